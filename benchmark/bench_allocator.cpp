@@ -34,134 +34,677 @@
 // Referred from:
 //
 //	https://github.com/daanx/mimalloc-bench/blob/master/bench/alloc-test/allocator_tester.h
+//
+// The suite runs the workloads on N threads against each allocator backend,
+// and reports the throughput, the tail latency of allocations and the
+// fragmentation ratio (the peak footprint of the allocator over the peak
+// live bytes), e.g.,
+//
+//   ./bin/vineyard-bench-allocator --allocators=system,dlmalloc,jemalloc \
+//       --workloads=pareto,fragmentation,trace --threads=1,4,16 \
+//       --trace=create_buffer_sizes.trace
+//
+// The "blob" backend allocates blobs from vineyardd (at "--ipc_socket") by
+// `CreateBuffer`, thus the server-side allocators (and the slab allocator of
+// small blobs, see "--slab_max_size") can be compared by running the suite
+// against vineyardd instances launched with different options.
+//
+// The trace is a text file of `CreateBuffer` requests, one per line:
+//
+//   a <id> <size>     allocates <size> bytes as <id>
+//   f <id>            frees <id>
+//
+// lines starting with '#' are ignored. Every thread replays the whole trace,
+// with its own ids.
 
 #include <sys/mman.h>
+#include <unistd.h>
 
-#include <time.h>
-
+#include <algorithm>
+#include <atomic>
 #include <chrono>
+#include <cstring>
 #include <fstream>
+#include <iomanip>
 #include <iostream>
 #include <memory>
+#include <sstream>
 #include <string>
 #include <thread>
+#include <unordered_map>
+#include <vector>
 
-#include "arrow/status.h"
-#include "arrow/util/io_util.h"
-#include "glog/logging.h"
+#include "boost/algorithm/string.hpp"
+#include "gflags/gflags.h"
 
-#include "basic/ds/array.h"
-#include "client/allocator.h"
 #include "client/client.h"
-#include "client/ds/object_meta.h"
+#include "client/ds/blob.h"
 #include "common/util/env.h"
-#include "common/util/functions.h"
+#include "common/util/flags.h"
+#include "common/util/json.h"
+#include "common/util/logging.h"
+#include "common/util/status.h"
 
+#if defined(WITH_JEMALLOC)
 #define JEMALLOC_NO_DEMANGLE
 #include "jemalloc/include/jemalloc/jemalloc.h"
 #undef JEMALLOC_NO_DEMANGLE
+#endif
 
+#if defined(WITH_VINEYARD_MALLOC)
 #include "malloc/allocator.h"
+#endif
+
+namespace vineyard {
+
+namespace dlmalloc {
+
+#define ONLY_MSPACES 1
+#define USE_LOCKS 1
+#define HAVE_MORECORE 0
+#define DEFAULT_MMAP_THRESHOLD MAX_SIZE_T
+#define DEFAULT_GRANULARITY ((size_t) 128U * 1024U)
+
+#include "dlmalloc/dlmalloc.c"  // NOLINT
+
+#undef ONLY_MSPACES
+#undef USE_LOCKS
+#undef HAVE_MORECORE
+#undef DEFAULT_MMAP_THRESHOLD
+#undef DEFAULT_GRANULARITY
+
+// dlmalloc.c defined DEBUG which will conflict with LOG(DEBUG).
+#ifdef DEBUG
+#undef DEBUG
+#endif
+
+}  // namespace dlmalloc
+
+}  // namespace vineyard
 
 #include "alloc_test.h"
 
-using namespace vineyard;  // NOLINT(build/namespaces)
+namespace vineyard {
+
+DEFINE_string(allocators, "system,dlmalloc",
+              "Allocator backends to compare: system, dlmalloc, jemalloc, "
+              "vineyard (the client-side allocator over the shared memory) "
+              "and blob (CreateBuffer of vineyardd)");
+DEFINE_string(workloads, "pareto,fragmentation",
+              "Workloads to run: pareto (the alloc-test loop), fragmentation "
+              "(long-lived objects with growing sizes) and trace (replaying "
+              "'--trace')");
+DEFINE_string(threads, "1,4,16", "Numbers of threads to run the workloads");
+DEFINE_uint64(iterations, 1 << 22,
+              "Number of iterations of the pareto workload, per thread");
+DEFINE_uint64(max_items, 1 << 16,
+              "Number of slots of the pareto workload, per thread");
+DEFINE_uint64(max_size_exp, 10,
+              "Allocations of the pareto workload are up to 2^exp bytes");
+DEFINE_uint64(live_bytes, 64 * 1024 * 1024,
+              "Live bytes of the fragmentation workload, per thread");
+DEFINE_uint64(rounds, 8, "Rounds of the fragmentation workload");
+DEFINE_string(trace, "", "The trace of CreateBuffer sizes to replay");
+DEFINE_uint64(sample_every, 16,
+              "Time one of such allocations for the latency percentiles");
+DEFINE_string(ipc_socket, "",
+              "IPC socket of vineyard server for the blob and vineyard "
+              "backends, defaults to $VINEYARD_IPC_SOCKET");
+DEFINE_string(format, "text", "Format of the report: text or json");
 
-// #define BENCH_VINEYARD
-#define BENCH_JEMALLOC
-// #define BENCH_SYSTEM
+namespace bench {
 
-size_t GetMillisecondCount() {
-  return std::chrono::duration_cast<std::chrono::milliseconds>(
-             std::chrono::system_clock::now().time_since_epoch())
-      .count();
+/**
+ * The allocator under benchmark, must be thread-safe, and the pointers are
+ * always freed by the thread that allocates them.
+ */
+class Backend {
+ public:
+  virtual ~Backend() {}
+
+  virtual Status Init() { return Status::OK(); }
+
+  virtual void* Allocate(const size_t size) = 0;
+
+  virtual void Free(void* pointer, const size_t size) = 0;
+
+  // the memory held by the allocator in bytes, 0 if it is unknown.
+  virtual size_t Footprint() = 0;
+};
+
+static size_t resident_bytes() {
+  std::ifstream statm("/proc/self/statm");
+  size_t pages = 0, resident = 0;
+  statm >> pages >> resident;
+  return resident * static_cast<size_t>(sysconf(_SC_PAGESIZE));
 }
 
-void bench() {
-  size_t start = GetMillisecondCount();
-
-  size_t iterCount = 100000000;
-  size_t maxItems = 1 << 18;   // 512 KB
-  size_t maxItemSizeExp = 10;  // 1K
-
-  size_t dummyCtr = 0;
-  size_t rssMax = 0;
-  size_t rss;
-  size_t allocatedSz = 0;
-  size_t allocatedSzMax = 0;
-
-  uint32_t reincarnation = 0;
-
-  Pareto_80_20_6_Data paretoData;
-  assert(maxItems <= UINT32_MAX);
-  Pareto_80_20_6_Init(paretoData, (uint32_t) maxItems);
-
-  struct TestBin {
-    uint8_t* ptr;
-    uint32_t sz;
-    uint32_t reincarnation;
-  };
-
-  TestBin* baseBuff = nullptr;
-#if defined(BENCH_SYSTEM)
-  baseBuff = reinterpret_cast<TestBin*>(malloc(maxItems * sizeof(TestBin)));
-#elif defined(BENCH_JEMALLOC)
-  baseBuff = reinterpret_cast<TestBin*>(
-      vineyard_je_malloc(maxItems * sizeof(TestBin)));
-#elif defined(BENCH_VINEYARD)
-  baseBuff =
-      reinterpret_cast<TestBin*>(vineyard_malloc(maxItems * sizeof(TestBin)));
-#else
-  baseBuff = reinterpret_cast<TestBin*>(vineyard_)
+class SystemBackend : public Backend {
+ public:
+  void* Allocate(const size_t size) override { return malloc(size); }
+
+  void Free(void* pointer, const size_t) override { free(pointer); }
+
+  // the growth of the process, as glibc doesn't expose the footprint portably
+  size_t Footprint() override {
+    size_t resident = resident_bytes();
+    return resident > baseline_ ? resident - baseline_ : 0;
+  }
+
+ private:
+  const size_t baseline_ = resident_bytes();
+};
+
+class DLmallocBackend : public Backend {
+ public:
+  ~DLmallocBackend() override {
+    if (space_ != nullptr) {
+      dlmalloc::destroy_mspace(space_);
+    }
+  }
+
+  // a single locked mspace, i.e., how vineyardd uses dlmalloc by default
+  Status Init() override {
+    space_ = dlmalloc::create_mspace(0, 1);
+    RETURN_ON_ASSERT(space_ != nullptr, "Failed to create the mspace");
+    return Status::OK();
+  }
+
+  void* Allocate(const size_t size) override {
+    return dlmalloc::mspace_malloc(space_, size);
+  }
+
+  void Free(void* pointer, const size_t) override {
+    dlmalloc::mspace_free(space_, pointer);
+  }
+
+  size_t Footprint() override { return dlmalloc::mspace_footprint(space_); }
+
+ private:
+  dlmalloc::mspace space_ = nullptr;
+};
+
+#if defined(WITH_JEMALLOC)
+class JemallocBackend : public Backend {
+ public:
+  void* Allocate(const size_t size) override {
+    return vineyard_je_malloc(size);
+  }
+
+  void Free(void* pointer, const size_t) override {
+    vineyard_je_free(pointer);
+  }
+
+  size_t Footprint() override {
+    // refreshes the stats
+    uint64_t epoch = 1;
+    size_t length = sizeof(epoch);
+    vineyard_je_mallctl("epoch", &epoch, &length, &epoch, length);
+    size_t resident = 0;
+    length = sizeof(resident);
+    if (vineyard_je_mallctl("stats.resident", &resident, &length, nullptr,
+                            0) != 0) {
+      return 0;
+    }
+    return resident;
+  }
+};
 #endif
-  assert(baseBuff);
-  allocatedSz += maxItems * sizeof(TestBin);
-  memset(baseBuff, 0, maxItems * sizeof(TestBin));
-
-  PRNG rng;
-
-  for (size_t k = 0; k < 32; ++k) {
-    for (size_t j = 0; j < iterCount >> 5; ++j) {
-      uint32_t rnum1 = rng.rng32();
-      uint32_t rnum2 = rng.rng32();
-      size_t idx = Pareto_80_20_6_Rand(paretoData, rnum1, rnum2);
-      if (baseBuff[idx].ptr) {
-#if defined(BENCH_SYSTEM)
-        free(baseBuff[idx].ptr);
-#elif defined(BENCH_JEMALLOC)
-        vineyard_je_free(baseBuff[idx].ptr);
-#else
-        vineyard_free(baseBuff[idx].ptr);
+
+#if defined(WITH_VINEYARD_MALLOC)
+class VineyardBackend : public Backend {
+ public:
+  ~VineyardBackend() override { vineyard_allocator_finalize(0); }
+
+  void* Allocate(const size_t size) override { return vineyard_malloc(size); }
+
+  void Free(void* pointer, const size_t) override { vineyard_free(pointer); }
+
+  // the mapped shared memory is counted to the resident set of the process
+  size_t Footprint() override {
+    size_t resident = resident_bytes();
+    return resident > baseline_ ? resident - baseline_ : 0;
+  }
+
+ private:
+  const size_t baseline_ = resident_bytes();
+};
 #endif
 
-        baseBuff[idx].ptr = 0;
-      } else {
-        size_t sz = calcSizeWithStatsAdjustment(rng.rng64(), maxItemSizeExp);
-        baseBuff[idx].sz = (uint32_t) sz;
-
-#if defined(BENCH_SYSTEM)
-        baseBuff[idx].ptr = reinterpret_cast<uint8_t*>(malloc(sz));
-#elif defined(BENCH_JEMALLOC)
-        baseBuff[idx].ptr = reinterpret_cast<uint8_t*>(vineyard_je_malloc(sz));
-#else
-        baseBuff[idx].ptr = reinterpret_cast<uint8_t*>(vineyard_malloc(sz));
+class BlobBackend : public Backend {
+ public:
+  Status Init() override {
+    Client client;
+    RETURN_ON_ERROR(client.Connect(FLAGS_ipc_socket));
+    client.Disconnect();
+    return Status::OK();
+  }
+
+  void* Allocate(const size_t size) override {
+    std::unique_ptr<BlobWriter> blob;
+    if (!client().CreateBlob(size, blob).ok()) {
+      return nullptr;
+    }
+    void* pointer = blob->data();
+    blobs()[pointer] = std::move(blob);
+    return pointer;
+  }
+
+  void Free(void* pointer, const size_t) override {
+    auto blob = blobs().find(pointer);
+    if (blob != blobs().end()) {
+      VINEYARD_DISCARD(blob->second->Abort(client()));
+      blobs().erase(blob);
+    }
+  }
+
+  // the fragmentation is inside vineyardd
+  size_t Footprint() override { return 0; }
+
+ private:
+  // blobs are created and aborted on the client of the calling thread
+  static Client& client() {
+    thread_local Client client;
+    if (!client.Connected()) {
+      VINEYARD_CHECK_OK(client.Connect(FLAGS_ipc_socket));
+    }
+    return client;
+  }
+
+  static std::unordered_map<void*, std::unique_ptr<BlobWriter>>& blobs() {
+    thread_local std::unordered_map<void*, std::unique_ptr<BlobWriter>> blobs;
+    return blobs;
+  }
+};
+
+static Status make_backend(std::string const& name,
+                           std::unique_ptr<Backend>& backend) {
+  if (name == "system") {
+    backend.reset(new SystemBackend());
+  } else if (name == "dlmalloc") {
+    backend.reset(new DLmallocBackend());
+#if defined(WITH_JEMALLOC)
+  } else if (name == "jemalloc") {
+    backend.reset(new JemallocBackend());
+#endif
+#if defined(WITH_VINEYARD_MALLOC)
+  } else if (name == "vineyard") {
+    backend.reset(new VineyardBackend());
 #endif
-        memset(baseBuff[idx].ptr, (uint8_t) sz, sz);
+  } else if (name == "blob") {
+    backend.reset(new BlobBackend());
+  } else {
+    return Status::Invalid("Unknown (or not compiled) allocator backend '" +
+                           name + "'");
+  }
+  return backend->Init();
+}
+
+struct trace_op_t {
+  bool allocate;
+  uint64_t id;
+  size_t size;
+};
+
+static Status load_trace(std::string const& path,
+                         std::vector<trace_op_t>& trace) {
+  std::ifstream input(path);
+  if (!input) {
+    return Status::IOError("Failed to open the trace '" + path + "'");
+  }
+  std::string line;
+  while (std::getline(input, line)) {
+    if (line.empty() || line[0] == '#') {
+      continue;
+    }
+    std::istringstream is(line);
+    std::string op;
+    trace_op_t item{false, 0, 0};
+    is >> op >> item.id;
+    item.allocate = op == "a";
+    if (item.allocate) {
+      is >> item.size;
+    }
+    if (is.fail() || (op != "a" && op != "f")) {
+      return Status::Invalid("Invalid line in the trace: '" + line + "'");
+    }
+    trace.emplace_back(item);
+  }
+  return Status::OK();
+}
+
+/**
+ * The counters of a run, the live bytes are shared by all threads to track
+ * the fragmentation.
+ */
+struct run_t {
+  std::atomic<uint64_t> operations{0};
+  std::atomic<uint64_t> failures{0};
+  std::atomic<int64_t> live_bytes{0};
+  std::vector<std::vector<int64_t>> latencies;  // per thread, in nanoseconds
+};
+
+/**
+ * The allocations of a thread, timed on sampling.
+ */
+class Worker {
+ public:
+  Worker(Backend& backend, run_t& run, const size_t index)
+      : backend_(backend), run_(run), latencies_(run.latencies[index]),
+        rng_(index + 1) {}
+
+  ~Worker() {
+    run_.operations += operations_;
+    run_.failures += failures_;
+  }
+
+  void* Allocate(const size_t size) {
+    void* pointer = nullptr;
+    operations_ += 1;
+    if (++allocations_ % FLAGS_sample_every == 0) {
+      auto start = std::chrono::steady_clock::now();
+      pointer = backend_.Allocate(size);
+      latencies_.emplace_back(
+          std::chrono::duration_cast<std::chrono::nanoseconds>(
+              std::chrono::steady_clock::now() - start)
+              .count());
+    } else {
+      pointer = backend_.Allocate(size);
+    }
+    if (pointer == nullptr) {
+      failures_ += 1;
+      return nullptr;
+    }
+    // touches the memory, as the footprint only counts the faulted pages
+    memset(pointer, static_cast<uint8_t>(size), size);
+    run_.live_bytes += size;
+    return pointer;
+  }
+
+  void Free(void* pointer, const size_t size) {
+    operations_ += 1;
+    backend_.Free(pointer, size);
+    run_.live_bytes -= size;
+  }
+
+  PRNG& rng() { return rng_; }
+
+ private:
+  Backend& backend_;
+  run_t& run_;
+  std::vector<int64_t>& latencies_;
+  PRNG rng_;
+  uint64_t operations_ = 0, allocations_ = 0, failures_ = 0;
+};
+
+struct slot_t {
+  void* pointer = nullptr;
+  size_t size = 0;
+};
+
+// the alloc-test loop: the slots are picked in Pareto 80-20, allocates if the
+// slot is empty, otherwise frees it.
+static void run_pareto(Worker& worker) {
+  Pareto_80_20_6_Data pareto;
+  Pareto_80_20_6_Init(pareto, static_cast<uint32_t>(FLAGS_max_items));
+  std::vector<slot_t> slots(FLAGS_max_items);
+  for (size_t iteration = 0; iteration < FLAGS_iterations; ++iteration) {
+    uint32_t rnum1 = worker.rng().rng32();
+    uint32_t rnum2 = worker.rng().rng32();
+    slot_t& slot = slots[Pareto_80_20_6_Rand(pareto, rnum1, rnum2)];
+    if (slot.pointer != nullptr) {
+      worker.Free(slot.pointer, slot.size);
+      slot.pointer = nullptr;
+    } else {
+      slot.size = calcSizeWithStatsAdjustment(worker.rng().rng64(),
+                                              FLAGS_max_size_exp);
+      slot.pointer = worker.Allocate(slot.size);
+    }
+  }
+  for (auto& slot : slots) {
+    if (slot.pointer != nullptr) {
+      worker.Free(slot.pointer, slot.size);
+    }
+  }
+}
+
+// fills the live set, frees a random half of them, and refills it with larger
+// objects that hardly fit into the holes, in rounds.
+static void run_fragmentation(Worker& worker) {
+  std::vector<slot_t> slots;
+  size_t live = 0;
+  for (size_t round = 0; round < FLAGS_rounds; ++round) {
+    size_t const min_size = 64 << round, max_size = 4096 << round;
+    while (live < FLAGS_live_bytes) {
+      slot_t slot;
+      slot.size = min_size + worker.rng().rng64() % (max_size - min_size);
+      slot.pointer = worker.Allocate(slot.size);
+      if (slot.pointer == nullptr) {
+        break;
       }
+      live += slot.size;
+      slots.emplace_back(slot);
     }
+    for (size_t index = 0; index < slots.size(); /* no self-inc */) {
+      if (worker.rng().rng32() % 2 == 0) {
+        worker.Free(slots[index].pointer, slots[index].size);
+        live -= slots[index].size;
+        slots[index] = slots.back();
+        slots.pop_back();
+      } else {
+        ++index;
+      }
+    }
+  }
+  for (auto& slot : slots) {
+    worker.Free(slot.pointer, slot.size);
   }
+}
 
-  size_t elapsed = GetMillisecondCount() - start;
-  LOG(INFO) << "usage: " << elapsed << " milliseconds";
+static void run_trace(Worker& worker, std::vector<trace_op_t> const& trace) {
+  std::unordered_map<uint64_t, slot_t> slots;
+  for (auto const& op : trace) {
+    if (op.allocate) {
+      slot_t& slot = slots[op.id];
+      if (slot.pointer != nullptr) {
+        worker.Free(slot.pointer, slot.size);
+      }
+      slot.size = op.size;
+      slot.pointer = worker.Allocate(op.size);
+    } else {
+      auto slot = slots.find(op.id);
+      if (slot != slots.end()) {
+        if (slot->second.pointer != nullptr) {
+          worker.Free(slot->second.pointer, slot->second.size);
+        }
+        slots.erase(slot);
+      }
+    }
+  }
+  for (auto& slot : slots) {
+    if (slot.second.pointer != nullptr) {
+      worker.Free(slot.second.pointer, slot.second.size);
+    }
+  }
 }
 
+static double percentile(std::vector<int64_t> const& sorted,
+                         const double ratio) {
+  if (sorted.empty()) {
+    return 0;
+  }
+  return sorted[static_cast<size_t>(ratio * (sorted.size() - 1))];
+}
+
+static json run(std::string const& allocator, std::string const& workload,
+                const size_t threads, std::vector<trace_op_t> const& trace) {
+  json result;
+  result["allocator"] = allocator;
+  result["workload"] = workload;
+  result["threads"] = threads;
+
+  std::unique_ptr<Backend> backend;
+  auto status = make_backend(allocator, backend);
+  if (!status.ok()) {
+    result["error"] = status.ToString();
+    return result;
+  }
+
+  run_t run;
+  run.latencies.resize(threads);
+  // samples the footprint while running, for the fragmentation ratio
+  std::atomic<bool> finished{false};
+  size_t peak_footprint = 0;
+  int64_t peak_live = 0;
+  std::thread sampler([&]() {
+    while (!finished.load()) {
+      peak_footprint = std::max(peak_footprint, backend->Footprint());
+      peak_live = std::max(peak_live, run.live_bytes.load());
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+  });
+
+  auto start = std::chrono::steady_clock::now();
+  std::vector<std::thread> workers;
+  for (size_t index = 0; index < threads; ++index) {
+    workers.emplace_back([&, index]() {
+      Worker worker(*backend, run, index);
+      if (workload == "pareto") {
+        run_pareto(worker);
+      } else if (workload == "fragmentation") {
+        run_fragmentation(worker);
+      } else {
+        run_trace(worker, trace);
+      }
+    });
+  }
+  for (auto& worker : workers) {
+    worker.join();
+  }
+  double seconds = std::chrono::duration<double>(
+                       std::chrono::steady_clock::now() - start)
+                       .count();
+  finished.store(true);
+  sampler.join();
+
+  std::vector<int64_t> latencies;
+  for (auto const& item : run.latencies) {
+    latencies.insert(latencies.end(), item.begin(), item.end());
+  }
+  std::sort(latencies.begin(), latencies.end());
+  result["operations"] = run.operations.load();
+  result["failures"] = run.failures.load();
+  result["seconds"] = seconds;
+  result["throughput"] = run.operations.load() / seconds;
+  result["p50_ns"] = percentile(latencies, 0.5);
+  result["p99_ns"] = percentile(latencies, 0.99);
+  result["p999_ns"] = percentile(latencies, 0.999);
+  result["max_ns"] = percentile(latencies, 1.0);
+  result["peak_footprint"] = peak_footprint;
+  result["peak_live_bytes"] = peak_live;
+  if (peak_footprint > 0 && peak_live > 0) {
+    result["fragmentation"] =
+        static_cast<double>(peak_footprint) / static_cast<double>(peak_live);
+  }
+  return result;
+}
+
+static void report(json const& results) {
+  if (FLAGS_format == "json") {
+    std::cout << results.dump() << std::endl;
+    return;
+  }
+  std::cout << std::left << std::setw(10) << "allocator" << std::setw(15)
+            << "workload" << std::right << std::setw(8) << "threads"
+            << std::setw(14) << "Mops/s" << std::setw(10) << "p50(ns)"
+            << std::setw(10) << "p99(ns)" << std::setw(11) << "p999(ns)"
+            << std::setw(15) << "fragmentation" << std::endl;
+  for (auto const& result : results) {
+    std::cout << std::left << std::setw(10)
+              << result["allocator"].get<std::string>() << std::setw(15)
+              << result["workload"].get<std::string>() << std::right
+              << std::setw(8) << result["threads"].get<size_t>();
+    if (result.contains("error")) {
+      std::cout << "  " << result["error"].get<std::string>() << std::endl;
+      continue;
+    }
+    std::cout << std::fixed << std::setprecision(3) << std::setw(14)
+              << result["throughput"].get<double>() / 1e6
+              << std::setprecision(0) << std::setw(10)
+              << result["p50_ns"].get<double>() << std::setw(10)
+              << result["p99_ns"].get<double>() << std::setw(11)
+              << result["p999_ns"].get<double>() << std::setprecision(3)
+              << std::setw(15);
+    if (result.contains("fragmentation")) {
+      std::cout << result["fragmentation"].get<double>();
+    } else {
+      std::cout << "-";
+    }
+    if (result["failures"].get<uint64_t>() > 0) {
+      std::cout << "  (" << result["failures"].get<uint64_t>()
+                << " allocations failed)";
+    }
+    std::cout << std::endl;
+  }
+}
+
+}  // namespace bench
+
+}  // namespace vineyard
+
 int main(int argc, char** argv) {
-  if (argc < 1) {
-    printf("usage ./bench_allocator");
-    return 1;
+  vineyard::logging::InitGoogleLogging("vineyard");
+  vineyard::flags::SetUsageMessage(
+      "Usage: vineyard-bench-allocator [options]\n\n"
+      "Compares the allocator backends on throughput, tail latency and "
+      "fragmentation under multi-threaded workloads.");
+  vineyard::flags::ParseCommandLineNonHelpFlags(&argc, &argv, false);
+  if (FLAGS_help) {
+    FLAGS_help = false;
+    FLAGS_helpmatch = "vineyard";
+  }
+  vineyard::flags::HandleCommandLineHelpFlags();
+
+  if (vineyard::FLAGS_ipc_socket.empty()) {
+    vineyard::FLAGS_ipc_socket = vineyard::read_env("VINEYARD_IPC_SOCKET");
+  }
+  if (vineyard::FLAGS_sample_every == 0) {
+    vineyard::FLAGS_sample_every = 1;
   }
 
-  bench();
+  std::vector<std::string> allocators, workloads, threads;
+  boost::split(allocators, vineyard::FLAGS_allocators, boost::is_any_of(","));
+  boost::split(workloads, vineyard::FLAGS_workloads, boost::is_any_of(","));
+  boost::split(threads, vineyard::FLAGS_threads, boost::is_any_of(","));
+
+  std::vector<vineyard::bench::trace_op_t> trace;
+  for (auto const& workload : workloads) {
+    if (workload != "pareto" && workload != "fragmentation" &&
+        workload != "trace") {
+      LOG(ERROR) << "Unknown workload '" << workload << "'";
+      return 1;
+    }
+    if (workload == "trace") {
+      auto status =
+          vineyard::bench::load_trace(vineyard::FLAGS_trace, trace);
+      if (!status.ok()) {
+        LOG(ERROR) << status.ToString();
+        return 1;
+      }
+    }
+  }
+
+  vineyard::json results = vineyard::json::array();
+  for (auto const& allocator : allocators) {
+    for (auto const& workload : workloads) {
+      for (auto const& thread : threads) {
+        size_t concurrency = std::max<size_t>(std::stoul(thread), 1);
+        results.push_back(vineyard::bench::run(allocator, workload,
+                                               concurrency, trace));
+      }
+    }
+  }
+  vineyard::bench::report(results);
 
   LOG(INFO) << "Finish allocator benchmarks...";
   return 0;
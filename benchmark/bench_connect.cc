@@ -0,0 +1,70 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+
+#include "benchmark/bench_utils.h"
+
+namespace vineyard {
+
+namespace bench {
+
+// the setup and teardown of short-lived IPC clients, e.g., serverless
+// functions that connect for a single request.
+static void BM_IPCConnect(benchmark::State& state) {
+  for (auto _ : state) {
+    Client client;
+    if (SkipOnError(state, client.Connect(IPCSocket()))) {
+      break;
+    }
+    client.Disconnect();
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_IPCConnect)->ThreadRange(1, 64)->UseRealTime();
+
+// as above, and issues a request on every connection.
+static void BM_IPCConnectRequest(benchmark::State& state) {
+  bool exists = false;
+  for (auto _ : state) {
+    Client client;
+    if (SkipOnError(state, client.Connect(IPCSocket())) ||
+        SkipOnError(state, client.Exists(InvalidObjectID(), exists))) {
+      break;
+    }
+    client.Disconnect();
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_IPCConnectRequest)->ThreadRange(1, 64)->UseRealTime();
+
+static void BM_RPCConnect(benchmark::State& state) {
+  if (RPCEndpoint().empty()) {
+    state.SkipWithError("VINEYARD_RPC_ENDPOINT is not set");
+    return;
+  }
+  for (auto _ : state) {
+    RPCClient client;
+    if (SkipOnError(state, client.Connect(RPCEndpoint()))) {
+      break;
+    }
+    client.Disconnect();
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_RPCConnect)->ThreadRange(1, 64)->UseRealTime();
+
+}  // namespace bench
+
+}  // namespace vineyard
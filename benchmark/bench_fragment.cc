@@ -0,0 +1,52 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+
+#include <memory>
+#include <string>
+
+#include "benchmark/bench_utils.h"
+#include "graph/fragment/arrow_fragment.h"
+
+namespace vineyard {
+
+namespace bench {
+
+using GraphType = ArrowFragment<property_graph_types::OID_TYPE,
+                                property_graph_types::VID_TYPE>;
+
+// loads the fragment "VINEYARD_BENCH_FRAGMENT" (the id of a fragment that
+// has been loaded into the vineyardd, e.g., by "arrow_fragment_test").
+static void BM_FragmentLoad(benchmark::State& state) {
+  std::string fragment = read_env("VINEYARD_BENCH_FRAGMENT");
+  if (fragment.empty()) {
+    state.SkipWithError("VINEYARD_BENCH_FRAGMENT is not set");
+    return;
+  }
+  Client& client = ThreadClient();
+  ObjectID fragment_id = ObjectIDFromString(fragment);
+  for (auto _ : state) {
+    std::shared_ptr<GraphType> graph;
+    if (SkipOnError(state, client.GetObject(fragment_id, graph))) {
+      break;
+    }
+    benchmark::DoNotOptimize(graph);
+  }
+}
+BENCHMARK(BM_FragmentLoad)->UseRealTime();
+
+}  // namespace bench
+
+}  // namespace vineyard
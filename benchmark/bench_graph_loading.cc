@@ -0,0 +1,405 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+// Loads synthetic power-law graphs by `ArrowFragmentLoader` end to end, and
+// reports the time of each phase (see also `LoadProfile`), the peak RSS of
+// the workers and the peak shared memory usage of vineyardd, e.g.,
+//
+//   mpirun -n 4 ./bin/vineyard-bench-graph-loading --vertices=1000000 \
+//       --avg_degree=16 --vertex_labels=2 --edge_labels=2 --rounds=3
+//
+// The graph files are generated by the first worker into "--data_dir", which
+// must be shared by all workers when running on more than one host.
+
+#include <sys/resource.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "boost/filesystem.hpp"
+#include "gflags/gflags.h"
+
+#include "client/client.h"
+#include "common/util/env.h"
+#include "common/util/flags.h"
+#include "common/util/json.h"
+#include "common/util/logging.h"
+
+#include "graph/fragment/arrow_fragment.h"
+#include "graph/loader/arrow_fragment_loader.h"
+#include "graph/utils/load_profile.h"
+
+namespace vineyard {
+
+DEFINE_uint64(vertices, 1 << 20, "Number of vertices of each vertex label");
+DEFINE_uint64(avg_degree, 16, "Average out-degree of each edge label");
+DEFINE_uint64(vertex_labels, 1, "Number of vertex labels");
+DEFINE_uint64(edge_labels, 1, "Number of edge labels");
+DEFINE_uint64(properties, 1, "Number of properties of vertices and edges");
+DEFINE_double(skew, 3.0,
+              "Skewness of the endpoints of edges, the degrees follow a "
+              "power-law distribution for values larger than 1");
+DEFINE_uint64(seed, 0, "Seed of the generator");
+DEFINE_string(data_dir, "/tmp/vineyard-bench-graph",
+              "Directory of the generated graph files");
+DEFINE_bool(regenerate, false,
+            "Regenerate the graph files even if they exist");
+DEFINE_bool(directed, true, "Load the graph as a directed graph");
+DEFINE_bool(edges_only, false,
+            "Load the graph from the edge files only, i.e., collect the "
+            "vertices from the endpoints of edges");
+DEFINE_bool(reorder_vertices, false, "Reorder the vertices by degrees");
+DEFINE_bool(partitioned_vertex_map, false,
+            "Build partitioned vertex maps rather than global ones");
+DEFINE_bool(degree_index, false,
+            "Precompute the degree index into the fragments");
+DEFINE_uint64(rounds, 3, "Rounds of loading the graph");
+DEFINE_string(ipc_socket, "",
+              "IPC socket of vineyard server, defaults to "
+              "$VINEYARD_IPC_SOCKET");
+DEFINE_string(format, "text", "Format of the report: text or json");
+
+namespace bench {
+
+using GraphType = ArrowFragment<property_graph_types::OID_TYPE,
+                                property_graph_types::VID_TYPE>;
+using LoaderType = ArrowFragmentLoader<property_graph_types::OID_TYPE,
+                                       property_graph_types::VID_TYPE>;
+
+static std::string vertex_file(const size_t label) {
+  return FLAGS_data_dir + "/v" + std::to_string(label) + ".csv";
+}
+
+static std::string edge_file(const size_t label, const size_t src_label) {
+  return FLAGS_data_dir + "/e" + std::to_string(label) + "_v" +
+         std::to_string(src_label) + ".csv";
+}
+
+// the edges of "e<i>" from "v<j>" end at "v<(i + j) % vertex_labels>"
+static size_t dst_label_of(const size_t label, const size_t src_label) {
+  return (label + src_label) % FLAGS_vertex_labels;
+}
+
+/**
+ * The endpoints are drawn by `n * u^skew` (u in [0, 1)), i.e., the smaller
+ * ids get most of the edges, and then scattered by a multiplicative hash to
+ * avoid the locality of high-degree vertices.
+ */
+class EndpointGenerator {
+ public:
+  EndpointGenerator(const uint64_t vertices, const uint64_t seed)
+      : vertices_(vertices), rng_(seed), uniform_(0.0, 1.0) {}
+
+  int64_t operator()() {
+    uint64_t rank = static_cast<uint64_t>(
+        static_cast<double>(vertices_) * std::pow(uniform_(rng_), FLAGS_skew));
+    rank = std::min(rank, vertices_ - 1);
+    return static_cast<int64_t>((rank * kPrime) % vertices_);
+  }
+
+  std::mt19937_64& rng() { return rng_; }
+
+ private:
+  static constexpr uint64_t kPrime = 2654435761ULL;
+
+  const uint64_t vertices_;
+  std::mt19937_64 rng_;
+  std::uniform_real_distribution<double> uniform_;
+};
+
+static void write_properties(std::ofstream& os, std::mt19937_64& rng) {
+  for (size_t property = 0; property < FLAGS_properties; ++property) {
+    os << ',' << (rng() % 1000000);
+  }
+}
+
+static void write_header(std::ofstream& os, std::string const& prefix) {
+  os << prefix;
+  for (size_t property = 0; property < FLAGS_properties; ++property) {
+    os << ",p" << property;
+  }
+  os << '\n';
+}
+
+static Status generate() {
+  boost::system::error_code ec;
+  boost::filesystem::create_directories(FLAGS_data_dir, ec);
+  RETURN_ON_ASSERT(!ec, "Failed to create the data directory '" +
+                            FLAGS_data_dir + "': " + ec.message());
+  if (!FLAGS_regenerate &&
+      boost::filesystem::exists(edge_file(FLAGS_edge_labels - 1,
+                                          FLAGS_vertex_labels - 1))) {
+    LOG(INFO) << "Reusing the graph files in '" << FLAGS_data_dir << "'";
+    return Status::OK();
+  }
+  std::mt19937_64 rng(FLAGS_seed);
+  for (size_t label = 0; label < FLAGS_vertex_labels; ++label) {
+    std::ofstream os(vertex_file(label));
+    RETURN_ON_ASSERT(os.good(), "Failed to write " + vertex_file(label));
+    write_header(os, "id");
+    for (uint64_t vertex = 0; vertex < FLAGS_vertices; ++vertex) {
+      os << vertex;
+      write_properties(os, rng);
+      os << '\n';
+    }
+  }
+  uint64_t edges = FLAGS_vertices * FLAGS_avg_degree;
+  for (size_t label = 0; label < FLAGS_edge_labels; ++label) {
+    for (size_t src_label = 0; src_label < FLAGS_vertex_labels; ++src_label) {
+      std::ofstream os(edge_file(label, src_label));
+      RETURN_ON_ASSERT(os.good(),
+                       "Failed to write " + edge_file(label, src_label));
+      EndpointGenerator endpoint(FLAGS_vertices,
+                                 FLAGS_seed + label * 1000 + src_label + 1);
+      write_header(os, "src,dst");
+      for (uint64_t edge = 0; edge < edges; ++edge) {
+        os << endpoint() << ',' << endpoint();
+        write_properties(os, endpoint.rng());
+        os << '\n';
+      }
+    }
+  }
+  LOG(INFO) << "Generated the graph files in '" << FLAGS_data_dir << "'";
+  return Status::OK();
+}
+
+static void make_locations(std::vector<std::string>& efiles,
+                           std::vector<std::string>& vfiles) {
+  for (size_t label = 0; label < FLAGS_vertex_labels; ++label) {
+    vfiles.emplace_back(vertex_file(label) + "#label=v" +
+                        std::to_string(label));
+  }
+  for (size_t label = 0; label < FLAGS_edge_labels; ++label) {
+    std::string location;
+    for (size_t src_label = 0; src_label < FLAGS_vertex_labels; ++src_label) {
+      location += (src_label == 0 ? "" : ";") + edge_file(label, src_label) +
+                  "#label=e" + std::to_string(label) + "&src_label=v" +
+                  std::to_string(src_label) + "&dst_label=v" +
+                  std::to_string(dst_label_of(label, src_label));
+    }
+    efiles.emplace_back(location);
+  }
+}
+
+// in bytes
+static int64_t peak_rss() {
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  return static_cast<int64_t>(usage.ru_maxrss) * 1024;
+}
+
+/**
+ * Polls the memory usage of vineyardd by a dedicated client, as the loader
+ * occupies the client of the worker.
+ */
+class SharedMemorySampler {
+ public:
+  SharedMemorySampler() {
+    if (!client_.Connect(FLAGS_ipc_socket).ok()) {
+      return;
+    }
+    sampler_ = std::thread([this]() {
+      while (!stopped_.load()) {
+        std::shared_ptr<struct InstanceStatus> status;
+        if (client_.InstanceStatus(status).ok()) {
+          int64_t usage = static_cast<int64_t>(status->memory_usage);
+          int64_t peak = peak_.load();
+          while (usage > peak && !peak_.compare_exchange_weak(peak, usage)) {
+          }
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+      }
+    });
+  }
+
+  ~SharedMemorySampler() {
+    stopped_.store(true);
+    if (sampler_.joinable()) {
+      sampler_.join();
+    }
+  }
+
+  int64_t Peak() const { return peak_.load(); }
+
+ private:
+  Client client_;
+  std::atomic<bool> stopped_{false};
+  std::atomic<int64_t> peak_{0};
+  std::thread sampler_;
+};
+
+static json run_round(Client& client, const grape::CommSpec& comm_spec,
+                      std::vector<std::string> const& efiles,
+                      std::vector<std::string> const& vfiles) {
+  LoadProfile profile;
+  std::unique_ptr<LoaderType> loader;
+  if (FLAGS_edges_only) {
+    loader.reset(new LoaderType(client, comm_spec, efiles, FLAGS_directed));
+  } else {
+    loader.reset(
+        new LoaderType(client, comm_spec, efiles, vfiles, FLAGS_directed));
+    loader->set_reorder_vertices(FLAGS_reorder_vertices);
+    loader->set_partitioned_vertex_map(FLAGS_partitioned_vertex_map);
+  }
+  loader->set_degree_index(FLAGS_degree_index);
+  loader->set_profile(&profile);
+
+  double seconds = 0;
+  int64_t peak_shm = 0;
+  ObjectID fragment_id = InvalidObjectID();
+  {
+    SharedMemorySampler sampler;
+    MPI_Barrier(comm_spec.comm());
+    auto start = std::chrono::steady_clock::now();
+    fragment_id = boost::leaf::try_handle_all(
+        [&loader]() { return loader->LoadFragment(); },
+        [](const GSError& e) {
+          LOG(FATAL) << e.error_msg;
+          return InvalidObjectID();
+        },
+        [](const boost::leaf::error_info& unmatched) {
+          LOG(FATAL) << "Unmatched error " << unmatched;
+          return InvalidObjectID();
+        });
+    MPI_Barrier(comm_spec.comm());
+    seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                            start)
+                  .count();
+    peak_shm = sampler.Peak();
+  }
+
+  // the slowest worker of every phase, and the peaks among workers
+  std::vector<double> phases(LoadProfile::kPhases);
+  for (int phase = 0; phase < LoadProfile::kPhases; ++phase) {
+    phases[phase] = profile.Get(static_cast<LoadProfile::Phase>(phase));
+  }
+  MPI_Allreduce(MPI_IN_PLACE, phases.data(), phases.size(), MPI_DOUBLE,
+                MPI_MAX, comm_spec.comm());
+  int64_t peaks[2] = {peak_rss(), peak_shm};
+  MPI_Allreduce(MPI_IN_PLACE, peaks, 2, MPI_INT64_T, MPI_MAX,
+                comm_spec.comm());
+
+  json result;
+  result["total"] = seconds;
+  for (int phase = 0; phase < LoadProfile::kPhases; ++phase) {
+    result[LoadProfile::PhaseName(static_cast<LoadProfile::Phase>(phase))] =
+        phases[phase];
+  }
+  result["peak_rss"] = peaks[0];
+  result["peak_shared_memory"] = peaks[1];
+
+  // drops the fragment (and the vertex map) before the next round
+  VINEYARD_DISCARD(client.DelData(fragment_id, true, true));
+  MPI_Barrier(comm_spec.comm());
+  return result;
+}
+
+static void report(json const& results) {
+  if (FLAGS_format == "json") {
+    std::cout << results.dump() << std::endl;
+    return;
+  }
+  std::vector<std::string> columns{"total"};
+  for (int phase = 0; phase < LoadProfile::kPhases; ++phase) {
+    columns.emplace_back(
+        LoadProfile::PhaseName(static_cast<LoadProfile::Phase>(phase)));
+  }
+  std::cout << std::left << std::setw(7) << "round" << std::right;
+  for (auto const& column : columns) {
+    std::cout << std::setw(12) << column + "(s)";
+  }
+  std::cout << std::setw(14) << "rss(MB)" << std::setw(14) << "shm(MB)"
+            << std::endl;
+  for (size_t round = 0; round < results.size(); ++round) {
+    auto const& result = results[round];
+    std::cout << std::left << std::setw(7) << round << std::right << std::fixed
+              << std::setprecision(3);
+    for (auto const& column : columns) {
+      std::cout << std::setw(12) << result[column].get<double>();
+    }
+    std::cout << std::setprecision(1) << std::setw(14)
+              << result["peak_rss"].get<int64_t>() / 1048576.0
+              << std::setw(14)
+              << result["peak_shared_memory"].get<int64_t>() / 1048576.0
+              << std::endl;
+  }
+}
+
+}  // namespace bench
+
+}  // namespace vineyard
+
+int main(int argc, char** argv) {
+  vineyard::logging::InitGoogleLogging("vineyard");
+  vineyard::flags::SetUsageMessage(
+      "Usage: vineyard-bench-graph-loading [options]\n\n"
+      "Loads synthetic power-law graphs into vineyard, and reports the time "
+      "of each phase of the loader.");
+  vineyard::flags::ParseCommandLineNonHelpFlags(&argc, &argv, false);
+  if (FLAGS_help) {
+    FLAGS_help = false;
+    FLAGS_helpmatch = "vineyard";
+  }
+  vineyard::flags::HandleCommandLineHelpFlags();
+
+  if (vineyard::FLAGS_ipc_socket.empty()) {
+    vineyard::FLAGS_ipc_socket = vineyard::read_env("VINEYARD_IPC_SOCKET");
+  }
+  vineyard::FLAGS_vertex_labels =
+      std::max<uint64_t>(vineyard::FLAGS_vertex_labels, 1);
+  vineyard::FLAGS_edge_labels =
+      std::max<uint64_t>(vineyard::FLAGS_edge_labels, 1);
+  vineyard::FLAGS_vertices = std::max<uint64_t>(vineyard::FLAGS_vertices, 1);
+
+  grape::InitMPIComm();
+  {
+    grape::CommSpec comm_spec;
+    comm_spec.Init(MPI_COMM_WORLD);
+
+    if (comm_spec.worker_id() == 0) {
+      VINEYARD_CHECK_OK(vineyard::bench::generate());
+    }
+    MPI_Barrier(comm_spec.comm());
+
+    vineyard::Client client;
+    VINEYARD_CHECK_OK(client.Connect(vineyard::FLAGS_ipc_socket));
+
+    std::vector<std::string> efiles, vfiles;
+    vineyard::bench::make_locations(efiles, vfiles);
+
+    vineyard::json results = vineyard::json::array();
+    for (size_t round = 0; round < vineyard::FLAGS_rounds; ++round) {
+      results.push_back(
+          vineyard::bench::run_round(client, comm_spec, efiles, vfiles));
+    }
+    if (comm_spec.worker_id() == 0) {
+      vineyard::bench::report(results);
+    }
+  }
+  grape::FinalizeMPIComm();
+
+  LOG(INFO) << "Finish graph loading benchmarks...";
+  return 0;
+}
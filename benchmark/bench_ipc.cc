@@ -0,0 +1,92 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+
+#include <memory>
+#include <vector>
+
+#include "basic/ds/tuple.h"
+#include "benchmark/bench_utils.h"
+
+namespace vineyard {
+
+namespace bench {
+
+// the round-trip of a request that doesn't touch the bulk store.
+static void BM_RoundTrip(benchmark::State& state) {
+  Client& client = ThreadClient();
+  bool exists = false;
+  for (auto _ : state) {
+    if (SkipOnError(state, client.Exists(InvalidObjectID(), exists))) {
+      break;
+    }
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_RoundTrip)->ThreadRange(1, 16)->UseRealTime();
+
+// creates a blob of the given size and seals it, the blob is deleted
+// afterwards to keep the footprint stable.
+static void BM_CreateSeal(benchmark::State& state) {
+  Client& client = ThreadClient();
+  size_t const size = state.range(0);
+  for (auto _ : state) {
+    std::unique_ptr<BlobWriter> writer;
+    if (SkipOnError(state, client.CreateBlob(size, writer))) {
+      break;
+    }
+    auto blob = writer->Seal(client);
+    state.PauseTiming();
+    VINEYARD_CHECK_OK(client.DelData(blob->id()));
+    state.ResumeTiming();
+  }
+  state.SetItemsProcessed(state.iterations());
+  state.SetBytesProcessed(state.iterations() * size);
+}
+BENCHMARK(BM_CreateSeal)
+    ->RangeMultiplier(16)
+    ->Range(64, 64 << 20)
+    ->ThreadRange(1, 16)
+    ->UseRealTime();
+
+// gets an object that has the given number of members.
+static void BM_GetObjectFanout(benchmark::State& state) {
+  Client& client = ThreadClient();
+  size_t const members = state.range(0);
+  TupleBuilder builder(client, members);
+  std::vector<ObjectID> blob_ids;
+  for (size_t index = 0; index < members; ++index) {
+    std::unique_ptr<BlobWriter> writer;
+    VINEYARD_CHECK_OK(client.CreateBlob(64, writer));
+    auto blob = writer->Seal(client);
+    blob_ids.emplace_back(blob->id());
+    builder.SetValue(index, blob);
+  }
+  auto tuple = builder.Seal(client);
+  for (auto _ : state) {
+    std::shared_ptr<Object> object;
+    if (SkipOnError(state, client.GetObject(tuple->id(), object))) {
+      break;
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * members);
+  VINEYARD_CHECK_OK(client.DelData(tuple->id()));
+  VINEYARD_CHECK_OK(client.DelData(blob_ids));
+}
+BENCHMARK(BM_GetObjectFanout)->RangeMultiplier(8)->Range(1, 4096);
+
+}  // namespace bench
+
+}  // namespace vineyard
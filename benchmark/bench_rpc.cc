@@ -0,0 +1,73 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+
+#include <cstring>
+#include <map>
+#include <memory>
+
+#include "benchmark/bench_utils.h"
+
+namespace vineyard {
+
+namespace bench {
+
+// fetches a blob of the given size from the vineyardd at the RPC endpoint,
+// optionally striped across the given number of data streams.
+static void BM_RemoteBlobs(benchmark::State& state) {
+  if (RPCEndpoint().empty()) {
+    state.SkipWithError("VINEYARD_RPC_ENDPOINT is not set");
+    return;
+  }
+  Client& client = ThreadClient();
+  size_t const size = state.range(0);
+  size_t const streams = state.range(1);
+
+  RPCClient rpc_client;
+  VINEYARD_CHECK_OK(rpc_client.Connect(RPCEndpoint()));
+  if (streams > 0) {
+    VINEYARD_CHECK_OK(rpc_client.ConnectDataStreams(streams));
+  }
+
+  // the blob lives in the instance that serves the RPC endpoint, which may
+  // be the local instance as well.
+  std::unique_ptr<BlobWriter> writer;
+  VINEYARD_CHECK_OK(client.CreateBlob(size, writer));
+  memset(writer->data(), 0xa5, size);
+  ObjectID blob_id = writer->Seal(client)->id();
+
+  for (auto _ : state) {
+    std::map<ObjectID, std::unique_ptr<BlobWriter>> blobs;
+    if (SkipOnError(state, rpc_client.GetRemoteBlobs({blob_id}, client,
+                                                     blobs))) {
+      break;
+    }
+    state.PauseTiming();
+    for (auto& blob : blobs) {
+      VINEYARD_CHECK_OK(blob.second->Abort(client));
+    }
+    state.ResumeTiming();
+  }
+  state.SetBytesProcessed(state.iterations() * size);
+  VINEYARD_CHECK_OK(client.DelData(blob_id));
+}
+BENCHMARK(BM_RemoteBlobs)
+    ->ArgsProduct({{64 << 10, 4 << 20, 256 << 20}, {0, 4}})
+    ->ArgNames({"size", "streams"})
+    ->UseRealTime();
+
+}  // namespace bench
+
+}  // namespace vineyard
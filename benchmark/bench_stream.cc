@@ -0,0 +1,83 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+
+#include <memory>
+#include <thread>
+
+#include "basic/stream/byte_stream.h"
+#include "benchmark/bench_utils.h"
+
+namespace vineyard {
+
+namespace bench {
+
+// streams the given number of chunks of the given size from a writer
+// (in another connection) to the reader.
+static void BM_StreamThroughput(benchmark::State& state) {
+  Client& client = ThreadClient();
+  size_t const chunk_size = state.range(0);
+  size_t const chunks = state.range(1);
+
+  Client writer_client;
+  VINEYARD_CHECK_OK(writer_client.Connect(IPCSocket()));
+
+  for (auto _ : state) {
+    state.PauseTiming();
+    ByteStreamBuilder builder(client);
+    auto stream = std::dynamic_pointer_cast<ByteStream>(builder.Seal(client));
+    std::unique_ptr<ByteStreamReader> reader;
+    VINEYARD_CHECK_OK(stream->OpenReader(client, reader));
+    state.ResumeTiming();
+
+    std::thread writer_thread([&]() {
+      auto writer_stream = writer_client.GetObject<ByteStream>(stream->id());
+      std::unique_ptr<ByteStreamWriter> writer;
+      VINEYARD_CHECK_OK(writer_stream->OpenWriter(writer_client, writer));
+      for (size_t index = 0; index < chunks; ++index) {
+        std::unique_ptr<arrow::MutableBuffer> buffer;
+        VINEYARD_CHECK_OK(writer->GetNext(chunk_size, buffer));
+      }
+      VINEYARD_CHECK_OK(writer->Finish());
+    });
+
+    size_t received = 0;
+    while (true) {
+      std::unique_ptr<arrow::Buffer> buffer;
+      auto status = reader->GetNext(buffer);
+      if (!status.ok()) {
+        CHECK(status.IsStreamDrained());
+        break;
+      }
+      received += 1;
+    }
+    writer_thread.join();
+    CHECK_EQ(received, chunks);
+
+    state.PauseTiming();
+    VINEYARD_CHECK_OK(client.DelData(stream->id(), true, true));
+    state.ResumeTiming();
+  }
+  state.SetItemsProcessed(state.iterations() * chunks);
+  state.SetBytesProcessed(state.iterations() * chunks * chunk_size);
+}
+BENCHMARK(BM_StreamThroughput)
+    ->ArgsProduct({{4 << 10, 256 << 10, 4 << 20}, {64}})
+    ->ArgNames({"chunk_size", "chunks"})
+    ->UseRealTime();
+
+}  // namespace bench
+
+}  // namespace vineyard
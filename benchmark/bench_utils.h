@@ -0,0 +1,66 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+
+#ifndef BENCHMARK_BENCH_UTILS_H_
+#define BENCHMARK_BENCH_UTILS_H_
+
+#include <string>
+
+#include "benchmark/benchmark.h"
+
+#include "client/client.h"
+#include "client/rpc_client.h"
+#include "common/util/env.h"
+#include "common/util/logging.h"
+
+namespace vineyard {
+
+namespace bench {
+
+/**
+ * @brief The benchmarks connect to the vineyardd at "VINEYARD_IPC_SOCKET",
+ * and the RPC benchmarks connect to "VINEYARD_RPC_ENDPOINT" in addition.
+ */
+inline std::string IPCSocket() { return read_env("VINEYARD_IPC_SOCKET"); }
+
+inline std::string RPCEndpoint() { return read_env("VINEYARD_RPC_ENDPOINT"); }
+
+/**
+ * @brief The client of the calling thread, as the concurrent benchmarks
+ * shouldn't share one connection.
+ */
+inline Client& ThreadClient() {
+  thread_local Client client;
+  if (!client.Connected()) {
+    VINEYARD_CHECK_OK(client.Connect(IPCSocket()));
+  }
+  return client;
+}
+
+// skips the benchmark if the status isn't ok, returns whether skipped.
+inline bool SkipOnError(benchmark::State& state, Status const& status) {
+  if (status.ok()) {
+    return false;
+  }
+  state.SkipWithError(status.ToString().c_str());
+  return true;
+}
+
+}  // namespace bench
+
+}  // namespace vineyard
+
+#endif  // BENCHMARK_BENCH_UTILS_H_
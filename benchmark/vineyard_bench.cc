@@ -0,0 +1,501 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+
+#include <signal.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "boost/algorithm/string.hpp"
+#include "gflags/gflags.h"
+
+#include "basic/stream/byte_stream.h"
+#include "client/client.h"
+#include "client/ds/blob.h"
+#include "client/rpc_client.h"
+#include "common/util/env.h"
+#include "common/util/flags.h"
+#include "common/util/json.h"
+#include "common/util/logging.h"
+#include "common/util/status.h"
+
+namespace vineyard {
+
+DEFINE_string(ipc_socket, "",
+              "IPC socket of vineyard server, defaults to "
+              "$VINEYARD_IPC_SOCKET");
+DEFINE_string(rpc_endpoint, "",
+              "RPC endpoint of vineyard server for the 'rpc_get_data' "
+              "operations, defaults to $VINEYARD_RPC_ENDPOINT");
+DEFINE_uint64(processes, 1, "Number of client processes on this node");
+DEFINE_uint64(duration, 10, "Seconds to generate the load");
+DEFINE_string(mix,
+              "create_data:4,get_data:8,rpc_get_data:0,persist:1,put_name:1,"
+              "del_data:3,stream:1",
+              "Weights of the operations, as 'operation:weight' pairs");
+DEFINE_uint64(blob_size, 4096, "Size of the blob of each object, in bytes");
+DEFINE_uint64(max_objects, 1024, "Maximum live objects of each process");
+DEFINE_string(format, "text", "Format of the report: text or json");
+
+namespace bench {
+
+enum Operation {
+  kCreateData = 0,
+  kGetData = 1,
+  kRPCGetData = 2,
+  kPersist = 3,
+  kPutName = 4,
+  kDelData = 5,
+  kStream = 6,
+  kOperations = 7,
+};
+
+static const char* operation_names[kOperations] = {
+    "create_data", "get_data", "rpc_get_data", "persist",
+    "put_name",    "del_data", "stream"};
+
+struct stats_t {
+  uint64_t errors = 0;
+  std::vector<int64_t> latencies;  // in nanoseconds
+};
+
+static Status parse_mix(std::string const& mix, std::vector<double>& weights) {
+  weights.assign(kOperations, 0);
+  std::vector<std::string> items;
+  boost::split(items, mix, boost::is_any_of(","));
+  for (auto const& item : items) {
+    if (item.empty()) {
+      continue;
+    }
+    auto pos = item.find(':');
+    std::string name = item.substr(0, pos);
+    auto iter = std::find(std::begin(operation_names),
+                          std::end(operation_names), name);
+    if (iter == std::end(operation_names)) {
+      return Status::Invalid("Unknown operation '" + name + "' in the mix");
+    }
+    double weight = 1;
+    if (pos != std::string::npos) {
+      try {
+        weight = std::stod(item.substr(pos + 1));
+      } catch (std::exception const&) {
+        return Status::Invalid("Invalid weight in the mix: '" + item + "'");
+      }
+    }
+    weights[iter - std::begin(operation_names)] = weight;
+  }
+  return Status::OK();
+}
+
+/**
+ * The worker runs in a client process, the objects it creates are only
+ * operated by itself.
+ */
+class Worker {
+ public:
+  explicit Worker(std::vector<double> const& weights)
+      : rng_(getpid()), operations_(weights.begin(), weights.end()) {}
+
+  Status Connect() {
+    RETURN_ON_ERROR(client_.Connect(FLAGS_ipc_socket));
+    if (!FLAGS_rpc_endpoint.empty()) {
+      RETURN_ON_ERROR(rpc_client_.Connect(FLAGS_rpc_endpoint));
+    }
+    return Status::OK();
+  }
+
+  void Run(std::chrono::steady_clock::time_point deadline,
+           std::vector<stats_t>& stats) {
+    stats.resize(kOperations);
+    while (std::chrono::steady_clock::now() < deadline) {
+      Operation operation = prepare(static_cast<Operation>(operations_(rng_)));
+      auto start = std::chrono::steady_clock::now();
+      auto status = run(operation);
+      auto elapsed = std::chrono::steady_clock::now() - start;
+      if (status.ok()) {
+        stats[operation].latencies.emplace_back(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed)
+                .count());
+      } else {
+        VLOG(2) << operation_names[operation] << ": " << status.ToString();
+        stats[operation].errors += 1;
+      }
+    }
+  }
+
+  // deletes the remaining objects
+  void Cleanup() {
+    while (!objects_.empty()) {
+      VINEYARD_DISCARD(delData());
+    }
+  }
+
+ private:
+  struct object_t {
+    ObjectID id;
+    bool persisted;
+    std::string name;
+  };
+
+  // falls back to create objects if there's nothing to operate on, and
+  // makes room for creating objects.
+  Operation prepare(Operation operation) {
+    if (operation == kRPCGetData && FLAGS_rpc_endpoint.empty()) {
+      operation = kGetData;
+    }
+    if (operation == kCreateData && objects_.size() >= FLAGS_max_objects) {
+      VINEYARD_DISCARD(delData());
+    }
+    if (operation != kCreateData && operation != kStream &&
+        objects_.empty()) {
+      operation = kCreateData;
+    }
+    if (operation == kRPCGetData) {
+      // the remote instance only sees the persisted objects
+      object_t& object = pick();
+      if (!object.persisted && client_.Persist(object.id).ok()) {
+        object.persisted = true;
+      }
+    }
+    return operation;
+  }
+
+  Status run(const Operation operation) {
+    switch (operation) {
+    case kCreateData:
+      return createData();
+    case kGetData: {
+      ObjectMeta meta;
+      return client_.GetMetaData(pick().id, meta);
+    }
+    case kRPCGetData: {
+      ObjectMeta meta;
+      return rpc_client_.GetMetaData(pick().id, meta, true);
+    }
+    case kPersist: {
+      object_t& object = pick();
+      RETURN_ON_ERROR(client_.Persist(object.id));
+      object.persisted = true;
+      return Status::OK();
+    }
+    case kPutName: {
+      object_t& object = pick();
+      if (!object.name.empty()) {
+        return Status::OK();
+      }
+      std::string name = "vineyard-bench-" + std::to_string(getpid()) + "-" +
+                         ObjectIDToString(object.id);
+      RETURN_ON_ERROR(client_.PutName(object.id, name));
+      object.name = name;
+      return Status::OK();
+    }
+    case kDelData:
+      return delData();
+    case kStream:
+      return stream();
+    default:
+      return Status::Invalid("Unknown operation");
+    }
+  }
+
+  object_t& pick() {
+    return objects_[std::uniform_int_distribution<size_t>(
+        0, objects_.size() - 1)(rng_)];
+  }
+
+  Status createData() {
+    std::unique_ptr<BlobWriter> writer;
+    RETURN_ON_ERROR(client_.CreateBlob(FLAGS_blob_size, writer));
+    auto blob = writer->Seal(client_);
+    ObjectMeta meta;
+    meta.SetTypeName("vineyard::bench::Object");
+    meta.AddMember("blob_", blob->id());
+    meta.AddKeyValue("nbytes", FLAGS_blob_size);
+    ObjectID id = InvalidObjectID();
+    RETURN_ON_ERROR(client_.CreateMetaData(meta, id));
+    objects_.emplace_back(object_t{id, false, ""});
+    return Status::OK();
+  }
+
+  Status delData() {
+    size_t index =
+        std::uniform_int_distribution<size_t>(0, objects_.size() - 1)(rng_);
+    object_t object = objects_[index];
+    objects_[index] = objects_.back();
+    objects_.pop_back();
+    if (!object.name.empty()) {
+      RETURN_ON_ERROR(client_.DropName(object.name));
+    }
+    return client_.DelData(object.id, true, true);
+  }
+
+  // a round-trip of one chunk through a stream
+  Status stream() {
+    ByteStreamBuilder builder(client_);
+    auto stream = std::dynamic_pointer_cast<ByteStream>(builder.Seal(client_));
+    std::unique_ptr<ByteStreamWriter> writer;
+    std::unique_ptr<ByteStreamReader> reader;
+    RETURN_ON_ERROR(stream->OpenWriter(client_, writer));
+    RETURN_ON_ERROR(stream->OpenReader(client_, reader));
+    std::unique_ptr<arrow::MutableBuffer> chunk;
+    RETURN_ON_ERROR(writer->GetNext(FLAGS_blob_size, chunk));
+    RETURN_ON_ERROR(writer->Finish());
+    std::unique_ptr<arrow::Buffer> received;
+    RETURN_ON_ERROR(reader->GetNext(received));
+    return client_.DelData(stream->id(), true, true);
+  }
+
+  Client client_;
+  RPCClient rpc_client_;
+  std::mt19937_64 rng_;
+  std::discrete_distribution<int> operations_;
+  std::vector<object_t> objects_;
+};
+
+static void write_all(int fd, const void* data, size_t size) {
+  auto ptr = static_cast<const char*>(data);
+  while (size > 0) {
+    ssize_t written = write(fd, ptr, size);
+    if (written <= 0) {
+      return;
+    }
+    ptr += written;
+    size -= written;
+  }
+}
+
+static bool read_all(int fd, void* data, size_t size) {
+  auto ptr = static_cast<char*>(data);
+  while (size > 0) {
+    ssize_t received = read(fd, ptr, size);
+    if (received <= 0) {
+      return false;
+    }
+    ptr += received;
+    size -= received;
+  }
+  return true;
+}
+
+// runs in the forked process, reports the stats to `result_fd`.
+static int run_worker(std::vector<double> const& weights, int start_fd,
+                      int result_fd) {
+  Worker worker(weights);
+  auto status = worker.Connect();
+  if (!status.ok()) {
+    LOG(ERROR) << "Failed to connect to vineyard: " << status.ToString();
+    return 1;
+  }
+  // waits until all processes are ready
+  char dummy;
+  read_all(start_fd, &dummy, 1);
+
+  std::vector<stats_t> stats;
+  worker.Run(std::chrono::steady_clock::now() +
+                 std::chrono::seconds(FLAGS_duration),
+             stats);
+  worker.Cleanup();
+
+  for (auto const& item : stats) {
+    uint64_t count = item.latencies.size();
+    write_all(result_fd, &item.errors, sizeof(uint64_t));
+    write_all(result_fd, &count, sizeof(uint64_t));
+    write_all(result_fd, item.latencies.data(), count * sizeof(int64_t));
+  }
+  return 0;
+}
+
+static double percentile(std::vector<int64_t> const& sorted,
+                         const double ratio) {
+  if (sorted.empty()) {
+    return 0;
+  }
+  size_t index = static_cast<size_t>(ratio * (sorted.size() - 1));
+  return sorted[index] / 1000.0;  // in microseconds
+}
+
+static void report(std::vector<stats_t>& stats, const double seconds) {
+  char hostname[256] = {0};
+  gethostname(hostname, sizeof(hostname) - 1);
+
+  json result;
+  result["host"] = hostname;
+  result["processes"] = FLAGS_processes;
+  result["duration"] = seconds;
+  uint64_t total = 0;
+  for (int index = 0; index < kOperations; ++index) {
+    auto& latencies = stats[index].latencies;
+    if (latencies.empty() && stats[index].errors == 0) {
+      continue;
+    }
+    std::sort(latencies.begin(), latencies.end());
+    double sum = 0;
+    for (auto latency : latencies) {
+      sum += latency;
+    }
+    json item;
+    item["count"] = latencies.size();
+    item["errors"] = stats[index].errors;
+    item["throughput"] = latencies.size() / seconds;
+    item["mean_us"] =
+        latencies.empty() ? 0 : sum / latencies.size() / 1000.0;
+    item["p50_us"] = percentile(latencies, 0.5);
+    item["p90_us"] = percentile(latencies, 0.9);
+    item["p99_us"] = percentile(latencies, 0.99);
+    item["p999_us"] = percentile(latencies, 0.999);
+    item["max_us"] = percentile(latencies, 1.0);
+    result["operations"][operation_names[index]] = item;
+    total += latencies.size();
+  }
+  result["throughput"] = total / seconds;
+
+  if (FLAGS_format == "json") {
+    std::cout << result.dump() << std::endl;
+    return;
+  }
+  std::cout << "host: " << hostname << ", processes: " << FLAGS_processes
+            << ", duration: " << seconds << "s, throughput: "
+            << result["throughput"].get<double>() << " ops/s" << std::endl;
+  for (auto const& item : result["operations"].items()) {
+    auto const& value = item.value();
+    std::cout << "  " << item.key() << ": count " << value["count"]
+              << ", errors " << value["errors"] << ", " << value["throughput"]
+              << " ops/s, mean " << value["mean_us"] << "us, p50 "
+              << value["p50_us"] << "us, p90 " << value["p90_us"]
+              << "us, p99 " << value["p99_us"] << "us, p999 "
+              << value["p999_us"] << "us, max " << value["max_us"] << "us"
+              << std::endl;
+  }
+}
+
+static int run(std::vector<double> const& weights) {
+  int start_pipe[2];
+  if (pipe(start_pipe) != 0) {
+    PLOG(ERROR) << "Failed to create pipe";
+    return 1;
+  }
+  std::vector<pid_t> pids;
+  std::vector<int> result_fds;
+  for (size_t index = 0; index < FLAGS_processes; ++index) {
+    int result_pipe[2];
+    if (pipe(result_pipe) != 0) {
+      PLOG(ERROR) << "Failed to create pipe";
+      return 1;
+    }
+    pid_t pid = fork();
+    if (pid == 0) {
+      close(start_pipe[1]);
+      close(result_pipe[0]);
+      for (int fd : result_fds) {
+        close(fd);
+      }
+      _exit(run_worker(weights, start_pipe[0], result_pipe[1]));
+    }
+    close(result_pipe[1]);
+    if (pid < 0) {
+      PLOG(ERROR) << "Failed to fork the client process";
+      close(result_pipe[0]);
+      break;
+    }
+    pids.emplace_back(pid);
+    result_fds.emplace_back(result_pipe[0]);
+  }
+  // starts the load in all processes, by closing the pipe
+  close(start_pipe[0]);
+  auto start = std::chrono::steady_clock::now();
+  close(start_pipe[1]);
+
+  std::vector<stats_t> stats(kOperations);
+  for (int fd : result_fds) {
+    for (auto& item : stats) {
+      uint64_t errors = 0, count = 0;
+      if (!read_all(fd, &errors, sizeof(uint64_t)) ||
+          !read_all(fd, &count, sizeof(uint64_t))) {
+        break;
+      }
+      size_t offset = item.latencies.size();
+      item.errors += errors;
+      item.latencies.resize(offset + count);
+      if (!read_all(fd, item.latencies.data() + offset,
+                    count * sizeof(int64_t))) {
+        item.latencies.resize(offset);
+        break;
+      }
+    }
+    close(fd);
+  }
+  int failed = 0;
+  for (pid_t pid : pids) {
+    int wstatus = 0;
+    waitpid(pid, &wstatus, 0);
+    if (!WIFEXITED(wstatus) || WEXITSTATUS(wstatus) != 0) {
+      failed += 1;
+    }
+  }
+  double seconds = std::min<double>(
+      FLAGS_duration,
+      std::chrono::duration<double>(std::chrono::steady_clock::now() - start)
+          .count());
+  if (failed > 0) {
+    LOG(ERROR) << failed << " of the " << pids.size()
+               << " client processes failed";
+  }
+  report(stats, seconds);
+  return failed == 0 ? 0 : 1;
+}
+
+}  // namespace bench
+
+}  // namespace vineyard
+
+int main(int argc, char** argv) {
+  sigset(SIGINT, SIG_DFL);
+  vineyard::logging::InitGoogleLogging("vineyard");
+  vineyard::flags::SetUsageMessage(
+      "Usage: vineyard-bench [options]\n\n"
+      "Generates the load against vineyardd from a number of client "
+      "processes, runs it on every node to load the whole cluster.");
+  vineyard::flags::ParseCommandLineNonHelpFlags(&argc, &argv, false);
+  if (FLAGS_help) {
+    FLAGS_help = false;
+    FLAGS_helpmatch = "vineyard";
+  }
+  vineyard::flags::HandleCommandLineHelpFlags();
+
+  if (vineyard::FLAGS_ipc_socket.empty()) {
+    vineyard::FLAGS_ipc_socket = vineyard::read_env("VINEYARD_IPC_SOCKET");
+  }
+  if (vineyard::FLAGS_rpc_endpoint.empty()) {
+    vineyard::FLAGS_rpc_endpoint = vineyard::read_env("VINEYARD_RPC_ENDPOINT");
+  }
+
+  std::vector<double> weights;
+  auto status = vineyard::bench::parse_mix(vineyard::FLAGS_mix, weights);
+  if (!status.ok()) {
+    LOG(ERROR) << status.ToString();
+    return 1;
+  }
+  return vineyard::bench::run(weights);
+}
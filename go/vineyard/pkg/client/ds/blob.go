@@ -12,34 +12,85 @@ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 See the License for the specific language governing permissions and
 limitations under the License.
 */
-
 package vineyard
 
 import (
 	"errors"
 	"fmt"
+
+	vineyard "github.com/v6d-io/v6d/go/vineyard/pkg/client"
 	"github.com/v6d-io/v6d/go/vineyard/pkg/common"
 	//x	"github.com/apache/arrow/go/arrow"
 )
 
+// Blob is a read-only view over the shared memory mapped by the client, no
+// bytes are copied and the view is valid until the client disconnects.
 type Blob struct {
-	id int
-	size int
+	id     common.ObjectID
+	size   int
 	buffer []byte
 }
 
+func NewBlob(id common.ObjectID, size int, buffer []byte) *Blob {
+	return &Blob{id: id, size: size, buffer: buffer}
+}
+
+// GetBlob gets the blob with the given id from vineyard, see also GetBlobs.
+func GetBlob(client *vineyard.IPCClient, id common.ObjectID) (*Blob, error) {
+	blobs, err := GetBlobs(client, []common.ObjectID{id})
+	if err != nil {
+		return nil, err
+	}
+	blob, ok := blobs[id]
+	if !ok {
+		return nil, &common.ReplyError{Code: common.KObjectNotExists, Type: common.GET_BUFFERS_REPLY,
+			Err: errors.New("buffer not exists: " + common.ObjectIDToString(id))}
+	}
+	return blob, nil
+}
+
+// GetBlobs gets the blobs with the given ids in a single round trip.
+func GetBlobs(client *vineyard.IPCClient, ids []common.ObjectID) (map[common.ObjectID]*Blob, error) {
+	buffers, err := client.GetBuffers(ids)
+	if err != nil {
+		return nil, err
+	}
+	blobs := make(map[common.ObjectID]*Blob, len(buffers))
+	for id, buffer := range buffers {
+		blobs[id] = NewBlob(id, buffer.Size, buffer.Data)
+	}
+	return blobs, nil
+}
+
+func (b *Blob) ID() common.ObjectID {
+	return b.id
+}
+
 func (b *Blob) Size() int {
 	return b.size
 }
 
 func (b *Blob) Data() ([]byte, error) {
 	if b.size > 0 && len(b.buffer) == 0 {
-		return nil, errors.New(fmt.Sprintf("The object might be a (partially) remote object " +
-		                    	"and the payload data is not locally available: %d", b.id))
+		return nil, errors.New(fmt.Sprintf("The object might be a (partially) remote object "+
+			"and the payload data is not locally available: %d", b.id))
 	}
 	return b.buffer, nil
 }
 
+// Slice returns a view of the blob's bytes in [begin, end) without copying.
+func (b *Blob) Slice(begin int, end int) ([]byte, error) {
+	data, err := b.Data()
+	if err != nil {
+		return nil, err
+	}
+	if begin < 0 || end < begin || end > len(data) {
+		return nil, errors.New(fmt.Sprintf("Slice [%d, %d) is out of the range of blob %d with size %d",
+			begin, end, b.id, b.size))
+	}
+	return data[begin:end:end], nil
+}
+
 type BufferSet struct {
 	//buffer arrow.
 }
@@ -48,10 +99,35 @@ func (b *BufferSet) EmplaceBuffer(id common.ObjectID) {
 
 }
 
+// BlobWriter is a writable view over a newly created blob in the shared
+// memory, the bytes written are visible to the server and other clients
+// without copying.
 type BlobWriter struct {
+	id     common.ObjectID
+	buffer []byte
+}
 
+func NewBlobWriter(id common.ObjectID, buffer []byte) *BlobWriter {
+	return &BlobWriter{id: id, buffer: buffer}
 }
 
+// CreateBlobWriter allocates a blob with the given size in vineyard.
+func CreateBlobWriter(client *vineyard.IPCClient, size int) (*BlobWriter, error) {
+	id, buffer, err := client.CreateBuffer(size)
+	if err != nil {
+		return nil, err
+	}
+	return NewBlobWriter(id, buffer), nil
+}
 
+func (w *BlobWriter) ID() common.ObjectID {
+	return w.id
+}
 
+func (w *BlobWriter) Size() int {
+	return len(w.buffer)
+}
 
+func (w *BlobWriter) Data() []byte {
+	return w.buffer
+}
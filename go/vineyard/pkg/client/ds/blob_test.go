@@ -0,0 +1,131 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+package vineyard
+
+import (
+	"testing"
+
+	vineyard "github.com/v6d-io/v6d/go/vineyard/pkg/client"
+	"github.com/v6d-io/v6d/go/vineyard/pkg/common"
+)
+
+// the sizes cover the small blobs that share a segment, and the large ones
+// that are likely to be placed in segments of their own.
+var blobSizes = []int{1, 100, 4096, 1 << 20, 16<<20 + 7}
+
+func valueAt(index int, offset int) byte {
+	return byte(offset*7 + index)
+}
+
+func connect(t *testing.T) *vineyard.IPCClient {
+	ipcAddr := "/var/run/vineyard.sock"
+	client := &vineyard.IPCClient{}
+	if err := client.Connect(ipcAddr); err != nil {
+		t.Fatal("connect to ipc server failed", err)
+	}
+	return client
+}
+
+func TestBlob_RoundTripAcrossClients(t *testing.T) {
+	writer := connect(t)
+	writers := make([]*BlobWriter, 0, len(blobSizes))
+	ids := make([]common.ObjectID, 0, len(blobSizes))
+	for index, size := range blobSizes {
+		blobWriter, err := CreateBlobWriter(writer, size)
+		if err != nil {
+			t.Fatal("create blob writer failed", err)
+		}
+		if blobWriter.Size() != size {
+			t.Fatal("the size of blob writer is not match")
+		}
+		data := blobWriter.Data()
+		for offset := range data {
+			data[offset] = valueAt(index, offset)
+		}
+		writers = append(writers, blobWriter)
+		ids = append(ids, blobWriter.ID())
+	}
+
+	// the blobs are mapped by another client, from the fds passed to it
+	reader := connect(t)
+	blobs, err := GetBlobs(reader, ids)
+	if err != nil {
+		t.Fatal("get blobs failed", err)
+	}
+	if len(blobs) != len(ids) {
+		t.Fatal("the number of blobs is not match")
+	}
+	for index, id := range ids {
+		blob, ok := blobs[id]
+		if !ok || blob.ID() != id || blob.Size() != blobSizes[index] {
+			t.Fatal("the blob is not found", common.ObjectIDToString(id))
+		}
+		data, err := blob.Data()
+		if err != nil {
+			t.Fatal("get the data of blob failed", err)
+		}
+		for offset := range data {
+			if data[offset] != valueAt(index, offset) {
+				t.Fatal("the content of blob is not match")
+			}
+		}
+		slice, err := blob.Slice(blob.Size()/2, blob.Size())
+		if err != nil || len(slice) != blob.Size()-blob.Size()/2 {
+			t.Fatal("slice the blob failed", err)
+		}
+		if _, err := blob.Slice(0, blob.Size()+1); err == nil {
+			t.Error("the out of range slice is not rejected")
+		}
+	}
+
+	// both clients map the same shared memory
+	writers[0].Data()[0] = 255
+	blob, err := GetBlob(reader, ids[0])
+	if err != nil {
+		t.Fatal("get blob failed", err)
+	}
+	if data, _ := blob.Data(); data[0] != 255 {
+		t.Error("the blob is not zero-copy")
+	}
+
+	// the segments are mapped again after reconnecting
+	if err := reader.Disconnect(); err != nil {
+		t.Error("disconnect ipc server failed", err.Error())
+	}
+	reader = connect(t)
+	blob, err = GetBlob(reader, ids[len(ids)-1])
+	if err != nil {
+		t.Fatal("get blob after reconnecting failed", err)
+	}
+	data, err := blob.Data()
+	if err != nil || len(data) != blobSizes[len(blobSizes)-1] {
+		t.Fatal("get the data of blob after reconnecting failed", err)
+	}
+	if data[len(data)-1] != valueAt(len(ids)-1, len(data)-1) {
+		t.Error("the content of blob after reconnecting is not match")
+	}
+
+	if _, err := GetBlob(reader, common.GenerateObjectID()); err == nil {
+		t.Error("get a blob that doesn't exist should fail")
+	}
+
+	if err := reader.Disconnect(); err != nil {
+		t.Error("disconnect ipc server failed", err.Error())
+	}
+	if err := writer.Disconnect(); err != nil {
+		t.Error("disconnect ipc server failed", err.Error())
+	}
+}
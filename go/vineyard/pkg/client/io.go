@@ -21,12 +21,17 @@ import (
 	"fmt"
 	"net"
 	"strconv"
+	"syscall"
 	"time"
 )
 
 const kNumConnectAttempts = 10
 const kConnectTimeoutMs = 1000
 
+// the server passes at most 253 (SCM_MAX_FD - 2) file descriptors in a
+// single message
+const kMaxFdsPerMessage = 253
+
 func ConnectIPCSocketRetry(pathname string, conn **net.UnixConn) error {
 	var numRetries int = kNumConnectAttempts
 	var timeout int64 = kConnectTimeoutMs
@@ -153,3 +158,51 @@ func RecvMessage(conn net.Conn, msg *string) error {
 	*msg = string(stringBytes)
 	return nil
 }
+
+// RecvFDs receives `count` file descriptors from the unix socket, the fds
+// may be passed by the server in one or more messages.
+func RecvFDs(conn *net.UnixConn, count int) ([]int, error) {
+	fds := make([]int, 0, count)
+	closeFDs := func() {
+		for _, fd := range fds {
+			syscall.Close(fd)
+		}
+	}
+	buf := make([]byte, 1)
+	oob := make([]byte, syscall.CmsgSpace(4*kMaxFdsPerMessage))
+	for len(fds) < count {
+		_, oobn, flags, _, err := conn.ReadMsgUnix(buf, oob)
+		if err != nil {
+			closeFDs()
+			return nil, errors.New(fmt.Sprintf("Receive file descriptors failed :%s", err.Error()))
+		}
+		if flags&syscall.MSG_CTRUNC != 0 {
+			closeFDs()
+			return nil, errors.New("Receive file descriptors failed: control message truncated")
+		}
+		messages, err := syscall.ParseSocketControlMessage(oob[:oobn])
+		if err != nil {
+			closeFDs()
+			return nil, err
+		}
+		received := 0
+		for _, message := range messages {
+			rights, err := syscall.ParseUnixRights(&message)
+			if err != nil {
+				continue
+			}
+			fds = append(fds, rights...)
+			received += len(rights)
+		}
+		if received == 0 {
+			closeFDs()
+			return nil, errors.New("Receive file descriptors failed: no file descriptor in the message")
+		}
+	}
+	if len(fds) > count {
+		closeFDs()
+		return nil, errors.New(fmt.Sprintf("Receive file descriptors failed: expect %d but got %d",
+			count, len(fds)))
+	}
+	return fds, nil
+}
@@ -17,10 +17,22 @@ package vineyard
 
 import (
 	"encoding/json"
-	"github.com/v6d-io/v6d/go/vineyard/pkg/common"
+	"errors"
+	"fmt"
 	"net"
+	"syscall"
+
+	"github.com/v6d-io/v6d/go/vineyard/pkg/common"
 )
 
+// Buffer is a view over the bytes of a blob in the shared memory, `Data` is
+// empty if the blob is not locally available.
+type Buffer struct {
+	ID   common.ObjectID
+	Size int
+	Data []byte
+}
+
 type IPCClient struct {
 	ClientBase
 	connected     bool
@@ -29,6 +41,11 @@ type IPCClient struct {
 	instanceID    int
 	serverVersion string
 	rpcEndpoint   string
+	// server fd -> the memory segment mapped from it, blobs are views over
+	// the mapped segments
+	mmapTable map[int][]byte
+	// server fd -> client fd, received but not mapped yet
+	receivedFDs map[int]int
 }
 
 // Connect to IPCClient steps as follows
@@ -67,15 +84,188 @@ func (i *IPCClient) Connect(ipcSocket string) error {
 		i.serverVersion = registerReply.Version
 	}
 	i.connected = true
+	i.ClientBase.connected = true
 	i.rpcEndpoint = registerReply.RPCEndpoint
 	// TODO: compatible server check
 	return nil
 }
 
-func (i *IPCClient) CreateBlob(size int, ) {
-	if i.connected == false {
-		return
+// Disconnect unmaps the shared memory, blobs got from the client are invalid
+// after that.
+func (i *IPCClient) Disconnect() error {
+	if err := i.ClientBase.Disconnect(); err != nil {
+		return err
+	}
+	for _, fd := range i.receivedFDs {
+		syscall.Close(fd)
+	}
+	i.receivedFDs = nil
+	for _, segment := range i.mmapTable {
+		syscall.Munmap(segment)
+	}
+	i.mmapTable = nil
+	i.connected = false
+	i.ipcSocket = ""
+	return nil
+}
+
+// CreateBuffer allocates a blob with the given size in the shared memory, and
+// returns a writable view over it.
+func (i *IPCClient) CreateBuffer(size int) (common.ObjectID, []byte, error) {
+	id := common.InvalidObjectID()
+	if !i.connected {
+		return id, nil, errors.New("the client is not connected to vineyard server")
+	}
+	var messageOut string
+	common.WriteCreateBufferRequest(uint64(size), &messageOut)
+	if err := i.DoWrite(messageOut); err != nil {
+		return id, nil, err
+	}
+	var messageIn string
+	if err := i.DoRead(&messageIn); err != nil {
+		return id, nil, err
+	}
+	var createBufferReply common.CreateBufferReply
+	if err := json.Unmarshal([]byte(messageIn), &createBufferReply); err != nil {
+		return id, nil, err
+	}
+	if createBufferReply.Code != 0 || createBufferReply.Type != common.CREATE_BUFFER_REPLY {
+		return id, nil, &common.ReplyError{Code: createBufferReply.Code, Type: createBufferReply.Type,
+			Err: errors.New(createBufferReply.Message)}
+	}
+	payload := &createBufferReply.Created
+	if payload.DataSize != int64(size) {
+		return id, nil, errors.New(fmt.Sprintf("expect a blob with size %d but got %d", size, payload.DataSize))
 	}
-	//var id common.ObjectID = common.InvalidObjectID()
+	buffer, err := i.mapPayload(payload)
+	if err != nil {
+		return id, nil, err
+	}
+	return createBufferReply.ID, buffer, nil
+}
 
+// GetBuffers gets the blobs with the given ids in a single round trip, the
+// buffers are views over the shared memory without copying.
+func (i *IPCClient) GetBuffers(ids []common.ObjectID) (map[common.ObjectID]Buffer, error) {
+	if !i.connected {
+		return nil, errors.New("the client is not connected to vineyard server")
+	}
+	buffers := make(map[common.ObjectID]Buffer)
+	if len(ids) == 0 {
+		return buffers, nil
+	}
+	var messageOut string
+	common.WriteGetBuffersRequest(ids, &messageOut)
+	if err := i.DoWrite(messageOut); err != nil {
+		return nil, err
+	}
+	var messageIn string
+	if err := i.DoRead(&messageIn); err != nil {
+		return nil, err
+	}
+	var getBuffersReply common.GetBuffersReply
+	if err := common.ReadGetBuffersReply(messageIn, &getBuffersReply); err != nil {
+		return nil, err
+	}
+	if getBuffersReply.Code != 0 || getBuffersReply.Type != common.GET_BUFFERS_REPLY {
+		return nil, &common.ReplyError{Code: getBuffersReply.Code, Type: getBuffersReply.Type,
+			Err: errors.New(getBuffersReply.Message)}
+	}
+	// the fds follow the reply on the socket, and must be received in the
+	// order of payloads.
+	if err := i.receiveFDs(getBuffersReply.Payloads); err != nil {
+		return nil, err
+	}
+	for idx := range getBuffersReply.Payloads {
+		payload := &getBuffersReply.Payloads[idx]
+		var buffer []byte
+		if payload.DataSize > 0 && !payload.IsDevice() {
+			var err error
+			if buffer, err = i.mapPayload(payload); err != nil {
+				return nil, err
+			}
+		}
+		buffers[payload.ID] = Buffer{ID: payload.ID, Size: int(payload.DataSize), Data: buffer}
+	}
+	return buffers, nil
+}
+
+// receiveFDs receives the fds of segments that haven't been mapped yet, the
+// server sends each fd once over the connection.
+func (i *IPCClient) receiveFDs(payloads []common.Payload) error {
+	var fds []int
+	pending := make(map[int]bool)
+	for _, payload := range payloads {
+		fd := payload.StoreFD
+		if payload.DataSize <= 0 || fd == -1 || payload.IsDevice() || pending[fd] {
+			continue
+		}
+		if _, ok := i.mmapTable[fd]; ok {
+			continue
+		}
+		if _, ok := i.receivedFDs[fd]; ok {
+			continue
+		}
+		pending[fd] = true
+		fds = append(fds, fd)
+	}
+	if len(fds) == 0 {
+		return nil
+	}
+	clientFDs, err := RecvFDs(i.conn, len(fds))
+	if err != nil {
+		return err
+	}
+	if i.receivedFDs == nil {
+		i.receivedFDs = make(map[int]int)
+	}
+	for idx, fd := range fds {
+		i.receivedFDs[fd] = clientFDs[idx]
+	}
+	return nil
+}
+
+// mapPayload returns the bytes of the payload as a view over the segment it
+// lives in, the segment is mapped on first access.
+func (i *IPCClient) mapPayload(payload *common.Payload) ([]byte, error) {
+	if payload.DataSize <= 0 {
+		return []byte{}, nil
+	}
+	if payload.IsDevice() || payload.StoreFD == -1 {
+		return nil, errors.New("Device blobs cannot be mapped as shared memory")
+	}
+	segment, ok := i.mmapTable[payload.StoreFD]
+	if !ok {
+		if err := i.receiveFDs([]common.Payload{*payload}); err != nil {
+			return nil, err
+		}
+		clientFD := i.receivedFDs[payload.StoreFD]
+		delete(i.receivedFDs, payload.StoreFD)
+		// fake_mmap in malloc.h leaves a gap between memory segments, and
+		// segments backed by huge pages must be mapped with aligned lengths.
+		length := payload.MapSize - 8
+		if payload.PageSize > 0 {
+			length = (length + payload.PageSize - 1) / payload.PageSize * payload.PageSize
+		}
+		// the segment is mapped as writable once, it is shared by blobs that
+		// are created and got by the client.
+		var err error
+		segment, err = syscall.Mmap(clientFD, 0, int(length),
+			syscall.PROT_READ|syscall.PROT_WRITE, syscall.MAP_SHARED)
+		syscall.Close(clientFD)
+		if err != nil {
+			return nil, errors.New(fmt.Sprintf("Failed to mmap received fd: %s", err.Error()))
+		}
+		if i.mmapTable == nil {
+			i.mmapTable = make(map[int][]byte)
+		}
+		i.mmapTable[payload.StoreFD] = segment
+	}
+	begin, end := payload.DataOffset, payload.DataOffset+payload.DataSize
+	if begin < 0 || end > int64(len(segment)) {
+		return nil, errors.New(fmt.Sprintf("Blob %s is out of the range of the mapped segment",
+			common.ObjectIDToString(payload.ID)))
+	}
+	// the capacity is limited so appends won't overwrite the neighbours
+	return segment[begin:end:end], nil
 }
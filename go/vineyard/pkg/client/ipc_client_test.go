@@ -103,3 +103,42 @@ func TestIPCClient_GetName(t *testing.T) {
 		t.Error("disconnect ipc server failed", err.Error())
 	}
 }
+
+func TestIPCClient_CreateAndGetBuffer(t *testing.T) {
+	ipcAddr := "/var/run/vineyard.sock"
+	ipcServer := IPCClient{}
+	err := ipcServer.Connect(ipcAddr)
+	if err != nil {
+		t.Error("connect to ipc server failed", err)
+	}
+	id, data, err := ipcServer.CreateBuffer(1024)
+	if err != nil {
+		t.Fatal("create buffer failed", err)
+	}
+	for idx := range data {
+		data[idx] = byte(idx % 256)
+	}
+	buffers, err := ipcServer.GetBuffers([]common.ObjectID{id})
+	if err != nil {
+		t.Fatal("get buffers failed", err)
+	}
+	buffer, ok := buffers[id]
+	if !ok || buffer.Size != 1024 || len(buffer.Data) != 1024 {
+		t.Fatal("the created buffer is not found")
+	}
+	for idx := range buffer.Data {
+		if buffer.Data[idx] != byte(idx%256) {
+			t.Fatal("the content of buffer is not match")
+		}
+	}
+	// the buffer is a view over the same shared memory
+	data[0] = 255
+	if buffer.Data[0] != 255 {
+		t.Error("the buffer is not zero-copy")
+	}
+	t.Log("create buffer and get buffers success!")
+
+	if err := ipcServer.Disconnect(); err != nil {
+		t.Error("disconnect ipc server failed", err.Error())
+	}
+}
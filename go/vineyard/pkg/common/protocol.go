@@ -17,6 +17,7 @@ package common
 
 import (
 	"encoding/json"
+	"strconv"
 )
 
 const (
@@ -30,6 +31,10 @@ const (
 	GET_NAME_REPLY         = "get_name_reply"
 	DROP_NAME_REQUEST      = "drop_name_request"
 	DROP_NAME_REPLY        = "drop_name_reply"
+	CREATE_BUFFER_REQUEST  = "create_buffer_request"
+	CREATE_BUFFER_REPLY    = "create_buffer_reply"
+	GET_BUFFERS_REQUEST    = "get_buffers_request"
+	GET_BUFFERS_REPLY      = "get_buffers_reply"
 	DEFAULT_SERVER_VERSION = "0.0.0"
 )
 
@@ -93,6 +98,45 @@ type DropNameReply struct {
 	Code int    `json:"code"`
 }
 
+// Payload describes where a blob lives in the shared memory, the blob is
+// mapped by the client from the segment `StoreFD` refers to.
+type Payload struct {
+	ID         ObjectID `json:"object_id"`
+	StoreFD    int      `json:"store_fd"`
+	DataOffset int64    `json:"data_offset"`
+	DataSize   int64    `json:"data_size"`
+	MapSize    int64    `json:"map_size"`
+	PageSize   int64    `json:"page_size,omitempty"`
+	NumaNode   int      `json:"numa_node,omitempty"`
+	Device     *int     `json:"device,omitempty"`
+}
+
+// IsDevice tells whether the blob lives in device memory, which cannot be
+// mapped as shared memory.
+func (p *Payload) IsDevice() bool {
+	return p.Device != nil && *p.Device >= 0
+}
+
+type CreateBufferRequest struct {
+	Type string `json:"type"`
+	Size uint64 `json:"size"`
+}
+
+type CreateBufferReply struct {
+	Type    string   `json:"type"`
+	Code    int      `json:"code"`
+	Message string   `json:"message,omitempty"`
+	ID      ObjectID `json:"id"`
+	Created Payload  `json:"created"`
+}
+
+type GetBuffersReply struct {
+	Type     string
+	Code     int
+	Message  string
+	Payloads []Payload
+}
+
 func encodeMsg(data interface{}, msg *string) error {
 	msgBytes, err := json.Marshal(data)
 	if err != nil {
@@ -150,3 +194,60 @@ func WriteDropNameRequest(name string, msg *string) {
 
 	encodeMsg(dropNameReq, msg)
 }
+
+func WriteCreateBufferRequest(size uint64, msg *string) {
+	var createBufferReq CreateBufferRequest
+	createBufferReq.Type = CREATE_BUFFER_REQUEST
+	createBufferReq.Size = size
+
+	encodeMsg(createBufferReq, msg)
+}
+
+// WriteGetBuffersRequest encodes the ids as index-keyed members, as the
+// server expects.
+func WriteGetBuffersRequest(ids []ObjectID, msg *string) {
+	getBuffersReq := make(map[string]interface{})
+	getBuffersReq["type"] = GET_BUFFERS_REQUEST
+	for idx, id := range ids {
+		getBuffersReq[strconv.Itoa(idx)] = id
+	}
+	getBuffersReq["num"] = len(ids)
+
+	encodeMsg(getBuffersReq, msg)
+}
+
+func ReadGetBuffersReply(msg string, reply *GetBuffersReply) error {
+	var root map[string]json.RawMessage
+	if err := json.Unmarshal([]byte(msg), &root); err != nil {
+		return err
+	}
+	if value, ok := root["type"]; ok {
+		if err := json.Unmarshal(value, &reply.Type); err != nil {
+			return err
+		}
+	}
+	if value, ok := root["code"]; ok {
+		if err := json.Unmarshal(value, &reply.Code); err != nil {
+			return err
+		}
+	}
+	if value, ok := root["message"]; ok {
+		if err := json.Unmarshal(value, &reply.Message); err != nil {
+			return err
+		}
+	}
+	if reply.Code != KOK || reply.Type != GET_BUFFERS_REPLY {
+		return nil
+	}
+	var num int
+	if err := json.Unmarshal(root["num"], &num); err != nil {
+		return err
+	}
+	reply.Payloads = make([]Payload, num)
+	for idx := 0; idx < num; idx++ {
+		if err := json.Unmarshal(root[strconv.Itoa(idx)], &reply.Payloads[idx]); err != nil {
+			return err
+		}
+	}
+	return nil
+}
@@ -19,6 +19,8 @@ limitations under the License.
 #include <string.h>
 #include <sys/mman.h>
 
+#include <vector>
+
 #include "vineyard/common/memory/fling.h"
 
 /*
@@ -43,18 +45,74 @@ JNIEXPORT jint JNICALL Java_io_v6d_core_common_memory_ffi_Fling_recvFD
 
 /*
  * Class:     io_v6d_core_common_memory_ffi_Fling
- * Method:    mapSharedMem
- * Signature: (IJZZ)J
+ * Method:    recvFDs
+ * Signature: (II)[I
  */
-JNIEXPORT jlong JNICALL Java_io_v6d_core_common_memory_ffi_Fling_mapSharedMem
-  (JNIEnv *, jclass, jint fd, jlong map_size, jboolean readonly, jboolean realign) {
+JNIEXPORT jintArray JNICALL Java_io_v6d_core_common_memory_ffi_Fling_recvFDs
+  (JNIEnv *env, jclass, jint conn, jint count) {
+  std::vector<int> fds(count);
+  if (recv_fds(conn, fds.data(), fds.size()) < 0) {
+    return nullptr;
+  }
+  jintArray result = env->NewIntArray(count);
+  if (result != nullptr) {
+    env->SetIntArrayRegion(result, 0, count, fds.data());
+  }
+  return result;
+}
+
+// The mapped length of a segment, see also `MmapEntry` in the C++ client:
+// fake_mmap in malloc.h leaves a gap between memory segments, and segments
+// backed by huge pages must be mapped (and unmapped) with aligned lengths.
+static size_t mapped_length(jlong map_size, jlong page_size, jboolean realign) {
   size_t length = map_size;
   if (realign == JNI_TRUE) {
     length -= sizeof(size_t);
   }
+  if (page_size > 0) {
+    length = (length + page_size - 1) / page_size * page_size;
+  }
+  return length;
+}
+
+/*
+ * Class:     io_v6d_core_common_memory_ffi_Fling
+ * Method:    mapSharedMem
+ * Signature: (IJJZZ)J
+ */
+JNIEXPORT jlong JNICALL Java_io_v6d_core_common_memory_ffi_Fling_mapSharedMem
+  (JNIEnv *, jclass, jint fd, jlong map_size, jlong page_size, jboolean readonly,
+   jboolean realign) {
+  size_t length = mapped_length(map_size, page_size, realign);
   void *pointer = mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
   if (pointer == MAP_FAILED) {
     fprintf(stderr, "mmap failed: errno = %d: %s\n", errno, strerror(errno));
   }
   return reinterpret_cast<jlong>(pointer);
 }
+
+/*
+ * Class:     io_v6d_core_common_memory_ffi_Fling
+ * Method:    unmapSharedMem
+ * Signature: (JJJZ)I
+ */
+JNIEXPORT jint JNICALL Java_io_v6d_core_common_memory_ffi_Fling_unmapSharedMem
+  (JNIEnv *, jclass, jlong pointer, jlong map_size, jlong page_size,
+   jboolean realign) {
+  size_t length = mapped_length(map_size, page_size, realign);
+  int ret = munmap(reinterpret_cast<void *>(pointer), length);
+  if (ret != 0) {
+    fprintf(stderr, "munmap failed: errno = %d: %s\n", errno, strerror(errno));
+  }
+  return ret;
+}
+
+/*
+ * Class:     io_v6d_core_common_memory_ffi_Fling
+ * Method:    asDirectBuffer
+ * Signature: (JJ)Ljava/nio/ByteBuffer;
+ */
+JNIEXPORT jobject JNICALL Java_io_v6d_core_common_memory_ffi_Fling_asDirectBuffer
+  (JNIEnv *env, jclass, jlong pointer, jlong size) {
+  return env->NewDirectByteBuffer(reinterpret_cast<void *>(pointer), size);
+}
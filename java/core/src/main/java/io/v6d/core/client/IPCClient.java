@@ -22,13 +22,17 @@ import com.google.common.io.LittleEndianDataInputStream;
 import com.google.common.io.LittleEndianDataOutputStream;
 import io.v6d.core.client.ds.Buffer;
 import io.v6d.core.client.ds.ObjectMeta;
+import io.v6d.core.common.memory.Payload;
 import io.v6d.core.common.memory.ffi.Fling;
 import io.v6d.core.common.util.ObjectID;
 import io.v6d.core.common.util.Protocol.*;
 import io.v6d.core.common.util.VineyardException;
 import java.io.*;
 import java.nio.channels.Channels;
+import java.util.ArrayList;
 import java.util.HashMap;
+import java.util.HashSet;
+import java.util.List;
 import java.util.Map;
 import java.util.Set;
 import jnr.unixsocket.UnixSocketAddress;
@@ -46,12 +50,14 @@ public class IPCClient extends Client {
     private LittleEndianDataInputStream reader_;
     private ObjectMapper mapper_;
 
-    private Map<Integer, Long> mmap_table;
+    private Map<Integer, MmapEntry> mmap_table;
+    private Map<Integer, Integer> received_fds;
 
     public IPCClient() throws VineyardException {
         mapper_ = new ObjectMapper();
         mapper_.configure(SerializationFeature.INDENT_OUTPUT, false);
         mmap_table = new HashMap<>();
+        received_fds = new HashMap<>();
         this.connect(System.getenv("VINEYARD_IPC_SOCKET"));
     }
 
@@ -59,6 +65,7 @@ public class IPCClient extends Client {
         mapper_ = new ObjectMapper();
         mapper_.configure(SerializationFeature.INDENT_OUTPUT, false);
         mmap_table = new HashMap<>();
+        received_fds = new HashMap<>();
         this.connect(ipc_socket);
     }
 
@@ -150,11 +157,18 @@ public class IPCClient extends Client {
         this.doWrite(root);
         val reply = new GetBuffersReply();
         reply.Get(this.doReadJson());
+        this.receiveFDs(reply.getPayloads());
         Map<ObjectID, Buffer> buffers = new HashMap<>();
         for (val payload : reply.getPayloads()) {
             val buffer = new Buffer();
             if (payload.getDataSize() > 0) {
-                long pointer = this.mmap(payload.getStoreFD(), payload.getMapSize(), true, true);
+                long pointer =
+                        this.mmap(
+                                payload.getStoreFD(),
+                                payload.getMapSize(),
+                                payload.getPageSize(),
+                                true,
+                                true);
                 buffer.setPointer(pointer + payload.getDataOffset());
                 buffer.setSize(payload.getDataSize());
             }
@@ -163,23 +177,87 @@ public class IPCClient extends Client {
         return buffers;
     }
 
-    private long mmap(int fd, long mapSize, boolean readonly, boolean realign)
+    private long mmap(int fd, long mapSize, long pageSize, boolean readonly, boolean realign)
             throws VineyardException {
         if (mmap_table.containsKey(fd)) {
-            return mmap_table.get(fd);
+            return mmap_table.get(fd).pointer;
         }
-        int client_fd = Fling.recvFD(this.channel_.getFD());
-        long pointer = Fling.mapSharedMem(client_fd, mapSize, readonly, realign);
+        int client_fd;
+        if (received_fds.containsKey(fd)) {
+            client_fd = received_fds.remove(fd);
+        } else {
+            client_fd = Fling.recvFD(this.channel_.getFD());
+        }
+        if (client_fd < 0) {
+            throw new VineyardException.IOError("Failed to receive the fd " + fd);
+        }
+        long pointer = Fling.mapSharedMem(client_fd, mapSize, pageSize, readonly, realign);
         if (pointer == -1) {
             throw new VineyardException.UnknownError("mmap failed for fd " + fd);
         }
-        mmap_table.put(fd, pointer);
+        mmap_table.put(fd, new MmapEntry(pointer, mapSize, pageSize, realign));
         return pointer;
     }
 
-    private long unmap(int fd) {
-        // TODO
-        return -1;
+    /**
+     * The server passes the fds of a reply in as few messages as possible, thus receive them in
+     * one go (in the order of payloads) before mapping.
+     */
+    private void receiveFDs(List<Payload> payloads) throws VineyardException {
+        List<Integer> fds = new ArrayList<>();
+        Set<Integer> pending = new HashSet<>();
+        for (val payload : payloads) {
+            int fd = payload.getStoreFD();
+            if (payload.getDataSize() > 0
+                    && fd != -1
+                    && !mmap_table.containsKey(fd)
+                    && !received_fds.containsKey(fd)
+                    && pending.add(fd)) {
+                fds.add(fd);
+            }
+        }
+        if (fds.size() <= 1) {
+            // a single fd is received on demand in `mmap`
+            return;
+        }
+        val client_fds = Fling.recvFDs(this.channel_.getFD(), fds.size());
+        if (client_fds == null) {
+            throw new VineyardException.IOError("Failed to receive the fds of buffers");
+        }
+        for (int index = 0; index < fds.size(); ++index) {
+            received_fds.put(fds.get(index), client_fds[index]);
+        }
+    }
+
+    private int unmap(int fd) {
+        val entry = mmap_table.remove(fd);
+        if (entry == null) {
+            return -1;
+        }
+        // n.b.: the length must be the same as mapped, see also `Fling.mapSharedMem`
+        return Fling.unmapSharedMem(entry.pointer, entry.mapSize, entry.pageSize, entry.realign);
+    }
+
+    @Override
+    public synchronized void disconnect() {
+        for (val fd : new ArrayList<>(mmap_table.keySet())) {
+            this.unmap(fd);
+        }
+    }
+
+    /** The mapped segments, the arguments are kept for unmapping. */
+    private static class MmapEntry {
+        final long pointer;
+        final long mapSize;
+        final long pageSize;
+        final boolean realign;
+
+        MmapEntry(long pointer, long mapSize, long pageSize, boolean realign) {
+            this.pointer = pointer;
+            this.mapSize = mapSize;
+            this.pageSize = pageSize;
+            this.realign = realign;
+        }
     }
 
     @SneakyThrows(IOException.class)
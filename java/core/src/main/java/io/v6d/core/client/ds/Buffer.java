@@ -14,6 +14,8 @@
  */
 package io.v6d.core.client.ds;
 
+import io.v6d.core.common.memory.ffi.Fling;
+import java.nio.ByteBuffer;
 import lombok.Data;
 import lombok.EqualsAndHashCode;
 
@@ -36,4 +38,12 @@ public class Buffer {
     public boolean isNull() {
         return this.size == 0;
     }
+
+    /** View the buffer as an off-heap byte buffer, the content is not copied. */
+    public ByteBuffer asByteBuffer() {
+        if (this.isNull()) {
+            return ByteBuffer.allocateDirect(0);
+        }
+        return Fling.asDirectBuffer(this.pointer, this.size);
+    }
 }
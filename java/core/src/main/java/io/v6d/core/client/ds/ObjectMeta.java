@@ -126,6 +126,23 @@ public class ObjectMeta {
         return this.meta.get(key);
     }
 
+    public boolean hasMember(String key) {
+        val member = this.meta.get(key);
+        return member != null && member.isObject();
+    }
+
+    /** Get the metadata of the member, which shares the buffers with this object. */
+    public ObjectMeta getMemberMeta(String key) throws VineyardException {
+        if (!this.hasMember(key)) {
+            throw new VineyardException.ObjectNotExists("Member not found: " + key);
+        }
+        val metadata = new ObjectMeta();
+        metadata.meta = (ObjectNode) this.meta.get(key);
+        metadata.instanceID = this.instanceID;
+        metadata.buffers = this.buffers;
+        return metadata;
+    }
+
     @Override
     public String toString() {
         return "ObjectMeta{"
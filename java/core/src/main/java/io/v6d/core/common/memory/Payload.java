@@ -30,6 +30,7 @@ public class Payload {
     @JsonProperty private long dataOffset;
     @JsonProperty private long dataSize;
     @JsonProperty private long mapSize;
+    @JsonProperty private long pageSize;
     @JsonProperty private long pointer; // uint8_t *
 
     private Payload() {
@@ -39,6 +40,7 @@ public class Payload {
         this.dataOffset = 0;
         this.dataSize = 0;
         this.mapSize = 0;
+        this.pageSize = 0;
         this.pointer = 0;
     }
 
@@ -61,6 +63,7 @@ public class Payload {
         this.dataOffset = dataOffset;
         this.dataSize = dataSize;
         this.mapSize = mapSize;
+        this.pageSize = 0;
         this.pointer = pointer;
     }
 
@@ -77,6 +80,7 @@ public class Payload {
         this.dataOffset = dataOffset;
         this.dataSize = dataSize;
         this.mapSize = mapSize;
+        this.pageSize = 0;
         this.pointer = pointer;
     }
 
@@ -87,6 +91,9 @@ public class Payload {
         payload.dataOffset = root.get("data_offset").asLong();
         payload.dataSize = root.get("data_size").asLong();
         payload.mapSize = root.get("map_size").asLong();
+        if (root.has("page_size")) {
+            payload.pageSize = root.get("page_size").asLong();
+        }
         return payload;
     }
 }
@@ -15,6 +15,7 @@
 package io.v6d.core.common.memory.ffi;
 
 import io.v6d.core.FFI;
+import java.nio.ByteBuffer;
 
 public class Fling {
     static {
@@ -25,5 +26,24 @@ public class Fling {
 
     public static native int recvFD(int socket);
 
-    public static native long mapSharedMem(int fd, long mapSize, boolean readonly, boolean realign);
+    /**
+     * Receive exactly `count` file descriptors, which may be passed in one or more messages.
+     *
+     * @return The received fds, or null on failure.
+     */
+    public static native int[] recvFDs(int socket, int count);
+
+    /**
+     * Map the segment, the length is rounded up to the page size of segments that are backed by
+     * huge pages.
+     */
+    public static native long mapSharedMem(
+            int fd, long mapSize, long pageSize, boolean readonly, boolean realign);
+
+    /** Unmap the segment mapped by `mapSharedMem` with the same arguments. */
+    public static native int unmapSharedMem(
+            long pointer, long mapSize, long pageSize, boolean realign);
+
+    /** Wrap the (mapped) memory region as a direct byte buffer, without copying. */
+    public static native ByteBuffer asDirectBuffer(long pointer, long size);
 }
@@ -0,0 +1,39 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+package io.v6d.modules.basic.arrow;
+
+import io.v6d.core.client.ds.ObjectFactory;
+import org.apache.arrow.memory.BufferAllocator;
+import org.apache.arrow.memory.RootAllocator;
+
+/**
+ * Resolves vineyard's arrow objects as arrow java vectors, the buffers of vectors refer the
+ * shared memory directly.
+ */
+public class Arrow {
+    /** Allocates the (small) buffers that are not shared, e.g., the all-valid bitmaps. */
+    public static final BufferAllocator default_allocator = new RootAllocator();
+
+    public static void instantiate() {
+        instantiate(ObjectFactory.getFactory());
+    }
+
+    public static void instantiate(ObjectFactory factory) {
+        factory.register("vineyard::Blob", new BufferResolver());
+        factory.register("vineyard::SchemaProxy", new SchemaResolver());
+        factory.register("vineyard::RecordBatch", new RecordBatchResolver());
+        factory.register("vineyard::Table", new TableResolver());
+    }
+}
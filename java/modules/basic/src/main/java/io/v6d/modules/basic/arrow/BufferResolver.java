@@ -24,6 +24,12 @@ public class BufferResolver extends ObjectFactory.Resolver {
     @Override
     public Object resolve(ObjectMeta metadata) {
         val buffer = metadata.getBuffer(metadata.id());
-        return new ArrowBuf(ReferenceManager.NO_OP, null, buffer.getSize(), buffer.getPointer());
+        if (buffer == null || buffer.isNull()) {
+            return new ArrowBuf(ReferenceManager.NO_OP, null, 0, 0);
+        }
+        val arrowBuf =
+                new ArrowBuf(ReferenceManager.NO_OP, null, buffer.getSize(), buffer.getPointer());
+        arrowBuf.writerIndex(buffer.getSize());
+        return arrowBuf;
     }
 }
@@ -0,0 +1,90 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+package io.v6d.modules.basic.arrow;
+
+import io.v6d.core.client.ds.ObjectFactory;
+import io.v6d.core.client.ds.ObjectMeta;
+import io.v6d.core.common.util.VineyardException;
+import java.util.ArrayList;
+import java.util.List;
+import lombok.SneakyThrows;
+import lombok.val;
+import org.apache.arrow.memory.ArrowBuf;
+import org.apache.arrow.vector.VectorLoader;
+import org.apache.arrow.vector.VectorSchemaRoot;
+import org.apache.arrow.vector.ipc.message.ArrowFieldNode;
+import org.apache.arrow.vector.ipc.message.ArrowRecordBatch;
+
+/**
+ * Resolves a vineyard::RecordBatch as a {@link VectorSchemaRoot}, the vectors are loaded from the
+ * blobs without copying.
+ */
+public class RecordBatchResolver extends ObjectFactory.Resolver {
+    private final BufferResolver bufferResolver = new BufferResolver();
+
+    @Override
+    @SneakyThrows(VineyardException.class)
+    public Object resolve(ObjectMeta metadata) {
+        val schema = SchemaResolver.resolveSchema(metadata.getMemberMeta("schema_"));
+        val root = VectorSchemaRoot.create(schema, Arrow.default_allocator);
+
+        List<ArrowFieldNode> nodes = new ArrayList<>();
+        List<ArrowBuf> buffers = new ArrayList<>();
+        val columns = metadata.getIntValue("__columns_-size");
+        for (int index = 0; index < columns; ++index) {
+            collect(metadata.getMemberMeta("__columns_-" + index), nodes, buffers);
+        }
+        val rows = metadata.getIntValue("row_num_");
+        try (val batch = new ArrowRecordBatch(rows, nodes, buffers)) {
+            new VectorLoader(root).load(batch);
+        }
+        return root;
+    }
+
+    /** Collect the field nodes and buffers of the array in the order of arrow's IPC format. */
+    private void collect(ObjectMeta array, List<ArrowFieldNode> nodes, List<ArrowBuf> buffers)
+            throws VineyardException {
+        val typename = array.typename();
+        val length = array.getLongValue("length_");
+        if (typename.equals("vineyard::NullArray")) {
+            nodes.add(new ArrowFieldNode(length, length));
+            return;
+        }
+        if (array.getLongValue("offset_") != 0) {
+            throw new VineyardException.NotImplemented(
+                    "Sliced arrays (with non-zero offsets) are not supported: " + array.id());
+        }
+        nodes.add(new ArrowFieldNode(length, array.getLongValue("null_count_")));
+        buffers.add(buffer(array, "null_bitmap_"));
+        if (typename.startsWith("vineyard::NumericArray<")
+                || typename.equals("vineyard::BooleanArray")
+                || typename.equals("vineyard::FixedSizeBinaryArray")) {
+            buffers.add(buffer(array, "buffer_"));
+        } else if (typename.endsWith("StringArray") || typename.endsWith("BinaryArray")) {
+            buffers.add(buffer(array, "buffer_offsets_"));
+            buffers.add(buffer(array, "buffer_data_"));
+        } else if (typename.endsWith("ListArray")) {
+            buffers.add(buffer(array, "buffer_offsets_"));
+            collect(array.getMemberMeta("values_"), nodes, buffers);
+        } else {
+            throw new VineyardException.NotImplemented(
+                    "Unsupported array type '" + typename + "' of " + array.id());
+        }
+    }
+
+    private ArrowBuf buffer(ObjectMeta array, String name) throws VineyardException {
+        return (ArrowBuf) bufferResolver.resolve(array.getMemberMeta(name));
+    }
+}
@@ -0,0 +1,45 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+package io.v6d.modules.basic.arrow;
+
+import io.v6d.core.client.ds.ObjectFactory;
+import io.v6d.core.client.ds.ObjectMeta;
+import io.v6d.core.common.util.VineyardException;
+import java.io.IOException;
+import lombok.SneakyThrows;
+import lombok.val;
+import org.apache.arrow.vector.ipc.ReadChannel;
+import org.apache.arrow.vector.ipc.message.MessageSerializer;
+import org.apache.arrow.vector.types.pojo.Schema;
+import org.apache.arrow.vector.util.ByteArrayReadableSeekableByteChannel;
+
+/** Resolves the schema that been serialized in arrow's IPC format. */
+public class SchemaResolver extends ObjectFactory.Resolver {
+    @Override
+    @SneakyThrows({IOException.class, VineyardException.class})
+    public Object resolve(ObjectMeta metadata) {
+        val member = metadata.getMemberMeta("buffer_");
+        val buffer = metadata.getBuffer(member.id());
+        val content = buffer.asByteBuffer();
+        val bytes = new byte[content.remaining()];
+        content.get(bytes);
+        return MessageSerializer.deserializeSchema(
+                new ReadChannel(new ByteArrayReadableSeekableByteChannel(bytes)));
+    }
+
+    public static Schema resolveSchema(ObjectMeta metadata) {
+        return (Schema) new SchemaResolver().resolve(metadata);
+    }
+}
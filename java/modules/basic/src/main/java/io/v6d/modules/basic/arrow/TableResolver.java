@@ -0,0 +1,42 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+package io.v6d.modules.basic.arrow;
+
+import io.v6d.core.client.ds.ObjectFactory;
+import io.v6d.core.client.ds.ObjectMeta;
+import io.v6d.core.common.util.VineyardException;
+import java.util.ArrayList;
+import java.util.List;
+import lombok.SneakyThrows;
+import lombok.val;
+import org.apache.arrow.vector.VectorSchemaRoot;
+
+/** Resolves a vineyard::Table as a list of {@link VectorSchemaRoot}, one for each batch. */
+public class TableResolver extends ObjectFactory.Resolver {
+    private final RecordBatchResolver batchResolver = new RecordBatchResolver();
+
+    @Override
+    @SneakyThrows(VineyardException.class)
+    public Object resolve(ObjectMeta metadata) {
+        List<VectorSchemaRoot> batches = new ArrayList<>();
+        val size = metadata.getIntValue("__batches_-size");
+        for (int index = 0; index < size; ++index) {
+            batches.add(
+                    (VectorSchemaRoot)
+                            batchResolver.resolve(metadata.getMemberMeta("__batches_-" + index)));
+        }
+        return batches;
+    }
+}
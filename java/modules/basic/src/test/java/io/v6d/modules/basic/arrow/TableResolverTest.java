@@ -0,0 +1,94 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+package io.v6d.modules.basic.arrow;
+
+import static org.junit.Assert.assertEquals;
+import static org.junit.Assert.assertFalse;
+import static org.junit.Assert.assertTrue;
+import static org.junit.Assume.assumeTrue;
+
+import io.v6d.core.client.IPCClient;
+import io.v6d.core.client.ds.ObjectFactory;
+import io.v6d.core.common.util.ObjectID;
+import io.v6d.core.common.util.VineyardException;
+import java.util.List;
+import lombok.val;
+import org.apache.arrow.vector.BigIntVector;
+import org.apache.arrow.vector.Float8Vector;
+import org.apache.arrow.vector.VectorSchemaRoot;
+import org.junit.Before;
+import org.junit.Test;
+
+/**
+ * Resolves the table that is put into vineyard by the python client, see also
+ * `run_java_tests` in `test/runner.py`: 3 batches of 1000 rows, where the column "a" is the row
+ * index, "b" is the half of "a", and "c" equals to "a" but is null at every 5th row.
+ */
+public class TableResolverTest {
+    private static final int BATCHES = 3;
+    private static final int ROWS = 1000;
+
+    @Before
+    public void prepareResolvers() {
+        Arrow.instantiate();
+    }
+
+    @Test
+    public void resolveTable() throws VineyardException {
+        val target = System.getenv("VINEYARD_TEST_TABLE");
+        assumeTrue(target != null && System.getenv("VINEYARD_IPC_SOCKET") != null);
+
+        val client = new IPCClient();
+        val meta = client.getMetaData(ObjectID.fromString(target));
+        assertEquals("vineyard::Table", meta.typename());
+
+        @SuppressWarnings("unchecked")
+        List<VectorSchemaRoot> batches =
+                (List<VectorSchemaRoot>) ObjectFactory.getFactory().resolve(meta);
+        assertEquals(BATCHES, batches.size());
+        for (int index = 0; index < BATCHES; ++index) {
+            val batch = batches.get(index);
+            assertEquals(ROWS, batch.getRowCount());
+            assertEquals(3, batch.getFieldVectors().size());
+            val a = (BigIntVector) batch.getVector("a");
+            val b = (Float8Vector) batch.getVector("b");
+            val c = (BigIntVector) batch.getVector("c");
+            for (int row = 0; row < ROWS; ++row) {
+                long value = (long) index * ROWS + row;
+                assertEquals(value, a.get(row));
+                assertEquals(value * 0.5, b.get(row), 0.0);
+                if (value % 5 == 0) {
+                    assertTrue(c.isNull(row));
+                } else {
+                    assertFalse(c.isNull(row));
+                    assertEquals(value, c.get(row));
+                }
+            }
+
+            // the vectors refer the blobs directly
+            val column =
+                    meta.getMemberMeta("__batches_-" + index)
+                            .getMemberMeta("__columns_-0")
+                            .getMemberMeta("buffer_");
+            assertEquals(
+                    meta.getBuffer(column.id()).getPointer(), a.getDataBuffer().memoryAddress());
+        }
+
+        for (val batch : batches) {
+            batch.close();
+        }
+        client.disconnect();
+    }
+}
@@ -33,6 +33,7 @@ type LocalObjectSpec struct {
 	Typename   string `json:"typename,omitempty"`
 	InstanceID int    `json:"instance_id"`
 	Hostname   string `json:"hostname"`
+	Nbytes     int64  `json:"nbytes,omitempty"`
 	Metadata   string `json:"metadata"`
 }
 
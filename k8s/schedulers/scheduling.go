@@ -16,6 +16,7 @@ package schedulers
 import (
 	"context"
 	"fmt"
+	"math"
 	"sort"
 	"strconv"
 	"strings"
@@ -25,6 +26,7 @@ import (
 
 	v1 "k8s.io/api/core/v1"
 	metav1 "k8s.io/apimachinery/pkg/apis/meta/v1"
+	"k8s.io/apimachinery/pkg/labels"
 	"k8s.io/apimachinery/pkg/runtime"
 	ctrl "sigs.k8s.io/controller-runtime"
 
@@ -64,8 +66,11 @@ func (ss *SchedulerState) Append(job string, pod string, nodeName string) error
 
 // Compute the placement of a pod in job, assuming the useable nodes, and based on the given objects pool.
 //
-// Use a deterministic strategy.
-func (ss *SchedulerState) Compute(ctx context.Context, job string, replica int64, rank int64, requires []string, nodeName string) (int64, error) {
+// Use a deterministic strategy: the chunks are weighted by their bytes and laid out in the order of
+// hostnames, each replica takes an even share of the bytes, and a node is scored by how many bytes
+// of the share of `rank` resides on it. Nodes under shared memory pressure (the usage ratio, from
+// `pressures`) are penalized.
+func (ss *SchedulerState) Compute(ctx context.Context, job string, replica int64, rank int64, requires []string, nodeName string, pressures map[string]float64) (int64, error) {
 	// if requires no vineyard object, raise
 	if len(requires) == 0 {
 		return 0, fmt.Errorf("No nodes available")
@@ -96,51 +101,54 @@ func (ss *SchedulerState) Compute(ctx context.Context, job string, replica int64
 	}
 	klog.V(5).Infof("job %v requires local chunks %v", job, localObjects)
 
-	locations := make(map[string][]string)
+	// chunks published by servers that don't report the bytes are counted as one
+	// byte each, thus falls back to balance the number of chunks.
+	weighted := true
 	for _, localObject := range localObjects {
-		host := localObject.Spec.Hostname
-		if _, ok := locations[host]; !ok {
-			locations[host] = make([]string, 0)
+		if localObject.Spec.Nbytes <= 0 {
+			weighted = false
+			break
 		}
-		locations[host] = append(locations[host], localObject.Spec.ObjectID)
 	}
-
-	// total frags
-	totalfrags := int64(len(localObjects))
-	// frags for per pod
-	nchunks := totalfrags / replica
-	if totalfrags%replica != 0 {
-		nchunks++
+	locations := make(map[string]int64)
+	var totalbytes int64 = 0
+	for _, localObject := range localObjects {
+		var nbytes int64 = 1
+		if weighted {
+			nbytes = localObject.Spec.Nbytes
+		}
+		locations[localObject.Spec.Hostname] += nbytes
+		totalbytes += nbytes
 	}
 
-	// find the node
+	// find the bytes of the rank's share on the node
 	nodes := make([]string, 0)
 	for k := range locations {
 		nodes = append(nodes, k)
 	}
 	sort.Strings(nodes)
 
-	var cnt int64 = 0
-	target := ""
+	share := float64(totalbytes) / float64(replica)
+	begin, end := share*float64(rank), share*float64(rank+1)
+	var cnt float64 = 0
+	var overlap float64 = 0
 	for _, node := range nodes {
-		localfrags := int64(len(locations[node]))
-		if cnt+localfrags >= (nchunks*rank + (nchunks+1)/2) {
-			target = node
+		localbytes := float64(locations[node])
+		if node == nodeName {
+			overlap = math.Max(0, math.Min(end, cnt+localbytes)-math.Max(begin, cnt))
 			break
 		}
-		cnt += localfrags
+		cnt += localbytes
 	}
+	score := float64(framework.MaxNodeScore) * overlap / share
 
-	if target == "" {
-		klog.V(5).Infof("Unable to find a target: replica = %v, rank = %v, locations = %v", replica, rank, locations)
-		return 0, fmt.Errorf("Unable to find a pod: internal error")
-	}
-
-	if target == nodeName {
-		return 100, nil
-	} else {
-		return 1, nil
+	if pressure, ok := pressures[nodeName]; ok && pressure >= MemoryPressureThreshold {
+		klog.V(5).Infof("node %v is under memory pressure: %v", nodeName, pressure)
+		score *= math.Max(0, 1-pressure)
 	}
+	klog.V(5).Infof("job %v rank %v takes %v of %v bytes at node %v, locations = %v",
+		job, rank, overlap, share, nodeName, locations)
+	return int64(math.Round(score)), nil
 }
 
 func (ss *SchedulerState) getGlobalObjectsByID(ctx context.Context, objectIds []string) ([]*v1alpha1.GlobalObject, error) {
@@ -176,6 +184,7 @@ func (ss *SchedulerState) getLocalObjectsBySignatures(ctx context.Context, signa
 type VineyardScheduling struct {
 	handle          framework.FrameworkHandle
 	podLister       listerv1.PodLister
+	configMapLister listerv1.ConfigMapLister
 	scheduleTimeout *time.Duration
 	state           map[string]*SchedulerState
 	client          *clientset.Clientset
@@ -184,7 +193,7 @@ type VineyardScheduling struct {
 var _ framework.ScorePlugin = &VineyardScheduling{}
 var _ framework.PreFilterPlugin = &VineyardScheduling{}
 
-// var _ framework.PermitPlugin = &VineyardScheduling{}
+var _ framework.PermitPlugin = &VineyardScheduling{}
 var _ framework.PostBindPlugin = &VineyardScheduling{}
 
 const (
@@ -198,6 +207,11 @@ const (
 	VineyardJobRequired = "scheduling.k8s.v6d.io/required"
 	// VineyardJobReplica is the replication of pods in this job.
 	VineyardJobReplica = "scheduling.k8s.v6d.io/replica"
+	// VineyardInstanceStatus is the label of configmaps that published by vineyard servers about the
+	// shared memory usage.
+	VineyardInstanceStatus = "k8s.v6d.io/instance-status"
+	// MemoryPressureThreshold is the shared memory usage ratio that beyond which a node is penalized.
+	MemoryPressureThreshold = 0.8
 )
 
 // New initializes a vineyard scheduler
@@ -210,6 +224,7 @@ func New(configuration runtime.Object, handle framework.FrameworkHandle) (framew
 	scheduling := &VineyardScheduling{
 		handle:          handle,
 		podLister:       handle.SharedInformerFactory().Core().V1().Pods().Lister(),
+		configMapLister: handle.SharedInformerFactory().Core().V1().ConfigMaps().Lister(),
 		scheduleTimeout: &timeout,
 		state:           state,
 		client:          client,
@@ -265,7 +280,9 @@ func (vs *VineyardScheduling) Score(ctx context.Context, state *framework.CycleS
 	namespace := pod.GetNamespace()
 	schedulerState := vs.MakeSchedulerStateForNamespace(namespace)
 
-	score, err := schedulerState.Compute(ctx, job, replica, rank, requires, nodeName)
+	pressures := vs.GetMemoryPressures(namespace)
+
+	score, err := schedulerState.Compute(ctx, job, replica, rank, requires, nodeName, pressures)
 	if err != nil {
 		return 0, framework.NewStatus(framework.Unschedulable, err.Error())
 	}
@@ -285,11 +302,73 @@ func (vs *VineyardScheduling) NormalizeScore(ctx context.Context, state *framewo
 	return framework.NewStatus(framework.Success, "")
 }
 
-// Permit only permit runs on the node that has vineyard installed.
+// Permit places the replicas of a job as a gang: a pod waits until all replicas of the job have been
+// assigned to nodes, and are permitted together, or rejected together when timeout.
 func (vs *VineyardScheduling) Permit(ctx context.Context, state *framework.CycleState, pod *v1.Pod, nodeName string) (*framework.Status, time.Duration) {
+	job, replica, _, err := vs.GetVineyardLabels(pod)
+	if err != nil {
+		// not a vineyard job
+		return framework.NewStatus(framework.Success, ""), 0
+	}
+	namespace := pod.GetNamespace()
+
+	// the pods already bound, and waiting, including the current one
+	var assigned int64 = 1
+	selector := labels.SelectorFromSet(labels.Set{VineyardJobName: job})
+	if pods, err := vs.podLister.Pods(namespace).List(selector); err == nil {
+		for _, p := range pods {
+			if p.GetUID() != pod.GetUID() && p.Spec.NodeName != "" {
+				assigned++
+			}
+		}
+	}
+	vs.handle.IterateOverWaitingPods(func(waitingPod framework.WaitingPod) {
+		if vs.isPodOfJob(waitingPod.GetPod(), namespace, job) && waitingPod.GetPod().GetUID() != pod.GetUID() {
+			assigned++
+		}
+	})
+	if assigned < replica {
+		klog.V(5).Infof("pod %v of job %v waits for the gang: %v of %v", GetNamespacedName(pod), job, assigned, replica)
+		return framework.NewStatus(framework.Wait, ""), *vs.scheduleTimeout
+	}
+
+	klog.V(5).Infof("permit the gang of job %v with %v replicas", job, replica)
+	vs.handle.IterateOverWaitingPods(func(waitingPod framework.WaitingPod) {
+		if vs.isPodOfJob(waitingPod.GetPod(), namespace, job) {
+			waitingPod.Allow(vs.Name())
+		}
+	})
 	return framework.NewStatus(framework.Success, ""), 0
 }
 
+func (vs *VineyardScheduling) isPodOfJob(pod *v1.Pod, namespace string, job string) bool {
+	return pod.GetNamespace() == namespace && pod.Labels[VineyardJobName] == job
+}
+
+// GetMemoryPressures returns the shared memory usage ratio of vineyard instances on each node, the
+// maximum is used if there are multiple instances on a node.
+func (vs *VineyardScheduling) GetMemoryPressures(namespace string) map[string]float64 {
+	pressures := make(map[string]float64)
+	selector := labels.SelectorFromSet(labels.Set{VineyardInstanceStatus: "true"})
+	configMaps, err := vs.configMapLister.ConfigMaps(namespace).List(selector)
+	if err != nil {
+		klog.V(5).Infof("failed to list the status of vineyard instances: %v", err)
+		return pressures
+	}
+	for _, configMap := range configMaps {
+		hostname := configMap.Data["hostname"]
+		usage, err1 := strconv.ParseFloat(configMap.Data["memory_usage"], 64)
+		limit, err2 := strconv.ParseFloat(configMap.Data["memory_limit"], 64)
+		if hostname == "" || err1 != nil || err2 != nil || limit <= 0 {
+			continue
+		}
+		if pressure := usage / limit; pressure > pressures[hostname] {
+			pressures[hostname] = pressure
+		}
+	}
+	return pressures
+}
+
 // PostBind do nothing
 func (vs *VineyardScheduling) PostBind(ctx context.Context, _ *framework.CycleState, pod *v1.Pod, nodeName string) {
 	klog.V(5).Infof("bind pod %v on node %v", GetNamespacedName(pod), nodeName)
@@ -0,0 +1,178 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+package schedulers
+
+import (
+	"context"
+	"fmt"
+	"testing"
+
+	v1 "k8s.io/api/core/v1"
+	metav1 "k8s.io/apimachinery/pkg/apis/meta/v1"
+	"k8s.io/apimachinery/pkg/runtime"
+	listerv1 "k8s.io/client-go/listers/core/v1"
+	"k8s.io/client-go/tools/cache"
+
+	v1alpha1 "github.com/v6d-io/v6d/k8s/api/k8s/v1alpha1"
+	"github.com/v6d-io/v6d/k8s/generated/clientset/versioned/fake"
+)
+
+const testNamespace = "vineyard-test"
+
+type chunk struct {
+	hostname string
+	nbytes   int64
+}
+
+// makeSchedulerState publishes a global object "o0001" whose members are the given chunks.
+func makeSchedulerState(chunks []chunk) *SchedulerState {
+	objects := make([]runtime.Object, 0)
+	members := make([]string, 0)
+	for index, c := range chunks {
+		signature := fmt.Sprintf("s%04d", index)
+		members = append(members, signature)
+		objects = append(objects, &v1alpha1.LocalObject{
+			ObjectMeta: metav1.ObjectMeta{
+				Name:      fmt.Sprintf("o%04d", index+2),
+				Namespace: testNamespace,
+				Labels:    map[string]string{"k8s.v6d.io/signature": signature},
+			},
+			Spec: v1alpha1.LocalObjectSpec{
+				ObjectID:  fmt.Sprintf("o%04d", index+2),
+				Signature: signature,
+				Hostname:  c.hostname,
+				Nbytes:    c.nbytes,
+			},
+		})
+	}
+	objects = append(objects, &v1alpha1.GlobalObject{
+		ObjectMeta: metav1.ObjectMeta{Name: "o0001", Namespace: testNamespace},
+		Spec: v1alpha1.GlobalObjectSpec{
+			ObjectID: "o0001",
+			Members:  members,
+		},
+	})
+	client := fake.NewSimpleClientset(objects...)
+	return &SchedulerState{
+		state:     make(map[string]map[string]string),
+		localctl:  client.K8sV1alpha1().LocalObjects(testNamespace),
+		globalctl: client.K8sV1alpha1().GlobalObjects(testNamespace),
+	}
+}
+
+func checkScores(t *testing.T, ss *SchedulerState, replica int64, pressures map[string]float64,
+	expected map[int64]map[string]int64) {
+	for rank, scores := range expected {
+		for node, score := range scores {
+			actual, err := ss.Compute(context.TODO(), "job", replica, rank, []string{"o0001"}, node, pressures)
+			if err != nil {
+				t.Fatalf("failed to compute the score of rank %v on %v: %v", rank, node, err)
+			}
+			if actual != score {
+				t.Errorf("the score of rank %v on %v: expected %v, got %v", rank, node, score, actual)
+			}
+		}
+	}
+}
+
+// the rank takes the nodes that hold its share of the bytes, rather than of the chunks
+func TestComputeByBytes(t *testing.T) {
+	ss := makeSchedulerState([]chunk{{"node-a", 200}, {"node-a", 100}, {"node-b", 100}, {"node-c", 200}})
+	checkScores(t, ss, 2, nil, map[int64]map[string]int64{
+		0: {"node-a": 100, "node-b": 0, "node-c": 0},
+		1: {"node-a": 0, "node-b": 33, "node-c": 67},
+	})
+}
+
+// falls back to balance the number of chunks if some server doesn't report the bytes
+func TestComputeByChunks(t *testing.T) {
+	ss := makeSchedulerState([]chunk{{"node-a", 200}, {"node-a", 100}, {"node-b", 0}, {"node-c", 200}})
+	checkScores(t, ss, 2, nil, map[int64]map[string]int64{
+		0: {"node-a": 100, "node-b": 0, "node-c": 0},
+		1: {"node-a": 0, "node-b": 50, "node-c": 50},
+	})
+}
+
+// only the nodes at or beyond the threshold are penalized
+func TestComputeUnderMemoryPressure(t *testing.T) {
+	ss := makeSchedulerState([]chunk{{"node-a", 300}, {"node-b", 100}, {"node-c", 200}})
+	pressures := map[string]float64{"node-a": 0.9, "node-b": 0.5, "node-c": MemoryPressureThreshold}
+	checkScores(t, ss, 2, pressures, map[int64]map[string]int64{
+		0: {"node-a": 10},
+		1: {"node-b": 33, "node-c": 13},
+	})
+}
+
+func TestComputeErrors(t *testing.T) {
+	ss := makeSchedulerState([]chunk{{"node-a", 100}})
+	if _, err := ss.Compute(context.TODO(), "job", 1, 0, []string{}, "node-a", nil); err == nil {
+		t.Errorf("expected an error when no objects are required")
+	}
+	if _, err := ss.Compute(context.TODO(), "job", 0, 0, []string{"o0001"}, "node-a", nil); err == nil {
+		t.Errorf("expected an error when there's no replica")
+	}
+	if _, err := ss.Compute(context.TODO(), "job", 1, 0, []string{"o9999"}, "node-a", nil); err == nil {
+		t.Errorf("expected an error when the object doesn't exist")
+	}
+	empty := makeSchedulerState([]chunk{})
+	if _, err := empty.Compute(context.TODO(), "job", 1, 0, []string{"o0001"}, "node-a", nil); err == nil {
+		t.Errorf("expected an error when there are no local chunks")
+	}
+}
+
+// the maximum ratio of the instances on a node is used, and the invalid statuses are skipped
+func TestGetMemoryPressures(t *testing.T) {
+	indexer := cache.NewIndexer(cache.MetaNamespaceKeyFunc, cache.Indexers{})
+	statuses := []map[string]string{
+		{"hostname": "node-a", "memory_usage": "512", "memory_limit": "1024"},
+		{"hostname": "node-a", "memory_usage": "900", "memory_limit": "1000"},
+		{"hostname": "node-b", "memory_usage": "100", "memory_limit": "1000"},
+		{"hostname": "node-c", "memory_usage": "100", "memory_limit": "0"},
+		{"hostname": "", "memory_usage": "100", "memory_limit": "1000"},
+		{"hostname": "node-d", "memory_usage": "unknown", "memory_limit": "1000"},
+	}
+	for index, data := range statuses {
+		if err := indexer.Add(&v1.ConfigMap{
+			ObjectMeta: metav1.ObjectMeta{
+				Name:      fmt.Sprintf("vineyard-status-%d", index),
+				Namespace: testNamespace,
+				Labels:    map[string]string{VineyardInstanceStatus: "true"},
+			},
+			Data: data,
+		}); err != nil {
+			t.Fatal(err)
+		}
+	}
+	// not a status of vineyard instances
+	if err := indexer.Add(&v1.ConfigMap{
+		ObjectMeta: metav1.ObjectMeta{Name: "others", Namespace: testNamespace},
+		Data:       map[string]string{"hostname": "node-e", "memory_usage": "1", "memory_limit": "1"},
+	}); err != nil {
+		t.Fatal(err)
+	}
+
+	vs := &VineyardScheduling{configMapLister: listerv1.NewConfigMapLister(indexer)}
+	pressures := vs.GetMemoryPressures(testNamespace)
+	expected := map[string]float64{"node-a": 0.9, "node-b": 0.1}
+	if len(pressures) != len(expected) {
+		t.Fatalf("expected the pressures %v, got %v", expected, pressures)
+	}
+	for node, pressure := range expected {
+		if pressures[node] != pressure {
+			t.Errorf("the pressure of %v: expected %v, got %v", node, pressure, pressures[node])
+		}
+	}
+}
@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef MODULES_BASIC_DS_ARRAY_H_
 #define MODULES_BASIC_DS_ARRAY_H_
 
+#include <algorithm>
 #include <memory>
 #include <string>
 #include <utility>
@@ -80,86 +81,174 @@ class ArrayBuilder : public ArrayBaseBuilder<T> {
    * @param idx The give index.
    * @return The element at the given index.
    */
-  T& operator[](size_t idx) { return data_[idx]; }
+  T& operator[](size_t idx) {
+    return payload_ ? (*payload_)[idx] : data_[idx];
+  }
 
-  /**
-   * @brief Get the data pointer to the array.
-   *
-   * @return The data pointer.
-   */
-  T* data() noexcept { return data_; }
+  void push_back(T const& v) {
+    if (payload_) {
+      payload_->push_back(v);
+      return;
+    }
+    T value = v;  // `v` may refer to an element of the array itself
+    ensure(size_ + 1);
+    new (data_ + size_) T(std::move(value));
+    size_ += 1;
+  }
+
+  void push_back(T&& v) {
+    if (payload_) {
+      payload_->push_back(std::move(v));
+      return;
+    }
+    T value = std::move(v);
+    ensure(size_ + 1);
+    new (data_ + size_) T(std::move(value));
+    size_ += 1;
+  }
+
+  template <class... Args>
+  void emplace_back(Args&&... args) {
+    if (payload_) {
+      payload_->emplace_back(std::forward<Args>(args)...);
+      return;
+    }
+    T value(std::forward<Args>(args)...);
+    ensure(size_ + 1);
+    new (data_ + size_) T(std::move(value));
+    size_ += 1;
+  }
+
+  size_t const size() const { return payload_ ? payload_->size() : size_; }
+  size_t const capacity() const {
+    return payload_ ? payload_->capacity() : capacity_;
+  }
+
+  void reserve(size_t size) {
+    if (payload_) {
+      payload_->reserve(size);
+    } else if (size > capacity_) {
+      VINEYARD_CHECK_OK(reallocate(size));
+    }
+  }
+
+  void resize(size_t size) { resize(size, T()); }
+
+  void resize(size_t size, T const& value) {
+    if (payload_) {
+      payload_->resize(size, value);
+      return;
+    }
+    if (size > size_) {
+      T fill = value;
+      ensure(size);
+      std::uninitialized_fill(data_ + size_, data_ + size, fill);
+    }
+    size_ = size;
+  }
+
+  bool empty() const { return size() == 0; }
 
   /**
-   * @brief Get the const data pointer to the array.
-   *
-   * @return The const data pointer.
+   * @brief Release the unused capacity, which requires copying the elements
+   * to a new blob.
    */
-  const T* data() const noexcept { return data_; }
+  void shrink_to_fit() {
+    if (payload_) {
+      payload_->shrink_to_fit();
+    } else if (capacity_ > size_) {
+      VINEYARD_CHECK_OK(reallocate(size_, true));
+    }
+  }
+
+  T* data() noexcept { return payload_ ? payload_->data() : data_; }
+
+  const T* data() const noexcept {
+    return payload_ ? payload_->data() : data_;
+  }
 
   /**
-   * @brief Build the array object.
+   * @brief Exposes the elements as a `std::vector`.
    *
-   * @param client The client connected to the vineyard server.
+   * The elements are moved out of the blob into the returned vector, and the
+   * builder keeps them in the vector afterwards, thus `Build` copies them
+   * into a new blob again.
    */
+  [[deprecated(
+      "The elements are kept in a blob, use data() and size() instead.")]]
+  std::vector<T>& payload() {
+    if (!payload_) {
+      payload_.reset(new std::vector<T>(data_, data_ + size_));
+      if (buffer_writer_ != nullptr) {
+        VINEYARD_DISCARD(buffer_writer_->Abort(client_));
+        buffer_writer_.reset();
+      }
+      data_ = nullptr;
+      size_ = capacity_ = 0;
+    }
+    return *payload_;
+  }
+
   Status Build(Client& client) override {
+    if (payload_) {
+      RETURN_ON_ERROR(
+          client.CreateBlob(payload_->size() * sizeof(T), buffer_writer_));
+      memcpy(buffer_writer_->data(), payload_->data(),
+             payload_->size() * sizeof(T));
+      size_ = payload_->size();
+      payload_.reset();
+    }
+    if (buffer_writer_ == nullptr) {
+      RETURN_ON_ERROR(client.CreateBlob(0, buffer_writer_));
+    }
     this->set_size_(size_);
     this->set_buffer_(std::shared_ptr<BlobWriter>(std::move(buffer_writer_)));
+    data_ = nullptr;
+    size_ = capacity_ = 0;
     return Status::OK();
   }
 
  private:
-  std::unique_ptr<BlobWriter> buffer_writer_;
-  T* data_;
-  size_t size_;
-};
-
-/**
- * @brief ResizableArrayBuilder is used for building resizable arrays.
- *
- * @tparam T The type for the elements.
- */
-template <typename T>
-class ResizableArrayBuilder : public ArrayBaseBuilder<T> {
- public:
-  explicit ResizableArrayBuilder(Client& client, size_t size = 0)
-      : ArrayBaseBuilder<T>(client), vec_(size) {}
-
-  T& operator[](size_t idx) { return vec_[idx]; }
-
-  void push_back(T const& v) { vec_.push_back(v); }
-
-  void push_back(T&& v) { vec_.push_back(std::move(v)); }
-
-  template <class... Args>
-  void emplace_back(Args&&... args) {
-    vec_.emplace_back(std::forward<Args>(args)...);
+  // grows geometrically to hold at least `size` elements
+  void ensure(size_t size) {
+    if (size > capacity_) {
+      size_t min_capacity = kMinCapacity;
+      VINEYARD_CHECK_OK(
+          reallocate(std::max({size, capacity_ * 2, min_capacity})));
+    }
   }
 
-  size_t const size() const { return vec_.size(); }
-  void reserve(size_t size) { vec_.reserve(size); }
-  void resize(size_t size) { vec_.resize(size); }
-  void resize(size_t size, T const& value) { vec_.resize(size, value); }
-
-  bool empty() const { return vec_.empty(); }
-
-  void shrink_to_fit() { return vec_.shrink_to_fit(); }
-
-  // FIXME: exposing the internal vec outside the builder is bad,
-  // but we need to manipulate a vector builder in sync_comm.h
-  std::vector<T>& payload() { return vec_; }
-
-  Status Build(Client& client) override {
+  Status reallocate(size_t capacity, bool shrink = false) {
+    if (buffer_writer_ != nullptr && !shrink) {
+      auto status = buffer_writer_->Extend(client_, capacity * sizeof(T));
+      if (status.ok()) {
+        data_ = reinterpret_cast<T*>(buffer_writer_->data());
+        capacity_ = capacity;
+        return status;
+      }
+      // fallbacks to a new blob when the blob cannot be extended in place
+    }
     std::unique_ptr<BlobWriter> buffer_writer;
-    RETURN_ON_ERROR(client.CreateBlob(vec_.size() * sizeof(T), buffer_writer));
-    memcpy(buffer_writer->data(), vec_.data(), vec_.size() * sizeof(T));
-
-    this->set_size_(vec_.size());
-    this->set_buffer_(std::shared_ptr<BlobWriter>(std::move(buffer_writer)));
+    RETURN_ON_ERROR(client_.CreateBlob(capacity * sizeof(T), buffer_writer));
+    if (buffer_writer_ != nullptr) {
+      memcpy(buffer_writer->data(), data_, size_ * sizeof(T));
+      VINEYARD_DISCARD(buffer_writer_->Abort(client_));
+    }
+    buffer_writer_ = std::move(buffer_writer);
+    data_ = reinterpret_cast<T*>(buffer_writer_->data());
+    capacity_ = capacity;
     return Status::OK();
   }
 
- private:
-  std::vector<T> vec_;
+  static constexpr size_t kMinCapacity = 64;
+
+  Client& client_;
+  std::unique_ptr<BlobWriter> buffer_writer_;
+  T* data_ = nullptr;
+  size_t size_ = 0;
+  size_t capacity_ = 0;
+  // the elements after `payload()` has been called
+  std::unique_ptr<std::vector<T>> payload_;
 };
 
 }  // namespace vineyard
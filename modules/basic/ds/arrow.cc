@@ -0,0 +1,153 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "basic/ds/arrow.h"
+
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace vineyard {
+
+namespace detail {
+
+namespace {
+
+bool internSchema() {
+  static const bool enabled = []() {
+    if (const char* env_p = std::getenv("VINEYARD_INTERN_SCHEMA")) {
+      std::string flag(env_p);
+      return !(flag == "0" || flag == "false");
+    }
+    return true;
+  }();
+  return enabled;
+}
+
+struct interned_schema_t {
+  InstanceID instance_id;
+  std::shared_ptr<arrow::Schema> schema;
+  std::shared_ptr<SchemaProxy> proxy;
+};
+
+constexpr size_t kMaxInternedSchemas = 1024;
+constexpr size_t kMaxCachedSchemas = 4096;
+
+// the interned proxies, keyed by the printed schemas (with the metadata),
+// and the candidates are compared by `arrow::Schema::Equals`.
+std::mutex interned_mutex;
+std::unordered_multimap<std::string, interned_schema_t> interned_schemas;
+
+// the deserialized schemas, keyed by the ids of proxies
+std::mutex cached_mutex;
+std::unordered_map<ObjectID, std::weak_ptr<arrow::Schema>> cached_schemas;
+
+void cacheSchema(const ObjectID proxy_id,
+                 std::shared_ptr<arrow::Schema> const& schema) {
+  std::lock_guard<std::mutex> lock(cached_mutex);
+  if (cached_schemas.size() >= kMaxCachedSchemas) {
+    for (auto iter = cached_schemas.begin(); iter != cached_schemas.end();
+         /* no self-inc */) {
+      if (iter->second.expired()) {
+        iter = cached_schemas.erase(iter);
+      } else {
+        ++iter;
+      }
+    }
+  }
+  if (cached_schemas.size() < kMaxCachedSchemas) {
+    cached_schemas[proxy_id] = schema;
+  }
+}
+
+}  // namespace
+
+std::shared_ptr<arrow::Schema> ReadSchema(const ObjectID proxy_id,
+                                          std::shared_ptr<Blob> const& buffer) {
+  {
+    std::lock_guard<std::mutex> lock(cached_mutex);
+    auto iter = cached_schemas.find(proxy_id);
+    if (iter != cached_schemas.end()) {
+      if (auto schema = iter->second.lock()) {
+        return schema;
+      }
+    }
+  }
+  std::shared_ptr<arrow::Schema> schema;
+  arrow::io::BufferReader reader(buffer->Buffer());
+#if defined(ARROW_VERSION) && ARROW_VERSION < 17000
+  CHECK_ARROW_ERROR(arrow::ipc::ReadSchema(&reader, nullptr, &schema));
+#else
+  CHECK_ARROW_ERROR_AND_ASSIGN(schema,
+                               arrow::ipc::ReadSchema(&reader, nullptr));
+#endif
+  cacheSchema(proxy_id, schema);
+  return schema;
+}
+
+std::shared_ptr<ObjectBase> BuildSchema(
+    Client& client, std::shared_ptr<arrow::Schema> const& schema) {
+  if (!internSchema()) {
+    return std::make_shared<SchemaProxyBuilder>(client, schema);
+  }
+  std::string const key = schema->ToString(true);
+  std::shared_ptr<SchemaProxy> proxy;
+  {
+    std::lock_guard<std::mutex> lock(interned_mutex);
+    auto range = interned_schemas.equal_range(key);
+    for (auto iter = range.first; iter != range.second; ++iter) {
+      if (iter->second.instance_id == client.instance_id() &&
+          iter->second.schema->Equals(*schema, true)) {
+        proxy = iter->second.proxy;
+        break;
+      }
+    }
+  }
+  if (proxy != nullptr) {
+    // the proxy may have been deleted since being interned.
+    bool exists = false;
+    if (client.Exists(proxy->id(), exists).ok() && exists) {
+      return proxy;
+    }
+  }
+
+  auto builder = std::make_shared<SchemaProxyBuilder>(client, schema);
+  auto sealed = std::dynamic_pointer_cast<SchemaProxy>(builder->Seal(client));
+  cacheSchema(sealed->id(), schema);
+  {
+    std::lock_guard<std::mutex> lock(interned_mutex);
+    if (proxy != nullptr) {
+      auto range = interned_schemas.equal_range(key);
+      for (auto iter = range.first; iter != range.second; ++iter) {
+        if (iter->second.proxy == proxy) {
+          interned_schemas.erase(iter);
+          break;
+        }
+      }
+    }
+    if (interned_schemas.size() >= kMaxInternedSchemas) {
+      interned_schemas.clear();
+    }
+    interned_schemas.emplace(
+        key, interned_schema_t{client.instance_id(), schema, sealed});
+  }
+  return sealed;
+}
+
+}  // namespace detail
+
+}  // namespace vineyard
@@ -16,33 +16,192 @@ limitations under the License.
 #ifndef MODULES_BASIC_DS_ARROW_H_
 #define MODULES_BASIC_DS_ARROW_H_
 
+#include <algorithm>
 #include <iostream>
 #include <memory>
 #include <string>
+#include <thread>
 #include <utility>
 #include <vector>
 
 #include "basic/ds/arrow.vineyard.h"
+#include "basic/ds/arrow_memory_pool.h"
 #include "basic/ds/arrow_utils.h"
 #include "client/client.h"
 #include "client/ds/blob.h"
+#include "common/memory/memcpy.h"
 
 namespace vineyard {
 
+namespace detail {
+
+inline bool HasNullBitmap(std::shared_ptr<arrow::Array> const& array) {
+  return array->null_bitmap() && array->null_count() > 0;
+}
+
+/**
+ * @brief Copy the content of the given arrow buffers into vineyard blobs. The
+ * blobs are created in a single round trip.
+ *
+ * Buffers that were allocated from a `VineyardMemoryPool` (or frozen from a
+ * `VineyardArenaMemoryPool`) of the client are already blobs, and are adopted
+ * without copying.
+ *
+ * Large buffers are copied by `concurrent_memcpy`, and many small buffers
+ * that sum up to a large amount are spread over threads.
+ */
+inline Status CopyToBlobs(
+    Client& client, std::vector<std::shared_ptr<arrow::Buffer>> const& buffers,
+    std::vector<std::shared_ptr<ObjectBase>>& blobs) {
+  std::vector<std::shared_ptr<ObjectBase>> adopted(buffers.size());
+  std::vector<size_t> sizes;
+  for (size_t idx = 0; idx < buffers.size(); ++idx) {
+    adopted[idx] = VineyardMemoryPool::Take(client, buffers[idx]->data());
+#if defined(WITH_JEMALLOC)
+    if (adopted[idx] == nullptr) {
+      adopted[idx] =
+          VineyardArenaMemoryPool::Freeze(client, buffers[idx]->data());
+    }
+#endif
+    if (adopted[idx] == nullptr) {
+      sizes.emplace_back(buffers[idx]->size());
+    }
+  }
+  std::vector<std::unique_ptr<BlobWriter>> writers;
+  if (!sizes.empty()) {
+    RETURN_ON_ERROR(client.CreateBlobs(sizes, writers));
+  }
+  auto writer = writers.begin();
+  // (destination, buffer) of the small buffers
+  std::vector<std::pair<char*, std::shared_ptr<arrow::Buffer>>> copies;
+  size_t total_bytes = 0;
+  for (size_t idx = 0; idx < buffers.size(); ++idx) {
+    if (adopted[idx] != nullptr) {
+      blobs.emplace_back(std::move(adopted[idx]));
+      continue;
+    }
+    size_t size = buffers[idx]->size();
+    if (size >= memory::kConcurrentMemcpyThreshold) {
+      memory::concurrent_memcpy((*writer)->data(), buffers[idx]->data(), size);
+    } else {
+      copies.emplace_back((*writer)->data(), buffers[idx]);
+      total_bytes += size;
+    }
+    blobs.emplace_back(std::move(*writer));
+    ++writer;
+  }
+  size_t parallelism = std::min<size_t>(
+      {8, copies.size(), total_bytes / memory::kConcurrentMemcpyChunk,
+       std::max<size_t>(1, std::thread::hardware_concurrency())});
+  auto copy = [&copies](size_t const begin, size_t const stride) {
+    for (size_t idx = begin; idx < copies.size(); idx += stride) {
+      memcpy(copies[idx].first, copies[idx].second->data(),
+             copies[idx].second->size());
+    }
+  };
+  if (total_bytes < memory::kConcurrentMemcpyThreshold || parallelism <= 1) {
+    copy(0, 1);
+  } else {
+    std::vector<std::thread> workers;
+    for (size_t worker = 1; worker < parallelism; ++worker) {
+      workers.emplace_back(copy, worker, parallelism);
+    }
+    copy(0, parallelism);
+    for (auto& worker : workers) {
+      worker.join();
+    }
+  }
+  return Status::OK();
+}
+
+/**
+ * @brief ArrowBufferBuilder is the base of builders that copy arrow buffers
+ * into blobs. The blobs could be created ahead for a batch of builders (see
+ * `PrepareBlobs`), otherwise each builder creates its blobs in one batch.
+ */
+class ArrowBufferBuilder {
+ public:
+  virtual ~ArrowBufferBuilder() = default;
+
+  /**
+   * @brief The arrow buffers to be copied, in the order that `Build` consumes
+   * the blobs.
+   */
+  virtual void CollectBuffers(
+      std::vector<std::shared_ptr<arrow::Buffer>>& buffers) = 0;
+
+  void AttachBlobs(std::vector<std::shared_ptr<ObjectBase>>&& blobs) {
+    blobs_ = std::move(blobs);
+  }
+
+ protected:
+  Status TakeBlobs(Client& client,
+                   std::vector<std::shared_ptr<ObjectBase>>& blobs) {
+    if (blobs_.empty()) {
+      std::vector<std::shared_ptr<arrow::Buffer>> buffers;
+      CollectBuffers(buffers);
+      return CopyToBlobs(client, buffers, blobs);
+    }
+    blobs = std::move(blobs_);
+    blobs_.clear();
+    return Status::OK();
+  }
+
+ private:
+  std::vector<std::shared_ptr<ObjectBase>> blobs_;
+};
+
+/**
+ * @brief Create the blobs for a batch of builders in a single round trip,
+ * builders that are not `ArrowBufferBuilder` are skipped.
+ */
+inline Status PrepareBlobs(
+    Client& client,
+    std::vector<std::shared_ptr<ObjectBuilder>> const& builders) {
+  std::vector<std::shared_ptr<arrow::Buffer>> buffers;
+  std::vector<size_t> counts;
+  for (auto const& builder : builders) {
+    size_t count = buffers.size();
+    if (auto buffer_builder =
+            std::dynamic_pointer_cast<ArrowBufferBuilder>(builder)) {
+      buffer_builder->CollectBuffers(buffers);
+    }
+    counts.emplace_back(buffers.size() - count);
+  }
+  std::vector<std::shared_ptr<ObjectBase>> blobs;
+  RETURN_ON_ERROR(CopyToBlobs(client, buffers, blobs));
+  auto iter = blobs.begin();
+  for (size_t idx = 0; idx < builders.size(); ++idx) {
+    if (counts[idx] == 0) {
+      continue;
+    }
+    std::dynamic_pointer_cast<ArrowBufferBuilder>(builders[idx])
+        ->AttachBlobs(std::vector<std::shared_ptr<ObjectBase>>(
+            iter, iter + counts[idx]));
+    iter += counts[idx];
+  }
+  return Status::OK();
+}
+
+}  // namespace detail
+
 #ifndef BUILD_NULL_BITMAP
-#define BUILD_NULL_BITMAP(builder, array)                                \
-  {                                                                      \
-    if (array->null_bitmap() && array->null_count() > 0) {               \
-      std::unique_ptr<BlobWriter> bitmap_buffer_writer;                  \
-      RETURN_ON_ERROR(client.CreateBlob(array->null_bitmap()->size(),    \
-                                        bitmap_buffer_writer));          \
-      memcpy(bitmap_buffer_writer->data(), array->null_bitmap()->data(), \
-             array->null_bitmap()->size());                              \
-      builder->set_null_bitmap_(                                         \
-          std::shared_ptr<BlobWriter>(std::move(bitmap_buffer_writer))); \
-    } else {                                                             \
-      builder->set_null_bitmap_(Blob::MakeEmpty(client));                \
-    }                                                                    \
+#define BUILD_NULL_BITMAP(builder, array, blobs, index)   \
+  {                                                       \
+    if (detail::HasNullBitmap(array)) {                   \
+      builder->set_null_bitmap_(blobs[index]);            \
+    } else {                                              \
+      builder->set_null_bitmap_(Blob::MakeEmpty(client)); \
+    }                                                     \
+  }
+#endif
+
+#ifndef COLLECT_NULL_BITMAP
+#define COLLECT_NULL_BITMAP(buffers, array)       \
+  {                                               \
+    if (detail::HasNullBitmap(array)) {           \
+      buffers.emplace_back(array->null_bitmap()); \
+    }                                             \
   }
 #endif
 
@@ -52,7 +211,8 @@ namespace vineyard {
  * @tparam T
  */
 template <typename T>
-class NumericArrayBuilder : public NumericArrayBaseBuilder<T> {
+class NumericArrayBuilder : public NumericArrayBaseBuilder<T>,
+                            public detail::ArrowBufferBuilder {
  public:
   using ArrayType = typename ConvertToArrowType<T>::ArrayType;
 
@@ -61,17 +221,21 @@ class NumericArrayBuilder : public NumericArrayBaseBuilder<T> {
 
   std::shared_ptr<ArrayType> GetArray() { return array_; }
 
+  void CollectBuffers(
+      std::vector<std::shared_ptr<arrow::Buffer>>& buffers) override {
+    buffers.emplace_back(array_->values());
+    COLLECT_NULL_BITMAP(buffers, array_);
+  }
+
   Status Build(Client& client) override {
-    std::unique_ptr<BlobWriter> buffer_writer;
-    RETURN_ON_ERROR(client.CreateBlob(array_->values()->size(), buffer_writer));
-    memcpy(buffer_writer->data(), array_->values()->data(),
-           array_->values()->size());
+    std::vector<std::shared_ptr<ObjectBase>> blobs;
+    RETURN_ON_ERROR(this->TakeBlobs(client, blobs));
 
     this->set_length_(array_->length());
     this->set_null_count_(array_->null_count());
     this->set_offset_(array_->offset());
-    this->set_buffer_(std::shared_ptr<BlobWriter>(std::move(buffer_writer)));
-    BUILD_NULL_BITMAP(this, array_);
+    this->set_buffer_(blobs[0]);
+    BUILD_NULL_BITMAP(this, array_, blobs, 1);
     return Status::OK();
   }
 
@@ -84,7 +248,8 @@ class NumericArrayBuilder : public NumericArrayBaseBuilder<T> {
  * boolean data type
  *
  */
-class BooleanArrayBuilder : public BooleanArrayBaseBuilder {
+class BooleanArrayBuilder : public BooleanArrayBaseBuilder,
+                            public detail::ArrowBufferBuilder {
  public:
   using ArrayType = typename ConvertToArrowType<bool>::ArrayType;
 
@@ -93,17 +258,21 @@ class BooleanArrayBuilder : public BooleanArrayBaseBuilder {
 
   std::shared_ptr<ArrayType> GetArray() { return array_; }
 
+  void CollectBuffers(
+      std::vector<std::shared_ptr<arrow::Buffer>>& buffers) override {
+    buffers.emplace_back(array_->values());
+    COLLECT_NULL_BITMAP(buffers, array_);
+  }
+
   Status Build(Client& client) override {
-    std::unique_ptr<BlobWriter> buffer_writer;
-    RETURN_ON_ERROR(client.CreateBlob(array_->values()->size(), buffer_writer));
-    memcpy(buffer_writer->data(), array_->values()->data(),
-           array_->values()->size());
+    std::vector<std::shared_ptr<ObjectBase>> blobs;
+    RETURN_ON_ERROR(this->TakeBlobs(client, blobs));
 
     this->set_length_(array_->length());
     this->set_null_count_(array_->null_count());
     this->set_offset_(array_->offset());
-    this->set_buffer_(std::shared_ptr<BlobWriter>(std::move(buffer_writer)));
-    BUILD_NULL_BITMAP(this, array_);
+    this->set_buffer_(blobs[0]);
+    BUILD_NULL_BITMAP(this, array_, blobs, 1);
     return Status::OK();
   }
 
@@ -117,38 +286,31 @@ class BooleanArrayBuilder : public BooleanArrayBaseBuilder {
  *
  */
 template <typename ArrayType>
-class BaseBinaryArrayBuilder : public BaseBinaryArrayBaseBuilder<ArrayType> {
+class BaseBinaryArrayBuilder : public BaseBinaryArrayBaseBuilder<ArrayType>,
+                               public detail::ArrowBufferBuilder {
  public:
   BaseBinaryArrayBuilder(Client& client, std::shared_ptr<ArrayType> array)
       : BaseBinaryArrayBaseBuilder<ArrayType>(client), array_(array) {}
 
   std::shared_ptr<ArrayType> GetArray() { return array_; }
 
-  Status Build(Client& client) override {
-    {
-      std::unique_ptr<BlobWriter> buffer_writer;
-      RETURN_ON_ERROR(
-          client.CreateBlob(array_->value_offsets()->size(), buffer_writer));
-      memcpy(buffer_writer->data(), array_->value_offsets()->data(),
-             array_->value_offsets()->size());
+  void CollectBuffers(
+      std::vector<std::shared_ptr<arrow::Buffer>>& buffers) override {
+    buffers.emplace_back(array_->value_offsets());
+    buffers.emplace_back(array_->value_data());
+    COLLECT_NULL_BITMAP(buffers, array_);
+  }
 
-      this->set_buffer_offsets_(
-          std::shared_ptr<BlobWriter>(std::move(buffer_writer)));
-    }
-    {
-      std::unique_ptr<BlobWriter> buffer_writer;
-      RETURN_ON_ERROR(
-          client.CreateBlob(array_->value_data()->size(), buffer_writer));
-      memcpy(buffer_writer->data(), array_->value_data()->data(),
-             array_->value_data()->size());
+  Status Build(Client& client) override {
+    std::vector<std::shared_ptr<ObjectBase>> blobs;
+    RETURN_ON_ERROR(this->TakeBlobs(client, blobs));
 
-      this->set_buffer_data_(
-          std::shared_ptr<BlobWriter>(std::move(buffer_writer)));
-    }
+    this->set_buffer_offsets_(blobs[0]);
+    this->set_buffer_data_(blobs[1]);
     this->set_length_(array_->length());
     this->set_null_count_(array_->null_count());
     this->set_offset_(array_->offset());
-    BUILD_NULL_BITMAP(this, array_);
+    BUILD_NULL_BITMAP(this, array_, blobs, 2);
     return Status::OK();
   }
 
@@ -166,7 +328,8 @@ using LargeStringArrayBuilder = BaseBinaryArrayBuilder<arrow::LargeStringArray>;
  * of a fixed-size binary data type
  *
  */
-class FixedSizeBinaryArrayBuilder : public FixedSizeBinaryArrayBaseBuilder {
+class FixedSizeBinaryArrayBuilder : public FixedSizeBinaryArrayBaseBuilder,
+                                    public detail::ArrowBufferBuilder {
  public:
   FixedSizeBinaryArrayBuilder(
       Client& client, std::shared_ptr<arrow::FixedSizeBinaryArray> array)
@@ -174,18 +337,22 @@ class FixedSizeBinaryArrayBuilder : public FixedSizeBinaryArrayBaseBuilder {
 
   std::shared_ptr<arrow::FixedSizeBinaryArray> GetArray() { return array_; }
 
+  void CollectBuffers(
+      std::vector<std::shared_ptr<arrow::Buffer>>& buffers) override {
+    buffers.emplace_back(array_->values());
+    COLLECT_NULL_BITMAP(buffers, array_);
+  }
+
   Status Build(Client& client) override {
-    std::unique_ptr<BlobWriter> buffer_writer;
-    RETURN_ON_ERROR(client.CreateBlob(array_->values()->size(), buffer_writer));
-    memcpy(buffer_writer->data(), array_->values()->data(),
-           array_->values()->size());
+    std::vector<std::shared_ptr<ObjectBase>> blobs;
+    RETURN_ON_ERROR(this->TakeBlobs(client, blobs));
 
     this->set_byte_width_(array_->byte_width());
     this->set_length_(array_->length());
     this->set_null_count_(array_->null_count());
     this->set_offset_(array_->offset());
-    this->set_buffer_(std::shared_ptr<BlobWriter>(std::move(buffer_writer)));
-    BUILD_NULL_BITMAP(this, array_);
+    this->set_buffer_(blobs[0]);
+    BUILD_NULL_BITMAP(this, array_, blobs, 1);
     return Status::OK();
   }
 
@@ -300,24 +467,25 @@ inline std::shared_ptr<ObjectBuilder> BuildSimpleArray(
  *
  */
 template <typename ArrayType>
-class BaseListArrayBuilder : public BaseListArrayBaseBuilder<ArrayType> {
+class BaseListArrayBuilder : public BaseListArrayBaseBuilder<ArrayType>,
+                             public detail::ArrowBufferBuilder {
  public:
   BaseListArrayBuilder(Client& client, std::shared_ptr<ArrayType> array)
       : BaseListArrayBaseBuilder<ArrayType>(client), array_(array) {}
 
   std::shared_ptr<ArrayType> GetArray() { return array_; }
 
+  void CollectBuffers(
+      std::vector<std::shared_ptr<arrow::Buffer>>& buffers) override {
+    buffers.emplace_back(array_->value_offsets());
+    COLLECT_NULL_BITMAP(buffers, array_);
+  }
+
   Status Build(Client& client) override {
-    {
-      std::unique_ptr<BlobWriter> buffer_writer;
-      RETURN_ON_ERROR(
-          client.CreateBlob(array_->value_offsets()->size(), buffer_writer));
-      memcpy(buffer_writer->data(), array_->value_offsets()->data(),
-             array_->value_offsets()->size());
+    std::vector<std::shared_ptr<ObjectBase>> blobs;
+    RETURN_ON_ERROR(this->TakeBlobs(client, blobs));
 
-      this->set_buffer_offsets_(
-          std::shared_ptr<BlobWriter>(std::move(buffer_writer)));
-    }
+    this->set_buffer_offsets_(blobs[0]);
     {
       // Assuming the list is not nested.
       // We need to split the definition to .cc if someday we need to consider
@@ -327,7 +495,7 @@ class BaseListArrayBuilder : public BaseListArrayBaseBuilder<ArrayType> {
     this->set_length_(array_->length());
     this->set_null_count_(array_->null_count());
     this->set_offset_(array_->offset());
-    BUILD_NULL_BITMAP(this, array_);
+    BUILD_NULL_BITMAP(this, array_, blobs, 1);
     return Status::OK();
   }
 
@@ -339,8 +507,17 @@ using ListArrayBuilder = BaseListArrayBuilder<arrow::ListArray>;
 using LargeListArrayBuilder = BaseListArrayBuilder<arrow::LargeListArray>;
 
 #undef BUILD_NULL_BITMAP
+#undef COLLECT_NULL_BITMAP
 
 namespace detail {
+
+/**
+ * @brief Build the encoded array if the encoding saves memory, otherwise
+ * returns nullptr, see also "basic/ds/encoded_array.h".
+ */
+std::shared_ptr<ObjectBuilder> BuildEncodedArray(
+    Client& client, std::shared_ptr<arrow::Array> const& array);
+
 inline std::shared_ptr<ObjectBuilder> BuildArray(
     Client& client, std::shared_ptr<arrow::Array> array) {
   if (auto arr = std::dynamic_pointer_cast<arrow::ListArray>(array)) {
@@ -389,6 +566,18 @@ class SchemaProxyBuilder : public SchemaProxyBaseBuilder {
   std::shared_ptr<arrow::Schema> schema_;
 };
 
+namespace detail {
+
+/**
+ * @brief Build the proxy of the schema. Identical schemas built by the
+ * clients of the same instance are interned, i.e., share one sealed
+ * `SchemaProxy`, unless `VINEYARD_INTERN_SCHEMA` is set to "0" or "false".
+ */
+std::shared_ptr<ObjectBase> BuildSchema(
+    Client& client, std::shared_ptr<arrow::Schema> const& schema);
+
+}  // namespace detail
+
 /**
  * @brief RecordBatchBuilder is used for generating the batch of rows of columns
  * of equal length
@@ -399,25 +588,120 @@ class RecordBatchBuilder : public RecordBatchBaseBuilder {
   RecordBatchBuilder(Client& client, std::shared_ptr<arrow::RecordBatch> batch)
       : RecordBatchBaseBuilder(client), batch_(batch) {}
 
+  /**
+   * @brief Keep the columns encoded (e.g., bit-packed) where the encoding
+   * saves memory, the columns are decoded on access.
+   */
+  void SetCompression(bool const compression) { compression_ = compression; }
+
+  /**
+   * @brief Keep the zone maps (null count, min and max) of the columns in the
+   * metadata of the batch, to let the consumers skip the batch without
+   * mapping its blobs, see also `RecordBatch::MayMatch`.
+   */
+  void SetStatistics(bool const statistics) { statistics_ = statistics; }
+
   Status Build(Client& client) override {
+    if (statistics_) {
+      column_statistics_ = json::array();
+      for (int64_t idx = 0; idx < batch_->num_columns(); ++idx) {
+        column_statistics_.push_back(ArrayStatistics(batch_->column(idx)));
+      }
+    }
     this->set_column_num_(batch_->num_columns());
     this->set_row_num_(batch_->num_rows());
-    this->set_schema_(
-        std::make_shared<SchemaProxyBuilder>(client, batch_->schema()));
+    this->set_schema_(detail::BuildSchema(client, batch_->schema()));
+    std::vector<std::shared_ptr<ObjectBuilder>> columns;
     for (int64_t idx = 0; idx < batch_->num_columns(); ++idx) {
-      this->add_columns_(detail::BuildArray(client, batch_->column(idx)));
+      std::shared_ptr<ObjectBuilder> column;
+      if (compression_) {
+        column = detail::BuildEncodedArray(client, batch_->column(idx));
+      }
+      if (column == nullptr) {
+        column = detail::BuildArray(client, batch_->column(idx));
+      }
+      columns.emplace_back(column);
+    }
+    // create blobs for all columns in one round trip
+    RETURN_ON_ERROR(detail::PrepareBlobs(client, columns));
+    for (auto const& column : columns) {
+      this->add_columns_(column);
     }
     return Status::OK();
   }
 
+  /**
+   * @brief Same as the generated one, besides the statistics are kept in the
+   * metadata as well.
+   */
+  std::shared_ptr<Object> _Seal(Client& client) override {
+    if (!statistics_) {
+      return RecordBatchBaseBuilder::_Seal(client);
+    }
+    // ensure the builder hasn't been sealed yet.
+    ENSURE_NOT_SEALED(this);
+
+    VINEYARD_CHECK_OK(this->Build(client));
+    auto __value = std::make_shared<RecordBatch>();
+
+    size_t __value_nbytes = 0;
+
+    __value->meta_.SetTypeName(type_name<RecordBatch>());
+
+    __value->column_num_ = this->column_num_;
+    __value->meta_.AddKeyValue("column_num_", __value->column_num_);
+
+    __value->row_num_ = this->row_num_;
+    __value->meta_.AddKeyValue("row_num_", __value->row_num_);
+
+    auto __value_schema_ =
+        std::dynamic_pointer_cast<SchemaProxy>(this->schema_->_Seal(client));
+    __value->schema_ = *__value_schema_;
+    __value->meta_.AddMember("schema_", __value->schema_);
+    __value_nbytes += __value_schema_->nbytes();
+
+    size_t __columns__idx = 0;
+    for (auto& __columns__value : this->columns_) {
+      auto __value_columns_ =
+          std::dynamic_pointer_cast<Object>(__columns__value->_Seal(client));
+      __value->columns_.emplace_back(__value_columns_);
+      __value->meta_.AddMember("__columns_-" + std::to_string(__columns__idx),
+                               __value_columns_);
+      __value_nbytes += __value_columns_->nbytes();
+      __columns__idx += 1;
+    }
+    __value->meta_.AddKeyValue("__columns_-size", __value->columns_.size());
+
+    __value->meta_.AddKeyValue("statistics_",
+                               json_to_string(column_statistics_));
+
+    __value->meta_.SetNBytes(__value_nbytes);
+
+    VINEYARD_CHECK_OK(client.CreateMetaData(__value->meta_, __value->id_));
+
+    // mark the builder as sealed
+    this->set_sealed(true);
+
+    // run `PostConstruct` to return a valid object
+    __value->PostConstruct(__value->meta_);
+    return std::static_pointer_cast<Object>(__value);
+  }
+
  private:
   std::shared_ptr<arrow::RecordBatch> batch_;
+  bool compression_ = false;
+  bool statistics_ = false;
+  json column_statistics_;
 };
 
 /**
  * @brief RecordBatchExtender supports extending the batch of rows of columns of
  * equal length
  *
+ * The existing columns are sealed objects and are referred as they are, only
+ * the newly added columns are copied into blobs. The statistics of the batch
+ * (see `RecordBatchBuilder::SetStatistics`) are kept, and extended with the
+ * statistics of the new columns.
  */
 class RecordBatchExtender : public RecordBatchBaseBuilder {
  public:
@@ -426,6 +710,7 @@ class RecordBatchExtender : public RecordBatchBaseBuilder {
     row_num_ = batch->num_rows();
     column_num_ = batch->num_columns();
     schema_ = batch->schema();
+    column_statistics_ = RecordBatch::Statistics(batch->meta());
     for (auto const& column : batch->columns()) {
       this->add_columns_(column);
     }
@@ -455,21 +740,107 @@ class RecordBatchExtender : public RecordBatchBaseBuilder {
     return Status::OK();
   }
 
+  /**
+   * @brief Create the builders of the newly added columns, and append them
+   * to `builders`, the blobs of them could be prepared together with other
+   * batches (see `detail::PrepareBlobs`) before sealing.
+   */
+  void PrepareColumns(Client& client,
+                      std::vector<std::shared_ptr<ObjectBuilder>>& builders) {
+    if (new_columns_.size() != arrow_columns_.size()) {
+      new_columns_.clear();
+      for (auto const& column : arrow_columns_) {
+        new_columns_.emplace_back(detail::BuildArray(client, column));
+      }
+    }
+    builders.insert(builders.end(), new_columns_.begin(), new_columns_.end());
+  }
+
  public:
   Status Build(Client& client) override {
     this->set_row_num_(row_num_);
     this->set_column_num_(column_num_);
-    this->set_schema_(std::make_shared<SchemaProxyBuilder>(client, schema_));
-    for (size_t idx = 0; idx < arrow_columns_.size(); ++idx) {
-      this->add_columns_(detail::BuildArray(client, arrow_columns_[idx]));
+    this->set_schema_(detail::BuildSchema(client, schema_));
+    if (new_columns_.size() != arrow_columns_.size()) {
+      std::vector<std::shared_ptr<ObjectBuilder>> columns;
+      PrepareColumns(client, columns);
+      // create blobs for all new columns in one round trip
+      RETURN_ON_ERROR(detail::PrepareBlobs(client, columns));
+    }
+    for (auto const& column : new_columns_) {
+      this->add_columns_(column);
+    }
+    if (column_statistics_.is_array()) {
+      for (auto const& column : arrow_columns_) {
+        column_statistics_.push_back(ArrayStatistics(column));
+      }
     }
     return Status::OK();
   }
 
+  /**
+   * @brief Same as `RecordBatchBuilder::_Seal`, the statistics are kept only
+   * when the extended batch has statistics.
+   */
+  std::shared_ptr<Object> _Seal(Client& client) override {
+    if (!column_statistics_.is_array()) {
+      return RecordBatchBaseBuilder::_Seal(client);
+    }
+    // ensure the builder hasn't been sealed yet.
+    ENSURE_NOT_SEALED(this);
+
+    VINEYARD_CHECK_OK(this->Build(client));
+    auto __value = std::make_shared<RecordBatch>();
+
+    size_t __value_nbytes = 0;
+
+    __value->meta_.SetTypeName(type_name<RecordBatch>());
+
+    __value->column_num_ = this->column_num_;
+    __value->meta_.AddKeyValue("column_num_", __value->column_num_);
+
+    __value->row_num_ = this->row_num_;
+    __value->meta_.AddKeyValue("row_num_", __value->row_num_);
+
+    auto __value_schema_ = std::dynamic_pointer_cast<SchemaProxy>(
+        RecordBatchBaseBuilder::schema_->_Seal(client));
+    __value->schema_ = *__value_schema_;
+    __value->meta_.AddMember("schema_", __value->schema_);
+    __value_nbytes += __value_schema_->nbytes();
+
+    size_t __columns__idx = 0;
+    for (auto& __columns__value : this->columns_) {
+      auto __value_columns_ =
+          std::dynamic_pointer_cast<Object>(__columns__value->_Seal(client));
+      __value->columns_.emplace_back(__value_columns_);
+      __value->meta_.AddMember("__columns_-" + std::to_string(__columns__idx),
+                               __value_columns_);
+      __value_nbytes += __value_columns_->nbytes();
+      __columns__idx += 1;
+    }
+    __value->meta_.AddKeyValue("__columns_-size", __value->columns_.size());
+
+    __value->meta_.AddKeyValue("statistics_",
+                               json_to_string(column_statistics_));
+
+    __value->meta_.SetNBytes(__value_nbytes);
+
+    VINEYARD_CHECK_OK(client.CreateMetaData(__value->meta_, __value->id_));
+
+    // mark the builder as sealed
+    this->set_sealed(true);
+
+    // run `PostConstruct` to return a valid object
+    __value->PostConstruct(__value->meta_);
+    return std::static_pointer_cast<Object>(__value);
+  }
+
  private:
   size_t row_num_ = 0, column_num_ = 0;
   std::shared_ptr<arrow::Schema> schema_;
   std::vector<std::shared_ptr<arrow::Array>> arrow_columns_;
+  std::vector<std::shared_ptr<ObjectBuilder>> new_columns_;
+  json column_statistics_;
 };
 
 /**
@@ -482,6 +853,16 @@ class TableBuilder : public TableBaseBuilder {
   TableBuilder(Client& client, std::shared_ptr<arrow::Table> table)
       : TableBaseBuilder(client), table_(table) {}
 
+  /**
+   * @brief See also `RecordBatchBuilder::SetCompression`.
+   */
+  void SetCompression(bool const compression) { compression_ = compression; }
+
+  /**
+   * @brief See also `RecordBatchBuilder::SetStatistics`.
+   */
+  void SetStatistics(bool const statistics) { statistics_ = statistics; }
+
  public:
   Status Build(Client& client) override {
     std::vector<std::shared_ptr<arrow::RecordBatch>> batches;
@@ -490,15 +871,19 @@ class TableBuilder : public TableBaseBuilder {
     this->set_num_rows_(table_->num_rows());
     this->set_num_columns_(table_->num_columns());
     for (auto const& batch : batches) {
-      this->add_batches_(std::make_shared<RecordBatchBuilder>(client, batch));
+      auto builder = std::make_shared<RecordBatchBuilder>(client, batch);
+      builder->SetCompression(compression_);
+      builder->SetStatistics(statistics_);
+      this->add_batches_(builder);
     }
-    this->set_schema_(
-        std::make_shared<SchemaProxyBuilder>(client, table_->schema()));
+    this->set_schema_(detail::BuildSchema(client, table_->schema()));
     return Status::OK();
   }
 
  private:
   std::shared_ptr<arrow::Table> table_;
+  bool compression_ = false;
+  bool statistics_ = false;
 };
 
 /**
@@ -581,10 +966,16 @@ class TableExtender : public TableBaseBuilder {
     this->set_batch_num_(record_batch_extenders_.size());
     this->set_num_rows_(row_num_);
     this->set_num_columns_(column_num_);
+    // create blobs for the new columns of all batches in one round trip
+    std::vector<std::shared_ptr<ObjectBuilder>> columns;
+    for (auto const& extender : record_batch_extenders_) {
+      extender->PrepareColumns(client, columns);
+    }
+    RETURN_ON_ERROR(detail::PrepareBlobs(client, columns));
     for (auto const& extender : record_batch_extenders_) {
       this->add_batches_(extender);
     }
-    this->set_schema_(std::make_shared<SchemaProxyBuilder>(client, schema_));
+    this->set_schema_(detail::BuildSchema(client, schema_));
     return Status::OK();
   }
 
@@ -0,0 +1,348 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+
+#include "basic/ds/arrow_memory_pool.h"
+
+#include <algorithm>
+#include <cstring>
+#include <set>
+#include <vector>
+
+#include "basic/ds/arrow_utils.h"
+
+namespace vineyard {
+
+namespace {
+
+// arrow requires a valid, aligned pointer for zero-size allocations
+alignas(64) uint8_t zero_size_area[1];
+
+std::mutex& live_pools_mutex() {
+  static std::mutex* mutex = new std::mutex();
+  return *mutex;
+}
+
+std::set<VineyardMemoryPool*>& live_pools() {
+  static std::set<VineyardMemoryPool*>* pools =
+      new std::set<VineyardMemoryPool*>();
+  return *pools;
+}
+
+inline void update_max_memory(std::atomic<int64_t>& max_memory,
+                              const int64_t allocated) {
+  int64_t current = max_memory.load();
+  while (allocated > current &&
+         !max_memory.compare_exchange_weak(current, allocated)) {
+  }
+}
+
+#if defined(WITH_JEMALLOC)
+std::set<VineyardArenaMemoryPool*>& live_arena_pools() {
+  static std::set<VineyardArenaMemoryPool*>* pools =
+      new std::set<VineyardArenaMemoryPool*>();
+  return *pools;
+}
+#endif
+
+}  // namespace
+
+VineyardMemoryPool::VineyardMemoryPool(Client& client) : client_(client) {
+  std::lock_guard<std::mutex> lock(live_pools_mutex());
+  live_pools().emplace(this);
+}
+
+VineyardMemoryPool::~VineyardMemoryPool() {
+  {
+    std::lock_guard<std::mutex> lock(live_pools_mutex());
+    live_pools().erase(this);
+  }
+  // the blobs that are still in use by arrow buffers are kept, as they will
+  // be released once the client disconnects.
+}
+
+#if defined(ARROW_VERSION) && ARROW_VERSION >= 9000000
+arrow::Status VineyardMemoryPool::Allocate(int64_t size, int64_t alignment,
+                                           uint8_t** out) {
+  return allocate(size, out);
+}
+
+arrow::Status VineyardMemoryPool::Reallocate(int64_t old_size,
+                                             int64_t new_size,
+                                             int64_t alignment,
+                                             uint8_t** ptr) {
+  return reallocate(old_size, new_size, ptr);
+}
+
+void VineyardMemoryPool::Free(uint8_t* buffer, int64_t size,
+                              int64_t alignment) {
+  free(buffer, size);
+}
+#else
+arrow::Status VineyardMemoryPool::Allocate(int64_t size, uint8_t** out) {
+  return allocate(size, out);
+}
+
+arrow::Status VineyardMemoryPool::Reallocate(int64_t old_size,
+                                             int64_t new_size,
+                                             uint8_t** ptr) {
+  return reallocate(old_size, new_size, ptr);
+}
+
+void VineyardMemoryPool::Free(uint8_t* buffer, int64_t size) {
+  free(buffer, size);
+}
+#endif
+
+std::shared_ptr<BlobWriter> VineyardMemoryPool::Take(Client& client,
+                                                     const uint8_t* data) {
+  std::lock_guard<std::mutex> lock(live_pools_mutex());
+  for (auto pool : live_pools()) {
+    if (&pool->client_ != &client) {
+      continue;
+    }
+    if (auto blob = pool->take(data)) {
+      return blob;
+    }
+  }
+  return nullptr;
+}
+
+arrow::Status VineyardMemoryPool::allocate(int64_t size, uint8_t** out) {
+  if (size < 0) {
+    return arrow::Status::Invalid("Negative allocation size requested");
+  }
+  if (size == 0) {
+    *out = zero_size_area;
+    return arrow::Status::OK();
+  }
+  std::unique_ptr<BlobWriter> blob;
+  auto status = client_.CreateBlob(size, blob);
+  if (!status.ok()) {
+    return arrow::Status::OutOfMemory("Failed to allocate from vineyard: ",
+                                      status.ToString());
+  }
+  *out = reinterpret_cast<uint8_t*>(blob->data());
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    blobs_.emplace(*out, std::move(blob));
+  }
+  update_max_memory(max_memory_, bytes_allocated_ += size);
+  return arrow::Status::OK();
+}
+
+arrow::Status VineyardMemoryPool::reallocate(int64_t old_size,
+                                             int64_t new_size, uint8_t** ptr) {
+  if (*ptr != zero_size_area && new_size > old_size) {
+    // grow in place if possible
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto iter = blobs_.find(*ptr);
+    if (iter != blobs_.end() &&
+        iter->second->Extend(client_, new_size).ok()) {
+      bytes_allocated_ += new_size - old_size;
+      return arrow::Status::OK();
+    }
+  }
+  uint8_t* out = nullptr;
+  ARROW_RETURN_NOT_OK(allocate(new_size, &out));
+  memcpy(out, *ptr, std::min(old_size, new_size));
+  free(*ptr, old_size);
+  *ptr = out;
+  return arrow::Status::OK();
+}
+
+void VineyardMemoryPool::free(uint8_t* buffer, int64_t size) {
+  if (buffer == zero_size_area) {
+    return;
+  }
+  std::unique_ptr<BlobWriter> blob;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto iter = blobs_.find(buffer);
+    if (iter == blobs_.end()) {
+      // has been taken, and sealed.
+      return;
+    }
+    blob = std::move(iter->second);
+    blobs_.erase(iter);
+  }
+  bytes_allocated_ -= size;
+  VINEYARD_DISCARD(blob->Abort(client_));
+}
+
+std::shared_ptr<BlobWriter> VineyardMemoryPool::take(const uint8_t* data) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto iter = blobs_.find(data);
+  if (iter == blobs_.end()) {
+    return nullptr;
+  }
+  std::shared_ptr<BlobWriter> blob = std::move(iter->second);
+  blobs_.erase(iter);
+  bytes_allocated_ -= blob->size();
+  return blob;
+}
+
+#if defined(WITH_JEMALLOC)
+
+VineyardArenaMemoryPool::VineyardArenaMemoryPool(Client& client,
+                                                 const size_t size)
+    : client_(client) {
+  VINEYARD_CHECK_OK(
+      client_.CreateArena(size, fd_, available_size_, base_, space_));
+  jemalloc_.Init(reinterpret_cast<void*>(space_), available_size_);
+  std::lock_guard<std::mutex> lock(live_pools_mutex());
+  live_arena_pools().emplace(this);
+}
+
+VineyardArenaMemoryPool::~VineyardArenaMemoryPool() {
+  {
+    std::lock_guard<std::mutex> lock(live_pools_mutex());
+    live_arena_pools().erase(this);
+  }
+  VINEYARD_DISCARD(Release());
+}
+
+#if defined(ARROW_VERSION) && ARROW_VERSION >= 9000000
+arrow::Status VineyardArenaMemoryPool::Allocate(int64_t size,
+                                                int64_t alignment,
+                                                uint8_t** out) {
+  return allocate(size, alignment, out);
+}
+
+arrow::Status VineyardArenaMemoryPool::Reallocate(int64_t old_size,
+                                                  int64_t new_size,
+                                                  int64_t alignment,
+                                                  uint8_t** ptr) {
+  return reallocate(old_size, new_size, alignment, ptr);
+}
+
+void VineyardArenaMemoryPool::Free(uint8_t* buffer, int64_t size,
+                                   int64_t alignment) {
+  free(buffer, size);
+}
+#else
+arrow::Status VineyardArenaMemoryPool::Allocate(int64_t size, uint8_t** out) {
+  return allocate(size, arrow::kDefaultBufferAlignment, out);
+}
+
+arrow::Status VineyardArenaMemoryPool::Reallocate(int64_t old_size,
+                                                  int64_t new_size,
+                                                  uint8_t** ptr) {
+  return reallocate(old_size, new_size, arrow::kDefaultBufferAlignment, ptr);
+}
+
+void VineyardArenaMemoryPool::Free(uint8_t* buffer, int64_t size) {
+  free(buffer, size);
+}
+#endif
+
+std::shared_ptr<Blob> VineyardArenaMemoryPool::Freeze(const uint8_t* data) {
+  if (data == zero_size_area || !contains(data)) {
+    return nullptr;
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (released_ || frozen_.find(data) != frozen_.end()) {
+    return nullptr;
+  }
+  size_t size = jemalloc_.GetAllocatedSize(const_cast<uint8_t*>(data));
+  size_t offset = reinterpret_cast<uintptr_t>(data) - space_;
+  offsets_.emplace_back(offset);
+  sizes_.emplace_back(size);
+  frozen_.emplace(data);
+  return Blob::FromBuffer(client_, GenerateBlobID(base_ + offset), size,
+                          reinterpret_cast<uintptr_t>(data));
+}
+
+std::shared_ptr<Blob> VineyardArenaMemoryPool::Freeze(Client& client,
+                                                      const uint8_t* data) {
+  std::lock_guard<std::mutex> lock(live_pools_mutex());
+  for (auto pool : live_arena_pools()) {
+    if (&pool->client_ != &client || !pool->contains(data)) {
+      continue;
+    }
+    return pool->Freeze(data);
+  }
+  return nullptr;
+}
+
+Status VineyardArenaMemoryPool::Release() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (released_) {
+    return Status::OK();
+  }
+  released_ = true;
+  VLOG(10) << "arena memory pool finalized: " << offsets_.size()
+           << " blocks are frozen.";
+  return client_.ReleaseArena(fd_, offsets_, sizes_);
+}
+
+arrow::Status VineyardArenaMemoryPool::allocate(int64_t size,
+                                                int64_t alignment,
+                                                uint8_t** out) {
+  if (size < 0) {
+    return arrow::Status::Invalid("Negative allocation size requested");
+  }
+  if (size == 0) {
+    *out = zero_size_area;
+    return arrow::Status::OK();
+  }
+  if (released_) {
+    return arrow::Status::Invalid("The arena memory pool has been released");
+  }
+  *out = reinterpret_cast<uint8_t*>(jemalloc_.Allocate(
+      size, std::max<int64_t>(alignment, arrow::kDefaultBufferAlignment)));
+  if (*out == nullptr) {
+    return arrow::Status::OutOfMemory("Failed to allocate ", size,
+                                      " bytes from the vineyard arena");
+  }
+  update_max_memory(max_memory_, bytes_allocated_ += size);
+  return arrow::Status::OK();
+}
+
+arrow::Status VineyardArenaMemoryPool::reallocate(int64_t old_size,
+                                                  int64_t new_size,
+                                                  int64_t alignment,
+                                                  uint8_t** ptr) {
+  if (*ptr != zero_size_area && new_size > old_size &&
+      jemalloc_.ReallocateInPlace(*ptr, new_size)) {
+    update_max_memory(max_memory_, bytes_allocated_ += new_size - old_size);
+    return arrow::Status::OK();
+  }
+  uint8_t* out = nullptr;
+  ARROW_RETURN_NOT_OK(allocate(new_size, alignment, &out));
+  memcpy(out, *ptr, std::min(old_size, new_size));
+  free(*ptr, old_size);
+  *ptr = out;
+  return arrow::Status::OK();
+}
+
+void VineyardArenaMemoryPool::free(uint8_t* buffer, int64_t size) {
+  if (buffer == zero_size_area) {
+    return;
+  }
+  bytes_allocated_ -= size;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (released_ || frozen_.find(buffer) != frozen_.end()) {
+      // the memory belongs to a blob, or has been recycled with the arena
+      return;
+    }
+  }
+  jemalloc_.Free(buffer, size);
+}
+
+#endif  // WITH_JEMALLOC
+
+}  // namespace vineyard
@@ -0,0 +1,188 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+
+#ifndef MODULES_BASIC_DS_ARROW_MEMORY_POOL_H_
+#define MODULES_BASIC_DS_ARROW_MEMORY_POOL_H_
+
+#include <atomic>
+#include <memory>
+#include <limits>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "arrow/memory_pool.h"
+#include "arrow/util/config.h"
+
+#include "client/client.h"
+#include "client/ds/blob.h"
+#include "common/memory/jemalloc.h"
+
+namespace vineyard {
+
+/**
+ * @brief VineyardMemoryPool is an `arrow::MemoryPool` that allocates memory
+ * from blobs in the vineyard server, thus arrays that are built with (e.g.,
+ * read by arrow's readers into) the pool could be sealed into vineyard
+ * without copying, see also `detail::CopyToBlobs`.
+ *
+ * Every allocation is a round trip to the vineyard server, the pool is meant
+ * for large buffers, e.g., the column chunks of parquet and orc files.
+ */
+class VineyardMemoryPool : public arrow::MemoryPool {
+ public:
+  explicit VineyardMemoryPool(Client& client);
+
+  ~VineyardMemoryPool() override;
+
+#if defined(ARROW_VERSION) && ARROW_VERSION >= 9000000
+  arrow::Status Allocate(int64_t size, int64_t alignment,
+                         uint8_t** out) override;
+
+  arrow::Status Reallocate(int64_t old_size, int64_t new_size,
+                           int64_t alignment, uint8_t** ptr) override;
+
+  void Free(uint8_t* buffer, int64_t size, int64_t alignment) override;
+#else
+  arrow::Status Allocate(int64_t size, uint8_t** out) override;
+
+  arrow::Status Reallocate(int64_t old_size, int64_t new_size,
+                           uint8_t** ptr) override;
+
+  void Free(uint8_t* buffer, int64_t size) override;
+#endif
+
+  int64_t bytes_allocated() const override { return bytes_allocated_.load(); }
+
+  int64_t max_memory() const override { return max_memory_.load(); }
+
+  std::string backend_name() const override { return "vineyard"; }
+
+  /**
+   * @brief Take the ownership of the blob that starts at `data` from the pool
+   * (and from any live pool of the client), the blob won't be released when
+   * the arrow buffer is freed. Returns nullptr if the memory is not allocated
+   * by such pools.
+   */
+  static std::shared_ptr<BlobWriter> Take(Client& client, const uint8_t* data);
+
+ private:
+  arrow::Status allocate(int64_t size, uint8_t** out);
+  arrow::Status reallocate(int64_t old_size, int64_t new_size, uint8_t** ptr);
+  void free(uint8_t* buffer, int64_t size);
+
+  std::shared_ptr<BlobWriter> take(const uint8_t* data);
+
+  Client& client_;
+  std::mutex mutex_;
+  std::unordered_map<const uint8_t*, std::unique_ptr<BlobWriter>> blobs_;
+  std::atomic<int64_t> bytes_allocated_{0};
+  std::atomic<int64_t> max_memory_{0};
+};
+
+#if defined(WITH_JEMALLOC)
+
+/**
+ * @brief VineyardArenaMemoryPool is an `arrow::MemoryPool` that allocates
+ * memory from a jemalloc arena mapped from the vineyard server (see also
+ * `VineyardAllocator`), allocations don't involve round trips to the
+ * server and the pool is suitable for builders that produce many small
+ * buffers, e.g., the csv reader.
+ *
+ * Buffers are frozen into blobs in place by `Freeze`, frozen blobs become
+ * available in the vineyard server once the pool is released (by `Release`
+ * or the destructor), before getting the objects that are built on them.
+ */
+class VineyardArenaMemoryPool : public arrow::MemoryPool {
+ public:
+  explicit VineyardArenaMemoryPool(
+      Client& client, const size_t size = std::numeric_limits<size_t>::max());
+
+  ~VineyardArenaMemoryPool() override;
+
+#if defined(ARROW_VERSION) && ARROW_VERSION >= 9000000
+  arrow::Status Allocate(int64_t size, int64_t alignment,
+                         uint8_t** out) override;
+
+  arrow::Status Reallocate(int64_t old_size, int64_t new_size,
+                           int64_t alignment, uint8_t** ptr) override;
+
+  void Free(uint8_t* buffer, int64_t size, int64_t alignment) override;
+#else
+  arrow::Status Allocate(int64_t size, uint8_t** out) override;
+
+  arrow::Status Reallocate(int64_t old_size, int64_t new_size,
+                           uint8_t** ptr) override;
+
+  void Free(uint8_t* buffer, int64_t size) override;
+#endif
+
+  int64_t bytes_allocated() const override { return bytes_allocated_.load(); }
+
+  int64_t max_memory() const override { return max_memory_.load(); }
+
+  std::string backend_name() const override { return "vineyard-jemalloc"; }
+
+  /**
+   * @brief Freeze the buffer that starts at `data` into a blob, the memory
+   * won't be reused by the pool after that. Returns nullptr if the memory
+   * is not allocated by the pool.
+   */
+  std::shared_ptr<Blob> Freeze(const uint8_t* data);
+
+  /**
+   * @brief Freeze the buffer in any live arena pool of the client.
+   */
+  static std::shared_ptr<Blob> Freeze(Client& client, const uint8_t* data);
+
+  /**
+   * @brief Hand the frozen blobs over to the vineyard server, the remaining
+   * memory of the arena is recycled and the pool cannot allocate anymore.
+   */
+  Status Release();
+
+ private:
+  arrow::Status allocate(int64_t size, int64_t alignment, uint8_t** out);
+  arrow::Status reallocate(int64_t old_size, int64_t new_size,
+                           int64_t alignment, uint8_t** ptr);
+  void free(uint8_t* buffer, int64_t size);
+
+  bool contains(const uint8_t* data) const {
+    auto pointer = reinterpret_cast<uintptr_t>(data);
+    return pointer >= space_ && pointer < space_ + available_size_;
+  }
+
+  Client& client_;
+  memory::Jemalloc jemalloc_;
+  int fd_ = -1;
+  uintptr_t base_ = 0, space_ = 0;
+  size_t available_size_ = 0;
+  bool released_ = false;
+
+  std::mutex mutex_;
+  std::vector<size_t> offsets_, sizes_;
+  std::unordered_set<const uint8_t*> frozen_;
+  std::atomic<int64_t> bytes_allocated_{0};
+  std::atomic<int64_t> max_memory_{0};
+};
+
+#endif  // WITH_JEMALLOC
+
+}  // namespace vineyard
+
+#endif  // MODULES_BASIC_DS_ARROW_MEMORY_POOL_H_
@@ -15,6 +15,11 @@ limitations under the License.
 
 #include "basic/ds/arrow_utils.h"
 
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <map>
+
 #include "arrow/io/memory.h"
 #include "arrow/ipc/options.h"
 #include "arrow/ipc/reader.h"
@@ -22,8 +27,140 @@ limitations under the License.
 #include "arrow/record_batch.h"
 #include "arrow/util/config.h"
 
+#include "common/memory/memcpy.h"
+
 namespace vineyard {
 
+namespace detail {
+
+template <typename T>
+inline bool is_nan(T const& value) {
+  return false;
+}
+
+template <>
+inline bool is_nan<float>(float const& value) {
+  return std::isnan(value);
+}
+
+template <>
+inline bool is_nan<double>(double const& value) {
+  return std::isnan(value);
+}
+
+template <typename ArrayType>
+void CollectMinMax(std::shared_ptr<arrow::Array> const& values, json& stats) {
+  auto array = std::dynamic_pointer_cast<ArrayType>(values);
+  bool found = false;
+  decltype(array->Value(0)) low{}, high{};
+  for (int64_t idx = 0; idx < array->length(); ++idx) {
+    if (array->IsNull(idx) || is_nan(array->Value(idx))) {
+      continue;
+    }
+    auto value = array->Value(idx);
+    if (!found) {
+      low = high = value;
+      found = true;
+    } else if (value < low) {
+      low = value;
+    } else if (high < value) {
+      high = value;
+    }
+  }
+  if (found) {
+    stats["min"] = low;
+    stats["max"] = high;
+  }
+}
+
+template <typename ArrayType>
+void CollectStringMinMax(std::shared_ptr<arrow::Array> const& values,
+                         json& stats) {
+  static constexpr size_t kMaxStatisticsStringSize = 256;
+  auto array = std::dynamic_pointer_cast<ArrayType>(values);
+  bool found = false;
+  decltype(array->GetView(0)) low, high;
+  for (int64_t idx = 0; idx < array->length(); ++idx) {
+    if (array->IsNull(idx)) {
+      continue;
+    }
+    auto value = array->GetView(idx);
+    if (!found) {
+      low = high = value;
+      found = true;
+    } else if (value < low) {
+      low = value;
+    } else if (high < value) {
+      high = value;
+    }
+  }
+  if (found && low.size() <= kMaxStatisticsStringSize &&
+      high.size() <= kMaxStatisticsStringSize) {
+    stats["min"] = std::string(low.data(), low.size());
+    stats["max"] = std::string(high.data(), high.size());
+  }
+}
+
+}  // namespace detail
+
+json ArrayStatistics(std::shared_ptr<arrow::Array> const& array) {
+  json stats;
+  stats["null_count"] = array->null_count();
+  switch (array->type()->id()) {
+  case arrow::Type::BOOL:
+    detail::CollectMinMax<arrow::BooleanArray>(array, stats);
+    break;
+  case arrow::Type::INT8:
+    detail::CollectMinMax<arrow::Int8Array>(array, stats);
+    break;
+  case arrow::Type::UINT8:
+    detail::CollectMinMax<arrow::UInt8Array>(array, stats);
+    break;
+  case arrow::Type::INT16:
+    detail::CollectMinMax<arrow::Int16Array>(array, stats);
+    break;
+  case arrow::Type::UINT16:
+    detail::CollectMinMax<arrow::UInt16Array>(array, stats);
+    break;
+  case arrow::Type::INT32:
+    detail::CollectMinMax<arrow::Int32Array>(array, stats);
+    break;
+  case arrow::Type::UINT32:
+    detail::CollectMinMax<arrow::UInt32Array>(array, stats);
+    break;
+  case arrow::Type::INT64:
+    detail::CollectMinMax<arrow::Int64Array>(array, stats);
+    break;
+  case arrow::Type::UINT64:
+    detail::CollectMinMax<arrow::UInt64Array>(array, stats);
+    break;
+  case arrow::Type::FLOAT:
+    detail::CollectMinMax<arrow::FloatArray>(array, stats);
+    break;
+  case arrow::Type::DOUBLE:
+    detail::CollectMinMax<arrow::DoubleArray>(array, stats);
+    break;
+  case arrow::Type::DATE32:
+    detail::CollectMinMax<arrow::Date32Array>(array, stats);
+    break;
+  case arrow::Type::DATE64:
+    detail::CollectMinMax<arrow::Date64Array>(array, stats);
+    break;
+  case arrow::Type::TIMESTAMP:
+    detail::CollectMinMax<arrow::TimestampArray>(array, stats);
+    break;
+  case arrow::Type::STRING:
+    detail::CollectStringMinMax<arrow::StringArray>(array, stats);
+    break;
+  case arrow::Type::LARGE_STRING:
+    detail::CollectStringMinMax<arrow::LargeStringArray>(array, stats);
+    break;
+  default:
+    break;
+  }
+  return stats;
+}
+
 std::shared_ptr<arrow::Table> ConcatenateTables(
     std::vector<std::shared_ptr<arrow::Table>>& tables) {
   if (tables.size() == 1) {
@@ -104,6 +241,113 @@ Status SerializeRecordBatches(
   return Status::OK();
 }
 
+namespace detail {
+
+/**
+ * @brief The output stream that records the writes that fall into the given
+ * buffers as slices of them, and copies the other writes.
+ */
+class GatherOutputStream : public arrow::io::OutputStream {
+ public:
+  explicit GatherOutputStream(
+      std::vector<std::shared_ptr<arrow::Buffer>>* buffers)
+      : buffers_(buffers) {}
+
+  using arrow::io::OutputStream::Write;
+
+  void Refer(std::shared_ptr<arrow::Buffer> const& buffer) {
+    if (buffer != nullptr && buffer->size() > 0) {
+      sources_.emplace(reinterpret_cast<uintptr_t>(buffer->data()), buffer);
+    }
+  }
+
+  ::arrow::Status Close() override {
+    flush();
+    closed_ = true;
+    return ::arrow::Status::OK();
+  }
+
+  bool closed() const override { return closed_; }
+
+#if defined(ARROW_VERSION) && ARROW_VERSION < 17000
+  ::arrow::Status Tell(int64_t* position) const override {
+    *position = position_;
+    return ::arrow::Status::OK();
+  }
+#else
+  ::arrow::Result<int64_t> Tell() const override { return position_; }
+#endif
+
+  ::arrow::Status Write(const void* data, int64_t nbytes) override {
+    if (nbytes <= 0) {
+      return ::arrow::Status::OK();
+    }
+    position_ += nbytes;
+    uintptr_t address = reinterpret_cast<uintptr_t>(data);
+    auto source = sources_.upper_bound(address);
+    if (source != sources_.begin()) {
+      --source;
+      if (address + nbytes <= source->first + source->second->size()) {
+        flush();
+        buffers_->emplace_back(arrow::SliceBuffer(
+            source->second, address - source->first, nbytes));
+        return ::arrow::Status::OK();
+      }
+    }
+    pending_.append(reinterpret_cast<const char*>(data), nbytes);
+    return ::arrow::Status::OK();
+  }
+
+ private:
+  void flush() {
+    if (!pending_.empty()) {
+      buffers_->emplace_back(arrow::Buffer::FromString(std::move(pending_)));
+      pending_.clear();
+    }
+  }
+
+  std::vector<std::shared_ptr<arrow::Buffer>>* buffers_;
+  // start address -> buffer
+  std::map<uintptr_t, std::shared_ptr<arrow::Buffer>> sources_;
+  std::string pending_;
+  int64_t position_ = 0;
+  bool closed_ = false;
+};
+
+static void ReferArrayData(GatherOutputStream& stream,
+                           std::shared_ptr<arrow::ArrayData> const& data) {
+  if (data == nullptr) {
+    return;
+  }
+  for (auto const& buffer : data->buffers) {
+    stream.Refer(buffer);
+  }
+  for (auto const& child : data->child_data) {
+    ReferArrayData(stream, child);
+  }
+#if defined(ARROW_VERSION) && ARROW_VERSION >= 1000000
+  ReferArrayData(stream, data->dictionary);
+#endif
+}
+
+}  // namespace detail
+
+Status SerializeRecordBatchesToBuffers(
+    const std::vector<std::shared_ptr<arrow::RecordBatch>>& batches,
+    std::vector<std::shared_ptr<arrow::Buffer>>* buffers) {
+  RETURN_ON_ASSERT(!batches.empty(), "No record batches to serialize");
+  detail::GatherOutputStream stream(buffers);
+  for (auto const& batch : batches) {
+    for (int i = 0; i < batch->num_columns(); ++i) {
+      detail::ReferArrayData(stream, batch->column(i)->data());
+    }
+  }
+  RETURN_ON_ARROW_ERROR(arrow::ipc::WriteRecordBatchStream(
+      batches, arrow::ipc::IpcOptions::Defaults(), &stream));
+  RETURN_ON_ARROW_ERROR(stream.Close());
+  return Status::OK();
+}
+
 Status DeserializeRecordBatches(
     const std::shared_ptr<arrow::Buffer>& buffer,
     std::vector<std::shared_ptr<arrow::RecordBatch>>* batches) {
@@ -120,6 +364,227 @@ Status DeserializeRecordBatches(
   return Status::OK();
 }
 
+Status SerializeSchema(const arrow::Schema& schema,
+                       std::shared_ptr<arrow::Buffer>* buffer) {
+#if defined(ARROW_VERSION) && ARROW_VERSION < 17000
+  arrow::ipc::DictionaryMemo out_memo;
+  RETURN_ON_ARROW_ERROR(arrow::ipc::SerializeSchema(
+      schema, &out_memo, arrow::default_memory_pool(), buffer));
+#elif defined(ARROW_VERSION) && ARROW_VERSION < 2000000
+  arrow::ipc::DictionaryMemo out_memo;
+  RETURN_ON_ARROW_ERROR_AND_ASSIGN(
+      *buffer, arrow::ipc::SerializeSchema(schema, &out_memo,
+                                           arrow::default_memory_pool()));
+#else
+  RETURN_ON_ARROW_ERROR_AND_ASSIGN(
+      *buffer,
+      arrow::ipc::SerializeSchema(schema, arrow::default_memory_pool()));
+#endif
+  return Status::OK();
+}
+
+Status DeserializeSchema(const std::shared_ptr<arrow::Buffer>& buffer,
+                         std::shared_ptr<arrow::Schema>* schema) {
+  arrow::io::BufferReader reader(buffer);
+  arrow::ipc::DictionaryMemo in_memo;
+#if defined(ARROW_VERSION) && ARROW_VERSION < 17000
+  RETURN_ON_ARROW_ERROR(arrow::ipc::ReadSchema(&reader, &in_memo, schema));
+#else
+  RETURN_ON_ARROW_ERROR_AND_ASSIGN(*schema,
+                                   arrow::ipc::ReadSchema(&reader, &in_memo));
+#endif
+  return Status::OK();
+}
+
+namespace detail {
+
+// The header of the columnar form is a sequence of int64: the number of
+// rows, nodes and buffers, the (length, null count, offset, number of
+// buffers, number of children) of each array node in pre-order, and the
+// (offset, size) of each buffer, where the offset of a null buffer is -1.
+static constexpr int64_t kColumnarNodeFields = 5;
+static constexpr int64_t kColumnarAlignment = 64;
+
+static inline int64_t ColumnarAligned(const int64_t size) {
+  return (size + kColumnarAlignment - 1) / kColumnarAlignment *
+         kColumnarAlignment;
+}
+
+static inline int num_fields_of(const std::shared_ptr<arrow::DataType>& type) {
+#if defined(ARROW_VERSION) && ARROW_VERSION < 1000000
+  return type->num_children();
+#else
+  return type->num_fields();
+#endif
+}
+
+static inline std::shared_ptr<arrow::DataType> field_type_of(
+    const std::shared_ptr<arrow::DataType>& type, const int index) {
+#if defined(ARROW_VERSION) && ARROW_VERSION < 1000000
+  return type->child(index)->type();
+#else
+  return type->field(index)->type();
+#endif
+}
+
+struct ColumnarLayout {
+  std::vector<int64_t> nodes;
+  std::vector<std::shared_ptr<arrow::Buffer>> buffers;
+  std::vector<int64_t> locations;
+  int64_t size = 0;
+};
+
+static Status CollectColumnarArrayData(
+    std::shared_ptr<arrow::ArrayData> const& data, ColumnarLayout& layout) {
+  auto type_id = data->type->id();
+  RETURN_ON_ASSERT(
+      type_id != arrow::Type::DICTIONARY && type_id != arrow::Type::EXTENSION,
+      "unsupported type in the columnar form: " + data->type->ToString());
+  layout.nodes.emplace_back(data->length);
+  layout.nodes.emplace_back(data->GetNullCount());
+  layout.nodes.emplace_back(data->offset);
+  layout.nodes.emplace_back(data->buffers.size());
+  layout.nodes.emplace_back(data->child_data.size());
+  for (auto const& buffer : data->buffers) {
+    layout.buffers.emplace_back(buffer);
+  }
+  for (auto const& child : data->child_data) {
+    RETURN_ON_ERROR(CollectColumnarArrayData(child, layout));
+  }
+  return Status::OK();
+}
+
+static Status MakeColumnarLayout(const arrow::RecordBatch& batch,
+                                 ColumnarLayout& layout) {
+  for (int i = 0; i < batch.num_columns(); ++i) {
+    RETURN_ON_ERROR(CollectColumnarArrayData(batch.column(i)->data(), layout));
+  }
+  int64_t offset = ColumnarAligned(
+      sizeof(int64_t) * (3 + layout.nodes.size() + 2 * layout.buffers.size()));
+  for (auto const& buffer : layout.buffers) {
+    if (buffer == nullptr) {
+      layout.locations.emplace_back(-1);
+      layout.locations.emplace_back(0);
+    } else {
+      layout.locations.emplace_back(offset);
+      layout.locations.emplace_back(buffer->size());
+      offset += ColumnarAligned(buffer->size());
+    }
+  }
+  layout.size = offset;
+  return Status::OK();
+}
+
+class ColumnarReader {
+ public:
+  explicit ColumnarReader(const std::shared_ptr<arrow::Buffer>& buffer)
+      : buffer_(buffer),
+        header_(reinterpret_cast<const int64_t*>(buffer->data())) {}
+
+  Status Open(int64_t* num_rows) {
+    RETURN_ON_ASSERT(buffer_->size() >= static_cast<int64_t>(
+                                            sizeof(int64_t) * 3),
+                     "the columnar batch is truncated");
+    num_nodes_ = header_[1];
+    num_buffers_ = header_[2];
+    RETURN_ON_ASSERT(
+        num_nodes_ >= 0 && num_buffers_ >= 0 &&
+            buffer_->size() >=
+                static_cast<int64_t>(sizeof(int64_t)) *
+                    (3 + num_nodes_ * kColumnarNodeFields + 2 * num_buffers_),
+        "the columnar batch is truncated");
+    *num_rows = header_[0];
+    return Status::OK();
+  }
+
+  Status Read(const std::shared_ptr<arrow::DataType>& type,
+              std::shared_ptr<arrow::ArrayData>* data) {
+    RETURN_ON_ASSERT(node_ < num_nodes_, "the columnar batch is malformed");
+    const int64_t* node = header_ + 3 + node_ * kColumnarNodeFields;
+    node_ += 1;
+    int64_t buffer_num = node[3], child_num = node[4];
+    RETURN_ON_ASSERT(buffer_index_ + buffer_num <= num_buffers_ &&
+                         child_num == num_fields_of(type),
+                     "the columnar batch mismatches with the schema: " +
+                         type->ToString());
+
+    const int64_t* locations =
+        header_ + 3 + num_nodes_ * kColumnarNodeFields + 2 * buffer_index_;
+    buffer_index_ += buffer_num;
+    std::vector<std::shared_ptr<arrow::Buffer>> buffers(buffer_num);
+    for (int64_t i = 0; i < buffer_num; ++i) {
+      int64_t offset = locations[2 * i], size = locations[2 * i + 1];
+      if (offset == -1) {
+        continue;
+      }
+      RETURN_ON_ASSERT(offset >= 0 && size >= 0 &&
+                           offset + size <= buffer_->size(),
+                       "the columnar batch is malformed");
+      buffers[i] = arrow::SliceBuffer(buffer_, offset, size);
+    }
+    std::vector<std::shared_ptr<arrow::ArrayData>> children(child_num);
+    for (int64_t i = 0; i < child_num; ++i) {
+      RETURN_ON_ERROR(Read(field_type_of(type, i), &children[i]));
+    }
+    *data = arrow::ArrayData::Make(type, node[0], std::move(buffers),
+                                   std::move(children), node[1], node[2]);
+    return Status::OK();
+  }
+
+ private:
+  std::shared_ptr<arrow::Buffer> buffer_;
+  const int64_t* header_;
+  int64_t num_nodes_ = 0, num_buffers_ = 0;
+  int64_t node_ = 0, buffer_index_ = 0;
+};
+
+}  // namespace detail
+
+Status GetColumnarBatchSize(const arrow::RecordBatch& batch, size_t* size) {
+  detail::ColumnarLayout layout;
+  RETURN_ON_ERROR(detail::MakeColumnarLayout(batch, layout));
+  *size = layout.size;
+  return Status::OK();
+}
+
+Status WriteColumnarBatch(const arrow::RecordBatch& batch,
+                          arrow::MutableBuffer* buffer) {
+  detail::ColumnarLayout layout;
+  RETURN_ON_ERROR(detail::MakeColumnarLayout(batch, layout));
+  RETURN_ON_ASSERT(buffer->size() >= layout.size,
+                   "the buffer is too small for the columnar batch");
+  int64_t* header = reinterpret_cast<int64_t*>(buffer->mutable_data());
+  header[0] = batch.num_rows();
+  header[1] = layout.nodes.size() / detail::kColumnarNodeFields;
+  header[2] = layout.buffers.size();
+  memcpy(header + 3, layout.nodes.data(),
+         sizeof(int64_t) * layout.nodes.size());
+  memcpy(header + 3 + layout.nodes.size(), layout.locations.data(),
+         sizeof(int64_t) * layout.locations.size());
+  for (size_t i = 0; i < layout.buffers.size(); ++i) {
+    if (layout.buffers[i] != nullptr && layout.buffers[i]->size() > 0) {
+      memory::concurrent_memcpy(
+          buffer->mutable_data() + layout.locations[2 * i],
+          layout.buffers[i]->data(), layout.buffers[i]->size());
+    }
+  }
+  return Status::OK();
+}
+
+Status ReadColumnarBatch(const std::shared_ptr<arrow::Schema>& schema,
+                         const std::shared_ptr<arrow::Buffer>& buffer,
+                         std::shared_ptr<arrow::RecordBatch>* batch) {
+  detail::ColumnarReader reader(buffer);
+  int64_t num_rows = 0;
+  RETURN_ON_ERROR(reader.Open(&num_rows));
+  std::vector<std::shared_ptr<arrow::ArrayData>> columns(schema->num_fields());
+  for (int i = 0; i < schema->num_fields(); ++i) {
+    RETURN_ON_ERROR(reader.Read(schema->field(i)->type(), &columns[i]));
+  }
+  *batch = arrow::RecordBatch::Make(schema, num_rows, std::move(columns));
+  return Status::OK();
+}
+
 Status RecordBatchesToTable(
     const std::vector<std::shared_ptr<arrow::RecordBatch>>& batches,
     std::shared_ptr<arrow::Table>* table) {
@@ -35,6 +35,7 @@ limitations under the License.
 #include "glog/logging.h"
 
 #include "basic/ds/types.h"
+#include "common/util/json.h"
 #include "common/util/status.h"
 
 namespace vineyard {
@@ -156,10 +157,62 @@ Status SerializeRecordBatches(
     const std::vector<std::shared_ptr<arrow::RecordBatch>>& batches,
     std::shared_ptr<arrow::Buffer>* buffer);
 
+/**
+ * @brief Serialize the batches as an arrow IPC stream in the scatter-gather
+ * form, i.e., the concatenation of `buffers` is the stream.
+ *
+ * The column buffers are referred as slices rather than copied, only the
+ * IPC metadata and paddings (and the buffers that arrow has to rewrite,
+ * e.g., bitmaps of sliced arrays) are copied into small buffers, thus the
+ * stream could be sent (e.g., by `writev` or an indexed MPI datatype) or
+ * copied into the destination blob without an intermediate buffer.
+ */
+Status SerializeRecordBatchesToBuffers(
+    const std::vector<std::shared_ptr<arrow::RecordBatch>>& batches,
+    std::vector<std::shared_ptr<arrow::Buffer>>* buffers);
+
+/**
+ * @brief Deserialize the arrow IPC stream, the column buffers of the batches
+ * are slices of `buffer` without copy, thus `buffer` is kept alive by the
+ * batches.
+ */
 Status DeserializeRecordBatches(
     const std::shared_ptr<arrow::Buffer>& buffer,
     std::vector<std::shared_ptr<arrow::RecordBatch>>* batches);
 
+Status SerializeSchema(const arrow::Schema& schema,
+                       std::shared_ptr<arrow::Buffer>* buffer);
+
+Status DeserializeSchema(const std::shared_ptr<arrow::Buffer>& buffer,
+                         std::shared_ptr<arrow::Schema>* schema);
+
+/**
+ * @brief The size of the batch in the columnar form, see also
+ * `WriteColumnarBatch`.
+ */
+Status GetColumnarBatchSize(const arrow::RecordBatch& batch, size_t* size);
+
+/**
+ * @brief Write the batch into `buffer` in the columnar form, i.e., a header
+ * that describes the array nodes (length, null count, offset) and the
+ * locations of their buffers, followed by the 64-bytes aligned buffers.
+ *
+ * The schema is not included, the whole layout is derived from the schema
+ * by the reader, thus the schema of a stream is only sent once. Dictionary
+ * and extension types are not supported.
+ */
+Status WriteColumnarBatch(const arrow::RecordBatch& batch,
+                          arrow::MutableBuffer* buffer);
+
+/**
+ * @brief Wrap the columnar form in `buffer` as a record batch of the given
+ * schema, the column buffers are slices of `buffer` without copy or IPC
+ * decoding.
+ */
+Status ReadColumnarBatch(const std::shared_ptr<arrow::Schema>& schema,
+                         const std::shared_ptr<arrow::Buffer>& buffer,
+                         std::shared_ptr<arrow::RecordBatch>* batch);
+
 Status RecordBatchesToTable(
     const std::vector<std::shared_ptr<arrow::RecordBatch>>& batches,
     std::shared_ptr<arrow::Table>* table);
@@ -192,6 +245,14 @@ struct EmptyTableBuilder {
 std::shared_ptr<arrow::Table> ConcatenateTables(
     std::vector<std::shared_ptr<arrow::Table>>& tables);
 
+/**
+ * @brief The zone map of the array, i.e., `{"null_count": ..., "min": ...,
+ * "max": ...}`. The `min` and `max` are absent for the arrays without any
+ * valid value, or of the types that don't have a (cheap) order, e.g., lists.
+ * NaNs are skipped, and long strings (more than 256 bytes) are not kept.
+ */
+json ArrayStatistics(std::shared_ptr<arrow::Array> const& array);
+
 /**
  * @brief Convert type name in string to arrow type.
  *
@@ -0,0 +1,149 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "basic/ds/chunked_table.h"
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace vineyard {
+
+ChunkedTableAppender::ChunkedTableAppender(
+    std::shared_ptr<arrow::Schema> schema, size_t const batch_size)
+    : batch_size_(std::max(batch_size, static_cast<size_t>(1))),
+      schema_(schema) {}
+
+ChunkedTableAppender::ChunkedTableAppender(std::shared_ptr<ChunkedTable> base,
+                                           size_t const batch_size)
+    : batch_size_(std::max(batch_size, static_cast<size_t>(1))),
+      schema_(base->schema()),
+      latest_(base) {}
+
+Status ChunkedTableAppender::Append(Client& client,
+                                    std::shared_ptr<arrow::RecordBatch> batch) {
+  std::shared_ptr<arrow::Schema> schema;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    schema = schema_;
+  }
+  if (!batch->schema()->Equals(*schema)) {
+    return Status::Invalid(
+        "The schema of the chunk doesn't match the table: " +
+        batch->schema()->ToString() + " vs. " + schema->ToString());
+  }
+  // build the chunk out of the lock, to let writers build in parallel
+  RecordBatchBuilder builder(client, batch);
+  auto chunk = std::dynamic_pointer_cast<RecordBatch>(builder.Seal(client));
+  return Append(client, chunk);
+}
+
+Status ChunkedTableAppender::Append(Client& client,
+                                    std::shared_ptr<RecordBatch> chunk) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!chunk->schema()->Equals(*schema_)) {
+    return Status::Invalid("The schema of the chunk doesn't match the table");
+  }
+  pending_.emplace_back(chunk);
+  if (pending_.size() >= batch_size_) {
+    return publish(client);
+  }
+  return Status::OK();
+}
+
+Status ChunkedTableAppender::Snapshot(Client& client,
+                                      std::shared_ptr<ChunkedTable>& snapshot) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!pending_.empty() || latest_ == nullptr) {
+    RETURN_ON_ERROR(publish(client));
+  } else {
+    // nothing changed: shares the metadata of the latest snapshot
+    ObjectID target_id = InvalidObjectID();
+    json extra_metadata;
+    extra_metadata["version_"] = latest_->version() + 1;
+    RETURN_ON_ERROR(
+        client.ShallowCopy(latest_->id(), extra_metadata, target_id));
+    std::shared_ptr<Object> object;
+    RETURN_ON_ERROR(client.GetObject(target_id, object));
+    latest_ = std::dynamic_pointer_cast<ChunkedTable>(object);
+    RETURN_ON_ASSERT(latest_ != nullptr, "The snapshot is not a chunked table");
+  }
+  snapshot = latest_;
+  return Status::OK();
+}
+
+Status ChunkedTableAppender::AddColumn(Client& client,
+                                       std::string const& field_name,
+                                       std::shared_ptr<arrow::Array> column) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!pending_.empty() || latest_ == nullptr) {
+    RETURN_ON_ERROR(publish(client));
+  }
+  if (static_cast<size_t>(column->length()) != latest_->num_rows()) {
+    return Status::Invalid(
+        "The newly added columns doesn't have a matched shape");
+  }
+  std::shared_ptr<arrow::Schema> schema;
+  auto field = ::arrow::field(field_name, column->type());
+#if defined(ARROW_VERSION) && ARROW_VERSION < 17000
+  RETURN_ON_ARROW_ERROR(
+      schema_->AddField(schema_->num_fields(), field, &schema));
+#else
+  RETURN_ON_ARROW_ERROR_AND_ASSIGN(
+      schema, schema_->AddField(schema_->num_fields(), field));
+#endif
+
+  ChunkedTableBuilder builder(client, schema, latest_->version() + 1);
+  size_t offset = 0;
+  for (auto const& chunk : latest_->chunks()) {
+    RecordBatchExtender extender(client, chunk);
+    RETURN_ON_ERROR(extender.AddColumn(
+        client, field_name, column->Slice(offset, chunk->num_rows())));
+    offset += chunk->num_rows();
+    builder.AddChunk(
+        std::dynamic_pointer_cast<RecordBatch>(extender.Seal(client)));
+  }
+  latest_ = std::dynamic_pointer_cast<ChunkedTable>(builder.Seal(client));
+  schema_ = schema;
+  return Status::OK();
+}
+
+std::shared_ptr<ChunkedTable> ChunkedTableAppender::Latest() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return latest_;
+}
+
+size_t ChunkedTableAppender::Pending() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return pending_.size();
+}
+
+Status ChunkedTableAppender::publish(Client& client) {
+  std::unique_ptr<ChunkedTableBuilder> builder;
+  if (latest_ == nullptr) {
+    builder.reset(new ChunkedTableBuilder(client, schema_));
+  } else {
+    builder.reset(new ChunkedTableBuilder(client, latest_));
+  }
+  for (auto const& chunk : pending_) {
+    builder->AddChunk(chunk);
+  }
+  latest_ = std::dynamic_pointer_cast<ChunkedTable>(builder->Seal(client));
+  pending_.clear();
+  return Status::OK();
+}
+
+}  // namespace vineyard
@@ -0,0 +1,160 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef MODULES_BASIC_DS_CHUNKED_TABLE_H_
+#define MODULES_BASIC_DS_CHUNKED_TABLE_H_
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "basic/ds/arrow.h"
+#include "basic/ds/chunked_table.vineyard.h"
+#include "client/client.h"
+
+namespace vineyard {
+
+/**
+ * @brief ChunkedTableBuilder seals a snapshot of the chunked table, the
+ * chunks must have been sealed already.
+ */
+class ChunkedTableBuilder : public ChunkedTableBaseBuilder {
+ public:
+  /**
+   * @brief Start a new table of the given schema.
+   */
+  ChunkedTableBuilder(Client& client, std::shared_ptr<arrow::Schema> schema,
+                      size_t const version = 0)
+      : ChunkedTableBaseBuilder(client),
+        arrow_schema_(schema),
+        next_version_(version) {}
+
+  /**
+   * @brief Start the next version of the given snapshot, the chunks and the
+   * schema of the snapshot are reused as members rather than copied.
+   */
+  ChunkedTableBuilder(Client& client, std::shared_ptr<ChunkedTable> base)
+      : ChunkedTableBaseBuilder(client),
+        arrow_schema_(base->schema()),
+        base_schema_(base->schema_proxy()),
+        next_version_(base->version() + 1),
+        batches_(base->chunks()) {}
+
+  void AddChunk(std::shared_ptr<RecordBatch> const& chunk) {
+    batches_.emplace_back(chunk);
+  }
+
+  Status Build(Client& client) override {
+    size_t num_rows = 0;
+    for (auto const& chunk : batches_) {
+      RETURN_ON_ASSERT(chunk->schema()->Equals(*arrow_schema_),
+                       "The schema of the chunk doesn't match the table");
+      num_rows += chunk->num_rows();
+      this->add_chunks_(chunk);
+    }
+    this->set_version_(next_version_);
+    this->set_chunk_num_(batches_.size());
+    this->set_num_rows_(num_rows);
+    this->set_num_columns_(arrow_schema_->num_fields());
+    if (base_schema_) {
+      this->set_schema_(base_schema_);
+    } else {
+      this->set_schema_(detail::BuildSchema(client, arrow_schema_));
+    }
+    return Status::OK();
+  }
+
+ private:
+  std::shared_ptr<arrow::Schema> arrow_schema_;
+  std::shared_ptr<SchemaProxy> base_schema_;
+  size_t next_version_ = 0;
+  std::vector<std::shared_ptr<RecordBatch>> batches_;
+};
+
+/**
+ * @brief ChunkedTableAppender appends chunks to a chunked table continuously,
+ * and publishes the accumulated chunks as a new snapshot in batches.
+ *
+ * `Append` is thread-safe: many writers (each with its own client) build
+ * their chunks in parallel, only registering the sealed chunks is serialized.
+ */
+class ChunkedTableAppender {
+ public:
+  /**
+   * @brief Append to a new table, a snapshot is published once `batch_size`
+   * chunks have been accumulated.
+   */
+  ChunkedTableAppender(std::shared_ptr<arrow::Schema> schema,
+                       size_t const batch_size = 1);
+
+  /**
+   * @brief Append to an existing snapshot.
+   */
+  ChunkedTableAppender(std::shared_ptr<ChunkedTable> base,
+                       size_t const batch_size = 1);
+
+  /**
+   * @brief Seal the record batch as a chunk and append it.
+   */
+  Status Append(Client& client, std::shared_ptr<arrow::RecordBatch> batch);
+
+  /**
+   * @brief Append a sealed record batch as a chunk.
+   */
+  Status Append(Client& client, std::shared_ptr<RecordBatch> chunk);
+
+  /**
+   * @brief Publish the accumulated chunks as a new snapshot.
+   *
+   * If no chunks have been accumulated since the latest snapshot, the new
+   * version is a shallow copy of the latest snapshot.
+   */
+  Status Snapshot(Client& client, std::shared_ptr<ChunkedTable>& snapshot);
+
+  /**
+   * @brief Extend every chunk with a new column (aligned with the rows of the
+   * latest snapshot), the existing columns of the chunks are shared rather
+   * than copied, see also `RecordBatchExtender`.
+   *
+   * The accumulated chunks are published first.
+   */
+  Status AddColumn(Client& client, std::string const& field_name,
+                   std::shared_ptr<arrow::Array> column);
+
+  /**
+   * @brief The latest snapshot, nullptr if nothing has been published.
+   */
+  std::shared_ptr<ChunkedTable> Latest() const;
+
+  /**
+   * @brief The number of chunks that haven't been published yet.
+   */
+  size_t Pending() const;
+
+ private:
+  // publishes the pending chunks, requires `mutex_` been held.
+  Status publish(Client& client);
+
+  const size_t batch_size_;
+  mutable std::mutex mutex_;
+  std::shared_ptr<arrow::Schema> schema_;
+  std::shared_ptr<ChunkedTable> latest_;
+  std::vector<std::shared_ptr<RecordBatch>> pending_;
+};
+
+}  // namespace vineyard
+
+#endif  // MODULES_BASIC_DS_CHUNKED_TABLE_H_
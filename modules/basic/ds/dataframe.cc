@@ -197,21 +197,31 @@ std::shared_ptr<Object> GlobalDataFrameBaseBuilder::_Seal(Client& client) {
   __value->meta_.AddKeyValue("partition_shape_column_",
                              __value->partition_shape_column_);
 
+  // the partitions are resolved in a single round trip, as the metadata has
+  // been synced above.
+  std::vector<std::shared_ptr<Object>> __partitions__objects;
+  VINEYARD_CHECK_OK(
+      client.GetObjects(partitions_, __partitions__objects, false));
   size_t __partitions__idx = 0;
-  for (auto& __partitions__value : partitions_) {
-    auto __value_partitions_ = client.GetObject<DataFrame>(__partitions__value);
+  for (auto& __partitions__object : __partitions__objects) {
+    auto __value_partitions_ =
+        std::dynamic_pointer_cast<DataFrame>(__partitions__object);
     __value->partitions_[__value_partitions_->meta().GetInstanceId()]
         .emplace_back(__value_partitions_);
     __value->meta_.AddMember("partitions_-" + std::to_string(__partitions__idx),
-                             __partitions__value);
+                             __value_partitions_->id());
     __value_nbytes += __value_partitions_->nbytes();
     __partitions__idx += 1;
   }
-  __value->meta_.AddKeyValue("partitions_-size", __value->partitions_.size());
+  __value->meta_.AddKeyValue("partitions_-size", __partitions__idx);
 
   __value->meta_.SetNBytes(__value_nbytes);
 
-  VINEYARD_CHECK_OK(client.CreateMetaData(__value->meta_, __value->id_));
+  // global objects are persisted along with the creation, together with all
+  // the transient local partitions, in a single request.
+  VINEYARD_CHECK_OK(client.CreateMetaData(
+      __value->meta_, __value->id_,
+      std::is_base_of<GlobalObject, GlobalDataFrame>::value));
 
   // mark the builder as sealed
   this->set_sealed(true);
@@ -243,10 +253,8 @@ void GlobalDataFrameBuilder::AddPartitions(
 }
 
 std::shared_ptr<Object> GlobalDataFrameBuilder::_Seal(Client& client) {
-  auto object = GlobalDataFrameBaseBuilder::_Seal(client);
-  // Global object will be persist automatically.
-  VINEYARD_CHECK_OK(client.Persist(object->id()));
-  return object;
+  // Global object has been persisted by the base builder.
+  return GlobalDataFrameBaseBuilder::_Seal(client);
 }
 
 Status GlobalDataFrameBuilder::Build(Client& client) { return Status::OK(); }
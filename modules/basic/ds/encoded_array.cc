@@ -0,0 +1,233 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "basic/ds/encoded_array.h"
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+namespace vineyard {
+
+namespace detail {
+
+template <typename Builder, typename ArrayType>
+std::shared_ptr<ObjectBuilder> buildIfEncodable(
+    Client& client, std::shared_ptr<arrow::Array> const& array) {
+  auto arr = std::dynamic_pointer_cast<ArrayType>(array);
+  if (arr == nullptr) {
+    return nullptr;
+  }
+  auto builder = std::make_shared<Builder>(client, arr);
+  return builder->Encodable() ? builder : nullptr;
+}
+
+template <typename T>
+std::shared_ptr<ObjectBuilder> buildBitPacked(
+    Client& client, std::shared_ptr<arrow::Array> const& array) {
+  return buildIfEncodable<BitPackedArrayBuilder<T>,
+                          typename ConvertToArrowType<T>::ArrayType>(client,
+                                                                     array);
+}
+
+std::shared_ptr<ObjectBuilder> BuildEncodedArray(
+    Client& client, std::shared_ptr<arrow::Array> const& array) {
+  std::shared_ptr<ObjectBuilder> builder;
+  if ((builder = buildBitPacked<int8_t>(client, array)) ||
+      (builder = buildBitPacked<uint8_t>(client, array)) ||
+      (builder = buildBitPacked<int16_t>(client, array)) ||
+      (builder = buildBitPacked<uint16_t>(client, array)) ||
+      (builder = buildBitPacked<int32_t>(client, array)) ||
+      (builder = buildBitPacked<uint32_t>(client, array)) ||
+      (builder = buildBitPacked<int64_t>(client, array)) ||
+      (builder = buildBitPacked<uint64_t>(client, array))) {
+    return builder;
+  }
+  if ((builder = buildIfEncodable<DictionaryBinaryArrayBuilder,
+                                  arrow::BinaryArray>(client, array)) ||
+      (builder = buildIfEncodable<DictionaryLargeBinaryArrayBuilder,
+                                  arrow::LargeBinaryArray>(client, array)) ||
+      (builder = buildIfEncodable<DictionaryStringArrayBuilder,
+                                  arrow::StringArray>(client, array)) ||
+      (builder = buildIfEncodable<DictionaryLargeStringArrayBuilder,
+                                  arrow::LargeStringArray>(client, array))) {
+    return builder;
+  }
+  return buildIfEncodable<RunLengthBooleanArrayBuilder, arrow::BooleanArray>(
+      client, array);
+}
+
+/**
+ * @brief Create the blobs of the given sizes and fill them by `decode`, then
+ * seal the plain array by the builder that adopts the blobs. Falls back to
+ * copying the decoded `GetArray()` if any of the blobs is empty.
+ */
+template <typename Builder, typename Encoded, typename Decode, typename Make>
+Status decompressInto(Client& client, Encoded const& array,
+                      std::vector<size_t> const& sizes, Decode const& decode,
+                      Make const& make, std::shared_ptr<Object>& decompressed) {
+  if (std::find(sizes.begin(), sizes.end(), 0) != sizes.end()) {
+    decompressed =
+        std::make_shared<Builder>(client, array.GetArray())->Seal(client);
+    return Status::OK();
+  }
+  std::vector<std::unique_ptr<BlobWriter>> writers;
+  RETURN_ON_ERROR(client.CreateBlobs(sizes, writers));
+  decode(writers);
+  auto builder = std::make_shared<Builder>(client, make(writers));
+  std::vector<std::shared_ptr<BlobWriter>> blobs;
+  for (auto& writer : writers) {
+    blobs.emplace_back(std::move(writer));
+  }
+  builder->AttachBlobs(std::move(blobs));
+  decompressed = builder->Seal(client);
+  return Status::OK();
+}
+
+template <typename T>
+Status decompressBitPacked(Client& client, BitPackedArray<T> const& array,
+                           std::shared_ptr<Object>& decompressed) {
+  using ArrayType = typename BitPackedArray<T>::ArrayType;
+  int64_t const length = array.length();
+  bool const nullable = array.null_count() > 0;
+  std::vector<size_t> sizes{length * sizeof(T)};
+  if (nullable) {
+    sizes.emplace_back((length + 7) / 8);
+  }
+  return decompressInto<NumericArrayBuilder<T>>(
+      client, array, sizes,
+      [&](std::vector<std::unique_ptr<BlobWriter>>& writers) {
+        array.Decode(0, length, reinterpret_cast<T*>(writers[0]->data()));
+        if (nullable) {
+          array.DecodeNullBitmap(
+              reinterpret_cast<uint8_t*>(writers[1]->data()));
+        }
+      },
+      [&](std::vector<std::unique_ptr<BlobWriter>>& writers) {
+        return std::make_shared<ArrayType>(
+            ConvertToArrowType<T>::TypeValue(), length, writers[0]->Buffer(),
+            nullable ? writers[1]->Buffer() : nullptr, array.null_count());
+      },
+      decompressed);
+}
+
+template <typename ArrayType>
+Status decompressDictionary(Client& client,
+                            DictionaryEncodedArray<ArrayType> const& array,
+                            std::shared_ptr<Object>& decompressed) {
+  using offset_type = typename ArrayType::offset_type;
+  int64_t const length = array.length();
+  bool const nullable = array.null_count() > 0;
+  std::vector<uint32_t> indices(length);
+  array.DecodeIndices(0, length, indices.data());
+  size_t data_size = 0;
+  for (auto const& index : indices) {
+    data_size += array.DictionaryValue(index).second;
+  }
+  std::vector<size_t> sizes{(length + 1) * sizeof(offset_type), data_size};
+  if (nullable) {
+    sizes.emplace_back((length + 7) / 8);
+  }
+  return decompressInto<BaseBinaryArrayBuilder<ArrayType>>(
+      client, array, sizes,
+      [&](std::vector<std::unique_ptr<BlobWriter>>& writers) {
+        auto offsets = reinterpret_cast<offset_type*>(writers[0]->data());
+        auto data = reinterpret_cast<uint8_t*>(writers[1]->data());
+        offsets[0] = 0;
+        for (int64_t idx = 0; idx < length; ++idx) {
+          auto value = array.DictionaryValue(indices[idx]);
+          memcpy(data + offsets[idx], value.first, value.second);
+          offsets[idx + 1] = offsets[idx] + value.second;
+        }
+        if (nullable) {
+          array.DecodeNullBitmap(
+              reinterpret_cast<uint8_t*>(writers[2]->data()));
+        }
+      },
+      [&](std::vector<std::unique_ptr<BlobWriter>>& writers) {
+        return std::make_shared<ArrayType>(
+            length, writers[0]->Buffer(), writers[1]->Buffer(),
+            nullable ? writers[2]->Buffer() : nullptr, array.null_count());
+      },
+      decompressed);
+}
+
+Status decompressBoolean(Client& client, RunLengthBooleanArray const& array,
+                         std::shared_ptr<Object>& decompressed) {
+  using ArrayType = RunLengthBooleanArray::ArrayType;
+  int64_t const length = array.length();
+  bool const nullable = array.null_count() > 0;
+  std::vector<size_t> sizes{static_cast<size_t>(length + 7) / 8};
+  if (nullable) {
+    sizes.emplace_back((length + 7) / 8);
+  }
+  return decompressInto<BooleanArrayBuilder>(
+      client, array, sizes,
+      [&](std::vector<std::unique_ptr<BlobWriter>>& writers) {
+        array.Decode(reinterpret_cast<uint8_t*>(writers[0]->data()));
+        if (nullable) {
+          array.DecodeNullBitmap(
+              reinterpret_cast<uint8_t*>(writers[1]->data()));
+        }
+      },
+      [&](std::vector<std::unique_ptr<BlobWriter>>& writers) {
+        return std::make_shared<ArrayType>(
+            length, writers[0]->Buffer(),
+            nullable ? writers[1]->Buffer() : nullptr, array.null_count());
+      },
+      decompressed);
+}
+
+}  // namespace detail
+
+#ifndef DECOMPRESS_BIT_PACKED
+#define DECOMPRESS_BIT_PACKED(type)                                        \
+  if (auto arr = std::dynamic_pointer_cast<BitPackedArray<type>>(array)) { \
+    return detail::decompressBitPacked(client, *arr, decompressed);        \
+  }
+#endif
+
+#ifndef DECOMPRESS_DICTIONARY
+#define DECOMPRESS_DICTIONARY(type)                                  \
+  if (auto arr = std::dynamic_pointer_cast<type>(array)) {           \
+    return detail::decompressDictionary(client, *arr, decompressed); \
+  }
+#endif
+
+Status Decompress(Client& client, std::shared_ptr<Object> const& array,
+                  std::shared_ptr<Object>& decompressed) {
+  DECOMPRESS_BIT_PACKED(int8_t);
+  DECOMPRESS_BIT_PACKED(uint8_t);
+  DECOMPRESS_BIT_PACKED(int16_t);
+  DECOMPRESS_BIT_PACKED(uint16_t);
+  DECOMPRESS_BIT_PACKED(int32_t);
+  DECOMPRESS_BIT_PACKED(uint32_t);
+  DECOMPRESS_BIT_PACKED(int64_t);
+  DECOMPRESS_BIT_PACKED(uint64_t);
+  DECOMPRESS_DICTIONARY(DictionaryBinaryArray);
+  DECOMPRESS_DICTIONARY(DictionaryLargeBinaryArray);
+  DECOMPRESS_DICTIONARY(DictionaryStringArray);
+  DECOMPRESS_DICTIONARY(DictionaryLargeStringArray);
+  if (auto arr = std::dynamic_pointer_cast<RunLengthBooleanArray>(array)) {
+    return detail::decompressBoolean(client, *arr, decompressed);
+  }
+  return Status::Invalid("Not an encoded array: " +
+                         array->meta().GetTypeName());
+}
+
+#undef DECOMPRESS_BIT_PACKED
+#undef DECOMPRESS_DICTIONARY
+
+}  // namespace vineyard
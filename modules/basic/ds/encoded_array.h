@@ -0,0 +1,294 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef MODULES_BASIC_DS_ENCODED_ARRAY_H_
+#define MODULES_BASIC_DS_ENCODED_ARRAY_H_
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "basic/ds/arrow.h"
+#include "basic/ds/encoded_array.vineyard.h"
+#include "basic/ds/encoding.h"
+#include "client/client.h"
+#include "client/ds/blob.h"
+
+namespace vineyard {
+
+namespace detail {
+
+/**
+ * @brief Copy the bytes into a new blob, an empty blob for 0 bytes.
+ */
+inline Status CopyToBlob(Client& client, const void* data, size_t const size,
+                         std::shared_ptr<ObjectBase>& blob) {
+  if (size == 0) {
+    blob = Blob::MakeEmpty(client);
+    return Status::OK();
+  }
+  std::unique_ptr<BlobWriter> writer;
+  RETURN_ON_ERROR(client.CreateBlob(size, writer));
+  memcpy(writer->data(), data, size);
+  blob = std::move(writer);
+  return Status::OK();
+}
+
+/**
+ * @brief Run-length encode the null bitmap of the array into a blob.
+ */
+inline Status EncodeNullBitmap(Client& client,
+                               std::shared_ptr<arrow::Array> const& array,
+                               std::shared_ptr<ObjectBase>& blob) {
+  std::vector<int64_t> runs;
+  if (array->null_count() > 0) {
+    encoding::RunLengthEncode(array->null_bitmap_data(), array->offset(),
+                              array->length(), runs);
+  }
+  return CopyToBlob(client, runs.data(), runs.size() * sizeof(int64_t), blob);
+}
+
+}  // namespace detail
+
+/**
+ * @brief BitPackedArrayBuilder encodes an integral arrow array with
+ * frame-of-reference and bit-packing.
+ */
+template <typename T>
+class BitPackedArrayBuilder : public BitPackedArrayBaseBuilder<T> {
+ public:
+  using ArrayType = typename ConvertToArrowType<T>::ArrayType;
+
+  BitPackedArrayBuilder(Client& client, std::shared_ptr<ArrayType> array)
+      : BitPackedArrayBaseBuilder<T>(client), array_(array) {}
+
+  /**
+   * @brief Whether the packed values take less memory than the raw ones.
+   */
+  bool Encodable() {
+    bool found = false;
+    T low = T(), high = T();
+    auto values = array_->raw_values();
+    for (int64_t idx = 0; idx < array_->length(); ++idx) {
+      if (array_->IsNull(idx)) {
+        continue;
+      }
+      if (!found) {
+        low = high = values[idx];
+        found = true;
+      } else {
+        low = std::min(low, values[idx]);
+        high = std::max(high, values[idx]);
+      }
+    }
+    reference_ = low;
+    width_ = encoding::BitWidth(static_cast<uint64_t>(high) -
+                                static_cast<uint64_t>(low));
+    return width_ <= encoding::kMaxBitWidth &&
+           encoding::BitPackedSize(array_->length(), width_) <
+               array_->length() * sizeof(T);
+  }
+
+  Status Build(Client& client) override {
+    if (width_ < 0) {
+      RETURN_ON_ASSERT(Encodable(), "The array cannot be bit-packed");
+    }
+    size_t const size = encoding::BitPackedSize(array_->length(), width_);
+    std::unique_ptr<BlobWriter> buffer;
+    RETURN_ON_ERROR(client.CreateBlob(size, buffer));
+    encoding::BitPack(
+        array_->raw_values(),
+        array_->null_count() > 0 ? array_->null_bitmap_data() : nullptr,
+        array_->offset(), array_->length(), reference_, width_,
+        reinterpret_cast<uint8_t*>(buffer->data()));
+    std::shared_ptr<ObjectBase> null_runs;
+    RETURN_ON_ERROR(detail::EncodeNullBitmap(client, array_, null_runs));
+
+    this->set_length_(array_->length());
+    this->set_null_count_(array_->null_count());
+    this->set_reference_(reference_);
+    this->set_bit_width_(width_);
+    this->set_buffer_(std::move(buffer));
+    this->set_null_runs_(null_runs);
+    return Status::OK();
+  }
+
+ private:
+  std::shared_ptr<ArrayType> array_;
+  T reference_ = T();
+  int width_ = -1;
+};
+
+/**
+ * @brief DictionaryEncodedArrayBuilder encodes a binary (or string) arrow
+ * array as the distinct values and the bit-packed indices.
+ */
+template <typename ArrayType>
+class DictionaryEncodedArrayBuilder
+    : public DictionaryEncodedArrayBaseBuilder<ArrayType> {
+ public:
+  using offset_type = typename ArrayType::offset_type;
+
+  DictionaryEncodedArrayBuilder(Client& client,
+                                std::shared_ptr<ArrayType> array)
+      : DictionaryEncodedArrayBaseBuilder<ArrayType>(client), array_(array) {}
+
+  /**
+   * @brief Whether the dictionary and the indices take less memory than the
+   * raw values and offsets.
+   */
+  bool Encodable() {
+    std::unordered_map<std::string, uint32_t> dictionary;
+    indices_.resize(array_->length());
+    dictionary_offsets_.assign(1, 0);
+    dictionary_data_.clear();
+    for (int64_t idx = 0; idx < array_->length(); ++idx) {
+      if (array_->IsNull(idx)) {
+        indices_[idx] = 0;
+        continue;
+      }
+      offset_type length = 0;
+      auto value = array_->GetValue(idx, &length);
+      auto inserted = dictionary.emplace(
+          std::string(reinterpret_cast<const char*>(value), length),
+          static_cast<uint32_t>(dictionary.size()));
+      if (inserted.second) {
+        dictionary_data_.insert(dictionary_data_.end(), value, value + length);
+        dictionary_offsets_.emplace_back(dictionary_data_.size());
+      }
+      indices_[idx] = inserted.first->second;
+    }
+    width_ = encoding::BitWidth(
+        dictionary.empty() ? 0 : static_cast<uint64_t>(dictionary.size() - 1));
+    size_t const encoded =
+        encoding::BitPackedSize(array_->length(), width_) +
+        dictionary_offsets_.size() * sizeof(offset_type) +
+        dictionary_data_.size();
+    size_t const raw = (array_->length() + 1) * sizeof(offset_type) +
+                       array_->value_data()->size();
+    return encoded < raw;
+  }
+
+  Status Build(Client& client) override {
+    if (width_ < 0) {
+      RETURN_ON_ASSERT(Encodable(), "The array cannot be dictionary encoded");
+    }
+    size_t const size = encoding::BitPackedSize(array_->length(), width_);
+    std::unique_ptr<BlobWriter> indices;
+    RETURN_ON_ERROR(client.CreateBlob(size, indices));
+    encoding::BitPack(indices_.data(), nullptr, 0, indices_.size(),
+                      static_cast<uint32_t>(0), width_,
+                      reinterpret_cast<uint8_t*>(indices->data()));
+    std::shared_ptr<ObjectBase> dictionary_offsets, dictionary_data,
+        null_runs;
+    RETURN_ON_ERROR(detail::CopyToBlob(
+        client, dictionary_offsets_.data(),
+        dictionary_offsets_.size() * sizeof(offset_type), dictionary_offsets));
+    RETURN_ON_ERROR(detail::CopyToBlob(client, dictionary_data_.data(),
+                                       dictionary_data_.size(),
+                                       dictionary_data));
+    RETURN_ON_ERROR(detail::EncodeNullBitmap(client, array_, null_runs));
+
+    this->set_length_(array_->length());
+    this->set_null_count_(array_->null_count());
+    this->set_dictionary_size_(dictionary_offsets_.size() - 1);
+    this->set_index_width_(width_);
+    this->set_dictionary_offsets_(dictionary_offsets);
+    this->set_dictionary_data_(dictionary_data);
+    this->set_indices_(std::move(indices));
+    this->set_null_runs_(null_runs);
+    return Status::OK();
+  }
+
+ private:
+  std::shared_ptr<ArrayType> array_;
+  std::vector<uint32_t> indices_;
+  std::vector<offset_type> dictionary_offsets_;
+  std::vector<uint8_t> dictionary_data_;
+  int width_ = -1;
+};
+
+using DictionaryBinaryArrayBuilder =
+    DictionaryEncodedArrayBuilder<arrow::BinaryArray>;
+using DictionaryLargeBinaryArrayBuilder =
+    DictionaryEncodedArrayBuilder<arrow::LargeBinaryArray>;
+using DictionaryStringArrayBuilder =
+    DictionaryEncodedArrayBuilder<arrow::StringArray>;
+using DictionaryLargeStringArrayBuilder =
+    DictionaryEncodedArrayBuilder<arrow::LargeStringArray>;
+
+/**
+ * @brief RunLengthBooleanArrayBuilder encodes the bitmaps of a boolean arrow
+ * array as runs.
+ */
+class RunLengthBooleanArrayBuilder : public RunLengthBooleanArrayBaseBuilder {
+ public:
+  using ArrayType = typename ConvertToArrowType<bool>::ArrayType;
+
+  RunLengthBooleanArrayBuilder(Client& client,
+                               std::shared_ptr<ArrayType> array)
+      : RunLengthBooleanArrayBaseBuilder(client), array_(array) {}
+
+  /**
+   * @brief Whether the runs take less memory than the value bitmap.
+   */
+  bool Encodable() {
+    encoding::RunLengthEncode(array_->values()->data(), array_->offset(),
+                              array_->length(), runs_);
+    encoded_ = true;
+    return runs_.size() * sizeof(int64_t) <
+           static_cast<size_t>(array_->length() + 7) / 8;
+  }
+
+  Status Build(Client& client) override {
+    if (!encoded_) {
+      RETURN_ON_ASSERT(Encodable(), "The array cannot be run-length encoded");
+    }
+    std::shared_ptr<ObjectBase> runs, null_runs;
+    RETURN_ON_ERROR(detail::CopyToBlob(client, runs_.data(),
+                                       runs_.size() * sizeof(int64_t), runs));
+    RETURN_ON_ERROR(detail::EncodeNullBitmap(client, array_, null_runs));
+
+    this->set_length_(array_->length());
+    this->set_null_count_(array_->null_count());
+    this->set_runs_(runs);
+    this->set_null_runs_(null_runs);
+    return Status::OK();
+  }
+
+ private:
+  std::shared_ptr<ArrayType> array_;
+  std::vector<int64_t> runs_;
+  bool encoded_ = false;
+};
+
+/**
+ * @brief Decode the encoded array into a plain array in vineyard, e.g., a
+ * `BitPackedArray<T>` to a `NumericArray<T>`. The values are decoded into
+ * the blobs directly.
+ *
+ * @param array An encoded array, i.e., `BitPackedArray<T>`,
+ * `DictionaryEncodedArray<ArrayType>` or `RunLengthBooleanArray`.
+ * @param decompressed The sealed plain array.
+ */
+Status Decompress(Client& client, std::shared_ptr<Object> const& array,
+                  std::shared_ptr<Object>& decompressed);
+
+}  // namespace vineyard
+
+#endif  // MODULES_BASIC_DS_ENCODED_ARRAY_H_
@@ -0,0 +1,164 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef MODULES_BASIC_DS_ENCODING_H_
+#define MODULES_BASIC_DS_ENCODING_H_
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+namespace vineyard {
+
+/**
+ * @brief The encoding kernels behind the encoded arrays, see also
+ * "basic/ds/encoded_array.h".
+ */
+namespace encoding {
+
+/// Values are read with a 64-bit window that starts at a byte boundary, thus
+/// at most 56 bits can be unpacked by a single load.
+constexpr int kMaxBitWidth = 56;
+
+/// The number of bits that required to represent values in `[0, range]`.
+inline int BitWidth(uint64_t const range) {
+  return range == 0 ? 0 : 64 - __builtin_clzll(range);
+}
+
+/// The size of the packed buffer, padded for the 64-bit window of the last
+/// value.
+inline size_t BitPackedSize(size_t const length, int const width) {
+  return (length * width + 7) / 8 + sizeof(uint64_t);
+}
+
+inline bool GetBit(const uint8_t* bitmap, int64_t const index) {
+  return (bitmap[index >> 3] >> (index & 7)) & 1;
+}
+
+/**
+ * @brief Pack `values - reference` with `width` bits for each value into
+ * `out`, which holds at least `BitPackedSize(length, width)` bytes. Slots
+ * that are invalid in `validity` (if not null) are packed as 0.
+ */
+template <typename T>
+void BitPack(const T* values, const uint8_t* validity,
+             int64_t const validity_offset, size_t const length,
+             T const reference, int const width, uint8_t* out) {
+  static_assert(std::is_integral<T>::value,
+                "Only integers can be bit-packed");
+  memset(out, 0, BitPackedSize(length, width));
+  if (width == 0) {
+    return;
+  }
+  for (size_t idx = 0; idx < length; ++idx) {
+    if (validity && !GetBit(validity, validity_offset + idx)) {
+      continue;
+    }
+    uint64_t value = static_cast<uint64_t>(values[idx]) -
+                     static_cast<uint64_t>(reference);
+    size_t const bit = idx * width;
+    uint64_t word;
+    memcpy(&word, out + (bit >> 3), sizeof(uint64_t));
+    word |= value << (bit & 7);
+    memcpy(out + (bit >> 3), &word, sizeof(uint64_t));
+  }
+}
+
+/**
+ * @brief Unpack `length` values starting from the `offset`-th one. The loop
+ * is branch-free and unrolled by 8, the compiler is able to vectorize it.
+ */
+template <typename T>
+void BitUnpack(const uint8_t* in, size_t const offset, size_t const length,
+               T const reference, int const width, T* out) {
+  if (width == 0) {
+    std::fill(out, out + length, reference);
+    return;
+  }
+  uint64_t const mask = (static_cast<uint64_t>(1) << width) - 1;
+  uint64_t const base = static_cast<uint64_t>(reference);
+  auto unpack = [&](size_t const idx) -> T {
+    size_t const bit = (offset + idx) * width;
+    uint64_t word;
+    memcpy(&word, in + (bit >> 3), sizeof(uint64_t));
+    return static_cast<T>(base + ((word >> (bit & 7)) & mask));
+  };
+  size_t idx = 0;
+  for (; idx + 8 <= length; idx += 8) {
+    for (size_t lane = 0; lane < 8; ++lane) {
+      out[idx + lane] = unpack(idx + lane);
+    }
+  }
+  for (; idx < length; ++idx) {
+    out[idx] = unpack(idx);
+  }
+}
+
+/**
+ * @brief Encode the bitmap as the lengths of runs, the runs alternate
+ * between unset and set bits, starting from an (maybe empty) run of unset
+ * bits.
+ */
+inline void RunLengthEncode(const uint8_t* bitmap, int64_t const offset,
+                            int64_t const length, std::vector<int64_t>& runs) {
+  runs.clear();
+  bool current = false;
+  int64_t run = 0;
+  for (int64_t idx = 0; idx < length; ++idx) {
+    bool const bit = GetBit(bitmap, offset + idx);
+    if (bit != current) {
+      runs.emplace_back(run);
+      current = bit;
+      run = 0;
+    }
+    run += 1;
+  }
+  runs.emplace_back(run);
+}
+
+/**
+ * @brief Decode the runs into `bitmap`, which holds at least `(length + 7) /
+ * 8` bytes. Whole bytes inside a run are filled at once.
+ */
+inline void RunLengthDecode(const int64_t* runs, size_t const num_runs,
+                            int64_t const length, uint8_t* bitmap) {
+  memset(bitmap, 0, (length + 7) / 8);
+  int64_t position = 0;
+  for (size_t idx = 0; idx < num_runs; ++idx) {
+    int64_t const end = std::min(position + runs[idx], length);
+    if (idx % 2 == 1) {
+      int64_t bit = position;
+      for (; bit < end && (bit & 7) != 0; ++bit) {
+        bitmap[bit >> 3] |= static_cast<uint8_t>(1 << (bit & 7));
+      }
+      if (end - bit >= 8) {
+        memset(bitmap + (bit >> 3), 0xff, (end - bit) >> 3);
+        bit += (end - bit) & ~static_cast<int64_t>(7);
+      }
+      for (; bit < end; ++bit) {
+        bitmap[bit >> 3] |= static_cast<uint8_t>(1 << (bit & 7));
+      }
+    }
+    position = end;
+  }
+}
+
+}  // namespace encoding
+
+}  // namespace vineyard
+
+#endif  // MODULES_BASIC_DS_ENCODING_H_
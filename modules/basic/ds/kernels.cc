@@ -0,0 +1,638 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "basic/ds/kernels.h"
+
+#include <immintrin.h>
+
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "basic/ds/tensor.h"
+
+namespace vineyard {
+
+namespace kernels {
+
+namespace detail {
+
+inline bool cpuSupportsAVX2() {
+  static const bool supported = __builtin_cpu_supports("avx2");
+  return supported;
+}
+
+inline bool cpuSupportsAVX512() {
+  static const bool supported = __builtin_cpu_supports("avx512f");
+  return supported;
+}
+
+// appends `base + i` for every set bit i in the mask
+inline int64_t emitSelection(uint64_t mask, int64_t const base,
+                             int64_t* selection) {
+  int64_t count = 0;
+  while (mask) {
+    selection[count++] = base + __builtin_ctzll(mask);
+    mask &= mask - 1;
+  }
+  return count;
+}
+
+template <CompareOp op, typename T>
+inline bool compareValue(T const lhs, T const rhs) {
+  switch (op) {
+  case CompareOp::kEqual:
+    return lhs == rhs;
+  case CompareOp::kNotEqual:
+    return lhs != rhs;
+  case CompareOp::kLess:
+    return lhs < rhs;
+  case CompareOp::kLessEqual:
+    return lhs <= rhs;
+  case CompareOp::kGreater:
+    return lhs > rhs;
+  case CompareOp::kGreaterEqual:
+    return lhs >= rhs;
+  }
+  return false;
+}
+
+// the index is always written, and the cursor advances only if matched
+template <CompareOp op, typename T>
+int64_t compareScalar(const T* values, int64_t const begin, int64_t const end,
+                      T const value, int64_t* selection) {
+  int64_t count = 0;
+  for (int64_t idx = begin; idx < end; ++idx) {
+    selection[count] = idx;
+    count += compareValue<op>(values[idx], value);
+  }
+  return count;
+}
+
+// the integral comparisons in AVX2 are `==` and `>` only, the others are
+// their negations.
+template <CompareOp op>
+constexpr bool negated() {
+  return op == CompareOp::kNotEqual || op == CompareOp::kLessEqual ||
+         op == CompareOp::kGreaterEqual;
+}
+
+// the predicates are static members rather than constexpr functions, as the
+// intrinsics require immediates even if not optimized.
+template <CompareOp op>
+struct integral_predicate {
+  static constexpr int value =
+      op == CompareOp::kEqual       ? _MM_CMPINT_EQ
+      : op == CompareOp::kNotEqual  ? _MM_CMPINT_NE
+      : op == CompareOp::kLess      ? _MM_CMPINT_LT
+      : op == CompareOp::kLessEqual ? _MM_CMPINT_LE
+      : op == CompareOp::kGreater   ? _MM_CMPINT_NLE
+      : _MM_CMPINT_NLT;
+};
+
+// ordered comparisons except `!=`, to keep the semantics of NaN as scalars.
+template <CompareOp op>
+struct floating_predicate {
+  static constexpr int value =
+      op == CompareOp::kEqual       ? _CMP_EQ_OQ
+      : op == CompareOp::kNotEqual  ? _CMP_NEQ_UQ
+      : op == CompareOp::kLess      ? _CMP_LT_OQ
+      : op == CompareOp::kLessEqual ? _CMP_LE_OQ
+      : op == CompareOp::kGreater   ? _CMP_GT_OQ
+      : _CMP_GE_OQ;
+};
+
+template <CompareOp op, typename T>
+int64_t compareAVX512(const T* values, int64_t const length, T const value,
+                      int64_t* selection) {
+  return compareScalar<op>(values, 0, length, value, selection);
+}
+
+template <CompareOp op, typename T>
+int64_t compareAVX2(const T* values, int64_t const length, T const value,
+                    int64_t* selection) {
+  return compareScalar<op>(values, 0, length, value, selection);
+}
+
+#ifndef COMPARE_AVX512
+#define COMPARE_AVX512(T, lanes, set1, load, compare, predicate)               \
+  template <CompareOp op>                                                      \
+  __attribute__((target("avx512f"))) int64_t compareAVX512(                    \
+      const T* values, int64_t const length, T const value,                    \
+      int64_t* selection) {                                                    \
+    auto const rhs = set1(value);                                              \
+    int64_t count = 0, idx = 0;                                                \
+    for (; idx + lanes <= length; idx += lanes) {                              \
+      uint64_t mask = compare(load(values + idx), rhs, predicate<op>::value);  \
+      count += emitSelection(mask, idx, selection + count);                    \
+    }                                                                          \
+    return count +                                                             \
+           compareScalar<op>(values, idx, length, value, selection + count);   \
+  }
+#endif
+
+COMPARE_AVX512(int32_t, 16, _mm512_set1_epi32, _mm512_loadu_si512,
+               _mm512_cmp_epi32_mask, integral_predicate)
+COMPARE_AVX512(uint32_t, 16, _mm512_set1_epi32, _mm512_loadu_si512,
+               _mm512_cmp_epu32_mask, integral_predicate)
+COMPARE_AVX512(int64_t, 8, _mm512_set1_epi64, _mm512_loadu_si512,
+               _mm512_cmp_epi64_mask, integral_predicate)
+COMPARE_AVX512(uint64_t, 8, _mm512_set1_epi64, _mm512_loadu_si512,
+               _mm512_cmp_epu64_mask, integral_predicate)
+COMPARE_AVX512(float, 16, _mm512_set1_ps, _mm512_loadu_ps,
+               _mm512_cmp_ps_mask, floating_predicate)
+COMPARE_AVX512(double, 8, _mm512_set1_pd, _mm512_loadu_pd,
+               _mm512_cmp_pd_mask, floating_predicate)
+
+#undef COMPARE_AVX512
+
+#ifndef COMPARE_AVX2_INTEGRAL
+#define COMPARE_AVX2_INTEGRAL(T, lanes, set1, cmpeq, cmpgt, movemask, cast)    \
+  template <CompareOp op>                                                      \
+  __attribute__((target("avx2"))) int64_t compareAVX2(                         \
+      const T* values, int64_t const length, T const value,                    \
+      int64_t* selection) {                                                    \
+    const __m256i rhs = set1(value);                                           \
+    int64_t count = 0, idx = 0;                                                \
+    for (; idx + lanes <= length; idx += lanes) {                              \
+      const __m256i lhs =                                                      \
+          _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values + idx));  \
+      __m256i matched;                                                         \
+      if (op == CompareOp::kEqual || op == CompareOp::kNotEqual) {             \
+        matched = cmpeq(lhs, rhs);                                             \
+      } else if (op == CompareOp::kGreater || op == CompareOp::kLessEqual) {   \
+        matched = cmpgt(lhs, rhs);                                             \
+      } else {                                                                 \
+        matched = cmpgt(rhs, lhs);                                             \
+      }                                                                        \
+      uint64_t mask = movemask(cast(matched));                                 \
+      if (negated<op>()) {                                                     \
+        mask ^= (1UL << lanes) - 1;                                            \
+      }                                                                        \
+      count += emitSelection(mask, idx, selection + count);                    \
+    }                                                                          \
+    return count +                                                             \
+           compareScalar<op>(values, idx, length, value, selection + count);   \
+  }
+#endif
+
+COMPARE_AVX2_INTEGRAL(int32_t, 8, _mm256_set1_epi32, _mm256_cmpeq_epi32,
+                      _mm256_cmpgt_epi32, _mm256_movemask_ps,
+                      _mm256_castsi256_ps)
+COMPARE_AVX2_INTEGRAL(int64_t, 4, _mm256_set1_epi64x, _mm256_cmpeq_epi64,
+                      _mm256_cmpgt_epi64, _mm256_movemask_pd,
+                      _mm256_castsi256_pd)
+
+#undef COMPARE_AVX2_INTEGRAL
+
+#ifndef COMPARE_AVX2_FLOATING
+#define COMPARE_AVX2_FLOATING(T, lanes, set1, load, compare, movemask)         \
+  template <CompareOp op>                                                      \
+  __attribute__((target("avx2"))) int64_t compareAVX2(                         \
+      const T* values, int64_t const length, T const value,                    \
+      int64_t* selection) {                                                    \
+    auto const rhs = set1(value);                                              \
+    int64_t count = 0, idx = 0;                                                \
+    for (; idx + lanes <= length; idx += lanes) {                              \
+      uint64_t mask = movemask(                                                \
+          compare(load(values + idx), rhs, floating_predicate<op>::value));    \
+      count += emitSelection(mask, idx, selection + count);                    \
+    }                                                                          \
+    return count +                                                             \
+           compareScalar<op>(values, idx, length, value, selection + count);   \
+  }
+#endif
+
+COMPARE_AVX2_FLOATING(float, 8, _mm256_set1_ps, _mm256_loadu_ps,
+                      _mm256_cmp_ps, _mm256_movemask_ps)
+COMPARE_AVX2_FLOATING(double, 4, _mm256_set1_pd, _mm256_loadu_pd,
+                      _mm256_cmp_pd, _mm256_movemask_pd)
+
+#undef COMPARE_AVX2_FLOATING
+
+template <CompareOp op, typename T>
+int64_t compare(const T* values, int64_t const length, T const value,
+                int64_t* selection) {
+  if (cpuSupportsAVX512()) {
+    return compareAVX512<op>(values, length, value, selection);
+  }
+  if (cpuSupportsAVX2()) {
+    return compareAVX2<op>(values, length, value, selection);
+  }
+  return compareScalar<op>(values, 0, length, value, selection);
+}
+
+template <typename T>
+void gatherValues(const T* values, SelectionVector const& selection, T* out) {
+  for (size_t idx = 0; idx < selection.size(); ++idx) {
+    out[idx] = values[selection[idx]];
+  }
+}
+
+inline int64_t countNulls(arrow::Array const& array,
+                          SelectionVector const& selection) {
+  if (array.null_count() == 0) {
+    return 0;
+  }
+  int64_t null_count = 0;
+  for (auto const& idx : selection) {
+    null_count += array.IsNull(idx);
+  }
+  return null_count;
+}
+
+inline void gatherNullBitmap(arrow::Array const& array,
+                             SelectionVector const& selection,
+                             uint8_t* bitmap) {
+  memset(bitmap, 0, (selection.size() + 7) / 8);
+  for (size_t idx = 0; idx < selection.size(); ++idx) {
+    if (array.IsValid(selection[idx])) {
+      bitmap[idx >> 3] |= static_cast<uint8_t>(1U << (idx & 7));
+    }
+  }
+}
+
+/**
+ * @brief The sizes of blobs that a taken column requires, and how to fill
+ * the (created) blobs and wrap them as an arrow array.
+ */
+struct gather_t {
+  std::vector<size_t> sizes;
+  std::function<std::shared_ptr<arrow::Array>(std::unique_ptr<BlobWriter>*)>
+      fill;
+};
+
+template <typename T>
+bool gatherNumeric(std::shared_ptr<arrow::Array> const& column,
+                   SelectionVector const& selection, gather_t& gather) {
+  using ArrayType = typename ConvertToArrowType<T>::ArrayType;
+  auto array = std::dynamic_pointer_cast<ArrayType>(column);
+  if (array == nullptr) {
+    return false;
+  }
+  int64_t const length = selection.size();
+  int64_t const null_count = countNulls(*array, selection);
+  gather.sizes = {length * sizeof(T)};
+  if (null_count > 0) {
+    gather.sizes.emplace_back((length + 7) / 8);
+  }
+  gather.fill = [array, &selection, length,
+                 null_count](std::unique_ptr<BlobWriter>* blobs) {
+    gatherValues(array->raw_values(), selection,
+                 reinterpret_cast<T*>(blobs[0]->data()));
+    std::shared_ptr<arrow::Buffer> null_bitmap;
+    if (null_count > 0) {
+      gatherNullBitmap(*array, selection,
+                       reinterpret_cast<uint8_t*>(blobs[1]->data()));
+      null_bitmap = blobs[1]->Buffer();
+    }
+    return std::make_shared<ArrayType>(array->type(), length,
+                                       blobs[0]->Buffer(), null_bitmap,
+                                       null_count);
+  };
+  return true;
+}
+
+template <typename ArrayType>
+bool gatherBinary(std::shared_ptr<arrow::Array> const& column,
+                  SelectionVector const& selection, gather_t& gather) {
+  using offset_type = typename ArrayType::offset_type;
+  auto array = std::dynamic_pointer_cast<ArrayType>(column);
+  if (array == nullptr) {
+    return false;
+  }
+  int64_t const length = selection.size();
+  int64_t const null_count = countNulls(*array, selection);
+  size_t data_size = 0;
+  for (auto const& idx : selection) {
+    data_size += array->value_length(idx);
+  }
+  gather.sizes = {(length + 1) * sizeof(offset_type), data_size};
+  if (null_count > 0) {
+    gather.sizes.emplace_back((length + 7) / 8);
+  }
+  gather.fill = [array, &selection, length,
+                 null_count](std::unique_ptr<BlobWriter>* blobs) {
+    offset_type* offsets = reinterpret_cast<offset_type*>(blobs[0]->data());
+    uint8_t* data = reinterpret_cast<uint8_t*>(blobs[1]->data());
+    offsets[0] = 0;
+    for (int64_t idx = 0; idx < length; ++idx) {
+      offset_type value_length = 0;
+      const uint8_t* value = array->GetValue(selection[idx], &value_length);
+      memcpy(data + offsets[idx], value, value_length);
+      offsets[idx + 1] = offsets[idx] + value_length;
+    }
+    std::shared_ptr<arrow::Buffer> null_bitmap;
+    if (null_count > 0) {
+      gatherNullBitmap(*array, selection,
+                       reinterpret_cast<uint8_t*>(blobs[2]->data()));
+      null_bitmap = blobs[2]->Buffer();
+    }
+    return std::make_shared<ArrayType>(length, blobs[0]->Buffer(),
+                                       blobs[1]->Buffer(), null_bitmap,
+                                       null_count);
+  };
+  return true;
+}
+
+inline bool gatherColumn(std::shared_ptr<arrow::Array> const& column,
+                         SelectionVector const& selection, gather_t& gather) {
+  return gatherNumeric<int8_t>(column, selection, gather) ||
+         gatherNumeric<uint8_t>(column, selection, gather) ||
+         gatherNumeric<int16_t>(column, selection, gather) ||
+         gatherNumeric<uint16_t>(column, selection, gather) ||
+         gatherNumeric<int32_t>(column, selection, gather) ||
+         gatherNumeric<uint32_t>(column, selection, gather) ||
+         gatherNumeric<int64_t>(column, selection, gather) ||
+         gatherNumeric<uint64_t>(column, selection, gather) ||
+         gatherNumeric<float>(column, selection, gather) ||
+         gatherNumeric<double>(column, selection, gather) ||
+         gatherBinary<arrow::StringArray>(column, selection, gather) ||
+         gatherBinary<arrow::LargeStringArray>(column, selection, gather);
+}
+
+/**
+ * @brief Assembles the record batch from the columns whose blobs have been
+ * filled.
+ */
+class TakenRecordBatchBuilder : public RecordBatchBaseBuilder {
+ public:
+  TakenRecordBatchBuilder(Client& client,
+                          std::shared_ptr<arrow::Schema> const& schema,
+                          size_t const num_rows)
+      : RecordBatchBaseBuilder(client),
+        arrow_schema_(schema),
+        num_rows_(num_rows) {}
+
+  void AddColumn(std::shared_ptr<ObjectBuilder> const& column) {
+    this->add_columns_(column);
+    num_columns_ += 1;
+  }
+
+  Status Build(Client& client) override {
+    this->set_row_num_(num_rows_);
+    this->set_column_num_(num_columns_);
+    this->set_schema_(detail::BuildSchema(client, arrow_schema_));
+    return Status::OK();
+  }
+
+ private:
+  std::shared_ptr<arrow::Schema> arrow_schema_;
+  size_t num_rows_ = 0, num_columns_ = 0;
+};
+
+template <typename T>
+bool takeTensor(Client& client, std::shared_ptr<ITensor> const& column,
+                SelectionVector const& selection,
+                std::shared_ptr<ITensorBuilder>& taken) {
+  auto tensor = std::dynamic_pointer_cast<Tensor<T>>(column);
+  if (tensor == nullptr) {
+    return false;
+  }
+  auto builder = std::make_shared<TensorBuilder<T>>(
+      client, std::vector<int64_t>{static_cast<int64_t>(selection.size())});
+  gatherValues(tensor->data(), selection, builder->data());
+  taken = builder;
+  return true;
+}
+
+}  // namespace detail
+
+template <typename T>
+int64_t Compare(const T* values, int64_t length, CompareOp op, T value,
+                int64_t* selection) {
+  switch (op) {
+  case CompareOp::kEqual:
+    return detail::compare<CompareOp::kEqual>(values, length, value,
+                                              selection);
+  case CompareOp::kNotEqual:
+    return detail::compare<CompareOp::kNotEqual>(values, length, value,
+                                                 selection);
+  case CompareOp::kLess:
+    return detail::compare<CompareOp::kLess>(values, length, value, selection);
+  case CompareOp::kLessEqual:
+    return detail::compare<CompareOp::kLessEqual>(values, length, value,
+                                                  selection);
+  case CompareOp::kGreater:
+    return detail::compare<CompareOp::kGreater>(values, length, value,
+                                                selection);
+  case CompareOp::kGreaterEqual:
+    return detail::compare<CompareOp::kGreaterEqual>(values, length, value,
+                                                     selection);
+  }
+  return 0;
+}
+
+template <typename T>
+Status Filter(std::shared_ptr<arrow::Array> const& column, CompareOp op,
+              T value, SelectionVector& selection) {
+  using ArrayType = typename ConvertToArrowType<T>::ArrayType;
+  auto array = std::dynamic_pointer_cast<ArrayType>(column);
+  if (array == nullptr) {
+    return Status::Invalid("The column type '" + column->type()->ToString() +
+                           "' doesn't match the predicate");
+  }
+  selection.resize(array->length());
+  int64_t count = Compare(array->raw_values(), array->length(), op, value,
+                          selection.data());
+  if (array->null_count() > 0) {
+    count = std::remove_if(selection.begin(), selection.begin() + count,
+                           [&array](int64_t const idx) {
+                             return array->IsNull(idx);
+                           }) -
+            selection.begin();
+  }
+  selection.resize(count);
+  return Status::OK();
+}
+
+template <typename T>
+Status Filter(std::shared_ptr<arrow::RecordBatch> const& batch,
+              std::string const& column, CompareOp op, T value,
+              SelectionVector& selection) {
+  auto array = batch->GetColumnByName(column);
+  if (array == nullptr) {
+    return Status::Invalid("Column '" + column + "' not found");
+  }
+  return Filter(array, op, value, selection);
+}
+
+template <typename T>
+Status Filter(DataFrame const& dataframe, json const& column, CompareOp op,
+              T value, SelectionVector& selection) {
+  auto const& columns = dataframe.Columns();
+  if (std::find(columns.begin(), columns.end(), column) == columns.end()) {
+    return Status::Invalid("Column '" + json_to_string(column) +
+                           "' not found");
+  }
+  auto tensor = std::dynamic_pointer_cast<Tensor<T>>(dataframe.Column(column));
+  if (tensor == nullptr) {
+    return Status::Invalid("The type of column '" + json_to_string(column) +
+                           "' doesn't match the predicate");
+  }
+  int64_t const length = tensor->shape()[0];
+  selection.resize(length);
+  selection.resize(
+      Compare(tensor->data(), length, op, value, selection.data()));
+  return Status::OK();
+}
+
+void Intersect(SelectionVector const& lhs, SelectionVector const& rhs,
+               SelectionVector& selection) {
+  selection.clear();
+  std::set_intersection(lhs.begin(), lhs.end(), rhs.begin(), rhs.end(),
+                        std::back_inserter(selection));
+}
+
+Status Take(Client& client, std::shared_ptr<arrow::RecordBatch> const& batch,
+            SelectionVector const& selection,
+            std::vector<std::string> const& projection,
+            std::shared_ptr<Object>& result) {
+  RETURN_ON_ASSERT(selection.empty() || selection.back() < batch->num_rows(),
+                   "The selection is out of range");
+  std::vector<int> indices;
+  if (projection.empty()) {
+    for (int idx = 0; idx < batch->num_columns(); ++idx) {
+      indices.emplace_back(idx);
+    }
+  }
+  for (auto const& name : projection) {
+    int idx = batch->schema()->GetFieldIndex(name);
+    if (idx == -1) {
+      return Status::Invalid("Column '" + name + "' not found");
+    }
+    indices.emplace_back(idx);
+  }
+
+  std::vector<detail::gather_t> gathers(indices.size());
+  std::vector<std::shared_ptr<arrow::Field>> fields;
+  std::vector<size_t> sizes;
+  for (size_t idx = 0; idx < indices.size(); ++idx) {
+    auto const& column = batch->column(indices[idx]);
+    if (!detail::gatherColumn(column, selection, gathers[idx])) {
+      return Status::NotImplemented("Taking rows from the column of type '" +
+                                    column->type()->ToString() +
+                                    "' is not supported");
+    }
+    fields.emplace_back(batch->schema()->field(indices[idx]));
+    sizes.insert(sizes.end(), gathers[idx].sizes.begin(),
+                 gathers[idx].sizes.end());
+  }
+
+  // create blobs for all columns in one round trip
+  std::vector<std::unique_ptr<BlobWriter>> writers;
+  RETURN_ON_ERROR(client.CreateBlobs(sizes, writers));
+  auto builder = std::make_shared<detail::TakenRecordBatchBuilder>(
+      client, arrow::schema(fields, batch->schema()->metadata()),
+      selection.size());
+  auto writer = writers.begin();
+  for (auto const& gather : gathers) {
+    auto column =
+        vineyard::detail::BuildSimpleArray(client, gather.fill(&*writer));
+    std::vector<std::shared_ptr<BlobWriter>> blobs;
+    for (size_t idx = 0; idx < gather.sizes.size(); ++idx, ++writer) {
+      blobs.emplace_back(std::move(*writer));
+    }
+    std::dynamic_pointer_cast<vineyard::detail::ArrowBufferBuilder>(column)
+        ->AttachBlobs(std::move(blobs));
+    builder->AddColumn(column);
+  }
+  result = builder->Seal(client);
+  return Status::OK();
+}
+
+Status Take(Client& client, DataFrame const& dataframe,
+            SelectionVector const& selection,
+            std::vector<json> const& projection,
+            std::shared_ptr<Object>& result) {
+  RETURN_ON_ASSERT(selection.empty() || static_cast<size_t>(selection.back()) <
+                                            dataframe.shape().first,
+                   "The selection is out of range");
+  auto const& columns = dataframe.Columns();
+  DataFrameBuilder builder(client);
+  builder.set_partition_index(dataframe.partition_index().first,
+                              dataframe.partition_index().second);
+  for (auto const& column : projection.empty() ? columns : projection) {
+    if (std::find(columns.begin(), columns.end(), column) == columns.end()) {
+      return Status::Invalid("Column '" + json_to_string(column) +
+                             "' not found");
+    }
+    auto const& tensor = dataframe.Column(column);
+    std::shared_ptr<ITensorBuilder> taken;
+    if (!(detail::takeTensor<int32_t>(client, tensor, selection, taken) ||
+          detail::takeTensor<uint32_t>(client, tensor, selection, taken) ||
+          detail::takeTensor<int64_t>(client, tensor, selection, taken) ||
+          detail::takeTensor<uint64_t>(client, tensor, selection, taken) ||
+          detail::takeTensor<float>(client, tensor, selection, taken) ||
+          detail::takeTensor<double>(client, tensor, selection, taken))) {
+      return Status::NotImplemented("Taking rows from the column '" +
+                                    json_to_string(column) +
+                                    "' is not supported");
+    }
+    builder.AddColumn(column, taken);
+  }
+  result = builder.Seal(client);
+  return Status::OK();
+}
+
+#ifndef INSTANTIATE_ARRAY_KERNELS
+#define INSTANTIATE_ARRAY_KERNELS(T)                                         \
+  template int64_t Compare<T>(const T* values, int64_t length, CompareOp op, \
+                              T value, int64_t* selection);                  \
+  template Status Filter<T>(std::shared_ptr<arrow::Array> const& column,     \
+                            CompareOp op, T value,                           \
+                            SelectionVector& selection);                     \
+  template Status Filter<T>(                                                 \
+      std::shared_ptr<arrow::RecordBatch> const& batch,                      \
+      std::string const& column, CompareOp op, T value,                      \
+      SelectionVector& selection);
+#endif
+
+#ifndef INSTANTIATE_TENSOR_KERNELS
+#define INSTANTIATE_TENSOR_KERNELS(T)                                       \
+  template Status Filter<T>(DataFrame const& dataframe, json const& column, \
+                            CompareOp op, T value,                          \
+                            SelectionVector& selection);
+#endif
+
+INSTANTIATE_ARRAY_KERNELS(int8_t)
+INSTANTIATE_ARRAY_KERNELS(uint8_t)
+INSTANTIATE_ARRAY_KERNELS(int16_t)
+INSTANTIATE_ARRAY_KERNELS(uint16_t)
+INSTANTIATE_ARRAY_KERNELS(int32_t)
+INSTANTIATE_ARRAY_KERNELS(uint32_t)
+INSTANTIATE_ARRAY_KERNELS(int64_t)
+INSTANTIATE_ARRAY_KERNELS(uint64_t)
+INSTANTIATE_ARRAY_KERNELS(float)
+INSTANTIATE_ARRAY_KERNELS(double)
+
+// the element types of dataframe columns, see also `AnyTypeEnum`.
+INSTANTIATE_TENSOR_KERNELS(int32_t)
+INSTANTIATE_TENSOR_KERNELS(uint32_t)
+INSTANTIATE_TENSOR_KERNELS(int64_t)
+INSTANTIATE_TENSOR_KERNELS(uint64_t)
+INSTANTIATE_TENSOR_KERNELS(float)
+INSTANTIATE_TENSOR_KERNELS(double)
+
+#undef INSTANTIATE_ARRAY_KERNELS
+#undef INSTANTIATE_TENSOR_KERNELS
+
+}  // namespace kernels
+
+}  // namespace vineyard
@@ -0,0 +1,115 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef MODULES_BASIC_DS_KERNELS_H_
+#define MODULES_BASIC_DS_KERNELS_H_
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "arrow/api.h"
+
+#include "basic/ds/arrow.h"
+#include "basic/ds/dataframe.h"
+#include "client/client.h"
+#include "common/util/json.h"
+#include "common/util/status.h"
+
+namespace vineyard {
+
+namespace kernels {
+
+/**
+ * @brief The comparison of the predicate `column <op> value`.
+ */
+enum class CompareOp {
+  kEqual,
+  kNotEqual,
+  kLess,
+  kLessEqual,
+  kGreater,
+  kGreaterEqual,
+};
+
+/**
+ * @brief The selection vector holds the indices of the selected rows in
+ * ascending order.
+ */
+using SelectionVector = std::vector<int64_t>;
+
+/**
+ * @brief Evaluate `values[i] <op> value` over a contiguous buffer and write
+ * the indices of the matched rows into `selection`, which must be able to hold
+ * `length` indices.
+ *
+ * The kernel runs on AVX-512 or AVX2 when the CPU supports them (detected at
+ * runtime), otherwise on a branch-free scalar loop.
+ *
+ * @return The number of the matched rows.
+ */
+template <typename T>
+int64_t Compare(const T* values, int64_t length, CompareOp op, T value,
+                int64_t* selection);
+
+/**
+ * @brief Filter the rows of a numeric arrow array, null values never match.
+ */
+template <typename T>
+Status Filter(std::shared_ptr<arrow::Array> const& column, CompareOp op,
+              T value, SelectionVector& selection);
+
+template <typename T>
+Status Filter(std::shared_ptr<arrow::RecordBatch> const& batch,
+              std::string const& column, CompareOp op, T value,
+              SelectionVector& selection);
+
+template <typename T>
+Status Filter(DataFrame const& dataframe, json const& column, CompareOp op,
+              T value, SelectionVector& selection);
+
+/**
+ * @brief The conjunction of two predicates.
+ */
+void Intersect(SelectionVector const& lhs, SelectionVector const& rhs,
+               SelectionVector& selection);
+
+/**
+ * @brief Gather the selected rows of the projected columns into new blobs
+ * directly and seal them as a vineyard RecordBatch. All columns are projected
+ * if the projection is empty.
+ *
+ * Numeric and (large) string columns are supported.
+ */
+Status Take(Client& client, std::shared_ptr<arrow::RecordBatch> const& batch,
+            SelectionVector const& selection,
+            std::vector<std::string> const& projection,
+            std::shared_ptr<Object>& result);
+
+/**
+ * @brief Gather the selected rows of the projected columns into new tensors
+ * and seal them as a vineyard DataFrame. All columns are projected if the
+ * projection is empty.
+ */
+Status Take(Client& client, DataFrame const& dataframe,
+            SelectionVector const& selection,
+            std::vector<json> const& projection,
+            std::shared_ptr<Object>& result);
+
+}  // namespace kernels
+
+}  // namespace vineyard
+
+#endif  // MODULES_BASIC_DS_KERNELS_H_
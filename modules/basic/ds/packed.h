@@ -0,0 +1,106 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef MODULES_BASIC_DS_PACKED_H_
+#define MODULES_BASIC_DS_PACKED_H_
+
+#include <cstring>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "basic/ds/packed.vineyard.h"
+#include "client/client.h"
+#include "client/ds/blob.h"
+
+namespace vineyard {
+
+/**
+ * @brief PackedValuesBuilder accumulates the values in memory, and writes
+ * them into a single blob on `Seal`, i.e., a batch of values costs one blob
+ * and one metadata entry in total.
+ */
+class PackedValuesBuilder : public PackedValuesBaseBuilder {
+ public:
+  explicit PackedValuesBuilder(Client& client)
+      : PackedValuesBaseBuilder(client) {
+    value_offsets_.emplace_back(0);
+  }
+
+  /**
+   * @brief Reserve the space for `values` values of `bytes` bytes in total.
+   */
+  void Reserve(size_t const values, size_t const bytes) {
+    value_offsets_.reserve(values + 1);
+    values_.reserve(bytes);
+  }
+
+  /**
+   * @brief The number of values that have been appended.
+   */
+  size_t size() const { return value_offsets_.size() - 1; }
+
+  void Append(const void* data, size_t const size) {
+    values_.append(reinterpret_cast<const char*>(data), size);
+    value_offsets_.emplace_back(values_.size());
+  }
+
+  void Append(std::string const& value) {
+    Append(value.data(), value.size());
+  }
+
+  /**
+   * @brief Append the values in batch.
+   */
+  void Append(std::vector<std::string> const& values) {
+    for (auto const& value : values) {
+      Append(value.data(), value.size());
+    }
+  }
+
+  /**
+   * @brief Append the bytes of a trivially copyable value, see also
+   * `PackedValues::Value`.
+   */
+  template <typename T>
+  void AppendValue(T const& value) {
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "The value must be trivially copyable");
+    Append(&value, sizeof(T));
+  }
+
+  Status Build(Client& client) override {
+    size_t table_size = value_offsets_.size() * sizeof(int64_t);
+    std::unique_ptr<BlobWriter> buffer;
+    RETURN_ON_ERROR(client.CreateBlob(table_size + values_.size(), buffer));
+    memcpy(buffer->data(), value_offsets_.data(), table_size);
+    if (!values_.empty()) {
+      memcpy(buffer->data() + table_size, values_.data(), values_.size());
+    }
+    this->set_size_(size());
+    this->set_buffer_(std::shared_ptr<BlobWriter>(std::move(buffer)));
+    return Status::OK();
+  }
+
+ private:
+  std::vector<int64_t> value_offsets_;
+  std::string values_;
+};
+
+}  // namespace vineyard
+
+#endif  // MODULES_BASIC_DS_PACKED_H_
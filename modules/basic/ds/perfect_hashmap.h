@@ -0,0 +1,252 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef MODULES_BASIC_DS_PERFECT_HASHMAP_H_
+#define MODULES_BASIC_DS_PERFECT_HASHMAP_H_
+
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "flat_hash_map/flat_hash_map.hpp"
+
+#include "basic/ds/array.h"
+#include "basic/ds/perfect_hashmap.vineyard.h"
+#include "client/ds/blob.h"
+#include "client/ds/i_object.h"
+#include "common/util/uuid.h"
+
+namespace vineyard {
+
+/**
+ * @brief PerfectHashmapBuilder is used for constructing the immutable perfect
+ * hash maps, the keys are collected in a (mutable) hash map first.
+ *
+ * @tparam K The type for the key.
+ * @tparam V The type for the value.
+ * @tparam std::hash<K> The hash function for the key.
+ * @tparam std::equal_to<K> The compare function for the key.
+ */
+template <typename K, typename V, typename H = std::hash<K>,
+          typename E = std::equal_to<K>>
+class PerfectHashmapBuilder : public PerfectHashmapBaseBuilder<K, V, H, E> {
+ public:
+  using value_type = std::pair<K, V>;
+
+  explicit PerfectHashmapBuilder(Client& client)
+      : PerfectHashmapBaseBuilder<K, V, H, E>(client) {}
+
+  explicit PerfectHashmapBuilder(Client& client,
+                                 ska::flat_hash_map<K, V, H, E>&& hashmap)
+      : PerfectHashmapBaseBuilder<K, V, H, E>(client),
+        hashmap_(std::move(hashmap)) {}
+
+  /**
+   * @brief Get the mapping value of the given key.
+   *
+   */
+  inline V& operator[](const K& key) { return hashmap_[key]; }
+
+  /**
+   * @brief Get the mapping value of the given key.
+   *
+   */
+  inline V& operator[](K&& key) { return hashmap_[std::move(key)]; }
+
+  /**
+   * @brief Emplace key-value pair into the hashmap.
+   *
+   */
+  template <class... Args>
+  inline void emplace(Args&&... args) {
+    hashmap_.emplace(std::forward<Args>(args)...);
+  }
+
+  /**
+   * @brief Get the size of the hashmap.
+   *
+   */
+  size_t size() const { return hashmap_.size(); }
+
+  /**
+   * @brief Reserve the size for the hashmap.
+   *
+   */
+  void reserve(size_t size) { hashmap_.reserve(size); }
+
+  /**
+   * @brief Check whether the hashmap is empty.
+   *
+   */
+  bool empty() const { return hashmap_.empty(); }
+
+  /**
+   * @brief Build the hashmap object.
+   *
+   */
+  Status Build(Client& client) override {
+    size_t const num_elements = hashmap_.size();
+    size_t table_size = 0, num_buckets = 0;
+    uint64_t seed = 0;
+    std::vector<uint32_t> pilots;
+    std::vector<uint64_t> slots;
+    if (num_elements > 0) {
+      table_size = num_elements + num_elements / kExtraSlotsRatio;
+      num_buckets = (num_elements + kBucketSize - 1) / kBucketSize;
+      bool found = false;
+      for (size_t attempt = 0; attempt < kMaxAttempts && !found; ++attempt) {
+        seed = detail::MixHash(attempt + 1);
+        found = searchPilots(seed, table_size, num_buckets, pilots, slots);
+      }
+      RETURN_ON_ASSERT(found, "Failed to build the perfect hash function");
+    }
+
+    // move the entries in the extra slots to the free slots
+    std::vector<uint64_t> remap(table_size - num_elements, 0);
+    {
+      std::vector<bool> occupied(table_size, false);
+      for (auto const& slot : slots) {
+        occupied[slot] = true;
+      }
+      size_t free_slot = 0;
+      for (size_t slot = num_elements; slot < table_size; ++slot) {
+        if (occupied[slot]) {
+          while (occupied[free_slot]) {
+            ++free_slot;
+          }
+          remap[slot - num_elements] = free_slot++;
+        }
+      }
+    }
+
+    auto entries_builder =
+        std::make_shared<ArrayBuilder<value_type>>(client, num_elements);
+    {
+      size_t index = 0;
+      for (auto const& kv : hashmap_) {
+        uint64_t slot = slots[index++];
+        if (slot >= num_elements) {
+          slot = remap[slot - num_elements];
+        }
+        new (entries_builder->data() + slot) value_type(kv.first, kv.second);
+      }
+    }
+
+    this->set_num_elements_(num_elements);
+    this->set_table_size_(table_size);
+    this->set_num_buckets_(num_buckets);
+    this->set_seed_(seed);
+    this->set_pilots_(std::make_shared<ArrayBuilder<uint32_t>>(client, pilots));
+    this->set_remap_(std::make_shared<ArrayBuilder<uint64_t>>(client, remap));
+    this->set_entries_(std::static_pointer_cast<ObjectBase>(entries_builder));
+    return Status::OK();
+  }
+
+ private:
+  // the average number of keys in a bucket
+  static constexpr size_t kBucketSize = 4;
+  // 2% extra slots
+  static constexpr size_t kExtraSlotsRatio = 50;
+  static constexpr uint32_t kMaxPilot = 1U << 20;
+  static constexpr size_t kMaxAttempts = 16;
+
+  /**
+   * @brief Search the pilots for buckets in descending order of the sizes,
+   * fails if the pilot of any bucket cannot be found (e.g., keys with the
+   * colliding hashes) and another seed should be tried.
+   */
+  bool searchPilots(uint64_t const seed, size_t const table_size,
+                    size_t const num_buckets, std::vector<uint32_t>& pilots,
+                    std::vector<uint64_t>& slots) {
+    size_t const num_elements = hashmap_.size();
+    std::vector<uint64_t> hashes;
+    hashes.reserve(num_elements);
+    for (auto const& kv : hashmap_) {
+      hashes.emplace_back(detail::MixHash(hasher_(kv.first) ^ seed));
+    }
+
+    // group the keys by buckets
+    std::vector<size_t> offsets(num_buckets + 1, 0), keys(num_elements);
+    for (auto const& hash : hashes) {
+      offsets[detail::PerfectHashBucket(hash, num_buckets) + 1] += 1;
+    }
+    size_t max_bucket_size = 0;
+    for (size_t bucket = 0; bucket < num_buckets; ++bucket) {
+      max_bucket_size = std::max(max_bucket_size, offsets[bucket + 1]);
+      offsets[bucket + 1] += offsets[bucket];
+    }
+    {
+      std::vector<size_t> cursors(offsets.begin(), offsets.end() - 1);
+      for (size_t index = 0; index < num_elements; ++index) {
+        keys[cursors[detail::PerfectHashBucket(hashes[index], num_buckets)]++] =
+            index;
+      }
+    }
+    std::vector<size_t> buckets(num_buckets);
+    for (size_t bucket = 0; bucket < num_buckets; ++bucket) {
+      buckets[bucket] = bucket;
+    }
+    std::stable_sort(buckets.begin(), buckets.end(),
+                     [&offsets](size_t const lhs, size_t const rhs) {
+                       return offsets[lhs + 1] - offsets[lhs] >
+                              offsets[rhs + 1] - offsets[rhs];
+                     });
+
+    pilots.assign(num_buckets, 0);
+    slots.assign(num_elements, 0);
+    std::vector<bool> taken(table_size, false);
+    std::vector<uint64_t> candidates(max_bucket_size);
+    for (auto const& bucket : buckets) {
+      size_t const begin = offsets[bucket], end = offsets[bucket + 1];
+      if (begin == end) {
+        continue;
+      }
+      bool placed = false;
+      for (uint32_t pilot = 0; pilot < kMaxPilot && !placed; ++pilot) {
+        placed = true;
+        for (size_t idx = begin; idx < end && placed; ++idx) {
+          uint64_t slot =
+              detail::PerfectHashSlot(hashes[keys[idx]], pilot, table_size);
+          placed = !taken[slot] &&
+                   std::find(candidates.begin(),
+                             candidates.begin() + (idx - begin),
+                             slot) == candidates.begin() + (idx - begin);
+          candidates[idx - begin] = slot;
+        }
+        if (placed) {
+          pilots[bucket] = pilot;
+          for (size_t idx = begin; idx < end; ++idx) {
+            taken[candidates[idx - begin]] = true;
+            slots[keys[idx]] = candidates[idx - begin];
+          }
+        }
+      }
+      if (!placed) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  ska::flat_hash_map<K, V, H, E> hashmap_;
+  H hasher_;
+};
+
+}  // namespace vineyard
+
+#endif  // MODULES_BASIC_DS_PERFECT_HASHMAP_H_
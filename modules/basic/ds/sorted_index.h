@@ -0,0 +1,179 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef MODULES_BASIC_DS_SORTED_INDEX_H_
+#define MODULES_BASIC_DS_SORTED_INDEX_H_
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "basic/ds/dataframe.h"
+#include "basic/ds/sorted_index.vineyard.h"
+#include "basic/ds/tensor.h"
+#include "client/client.h"
+#include "client/ds/blob.h"
+
+namespace vineyard {
+
+namespace detail {
+
+/**
+ * @brief Sort the values with `concurrency` threads: the chunks are sorted
+ * in parallel, then merged pairwise round by round.
+ */
+template <typename T>
+void ParallelSort(std::vector<T>& values, size_t concurrency) {
+  static constexpr size_t kMinChunkSize = 64 * 1024;
+  concurrency = std::max(
+      static_cast<size_t>(1),
+      std::min(concurrency, values.size() / kMinChunkSize));
+  std::vector<size_t> bounds;
+  for (size_t index = 0; index <= concurrency; ++index) {
+    bounds.emplace_back(values.size() * index / concurrency);
+  }
+  std::vector<std::thread> workers;
+  for (size_t index = 0; index < concurrency; ++index) {
+    workers.emplace_back([&values, &bounds, index]() {
+      std::sort(values.begin() + bounds[index],
+                values.begin() + bounds[index + 1]);
+    });
+  }
+  for (auto& worker : workers) {
+    worker.join();
+  }
+  for (size_t width = 1; width < concurrency; width *= 2) {
+    workers.clear();
+    for (size_t index = 0; index + width < concurrency; index += 2 * width) {
+      size_t end = std::min(index + 2 * width, concurrency);
+      workers.emplace_back([&values, &bounds, index, width, end]() {
+        std::inplace_merge(values.begin() + bounds[index],
+                           values.begin() + bounds[index + width],
+                           values.begin() + bounds[end]);
+      });
+    }
+    for (auto& worker : workers) {
+      worker.join();
+    }
+  }
+}
+
+}  // namespace detail
+
+/**
+ * @brief SortedIndexBuilder builds the sorted index over a key column of a
+ * sealed dataframe, the column must be a `Tensor<K>`.
+ *
+ * The (key, row) pairs are sorted in parallel, ties are kept in the row
+ * order, hence `Lookup` returns the first row of a key.
+ */
+template <typename K>
+class SortedIndexBuilder : public SortedIndexBaseBuilder<K> {
+ public:
+  static constexpr size_t kDefaultFanout = 64;
+
+  SortedIndexBuilder(Client& client, std::shared_ptr<DataFrame> dataframe,
+                     json const& key_column,
+                     size_t const fanout = kDefaultFanout,
+                     size_t const concurrency =
+                         std::thread::hardware_concurrency())
+      : SortedIndexBaseBuilder<K>(client),
+        dataframe_(dataframe),
+        key_column_(key_column),
+        fanout_(std::max(fanout, static_cast<size_t>(2))),
+        concurrency_(std::max(concurrency, static_cast<size_t>(1))) {}
+
+  Status Build(Client& client) override {
+    auto const& columns = dataframe_->Columns();
+    RETURN_ON_ASSERT(
+        std::find(columns.begin(), columns.end(), key_column_) !=
+            columns.end(),
+        "The key column doesn't exist in the dataframe: " + key_column_.dump());
+    auto tensor =
+        std::dynamic_pointer_cast<Tensor<K>>(dataframe_->Column(key_column_));
+    RETURN_ON_ASSERT(tensor != nullptr,
+                     "The key column is not a tensor of " + type_name<K>());
+    size_t const length = tensor->shape().empty() ? 0 : tensor->shape()[0];
+
+    std::vector<std::pair<K, int64_t>> entries(length);
+    const K* values = tensor->data();
+    for (size_t index = 0; index < length; ++index) {
+      entries[index] = std::make_pair(values[index], index);
+    }
+    detail::ParallelSort(entries, concurrency_);
+
+    auto levels = detail::SortedIndexLevels(length, fanout_);
+    size_t fences_size = 0;
+    for (auto const size : levels) {
+      fences_size += size;
+    }
+
+    std::shared_ptr<ObjectBase> keys, rows, fences;
+    K *keys_data = nullptr, *fences_data = nullptr;
+    int64_t* rows_data = nullptr;
+    RETURN_ON_ERROR(createBlob(client, length, keys, keys_data));
+    RETURN_ON_ERROR(createBlob(client, length, rows, rows_data));
+    RETURN_ON_ERROR(createBlob(client, fences_size, fences, fences_data));
+    for (size_t index = 0; index < length; ++index) {
+      keys_data[index] = entries[index].first;
+      rows_data[index] = entries[index].second;
+    }
+    // every `fanout`-th entry of a level forms the level above
+    const K* below = keys_data;
+    for (auto const size : levels) {
+      for (size_t index = 0; index < size; ++index) {
+        fences_data[index] = below[index * fanout_];
+      }
+      below = fences_data;
+      fences_data += size;
+    }
+
+    this->set_length_(length);
+    this->set_fanout_(fanout_);
+    this->set_value_type_(AnyType(AnyTypeEnum<K>::value));
+    this->set_key_column_(key_column_.dump());
+    this->set_keys_(keys);
+    this->set_rows_(rows);
+    this->set_fences_(fences);
+    this->set_dataframe_(dataframe_);
+    return Status::OK();
+  }
+
+ private:
+  template <typename T>
+  Status createBlob(Client& client, size_t const size,
+                    std::shared_ptr<ObjectBase>& blob, T*& data) {
+    if (size == 0) {
+      blob = Blob::MakeEmpty(client);
+      return Status::OK();
+    }
+    std::unique_ptr<BlobWriter> writer;
+    RETURN_ON_ERROR(client.CreateBlob(size * sizeof(T), writer));
+    data = reinterpret_cast<T*>(writer->data());
+    blob = std::move(writer);
+    return Status::OK();
+  }
+
+  std::shared_ptr<DataFrame> dataframe_;
+  json key_column_;
+  size_t fanout_, concurrency_;
+};
+
+}  // namespace vineyard
+
+#endif  // MODULES_BASIC_DS_SORTED_INDEX_H_
@@ -17,12 +17,14 @@ limitations under the License.
 #define MODULES_BASIC_DS_TENSOR_H_
 
 #include <algorithm>
+#include <atomic>
 #include <functional>
 #include <map>
 #include <memory>
 #include <numeric>
 #include <set>
 #include <string>
+#include <thread>
 #include <tuple>
 #include <utility>
 #include <vector>
@@ -45,6 +47,56 @@ class ITensorBuilder {
   virtual ~ITensorBuilder() {}
 };
 
+/**
+ * @brief The memory layout of the elements of tensors, i.e., numpy's "C" and
+ * "F" order.
+ */
+enum class TensorOrder {
+  kRowMajor = 0,
+  kColumnMajor = 1,
+};
+
+namespace detail {
+
+/**
+ * @brief Run `task(i)` for `i` in `[0, size)` on at most `concurrency`
+ * threads (0 means the hardware concurrency), and returns the first error.
+ */
+inline Status ParallelRun(size_t const size,
+                          std::function<Status(size_t const)> const& task,
+                          size_t const concurrency = 0) {
+  size_t parallelism = concurrency;
+  if (parallelism == 0) {
+    parallelism =
+        std::max<unsigned int>(1, std::thread::hardware_concurrency());
+  }
+  parallelism = std::min(parallelism, size);
+  std::atomic<size_t> next(0);
+  std::vector<Status> statuses(parallelism);
+  auto run = [&](size_t const worker) {
+    for (size_t idx = next++; idx < size; idx = next++) {
+      statuses[worker] &= task(idx);
+    }
+  };
+  std::vector<std::thread> workers;
+  for (size_t worker = 1; worker < parallelism; ++worker) {
+    workers.emplace_back(run, worker);
+  }
+  if (parallelism > 0) {
+    run(0);
+  }
+  for (auto& worker : workers) {
+    worker.join();
+  }
+  Status status;
+  for (auto const& s : statuses) {
+    status &= s;
+  }
+  return status;
+}
+
+}  // namespace detail
+
 /**
  * @brief TensorBuilder is used for building tensors that supported by vineyard
  *
@@ -82,6 +134,17 @@ class TensorBuilder : public ITensorBuilder, public TensorBaseBuilder<T> {
     this->set_partition_index_(partition_index);
   }
 
+  /**
+   * @brief Initialize the TensorBuilder with the tensor shape and the memory
+   * layout, column-major tensors are resolved as Fortran-ordered numpy arrays
+   * in Python without copy.
+   */
+  TensorBuilder(Client& client, std::vector<int64_t> const& shape,
+                TensorOrder const order)
+      : TensorBuilder(client, shape) {
+    order_ = order;
+  }
+
   /**
    * @brief Get the shape of the tensor.
    *
@@ -126,6 +189,16 @@ class TensorBuilder : public ITensorBuilder, public TensorBaseBuilder<T> {
    */
   std::vector<int64_t> strides() const {
     std::vector<int64_t> vec(this->shape_.size());
+    if (vec.empty()) {
+      return vec;
+    }
+    if (order_ == TensorOrder::kColumnMajor) {
+      vec[0] = sizeof(T);
+      for (size_t i = 1; i < this->shape_.size(); ++i) {
+        vec[i] = vec[i - 1] * this->shape_[i - 1];
+      }
+      return vec;
+    }
     vec[this->shape_.size() - 1] = sizeof(T);
     for (size_t i = this->shape_.size() - 1; i > 0; --i) {
       vec[i - 1] = vec[i] * this->shape_[i];
@@ -133,12 +206,47 @@ class TensorBuilder : public ITensorBuilder, public TensorBaseBuilder<T> {
     return vec;
   }
 
+  /**
+   * @brief Get the memory layout of the tensor.
+   */
+  TensorOrder order() const { return order_; }
+
   /**
    * @brief Get the data pointer of the tensor.
    *
    */
   inline T* data() const { return this->data_; }
 
+  /**
+   * @brief Fill the tensor concurrently, the rows (i.e., the first axis) are
+   * split into disjoint ranges and `fill(begin, end)` is invoked for each
+   * range `[begin, end)` on a separate thread. The elements are addressed by
+   * `data()` and `strides()`.
+   *
+   * @param concurrency The number of threads, 0 means the hardware
+   * concurrency.
+   */
+  Status Fill(std::function<Status(int64_t const, int64_t const)> const& fill,
+              size_t const concurrency = 0) {
+    int64_t rows = this->shape_.empty() ? 1 : this->shape_[0];
+    size_t parallelism = concurrency;
+    if (parallelism == 0) {
+      parallelism =
+          std::max<unsigned int>(1, std::thread::hardware_concurrency());
+    }
+    parallelism = std::max<size_t>(
+        1, std::min(parallelism, static_cast<size_t>(rows)));
+    int64_t slice = (rows + parallelism - 1) / parallelism;
+    return detail::ParallelRun(
+        parallelism,
+        [&](size_t const index) -> Status {
+          int64_t begin = std::min(rows, slice * static_cast<int64_t>(index));
+          int64_t end = std::min(rows, begin + slice);
+          return begin < end ? fill(begin, end) : Status::OK();
+        },
+        parallelism);
+  }
+
   /**
    * @brief Build the tensor.
    *
@@ -149,9 +257,57 @@ class TensorBuilder : public ITensorBuilder, public TensorBaseBuilder<T> {
     return Status::OK();
   }
 
+  /**
+   * @brief Same as the generated one, besides the strides (and the order) of
+   * column-major tensors are kept in the metadata as well.
+   */
+  std::shared_ptr<Object> _Seal(Client& client) override {
+    if (order_ == TensorOrder::kRowMajor) {
+      return TensorBaseBuilder<T>::_Seal(client);
+    }
+    // ensure the builder hasn't been sealed yet.
+    ENSURE_NOT_SEALED(this);
+
+    VINEYARD_CHECK_OK(this->Build(client));
+    auto __value = std::make_shared<Tensor<T>>();
+
+    size_t __value_nbytes = 0;
+
+    __value->meta_.SetTypeName(type_name<Tensor<T>>());
+
+    __value->value_type_ = this->value_type_;
+    __value->meta_.AddKeyValue("value_type_", __value->value_type_);
+
+    __value->buffer_ =
+        std::dynamic_pointer_cast<Blob>(this->buffer_->_Seal(client));
+    __value->meta_.AddMember("buffer_", __value->buffer_);
+    __value_nbytes += __value->buffer_->nbytes();
+
+    __value->shape_ = this->shape_;
+    __value->meta_.AddKeyValue("shape_", __value->shape_);
+
+    __value->partition_index_ = this->partition_index_;
+    __value->meta_.AddKeyValue("partition_index_", __value->partition_index_);
+
+    __value->meta_.AddKeyValue("strides_", strides());
+    __value->meta_.AddKeyValue("order_", std::string("F"));
+
+    __value->meta_.SetNBytes(__value_nbytes);
+
+    VINEYARD_CHECK_OK(client.CreateMetaData(__value->meta_, __value->id_));
+
+    // mark the builder as sealed
+    this->set_sealed(true);
+
+    // run `PostConstruct` to return a valid object
+    __value->PostConstruct(__value->meta_);
+    return std::static_pointer_cast<Object>(__value);
+  }
+
  private:
   std::unique_ptr<BlobWriter> buffer_writer_;
   T* data_;
+  TensorOrder order_ = TensorOrder::kRowMajor;
 };
 
 class GlobalTensorBaseBuilder;
@@ -305,6 +461,75 @@ class GlobalTensorBuilder : public GlobalTensorBaseBuilder {
    */
   void AddPartitions(const std::vector<ObjectID>& partition_ids);
 
+  /**
+   * @brief Partition the global tensor (see `set_shape` and
+   * `set_partition_shape`) and build the partitions on the connected
+   * instance in one call.
+   *
+   * The partitions are numbered in row-major order of their indices, and
+   * the `i`-th partition is built by this builder iff `i % workers ==
+   * worker`, thus workers connected to different instances could build
+   * their shares of the same global tensor and exchange the ids (see
+   * `AddPartitions`) before sealing. `fill(partition, offset)` is invoked
+   * for each partition concurrently, where `offset` is the position of the
+   * first element of the partition in the global tensor.
+   *
+   * @param concurrency The number of threads to fill partitions, 0 means
+   * the hardware concurrency.
+   */
+  template <typename T>
+  Status BuildPartitions(
+      Client& client,
+      std::function<Status(TensorBuilder<T>&, std::vector<int64_t> const&)>
+          const& fill,
+      size_t const worker = 0, size_t const workers = 1,
+      TensorOrder const order = TensorOrder::kRowMajor,
+      size_t const concurrency = 0) {
+    size_t ndim = this->shape_.size();
+    RETURN_ON_ASSERT(this->partition_shape_.size() == ndim,
+                     "The partition shape doesn't match the shape");
+    RETURN_ON_ASSERT(worker < workers, "Invalid worker index");
+    size_t num_partitions = 1;
+    std::vector<int64_t> extents(ndim);
+    for (size_t i = 0; i < ndim; ++i) {
+      int64_t parts = this->partition_shape_[i];
+      RETURN_ON_ASSERT(parts > 0 && parts <= this->shape_[i],
+                       "Invalid partition shape on axis " + std::to_string(i));
+      extents[i] = (this->shape_[i] + parts - 1) / parts;
+      num_partitions *= parts;
+    }
+
+    std::vector<std::shared_ptr<TensorBuilder<T>>> builders;
+    std::vector<std::vector<int64_t>> offsets;
+    for (size_t p = worker; p < num_partitions; p += workers) {
+      std::vector<int64_t> index(ndim), offset(ndim), shape(ndim);
+      size_t remainder = p;
+      for (size_t i = ndim; i > 0; --i) {
+        index[i - 1] = remainder % this->partition_shape_[i - 1];
+        remainder /= this->partition_shape_[i - 1];
+        offset[i - 1] = index[i - 1] * extents[i - 1];
+        shape[i - 1] =
+            std::min(extents[i - 1], this->shape_[i - 1] - offset[i - 1]);
+      }
+      RETURN_ON_ASSERT(
+          std::all_of(shape.begin(), shape.end(),
+                      [](int64_t const extent) { return extent > 0; }),
+          "Empty partition at " + std::to_string(p));
+      auto builder = std::make_shared<TensorBuilder<T>>(client, shape, order);
+      builder->set_partition_index(index);
+      builders.emplace_back(builder);
+      offsets.emplace_back(std::move(offset));
+    }
+    RETURN_ON_ERROR(detail::ParallelRun(
+        builders.size(),
+        [&](size_t const idx) { return fill(*builders[idx], offsets[idx]); },
+        concurrency));
+    for (auto const& builder : builders) {
+      this->AddPartition(builder->Seal(client)->id());
+    }
+    return Status::OK();
+  }
+
   /**
    * @brief Seal the meta data of the global tensor.
    * When creating a global tensor, clients from different
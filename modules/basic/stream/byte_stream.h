@@ -50,11 +50,31 @@ class ByteStreamBuilder : public ByteStreamBaseBuilder {
     }
   }
 
+  /**
+   * @brief Keep the chunks that have been read within the budget, thus
+   * readers can reopen the stream at a chunk offset and replay.
+   */
+  void SetRetention(size_t const chunks, size_t const bytes) {
+    retain_chunks_ = chunks;
+    retain_bytes_ = bytes;
+  }
+
+  /**
+   * @brief Limit the total bytes of chunks that the stream holds, the
+   * producer waits for the consumers when exceeding it.
+   */
+  void SetBudget(size_t const bytes) { budget_bytes_ = bytes; }
+
   std::shared_ptr<Object> Seal(Client& client) {
     auto bstream = ByteStreamBaseBuilder::Seal(client);
-    VINEYARD_CHECK_OK(client.CreateStream(bstream->id()));
+    VINEYARD_CHECK_OK(
+        client.CreateStream(bstream->id(), retain_chunks_, retain_bytes_,
+                            budget_bytes_));
     return std::static_pointer_cast<Object>(bstream);
   }
+
+ private:
+  size_t retain_chunks_ = 0, retain_bytes_ = 0, budget_bytes_ = 0;
 };
 
 }  // namespace vineyard
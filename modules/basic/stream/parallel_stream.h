@@ -16,7 +16,9 @@ limitations under the License.
 #ifndef MODULES_BASIC_STREAM_PARALLEL_STREAM_H_
 #define MODULES_BASIC_STREAM_PARALLEL_STREAM_H_
 
+#include <atomic>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 
@@ -117,6 +119,109 @@ class ParallelStreamBuilder : public ObjectBuilder {
   std::vector<ObjectID> streams_;
 };
 
+/**
+ * @brief ParallelStreamReader consumes the local partitions of a parallel
+ * stream from a pool of threads, e.g.,
+ *
+ *     ParallelStreamReader<ByteStream, ByteStreamReader> reader;
+ *     VINEYARD_CHECK_OK(reader.Open(ipc_socket, pstream));
+ *     // on each consumer thread
+ *     std::vector<std::shared_ptr<arrow::Buffer>> chunks;
+ *     while (reader.GetNextBatch(8, chunks).ok()) { ... }
+ *
+ * Every partition is read through its own connection, thus partitions make
+ * progress independently. A consumer tries the partitions in round-robin
+ * order and steals from the one that no other consumer is reading, and only
+ * waits for a busy partition when all alive partitions are being read.
+ *
+ * The chunks are copied out from vineyard (see also
+ * `Client::PullStreamChunks`), as chunks of the same partition may be
+ * consumed by different threads at the same time.
+ */
+template <typename S, typename R>
+class ParallelStreamReader {
+ public:
+  Status Open(std::string const& ipc_socket,
+              std::shared_ptr<ParallelStream> const& stream) {
+    RETURN_ON_ASSERT(partitions_.empty(), "The reader has been opened");
+    for (auto const& local : stream->GetLocalStreams<S>()) {
+      std::unique_ptr<partition_t> partition(new partition_t());
+      RETURN_ON_ERROR(partition->client.Connect(ipc_socket));
+      RETURN_ON_ERROR(local->OpenReader(partition->client, partition->reader));
+      partitions_.emplace_back(std::move(partition));
+    }
+    return Status::OK();
+  }
+
+  /**
+   * @brief Read at most `limit` chunks from one of the partitions, returns
+   * `StreamDrained` after all partitions have been drained.
+   */
+  Status GetNextBatch(size_t const limit,
+                      std::vector<std::shared_ptr<arrow::Buffer>>& buffers) {
+    size_t const start = next_.fetch_add(1);
+    while (true) {
+      partition_t* pending = nullptr;
+      for (size_t idx = 0; idx < partitions_.size(); ++idx) {
+        auto& partition = partitions_[(start + idx) % partitions_.size()];
+        if (partition->drained.load()) {
+          continue;
+        }
+        std::unique_lock<std::mutex> lock(partition->mutex, std::try_to_lock);
+        if (!lock.owns_lock()) {
+          pending = pending ? pending : partition.get();
+          continue;
+        }
+        bool drained = false;
+        RETURN_ON_ERROR(pullFrom(*partition, limit, buffers, drained));
+        if (!drained) {
+          return Status::OK();
+        }
+      }
+      if (pending == nullptr) {
+        return Status::StreamDrained();
+      }
+      // every alive partition is being read, waits for one of them
+      std::lock_guard<std::mutex> lock(pending->mutex);
+      bool drained = false;
+      RETURN_ON_ERROR(pullFrom(*pending, limit, buffers, drained));
+      if (!drained) {
+        return Status::OK();
+      }
+    }
+  }
+
+  size_t Partitions() const { return partitions_.size(); }
+
+ private:
+  struct partition_t {
+    Client client;
+    std::unique_ptr<R> reader;
+    std::mutex mutex;
+    std::atomic_bool drained{false};
+  };
+
+  // requires the mutex of partition been held
+  Status pullFrom(partition_t& partition, size_t const limit,
+                  std::vector<std::shared_ptr<arrow::Buffer>>& buffers,
+                  bool& drained) {
+    drained = partition.drained.load();
+    if (drained) {
+      return Status::OK();
+    }
+    auto status = partition.reader->GetNextBatch(limit, buffers);
+    if (status.IsStreamDrained()) {
+      partition.drained.store(true);
+      drained = true;
+      return Status::OK();
+    }
+    return status;
+  }
+
+  std::vector<std::unique_ptr<partition_t>> partitions_;
+  std::atomic<size_t> next_{0};
+};
+
 }  // namespace vineyard
 
 #endif  // MODULES_BASIC_STREAM_PARALLEL_STREAM_H_
@@ -16,11 +16,56 @@ limitations under the License.
 #ifndef MODULES_BASIC_STREAM_STREAM_UTILS_H_
 #define MODULES_BASIC_STREAM_STREAM_UTILS_H_
 
+#include <algorithm>
+#include <cstddef>
+
 namespace vineyard {
 
 enum class OpenStreamMode {
   read = 1,
   write = 2,
+  // read as one of the consumers of a broadcast stream, every consumer
+  // receives all chunks that sealed since it opens the stream.
+  broadcast = 4,
+};
+
+/**
+ * @brief Chooses the size of the next chunk from the observed latency of
+ * allocating chunks, which is dominated by waiting for the consumers (or
+ * the memory budget) once the producer runs ahead.
+ *
+ * The size doubles while the allocations return quickly, as small chunks
+ * pay the per-chunk round trips, and halves when the producer waits, thus
+ * the memory that a slow consumer pins stays small and other streams could
+ * get their share.
+ */
+class AdaptiveChunkSize {
+ public:
+  /**
+   * @param target_latency The latency (in microseconds) of allocation that
+   * is considered as not being waiting.
+   */
+  AdaptiveChunkSize(size_t const min_size, size_t const max_size,
+                    double const target_latency = 1000)
+      : min_size_(std::max<size_t>(min_size, 1)),
+        max_size_(std::max(max_size, min_size_)),
+        target_latency_(target_latency),
+        size_(min_size_) {}
+
+  size_t Next() const { return size_; }
+
+  void Observe(size_t const size, double const latency) {
+    if (latency > 2 * target_latency_) {
+      size_ = std::max(min_size_, size_ / 2);
+    } else if (latency < target_latency_ && 2 * size >= size_) {
+      size_ = std::min(max_size_, size_ * 2);
+    }
+  }
+
+ private:
+  size_t min_size_, max_size_;
+  double target_latency_;
+  size_t size_;
 };
 
 }  // namespace vineyard
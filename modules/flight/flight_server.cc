@@ -0,0 +1,271 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+
+#include "flight/flight_server.h"
+
+#include <limits>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "basic/ds/arrow.h"
+#include "basic/ds/arrow_utils.h"
+#include "basic/ds/dataframe.h"
+#include "common/util/logging.h"
+#include "common/util/typename.h"
+
+namespace vineyard {
+
+namespace flight = arrow::flight;
+
+namespace {
+
+inline arrow::Status ToArrowStatus(Status const& status) {
+  if (status.ok()) {
+    return arrow::Status::OK();
+  }
+  if (status.IsObjectNotExists()) {
+    return arrow::Status::KeyError(status.ToString());
+  }
+  return arrow::Status::IOError(status.ToString());
+}
+
+/**
+ * Streams the batches of a vineyard object, and keeps the object (and thus
+ * the mapped blobs) alive until the stream is finished.
+ */
+class ObjectBatchReader : public arrow::RecordBatchReader {
+ public:
+  ObjectBatchReader(std::shared_ptr<Object> const& object,
+                    std::shared_ptr<arrow::Schema> const& schema,
+                    std::vector<std::shared_ptr<arrow::RecordBatch>>&& batches)
+      : object_(object), schema_(schema), batches_(std::move(batches)) {}
+
+  std::shared_ptr<arrow::Schema> schema() const override { return schema_; }
+
+  arrow::Status ReadNext(std::shared_ptr<arrow::RecordBatch>* batch) override {
+    if (index_ < batches_.size()) {
+      *batch = batches_[index_++];
+    } else {
+      batch->reset();
+    }
+    return arrow::Status::OK();
+  }
+
+ private:
+  std::shared_ptr<Object> object_;
+  std::shared_ptr<arrow::Schema> schema_;
+  std::vector<std::shared_ptr<arrow::RecordBatch>> batches_;
+  size_t index_ = 0;
+};
+
+Status CollectBatches(
+    Client& client, std::shared_ptr<Object> const& object,
+    std::shared_ptr<arrow::Schema>& schema,
+    std::vector<std::shared_ptr<arrow::RecordBatch>>& batches) {
+  if (auto batch = std::dynamic_pointer_cast<RecordBatch>(object)) {
+    schema = batch->schema();
+    batches.emplace_back(batch->GetRecordBatch());
+  } else if (auto table = std::dynamic_pointer_cast<Table>(object)) {
+    schema = table->schema();
+    for (auto const& batch : table->batches()) {
+      batches.emplace_back(batch->GetRecordBatch());
+    }
+  } else if (auto df = std::dynamic_pointer_cast<DataFrame>(object)) {
+    batches.emplace_back(df->RecordBatchView());
+    schema = batches.back()->schema();
+  } else if (auto gdf = std::dynamic_pointer_cast<GlobalDataFrame>(object)) {
+    for (auto const& partition : gdf->LocalPartitions(client)) {
+      batches.emplace_back(partition->RecordBatchView());
+    }
+    schema = batches.empty() ? arrow::schema({}) : batches.front()->schema();
+  } else {
+    return Status::Invalid("The object '" + ObjectIDToString(object->id()) +
+                           "' of type '" + object->meta().GetTypeName() +
+                           "' cannot be served as a flight");
+  }
+  return Status::OK();
+}
+
+}  // namespace
+
+FlightServer::FlightServer(Client& client, const int port)
+    : client_(client), port_(port) {}
+
+arrow::Status FlightServer::ListFlights(
+    const flight::ServerCallContext& context, const flight::Criteria* criteria,
+    std::unique_ptr<flight::FlightListing>* listings) {
+  std::vector<flight::FlightInfo> flights;
+  for (auto const& type :
+       {type_name<RecordBatch>(), type_name<Table>(), type_name<DataFrame>(),
+        type_name<GlobalDataFrame>()}) {
+    std::unordered_map<ObjectID, json> metas;
+    ARROW_RETURN_NOT_OK(ToArrowStatus(
+        client_.ListData(type, false, std::numeric_limits<size_t>::max(),
+                         metas)));
+    for (auto const& item : metas) {
+      std::unique_ptr<flight::FlightInfo> info;
+      auto descriptor =
+          flight::FlightDescriptor::Path({ObjectIDToString(item.first)});
+      auto status = makeFlightInfo(item.first, descriptor, info);
+      if (status.ok()) {
+        flights.emplace_back(std::move(*info));
+      } else {
+        VLOG(10) << "Skipped flight: " << status.ToString();
+      }
+    }
+  }
+  listings->reset(new flight::SimpleFlightListing(std::move(flights)));
+  return arrow::Status::OK();
+}
+
+arrow::Status FlightServer::GetFlightInfo(
+    const flight::ServerCallContext& context,
+    const flight::FlightDescriptor& request,
+    std::unique_ptr<flight::FlightInfo>* info) {
+  ObjectID id = InvalidObjectID();
+  ARROW_RETURN_NOT_OK(ToArrowStatus(resolve(request, id)));
+  return ToArrowStatus(makeFlightInfo(id, request, *info));
+}
+
+arrow::Status FlightServer::DoGet(
+    const flight::ServerCallContext& context, const flight::Ticket& request,
+    std::unique_ptr<flight::FlightDataStream>* stream) {
+  ObjectID id = ObjectIDFromString(request.ticket);
+  std::shared_ptr<Object> object;
+  ARROW_RETURN_NOT_OK(ToArrowStatus(client_.GetObject(id, object)));
+  std::shared_ptr<arrow::Schema> schema;
+  std::vector<std::shared_ptr<arrow::RecordBatch>> batches;
+  ARROW_RETURN_NOT_OK(
+      ToArrowStatus(CollectBatches(client_, object, schema, batches)));
+  auto reader = std::make_shared<ObjectBatchReader>(object, schema,
+                                                    std::move(batches));
+  stream->reset(new flight::RecordBatchStream(reader));
+  return arrow::Status::OK();
+}
+
+Status FlightServer::resolve(const flight::FlightDescriptor& descriptor,
+                             ObjectID& id) {
+  std::string target;
+  if (descriptor.type == flight::FlightDescriptor::PATH) {
+    RETURN_ON_ASSERT(descriptor.path.size() == 1,
+                     "The path of flight descriptors must be an object id "
+                     "or a name");
+    target = descriptor.path[0];
+  } else {
+    target = descriptor.cmd;
+  }
+  RETURN_ON_ASSERT(!target.empty(), "The flight descriptor is empty");
+  if (target[0] == 'o' && target.size() == 17 &&
+      target.find_first_not_of("0123456789abcdef", 1) == std::string::npos) {
+    id = ObjectIDFromString(target);
+    return Status::OK();
+  }
+  return client_.GetName(target, id);
+}
+
+Status FlightServer::makeFlightInfo(
+    const ObjectID id, const flight::FlightDescriptor& descriptor,
+    std::unique_ptr<flight::FlightInfo>& info) {
+  ObjectMeta meta;
+  RETURN_ON_ERROR(client_.GetMetaData(id, meta, true));
+  auto const& type = meta.GetTypeName();
+
+  std::vector<ObjectMeta> chunks;
+  int64_t num_rows = -1;
+  if (type == type_name<RecordBatch>() || type == type_name<DataFrame>()) {
+    chunks.emplace_back(meta);
+    num_rows = meta.MetaData().value("row_num_", -1);
+  } else if (type == type_name<Table>()) {
+    for (size_t idx = 0; idx < meta.GetKeyValue<size_t>("__batches_-size");
+         ++idx) {
+      chunks.emplace_back(
+          meta.GetMemberMeta("__batches_-" + std::to_string(idx)));
+    }
+    num_rows = meta.MetaData().value("num_rows_", -1);
+  } else if (type == type_name<GlobalDataFrame>()) {
+    for (size_t idx = 0; idx < meta.GetKeyValue<size_t>("partitions_-size");
+         ++idx) {
+      chunks.emplace_back(
+          meta.GetMemberMeta("partitions_-" + std::to_string(idx)));
+    }
+  } else {
+    return Status::Invalid("The object '" + ObjectIDToString(id) +
+                           "' of type '" + type +
+                           "' cannot be served as a flight");
+  }
+
+  // the schema is only known when (some of) the chunks are local
+  std::shared_ptr<arrow::Schema> schema = arrow::schema({});
+  for (auto const& chunk : chunks) {
+    if (chunk.GetInstanceId() != client_.instance_id()) {
+      continue;
+    }
+    std::shared_ptr<Object> object;
+    std::vector<std::shared_ptr<arrow::RecordBatch>> batches;
+    RETURN_ON_ERROR(client_.GetObject(chunk.GetId(), object));
+    RETURN_ON_ERROR(CollectBatches(client_, object, schema, batches));
+    break;
+  }
+
+  std::vector<flight::FlightEndpoint> endpoints(chunks.size());
+  for (size_t idx = 0; idx < chunks.size(); ++idx) {
+    RETURN_ON_ERROR(makeEndpoint(chunks[idx], endpoints[idx]));
+  }
+  flight::FlightInfo flight_info;
+  RETURN_ON_ARROW_ERROR_AND_ASSIGN(
+      flight_info,
+      flight::FlightInfo::Make(*schema, descriptor, endpoints, num_rows,
+                               static_cast<int64_t>(meta.GetNBytes())));
+  info.reset(new flight::FlightInfo(std::move(flight_info)));
+  return Status::OK();
+}
+
+Status FlightServer::makeEndpoint(const ObjectMeta& chunk,
+                                  flight::FlightEndpoint& endpoint) {
+  endpoint.ticket.ticket = ObjectIDToString(chunk.GetId());
+  if (chunk.GetInstanceId() == client_.instance_id()) {
+    // no locations: the chunk is served by this server
+    return Status::OK();
+  }
+  std::string hostname;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto iter = hostnames_.find(chunk.GetInstanceId());
+    if (iter == hostnames_.end()) {
+      std::map<InstanceID, json> cluster;
+      RETURN_ON_ERROR(client_.ClusterInfo(cluster));
+      for (auto const& instance : cluster) {
+        hostnames_[instance.first] =
+            instance.second.value("hostname", std::string());
+      }
+      iter = hostnames_.find(chunk.GetInstanceId());
+    }
+    RETURN_ON_ASSERT(iter != hostnames_.end() && !iter->second.empty(),
+                     "Failed to locate the instance " +
+                         std::to_string(chunk.GetInstanceId()));
+    hostname = iter->second;
+  }
+  flight::Location location;
+  RETURN_ON_ARROW_ERROR_AND_ASSIGN(
+      location, flight::Location::ForGrpcTcp(hostname, port_));
+  endpoint.locations.emplace_back(std::move(location));
+  return Status::OK();
+}
+
+}  // namespace vineyard
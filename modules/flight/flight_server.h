@@ -0,0 +1,91 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+
+#ifndef MODULES_FLIGHT_FLIGHT_SERVER_H_
+#define MODULES_FLIGHT_FLIGHT_SERVER_H_
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "arrow/api.h"
+#include "arrow/flight/api.h"
+
+#include "client/client.h"
+#include "common/util/status.h"
+#include "common/util/uuid.h"
+
+namespace vineyard {
+
+/**
+ * @brief FlightServer serves the dataframes, record batches and tables in
+ * vineyard as Arrow Flight streams, it runs alongside a vineyardd instance
+ * and maps the blobs through an IPC client, thus the batches are written to
+ * the wire from the shared memory without being copied.
+ *
+ * A flight is described by a path of a single element, that is either an
+ * object id (e.g., "o0001c3a3b0d6e4b2") or the name of an object. Each chunk
+ * is an endpoint of the flight, i.e., every batch of tables and every
+ * partition of global dataframes, and the partitions on other instances are
+ * located at the flight servers alongside them (on the same port), thus the
+ * chunks can be fetched in parallel.
+ */
+class FlightServer : public arrow::flight::FlightServerBase {
+ public:
+  FlightServer(Client& client, const int port);
+
+  ~FlightServer() override = default;
+
+  arrow::Status ListFlights(
+      const arrow::flight::ServerCallContext& context,
+      const arrow::flight::Criteria* criteria,
+      std::unique_ptr<arrow::flight::FlightListing>* listings) override;
+
+  arrow::Status GetFlightInfo(
+      const arrow::flight::ServerCallContext& context,
+      const arrow::flight::FlightDescriptor& request,
+      std::unique_ptr<arrow::flight::FlightInfo>* info) override;
+
+  arrow::Status DoGet(
+      const arrow::flight::ServerCallContext& context,
+      const arrow::flight::Ticket& request,
+      std::unique_ptr<arrow::flight::FlightDataStream>* stream) override;
+
+ private:
+  Status resolve(const arrow::flight::FlightDescriptor& descriptor,
+                 ObjectID& id);
+
+  Status makeFlightInfo(const ObjectID id,
+                        const arrow::flight::FlightDescriptor& descriptor,
+                        std::unique_ptr<arrow::flight::FlightInfo>& info);
+
+  // the endpoint of a chunk, which is served by the flight server alongside
+  // the instance that holds the chunk.
+  Status makeEndpoint(const ObjectMeta& chunk,
+                      arrow::flight::FlightEndpoint& endpoint);
+
+  Client& client_;
+  const int port_;
+
+  std::mutex mutex_;
+  std::map<InstanceID, std::string> hostnames_;
+};
+
+}  // namespace vineyard
+
+#endif  // MODULES_FLIGHT_FLIGHT_SERVER_H_
@@ -0,0 +1,206 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <stdio.h>
+
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "arrow/api.h"
+#include "arrow/flight/api.h"
+#include "arrow/ipc/api.h"
+
+#include "basic/ds/array.h"
+#include "basic/ds/arrow.h"
+#include "basic/ds/arrow_utils.h"
+#include "client/client.h"
+#include "common/util/logging.h"
+#include "flight/flight_server.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+namespace flight = arrow::flight;
+
+std::shared_ptr<arrow::Table> MakeTable() {
+  auto schema = arrow::schema({arrow::field("f1", arrow::int64()),
+                               arrow::field("f2", arrow::utf8())});
+  std::vector<std::shared_ptr<arrow::RecordBatch>> batches;
+  for (int64_t i = 0; i < 3; ++i) {
+    arrow::Int64Builder value_builder;
+    arrow::StringBuilder string_builder;
+    std::shared_ptr<arrow::Array> array1, array2;
+    for (int64_t j = i * 1000; j < (i + 1) * 1000; ++j) {
+      CHECK_ARROW_ERROR(value_builder.Append(j));
+      CHECK_ARROW_ERROR(string_builder.Append("s" + std::to_string(j)));
+    }
+    CHECK_ARROW_ERROR(value_builder.Finish(&array1));
+    CHECK_ARROW_ERROR(string_builder.Finish(&array2));
+    batches.emplace_back(arrow::RecordBatch::Make(schema, 1000,
+                                                  {array1, array2}));
+  }
+  std::shared_ptr<arrow::Table> table;
+  CHECK_ARROW_ERROR_AND_ASSIGN(table,
+                               arrow::Table::FromRecordBatches(batches));
+  return table;
+}
+
+std::shared_ptr<arrow::Table> Fetch(flight::FlightClient& flight_client,
+                                    const flight::Ticket& ticket) {
+  std::unique_ptr<flight::FlightStreamReader> reader;
+  CHECK_ARROW_ERROR_AND_ASSIGN(reader, flight_client.DoGet(ticket));
+  std::shared_ptr<arrow::Table> table;
+  CHECK_ARROW_ERROR_AND_ASSIGN(table, reader->ToTable());
+  return table;
+}
+
+// the table is served as a flight of an endpoint per batch, by the id and by
+// the name, and every batch is fetched back as is.
+void TestTableFlight(Client& client, flight::FlightClient& flight_client) {
+  auto table = MakeTable();
+  TableBuilder builder(client, table);
+  auto object = std::dynamic_pointer_cast<Table>(builder.Seal(client));
+  VINEYARD_CHECK_OK(client.Persist(object->id()));
+  VINEYARD_CHECK_OK(client.PutName(object->id(), "flight_test_table"));
+
+  std::vector<flight::FlightDescriptor> descriptors = {
+      flight::FlightDescriptor::Path({ObjectIDToString(object->id())}),
+      flight::FlightDescriptor::Path({"flight_test_table"}),
+      flight::FlightDescriptor::Command("flight_test_table")};
+  for (auto const& descriptor : descriptors) {
+    std::unique_ptr<flight::FlightInfo> info;
+    CHECK_ARROW_ERROR_AND_ASSIGN(info,
+                                 flight_client.GetFlightInfo(descriptor));
+    CHECK(info->descriptor() == descriptor);
+    CHECK_EQ(info->total_records(), table->num_rows());
+    CHECK_EQ(info->endpoints().size(), object->batches().size());
+
+    std::shared_ptr<arrow::Schema> schema;
+    arrow::ipc::DictionaryMemo memo;
+#if defined(ARROW_VERSION) && ARROW_VERSION < 10000000
+    CHECK_ARROW_ERROR(info->GetSchema(&memo, &schema));
+#else
+    CHECK_ARROW_ERROR_AND_ASSIGN(schema, info->GetSchema(&memo));
+#endif
+    CHECK(schema->Equals(*table->schema()));
+
+    std::vector<std::shared_ptr<arrow::RecordBatch>> batches;
+    for (size_t idx = 0; idx < info->endpoints().size(); ++idx) {
+      auto const& endpoint = info->endpoints()[idx];
+      // the batches are local, thus served by this server
+      CHECK(endpoint.locations.empty());
+      auto chunk = Fetch(flight_client, endpoint.ticket);
+      auto expected = object->batches()[idx]->GetRecordBatch();
+      CHECK_EQ(chunk->num_rows(), expected->num_rows());
+      arrow::TableBatchReader chunk_reader(*chunk);
+      std::shared_ptr<arrow::RecordBatch> batch;
+      while (true) {
+        CHECK_ARROW_ERROR(chunk_reader.ReadNext(&batch));
+        if (batch == nullptr) {
+          break;
+        }
+        batches.emplace_back(batch);
+      }
+    }
+    std::shared_ptr<arrow::Table> fetched;
+    CHECK_ARROW_ERROR_AND_ASSIGN(
+        fetched, arrow::Table::FromRecordBatches(table->schema(), batches));
+    CHECK(fetched->Equals(*table));
+  }
+
+  // the whole table is a ticket as well
+  auto fetched = Fetch(flight_client,
+                       flight::Ticket{ObjectIDToString(object->id())});
+  CHECK(fetched->Equals(*table));
+
+  // the listing contains the table
+  std::unique_ptr<flight::FlightListing> listing;
+  CHECK_ARROW_ERROR_AND_ASSIGN(listing, flight_client.ListFlights());
+  bool listed = false;
+  while (true) {
+    std::unique_ptr<flight::FlightInfo> info;
+    CHECK_ARROW_ERROR_AND_ASSIGN(info, listing->Next());
+    if (info == nullptr) {
+      break;
+    }
+    if (info->descriptor().path ==
+        std::vector<std::string>{ObjectIDToString(object->id())}) {
+      CHECK_EQ(info->total_records(), table->num_rows());
+      listed = true;
+    }
+  }
+  CHECK(listed);
+
+  VINEYARD_CHECK_OK(client.DropName("flight_test_table"));
+}
+
+// the objects that are not tabular, and the unknown names, are rejected
+void TestInvalidFlight(Client& client, flight::FlightClient& flight_client) {
+  std::vector<double> values = {1.0, 2.0, 3.0};
+  ArrayBuilder<double> builder(client, values);
+  auto array = builder.Seal(client);
+  CHECK(!flight_client
+             .GetFlightInfo(flight::FlightDescriptor::Path(
+                 {ObjectIDToString(array->id())}))
+             .ok());
+  CHECK(!flight_client
+             .GetFlightInfo(
+                 flight::FlightDescriptor::Path({"flight_test_not_exists"}))
+             .ok());
+  CHECK(!flight_client.GetFlightInfo(flight::FlightDescriptor::Path({}))
+             .ok());
+}
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    printf("usage ./flight_test <ipc_socket>");
+    return 1;
+  }
+  std::string ipc_socket = std::string(argv[1]);
+
+  Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+  LOG(INFO) << "Connected to IPCServer: " << ipc_socket;
+
+  // the server listens on a random port
+  flight::Location location;
+  CHECK_ARROW_ERROR_AND_ASSIGN(location,
+                               flight::Location::ForGrpcTcp("localhost", 0));
+  auto server = std::make_shared<FlightServer>(client, 0);
+  CHECK_ARROW_ERROR(server->Init(flight::FlightServerOptions(location)));
+  std::thread serving([&]() { CHECK_ARROW_ERROR(server->Serve()); });
+
+  flight::Location server_location;
+  CHECK_ARROW_ERROR_AND_ASSIGN(
+      server_location,
+      flight::Location::ForGrpcTcp("localhost", server->port()));
+  std::unique_ptr<flight::FlightClient> flight_client;
+  CHECK_ARROW_ERROR_AND_ASSIGN(flight_client,
+                               flight::FlightClient::Connect(server_location));
+
+  TestTableFlight(client, *flight_client);
+  TestInvalidFlight(client, *flight_client);
+
+  CHECK_ARROW_ERROR(flight_client->Close());
+  CHECK_ARROW_ERROR(server->Shutdown());
+  serving.join();
+
+  LOG(INFO) << "Passed flight tests...";
+
+  client.Disconnect();
+
+  return 0;
+}
@@ -0,0 +1,82 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+
+#include <signal.h>
+
+#include <memory>
+#include <string>
+
+#include "arrow/flight/api.h"
+#include "gflags/gflags.h"
+
+#include "basic/ds/arrow_utils.h"
+#include "client/client.h"
+#include "common/util/flags.h"
+#include "common/util/logging.h"
+#include "common/util/status.h"
+#include "flight/flight_server.h"
+
+namespace vineyard {
+
+DEFINE_string(ipc_socket, "/tmp/vineyard/vineyard.sock",
+              "IPC socket of vineyard server");
+DEFINE_string(host, "0.0.0.0", "The host that the flight server listens on");
+DEFINE_int32(port, 9602,
+             "The port that the flight server listens on, the flight servers "
+             "alongside all vineyard instances are expected to use the same "
+             "port");
+
+Status RunFlightServer() {
+  Client client;
+  RETURN_ON_ERROR(client.Connect(FLAGS_ipc_socket));
+  LOG(INFO) << "Connected to IPCServer: " << FLAGS_ipc_socket;
+
+  arrow::flight::Location location;
+  RETURN_ON_ARROW_ERROR_AND_ASSIGN(
+      location, arrow::flight::Location::ForGrpcTcp(FLAGS_host, FLAGS_port));
+  arrow::flight::FlightServerOptions options(location);
+  auto server = std::make_shared<FlightServer>(client, FLAGS_port);
+  RETURN_ON_ARROW_ERROR(server->Init(options));
+  RETURN_ON_ARROW_ERROR(server->SetShutdownOnSignals({SIGINT, SIGTERM}));
+  LOG(INFO) << "Serving arrow flight on " << FLAGS_host << ":"
+            << server->port();
+  RETURN_ON_ARROW_ERROR(server->Serve());
+  return Status::OK();
+}
+
+}  // namespace vineyard
+
+DECLARE_bool(help);
+DECLARE_string(helpmatch);
+
+int main(int argc, char** argv) {
+  FLAGS_stderrthreshold = 0;
+  vineyard::logging::InitGoogleLogging("vineyard");
+  vineyard::flags::SetUsageMessage("Usage: vineyard-flight [options]");
+  vineyard::flags::ParseCommandLineNonHelpFlags(&argc, &argv, false);
+  if (FLAGS_help) {
+    FLAGS_help = false;
+    FLAGS_helpmatch = "vineyard";
+  }
+  vineyard::flags::HandleCommandLineHelpFlags();
+
+  auto status = vineyard::RunFlightServer();
+  if (!status.ok()) {
+    LOG(ERROR) << "Flight server failed: " << status.ToString();
+    return static_cast<int>(status.code());
+  }
+  return 0;
+}
@@ -21,6 +21,7 @@ limitations under the License.
 #include <memory>
 #include <set>
 #include <string>
+#include <type_traits>
 #include <unordered_map>
 #include <utility>
 #include <vector>
@@ -113,9 +114,40 @@ class ArrowFragmentBase : public vineyard::Object {
     return vineyard::InvalidObjectID();
   }
 
+  virtual boost::leaf::result<vineyard::ObjectID> AddEdgeColumns(
+      vineyard::Client& client,
+      const std::map<
+          label_id_t,
+          std::vector<std::pair<std::string, std::shared_ptr<arrow::Array>>>>
+          columns) {
+    VINEYARD_ASSERT(false, "Not implemented");
+    return vineyard::InvalidObjectID();
+  }
+
+  virtual boost::leaf::result<vineyard::ObjectID> AddEdgeColumns(
+      vineyard::Client& client,
+      const std::map<label_id_t,
+                     std::vector<std::pair<
+                         std::string, std::shared_ptr<arrow::ChunkedArray>>>>
+          columns) {
+    VINEYARD_ASSERT(false, "Not implemented");
+    return vineyard::InvalidObjectID();
+  }
+
   virtual vineyard::ObjectID vertex_map_id() const = 0;
 
   virtual const PropertyGraphSchema& schema() const = 0;
+
+  /**
+   * @brief The number of inner vertices, outer vertices (i.e., the mirrors of
+   * vertices owned by other fragments) and edges of all labels in this
+   * fragment, see also `ArrowFragmentGroup`.
+   */
+  virtual size_t local_inner_vertex_num() const = 0;
+
+  virtual size_t local_outer_vertex_num() const = 0;
+
+  virtual size_t local_edge_num() const = 0;
 };
 
 inline const void* get_arrow_array_ptr(std::shared_ptr<arrow::Array> array) {
@@ -309,6 +341,23 @@ class ArrowFragment
     }
     CONSTRUCT_ARRAY_VECTOR_VECTOR(int64_t, oe_offsets_lists_, vertex_label_num_,
                                   edge_label_num_, "oe_offsets_lists");
+
+    // the degree index is optional, and isn't inherited by the fragments
+    // derived by `AddVertices`/`AddEdges`.
+    degree_index_ = meta.Haskey("degree_index") &&
+                    meta.GetKeyValue<int>("degree_index") != 0;
+    if (degree_index_) {
+      if (directed_) {
+        CONSTRUCT_ARRAY_VECTOR(int64_t, ie_degrees_lists_, vertex_label_num_,
+                               "ie_degrees_lists");
+        CONSTRUCT_ARRAY_VECTOR(int64_t, ie_label_offsets_lists_,
+                               vertex_label_num_, "ie_label_offsets_lists");
+      }
+      CONSTRUCT_ARRAY_VECTOR(int64_t, oe_degrees_lists_, vertex_label_num_,
+                             "oe_degrees_lists");
+      CONSTRUCT_ARRAY_VECTOR(int64_t, oe_label_offsets_lists_,
+                             vertex_label_num_, "oe_label_offsets_lists");
+    }
     vm_ptr_ = std::make_shared<vertex_map_t>();
     vm_ptr_->Construct(meta.GetMemberMeta("vertex_map"));
 
@@ -382,6 +431,74 @@ class ArrowFragment
     }
   }
 
+  /**
+   * @brief The values of the property of all inner vertices of the label, the
+   * value of vertex `v` is at `vid_parser_.GetOffset(v.GetValue())`, i.e.,
+   * the order of `InnerVertices(label)`.
+   *
+   * Only primitive properties are supported, and the span is empty if the
+   * type mismatches or the label has no inner vertices.
+   */
+  template <typename DATA_T>
+  property_graph_utils::DataSpan<DATA_T> GetInnerVertexDataSpan(
+      label_id_t label, prop_id_t prop) const {
+    static_assert(std::is_arithmetic<DATA_T>::value,
+                  "Only primitive properties can be accessed as spans");
+    if (vertex_tables_[label]->num_rows() == 0 ||
+        !vertex_property_type(label, prop)->Equals(
+            ConvertToArrowType<DATA_T>::TypeValue())) {
+      return property_graph_utils::DataSpan<DATA_T>();
+    }
+    return property_graph_utils::DataSpan<DATA_T>(
+        reinterpret_cast<const DATA_T*>(vertex_tables_columns_[label][prop]),
+        ivnums_[label]);
+  }
+
+  /**
+   * @brief The property of the inner vertices `[begin, begin + length)` (in
+   * offsets) of the label as an arrow array, without copying. The `length`
+   * defaults to the rest of inner vertices.
+   */
+  std::shared_ptr<arrow::Array> GetInnerVertexDataArray(
+      label_id_t label, prop_id_t prop, int64_t begin = 0,
+      int64_t length = -1) const {
+    auto column = vertex_tables_[label]->column(prop);
+    if (column->num_chunks() == 0) {
+      return nullptr;
+    }
+    auto array = column->chunk(0);
+    if (length < 0) {
+      length = array->length() - begin;
+    }
+    return array->Slice(begin, length);
+  }
+
+  /**
+   * @brief Gather the property of the inner vertices of the label into
+   * `values`, i.e., `values[i] = GetData<DATA_T>(vertices[i], prop)`, without
+   * decoding the label of every vertex.
+   */
+  template <typename DATA_T>
+  void GatherInnerVertexData(label_id_t label, prop_id_t prop,
+                             const vertex_t* vertices, size_t size,
+                             DATA_T* values) const {
+    const void* column = vertex_tables_columns_[label][prop];
+    for (size_t index = 0; index < size; ++index) {
+      values[index] = property_graph_utils::ValueGetter<DATA_T>::Value(
+          column, vid_parser_.GetOffset(vertices[index].GetValue()));
+    }
+  }
+
+  template <typename DATA_T>
+  std::vector<DATA_T> GatherInnerVertexData(
+      label_id_t label, prop_id_t prop,
+      const std::vector<vertex_t>& vertices) const {
+    std::vector<DATA_T> values(vertices.size());
+    GatherInnerVertexData(label, prop, vertices.data(), vertices.size(),
+                          values.data());
+    return values;
+  }
+
   vertex_range_t Vertices(label_id_t label_id) const {
     return vertex_range_t(
         vid_parser_.GenerateId(0, label_id, 0),
@@ -451,6 +568,65 @@ class ArrowFragment
     return GetIncomingAdjList(v, e_label).Size();
   }
 
+  /**
+   * @brief Whether the degrees have been precomputed when building the
+   * fragment, see also `BasicArrowFragmentBuilder::set_degree_index`.
+   */
+  bool has_degree_index() const { return degree_index_; }
+
+  /**
+   * @brief The out-degree of the vertex over all edge labels.
+   */
+  int64_t GetLocalOutDegree(const vertex_t& v) const {
+    return getLocalDegree(v, oe_degrees_ptr_lists_, oe_offsets_ptr_lists_);
+  }
+
+  /**
+   * @brief The in-degree of the vertex over all edge labels.
+   */
+  int64_t GetLocalInDegree(const vertex_t& v) const {
+    return getLocalDegree(v, ie_degrees_ptr_lists_, ie_offsets_ptr_lists_);
+  }
+
+  /**
+   * @brief The out-degrees (over all edge labels) of the inner and outer
+   * vertices of the label, indexed by the offsets of vertices. The span is
+   * empty without the degree index.
+   */
+  property_graph_utils::DataSpan<int64_t> GetLocalOutDegrees(
+      label_id_t v_label) const {
+    if (!degree_index_) {
+      return property_graph_utils::DataSpan<int64_t>();
+    }
+    return property_graph_utils::DataSpan<int64_t>(
+        oe_degrees_ptr_lists_[v_label], tvnums_[v_label]);
+  }
+
+  property_graph_utils::DataSpan<int64_t> GetLocalInDegrees(
+      label_id_t v_label) const {
+    if (!degree_index_) {
+      return property_graph_utils::DataSpan<int64_t>();
+    }
+    return property_graph_utils::DataSpan<int64_t>(
+        ie_degrees_ptr_lists_[v_label], tvnums_[v_label]);
+  }
+
+  /**
+   * @brief The vertex-major index of the outgoing edges across edge labels:
+   * `edge_label_num() + 1` prefix sums, i.e., the out-degree of label `e` is
+   * `offsets[e + 1] - offsets[e]` and the total is `offsets[edge_label_num()]`,
+   * thus the degrees of all labels of a vertex are in the same cache line(s).
+   *
+   * Returns nullptr without the degree index.
+   */
+  const int64_t* GetOutgoingLabelOffsets(const vertex_t& v) const {
+    return getLabelOffsets(v, oe_label_offsets_ptr_lists_);
+  }
+
+  const int64_t* GetIncomingLabelOffsets(const vertex_t& v) const {
+    return getLabelOffsets(v, ie_label_offsets_ptr_lists_);
+  }
+
   // FIXME: grape message buffer compatibility
   bool Gid2Vertex(const vid_t& gid, vertex_t& v) const {
     return (vid_parser_.GetFid(gid) == fid_) ? InnerVertexGid2Vertex(gid, v)
@@ -606,6 +782,34 @@ class ArrowFragment
                           &oe[offset_array[v_offset + 1]]);
   }
 
+  /**
+   * @brief The incoming adjacency list that prefetches the values of the
+   * (fixed-width) edge property `prop` during iteration.
+   */
+  template <typename DATA_T>
+  inline property_graph_utils::PrefetchAdjList<vid_t, eid_t, DATA_T>
+  GetIncomingPrefetchAdjList(const vertex_t& v, label_id_t e_label,
+                             prop_id_t prop) const {
+    auto adj_list = GetIncomingRawAdjList(v, e_label);
+    return property_graph_utils::PrefetchAdjList<vid_t, eid_t, DATA_T>(
+        adj_list.begin(), adj_list.end(), flatten_edge_tables_columns_[e_label],
+        prop);
+  }
+
+  /**
+   * @brief The outgoing adjacency list that prefetches the values of the
+   * (fixed-width) edge property `prop` during iteration.
+   */
+  template <typename DATA_T>
+  inline property_graph_utils::PrefetchAdjList<vid_t, eid_t, DATA_T>
+  GetOutgoingPrefetchAdjList(const vertex_t& v, label_id_t e_label,
+                             prop_id_t prop) const {
+    auto adj_list = GetOutgoingRawAdjList(v, e_label);
+    return property_graph_utils::PrefetchAdjList<vid_t, eid_t, DATA_T>(
+        adj_list.begin(), adj_list.end(), flatten_edge_tables_columns_[e_label],
+        prop);
+  }
+
   /**
    * N.B.: as an temporary solution, for POC of graph-learn, will be removed
    * later.
@@ -650,6 +854,30 @@ class ArrowFragment
 
   const PropertyGraphSchema& schema() const override { return schema_; }
 
+  size_t local_inner_vertex_num() const override {
+    size_t num = 0;
+    for (label_id_t i = 0; i < vertex_label_num_; ++i) {
+      num += ivnums_[i];
+    }
+    return num;
+  }
+
+  size_t local_outer_vertex_num() const override {
+    size_t num = 0;
+    for (label_id_t i = 0; i < vertex_label_num_; ++i) {
+      num += ovnums_[i];
+    }
+    return num;
+  }
+
+  size_t local_edge_num() const override {
+    size_t num = 0;
+    for (label_id_t i = 0; i < edge_label_num_; ++i) {
+      num += edge_tables_[i]->num_rows();
+    }
+    return num;
+  }
+
   void PrepareToRunApp(grape::MessageStrategy strategy, bool need_split_edges) {
     if (strategy == grape::MessageStrategy::kAlongEdgeToOuterVertex) {
       initDestFidList(true, true, iodst_, iodoffset_);
@@ -2153,12 +2381,326 @@ class ArrowFragment
     return AddVertexColumnsImpl<arrow::ChunkedArray>(client, columns);
   }
 
+  /**
+   * @brief Attaches the columns to the edge tables of the given labels, the
+   * new columns are sealed as new blobs and all other members (the topology,
+   * the vertex tables, the vertex map, etc.) are shared with this fragment.
+   *
+   * The columns must be aligned with the rows of the edge tables, i.e., be
+   * indexed by the edge id.
+   */
+  template <typename ArrayType = arrow::Array>
+  boost::leaf::result<vineyard::ObjectID> AddEdgeColumnsImpl(
+      vineyard::Client& client,
+      const std::map<
+          label_id_t,
+          std::vector<std::pair<std::string, std::shared_ptr<ArrayType>>>>
+          columns) {
+    vineyard::ObjectMeta old_meta, new_meta;
+    VINEYARD_CHECK_OK(client.GetMetaData(this->id_, old_meta));
+
+    new_meta.SetTypeName(type_name<ArrowFragment<oid_t, vid_t>>());
+    new_meta.AddKeyValue("fid", fid_);
+    new_meta.AddKeyValue("fnum", fnum_);
+    new_meta.AddKeyValue("directed", static_cast<int>(directed_));
+    new_meta.AddKeyValue("oid_type", TypeName<oid_t>::Get());
+    new_meta.AddKeyValue("vid_type", TypeName<vid_t>::Get());
+    new_meta.AddKeyValue("vertex_label_num", vertex_label_num_);
+    new_meta.AddKeyValue("edge_label_num", edge_label_num_);
+
+    size_t nbytes = 0;
+    auto schema = schema_;
+    for (label_id_t i = 0; i < edge_label_num_; ++i) {
+      std::string table_name = generate_name_with_suffix("edge_tables", i);
+      if (columns.find(i) != columns.end()) {
+        std::shared_ptr<vineyard::Table> old_table =
+            std::make_shared<vineyard::Table>();
+        old_table->Construct(old_meta.GetMemberMeta(table_name));
+        prop_id_t old_prop_num = old_table->num_columns();
+        vineyard::TableExtender extender(client, old_table);
+        for (auto& pair : columns.at(i)) {
+          auto status = extender.AddColumn(client, pair.first, pair.second);
+          if (!status.ok()) {
+            RETURN_GS_ERROR(ErrorCode::kVineyardError, status.ToString());
+          }
+        }
+        std::shared_ptr<vineyard::Table> new_table =
+            std::dynamic_pointer_cast<vineyard::Table>(extender.Seal(client));
+        new_meta.AddMember(table_name, new_table->meta());
+        nbytes += new_table->nbytes();
+        std::shared_ptr<arrow::Table> arrow_table = new_table->GetTable();
+        GENERATE_TABLE_META("edge", i, arrow_table);
+        auto label =
+            old_meta.GetKeyValue("edge_label_name_" + std::to_string(i));
+        auto& entry = schema.GetMutableEntry(label, "EDGE");
+        prop_id_t prop_num = arrow_table->num_columns();
+        for (prop_id_t j = old_prop_num; j < prop_num; ++j) {
+          entry.AddProperty(arrow_table->field(j)->name(),
+                            arrow_table->field(j)->type());
+        }
+      } else {
+        GENERATE_TABLE_META("edge", i, this->edge_tables_[i]);
+        new_meta.AddMember(table_name, old_meta.GetMemberMeta(table_name));
+        nbytes += old_meta.GetMemberMeta(table_name).GetNBytes();
+      }
+    }
+    if (!schema.Validate()) {
+      RETURN_GS_ERROR(ErrorCode::kInvalidValueError, "Invalid schema.");
+    }
+    new_meta.AddKeyValue("schema", schema.ToJSONString());
+
+    new_meta.AddMember("ivnums", old_meta.GetMemberMeta("ivnums"));
+    nbytes += old_meta.GetMemberMeta("ivnums").GetNBytes();
+    new_meta.AddMember("ovnums", old_meta.GetMemberMeta("ovnums"));
+    nbytes += old_meta.GetMemberMeta("ovnums").GetNBytes();
+    new_meta.AddMember("tvnums", old_meta.GetMemberMeta("tvnums"));
+    nbytes += old_meta.GetMemberMeta("tvnums").GetNBytes();
+
+    ASSIGN_IDENTICAL_VEC_META("vertex_tables", vertex_label_num_);
+    ASSIGN_IDENTICAL_VEC_META("ovgid_lists", vertex_label_num_);
+    ASSIGN_IDENTICAL_VEC_META("ovg2l_maps", vertex_label_num_);
+
+    GENERATE_TABLE_VEC_META("vertex", 0, vertex_label_num_,
+                            this->vertex_tables_);
+
+    if (directed_) {
+      ASSIGN_IDENTICAL_VEC_VEC_META("ie_lists", vertex_label_num_,
+                                    edge_label_num_);
+      ASSIGN_IDENTICAL_VEC_VEC_META("ie_offsets_lists", vertex_label_num_,
+                                    edge_label_num_);
+    }
+    ASSIGN_IDENTICAL_VEC_VEC_META("oe_lists", vertex_label_num_,
+                                  edge_label_num_);
+    ASSIGN_IDENTICAL_VEC_VEC_META("oe_offsets_lists", vertex_label_num_,
+                                  edge_label_num_);
+
+    new_meta.AddMember("vertex_map", old_meta.GetMemberMeta("vertex_map"));
+
+    new_meta.SetNBytes(nbytes);
+
+    vineyard::ObjectID ret;
+    VINEYARD_CHECK_OK(client.CreateMetaData(new_meta, ret));
+    return ret;
+  }
+
+  boost::leaf::result<vineyard::ObjectID> AddEdgeColumns(
+      vineyard::Client& client,
+      const std::map<
+          label_id_t,
+          std::vector<std::pair<std::string, std::shared_ptr<arrow::Array>>>>
+          columns) override {
+    return AddEdgeColumnsImpl<arrow::Array>(client, columns);
+  }
+
+  boost::leaf::result<vineyard::ObjectID> AddEdgeColumns(
+      vineyard::Client& client,
+      const std::map<label_id_t,
+                     std::vector<std::pair<
+                         std::string, std::shared_ptr<arrow::ChunkedArray>>>>
+          columns) override {
+    return AddEdgeColumnsImpl<arrow::ChunkedArray>(client, columns);
+  }
+
+  /// Append edges between the existing vertices to the existing edge labels,
+  /// the CSR of the touched edge labels are rebuilt and the others are shared
+  /// with this fragment.
+  ///
+  /// The `edge_src` and `edge_dst` are the vertices (`vertex_t::GetValue()`)
+  /// in this fragment, and `edge_tables` are the properties of the appended
+  /// edges, in the same schema of the existing edge tables. See also
+  /// `ArrowFragmentDelta`.
+  boost::leaf::result<vineyard::ObjectID> AppendEdges(
+      vineyard::Client& client,
+      const std::map<label_id_t, std::shared_ptr<vid_array_t>>& edge_src,
+      const std::map<label_id_t, std::shared_ptr<vid_array_t>>& edge_dst,
+      const std::map<label_id_t, std::shared_ptr<arrow::Table>>& edge_tables,
+      int concurrency) {
+    vineyard::ObjectMeta old_meta, new_meta;
+    VINEYARD_CHECK_OK(client.GetMetaData(this->id_, old_meta));
+
+    new_meta.SetTypeName(type_name<ArrowFragment<oid_t, vid_t>>());
+    new_meta.AddKeyValue("fid", fid_);
+    new_meta.AddKeyValue("fnum", fnum_);
+    new_meta.AddKeyValue("directed", static_cast<int>(directed_));
+    new_meta.AddKeyValue("oid_type", TypeName<oid_t>::Get());
+    new_meta.AddKeyValue("vid_type", TypeName<vid_t>::Get());
+    new_meta.AddKeyValue("vertex_label_num", vertex_label_num_);
+    new_meta.AddKeyValue("edge_label_num", edge_label_num_);
+    new_meta.AddKeyValue("schema", schema_.ToJSONString());
+
+    std::vector<vid_t> tvnums(vertex_label_num_);
+    for (label_id_t i = 0; i < vertex_label_num_; ++i) {
+      tvnums[i] = ivnums_[i] + ovnums_[i];
+    }
+
+    size_t nbytes = 0;
+    for (label_id_t j = 0; j < edge_label_num_; ++j) {
+      std::string table_name = generate_name_with_suffix("edge_tables", j);
+      auto table_iter = edge_tables.find(j);
+      if (table_iter == edge_tables.end()) {
+        GENERATE_TABLE_META("edge", j, this->edge_tables_[j]);
+        new_meta.AddMember(table_name, old_meta.GetMemberMeta(table_name));
+        nbytes += old_meta.GetMemberMeta(table_name).GetNBytes();
+        for (label_id_t i = 0; i < vertex_label_num_; ++i) {
+          std::vector<std::string> names = {
+              generate_name_with_suffix("oe_lists", i, j),
+              generate_name_with_suffix("oe_offsets_lists", i, j)};
+          if (directed_) {
+            names.emplace_back(generate_name_with_suffix("ie_lists", i, j));
+            names.emplace_back(
+                generate_name_with_suffix("ie_offsets_lists", i, j));
+          }
+          for (auto const& name : names) {
+            new_meta.AddMember(name, old_meta.GetMemberMeta(name));
+            nbytes += old_meta.GetMemberMeta(name).GetNBytes();
+          }
+        }
+        continue;
+      }
+      if (edge_src.find(j) == edge_src.end() ||
+          edge_dst.find(j) == edge_dst.end() ||
+          edge_src.at(j)->length() != table_iter->second->num_rows() ||
+          edge_dst.at(j)->length() != table_iter->second->num_rows()) {
+        RETURN_GS_ERROR(ErrorCode::kInvalidValueError,
+                        "The appended edges of label " + std::to_string(j) +
+                            " mismatch with their properties");
+      }
+      if (!table_iter->second->schema()->Equals(*edge_tables_[j]->schema(),
+                                                false)) {
+        RETURN_GS_ERROR(ErrorCode::kInvalidValueError,
+                        "The appended edges of label " + std::to_string(j) +
+                            " mismatch with the schema");
+      }
+
+      // recovers the (src, dst) of the existing edges from the outgoing CSR,
+      // where every edge appears (at least) once.
+      int64_t base_num = edge_tables_[j]->num_rows();
+      int64_t delta_num = table_iter->second->num_rows();
+      std::vector<vid_t> srcs(base_num + delta_num), dsts(base_num + delta_num);
+      for (label_id_t i = 0; i < vertex_label_num_; ++i) {
+        const int64_t* offsets = oe_offsets_ptr_lists_[i][j];
+        const nbr_unit_t* oe = oe_ptr_lists_[i][j];
+        int64_t vnum = oe_offsets_lists_[i][j]->length() - 1;
+        for (int64_t k = 0; k < vnum; ++k) {
+          vid_t u = vid_parser_.GenerateId(0, i, k);
+          for (int64_t e = offsets[k]; e < offsets[k + 1]; ++e) {
+            srcs[oe[e].eid] = u;
+            dsts[oe[e].eid] = oe[e].vid;
+          }
+        }
+      }
+      const vid_t* delta_src = edge_src.at(j)->raw_values();
+      const vid_t* delta_dst = edge_dst.at(j)->raw_values();
+      std::copy(delta_src, delta_src + delta_num, srcs.begin() + base_num);
+      std::copy(delta_dst, delta_dst + delta_num, dsts.begin() + base_num);
+
+      std::shared_ptr<vid_array_t> src_array, dst_array;
+      {
+        vid_builder_t src_builder, dst_builder;
+        ARROW_OK_OR_RAISE(src_builder.AppendValues(srcs));
+        ARROW_OK_OR_RAISE(src_builder.Finish(&src_array));
+        ARROW_OK_OR_RAISE(dst_builder.AppendValues(dsts));
+        ARROW_OK_OR_RAISE(dst_builder.Finish(&dst_array));
+      }
+
+      std::vector<std::shared_ptr<arrow::FixedSizeBinaryArray>> sub_ie_lists(
+          vertex_label_num_),
+          sub_oe_lists(vertex_label_num_);
+      std::vector<std::shared_ptr<arrow::Int64Array>> sub_ie_offset_lists(
+          vertex_label_num_),
+          sub_oe_offset_lists(vertex_label_num_);
+      if (directed_) {
+        BOOST_LEAF_CHECK(generate_directed_csr<vid_t, eid_t>(
+            vid_parser_, src_array, dst_array, tvnums, vertex_label_num_,
+            concurrency, sub_oe_lists, sub_oe_offset_lists));
+        BOOST_LEAF_CHECK(generate_directed_csr<vid_t, eid_t>(
+            vid_parser_, dst_array, src_array, tvnums, vertex_label_num_,
+            concurrency, sub_ie_lists, sub_ie_offset_lists));
+      } else {
+        BOOST_LEAF_CHECK(generate_undirected_csr<vid_t, eid_t>(
+            vid_parser_, src_array, dst_array, tvnums, vertex_label_num_,
+            concurrency, sub_oe_lists, sub_oe_offset_lists));
+      }
+
+      // the appended properties follow the existing ones, thus the edge ids
+      // of appended edges start from `base_num`.
+      std::shared_ptr<arrow::Table> merged_table;
+      ARROW_OK_ASSIGN_OR_RAISE(
+          merged_table,
+          arrow::ConcatenateTables(
+              {edge_tables_[j],
+               arrow::Table::Make(edge_tables_[j]->schema(),
+                                  table_iter->second->columns())}));
+      vineyard::TableBuilder et(client, merged_table);
+      auto vy_table =
+          std::dynamic_pointer_cast<vineyard::Table>(et.Seal(client));
+      new_meta.AddMember(table_name, vy_table->meta());
+      nbytes += vy_table->nbytes();
+      GENERATE_TABLE_META("edge", j, merged_table);
+
+      for (label_id_t i = 0; i < vertex_label_num_; ++i) {
+        if (directed_) {
+          vineyard::FixedSizeBinaryArrayBuilder ie_builder(client,
+                                                           sub_ie_lists[i]);
+          auto ie = ie_builder.Seal(client);
+          new_meta.AddMember(generate_name_with_suffix("ie_lists", i, j),
+                             ie->meta());
+          nbytes += ie->nbytes();
+          vineyard::NumericArrayBuilder<int64_t> ieo_builder(
+              client, sub_ie_offset_lists[i]);
+          auto ieo = ieo_builder.Seal(client);
+          new_meta.AddMember(
+              generate_name_with_suffix("ie_offsets_lists", i, j),
+              ieo->meta());
+          nbytes += ieo->nbytes();
+        }
+        vineyard::FixedSizeBinaryArrayBuilder oe_builder(client,
+                                                         sub_oe_lists[i]);
+        auto oe = oe_builder.Seal(client);
+        new_meta.AddMember(generate_name_with_suffix("oe_lists", i, j),
+                           oe->meta());
+        nbytes += oe->nbytes();
+        vineyard::NumericArrayBuilder<int64_t> oeo_builder(
+            client, sub_oe_offset_lists[i]);
+        auto oeo = oeo_builder.Seal(client);
+        new_meta.AddMember(generate_name_with_suffix("oe_offsets_lists", i, j),
+                           oeo->meta());
+        nbytes += oeo->nbytes();
+      }
+    }
+
+    new_meta.AddMember("ivnums", old_meta.GetMemberMeta("ivnums"));
+    nbytes += old_meta.GetMemberMeta("ivnums").GetNBytes();
+    new_meta.AddMember("ovnums", old_meta.GetMemberMeta("ovnums"));
+    nbytes += old_meta.GetMemberMeta("ovnums").GetNBytes();
+    new_meta.AddMember("tvnums", old_meta.GetMemberMeta("tvnums"));
+    nbytes += old_meta.GetMemberMeta("tvnums").GetNBytes();
+
+    ASSIGN_IDENTICAL_VEC_META("vertex_tables", vertex_label_num_);
+    ASSIGN_IDENTICAL_VEC_META("ovgid_lists", vertex_label_num_);
+    ASSIGN_IDENTICAL_VEC_META("ovg2l_maps", vertex_label_num_);
+
+    GENERATE_TABLE_VEC_META("vertex", 0, vertex_label_num_,
+                            this->vertex_tables_);
+
+    new_meta.AddMember("vertex_map", old_meta.GetMemberMeta("vertex_map"));
+
+    new_meta.SetNBytes(nbytes);
+
+    vineyard::ObjectID ret;
+    VINEYARD_CHECK_OK(client.CreateMetaData(new_meta, ret));
+    return ret;
+  }
+
   boost::leaf::result<vineyard::ObjectID> Project(
       vineyard::Client& client,
       std::map<label_id_t, std::vector<label_id_t>> vertices,
       std::map<label_id_t, std::vector<label_id_t>> edges) {
-    vineyard::ObjectMeta old_meta, new_meta;
-    VINEYARD_CHECK_OK(client.GetMetaData(this->id_, old_meta));
+    // the projection shares all members with this fragment, the members are
+    // referred by ids rather than copying their metadata trees.
+    const vineyard::ObjectMeta& old_meta = this->meta_;
+    const json& old_tree = old_meta.MetaData();
+    vineyard::ObjectMeta new_meta;
 
     new_meta.SetTypeName(type_name<ArrowFragment<oid_t, vid_t>>());
     new_meta.AddKeyValue("fid", fid_);
@@ -2248,34 +2790,41 @@ class ArrowFragment
     new_meta.AddKeyValue("schema", schema.ToJSONString());
 
     size_t nbytes = 0;
-    new_meta.AddMember("ivnums", old_meta.GetMemberMeta("ivnums"));
-    nbytes += old_meta.GetMemberMeta("ivnums").GetNBytes();
-    new_meta.AddMember("ovnums", old_meta.GetMemberMeta("ovnums"));
-    nbytes += old_meta.GetMemberMeta("ovnums").GetNBytes();
-    new_meta.AddMember("tvnums", old_meta.GetMemberMeta("tvnums"));
-    nbytes += old_meta.GetMemberMeta("tvnums").GetNBytes();
+    auto share_member = [&](const std::string& name) {
+      const json& member = old_tree[name];
+      new_meta.AddMember(name, VYObjectIDFromString(
+                                   member["id"].get_ref<std::string const&>()));
+      nbytes += member.value("nbytes", static_cast<size_t>(0));
+    };
 
-    ASSIGN_IDENTICAL_VEC_META("ovgid_lists", vertex_label_num_);
-    ASSIGN_IDENTICAL_VEC_META("ovg2l_maps", vertex_label_num_);
-    ASSIGN_IDENTICAL_VEC_META("vertex_tables", vertex_label_num_);
-    ASSIGN_IDENTICAL_VEC_META("edge_tables", edge_label_num_);
+    share_member("ivnums");
+    share_member("ovnums");
+    share_member("tvnums");
+    for (label_id_t i = 0; i < vertex_label_num_; ++i) {
+      share_member(generate_name_with_suffix("ovgid_lists", i));
+      share_member(generate_name_with_suffix("ovg2l_maps", i));
+      share_member(generate_name_with_suffix("vertex_tables", i));
+    }
+    for (label_id_t i = 0; i < edge_label_num_; ++i) {
+      share_member(generate_name_with_suffix("edge_tables", i));
+    }
 
     GENERATE_TABLE_VEC_META("vertex", 0, vertex_label_num_,
                             this->vertex_tables_);
     GENERATE_TABLE_VEC_META("edge", 0, edge_label_num_, this->edge_tables_);
 
-    if (directed_) {
-      ASSIGN_IDENTICAL_VEC_VEC_META("ie_lists", vertex_label_num_,
-                                    edge_label_num_);
-      ASSIGN_IDENTICAL_VEC_VEC_META("ie_offsets_lists", vertex_label_num_,
-                                    edge_label_num_);
+    for (label_id_t i = 0; i < vertex_label_num_; ++i) {
+      for (label_id_t j = 0; j < edge_label_num_; ++j) {
+        if (directed_) {
+          share_member(generate_name_with_suffix("ie_lists", i, j));
+          share_member(generate_name_with_suffix("ie_offsets_lists", i, j));
+        }
+        share_member(generate_name_with_suffix("oe_lists", i, j));
+        share_member(generate_name_with_suffix("oe_offsets_lists", i, j));
+      }
     }
-    ASSIGN_IDENTICAL_VEC_VEC_META("oe_lists", vertex_label_num_,
-                                  edge_label_num_);
-    ASSIGN_IDENTICAL_VEC_VEC_META("oe_offsets_lists", vertex_label_num_,
-                                  edge_label_num_);
 
-    new_meta.AddMember("vertex_map", old_meta.GetMemberMeta("vertex_map"));
+    share_member("vertex_map");
 
     new_meta.SetNBytes(nbytes);
 
@@ -2373,6 +2922,53 @@ class ArrowFragment
       ie_ptr_lists_ = oe_ptr_lists_;
       ie_offsets_ptr_lists_ = oe_offsets_ptr_lists_;
     }
+
+    if (degree_index_) {
+      auto raw_values =
+          [](const std::vector<std::shared_ptr<arrow::Int64Array>>& arrays)
+          -> std::vector<const int64_t*> {
+        std::vector<const int64_t*> pointers;
+        for (auto const& array : arrays) {
+          pointers.emplace_back(array->raw_values());
+        }
+        return pointers;
+      };
+      oe_degrees_ptr_lists_ = raw_values(oe_degrees_lists_);
+      oe_label_offsets_ptr_lists_ = raw_values(oe_label_offsets_lists_);
+      if (directed_) {
+        ie_degrees_ptr_lists_ = raw_values(ie_degrees_lists_);
+        ie_label_offsets_ptr_lists_ = raw_values(ie_label_offsets_lists_);
+      } else {
+        ie_degrees_ptr_lists_ = oe_degrees_ptr_lists_;
+        ie_label_offsets_ptr_lists_ = oe_label_offsets_ptr_lists_;
+      }
+    }
+  }
+
+  int64_t getLocalDegree(
+      const vertex_t& v, const std::vector<const int64_t*>& degrees,
+      const std::vector<std::vector<const int64_t*>>& offsets) const {
+    label_id_t v_label = vid_parser_.GetLabelId(v.GetValue());
+    int64_t v_offset = vid_parser_.GetOffset(v.GetValue());
+    if (degree_index_) {
+      return degrees[v_label][v_offset];
+    }
+    int64_t degree = 0;
+    for (label_id_t e_label = 0; e_label < edge_label_num_; ++e_label) {
+      degree += offsets[v_label][e_label][v_offset + 1] -
+                offsets[v_label][e_label][v_offset];
+    }
+    return degree;
+  }
+
+  const int64_t* getLabelOffsets(
+      const vertex_t& v,
+      const std::vector<const int64_t*>& label_offsets) const {
+    if (!degree_index_) {
+      return nullptr;
+    }
+    return label_offsets[vid_parser_.GetLabelId(v.GetValue())] +
+           vid_parser_.GetOffset(v.GetValue()) * (edge_label_num_ + 1);
   }
 
   void initDestFidList(
@@ -2458,6 +3054,13 @@ class ArrowFragment
   std::vector<std::vector<const int64_t*>> ie_offsets_ptr_lists_,
       oe_offsets_ptr_lists_;
 
+  // the optional degree index, per vertex label
+  bool degree_index_ = false;
+  std::vector<std::shared_ptr<arrow::Int64Array>> ie_degrees_lists_,
+      oe_degrees_lists_, ie_label_offsets_lists_, oe_label_offsets_lists_;
+  std::vector<const int64_t*> ie_degrees_ptr_lists_, oe_degrees_ptr_lists_,
+      ie_label_offsets_ptr_lists_, oe_label_offsets_ptr_lists_;
+
   std::vector<std::vector<std::vector<fid_t>>> idst_, odst_, iodst_;
   std::vector<std::vector<std::vector<fid_t*>>> idoffset_, odoffset_,
       iodoffset_;
@@ -2592,6 +3195,26 @@ class ArrowFragmentBuilder : public vineyard::ObjectBuilder {
     vm_ptr_ = vm_ptr;
   }
 
+  void set_in_degree_index(
+      label_id_t v_label,
+      std::shared_ptr<vineyard::NumericArray<int64_t>> degrees,
+      std::shared_ptr<vineyard::NumericArray<int64_t>> label_offsets) {
+    ie_degrees_lists_.resize(vertex_label_num_);
+    ie_label_offsets_lists_.resize(vertex_label_num_);
+    ie_degrees_lists_[v_label] = degrees;
+    ie_label_offsets_lists_[v_label] = label_offsets;
+  }
+
+  void set_out_degree_index(
+      label_id_t v_label,
+      std::shared_ptr<vineyard::NumericArray<int64_t>> degrees,
+      std::shared_ptr<vineyard::NumericArray<int64_t>> label_offsets) {
+    oe_degrees_lists_.resize(vertex_label_num_);
+    oe_label_offsets_lists_.resize(vertex_label_num_);
+    oe_degrees_lists_[v_label] = degrees;
+    oe_label_offsets_lists_[v_label] = label_offsets;
+  }
+
 #define ASSIGN_ARRAY_VECTOR(src_array_vec, dst_array_vec) \
   do {                                                    \
     dst_array_vec.resize(src_array_vec.size());           \
@@ -2748,6 +3371,21 @@ class ArrowFragmentBuilder : public vineyard::ObjectBuilder {
     GENERATE_VEC_VEC_META("oe_offsets_lists", oe_offsets_lists_,
                           vertex_label_num_, edge_label_num_);
 
+    bool degree_index = !oe_degrees_lists_.empty();
+    frag->meta_.AddKeyValue("degree_index", static_cast<int>(degree_index));
+    if (degree_index) {
+      if (directed_) {
+        GENERATE_VEC_META("ie_degrees_lists", ie_degrees_lists_,
+                          vertex_label_num_);
+        GENERATE_VEC_META("ie_label_offsets_lists", ie_label_offsets_lists_,
+                          vertex_label_num_);
+      }
+      GENERATE_VEC_META("oe_degrees_lists", oe_degrees_lists_,
+                        vertex_label_num_);
+      GENERATE_VEC_META("oe_label_offsets_lists", oe_label_offsets_lists_,
+                        vertex_label_num_);
+    }
+
     frag->meta_.AddMember("vertex_map", vm_ptr_->meta());
 
     frag->meta_.SetNBytes(nbytes);
@@ -2784,6 +3422,9 @@ class ArrowFragmentBuilder : public vineyard::ObjectBuilder {
       ie_lists_, oe_lists_;
   std::vector<std::vector<std::shared_ptr<vineyard::NumericArray<int64_t>>>>
       ie_offsets_lists_, oe_offsets_lists_;
+  std::vector<std::shared_ptr<vineyard::NumericArray<int64_t>>>
+      ie_degrees_lists_, oe_degrees_lists_, ie_label_offsets_lists_,
+      oe_label_offsets_lists_;
 
   std::shared_ptr<vertex_map_t> vm_ptr_;
   PropertyGraphSchema schema_;
@@ -2903,6 +3544,27 @@ class BasicArrowFragmentBuilder : public ArrowFragmentBuilder<OID_T, VID_T> {
       }
     }
 
+    if (degree_index_) {
+      for (label_id_t i = 0; i < vertex_label_num_; ++i) {
+        auto fn = [this, i](Client& client) {
+          auto seal = [&client](std::shared_ptr<arrow::Int64Array> const& array)
+              -> std::shared_ptr<vineyard::NumericArray<int64_t>> {
+            vineyard::NumericArrayBuilder<int64_t> builder(client, array);
+            return std::dynamic_pointer_cast<vineyard::NumericArray<int64_t>>(
+                builder.Seal(client));
+          };
+          if (directed_) {
+            this->set_in_degree_index(i, seal(ie_degrees_lists_[i]),
+                                      seal(ie_label_offsets_lists_[i]));
+          }
+          this->set_out_degree_index(i, seal(oe_degrees_lists_[i]),
+                                     seal(oe_label_offsets_lists_[i]));
+          return Status::OK();
+        };
+        tg.AddTask(fn, std::ref(client));
+      }
+    }
+
     tg.TakeResults();
 
     this->set_vertex_map(vm_ptr_);
@@ -2924,9 +3586,20 @@ class BasicArrowFragmentBuilder : public ArrowFragmentBuilder<OID_T, VID_T> {
 
     BOOST_LEAF_CHECK(initVertices(std::move(vertex_tables)));
     BOOST_LEAF_CHECK(initEdges(std::move(edge_tables), concurrency));
+    if (degree_index_) {
+      BOOST_LEAF_CHECK(initDegreeIndex(concurrency));
+    }
     return {};
   }
 
+  /**
+   * @brief Precompute the degrees of vertices (over all edge labels) and the
+   * vertex-major index of edges across edge labels, into the sealed fragment,
+   * see also `ArrowFragment::GetLocalOutDegrees` and
+   * `ArrowFragment::GetOutgoingLabelOffsets`. It must be set before `Init`.
+   */
+  void set_degree_index(bool enabled) { degree_index_ = enabled; }
+
   boost::leaf::result<void> SetPropertyGraphSchema(
       PropertyGraphSchema&& schema) {
     schema_ = std::move(schema);
@@ -3074,6 +3747,60 @@ class BasicArrowFragmentBuilder : public ArrowFragmentBuilder<OID_T, VID_T> {
     return {};
   }
 
+  boost::leaf::result<void> initDegreeIndex(int concurrency) {
+    ie_degrees_lists_.resize(vertex_label_num_);
+    oe_degrees_lists_.resize(vertex_label_num_);
+    ie_label_offsets_lists_.resize(vertex_label_num_);
+    oe_label_offsets_lists_.resize(vertex_label_num_);
+    for (label_id_t v_label = 0; v_label < vertex_label_num_; ++v_label) {
+      if (directed_) {
+        BOOST_LEAF_CHECK(buildDegreeIndex(ie_offsets_lists_[v_label],
+                                          tvnums_[v_label], concurrency,
+                                          ie_degrees_lists_[v_label],
+                                          ie_label_offsets_lists_[v_label]));
+      }
+      BOOST_LEAF_CHECK(buildDegreeIndex(oe_offsets_lists_[v_label],
+                                        tvnums_[v_label], concurrency,
+                                        oe_degrees_lists_[v_label],
+                                        oe_label_offsets_lists_[v_label]));
+    }
+    return {};
+  }
+
+  // the degrees and the label-wise prefix sums of `tvnum` vertices from the
+  // CSR offsets of every edge label, in parallel over vertices.
+  boost::leaf::result<void> buildDegreeIndex(
+      const std::vector<std::shared_ptr<arrow::Int64Array>>& offsets_lists,
+      const vid_t tvnum, int concurrency,
+      std::shared_ptr<arrow::Int64Array>& degrees_out,
+      std::shared_ptr<arrow::Int64Array>& label_offsets_out) {
+    const int64_t stride = edge_label_num_ + 1;
+    std::vector<const int64_t*> offsets(edge_label_num_);
+    for (label_id_t e_label = 0; e_label < edge_label_num_; ++e_label) {
+      offsets[e_label] = offsets_lists[e_label]->raw_values();
+    }
+    std::vector<int64_t> degrees(tvnum), label_offsets(tvnum * stride);
+    parallel_for(
+        static_cast<vid_t>(0), tvnum,
+        [&](vid_t v) {
+          int64_t* index = &label_offsets[v * stride];
+          index[0] = 0;
+          for (label_id_t e_label = 0; e_label < edge_label_num_; ++e_label) {
+            index[e_label + 1] = index[e_label] + offsets[e_label][v + 1] -
+                                 offsets[e_label][v];
+          }
+          degrees[v] = index[edge_label_num_];
+        },
+        std::max(concurrency, 1), 4096);
+
+    arrow::Int64Builder degrees_builder, label_offsets_builder;
+    ARROW_OK_OR_RAISE(degrees_builder.AppendValues(degrees));
+    ARROW_OK_OR_RAISE(degrees_builder.Finish(&degrees_out));
+    ARROW_OK_OR_RAISE(label_offsets_builder.AppendValues(label_offsets));
+    ARROW_OK_OR_RAISE(label_offsets_builder.Finish(&label_offsets_out));
+    return {};
+  }
+
   fid_t fid_, fnum_;
   bool directed_;
   label_id_t vertex_label_num_;
@@ -3092,6 +3819,10 @@ class BasicArrowFragmentBuilder : public ArrowFragmentBuilder<OID_T, VID_T> {
   std::vector<std::vector<std::shared_ptr<arrow::Int64Array>>>
       ie_offsets_lists_, oe_offsets_lists_;
 
+  bool degree_index_ = false;
+  std::vector<std::shared_ptr<arrow::Int64Array>> ie_degrees_lists_,
+      oe_degrees_lists_, ie_label_offsets_lists_, oe_label_offsets_lists_;
+
   std::shared_ptr<vertex_map_t> vm_ptr_;
 
   IdParser<vid_t> vid_parser_;
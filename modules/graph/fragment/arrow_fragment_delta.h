@@ -0,0 +1,350 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+
+#ifndef MODULES_GRAPH_FRAGMENT_ARROW_FRAGMENT_DELTA_H_
+#define MODULES_GRAPH_FRAGMENT_ARROW_FRAGMENT_DELTA_H_
+
+#include <map>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "arrow/api.h"
+
+#include "client/client.h"
+
+#include "graph/fragment/arrow_fragment.h"
+#include "graph/utils/error.h"
+
+namespace vineyard {
+
+/**
+ * @brief ArrowFragmentDelta is a mutable layer over a sealed ArrowFragment,
+ * where the edges (between the existing vertices) are appended to per-label
+ * edge logs with adjacency hashes, and queried together with the CSR of the
+ * fragment, without rebuilding the CSR for every batch of updates.
+ *
+ * The delta is merged into a new sealed version of the fragment by
+ * `Compact()`. The appended edges get edge ids that follow the edges in the
+ * fragment, which are kept by the compaction.
+ *
+ * Note that the delta is not thread-safe, updates and queries should be
+ * serialized by the caller.
+ */
+template <typename OID_T, typename VID_T>
+class ArrowFragmentDelta {
+ public:
+  using fragment_t = ArrowFragment<OID_T, VID_T>;
+  using oid_t = typename fragment_t::oid_t;
+  using vid_t = typename fragment_t::vid_t;
+  using eid_t = typename fragment_t::eid_t;
+  using prop_id_t = typename fragment_t::prop_id_t;
+  using label_id_t = typename fragment_t::label_id_t;
+  using vertex_t = typename fragment_t::vertex_t;
+  using nbr_unit_t = typename fragment_t::nbr_unit_t;
+  using vid_array_t = typename fragment_t::vid_array_t;
+  using vid_builder_t = typename fragment_t::vid_builder_t;
+
+  /**
+   * @brief The neighbors in the CSR of the fragment, followed by the
+   * neighbors in the delta.
+   */
+  class adj_list_t {
+   public:
+    class iterator {
+     public:
+      iterator(const nbr_unit_t* current, const nbr_unit_t* base_end,
+               const nbr_unit_t* delta_begin)
+          : current_(current), base_end_(base_end), delta_begin_(delta_begin) {
+        if (current_ == base_end_) {
+          current_ = delta_begin_;
+        }
+      }
+
+      const nbr_unit_t& operator*() const { return *current_; }
+
+      const nbr_unit_t* operator->() const { return current_; }
+
+      iterator& operator++() {
+        if (++current_ == base_end_) {
+          current_ = delta_begin_;
+        }
+        return *this;
+      }
+
+      bool operator==(const iterator& rhs) const {
+        return current_ == rhs.current_;
+      }
+
+      bool operator!=(const iterator& rhs) const {
+        return current_ != rhs.current_;
+      }
+
+     private:
+      const nbr_unit_t* current_;
+      const nbr_unit_t* base_end_;
+      const nbr_unit_t* delta_begin_;
+    };
+
+    adj_list_t(const nbr_unit_t* base_begin, const nbr_unit_t* base_end,
+               const std::vector<nbr_unit_t>* delta)
+        : base_begin_(base_begin), base_end_(base_end) {
+      if (delta == nullptr || delta->empty()) {
+        delta_begin_ = delta_end_ = base_end_;
+      } else {
+        delta_begin_ = delta->data();
+        delta_end_ = delta->data() + delta->size();
+      }
+    }
+
+    iterator begin() const {
+      return iterator(base_begin_, base_end_, delta_begin_);
+    }
+
+    iterator end() const { return iterator(delta_end_, nullptr, nullptr); }
+
+    size_t Size() const {
+      size_t size = base_end_ - base_begin_;
+      if (delta_begin_ != base_end_) {
+        size += delta_end_ - delta_begin_;
+      }
+      return size;
+    }
+
+    bool Empty() const { return Size() == 0; }
+
+   private:
+    const nbr_unit_t* base_begin_;
+    const nbr_unit_t* base_end_;
+    const nbr_unit_t* delta_begin_;
+    const nbr_unit_t* delta_end_;
+  };
+
+  explicit ArrowFragmentDelta(const std::shared_ptr<fragment_t>& fragment) {
+    reset(fragment);
+  }
+
+  const std::shared_ptr<fragment_t>& fragment() const { return fragment_; }
+
+  /**
+   * @brief Append edges of the label `e_label` from the vertices `srcs` (of
+   * label `src_label`) to the vertices `dsts` (of label `dst_label`), with
+   * the properties in `properties`, which should be in the same schema of
+   * the edge table of `e_label` (or nullptr if the edge label doesn't have
+   * properties).
+   *
+   * The vertices should exist in the fragment (as inner or outer vertices),
+   * new vertices require `AddVertices` on the fragment instead.
+   */
+  boost::leaf::result<void> AddEdges(
+      label_id_t e_label, label_id_t src_label, const std::vector<oid_t>& srcs,
+      label_id_t dst_label, const std::vector<oid_t>& dsts,
+      const std::shared_ptr<arrow::Table>& properties) {
+    if (e_label < 0 || e_label >= fragment_->edge_label_num()) {
+      RETURN_GS_ERROR(ErrorCode::kInvalidValueError,
+                      "Invalid edge label id: " + std::to_string(e_label));
+    }
+    if (srcs.size() != dsts.size()) {
+      RETURN_GS_ERROR(ErrorCode::kInvalidValueError,
+                      "The numbers of sources and destinations mismatch");
+    }
+    auto schema = fragment_->edge_data_table(e_label)->schema();
+    std::shared_ptr<arrow::Table> table = properties;
+    if (table == nullptr && schema->num_fields() == 0) {
+      table = arrow::Table::Make(
+          schema, std::vector<std::shared_ptr<arrow::ChunkedArray>>{},
+          srcs.size());
+    }
+    if (table == nullptr ||
+        table->num_rows() != static_cast<int64_t>(srcs.size()) ||
+        !table->schema()->Equals(*schema, false)) {
+      RETURN_GS_ERROR(ErrorCode::kInvalidValueError,
+                      "The properties mismatch with the edge table of label " +
+                          std::to_string(e_label));
+    }
+
+    // resolves all vertices before changing the delta
+    std::vector<std::pair<vertex_t, vertex_t>> edges(srcs.size());
+    for (size_t idx = 0; idx < srcs.size(); ++idx) {
+      if (!fragment_->GetVertex(src_label, srcs[idx], edges[idx].first) ||
+          !fragment_->GetVertex(dst_label, dsts[idx], edges[idx].second)) {
+        RETURN_GS_ERROR(ErrorCode::kInvalidValueError,
+                        "The endpoints of the edge don't exist in the "
+                        "fragment, add the vertices first");
+      }
+    }
+
+    auto& oe = oe_deltas_[e_label];
+    auto& ie = fragment_->directed() ? ie_deltas_[e_label] : oe;
+    eid_t eid = base_edge_nums_[e_label] + edge_srcs_[e_label].size();
+    for (auto const& edge : edges) {
+      vid_t u = edge.first.GetValue(), v = edge.second.GetValue();
+      oe[u].emplace_back(v, eid);
+      ie[v].emplace_back(u, eid);
+      edge_srcs_[e_label].emplace_back(u);
+      edge_dsts_[e_label].emplace_back(v);
+      ++eid;
+    }
+    edge_tables_[e_label].emplace_back(table);
+    return {};
+  }
+
+  adj_list_t GetOutgoingAdjList(const vertex_t& v, label_id_t e_label) const {
+    auto base = fragment_->GetOutgoingRawAdjList(v, e_label);
+    return adj_list_t(base.begin(), base.end(),
+                      find(oe_deltas_[e_label], v.GetValue()));
+  }
+
+  adj_list_t GetIncomingAdjList(const vertex_t& v, label_id_t e_label) const {
+    auto base = fragment_->GetIncomingRawAdjList(v, e_label);
+    auto const& deltas =
+        fragment_->directed() ? ie_deltas_[e_label] : oe_deltas_[e_label];
+    return adj_list_t(base.begin(), base.end(), find(deltas, v.GetValue()));
+  }
+
+  int GetLocalOutDegree(const vertex_t& v, label_id_t e_label) const {
+    return GetOutgoingAdjList(v, e_label).Size();
+  }
+
+  int GetLocalInDegree(const vertex_t& v, label_id_t e_label) const {
+    return GetIncomingAdjList(v, e_label).Size();
+  }
+
+  /**
+   * @brief Get the property of an edge in the fragment or in the delta.
+   */
+  template <typename DATA_T>
+  DATA_T GetEdgeData(label_id_t e_label, eid_t eid, prop_id_t prop) const {
+    using array_t = typename ConvertToArrowType<DATA_T>::ArrayType;
+    int64_t index = static_cast<int64_t>(eid);
+    if (index < base_edge_nums_[e_label]) {
+      return locate<array_t>(fragment_->edge_data_table(e_label), prop, index)
+          ->GetView(index);
+    }
+    index -= base_edge_nums_[e_label];
+    for (auto const& table : edge_tables_[e_label]) {
+      if (index < table->num_rows()) {
+        return locate<array_t>(table, prop, index)->GetView(index);
+      }
+      index -= table->num_rows();
+    }
+    return DATA_T();
+  }
+
+  /**
+   * @brief The number of edges in the delta.
+   */
+  size_t DeltaEdgeNum() const {
+    size_t num = 0;
+    for (auto const& srcs : edge_srcs_) {
+      num += srcs.size();
+    }
+    return num;
+  }
+
+  /**
+   * @brief Merge the delta into a new sealed version of the fragment, the
+   * delta continues on the new version afterwards.
+   *
+   * Only the CSR and edge tables of the touched edge labels are rebuilt, the
+   * other members are shared with the current version.
+   */
+  boost::leaf::result<ObjectID> Compact(Client& client, int concurrency = 1) {
+    if (DeltaEdgeNum() == 0) {
+      return fragment_->id();
+    }
+    std::map<label_id_t, std::shared_ptr<vid_array_t>> srcs, dsts;
+    std::map<label_id_t, std::shared_ptr<arrow::Table>> tables;
+    for (label_id_t e_label = 0; e_label < fragment_->edge_label_num();
+         ++e_label) {
+      if (edge_srcs_[e_label].empty()) {
+        continue;
+      }
+      vid_builder_t src_builder, dst_builder;
+      ARROW_OK_OR_RAISE(src_builder.AppendValues(edge_srcs_[e_label]));
+      ARROW_OK_OR_RAISE(src_builder.Finish(&srcs[e_label]));
+      ARROW_OK_OR_RAISE(dst_builder.AppendValues(edge_dsts_[e_label]));
+      ARROW_OK_OR_RAISE(dst_builder.Finish(&dsts[e_label]));
+      ARROW_OK_ASSIGN_OR_RAISE(tables[e_label],
+                               arrow::ConcatenateTables(edge_tables_[e_label]));
+    }
+    BOOST_LEAF_AUTO(frag_id, fragment_->AppendEdges(client, srcs, dsts,
+                                                    tables, concurrency));
+    std::shared_ptr<fragment_t> fragment;
+    VY_OK_OR_RAISE(client.GetObject(frag_id, fragment));
+    reset(fragment);
+    return frag_id;
+  }
+
+ private:
+  void reset(const std::shared_ptr<fragment_t>& fragment) {
+    fragment_ = fragment;
+    label_id_t e_label_num = fragment_->edge_label_num();
+    base_edge_nums_.resize(e_label_num);
+    for (label_id_t e_label = 0; e_label < e_label_num; ++e_label) {
+      base_edge_nums_[e_label] =
+          fragment_->edge_data_table(e_label)->num_rows();
+    }
+    oe_deltas_.clear();
+    oe_deltas_.resize(e_label_num);
+    ie_deltas_.clear();
+    ie_deltas_.resize(e_label_num);
+    edge_srcs_.clear();
+    edge_srcs_.resize(e_label_num);
+    edge_dsts_.clear();
+    edge_dsts_.resize(e_label_num);
+    edge_tables_.clear();
+    edge_tables_.resize(e_label_num);
+  }
+
+  static const std::vector<nbr_unit_t>* find(
+      const std::unordered_map<vid_t, std::vector<nbr_unit_t>>& deltas,
+      const vid_t v) {
+    auto iter = deltas.find(v);
+    return iter == deltas.end() ? nullptr : &iter->second;
+  }
+
+  // returns the chunk that contains the row, and the row index in the chunk
+  template <typename ARRAY_T>
+  static std::shared_ptr<ARRAY_T> locate(
+      const std::shared_ptr<arrow::Table>& table, prop_id_t prop,
+      int64_t& index) {
+    auto column = table->column(prop);
+    for (auto const& chunk : column->chunks()) {
+      if (index < chunk->length()) {
+        return std::dynamic_pointer_cast<ARRAY_T>(chunk);
+      }
+      index -= chunk->length();
+    }
+    return nullptr;
+  }
+
+  std::shared_ptr<fragment_t> fragment_;
+  std::vector<int64_t> base_edge_nums_;
+
+  // e_label -> vertex -> the appended neighbors
+  std::vector<std::unordered_map<vid_t, std::vector<nbr_unit_t>>> oe_deltas_,
+      ie_deltas_;
+  // e_label -> the appended edges, and the properties
+  std::vector<std::vector<vid_t>> edge_srcs_, edge_dsts_;
+  std::vector<std::vector<std::shared_ptr<arrow::Table>>> edge_tables_;
+};
+
+}  // namespace vineyard
+
+#endif  // MODULES_GRAPH_FRAGMENT_ARROW_FRAGMENT_DELTA_H_
@@ -16,10 +16,15 @@ limitations under the License.
 #ifndef MODULES_GRAPH_FRAGMENT_ARROW_FRAGMENT_GROUP_H_
 #define MODULES_GRAPH_FRAGMENT_ARROW_FRAGMENT_GROUP_H_
 
+#include <algorithm>
+#include <list>
+#include <map>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <type_traits>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "client/client.h"
@@ -31,6 +36,36 @@ namespace vineyard {
 
 class ArrowFragmentGroupBuilder;
 
+/**
+ * @brief The sizes of a fragment, the outer vertices are the mirrors of
+ * vertices owned by other fragments.
+ */
+struct FragmentLoad {
+  size_t inner_vertex_num = 0;
+  size_t outer_vertex_num = 0;
+  size_t edge_num = 0;
+};
+
+/**
+ * @brief The dense fid -> (instance id, fragment object id) table of a
+ * fragment group, see also `ArrowFragmentGroup::GetFragmentTable`.
+ */
+struct FragmentTable {
+  std::vector<uint64_t> instances;
+  std::vector<ObjectID> fragments;
+
+  fid_t size() const { return static_cast<fid_t>(fragments.size()); }
+
+  bool Locate(fid_t fid, uint64_t& instance_id, ObjectID& frag_id) const {
+    if (fid >= size()) {
+      return false;
+    }
+    instance_id = instances[fid];
+    frag_id = fragments[fid];
+    return true;
+  }
+};
+
 class ArrowFragmentGroup : public Registered<ArrowFragmentGroup>, GlobalObject {
  public:
   static std::unique_ptr<vineyard::Object> Create() __attribute__((used)) {
@@ -51,6 +86,70 @@ class ArrowFragmentGroup : public Registered<ArrowFragmentGroup>, GlobalObject {
     return fragment_locations_;
   }
 
+  /**
+   * @brief The fid -> (instance id, fragment object id) table.
+   */
+  const FragmentTable& Table() const { return table_; }
+
+  /**
+   * @brief Get the fid -> (instance id, fragment object id) table of the
+   * group, which is cached in the process as the groups are immutable, thus
+   * looking up the fragments doesn't go through the metadata (and the
+   * construction of the group) every time.
+   */
+  static Status GetFragmentTable(Client& client, const ObjectID group_id,
+                                 std::shared_ptr<const FragmentTable>& table) {
+    static constexpr size_t kCachedGroups = 64;
+    static std::mutex mutex;
+    static std::list<std::pair<ObjectID, std::shared_ptr<const FragmentTable>>>
+        cached;
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      for (auto iter = cached.begin(); iter != cached.end(); ++iter) {
+        if (iter->first == group_id) {
+          table = iter->second;
+          cached.splice(cached.begin(), cached, iter);
+          return Status::OK();
+        }
+      }
+    }
+    std::shared_ptr<ArrowFragmentGroup> group;
+    RETURN_ON_ERROR(client.GetObject(group_id, group));
+    RETURN_ON_ASSERT(group != nullptr, "Not a fragment group: " +
+                                           ObjectIDToString(group_id));
+    table = std::make_shared<const FragmentTable>(group->Table());
+    std::lock_guard<std::mutex> lock(mutex);
+    cached.emplace_front(group_id, table);
+    if (cached.size() > kCachedGroups) {
+      cached.pop_back();
+    }
+    return Status::OK();
+  }
+  /**
+   * @brief The sizes of each fragment, empty for groups that were built
+   * without them.
+   */
+  const std::unordered_map<fid_t, FragmentLoad>& FragmentLoads() const {
+    return fragment_loads_;
+  }
+
+  /**
+   * @brief The ratio of the maximum to the average number of edges among
+   * fragments, i.e., 1.0 for a perfectly balanced partitioning.
+   */
+  double LoadImbalance() const {
+    size_t max_edge_num = 0, total_edge_num = 0;
+    for (auto const& kv : fragment_loads_) {
+      max_edge_num = std::max(max_edge_num, kv.second.edge_num);
+      total_edge_num += kv.second.edge_num;
+    }
+    if (total_edge_num == 0) {
+      return 1.0;
+    }
+    return static_cast<double>(max_edge_num) * fragment_loads_.size() /
+           total_edge_num;
+  }
+
   void Construct(const vineyard::ObjectMeta& meta) override {
     this->meta_ = meta;
     this->id_ = meta.GetId();
@@ -68,15 +167,40 @@ class ArrowFragmentGroup : public Registered<ArrowFragmentGroup>, GlobalObject {
           meta.GetKeyValue<fid_t>("fid_" + std::to_string(idx)),
           meta.GetKeyValue<uint64_t>("frag_instance_id_" +
                                      std::to_string(idx)));
+      if (meta.MetaData().contains("frag_edge_num_" + std::to_string(idx))) {
+        FragmentLoad load;
+        load.inner_vertex_num = meta.GetKeyValue<size_t>(
+            "frag_inner_vertex_num_" + std::to_string(idx));
+        load.outer_vertex_num = meta.GetKeyValue<size_t>(
+            "frag_outer_vertex_num_" + std::to_string(idx));
+        load.edge_num =
+            meta.GetKeyValue<size_t>("frag_edge_num_" + std::to_string(idx));
+        fragment_loads_.emplace(
+            meta.GetKeyValue<fid_t>("fid_" + std::to_string(idx)), load);
+      }
     }
+    initTable();
   }
 
  private:
+  void initTable() {
+    table_.instances.assign(total_frag_num_, UnspecifiedInstanceID());
+    table_.fragments.assign(total_frag_num_, InvalidObjectID());
+    for (auto const& kv : fragments_) {
+      if (kv.first < total_frag_num_) {
+        table_.fragments[kv.first] = kv.second;
+        table_.instances[kv.first] = fragment_locations_[kv.first];
+      }
+    }
+  }
+
   fid_t total_frag_num_;
   property_graph_types::LABEL_ID_TYPE vertex_label_num_;
   property_graph_types::LABEL_ID_TYPE edge_label_num_;
   std::unordered_map<fid_t, vineyard::ObjectID> fragments_;
   std::unordered_map<fid_t, uint64_t> fragment_locations_;
+  std::unordered_map<fid_t, FragmentLoad> fragment_loads_;
+  FragmentTable table_;
 
   friend ArrowFragmentGroupBuilder;
 };
@@ -95,11 +219,20 @@ class ArrowFragmentGroupBuilder : public ObjectBuilder {
   void set_edge_label_num(property_graph_types::LABEL_ID_TYPE edge_label_num) {
     edge_label_num_ = edge_label_num;
   }
+  /**
+   * @brief Register a fragment to the group, fragments can be registered
+   * concurrently as soon as they are sealed.
+   */
   void AddFragmentObject(fid_t fid, vineyard::ObjectID object_id,
                          uint64_t instance_id) {
+    std::lock_guard<std::mutex> lock(mutex_);
     fragments_.emplace(fid, object_id);
     fragment_locations_.emplace(fid, instance_id);
   }
+  void SetFragmentLoad(fid_t fid, const FragmentLoad& load) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    fragment_loads_[fid] = load;
+  }
 
   vineyard::Status Build(vineyard::Client& client) override {
     return vineyard::Status::OK();
@@ -110,12 +243,16 @@ class ArrowFragmentGroupBuilder : public ObjectBuilder {
     ENSURE_NOT_SEALED(this);
 
     VINEYARD_CHECK_OK(this->Build(client));
+    std::lock_guard<std::mutex> lock(mutex_);
 
     auto fg = std::make_shared<ArrowFragmentGroup>();
     fg->total_frag_num_ = total_frag_num_;
     fg->vertex_label_num_ = vertex_label_num_;
     fg->edge_label_num_ = edge_label_num_;
     fg->fragments_ = fragments_;
+    fg->fragment_locations_ = fragment_locations_;
+    fg->fragment_loads_ = fragment_loads_;
+    fg->initTable();
     if (std::is_base_of<GlobalObject, ArrowFragmentGroup>::value) {
       fg->meta_.SetGlobal(true);
     }
@@ -130,6 +267,15 @@ class ArrowFragmentGroupBuilder : public ObjectBuilder {
       fg->meta_.AddKeyValue("frag_instance_id_" + std::to_string(idx),
                             fragment_locations_[kv.first]);
       fg->meta_.AddMember("frag_object_id_" + std::to_string(idx), kv.second);
+      auto load = fragment_loads_.find(kv.first);
+      if (load != fragment_loads_.end()) {
+        fg->meta_.AddKeyValue("frag_inner_vertex_num_" + std::to_string(idx),
+                              load->second.inner_vertex_num);
+        fg->meta_.AddKeyValue("frag_outer_vertex_num_" + std::to_string(idx),
+                              load->second.outer_vertex_num);
+        fg->meta_.AddKeyValue("frag_edge_num_" + std::to_string(idx),
+                              load->second.edge_num);
+      }
       idx += 1;
     }
 
@@ -146,43 +292,57 @@ class ArrowFragmentGroupBuilder : public ObjectBuilder {
   property_graph_types::LABEL_ID_TYPE edge_label_num_;
   std::unordered_map<fid_t, ObjectID> fragments_;
   std::unordered_map<fid_t, uint64_t> fragment_locations_;
+  std::unordered_map<fid_t, FragmentLoad> fragment_loads_;
+  std::mutex mutex_;
 };
 
 inline boost::leaf::result<ObjectID> ConstructFragmentGroup(
     Client& client, ObjectID frag_id, const grape::CommSpec& comm_spec) {
-  ObjectID group_object_id;
-  uint64_t instance_id = client.instance_id();
-
-  MPI_Barrier(comm_spec.comm());
-  VINEYARD_DISCARD(client.SyncMetaData());
+  // everything the root needs from a worker, gathered in a single collective,
+  // which also makes sure that all fragments have been sealed.
+  struct registration_t {
+    uint64_t instance_id;
+    ObjectID frag_id;
+    FragmentLoad load;
+    typename ArrowFragmentBase::label_id_t vertex_label_num;
+    typename ArrowFragmentBase::label_id_t edge_label_num;
+  };
+
+  registration_t registration;
+  registration.instance_id = client.instance_id();
+  registration.frag_id = frag_id;
+  {
+    auto fragment =
+        std::dynamic_pointer_cast<ArrowFragmentBase>(client.GetObject(frag_id));
+    registration.load.inner_vertex_num = fragment->local_inner_vertex_num();
+    registration.load.outer_vertex_num = fragment->local_outer_vertex_num();
+    registration.load.edge_num = fragment->local_edge_num();
+    auto& meta = fragment->meta();
+    registration.vertex_label_num =
+        meta.GetKeyValue<typename ArrowFragmentBase::label_id_t>(
+            "vertex_label_num");
+    registration.edge_label_num =
+        meta.GetKeyValue<typename ArrowFragmentBase::label_id_t>(
+            "edge_label_num");
+  }
 
+  ObjectID group_object_id;
   if (comm_spec.worker_id() == 0) {
-    std::vector<uint64_t> gathered_instance_ids(comm_spec.worker_num());
-    std::vector<ObjectID> gathered_object_ids(comm_spec.worker_num());
-
-    MPI_Gather(&instance_id, sizeof(uint64_t), MPI_CHAR,
-               &gathered_instance_ids[0], sizeof(uint64_t), MPI_CHAR, 0,
-               comm_spec.comm());
+    std::vector<registration_t> gathered(comm_spec.worker_num());
+    MPI_Gather(&registration, sizeof(registration_t), MPI_CHAR, &gathered[0],
+               sizeof(registration_t), MPI_CHAR, 0, comm_spec.comm());
 
-    MPI_Gather(&frag_id, sizeof(ObjectID), MPI_CHAR, &gathered_object_ids[0],
-               sizeof(ObjectID), MPI_CHAR, 0, comm_spec.comm());
+    // the fragments of other workers are visible after the sync
+    VINEYARD_DISCARD(client.SyncMetaData());
 
     ArrowFragmentGroupBuilder builder;
     builder.set_total_frag_num(comm_spec.fnum());
-    auto fragment =
-        std::dynamic_pointer_cast<ArrowFragmentBase>(client.GetObject(frag_id));
-    auto& meta = fragment->meta();
-
-    builder.set_vertex_label_num(
-        meta.GetKeyValue<typename ArrowFragmentBase::label_id_t>(
-            "vertex_label_num"));
-    builder.set_edge_label_num(
-        meta.GetKeyValue<typename ArrowFragmentBase::label_id_t>(
-            "edge_label_num"));
+    builder.set_vertex_label_num(registration.vertex_label_num);
+    builder.set_edge_label_num(registration.edge_label_num);
     for (fid_t i = 0; i < comm_spec.fnum(); ++i) {
-      builder.AddFragmentObject(
-          i, gathered_object_ids[comm_spec.FragToWorker(i)],
-          gathered_instance_ids[comm_spec.FragToWorker(i)]);
+      auto const& item = gathered[comm_spec.FragToWorker(i)];
+      builder.AddFragmentObject(i, item.frag_id, item.instance_id);
+      builder.SetFragmentLoad(i, item.load);
     }
 
     auto group_object =
@@ -193,20 +353,72 @@ inline boost::leaf::result<ObjectID> ConstructFragmentGroup(
     MPI_Bcast(&group_object_id, sizeof(ObjectID), MPI_CHAR, 0,
               comm_spec.comm());
   } else {
-    MPI_Gather(&instance_id, sizeof(uint64_t), MPI_CHAR, NULL, sizeof(uint64_t),
-               MPI_CHAR, 0, comm_spec.comm());
-    MPI_Gather(&frag_id, sizeof(ObjectID), MPI_CHAR, NULL, sizeof(ObjectID),
-               MPI_CHAR, 0, comm_spec.comm());
-
+    MPI_Gather(&registration, sizeof(registration_t), MPI_CHAR, NULL,
+               sizeof(registration_t), MPI_CHAR, 0, comm_spec.comm());
     MPI_Bcast(&group_object_id, sizeof(ObjectID), MPI_CHAR, 0,
               comm_spec.comm());
+    // the group is visible after the sync
+    VINEYARD_DISCARD(client.SyncMetaData());
   }
-
-  MPI_Barrier(comm_spec.comm());
-  VINEYARD_DISCARD(client.SyncMetaData());
   return group_object_id;
 }
 
+/**
+ * @brief Move the fragments of the group to the given instances, and create
+ * a new group that refers the migrated fragments. The fragments are
+ * transferred in parallel by `Client::Migrate`, and the group metadata is
+ * rewritten once after all transfers have finished.
+ *
+ * @param placement The target instance of the fragments to move, the other
+ * fragments are kept where they are.
+ */
+inline boost::leaf::result<ObjectID> RebalanceFragmentGroup(
+    Client& client, ObjectID group_id,
+    const std::map<fid_t, InstanceID>& placement,
+    const MigrationOptions& options = MigrationOptions()) {
+  auto group =
+      std::dynamic_pointer_cast<ArrowFragmentGroup>(client.GetObject(group_id));
+  if (group == nullptr) {
+    RETURN_GS_ERROR(ErrorCode::kInvalidValueError,
+                    "Object " + ObjectIDToString(group_id) +
+                        " is not a fragment group");
+  }
+  std::map<ObjectID, InstanceID> objects;
+  for (auto const& kv : placement) {
+    auto iter = group->Fragments().find(kv.first);
+    if (iter == group->Fragments().end()) {
+      RETURN_GS_ERROR(ErrorCode::kInvalidValueError,
+                      "Fragment " + std::to_string(kv.first) +
+                          " doesn't exist in the group");
+    }
+    objects[iter->second] = kv.second;
+  }
+  std::map<ObjectID, ObjectID> migrated;
+  VY_OK_OR_RAISE(client.Migrate(objects, migrated, options));
+
+  ArrowFragmentGroupBuilder builder;
+  builder.set_total_frag_num(group->total_frag_num());
+  builder.set_vertex_label_num(group->vertex_label_num());
+  builder.set_edge_label_num(group->edge_label_num());
+  for (auto const& kv : group->Fragments()) {
+    auto target = placement.find(kv.first);
+    if (target == placement.end()) {
+      builder.AddFragmentObject(kv.first, kv.second,
+                                group->FragmentLocations().at(kv.first));
+    } else {
+      builder.AddFragmentObject(kv.first, migrated.at(kv.second),
+                                target->second);
+    }
+  }
+  for (auto const& kv : group->FragmentLoads()) {
+    builder.SetFragmentLoad(kv.first, kv.second);
+  }
+  auto group_object =
+      std::dynamic_pointer_cast<ArrowFragmentGroup>(builder.Seal(client));
+  VY_OK_OR_RAISE(client.Persist(group_object->id()));
+  return group_object->id();
+}
+
 }  // namespace vineyard
 
 #endif  // MODULES_GRAPH_FRAGMENT_ARROW_FRAGMENT_GROUP_H_
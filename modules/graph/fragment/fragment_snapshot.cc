@@ -0,0 +1,317 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+
+#include "graph/fragment/fragment_snapshot.h"
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "client/ds/blob.h"
+#include "common/util/json.h"
+#include "graph/utils/thread_group.h"
+
+namespace vineyard {
+
+namespace detail {
+
+constexpr int kFragmentSnapshotVersion = 1;
+constexpr uint64_t kFragmentSnapshotAlignment = 64;
+constexpr const char* kFragmentSnapshotIndex = "index.json";
+
+static inline uint64_t align_up(const uint64_t value) {
+  return (value + kFragmentSnapshotAlignment - 1) /
+         kFragmentSnapshotAlignment * kFragmentSnapshotAlignment;
+}
+
+static Status write_all(const int fd, const std::string& path,
+                        const uint8_t* data, const size_t size,
+                        const size_t offset) {
+  size_t written = 0;
+  while (written < size) {
+    ssize_t nbytes =
+        pwrite(fd, data + written, size - written, offset + written);
+    if (nbytes == -1) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return Status::IOError("Failed to write snapshot file '" + path +
+                             "': " + strerror(errno));
+    }
+    written += nbytes;
+  }
+  return Status::OK();
+}
+
+static Status read_all(const int fd, const std::string& path, uint8_t* data,
+                       const size_t size, const size_t offset) {
+  size_t nread = 0;
+  while (nread < size) {
+    ssize_t nbytes = pread(fd, data + nread, size - nread, offset + nread);
+    if (nbytes == -1 && errno == EINTR) {
+      continue;
+    }
+    if (nbytes == 0) {
+      return Status::IOError("The snapshot file '" + path + "' is truncated");
+    }
+    if (nbytes == -1) {
+      return Status::IOError("Failed to read snapshot file '" + path +
+                             "': " + strerror(errno));
+    }
+    nread += nbytes;
+  }
+  return Status::OK();
+}
+
+static inline bool is_member(const json& item) {
+  return item.is_object() && item.contains("id");
+}
+
+static inline ObjectID member_id(const json& item) {
+  return VYObjectIDFromString(item["id"].get_ref<std::string const&>());
+}
+
+// collects the blobs of the tree, in the order of being visited
+static void collect_blobs(const json& tree, std::vector<ObjectID>& blobs) {
+  for (auto const& item : tree) {
+    if (!is_member(item)) {
+      continue;
+    }
+    ObjectID id = member_id(item);
+    if (IsBlob(id)) {
+      blobs.emplace_back(id);
+    } else {
+      collect_blobs(item, blobs);
+    }
+  }
+}
+
+// recreates the metadata of the tree on top of the restored blobs, shared
+// members are recreated once.
+static Status restore_meta(Client& client, const json& tree,
+                           std::map<ObjectID, ObjectMeta>& restored,
+                           ObjectMeta& meta) {
+  ObjectID id = member_id(tree);
+  auto iter = restored.find(id);
+  if (iter != restored.end()) {
+    meta = iter->second;
+    return Status::OK();
+  }
+  RETURN_ON_ASSERT(!IsBlob(id), "The blob " + ObjectIDToString(id) +
+                                    " is not found in the snapshot");
+
+  // the keys that are regenerated when creating the metadata
+  static const std::set<std::string> reserved = {
+      "id",       "signature", "instance_id", "transient",
+      "typename", "typeid",    "global",      "nbytes"};
+
+  ObjectMeta target;
+  target.SetTypeName(tree["typename"].get_ref<std::string const&>());
+  for (auto item = tree.begin(); item != tree.end(); ++item) {
+    if (is_member(item.value())) {
+      ObjectMeta member;
+      RETURN_ON_ERROR(restore_meta(client, item.value(), restored, member));
+      target.AddMember(item.key(), member);
+      continue;
+    }
+    if (reserved.find(item.key()) == reserved.end()) {
+      target.MutMetaData()[item.key()] = item.value();
+    }
+  }
+  target.SetNBytes(tree.value("nbytes", static_cast<size_t>(0)));
+  ObjectID target_id = InvalidObjectID();
+  RETURN_ON_ERROR(client.CreateMetaData(target, target_id));
+  restored.emplace(id, target);
+  meta = target;
+  return Status::OK();
+}
+
+}  // namespace detail
+
+Status WriteFragmentSnapshot(Client& client, const ObjectID id,
+                             const std::string& path, const int concurrency) {
+  ObjectMeta meta;
+  RETURN_ON_ERROR(client.GetMetaData(id, meta));
+  const json& tree = meta.MetaData();
+  if (mkdir(path.c_str(), 0755) != 0 && errno != EEXIST) {
+    return Status::IOError("Failed to create the snapshot directory '" +
+                           path + "': " + strerror(errno));
+  }
+
+  // groups the blobs by the top-level members, i.e., the tables and the CSR
+  // of every label are written into their own files.
+  std::vector<std::string> files;
+  std::vector<std::vector<ObjectID>> groups;
+  std::set<ObjectID> visited;
+  for (auto item = tree.begin(); item != tree.end(); ++item) {
+    if (!detail::is_member(item.value())) {
+      continue;
+    }
+    std::vector<ObjectID> blobs, group;
+    if (IsBlob(detail::member_id(item.value()))) {
+      blobs.emplace_back(detail::member_id(item.value()));
+    } else {
+      detail::collect_blobs(item.value(), blobs);
+    }
+    for (auto const& blob : blobs) {
+      if (blob != EmptyBlobID() && visited.emplace(blob).second) {
+        group.emplace_back(blob);
+      }
+    }
+    if (!group.empty()) {
+      files.emplace_back(item.key() + ".bin");
+      groups.emplace_back(std::move(group));
+    }
+  }
+
+  json locations = json::object();
+  std::vector<std::vector<std::shared_ptr<arrow::Buffer>>> buffers(
+      groups.size());
+  std::vector<std::vector<uint64_t>> offsets(groups.size());
+  for (size_t index = 0; index < groups.size(); ++index) {
+    uint64_t offset = 0;
+    for (auto const& blob : groups[index]) {
+      std::shared_ptr<arrow::Buffer> buffer;
+      RETURN_ON_ERROR(meta.GetBuffer(blob, buffer));
+      RETURN_ON_ASSERT(buffer != nullptr, "The blob " + ObjectIDToString(blob) +
+                                              " is not local");
+      locations[ObjectIDToString(blob)] = {
+          {"file", files[index]},
+          {"offset", offset},
+          {"size", static_cast<uint64_t>(buffer->size())}};
+      buffers[index].emplace_back(buffer);
+      offsets[index].emplace_back(offset);
+      offset = detail::align_up(offset + buffer->size());
+    }
+  }
+
+  ThreadGroup tg(std::max(concurrency, 1));
+  for (size_t index = 0; index < groups.size(); ++index) {
+    tg.AddTask([&, index]() -> Status {
+      std::string file = path + "/" + files[index];
+      int fd = open(file.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+      if (fd == -1) {
+        return Status::IOError("Failed to open snapshot file '" + file +
+                               "': " + strerror(errno));
+      }
+      Status status;
+      for (size_t k = 0; k < buffers[index].size() && status.ok(); ++k) {
+        auto& buffer = buffers[index][k];
+        status = detail::write_all(fd, file, buffer->data(), buffer->size(),
+                                   offsets[index][k]);
+      }
+      close(fd);
+      return status;
+    });
+  }
+  for (auto& status : tg.TakeResults()) {
+    RETURN_ON_ERROR(status);
+  }
+
+  json index;
+  index["version"] = detail::kFragmentSnapshotVersion;
+  index["alignment"] = detail::kFragmentSnapshotAlignment;
+  index["meta"] = tree;
+  index["blobs"] = locations;
+  std::ofstream stream(path + "/" + detail::kFragmentSnapshotIndex);
+  stream << index.dump();
+  if (!stream.good()) {
+    return Status::IOError("Failed to write the snapshot index of '" + path +
+                           "'");
+  }
+  return Status::OK();
+}
+
+Status ReadFragmentSnapshot(Client& client, const std::string& path,
+                            ObjectID& id, const int concurrency) {
+  json index;
+  {
+    std::ifstream stream(path + "/" + detail::kFragmentSnapshotIndex);
+    RETURN_ON_ASSERT(stream.good(),
+                     "Failed to open the snapshot index of '" + path + "'");
+    index = json::parse(stream, nullptr, false);
+  }
+  RETURN_ON_ASSERT(!index.is_discarded() && index.is_object() &&
+                       index.value("version", 0) ==
+                           detail::kFragmentSnapshotVersion,
+                   "Invalid snapshot index of '" + path + "'");
+
+  // the blobs in every file
+  std::map<std::string, std::vector<std::pair<ObjectID, const json*>>> files;
+  const json& locations = index["blobs"];
+  for (auto item = locations.begin(); item != locations.end(); ++item) {
+    files[item.value()["file"].get<std::string>()].emplace_back(
+        ObjectIDFromString(item.key()), &item.value());
+  }
+
+  std::mutex mutex;
+  std::map<ObjectID, ObjectMeta> restored;
+  restored.emplace(EmptyBlobID(), Blob::MakeEmpty(client)->meta());
+  ThreadGroup tg(std::max(concurrency, 1));
+  for (auto const& item : files) {
+    tg.AddTask([&](const std::string& file_name) -> Status {
+      std::string file = path + "/" + file_name;
+      int fd = open(file.c_str(), O_RDONLY);
+      if (fd == -1) {
+        return Status::IOError("Failed to open snapshot file '" + file +
+                               "': " + strerror(errno));
+      }
+      Status status;
+      for (auto const& blob : files.at(file_name)) {
+        size_t size = (*blob.second)["size"].get<size_t>();
+        size_t offset = (*blob.second)["offset"].get<size_t>();
+        std::unique_ptr<BlobWriter> writer;
+        status = client.CreateBlob(size, writer);
+        if (status.ok()) {
+          // reads into the shared memory directly
+          status = detail::read_all(fd, file,
+                                    reinterpret_cast<uint8_t*>(writer->data()),
+                                    size, offset);
+        }
+        if (!status.ok()) {
+          break;
+        }
+        auto sealed = writer->Seal(client);
+        std::lock_guard<std::mutex> lock(mutex);
+        restored.emplace(blob.first, sealed->meta());
+      }
+      close(fd);
+      return status;
+    }, item.first);
+  }
+  for (auto& status : tg.TakeResults()) {
+    RETURN_ON_ERROR(status);
+  }
+
+  ObjectMeta meta;
+  RETURN_ON_ERROR(detail::restore_meta(client, index["meta"], restored, meta));
+  id = meta.GetId();
+  return Status::OK();
+}
+
+}  // namespace vineyard
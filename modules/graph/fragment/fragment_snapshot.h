@@ -0,0 +1,89 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+
+#ifndef MODULES_GRAPH_FRAGMENT_FRAGMENT_SNAPSHOT_H_
+#define MODULES_GRAPH_FRAGMENT_FRAGMENT_SNAPSHOT_H_
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "boost/leaf/all.hpp"
+
+#include "client/client.h"
+#include "common/util/status.h"
+#include "common/util/uuid.h"
+
+#include "graph/fragment/arrow_fragment.h"
+#include "graph/fragment/property_graph_types.h"
+#include "graph/utils/error.h"
+
+namespace vineyard {
+
+/**
+ * @brief Write a fragment (or any other object) in the local vineyard server
+ * into the snapshot directory `path`, from which the fragment can be
+ * restored without loading the raw data again.
+ *
+ * The blobs are grouped by the top-level members of the fragment, e.g., the
+ * vertex table, or the CSR of a label, into one file per member, where the
+ * blobs are aligned to be mmap-able. The files are written in parallel, and
+ * an "index.json" keeps the metadata of the fragment and the locations of
+ * the blobs.
+ */
+Status WriteFragmentSnapshot(Client& client, const ObjectID id,
+                             const std::string& path,
+                             const int concurrency = 8);
+
+/**
+ * @brief Restore the fragment from the snapshot directory `path` into the
+ * local vineyard server, the files are read in parallel and directly into
+ * the newly created blobs.
+ *
+ * @param id The id of the restored fragment.
+ */
+Status ReadFragmentSnapshot(Client& client, const std::string& path,
+                            ObjectID& id, const int concurrency = 8);
+
+/**
+ * @brief Restore the fragment from the snapshot, and project it to the given
+ * vertex/edge labels and properties, see also `ArrowFragment::Project`.
+ */
+template <typename OID_T, typename VID_T>
+boost::leaf::result<ObjectID> ReadFragmentSnapshot(
+    Client& client, const std::string& path,
+    std::map<property_graph_types::LABEL_ID_TYPE,
+             std::vector<property_graph_types::LABEL_ID_TYPE>>
+        vertices,
+    std::map<property_graph_types::LABEL_ID_TYPE,
+             std::vector<property_graph_types::LABEL_ID_TYPE>>
+        edges,
+    const int concurrency = 8) {
+  ObjectID restored = InvalidObjectID();
+  VY_OK_OR_RAISE(ReadFragmentSnapshot(client, path, restored, concurrency));
+  auto fragment = std::dynamic_pointer_cast<ArrowFragment<OID_T, VID_T>>(
+      client.GetObject(restored));
+  if (fragment == nullptr) {
+    RETURN_GS_ERROR(ErrorCode::kInvalidValueError,
+                    "The snapshot is not a fragment of the given types");
+  }
+  return fragment->Project(client, vertices, edges);
+}
+
+}  // namespace vineyard
+
+#endif  // MODULES_GRAPH_FRAGMENT_FRAGMENT_SNAPSHOT_H_
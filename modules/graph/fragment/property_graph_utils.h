@@ -20,6 +20,7 @@ limitations under the License.
 #include <map>
 #include <memory>
 #include <string>
+#include <type_traits>
 #include <unordered_map>
 #include <utility>
 #include <vector>
@@ -38,6 +39,7 @@ limitations under the License.
 #include "graph/fragment/property_graph_types.h"
 #include "graph/utils/error.h"
 #include "graph/utils/mpi_utils.h"
+#include "graph/utils/thread_pool.h"
 
 namespace vineyard {
 
@@ -234,6 +236,35 @@ class VertexDataColumn<std::string, VID_T> {
   std::shared_ptr<arrow::LargeStringArray> array_;
 };
 
+/**
+ * @brief A read-only view of contiguous values, e.g., a property of the inner
+ * vertices of a label, which is indexed by the offsets of vertices (rather
+ * than the vertices).
+ */
+template <typename DATA_T>
+class DataSpan {
+ public:
+  DataSpan() : data_(nullptr), size_(0) {}
+
+  DataSpan(const DATA_T* data, size_t size) : data_(data), size_(size) {}
+
+  const DATA_T* data() const { return data_; }
+
+  size_t size() const { return size_; }
+
+  bool empty() const { return size_ == 0; }
+
+  const DATA_T& operator[](size_t index) const { return data_[index]; }
+
+  const DATA_T* begin() const { return data_; }
+
+  const DATA_T* end() const { return data_ + size_; }
+
+ private:
+  const DATA_T* data_;
+  size_t size_;
+};
+
 template <typename T>
 struct ValueGetter {
   inline static T Value(const void* data, int64_t offset) {
@@ -509,6 +540,314 @@ class AdjList {
 template <typename VID_T>
 using AdjListDefault = AdjList<VID_T, property_graph_types::EID_TYPE>;
 
+/**
+ * @brief PrefetchNbr behaves like `Nbr`, and software-prefetches the values of
+ * a (fixed-width) edge property for the neighbors `distance` ahead, as the
+ * values are scattered in the column by the edge ids, see also
+ * `PrefetchAdjList`.
+ */
+template <typename VID_T, typename EID_T, typename DATA_T>
+struct PrefetchNbr {
+ private:
+  using prop_id_t = property_graph_types::PROP_ID_TYPE;
+
+ public:
+  PrefetchNbr()
+      : nbr_(NULL),
+        end_(NULL),
+        values_(nullptr),
+        distance_(0),
+        edata_arrays_(nullptr) {}
+  PrefetchNbr(const NbrUnit<VID_T, EID_T>* nbr,
+              const NbrUnit<VID_T, EID_T>* end, const DATA_T* values,
+              size_t distance, const void** edata_arrays)
+      : nbr_(nbr),
+        end_(end),
+        values_(values),
+        distance_(distance),
+        edata_arrays_(edata_arrays) {}
+
+  grape::Vertex<VID_T> neighbor() const {
+    return grape::Vertex<VID_T>(nbr_->vid);
+  }
+
+  grape::Vertex<VID_T> get_neighbor() const {
+    return grape::Vertex<VID_T>(nbr_->vid);
+  }
+
+  EID_T edge_id() const { return nbr_->eid; }
+
+  /**
+   * @brief The value of the prefetched property.
+   */
+  DATA_T data() const { return values_[nbr_->eid]; }
+
+  template <typename T>
+  T get_data(prop_id_t prop_id) const {
+    return ValueGetter<T>::Value(edata_arrays_[prop_id], nbr_->eid);
+  }
+
+  inline const PrefetchNbr& operator++() const {
+    ++nbr_;
+    if (distance_ < static_cast<size_t>(end_ - nbr_)) {
+      __builtin_prefetch(values_ + nbr_[distance_].eid, 0, 1);
+    }
+    return *this;
+  }
+
+  inline PrefetchNbr operator++(int) const {
+    PrefetchNbr ret(*this);
+    ++(*this);
+    return ret;
+  }
+
+  inline bool operator==(const PrefetchNbr& rhs) const {
+    return nbr_ == rhs.nbr_;
+  }
+  inline bool operator!=(const PrefetchNbr& rhs) const {
+    return nbr_ != rhs.nbr_;
+  }
+
+  inline const PrefetchNbr& operator*() const { return *this; }
+
+ private:
+  const mutable NbrUnit<VID_T, EID_T>* nbr_;
+  const NbrUnit<VID_T, EID_T>* end_;
+  const DATA_T* values_;
+  size_t distance_;
+  const void** edata_arrays_;
+};
+
+/**
+ * @brief PrefetchAdjList is an `AdjList` that prefetches the values of the
+ * given edge property during iteration, which is useful for algorithms that
+ * read one property of every edge, e.g., the weights in SSSP.
+ */
+template <typename VID_T, typename EID_T, typename DATA_T>
+class PrefetchAdjList {
+  static_assert(std::is_arithmetic<DATA_T>::value,
+                "Only the fixed-width properties can be prefetched");
+  using prop_id_t = property_graph_types::PROP_ID_TYPE;
+
+ public:
+  // enough to cover the latency of a cache miss in the neighbor loops
+  static constexpr size_t kDefaultPrefetchDistance = 8;
+
+  PrefetchAdjList()
+      : begin_(NULL),
+        end_(NULL),
+        values_(nullptr),
+        distance_(0),
+        edata_arrays_(nullptr) {}
+  PrefetchAdjList(const NbrUnit<VID_T, EID_T>* begin,
+                  const NbrUnit<VID_T, EID_T>* end, const void** edata_arrays,
+                  prop_id_t prop_id,
+                  size_t distance = kDefaultPrefetchDistance)
+      : begin_(begin),
+        end_(end),
+        values_(edata_arrays == nullptr
+                    ? nullptr
+                    : reinterpret_cast<const DATA_T*>(edata_arrays[prop_id])),
+        distance_(distance),
+        edata_arrays_(edata_arrays) {}
+
+  inline PrefetchNbr<VID_T, EID_T, DATA_T> begin() const {
+    size_t ahead = std::min(distance_, Size());
+    for (size_t i = 0; i < ahead; ++i) {
+      __builtin_prefetch(values_ + begin_[i].eid, 0, 1);
+    }
+    return PrefetchNbr<VID_T, EID_T, DATA_T>(begin_, end_, values_, distance_,
+                                             edata_arrays_);
+  }
+
+  inline PrefetchNbr<VID_T, EID_T, DATA_T> end() const {
+    return PrefetchNbr<VID_T, EID_T, DATA_T>(end_, end_, values_, distance_,
+                                             edata_arrays_);
+  }
+
+  inline size_t Size() const { return end_ - begin_; }
+
+  inline bool Empty() const { return end_ == begin_; }
+
+  inline bool NotEmpty() const { return end_ != begin_; }
+
+  size_t size() const { return end_ - begin_; }
+
+ private:
+  const NbrUnit<VID_T, EID_T>* begin_;
+  const NbrUnit<VID_T, EID_T>* end_;
+  const DATA_T* values_;
+  size_t distance_;
+  const void** edata_arrays_;
+};
+
+/**
+ * @brief Varints (LEB128) used by the compressed adjacency lists, see also
+ * `generate_compressed_csr`.
+ */
+inline uint8_t* encode_varint(uint64_t value, uint8_t* ptr) {
+  while (value >= 0x80) {
+    *ptr++ = static_cast<uint8_t>(value | 0x80);
+    value >>= 7;
+  }
+  *ptr++ = static_cast<uint8_t>(value);
+  return ptr;
+}
+
+inline const uint8_t* decode_varint(const uint8_t* ptr, uint64_t& value) {
+  // fast path: the deltas of sorted neighbors are mostly small
+  if (*ptr < 0x80) {
+    value = *ptr;
+    return ptr + 1;
+  }
+  value = 0;
+  for (int shift = 0;; shift += 7) {
+    uint64_t byte = *ptr++;
+    value |= (byte & 0x7f) << shift;
+    if (byte < 0x80) {
+      return ptr;
+    }
+  }
+}
+
+inline uint64_t zigzag_encode(int64_t value) {
+  return (static_cast<uint64_t>(value) << 1) ^
+         static_cast<uint64_t>(value >> 63);
+}
+
+inline int64_t zigzag_decode(uint64_t value) {
+  return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+/**
+ * @brief CompressedNbr decodes a compressed neighbor list on the fly, it
+ * provides the same accessors as `Nbr` and is used by `CompressedAdjList`.
+ *
+ * Every neighbor is encoded as the varint of the delta to the previous vid
+ * (the list is sorted by vids), followed by the zigzag varint of the delta to
+ * the previous eid.
+ */
+template <typename VID_T, typename EID_T>
+struct CompressedNbr {
+ private:
+  using prop_id_t = property_graph_types::PROP_ID_TYPE;
+
+ public:
+  CompressedNbr() : ptr_(NULL), remaining_(0), edata_arrays_(nullptr) {}
+  CompressedNbr(const uint8_t* ptr, size_t remaining,
+                const void** edata_arrays)
+      : ptr_(ptr), remaining_(remaining), edata_arrays_(edata_arrays) {
+    decode();
+  }
+
+  grape::Vertex<VID_T> neighbor() const { return grape::Vertex<VID_T>(vid_); }
+
+  grape::Vertex<VID_T> get_neighbor() const {
+    return grape::Vertex<VID_T>(vid_);
+  }
+
+  EID_T edge_id() const { return eid_; }
+
+  template <typename T>
+  T get_data(prop_id_t prop_id) const {
+    return ValueGetter<T>::Value(edata_arrays_[prop_id], eid_);
+  }
+
+  std::string get_str(prop_id_t prop_id) const {
+    return ValueGetter<std::string>::Value(edata_arrays_[prop_id], eid_);
+  }
+
+  double get_double(prop_id_t prop_id) const {
+    return ValueGetter<double>::Value(edata_arrays_[prop_id], eid_);
+  }
+
+  int64_t get_int(prop_id_t prop_id) const {
+    return ValueGetter<int64_t>::Value(edata_arrays_[prop_id], eid_);
+  }
+
+  inline const CompressedNbr& operator++() const {
+    --remaining_;
+    decode();
+    return *this;
+  }
+
+  inline CompressedNbr operator++(int) const {
+    CompressedNbr ret(*this);
+    ++(*this);
+    return ret;
+  }
+
+  // the iterators of the same list are compared by the number of the
+  // remaining neighbors.
+  inline bool operator==(const CompressedNbr& rhs) const {
+    return remaining_ == rhs.remaining_;
+  }
+  inline bool operator!=(const CompressedNbr& rhs) const {
+    return remaining_ != rhs.remaining_;
+  }
+
+  inline const CompressedNbr& operator*() const { return *this; }
+
+ private:
+  inline void decode() const {
+    if (remaining_ > 0) {
+      uint64_t delta;
+      ptr_ = decode_varint(ptr_, delta);
+      vid_ += static_cast<VID_T>(delta);
+      ptr_ = decode_varint(ptr_, delta);
+      eid_ += static_cast<EID_T>(zigzag_decode(delta));
+    }
+  }
+
+  mutable const uint8_t* ptr_;
+  mutable size_t remaining_;
+  mutable VID_T vid_ = 0;
+  mutable EID_T eid_ = 0;
+  const void** edata_arrays_;
+};
+
+template <typename VID_T>
+using CompressedNbrDefault =
+    CompressedNbr<VID_T, property_graph_types::EID_TYPE>;
+
+/**
+ * @brief CompressedAdjList is the counterpart of `AdjList` over the
+ * compressed neighbor lists generated by `generate_compressed_csr`.
+ */
+template <typename VID_T, typename EID_T>
+class CompressedAdjList {
+ public:
+  CompressedAdjList() : begin_(NULL), size_(0), edata_arrays_(nullptr) {}
+  CompressedAdjList(const uint8_t* begin, size_t size,
+                    const void** edata_arrays)
+      : begin_(begin), size_(size), edata_arrays_(edata_arrays) {}
+
+  inline CompressedNbr<VID_T, EID_T> begin() const {
+    return CompressedNbr<VID_T, EID_T>(begin_, size_, edata_arrays_);
+  }
+
+  inline CompressedNbr<VID_T, EID_T> end() const {
+    return CompressedNbr<VID_T, EID_T>(begin_, 0, edata_arrays_);
+  }
+
+  inline size_t Size() const { return size_; }
+
+  inline bool Empty() const { return size_ == 0; }
+
+  inline bool NotEmpty() const { return size_ != 0; }
+
+  size_t size() const { return size_; }
+
+ private:
+  const uint8_t* begin_;
+  size_t size_;
+  const void** edata_arrays_;
+};
+
+template <typename VID_T>
+using CompressedAdjListDefault =
+    CompressedAdjList<VID_T, property_graph_types::EID_TYPE>;
+
 /**
  * OffsetAdjList will offset the outer vertices' lid, makes it between "ivnum"
  * and "tvnum" instead of "ivnum ~ tvnum - outer vertex index"
@@ -863,31 +1202,36 @@ inline boost::leaf::result<std::shared_ptr<arrow::Table>> SyncSchema(
 template <typename ITER_T, typename FUNC_T>
 void parallel_for(const ITER_T& begin, const ITER_T& end, const FUNC_T& func,
                   int thread_num, size_t chunk = 0) {
-  std::vector<std::thread> threads(thread_num);
   size_t num = end - begin;
   if (chunk == 0) {
     chunk = (num + thread_num - 1) / thread_num;
   }
   std::atomic<size_t> cur(0);
-  for (int i = 0; i < thread_num; ++i) {
-    threads[i] = std::thread([&]() {
-      while (true) {
-        size_t x = cur.fetch_add(chunk);
-        if (x >= num) {
-          break;
-        }
-        size_t y = std::min(x + chunk, num);
-        ITER_T a = begin + x;
-        ITER_T b = begin + y;
-        while (a != b) {
-          func(a);
-          ++a;
-        }
+  auto fn = [&]() -> Status {
+    while (true) {
+      size_t x = cur.fetch_add(chunk);
+      if (x >= num) {
+        break;
+      }
+      size_t y = std::min(x + chunk, num);
+      ITER_T a = begin + x;
+      ITER_T b = begin + y;
+      while (a != b) {
+        func(a);
+        ++a;
       }
-    });
+    }
+    return Status::OK();
+  };
+  // runs on the persistent pool, the calling thread participates as well
+  TaskGroup tg;
+  for (int i = 0; i < thread_num; ++i) {
+    tg.AddTask(fn);
   }
-  for (auto& thrd : threads) {
-    thrd.join();
+  // the exceptions raised by `func` are caught by the pool, rethrow them
+  // rather than continuing with the partially filled results.
+  for (auto const& status : tg.TakeResults()) {
+    VINEYARD_CHECK_OK(status);
   }
 }
 
@@ -907,13 +1251,7 @@ inline void parallel_prefix_sum(const int* input, int64_t* output,
     }
   };
 
-  std::vector<std::thread> threads_prefix;
-  for (int i = 0; i < thread_num; ++i) {
-    threads_prefix.emplace_back(block_prefix, i);
-  }
-  for (auto& thrd : threads_prefix) {
-    thrd.join();
-  }
+  parallel_for(0, thread_num, block_prefix, thread_num, 1);
 
   std::vector<int64_t> block_sum(thread_num);
   {
@@ -933,13 +1271,7 @@ inline void parallel_prefix_sum(const int* input, int64_t* output,
     }
   };
 
-  std::vector<std::thread> threads_sum;
-  for (int i = 1; i < thread_num; ++i) {
-    threads_sum.emplace_back(block_add, i);
-  }
-  for (auto& thrd : threads_sum) {
-    thrd.join();
-  }
+  parallel_for(1, thread_num, block_add, thread_num, 1);
 }
 
 template <typename VID_T>
@@ -1034,6 +1366,123 @@ boost::leaf::result<void> generate_local_id_list(
   return {};
 }
 
+namespace property_graph_utils {
+
+// the edge lists larger than that are partitioned before building the CSR
+static constexpr int64_t kPartitionedCSRThreshold = 16 * 1024 * 1024;
+// the fan-out of every partitioning pass
+static constexpr int kCSRPartitionBits = 10;
+// the final partitions cover at most `2^kCSRLocalBits` source vertices
+static constexpr int kCSRLocalBits = 16;
+
+template <typename VID_T, typename EID_T>
+struct PartitionedEdge {
+  VID_T src;
+  VID_T dst;
+  EID_T eid;
+};
+
+/**
+ * @brief Radix-partitions the edges by the (label-major) positions of their
+ * source vertices into `partitions`, the edges of the p-th partition are
+ * `[partition_offsets[p], partition_offsets[p + 1])`. The first pass splits
+ * the edge list across threads, and every partition still spanning more than
+ * `2^kCSRLocalBits` vertices is sorted by a second pass on its own, the
+ * partitioning is stable, i.e., the edges of a vertex keep their order.
+ */
+template <typename VID_T, typename EID_T>
+void partition_edges_by_src(
+    IdParser<VID_T>& parser, const VID_T* src_list, const VID_T* dst_list,
+    int64_t edge_num, std::vector<int64_t> const& label_bases, int concurrency,
+    std::unique_ptr<PartitionedEdge<VID_T, EID_T>[]>& partitions,
+    std::vector<int64_t>& partition_offsets) {
+  using edge_t = PartitionedEdge<VID_T, EID_T>;
+  int64_t const total_vnum = label_bases.back();
+  int64_t const fanout = static_cast<int64_t>(1) << kCSRPartitionBits;
+  int shift = 0;
+  while ((total_vnum >> shift) >= fanout) {
+    ++shift;
+  }
+  int64_t const partition_num =
+      ((std::max(total_vnum, static_cast<int64_t>(1)) - 1) >> shift) + 1;
+  auto position_of = [&parser, &label_bases](VID_T src) -> int64_t {
+    return label_bases[parser.GetLabelId(src)] + parser.GetOffset(src);
+  };
+
+  // the first pass: counts and scatters the edges of every thread
+  int64_t const edge_chunk = (edge_num + concurrency - 1) / concurrency;
+  std::vector<std::vector<int64_t>> cursors(
+      concurrency, std::vector<int64_t>(partition_num, 0));
+  parallel_for(
+      0, concurrency,
+      [&](int tid) {
+        int64_t begin = std::min(tid * edge_chunk, edge_num);
+        int64_t end = std::min(begin + edge_chunk, edge_num);
+        for (int64_t i = begin; i < end; ++i) {
+          ++cursors[tid][position_of(src_list[i]) >> shift];
+        }
+      },
+      concurrency, 1);
+  partition_offsets.resize(partition_num + 1);
+  int64_t position = 0;
+  for (int64_t p = 0; p < partition_num; ++p) {
+    partition_offsets[p] = position;
+    for (auto& cursor : cursors) {
+      int64_t count = cursor[p];
+      cursor[p] = position;
+      position += count;
+    }
+  }
+  partition_offsets[partition_num] = position;
+
+  partitions.reset(new edge_t[edge_num]);
+  edge_t* edges = partitions.get();
+  parallel_for(
+      0, concurrency,
+      [&](int tid) {
+        auto& cursor = cursors[tid];
+        int64_t begin = std::min(tid * edge_chunk, edge_num);
+        int64_t end = std::min(begin + edge_chunk, edge_num);
+        for (int64_t i = begin; i < end; ++i) {
+          VID_T src = src_list[i];
+          edges[cursor[position_of(src) >> shift]++] =
+              edge_t{src, dst_list[i], static_cast<EID_T>(i)};
+        }
+      },
+      concurrency, 1);
+  if (shift <= kCSRLocalBits) {
+    return;
+  }
+
+  // the second pass: sorts every partition by the next bits, to keep the
+  // working set of the sequential fill in cache
+  parallel_for(
+      static_cast<int64_t>(0), partition_num,
+      [&](int64_t p) {
+        int64_t begin = partition_offsets[p], end = partition_offsets[p + 1];
+        if (end - begin <= 1) {
+          return;
+        }
+        int64_t const mask = (static_cast<int64_t>(1) << shift) - 1;
+        std::vector<int64_t> cursor(
+            (static_cast<int64_t>(1) << (shift - kCSRLocalBits)) + 1, 0);
+        for (int64_t k = begin; k < end; ++k) {
+          ++cursor[((position_of(edges[k].src) & mask) >> kCSRLocalBits) + 1];
+        }
+        for (size_t b = 1; b < cursor.size(); ++b) {
+          cursor[b] += cursor[b - 1];
+        }
+        std::vector<edge_t> scratch(edges + begin, edges + end);
+        for (auto const& edge : scratch) {
+          edges[begin + cursor[(position_of(edge.src) & mask) >>
+                               kCSRLocalBits]++] = edge;
+        }
+      },
+      concurrency, 1);
+}
+
+}  // namespace property_graph_utils
+
 template <typename VID_T, typename EID_T>
 boost::leaf::result<void> generate_directed_csr(
     IdParser<VID_T>& parser,
@@ -1053,11 +1502,84 @@ boost::leaf::result<void> generate_directed_csr(
   const VID_T* src_list_ptr = src_list->raw_values();
   const VID_T* dst_list_ptr = dst_list->raw_values();
 
+  // When the per-thread degree histograms are not larger than the edge list,
+  // every thread counts the degrees of a contiguous range of edges on its own
+  // and later scatters the range to its own offsets, without atomics.
+  int64_t total_tvnum = 0;
+  for (int v_label = 0; v_label != vertex_label_num; ++v_label) {
+    total_tvnum += tvnums[v_label];
+  }
+  bool const local_degrees =
+      concurrency > 1 &&
+      static_cast<int64_t>(concurrency) * total_tvnum <= edge_num;
+  int64_t const edge_chunk = (edge_num + concurrency - 1) / concurrency;
+  std::vector<std::vector<std::vector<int64_t>>> local_offsets;
+
+  // When the edge list is large, the edges are radix-partitioned by their
+  // sources first, then every partition counts the degrees and fills the
+  // neighbors of its own vertices, see also `partition_edges_by_src`, to
+  // avoid the random writes across the whole neighbor lists.
+  bool const partitioned =
+      concurrency > 1 &&
+      edge_num >= property_graph_utils::kPartitionedCSRThreshold;
+  std::unique_ptr<property_graph_utils::PartitionedEdge<VID_T, EID_T>[]>
+      partitions;
+  std::vector<int64_t> partition_offsets;
+
   if (concurrency == 1) {
     for (int64_t i = 0; i < edge_num; ++i) {
       VID_T src_id = src_list_ptr[i];
       ++degree[parser.GetLabelId(src_id)][parser.GetOffset(src_id)];
     }
+  } else if (partitioned) {
+    std::vector<int64_t> label_bases(vertex_label_num + 1, 0);
+    for (int v_label = 0; v_label != vertex_label_num; ++v_label) {
+      label_bases[v_label + 1] = label_bases[v_label] + tvnums[v_label];
+    }
+    property_graph_utils::partition_edges_by_src<VID_T, EID_T>(
+        parser, src_list_ptr, dst_list_ptr, edge_num, label_bases,
+        concurrency, partitions, partition_offsets);
+    // the partitions cover disjoint vertices
+    parallel_for(
+        static_cast<size_t>(0), partition_offsets.size() - 1,
+        [&](size_t p) {
+          for (int64_t k = partition_offsets[p]; k < partition_offsets[p + 1];
+               ++k) {
+            VID_T src_id = partitions[k].src;
+            ++degree[parser.GetLabelId(src_id)][parser.GetOffset(src_id)];
+          }
+        },
+        concurrency, 1);
+  } else if (local_degrees) {
+    local_offsets.resize(concurrency);
+    parallel_for(
+        0, concurrency,
+        [&](int tid) {
+          auto& local = local_offsets[tid];
+          local.resize(vertex_label_num);
+          for (int v_label = 0; v_label != vertex_label_num; ++v_label) {
+            local[v_label].resize(tvnums[v_label], 0);
+          }
+          int64_t begin = std::min(tid * edge_chunk, edge_num);
+          int64_t end = std::min(begin + edge_chunk, edge_num);
+          for (int64_t i = begin; i < end; ++i) {
+            VID_T src_id = src_list_ptr[i];
+            ++local[parser.GetLabelId(src_id)][parser.GetOffset(src_id)];
+          }
+        },
+        concurrency, 1);
+    for (int v_label = 0; v_label != vertex_label_num; ++v_label) {
+      parallel_for(
+          static_cast<VID_T>(0), tvnums[v_label],
+          [&](VID_T v) {
+            int64_t deg = 0;
+            for (auto& local : local_offsets) {
+              deg += local[v_label][v];
+            }
+            degree[v_label][v] = static_cast<int>(deg);
+          },
+          concurrency);
+    }
   } else {
     parallel_for(
         static_cast<int64_t>(0), edge_num,
@@ -1120,6 +1642,55 @@ boost::leaf::result<void> generate_directed_csr(
       ptr->eid = static_cast<EID_T>(i);
       ++offsets[v_label][v_offset];
     }
+  } else if (partitioned) {
+    parallel_for(
+        static_cast<size_t>(0), partition_offsets.size() - 1,
+        [&](size_t p) {
+          for (int64_t k = partition_offsets[p]; k < partition_offsets[p + 1];
+               ++k) {
+            auto const& edge = partitions[k];
+            int v_label = parser.GetLabelId(edge.src);
+            int64_t v_offset = parser.GetOffset(edge.src);
+            nbr_unit_t* ptr = edge_builders[v_label].MutablePointer(
+                offsets[v_label][v_offset]++);
+            ptr->vid = edge.dst;
+            ptr->eid = edge.eid;
+          }
+        },
+        concurrency, 1);
+    partitions.reset();
+  } else if (local_degrees) {
+    // the edges of a vertex are placed in the order of threads
+    for (int v_label = 0; v_label != vertex_label_num; ++v_label) {
+      parallel_for(
+          static_cast<VID_T>(0), tvnums[v_label],
+          [&](VID_T v) {
+            int64_t position = offsets[v_label][v];
+            for (auto& local : local_offsets) {
+              int64_t deg = local[v_label][v];
+              local[v_label][v] = position;
+              position += deg;
+            }
+          },
+          concurrency);
+    }
+    parallel_for(
+        0, concurrency,
+        [&](int tid) {
+          auto& local = local_offsets[tid];
+          int64_t begin = std::min(tid * edge_chunk, edge_num);
+          int64_t end = std::min(begin + edge_chunk, edge_num);
+          for (int64_t i = begin; i < end; ++i) {
+            VID_T src_id = src_list_ptr[i];
+            int v_label = parser.GetLabelId(src_id);
+            int64_t v_offset = parser.GetOffset(src_id);
+            nbr_unit_t* ptr = edge_builders[v_label].MutablePointer(
+                local[v_label][v_offset]++);
+            ptr->vid = dst_list_ptr[i];
+            ptr->eid = static_cast<EID_T>(i);
+          }
+        },
+        concurrency, 1);
   } else {
     parallel_for(
         static_cast<int64_t>(0), edge_num,
@@ -1169,6 +1740,83 @@ boost::leaf::result<void> generate_directed_csr(
   return {};
 }
 
+/**
+ * @brief Compress the (sorted) neighbor lists generated by
+ * `generate_directed_csr` or `generate_undirected_csr`, the neighbors of the
+ * i-th vertex are stored in `[compressed_offsets[i], compressed_offsets[i +
+ * 1])` of `compressed_edges`, and its degree is still given by the original
+ * `edge_offsets`, see also `CompressedAdjList`.
+ */
+template <typename VID_T, typename EID_T>
+boost::leaf::result<void> generate_compressed_csr(
+    const std::shared_ptr<arrow::FixedSizeBinaryArray>& edges,
+    const std::shared_ptr<arrow::Int64Array>& edge_offsets, int concurrency,
+    std::shared_ptr<arrow::UInt8Array>& compressed_edges,
+    std::shared_ptr<arrow::Int64Array>& compressed_offsets) {
+  using nbr_unit_t = property_graph_utils::NbrUnit<VID_T, EID_T>;
+  // at most 10 bytes for each varint
+  constexpr size_t kMaxEncodedSize = 20;
+
+  const nbr_unit_t* nbrs =
+      reinterpret_cast<const nbr_unit_t*>(edges->GetValue(0));
+  const int64_t* offsets = edge_offsets->raw_values();
+  int64_t vnum = edge_offsets->length() - 1;
+
+  // every chunk of vertices is encoded into its own buffer
+  int64_t chunk_num = std::max(concurrency, 1);
+  int64_t chunk_size = (vnum + chunk_num - 1) / chunk_num;
+  std::vector<std::vector<uint8_t>> chunks(chunk_num);
+  std::vector<int64_t> byte_offsets(vnum + 1, 0);
+  parallel_for(
+      static_cast<int64_t>(0), chunk_num,
+      [&](int64_t chunk) {
+        int64_t begin = std::min(chunk * chunk_size, vnum);
+        int64_t end = std::min(begin + chunk_size, vnum);
+        auto& buffer = chunks[chunk];
+        buffer.resize((offsets[end] - offsets[begin]) * kMaxEncodedSize);
+        uint8_t* ptr = buffer.data();
+        for (int64_t v = begin; v < end; ++v) {
+          VID_T prev_vid = 0;
+          EID_T prev_eid = 0;
+          for (int64_t k = offsets[v]; k < offsets[v + 1]; ++k) {
+            ptr = property_graph_utils::encode_varint(
+                static_cast<uint64_t>(nbrs[k].vid - prev_vid), ptr);
+            ptr = property_graph_utils::encode_varint(
+                property_graph_utils::zigzag_encode(
+                    static_cast<int64_t>(nbrs[k].eid) -
+                    static_cast<int64_t>(prev_eid)),
+                ptr);
+            prev_vid = nbrs[k].vid;
+            prev_eid = nbrs[k].eid;
+          }
+          byte_offsets[v + 1] = ptr - buffer.data();
+        }
+        buffer.resize(ptr - buffer.data());
+      },
+      concurrency, 1);
+
+  // concatenates the chunks
+  arrow::UInt8Builder edges_builder;
+  int64_t base = 0;
+  for (int64_t chunk = 0; chunk < chunk_num; ++chunk) {
+    int64_t begin = std::min(chunk * chunk_size, vnum);
+    int64_t end = std::min(begin + chunk_size, vnum);
+    for (int64_t v = begin; v < end; ++v) {
+      byte_offsets[v + 1] += base;
+    }
+    base += chunks[chunk].size();
+    ARROW_OK_OR_RAISE(
+        edges_builder.AppendValues(chunks[chunk].data(), chunks[chunk].size()));
+    std::vector<uint8_t>().swap(chunks[chunk]);
+  }
+  ARROW_OK_OR_RAISE(edges_builder.Finish(&compressed_edges));
+
+  arrow::Int64Builder offsets_builder;
+  ARROW_OK_OR_RAISE(offsets_builder.AppendValues(byte_offsets));
+  ARROW_OK_OR_RAISE(offsets_builder.Finish(&compressed_offsets));
+  return {};
+}
+
 template <typename VID_T, typename EID_T>
 boost::leaf::result<void> generate_undirected_csr(
     IdParser<VID_T>& parser,
@@ -46,6 +46,7 @@ limitations under the License.
 #include "graph/loader/basic_e_fragment_loader.h"
 #include "graph/loader/basic_ev_fragment_loader.h"
 #include "graph/utils/error.h"
+#include "graph/utils/load_profile.h"
 #include "graph/utils/partitioner.h"
 #include "graph/utils/thread_group.h"
 #include "graph/vertex_map/arrow_vertex_map.h"
@@ -386,6 +387,8 @@ class ArrowFragmentLoader {
   static constexpr int id_column = 0;
 #ifdef HASH_PARTITION
   using partitioner_t = HashPartitioner<oid_t>;
+#elif defined(DEGREE_BALANCED_PARTITION)
+  using partitioner_t = DegreeBalancedPartitioner<oid_t>;
 #else
   using partitioner_t = SegmentedPartitioner<oid_t>;
 #endif
@@ -464,11 +467,61 @@ class ArrowFragmentLoader {
 
   ~ArrowFragmentLoader() = default;
 
+  /**
+   * @brief Reorder the vertices by degrees when loading from both vertex and
+   * edge files, see also `BasicEVFragmentLoader::set_reorder_vertices`.
+   */
+  void set_reorder_vertices(bool reorder) { reorder_vertices_ = reorder; }
+
+  /**
+   * @brief Build partial vertex maps that hold the inner and outer vertices
+   * of the fragments only, when loading from both vertex and edge files, see
+   * also `BasicEVFragmentLoader::set_partitioned_vertex_map`.
+   */
+  void set_partitioned_vertex_map(bool partitioned) {
+    partitioned_vertex_map_ = partitioned;
+  }
+
+  /**
+   * @brief Precompute the degrees of vertices and the vertex-major index of
+   * edges across edge labels into the fragment, see also
+   * `BasicArrowFragmentBuilder::set_degree_index`.
+   */
+  void set_degree_index(bool enabled) { degree_index_ = enabled; }
+
+  /**
+   * @brief The number of edges that are converted and shuffled in a batch
+   * when loading from both vertex and edge files, see also
+   * `BasicEVFragmentLoader::set_edge_batch_size`.
+   */
+  void set_edge_batch_size(int64_t batch_size) {
+    edge_batch_size_ = batch_size;
+  }
+
+  /**
+   * @brief Load only the given properties of the labels (by label names), the
+   * other properties are pruned when reading the files (i.e., pushed down to
+   * the column selection of IO adaptors) and before shuffling. The labels that
+   * are not in `properties` keep all their properties.
+   */
+  void set_required_properties(
+      const std::map<std::string, std::vector<std::string>>& properties) {
+    required_properties_ = properties;
+  }
+
+  /**
+   * @brief Accumulate the time of each phase of `LoadFragment` into the
+   * profile (not owned), nullptr (the default) disables the profiling.
+   */
+  void set_profile(LoadProfile* profile) { profile_ = profile; }
+
   boost::leaf::result<ObjectID> LoadFragment() {
     BOOST_LEAF_CHECK(initPartitioner());
 
     std::vector<std::shared_ptr<arrow::Table>> partial_v_tables;
     std::vector<std::vector<std::shared_ptr<arrow::Table>>> partial_e_tables;
+    std::unique_ptr<LoadProfile::Timer> read_timer(
+        new LoadProfile::Timer(profile_, LoadProfile::kRead));
     if (!v_streams_.empty() && !e_streams_.empty()) {
       {
         BOOST_LEAF_AUTO(
@@ -527,12 +580,32 @@ class ArrowFragmentLoader {
                       "Error when processing input source");
     }
 
+    // the id column of vertices, and the src and dst columns of edges are
+    // always kept.
+    for (auto& table : partial_v_tables) {
+      BOOST_LEAF_ASSIGN(table, pruneProperties(table, 1));
+    }
+    for (auto& sub_tables : partial_e_tables) {
+      for (auto& table : sub_tables) {
+        BOOST_LEAF_ASSIGN(table, pruneProperties(table, 2));
+      }
+    }
+    read_timer.reset();
+
     if (load_with_ve_) {
       std::shared_ptr<BasicEVFragmentLoader<OID_T, VID_T, partitioner_t>>
           basic_fragment_loader = std::make_shared<
               BasicEVFragmentLoader<OID_T, VID_T, partitioner_t>>(
               client_, comm_spec_, partitioner_, directed_, true,
               generate_eid_);
+      basic_fragment_loader->set_reorder_vertices(reorder_vertices_);
+      basic_fragment_loader->set_partitioned_vertex_map(
+          partitioned_vertex_map_);
+      basic_fragment_loader->set_degree_index(degree_index_);
+      basic_fragment_loader->set_profile(profile_);
+      if (edge_batch_size_ > 0) {
+        basic_fragment_loader->set_edge_batch_size(edge_batch_size_);
+      }
 
       for (auto table : partial_v_tables) {
         auto meta = table->schema()->metadata();
@@ -581,6 +654,8 @@ class ArrowFragmentLoader {
               BasicEFragmentLoader<OID_T, VID_T, partitioner_t>>(
               client_, comm_spec_, partitioner_, directed_, true,
               generate_eid_);
+      basic_fragment_loader->set_profile(profile_);
+      basic_fragment_loader->set_degree_index(degree_index_);
 
       for (auto& table_vec : partial_e_tables) {
         for (auto table : table_vec) {
@@ -671,11 +746,58 @@ class ArrowFragmentLoader {
       }
     }
 
+#ifdef DEGREE_BALANCED_PARTITION
+    BOOST_LEAF_AUTO(degree_list, countDegrees(oid_list));
+    partitioner_.Init(comm_spec_.fnum(), oid_list, degree_list);
+#else
     partitioner_.Init(comm_spec_.fnum(), oid_list);
+#endif
 #endif
     return {};
   }
 
+#if !defined(HASH_PARTITION) && defined(DEGREE_BALANCED_PARTITION)
+  // counts the degrees of vertices in `oid_list`, each worker scans a part of
+  // the edge files and the counts are summed up among workers.
+  boost::leaf::result<std::vector<int64_t>> countDegrees(
+      const std::vector<oid_t>& oid_list) {
+    ska::flat_hash_map<oid_t, size_t> indices;
+    indices.reserve(oid_list.size());
+    for (size_t i = 0; i < oid_list.size(); ++i) {
+      indices.emplace(oid_list[i], i);
+    }
+    std::vector<int64_t> degree_list(oid_list.size(), 0);
+
+    BOOST_LEAF_AUTO(etables, loadEdgeTables(efiles_, comm_spec_.worker_id(),
+                                            comm_spec_.worker_num()));
+    for (auto& sub_tables : etables) {
+      for (auto& table : sub_tables) {
+        // the first two columns of edge files are the src and dst
+        for (int column = 0; column < 2; ++column) {
+          for (auto const& chunk : table->column(column)->chunks()) {
+            auto array = std::dynamic_pointer_cast<oid_array_t>(chunk);
+            if (array == nullptr) {
+              RETURN_GS_ERROR(ErrorCode::kInvalidValueError,
+                              "The type of src/dst in edge files mismatches "
+                              "the oid type: " +
+                                  chunk->type()->ToString());
+            }
+            for (int64_t i = 0; i < array->length(); ++i) {
+              auto iter = indices.find(oid_t(array->GetView(i)));
+              if (iter != indices.end()) {
+                ++degree_list[iter->second];
+              }
+            }
+          }
+        }
+      }
+    }
+    MPI_Allreduce(MPI_IN_PLACE, degree_list.data(), degree_list.size(),
+                  MPI_INT64_T, MPI_SUM, comm_spec_.comm());
+    return degree_list;
+  }
+#endif
+
   boost::leaf::result<std::vector<std::shared_ptr<arrow::Table>>>
   loadVertexTables(const std::vector<std::string>& files, int index,
                    int total_parts) {
@@ -684,7 +806,8 @@ class ArrowFragmentLoader {
 
     for (label_id_t label_id = 0; label_id < label_num; ++label_id) {
       std::unique_ptr<IIOAdaptor, std::function<void(IIOAdaptor*)>> io_adaptor(
-          IOFactory::CreateIOAdaptor(files[label_id] + "#header_row=true")
+          IOFactory::CreateIOAdaptor(selectColumns(files[label_id], 1) +
+                                     "#header_row=true")
               .release(),
           io_deleter_);
       auto read_procedure =
@@ -741,8 +864,9 @@ class ArrowFragmentLoader {
 
         for (size_t j = 0; j < sub_label_files.size(); ++j) {
           std::unique_ptr<IIOAdaptor, std::function<void(IIOAdaptor*)>>
-              io_adaptor(IOFactory::CreateIOAdaptor(sub_label_files[j] +
-                                                    "#header_row=true")
+              io_adaptor(IOFactory::CreateIOAdaptor(
+                             selectColumns(sub_label_files[j], 2) +
+                             "#header_row=true")
                              .release(),
                          io_deleter_);
           auto read_procedure =
@@ -810,6 +934,87 @@ class ArrowFragmentLoader {
     return tables;
   }
 
+  // the label name in the arguments of the location, e.g., "...#label=v0"
+  static std::string locationLabel(const std::string& location) {
+    size_t arg_pos = location.find_first_of('#');
+    if (arg_pos == std::string::npos) {
+      return std::string();
+    }
+    std::vector<std::string> config_list;
+    std::string location_args = location.substr(arg_pos + 1);
+    boost::split(config_list, location_args, boost::is_any_of("&#"));
+    const std::string prefix = std::string(LABEL_TAG) + "=";
+    for (auto const& config : config_list) {
+      if (boost::algorithm::starts_with(config, prefix)) {
+        return config.substr(prefix.size());
+      }
+    }
+    return std::string();
+  }
+
+  // pushes the required properties down to the column selection of the IO
+  // adaptor, the first `key_columns` columns are always selected.
+  std::string selectColumns(const std::string& location,
+                            int key_columns) const {
+    if (required_properties_.empty() ||
+        location.find("schema=") != std::string::npos) {
+      return location;
+    }
+    auto iter = required_properties_.find(locationLabel(location));
+    if (iter == required_properties_.end()) {
+      return location;
+    }
+    std::string schema;
+    for (int i = 0; i < key_columns; ++i) {
+      schema += std::to_string(i) + ",";
+    }
+    for (auto const& property : iter->second) {
+      schema += property + ",";
+    }
+    schema.pop_back();
+    return location + "#schema=" + schema;
+  }
+
+  // drops the properties that are not required, the first `key_columns`
+  // columns are always kept.
+  boost::leaf::result<std::shared_ptr<arrow::Table>> pruneProperties(
+      const std::shared_ptr<arrow::Table>& table, int key_columns) const {
+    if (required_properties_.empty() || table == nullptr) {
+      return table;
+    }
+    auto meta = table->schema()->metadata();
+    int label_meta_index = meta == nullptr ? -1 : meta->FindKey(LABEL_TAG);
+    if (label_meta_index == -1) {
+      return table;
+    }
+    std::string label_name = meta->value(label_meta_index);
+    auto iter = required_properties_.find(label_name);
+    if (iter == required_properties_.end()) {
+      return table;
+    }
+    std::vector<int> indices;
+    for (int i = 0; i < key_columns && i < table->num_columns(); ++i) {
+      indices.push_back(i);
+    }
+    for (auto const& property : iter->second) {
+      int index = table->schema()->GetFieldIndex(property);
+      if (index == -1) {
+        RETURN_GS_ERROR(ErrorCode::kInvalidValueError,
+                        "Property '" + property + "' not found in label '" +
+                            label_name + "'");
+      }
+      if (index >= key_columns) {
+        indices.push_back(index);
+      }
+    }
+    if (static_cast<int>(indices.size()) == table->num_columns()) {
+      return table;
+    }
+    std::shared_ptr<arrow::Table> pruned;
+    ARROW_OK_ASSIGN_OR_RAISE(pruned, table->SelectColumns(indices));
+    return pruned->ReplaceSchemaMetadata(meta);
+  }
+
   Client& client_;
   grape::CommSpec comm_spec_;
   std::vector<std::string> efiles_, vfiles_;
@@ -824,6 +1029,12 @@ class ArrowFragmentLoader {
   bool directed_;
   bool generate_eid_;
   bool load_with_ve_;
+  bool reorder_vertices_ = false;
+  bool partitioned_vertex_map_ = false;
+  bool degree_index_ = false;
+  int64_t edge_batch_size_ = 0;
+  std::map<std::string, std::vector<std::string>> required_properties_;
+  LoadProfile* profile_ = nullptr;
 
   std::function<void(IIOAdaptor*)> io_deleter_ = [](IIOAdaptor* adaptor) {
     VINEYARD_CHECK_OK(adaptor->Close());
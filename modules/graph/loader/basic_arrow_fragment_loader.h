@@ -369,10 +369,11 @@ class BasicArrowFragmentLoader {
                 return;
               }
 
+              std::vector<fid_t> fids(size);
+              partitioner_.GetPartitionIds(*oid_array, fids.data());
               for (size_t k = 0; k != size; ++k) {
                 internal_oid_t oid = oid_array->GetView(k);
-                fid_t fid = partitioner_.GetPartitionId(oid_t(oid));
-                if (!oid2gid_mapper(fid, label_id, oid, builder[k])) {
+                if (!oid2gid_mapper(fids[k], label_id, oid, builder[k])) {
                   LOG(ERROR) << "Mapping vertex " << oid << " failed.";
                 }
               }
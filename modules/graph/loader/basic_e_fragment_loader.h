@@ -110,6 +110,21 @@ class BasicEFragmentLoader {
    *  | src : OID_T | dst : OID_T | property_1 | ... | property_m |
    * @return
    */
+  /**
+   * @brief See also `BasicEVFragmentLoader::set_profile`.
+   */
+  void set_profile(LoadProfile* profile) {
+    profile_ = profile;
+    ev_fragment_loader_->set_profile(profile);
+  }
+
+  /**
+   * @brief See also `BasicEVFragmentLoader::set_degree_index`.
+   */
+  void set_degree_index(bool enabled) {
+    ev_fragment_loader_->set_degree_index(enabled);
+  }
+
   boost::leaf::result<void> AddEdgeTable(
       const std::string& src_label, const std::string& dst_label,
       const std::string& edge_label, std::shared_ptr<arrow::Table> edge_table) {
@@ -177,14 +192,18 @@ class BasicEFragmentLoader {
 
   boost::leaf::result<void> constructVertices() {
     std::vector<OidSet<oid_t>> oids(vertex_label_num_);
-    for (auto& tab : input_tables_) {
-      label_id_t src_label_id = vertex_label_to_index_.at(tab.src_label);
-      label_id_t dst_label_id = vertex_label_to_index_.at(tab.dst_label);
-
-      BOOST_LEAF_CHECK(
-          oids[src_label_id].BatchInsert(tab.table->column(src_column)));
-      BOOST_LEAF_CHECK(
-          oids[dst_label_id].BatchInsert(tab.table->column(dst_column)));
+    {
+      // collects the vertices from the endpoints of edges
+      LoadProfile::Timer timer(profile_, LoadProfile::kVertexMap);
+      for (auto& tab : input_tables_) {
+        label_id_t src_label_id = vertex_label_to_index_.at(tab.src_label);
+        label_id_t dst_label_id = vertex_label_to_index_.at(tab.dst_label);
+
+        BOOST_LEAF_CHECK(
+            oids[src_label_id].BatchInsert(tab.table->column(src_column)));
+        BOOST_LEAF_CHECK(
+            oids[dst_label_id].BatchInsert(tab.table->column(dst_column)));
+      }
     }
 
     std::vector<std::shared_ptr<arrow::Field>> schema_vector{
@@ -198,8 +217,12 @@ class BasicEFragmentLoader {
         std::vector<std::shared_ptr<arrow::Array>> arrays{oid_array};
         auto v_table = arrow::Table::Make(schema, arrays);
 
-        BOOST_LEAF_AUTO(tmp_table, beta::ShufflePropertyVertexTable(
-                                       comm_spec_, partitioner_, v_table));
+        std::shared_ptr<arrow::Table> tmp_table;
+        {
+          LoadProfile::Timer timer(profile_, LoadProfile::kShuffle);
+          BOOST_LEAF_ASSIGN(tmp_table, beta::ShufflePropertyVertexTable(
+                                           comm_spec_, partitioner_, v_table));
+        }
 
         oid_set.Clear();
         BOOST_LEAF_CHECK(oid_set.BatchInsert(tmp_table->column(0)));
@@ -231,6 +254,7 @@ class BasicEFragmentLoader {
 
   grape::CommSpec comm_spec_;
   const partitioner_t& partitioner_;
+  LoadProfile* profile_ = nullptr;
 };
 
 }  // namespace vineyard
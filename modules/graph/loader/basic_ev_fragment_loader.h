@@ -16,10 +16,15 @@ limitations under the License.
 #ifndef MODULES_GRAPH_LOADER_BASIC_EV_FRAGMENT_LOADER_H_
 #define MODULES_GRAPH_LOADER_BASIC_EV_FRAGMENT_LOADER_H_
 
+#include <algorithm>
+#include <future>
+#include <limits>
 #include <map>
 #include <memory>
 #include <set>
 #include <string>
+#include <thread>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
@@ -29,6 +34,7 @@ limitations under the License.
 #include "graph/fragment/arrow_fragment_group.h"
 #include "graph/fragment/property_graph_types.h"
 #include "graph/utils/error.h"
+#include "graph/utils/load_profile.h"
 #include "graph/utils/table_shuffler.h"
 #include "graph/utils/table_shuffler_beta.h"
 #include "graph/vertex_map/arrow_vertex_map.h"
@@ -89,6 +95,13 @@ class BasicEVFragmentLoader {
   ///                 vertex_label_to_index_, vertex_labels_
   boost::leaf::result<void> ConstructVertices(
       ObjectID vm_id = InvalidObjectID()) {
+    if (partitioned_vertex_map_ &&
+        (vm_id != InvalidObjectID() || reorder_vertices_ ||
+         !std::is_arithmetic<internal_oid_t>::value)) {
+      RETURN_GS_ERROR(ErrorCode::kUnsupportedOperationError,
+                      "The partitioned vertex map only supports constructing "
+                      "new vertex maps of arithmetic oids without reordering");
+    }
     for (size_t i = 0; i < vertex_labels_.size(); ++i) {
       vertex_label_to_index_[vertex_labels_[i]] = i;
     }
@@ -120,15 +133,25 @@ class BasicEVFragmentLoader {
                               std::to_string(id_column) + ")");
         }
 
-        BOOST_LEAF_AUTO(tmp_table,
-                        beta::ShufflePropertyVertexTable<partitioner_t>(
-                            comm_spec_, partitioner_, vertex_table));
+        std::shared_ptr<arrow::Table> tmp_table;
+        {
+          LoadProfile::Timer timer(profile_, LoadProfile::kShuffle);
+          BOOST_LEAF_ASSIGN(tmp_table,
+                            beta::ShufflePropertyVertexTable<partitioner_t>(
+                                comm_spec_, partitioner_, vertex_table));
+        }
 
         auto local_oid_array = std::dynamic_pointer_cast<oid_array_t>(
             tmp_table->column(id_column)->chunk(0));
 
-        VY_OK_OR_RAISE(FragmentAllGatherArray<oid_t>(
-            comm_spec_, local_oid_array, oid_lists[v_label]));
+        if (partitioned_vertex_map_) {
+          oid_lists[v_label].resize(comm_spec_.fnum());
+          oid_lists[v_label][comm_spec_.fid()] = local_oid_array;
+        } else {
+          LoadProfile::Timer timer(profile_, LoadProfile::kVertexMap);
+          VY_OK_OR_RAISE(FragmentAllGatherArray<oid_t>(
+              comm_spec_, local_oid_array, oid_lists[v_label]));
+        }
 
         if (retain_oid_) {
           auto id_field = tmp_table->schema()->field(id_column);
@@ -157,32 +180,23 @@ class BasicEVFragmentLoader {
       metadata->Append("retain_oid", std::to_string(retain_oid_));
       output_vertex_tables_[v_label] = table->ReplaceSchemaMetadata(metadata);
     }
-    if (vm_id == InvalidObjectID()) {
-      BasicArrowVertexMapBuilder<internal_oid_t, vid_t> vm_builder(
-          client_, comm_spec_.fnum(), vertex_label_num_, oid_lists);
-
-      auto vm = vm_builder.Seal(client_);
-
-      vm_ptr_ =
-          std::dynamic_pointer_cast<ArrowVertexMap<internal_oid_t, vid_t>>(
-              client_.GetObject(vm->id()));
-    } else {
-      auto old_vm_ptr =
-          std::dynamic_pointer_cast<ArrowVertexMap<internal_oid_t, vid_t>>(
-              client_.GetObject(vm_id));
-      label_id_t pre_label_num = old_vm_ptr->label_num();
-      std::map<label_id_t, std::vector<std::shared_ptr<oid_array_t>>>
-          oid_lists_map;
-      for (size_t i = 0; i < oid_lists.size(); ++i) {
-        oid_lists_map[pre_label_num + i] = oid_lists[i];
-      }
-      auto new_vm_id = old_vm_ptr->AddVertices(client_, oid_lists_map);
-      vm_ptr_ =
-          std::dynamic_pointer_cast<ArrowVertexMap<internal_oid_t, vid_t>>(
-              client_.GetObject(new_vm_id));
-    }
-
     ordered_vertex_tables_.clear();
+    if (partitioned_vertex_map_) {
+      // the vertex map is built after the outer vertices are known, in
+      // `ConstructEdges`.
+      gatherVertexNums(oid_lists);
+      oid_lists_ = std::move(oid_lists);
+      vm_id_ = vm_id;
+      return {};
+    }
+    if (reorder_vertices_ && vm_id == InvalidObjectID()) {
+      // the vertex map is built after the degrees are known, in
+      // `ConstructEdges`.
+      oid_lists_ = std::move(oid_lists);
+      vm_id_ = vm_id;
+      return {};
+    }
+    constructVertexMap(vm_id, oid_lists);
     return {};
   }
 
@@ -244,12 +258,13 @@ class BasicEVFragmentLoader {
                       "OID_T is not consistent with dst id of edge table");
     }
 
-    BOOST_LEAF_AUTO(
-        src_gid_array,
-        parseOidChunkedArray(src_label, edge_table->column(src_column)));
-    BOOST_LEAF_AUTO(
-        dst_gid_array,
-        parseOidChunkedArray(dst_label, edge_table->column(dst_column)));
+    // the src and dst columns are translated together
+    BOOST_LEAF_AUTO(gid_arrays, parseOidChunkedArrays(
+                                    {src_label, dst_label},
+                                    {edge_table->column(src_column),
+                                     edge_table->column(dst_column)}));
+    auto& src_gid_array = gid_arrays[0];
+    auto& dst_gid_array = gid_arrays[1];
 
     // replace oid columns with gid
 #if defined(ARROW_VERSION) && ARROW_VERSION < 17000
@@ -273,6 +288,18 @@ class BasicEVFragmentLoader {
     if (vertex_label_num == 0) {
       vertex_label_num = vertex_label_num_;
     }
+    if (vm_ptr_ == nullptr && reorder_vertices_) {
+      {
+        LoadProfile::Timer timer(profile_, LoadProfile::kVertexMap);
+        BOOST_LEAF_CHECK(reorderVerticesByDegree());
+      }
+      constructVertexMap(vm_id_, oid_lists_);
+      oid_lists_.clear();
+    }
+    if (vm_ptr_ == nullptr && partitioned_vertex_map_) {
+      LoadProfile::Timer timer(profile_, LoadProfile::kVertexMap);
+      BOOST_LEAF_CHECK(resolveRemoteGids());
+    }
     for (size_t i = 0; i < edge_labels_.size(); ++i) {
       edge_label_to_index_[edge_labels_[i]] = i;
     }
@@ -316,24 +343,64 @@ class BasicEVFragmentLoader {
     for (label_id_t e_label = 0; e_label < edge_label_num_; ++e_label) {
       auto shuffle_procedure =
           [&]() -> boost::leaf::result<std::shared_ptr<arrow::Table>> {
+        // The edges are converted to gids and shuffled in batches, and the
+        // conversion of the next batch overlaps with the shuffle of the
+        // current one, thus the intermediate (gid) tables of different
+        // batches don't co-exist.
         auto& edge_table_list = ordered_edge_tables_[e_label];
-        std::vector<std::shared_ptr<arrow::Table>> processed_table_list;
+        std::vector<std::pair<std::pair<label_id_t, label_id_t>,
+                              std::shared_ptr<arrow::Table>>>
+            batches;
         for (auto& item : edge_table_list) {
-          label_id_t src_label = item.first.first;
-          label_id_t dst_label = item.first.second;
-          auto edge_table = item.second;
-          BOOST_LEAF_AUTO(tmp_table,
-                          edgesId2Gid(edge_table, src_label, dst_label));
-          processed_table_list.push_back(tmp_table);
+          int64_t num_rows = item.second->num_rows();
+          int64_t offset = 0;
+          do {
+            batches.emplace_back(item.first,
+                                 item.second->Slice(offset, edge_batch_size_));
+            offset += edge_batch_size_;
+          } while (offset < num_rows);
+          item.second.reset();
         }
 
-        auto table = vineyard::ConcatenateTables(processed_table_list);
-
-        BOOST_LEAF_AUTO(table_out, beta::ShufflePropertyEdgeTable<vid_t>(
-                                       comm_spec_, id_parser, src_column,
-                                       dst_column, table));
-
-        return table_out;
+        // every worker shuffles the same number of batches
+        int64_t local_rounds = batches.size(), rounds = 0;
+        MPI_Allreduce(&local_rounds, &rounds, 1, MPI_INT64_T, MPI_MAX,
+                      comm_spec_.comm());
+
+        auto convert = [this, &batches](size_t index)
+            -> boost::leaf::result<std::shared_ptr<arrow::Table>> {
+          auto& batch = batches[index];
+          LoadProfile::Timer timer(profile_, LoadProfile::kOidToGid);
+          BOOST_LEAF_AUTO(table,
+                          edgesId2Gid(batch.second, batch.first.first,
+                                      batch.first.second));
+          batch.second.reset();
+          return table;
+        };
+
+        BOOST_LEAF_AUTO(current, convert(0));
+        auto empty_batch = current->Slice(0, 0);
+        std::vector<std::shared_ptr<arrow::Table>> shuffled_tables;
+        for (int64_t round = 0; round < rounds; ++round) {
+          std::future<boost::leaf::result<std::shared_ptr<arrow::Table>>> next;
+          if (round + 1 < local_rounds) {
+            next = std::async(std::launch::async, convert, round + 1);
+          }
+          std::shared_ptr<arrow::Table> table_out;
+          {
+            LoadProfile::Timer timer(profile_, LoadProfile::kShuffle);
+            BOOST_LEAF_ASSIGN(table_out, beta::ShufflePropertyEdgeTable<vid_t>(
+                                             comm_spec_, id_parser, src_column,
+                                             dst_column, current));
+          }
+          shuffled_tables.emplace_back(table_out);
+          if (next.valid()) {
+            BOOST_LEAF_ASSIGN(current, next.get());
+          } else {
+            current = empty_batch;
+          }
+        }
+        return vineyard::ConcatenateTables(shuffled_tables);
       };
 
       BOOST_LEAF_AUTO(table, sync_gs_error(comm_spec_, shuffle_procedure));
@@ -346,11 +413,20 @@ class BasicEVFragmentLoader {
       ordered_edge_tables_[e_label].clear();
     }
     ordered_edge_tables_.clear();
+    if (vm_ptr_ == nullptr && partitioned_vertex_map_) {
+      LoadProfile::Timer timer(profile_, LoadProfile::kVertexMap);
+      BOOST_LEAF_CHECK(constructPartitionedVertexMap());
+    }
     return {};
   }
 
   boost::leaf::result<ObjectID> AddVerticesToFragment(
       std::shared_ptr<ArrowFragment<oid_t, vid_t>> frag) {
+    if (vm_ptr_ == nullptr && reorder_vertices_) {
+      // no edges, nothing to reorder by
+      constructVertexMap(vm_id_, oid_lists_);
+      oid_lists_.clear();
+    }
     int pre_vlabel_num = frag->schema().all_vertex_label_num();
     std::map<label_id_t, std::shared_ptr<arrow::Table>> vertex_tables_map;
     for (size_t i = 0; i < output_vertex_tables_.size(); ++i) {
@@ -431,15 +507,20 @@ class BasicEVFragmentLoader {
     PropertyGraphSchema schema;
     BOOST_LEAF_CHECK(initSchema(schema));
     frag_builder.SetPropertyGraphSchema(std::move(schema));
+    frag_builder.set_degree_index(degree_index_);
 
     int thread_num =
         (std::thread::hardware_concurrency() + comm_spec_.local_num() - 1) /
         comm_spec_.local_num();
 
-    BOOST_LEAF_CHECK(frag_builder.Init(
-        comm_spec_.fid(), comm_spec_.fnum(), std::move(output_vertex_tables_),
-        std::move(output_edge_tables_), directed_, thread_num));
+    {
+      LoadProfile::Timer timer(profile_, LoadProfile::kCSR);
+      BOOST_LEAF_CHECK(frag_builder.Init(
+          comm_spec_.fid(), comm_spec_.fnum(), std::move(output_vertex_tables_),
+          std::move(output_edge_tables_), directed_, thread_num));
+    }
 
+    LoadProfile::Timer timer(profile_, LoadProfile::kSeal);
     auto frag = std::dynamic_pointer_cast<ArrowFragment<oid_t, vid_t>>(
         frag_builder.Seal(client_));
 
@@ -459,92 +540,528 @@ class BasicEVFragmentLoader {
     vm_ptr_ = in;
   }
 
+  /**
+   * @brief Reorder the inner vertices of every label by the descending order
+   * of their degrees (the in-degrees plus the out-degrees), to place the
+   * high-degree vertices together for better locality of traversals.
+   *
+   * The reordering happens before the vertex map is built, thus the lids, the
+   * vertex tables and the CSR are consistent with it. It must be enabled
+   * before `ConstructVertices`, and is only applied when constructing new
+   * vertex maps (rather than extending existing ones).
+   */
+  void set_reorder_vertices(bool reorder) { reorder_vertices_ = reorder; }
+
+  /**
+   * @brief The number of edges that are converted to gids and shuffled in a
+   * batch by `ConstructEdges`.
+   */
+  void set_edge_batch_size(int64_t batch_size) {
+    edge_batch_size_ = batch_size;
+  }
+
+  /**
+   * @brief Build a partial vertex map (see also `ArrowVertexMap::partial()`)
+   * that holds the inner vertices of this fragment and caches its outer
+   * vertices only, rather than gathering the oids of all fragments to every
+   * worker.
+   *
+   * The gids of the remote endpoints of edges are resolved by their owners in
+   * batches, which are exchanged once per label before converting the edges.
+   * It must be enabled before `ConstructVertices`, and only supports new
+   * vertex maps of arithmetic oids (without reordering).
+   */
+  void set_partitioned_vertex_map(bool partitioned) {
+    partitioned_vertex_map_ = partitioned;
+  }
+
+  /**
+   * @brief Precompute the degree index into the fragment, see also
+   * `BasicArrowFragmentBuilder::set_degree_index`.
+   */
+  void set_degree_index(bool enabled) { degree_index_ = enabled; }
+
+  /**
+   * @brief Accumulate the time of each phase into the profile (not owned),
+   * nullptr disables the profiling.
+   */
+  void set_profile(LoadProfile* profile) { profile_ = profile; }
+
  private:
-  boost::leaf::result<std::shared_ptr<arrow::ChunkedArray>>
-  parseOidChunkedArray(label_id_t label_id,
-                       std::shared_ptr<arrow::ChunkedArray> oid_arrays_in) {
-    size_t chunk_num = oid_arrays_in->num_chunks();
-    std::vector<std::shared_ptr<arrow::Array>> chunks_out(chunk_num);
+  void constructVertexMap(
+      ObjectID vm_id,
+      const std::vector<std::vector<std::shared_ptr<oid_array_t>>>&
+          oid_lists) {
+    LoadProfile::Timer timer(profile_, LoadProfile::kVertexMap);
+    if (vm_id == InvalidObjectID()) {
+      BasicArrowVertexMapBuilder<internal_oid_t, vid_t> vm_builder(
+          client_, comm_spec_.fnum(), vertex_label_num_, oid_lists);
 
-    ArrowVertexMap<internal_oid_t, vid_t>* vm = vm_ptr_.get();
+      auto vm = vm_builder.Seal(client_);
 
-#if 0
-    for (size_t chunk_i = 0; chunk_i != chunk_num; ++chunk_i) {
-      std::shared_ptr<oid_array_t> oid_array =
-          std::dynamic_pointer_cast<oid_array_t>(oid_arrays_in->chunk(chunk_i));
-      typename vineyard::ConvertToArrowType<vid_t>::BuilderType builder;
-      size_t size = oid_array->length();
-      ARROW_OK_OR_RAISE(builder.Resize(size));
-
-      for (size_t i = 0; i != size; ++i) {
-        internal_oid_t oid = oid_array->GetView(i);
-        fid_t fid = partitioner_.GetPartitionId(oid_t(oid));
-        CHECK_OR_RAISE(vm->GetGid(fid, label_id, oid, builder[i]));
+      vm_ptr_ =
+          std::dynamic_pointer_cast<ArrowVertexMap<internal_oid_t, vid_t>>(
+              client_.GetObject(vm->id()));
+    } else {
+      auto old_vm_ptr =
+          std::dynamic_pointer_cast<ArrowVertexMap<internal_oid_t, vid_t>>(
+              client_.GetObject(vm_id));
+      label_id_t pre_label_num = old_vm_ptr->label_num();
+      std::map<label_id_t, std::vector<std::shared_ptr<oid_array_t>>>
+          oid_lists_map;
+      for (size_t i = 0; i < oid_lists.size(); ++i) {
+        oid_lists_map[pre_label_num + i] = oid_lists[i];
+      }
+      auto new_vm_id = old_vm_ptr->AddVertices(client_, oid_lists_map);
+      vm_ptr_ =
+          std::dynamic_pointer_cast<ArrowVertexMap<internal_oid_t, vid_t>>(
+              client_.GetObject(new_vm_id));
+    }
+  }
+
+  /**
+   * @brief Gather the number of inner vertices of every (fragment, label) for
+   * the partitioned vertex map.
+   */
+  void gatherVertexNums(
+      const std::vector<std::vector<std::shared_ptr<oid_array_t>>>&
+          oid_lists) {
+    fid_t fid = comm_spec_.fid();
+    std::vector<int64_t> local_nums(vertex_label_num_);
+    for (label_id_t v_label = 0; v_label < vertex_label_num_; ++v_label) {
+      local_nums[v_label] = oid_lists[v_label][fid]->length();
+    }
+    std::vector<int64_t> nums(vertex_label_num_ * comm_spec_.worker_num());
+    MPI_Allgather(local_nums.data(), vertex_label_num_, MPI_INT64_T,
+                  nums.data(), vertex_label_num_, MPI_INT64_T,
+                  comm_spec_.comm());
+    vertex_nums_.clear();
+    vertex_nums_.resize(vertex_label_num_,
+                        std::vector<int64_t>(comm_spec_.fnum(), 0));
+    for (int worker = 0; worker < comm_spec_.worker_num(); ++worker) {
+      fid_t worker_fid = comm_spec_.WorkerToFrag(worker);
+      for (label_id_t v_label = 0; v_label < vertex_label_num_; ++v_label) {
+        vertex_nums_[v_label][worker_fid] =
+            nums[worker * vertex_label_num_ + v_label];
       }
-      ARROW_OK_OR_RAISE(builder.Advance(size));
-      ARROW_OK_OR_RAISE(builder.Finish(&chunks_out[chunk_i]));
     }
+  }
+
+  /**
+   * @brief Resolve the gids of the endpoints of the local (not yet shuffled)
+   * edges for the partitioned vertex map.
+   *
+   * The distinct remote oids are grouped by their fragments and sent to the
+   * owners, which look them up in the inner vertices and reply the gids, i.e.,
+   * a batched request per (label, worker) rather than a lookup per edge.
+   */
+  boost::leaf::result<void> resolveRemoteGids() {
+    using gid_array_t = typename ConvertToArrowType<vid_t>::ArrayType;
+    fid_t fnum = comm_spec_.fnum(), fid = comm_spec_.fid();
+    vineyard::IdParser<vid_t> id_parser;
+    id_parser.Init(fnum, vertex_label_num_);
+    const vid_t invalid_gid = std::numeric_limits<vid_t>::max();
+
+    resolved_gids_.clear();
+    resolved_gids_.resize(vertex_label_num_);
+    for (label_id_t v_label = 0; v_label < vertex_label_num_; ++v_label) {
+      auto& resolved = resolved_gids_[v_label];
+      auto const& inner_oids = oid_lists_[v_label][fid];
+      resolved.reserve(inner_oids->length());
+      vid_t gid = id_parser.GenerateId(fid, v_label, 0);
+      for (int64_t k = 0; k < inner_oids->length(); ++k) {
+        resolved.emplace(inner_oids->GetView(k), gid++);
+      }
+
+      std::vector<ska::flat_hash_set<internal_oid_t>> remote_oids(fnum);
+      auto collect = [&](const std::shared_ptr<arrow::ChunkedArray>& column) {
+        for (auto const& chunk : column->chunks()) {
+          auto array = std::dynamic_pointer_cast<oid_array_t>(chunk);
+          std::vector<fid_t> fids(array->length());
+          partitioner_.GetPartitionIds(*array, fids.data());
+          for (int64_t i = 0; i < array->length(); ++i) {
+            if (fids[i] != fid) {
+              remote_oids[fids[i]].insert(array->GetView(i));
+            }
+          }
+        }
+      };
+      for (auto const& pair : input_edge_tables_) {
+        for (auto const& item : pair.second) {
+          if (item.first.first == v_label) {
+            collect(item.second->column(src_column));
+          }
+          if (item.first.second == v_label) {
+            collect(item.second->column(dst_column));
+          }
+        }
+      }
+
+      std::vector<std::shared_ptr<oid_array_t>> requests(fnum), received;
+      for (fid_t target = 0; target < fnum; ++target) {
+        typename ConvertToArrowType<oid_t>::BuilderType builder;
+        for (auto const& oid : remote_oids[target]) {
+          ARROW_OK_OR_RAISE(builder.Append(oid));
+        }
+        ARROW_OK_OR_RAISE(builder.Finish(&requests[target]));
+      }
+      remote_oids.clear();
+      VY_OK_OR_RAISE(
+          FragmentAllToAllArray<oid_t>(comm_spec_, requests, received));
+
+      std::vector<std::shared_ptr<gid_array_t>> replies(fnum), gids;
+      for (fid_t source = 0; source < fnum; ++source) {
+        typename ConvertToArrowType<vid_t>::BuilderType builder;
+        ARROW_OK_OR_RAISE(builder.Reserve(received[source]->length()));
+        for (int64_t k = 0; k < received[source]->length(); ++k) {
+          auto iter = resolved.find(received[source]->GetView(k));
+          builder.UnsafeAppend(iter == resolved.end() ? invalid_gid
+                                                      : iter->second);
+        }
+        ARROW_OK_OR_RAISE(builder.Finish(&replies[source]));
+      }
+      received.clear();
+      VY_OK_OR_RAISE(FragmentAllToAllArray<vid_t>(comm_spec_, replies, gids));
+
+      for (fid_t target = 0; target < fnum; ++target) {
+        if (target == fid) {
+          continue;
+        }
+        for (int64_t k = 0; k < gids[target]->length(); ++k) {
+          if (gids[target]->Value(k) != invalid_gid) {
+            resolved.emplace(requests[target]->GetView(k),
+                             gids[target]->Value(k));
+          }
+        }
+      }
+    }
+    return {};
+  }
+
+  /**
+   * @brief Build the partitioned vertex map from the inner vertices and the
+   * outer vertices of the shuffled edges, the oids of outer vertices are
+   * requested from their owners by gids in batches.
+   */
+  boost::leaf::result<void> constructPartitionedVertexMap() {
+    using gid_array_t = typename ConvertToArrowType<vid_t>::ArrayType;
+    fid_t fnum = comm_spec_.fnum(), fid = comm_spec_.fid();
+    vineyard::IdParser<vid_t> id_parser;
+    id_parser.Init(fnum, vertex_label_num_);
+
+    std::vector<std::vector<std::shared_ptr<oid_array_t>>> oid_arrays(
+        vertex_label_num_);
+    std::vector<std::vector<std::shared_ptr<gid_array_t>>> gid_arrays(
+        vertex_label_num_);
+    for (label_id_t v_label = 0; v_label < vertex_label_num_; ++v_label) {
+      std::vector<std::vector<vid_t>> outer_gids(fnum);
+      for (auto const& table : output_edge_tables_) {
+        for (int column = src_column; column <= dst_column; ++column) {
+          for (auto const& chunk : table->column(column)->chunks()) {
+            auto array = std::dynamic_pointer_cast<gid_array_t>(chunk);
+            for (int64_t i = 0; i < array->length(); ++i) {
+              vid_t gid = array->Value(i);
+              fid_t gid_fid = id_parser.GetFid(gid);
+              if (gid_fid != fid && id_parser.GetLabelId(gid) == v_label) {
+                outer_gids[gid_fid].push_back(gid);
+              }
+            }
+          }
+        }
+      }
+
+      // the cached vertices are sorted by gids
+      std::vector<std::shared_ptr<gid_array_t>> requests(fnum), received;
+      for (fid_t target = 0; target < fnum; ++target) {
+        auto& gids = outer_gids[target];
+        std::sort(gids.begin(), gids.end());
+        gids.erase(std::unique(gids.begin(), gids.end()), gids.end());
+        typename ConvertToArrowType<vid_t>::BuilderType builder;
+        ARROW_OK_OR_RAISE(builder.AppendValues(gids));
+        ARROW_OK_OR_RAISE(builder.Finish(&requests[target]));
+      }
+      outer_gids.clear();
+      VY_OK_OR_RAISE(
+          FragmentAllToAllArray<vid_t>(comm_spec_, requests, received));
+
+      auto const& inner_oids = oid_lists_[v_label][fid];
+      std::vector<std::shared_ptr<oid_array_t>> replies(fnum);
+      for (fid_t source = 0; source < fnum; ++source) {
+        typename ConvertToArrowType<oid_t>::BuilderType builder;
+        for (int64_t k = 0; k < received[source]->length(); ++k) {
+          int64_t offset = id_parser.GetOffset(received[source]->Value(k));
+          if (offset >= inner_oids->length()) {
+            RETURN_GS_ERROR(ErrorCode::kInvalidValueError,
+                            "Invalid gid " +
+                                std::to_string(received[source]->Value(k)));
+          }
+          ARROW_OK_OR_RAISE(builder.Append(inner_oids->GetView(offset)));
+        }
+        ARROW_OK_OR_RAISE(builder.Finish(&replies[source]));
+      }
+      received.clear();
+      VY_OK_OR_RAISE(FragmentAllToAllArray<oid_t>(comm_spec_, replies,
+                                                  oid_arrays[v_label]));
+      oid_arrays[v_label][fid] = inner_oids;
+      gid_arrays[v_label] = std::move(requests);
+    }
+    resolved_gids_.clear();
+    oid_lists_.clear();
+    return buildPartitionedVertexMap(oid_arrays, gid_arrays);
+  }
+
+  template <typename T = internal_oid_t>
+  typename std::enable_if<std::is_arithmetic<T>::value,
+                          boost::leaf::result<void>>::type
+  buildPartitionedVertexMap(
+      const std::vector<std::vector<std::shared_ptr<oid_array_t>>>&
+          oid_arrays,
+      const std::vector<std::vector<
+          std::shared_ptr<typename ConvertToArrowType<vid_t>::ArrayType>>>&
+          gid_arrays) {
+    PartitionedArrowVertexMapBuilder<internal_oid_t, vid_t> vm_builder(
+        client_, comm_spec_.fnum(), comm_spec_.fid(), vertex_label_num_,
+        oid_arrays, gid_arrays, vertex_nums_);
+    auto vm = vm_builder.Seal(client_);
+    vm_ptr_ = std::dynamic_pointer_cast<ArrowVertexMap<internal_oid_t, vid_t>>(
+        client_.GetObject(vm->id()));
+    return {};
+  }
+
+  template <typename T = internal_oid_t>
+  typename std::enable_if<!std::is_arithmetic<T>::value,
+                          boost::leaf::result<void>>::type
+  buildPartitionedVertexMap(
+      const std::vector<std::vector<std::shared_ptr<oid_array_t>>>&,
+      const std::vector<std::vector<
+          std::shared_ptr<typename ConvertToArrowType<vid_t>::ArrayType>>>&) {
+    RETURN_GS_ERROR(ErrorCode::kUnsupportedOperationError,
+                    "The partitioned vertex map requires arithmetic oids");
+  }
+
+  /**
+   * @brief Count the degrees of the local inner vertices from the (not yet
+   * shuffled) edge tables, and then reorder the output vertex tables and the
+   * oid lists of this fragment by the descending order of degrees.
+   */
+  boost::leaf::result<void> reorderVerticesByDegree() {
+    auto id_field = std::make_shared<arrow::Field>(
+        "id", vineyard::ConvertToArrowType<oid_t>::TypeValue());
+    auto id_schema = std::make_shared<arrow::Schema>(
+        std::vector<std::shared_ptr<arrow::Field>>{id_field});
+    fid_t fid = comm_spec_.fid();
+
+    for (label_id_t v_label = 0; v_label < vertex_label_num_; ++v_label) {
+      // send the endpoints of edges to the owners of the vertices
+      std::vector<std::shared_ptr<arrow::Array>> endpoints;
+      for (auto const& pair : input_edge_tables_) {
+        for (auto const& item : pair.second) {
+          if (item.first.first == v_label) {
+            auto const& chunks = item.second->column(src_column)->chunks();
+            endpoints.insert(endpoints.end(), chunks.begin(), chunks.end());
+          }
+          if (item.first.second == v_label) {
+            auto const& chunks = item.second->column(dst_column)->chunks();
+            endpoints.insert(endpoints.end(), chunks.begin(), chunks.end());
+          }
+        }
+      }
+      auto endpoint_table = arrow::Table::Make(
+          id_schema, {std::make_shared<arrow::ChunkedArray>(
+                         endpoints, id_field->type())});
+      auto shuffle_procedure =
+          [&]() -> boost::leaf::result<std::shared_ptr<arrow::Table>> {
+        return beta::ShufflePropertyVertexTable<partitioner_t>(
+            comm_spec_, partitioner_, endpoint_table);
+      };
+      BOOST_LEAF_AUTO(local_endpoints,
+                      sync_gs_error(comm_spec_, shuffle_procedure));
+
+      ska::flat_hash_map<internal_oid_t, int64_t> degrees;
+      for (auto const& chunk : local_endpoints->column(0)->chunks()) {
+        auto array = std::dynamic_pointer_cast<oid_array_t>(chunk);
+        for (int64_t i = 0; i < array->length(); ++i) {
+          degrees[array->GetView(i)] += 1;
+        }
+      }
+
+      auto oid_array = oid_lists_[v_label][fid];
+      std::vector<int64_t> vertex_degrees(oid_array->length(), 0);
+      for (int64_t i = 0; i < oid_array->length(); ++i) {
+        auto iter = degrees.find(oid_array->GetView(i));
+        if (iter != degrees.end()) {
+          vertex_degrees[i] = iter->second;
+        }
+      }
+      std::vector<int64_t> order(oid_array->length());
+      for (size_t i = 0; i < order.size(); ++i) {
+        order[i] = i;
+      }
+      std::stable_sort(order.begin(), order.end(),
+                       [&vertex_degrees](int64_t lhs, int64_t rhs) {
+                         return vertex_degrees[lhs] > vertex_degrees[rhs];
+                       });
+
+      // permute the vertex table and the oid array in the same order
+      std::shared_ptr<arrow::Array> indices;
+      {
+        arrow::Int64Builder builder;
+        ARROW_OK_OR_RAISE(builder.AppendValues(order));
+        ARROW_OK_OR_RAISE(builder.Finish(&indices));
+      }
+      auto& vertex_table = output_vertex_tables_[v_label];
+      auto metadata = vertex_table->schema()->metadata();
+#if defined(ARROW_VERSION) && ARROW_VERSION < 1000000
+      arrow::compute::FunctionContext ctx;
+      ARROW_OK_OR_RAISE(arrow::compute::Take(&ctx, *vertex_table, *indices,
+                                             arrow::compute::TakeOptions(),
+                                             &vertex_table));
+#else
+      arrow::Datum taken;
+      CHECK_ARROW_ERROR_AND_ASSIGN(
+          taken, arrow::compute::Take(vertex_table, indices));
+      vertex_table = taken.table();
+#endif
+      vertex_table = vertex_table->ReplaceSchemaMetadata(metadata);
+
+      std::shared_ptr<oid_array_t> reordered_oid_array;
+      {
+        typename ConvertToArrowType<oid_t>::BuilderType builder;
+        for (auto const& index : order) {
+          ARROW_OK_OR_RAISE(builder.Append(oid_array->GetView(index)));
+        }
+        ARROW_OK_OR_RAISE(builder.Finish(&reordered_oid_array));
+      }
+      VY_OK_OR_RAISE(FragmentAllGatherArray<oid_t>(
+          comm_spec_, reordered_oid_array, oid_lists_[v_label]));
+    }
+    return {};
+  }
+
+  /**
+   * @brief Translates the oid columns into gid columns.
+   *
+   * All chunks of all columns are split into fixed-size ranges that are
+   * translated on the thread pool, a large chunk doesn't serialize the
+   * translation. The gids are looked up in batches (which prefetch the
+   * hashmap slots, see `ArrowVertexMap::GetGids`) and are written directly
+   * into the pre-allocated gid arrays.
+   */
+  boost::leaf::result<std::vector<std::shared_ptr<arrow::ChunkedArray>>>
+  parseOidChunkedArrays(
+      std::vector<label_id_t> const& label_ids,
+      std::vector<std::shared_ptr<arrow::ChunkedArray>> const& oid_arrays_in) {
+    constexpr int64_t kRangeSize = 64 * 1024;
+    using gid_array_t = typename ConvertToArrowType<vid_t>::ArrayType;
+
+    struct range_t {
+      size_t column, chunk;
+      int64_t begin, end;
+    };
+
+    ArrowVertexMap<internal_oid_t, vid_t>* vm = vm_ptr_.get();
+
+    std::vector<std::vector<std::shared_ptr<arrow::Buffer>>> buffers(
+        oid_arrays_in.size());
+    std::vector<range_t> ranges;
+    for (size_t column = 0; column < oid_arrays_in.size(); ++column) {
+      auto const& oid_arrays = oid_arrays_in[column];
+      buffers[column].resize(oid_arrays->num_chunks());
+      for (int chunk = 0; chunk < oid_arrays->num_chunks(); ++chunk) {
+        int64_t length = oid_arrays->chunk(chunk)->length();
+        auto& buffer = buffers[column][chunk];
+#if defined(ARROW_VERSION) && ARROW_VERSION < 17000
+        ARROW_OK_OR_RAISE(
+            arrow::AllocateBuffer(arrow::default_memory_pool(),
+                                  length * sizeof(vid_t), &buffer));
 #else
+        ARROW_OK_ASSIGN_OR_RAISE(
+            buffer, arrow::AllocateBuffer(length * sizeof(vid_t),
+                                          arrow::default_memory_pool()));
+#endif
+        for (int64_t begin = 0; begin < length; begin += kRangeSize) {
+          ranges.push_back(range_t{column, static_cast<size_t>(chunk), begin,
+                                   std::min(length, begin + kRangeSize)});
+        }
+      }
+    }
+
     int thread_num =
         (std::thread::hardware_concurrency() + comm_spec_.local_num() - 1) /
         comm_spec_.local_num();
-    std::vector<std::thread> parse_threads(thread_num);
-
-    std::atomic<size_t> cur(0);
-    std::vector<arrow::Status> statuses(thread_num, arrow::Status::OK());
-    for (int i = 0; i < thread_num; ++i) {
-      parse_threads[i] = std::thread(
-          [&](int tid) {
-            while (true) {
-              auto got = cur.fetch_add(1);
-              if (got >= chunk_num) {
-                break;
-              }
-              std::shared_ptr<oid_array_t> oid_array =
-                  std::dynamic_pointer_cast<oid_array_t>(
-                      oid_arrays_in->chunk(got));
-              typename ConvertToArrowType<vid_t>::BuilderType builder;
-              size_t size = oid_array->length();
-
-              arrow::Status status = builder.Resize(size);
-              if (!status.ok()) {
-                statuses[tid] = status;
-                return;
-              }
-
-              for (size_t k = 0; k != size; ++k) {
-                internal_oid_t oid = oid_array->GetView(k);
-                fid_t fid = partitioner_.GetPartitionId(oid_t(oid));
-                if (!vm->GetGid(fid, label_id, oid, builder[k])) {
-                  LOG(ERROR) << "Mapping vertex " << oid << " failed.";
-                }
-              }
-
-              status = builder.Advance(size);
-              if (!status.ok()) {
-                statuses[tid] = status;
-                return;
+    parallel_for(
+        static_cast<size_t>(0), ranges.size(),
+        [&](size_t index) {
+          auto const& range = ranges[index];
+          auto oid_array = std::dynamic_pointer_cast<oid_array_t>(
+              oid_arrays_in[range.column]->chunk(range.chunk));
+          label_id_t label_id = label_ids[range.column];
+          size_t size = range.end - range.begin;
+          auto& buffer = buffers[range.column][range.chunk];
+          vid_t* gids =
+              reinterpret_cast<vid_t*>(buffer->mutable_data()) + range.begin;
+
+          std::vector<internal_oid_t> views;
+          const internal_oid_t* oids =
+              oidValues(*oid_array, range.begin, range.end, views);
+          if (!resolved_gids_.empty()) {
+            // the partitioned vertex map hasn't been built yet
+            auto const& resolved = resolved_gids_[label_id];
+            for (size_t k = 0; k != size; ++k) {
+              auto iter = resolved.find(oids[k]);
+              if (iter == resolved.end()) {
+                LOG(ERROR) << "Mapping vertex " << oids[k] << " failed.";
+                gids[k] = 0;
+              } else {
+                gids[k] = iter->second;
               }
-              status = builder.Finish(&chunks_out[got]);
-              if (!status.ok()) {
-                statuses[tid] = status;
-                return;
+            }
+            return;
+          }
+          std::vector<fid_t> fids(size);
+          partitioner_.GetPartitionIds(*oid_array->Slice(range.begin, size),
+                                       fids.data());
+          if (vm->GetGids(label_id, fids.data(), oids, size, gids) != size) {
+            for (size_t k = 0; k != size; ++k) {
+              if (!vm->GetGid(fids[k], label_id, oids[k], gids[k])) {
+                LOG(ERROR) << "Mapping vertex " << oids[k] << " failed.";
+                gids[k] = 0;
               }
             }
-          },
-          i);
-    }
-    for (auto& thrd : parse_threads) {
-      thrd.join();
-    }
-    for (auto& status : statuses) {
-      if (!status.ok()) {
-        RETURN_GS_ERROR(ErrorCode::kArrowError, status.ToString());
+          }
+        },
+        thread_num, 1);
+
+    std::vector<std::shared_ptr<arrow::ChunkedArray>> gid_arrays;
+    for (size_t column = 0; column < oid_arrays_in.size(); ++column) {
+      std::vector<std::shared_ptr<arrow::Array>> chunks_out;
+      for (auto& buffer : buffers[column]) {
+        chunks_out.push_back(std::make_shared<gid_array_t>(
+            buffer->size() / sizeof(vid_t), buffer));
       }
+      gid_arrays.push_back(std::make_shared<arrow::ChunkedArray>(
+          chunks_out, ConvertToArrowType<vid_t>::TypeValue()));
     }
-#endif
+    return gid_arrays;
+  }
+
+  // the oids are read in place if they are arithmetic values.
+  template <typename T = internal_oid_t>
+  static typename std::enable_if<std::is_arithmetic<T>::value, const T*>::type
+  oidValues(const oid_array_t& array, int64_t begin, int64_t,
+            std::vector<T>&) {
+    return array.raw_values() + begin;
+  }
 
-    return std::make_shared<arrow::ChunkedArray>(chunks_out);
+  template <typename T = internal_oid_t>
+  static typename std::enable_if<!std::is_arithmetic<T>::value, const T*>::type
+  oidValues(const oid_array_t& array, int64_t begin, int64_t end,
+            std::vector<T>& views) {
+    views.resize(end - begin);
+    for (int64_t k = begin; k < end; ++k) {
+      views[k - begin] = array.GetView(k);
+    }
+    return views.data();
   }
 
   boost::leaf::result<void> initSchema(PropertyGraphSchema& schema) {
@@ -651,6 +1168,11 @@ class BasicEVFragmentLoader {
   bool directed_;
   bool retain_oid_;
   bool generate_eid_;
+  bool reorder_vertices_ = false;
+  bool partitioned_vertex_map_ = false;
+  bool degree_index_ = false;
+  int64_t edge_batch_size_ = 1 << 22;
+  LoadProfile* profile_ = nullptr;
 
   std::map<std::string, label_id_t> vertex_label_to_index_;
   std::vector<std::string> vertex_labels_;
@@ -671,6 +1193,17 @@ class BasicEVFragmentLoader {
   std::vector<std::shared_ptr<arrow::Table>> output_edge_tables_;
   std::vector<std::set<std::pair<label_id_t, label_id_t>>> edge_relations_;
 
+  // the oid lists and the vertex map to extend, if the construction of vertex
+  // map is deferred by the reordering.
+  std::vector<std::vector<std::shared_ptr<oid_array_t>>> oid_lists_;
+  ObjectID vm_id_ = InvalidObjectID();
+
+  // for the partitioned vertex map: label -> fid -> the number of vertices,
+  // and label -> oid -> gid of the inner vertices and the remote endpoints
+  // of local edges, which is released after the edges are converted.
+  std::vector<std::vector<int64_t>> vertex_nums_;
+  std::vector<ska::flat_hash_map<internal_oid_t, vid_t>> resolved_gids_;
+
   std::shared_ptr<ArrowVertexMap<internal_oid_t, vid_t>> vm_ptr_;
 };
 
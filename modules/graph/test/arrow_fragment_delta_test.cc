@@ -0,0 +1,296 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <stdio.h>
+
+#include <algorithm>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "glog/logging.h"
+
+#include "client/client.h"
+
+#include "graph/fragment/arrow_fragment.h"
+#include "graph/fragment/arrow_fragment_delta.h"
+#include "graph/loader/arrow_fragment_loader.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+using GraphType = ArrowFragment<property_graph_types::OID_TYPE,
+                                property_graph_types::VID_TYPE>;
+using DeltaType = ArrowFragmentDelta<property_graph_types::OID_TYPE,
+                                     property_graph_types::VID_TYPE>;
+using LabelType = typename GraphType::label_id_t;
+
+std::string FormatValue(const std::shared_ptr<arrow::ChunkedArray>& column,
+                        int64_t index) {
+  for (auto const& chunk : column->chunks()) {
+    if (index >= chunk->length()) {
+      index -= chunk->length();
+      continue;
+    }
+    switch (chunk->type()->id()) {
+    case arrow::Type::INT32:
+      return std::to_string(
+          std::dynamic_pointer_cast<arrow::Int32Array>(chunk)->Value(index));
+    case arrow::Type::INT64:
+      return std::to_string(
+          std::dynamic_pointer_cast<arrow::Int64Array>(chunk)->Value(index));
+    case arrow::Type::DOUBLE:
+      return std::to_string(
+          std::dynamic_pointer_cast<arrow::DoubleArray>(chunk)->Value(index));
+    case arrow::Type::STRING:
+      return std::dynamic_pointer_cast<arrow::StringArray>(chunk)->GetString(
+          index);
+    case arrow::Type::LARGE_STRING:
+      return std::dynamic_pointer_cast<arrow::LargeStringArray>(chunk)
+          ->GetString(index);
+    default:
+      return chunk->type()->ToString();
+    }
+  }
+  return "";
+}
+
+// the (sorted) lines of the inner vertices and their outgoing edges, with
+// the properties, which don't depend on the lids and eids
+std::vector<std::string> DumpFragment(const std::shared_ptr<GraphType>& frag) {
+  std::vector<std::string> lines;
+  for (LabelType v_label = 0; v_label < frag->vertex_label_num(); ++v_label) {
+    auto table = frag->vertex_data_table(v_label);
+    for (auto v : frag->InnerVertices(v_label)) {
+      std::stringstream ss;
+      ss << "v " << v_label << " " << frag->GetId(v);
+      for (int prop = 0; prop < table->num_columns(); ++prop) {
+        ss << " " << FormatValue(table->column(prop), frag->vertex_offset(v));
+      }
+      lines.emplace_back(ss.str());
+    }
+  }
+  for (LabelType e_label = 0; e_label < frag->edge_label_num(); ++e_label) {
+    auto table = frag->edge_data_table(e_label);
+    for (LabelType v_label = 0; v_label < frag->vertex_label_num();
+         ++v_label) {
+      for (auto v : frag->InnerVertices(v_label)) {
+        for (auto& e : frag->GetOutgoingAdjList(v, e_label)) {
+          std::stringstream ss;
+          ss << "e " << e_label << " " << frag->GetId(v) << " "
+             << frag->GetId(e.neighbor());
+          for (int prop = 0; prop < table->num_columns(); ++prop) {
+            ss << " " << FormatValue(table->column(prop), e.edge_id());
+          }
+          lines.emplace_back(ss.str());
+        }
+      }
+    }
+  }
+  std::sort(lines.begin(), lines.end());
+  return lines;
+}
+
+// re-appends every 7th edge of every label through the delta, and checks
+// the delta view, and the fragment compacted from the delta.
+void TestDelta(Client& client, const std::shared_ptr<GraphType>& frag) {
+  std::vector<std::string> expected = DumpFragment(frag);
+  DeltaType delta(frag);
+
+  // new eid - base edge num -> the eid of the copied edge
+  std::vector<std::vector<GraphType::eid_t>> origins(frag->edge_label_num());
+  for (LabelType e_label = 0; e_label < frag->edge_label_num(); ++e_label) {
+    auto table = frag->edge_data_table(e_label);
+    std::set<GraphType::eid_t> copied;
+    for (LabelType v_label = 0; v_label < frag->vertex_label_num();
+         ++v_label) {
+      for (auto v : frag->InnerVertices(v_label)) {
+        for (auto& e : frag->GetOutgoingAdjList(v, e_label)) {
+          if (e.edge_id() % 7 != 0) {
+            continue;
+          }
+          // every occurrence of the copied edges is doubled
+          std::stringstream ss;
+          ss << "e " << e_label << " " << frag->GetId(v) << " "
+             << frag->GetId(e.neighbor());
+          for (int prop = 0; prop < table->num_columns(); ++prop) {
+            ss << " " << FormatValue(table->column(prop), e.edge_id());
+          }
+          expected.emplace_back(ss.str());
+          if (!copied.insert(e.edge_id()).second) {
+            continue;
+          }
+
+          auto u = e.neighbor();
+          boost::leaf::try_handle_all(
+              [&]() {
+                return delta.AddEdges(e_label, frag->vertex_label(v),
+                                      {frag->GetId(v)}, frag->vertex_label(u),
+                                      {frag->GetId(u)},
+                                      table->Slice(e.edge_id(), 1));
+              },
+              [](const GSError& e) { LOG(FATAL) << e.error_msg; },
+              [](const boost::leaf::error_info& unmatched) {
+                LOG(FATAL) << "Unmatched error " << unmatched;
+              });
+          origins[e_label].push_back(e.edge_id());
+        }
+      }
+    }
+  }
+  std::sort(expected.begin(), expected.end());
+
+  size_t appended = 0;
+  for (auto const& items : origins) {
+    appended += items.size();
+  }
+  CHECK_EQ(delta.DeltaEdgeNum(), appended);
+
+  // the delta view: the base neighbors, followed by the appended ones with
+  // the properties of the copied edges
+  for (LabelType e_label = 0; e_label < frag->edge_label_num(); ++e_label) {
+    auto table = frag->edge_data_table(e_label);
+    GraphType::eid_t base = table->num_rows();
+    for (LabelType v_label = 0; v_label < frag->vertex_label_num();
+         ++v_label) {
+      for (auto v : frag->InnerVertices(v_label)) {
+        std::multiset<GraphType::vid_t> copies;
+        for (auto& e : frag->GetOutgoingAdjList(v, e_label)) {
+          if (e.edge_id() % 7 == 0) {
+            copies.insert(e.neighbor().GetValue());
+          }
+        }
+        auto adj_list = delta.GetOutgoingAdjList(v, e_label);
+        CHECK_EQ(adj_list.Size(),
+                 frag->GetLocalOutDegree(v, e_label) + copies.size());
+        std::multiset<GraphType::vid_t> appended_nbrs;
+        for (auto const& nbr : adj_list) {
+          if (nbr.eid < base) {
+            continue;
+          }
+          appended_nbrs.insert(nbr.vid);
+          auto origin = origins[e_label][nbr.eid - base];
+          for (int prop = 0; prop < table->num_columns(); ++prop) {
+            auto type = frag->edge_property_type(e_label, prop);
+            if (type->Equals(arrow::int64())) {
+              CHECK_EQ(delta.GetEdgeData<int64_t>(e_label, nbr.eid, prop),
+                       delta.GetEdgeData<int64_t>(e_label, origin, prop));
+            } else if (type->Equals(arrow::float64())) {
+              CHECK_EQ(delta.GetEdgeData<double>(e_label, nbr.eid, prop),
+                       delta.GetEdgeData<double>(e_label, origin, prop));
+            }
+          }
+        }
+        CHECK(appended_nbrs == copies);
+      }
+    }
+  }
+
+  ObjectID compacted_id = boost::leaf::try_handle_all(
+      [&]() { return delta.Compact(client); },
+      [](const GSError& e) {
+        LOG(FATAL) << e.error_msg;
+        return InvalidObjectID();
+      },
+      [](const boost::leaf::error_info& unmatched) {
+        LOG(FATAL) << "Unmatched error " << unmatched;
+        return InvalidObjectID();
+      });
+  auto compacted =
+      std::dynamic_pointer_cast<GraphType>(client.GetObject(compacted_id));
+  CHECK(compacted != nullptr);
+  CHECK_EQ(delta.DeltaEdgeNum(), 0);
+  CHECK_EQ(delta.fragment()->id(), compacted_id);
+  for (LabelType e_label = 0; e_label < frag->edge_label_num(); ++e_label) {
+    CHECK_EQ(compacted->edge_data_table(e_label)->num_rows(),
+             frag->edge_data_table(e_label)->num_rows() +
+                 static_cast<int64_t>(origins[e_label].size()));
+  }
+  CHECK(DumpFragment(compacted) == expected);
+
+  // compacting an empty delta keeps the fragment
+  CHECK_EQ(boost::leaf::try_handle_all(
+               [&]() { return delta.Compact(client); },
+               [](const boost::leaf::error_info& unmatched) {
+                 LOG(FATAL) << "Unmatched error " << unmatched;
+                 return InvalidObjectID();
+               }),
+           compacted_id);
+}
+
+int main(int argc, char** argv) {
+  if (argc < 6) {
+    printf(
+        "usage: ./arrow_fragment_delta_test <ipc_socket> <e_label_num> "
+        "<efiles...> <v_label_num> <vfiles...> [directed]\n");
+    return 1;
+  }
+  int index = 1;
+  std::string ipc_socket = std::string(argv[index++]);
+
+  int edge_label_num = atoi(argv[index++]);
+  std::vector<std::string> efiles;
+  for (int i = 0; i < edge_label_num; ++i) {
+    efiles.push_back(argv[index++]);
+  }
+
+  int vertex_label_num = atoi(argv[index++]);
+  std::vector<std::string> vfiles;
+  for (int i = 0; i < vertex_label_num; ++i) {
+    vfiles.push_back(argv[index++]);
+  }
+
+  int directed = 1;
+  if (argc > index) {
+    directed = atoi(argv[index]);
+  }
+
+  vineyard::Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+
+  LOG(INFO) << "Connected to IPCServer: " << ipc_socket;
+
+  grape::InitMPIComm();
+
+  {
+    grape::CommSpec comm_spec;
+    comm_spec.Init(MPI_COMM_WORLD);
+
+    auto loader =
+        std::make_unique<ArrowFragmentLoader<property_graph_types::OID_TYPE,
+                                             property_graph_types::VID_TYPE>>(
+            client, comm_spec, efiles, vfiles, directed != 0);
+    vineyard::ObjectID fragment_id = boost::leaf::try_handle_all(
+        [&loader]() { return loader->LoadFragment(); },
+        [](const GSError& e) {
+          LOG(FATAL) << e.error_msg;
+          return 0;
+        },
+        [](const boost::leaf::error_info& unmatched) {
+          LOG(FATAL) << "Unmatched error " << unmatched;
+          return 0;
+        });
+    auto frag =
+        std::dynamic_pointer_cast<GraphType>(client.GetObject(fragment_id));
+    TestDelta(client, frag);
+
+    MPI_Barrier(comm_spec.comm());
+  }
+  grape::FinalizeMPIComm();
+
+  LOG(INFO) << "Passed arrow fragment delta test...";
+
+  return 0;
+}
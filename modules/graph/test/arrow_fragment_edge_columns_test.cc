@@ -0,0 +1,236 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <stdio.h>
+
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "glog/logging.h"
+
+#include "client/client.h"
+
+#include "graph/fragment/arrow_fragment.h"
+#include "graph/loader/arrow_fragment_loader.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+using GraphType = ArrowFragment<property_graph_types::OID_TYPE,
+                                property_graph_types::VID_TYPE>;
+using LabelType = typename GraphType::label_id_t;
+
+std::string FormatValue(const std::shared_ptr<arrow::ChunkedArray>& column,
+                        int64_t index) {
+  for (auto const& chunk : column->chunks()) {
+    if (index >= chunk->length()) {
+      index -= chunk->length();
+      continue;
+    }
+    switch (chunk->type()->id()) {
+    case arrow::Type::INT32:
+      return std::to_string(
+          std::dynamic_pointer_cast<arrow::Int32Array>(chunk)->Value(index));
+    case arrow::Type::INT64:
+      return std::to_string(
+          std::dynamic_pointer_cast<arrow::Int64Array>(chunk)->Value(index));
+    case arrow::Type::DOUBLE:
+      return std::to_string(
+          std::dynamic_pointer_cast<arrow::DoubleArray>(chunk)->Value(index));
+    case arrow::Type::STRING:
+      return std::dynamic_pointer_cast<arrow::StringArray>(chunk)->GetString(
+          index);
+    case arrow::Type::LARGE_STRING:
+      return std::dynamic_pointer_cast<arrow::LargeStringArray>(chunk)
+          ->GetString(index);
+    default:
+      return chunk->type()->ToString();
+    }
+  }
+  return "";
+}
+
+using LabelColumns = std::map<
+    LabelType,
+    std::vector<std::pair<std::string, std::shared_ptr<arrow::Array>>>>;
+
+std::shared_ptr<GraphType> AddEdgeColumns(Client& client,
+                                          const std::shared_ptr<GraphType>& frag,
+                                          const LabelColumns& columns) {
+  ObjectID id = boost::leaf::try_handle_all(
+      [&]() { return frag->AddEdgeColumns(client, columns); },
+      [](const GSError& e) {
+        LOG(FATAL) << e.error_msg;
+        return InvalidObjectID();
+      },
+      [](const boost::leaf::error_info& unmatched) {
+        LOG(FATAL) << "Unmatched error " << unmatched;
+        return InvalidObjectID();
+      });
+  return std::dynamic_pointer_cast<GraphType>(client.GetObject(id));
+}
+
+// the value of the added column of the edge `eid`
+int64_t AddedValue(LabelType e_label, GraphType::eid_t eid) {
+  return static_cast<int64_t>(eid) * 2 + e_label;
+}
+
+// adds an int64 column to every edge label, and checks that the topology,
+// the vertices and the existing properties are kept, and the new property
+// follows the edge ids.
+void TestAddEdgeColumns(Client& client,
+                        const std::shared_ptr<GraphType>& frag) {
+  LabelColumns columns;
+  for (LabelType e_label = 0; e_label < frag->edge_label_num(); ++e_label) {
+    int64_t edge_num = frag->edge_data_table(e_label)->num_rows();
+    arrow::Int64Builder builder;
+    for (int64_t eid = 0; eid < edge_num; ++eid) {
+      CHECK(builder.Append(AddedValue(e_label, eid)).ok());
+    }
+    std::shared_ptr<arrow::Array> array;
+    CHECK(builder.Finish(&array).ok());
+    columns[e_label].emplace_back("added_" + std::to_string(e_label), array);
+  }
+  auto extended = AddEdgeColumns(client, frag, columns);
+  CHECK(extended != nullptr);
+  CHECK_NE(extended->id(), frag->id());
+
+  for (LabelType v_label = 0; v_label < frag->vertex_label_num(); ++v_label) {
+    CHECK_EQ(extended->vertex_property_num(v_label),
+             frag->vertex_property_num(v_label));
+    CHECK_EQ(extended->vertex_data_table(v_label)->num_rows(),
+             frag->vertex_data_table(v_label)->num_rows());
+  }
+  for (LabelType e_label = 0; e_label < frag->edge_label_num(); ++e_label) {
+    auto table = frag->edge_data_table(e_label);
+    GraphType::prop_id_t added = frag->edge_property_num(e_label);
+    CHECK_EQ(extended->edge_property_num(e_label), added + 1);
+    CHECK(extended->edge_property_type(e_label, added)->Equals(arrow::int64()));
+    CHECK_EQ(extended->schema().GetEdgePropertyId(
+                 e_label, "added_" + std::to_string(e_label)),
+             added);
+    auto extended_table = extended->edge_data_table(e_label);
+    for (LabelType v_label = 0; v_label < frag->vertex_label_num();
+         ++v_label) {
+      for (auto v : frag->InnerVertices(v_label)) {
+        auto adj_list = frag->GetOutgoingAdjList(v, e_label);
+        auto extended_adj_list = extended->GetOutgoingAdjList(v, e_label);
+        CHECK_EQ(extended_adj_list.Size(), adj_list.Size());
+        auto iter = extended_adj_list.begin();
+        for (auto& e : adj_list) {
+          auto const& nbr = *iter;
+          CHECK(nbr.neighbor() == e.neighbor());
+          CHECK_EQ(nbr.edge_id(), e.edge_id());
+          for (int prop = 0; prop < added; ++prop) {
+            CHECK_EQ(FormatValue(extended_table->column(prop), e.edge_id()),
+                     FormatValue(table->column(prop), e.edge_id()));
+          }
+          CHECK_EQ(nbr.get_data<int64_t>(added),
+                   AddedValue(e_label, e.edge_id()));
+          ++iter;
+        }
+      }
+    }
+  }
+
+  // the columns must be aligned with the edges
+  if (frag->edge_data_table(0)->num_rows() > 0) {
+    LabelColumns misaligned;
+    auto column = columns[0][0].second;
+    misaligned[0].emplace_back("misaligned",
+                               column->Slice(0, column->length() - 1));
+    bool rejected = boost::leaf::try_handle_all(
+        [&]() -> boost::leaf::result<bool> {
+          BOOST_LEAF_CHECK(frag->AddEdgeColumns(client, misaligned));
+          return false;
+        },
+        [](const GSError& e) {
+          CHECK(e.error_code == ErrorCode::kVineyardError);
+          return true;
+        },
+        [](const boost::leaf::error_info& unmatched) {
+          LOG(FATAL) << "Unmatched error " << unmatched;
+          return false;
+        });
+    CHECK(rejected);
+  }
+}
+
+int main(int argc, char** argv) {
+  if (argc < 6) {
+    printf(
+        "usage: ./arrow_fragment_edge_columns_test <ipc_socket> <e_label_num> "
+        "<efiles...> <v_label_num> <vfiles...> [directed]\n");
+    return 1;
+  }
+  int index = 1;
+  std::string ipc_socket = std::string(argv[index++]);
+
+  int edge_label_num = atoi(argv[index++]);
+  std::vector<std::string> efiles;
+  for (int i = 0; i < edge_label_num; ++i) {
+    efiles.push_back(argv[index++]);
+  }
+
+  int vertex_label_num = atoi(argv[index++]);
+  std::vector<std::string> vfiles;
+  for (int i = 0; i < vertex_label_num; ++i) {
+    vfiles.push_back(argv[index++]);
+  }
+
+  int directed = 1;
+  if (argc > index) {
+    directed = atoi(argv[index]);
+  }
+
+  vineyard::Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+
+  LOG(INFO) << "Connected to IPCServer: " << ipc_socket;
+
+  grape::InitMPIComm();
+
+  {
+    grape::CommSpec comm_spec;
+    comm_spec.Init(MPI_COMM_WORLD);
+
+    auto loader =
+        std::make_unique<ArrowFragmentLoader<property_graph_types::OID_TYPE,
+                                             property_graph_types::VID_TYPE>>(
+            client, comm_spec, efiles, vfiles, directed != 0);
+    vineyard::ObjectID fragment_id = boost::leaf::try_handle_all(
+        [&loader]() { return loader->LoadFragment(); },
+        [](const GSError& e) {
+          LOG(FATAL) << e.error_msg;
+          return 0;
+        },
+        [](const boost::leaf::error_info& unmatched) {
+          LOG(FATAL) << "Unmatched error " << unmatched;
+          return 0;
+        });
+    auto frag =
+        std::dynamic_pointer_cast<GraphType>(client.GetObject(fragment_id));
+    TestAddEdgeColumns(client, frag);
+
+    MPI_Barrier(comm_spec.comm());
+  }
+  grape::FinalizeMPIComm();
+
+  LOG(INFO) << "Passed arrow fragment edge columns test...";
+
+  return 0;
+}
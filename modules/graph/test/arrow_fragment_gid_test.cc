@@ -0,0 +1,174 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <stdio.h>
+
+#include <algorithm>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "glog/logging.h"
+
+#include "client/client.h"
+
+#include "graph/fragment/arrow_fragment.h"
+#include "graph/loader/arrow_fragment_loader.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+using GraphType = ArrowFragment<property_graph_types::OID_TYPE,
+                                property_graph_types::VID_TYPE>;
+using LabelType = typename GraphType::label_id_t;
+using LoaderType = ArrowFragmentLoader<property_graph_types::OID_TYPE,
+                                       property_graph_types::VID_TYPE>;
+
+// the edges are many more than a translation range of the loader, thus the
+// src and dst columns are translated by many ranges in parallel
+constexpr int64_t kEdgeNum = 500000;
+constexpr int64_t kVertexNums[2] = {100003, 70001};
+constexpr int64_t kVertexBases[2] = {0, 1000000};
+
+int64_t VertexOf(int label, int64_t key, uint64_t factor) {
+  uint64_t hash = static_cast<uint64_t>(key) * factor + 7;
+  return kVertexBases[label] + static_cast<int64_t>(hash % kVertexNums[label]);
+}
+
+// the edges of the i-th file are from "v<i>" to "v<1 - i>", identified by
+// the key, from which the endpoints are derived
+int64_t SrcOf(int file, int64_t key) {
+  return VertexOf(file, key, 2654435761ULL);
+}
+
+int64_t DstOf(int file, int64_t key) { return VertexOf(1 - file, key, 40503); }
+
+std::string VertexFile(const std::string& dir, int label) {
+  return dir + "/gid_test_v" + std::to_string(label) + ".csv";
+}
+
+std::string EdgeFile(const std::string& dir, int file) {
+  return dir + "/gid_test_e" + std::to_string(file) + ".csv";
+}
+
+void WriteFiles(const std::string& dir) {
+  for (int label = 0; label < 2; ++label) {
+    std::ofstream os(VertexFile(dir, label));
+    CHECK(os.good());
+    os << "id,weight\n";
+    for (int64_t index = 0; index < kVertexNums[label]; ++index) {
+      os << kVertexBases[label] + index << "," << index % 1000 << "\n";
+    }
+  }
+  for (int file = 0; file < 2; ++file) {
+    std::ofstream os(EdgeFile(dir, file));
+    CHECK(os.good());
+    os << "src,dst,key\n";
+    for (int64_t key = file * kEdgeNum; key < (file + 1) * kEdgeNum; ++key) {
+      os << SrcOf(file, key) << "," << DstOf(file, key) << "," << key << "\n";
+    }
+  }
+}
+
+// every edge of the files whose source is an inner vertex must be an
+// outgoing edge of the fragment, with the endpoints of the files
+void TestGids(const std::shared_ptr<GraphType>& frag) {
+  CHECK_EQ(frag->edge_label_num(), 1);
+  CHECK_EQ(frag->edge_data_table(0)->schema()->field(0)->name(), "key");
+  std::vector<int64_t> keys;
+  for (LabelType v_label = 0; v_label < frag->vertex_label_num(); ++v_label) {
+    for (auto v : frag->InnerVertices(v_label)) {
+      for (auto& e : frag->GetOutgoingAdjList(v, 0)) {
+        int64_t key = e.get_data<int64_t>(0);
+        int file = static_cast<int>(key / kEdgeNum);
+        CHECK_EQ(frag->GetId(v), SrcOf(file, key));
+        CHECK_EQ(frag->GetId(e.neighbor()), DstOf(file, key));
+        keys.push_back(key);
+      }
+    }
+  }
+  std::sort(keys.begin(), keys.end());
+
+  std::vector<int64_t> expected_keys;
+  for (int file = 0; file < 2; ++file) {
+    LabelType src_label =
+        frag->schema().GetVertexLabelId("v" + std::to_string(file));
+    for (int64_t key = file * kEdgeNum; key < (file + 1) * kEdgeNum; ++key) {
+      GraphType::vertex_t v;
+      if (frag->GetInnerVertex(src_label, SrcOf(file, key), v)) {
+        expected_keys.push_back(key);
+      }
+    }
+  }
+  CHECK(keys == expected_keys);
+  LOG(INFO) << "Checked " << keys.size() << " edges";
+}
+
+int main(int argc, char** argv) {
+  if (argc < 3) {
+    printf("usage: ./arrow_fragment_gid_test <ipc_socket> <data_dir>\n");
+    return 1;
+  }
+  std::string ipc_socket = std::string(argv[1]);
+  std::string data_dir = std::string(argv[2]);
+
+  vineyard::Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+
+  LOG(INFO) << "Connected to IPCServer: " << ipc_socket;
+
+  grape::InitMPIComm();
+
+  {
+    grape::CommSpec comm_spec;
+    comm_spec.Init(MPI_COMM_WORLD);
+
+    if (comm_spec.worker_id() == 0) {
+      WriteFiles(data_dir);
+    }
+    MPI_Barrier(comm_spec.comm());
+
+    std::vector<std::string> efiles, vfiles;
+    for (int label = 0; label < 2; ++label) {
+      vfiles.push_back(VertexFile(data_dir, label) + "#label=v" +
+                       std::to_string(label));
+    }
+    efiles.push_back(EdgeFile(data_dir, 0) +
+                     "#label=e&src_label=v0&dst_label=v1;" +
+                     EdgeFile(data_dir, 1) +
+                     "#label=e&src_label=v1&dst_label=v0");
+
+    auto loader =
+        std::make_unique<LoaderType>(client, comm_spec, efiles, vfiles, true);
+    ObjectID frag_id = boost::leaf::try_handle_all(
+        [&loader]() { return loader->LoadFragment(); },
+        [](const GSError& e) {
+          LOG(FATAL) << e.error_msg;
+          return InvalidObjectID();
+        },
+        [](const boost::leaf::error_info& unmatched) {
+          LOG(FATAL) << "Unmatched error " << unmatched;
+          return InvalidObjectID();
+        });
+    TestGids(std::dynamic_pointer_cast<GraphType>(client.GetObject(frag_id)));
+
+    MPI_Barrier(comm_spec.comm());
+  }
+  grape::FinalizeMPIComm();
+
+  LOG(INFO) << "Passed arrow fragment gid test...";
+
+  return 0;
+}
@@ -0,0 +1,195 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <stdio.h>
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "glog/logging.h"
+
+#include "client/client.h"
+
+#include "graph/fragment/arrow_fragment.h"
+#include "graph/fragment/arrow_fragment_group.h"
+#include "graph/loader/arrow_fragment_loader.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+using GraphType = ArrowFragment<property_graph_types::OID_TYPE,
+                                property_graph_types::VID_TYPE>;
+using LoaderType = ArrowFragmentLoader<property_graph_types::OID_TYPE,
+                                       property_graph_types::VID_TYPE>;
+
+template <typename FUNC_T>
+ObjectID Check(FUNC_T&& fn) {
+  return boost::leaf::try_handle_all(
+      fn,
+      [](const GSError& e) {
+        LOG(FATAL) << e.error_msg;
+        return InvalidObjectID();
+      },
+      [](const boost::leaf::error_info& unmatched) {
+        LOG(FATAL) << "Unmatched error " << unmatched;
+        return InvalidObjectID();
+      });
+}
+
+void CheckTable(const FragmentTable& table,
+                const std::shared_ptr<ArrowFragmentGroup>& group) {
+  CHECK_EQ(table.size(), group->total_frag_num());
+  for (fid_t fid = 0; fid < table.size(); ++fid) {
+    uint64_t instance_id;
+    ObjectID frag_id;
+    CHECK(table.Locate(fid, instance_id, frag_id));
+    CHECK_EQ(frag_id, group->Fragments().at(fid));
+    CHECK_EQ(instance_id, group->FragmentLocations().at(fid));
+  }
+  uint64_t instance_id;
+  ObjectID frag_id;
+  CHECK(!table.Locate(table.size(), instance_id, frag_id));
+}
+
+// the group built in one collective must register every fragment with its
+// location and load, and the table of the group is served from the cache
+// after the first lookup.
+void TestFragmentGroup(Client& client, const grape::CommSpec& comm_spec,
+                       ObjectID frag_id) {
+  ObjectID group_id = Check(
+      [&]() { return ConstructFragmentGroup(client, frag_id, comm_spec); });
+  auto frag = std::dynamic_pointer_cast<GraphType>(client.GetObject(frag_id));
+  auto group =
+      std::dynamic_pointer_cast<ArrowFragmentGroup>(client.GetObject(group_id));
+  CHECK(group != nullptr);
+  CHECK_EQ(group->total_frag_num(), comm_spec.fnum());
+  CHECK_EQ(group->vertex_label_num(), frag->vertex_label_num());
+  CHECK_EQ(group->edge_label_num(), frag->edge_label_num());
+  CHECK_EQ(group->Fragments().size(), comm_spec.fnum());
+  CHECK_EQ(group->Fragments().at(comm_spec.fid()), frag_id);
+  CHECK_EQ(group->FragmentLocations().at(comm_spec.fid()),
+           client.instance_id());
+  CheckTable(group->Table(), group);
+
+  // the loads of all fragments, including the local one
+  CHECK_EQ(group->FragmentLoads().size(), comm_spec.fnum());
+  auto const& load = group->FragmentLoads().at(comm_spec.fid());
+  CHECK_EQ(load.inner_vertex_num, frag->local_inner_vertex_num());
+  CHECK_EQ(load.outer_vertex_num, frag->local_outer_vertex_num());
+  CHECK_EQ(load.edge_num, frag->local_edge_num());
+  size_t max_edge_num = 0, total_edge_num = 0;
+  for (auto const& kv : group->FragmentLoads()) {
+    max_edge_num = std::max(max_edge_num, kv.second.edge_num);
+    total_edge_num += kv.second.edge_num;
+  }
+  CHECK_GE(group->LoadImbalance(), 1.0);
+  if (total_edge_num > 0) {
+    CHECK_DOUBLE_EQ(group->LoadImbalance(),
+                    static_cast<double>(max_edge_num) * comm_spec.fnum() /
+                        total_edge_num);
+  }
+  LOG(INFO) << "Load imbalance of the group: " << group->LoadImbalance();
+
+  std::shared_ptr<const FragmentTable> table, cached_table;
+  VINEYARD_CHECK_OK(
+      ArrowFragmentGroup::GetFragmentTable(client, group_id, table));
+  CheckTable(*table, group);
+  VINEYARD_CHECK_OK(
+      ArrowFragmentGroup::GetFragmentTable(client, group_id, cached_table));
+  CHECK(cached_table == table);
+  CHECK(!ArrowFragmentGroup::GetFragmentTable(client, frag_id, table).ok());
+
+  // the fragments can be registered concurrently
+  if (comm_spec.worker_id() == 0) {
+    ArrowFragmentGroupBuilder builder;
+    builder.set_total_frag_num(group->total_frag_num());
+    builder.set_vertex_label_num(group->vertex_label_num());
+    builder.set_edge_label_num(group->edge_label_num());
+    std::vector<std::thread> threads;
+    for (fid_t fid = 0; fid < group->total_frag_num(); ++fid) {
+      threads.emplace_back([&builder, &group, fid]() {
+        builder.AddFragmentObject(fid, group->Fragments().at(fid),
+                                  group->FragmentLocations().at(fid));
+        builder.SetFragmentLoad(fid, group->FragmentLoads().at(fid));
+      });
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+    auto rebuilt =
+        std::dynamic_pointer_cast<ArrowFragmentGroup>(builder.Seal(client));
+    auto fetched = std::dynamic_pointer_cast<ArrowFragmentGroup>(
+        client.GetObject(rebuilt->id()));
+    CHECK(fetched->Fragments() == group->Fragments());
+    CHECK(fetched->FragmentLocations() == group->FragmentLocations());
+    CheckTable(fetched->Table(), group);
+    CHECK_EQ(fetched->FragmentLoads().size(), group->FragmentLoads().size());
+    CHECK_DOUBLE_EQ(fetched->LoadImbalance(), group->LoadImbalance());
+  }
+}
+
+int main(int argc, char** argv) {
+  if (argc < 6) {
+    printf(
+        "usage: ./arrow_fragment_group_test <ipc_socket> <e_label_num> "
+        "<efiles...> <v_label_num> <vfiles...> [directed]\n");
+    return 1;
+  }
+  int index = 1;
+  std::string ipc_socket = std::string(argv[index++]);
+
+  int edge_label_num = atoi(argv[index++]);
+  std::vector<std::string> efiles;
+  for (int i = 0; i < edge_label_num; ++i) {
+    efiles.push_back(argv[index++]);
+  }
+
+  int vertex_label_num = atoi(argv[index++]);
+  std::vector<std::string> vfiles;
+  for (int i = 0; i < vertex_label_num; ++i) {
+    vfiles.push_back(argv[index++]);
+  }
+
+  int directed = 1;
+  if (argc > index) {
+    directed = atoi(argv[index]);
+  }
+
+  vineyard::Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+
+  LOG(INFO) << "Connected to IPCServer: " << ipc_socket;
+
+  grape::InitMPIComm();
+
+  {
+    grape::CommSpec comm_spec;
+    comm_spec.Init(MPI_COMM_WORLD);
+
+    auto loader = std::make_unique<LoaderType>(client, comm_spec, efiles,
+                                               vfiles, directed != 0);
+    ObjectID frag_id = Check([&]() { return loader->LoadFragment(); });
+    TestFragmentGroup(client, comm_spec, frag_id);
+
+    MPI_Barrier(comm_spec.comm());
+  }
+  grape::FinalizeMPIComm();
+
+  LOG(INFO) << "Passed arrow fragment group test...";
+
+  return 0;
+}
@@ -0,0 +1,220 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <stdio.h>
+
+#include <algorithm>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "glog/logging.h"
+
+#include "client/client.h"
+
+#include "graph/fragment/arrow_fragment.h"
+#include "graph/loader/arrow_fragment_loader.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+using GraphType = ArrowFragment<property_graph_types::OID_TYPE,
+                                property_graph_types::VID_TYPE>;
+using LabelType = typename GraphType::label_id_t;
+
+std::string FormatValue(const std::shared_ptr<arrow::ChunkedArray>& column,
+                        int64_t index) {
+  for (auto const& chunk : column->chunks()) {
+    if (index >= chunk->length()) {
+      index -= chunk->length();
+      continue;
+    }
+    switch (chunk->type()->id()) {
+    case arrow::Type::INT32:
+      return std::to_string(
+          std::dynamic_pointer_cast<arrow::Int32Array>(chunk)->Value(index));
+    case arrow::Type::INT64:
+      return std::to_string(
+          std::dynamic_pointer_cast<arrow::Int64Array>(chunk)->Value(index));
+    case arrow::Type::DOUBLE:
+      return std::to_string(
+          std::dynamic_pointer_cast<arrow::DoubleArray>(chunk)->Value(index));
+    case arrow::Type::STRING:
+      return std::dynamic_pointer_cast<arrow::StringArray>(chunk)->GetString(
+          index);
+    case arrow::Type::LARGE_STRING:
+      return std::dynamic_pointer_cast<arrow::LargeStringArray>(chunk)
+          ->GetString(index);
+    default:
+      return chunk->type()->ToString();
+    }
+  }
+  return "";
+}
+
+// the (sorted) lines of the inner vertices and their outgoing edges, with
+// the properties, which don't depend on the lids and eids
+std::vector<std::string> DumpFragment(const std::shared_ptr<GraphType>& frag) {
+  std::vector<std::string> lines;
+  for (LabelType v_label = 0; v_label < frag->vertex_label_num(); ++v_label) {
+    auto table = frag->vertex_data_table(v_label);
+    for (auto v : frag->InnerVertices(v_label)) {
+      std::stringstream ss;
+      ss << "v " << v_label << " " << frag->GetId(v);
+      for (int prop = 0; prop < table->num_columns(); ++prop) {
+        ss << " " << FormatValue(table->column(prop), frag->vertex_offset(v));
+      }
+      lines.emplace_back(ss.str());
+    }
+  }
+  for (LabelType e_label = 0; e_label < frag->edge_label_num(); ++e_label) {
+    auto table = frag->edge_data_table(e_label);
+    for (LabelType v_label = 0; v_label < frag->vertex_label_num();
+         ++v_label) {
+      for (auto v : frag->InnerVertices(v_label)) {
+        for (auto& e : frag->GetOutgoingAdjList(v, e_label)) {
+          std::stringstream ss;
+          ss << "e " << e_label << " " << frag->GetId(v) << " "
+             << frag->GetId(e.neighbor());
+          for (int prop = 0; prop < table->num_columns(); ++prop) {
+            ss << " " << FormatValue(table->column(prop), e.edge_id());
+          }
+          lines.emplace_back(ss.str());
+        }
+      }
+    }
+  }
+  std::sort(lines.begin(), lines.end());
+  return lines;
+}
+
+using LoaderType = ArrowFragmentLoader<property_graph_types::OID_TYPE,
+                                       property_graph_types::VID_TYPE>;
+
+ObjectID LoadFragment(std::unique_ptr<LoaderType>& loader) {
+  return boost::leaf::try_handle_all(
+      [&loader]() { return loader->LoadFragment(); },
+      [](const GSError& e) {
+        LOG(FATAL) << e.error_msg;
+        return InvalidObjectID();
+      },
+      [](const boost::leaf::error_info& unmatched) {
+        LOG(FATAL) << "Unmatched error " << unmatched;
+        return InvalidObjectID();
+      });
+}
+
+// the fragment with a partial vertex map must have the same vertices and
+// edges as the one with the complete vertex map, and the outer vertices
+// must be resolvable through the cache of the partial vertex map.
+void CheckPartitioned(const std::shared_ptr<GraphType>& expected,
+                      const std::shared_ptr<GraphType>& frag) {
+  CHECK(!expected->GetVertexMap()->partial());
+  CHECK(frag->GetVertexMap()->partial());
+  CHECK_EQ(frag->GetTotalNodesNum(), expected->GetTotalNodesNum());
+  for (LabelType v_label = 0; v_label < frag->vertex_label_num(); ++v_label) {
+    CHECK_EQ(frag->GetInnerVerticesNum(v_label),
+             expected->GetInnerVerticesNum(v_label));
+    CHECK_EQ(frag->GetOuterVerticesNum(v_label),
+             expected->GetOuterVerticesNum(v_label));
+    for (auto v : frag->Vertices(v_label)) {
+      GraphType::vertex_t u;
+      CHECK(frag->GetVertex(v_label, frag->GetId(v), u));
+      CHECK(u == v);
+      CHECK(expected->GetVertex(v_label, frag->GetId(v), u));
+      CHECK_EQ(expected->IsInnerVertex(u), frag->IsInnerVertex(v));
+    }
+  }
+  CHECK(DumpFragment(frag) == DumpFragment(expected));
+}
+
+int main(int argc, char** argv) {
+  if (argc < 6) {
+    printf(
+        "usage: ./arrow_fragment_partitioned_test <ipc_socket> <e_label_num> "
+        "<efiles...> <v_label_num> <vfiles...> [directed]\n");
+    return 1;
+  }
+  int index = 1;
+  std::string ipc_socket = std::string(argv[index++]);
+
+  int edge_label_num = atoi(argv[index++]);
+  std::vector<std::string> efiles;
+  for (int i = 0; i < edge_label_num; ++i) {
+    efiles.push_back(argv[index++]);
+  }
+
+  int vertex_label_num = atoi(argv[index++]);
+  std::vector<std::string> vfiles;
+  for (int i = 0; i < vertex_label_num; ++i) {
+    vfiles.push_back(argv[index++]);
+  }
+
+  int directed = 1;
+  if (argc > index) {
+    directed = atoi(argv[index]);
+  }
+
+  vineyard::Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+
+  LOG(INFO) << "Connected to IPCServer: " << ipc_socket;
+
+  grape::InitMPIComm();
+
+  {
+    grape::CommSpec comm_spec;
+    comm_spec.Init(MPI_COMM_WORLD);
+
+    auto loader = std::make_unique<LoaderType>(client, comm_spec, efiles,
+                                               vfiles, directed != 0);
+    auto expected = std::dynamic_pointer_cast<GraphType>(
+        client.GetObject(LoadFragment(loader)));
+
+    loader = std::make_unique<LoaderType>(client, comm_spec, efiles, vfiles,
+                                          directed != 0);
+    loader->set_partitioned_vertex_map(true);
+    auto frag = std::dynamic_pointer_cast<GraphType>(
+        client.GetObject(LoadFragment(loader)));
+    CheckPartitioned(expected, frag);
+
+    // the partial vertex map doesn't support the degree reordering
+    loader = std::make_unique<LoaderType>(client, comm_spec, efiles, vfiles,
+                                          directed != 0);
+    loader->set_partitioned_vertex_map(true);
+    loader->set_reorder_vertices(true);
+    bool rejected = boost::leaf::try_handle_all(
+        [&loader]() -> boost::leaf::result<bool> {
+          BOOST_LEAF_CHECK(loader->LoadFragment());
+          return false;
+        },
+        [](const GSError& e) {
+          CHECK(e.error_code == ErrorCode::kUnsupportedOperationError);
+          return true;
+        },
+        [](const boost::leaf::error_info& unmatched) {
+          LOG(FATAL) << "Unmatched error " << unmatched;
+          return false;
+        });
+    CHECK(rejected);
+
+    MPI_Barrier(comm_spec.comm());
+  }
+  grape::FinalizeMPIComm();
+
+  LOG(INFO) << "Passed arrow fragment partitioned vertex map test...";
+
+  return 0;
+}
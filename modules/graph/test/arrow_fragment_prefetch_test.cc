@@ -0,0 +1,166 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <stdio.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "glog/logging.h"
+
+#include "client/client.h"
+
+#include "graph/fragment/arrow_fragment.h"
+#include "graph/loader/arrow_fragment_loader.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+using GraphType = ArrowFragment<property_graph_types::OID_TYPE,
+                                property_graph_types::VID_TYPE>;
+using LabelType = typename GraphType::label_id_t;
+using LoaderType = ArrowFragmentLoader<property_graph_types::OID_TYPE,
+                                       property_graph_types::VID_TYPE>;
+
+template <typename FUNC_T>
+ObjectID Check(FUNC_T&& fn) {
+  return boost::leaf::try_handle_all(
+      fn,
+      [](const GSError& e) {
+        LOG(FATAL) << e.error_msg;
+        return InvalidObjectID();
+      },
+      [](const boost::leaf::error_info& unmatched) {
+        LOG(FATAL) << "Unmatched error " << unmatched;
+        return InvalidObjectID();
+      });
+}
+
+// the prefetching adjacency list must visit the same neighbors in the same
+// order as the plain one, and read the same property values
+template <typename DATA_T, typename ADJ_LIST_T, typename PREFETCH_ADJ_LIST_T>
+int64_t CheckAdjList(const ADJ_LIST_T& adj_list,
+                     const PREFETCH_ADJ_LIST_T& prefetch_adj_list,
+                     GraphType::prop_id_t prop) {
+  CHECK_EQ(prefetch_adj_list.Size(), adj_list.Size());
+  auto iter = prefetch_adj_list.begin();
+  for (auto& e : adj_list) {
+    CHECK(iter != prefetch_adj_list.end());
+    CHECK_EQ((*iter).neighbor().GetValue(), e.neighbor().GetValue());
+    CHECK_EQ((*iter).edge_id(), e.edge_id());
+    CHECK_EQ((*iter).data(), e.template get_data<DATA_T>(prop));
+    CHECK_EQ((*iter).template get_data<DATA_T>(prop),
+             e.template get_data<DATA_T>(prop));
+    ++iter;
+  }
+  CHECK(iter == prefetch_adj_list.end());
+  return adj_list.Size();
+}
+
+template <typename DATA_T>
+void CheckProperty(const std::shared_ptr<GraphType>& frag, LabelType e_label,
+                   GraphType::prop_id_t prop) {
+  int64_t edge_num = 0;
+  for (LabelType v_label = 0; v_label < frag->vertex_label_num(); ++v_label) {
+    for (auto v : frag->InnerVertices(v_label)) {
+      edge_num += CheckAdjList<DATA_T>(
+          frag->GetOutgoingAdjList(v, e_label),
+          frag->GetOutgoingPrefetchAdjList<DATA_T>(v, e_label, prop), prop);
+      if (frag->directed()) {
+        edge_num += CheckAdjList<DATA_T>(
+            frag->GetIncomingAdjList(v, e_label),
+            frag->GetIncomingPrefetchAdjList<DATA_T>(v, e_label, prop), prop);
+      }
+    }
+  }
+  LOG(INFO) << "Checked " << edge_num << " edges of property " << prop
+            << " of edge label " << e_label;
+}
+
+void TestPrefetch(const std::shared_ptr<GraphType>& frag) {
+  int checked = 0;
+  for (LabelType e_label = 0; e_label < frag->edge_label_num(); ++e_label) {
+    for (GraphType::prop_id_t prop = 0; prop < frag->edge_property_num(e_label);
+         ++prop) {
+      auto type = frag->edge_property_type(e_label, prop);
+      if (type->Equals(arrow::int64())) {
+        CheckProperty<int64_t>(frag, e_label, prop);
+      } else if (type->Equals(arrow::int32())) {
+        CheckProperty<int32_t>(frag, e_label, prop);
+      } else if (type->Equals(arrow::float64())) {
+        CheckProperty<double>(frag, e_label, prop);
+      } else if (type->Equals(arrow::float32())) {
+        CheckProperty<float>(frag, e_label, prop);
+      } else {
+        continue;
+      }
+      ++checked;
+    }
+  }
+  CHECK_GT(checked, 0) << "no fixed-width edge property to prefetch";
+}
+
+int main(int argc, char** argv) {
+  if (argc < 6) {
+    printf(
+        "usage: ./arrow_fragment_prefetch_test <ipc_socket> <e_label_num> "
+        "<efiles...> <v_label_num> <vfiles...> [directed]\n");
+    return 1;
+  }
+  int index = 1;
+  std::string ipc_socket = std::string(argv[index++]);
+
+  int edge_label_num = atoi(argv[index++]);
+  std::vector<std::string> efiles;
+  for (int i = 0; i < edge_label_num; ++i) {
+    efiles.push_back(argv[index++]);
+  }
+
+  int vertex_label_num = atoi(argv[index++]);
+  std::vector<std::string> vfiles;
+  for (int i = 0; i < vertex_label_num; ++i) {
+    vfiles.push_back(argv[index++]);
+  }
+
+  int directed = 1;
+  if (argc > index) {
+    directed = atoi(argv[index]);
+  }
+
+  vineyard::Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+
+  LOG(INFO) << "Connected to IPCServer: " << ipc_socket;
+
+  grape::InitMPIComm();
+
+  {
+    grape::CommSpec comm_spec;
+    comm_spec.Init(MPI_COMM_WORLD);
+
+    auto loader = std::make_unique<LoaderType>(client, comm_spec, efiles,
+                                               vfiles, directed != 0);
+    auto frag = std::dynamic_pointer_cast<GraphType>(
+        client.GetObject(Check([&]() { return loader->LoadFragment(); })));
+    TestPrefetch(frag);
+
+    MPI_Barrier(comm_spec.comm());
+  }
+  grape::FinalizeMPIComm();
+
+  LOG(INFO) << "Passed arrow fragment prefetch test...";
+
+  return 0;
+}
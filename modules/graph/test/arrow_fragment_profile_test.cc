@@ -0,0 +1,179 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <stdio.h>
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "glog/logging.h"
+
+#include "client/client.h"
+
+#include "graph/fragment/arrow_fragment.h"
+#include "graph/loader/arrow_fragment_loader.h"
+#include "graph/utils/load_profile.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+using GraphType = ArrowFragment<property_graph_types::OID_TYPE,
+                                property_graph_types::VID_TYPE>;
+using LoaderType = ArrowFragmentLoader<property_graph_types::OID_TYPE,
+                                       property_graph_types::VID_TYPE>;
+
+template <typename FUNC_T>
+ObjectID Check(FUNC_T&& fn) {
+  return boost::leaf::try_handle_all(
+      fn,
+      [](const GSError& e) {
+        LOG(FATAL) << e.error_msg;
+        return InvalidObjectID();
+      },
+      [](const boost::leaf::error_info& unmatched) {
+        LOG(FATAL) << "Unmatched error " << unmatched;
+        return InvalidObjectID();
+      });
+}
+
+// the durations are accumulated from concurrent threads, and the timers
+// without a profile are no-ops
+void TestLoadProfile() {
+  LoadProfile profile;
+  for (int phase = 0; phase < LoadProfile::kPhases; ++phase) {
+    CHECK_EQ(profile.Get(static_cast<LoadProfile::Phase>(phase)), 0.0);
+  }
+
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 8; ++i) {
+    threads.emplace_back([&profile]() {
+      for (int k = 0; k < 1000; ++k) {
+        profile.Add(LoadProfile::kShuffle, 0.001);
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  CHECK_NEAR(profile.Get(LoadProfile::kShuffle), 8.0, 1e-6);
+
+  {
+    LoadProfile::Timer timer(&profile, LoadProfile::kCSR);
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  }
+  CHECK_GE(profile.Get(LoadProfile::kCSR), 0.02);
+  {
+    LoadProfile::Timer timer(nullptr, LoadProfile::kCSR);
+  }
+
+  std::string text = profile.ToString();
+  for (int phase = 0; phase < LoadProfile::kPhases; ++phase) {
+    CHECK_NE(text.find(LoadProfile::PhaseName(
+                 static_cast<LoadProfile::Phase>(phase))),
+             std::string::npos);
+  }
+  CHECK_NE(text.find("shuffle: 8.000s"), std::string::npos) << text;
+
+  profile.Reset();
+  CHECK_EQ(profile.Get(LoadProfile::kShuffle), 0.0);
+  CHECK_EQ(profile.Get(LoadProfile::kCSR), 0.0);
+}
+
+// every phase of loading is timed, and none of them exceeds the wall time
+// of the load, while the fragment is the same as the one loaded without
+// being profiled
+void TestLoadWithProfile(Client& client, const grape::CommSpec& comm_spec,
+                         const std::vector<std::string>& efiles,
+                         const std::vector<std::string>& vfiles,
+                         bool directed) {
+  auto loader = std::make_unique<LoaderType>(client, comm_spec, efiles, vfiles,
+                                             directed);
+  auto expected = std::dynamic_pointer_cast<GraphType>(
+      client.GetObject(Check([&]() { return loader->LoadFragment(); })));
+
+  LoadProfile profile;
+  loader = std::make_unique<LoaderType>(client, comm_spec, efiles, vfiles,
+                                        directed);
+  loader->set_profile(&profile);
+  auto start = std::chrono::steady_clock::now();
+  auto frag = std::dynamic_pointer_cast<GraphType>(
+      client.GetObject(Check([&]() { return loader->LoadFragment(); })));
+  double wall_time = std::chrono::duration<double>(
+                         std::chrono::steady_clock::now() - start)
+                         .count();
+  LOG(INFO) << "Loaded in " << wall_time << "s, " << profile.ToString();
+
+  CHECK_EQ(frag->GetTotalNodesNum(), expected->GetTotalNodesNum());
+  CHECK_EQ(frag->local_edge_num(), expected->local_edge_num());
+  for (int phase = 0; phase < LoadProfile::kPhases; ++phase) {
+    double seconds = profile.Get(static_cast<LoadProfile::Phase>(phase));
+    CHECK_GT(seconds, 0.0) << LoadProfile::PhaseName(
+        static_cast<LoadProfile::Phase>(phase));
+    CHECK_LE(seconds, wall_time);
+  }
+}
+
+int main(int argc, char** argv) {
+  if (argc < 6) {
+    printf(
+        "usage: ./arrow_fragment_profile_test <ipc_socket> <e_label_num> "
+        "<efiles...> <v_label_num> <vfiles...> [directed]\n");
+    return 1;
+  }
+  int index = 1;
+  std::string ipc_socket = std::string(argv[index++]);
+
+  int edge_label_num = atoi(argv[index++]);
+  std::vector<std::string> efiles;
+  for (int i = 0; i < edge_label_num; ++i) {
+    efiles.push_back(argv[index++]);
+  }
+
+  int vertex_label_num = atoi(argv[index++]);
+  std::vector<std::string> vfiles;
+  for (int i = 0; i < vertex_label_num; ++i) {
+    vfiles.push_back(argv[index++]);
+  }
+
+  int directed = 1;
+  if (argc > index) {
+    directed = atoi(argv[index]);
+  }
+
+  TestLoadProfile();
+
+  vineyard::Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+
+  LOG(INFO) << "Connected to IPCServer: " << ipc_socket;
+
+  grape::InitMPIComm();
+
+  {
+    grape::CommSpec comm_spec;
+    comm_spec.Init(MPI_COMM_WORLD);
+
+    TestLoadWithProfile(client, comm_spec, efiles, vfiles, directed != 0);
+
+    MPI_Barrier(comm_spec.comm());
+  }
+  grape::FinalizeMPIComm();
+
+  LOG(INFO) << "Passed arrow fragment profile test...";
+
+  return 0;
+}
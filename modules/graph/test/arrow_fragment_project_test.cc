@@ -0,0 +1,205 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <stdio.h>
+
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "glog/logging.h"
+
+#include "client/client.h"
+
+#include "graph/fragment/arrow_fragment.h"
+#include "graph/loader/arrow_fragment_loader.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+using GraphType = ArrowFragment<property_graph_types::OID_TYPE,
+                                property_graph_types::VID_TYPE>;
+using LabelType = typename GraphType::label_id_t;
+using LoaderType = ArrowFragmentLoader<property_graph_types::OID_TYPE,
+                                       property_graph_types::VID_TYPE>;
+
+template <typename FUNC_T>
+ObjectID Check(FUNC_T&& fn) {
+  return boost::leaf::try_handle_all(
+      fn,
+      [](const GSError& e) {
+        LOG(FATAL) << e.error_msg;
+        return InvalidObjectID();
+      },
+      [](const boost::leaf::error_info& unmatched) {
+        LOG(FATAL) << "Unmatched error " << unmatched;
+        return InvalidObjectID();
+      });
+}
+
+size_t MemoryUsage(Client& client) {
+  std::shared_ptr<InstanceStatus> status;
+  VINEYARD_CHECK_OK(client.InstanceStatus(status));
+  return status->memory_usage;
+}
+
+const void* ColumnData(const std::shared_ptr<arrow::Table>& table, int col) {
+  return table->column(col)->chunk(0)->data()->buffers[1]->data();
+}
+
+// the outgoing (neighbor, eid) pairs of every inner vertex
+std::vector<std::pair<int64_t, int64_t>> Edges(
+    const std::shared_ptr<GraphType>& frag, LabelType e_label) {
+  std::vector<std::pair<int64_t, int64_t>> edges;
+  for (LabelType v_label = 0; v_label < frag->vertex_label_num(); ++v_label) {
+    for (auto v : frag->InnerVertices(v_label)) {
+      for (auto& e : frag->GetOutgoingAdjList(v, e_label)) {
+        edges.emplace_back(e.neighbor().GetValue(), e.edge_id());
+      }
+    }
+  }
+  return edges;
+}
+
+// the projection keeps the first property of every vertex label, and all
+// properties of the first edge label. It shares all members with the
+// fragment, thus creates no blobs, and the columns are served by the blobs
+// the client has already mapped.
+void TestProject(Client& client, const std::shared_ptr<GraphType>& frag) {
+  std::map<LabelType, std::vector<LabelType>> vertices, edges;
+  for (LabelType v_label = 0; v_label < frag->vertex_label_num(); ++v_label) {
+    vertices[v_label] = {};
+    if (frag->vertex_property_num(v_label) > 0) {
+      vertices[v_label].push_back(0);
+    }
+  }
+  for (GraphType::prop_id_t prop = 0; prop < frag->edge_property_num(0);
+       ++prop) {
+    edges[0].push_back(prop);
+  }
+
+  size_t memory_usage = MemoryUsage(client);
+  ObjectID projected_id =
+      Check([&]() { return frag->Project(client, vertices, edges); });
+  auto projected =
+      std::dynamic_pointer_cast<GraphType>(client.GetObject(projected_id));
+  CHECK(projected != nullptr);
+  CHECK_EQ(MemoryUsage(client), memory_usage);
+  CHECK_LE(projected->meta().GetNBytes(), frag->meta().GetNBytes());
+
+  std::vector<std::string> shared_members{"ivnums", "ovnums", "tvnums",
+                                          "vertex_map"};
+  for (LabelType v_label = 0; v_label < frag->vertex_label_num(); ++v_label) {
+    shared_members.emplace_back(
+        generate_name_with_suffix("ovgid_lists", v_label));
+    shared_members.emplace_back(
+        generate_name_with_suffix("ovg2l_maps", v_label));
+    shared_members.emplace_back(
+        generate_name_with_suffix("vertex_tables", v_label));
+    shared_members.emplace_back(
+        generate_name_with_suffix("oe_lists", v_label, 0));
+    shared_members.emplace_back(
+        generate_name_with_suffix("oe_offsets_lists", v_label, 0));
+  }
+  shared_members.emplace_back(generate_name_with_suffix("edge_tables", 0));
+  for (auto const& name : shared_members) {
+    CHECK_EQ(projected->meta().GetMemberMeta(name).GetId(),
+             frag->meta().GetMemberMeta(name).GetId())
+        << "member " << name << " is not shared";
+  }
+
+  CHECK_EQ(projected->GetTotalNodesNum(), frag->GetTotalNodesNum());
+  for (LabelType v_label = 0; v_label < frag->vertex_label_num(); ++v_label) {
+    CHECK_EQ(projected->GetInnerVerticesNum(v_label),
+             frag->GetInnerVerticesNum(v_label));
+    CHECK_EQ(projected->vertex_property_num(v_label),
+             static_cast<GraphType::prop_id_t>(vertices[v_label].size()));
+    auto table = projected->vertex_data_table(v_label);
+    if (!vertices[v_label].empty() && table->num_rows() > 0) {
+      CHECK_EQ(ColumnData(table, 0),
+               ColumnData(frag->vertex_data_table(v_label), 0));
+    }
+  }
+  CHECK_EQ(projected->edge_property_num(0), frag->edge_property_num(0));
+  auto table = projected->edge_data_table(0);
+  for (int col = 0; col < table->num_columns() && table->num_rows() > 0;
+       ++col) {
+    CHECK_EQ(ColumnData(table, col),
+             ColumnData(frag->edge_data_table(0), col));
+  }
+  CHECK(Edges(projected, 0) == Edges(frag, 0));
+
+  // the projection can be released without affecting the fragment
+  projected.reset();
+  VINEYARD_CHECK_OK(client.DelData(projected_id));
+  CHECK(Edges(frag, 0) ==
+        Edges(std::dynamic_pointer_cast<GraphType>(
+                  client.GetObject(frag->id())),
+              0));
+}
+
+int main(int argc, char** argv) {
+  if (argc < 6) {
+    printf(
+        "usage: ./arrow_fragment_project_test <ipc_socket> <e_label_num> "
+        "<efiles...> <v_label_num> <vfiles...> [directed]\n");
+    return 1;
+  }
+  int index = 1;
+  std::string ipc_socket = std::string(argv[index++]);
+
+  int edge_label_num = atoi(argv[index++]);
+  std::vector<std::string> efiles;
+  for (int i = 0; i < edge_label_num; ++i) {
+    efiles.push_back(argv[index++]);
+  }
+
+  int vertex_label_num = atoi(argv[index++]);
+  std::vector<std::string> vfiles;
+  for (int i = 0; i < vertex_label_num; ++i) {
+    vfiles.push_back(argv[index++]);
+  }
+
+  int directed = 1;
+  if (argc > index) {
+    directed = atoi(argv[index]);
+  }
+
+  vineyard::Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+
+  LOG(INFO) << "Connected to IPCServer: " << ipc_socket;
+
+  grape::InitMPIComm();
+
+  {
+    grape::CommSpec comm_spec;
+    comm_spec.Init(MPI_COMM_WORLD);
+
+    auto loader = std::make_unique<LoaderType>(client, comm_spec, efiles,
+                                               vfiles, directed != 0);
+    auto frag = std::dynamic_pointer_cast<GraphType>(
+        client.GetObject(Check([&]() { return loader->LoadFragment(); })));
+    TestProject(client, frag);
+
+    MPI_Barrier(comm_spec.comm());
+  }
+  grape::FinalizeMPIComm();
+
+  LOG(INFO) << "Passed arrow fragment project test...";
+
+  return 0;
+}
@@ -15,8 +15,10 @@ limitations under the License.
 
 #include <stdio.h>
 
+#include <algorithm>
 #include <fstream>
 #include <string>
+#include <vector>
 
 #include "glog/logging.h"
 
@@ -32,6 +34,73 @@ using GraphType = ArrowFragment<property_graph_types::OID_TYPE,
                                 property_graph_types::VID_TYPE>;
 using LabelType = typename GraphType::label_id_t;
 
+// the batch accessors must agree with `GetData` on the numeric properties
+template <typename T>
+void CheckVertexDataSpan(std::shared_ptr<GraphType> frag, LabelType v_label,
+                         GraphType::prop_id_t prop) {
+  auto span = frag->GetInnerVertexDataSpan<T>(v_label, prop);
+  auto iv = frag->InnerVertices(v_label);
+  CHECK_EQ(span.size(), iv.size());
+  std::vector<GraphType::vertex_t> vertices(iv.begin(), iv.end());
+  std::reverse(vertices.begin(), vertices.end());
+  auto gathered = frag->GatherInnerVertexData<T>(v_label, prop, vertices);
+  size_t index = 0;
+  for (auto v : iv) {
+    CHECK_EQ(span[index], frag->GetData<T>(v, prop));
+    CHECK_EQ(gathered[vertices.size() - 1 - index], span[index]);
+    ++index;
+  }
+  CHECK_EQ(frag->GetInnerVertexDataArray(v_label, prop)->length(),
+           static_cast<int64_t>(iv.size()));
+}
+
+void CheckVertexData(std::shared_ptr<GraphType> frag) {
+  for (LabelType v_label = 0; v_label < frag->vertex_label_num(); ++v_label) {
+    if (frag->GetInnerVerticesNum(v_label) == 0) {
+      continue;
+    }
+    for (GraphType::prop_id_t prop = 0;
+         prop < frag->vertex_property_num(v_label); ++prop) {
+      auto type = frag->vertex_property_type(v_label, prop);
+      if (type->Equals(arrow::int64())) {
+        CheckVertexDataSpan<int64_t>(frag, v_label, prop);
+      } else if (type->Equals(arrow::float64())) {
+        CheckVertexDataSpan<double>(frag, v_label, prop);
+      }
+    }
+  }
+}
+
+// the degree index must agree with the CSR of every edge label
+void CheckDegreeIndex(std::shared_ptr<GraphType> frag) {
+  if (!frag->has_degree_index()) {
+    return;
+  }
+  LabelType e_label_num = frag->edge_label_num();
+  for (LabelType v_label = 0; v_label < frag->vertex_label_num(); ++v_label) {
+    auto out_degrees = frag->GetLocalOutDegrees(v_label);
+    auto in_degrees = frag->GetLocalInDegrees(v_label);
+    CHECK_EQ(out_degrees.size(), frag->Vertices(v_label).size());
+    for (auto v : frag->Vertices(v_label)) {
+      const int64_t* out_offsets = frag->GetOutgoingLabelOffsets(v);
+      const int64_t* in_offsets = frag->GetIncomingLabelOffsets(v);
+      int64_t out_degree = 0, in_degree = 0;
+      for (LabelType e_label = 0; e_label < e_label_num; ++e_label) {
+        CHECK_EQ(out_offsets[e_label + 1] - out_offsets[e_label],
+                 frag->GetLocalOutDegree(v, e_label));
+        CHECK_EQ(in_offsets[e_label + 1] - in_offsets[e_label],
+                 frag->GetLocalInDegree(v, e_label));
+        out_degree += frag->GetLocalOutDegree(v, e_label);
+        in_degree += frag->GetLocalInDegree(v, e_label);
+      }
+      CHECK_EQ(frag->GetLocalOutDegree(v), out_degree);
+      CHECK_EQ(frag->GetLocalInDegree(v), in_degree);
+      CHECK_EQ(out_degrees[frag->vertex_offset(v)], out_degree);
+      CHECK_EQ(in_degrees[frag->vertex_offset(v)], in_degree);
+    }
+  }
+}
+
 void WriteOut(vineyard::Client& client, const grape::CommSpec& comm_spec,
               vineyard::ObjectID fragment_group_id) {
   LOG(INFO) << "Loaded graph to vineyard: " << fragment_group_id;
@@ -51,6 +120,9 @@ void WriteOut(vineyard::Client& client, const grape::CommSpec& comm_spec,
     }
     auto frag_id = pair.second;
     auto frag = std::dynamic_pointer_cast<GraphType>(client.GetObject(frag_id));
+    CheckVertexData(frag);
+    CheckDegreeIndex(frag);
+
     auto schema = frag->schema();
     auto mg_schema = vineyard::MaxGraphSchema(schema);
     mg_schema.DumpToFile("/tmp/" + std::to_string(fragment_group_id) + ".json");
@@ -182,6 +254,7 @@ int main(int argc, char** argv) {
           std::make_unique<ArrowFragmentLoader<property_graph_types::OID_TYPE,
                                                property_graph_types::VID_TYPE>>(
               client, comm_spec, efiles, vfiles, directed != 0);
+      loader->set_degree_index(true);
       vineyard::ObjectID fragment_group_id = boost::leaf::try_handle_all(
           [&loader]() { return loader->LoadFragmentAsFragmentGroup(); },
           [](const GSError& e) {
@@ -0,0 +1,187 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <stdio.h>
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "glog/logging.h"
+
+#include "client/client.h"
+
+#include "graph/fragment/arrow_fragment.h"
+#include "graph/loader/arrow_fragment_loader.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+using GraphType = ArrowFragment<property_graph_types::OID_TYPE,
+                                property_graph_types::VID_TYPE>;
+using LabelType = typename GraphType::label_id_t;
+
+// the compressed neighbor lists of the inner vertices must decode to the
+// same neighbors, eids and edge properties as the CSR of the fragment.
+void CheckCompressedCSR(const std::shared_ptr<GraphType>& frag,
+                        LabelType v_label, LabelType e_label) {
+  using nbr_unit_t = GraphType::nbr_unit_t;
+  auto iv = frag->InnerVertices(v_label);
+  arrow::FixedSizeBinaryBuilder edges_builder(
+      arrow::fixed_size_binary(sizeof(nbr_unit_t)));
+  arrow::Int64Builder offsets_builder;
+  int64_t edge_num = 0;
+  CHECK(offsets_builder.Append(0).ok());
+  for (auto v : iv) {
+    auto adj_list = frag->GetOutgoingRawAdjList(v, e_label);
+    for (auto& nbr : adj_list) {
+      CHECK(edges_builder.Append(reinterpret_cast<const uint8_t*>(&nbr)).ok());
+    }
+    edge_num += adj_list.Size();
+    CHECK(offsets_builder.Append(edge_num).ok());
+  }
+  if (edge_num == 0) {
+    return;
+  }
+  std::shared_ptr<arrow::FixedSizeBinaryArray> edges;
+  std::shared_ptr<arrow::Int64Array> offsets;
+  CHECK(edges_builder.Finish(&edges).ok());
+  CHECK(offsets_builder.Finish(&offsets).ok());
+
+  std::shared_ptr<arrow::UInt8Array> compressed_edges;
+  std::shared_ptr<arrow::Int64Array> compressed_offsets;
+  boost::leaf::try_handle_all(
+      [&]() {
+        return generate_compressed_csr<GraphType::vid_t, GraphType::eid_t>(
+            edges, offsets, 3, compressed_edges, compressed_offsets);
+      },
+      [](const GSError& e) { LOG(FATAL) << e.error_msg; },
+      [](const boost::leaf::error_info& unmatched) {
+        LOG(FATAL) << "Unmatched error " << unmatched;
+      });
+  CHECK_EQ(compressed_offsets->length(), offsets->length());
+  CHECK_EQ(compressed_offsets->Value(offsets->length() - 1),
+           compressed_edges->length());
+  CHECK_LT(compressed_edges->length(),
+           static_cast<int64_t>(edge_num * sizeof(nbr_unit_t)));
+
+  auto table = frag->edge_data_table(e_label);
+  std::vector<const void*> edata_arrays(table->num_columns());
+  for (int prop = 0; prop < table->num_columns(); ++prop) {
+    edata_arrays[prop] = get_arrow_array_ptr(table->column(prop)->chunk(0));
+  }
+
+  int64_t index = 0;
+  for (auto v : iv) {
+    property_graph_utils::CompressedAdjList<GraphType::vid_t, GraphType::eid_t>
+        compressed(compressed_edges->raw_values() +
+                       compressed_offsets->Value(index),
+                   offsets->Value(index + 1) - offsets->Value(index),
+                   edata_arrays.data());
+    auto adj_list = frag->GetOutgoingAdjList(v, e_label);
+    CHECK_EQ(compressed.Size(), adj_list.Size());
+    auto iter = compressed.begin();
+    for (auto& e : adj_list) {
+      CHECK(iter != compressed.end());
+      auto const& nbr = *iter;
+      CHECK(nbr.neighbor() == e.neighbor());
+      CHECK_EQ(nbr.edge_id(), e.edge_id());
+      for (int prop = 0; prop < table->num_columns(); ++prop) {
+        auto type = frag->edge_property_type(e_label, prop);
+        if (type->Equals(arrow::int64())) {
+          CHECK_EQ(nbr.get_data<int64_t>(prop), e.get_data<int64_t>(prop));
+        } else if (type->Equals(arrow::float64())) {
+          CHECK_EQ(nbr.get_data<double>(prop), e.get_data<double>(prop));
+        } else if (type->Equals(arrow::large_utf8())) {
+          CHECK_EQ(nbr.get_str(prop), e.get_str(prop));
+        }
+      }
+      ++iter;
+    }
+    CHECK(iter == compressed.end());
+    ++index;
+  }
+}
+
+int main(int argc, char** argv) {
+  if (argc < 6) {
+    printf(
+        "usage: ./compressed_csr_test <ipc_socket> <e_label_num> "
+        "<efiles...> <v_label_num> <vfiles...> [directed]\n");
+    return 1;
+  }
+  int index = 1;
+  std::string ipc_socket = std::string(argv[index++]);
+
+  int edge_label_num = atoi(argv[index++]);
+  std::vector<std::string> efiles;
+  for (int i = 0; i < edge_label_num; ++i) {
+    efiles.push_back(argv[index++]);
+  }
+
+  int vertex_label_num = atoi(argv[index++]);
+  std::vector<std::string> vfiles;
+  for (int i = 0; i < vertex_label_num; ++i) {
+    vfiles.push_back(argv[index++]);
+  }
+
+  int directed = 1;
+  if (argc > index) {
+    directed = atoi(argv[index]);
+  }
+
+  vineyard::Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+
+  LOG(INFO) << "Connected to IPCServer: " << ipc_socket;
+
+  grape::InitMPIComm();
+
+  {
+    grape::CommSpec comm_spec;
+    comm_spec.Init(MPI_COMM_WORLD);
+
+    auto loader =
+        std::make_unique<ArrowFragmentLoader<property_graph_types::OID_TYPE,
+                                             property_graph_types::VID_TYPE>>(
+            client, comm_spec, efiles, vfiles, directed != 0);
+    vineyard::ObjectID fragment_id = boost::leaf::try_handle_all(
+        [&loader]() { return loader->LoadFragment(); },
+        [](const GSError& e) {
+          LOG(FATAL) << e.error_msg;
+          return 0;
+        },
+        [](const boost::leaf::error_info& unmatched) {
+          LOG(FATAL) << "Unmatched error " << unmatched;
+          return 0;
+        });
+    auto frag =
+        std::dynamic_pointer_cast<GraphType>(client.GetObject(fragment_id));
+    for (LabelType v_label = 0; v_label < frag->vertex_label_num();
+         ++v_label) {
+      for (LabelType e_label = 0; e_label < frag->edge_label_num();
+           ++e_label) {
+        CheckCompressedCSR(frag, v_label, e_label);
+      }
+    }
+
+    MPI_Barrier(comm_spec.comm());
+  }
+  grape::FinalizeMPIComm();
+
+  LOG(INFO) << "Passed compressed csr test...";
+
+  return 0;
+}
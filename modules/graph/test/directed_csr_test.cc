@@ -0,0 +1,141 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <stdio.h>
+
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <tuple>
+#include <vector>
+
+#include "glog/logging.h"
+
+#include "graph/fragment/property_graph_utils.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+using vid_t = property_graph_types::VID_TYPE;
+using eid_t = property_graph_types::EID_TYPE;
+using nbr_unit_t = property_graph_utils::NbrUnit<vid_t, eid_t>;
+using vid_array_t = typename ConvertToArrowType<vid_t>::ArrayType;
+using vid_builder_t = typename ConvertToArrowType<vid_t>::BuilderType;
+
+constexpr int kConcurrency = 4;
+
+void GenerateEdges(const IdParser<vid_t>& parser,
+                   const std::vector<vid_t>& vnums, int64_t edge_num,
+                   std::shared_ptr<vid_array_t>& srcs,
+                   std::shared_ptr<vid_array_t>& dsts) {
+  std::mt19937_64 rng(20211015);
+  vid_builder_t src_builder, dst_builder;
+  CHECK(src_builder.Reserve(edge_num).ok());
+  CHECK(dst_builder.Reserve(edge_num).ok());
+  for (int64_t i = 0; i < edge_num; ++i) {
+    int src_label = rng() % vnums.size(), dst_label = rng() % vnums.size();
+    // a few dense vertices, with many parallel edges
+    uint64_t src_offset = rng() % vnums[src_label];
+    src_offset = std::min(src_offset, rng() % vnums[src_label]);
+    uint64_t dst_offset = rng() % std::min<vid_t>(vnums[dst_label], 64);
+    src_builder.UnsafeAppend(parser.GenerateId(0, src_label, src_offset));
+    dst_builder.UnsafeAppend(parser.GenerateId(0, dst_label, dst_offset));
+  }
+  CHECK(src_builder.Finish(&srcs).ok());
+  CHECK(dst_builder.Finish(&dsts).ok());
+}
+
+void BuildCSR(IdParser<vid_t>& parser,
+              const std::shared_ptr<vid_array_t>& srcs,
+              const std::shared_ptr<vid_array_t>& dsts,
+              const std::vector<vid_t>& vnums, int concurrency,
+              std::vector<std::shared_ptr<arrow::FixedSizeBinaryArray>>& edges,
+              std::vector<std::shared_ptr<arrow::Int64Array>>& offsets) {
+  edges.resize(vnums.size());
+  offsets.resize(vnums.size());
+  boost::leaf::try_handle_all(
+      [&]() {
+        return generate_directed_csr<vid_t, eid_t>(parser, srcs, dsts, vnums,
+                                                   vnums.size(), concurrency,
+                                                   edges, offsets);
+      },
+      [](const GSError& e) { LOG(FATAL) << e.error_msg; },
+      [](const boost::leaf::error_info& unmatched) {
+        LOG(FATAL) << "Unmatched error " << unmatched;
+      });
+}
+
+// the CSR built in parallel must have the same neighbors for every vertex as
+// the one built sequentially, and when the degrees are counted by threads
+// (i.e., the histograms of the threads are no larger than the edge list),
+// exactly the same layout, as the edges of a vertex are placed in order.
+void TestCSR(const std::vector<vid_t>& vnums, int64_t edge_num,
+             bool ordered) {
+  CHECK_LT(edge_num, property_graph_utils::kPartitionedCSRThreshold);
+  IdParser<vid_t> parser;
+  parser.Init(1, vnums.size());
+
+  std::shared_ptr<vid_array_t> srcs, dsts;
+  GenerateEdges(parser, vnums, edge_num, srcs, dsts);
+
+  std::vector<std::shared_ptr<arrow::FixedSizeBinaryArray>> expected_edges,
+      edges;
+  std::vector<std::shared_ptr<arrow::Int64Array>> expected_offsets, offsets;
+  BuildCSR(parser, srcs, dsts, vnums, 1, expected_edges, expected_offsets);
+  BuildCSR(parser, srcs, dsts, vnums, kConcurrency, edges, offsets);
+
+  auto less = [](const nbr_unit_t& lhs, const nbr_unit_t& rhs) {
+    return std::tie(lhs.vid, lhs.eid) < std::tie(rhs.vid, rhs.eid);
+  };
+  for (size_t v_label = 0; v_label < vnums.size(); ++v_label) {
+    CHECK_EQ(offsets[v_label]->length(),
+             static_cast<int64_t>(vnums[v_label]) + 1);
+    CHECK(offsets[v_label]->Equals(*expected_offsets[v_label]));
+    if (ordered) {
+      CHECK(edges[v_label]->Equals(*expected_edges[v_label]));
+    }
+    auto nbrs =
+        reinterpret_cast<const nbr_unit_t*>(edges[v_label]->GetValue(0));
+    auto expected_nbrs = reinterpret_cast<const nbr_unit_t*>(
+        expected_edges[v_label]->GetValue(0));
+    const int64_t* offset = offsets[v_label]->raw_values();
+    for (vid_t v = 0; v < vnums[v_label]; ++v) {
+      std::vector<nbr_unit_t> actual(nbrs + offset[v], nbrs + offset[v + 1]),
+          expected(expected_nbrs + offset[v], expected_nbrs + offset[v + 1]);
+      for (size_t k = 1; k < actual.size(); ++k) {
+        CHECK_LE(actual[k - 1].vid, actual[k].vid);
+      }
+      std::sort(actual.begin(), actual.end(), less);
+      std::sort(expected.begin(), expected.end(), less);
+      for (size_t k = 0; k < actual.size(); ++k) {
+        CHECK_EQ(actual[k].vid, expected[k].vid);
+        CHECK_EQ(actual[k].eid, expected[k].eid);
+        CHECK_EQ(srcs->Value(actual[k].eid),
+                 parser.GenerateId(0, v_label, v));
+        CHECK_EQ(dsts->Value(actual[k].eid), actual[k].vid);
+      }
+    }
+  }
+}
+
+int main(int argc, char** argv) {
+  // the degrees are counted by threads
+  TestCSR({1000, 500, 1}, 1 << 20, true);
+  // too many vertices for the histograms of threads, counted by atomics
+  TestCSR({1 << 20, 1 << 18}, 100000, false);
+
+  LOG(INFO) << "Passed directed csr test...";
+
+  return 0;
+}
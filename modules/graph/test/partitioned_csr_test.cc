@@ -0,0 +1,192 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <stdio.h>
+
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <tuple>
+#include <vector>
+
+#include "glog/logging.h"
+
+#include "graph/fragment/property_graph_utils.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+using vid_t = property_graph_types::VID_TYPE;
+using eid_t = property_graph_types::EID_TYPE;
+using nbr_unit_t = property_graph_utils::NbrUnit<vid_t, eid_t>;
+using vid_array_t = typename ConvertToArrowType<vid_t>::ArrayType;
+using vid_builder_t = typename ConvertToArrowType<vid_t>::BuilderType;
+
+// generates `edge_num` edges between the vertices of the labels, where the
+// sources are skewed to the first vertices of every label
+void GenerateEdges(const IdParser<vid_t>& parser,
+                   const std::vector<vid_t>& vnums, int64_t edge_num,
+                   std::shared_ptr<vid_array_t>& srcs,
+                   std::shared_ptr<vid_array_t>& dsts) {
+  std::mt19937_64 rng(20211015);
+  vid_builder_t src_builder, dst_builder;
+  CHECK(src_builder.Reserve(edge_num).ok());
+  CHECK(dst_builder.Reserve(edge_num).ok());
+  for (int64_t i = 0; i < edge_num; ++i) {
+    int src_label = rng() % vnums.size(), dst_label = rng() % vnums.size();
+    uint64_t src_offset = rng() % vnums[src_label];
+    src_offset = std::min(src_offset, rng() % vnums[src_label]);
+    uint64_t dst_offset = rng() % vnums[dst_label];
+    src_builder.UnsafeAppend(parser.GenerateId(0, src_label, src_offset));
+    dst_builder.UnsafeAppend(parser.GenerateId(0, dst_label, dst_offset));
+  }
+  CHECK(src_builder.Finish(&srcs).ok());
+  CHECK(dst_builder.Finish(&dsts).ok());
+}
+
+void BuildCSR(IdParser<vid_t>& parser,
+              const std::shared_ptr<vid_array_t>& srcs,
+              const std::shared_ptr<vid_array_t>& dsts,
+              const std::vector<vid_t>& vnums, int concurrency,
+              std::vector<std::shared_ptr<arrow::FixedSizeBinaryArray>>& edges,
+              std::vector<std::shared_ptr<arrow::Int64Array>>& offsets) {
+  edges.resize(vnums.size());
+  offsets.resize(vnums.size());
+  boost::leaf::try_handle_all(
+      [&]() {
+        return generate_directed_csr<vid_t, eid_t>(parser, srcs, dsts, vnums,
+                                                   vnums.size(), concurrency,
+                                                   edges, offsets);
+      },
+      [](const GSError& e) { LOG(FATAL) << e.error_msg; },
+      [](const boost::leaf::error_info& unmatched) {
+        LOG(FATAL) << "Unmatched error " << unmatched;
+      });
+}
+
+// the CSR built from the partitioned edges must have the same neighbors for
+// every vertex as the one built sequentially
+void TestPartitionedCSR() {
+  std::vector<vid_t> vnums{1 << 20, 300000};
+  int64_t edge_num = property_graph_utils::kPartitionedCSRThreshold + 12345;
+  IdParser<vid_t> parser;
+  parser.Init(1, vnums.size());
+
+  std::shared_ptr<vid_array_t> srcs, dsts;
+  GenerateEdges(parser, vnums, edge_num, srcs, dsts);
+
+  std::vector<std::shared_ptr<arrow::FixedSizeBinaryArray>> expected_edges,
+      edges;
+  std::vector<std::shared_ptr<arrow::Int64Array>> expected_offsets, offsets;
+  BuildCSR(parser, srcs, dsts, vnums, 1, expected_edges, expected_offsets);
+  BuildCSR(parser, srcs, dsts, vnums, 4, edges, offsets);
+
+  auto less = [](const nbr_unit_t& lhs, const nbr_unit_t& rhs) {
+    return std::tie(lhs.vid, lhs.eid) < std::tie(rhs.vid, rhs.eid);
+  };
+  for (size_t v_label = 0; v_label < vnums.size(); ++v_label) {
+    CHECK_EQ(offsets[v_label]->length(),
+             static_cast<int64_t>(vnums[v_label]) + 1);
+    CHECK(offsets[v_label]->Equals(*expected_offsets[v_label]));
+    auto nbrs =
+        reinterpret_cast<const nbr_unit_t*>(edges[v_label]->GetValue(0));
+    auto expected_nbrs = reinterpret_cast<const nbr_unit_t*>(
+        expected_edges[v_label]->GetValue(0));
+    const int64_t* offset = offsets[v_label]->raw_values();
+    for (vid_t v = 0; v < vnums[v_label]; ++v) {
+      std::vector<nbr_unit_t> actual(nbrs + offset[v], nbrs + offset[v + 1]),
+          expected(expected_nbrs + offset[v], expected_nbrs + offset[v + 1]);
+      // sorted by vids, the order of the parallel edges is unspecified
+      for (size_t k = 1; k < actual.size(); ++k) {
+        CHECK_LE(actual[k - 1].vid, actual[k].vid);
+      }
+      std::sort(actual.begin(), actual.end(), less);
+      std::sort(expected.begin(), expected.end(), less);
+      for (size_t k = 0; k < actual.size(); ++k) {
+        CHECK_EQ(actual[k].vid, expected[k].vid);
+        CHECK_EQ(actual[k].eid, expected[k].eid);
+        CHECK_EQ(srcs->Value(actual[k].eid),
+                 parser.GenerateId(0, v_label, v));
+        CHECK_EQ(dsts->Value(actual[k].eid), actual[k].vid);
+      }
+    }
+  }
+}
+
+// the partitions must cover the position ranges in order, and be stable, in
+// both passes, where the vertex space is large enough for the second pass
+void TestPartitionEdges() {
+  std::vector<vid_t> vnums{1 << 26, 1 << 25};
+  std::vector<int64_t> label_bases{0, static_cast<int64_t>(vnums[0]),
+                                   static_cast<int64_t>(vnums[0] + vnums[1])};
+  int64_t edge_num = 1 << 20;
+  IdParser<vid_t> parser;
+  parser.Init(1, vnums.size());
+
+  std::shared_ptr<vid_array_t> srcs, dsts;
+  GenerateEdges(parser, vnums, edge_num, srcs, dsts);
+
+  std::unique_ptr<property_graph_utils::PartitionedEdge<vid_t, eid_t>[]>
+      partitions;
+  std::vector<int64_t> partition_offsets;
+  property_graph_utils::partition_edges_by_src<vid_t, eid_t>(
+      parser, srcs->raw_values(), dsts->raw_values(), edge_num, label_bases,
+      4, partitions, partition_offsets);
+
+  int shift = 0;
+  while ((label_bases.back() >> shift) >=
+         (1 << property_graph_utils::kCSRPartitionBits)) {
+    ++shift;
+  }
+  CHECK_GT(shift, property_graph_utils::kCSRLocalBits);
+  auto position_of = [&](vid_t src) -> int64_t {
+    return label_bases[parser.GetLabelId(src)] + parser.GetOffset(src);
+  };
+
+  CHECK_EQ(partition_offsets.front(), 0);
+  CHECK_EQ(partition_offsets.back(), edge_num);
+  std::vector<bool> visited(edge_num, false);
+  for (size_t p = 0; p + 1 < partition_offsets.size(); ++p) {
+    for (int64_t k = partition_offsets[p]; k < partition_offsets[p + 1];
+         ++k) {
+      auto const& edge = partitions[k];
+      CHECK_EQ(edge.src, srcs->Value(edge.eid));
+      CHECK_EQ(edge.dst, dsts->Value(edge.eid));
+      CHECK(!visited[edge.eid]);
+      visited[edge.eid] = true;
+      CHECK_EQ(position_of(edge.src) >> shift, static_cast<int64_t>(p));
+      if (k == partition_offsets[p]) {
+        continue;
+      }
+      auto const& prev = partitions[k - 1];
+      int64_t bucket =
+          position_of(edge.src) >> property_graph_utils::kCSRLocalBits;
+      int64_t prev_bucket =
+          position_of(prev.src) >> property_graph_utils::kCSRLocalBits;
+      CHECK_LE(prev_bucket, bucket);
+      if (prev_bucket == bucket) {
+        CHECK_LT(prev.eid, edge.eid);
+      }
+    }
+  }
+}
+
+int main(int argc, char** argv) {
+  TestPartitionEdges();
+  TestPartitionedCSR();
+
+  LOG(INFO) << "Passed partitioned csr test...";
+
+  return 0;
+}
@@ -0,0 +1,192 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <stdio.h>
+
+#include <algorithm>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "arrow/api.h"
+#include "glog/logging.h"
+
+#include "graph/utils/partitioner.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+constexpr fid_t kFnum = 7;
+
+// large enough to be split into ranges for multiple threads
+constexpr int64_t kLength = 300007;
+
+int64_t OidOf(int64_t index) { return index * 7919 - 1000003; }
+
+std::string StringOidOf(int64_t index) {
+  // includes the empty string
+  return index == 0 ? "" : "vertex-" + std::to_string(OidOf(index));
+}
+
+template <typename BUILDER_T, typename FUNC_T>
+std::shared_ptr<arrow::Array> MakeArray(const FUNC_T& oid_of) {
+  BUILDER_T builder;
+  for (int64_t index = 0; index < kLength; ++index) {
+    CHECK(builder.Append(oid_of(index)).ok());
+  }
+  std::shared_ptr<arrow::Array> array;
+  CHECK(builder.Finish(&array).ok());
+  return array;
+}
+
+// the partition ids of the whole array (and of a slice of it) must be the
+// same as the ones of the elements, with any concurrency, and the offset
+// lists must hold every element in order under its partition id.
+template <typename PARTITIONER_T, typename ARRAY_T, typename FUNC_T>
+void CheckPartitioner(const PARTITIONER_T& partitioner,
+                      const std::shared_ptr<arrow::Array>& array,
+                      const FUNC_T& oid_of) {
+  std::vector<fid_t> expected(kLength);
+  for (int64_t index = 0; index < kLength; ++index) {
+    expected[index] = partitioner.GetPartitionId(oid_of(index));
+    CHECK_LT(expected[index], kFnum);
+  }
+
+  for (int concurrency : {1, 4, 13}) {
+    std::vector<fid_t> fids(kLength, kFnum);
+    partitioner.GetPartitionIds(*array, fids.data(), concurrency);
+    CHECK(fids == expected);
+
+    int64_t offset = 12345, length = kLength - 2 * offset;
+    auto slice =
+        std::dynamic_pointer_cast<ARRAY_T>(array->Slice(offset, length));
+    std::vector<fid_t> slice_fids(length, kFnum);
+    partitioner.GetPartitionIds(*slice, slice_fids.data(), concurrency);
+    CHECK(std::equal(slice_fids.begin(), slice_fids.end(),
+                     expected.begin() + offset));
+
+    // the offsets are appended to the existing ones
+    std::vector<std::vector<int64_t>> offset_lists(kFnum, {-1});
+    PartitionArray(partitioner, *array, kFnum, offset_lists, concurrency);
+    CHECK_EQ(offset_lists.size(), kFnum);
+    int64_t total = 0;
+    for (fid_t fid = 0; fid < kFnum; ++fid) {
+      auto& offsets = offset_lists[fid];
+      CHECK_EQ(offsets.front(), -1);
+      for (size_t k = 1; k < offsets.size(); ++k) {
+        CHECK_EQ(expected[offsets[k]], fid);
+        if (k > 1) {
+          CHECK_LT(offsets[k - 1], offsets[k]);
+        }
+      }
+      total += offsets.size() - 1;
+    }
+    CHECK_EQ(total, kLength);
+  }
+}
+
+// on a power-law graph where the hot vertices come first, the degree
+// balanced partitioner must spread the hottest vertices and balance the
+// loads, where the segmented partitioning is skewed.
+void TestDegreeBalancedPartitioner() {
+  std::vector<int64_t> oids, degrees;
+  int64_t total_load = 0;
+  for (int64_t index = 0; index < kLength; ++index) {
+    oids.emplace_back(OidOf(index));
+    degrees.emplace_back(1000000 / (index + 1));
+    total_load += degrees.back() + 1;
+  }
+  DegreeBalancedPartitioner<int64_t> partitioner;
+  partitioner.Init(kFnum, oids, degrees);
+
+  std::vector<int64_t> loads(kFnum, 0), segmented_loads(kFnum, 0);
+  int64_t segment = (kLength + kFnum - 1) / kFnum;
+  for (int64_t index = 0; index < kLength; ++index) {
+    fid_t fid = partitioner.GetPartitionId(oids[index]);
+    CHECK_LT(fid, kFnum);
+    loads[fid] += degrees[index] + 1;
+    segmented_loads[index / segment] += degrees[index] + 1;
+  }
+  CHECK(loads == partitioner.loads());
+
+  double average = static_cast<double>(total_load) / kFnum;
+  double imbalance = *std::max_element(loads.begin(), loads.end()) / average;
+  double segmented_imbalance =
+      *std::max_element(segmented_loads.begin(), segmented_loads.end()) /
+      average;
+  LOG(INFO) << "load imbalance: " << imbalance
+            << ", segmented: " << segmented_imbalance;
+  CHECK_LE(imbalance, 1.05);
+  CHECK_GT(segmented_imbalance, 2.0);
+
+  std::set<fid_t> hottest;
+  for (fid_t index = 0; index < kFnum; ++index) {
+    hottest.insert(partitioner.GetPartitionId(oids[index]));
+  }
+  CHECK_EQ(hottest.size(), kFnum);
+
+  CheckPartitioner<DegreeBalancedPartitioner<int64_t>, arrow::Int64Array>(
+      partitioner, MakeArray<arrow::Int64Builder>(OidOf), OidOf);
+}
+
+int main(int argc, char** argv) {
+  auto int64_array = MakeArray<arrow::Int64Builder>(OidOf);
+  auto string_array = MakeArray<arrow::StringBuilder>(StringOidOf);
+  auto large_string_array = MakeArray<arrow::LargeStringBuilder>(StringOidOf);
+
+  {
+    HashPartitioner<int64_t> partitioner;
+    partitioner.Init(kFnum);
+    CheckPartitioner<HashPartitioner<int64_t>, arrow::Int64Array>(
+        partitioner, int64_array, OidOf);
+  }
+  {
+    HashPartitioner<std::string> partitioner;
+    partitioner.Init(kFnum);
+    CheckPartitioner<HashPartitioner<std::string>, arrow::StringArray>(
+        partitioner, string_array, StringOidOf);
+    CheckPartitioner<HashPartitioner<std::string>, arrow::LargeStringArray>(
+        partitioner, large_string_array, StringOidOf);
+  }
+  LOG(INFO) << "Passed hash partitioner test...";
+
+  {
+    std::vector<int64_t> oids;
+    for (int64_t index = 0; index < kLength; ++index) {
+      oids.emplace_back(OidOf(index));
+    }
+    SegmentedPartitioner<int64_t> partitioner;
+    partitioner.Init(kFnum, oids);
+    CheckPartitioner<SegmentedPartitioner<int64_t>, arrow::Int64Array>(
+        partitioner, int64_array, OidOf);
+  }
+  {
+    std::vector<std::string> oids;
+    for (int64_t index = 0; index < kLength; ++index) {
+      oids.emplace_back(StringOidOf(index));
+    }
+    SegmentedPartitioner<std::string> partitioner;
+    partitioner.Init(kFnum, oids);
+    CheckPartitioner<SegmentedPartitioner<std::string>,
+                     arrow::LargeStringArray>(partitioner, large_string_array,
+                                              StringOidOf);
+  }
+  LOG(INFO) << "Passed segmented partitioner test...";
+
+  TestDegreeBalancedPartitioner();
+  LOG(INFO) << "Passed degree balanced partitioner test...";
+
+  return 0;
+}
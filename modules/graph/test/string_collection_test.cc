@@ -0,0 +1,159 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <stdio.h>
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "arrow/api.h"
+#include "glog/logging.h"
+
+#include "graph/utils/table_shuffler_beta.h"
+
+// after the MPI and grape headers that it depends on
+#include "graph/utils/string_collection.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+std::string StringOf(int64_t index) {
+  // includes empty strings and strings with NUL bytes
+  if (index % 7 == 0) {
+    return "";
+  }
+  std::string str = "string-" + std::to_string(index * 131);
+  if (index % 5 == 0) {
+    str[3] = '\0';
+  }
+  return str;
+}
+
+std::shared_ptr<arrow::LargeStringArray> MakeArray(int64_t begin,
+                                                   int64_t end) {
+  arrow::LargeStringBuilder builder;
+  for (int64_t index = begin; index < end; ++index) {
+    CHECK(builder.Append(StringOf(index)).ok());
+  }
+  std::shared_ptr<arrow::Array> array;
+  CHECK(builder.Finish(&array).ok());
+  return std::dynamic_pointer_cast<arrow::LargeStringArray>(array);
+}
+
+void CheckStrings(const grape::RSVector& vec, int64_t begin, int64_t end) {
+  CHECK_EQ(vec.size(), static_cast<size_t>(end - begin));
+  size_t bytes = 0;
+  int64_t index = begin;
+  for (auto& rs : vec) {
+    CHECK_EQ(rs.ToString(), StringOf(index));
+    CHECK_EQ(vec[index - begin].ToString(), StringOf(index));
+    bytes += rs.len;
+    ++index;
+  }
+  CHECK_EQ(index, end);
+  CHECK_EQ(vec.size_in_bytes(), bytes);
+}
+
+void TestRSVector() {
+  grape::RSVector vec;
+  CheckStrings(vec, 0, 0);
+  for (int64_t index = 0; index < 1000; ++index) {
+    if (index % 2 == 0) {
+      vec.emplace_back(StringOf(index));
+    } else {
+      std::string str = StringOf(index);
+      vec.emplace(grape::RefString(str.data(), str.size()));
+    }
+  }
+  CheckStrings(vec, 0, 1000);
+
+  // appends another vector, and (a slice of) arrow arrays
+  grape::RSVector other;
+  for (int64_t index = 1000; index < 1500; ++index) {
+    other.emplace_back(StringOf(index));
+  }
+  vec.append(other);
+  CheckStrings(vec, 0, 1500);
+  vec.append(*MakeArray(1500, 2000));
+  auto array = MakeArray(1900, 3100);
+  vec.append(*std::dynamic_pointer_cast<arrow::LargeStringArray>(
+      array->Slice(100, 1000)));
+  vec.append(*MakeArray(3000, 3000));
+  CheckStrings(vec, 0, 3000);
+
+  std::vector<std::string> strings = vec;
+  CHECK_EQ(strings.size(), static_cast<size_t>(3000));
+  for (int64_t index = 0; index < 3000; ++index) {
+    CHECK_EQ(strings[index], StringOf(index));
+  }
+
+  grape::RSVector copied(vec);
+  CheckStrings(copied, 0, 3000);
+  grape::RSVector moved(std::move(copied));
+  CheckStrings(moved, 0, 3000);
+  CheckStrings(copied, 0, 0);
+
+  // the buffers are handed over, and the vector can be reused
+  auto converted = vec.ToArrowArray();
+  CheckStrings(vec, 0, 0);
+  CHECK(converted->Equals(*MakeArray(0, 3000)));
+  grape::RSVector from_array(*converted);
+  CheckStrings(from_array, 0, 3000);
+  vec.emplace_back(StringOf(1));
+  CheckStrings(vec, 1, 2);
+
+  vec.clear();
+  CheckStrings(vec, 0, 0);
+  CHECK(vec.ToArrowArray()->Equals(*MakeArray(0, 0)));
+}
+
+// the selected rows of string columns must be kept as is, and selecting all
+// rows hands over the batch
+void TestSelectRows() {
+  auto schema = arrow::schema({arrow::field("name", arrow::large_utf8())});
+  auto array = MakeArray(0, 10000);
+  auto batch = arrow::RecordBatch::Make(schema, 10000, {array});
+  auto slice = batch->Slice(1000, 5000);
+
+  std::vector<int64_t> offset;
+  for (int64_t index = 0; index < 5000; index += 3) {
+    offset.push_back(index);
+  }
+  std::shared_ptr<arrow::RecordBatch> selected;
+  beta::SelectRows(slice, offset, selected);
+  CHECK_EQ(selected->num_rows(), static_cast<int64_t>(offset.size()));
+  auto names =
+      std::dynamic_pointer_cast<arrow::LargeStringArray>(selected->column(0));
+  for (size_t k = 0; k < offset.size(); ++k) {
+    CHECK_EQ(names->GetString(k), StringOf(1000 + offset[k]));
+  }
+
+  offset.clear();
+  for (int64_t index = 0; index < 5000; ++index) {
+    offset.push_back(index);
+  }
+  beta::SelectRows(slice, offset, selected);
+  CHECK(selected == slice);
+}
+
+int main(int argc, char** argv) {
+  TestRSVector();
+  TestSelectRows();
+
+  LOG(INFO) << "Passed string collection test...";
+
+  return 0;
+}
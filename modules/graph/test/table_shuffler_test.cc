@@ -0,0 +1,356 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <stdio.h>
+
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "arrow/api.h"
+#include "glog/logging.h"
+
+#include "basic/ds/arrow_utils.h"
+#include "graph/fragment/property_graph_utils.h"
+#include "graph/utils/partitioner.h"
+#include "graph/utils/table_shuffler.h"
+#include "graph/utils/table_shuffler_beta.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+// the rows of a worker are split into uneven record batches
+constexpr int64_t kBatchRows = 4093;
+
+// every row is identified by a key that is unique across workers, and the
+// other columns are derived from the key, thus every worker knows the rows
+// of all workers
+int64_t KeyOf(int worker_id, int64_t index) {
+  return (static_cast<int64_t>(worker_id) << 32) + index;
+}
+
+int64_t RowNum(int worker_id, bool empty_first) {
+  if (empty_first && worker_id == 0) {
+    return 0;
+  }
+  return 20000 + 3001 * worker_id;
+}
+
+uint64_t SrcOf(const IdParser<uint64_t>& parser, fid_t fnum, int64_t key) {
+  uint64_t hash = static_cast<uint64_t>(key) * 2654435761ULL;
+  return parser.GenerateId(hash % fnum, 0, key % 1000);
+}
+
+uint64_t DstOf(const IdParser<uint64_t>& parser, fid_t fnum, int64_t key) {
+  uint64_t hash = static_cast<uint64_t>(key) * 40503ULL + 7;
+  return parser.GenerateId(hash % fnum, 0, key % 997);
+}
+
+std::string NameOf(int64_t key) {
+  // includes empty strings
+  return key % 5 == 0 ? "" : "row-" + std::to_string(key);
+}
+
+std::shared_ptr<arrow::Table> MakeTable(
+    const std::shared_ptr<arrow::Schema>& schema, int worker_id,
+    bool empty_first,
+    const std::function<std::shared_ptr<arrow::RecordBatch>(int64_t, int64_t)>&
+        make_batch) {
+  std::vector<std::shared_ptr<arrow::RecordBatch>> batches;
+  int64_t row_num = RowNum(worker_id, empty_first);
+  for (int64_t begin = 0; begin < row_num; begin += kBatchRows) {
+    batches.emplace_back(
+        make_batch(begin, std::min(begin + kBatchRows, row_num)));
+  }
+  std::shared_ptr<arrow::Table> table;
+  if (batches.empty()) {
+    VINEYARD_CHECK_OK(EmptyTableBuilder::Build(schema, table));
+  } else {
+    VINEYARD_CHECK_OK(RecordBatchesToTable(batches, &table));
+  }
+  return table;
+}
+
+std::vector<std::shared_ptr<arrow::RecordBatch>> ToRecordBatches(
+    const std::shared_ptr<arrow::Table>& table) {
+  std::vector<std::shared_ptr<arrow::RecordBatch>> batches;
+  VINEYARD_CHECK_OK(TableToRecordBatches(table, &batches));
+  return batches;
+}
+
+// the taken rows must keep the values and the nulls of every column, also
+// for sliced batches, and taking all rows hands over the batch
+void TestTakeRows() {
+  auto schema = arrow::schema({arrow::field("key", arrow::int64()),
+                               arrow::field("value", arrow::float64()),
+                               arrow::field("name", arrow::large_utf8())});
+  constexpr int64_t kRows = 10000;
+  arrow::Int64Builder key_builder;
+  arrow::DoubleBuilder value_builder;
+  arrow::LargeStringBuilder name_builder;
+  for (int64_t key = 0; key < kRows; ++key) {
+    CHECK(key_builder.Append(key).ok());
+    if (key % 3 == 0) {
+      CHECK(value_builder.AppendNull().ok());
+    } else {
+      CHECK(value_builder.Append(key * 0.5).ok());
+    }
+    CHECK(name_builder.Append(NameOf(key)).ok());
+  }
+  std::vector<std::shared_ptr<arrow::Array>> columns(3);
+  CHECK(key_builder.Finish(&columns[0]).ok());
+  CHECK(value_builder.Finish(&columns[1]).ok());
+  CHECK(name_builder.Finish(&columns[2]).ok());
+  auto batch = arrow::RecordBatch::Make(schema, kRows, columns);
+  auto slice = batch->Slice(1000, 5000);
+
+  std::vector<int64_t> offset;
+  for (int64_t index = 4999; index >= 0; index -= 7) {
+    offset.push_back(index);
+  }
+  std::shared_ptr<arrow::RecordBatch> taken;
+  beta::TakeRows(slice, offset, taken);
+  CHECK(taken->schema()->Equals(*schema));
+  CHECK_EQ(taken->num_rows(), static_cast<int64_t>(offset.size()));
+  CHECK(taken->Validate().ok());
+  auto keys = std::dynamic_pointer_cast<arrow::Int64Array>(taken->column(0));
+  auto values =
+      std::dynamic_pointer_cast<arrow::DoubleArray>(taken->column(1));
+  auto names =
+      std::dynamic_pointer_cast<arrow::LargeStringArray>(taken->column(2));
+  for (size_t k = 0; k < offset.size(); ++k) {
+    int64_t key = 1000 + offset[k];
+    CHECK_EQ(keys->Value(k), key);
+    CHECK_EQ(values->IsNull(k), key % 3 == 0);
+    if (key % 3 != 0) {
+      CHECK_EQ(values->Value(k), key * 0.5);
+    }
+    CHECK_EQ(names->GetString(k), NameOf(key));
+  }
+
+  offset.clear();
+  beta::TakeRows(slice, offset, taken);
+  CHECK_EQ(taken->num_rows(), 0);
+  CHECK(taken->schema()->Equals(*schema));
+
+  for (int64_t index = 0; index < slice->num_rows(); ++index) {
+    offset.push_back(index);
+  }
+  beta::TakeRows(slice, offset, taken);
+  CHECK(taken == slice);
+}
+
+// every edge must arrive at the fragments of both of its endpoints, with
+// the whole row
+void TestShuffleEdges(const grape::CommSpec& comm_spec, bool empty_first) {
+  fid_t fnum = comm_spec.fnum();
+  IdParser<uint64_t> parser;
+  parser.Init(fnum, 1);
+
+  auto schema = arrow::schema({arrow::field("src", arrow::uint64()),
+                               arrow::field("dst", arrow::uint64()),
+                               arrow::field("key", arrow::int64()),
+                               arrow::field("name", arrow::large_utf8())});
+  auto table = MakeTable(
+      schema, comm_spec.worker_id(), empty_first,
+      [&](int64_t begin, int64_t end) {
+        arrow::UInt64Builder src_builder, dst_builder;
+        arrow::Int64Builder key_builder;
+        arrow::LargeStringBuilder name_builder;
+        for (int64_t index = begin; index < end; ++index) {
+          int64_t key = KeyOf(comm_spec.worker_id(), index);
+          CHECK(src_builder.Append(SrcOf(parser, fnum, key)).ok());
+          CHECK(dst_builder.Append(DstOf(parser, fnum, key)).ok());
+          CHECK(key_builder.Append(key).ok());
+          CHECK(name_builder.Append(NameOf(key)).ok());
+        }
+        std::vector<std::shared_ptr<arrow::Array>> columns(4);
+        CHECK(src_builder.Finish(&columns[0]).ok());
+        CHECK(dst_builder.Finish(&columns[1]).ok());
+        CHECK(key_builder.Finish(&columns[2]).ok());
+        CHECK(name_builder.Finish(&columns[3]).ok());
+        return arrow::RecordBatch::Make(schema, end - begin, columns);
+      });
+
+  auto shuffled = boost::leaf::try_handle_all(
+      [&]() {
+        return beta::ShufflePropertyEdgeTable<uint64_t>(comm_spec, parser, 0,
+                                                        1, table);
+      },
+      [](const GSError& e) {
+        LOG(FATAL) << e.error_msg;
+        return std::shared_ptr<arrow::Table>(nullptr);
+      },
+      [](const boost::leaf::error_info& unmatched) {
+        LOG(FATAL) << "Unmatched error " << unmatched;
+        return std::shared_ptr<arrow::Table>(nullptr);
+      });
+  CHECK(shuffled->schema()->Equals(*schema));
+  CHECK(shuffled->Validate().ok());
+
+  std::vector<int64_t> expected_keys, keys;
+  for (int worker_id = 0; worker_id < comm_spec.worker_num(); ++worker_id) {
+    for (int64_t index = 0; index < RowNum(worker_id, empty_first); ++index) {
+      int64_t key = KeyOf(worker_id, index);
+      if (parser.GetFid(SrcOf(parser, fnum, key)) == comm_spec.fid() ||
+          parser.GetFid(DstOf(parser, fnum, key)) == comm_spec.fid()) {
+        expected_keys.emplace_back(key);
+      }
+    }
+  }
+  for (auto const& batch : ToRecordBatches(shuffled)) {
+    auto srcs = std::dynamic_pointer_cast<arrow::UInt64Array>(batch->column(0));
+    auto dsts = std::dynamic_pointer_cast<arrow::UInt64Array>(batch->column(1));
+    auto keys_in =
+        std::dynamic_pointer_cast<arrow::Int64Array>(batch->column(2));
+    auto names =
+        std::dynamic_pointer_cast<arrow::LargeStringArray>(batch->column(3));
+    for (int64_t row = 0; row < batch->num_rows(); ++row) {
+      int64_t key = keys_in->Value(row);
+      CHECK_EQ(srcs->Value(row), SrcOf(parser, fnum, key));
+      CHECK_EQ(dsts->Value(row), DstOf(parser, fnum, key));
+      CHECK_EQ(names->GetString(row), NameOf(key));
+      keys.emplace_back(key);
+    }
+  }
+  std::sort(keys.begin(), keys.end());
+  CHECK(keys == expected_keys);
+}
+
+// every vertex must arrive at the fragment given by the partitioner
+void TestShuffleVertices(const grape::CommSpec& comm_spec, bool empty_first) {
+  HashPartitioner<int64_t> partitioner;
+  partitioner.Init(comm_spec.fnum());
+
+  auto schema = arrow::schema({arrow::field("id", arrow::int64()),
+                               arrow::field("name", arrow::large_utf8())});
+  auto table = MakeTable(
+      schema, comm_spec.worker_id(), empty_first,
+      [&](int64_t begin, int64_t end) {
+        arrow::Int64Builder id_builder;
+        arrow::LargeStringBuilder name_builder;
+        for (int64_t index = begin; index < end; ++index) {
+          int64_t key = KeyOf(comm_spec.worker_id(), index);
+          CHECK(id_builder.Append(key).ok());
+          CHECK(name_builder.Append(NameOf(key)).ok());
+        }
+        std::vector<std::shared_ptr<arrow::Array>> columns(2);
+        CHECK(id_builder.Finish(&columns[0]).ok());
+        CHECK(name_builder.Finish(&columns[1]).ok());
+        return arrow::RecordBatch::Make(schema, end - begin, columns);
+      });
+
+  auto shuffled = boost::leaf::try_handle_all(
+      [&]() {
+        return beta::ShufflePropertyVertexTable(comm_spec, partitioner,
+                                                table);
+      },
+      [](const GSError& e) {
+        LOG(FATAL) << e.error_msg;
+        return std::shared_ptr<arrow::Table>(nullptr);
+      },
+      [](const boost::leaf::error_info& unmatched) {
+        LOG(FATAL) << "Unmatched error " << unmatched;
+        return std::shared_ptr<arrow::Table>(nullptr);
+      });
+  CHECK(shuffled->schema()->Equals(*schema));
+  CHECK(shuffled->Validate().ok());
+
+  std::vector<int64_t> expected_keys, keys;
+  for (int worker_id = 0; worker_id < comm_spec.worker_num(); ++worker_id) {
+    for (int64_t index = 0; index < RowNum(worker_id, empty_first); ++index) {
+      int64_t key = KeyOf(worker_id, index);
+      if (partitioner.GetPartitionId(key) == comm_spec.fid()) {
+        expected_keys.emplace_back(key);
+      }
+    }
+  }
+  for (auto const& batch : ToRecordBatches(shuffled)) {
+    auto ids = std::dynamic_pointer_cast<arrow::Int64Array>(batch->column(0));
+    auto names =
+        std::dynamic_pointer_cast<arrow::LargeStringArray>(batch->column(1));
+    for (int64_t row = 0; row < batch->num_rows(); ++row) {
+      int64_t key = ids->Value(row);
+      CHECK_EQ(names->GetString(row), NameOf(key));
+      keys.emplace_back(key);
+    }
+  }
+  std::sort(keys.begin(), keys.end());
+  CHECK(keys == expected_keys);
+}
+
+template <typename T, typename BUILDER_T, typename FUNC_T>
+std::shared_ptr<typename ConvertToArrowType<T>::ArrayType> MakeArray(
+    int worker_id, bool empty_first, const FUNC_T& value_of) {
+  BUILDER_T builder;
+  for (int64_t index = 0; index < RowNum(worker_id, empty_first); ++index) {
+    CHECK(builder.Append(value_of(KeyOf(worker_id, index))).ok());
+  }
+  std::shared_ptr<typename ConvertToArrowType<T>::ArrayType> array;
+  CHECK(builder.Finish(&array).ok());
+  return array;
+}
+
+// every worker must receive the arrays of all workers in the slots of their
+// fragments, with the ring passing every array through all workers
+template <typename T, typename BUILDER_T, typename FUNC_T>
+void CheckAllGather(const grape::CommSpec& comm_spec, bool empty_first,
+                    const FUNC_T& value_of) {
+  std::vector<std::shared_ptr<typename ConvertToArrowType<T>::ArrayType>>
+      gathered;
+  VINEYARD_CHECK_OK(FragmentAllGatherArray<T>(
+      comm_spec,
+      MakeArray<T, BUILDER_T>(comm_spec.worker_id(), empty_first, value_of),
+      gathered));
+  CHECK_EQ(gathered.size(), comm_spec.fnum());
+  for (int worker_id = 0; worker_id < comm_spec.worker_num(); ++worker_id) {
+    auto const& array = gathered[comm_spec.WorkerToFrag(worker_id)];
+    CHECK(array->Equals(
+        *MakeArray<T, BUILDER_T>(worker_id, empty_first, value_of)))
+        << "mismatched array of worker " << worker_id;
+  }
+}
+
+void TestAllGather(const grape::CommSpec& comm_spec, bool empty_first) {
+  CheckAllGather<int64_t, arrow::Int64Builder>(
+      comm_spec, empty_first, [](int64_t key) { return key; });
+  CheckAllGather<double, arrow::DoubleBuilder>(
+      comm_spec, empty_first, [](int64_t key) { return key * 0.5; });
+  CheckAllGather<std::string, arrow::LargeStringBuilder>(comm_spec,
+                                                         empty_first, NameOf);
+}
+
+int main(int argc, char** argv) {
+  TestTakeRows();
+
+  grape::InitMPIComm();
+  {
+    grape::CommSpec comm_spec;
+    comm_spec.Init(MPI_COMM_WORLD);
+
+    for (bool empty_first : {false, true}) {
+      TestShuffleEdges(comm_spec, empty_first);
+      TestShuffleVertices(comm_spec, empty_first);
+      TestAllGather(comm_spec, empty_first);
+      MPI_Barrier(comm_spec.comm());
+    }
+  }
+  grape::FinalizeMPIComm();
+
+  LOG(INFO) << "Passed table shuffler test...";
+
+  return 0;
+}
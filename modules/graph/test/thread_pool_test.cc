@@ -0,0 +1,192 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <atomic>
+#include <future>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "glog/logging.h"
+
+#include "graph/fragment/property_graph_utils.h"
+#include "graph/utils/thread_pool.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+constexpr size_t kDefaultPoolSize = 3;
+
+void TestSubmit() {
+  ThreadPool pool(4);
+  CHECK_EQ(pool.ThreadNum(), static_cast<size_t>(4));
+
+  std::atomic<int64_t> sum(0);
+  std::vector<std::future<Status>> futures;
+  for (int64_t i = 0; i < 1000; ++i) {
+    futures.emplace_back(pool.Submit(
+        [&sum](int64_t value) -> Status {
+          sum += value;
+          return value % 100 == 7 ? Status::Invalid(std::to_string(value))
+                                  : Status::OK();
+        },
+        i));
+  }
+  for (size_t i = 0; i < futures.size(); ++i) {
+    Status status = pool.Wait(futures[i]);
+    if (i % 100 == 7) {
+      CHECK(status.IsInvalid());
+      CHECK_NE(status.ToString().find(std::to_string(i)), std::string::npos);
+    } else {
+      VINEYARD_CHECK_OK(status);
+    }
+  }
+  CHECK_EQ(sum.load(), 999 * 1000 / 2);
+
+  // exceptions are turned into failed status
+  auto future = pool.Submit([]() -> Status {
+    throw std::runtime_error("failed in the task");
+    return Status::OK();
+  });
+  Status status = pool.Wait(future);
+  CHECK(!status.ok());
+  CHECK_NE(status.ToString().find("failed in the task"), std::string::npos);
+}
+
+// tasks wait for the sub-tasks they submit, on a pool that is smaller than
+// the number of waiting tasks
+Status RunNested(ThreadPool& pool, int depth, std::atomic<int64_t>& leaves) {
+  if (depth == 0) {
+    ++leaves;
+    return Status::OK();
+  }
+  std::vector<std::future<Status>> futures;
+  for (int i = 0; i < 4; ++i) {
+    futures.emplace_back(pool.Submit(
+        [&pool, &leaves, depth]() -> Status {
+          return RunNested(pool, depth - 1, leaves);
+        }));
+  }
+  for (auto& future : futures) {
+    RETURN_ON_ERROR(pool.Wait(future));
+  }
+  return Status::OK();
+}
+
+void TestNested() {
+  ThreadPool pool(2);
+  std::atomic<int64_t> leaves(0);
+  VINEYARD_CHECK_OK(RunNested(pool, 4, leaves));
+  CHECK_EQ(leaves.load(), 4 * 4 * 4 * 4);
+
+  TaskGroup tg(pool);
+  for (int i = 0; i < 8; ++i) {
+    tg.AddTask([&pool, i]() -> Status {
+      std::atomic<int64_t> leaves(0);
+      RETURN_ON_ERROR(RunNested(pool, 2, leaves));
+      return leaves.load() == 16 ? Status::OK()
+                                 : Status::Invalid(std::to_string(i));
+    });
+  }
+  VINEYARD_CHECK_OK(tg.TaskResult(3));
+  auto results = tg.TakeResults();
+  CHECK_EQ(results.size(), static_cast<size_t>(8));
+  for (auto const& status : results) {
+    VINEYARD_CHECK_OK(status);
+  }
+}
+
+void TestPinning() {
+#if defined(__linux__)
+  // the workers are pinned to the first cores, which may be out of the
+  // allowed ones, e.g., in containers
+  cpu_set_t allowed;
+  CPU_ZERO(&allowed);
+  CHECK_EQ(pthread_getaffinity_np(pthread_self(), sizeof(cpu_set_t), &allowed),
+           0);
+  if (std::thread::hardware_concurrency() < 2 || !CPU_ISSET(0, &allowed) ||
+      !CPU_ISSET(1, &allowed)) {
+    LOG(INFO) << "Skipped the pinning test as the first cores are unavailable";
+    return;
+  }
+
+  ThreadPool pool(2, true);
+  std::vector<std::future<Status>> futures;
+  for (int i = 0; i < 16; ++i) {
+    futures.emplace_back(pool.Submit([]() -> Status {
+      cpu_set_t cpus;
+      CPU_ZERO(&cpus);
+      if (pthread_getaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpus)) {
+        return Status::IOError("failed to get the affinity");
+      }
+      return CPU_COUNT(&cpus) == 1 ? Status::OK()
+                                   : Status::Invalid("not pinned");
+    }));
+  }
+  // waits without running the tasks in the current (unpinned) thread
+  for (auto& future : futures) {
+    VINEYARD_CHECK_OK(future.get());
+  }
+#endif
+}
+
+void TestParallelFor() {
+  CHECK_EQ(ThreadPool::Default().ThreadNum(), kDefaultPoolSize);
+
+  std::vector<std::atomic<int>> visited(100003);
+  for (auto& count : visited) {
+    count = 0;
+  }
+  parallel_for(
+      static_cast<size_t>(0), visited.size(),
+      [&visited](size_t index) { ++visited[index]; }, 8, 97);
+  for (auto& count : visited) {
+    CHECK_EQ(count.load(), 1);
+  }
+
+  // the failures of the function are rethrown
+  bool failed = false;
+  try {
+    parallel_for(
+        0, 1000,
+        [](int index) {
+          if (index == 517) {
+            throw std::runtime_error("failed at " + std::to_string(index));
+          }
+        },
+        4);
+  } catch (std::runtime_error& e) {
+    failed = std::string(e.what()).find("failed at 517") != std::string::npos;
+  }
+  CHECK(failed);
+}
+
+int main(int argc, char** argv) {
+  // before the default pool is created
+  setenv("VINEYARD_THREAD_POOL_SIZE", std::to_string(kDefaultPoolSize).c_str(),
+         1);
+
+  TestSubmit();
+  TestNested();
+  TestPinning();
+  TestParallelFor();
+
+  LOG(INFO) << "Passed thread pool test...";
+
+  return 0;
+}
@@ -0,0 +1,140 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <stdio.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "arrow/api.h"
+#include "glog/logging.h"
+
+#include "client/client.h"
+#include "graph/vertex_map/arrow_vertex_map.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+using VertexMapType = ArrowVertexMap<int64_t, uint64_t>;
+using label_id_t = property_graph_types::LABEL_ID_TYPE;
+
+// more (fragment, label) pairs than the hardware threads, including empty
+// ones, thus the tasks of building hashmaps are queued for the workers
+constexpr fid_t kFnum = 8;
+constexpr label_id_t kLabelNum = 6;
+constexpr label_id_t kExtraLabelNum = 2;
+
+int64_t VertexNum(fid_t fid, label_id_t label) {
+  return ((fid * 7 + label * 13) % 11) * 997;
+}
+
+int64_t OidOf(fid_t fid, label_id_t label, int64_t index) {
+  // unique in a label across fragments, and not in the order of the index
+  return (static_cast<int64_t>(label) << 40) +
+         (static_cast<int64_t>(fid) << 32) + (index * 7919) % 1000003;
+}
+
+std::vector<std::vector<std::shared_ptr<arrow::Int64Array>>> MakeOidArrays(
+    label_id_t label_begin, label_id_t label_end) {
+  std::vector<std::vector<std::shared_ptr<arrow::Int64Array>>> oid_arrays(
+      label_end - label_begin);
+  for (label_id_t label = label_begin; label < label_end; ++label) {
+    for (fid_t fid = 0; fid < kFnum; ++fid) {
+      arrow::Int64Builder builder;
+      for (int64_t index = 0; index < VertexNum(fid, label); ++index) {
+        CHECK_ARROW_ERROR(builder.Append(OidOf(fid, label, index)));
+      }
+      std::shared_ptr<arrow::Array> array;
+      CHECK_ARROW_ERROR(builder.Finish(&array));
+      oid_arrays[label - label_begin].emplace_back(
+          std::dynamic_pointer_cast<arrow::Int64Array>(array));
+    }
+  }
+  return oid_arrays;
+}
+
+void CheckVertexMap(const std::shared_ptr<VertexMapType>& vm,
+                    label_id_t label_num) {
+  CHECK_EQ(vm->fnum(), kFnum);
+  CHECK_EQ(vm->label_num(), label_num);
+  IdParser<uint64_t> id_parser;
+  id_parser.Init(kFnum, label_num);
+
+  size_t total = 0;
+  for (fid_t fid = 0; fid < kFnum; ++fid) {
+    for (label_id_t label = 0; label < label_num; ++label) {
+      int64_t vnum = VertexNum(fid, label);
+      CHECK_EQ(vm->GetInnerVertexSize(fid, label),
+               static_cast<uint64_t>(vnum));
+      total += vnum;
+      for (int64_t index = 0; index < vnum; ++index) {
+        int64_t oid = OidOf(fid, label, index);
+        uint64_t expected = id_parser.GenerateId(fid, label, index);
+        uint64_t gid = 0;
+        CHECK(vm->GetGid(fid, label, oid, gid));
+        CHECK_EQ(gid, expected);
+        gid = 0;
+        CHECK(vm->GetGid(label, oid, gid));
+        CHECK_EQ(gid, expected);
+        int64_t fetched = -1;
+        CHECK(vm->GetOid(expected, fetched));
+        CHECK_EQ(fetched, oid);
+      }
+      // the oids of other fragments and labels are not found
+      uint64_t gid = 0;
+      CHECK(!vm->GetGid(fid, label, OidOf(fid, label + 1, 0), gid));
+      CHECK(!vm->GetGid(fid, label, OidOf(fid + 1, label, 0), gid));
+    }
+  }
+  CHECK_EQ(vm->GetTotalNodesNum(), total);
+}
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    printf("usage: ./vertex_map_build_test <ipc_socket>\n");
+    return 1;
+  }
+  std::string ipc_socket = std::string(argv[1]);
+
+  vineyard::Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+
+  LOG(INFO) << "Connected to IPCServer: " << ipc_socket;
+
+  ObjectID vm_id = InvalidObjectID();
+  {
+    BasicArrowVertexMapBuilder<int64_t, uint64_t> vm_builder(
+        client, kFnum, kLabelNum, MakeOidArrays(0, kLabelNum));
+    vm_id = vm_builder.Seal(client)->id();
+  }
+  auto vm = std::dynamic_pointer_cast<VertexMapType>(client.GetObject(vm_id));
+  CHECK(vm != nullptr);
+  CheckVertexMap(vm, kLabelNum);
+  LOG(INFO) << "Passed vertex map build test...";
+
+  // the hashmaps of the new labels are built in parallel as well
+  ObjectID new_vm_id = vm->AddNewVertexLabels(
+      client, MakeOidArrays(kLabelNum, kLabelNum + kExtraLabelNum));
+  CHECK(new_vm_id != InvalidObjectID());
+  auto new_vm =
+      std::dynamic_pointer_cast<VertexMapType>(client.GetObject(new_vm_id));
+  CHECK(new_vm != nullptr);
+  CheckVertexMap(new_vm, kLabelNum + kExtraLabelNum);
+  LOG(INFO) << "Passed vertex map add labels test...";
+
+  client.Disconnect();
+
+  return 0;
+}
@@ -0,0 +1,154 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <stdio.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "arrow/api.h"
+#include "glog/logging.h"
+
+#include "client/client.h"
+#include "graph/vertex_map/arrow_vertex_map.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+using oid_t = arrow::util::string_view;
+using VertexMapType = ArrowVertexMap<oid_t, uint64_t>;
+using label_id_t = property_graph_types::LABEL_ID_TYPE;
+
+constexpr fid_t kFnum = 4;
+constexpr label_id_t kLabelNum = 2;
+constexpr label_id_t kExtraLabelNum = 2;
+
+int64_t VertexNum(fid_t fid, label_id_t label) {
+  return 1000 + fid * 100 + label * 10;
+}
+
+std::string OidOf(fid_t fid, label_id_t label, int64_t index) {
+  return "vertex-" + std::to_string(label) + "-" + std::to_string(fid) + "-" +
+         std::to_string(index);
+}
+
+std::vector<std::vector<std::shared_ptr<arrow::LargeStringArray>>>
+MakeOidArrays(label_id_t label_begin, label_id_t label_end) {
+  std::vector<std::vector<std::shared_ptr<arrow::LargeStringArray>>>
+      oid_arrays(label_end - label_begin);
+  for (label_id_t label = label_begin; label < label_end; ++label) {
+    for (fid_t fid = 0; fid < kFnum; ++fid) {
+      arrow::LargeStringBuilder builder;
+      for (int64_t index = 0; index < VertexNum(fid, label); ++index) {
+        CHECK_ARROW_ERROR(builder.Append(OidOf(fid, label, index)));
+      }
+      std::shared_ptr<arrow::Array> array;
+      CHECK_ARROW_ERROR(builder.Finish(&array));
+      oid_arrays[label - label_begin].emplace_back(
+          std::dynamic_pointer_cast<arrow::LargeStringArray>(array));
+    }
+  }
+  return oid_arrays;
+}
+
+void CheckVertexMap(const std::shared_ptr<VertexMapType>& vm,
+                    label_id_t label_num) {
+  CHECK_EQ(vm->label_num(), label_num);
+  IdParser<uint64_t> id_parser;
+  id_parser.Init(kFnum, label_num);
+  for (fid_t fid = 0; fid < kFnum; ++fid) {
+    for (label_id_t label = 0; label < label_num; ++label) {
+      int64_t vnum = VertexNum(fid, label);
+      CHECK_EQ(vm->GetInnerVertexSize(fid, label),
+               static_cast<uint64_t>(vnum));
+      for (int64_t index = 0; index < vnum; ++index) {
+        std::string oid = OidOf(fid, label, index);
+        uint64_t gid = 0;
+        CHECK(vm->GetGid(fid, label, oid_t(oid), gid));
+        CHECK_EQ(gid, id_parser.GenerateId(fid, label, index));
+        oid_t fetched;
+        CHECK(vm->GetOid(gid, fetched));
+        CHECK_EQ(std::string(fetched.data(), fetched.size()), oid);
+      }
+      uint64_t gid = 0;
+      CHECK(!vm->GetGid(fid, label, oid_t(OidOf(fid, label, vnum)), gid));
+    }
+  }
+}
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    printf("usage: ./vertex_map_shared_test <ipc_socket>\n");
+    return 1;
+  }
+  std::string ipc_socket = std::string(argv[1]);
+
+  vineyard::Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+
+  LOG(INFO) << "Connected to IPCServer: " << ipc_socket;
+
+  ObjectID vm_id = InvalidObjectID();
+  {
+    BasicArrowVertexMapBuilder<oid_t, uint64_t> vm_builder(
+        client, kFnum, kLabelNum, MakeOidArrays(0, kLabelNum));
+    vm_id = vm_builder.Seal(client)->id();
+  }
+
+  ObjectID new_vm_id = InvalidObjectID();
+  {
+    auto vm =
+        std::dynamic_pointer_cast<VertexMapType>(client.GetObject(vm_id));
+    CheckVertexMap(vm, kLabelNum);
+
+    // the same vertex map constructed again shares the hashmaps
+    auto another =
+        std::dynamic_pointer_cast<VertexMapType>(client.GetObject(vm_id));
+    CheckVertexMap(another, kLabelNum);
+
+    // the new version shares the hashmaps of the unchanged labels
+    new_vm_id = vm->AddNewVertexLabels(
+        client, MakeOidArrays(kLabelNum, kLabelNum + kExtraLabelNum));
+    CHECK(new_vm_id != InvalidObjectID());
+    auto new_vm =
+        std::dynamic_pointer_cast<VertexMapType>(client.GetObject(new_vm_id));
+    CheckVertexMap(new_vm, kLabelNum + kExtraLabelNum);
+    CheckVertexMap(vm, kLabelNum);
+  }
+  LOG(INFO) << "Passed shared vertex map test...";
+
+  // the shared hashmaps own the oid arrays they refer to, thus the new
+  // version keeps working after the old one (that builds the hashmaps of
+  // the unchanged labels) being released
+  {
+    auto vm =
+        std::dynamic_pointer_cast<VertexMapType>(client.GetObject(vm_id));
+    auto new_vm =
+        std::dynamic_pointer_cast<VertexMapType>(client.GetObject(new_vm_id));
+    vm.reset();
+    CheckVertexMap(new_vm, kLabelNum + kExtraLabelNum);
+  }
+  VINEYARD_CHECK_OK(client.DelData(vm_id));
+  {
+    auto new_vm =
+        std::dynamic_pointer_cast<VertexMapType>(client.GetObject(new_vm_id));
+    CheckVertexMap(new_vm, kLabelNum + kExtraLabelNum);
+  }
+  LOG(INFO) << "Passed released vertex map test...";
+
+  client.Disconnect();
+
+  return 0;
+}
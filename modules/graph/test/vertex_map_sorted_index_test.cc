@@ -0,0 +1,187 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <algorithm>
+#include <limits>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "arrow/util/config.h"
+#include "glog/logging.h"
+
+#include "client/client.h"
+#include "graph/vertex_map/arrow_vertex_map.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+using oid_t = arrow::util::string_view;
+using vid_t = uint64_t;
+using VertexMapType = ArrowVertexMap<oid_t, vid_t>;
+
+constexpr int kLabelNum = 2;
+
+// unique among all fragments of a label, in no particular order, including
+// the empty string and strings sharing long prefixes
+std::string OidOf(fid_t fid, int label, int64_t index) {
+  if (fid == 0 && index == 0) {
+    return "";
+  }
+  uint64_t hash = (static_cast<uint64_t>(index) * 2654435761ULL) % 1000003;
+  return "label-" + std::to_string(label) + "/vertex-" + std::to_string(hash) +
+         "/" + std::to_string(fid) + "-" + std::to_string(index);
+}
+
+int64_t VertexNum(fid_t fid, int label) {
+  return 20000 + 3001 * fid + 777 * label;
+}
+
+// with the sorted index, the gids of oids (one by one and in batches) must
+// be the ones of their positions in the oid arrays, and the missing oids
+// must be reported as such, leaving their gids untouched.
+void TestSortedIndex(Client& client, fid_t fnum) {
+  std::vector<std::vector<std::shared_ptr<arrow::LargeStringArray>>> oid_lists(
+      kLabelNum, std::vector<std::shared_ptr<arrow::LargeStringArray>>(fnum));
+  for (int label = 0; label < kLabelNum; ++label) {
+    for (fid_t fid = 0; fid < fnum; ++fid) {
+      arrow::LargeStringBuilder builder;
+      for (int64_t index = 0; index < VertexNum(fid, label); ++index) {
+        CHECK(builder.Append(OidOf(fid, label, index)).ok());
+      }
+      std::shared_ptr<arrow::Array> array;
+      CHECK(builder.Finish(&array).ok());
+      oid_lists[label][fid] =
+          std::dynamic_pointer_cast<arrow::LargeStringArray>(array);
+    }
+  }
+  BasicArrowVertexMapBuilder<oid_t, vid_t> vm_builder(client, fnum, kLabelNum,
+                                                      oid_lists);
+  ObjectID vm_id = vm_builder.Seal(client)->id();
+  auto vm = std::dynamic_pointer_cast<VertexMapType>(client.GetObject(vm_id));
+  CHECK(vm != nullptr);
+
+  IdParser<vid_t> id_parser;
+  id_parser.Init(fnum, kLabelNum);
+  std::mt19937_64 rng(20211015);
+  for (int label = 0; label < kLabelNum; ++label) {
+    std::vector<std::string> strings;
+    std::vector<fid_t> fids;
+    std::vector<vid_t> expected_gids;
+    for (fid_t fid = 0; fid < fnum; ++fid) {
+      CHECK_EQ(vm->GetInnerVertexSize(fid, label),
+               static_cast<vid_t>(VertexNum(fid, label)));
+      for (int64_t index = 0; index < VertexNum(fid, label); ++index) {
+        std::string oid = OidOf(fid, label, index);
+        vid_t expected = id_parser.GenerateId(fid, label, index), gid;
+        CHECK(vm->GetGid(fid, label, oid_t(oid.data(), oid.size()), gid));
+        CHECK_EQ(gid, expected);
+        CHECK(vm->GetGid(label, oid_t(oid.data(), oid.size()), gid));
+        CHECK_EQ(gid, expected);
+        oid_t stored;
+        CHECK(vm->GetOid(expected, stored));
+        CHECK_EQ(std::string(stored.data(), stored.size()), oid);
+
+        strings.push_back(oid);
+        fids.push_back(fid);
+        expected_gids.push_back(expected);
+      }
+      // missing oids, before, among and after the existing ones
+      for (std::string oid : {std::string("\x01"), OidOf(fid, label, 1) + "!",
+                              std::string("\xff")}) {
+        vid_t gid;
+        CHECK(!vm->GetGid(fid, label, oid_t(oid.data(), oid.size()), gid));
+        strings.push_back(oid);
+        fids.push_back(fid);
+        expected_gids.push_back(std::numeric_limits<vid_t>::max());
+      }
+    }
+
+    // the batches are in random order, with duplicated oids
+    std::vector<size_t> order(strings.size());
+    for (size_t k = 0; k < order.size(); ++k) {
+      order[k] = k;
+    }
+    std::shuffle(order.begin(), order.end(), rng);
+    order.insert(order.end(), order.begin(), order.begin() + 100);
+
+    std::vector<oid_t> oids;
+    std::vector<fid_t> batch_fids;
+    size_t present = 0;
+    for (size_t k : order) {
+      oids.emplace_back(strings[k].data(), strings[k].size());
+      batch_fids.push_back(fids[k]);
+      present += expected_gids[k] != std::numeric_limits<vid_t>::max();
+    }
+    std::vector<vid_t> gids(oids.size(), std::numeric_limits<vid_t>::max());
+    CHECK_EQ(vm->GetGids(label, batch_fids.data(), oids.data(), oids.size(),
+                         gids.data()),
+             present);
+    for (size_t k = 0; k < order.size(); ++k) {
+      CHECK_EQ(gids[k], expected_gids[order[k]]);
+    }
+
+    // the oids of a single fragment
+    for (fid_t fid = 0; fid < fnum; ++fid) {
+      std::vector<oid_t> frag_oids;
+      std::vector<size_t> frag_order;
+      for (size_t k : order) {
+        if (fids[k] == fid) {
+          frag_oids.emplace_back(strings[k].data(), strings[k].size());
+          frag_order.push_back(k);
+        }
+      }
+      std::vector<vid_t> frag_gids(frag_oids.size(),
+                                   std::numeric_limits<vid_t>::max());
+      size_t found = vm->GetGids(fid, label, frag_oids.data(),
+                                 frag_oids.size(), frag_gids.data());
+      size_t expected_found = 0;
+      for (size_t k = 0; k < frag_order.size(); ++k) {
+        CHECK_EQ(frag_gids[k], expected_gids[frag_order[k]]);
+        expected_found +=
+            expected_gids[frag_order[k]] != std::numeric_limits<vid_t>::max();
+      }
+      CHECK_EQ(found, expected_found);
+    }
+  }
+  VINEYARD_CHECK_OK(client.DelData(vm_id, true));
+}
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    printf("usage: ./vertex_map_sorted_index_test <ipc_socket>\n");
+    return 1;
+  }
+  std::string ipc_socket = std::string(argv[1]);
+
+  // before any string vertex map is constructed
+  setenv("VINEYARD_STRING_VERTEX_MAP_INDEX", "sorted", 1);
+
+  vineyard::Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+
+  LOG(INFO) << "Connected to IPCServer: " << ipc_socket;
+
+  // a single fragment takes the batched path of fragments
+  TestSortedIndex(client, 1);
+  TestSortedIndex(client, 3);
+
+  LOG(INFO) << "Passed string vertex map with sorted index test...";
+
+  return 0;
+}
@@ -0,0 +1,165 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <algorithm>
+#include <atomic>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "glog/logging.h"
+
+#include "graph/utils/vertex_parallel.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+using vid_t = uint64_t;
+using vertex_t = grape::Vertex<vid_t>;
+
+constexpr vid_t kBegin = 1000, kEnd = 1000 + 100003;
+
+// a few heavy vertices, and many light ones
+uint64_t WeightOf(const vertex_t& v) {
+  return v.GetValue() % 1000 == 0 ? 100000 : v.GetValue() % 3;
+}
+
+void CheckVisited(std::vector<std::atomic<int>>& visited) {
+  for (auto& count : visited) {
+    CHECK_EQ(count.load(), 1);
+    count = 0;
+  }
+}
+
+void TestForEachVertex() {
+  grape::VertexRange<vid_t> range(kBegin, kEnd);
+  std::vector<std::atomic<int>> visited(kEnd - kBegin);
+  for (auto& count : visited) {
+    count = 0;
+  }
+  for (int concurrency : {0, 1, 4, 13}) {
+    ParallelForEachVertex(
+        range, [&](const vertex_t& v) { ++visited[v.GetValue() - kBegin]; },
+        concurrency);
+    CheckVisited(visited);
+    ParallelForEachVertex(
+        range, WeightOf,
+        [&](const vertex_t& v) { ++visited[v.GetValue() - kBegin]; },
+        concurrency);
+    CheckVisited(visited);
+  }
+
+  // empty and tiny ranges
+  for (vid_t end : {kBegin, kBegin + 1, kBegin + 100}) {
+    std::atomic<vid_t> count(0);
+    ParallelForEachVertex(grape::VertexRange<vid_t>(kBegin, end),
+                          [&](const vertex_t&) { ++count; });
+    CHECK_EQ(count.load(), end - kBegin);
+    count = 0;
+    ParallelForEachVertex(
+        grape::VertexRange<vid_t>(kBegin, end), WeightOf,
+        [&](const vertex_t&) { ++count; });
+    CHECK_EQ(count.load(), end - kBegin);
+  }
+}
+
+// the weighted chunks must cover the range in order, each holding no more
+// than its share of the weights plus a vertex
+void TestWeightedChunks() {
+  for (size_t concurrency : {1, 4, 13}) {
+    std::vector<std::pair<vid_t, vid_t>> chunks;
+    vertex_parallel::split_by_weight(grape::VertexRange<vid_t>(kBegin, kEnd),
+                                     WeightOf, concurrency, chunks);
+    CHECK(!chunks.empty());
+    CHECK_LE(chunks.size(), concurrency * vertex_parallel::kChunksPerThread);
+    uint64_t total = 0, max_weight = 0;
+    for (vid_t v = kBegin; v < kEnd; ++v) {
+      total += WeightOf(vertex_t(v));
+      max_weight = std::max(max_weight, WeightOf(vertex_t(v)));
+    }
+    vid_t expected_begin = kBegin;
+    for (auto const& chunk : chunks) {
+      CHECK_EQ(chunk.first, expected_begin);
+      CHECK_LT(chunk.first, chunk.second);
+      uint64_t weight = 0;
+      for (vid_t v = chunk.first; v < chunk.second; ++v) {
+        weight += WeightOf(vertex_t(v));
+      }
+      CHECK_LE(weight, total / chunks.size() + 1 + max_weight);
+      expected_begin = chunk.second;
+    }
+    CHECK_EQ(expected_begin, kEnd);
+  }
+
+  // all weights are zero
+  std::vector<std::pair<vid_t, vid_t>> chunks;
+  vertex_parallel::split_by_weight(
+      grape::VertexRange<vid_t>(kBegin, kEnd),
+      [](const vertex_t&) { return 0; }, 4, chunks);
+  CHECK_EQ(chunks.front().first, kBegin);
+  CHECK_EQ(chunks.back().second, kEnd);
+  for (size_t k = 1; k < chunks.size(); ++k) {
+    CHECK_EQ(chunks[k - 1].second, chunks[k].first);
+  }
+}
+
+// the locals are combined in the order of vertices, even if the reduction
+// is not commutative
+void TestReduceVertices() {
+  grape::VertexRange<vid_t> range(kBegin, kEnd);
+  for (int concurrency : {0, 1, 4, 13}) {
+    auto sum = ParallelReduceVertices(
+        range, static_cast<uint64_t>(0),
+        [](uint64_t& local, const vertex_t& v) { local += v.GetValue(); },
+        [](uint64_t& result, const uint64_t& local) { result += local; },
+        concurrency);
+    CHECK_EQ(sum, (kBegin + kEnd - 1) * (kEnd - kBegin) / 2);
+
+    auto vids = ParallelReduceVertices(
+        range, std::vector<vid_t>(),
+        [](std::vector<vid_t>& local, const vertex_t& v) {
+          local.push_back(v.GetValue());
+        },
+        [](std::vector<vid_t>& result, const std::vector<vid_t>& local) {
+          result.insert(result.end(), local.begin(), local.end());
+        },
+        concurrency);
+    CHECK_EQ(vids.size(), kEnd - kBegin);
+    for (size_t k = 0; k < vids.size(); ++k) {
+      CHECK_EQ(vids[k], kBegin + k);
+    }
+  }
+
+  auto empty = ParallelReduceVertices(
+      grape::VertexRange<vid_t>(kBegin, kBegin), static_cast<uint64_t>(7),
+      [](uint64_t& local, const vertex_t& v) { local += v.GetValue(); },
+      [](uint64_t& result, const uint64_t& local) { result += local; });
+  CHECK_EQ(empty, static_cast<uint64_t>(7));
+}
+
+int main(int argc, char** argv) {
+  // before the default pool is created
+  setenv("VINEYARD_THREAD_POOL_SIZE", "4", 1);
+
+  TestForEachVertex();
+  TestWeightedChunks();
+  TestReduceVertices();
+
+  LOG(INFO) << "Passed vertex parallel test...";
+
+  return 0;
+}
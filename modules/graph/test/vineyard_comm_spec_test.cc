@@ -0,0 +1,175 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <stdio.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "arrow/api.h"
+#include "glog/logging.h"
+
+#include "basic/ds/arrow_utils.h"
+#include "graph/utils/partitioner.h"
+#include "graph/utils/table_shuffler.h"
+#include "graph/utils/vineyard_comm_spec.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+// a few more messages than the credits of a subscription, including empty
+// and large ones
+constexpr int kMessageNum = 12;
+
+int64_t MessageSize(int index) {
+  return index % 4 == 0 ? 0 : (int64_t(1) << (index + 8));
+}
+
+uint8_t MessageByte(int src, int dst, int index, int64_t offset) {
+  return static_cast<uint8_t>(src * 131 + dst * 17 + index * 7 + offset);
+}
+
+// the messages between every pair of workers must arrive complete and in
+// order, while all workers send and receive concurrently
+void TestMessages(VineyardCommSpec& comm_spec) {
+  int worker_id = comm_spec.worker_id();
+  int worker_num = comm_spec.worker_num();
+  std::thread sender([&]() {
+    for (int index = 0; index < kMessageNum; ++index) {
+      for (int dst = 0; dst < worker_num; ++dst) {
+        if (dst == worker_id) {
+          continue;
+        }
+        std::shared_ptr<arrow::Buffer> buffer;
+        int64_t size = MessageSize(index);
+        if (size > 0) {
+          std::string data(size, '\0');
+          for (int64_t offset = 0; offset < size; ++offset) {
+            data[offset] = MessageByte(worker_id, dst, index, offset);
+          }
+          buffer = arrow::Buffer::FromString(std::move(data));
+        }
+        VINEYARD_CHECK_OK(comm_spec.Send(dst, buffer));
+      }
+    }
+  });
+  for (int index = 0; index < kMessageNum; ++index) {
+    for (int src = 0; src < worker_num; ++src) {
+      if (src == worker_id) {
+        continue;
+      }
+      std::shared_ptr<arrow::Buffer> buffer;
+      VINEYARD_CHECK_OK(comm_spec.Recv(src, buffer));
+      CHECK_EQ(buffer->size(), MessageSize(index));
+      for (int64_t offset = 0; offset < buffer->size(); ++offset) {
+        CHECK_EQ(buffer->data()[offset],
+                 MessageByte(src, worker_id, index, offset));
+      }
+    }
+  }
+  sender.join();
+}
+
+int64_t KeyOf(int worker_id, int64_t index) {
+  return (static_cast<int64_t>(worker_id) << 32) + index;
+}
+
+int64_t RowNum(int worker_id) { return 10000 + 3001 * worker_id; }
+
+// the vertices must arrive at the fragments given by the partitioner, as
+// the shuffle over MPI does
+void TestShuffle(VineyardCommSpec& comm_spec) {
+  HashPartitioner<int64_t> partitioner;
+  partitioner.Init(comm_spec.fnum());
+
+  auto schema = arrow::schema({arrow::field("id", arrow::int64()),
+                               arrow::field("name", arrow::large_utf8())});
+  arrow::Int64Builder id_builder;
+  arrow::LargeStringBuilder name_builder;
+  for (int64_t index = 0; index < RowNum(comm_spec.worker_id()); ++index) {
+    int64_t key = KeyOf(comm_spec.worker_id(), index);
+    CHECK(id_builder.Append(key).ok());
+    CHECK(name_builder.Append("vertex-" + std::to_string(key)).ok());
+  }
+  std::vector<std::shared_ptr<arrow::Array>> columns(2);
+  CHECK(id_builder.Finish(&columns[0]).ok());
+  CHECK(name_builder.Finish(&columns[1]).ok());
+  auto table = arrow::Table::Make(schema, columns);
+
+  std::shared_ptr<arrow::Table> shuffled;
+  VINEYARD_CHECK_OK(
+      ShufflePropertyVertexTable(comm_spec, partitioner, table, shuffled));
+  CHECK(shuffled->schema()->Equals(*schema));
+
+  std::vector<int64_t> expected_keys, keys;
+  for (int worker_id = 0; worker_id < comm_spec.worker_num(); ++worker_id) {
+    for (int64_t index = 0; index < RowNum(worker_id); ++index) {
+      int64_t key = KeyOf(worker_id, index);
+      if (partitioner.GetPartitionId(key) == comm_spec.fid()) {
+        expected_keys.push_back(key);
+      }
+    }
+  }
+  std::vector<std::shared_ptr<arrow::RecordBatch>> batches;
+  VINEYARD_CHECK_OK(TableToRecordBatches(shuffled, &batches));
+  for (auto const& batch : batches) {
+    auto ids = std::dynamic_pointer_cast<arrow::Int64Array>(batch->column(0));
+    auto names =
+        std::dynamic_pointer_cast<arrow::LargeStringArray>(batch->column(1));
+    for (int64_t row = 0; row < batch->num_rows(); ++row) {
+      CHECK_EQ(names->GetString(row),
+               "vertex-" + std::to_string(ids->Value(row)));
+      keys.push_back(ids->Value(row));
+    }
+  }
+  std::sort(keys.begin(), keys.end());
+  CHECK(keys == expected_keys);
+}
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    printf("usage: ./vineyard_comm_spec_test <ipc_socket> [worker_num]\n");
+    return 1;
+  }
+  std::string ipc_socket = std::string(argv[1]);
+  int worker_num = argc > 2 ? atoi(argv[2]) : 4;
+  // unique among the concurrent runs on the same vineyard cluster
+  std::string session = "comm_spec_test_" + std::to_string(getpid());
+
+  // the workers are threads, each with its own connections
+  std::vector<std::thread> workers;
+  for (int worker_id = 0; worker_id < worker_num; ++worker_id) {
+    workers.emplace_back([&, worker_id]() {
+      VineyardCommSpec comm_spec(ipc_socket, session, worker_id, worker_num,
+                                 4);
+      VINEYARD_CHECK_OK(comm_spec.Init());
+      CHECK_EQ(comm_spec.local_num(), worker_num);
+      TestMessages(comm_spec);
+      TestShuffle(comm_spec);
+      VINEYARD_CHECK_OK(comm_spec.Finalize());
+    });
+  }
+  for (auto& worker : workers) {
+    worker.join();
+  }
+
+  LOG(INFO) << "Passed vineyard comm spec test...";
+
+  return 0;
+}
@@ -0,0 +1,123 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef MODULES_GRAPH_UTILS_LOAD_PROFILE_H_
+#define MODULES_GRAPH_UTILS_LOAD_PROFILE_H_
+
+#include <atomic>
+#include <chrono>
+#include <iomanip>
+#include <sstream>
+#include <string>
+
+namespace vineyard {
+
+/**
+ * @brief LoadProfile accumulates the time spent in each phase of loading a
+ * fragment, see also `ArrowFragmentLoader::set_profile`.
+ *
+ * The conversion of oids to gids overlaps with the shuffle of edges (in
+ * another thread), thus the sum of phases may exceed the wall time.
+ */
+class LoadProfile {
+ public:
+  enum Phase {
+    kRead,       // reading the vertex/edge tables from files or streams
+    kShuffle,    // shuffling the vertices and edges to their fragments
+    kVertexMap,  // building the vertex map
+    kOidToGid,   // translating the src/dst oids of edges to gids
+    kCSR,        // building the CSR and the property tables
+    kSeal,       // sealing and persisting the fragment
+    kPhases,
+  };
+
+  /**
+   * @brief Times the scope into the phase, no-op if the profile is nullptr.
+   */
+  class Timer {
+   public:
+    Timer(LoadProfile* profile, const Phase phase)
+        : profile_(profile),
+          phase_(phase),
+          start_(std::chrono::steady_clock::now()) {}
+
+    ~Timer() {
+      if (profile_ != nullptr) {
+        profile_->Add(phase_, std::chrono::duration<double>(
+                                  std::chrono::steady_clock::now() - start_)
+                                  .count());
+      }
+    }
+
+   private:
+    LoadProfile* profile_;
+    const Phase phase_;
+    const std::chrono::steady_clock::time_point start_;
+  };
+
+  LoadProfile() { Reset(); }
+
+  void Add(const Phase phase, const double seconds) {
+    int64_t nanoseconds = static_cast<int64_t>(seconds * 1e9);
+    durations_[phase].fetch_add(nanoseconds, std::memory_order_relaxed);
+  }
+
+  // in seconds
+  double Get(const Phase phase) const {
+    return durations_[phase].load(std::memory_order_relaxed) / 1e9;
+  }
+
+  void Reset() {
+    for (int phase = 0; phase < kPhases; ++phase) {
+      durations_[phase].store(0);
+    }
+  }
+
+  static const char* PhaseName(const Phase phase) {
+    switch (phase) {
+    case kRead:
+      return "read";
+    case kShuffle:
+      return "shuffle";
+    case kVertexMap:
+      return "vertex_map";
+    case kOidToGid:
+      return "oid2gid";
+    case kCSR:
+      return "csr";
+    case kSeal:
+      return "seal";
+    default:
+      return "unknown";
+    }
+  }
+
+  std::string ToString() const {
+    std::stringstream ss;
+    ss << std::fixed << std::setprecision(3);
+    for (int phase = 0; phase < kPhases; ++phase) {
+      ss << (phase == 0 ? "" : ", ") << PhaseName(static_cast<Phase>(phase))
+         << ": " << Get(static_cast<Phase>(phase)) << "s";
+    }
+    return ss.str();
+  }
+
+ private:
+  std::atomic<int64_t> durations_[kPhases];
+};
+
+}  // namespace vineyard
+
+#endif  // MODULES_GRAPH_UTILS_LOAD_PROFILE_H_
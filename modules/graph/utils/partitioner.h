@@ -16,20 +16,64 @@ limitations under the License.
 #ifndef MODULES_GRAPH_UTILS_PARTITIONER_H_
 #define MODULES_GRAPH_UTILS_PARTITIONER_H_
 
+#include <algorithm>
 #include <cstdint>
+#include <functional>
+#include <queue>
 #include <string>
 #include <utility>
 #include <vector>
 
+#include "arrow/api.h"
+
 #include "flat_hash_map/flat_hash_map.hpp"
 #if defined(EXPERIMENTAL_ON) || defined(NETWORKX)
 #include "folly/dynamic.h"
 #endif
 
+#include "basic/ds/arrow_utils.h"
 #include "graph/fragment/property_graph_types.h"
+#include "graph/utils/thread_pool.h"
 
 namespace vineyard {
 
+namespace detail {
+
+// hashes the string view in the same way as `std::hash<std::string>`, to
+// avoid materializing a `std::string`.
+inline size_t hash_string_view(const arrow::util::string_view& view) {
+#if defined(__GLIBCXX__)
+  return std::_Hash_impl::hash(view.data(), view.size());
+#else
+  return std::hash<std::string>()(std::string(view.data(), view.size()));
+#endif
+}
+
+// invokes `func(begin, end)` on disjoint ranges of [0, size) on at most
+// `concurrency` workers of the thread pool.
+template <typename FUNC_T>
+inline void for_each_range(int64_t size, int concurrency, const FUNC_T& func) {
+  // not worth spawning threads for small arrays
+  constexpr int64_t kMinRangeSize = 1 << 16;
+  int64_t range_num = std::min(static_cast<int64_t>(concurrency),
+                               (size + kMinRangeSize - 1) / kMinRangeSize);
+  if (range_num <= 1) {
+    func(0, size);
+    return;
+  }
+  int64_t range_size = (size + range_num - 1) / range_num;
+  TaskGroup tg;
+  for (int64_t begin = 0; begin < size; begin += range_size) {
+    tg.AddTask([&func, begin, size, range_size]() -> Status {
+      func(begin, std::min(size, begin + range_size));
+      return Status::OK();
+    });
+  }
+  tg.TakeResults();
+}
+
+}  // namespace detail
+
 // TODO(lxj): check if identical to the file in libgrape-lite
 template <typename OID_T>
 class HashPartitioner {
@@ -44,6 +88,23 @@ class HashPartitioner {
     return static_cast<fid_t>(static_cast<uint64_t>(oid) % fnum_);
   }
 
+  /**
+   * @brief Computes the partition ids of all elements of the array (of type
+   * `ConvertToArrowType<OID_T>::ArrayType`) into `out`.
+   */
+  void GetPartitionIds(const arrow::Array& array, fid_t* out,
+                       int concurrency = 1) const {
+    using array_t = typename ConvertToArrowType<OID_T>::ArrayType;
+    const OID_T* oids = dynamic_cast<const array_t&>(array).raw_values();
+    const uint64_t fnum = fnum_;
+    detail::for_each_range(
+        array.length(), concurrency, [&](int64_t begin, int64_t end) {
+          for (int64_t i = begin; i < end; ++i) {
+            out[i] = static_cast<fid_t>(static_cast<uint64_t>(oids[i]) % fnum);
+          }
+        });
+  }
+
   HashPartitioner& operator=(const HashPartitioner& other) {
     if (this == &other) {
       return *this;
@@ -80,6 +141,21 @@ class HashPartitioner<std::string> {
         static_cast<uint64_t>(std::hash<std::string>()(oid)) % fnum_);
   }
 
+  /**
+   * @brief Computes the partition ids of all elements of the (large) string
+   * array into `out`, the strings are hashed without being copied.
+   */
+  void GetPartitionIds(const arrow::Array& array, fid_t* out,
+                       int concurrency = 1) const {
+    if (array.type()->id() == arrow::Type::LARGE_STRING) {
+      getPartitionIds(dynamic_cast<const arrow::LargeStringArray&>(array), out,
+                      concurrency);
+    } else {
+      getPartitionIds(dynamic_cast<const arrow::StringArray&>(array), out,
+                      concurrency);
+    }
+  }
+
   HashPartitioner& operator=(const HashPartitioner& other) {
     if (this == &other) {
       return *this;
@@ -99,6 +175,21 @@ class HashPartitioner<std::string> {
   }
 
  private:
+  template <typename ARRAY_T>
+  void getPartitionIds(const ARRAY_T& array, fid_t* out,
+                       int concurrency) const {
+    const uint64_t fnum = fnum_;
+    detail::for_each_range(
+        array.length(), concurrency, [&](int64_t begin, int64_t end) {
+          for (int64_t i = begin; i < end; ++i) {
+            out[i] = static_cast<fid_t>(
+                static_cast<uint64_t>(
+                    detail::hash_string_view(array.GetView(i))) %
+                fnum);
+          }
+        });
+  }
+
   fid_t fnum_;
 };
 
@@ -172,6 +263,22 @@ class SegmentedPartitioner {
 
   inline fid_t GetPartitionId(const OID_T& oid) const { return o2f_.at(oid); }
 
+  /**
+   * @brief Computes the partition ids of all elements of the array (of type
+   * `ConvertToArrowType<OID_T>::ArrayType`) into `out`.
+   */
+  void GetPartitionIds(const arrow::Array& array, fid_t* out,
+                       int concurrency = 1) const {
+    using array_t = typename ConvertToArrowType<OID_T>::ArrayType;
+    const array_t& oids = dynamic_cast<const array_t&>(array);
+    detail::for_each_range(
+        array.length(), concurrency, [&](int64_t begin, int64_t end) {
+          for (int64_t i = begin; i < end; ++i) {
+            out[i] = o2f_.at(OID_T(oids.GetView(i)));
+          }
+        });
+  }
+
   SegmentedPartitioner& operator=(const SegmentedPartitioner& other) {
     if (this == &other) {
       return *this;
@@ -195,6 +302,135 @@ class SegmentedPartitioner {
   ska::flat_hash_map<OID_T, fid_t> o2f_;
 };
 
+/**
+ * @brief DegreeBalancedPartitioner balances the number of edges, rather than
+ * the number of vertices, across fragments, as on power-law graphs a few hot
+ * vertices carry most of the edges.
+ *
+ * Every vertex weights `degree + 1`. The hot vertices, i.e., whose degree
+ * exceeds `hot_factor` times the average degree, are placed first onto the
+ * least loaded fragment in descending order of degrees, then the remaining
+ * vertices fill up the fragments in the order of `oid_list`, to keep the
+ * locality of the segmented partitioning.
+ */
+template <typename OID_T>
+class DegreeBalancedPartitioner {
+ public:
+  using oid_t = OID_T;
+
+  DegreeBalancedPartitioner() : fnum_(1) {}
+
+  void Init(fid_t fnum, const std::vector<OID_T>& oid_list,
+            const std::vector<int64_t>& degree_list, double hot_factor = 8.0) {
+    fnum_ = fnum;
+    size_t vnum = oid_list.size();
+    loads_.assign(fnum_, 0);
+    o2f_.reserve(vnum);
+
+    int64_t total_degree = 0;
+    for (auto degree : degree_list) {
+      total_degree += degree;
+    }
+    int64_t total_load = total_degree + static_cast<int64_t>(vnum);
+    int64_t capacity = (total_load + fnum_ - 1) / fnum_;
+    double hot_degree =
+        hot_factor * total_degree / std::max(vnum, static_cast<size_t>(1));
+
+    std::vector<size_t> hot_vertices;
+    for (size_t i = 0; i < vnum; ++i) {
+      if (degree_list[i] > hot_degree) {
+        hot_vertices.push_back(i);
+      }
+    }
+    std::sort(hot_vertices.begin(), hot_vertices.end(),
+              [&degree_list](size_t lhs, size_t rhs) {
+                return degree_list[lhs] > degree_list[rhs];
+              });
+    using load_t = std::pair<int64_t, fid_t>;
+    std::priority_queue<load_t, std::vector<load_t>, std::greater<load_t>>
+        least_loaded;
+    for (fid_t fid = 0; fid < fnum_; ++fid) {
+      least_loaded.emplace(0, fid);
+    }
+    for (auto i : hot_vertices) {
+      load_t load = least_loaded.top();
+      least_loaded.pop();
+      load.first += degree_list[i] + 1;
+      o2f_.emplace(oid_list[i], load.second);
+      loads_[load.second] = load.first;
+      least_loaded.push(load);
+    }
+
+    fid_t fid = 0;
+    for (size_t i = 0; i < vnum; ++i) {
+      if (degree_list[i] > hot_degree) {
+        continue;
+      }
+      int64_t weight = degree_list[i] + 1;
+      while (fid + 1 < fnum_ && loads_[fid] + weight > capacity) {
+        ++fid;
+      }
+      o2f_.emplace(oid_list[i], fid);
+      loads_[fid] += weight;
+    }
+  }
+
+  inline fid_t GetPartitionId(const OID_T& oid) const { return o2f_.at(oid); }
+
+  /**
+   * @brief Computes the partition ids of all elements of the array (of type
+   * `ConvertToArrowType<OID_T>::ArrayType`) into `out`.
+   */
+  void GetPartitionIds(const arrow::Array& array, fid_t* out,
+                       int concurrency = 1) const {
+    using array_t = typename ConvertToArrowType<OID_T>::ArrayType;
+    const array_t& oids = dynamic_cast<const array_t&>(array);
+    detail::for_each_range(
+        array.length(), concurrency, [&](int64_t begin, int64_t end) {
+          for (int64_t i = begin; i < end; ++i) {
+            out[i] = o2f_.at(OID_T(oids.GetView(i)));
+          }
+        });
+  }
+
+  /**
+   * @brief The expected load (i.e., the number of vertices plus the number of
+   * edges) of each fragment.
+   */
+  const std::vector<int64_t>& loads() const { return loads_; }
+
+ private:
+  fid_t fnum_;
+  std::vector<int64_t> loads_;
+  ska::flat_hash_map<OID_T, fid_t> o2f_;
+};
+
+/**
+ * @brief Partitions the elements of the array in one pass, the offsets of
+ * elements that belong to fragment `fid` are appended to `offset_lists[fid]`.
+ */
+template <typename PARTITIONER_T>
+void PartitionArray(const PARTITIONER_T& partitioner,
+                    const arrow::Array& array, fid_t fnum,
+                    std::vector<std::vector<int64_t>>& offset_lists,
+                    int concurrency = 1) {
+  int64_t length = array.length();
+  std::vector<fid_t> fids(length);
+  partitioner.GetPartitionIds(array, fids.data(), concurrency);
+
+  std::vector<int64_t> counts(fnum, 0);
+  for (int64_t i = 0; i < length; ++i) {
+    ++counts[fids[i]];
+  }
+  offset_lists.resize(fnum);
+  for (fid_t fid = 0; fid < fnum; ++fid) {
+    offset_lists[fid].reserve(offset_lists[fid].size() + counts[fid]);
+  }
+  for (int64_t i = 0; i < length; ++i) {
+    offset_lists[fids[i]].push_back(i);
+  }
+}
+
 }  // namespace vineyard
 
 #endif  // MODULES_GRAPH_UTILS_PARTITIONER_H_
@@ -25,6 +25,7 @@ limitations under the License.
 #include <utility>
 #include <vector>
 
+#include "arrow/api.h"
 #include "boost/functional/hash.hpp"
 #include "flat_hash_map/flat_hash_map.hpp"
 
@@ -134,25 +135,29 @@ struct RSBlock {
   uint64_t size;
 };
 
+/**
+ * @brief RSVector keeps strings in the layout of arrow's LargeStringArray,
+ * i.e., a contiguous data buffer and `size() + 1` offsets, thus can be
+ * converted from and to arrow arrays without copying every string, see also
+ * `ToArrowArray`.
+ */
 class RSVector {
  public:
-  RSVector() : count_(0) {}
-  RSVector(const RSVector& rhs) : buffer_(rhs.buffer_), count_(rhs.count_) {}
-  RSVector(RSVector&& rhs) {
-    buffer_.swap(rhs.buffer_);
-    count_ = rhs.count_;
-    rhs.count_ = 0;
-    rhs.buffer_.clear();
-  }
-  RSVector& operator=(RSVector&& other) {
-    buffer_.clear();
-    count_ = 0;
+  RSVector() : offsets_(1, 0) {}
+  RSVector(const RSVector& rhs) = default;
+  RSVector(RSVector&& rhs) noexcept : offsets_(1, 0) { swap(rhs); }
+  explicit RSVector(const arrow::LargeStringArray& array) : offsets_(1, 0) {
+    append(array);
+  }
+  RSVector& operator=(const RSVector& other) = default;
+  RSVector& operator=(RSVector&& other) noexcept {
+    clear();
     swap(other);
     return *this;
   }
   void swap(RSVector& other) noexcept {
     buffer_.swap(other.buffer_);
-    std::swap(count_, other.count_);
+    offsets_.swap(other.offsets_);
   }
   operator std::vector<std::string>() const {
     std::vector<std::string> ret;
@@ -162,97 +167,136 @@ class RSVector {
     }
     return ret;
   }
-  void emplace(const std::string& str) {
-    size_t old_size = buffer_.size();
-    size_t new_size = old_size + str.length() + 1;
-    buffer_.resize(new_size);
-    memcpy(&buffer_[old_size], str.data(), str.length());
-    buffer_[new_size - 1] = '\0';
-    ++count_;
-  }
-  void emplace(const RefString& rs) {
-    size_t old_size = buffer_.size();
-    size_t new_size = old_size + rs.len + 1;
-    buffer_.resize(new_size);
-    memcpy(&buffer_[old_size], rs.str, rs.len);
-    buffer_[new_size - 1] = '\0';
-    ++count_;
-  }
+  void emplace(const std::string& str) { append(str.data(), str.length()); }
+  void emplace(const RefString& rs) { append(rs.str, rs.len); }
   void emplace_back(const std::string& str) {
-    size_t old_size = buffer_.size();
-    size_t new_size = old_size + str.length() + 1;
-    buffer_.resize(new_size);
-    memcpy(&buffer_[old_size], str.data(), str.length());
-    buffer_[new_size - 1] = '\0';
-    ++count_;
-  }
-  void emplace_back(const RefString& rs) {
-    size_t old_size = buffer_.size();
-    size_t new_size = old_size + rs.len + 1;
-    buffer_.resize(new_size);
-    memcpy(&buffer_[old_size], rs.str, rs.len);
-    buffer_[new_size - 1] = '\0';
-    ++count_;
+    append(str.data(), str.length());
   }
+  void emplace_back(const RefString& rs) { append(rs.str, rs.len); }
   void append(const RSVector& rsv) {
+    int64_t base = offsets_.back();
     buffer_.insert(buffer_.end(), rsv.buffer_.begin(), rsv.buffer_.end());
-    count_ += rsv.count_;
+    offsets_.reserve(offsets_.size() + rsv.size());
+    for (size_t i = 1; i < rsv.offsets_.size(); ++i) {
+      offsets_.push_back(base + rsv.offsets_[i]);
+    }
+  }
+  // appends all strings in the array, the data is copied in one pass.
+  void append(const arrow::LargeStringArray& array) {
+    int64_t length = array.length();
+    if (length == 0) {
+      return;
+    }
+    const int64_t* offsets = array.raw_value_offsets();
+    const char* data = reinterpret_cast<const char*>(array.raw_data());
+    int64_t base = offsets_.back() - offsets[0];
+    buffer_.insert(buffer_.end(), data + offsets[0], data + offsets[length]);
+    offsets_.reserve(offsets_.size() + length);
+    for (int64_t i = 1; i <= length; ++i) {
+      offsets_.push_back(base + offsets[i]);
+    }
   }
   struct const_iterator {
     const_iterator() = default;
-    explicit const_iterator(const char* str, size_t len = 0)
-        : current(str, len) {}
+    const_iterator(const char* data, const int64_t* offset)
+        : data(data), offset(offset) {}
     ~const_iterator() = default;
     friend bool operator==(const const_iterator& lhs,
                            const const_iterator& rhs) {
-      return lhs.current.str == rhs.current.str;
+      return lhs.offset == rhs.offset;
     }
     friend bool operator!=(const const_iterator& lhs,
                            const const_iterator& rhs) {
-      return lhs.current.str != rhs.current.str;
+      return lhs.offset != rhs.offset;
     }
     const_iterator& operator++() {
-      current.str += (strlen(current.str) + 1);
+      ++offset;
       return *this;
     }
     const_iterator operator++(int) {
-      const_iterator copy(current.str);
+      const_iterator copy(data, offset);
       ++*this;
       return copy;
     }
     const RefString& operator*() const {
-      current.len = strlen(current.str);
+      current.str = data + offset[0];
+      current.len = static_cast<size_t>(offset[1] - offset[0]);
       return current;
     }
-    const RefString* operator->() const { return std::addressof(current); }
+    const RefString* operator->() const { return std::addressof(**this); }
+    const char* data = nullptr;
+    const int64_t* offset = nullptr;
     mutable RefString current;
   };
   const_iterator begin() const {
-    const char* str = buffer_.data();
-    return const_iterator(str);
+    return const_iterator(buffer_.data(), offsets_.data());
   }
   const_iterator end() const {
-    const char* str = buffer_.data() + static_cast<ptrdiff_t>(buffer_.size());
-    return const_iterator(str);
+    return const_iterator(buffer_.data(), offsets_.data() + size());
+  }
+  RefString operator[](size_t index) const {
+    int64_t begin = offsets_[index], end = offsets_[index + 1];
+    return RefString(buffer_.data() + begin, static_cast<size_t>(end - begin));
   }
   char* data() { return buffer_.data(); }
   const char* data() const { return buffer_.data(); }
+  int64_t* offsets() { return offsets_.data(); }
+  const int64_t* offsets() const { return offsets_.data(); }
   size_t size_in_bytes() const { return buffer_.size(); }
   size_t capacity() const { return buffer_.capacity(); }
-  size_t size() const { return count_; }
+  size_t size() const { return offsets_.size() - 1; }
   void clear() {
     buffer_.clear();
-    count_ = 0;
+    offsets_.resize(1);
+    offsets_[0] = 0;
   }
+  // resizes the buffers, the data and the `count + 1` offsets are expected to
+  // be filled by the caller.
   void resize(size_t size, size_t count = 0) {
     buffer_.resize(size);
-    count_ = count;
+    offsets_.resize(count + 1);
+  }
+  void reserve(size_t cap, size_t count = 0) {
+    buffer_.reserve(cap);
+    offsets_.reserve(count + 1);
+  }
+
+  /**
+   * @brief Hands over the buffers to an arrow LargeStringArray without
+   * copying, the RSVector becomes empty.
+   */
+  std::shared_ptr<arrow::LargeStringArray> ToArrowArray() {
+    int64_t length = static_cast<int64_t>(size());
+    auto data = std::make_shared<VectorBuffer<char>>(std::move(buffer_));
+    auto offsets =
+        std::make_shared<VectorBuffer<int64_t>>(std::move(offsets_));
+    clear();
+    return std::make_shared<arrow::LargeStringArray>(length, offsets, data);
   }
-  void reserve(size_t cap) { buffer_.reserve(cap); }
 
  private:
+  // an arrow buffer that owns a std::vector
+  template <typename T>
+  class VectorBuffer : public arrow::Buffer {
+   public:
+    explicit VectorBuffer(std::vector<T>&& vec)
+        : arrow::Buffer(nullptr, 0), vec_(std::move(vec)) {
+      data_ = reinterpret_cast<const uint8_t*>(vec_.data());
+      size_ = static_cast<int64_t>(vec_.size() * sizeof(T));
+      capacity_ = size_;
+    }
+
+   private:
+    std::vector<T> vec_;
+  };
+
+  void append(const char* str, size_t len) {
+    buffer_.insert(buffer_.end(), str, str + len);
+    offsets_.push_back(static_cast<int64_t>(buffer_.size()));
+  }
+
   std::vector<char> buffer_;
-  size_t count_;
+  std::vector<int64_t> offsets_;
 };
 
 class StringCollection {
@@ -18,6 +18,7 @@ limitations under the License.
 
 #include <mpi.h>
 
+#include <algorithm>
 #include <future>
 #include <memory>
 #include <string>
@@ -239,6 +240,60 @@ inline void SendArrowBuffer(const std::shared_ptr<arrow::Buffer>& buffer,
   }
 }
 
+/**
+ * @brief Send the concatenation of `buffers` without copying them into a
+ * contiguous buffer first, the receiver is the same as `SendArrowBuffer`'s,
+ * i.e., `RecvArrowBuffer`.
+ *
+ * The messages are split at the same boundaries as `send_buffer`, and each
+ * message gathers its pieces with an indexed datatype over the absolute
+ * addresses.
+ */
+inline void SendArrowBuffers(
+    const std::vector<std::shared_ptr<arrow::Buffer>>& buffers,
+    int dst_worker_id, MPI_Comm comm, int tag = 0) {
+  int64_t size = 0;
+  for (auto const& buffer : buffers) {
+    size += buffer->size();
+  }
+  MPI_Send(&size, 1, MPI_INT64_T, dst_worker_id, tag, comm);
+
+  std::vector<int> lengths;
+  std::vector<MPI_Aint> displacements;
+  int64_t pending = 0;
+  auto flush = [&]() {
+    MPI_Datatype message_type;
+    MPI_Type_create_hindexed(lengths.size(), lengths.data(),
+                             displacements.data(), MPI_CHAR, &message_type);
+    MPI_Type_commit(&message_type);
+    MPI_Send(MPI_BOTTOM, 1, message_type, dst_worker_id, tag, comm);
+    MPI_Type_free(&message_type);
+    lengths.clear();
+    displacements.clear();
+    pending = 0;
+  };
+  for (auto const& buffer : buffers) {
+    const uint8_t* ptr = buffer->data();
+    int64_t remaining = buffer->size();
+    while (remaining > 0) {
+      int64_t length = std::min<int64_t>(remaining, chunk_size - pending);
+      MPI_Aint address;
+      MPI_Get_address(const_cast<uint8_t*>(ptr), &address);
+      lengths.emplace_back(static_cast<int>(length));
+      displacements.emplace_back(address);
+      ptr += length;
+      remaining -= length;
+      pending += length;
+      if (pending == chunk_size) {
+        flush();
+      }
+    }
+  }
+  if (pending > 0) {
+    flush();
+  }
+}
+
 inline Status RecvArrowBuffer(std::shared_ptr<arrow::Buffer>& buffer,
                               int src_worker_id, MPI_Comm comm, int tag = 0) {
   int64_t size;
@@ -259,6 +314,31 @@ inline Status RecvArrowBuffer(std::shared_ptr<arrow::Buffer>& buffer,
   return Status::OK();
 }
 
+/**
+ * @brief The point-to-point transfers of the shuffles below, which are
+ * overloaded for other communicators than MPI, see also `VineyardCommSpec`.
+ */
+inline Status SendShuffleBuffer(const grape::CommSpec& comm_spec,
+                                const std::shared_ptr<arrow::Buffer>& buffer,
+                                int dst_worker_id) {
+  SendArrowBuffer(buffer, dst_worker_id, comm_spec.comm());
+  return Status::OK();
+}
+
+inline Status SendShuffleBuffers(
+    const grape::CommSpec& comm_spec,
+    const std::vector<std::shared_ptr<arrow::Buffer>>& buffers,
+    int dst_worker_id) {
+  SendArrowBuffers(buffers, dst_worker_id, comm_spec.comm());
+  return Status::OK();
+}
+
+inline Status RecvShuffleBuffer(const grape::CommSpec& comm_spec,
+                                std::shared_ptr<arrow::Buffer>& buffer,
+                                int src_worker_id) {
+  return RecvArrowBuffer(buffer, src_worker_id, comm_spec.comm());
+}
+
 template <typename T>
 inline Status send_numeric_array(
     const std::shared_ptr<typename ConvertToArrowType<T>::ArrayType>& array,
@@ -275,9 +355,9 @@ inline Status send_numeric_array<std::string>(
     MPI_Comm comm, int tag) {
   auto batch =
       ArrayToRecordBatch(std::dynamic_pointer_cast<arrow::Array>(array));
-  std::shared_ptr<arrow::Buffer> buffer;
-  RETURN_ON_ERROR(SerializeRecordBatches({batch}, &buffer));
-  SendArrowBuffer(buffer, dst_worker_id, comm, tag);
+  std::vector<std::shared_ptr<arrow::Buffer>> buffers;
+  RETURN_ON_ERROR(SerializeRecordBatchesToBuffers({batch}, &buffers));
+  SendArrowBuffers(buffers, dst_worker_id, comm, tag);
   return Status::OK();
 }
 
@@ -312,57 +392,111 @@ inline Status recv_numeric_array<std::string>(
   return Status::OK();
 }
 
+/**
+ * @brief Allgather the arrays of all workers with a ring, i.e., in the
+ * `i`-th step every worker forwards the array it received in the previous
+ * step (its own array in the first step) to the next worker, and receives
+ * the array of the `i`-th previous worker from the previous worker.
+ *
+ * Every worker talks to its two neighbors only, rather than to all workers
+ * at the same time, thus the traffic is spread evenly on the links and
+ * doesn't contend at the receivers at large scale.
+ */
 template <typename T>
 Status FragmentAllGatherArray(
     const grape::CommSpec& comm_spec,
     std::shared_ptr<typename ConvertToArrowType<T>::ArrayType> data_in,
     std::vector<std::shared_ptr<typename ConvertToArrowType<T>::ArrayType>>&
         data_out) {
+  using array_t = typename ConvertToArrowType<T>::ArrayType;
   int worker_id = comm_spec.worker_id();
   int worker_num = comm_spec.worker_num();
+  int next_worker_id = (worker_id + 1) % worker_num;
+  int prev_worker_id = (worker_id + worker_num - 1) % worker_num;
 
   data_out.resize(comm_spec.fnum());
-
-  auto send_procedure = [&]() {
-    int dst_worker_id = (worker_id + worker_num - 1) % worker_num;
-    while (dst_worker_id != worker_id) {
-      send_numeric_array<T>(data_in, dst_worker_id, comm_spec.comm());
-      dst_worker_id = (dst_worker_id + worker_num - 1) % worker_num;
+  data_out[comm_spec.fid()] = data_in;
+
+  std::shared_ptr<array_t> forwarding = data_in;
+  for (int step = 1; step < worker_num; ++step) {
+    std::shared_ptr<array_t> received;
+    ThreadGroup tg;
+    tg.AddTask([&]() {
+      return send_numeric_array<T>(forwarding, next_worker_id,
+                                   comm_spec.comm());
+    });
+    tg.AddTask([&]() {
+      return recv_numeric_array<T>(received, prev_worker_id,
+                                   comm_spec.comm());
+    });
+    auto results = tg.TakeResults();
+    for (auto& res : results) {
+      RETURN_ON_ERROR(res);
     }
-    return Status::OK();
-  };
-
-  auto recv_procedure = [&]() {
-    int src_worker_id = (worker_id + 1) % worker_num;
-    while (src_worker_id != worker_id) {
-      fid_t src_fid = comm_spec.WorkerToFrag(src_worker_id);
-      recv_numeric_array<T>(data_out[src_fid], src_worker_id, comm_spec.comm());
-      src_worker_id = (src_worker_id + 1) % worker_num;
-    }
-    data_out[comm_spec.fid()] = data_in;
-    return Status::OK();
-  };
-
-  ThreadGroup tg;
+    int src_worker_id = (worker_id + worker_num - step) % worker_num;
+    data_out[comm_spec.WorkerToFrag(src_worker_id)] = received;
+    forwarding = received;
+  }
+  return Status::OK();
+}
 
-  tg.AddTask(send_procedure);
-  tg.AddTask(recv_procedure);
-  auto results = tg.TakeResults();
+/**
+ * @brief Exchange the arrays between all pairs of workers, `data_in[fid]` is
+ * sent to the worker of fragment `fid`, and `data_out[fid]` is received from
+ * the worker of fragment `fid` (the entry of the local fragment is passed
+ * through).
+ *
+ * In the `i`-th step every worker sends to the `i`-th next worker and
+ * receives from the `i`-th previous worker, thus every worker talks to a
+ * single peer at a time.
+ */
+template <typename T>
+Status FragmentAllToAllArray(
+    const grape::CommSpec& comm_spec,
+    const std::vector<
+        std::shared_ptr<typename ConvertToArrowType<T>::ArrayType>>& data_in,
+    std::vector<std::shared_ptr<typename ConvertToArrowType<T>::ArrayType>>&
+        data_out) {
+  using array_t = typename ConvertToArrowType<T>::ArrayType;
+  int worker_id = comm_spec.worker_id();
+  int worker_num = comm_spec.worker_num();
+  RETURN_ON_ASSERT(data_in.size() == comm_spec.fnum(),
+                   "The arrays to send don't match the fragments");
 
-  for (auto& res : results) {
-    RETURN_ON_ERROR(res);
+  data_out.resize(comm_spec.fnum());
+  data_out[comm_spec.fid()] = data_in[comm_spec.fid()];
+
+  for (int step = 1; step < worker_num; ++step) {
+    int dst_worker_id = (worker_id + step) % worker_num;
+    int src_worker_id = (worker_id + worker_num - step) % worker_num;
+    std::shared_ptr<array_t> received;
+    ThreadGroup tg;
+    tg.AddTask([&]() {
+      return send_numeric_array<T>(
+          data_in[comm_spec.WorkerToFrag(dst_worker_id)], dst_worker_id,
+          comm_spec.comm());
+    });
+    tg.AddTask([&]() {
+      return recv_numeric_array<T>(received, src_worker_id, comm_spec.comm());
+    });
+    auto results = tg.TakeResults();
+    for (auto& res : results) {
+      RETURN_ON_ERROR(res);
+    }
+    data_out[comm_spec.WorkerToFrag(src_worker_id)] = received;
   }
   return Status::OK();
 }
 
-template <typename PARTITIONER_T>
-Status ShufflePropertyVertexTable(const grape::CommSpec& comm_spec,
+/**
+ * @brief Shuffle the vertex table to the fragments of the vertices, the
+ * communicator is either a `grape::CommSpec` (MPI), or a `VineyardCommSpec`.
+ */
+template <typename PARTITIONER_T, typename COMM_SPEC_T = grape::CommSpec>
+Status ShufflePropertyVertexTable(const COMM_SPEC_T& comm_spec,
                                   const PARTITIONER_T& partitioner,
                                   const std::shared_ptr<arrow::Table>& table_in,
                                   std::shared_ptr<arrow::Table>& table_out) {
-  using oid_t = typename PARTITIONER_T::oid_t;
-  using internal_oid_t = typename InternalType<oid_t>::type;
-  using oid_array_type = typename ConvertToArrowType<oid_t>::ArrayType;
   auto fnum = comm_spec.fnum();
   std::vector<std::unique_ptr<arrow::RecordBatchBuilder>>
       divided_table_builders;
@@ -383,11 +517,11 @@ Status ShufflePropertyVertexTable(const grape::CommSpec& comm_spec,
     if (batch == nullptr) {
       break;
     }
-    auto id_col = std::dynamic_pointer_cast<oid_array_type>(batch->column(0));
     size_t row_num = batch->num_rows();
+    std::vector<fid_t> fids(row_num);
+    partitioner.GetPartitionIds(*batch->column(0), fids.data());
     for (size_t i = 0; i < row_num; ++i) {
-      internal_oid_t rs = id_col->GetView(i);
-      fid_t fid = partitioner.GetPartitionId(oid_t(rs));
+      fid_t fid = fids[i];
       RETURN_ON_ERROR(appender.Apply(divided_table_builders[fid], batch, i,
                                      divided_records[fid]));
     }
@@ -407,11 +541,11 @@ Status ShufflePropertyVertexTable(const grape::CommSpec& comm_spec,
     int dst_worker_id = (worker_id + worker_num - 1) % worker_num;
     while (dst_worker_id != worker_id) {
       fid_t dst_fid = comm_spec.WorkerToFrag(dst_worker_id);
-      std::shared_ptr<arrow::Buffer> buffer;
+      std::vector<std::shared_ptr<arrow::Buffer>> buffers;
       std::vector<std::shared_ptr<arrow::RecordBatch>> batches =
           std::move(divided_records[dst_fid]);
-      RETURN_ON_ERROR(SerializeRecordBatches(batches, &buffer));
-      SendArrowBuffer(buffer, dst_worker_id, comm_spec.comm());
+      RETURN_ON_ERROR(SerializeRecordBatchesToBuffers(batches, &buffers));
+      RETURN_ON_ERROR(SendShuffleBuffers(comm_spec, buffers, dst_worker_id));
       dst_worker_id = (dst_worker_id + worker_num - 1) % worker_num;
     }
     return Status::OK();
@@ -421,7 +555,7 @@ Status ShufflePropertyVertexTable(const grape::CommSpec& comm_spec,
     int src_worker_id = (worker_id + 1) % worker_num;
     while (src_worker_id != worker_id) {
       std::shared_ptr<arrow::Buffer> buffer;
-      RETURN_ON_ERROR(RecvArrowBuffer(buffer, src_worker_id, comm_spec.comm()));
+      RETURN_ON_ERROR(RecvShuffleBuffer(comm_spec, buffer, src_worker_id));
       std::vector<std::shared_ptr<arrow::RecordBatch>> batches;
       RETURN_ON_ERROR(DeserializeRecordBatches(buffer, &batches));
       for (const auto& batch : batches) {
@@ -469,8 +603,12 @@ Status ShufflePropertyVertexTable(const grape::CommSpec& comm_spec,
   return Status::OK();
 }
 
-template <typename VID_TYPE>
-Status ShufflePropertyEdgeTable(const grape::CommSpec& comm_spec,
+/**
+ * @brief Shuffle the edge table to the fragments of the source and
+ * destination vertices, see also `ShufflePropertyVertexTable`.
+ */
+template <typename VID_TYPE, typename COMM_SPEC_T = grape::CommSpec>
+Status ShufflePropertyEdgeTable(const COMM_SPEC_T& comm_spec,
                                 IdParser<VID_TYPE>& id_parser, int src_col_id,
                                 int dst_col_id,
                                 const std::shared_ptr<arrow::Table>& table_in,
@@ -542,18 +680,14 @@ Status ShufflePropertyEdgeTable(const grape::CommSpec& comm_spec,
     int dst_worker_id = (worker_id + worker_num - 1) % worker_num;
     while (dst_worker_id != worker_id) {
       fid_t dst_fid = comm_spec.WorkerToFrag(dst_worker_id);
-      std::shared_ptr<arrow::Buffer> buffer;
+      // empty buffers for empty batches
+      std::vector<std::shared_ptr<arrow::Buffer>> buffers;
       std::vector<std::shared_ptr<arrow::RecordBatch>> batches =
           std::move(divided_record_batches[dst_fid]);
-      if (batches.empty()) {
-        std::shared_ptr<arrow::io::BufferOutputStream> out_stream;
-        RETURN_ON_ARROW_ERROR_AND_ASSIGN(
-            out_stream, arrow::io::BufferOutputStream::Create(1024));
-        RETURN_ON_ARROW_ERROR_AND_ASSIGN(buffer, out_stream->Finish());
-      } else {
-        RETURN_ON_ERROR(SerializeRecordBatches(batches, &buffer));
+      if (!batches.empty()) {
+        RETURN_ON_ERROR(SerializeRecordBatchesToBuffers(batches, &buffers));
       }
-      SendArrowBuffer(buffer, dst_worker_id, comm_spec.comm());
+      RETURN_ON_ERROR(SendShuffleBuffers(comm_spec, buffers, dst_worker_id));
       dst_worker_id = (dst_worker_id + worker_num - 1) % worker_num;
     }
 
@@ -565,7 +699,7 @@ Status ShufflePropertyEdgeTable(const grape::CommSpec& comm_spec,
 
     while (src_worker_id != worker_id) {
       std::shared_ptr<arrow::Buffer> buffer;
-      RETURN_ON_ERROR(RecvArrowBuffer(buffer, src_worker_id, comm_spec.comm()));
+      RETURN_ON_ERROR(RecvShuffleBuffer(comm_spec, buffer, src_worker_id));
 
       if (buffer->size() > 0) {
         std::vector<std::shared_ptr<arrow::RecordBatch>> batches;
@@ -20,6 +20,7 @@ limitations under the License.
 
 #include <algorithm>
 #include <atomic>
+#include <deque>
 #include <memory>
 #include <thread>
 #include <utility>
@@ -28,6 +29,7 @@ limitations under the License.
 #include <boost/leaf/all.hpp>
 
 #include "arrow/buffer.h"
+#include "arrow/compute/api.h"
 #include "arrow/io/memory.h"
 #include "arrow/ipc/dictionary.h"
 #include "arrow/ipc/reader.h"
@@ -40,7 +42,9 @@ limitations under the License.
 #include "grape/worker/comm_spec.h"
 
 #include "basic/ds/arrow_utils.h"
+#include "common/util/mpmc_queue.h"
 #include "graph/utils/error.h"
+#include "graph/utils/partitioner.h"
 
 namespace grape {
 
@@ -199,6 +203,12 @@ void serialize_string_items(grape::InArchive& arc,
                             std::shared_ptr<arrow::Array> array,
                             const std::vector<int64_t>& offset) {
   auto* ptr = std::dynamic_pointer_cast<arrow::LargeStringArray>(array).get();
+  // the total length goes first to let the receiver reserve the data buffer
+  int64_t total_length = 0;
+  for (auto x : offset) {
+    total_length += ptr->value_length(x);
+  }
+  arc << total_length;
   for (auto x : offset) {
     arc << ptr->GetView(x);
   }
@@ -285,10 +295,15 @@ inline void deserialize_selected_typed_items(grape::OutArchive& arc,
 inline void deserialize_string_items(grape::OutArchive& arc, int64_t num,
                                      arrow::ArrayBuilder* builder) {
   auto casted_builder = dynamic_cast<arrow::LargeStringBuilder*>(builder);
+  int64_t total_length;
+  arc >> total_length;
+  ARROW_CHECK_OK(casted_builder->Reserve(num));
+  ARROW_CHECK_OK(casted_builder->ReserveData(total_length));
   arrow::util::string_view val;
   for (int64_t i = 0; i != num; ++i) {
     arc >> val;
-    casted_builder->Append(val);
+    casted_builder->UnsafeAppend(reinterpret_cast<const uint8_t*>(val.data()),
+                                 static_cast<int64_t>(val.size()));
   }
 }
 
@@ -393,8 +408,16 @@ inline void select_string_items(std::shared_ptr<arrow::Array> array,
                                 arrow::ArrayBuilder* builder) {
   auto* ptr = std::dynamic_pointer_cast<arrow::LargeStringArray>(array).get();
   auto casted_builder = dynamic_cast<arrow::LargeStringBuilder*>(builder);
+  int64_t total_length = 0;
   for (auto x : offset) {
-    casted_builder->Append(ptr->GetView(x));
+    total_length += ptr->value_length(x);
+  }
+  ARROW_CHECK_OK(casted_builder->Reserve(offset.size()));
+  ARROW_CHECK_OK(casted_builder->ReserveData(total_length));
+  for (auto x : offset) {
+    auto view = ptr->GetView(x);
+    casted_builder->UnsafeAppend(reinterpret_cast<const uint8_t*>(view.data()),
+                                 static_cast<int64_t>(view.size()));
   }
 }
 
@@ -421,7 +444,7 @@ inline void select_list_items(std::shared_ptr<arrow::Array> array,
 }
 
 inline void SelectItems(std::shared_ptr<arrow::Array> array,
-                        const std::vector<int64_t> offset,
+                        const std::vector<int64_t>& offset,
                         arrow::ArrayBuilder* builder) {
   if (array->type()->Equals(arrow::float64())) {
     select_typed_items<double>(array, offset, builder);
@@ -460,6 +483,12 @@ inline void SelectRows(std::shared_ptr<arrow::RecordBatch> record_batch_in,
                        const std::vector<int64_t>& offset,
                        std::shared_ptr<arrow::RecordBatch>& record_batch_out) {
   int64_t row_num = offset.size();
+  // the offsets are ascending and distinct, selecting all rows means the
+  // batch can be handed over as is.
+  if (row_num == record_batch_in->num_rows()) {
+    record_batch_out = record_batch_in;
+    return;
+  }
   std::unique_ptr<arrow::RecordBatchBuilder> builder;
   ARROW_CHECK_OK(arrow::RecordBatchBuilder::Make(record_batch_in->schema(),
                                                  arrow::default_memory_pool(),
@@ -472,16 +501,126 @@ inline void SelectRows(std::shared_ptr<arrow::RecordBatch> record_batch_in,
   ARROW_CHECK_OK(builder->Flush(&record_batch_out));
 }
 
-void ShuffleTableByOffsetLists(
+/**
+ * @brief Gathers the selected rows of all columns using the (vectorized)
+ * `Take` kernel of arrow, the offsets are wrapped as indices without being
+ * copied.
+ */
+inline void TakeRows(const std::shared_ptr<arrow::RecordBatch>& record_batch_in,
+                     const std::vector<int64_t>& offset,
+                     std::shared_ptr<arrow::RecordBatch>& record_batch_out) {
+  int64_t row_num = offset.size();
+  if (row_num == record_batch_in->num_rows()) {
+    record_batch_out = record_batch_in;
+    return;
+  }
+  auto indices = std::make_shared<arrow::Int64Array>(
+      row_num, arrow::Buffer::Wrap(offset.data(), offset.size()));
+#if defined(ARROW_VERSION) && ARROW_VERSION < 1000000
+  arrow::compute::FunctionContext ctx;
+  ARROW_CHECK_OK(arrow::compute::Take(&ctx, *record_batch_in, *indices,
+                                      arrow::compute::TakeOptions(),
+                                      &record_batch_out));
+#else
+  arrow::Datum taken;
+  ARROW_CHECK_OK_AND_ASSIGN(taken,
+                            arrow::compute::Take(record_batch_in, indices));
+  record_batch_out = taken.record_batch();
+#endif
+}
+
+namespace detail {
+
+// dedicated tags for the shuffled record batches, to avoid being mixed up
+// with other point-to-point messages on the same communicator.
+constexpr int kShuffleSizeTag = 0x7f01;
+constexpr int kShufflePayloadTag = 0x7f02;
+
+// the count argument of MPI calls is an `int`, large payloads are split
+// into chunks.
+constexpr size_t kShuffleChunkSize = 1UL << 30;
+
+// the maximum bytes of serialized batches that are in flight (per worker),
+// the serialization will be blocked when it is exceeded.
+constexpr size_t kShuffleInflightBytes = 1UL << 30;
+
+struct shuffle_message_t {
+  std::shared_ptr<arrow::Buffer> buffer;
+  int64_t size = 0;
+  std::vector<MPI_Request> requests;
+};
+
+inline void PostShuffleMessage(shuffle_message_t& message, int dst_worker_id,
+                               MPI_Comm comm) {
+  message.size = message.buffer->size();
+  size_t size = static_cast<size_t>(message.size);
+  size_t chunk_num = (size + kShuffleChunkSize - 1) / kShuffleChunkSize;
+  message.requests.resize(1 + chunk_num);
+  MPI_Isend(&message.size, 1, MPI_INT64_T, dst_worker_id, kShuffleSizeTag,
+            comm, &message.requests[0]);
+  const uint8_t* data = message.buffer->data();
+  for (size_t chunk = 0; chunk < chunk_num; ++chunk) {
+    size_t offset = chunk * kShuffleChunkSize;
+    int count = static_cast<int>(std::min(kShuffleChunkSize, size - offset));
+    MPI_Isend(data + offset, count, MPI_UINT8_T, dst_worker_id,
+              kShufflePayloadTag, comm, &message.requests[1 + chunk]);
+  }
+}
+
+inline void RecvShuffleMessage(std::shared_ptr<arrow::Buffer>& buffer,
+                               MPI_Comm comm) {
+  MPI_Status status;
+  int64_t message_size = 0;
+  MPI_Recv(&message_size, 1, MPI_INT64_T, MPI_ANY_SOURCE, kShuffleSizeTag,
+           comm, &status);
+  size_t size = static_cast<size_t>(message_size);
+  size_t chunk_num = (size + kShuffleChunkSize - 1) / kShuffleChunkSize;
+#if defined(ARROW_VERSION) && ARROW_VERSION < 17000
+  ARROW_CHECK_OK(arrow::AllocateBuffer(arrow::default_memory_pool(),
+                                       message_size, &buffer));
+#else
+  ARROW_CHECK_OK_AND_ASSIGN(
+      buffer,
+      arrow::AllocateBuffer(message_size, arrow::default_memory_pool()));
+#endif
+  std::vector<MPI_Request> requests(chunk_num);
+  uint8_t* data = buffer->mutable_data();
+  for (size_t chunk = 0; chunk < chunk_num; ++chunk) {
+    size_t offset = chunk * kShuffleChunkSize;
+    int count = static_cast<int>(std::min(kShuffleChunkSize, size - offset));
+    MPI_Irecv(data + offset, count, MPI_UINT8_T, status.MPI_SOURCE,
+              kShufflePayloadTag, comm, &requests[chunk]);
+  }
+  MPI_Waitall(static_cast<int>(chunk_num), requests.data(),
+              MPI_STATUSES_IGNORE);
+}
+
+}  // namespace detail
+
+/**
+ * @brief Shuffle the record batches to all workers, where `partition(index,
+ * buffer)` returns the row offsets (per fragment) of the `index`-th batch,
+ * either a reference to precomputed lists or to the `buffer` it fills.
+ *
+ * The partitioning and serialization of a batch run in the serialize
+ * threads, thus overlap with the communication of previous batches. The rows
+ * for every fragment are gathered column by column (see `TakeRows`) and sent
+ * as arrow IPC buffers, which are wrapped as record batches on the receiver
+ * side without rebuilding the columns. Serialized batches are sent using
+ * non-blocking point-to-point messages, the bytes in flight are bounded by
+ * `detail::kShuffleInflightBytes`.
+ */
+template <typename PARTITION_FUNC_T>
+void ShuffleTableByPartition(
     std::shared_ptr<arrow::Schema> schema,
     std::vector<std::shared_ptr<arrow::RecordBatch>>& record_batches_out,
-    const std::vector<std::vector<std::vector<int64_t>>>& offset_lists,
+    const PARTITION_FUNC_T& partition,
     std::vector<std::shared_ptr<arrow::RecordBatch>>& record_batches_in,
     const grape::CommSpec& comm_spec) {
   int worker_id = comm_spec.worker_id();
   int worker_num = comm_spec.worker_num();
   size_t record_batches_out_num = record_batches_out.size();
-#if 1
+
   int thread_num =
       (std::thread::hardware_concurrency() + comm_spec.local_num() - 1) /
       comm_spec.local_num();
@@ -491,9 +630,12 @@ void ShuffleTableByOffsetLists(
   std::vector<std::thread> serialize_threads(serialize_thread_num);
   std::vector<std::thread> deserialize_threads(deserialize_thread_num);
 
-  grape::BlockingQueue<std::pair<grape::fid_t, grape::InArchive>> msg_out;
-  grape::BlockingQueue<grape::OutArchive> msg_in;
+  PCMPMCQueue<std::pair<grape::fid_t, std::shared_ptr<arrow::Buffer>>> msg_out;
+  PCMPMCQueue<std::shared_ptr<arrow::Buffer>> msg_in;
 
+  // bounds the serialized batches that wait for being sent or deserialized
+  msg_out.SetLimit(std::max(worker_num, 2 * serialize_thread_num));
+  msg_in.SetLimit(std::max(worker_num, 2 * deserialize_thread_num));
   msg_out.SetProducerNum(serialize_thread_num);
   msg_in.SetProducerNum(1);
 
@@ -505,46 +647,87 @@ void ShuffleTableByOffsetLists(
       total_record_batches - record_batches_to_send;
 
   std::thread send_thread([&]() {
-    std::pair<grape::fid_t, grape::InArchive> item;
+    std::deque<std::unique_ptr<detail::shuffle_message_t>> inflight;
+    size_t inflight_bytes = 0;
+    auto retire = [&]() {
+      auto& message = inflight.front();
+      MPI_Waitall(static_cast<int>(message->requests.size()),
+                  message->requests.data(), MPI_STATUSES_IGNORE);
+      inflight_bytes -= static_cast<size_t>(message->size);
+      inflight.pop_front();
+    };
+
+    std::pair<grape::fid_t, std::shared_ptr<arrow::Buffer>> item;
     while (msg_out.Get(item)) {
       int dst_worker_id = comm_spec.FragToWorker(item.first);
-      auto& arc = item.second;
-      grape::SendArchive(arc, dst_worker_id, comm_spec.comm());
+      std::unique_ptr<detail::shuffle_message_t> message(
+          new detail::shuffle_message_t());
+      message->buffer = std::move(item.second);
+      detail::PostShuffleMessage(*message, dst_worker_id, comm_spec.comm());
+      inflight_bytes += static_cast<size_t>(message->size);
+      inflight.emplace_back(std::move(message));
+
+      // releases the completed messages, and waits when there are too many
+      // bytes in flight.
+      while (!inflight.empty()) {
+        if (inflight_bytes > detail::kShuffleInflightBytes) {
+          retire();
+          continue;
+        }
+        auto& front = inflight.front();
+        int completed = 0;
+        MPI_Testall(static_cast<int>(front->requests.size()),
+                    front->requests.data(), &completed, MPI_STATUSES_IGNORE);
+        if (!completed) {
+          break;
+        }
+        retire();
+      }
+    }
+    while (!inflight.empty()) {
+      retire();
     }
   });
 
   std::thread recv_thread([&]() {
     int64_t remaining_msg_num = record_batches_to_recv;
     while (remaining_msg_num != 0) {
-      MPI_Status status;
-      MPI_Probe(MPI_ANY_SOURCE, MPI_ANY_TAG, comm_spec.comm(), &status);
-      grape::OutArchive arc;
-      grape::RecvArchive(arc, status.MPI_SOURCE, comm_spec.comm());
-      msg_in.Put(std::move(arc));
+      std::shared_ptr<arrow::Buffer> buffer;
+      detail::RecvShuffleMessage(buffer, comm_spec.comm());
+      msg_in.Put(std::move(buffer));
       --remaining_msg_num;
     }
     msg_in.DecProducerNum();
   });
 
+  // the rows that stay in this fragment
+  std::vector<std::shared_ptr<arrow::RecordBatch>> record_batches_local(
+      record_batches_out_num);
   std::atomic<size_t> cur_batch_out(0);
   for (int i = 0; i != serialize_thread_num; ++i) {
     serialize_threads[i] = std::thread([&]() {
+      std::vector<std::vector<int64_t>> buffer;
       while (true) {
         size_t got_batch = cur_batch_out.fetch_add(1);
         if (got_batch >= record_batches_out_num) {
           break;
         }
         auto cur_rb = record_batches_out[got_batch];
-        auto& cur_offset_lists = offset_lists[got_batch];
+        const std::vector<std::vector<int64_t>>& cur_offset_lists =
+            partition(got_batch, buffer);
 
         for (int i = 1; i != worker_num; ++i) {
           int dst_worker_id = (worker_id + i) % worker_num;
           grape::fid_t dst_fid = comm_spec.WorkerToFrag(dst_worker_id);
-          std::pair<grape::fid_t, grape::InArchive> item;
+          std::shared_ptr<arrow::RecordBatch> selected;
+          TakeRows(cur_rb, cur_offset_lists[dst_fid], selected);
+          std::pair<grape::fid_t, std::shared_ptr<arrow::Buffer>> item;
           item.first = dst_fid;
-          SerializeSelectedRows(item.second, cur_rb, cur_offset_lists[dst_fid]);
+          VINEYARD_CHECK_OK(SerializeRecordBatches({selected}, &item.second));
           msg_out.Put(std::move(item));
         }
+        TakeRows(cur_rb, cur_offset_lists[comm_spec.fid()],
+                 record_batches_local[got_batch]);
       }
       msg_out.DecProducerNum();
     });
@@ -554,10 +737,19 @@ void ShuffleTableByOffsetLists(
   record_batches_in.resize(record_batches_to_recv);
   for (int i = 0; i != deserialize_thread_num; ++i) {
     deserialize_threads[i] = std::thread([&]() {
-      grape::OutArchive arc;
-      while (msg_in.Get(arc)) {
+      std::shared_ptr<arrow::Buffer> buffer;
+      std::vector<std::shared_ptr<arrow::RecordBatch>> batches;
+      while (msg_in.Get(buffer)) {
         int64_t got_batch = cur_batch_in.fetch_add(1);
-        DeserializeSelectedRows(arc, schema, record_batches_in[got_batch]);
+        batches.clear();
+        // the columns refer to the received buffer
+        VINEYARD_CHECK_OK(DeserializeRecordBatches(buffer, &batches));
+        if (batches.size() == 1) {
+          record_batches_in[got_batch] = batches[0];
+        } else {
+          VINEYARD_CHECK_OK(
+              CombineRecordBatches(batches, &record_batches_in[got_batch]));
+        }
       }
     });
   }
@@ -571,55 +763,28 @@ void ShuffleTableByOffsetLists(
     thrd.join();
   }
 
-  for (size_t rb_i = 0; rb_i != record_batches_out_num; ++rb_i) {
-    std::shared_ptr<arrow::RecordBatch> rb;
-    SelectRows(record_batches_out[rb_i], offset_lists[rb_i][comm_spec.fid()],
-               rb);
+  for (auto& rb : record_batches_local) {
     record_batches_in.emplace_back(std::move(rb));
   }
-#else
-  std::thread send_thread([&]() {
-    for (int i = 1; i != worker_num; ++i) {
-      int dst_worker_id = (worker_id + worker_num - i) % worker_num;
-      grape::fid_t dst_fid = comm_spec.WorkerToFrag(dst_worker_id);
-      grape::InArchive arc;
-      arc << record_batches_out_num;
-      for (size_t rb_i = 0; rb_i != record_batches_out_num; ++rb_i) {
-        SerializeSelectedRows(arc, record_batches_out[rb_i],
-                              offset_lists[rb_i][dst_fid]);
-      }
-      grape::SendArchive(arc, dst_worker_id, comm_spec.comm());
-    }
-  });
-  std::thread recv_thread([&]() {
-    for (int i = 1; i != worker_num; ++i) {
-      int src_worker_id = (worker_id + i) % worker_num;
-      grape::OutArchive arc;
-      grape::RecvArchive(arc, src_worker_id, comm_spec.comm());
-      size_t rb_num;
-      arc >> rb_num;
-      for (size_t rb_i = 0; rb_i != rb_num; ++rb_i) {
-        std::shared_ptr<arrow::RecordBatch> rb;
-        DeserializeSelectedRows(arc, schema, rb);
-        record_batches_in.emplace_back(std::move(rb));
-      }
-    }
-
-    for (size_t rb_i = 0; rb_i != record_batches_out_num; ++rb_i) {
-      std::shared_ptr<arrow::RecordBatch> rb;
-      SelectRows(record_batches_out[rb_i], offset_lists[rb_i][comm_spec.fid()],
-                 rb);
-      record_batches_in.emplace_back(std::move(rb));
-    }
-  });
-
-  send_thread.join();
-  recv_thread.join();
-#endif
 
   MPI_Barrier(comm_spec.comm());
 }
 
+inline void ShuffleTableByOffsetLists(
+    std::shared_ptr<arrow::Schema> schema,
+    std::vector<std::shared_ptr<arrow::RecordBatch>>& record_batches_out,
+    const std::vector<std::vector<std::vector<int64_t>>>& offset_lists,
+    std::vector<std::shared_ptr<arrow::RecordBatch>>& record_batches_in,
+    const grape::CommSpec& comm_spec) {
+  ShuffleTableByPartition(
+      schema, record_batches_out,
+      [&offset_lists](size_t index, std::vector<std::vector<int64_t>>&)
+          -> const std::vector<std::vector<int64_t>>& {
+        return offset_lists[index];
+      },
+      record_batches_in, comm_spec);
+}
+
 template <typename VID_TYPE>
 boost::leaf::result<std::shared_ptr<arrow::Table>> ShufflePropertyEdgeTable(
     const grape::CommSpec& comm_spec, IdParser<VID_TYPE>& id_parser,
@@ -629,63 +794,45 @@ boost::leaf::result<std::shared_ptr<arrow::Table>> ShufflePropertyEdgeTable(
   std::vector<std::shared_ptr<arrow::RecordBatch>> record_batches;
   VY_OK_OR_RAISE(TableToRecordBatches(table_in, &record_batches));
 
-  size_t record_batch_num = record_batches.size();
-  // record_batch_num, fragment_num, row_ids
-  std::vector<std::vector<std::vector<int64_t>>> offset_lists(record_batch_num);
-
-  int thread_num =
-      (std::thread::hardware_concurrency() + comm_spec.local_num() - 1) /
-      comm_spec.local_num();
-  std::vector<std::thread> scan_threads(thread_num);
-  std::atomic<size_t> cur(0);
-
-  for (int i = 0; i < thread_num; ++i) {
-    scan_threads[i] = std::thread([&]() {
-      while (true) {
-        size_t got = cur.fetch_add(1);
-        if (got >= record_batch_num) {
-          break;
-        }
-
-        auto& offset_list = offset_lists[got];
-        offset_list.resize(comm_spec.fnum());
-        auto cur_batch = record_batches[got];
-        int64_t row_num = cur_batch->num_rows();
-
-        const VID_TYPE* src_col =
-            std::dynamic_pointer_cast<
-                typename ConvertToArrowType<VID_TYPE>::ArrayType>(
-                cur_batch->column(src_col_id))
-                ->raw_values();
-        const VID_TYPE* dst_col =
-            std::dynamic_pointer_cast<
-                typename ConvertToArrowType<VID_TYPE>::ArrayType>(
-                cur_batch->column(dst_col_id))
-                ->raw_values();
-
-        for (int64_t row_id = 0; row_id < row_num; ++row_id) {
-          VID_TYPE src_gid = src_col[row_id];
-          VID_TYPE dst_gid = dst_col[row_id];
-
-          grape::fid_t src_fid = id_parser.GetFid(src_gid);
-          grape::fid_t dst_fid = id_parser.GetFid(dst_gid);
-
-          offset_list[src_fid].push_back(row_id);
-          if (src_fid != dst_fid) {
-            offset_list[dst_fid].push_back(row_id);
-          }
-        }
+  // partitions the batch by the fragments of the endpoints
+  auto partition = [&](size_t index,
+                       std::vector<std::vector<int64_t>>& offset_list)
+      -> const std::vector<std::vector<int64_t>>& {
+    offset_list.clear();
+    offset_list.resize(comm_spec.fnum());
+    auto cur_batch = record_batches[index];
+    int64_t row_num = cur_batch->num_rows();
+
+    const VID_TYPE* src_col =
+        std::dynamic_pointer_cast<
+            typename ConvertToArrowType<VID_TYPE>::ArrayType>(
+            cur_batch->column(src_col_id))
+            ->raw_values();
+    const VID_TYPE* dst_col =
+        std::dynamic_pointer_cast<
+            typename ConvertToArrowType<VID_TYPE>::ArrayType>(
+            cur_batch->column(dst_col_id))
+            ->raw_values();
+
+    for (int64_t row_id = 0; row_id < row_num; ++row_id) {
+      VID_TYPE src_gid = src_col[row_id];
+      VID_TYPE dst_gid = dst_col[row_id];
+
+      grape::fid_t src_fid = id_parser.GetFid(src_gid);
+      grape::fid_t dst_fid = id_parser.GetFid(dst_gid);
+
+      offset_list[src_fid].push_back(row_id);
+      if (src_fid != dst_fid) {
+        offset_list[dst_fid].push_back(row_id);
       }
-    });
-  }
-  for (auto& thrd : scan_threads) {
-    thrd.join();
-  }
+    }
+    return offset_list;
+  };
 
   std::vector<std::shared_ptr<arrow::RecordBatch>> batches_in;
 
-  ShuffleTableByOffsetLists(table_in->schema(), record_batches, offset_lists,
-                            batches_in, comm_spec);
+  ShuffleTableByPartition(table_in->schema(), record_batches, partition,
+                          batches_in, comm_spec);
 
   batches_in.erase(std::remove_if(batches_in.begin(), batches_in.end(),
                                   [](std::shared_ptr<arrow::RecordBatch>& e) {
@@ -715,56 +862,25 @@ template <typename PARTITIONER_T>
 boost::leaf::result<std::shared_ptr<arrow::Table>> ShufflePropertyVertexTable(
     const grape::CommSpec& comm_spec, const PARTITIONER_T& partitioner,
     std::shared_ptr<arrow::Table>& table_in) {
-  using oid_t = typename PARTITIONER_T::oid_t;
-  using internal_oid_t = typename InternalType<oid_t>::type;
-  using oid_array_type = typename ConvertToArrowType<oid_t>::ArrayType;
-
   BOOST_LEAF_CHECK(SchemaConsistent(*table_in->schema(), comm_spec));
 
   std::vector<std::shared_ptr<arrow::RecordBatch>> record_batches;
   VY_OK_OR_RAISE(TableToRecordBatches(table_in, &record_batches));
 
-  size_t record_batch_num = record_batches.size();
-  std::vector<std::vector<std::vector<int64_t>>> offset_lists(record_batch_num);
-
-  int thread_num =
-      (std::thread::hardware_concurrency() + comm_spec.local_num() - 1) /
-      comm_spec.local_num();
-  std::vector<std::thread> scan_threads(thread_num);
-  std::atomic<size_t> cur(0);
-
-  for (int i = 0; i < thread_num; ++i) {
-    scan_threads[i] = std::thread([&]() {
-      while (true) {
-        size_t got = cur.fetch_add(1);
-        if (got >= record_batch_num) {
-          break;
-        }
-
-        auto& offset_list = offset_lists[got];
-        offset_list.resize(comm_spec.fnum());
-        auto cur_batch = record_batches[got];
-        int64_t row_num = cur_batch->num_rows();
-
-        std::shared_ptr<oid_array_type> id_col =
-            std::dynamic_pointer_cast<oid_array_type>(cur_batch->column(0));
-
-        for (int64_t row_id = 0; row_id < row_num; ++row_id) {
-          internal_oid_t rs = id_col->GetView(row_id);
-          grape::fid_t fid = partitioner.GetPartitionId(oid_t(rs));
-          offset_list[fid].push_back(row_id);
-        }
-      }
-    });
-  }
-  for (auto& thrd : scan_threads) {
-    thrd.join();
-  }
+  // partitions the batch by the fragments of the vertices
+  auto partition = [&](size_t index,
+                       std::vector<std::vector<int64_t>>& offset_list)
+      -> const std::vector<std::vector<int64_t>>& {
+    offset_list.clear();
+    PartitionArray(partitioner, *record_batches[index]->column(0),
+                   comm_spec.fnum(), offset_list);
+    return offset_list;
+  };
 
   std::vector<std::shared_ptr<arrow::RecordBatch>> batches_in;
 
-  ShuffleTableByOffsetLists(table_in->schema(), record_batches, offset_lists,
-                            batches_in, comm_spec);
+  ShuffleTableByPartition(table_in->schema(), record_batches, partition,
+                          batches_in, comm_spec);
 
   batches_in.erase(std::remove_if(batches_in.begin(), batches_in.end(),
                                   [](std::shared_ptr<arrow::RecordBatch>& e) {
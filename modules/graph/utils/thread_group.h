@@ -15,6 +15,7 @@ limitations under the License.
 
 #ifndef MODULES_GRAPH_UTILS_THREAD_GROUP_H_
 #define MODULES_GRAPH_UTILS_THREAD_GROUP_H_
+#include <condition_variable>
 #include <future>
 #include <memory>
 #include <queue>
@@ -27,6 +28,11 @@ limitations under the License.
 #include "graph/utils/error.h"
 
 namespace vineyard {
+/**
+ * @brief ThreadGroup runs every task in a dedicated thread, for tasks that
+ * may block on each other (e.g., sending and receiving). Compute tasks
+ * should prefer the `TaskGroup` in "graph/utils/thread_pool.h".
+ */
 class ThreadGroup {
   using tid_t = uint32_t;
   using return_t = Status;
@@ -40,14 +46,14 @@ class ThreadGroup {
     if (stopped_) {
       throw std::runtime_error("ThreadGroup is stopped");
     }
-    while (getRunningThreadNum() >= parallelism_) {
-      std::lock_guard<std::mutex> lg(mutex_);
-
+    {
+      std::unique_lock<std::mutex> lk(mutex_);
+      finished_cv_.wait(lk,
+                        [this]() { return threads_.size() < parallelism_; });
       while (!finished_threads_.empty()) {
         finished_threads_.front().join();
         finished_threads_.pop();
       }
-      std::this_thread::yield();
     }
 
     auto task_wrapper = [this](tid_t tid, F_T&& _f,
@@ -60,10 +66,12 @@ class ThreadGroup {
         v = Status(StatusCode::kUnknownError, e.what());
       }
 
-      std::lock_guard<std::mutex> lg(mutex_);
-
-      finished_threads_.push(std::move(threads_.at(tid)));
-      threads_.erase(tid);
+      {
+        std::lock_guard<std::mutex> lg(mutex_);
+        finished_threads_.push(std::move(threads_.at(tid)));
+        threads_.erase(tid);
+      }
+      finished_cv_.notify_all();
       return v;
     };
 
@@ -80,11 +88,8 @@ class ThreadGroup {
 
   ~ThreadGroup() {
     stopped_ = true;
-    while (getRunningThreadNum() > 0) {
-      std::this_thread::yield();
-    }
-
-    std::lock_guard<std::mutex> lg(mutex_);
+    std::unique_lock<std::mutex> lk(mutex_);
+    finished_cv_.wait(lk, [this]() { return threads_.empty(); });
 
     while (!finished_threads_.empty()) {
       finished_threads_.front().join();
@@ -111,11 +116,6 @@ class ThreadGroup {
   }
 
  private:
-  size_t getRunningThreadNum() {
-    std::unique_lock<std::mutex> lk(mutex_);
-    return threads_.size();
-  }
-
   tid_t parallelism_;
   tid_t tid_;
   bool stopped_;
@@ -123,6 +123,7 @@ class ThreadGroup {
   std::unordered_map<tid_t, std::future<return_t>> tasks_;
   std::queue<std::thread> finished_threads_;
   std::mutex mutex_;
+  std::condition_variable finished_cv_;
 };
 }  // namespace vineyard
 #endif  // MODULES_GRAPH_UTILS_THREAD_GROUP_H_
@@ -0,0 +1,289 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+
+#ifndef MODULES_GRAPH_UTILS_THREAD_POOL_H_
+#define MODULES_GRAPH_UTILS_THREAD_POOL_H_
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "common/util/env.h"
+#include "common/util/status.h"
+
+namespace vineyard {
+
+/**
+ * @brief A persistent pool of worker threads. Every worker owns a task deque
+ * and takes tasks from its back, idle workers steal tasks from the front of
+ * the others' deques.
+ *
+ * Waiting for a task (see `Wait`) runs pending tasks of the pool instead of
+ * blocking, thus tasks can submit sub-tasks and wait for them. Tasks that
+ * block on each other in other ways (e.g., pairs of MPI send and receive)
+ * should use `ThreadGroup` instead.
+ */
+class ThreadPool {
+ public:
+  explicit ThreadPool(size_t thread_num = std::thread::hardware_concurrency(),
+                      bool pin_threads = false)
+      : queues_(std::max(thread_num, static_cast<size_t>(1))) {
+    for (auto& queue : queues_) {
+      queue.reset(new queue_t());
+    }
+    for (size_t index = 0; index < queues_.size(); ++index) {
+      workers_.emplace_back([this, index]() { this->run(index); });
+#if defined(__linux__)
+      if (pin_threads) {
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        CPU_SET(index % std::max(std::thread::hardware_concurrency(), 1U),
+                &cpus);
+        pthread_setaffinity_np(workers_.back().native_handle(),
+                               sizeof(cpu_set_t), &cpus);
+      }
+#endif
+    }
+  }
+
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+  ~ThreadPool() {
+    {
+      std::lock_guard<std::mutex> lock(idle_mutex_);
+      stopped_ = true;
+    }
+    idle_cv_.notify_all();
+    for (auto& worker : workers_) {
+      worker.join();
+    }
+  }
+
+  /**
+   * @brief The process-wide pool, the size can be specified by the
+   * environment variable `VINEYARD_THREAD_POOL_SIZE` and workers are pinned
+   * to cores when `VINEYARD_THREAD_POOL_PINNING` is set to "1".
+   */
+  static ThreadPool& Default() {
+    static ThreadPool pool(defaultThreadNum(),
+                           read_env("VINEYARD_THREAD_POOL_PINNING") == "1");
+    return pool;
+  }
+
+  size_t ThreadNum() const { return workers_.size(); }
+
+  template <class F_T, class... ARGS_T>
+  std::future<Status> Submit(F_T&& f, ARGS_T&&... args) {
+    auto fn = std::bind(std::forward<F_T>(f), std::forward<ARGS_T>(args)...);
+    auto task = std::make_shared<std::packaged_task<Status()>>(
+        [fn]() mutable -> Status {
+          try {
+            return fn();
+          } catch (std::exception& e) {
+            return Status(StatusCode::kUnknownError, e.what());
+          }
+        });
+    auto future = task->get_future();
+    push([task]() { (*task)(); });
+    return future;
+  }
+
+  /**
+   * @brief Waits for the task, pending tasks are executed in the current
+   * thread meanwhile.
+   */
+  Status Wait(std::future<Status>& future) {
+    task_t task;
+    while (future.wait_for(std::chrono::seconds(0)) !=
+           std::future_status::ready) {
+      if (pop(task)) {
+        task();
+      } else {
+        future.wait_for(std::chrono::microseconds(100));
+      }
+    }
+    return future.get();
+  }
+
+ private:
+  using task_t = std::function<void()>;
+
+  struct queue_t {
+    std::mutex mutex;
+    std::deque<task_t> tasks;
+  };
+
+  static size_t defaultThreadNum() {
+    std::string size = read_env("VINEYARD_THREAD_POOL_SIZE");
+    if (!size.empty()) {
+      return std::stoul(size);
+    }
+    return std::thread::hardware_concurrency();
+  }
+
+  // the index of the worker in this pool that runs the current thread, or
+  // the size of the pool for threads outside the pool.
+  size_t currentIndex() const {
+    if (current_pool() == this) {
+      return current_index();
+    }
+    return queues_.size();
+  }
+
+  static const ThreadPool*& current_pool() {
+    static thread_local const ThreadPool* pool = nullptr;
+    return pool;
+  }
+
+  static size_t& current_index() {
+    static thread_local size_t index = 0;
+    return index;
+  }
+
+  void push(task_t&& task) {
+    size_t index = currentIndex();
+    if (index == queues_.size()) {
+      index = next_queue_.fetch_add(1) % queues_.size();
+    }
+    {
+      std::lock_guard<std::mutex> lock(queues_[index]->mutex);
+      queues_[index]->tasks.emplace_back(std::move(task));
+    }
+    {
+      std::lock_guard<std::mutex> lock(idle_mutex_);
+      ++pending_;
+    }
+    idle_cv_.notify_one();
+  }
+
+  bool pop(task_t& task) {
+    if (pending_.load() == 0) {
+      return false;
+    }
+    size_t index = currentIndex();
+    if (index != queues_.size()) {
+      auto& queue = *queues_[index];
+      std::lock_guard<std::mutex> lock(queue.mutex);
+      if (!queue.tasks.empty()) {
+        task = std::move(queue.tasks.back());
+        queue.tasks.pop_back();
+        --pending_;
+        return true;
+      }
+    }
+    // steal from the others
+    for (size_t k = 1; k <= queues_.size(); ++k) {
+      auto& queue = *queues_[(index + k) % queues_.size()];
+      std::lock_guard<std::mutex> lock(queue.mutex);
+      if (!queue.tasks.empty()) {
+        task = std::move(queue.tasks.front());
+        queue.tasks.pop_front();
+        --pending_;
+        return true;
+      }
+    }
+    return false;
+  }
+
+  void run(size_t index) {
+    current_pool() = this;
+    current_index() = index;
+    task_t task;
+    while (true) {
+      if (pop(task)) {
+        task();
+        task = nullptr;
+        continue;
+      }
+      std::unique_lock<std::mutex> lock(idle_mutex_);
+      idle_cv_.wait(lock, [this]() { return stopped_ || pending_ > 0; });
+      if (stopped_ && pending_ == 0) {
+        break;
+      }
+    }
+  }
+
+  std::vector<std::unique_ptr<queue_t>> queues_;
+  std::vector<std::thread> workers_;
+  std::atomic<size_t> next_queue_{0};
+  std::atomic<size_t> pending_{0};
+  bool stopped_ = false;
+  std::mutex idle_mutex_;
+  std::condition_variable idle_cv_;
+};
+
+/**
+ * @brief A group of tasks that run on the `ThreadPool`, with the interface
+ * of `ThreadGroup`.
+ */
+class TaskGroup {
+  using tid_t = uint32_t;
+  using return_t = Status;
+
+ public:
+  explicit TaskGroup(ThreadPool& pool = ThreadPool::Default()) : pool_(pool) {}
+
+  ~TaskGroup() {
+    for (auto& task : tasks_) {
+      if (task.valid()) {
+        pool_.Wait(task);
+      }
+    }
+  }
+
+  template <class F_T, class... ARGS_T>
+  tid_t AddTask(F_T&& f, ARGS_T&&... args) {
+    tasks_.emplace_back(
+        pool_.Submit(std::forward<F_T>(f), std::forward<ARGS_T>(args)...));
+    return static_cast<tid_t>(tasks_.size() - 1);
+  }
+
+  return_t TaskResult(tid_t tid) { return pool_.Wait(tasks_[tid]); }
+
+  std::vector<return_t> TakeResults() {
+    std::vector<return_t> results;
+    for (auto& task : tasks_) {
+      results.push_back(pool_.Wait(task));
+    }
+    tasks_.clear();
+    return results;
+  }
+
+ private:
+  ThreadPool& pool_;
+  std::vector<std::future<return_t>> tasks_;
+};
+
+}  // namespace vineyard
+
+#endif  // MODULES_GRAPH_UTILS_THREAD_POOL_H_
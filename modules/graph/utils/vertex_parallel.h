@@ -0,0 +1,225 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+
+#ifndef MODULES_GRAPH_UTILS_VERTEX_PARALLEL_H_
+#define MODULES_GRAPH_UTILS_VERTEX_PARALLEL_H_
+
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "grape/utils/vertex_array.h"
+
+#include "graph/utils/thread_pool.h"
+
+namespace vineyard {
+
+/**
+ * @brief Parallel iteration over the vertex ranges of fragments (e.g.,
+ * `ArrowFragment::InnerVertices(label)`, or the ranges of
+ * `gs::ArrowProjectedFragment`), on the work-stealing `ThreadPool`.
+ *
+ * The range is split into many more chunks than threads, and idle workers
+ * steal the pending chunks, with the weighted variants the chunks carry
+ * roughly equal weights (e.g., the degrees), to balance the skewed vertices,
+ * e.g.,
+ *
+ *    ParallelForEachVertex(
+ *        frag.InnerVertices(v_label),
+ *        [&](const vertex_t& v) {
+ *          return frag.GetLocalOutDegree(v, e_label) + 1;
+ *        },
+ *        [&](const vertex_t& v) { ... });
+ *
+ *    size_t edges = ParallelReduceVertices(
+ *        frag.InnerVertices(v_label), static_cast<size_t>(0),
+ *        [&](size_t& local, const vertex_t& v) {
+ *          local += frag.GetLocalOutDegree(v, e_label);
+ *        },
+ *        [](size_t& sum, const size_t& local) { sum += local; });
+ */
+namespace vertex_parallel {
+
+// the number of chunks for each thread, as the units of stealing
+static constexpr size_t kChunksPerThread = 8;
+// chunks smaller than that don't pay for the scheduling
+static constexpr size_t kMinChunkSize = 64;
+
+// splits the range into chunks of (roughly) equal weights, `weights` is the
+// inclusive prefix sum of the weights of vertices.
+template <typename VID_T>
+void split_weighted(VID_T begin, std::vector<uint64_t> const& weights,
+                    size_t const chunk_num,
+                    std::vector<std::pair<VID_T, VID_T>>& chunks) {
+  size_t const size = weights.size();
+  uint64_t const total = size == 0 ? 0 : weights.back();
+  size_t offset = 0;
+  for (size_t chunk = 1; chunk <= chunk_num && offset < size; ++chunk) {
+    uint64_t target = (total * chunk + chunk_num - 1) / chunk_num;
+    size_t end = std::lower_bound(weights.begin() + offset, weights.end(),
+                                  target) -
+                 weights.begin() + 1;
+    end = std::min(std::max(end, offset + 1), size);
+    if (chunk == chunk_num) {
+      end = size;
+    }
+    chunks.emplace_back(begin + offset, begin + end);
+    offset = end;
+  }
+}
+
+template <typename VID_T, typename FUNC_T>
+void run_chunks(std::vector<std::pair<VID_T, VID_T>> const& chunks,
+                const FUNC_T& func) {
+  TaskGroup tg;
+  for (size_t index = 0; index < chunks.size(); ++index) {
+    tg.AddTask([&chunks, &func, index]() -> Status {
+      func(index, chunks[index].first, chunks[index].second);
+      return Status::OK();
+    });
+  }
+  tg.TakeResults();
+}
+
+template <typename VID_T>
+void split_even(VID_T begin, VID_T end, size_t const concurrency,
+                std::vector<std::pair<VID_T, VID_T>>& chunks) {
+  size_t const size = end - begin;
+  size_t chunk_size = std::max(
+      kMinChunkSize, (size + concurrency * kChunksPerThread - 1) /
+                         std::max(concurrency * kChunksPerThread,
+                                  static_cast<size_t>(1)));
+  for (size_t offset = 0; offset < size; offset += chunk_size) {
+    chunks.emplace_back(begin + offset,
+                        begin + std::min(size, offset + chunk_size));
+  }
+}
+
+template <typename VID_T, typename WEIGHT_FUNC_T>
+void split_by_weight(const grape::VertexRange<VID_T>& range,
+                     const WEIGHT_FUNC_T& weight, size_t const concurrency,
+                     std::vector<std::pair<VID_T, VID_T>>& chunks) {
+  VID_T begin = range.begin().GetValue(), end = range.end().GetValue();
+  size_t const size = end - begin;
+  std::vector<uint64_t> weights(size);
+  std::vector<std::pair<VID_T, VID_T>> blocks;
+  split_even(begin, end, concurrency, blocks);
+  // the weights of vertices, then the prefix sum with block offsets
+  std::vector<uint64_t> block_weights(blocks.size(), 0);
+  run_chunks(blocks, [&](size_t index, VID_T from, VID_T to) {
+    uint64_t sum = 0;
+    for (VID_T v = from; v < to; ++v) {
+      sum += static_cast<uint64_t>(weight(grape::Vertex<VID_T>(v)));
+      weights[v - begin] = sum;
+    }
+    block_weights[index] = sum;
+  });
+  uint64_t base = 0;
+  for (auto& block_weight : block_weights) {
+    uint64_t block_sum = block_weight;
+    block_weight = base;
+    base += block_sum;
+  }
+  run_chunks(blocks, [&](size_t index, VID_T from, VID_T to) {
+    for (VID_T v = from; v < to; ++v) {
+      weights[v - begin] += block_weights[index];
+    }
+  });
+  size_t chunk_num = std::min(
+      std::max(concurrency * kChunksPerThread, static_cast<size_t>(1)),
+      std::max(size / kMinChunkSize, static_cast<size_t>(1)));
+  split_weighted(begin, weights, chunk_num, chunks);
+}
+
+inline size_t concurrency_of(int concurrency) {
+  return concurrency > 0 ? static_cast<size_t>(concurrency)
+                         : ThreadPool::Default().ThreadNum();
+}
+
+}  // namespace vertex_parallel
+
+/**
+ * @brief Apply `func(v)` on every vertex of the range in parallel, with
+ * chunks of equal sizes.
+ */
+template <typename VID_T, typename FUNC_T>
+void ParallelForEachVertex(const grape::VertexRange<VID_T>& range,
+                           const FUNC_T& func, int concurrency = 0) {
+  std::vector<std::pair<VID_T, VID_T>> chunks;
+  vertex_parallel::split_even(range.begin().GetValue(),
+                              range.end().GetValue(),
+                              vertex_parallel::concurrency_of(concurrency),
+                              chunks);
+  vertex_parallel::run_chunks(chunks, [&func](size_t, VID_T from, VID_T to) {
+    for (VID_T v = from; v < to; ++v) {
+      func(grape::Vertex<VID_T>(v));
+    }
+  });
+}
+
+/**
+ * @brief Apply `func(v)` on every vertex of the range in parallel, with
+ * chunks of equal weights, where `weight(v)` is the (non-negative) cost of
+ * a vertex, e.g., its degree plus one.
+ */
+template <typename VID_T, typename WEIGHT_FUNC_T, typename FUNC_T>
+void ParallelForEachVertex(const grape::VertexRange<VID_T>& range,
+                           const WEIGHT_FUNC_T& weight, const FUNC_T& func,
+                           int concurrency = 0) {
+  std::vector<std::pair<VID_T, VID_T>> chunks;
+  vertex_parallel::split_by_weight(
+      range, weight, vertex_parallel::concurrency_of(concurrency), chunks);
+  vertex_parallel::run_chunks(chunks, [&func](size_t, VID_T from, VID_T to) {
+    for (VID_T v = from; v < to; ++v) {
+      func(grape::Vertex<VID_T>(v));
+    }
+  });
+}
+
+/**
+ * @brief Reduce the vertices of the range in parallel, every chunk folds its
+ * vertices into a local copy of `init` by `fold(local, v)`, and the locals
+ * are combined in the order of vertices by `combine(result, local)`, thus
+ * the result is deterministic even for non-commutative reductions.
+ */
+template <typename VID_T, typename T, typename FOLD_FUNC_T,
+          typename COMBINE_FUNC_T>
+T ParallelReduceVertices(const grape::VertexRange<VID_T>& range, const T& init,
+                         const FOLD_FUNC_T& fold,
+                         const COMBINE_FUNC_T& combine, int concurrency = 0) {
+  std::vector<std::pair<VID_T, VID_T>> chunks;
+  vertex_parallel::split_even(range.begin().GetValue(),
+                              range.end().GetValue(),
+                              vertex_parallel::concurrency_of(concurrency),
+                              chunks);
+  std::vector<T> locals(chunks.size(), init);
+  vertex_parallel::run_chunks(
+      chunks, [&fold, &locals](size_t index, VID_T from, VID_T to) {
+        for (VID_T v = from; v < to; ++v) {
+          fold(locals[index], grape::Vertex<VID_T>(v));
+        }
+      });
+  T result = init;
+  for (auto const& local : locals) {
+    combine(result, local);
+  }
+  return result;
+}
+
+}  // namespace vineyard
+
+#endif  // MODULES_GRAPH_UTILS_VERTEX_PARALLEL_H_
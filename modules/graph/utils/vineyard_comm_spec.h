@@ -0,0 +1,313 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+
+#ifndef MODULES_GRAPH_UTILS_VINEYARD_COMM_SPEC_H_
+#define MODULES_GRAPH_UTILS_VINEYARD_COMM_SPEC_H_
+
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "arrow/buffer.h"
+#include "arrow/memory_pool.h"
+#include "arrow/util/config.h"
+
+#include "basic/ds/arrow_utils.h"
+#include "basic/stream/byte_stream.h"
+#include "client/client.h"
+#include "client/ds/object_meta.h"
+#include "client/rpc_client.h"
+#include "common/util/status.h"
+#include "graph/fragment/property_graph_types.h"
+
+namespace vineyard {
+
+/**
+ * @brief A communicator among the loading workers that exchanges messages
+ * through vineyard streams between vineyard servers (over RPC), rather than
+ * MPI. It implements the subset of `grape::CommSpec` used by the shuffles
+ * in "graph/utils/table_shuffler.h", e.g.,
+ *
+ *    VineyardCommSpec comm_spec(ipc_socket, session, worker_id, worker_num);
+ *    VINEYARD_CHECK_OK(comm_spec.Init());
+ *    VINEYARD_CHECK_OK(ShufflePropertyVertexTable(comm_spec, partitioner,
+ *                                                 table_in, table_out));
+ *    VINEYARD_CHECK_OK(comm_spec.Finalize());
+ *
+ * Every (ordered) pair of workers has a dedicated stream, which is written
+ * to the vineyard server of the sender and subscribed by the receiver with a
+ * bounded window of credits, i.e., a sender is blocked once its receiver
+ * falls behind. The workers discover each other by the names registered in
+ * the metadata of the vineyard cluster under the given session, thus the
+ * session must be unique among the concurrent loads.
+ */
+class VineyardCommSpec {
+ public:
+  VineyardCommSpec(const std::string& ipc_socket, const std::string& session,
+                   int worker_id, int worker_num, size_t const credits = 8)
+      : ipc_socket_(ipc_socket),
+        session_(session),
+        worker_id_(worker_id),
+        worker_num_(worker_num),
+        credits_(credits) {}
+
+  ~VineyardCommSpec() {
+    if (initialized_) {
+      VINEYARD_DISCARD(Finalize());
+    }
+  }
+
+  VineyardCommSpec(const VineyardCommSpec&) = delete;
+  VineyardCommSpec& operator=(const VineyardCommSpec&) = delete;
+
+  /**
+   * @brief Creates the outgoing streams, registers this worker, and
+   * subscribes the incoming streams of all other workers, blocked until
+   * all of them have been registered.
+   */
+  Status Init() {
+    RETURN_ON_ASSERT(!initialized_, "The communicator has been initialized");
+    RETURN_ON_ASSERT(worker_id_ >= 0 && worker_id_ < worker_num_,
+                     "Invalid worker id");
+    RETURN_ON_ERROR(client_.Connect(ipc_socket_));
+
+    ObjectMeta meta;
+    meta.SetTypeName("vineyard::VineyardCommSpec");
+    meta.AddKeyValue("session", session_);
+    meta.AddKeyValue("worker_id", worker_id_);
+    meta.AddKeyValue("instance_id", client_.instance_id());
+    meta.AddKeyValue("rpc_endpoint", client_.RPCEndpoint());
+    writers_.resize(worker_num_);
+    for (int dst = 0; dst < worker_num_; ++dst) {
+      if (dst == worker_id_) {
+        continue;
+      }
+      ByteStreamBuilder builder(client_);
+      builder.SetParam("kind", "shuffle");
+      builder.SetParam("session", session_);
+      auto stream =
+          std::dynamic_pointer_cast<ByteStream>(builder.Seal(client_));
+      RETURN_ON_ASSERT(stream != nullptr, "Failed to create the stream");
+      RETURN_ON_ERROR(stream->OpenWriter(client_, writers_[dst]));
+      meta.AddKeyValue("stream_" + std::to_string(dst), stream->id());
+    }
+    RETURN_ON_ERROR(client_.CreateMetaData(meta, self_));
+    RETURN_ON_ERROR(client_.Persist(self_));
+    RETURN_ON_ERROR(client_.PutName(self_, registryName(worker_id_)));
+
+    local_num_ = 1;
+    readers_.resize(worker_num_);
+    pending_.resize(worker_num_);
+    for (int src = 0; src < worker_num_; ++src) {
+      if (src == worker_id_) {
+        continue;
+      }
+      ObjectID peer = InvalidObjectID();
+      ObjectMeta peer_meta;
+      RETURN_ON_ERROR(client_.GetName(registryName(src), peer, true));
+      RETURN_ON_ERROR(client_.GetMetaData(peer, peer_meta, true));
+      if (peer_meta.GetKeyValue<InstanceID>("instance_id") ==
+          client_.instance_id()) {
+        local_num_ += 1;
+      }
+      ObjectID stream_id = peer_meta.GetKeyValue<ObjectID>(
+          "stream_" + std::to_string(worker_id_));
+      readers_[src].reset(new RPCClient());
+      RETURN_ON_ERROR(readers_[src]->Connect(
+          peer_meta.GetKeyValue<std::string>("rpc_endpoint")));
+      RETURN_ON_ERROR(readers_[src]->SubscribeStream(stream_id, credits_));
+    }
+    initialized_ = true;
+    return Status::OK();
+  }
+
+  /**
+   * @brief Finishes the outgoing streams, and waits until the incoming
+   * streams are finished by their writers as well, i.e., all workers have
+   * passed `Init`, then the registration of this worker is dropped.
+   */
+  Status Finalize() {
+    if (!initialized_) {
+      return Status::OK();
+    }
+    initialized_ = false;
+    for (auto& writer : writers_) {
+      if (writer) {
+        RETURN_ON_ERROR(writer->Finish());
+      }
+    }
+    for (int src = 0; src < worker_num_; ++src) {
+      if (src == worker_id_) {
+        continue;
+      }
+      std::vector<std::shared_ptr<arrow::Buffer>> chunks;
+      while (true) {
+        auto status = readers_[src]->ReceiveStreamChunks(chunks);
+        if (status.IsStreamDrained()) {
+          break;
+        }
+        RETURN_ON_ERROR(status);
+      }
+    }
+    writers_.clear();
+    readers_.clear();
+    pending_.clear();
+    RETURN_ON_ERROR(client_.DropName(registryName(worker_id_)));
+    RETURN_ON_ERROR(client_.DelData(self_));
+    client_.Disconnect();
+    return Status::OK();
+  }
+
+  int worker_id() const { return worker_id_; }
+
+  int worker_num() const { return worker_num_; }
+
+  int local_num() const { return local_num_; }
+
+  fid_t fid() const { return static_cast<fid_t>(worker_id_); }
+
+  fid_t fnum() const { return static_cast<fid_t>(worker_num_); }
+
+  fid_t WorkerToFrag(int worker_id) const {
+    return static_cast<fid_t>(worker_id);
+  }
+
+  int FragToWorker(fid_t fid) const { return static_cast<int>(fid); }
+
+  /**
+   * @brief Sends the buffer to the worker, the messages between a pair of
+   * workers are received in the order of being sent.
+   *
+   * Every message is published as a header chunk (that holds the size) and
+   * a payload chunk, the payload is sent inline without being copied into a
+   * staging buffer.
+   */
+  Status Send(int dst_worker_id,
+              const std::shared_ptr<arrow::Buffer>& buffer) const {
+    RETURN_ON_ASSERT(initialized_ && dst_worker_id != worker_id_ &&
+                         dst_worker_id >= 0 && dst_worker_id < worker_num_,
+                     "Invalid destination worker");
+    int64_t size = buffer == nullptr ? 0 : buffer->size();
+    std::vector<std::shared_ptr<arrow::Buffer>> chunks;
+    chunks.emplace_back(std::make_shared<arrow::Buffer>(
+        reinterpret_cast<const uint8_t*>(&size), sizeof(int64_t)));
+    if (size != 0) {
+      chunks.emplace_back(buffer);
+    }
+    return writers_[dst_worker_id]->PutChunks(chunks);
+  }
+
+  /**
+   * @brief Receives the next buffer sent by the worker, blocked until it
+   * arrives.
+   */
+  Status Recv(int src_worker_id, std::shared_ptr<arrow::Buffer>& buffer) const {
+    RETURN_ON_ASSERT(initialized_ && src_worker_id != worker_id_ &&
+                         src_worker_id >= 0 && src_worker_id < worker_num_,
+                     "Invalid source worker");
+    std::shared_ptr<arrow::Buffer> header;
+    RETURN_ON_ERROR(nextChunk(src_worker_id, header));
+    RETURN_ON_ASSERT(header->size() == sizeof(int64_t),
+                     "Invalid message header");
+    int64_t size = 0;
+    memcpy(&size, header->data(), sizeof(int64_t));
+    if (size == 0) {
+      buffer = std::make_shared<arrow::Buffer>(nullptr, 0);
+      return Status::OK();
+    }
+    RETURN_ON_ERROR(nextChunk(src_worker_id, buffer));
+    RETURN_ON_ASSERT(buffer->size() == size, "Invalid message payload");
+    return Status::OK();
+  }
+
+ private:
+  std::string registryName(int worker_id) const {
+    return "__vineyard_comm_spec_" + session_ + "_" + std::to_string(worker_id);
+  }
+
+  Status nextChunk(int src_worker_id,
+                   std::shared_ptr<arrow::Buffer>& chunk) const {
+    auto& pending = pending_[src_worker_id];
+    if (pending.empty()) {
+      std::vector<std::shared_ptr<arrow::Buffer>> chunks;
+      RETURN_ON_ERROR(readers_[src_worker_id]->ReceiveStreamChunks(chunks));
+      for (auto& item : chunks) {
+        pending.emplace_back(std::move(item));
+      }
+    }
+    chunk = std::move(pending.front());
+    pending.pop_front();
+    return Status::OK();
+  }
+
+  const std::string ipc_socket_;
+  const std::string session_;
+  const int worker_id_;
+  const int worker_num_;
+  const size_t credits_;
+  int local_num_ = 1;
+  bool initialized_ = false;
+
+  Client client_;
+  ObjectID self_ = InvalidObjectID();
+  // indexed by the destination worker
+  std::vector<std::unique_ptr<ByteStreamWriter>> writers_;
+  // indexed by the source worker, every subscription takes a connection
+  std::vector<std::unique_ptr<RPCClient>> readers_;
+  mutable std::vector<std::deque<std::shared_ptr<arrow::Buffer>>> pending_;
+};
+
+inline Status SendShuffleBuffer(const VineyardCommSpec& comm_spec,
+                                const std::shared_ptr<arrow::Buffer>& buffer,
+                                int dst_worker_id) {
+  return comm_spec.Send(dst_worker_id, buffer);
+}
+
+/**
+ * @brief The chunks of the stream are not gathered on the receiver side, thus
+ * the buffers are concatenated before sending.
+ */
+inline Status SendShuffleBuffers(
+    const VineyardCommSpec& comm_spec,
+    const std::vector<std::shared_ptr<arrow::Buffer>>& buffers,
+    int dst_worker_id) {
+  std::shared_ptr<arrow::Buffer> buffer;
+  if (buffers.size() == 1) {
+    buffer = buffers[0];
+  } else if (!buffers.empty()) {
+#if defined(ARROW_VERSION) && ARROW_VERSION < 17000
+    RETURN_ON_ARROW_ERROR(arrow::ConcatenateBuffers(
+        buffers, arrow::default_memory_pool(), &buffer));
+#else
+    RETURN_ON_ARROW_ERROR_AND_ASSIGN(
+        buffer,
+        arrow::ConcatenateBuffers(buffers, arrow::default_memory_pool()));
+#endif
+  }
+  return comm_spec.Send(dst_worker_id, buffer);
+}
+
+inline Status RecvShuffleBuffer(const VineyardCommSpec& comm_spec,
+                                std::shared_ptr<arrow::Buffer>& buffer,
+                                int src_worker_id) {
+  return comm_spec.Recv(src_worker_id, buffer);
+}
+
+}  // namespace vineyard
+
+#endif  // MODULES_GRAPH_UTILS_VINEYARD_COMM_SPEC_H_
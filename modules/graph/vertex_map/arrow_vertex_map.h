@@ -18,6 +18,7 @@ limitations under the License.
 
 #include <algorithm>
 #include <atomic>
+#include <limits>
 #include <map>
 #include <memory>
 #include <mutex>
@@ -29,12 +30,13 @@ limitations under the License.
 #include "basic/ds/arrow.h"
 #include "basic/ds/hashmap.h"
 #include "client/client.h"
+#include "common/util/env.h"
 #include "common/util/functions.h"
 #include "common/util/typename.h"
 
 #include "graph/fragment/property_graph_types.h"
 #include "graph/fragment/property_graph_utils.h"
-#include "graph/utils/thread_group.h"
+#include "graph/utils/thread_pool.h"
 
 namespace gs {
 
@@ -75,29 +77,69 @@ class ArrowVertexMap
 
     id_parser_.Init(fnum_, label_num_);
 
+    partial_ = meta.HasKey("partial") && meta.GetKeyValue<bool>("partial");
+
     o2g_.resize(fnum_);
     oid_arrays_.resize(fnum_);
+    gid_arrays_.resize(fnum_);
+    vertex_nums_.resize(fnum_);
     for (fid_t i = 0; i < fnum_; ++i) {
       o2g_[i].resize(label_num_);
       oid_arrays_[i].resize(label_num_);
+      gid_arrays_[i].resize(label_num_);
+      vertex_nums_[i].resize(label_num_);
       for (label_id_t j = 0; j < label_num_; ++j) {
-        o2g_[i][j].Construct(meta.GetMemberMeta("o2g_" + std::to_string(i) +
-                                                "_" + std::to_string(j)));
+        std::string suffix = std::to_string(i) + "_" + std::to_string(j);
+        o2g_[i][j].Construct(meta.GetMemberMeta("o2g_" + suffix));
 
         typename InternalType<oid_t>::vineyard_array_type array;
-        array.Construct(meta.GetMemberMeta("oid_arrays_" + std::to_string(i) +
-                                           "_" + std::to_string(j)));
+        array.Construct(meta.GetMemberMeta("oid_arrays_" + suffix));
         oid_arrays_[i][j] = array.GetArray();
+
+        if (partial_ && meta.HasKey("gid_arrays_" + suffix)) {
+          vineyard::NumericArray<vid_t> gid_array;
+          gid_array.Construct(meta.GetMemberMeta("gid_arrays_" + suffix));
+          gid_arrays_[i][j] = gid_array.GetArray();
+        }
+        if (partial_) {
+          vertex_nums_[i][j] =
+              meta.GetKeyValue<int64_t>("vertex_num_" + suffix);
+        } else {
+          vertex_nums_[i][j] = oid_arrays_[i][j]->length();
+        }
       }
     }
   }
 
+  /**
+   * @brief Whether the vertex map is partial, i.e., only the partition of a
+   * fragment is complete, and the partitions of other fragments only
+   * contain the vertices that are cached by the fragment (e.g., its outer
+   * vertices), see also `PartitionedArrowVertexMapBuilder`.
+   *
+   * The lookups of the uncached remote vertices fail in a partial vertex
+   * map.
+   */
+  bool partial() const { return partial_; }
+
   bool GetOid(vid_t gid, oid_t& oid) const {
     fid_t fid = id_parser_.GetFid(gid);
     label_id_t label = id_parser_.GetLabelId(gid);
     int64_t offset = id_parser_.GetOffset(gid);
     if (fid < fnum_ && label < label_num_ && label >= 0) {
       auto array = oid_arrays_[fid][label];
+      auto const& gid_array = gid_arrays_[fid][label];
+      if (gid_array != nullptr) {
+        // the cached vertices are sorted by gids
+        const vid_t* begin = gid_array->raw_values();
+        const vid_t* end = begin + gid_array->length();
+        const vid_t* iter = std::lower_bound(begin, end, gid);
+        if (iter == end || *iter != gid) {
+          return false;
+        }
+        oid = array->GetView(iter - begin);
+        return true;
+      }
       if (offset < array->length()) {
         oid = array->GetView(offset);
         return true;
@@ -124,6 +166,78 @@ class ArrowVertexMap
     return false;
   }
 
+  /**
+   * @brief Get the gids of a batch of oids in the given fragment, the lookups
+   * are prefetched ahead, see also `Hashmap::find`.
+   *
+   * @return The number of the found oids, `gids[i]` is left untouched if
+   * `oids[i]` is not found.
+   */
+  size_t GetGids(fid_t fid, label_id_t label_id, const oid_t* oids,
+                 size_t const n, vid_t* gids) const {
+    using iterator = typename Hashmap<oid_t, vid_t>::iterator;
+    constexpr size_t kBatchSize = 1024;
+    iterator iters[kBatchSize];
+    auto const& map = o2g_[fid][label_id];
+    size_t found = 0;
+    for (size_t base = 0; base < n; base += kBatchSize) {
+      size_t const batch = std::min(kBatchSize, n - base);
+      found += map.find(oids + base, batch, iters);
+      for (size_t i = 0; i < batch; ++i) {
+        if (iters[i] != map.end()) {
+          gids[base + i] = iters[i]->second;
+        }
+      }
+    }
+    return found;
+  }
+
+  /**
+   * @brief Get the gids of a batch of oids, where `oids[i]` belongs to the
+   * fragment `fids[i]`.
+   *
+   * The oids are grouped by fragments first, to make the batched lookups
+   * work on a single hashmap.
+   *
+   * @return The number of the found oids, `gids[i]` is left untouched if
+   * `oids[i]` is not found.
+   */
+  size_t GetGids(label_id_t label_id, const fid_t* fids, const oid_t* oids,
+                 size_t const n, vid_t* gids) const {
+    if (fnum_ == 1) {
+      return GetGids(0, label_id, oids, n, gids);
+    }
+    std::vector<size_t> offsets(fnum_ + 1, 0), positions(n);
+    for (size_t i = 0; i < n; ++i) {
+      offsets[fids[i] + 1] += 1;
+    }
+    for (fid_t fid = 0; fid < fnum_; ++fid) {
+      offsets[fid + 1] += offsets[fid];
+    }
+    {
+      std::vector<size_t> cursors(offsets.begin(), offsets.end() - 1);
+      for (size_t i = 0; i < n; ++i) {
+        positions[cursors[fids[i]]++] = i;
+      }
+    }
+    std::vector<oid_t> grouped_oids(n);
+    std::vector<vid_t> grouped_gids(n);
+    for (size_t k = 0; k < n; ++k) {
+      grouped_oids[k] = oids[positions[k]];
+      grouped_gids[k] = gids[positions[k]];
+    }
+    size_t found = 0;
+    for (fid_t fid = 0; fid < fnum_; ++fid) {
+      found += GetGids(fid, label_id, grouped_oids.data() + offsets[fid],
+                       offsets[fid + 1] - offsets[fid],
+                       grouped_gids.data() + offsets[fid]);
+    }
+    for (size_t k = 0; k < n; ++k) {
+      gids[positions[k]] = grouped_gids[k];
+    }
+    return found;
+  }
+
   std::vector<oid_t> GetOids(fid_t fid, label_id_t label_id) {
     auto array = oid_arrays_[fid][label_id];
     std::vector<oid_t> oids;
@@ -144,9 +258,9 @@ class ArrowVertexMap
 
   size_t GetTotalNodesNum() const {
     size_t num = 0;
-    for (auto& vec : oid_arrays_) {
+    for (auto& vec : vertex_nums_) {
       for (auto& v : vec) {
-        num += v->length();
+        num += v;
       }
     }
     return num;
@@ -154,8 +268,8 @@ class ArrowVertexMap
 
   size_t GetTotalNodesNum(label_id_t label) const {
     size_t num = 0;
-    for (auto& vec : oid_arrays_) {
-      num += vec[label]->length();
+    for (auto& vec : vertex_nums_) {
+      num += vec[label];
     }
     return num;
   }
@@ -164,14 +278,14 @@ class ArrowVertexMap
 
   vid_t GetInnerVertexSize(fid_t fid) const {
     size_t num = 0;
-    for (auto& v : oid_arrays_[fid]) {
-      num += v->length();
+    for (auto& v : vertex_nums_[fid]) {
+      num += v;
     }
     return static_cast<vid_t>(num);
   }
 
   vid_t GetInnerVertexSize(fid_t fid, label_id_t label_id) const {
-    return static_cast<vid_t>(oid_arrays_[fid][label_id]->length());
+    return static_cast<vid_t>(vertex_nums_[fid][label_id]);
   }
 
   ObjectID AddVertices(
@@ -192,6 +306,11 @@ class ArrowVertexMap
       Client& client,
       const std::vector<std::vector<std::shared_ptr<oid_array_t>>>&
           oid_arrays) {
+    if (partial_) {
+      LOG(ERROR) << "Adding vertex labels to a partial vertex map is not "
+                    "supported";
+      return InvalidObjectID();
+    }
     size_t extra_label_num = oid_arrays.size();
     int task_num = static_cast<int>(fnum_) * static_cast<int>(extra_label_num);
 
@@ -206,50 +325,42 @@ class ArrowVertexMap
       vy_o2g[i].resize(extra_label_num);
     }
 
-    int thread_num = std::min(
-        static_cast<int>(std::thread::hardware_concurrency()), task_num);
-    std::atomic<int> task_id(0);
-    std::vector<std::thread> threads(thread_num);
-    for (int i = 0; i < thread_num; ++i) {
-      threads[i] = std::thread([&]() {
-        while (true) {
-          int got_task_id = task_id.fetch_add(1);
-          if (got_task_id >= task_num) {
-            break;
-          }
-          fid_t cur_fid = static_cast<fid_t>(got_task_id) % fnum_;
-          auto cur_label =
-              static_cast<label_id_t>(static_cast<fid_t>(got_task_id) / fnum_);
-
-          vineyard::HashmapBuilder<oid_t, vid_t> builder(client);
-          auto array = oid_arrays[cur_label][cur_fid];
-          {
-            vid_t cur_gid =
-                id_parser_.GenerateId(cur_fid, label_num_ + cur_label, 0);
-            int64_t vnum = array->length();
-            // builder.reserve(static_cast<size_t>(vnum));
-            for (int64_t k = 0; k < vnum; ++k) {
-              builder.emplace(array->GetView(k), cur_gid);
-              ++cur_gid;
-            }
-          }
-
-          {
-            typename InternalType<oid_t>::vineyard_builder_type array_builder(
-                client, array);
-            vy_oid_arrays[cur_fid][cur_label] =
-                *std::dynamic_pointer_cast<vineyard::NumericArray<oid_t>>(
-                    array_builder.Seal(client));
+    TaskGroup tg;
+    for (int got_task_id = 0; got_task_id < task_num; ++got_task_id) {
+      tg.AddTask([&, got_task_id]() -> Status {
+        fid_t cur_fid = static_cast<fid_t>(got_task_id) % fnum_;
+        auto cur_label =
+            static_cast<label_id_t>(static_cast<fid_t>(got_task_id) / fnum_);
 
-            vy_o2g[cur_fid][cur_label] =
-                *std::dynamic_pointer_cast<vineyard::Hashmap<oid_t, vid_t>>(
-                    builder.Seal(client));
+        vineyard::HashmapBuilder<oid_t, vid_t> builder(client);
+        auto array = oid_arrays[cur_label][cur_fid];
+        {
+          vid_t cur_gid =
+              id_parser_.GenerateId(cur_fid, label_num_ + cur_label, 0);
+          int64_t vnum = array->length();
+          builder.reserve(static_cast<size_t>(vnum));
+          for (int64_t k = 0; k < vnum; ++k) {
+            builder.emplace(array->GetView(k), cur_gid);
+            ++cur_gid;
           }
         }
+
+        {
+          typename InternalType<oid_t>::vineyard_builder_type array_builder(
+              client, array);
+          vy_oid_arrays[cur_fid][cur_label] =
+              *std::dynamic_pointer_cast<vineyard::NumericArray<oid_t>>(
+                  array_builder.Seal(client));
+
+          vy_o2g[cur_fid][cur_label] =
+              *std::dynamic_pointer_cast<vineyard::Hashmap<oid_t, vid_t>>(
+                  builder.Seal(client));
+        }
+        return Status::OK();
       });
     }
-    for (auto& thrd : threads) {
-      thrd.join();
+    for (auto const& status : tg.TakeResults()) {
+      VINEYARD_CHECK_OK(status);
     }
 
     vineyard::ObjectMeta old_meta, new_meta;
@@ -302,6 +413,15 @@ class ArrowVertexMap
   std::vector<std::vector<std::shared_ptr<oid_array_t>>> oid_arrays_;
   std::vector<std::vector<vineyard::Hashmap<oid_t, vid_t>>> o2g_;
 
+  // for partial vertex maps: the (sorted) gids of the cached vertices, which
+  // is nullptr for the complete partitions, and the number of vertices of
+  // every partition.
+  bool partial_ = false;
+  std::vector<std::vector<
+      std::shared_ptr<typename ConvertToArrowType<vid_t>::ArrayType>>>
+      gid_arrays_;
+  std::vector<std::vector<int64_t>> vertex_nums_;
+
   template <typename _OID_T, typename _VID_T>
   friend class ArrowVertexMapBuilder;
 
@@ -338,17 +458,18 @@ class ArrowVertexMap<arrow::util::string_view, VID_T>
     id_parser_.Init(fnum_, label_num_);
 
     oid_arrays_.resize(fnum_);
+    o2g_.resize(fnum_);
     for (fid_t i = 0; i < fnum_; ++i) {
       oid_arrays_[i].resize(label_num_);
+      o2g_[i].resize(label_num_);
       for (label_id_t j = 0; j < label_num_; ++j) {
         typename InternalType<oid_t>::vineyard_array_type array;
         array.Construct(meta.GetMemberMeta("oid_arrays_" + std::to_string(i) +
                                            "_" + std::to_string(j)));
         oid_arrays_[i][j] = array.GetArray();
+        o2g_[i][j] = sharedHashmap(array.id(), i, j, oid_arrays_[i][j]);
       }
     }
-
-    initHashmaps();
   }
 
   bool GetOid(vid_t gid, oid_t& oid) const {
@@ -366,12 +487,7 @@ class ArrowVertexMap<arrow::util::string_view, VID_T>
   }
 
   bool GetGid(fid_t fid, label_id_t label_id, oid_t oid, vid_t& gid) const {
-    auto iter = o2g_[fid][label_id].find(oid);
-    if (iter != o2g_[fid][label_id].end()) {
-      gid = iter->second;
-      return true;
-    }
-    return false;
+    return o2g_[fid][label_id]->find(oid, gid);
   }
 
   bool GetGid(label_id_t label_id, oid_t oid, vid_t& gid) const {
@@ -383,6 +499,31 @@ class ArrowVertexMap<arrow::util::string_view, VID_T>
     return false;
   }
 
+  /**
+   * @brief Get the gids of a batch of oids in the given fragment, with the
+   * sorted index the batch is sorted first and searched in a single forward
+   * pass, see also `shared_hashmap_t::find`.
+   *
+   * @return The number of the found oids, `gids[i]` is left untouched if
+   * `oids[i]` is not found.
+   */
+  size_t GetGids(fid_t fid, label_id_t label_id, const oid_t* oids,
+                 size_t const n, vid_t* gids) const {
+    return o2g_[fid][label_id]->find(oids, n, gids);
+  }
+
+  size_t GetGids(label_id_t label_id, const fid_t* fids, const oid_t* oids,
+                 size_t const n, vid_t* gids) const {
+    if (fnum_ == 1) {
+      return GetGids(0, label_id, oids, n, gids);
+    }
+    size_t found = 0;
+    for (size_t i = 0; i < n; ++i) {
+      found += GetGid(fids[i], label_id, oids[i], gids[i]);
+    }
+    return found;
+  }
+
   std::vector<oid_t> GetOids(fid_t fid, label_id_t label_id) {
     auto array = oid_arrays_[fid][label_id];
     std::vector<oid_t> oids;
@@ -457,7 +598,7 @@ class ArrowVertexMap<arrow::util::string_view, VID_T>
       vy_oid_arrays[i].resize(extra_label_num);
     }
 
-    ThreadGroup tg;
+    TaskGroup tg;
     auto builder_fn = [&client, &oid_arrays, &vy_oid_arrays](
                           fid_t const fid,
                           label_id_t const vlabel_id) -> Status {
@@ -508,23 +649,138 @@ class ArrowVertexMap<arrow::util::string_view, VID_T>
   }
 
  private:
-  void initHashmaps() {
-    o2g_.resize(fnum_);
-    for (fid_t i = 0; i < fnum_; ++i) {
-      o2g_[i].resize(label_num_);
-      for (label_id_t j = 0; j < label_num_; ++j) {
-        auto array = oid_arrays_[i][j];
-        auto& map = o2g_[i][j];
-        {
-          vid_t cur_gid = id_parser_.GenerateId(i, j, 0);
-          int64_t vnum = array->length();
-          for (int64_t k = 0; k < vnum; ++k) {
-            map.emplace(array->GetView(k), cur_gid);
-            ++cur_gid;
-          }
+  // the index of an oid array, which also keeps the array alive as the
+  // keys are views of it.
+  //
+  // The oids are hashed by default. When the environment variable
+  // `VINEYARD_STRING_VERTEX_MAP_INDEX` is "sorted", the offsets are sorted
+  // by the oids instead and the oids are looked up by binary search, which
+  // takes 4 bytes per vertex rather than a hashmap entry (with a view of the
+  // string).
+  struct shared_hashmap_t {
+    std::shared_ptr<oid_array_t> oids;
+    vid_t base_gid = 0;
+    ska::flat_hash_map<oid_t, vid_t> o2g;
+    bool ordered = false;
+    std::vector<uint32_t> sorted;
+
+    bool find(oid_t oid, vid_t& gid) const {
+      if (!ordered) {
+        auto iter = o2g.find(oid);
+        if (iter != o2g.end()) {
+          gid = iter->second;
+          return true;
         }
+        return false;
       }
+      return search(oid, sorted.begin(), gid) != sorted.end();
     }
+
+    size_t find(const oid_t* keys, size_t const n, vid_t* gids) const {
+      size_t found = 0;
+      if (!ordered) {
+        for (size_t i = 0; i < n; ++i) {
+          found += find(keys[i], gids[i]);
+        }
+        return found;
+      }
+      // the searching range shrinks as the keys are visited in order
+      std::vector<size_t> order(n);
+      for (size_t i = 0; i < n; ++i) {
+        order[i] = i;
+      }
+      std::sort(order.begin(), order.end(), [keys](size_t lhs, size_t rhs) {
+        return keys[lhs] < keys[rhs];
+      });
+      auto from = sorted.begin();
+      for (size_t i : order) {
+        auto iter = search(keys[i], from, gids[i]);
+        if (iter != sorted.end()) {
+          from = iter;
+          found += 1;
+        }
+      }
+      return found;
+    }
+
+   private:
+    std::vector<uint32_t>::const_iterator search(
+        oid_t oid, std::vector<uint32_t>::const_iterator from,
+        vid_t& gid) const {
+      const oid_array_t* array = oids.get();
+      auto iter = std::lower_bound(from, sorted.end(), oid,
+                                   [array](uint32_t offset, const oid_t& key) {
+                                     return array->GetView(offset) < key;
+                                   });
+      if (iter != sorted.end() && array->GetView(*iter) == oid) {
+        gid = base_gid + *iter;
+        return iter;
+      }
+      return sorted.end();
+    }
+  };
+
+  static bool sortedIndex() {
+    static const bool sorted =
+        read_env("VINEYARD_STRING_VERTEX_MAP_INDEX") == "sorted";
+    return sorted;
+  }
+
+  /**
+   * @brief The hashmaps are built on the client side, and are shared by the
+   * vertex maps that contain the same oid array in the same fragment and
+   * label, e.g., the new version created by `AddNewVertexLabels` reuses the
+   * hashmaps of the unchanged labels rather than rebuilding them.
+   */
+  std::shared_ptr<shared_hashmap_t> sharedHashmap(
+      const ObjectID array_id, fid_t const fid, label_id_t const label,
+      const std::shared_ptr<oid_array_t>& array) const {
+    static std::mutex mutex;
+    static std::map<std::pair<ObjectID, vid_t>,
+                    std::weak_ptr<shared_hashmap_t>>
+        hashmaps;
+
+    vid_t cur_gid = id_parser_.GenerateId(fid, label, 0);
+    std::lock_guard<std::mutex> lock(mutex);
+    auto& cached = hashmaps[std::make_pair(array_id, cur_gid)];
+    if (auto hashmap = cached.lock()) {
+      return hashmap;
+    }
+    auto hashmap = std::make_shared<shared_hashmap_t>();
+    hashmap->oids = array;
+    hashmap->base_gid = cur_gid;
+    int64_t vnum = array->length();
+    if (sortedIndex() &&
+        vnum <= static_cast<int64_t>(std::numeric_limits<uint32_t>::max())) {
+      hashmap->ordered = true;
+      hashmap->sorted.resize(vnum);
+      for (int64_t k = 0; k < vnum; ++k) {
+        hashmap->sorted[k] = static_cast<uint32_t>(k);
+      }
+      const oid_array_t* oids = array.get();
+      std::sort(hashmap->sorted.begin(), hashmap->sorted.end(),
+                [oids](uint32_t lhs, uint32_t rhs) {
+                  return oids->GetView(lhs) < oids->GetView(rhs);
+                });
+    } else {
+      hashmap->o2g.reserve(static_cast<size_t>(vnum));
+      for (int64_t k = 0; k < vnum; ++k) {
+        hashmap->o2g.emplace(array->GetView(k), cur_gid);
+        ++cur_gid;
+      }
+    }
+    cached = hashmap;
+
+    // drops the hashmaps of the released vertex maps
+    for (auto iter = hashmaps.begin(); iter != hashmaps.end();
+         /* no self-inc */) {
+      if (iter->second.expired()) {
+        iter = hashmaps.erase(iter);
+      } else {
+        ++iter;
+      }
+    }
+    return hashmap;
   }
 
   fid_t fnum_;
@@ -534,7 +790,7 @@ class ArrowVertexMap<arrow::util::string_view, VID_T>
 
   // frag->label->oid
   std::vector<std::vector<std::shared_ptr<oid_array_t>>> oid_arrays_;
-  std::vector<std::vector<ska::flat_hash_map<oid_t, vid_t>>> o2g_;
+  std::vector<std::vector<std::shared_ptr<shared_hashmap_t>>> o2g_;
 
   template <typename _OID_T, typename _VID_T>
   friend class ArrowVertexMapBuilder;
@@ -574,6 +830,32 @@ class ArrowVertexMapBuilder : public vineyard::ObjectBuilder {
     o2g_[fid][label] = rm;
   }
 
+  /**
+   * @brief Mark the vertex map as partial, the number of vertices of every
+   * partition must be set, and the partitions that only cache some vertices
+   * must set the (sorted) gids of the cached vertices, see also
+   * `ArrowVertexMap::partial()`.
+   */
+  void set_partial(bool partial) {
+    partial_ = partial;
+    gid_arrays_.resize(fnum_);
+    vertex_nums_.resize(fnum_);
+    for (fid_t i = 0; i < fnum_; ++i) {
+      gid_arrays_[i].resize(label_num_);
+      vertex_nums_[i].resize(label_num_, 0);
+    }
+  }
+
+  void set_vertex_num(fid_t fid, label_id_t label, int64_t vertex_num) {
+    vertex_nums_[fid][label] = vertex_num;
+  }
+
+  void set_gid_array(fid_t fid, label_id_t label,
+                     const vineyard::NumericArray<vid_t>& array) {
+    gid_arrays_[fid][label] =
+        std::make_shared<vineyard::NumericArray<vid_t>>(array);
+  }
+
   std::shared_ptr<vineyard::Object> _Seal(vineyard::Client& client) {
     // ensure the builder hasn't been sealed yet.
     ENSURE_NOT_SEALED(this);
@@ -584,13 +866,26 @@ class ArrowVertexMapBuilder : public vineyard::ObjectBuilder {
     vertex_map->fnum_ = fnum_;
     vertex_map->label_num_ = label_num_;
     vertex_map->id_parser_.Init(fnum_, label_num_);
+    vertex_map->partial_ = partial_;
 
     vertex_map->oid_arrays_.resize(fnum_);
+    vertex_map->gid_arrays_.resize(fnum_);
+    vertex_map->vertex_nums_.resize(fnum_);
     for (fid_t i = 0; i < fnum_; ++i) {
       auto& array = vertex_map->oid_arrays_[i];
       array.resize(label_num_);
+      vertex_map->gid_arrays_[i].resize(label_num_);
+      vertex_map->vertex_nums_[i].resize(label_num_);
       for (label_id_t j = 0; j < label_num_; ++j) {
         array[j] = oid_arrays_[i][j].GetArray();
+        if (partial_) {
+          if (gid_arrays_[i][j] != nullptr) {
+            vertex_map->gid_arrays_[i][j] = gid_arrays_[i][j]->GetArray();
+          }
+          vertex_map->vertex_nums_[i][j] = vertex_nums_[i][j];
+        } else {
+          vertex_map->vertex_nums_[i][j] = array[j]->length();
+        }
       }
     }
 
@@ -600,19 +895,30 @@ class ArrowVertexMapBuilder : public vineyard::ObjectBuilder {
 
     vertex_map->meta_.AddKeyValue("fnum", fnum_);
     vertex_map->meta_.AddKeyValue("label_num", label_num_);
+    if (partial_) {
+      vertex_map->meta_.AddKeyValue("partial", true);
+    }
 
     size_t nbytes = 0;
     for (fid_t i = 0; i < fnum_; ++i) {
       for (label_id_t j = 0; j < label_num_; ++j) {
-        vertex_map->meta_.AddMember(
-            "oid_arrays_" + std::to_string(i) + "_" + std::to_string(j),
-            oid_arrays_[i][j].meta());
+        std::string suffix = std::to_string(i) + "_" + std::to_string(j);
+        vertex_map->meta_.AddMember("oid_arrays_" + suffix,
+                                    oid_arrays_[i][j].meta());
         nbytes += oid_arrays_[i][j].nbytes();
 
-        vertex_map->meta_.AddMember(
-            "o2g_" + std::to_string(i) + "_" + std::to_string(j),
-            o2g_[i][j].meta());
+        vertex_map->meta_.AddMember("o2g_" + suffix, o2g_[i][j].meta());
         nbytes += o2g_[i][j].nbytes();
+
+        if (partial_) {
+          vertex_map->meta_.AddKeyValue("vertex_num_" + suffix,
+                                        vertex_nums_[i][j]);
+          if (gid_arrays_[i][j] != nullptr) {
+            vertex_map->meta_.AddMember("gid_arrays_" + suffix,
+                                        gid_arrays_[i][j]->meta());
+            nbytes += gid_arrays_[i][j]->nbytes();
+          }
+        }
       }
     }
 
@@ -633,6 +939,11 @@ class ArrowVertexMapBuilder : public vineyard::ObjectBuilder {
   std::vector<std::vector<typename InternalType<oid_t>::vineyard_array_type>>
       oid_arrays_;
   std::vector<std::vector<vineyard::Hashmap<oid_t, vid_t>>> o2g_;
+
+  bool partial_ = false;
+  std::vector<std::vector<std::shared_ptr<vineyard::NumericArray<vid_t>>>>
+      gid_arrays_;
+  std::vector<std::vector<int64_t>> vertex_nums_;
 };
 
 template <typename VID_T>
@@ -735,95 +1046,54 @@ class BasicArrowVertexMapBuilder : public ArrowVertexMapBuilder<OID_T, VID_T> {
   vineyard::Status Build(vineyard::Client& client) override {
     this->set_fnum_label_num(fnum_, label_num_);
 
-#if 0
-    for (fid_t i = 0; i < fnum_; ++i) {
-      // TODO(luoxiaojian): parallel construct hashmap
-      for (label_id_t j = 0; j < label_num_; ++j) {
-        vineyard::HashmapBuilder<oid_t, vid_t> builder(client);
-
-        auto array = oid_arrays_[j][i];
-        {
-          vid_t cur_gid = id_parser_.GenerateId(i, j, 0);
-          int64_t vnum = array->length();
-          for (int64_t k = 0; k < vnum; ++k) {
-            builder.emplace(array->GetView(k), cur_gid);
-            ++cur_gid;
-          }
-        }
-
-        typename InternalType<oid_t>::vineyard_builder_type array_builder(
-            client, array);
-        this->set_oid_array(
-            i, j,
-            *std::dynamic_pointer_cast<vineyard::NumericArray<oid_t>>(
-                array_builder.Seal(client)));
-
-        this->set_o2g(
-            i, j,
-            *std::dynamic_pointer_cast<vineyard::Hashmap<oid_t, vid_t>>(
-                builder.Seal(client)));
-      }
-    }
-#else
-    int task_num = static_cast<int>(fnum_) * static_cast<int>(label_num_);
-    int thread_num = std::min(
-        static_cast<int>(std::thread::hardware_concurrency()), task_num);
-    std::atomic<int> task_id(0);
-
 #if defined(WITH_PROFILING)
     auto start_ts = GetCurrentTime();
 #endif
 
-    std::vector<std::thread> threads(thread_num);
-    for (int i = 0; i < thread_num; ++i) {
-      threads[i] = std::thread([&]() {
-        while (true) {
-          int got_task_id = task_id.fetch_add(1);
-          if (got_task_id >= task_num) {
-            break;
-          }
-          fid_t cur_fid = static_cast<fid_t>(got_task_id) % fnum_;
-          label_id_t cur_label =
-              static_cast<label_id_t>(static_cast<fid_t>(got_task_id) / fnum_);
-
-          vineyard::HashmapBuilder<oid_t, vid_t> builder(client);
-          auto array = oid_arrays_[cur_label][cur_fid];
-          {
-            vid_t cur_gid = id_parser_.GenerateId(cur_fid, cur_label, 0);
-            int64_t vnum = array->length();
-            // builder.reserve(static_cast<size_t>(vnum));
-            for (int64_t k = 0; k < vnum; ++k) {
-              builder.emplace(array->GetView(k), cur_gid);
-              ++cur_gid;
-            }
-          }
+    // every (fragment, label) builds and seals its own oid array and hashmap
+    TaskGroup tg;
 
-          {
-            typename InternalType<oid_t>::vineyard_builder_type array_builder(
-                client, array);
-            this->set_oid_array(
-                cur_fid, cur_label,
-                *std::dynamic_pointer_cast<vineyard::NumericArray<oid_t>>(
-                    array_builder.Seal(client)));
-
-            this->set_o2g(
-                cur_fid, cur_label,
-                *std::dynamic_pointer_cast<vineyard::Hashmap<oid_t, vid_t>>(
-                    builder.Seal(client)));
-          }
+    auto builder_fn = [this, &client](fid_t const fid,
+                                      label_id_t const vlabel_id) -> Status {
+      auto& array = oid_arrays_[vlabel_id][fid];
+      vineyard::HashmapBuilder<oid_t, vid_t> builder(client);
+      {
+        vid_t cur_gid = id_parser_.GenerateId(fid, vlabel_id, 0);
+        int64_t vnum = array->length();
+        builder.reserve(static_cast<size_t>(vnum));
+        for (int64_t k = 0; k < vnum; ++k) {
+          builder.emplace(array->GetView(k), cur_gid);
+          ++cur_gid;
         }
-      });
+      }
+
+      typename InternalType<oid_t>::vineyard_builder_type array_builder(client,
+                                                                        array);
+      this->set_oid_array(
+          fid, vlabel_id,
+          *std::dynamic_pointer_cast<vineyard::NumericArray<oid_t>>(
+              array_builder.Seal(client)));
+
+      this->set_o2g(
+          fid, vlabel_id,
+          *std::dynamic_pointer_cast<vineyard::Hashmap<oid_t, vid_t>>(
+              builder.Seal(client)));
+      return Status::OK();
+    };
+
+    for (fid_t fid = 0; fid < fnum_; ++fid) {
+      for (label_id_t vlabel_id = 0; vlabel_id < label_num_; ++vlabel_id) {
+        tg.AddTask(builder_fn, fid, vlabel_id);
+      }
     }
-    for (auto& thrd : threads) {
-      thrd.join();
+    for (auto const& status : tg.TakeResults()) {
+      RETURN_ON_ERROR(status);
     }
 
 #if defined(WITH_PROFILING)
     auto finish_seal_ts = GetCurrentTime();
     LOG(INFO) << "Seal hashmaps uses " << (finish_seal_ts - start_ts)
               << " seconds";
-#endif
-
 #endif
 
     return vineyard::Status::OK();
@@ -838,6 +1108,119 @@ class BasicArrowVertexMapBuilder : public ArrowVertexMapBuilder<OID_T, VID_T> {
   std::vector<std::vector<std::shared_ptr<oid_array_t>>> oid_arrays_;
 };
 
+/**
+ * @brief Builds the partial vertex map of a fragment (see also
+ * `ArrowVertexMap::partial()`), from the oids of its inner vertices, the
+ * number of vertices of every fragment, and the (oid, gid) pairs of the
+ * remote vertices that are cached, which must be sorted by the gids.
+ *
+ * Only the arithmetic oids are supported.
+ */
+template <typename OID_T, typename VID_T>
+class PartitionedArrowVertexMapBuilder
+    : public ArrowVertexMapBuilder<OID_T, VID_T> {
+  using oid_t = OID_T;
+  using vid_t = VID_T;
+  using oid_array_t = typename vineyard::ConvertToArrowType<oid_t>::ArrayType;
+  using vid_array_t = typename vineyard::ConvertToArrowType<vid_t>::ArrayType;
+  using label_id_t = property_graph_types::LABEL_ID_TYPE;
+
+ public:
+  /**
+   * @param oid_arrays label -> fid -> the oids of the partition, i.e., the
+   *  inner vertices for `fid`, and the cached vertices for other fragments.
+   * @param gid_arrays label -> fid -> the gids of the cached vertices, the
+   *  entries of `fid` are ignored.
+   * @param vertex_nums label -> fid -> the number of vertices.
+   */
+  PartitionedArrowVertexMapBuilder(
+      vineyard::Client& client, fid_t fnum, fid_t fid, label_id_t label_num,
+      const std::vector<std::vector<std::shared_ptr<oid_array_t>>>& oid_arrays,
+      const std::vector<std::vector<std::shared_ptr<vid_array_t>>>& gid_arrays,
+      const std::vector<std::vector<int64_t>>& vertex_nums)
+      : ArrowVertexMapBuilder<oid_t, vid_t>(client),
+        fnum_(fnum),
+        fid_(fid),
+        label_num_(label_num),
+        oid_arrays_(oid_arrays),
+        gid_arrays_(gid_arrays),
+        vertex_nums_(vertex_nums) {
+    CHECK_EQ(oid_arrays.size(), label_num);
+    CHECK_EQ(gid_arrays.size(), label_num);
+    CHECK_EQ(vertex_nums.size(), label_num);
+    id_parser_.Init(fnum_, label_num_);
+  }
+
+  vineyard::Status Build(vineyard::Client& client) override {
+    this->set_fnum_label_num(fnum_, label_num_);
+    this->set_partial(true);
+
+    TaskGroup tg;
+
+    auto builder_fn = [this, &client](fid_t const fid,
+                                      label_id_t const vlabel_id) -> Status {
+      auto& array = oid_arrays_[vlabel_id][fid];
+      vineyard::HashmapBuilder<oid_t, vid_t> builder(client);
+      int64_t vnum = array->length();
+      builder.reserve(static_cast<size_t>(vnum));
+      if (fid == fid_) {
+        vid_t cur_gid = id_parser_.GenerateId(fid, vlabel_id, 0);
+        for (int64_t k = 0; k < vnum; ++k) {
+          builder.emplace(array->GetView(k), cur_gid);
+          ++cur_gid;
+        }
+      } else {
+        auto& gid_array = gid_arrays_[vlabel_id][fid];
+        RETURN_ON_ASSERT(gid_array->length() == vnum,
+                         "The cached oids and gids are not consistent");
+        for (int64_t k = 0; k < vnum; ++k) {
+          builder.emplace(array->GetView(k), gid_array->Value(k));
+        }
+        typename InternalType<vid_t>::vineyard_builder_type gid_builder(
+            client, gid_array);
+        this->set_gid_array(
+            fid, vlabel_id,
+            *std::dynamic_pointer_cast<vineyard::NumericArray<vid_t>>(
+                gid_builder.Seal(client)));
+      }
+      this->set_vertex_num(fid, vlabel_id, vertex_nums_[vlabel_id][fid]);
+
+      typename InternalType<oid_t>::vineyard_builder_type array_builder(client,
+                                                                        array);
+      this->set_oid_array(
+          fid, vlabel_id,
+          *std::dynamic_pointer_cast<vineyard::NumericArray<oid_t>>(
+              array_builder.Seal(client)));
+
+      this->set_o2g(
+          fid, vlabel_id,
+          *std::dynamic_pointer_cast<vineyard::Hashmap<oid_t, vid_t>>(
+              builder.Seal(client)));
+      return Status::OK();
+    };
+
+    for (fid_t fid = 0; fid < fnum_; ++fid) {
+      for (label_id_t vlabel_id = 0; vlabel_id < label_num_; ++vlabel_id) {
+        tg.AddTask(builder_fn, fid, vlabel_id);
+      }
+    }
+    for (auto const& status : tg.TakeResults()) {
+      RETURN_ON_ERROR(status);
+    }
+    return vineyard::Status::OK();
+  }
+
+ private:
+  fid_t fnum_, fid_;
+  label_id_t label_num_;
+
+  vineyard::IdParser<vid_t> id_parser_;
+
+  std::vector<std::vector<std::shared_ptr<oid_array_t>>> oid_arrays_;
+  std::vector<std::vector<std::shared_ptr<vid_array_t>>> gid_arrays_;
+  std::vector<std::vector<int64_t>> vertex_nums_;
+};
+
 template <typename VID_T>
 class BasicArrowVertexMapBuilder<arrow::util::string_view, VID_T>
     : public ArrowVertexMapBuilder<arrow::util::string_view, VID_T> {
@@ -861,7 +1244,7 @@ class BasicArrowVertexMapBuilder<arrow::util::string_view, VID_T>
   vineyard::Status Build(vineyard::Client& client) override {
     this->set_fnum_label_num(fnum_, label_num_);
 
-    ThreadGroup tg;
+    TaskGroup tg;
 
     auto builder_fn = [this, &client](fid_t const fid,
                                       label_id_t const vlabel_id) -> Status {
@@ -17,9 +17,11 @@ limitations under the License.
 #include "basic/stream/parallel_stream.h"
 #include "client/client.h"
 #include "client/ds/blob.h"
+#include "common/memory/memcpy.h"
 #include "common/util/json.h"
 #include "common/util/logging.h"
 #include "common/util/status.h"
+#include "io/io/chunked_blobs.h"
 #include "io/io/utils.h"
 
 using namespace vineyard;  // NOLINT(build/namespaces)
@@ -92,18 +94,44 @@ Status Deserialize(Client& client, ObjectID stream_id, std::string& out_id) {
       json::parse(params["blobs"]).get<std::vector<ObjectID>>();
   auto blobs_size =
       json::parse(params["blobs_size"]).get<std::vector<size_t>>();
-  std::unique_ptr<BlobWriter> blob_writer;
   std::unordered_map<ObjectID, std::shared_ptr<Blob>> blobs;
-  for (size_t i = 0; i < ordered_blobs.size(); ++i) {
-    if (blobs_size[i] > 0) {
-      std::unique_ptr<arrow::Buffer> buffer = nullptr;
-      RETURN_ON_ERROR(reader->GetNext(buffer));
-      RETURN_ON_ERROR(client.CreateBlob(buffer->size(), blob_writer));
-      memcpy(blob_writer->data(), buffer->data(), buffer->size());
-      auto blob = std::dynamic_pointer_cast<Blob>(blob_writer->Seal(client));
-      blobs.emplace(ordered_blobs[i], blob);
-    } else {
-      blobs.emplace(ordered_blobs[i], Blob::MakeEmpty(client));
+  BlobChunkOptions options;
+  if (ReadBlobChunkOptions(params, options)) {
+    // allocate all destination blobs up front, then fill them concurrently
+    std::vector<std::unique_ptr<BlobWriter>> blob_writers(ordered_blobs.size());
+    std::vector<uint8_t*> targets(ordered_blobs.size(), nullptr);
+    for (size_t i = 0; i < ordered_blobs.size(); ++i) {
+      if (blobs_size[i] > 0) {
+        RETURN_ON_ERROR(client.CreateBlob(blobs_size[i], blob_writers[i]));
+        targets[i] = reinterpret_cast<uint8_t*>(blob_writers[i]->data());
+      }
+    }
+    reader->SetPrefetch(options.concurrency);
+    RETURN_ON_ERROR(ReadBlobChunks(*reader, targets, blobs_size, options));
+    for (size_t i = 0; i < ordered_blobs.size(); ++i) {
+      if (blob_writers[i]) {
+        blobs.emplace(ordered_blobs[i], std::dynamic_pointer_cast<Blob>(
+                                            blob_writers[i]->Seal(client)));
+      } else {
+        blobs.emplace(ordered_blobs[i], Blob::MakeEmpty(client));
+      }
+    }
+  } else {
+    // serialized by the legacy serializer, one blob per chunk
+    std::unique_ptr<BlobWriter> blob_writer;
+    for (size_t i = 0; i < ordered_blobs.size(); ++i) {
+      if (blobs_size[i] > 0) {
+        std::unique_ptr<arrow::Buffer> buffer = nullptr;
+        RETURN_ON_ERROR(reader->GetNext(buffer));
+        RETURN_ON_ERROR(client.CreateBlob(buffer->size(), blob_writer));
+        memory::concurrent_memcpy(blob_writer->data(), buffer->data(),
+                                  buffer->size());
+        auto blob =
+            std::dynamic_pointer_cast<Blob>(blob_writer->Seal(client));
+        blobs.emplace(ordered_blobs[i], blob);
+      } else {
+        blobs.emplace(ordered_blobs[i], Blob::MakeEmpty(client));
+      }
     }
   }
   json meta = json::parse(params["meta"]);
@@ -14,8 +14,10 @@ limitations under the License.
 */
 
 #include <iostream>
+#include <memory>
 #include <string>
 
+#include "basic/ds/arrow_utils.h"
 #include "basic/stream/dataframe_stream.h"
 #include "client/client.h"
 #include "io/io/i_io_adaptor.h"
@@ -25,7 +27,9 @@ using namespace vineyard;  // NOLINT(build/namespaces)
 
 int main(int argc, const char** argv) {
   if (argc < 3) {
-    printf("usage ./dataframe_stream_reader <ipc_socket> <stream_id>");
+    printf(
+        "usage ./dataframe_stream_reader <ipc_socket> <stream_id> "
+        "[<output location>]");
     return 1;
   }
 
@@ -43,6 +47,26 @@ int main(int argc, const char** argv) {
   std::unique_ptr<DataframeStreamReader> reader;
   VINEYARD_CHECK_OK(s->OpenReader(client, reader));
 
+  if (argc > 3) {
+    // dumps the chunks as they arrive, formatted as CSV (or parquet, by the
+    // extension or the "format" argument of the location)
+    auto adaptor = IOFactory::CreateIOAdaptor(argv[3]);
+    VINEYARD_ASSERT(adaptor != nullptr,
+                    "Cannot dump to '" + std::string(argv[3]) + "'");
+    VINEYARD_CHECK_OK(adaptor->Open("w"));
+    int64_t num_rows = 0;
+    std::shared_ptr<arrow::RecordBatch> batch;
+    while (reader->ReadBatch(batch).ok()) {
+      std::shared_ptr<arrow::Table> table;
+      VINEYARD_CHECK_OK(RecordBatchesToTable({batch}, &table));
+      VINEYARD_CHECK_OK(adaptor->WriteTable(table));
+      num_rows += batch->num_rows();
+    }
+    VINEYARD_CHECK_OK(adaptor->Close());
+    LOG(INFO) << "Dumped " << num_rows << " rows to " << argv[3];
+    return 0;
+  }
+
   std::shared_ptr<arrow::Table> table;
   VINEYARD_CHECK_OK(reader->ReadTable(table));
 
@@ -0,0 +1,89 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <string>
+#include <vector>
+
+#include "client/client.h"
+#include "io/io/io_driver.h"
+
+#include "io/io/utils.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+/**
+ * Runs the io tasks of the local partitions (`proc_offset`, ...,
+ * `proc_offset + local_num - 1` of `proc_num`) inside a single process, and
+ * reports the resulting streams in the order of partitions.
+ */
+int main(int argc, const char** argv) {
+  if (argc < 7) {
+    printf(
+        "usage ./io_driver <ipc_socket> "
+        "<read_bytes|read_dataframe|read_table|parse_bytes_to_dataframe> "
+        "<location|stream_id> <proc_num> <proc_offset> <local_num>\n");
+    return 1;
+  }
+  std::string ipc_socket = std::string(argv[1]);
+  std::string kind = std::string(argv[2]);
+  std::string source = std::string(argv[3]);
+  int proc_num = std::stoi(argv[4]);
+  int proc_offset = std::stoi(argv[5]);
+  int local_num = std::stoi(argv[6]);
+
+  Client client;
+  CHECK_AND_REPORT(client.Connect(ipc_socket));
+  LOG(INFO) << "Connected to IPCServer: " << ipc_socket;
+
+  IODriver driver(client);
+  std::vector<ObjectID> streams(local_num);
+  for (int index = 0; index < local_num; ++index) {
+    int proc_index = proc_offset + index;
+    Status st;
+    if (kind == "read_bytes") {
+      st = driver.ReadBytes(source, proc_num, proc_index, streams[index]);
+    } else if (kind == "read_dataframe") {
+      st = driver.ReadDataframe(source, proc_num, proc_index, streams[index]);
+    } else if (kind == "read_table") {
+      st = driver.ReadTable(source, proc_num, proc_index, streams[index]);
+    } else if (kind == "parse_bytes_to_dataframe") {
+      st = driver.ParseBytesToDataframe(VYObjectIDFromString(source),
+                                        proc_index, streams[index]);
+    } else {
+      st = Status::Invalid("Unknown io task: " + kind);
+    }
+    CHECK_AND_REPORT(st);
+    if (kind == "read_table") {
+      continue;
+    }
+    LOG(INFO) << "Created stream " << ObjectIDToString(streams[index])
+              << " at " << proc_index << " (of " << proc_num << ")";
+    ReportStatus("return", VYObjectIDToString(streams[index]));
+  }
+
+  auto status = driver.Wait();
+  if (status.ok() && kind == "read_table") {
+    // the tables are sealed once the tasks finish
+    for (auto const& table_id : streams) {
+      ReportStatus("return", VYObjectIDToString(table_id));
+    }
+  }
+  if (status.ok()) {
+    ReportStatus("exit", "");
+  } else {
+    ReportStatus("error", status.ToString());
+  }
+  return 0;
+}
@@ -13,7 +13,9 @@ See the License for the specific language governing permissions and
 limitations under the License.
 */
 
+#include <cstring>
 #include <iostream>
+#include <memory>
 #include <string>
 
 #include "basic/stream/byte_stream.h"
@@ -29,7 +31,7 @@ int main(int argc, char** argv) {
   if (argc < 5) {
     printf(
         "usage ./read_kafka_bytes <ipc_socket> <kafka_address> "
-        "<proc_num> <proc_index>");
+        "<proc_num> <proc_index> [<batch_size> [<linger_ms>]]");
     return 1;
   }
 
@@ -42,6 +44,12 @@ int main(int argc, char** argv) {
       IOFactory::CreateIOAdaptor(kafka_address);
 
   CHECK_AND_REPORT(kafka_io_adaptor->SetPartialRead(proc, pnum));
+  if (argc > 5) {
+    CHECK_AND_REPORT(kafka_io_adaptor->Configure("batch_size", argv[5]));
+  }
+  if (argc > 6) {
+    CHECK_AND_REPORT(kafka_io_adaptor->Configure("linger_ms", argv[6]));
+  }
 
   CHECK_AND_REPORT(kafka_io_adaptor->Open());
 
@@ -56,15 +64,17 @@ int main(int argc, char** argv) {
 
   std::unique_ptr<ByteStreamWriter> writer;
   CHECK_AND_REPORT(bstream->OpenWriter(client, writer));
-  writer->SetBufferSizeLimit(2 * 1024 * 1024);
 
-  std::string line;
-  while (kafka_io_adaptor->ReadLine(line).ok()) {
-    auto st = writer->WriteLine(line + "\n");
+  // each batch of messages goes into a chunk directly
+  std::string lines;
+  while (kafka_io_adaptor->ReadLines(lines).ok()) {
+    std::unique_ptr<arrow::MutableBuffer> buffer;
+    auto st = writer->GetNext(lines.size(), buffer);
     if (!st.ok()) {
       ReportStatus("error", st.ToString());
       CHECK_AND_REPORT(st);
     }
+    memcpy(buffer->mutable_data(), lines.data(), lines.size());
   }
 
   CHECK_AND_REPORT(writer->Finish());
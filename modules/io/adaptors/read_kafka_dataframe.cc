@@ -0,0 +1,153 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+
+#include <iostream>
+#include <memory>
+#include <string>
+
+#include "arrow/api.h"
+#include "arrow/io/api.h"
+#if defined(VINEYARD_WITH_ARROW_JSON)
+#include "arrow/json/api.h"
+#endif
+
+#include "basic/stream/dataframe_stream.h"
+#include "client/client.h"
+#include "io/io/io_factory.h"
+#include "io/io/utils.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+#if defined(VINEYARD_WITH_ARROW_JSON)
+/**
+ * @brief Decodes the batches of JSON messages (one object per message) into
+ * tables directly, without materializing the messages as lines.
+ *
+ * The schema is inferred from the first batch and pinned for the following
+ * batches, thus every chunk of the dataframe stream has the same schema, and
+ * unexpected fields are ignored.
+ */
+class JSONDecoder {
+ public:
+  JSONDecoder()
+      : read_options_(arrow::json::ReadOptions::Defaults()),
+        parse_options_(arrow::json::ParseOptions::Defaults()) {
+    // blocks of a batch are decoded by arrow's thread pool.
+    read_options_.use_threads = true;
+    parse_options_.newlines_in_values = false;
+  }
+
+  Status Decode(const std::string& messages,
+                std::shared_ptr<arrow::Table>& table) {
+    auto buffer = std::make_shared<arrow::Buffer>(
+        reinterpret_cast<const uint8_t*>(messages.data()), messages.size());
+    auto input = std::make_shared<arrow::io::BufferReader>(buffer);
+    std::shared_ptr<arrow::json::TableReader> reader;
+    RETURN_ON_ARROW_ERROR_AND_ASSIGN(
+        reader,
+        arrow::json::TableReader::Make(arrow::default_memory_pool(), input,
+                                       read_options_, parse_options_));
+    RETURN_ON_ARROW_ERROR_AND_ASSIGN(table, reader->Read());
+    if (parse_options_.explicit_schema == nullptr) {
+      parse_options_.explicit_schema = table->schema();
+      parse_options_.unexpected_field_behavior =
+          arrow::json::UnexpectedFieldBehavior::Ignore;
+    }
+    return Status::OK();
+  }
+
+ private:
+  arrow::json::ReadOptions read_options_;
+  arrow::json::ParseOptions parse_options_;
+};
+#else
+class JSONDecoder {
+ public:
+  Status Decode(const std::string& messages,
+                std::shared_ptr<arrow::Table>& table) {
+    return Status::NotImplemented(
+        "Decoding json messages requires arrow's json reader");
+  }
+};
+#endif
+
+int main(int argc, char** argv) {
+  // kafka address format: kafka://brokers/topics/group_id/partition_num
+  if (argc < 6) {
+    printf(
+        "usage ./read_kafka_dataframe <ipc_socket> <kafka_address> "
+        "<proc_num> <proc_index> <format> [<batch_size> [<linger_ms>]]");
+    return 1;
+  }
+
+  std::string ipc_socket = std::string(argv[1]);
+  std::string kafka_address = "kafka://" + std::string(argv[2]);
+  int pnum = std::stoi(argv[3]);
+  int proc = std::stoi(argv[4]);
+  std::string format = std::string(argv[5]);
+
+  if (format != "json") {
+    ReportStatus("error", "Unsupported message format: " + format);
+    return 1;
+  }
+  JSONDecoder decoder;
+
+  std::unique_ptr<IIOAdaptor> kafka_io_adaptor =
+      IOFactory::CreateIOAdaptor(kafka_address);
+
+  CHECK_AND_REPORT(kafka_io_adaptor->SetPartialRead(proc, pnum));
+  if (argc > 6) {
+    CHECK_AND_REPORT(kafka_io_adaptor->Configure("batch_size", argv[6]));
+  }
+  if (argc > 7) {
+    CHECK_AND_REPORT(kafka_io_adaptor->Configure("linger_ms", argv[7]));
+  }
+
+  CHECK_AND_REPORT(kafka_io_adaptor->Open());
+
+  Client client;
+  CHECK_AND_REPORT(client.Connect(ipc_socket));
+  LOG(INFO) << "Connected to IPCServer: " << ipc_socket;
+
+  DataframeStreamBuilder builder(client);
+  builder.SetParam("format", format);
+  auto dfstream =
+      std::dynamic_pointer_cast<DataframeStream>(builder.Seal(client));
+  CHECK_AND_REPORT(client.Persist(dfstream->id()));
+  ReportStatus("return", VYObjectIDToString(dfstream->id()));
+
+  std::unique_ptr<DataframeStreamWriter> writer;
+  CHECK_AND_REPORT(dfstream->OpenWriter(client, writer));
+
+  // each batch of messages is decoded into a chunk of the dataframe stream
+  std::string messages;
+  while (kafka_io_adaptor->ReadLines(messages).ok()) {
+    std::shared_ptr<arrow::Table> table;
+    auto st = decoder.Decode(messages, table);
+    if (st.ok()) {
+      st = writer->WriteTable(table);
+    }
+    if (!st.ok()) {
+      ReportStatus("error", st.ToString());
+      CHECK_AND_REPORT(st);
+    }
+  }
+
+  CHECK_AND_REPORT(writer->Finish());
+  ReportStatus("exit", "");
+
+  return 0;
+}
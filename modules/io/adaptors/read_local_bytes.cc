@@ -13,6 +13,8 @@ See the License for the specific language governing permissions and
 limitations under the License.
 */
 
+#include <cstring>
+#include <memory>
 #include <string>
 
 #include "arrow/table.h"
@@ -20,7 +22,9 @@ limitations under the License.
 #include "basic/stream/parallel_stream.h"
 #include "client/client.h"
 #include "io/io/i_io_adaptor.h"
+#include "io/io/io_driver.h"
 #include "io/io/io_factory.h"
+#include "io/io/local_io_adaptor.h"
 
 #include "io/io/utils.h"
 
@@ -64,13 +68,32 @@ int main(int argc, const char** argv) {
   CHECK_AND_REPORT(lstream->OpenWriter(client, writer));
   writer->SetBufferSizeLimit(2 * 1024 * 1024);
 
-  std::string line;
-  while (local_io_adaptor->ReadLine(line).ok()) {
-    auto st = writer->WriteLine(line);
+  auto block_io_adaptor =
+      dynamic_cast<LocalIOAdaptor*>(local_io_adaptor.get());
+  if (block_io_adaptor != nullptr) {
+    auto st = ReadLineBlocks(
+        block_io_adaptor,
+        [&writer](const std::string& carry, const char* data,
+                  int64_t const size) -> Status {
+          std::unique_ptr<arrow::MutableBuffer> buffer;
+          RETURN_ON_ERROR(writer->GetNext(carry.size() + size, buffer));
+          memcpy(buffer->mutable_data(), carry.data(), carry.size());
+          memcpy(buffer->mutable_data() + carry.size(), data, size);
+          return Status::OK();
+        });
     if (!st.ok()) {
       ReportStatus("error", st.ToString());
       CHECK_AND_REPORT(st);
     }
+  } else {
+    std::string line;
+    while (local_io_adaptor->ReadLine(line).ok()) {
+      auto st = writer->WriteLine(line);
+      if (!st.ok()) {
+        ReportStatus("error", st.ToString());
+        CHECK_AND_REPORT(st);
+      }
+    }
   }
 
   {
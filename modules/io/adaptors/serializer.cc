@@ -19,13 +19,15 @@ limitations under the License.
 #include "common/util/json.h"
 #include "common/util/logging.h"
 #include "common/util/status.h"
+#include "io/io/chunked_blobs.h"
 #include "io/io/utils.h"
 
 using namespace vineyard;  // NOLINT(build/namespaces)
 
 /// Put meta in streams' params,
-/// And put all local blobs into ByteStream.
-Status Serialize(Client& client, ObjectID in_id, ObjectID* stream_id) {
+/// And put all local blobs into ByteStream, in chunks.
+Status Serialize(Client& client, ObjectID in_id,
+                 BlobChunkOptions const& options, ObjectID* stream_id) {
   ObjectMeta meta;
   RETURN_ON_ERROR(client.GetMetaData(in_id, meta, true));
   VLOG(10) << meta.MetaData().dump(4);
@@ -61,6 +63,7 @@ Status Serialize(Client& client, ObjectID in_id, ObjectID* stream_id) {
   }
   builder.SetParam("blobs", json(all_blobs).dump());
   builder.SetParam("blobs_size", json(blobs_size).dump());
+  WriteBlobChunkOptions(options, builder);
 
   *stream_id =
       std::dynamic_pointer_cast<ByteStream>(builder.Seal(client))->id();
@@ -70,13 +73,7 @@ Status Serialize(Client& client, ObjectID in_id, ObjectID* stream_id) {
   std::unique_ptr<ByteStreamWriter> writer;
   RETURN_ON_ERROR(byte_stream->OpenWriter(client, writer));
   // Store blobs
-  for (const auto& blob : blobs) {
-    if (blob->size() > 0) {
-      std::unique_ptr<arrow::MutableBuffer> buffer = nullptr;
-      RETURN_ON_ERROR(writer->GetNext(blob->size(), buffer));
-      memcpy(buffer->mutable_data(), blob->data(), blob->size());
-    }
-  }
+  RETURN_ON_ERROR(WriteBlobChunks(*writer, blobs, options));
   RETURN_ON_ERROR(writer->Finish());
   LOG(INFO) << "Serialized object " << in_id << " to stream " << *stream_id;
   return Status::OK();
@@ -84,19 +81,28 @@ Status Serialize(Client& client, ObjectID in_id, ObjectID* stream_id) {
 
 int main(int argc, const char** argv) {
   if (argc < 3) {
-    printf("usage ./serializer <ipc_socket> <object_id>\n");
+    printf(
+        "usage ./serializer <ipc_socket> <object_id> [<compression> "
+        "[<chunk_size>]]\n");
     return 1;
   }
 
   std::string ipc_socket = std::string(argv[1]);
   ObjectID object_id = VYObjectIDFromString(argv[2]);
+  BlobChunkOptions options;
+  if (argc > 3) {
+    options.compression = std::string(argv[3]);
+  }
+  if (argc > 4) {
+    options.chunk_size = std::stoull(argv[4]);
+  }
 
   Client client;
   VINEYARD_CHECK_OK(client.Connect(ipc_socket));
   LOG(INFO) << "Connected to IPCServer: " << ipc_socket;
 
   ObjectID stream_id;
-  auto st = Serialize(client, object_id, &stream_id);
+  auto st = Serialize(client, object_id, options, &stream_id);
   if (st.ok()) {
     ReportStatus("return", VYObjectIDToString(stream_id));
     ReportStatus("exit", "");
@@ -14,6 +14,7 @@ limitations under the License.
 */
 
 #include <iostream>
+#include <memory>
 #include <string>
 
 #include "basic/stream/byte_stream.h"
@@ -63,10 +64,14 @@ int main(int argc, char** argv) {
   std::unique_ptr<ByteStreamReader> reader;
   CHECK_AND_REPORT(ls->OpenReader(client, reader));
 
-  std::string line;
-  while (reader->ReadLine(line).ok()) {
-    CHECK_AND_REPORT(kafka_io_adaptor->WriteLine(line));
+  // produce the lines of chunks without waiting for the deliveries, and
+  // flush when closing
+  std::unique_ptr<arrow::Buffer> buffer;
+  while (reader->GetNext(buffer).ok()) {
+    CHECK_AND_REPORT(kafka_io_adaptor->WriteLines(
+        reinterpret_cast<const char*>(buffer->data()), buffer->size()));
   }
+  CHECK_AND_REPORT(kafka_io_adaptor->Close());
 
   return 0;
 }
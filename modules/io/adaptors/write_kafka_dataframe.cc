@@ -67,6 +67,7 @@ int main(int argc, char** argv) {
   while (reader->ReadLine(line).ok()) {
     CHECK_AND_REPORT(kafka_io_adaptor->WriteLine(line));
   }
+  CHECK_AND_REPORT(kafka_io_adaptor->Close());
 
   return 0;
 }
@@ -0,0 +1,495 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+
+#include "io/io/async_file_reader.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#include "common/util/logging.h"
+
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#include <sys/syscall.h>
+#if defined(__NR_io_uring_setup) && defined(__NR_io_uring_enter) && \
+    defined(__NR_io_uring_register)
+#define VINEYARD_WITH_IO_URING 1
+#endif
+#endif
+#endif
+
+namespace vineyard {
+
+struct AsyncFileReader::request_t {
+  int64_t offset;
+  char* buffer;
+  size_t size;
+  size_t done = 0;
+  int64_t* nread = nullptr;
+  std::promise<Status> promise;
+  struct iovec iov;
+};
+
+#if defined(VINEYARD_WITH_IO_URING)
+
+struct AsyncFileReader::ring_t {
+  int fd = -1;
+  void* sq_ring = MAP_FAILED;
+  void* cq_ring = MAP_FAILED;
+  void* sqes_ring = MAP_FAILED;
+  size_t sq_ring_size = 0, cq_ring_size = 0, sqes_ring_size = 0;
+
+  unsigned *sq_tail, *sq_mask, *sq_array;
+  unsigned *cq_head, *cq_tail, *cq_mask;
+  io_uring_sqe* sqes;
+  io_uring_cqe* cqes;
+
+  std::vector<std::pair<uintptr_t, size_t>> registered_buffers;
+
+  ~ring_t() {
+    if (sqes_ring != MAP_FAILED) {
+      munmap(sqes_ring, sqes_ring_size);
+    }
+    if (cq_ring != MAP_FAILED && cq_ring != sq_ring) {
+      munmap(cq_ring, cq_ring_size);
+    }
+    if (sq_ring != MAP_FAILED) {
+      munmap(sq_ring, sq_ring_size);
+    }
+    if (fd != -1) {
+      close(fd);
+    }
+  }
+
+  Status Setup(const unsigned entries) {
+    io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    fd = syscall(__NR_io_uring_setup, entries, &params);
+    if (fd < 0) {
+      fd = -1;
+      return Status::IOError(std::string("io_uring is not available: ") +
+                             strerror(errno));
+    }
+    sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    cq_ring_size =
+        params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    bool single_mmap = params.features & IORING_FEAT_SINGLE_MMAP;
+    if (single_mmap) {
+      sq_ring_size = cq_ring_size = std::max(sq_ring_size, cq_ring_size);
+    }
+    sq_ring = mmap(nullptr, sq_ring_size, PROT_READ | PROT_WRITE,
+                   MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+    if (sq_ring == MAP_FAILED) {
+      return Status::IOError("Failed to map the io_uring");
+    }
+    if (single_mmap) {
+      cq_ring = sq_ring;
+    } else {
+      cq_ring = mmap(nullptr, cq_ring_size, PROT_READ | PROT_WRITE,
+                     MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+      if (cq_ring == MAP_FAILED) {
+        return Status::IOError("Failed to map the io_uring");
+      }
+    }
+    sqes_ring_size = params.sq_entries * sizeof(io_uring_sqe);
+    sqes_ring = mmap(nullptr, sqes_ring_size, PROT_READ | PROT_WRITE,
+                     MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+    if (sqes_ring == MAP_FAILED) {
+      return Status::IOError("Failed to map the io_uring");
+    }
+
+    char* sq = static_cast<char*>(sq_ring);
+    char* cq = static_cast<char*>(cq_ring);
+    sq_tail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+    sq_mask = reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+    sq_array = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+    cq_head = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+    cq_tail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+    cq_mask = reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+    sqes = static_cast<io_uring_sqe*>(sqes_ring);
+    cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+    return Status::OK();
+  }
+
+  // returns the index of the registered buffer that covers the range, or -1.
+  int FindRegisteredBuffer(const char* buffer, const size_t size) const {
+    uintptr_t begin = reinterpret_cast<uintptr_t>(buffer);
+    for (size_t i = 0; i < registered_buffers.size(); ++i) {
+      auto const& registered = registered_buffers[i];
+      if (begin >= registered.first &&
+          begin + size <= registered.first + registered.second) {
+        return static_cast<int>(i);
+      }
+    }
+    return -1;
+  }
+
+  // requires the submission lock been held, the request is not submitted if
+  // failed, and is left to the caller.
+  Status Push(const int file, request_t* request) {
+    unsigned tail = *sq_tail;
+    unsigned index = tail & *sq_mask;
+    io_uring_sqe* sqe = &sqes[index];
+    memset(sqe, 0, sizeof(io_uring_sqe));
+    if (request == nullptr) {
+      sqe->opcode = IORING_OP_NOP;
+      sqe->user_data = 0;
+    } else {
+      char* buffer = request->buffer + request->done;
+      size_t size = request->size - request->done;
+      int buffer_index = FindRegisteredBuffer(buffer, size);
+      sqe->fd = file;
+      sqe->off = request->offset + request->done;
+      if (buffer_index != -1) {
+        sqe->opcode = IORING_OP_READ_FIXED;
+        sqe->addr = reinterpret_cast<uint64_t>(buffer);
+        sqe->len = size;
+        sqe->buf_index = buffer_index;
+      } else {
+        request->iov.iov_base = buffer;
+        request->iov.iov_len = size;
+        sqe->opcode = IORING_OP_READV;
+        sqe->addr = reinterpret_cast<uint64_t>(&request->iov);
+        sqe->len = 1;
+      }
+      sqe->user_data = reinterpret_cast<uint64_t>(request);
+    }
+    sq_array[index] = index;
+    __atomic_store_n(sq_tail, tail + 1, __ATOMIC_RELEASE);
+    while (syscall(__NR_io_uring_enter, fd, 1, 0, 0, nullptr, 0) < 0) {
+      if (errno == EINTR || errno == EAGAIN || errno == EBUSY) {
+        continue;
+      }
+      // the entry hasn't been consumed by the kernel, withdraw it
+      int error = errno;
+      __atomic_store_n(sq_tail, tail, __ATOMIC_RELEASE);
+      return Status::IOError(std::string("Failed to submit the read: ") +
+                             strerror(error));
+    }
+    return Status::OK();
+  }
+};
+
+Status AsyncFileReader::setupRing() {
+  ring_t* ring = new ring_t();
+  auto status = ring->Setup(queue_depth_);
+  if (status.ok()) {
+    ring_ = ring;
+  } else {
+    delete ring;
+  }
+  return status;
+}
+
+void AsyncFileReader::closeRing() {
+  delete ring_;
+  ring_ = nullptr;
+}
+
+Status AsyncFileReader::RegisterBuffers(
+    const std::vector<std::pair<void*, size_t>>& buffers) {
+  if (ring_ == nullptr) {
+    return Status::OK();
+  }
+  std::lock_guard<std::mutex> lock(submit_mutex_);
+  if (!ring_->registered_buffers.empty()) {
+    syscall(__NR_io_uring_register, ring_->fd, IORING_UNREGISTER_BUFFERS,
+            nullptr, 0);
+    ring_->registered_buffers.clear();
+  }
+  std::vector<struct iovec> iovecs;
+  for (auto const& buffer : buffers) {
+    iovecs.push_back({buffer.first, buffer.second});
+  }
+  if (syscall(__NR_io_uring_register, ring_->fd, IORING_REGISTER_BUFFERS,
+              iovecs.data(), iovecs.size()) != 0) {
+    return Status::IOError(std::string("Failed to register buffers: ") +
+                           strerror(errno));
+  }
+  for (auto const& buffer : buffers) {
+    ring_->registered_buffers.emplace_back(
+        reinterpret_cast<uintptr_t>(buffer.first), buffer.second);
+  }
+  return Status::OK();
+}
+
+void AsyncFileReader::reap() {
+  while (true) {
+    syscall(__NR_io_uring_enter, ring_->fd, 0, 1, IORING_ENTER_GETEVENTS,
+            nullptr, 0);
+    unsigned head = *ring_->cq_head;
+    unsigned tail = __atomic_load_n(ring_->cq_tail, __ATOMIC_ACQUIRE);
+    bool stopping = false;
+    for (; head != tail; ++head) {
+      io_uring_cqe* cqe = &ring_->cqes[head & *ring_->cq_mask];
+      request_t* request = reinterpret_cast<request_t*>(cqe->user_data);
+      int res = cqe->res;
+      if (request == nullptr) {
+        stopping = true;
+        continue;
+      }
+      if (res == -EINTR || res == -EAGAIN) {
+        resubmit(request);
+      } else if (res < 0) {
+        complete(request, Status::IOError(std::string("Failed to read: ") +
+                                          strerror(-res)));
+      } else {
+        request->done += res;
+        if (res == 0 || request->done == request->size) {
+          complete(request, Status::OK());
+        } else {
+          // short read, continue with the rest
+          resubmit(request);
+        }
+      }
+    }
+    __atomic_store_n(ring_->cq_head, head, __ATOMIC_RELEASE);
+    if (stopping) {
+      break;
+    }
+  }
+}
+
+void AsyncFileReader::stopReaper() {
+  Status status;
+  {
+    std::lock_guard<std::mutex> lock(submit_mutex_);
+    status = ring_->Push(fd_, nullptr);
+  }
+  if (status.ok()) {
+    reaper_.join();
+    return;
+  }
+  // the reaper cannot be woken up anymore, the ring is left to it
+  LOG(ERROR) << "Failed to stop the io_uring reaper: " << status.ToString();
+  reaper_.detach();
+  ring_ = nullptr;
+}
+
+void AsyncFileReader::resubmit(request_t* request) {
+  Status status;
+  {
+    std::lock_guard<std::mutex> lock(submit_mutex_);
+    status = ring_->Push(fd_, request);
+  }
+  // otherwise the read would never be completed and waited forever
+  if (!status.ok()) {
+    complete(request, status);
+  }
+}
+
+void AsyncFileReader::submit(request_t* request) {
+  if (ring_ != nullptr) {
+    resubmit(request);
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(submit_mutex_);
+    pending_.push_back(request);
+  }
+  pending_cv_.notify_one();
+}
+
+#else
+
+struct AsyncFileReader::ring_t {};
+
+Status AsyncFileReader::setupRing() {
+  return Status::NotImplemented("io_uring is not supported");
+}
+
+void AsyncFileReader::closeRing() {}
+
+Status AsyncFileReader::RegisterBuffers(
+    const std::vector<std::pair<void*, size_t>>& buffers) {
+  return Status::OK();
+}
+
+void AsyncFileReader::reap() {}
+
+void AsyncFileReader::stopReaper() {}
+
+void AsyncFileReader::resubmit(request_t* request) { submit(request); }
+
+void AsyncFileReader::submit(request_t* request) {
+  {
+    std::lock_guard<std::mutex> lock(submit_mutex_);
+    pending_.push_back(request);
+  }
+  pending_cv_.notify_one();
+}
+
+#endif
+
+AsyncFileReader::AsyncFileReader(const unsigned queue_depth,
+                                 const bool io_uring)
+    : queue_depth_(std::max(queue_depth, 1u)), io_uring_(io_uring) {}
+
+AsyncFileReader::~AsyncFileReader() { VINEYARD_DISCARD(Close()); }
+
+Status AsyncFileReader::Open(const std::string& path) {
+  RETURN_ON_ASSERT(fd_ == -1, "The file reader has been opened");
+  fd_ = open(path.c_str(), O_RDONLY);
+  if (fd_ == -1) {
+    return Status::IOError("Failed to open '" + path +
+                           "': " + strerror(errno));
+  }
+  stopped_ = false;
+  if (io_uring_ && setupRing().ok()) {
+    reaper_ = std::thread([this]() { this->reap(); });
+  } else {
+    for (unsigned i = 0; i < queue_depth_; ++i) {
+      workers_.emplace_back([this]() { this->serve(); });
+    }
+  }
+  return Status::OK();
+}
+
+Status AsyncFileReader::Close() {
+  if (fd_ == -1) {
+    return Status::OK();
+  }
+  {
+    // wait for the reads in flight
+    std::unique_lock<std::mutex> lock(inflight_mutex_);
+    inflight_cv_.wait(lock, [this]() { return inflight_ == 0; });
+  }
+  if (reaper_.joinable()) {
+    // the nop request stops the reaper
+    stopReaper();
+  }
+  {
+    std::lock_guard<std::mutex> lock(submit_mutex_);
+    stopped_ = true;
+  }
+  pending_cv_.notify_all();
+  for (auto& worker : workers_) {
+    worker.join();
+  }
+  workers_.clear();
+  closeRing();
+  close(fd_);
+  fd_ = -1;
+  return Status::OK();
+}
+
+int64_t AsyncFileReader::Size() const {
+  struct stat st;
+  if (fd_ == -1 || fstat(fd_, &st) != 0) {
+    return -1;
+  }
+  return st.st_size;
+}
+
+std::future<Status> AsyncFileReader::ReadAsync(const int64_t offset,
+                                               void* buffer, const size_t size,
+                                               int64_t* nread) {
+  request_t* request = new request_t();
+  request->offset = offset;
+  request->buffer = static_cast<char*>(buffer);
+  request->size = size;
+  request->nread = nread;
+  auto future = request->promise.get_future();
+  {
+    std::unique_lock<std::mutex> lock(inflight_mutex_);
+    inflight_cv_.wait(lock, [this]() { return inflight_ < queue_depth_; });
+    inflight_ += 1;
+  }
+  if (fd_ == -1) {
+    complete(request, Status::IOError("The file reader hasn't been opened"));
+  } else if (size == 0) {
+    complete(request, Status::OK());
+  } else {
+    submit(request);
+  }
+  return future;
+}
+
+Status AsyncFileReader::ReadBatch(std::vector<read_request_t>& requests) {
+  std::vector<std::future<Status>> futures;
+  futures.reserve(requests.size());
+  for (auto& request : requests) {
+    futures.emplace_back(ReadAsync(request.offset, request.buffer,
+                                   request.size, &request.nread));
+  }
+  Status status;
+  for (auto& future : futures) {
+    auto s = future.get();
+    if (status.ok() && !s.ok()) {
+      status = s;
+    }
+  }
+  return status;
+}
+
+void AsyncFileReader::complete(request_t* request, const Status& status) {
+  if (request->nread != nullptr) {
+    *request->nread = request->done;
+  }
+  request->promise.set_value(status);
+  delete request;
+  {
+    std::lock_guard<std::mutex> lock(inflight_mutex_);
+    inflight_ -= 1;
+  }
+  inflight_cv_.notify_all();
+}
+
+void AsyncFileReader::serve() {
+  while (true) {
+    request_t* request = nullptr;
+    {
+      std::unique_lock<std::mutex> lock(submit_mutex_);
+      pending_cv_.wait(lock,
+                       [this]() { return stopped_ || !pending_.empty(); });
+      if (pending_.empty()) {
+        return;
+      }
+      request = pending_.front();
+      pending_.pop_front();
+    }
+    Status status;
+    while (request->done < request->size) {
+      ssize_t res = pread(fd_, request->buffer + request->done,
+                          request->size - request->done,
+                          request->offset + request->done);
+      if (res < 0) {
+        if (errno == EINTR || errno == EAGAIN) {
+          continue;
+        }
+        status = Status::IOError(std::string("Failed to read: ") +
+                                 strerror(errno));
+        break;
+      }
+      if (res == 0) {
+        break;
+      }
+      request->done += res;
+    }
+    complete(request, status);
+  }
+}
+
+}  // namespace vineyard
@@ -0,0 +1,130 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+
+#ifndef MODULES_IO_IO_ASYNC_FILE_READER_H_
+#define MODULES_IO_IO_ASYNC_FILE_READER_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <future>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "common/util/status.h"
+
+namespace vineyard {
+
+/**
+ * @brief AsyncFileReader issues positional reads of a local file
+ * asynchronously, with at most `queue_depth` reads in flight.
+ *
+ * On Linux the reads are submitted to an io_uring. When io_uring is not
+ * available (e.g., old kernels, or disallowed by seccomp), or `io_uring` is
+ * false, the reads are served by `queue_depth` threads with `pread` instead.
+ */
+class AsyncFileReader {
+ public:
+  struct read_request_t {
+    int64_t offset;
+    void* buffer;
+    size_t size;
+    // the number of bytes been read, less than `size` only at the end of
+    // file.
+    int64_t nread = 0;
+  };
+
+  explicit AsyncFileReader(const unsigned queue_depth = 32,
+                           const bool io_uring = true);
+
+  ~AsyncFileReader();
+
+  Status Open(const std::string& path);
+
+  Status Close();
+
+  int64_t Size() const;
+
+  unsigned QueueDepth() const { return queue_depth_; }
+
+  bool UsingIOUring() const { return ring_ != nullptr; }
+
+  /**
+   * @brief Register the buffers (e.g., the shared memory of vineyard blobs)
+   * that been read into, thus the kernel doesn't need to map the pages for
+   * every read. Reads into other locations are still allowed.
+   */
+  Status RegisterBuffers(const std::vector<std::pair<void*, size_t>>& buffers);
+
+  /**
+   * @brief Read `size` bytes at `offset` into `buffer`, which must be kept
+   * alive until the returned future is ready.
+   *
+   * The call blocks when there are already `queue_depth` reads in flight.
+   *
+   * @param nread The number of bytes been read when the read completes, can
+   * be nullptr.
+   */
+  std::future<Status> ReadAsync(const int64_t offset, void* buffer,
+                                const size_t size, int64_t* nread = nullptr);
+
+  /**
+   * @brief Submit all requests and wait for them, returns the first error.
+   */
+  Status ReadBatch(std::vector<read_request_t>& requests);
+
+ private:
+  struct request_t;
+
+  Status setupRing();
+  void closeRing();
+  void submit(request_t* request);
+  // submits the request to the ring again, e.g., after a short read, and
+  // completes it with the error if the submission fails.
+  void resubmit(request_t* request);
+  void stopReaper();
+  void complete(request_t* request, const Status& status);
+  void reap();
+  void serve();
+
+  const unsigned queue_depth_;
+  const bool io_uring_;
+  int fd_ = -1;
+
+  // io_uring
+  struct ring_t;
+  ring_t* ring_ = nullptr;
+  std::mutex submit_mutex_;
+  std::thread reaper_;
+
+  // the pread fallback
+  std::vector<std::thread> workers_;
+  std::deque<request_t*> pending_;
+  std::condition_variable pending_cv_;
+  bool stopped_ = false;
+
+  std::mutex inflight_mutex_;
+  std::condition_variable inflight_cv_;
+  unsigned inflight_ = 0;
+};
+
+}  // namespace vineyard
+
+#endif  // MODULES_IO_IO_ASYNC_FILE_READER_H_
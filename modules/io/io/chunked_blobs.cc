@@ -0,0 +1,462 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+
+#include "io/io/chunked_blobs.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+#include "arrow/util/compression.h"
+
+#include "common/memory/memcpy.h"
+#include "common/util/logging.h"
+#include "common/util/mpmc_queue.h"
+
+namespace vineyard {
+
+namespace {
+
+struct piece_t {
+  size_t blob;
+  size_t offset;  // in the blob
+  size_t length;
+};
+
+// Locates the pieces of blobs in chunks.
+class ChunkLayout {
+ public:
+  ChunkLayout(std::vector<size_t> const& sizes, const size_t chunk_size)
+      : chunk_size_(std::max<size_t>(chunk_size, 1)),
+        offsets_(sizes.size() + 1, 0) {
+    for (size_t idx = 0; idx < sizes.size(); ++idx) {
+      offsets_[idx + 1] = offsets_[idx] + sizes[idx];
+    }
+  }
+
+  size_t Chunks() const {
+    return (offsets_.back() + chunk_size_ - 1) / chunk_size_;
+  }
+
+  size_t ChunkSize(const size_t chunk) const {
+    return std::min(chunk_size_, offsets_.back() - chunk * chunk_size_);
+  }
+
+  void Pieces(const size_t chunk, std::vector<piece_t>& pieces) const {
+    pieces.clear();
+    size_t begin = chunk * chunk_size_;
+    size_t end = begin + ChunkSize(chunk);
+    size_t blob =
+        std::upper_bound(offsets_.begin(), offsets_.end(), begin) -
+        offsets_.begin() - 1;
+    while (begin < end) {
+      size_t length = std::min(end, offsets_[blob + 1]) - begin;
+      if (length > 0) {
+        pieces.emplace_back(piece_t{blob, begin - offsets_[blob], length});
+      }
+      begin += length;
+      blob += 1;
+    }
+  }
+
+ private:
+  const size_t chunk_size_;
+  std::vector<size_t> offsets_;
+};
+
+static inline uint64_t rotl(const uint64_t value, const int bits) {
+  return (value << bits) | (value >> (64 - bits));
+}
+
+// A xxhash64-alike hash, for detecting corruptions rather than adversaries.
+static uint64_t checksum(const uint8_t* data, const size_t size,
+                         const uint64_t seed) {
+  constexpr uint64_t prime1 = 0x9E3779B185EBCA87ULL;
+  constexpr uint64_t prime2 = 0xC2B2AE3D27D4EB4FULL;
+  uint64_t lanes[4] = {seed + prime1 + prime2, seed + prime2, seed,
+                       seed - prime1};
+  size_t offset = 0;
+  for (; offset + 32 <= size; offset += 32) {
+    for (int k = 0; k < 4; ++k) {
+      uint64_t word;
+      memcpy(&word, data + offset + k * 8, sizeof(uint64_t));
+      lanes[k] = rotl(lanes[k] + word * prime2, 31) * prime1;
+    }
+  }
+  uint64_t hash = rotl(lanes[0], 1) + rotl(lanes[1], 7) + rotl(lanes[2], 12) +
+                  rotl(lanes[3], 18) + size;
+  for (; offset < size; ++offset) {
+    hash = rotl(hash ^ (data[offset] * prime1), 11) * prime2;
+  }
+  hash ^= hash >> 33;
+  hash *= prime2;
+  hash ^= hash >> 29;
+  return hash;
+}
+
+static Status makeCodec(std::string const& name,
+                        std::unique_ptr<arrow::util::Codec>& codec) {
+  arrow::Compression::type type;
+  if (name.empty() || name == "none") {
+    codec = nullptr;
+    return Status::OK();
+  } else if (name == "lz4") {
+    type = arrow::Compression::LZ4_FRAME;
+  } else if (name == "zstd") {
+    type = arrow::Compression::ZSTD;
+  } else {
+    return Status::Invalid("Unsupported compression for serialization: " +
+                           name);
+  }
+#if defined(ARROW_VERSION) && ARROW_VERSION < 17000
+  RETURN_ON_ERROR(Status::ArrowError(arrow::util::Codec::Create(type, &codec)));
+#else
+  auto result = arrow::util::Codec::Create(type);
+  RETURN_ON_ERROR(Status::ArrowError(result.status()));
+  codec = std::move(result).ValueOrDie();
+#endif
+  return Status::OK();
+}
+
+static Status compress(arrow::util::Codec* codec, const uint8_t* data,
+                       const size_t size, std::vector<uint8_t>& output) {
+  output.resize(codec->MaxCompressedLen(size, data));
+  int64_t compressed_size = 0;
+#if defined(ARROW_VERSION) && ARROW_VERSION < 17000
+  RETURN_ON_ERROR(Status::ArrowError(codec->Compress(
+      size, data, output.size(), output.data(), &compressed_size)));
+#else
+  auto result = codec->Compress(size, data, output.size(), output.data());
+  RETURN_ON_ERROR(Status::ArrowError(result.status()));
+  compressed_size = result.ValueOrDie();
+#endif
+  output.resize(compressed_size);
+  return Status::OK();
+}
+
+static Status decompress(arrow::util::Codec* codec, const uint8_t* data,
+                         const size_t size, uint8_t* output,
+                         const size_t output_size) {
+  int64_t decompressed_size = 0;
+#if defined(ARROW_VERSION) && ARROW_VERSION < 17000
+  RETURN_ON_ERROR(Status::ArrowError(codec->Decompress(
+      size, data, output_size, output, &decompressed_size)));
+#else
+  auto result = codec->Decompress(size, data, output_size, output);
+  RETURN_ON_ERROR(Status::ArrowError(result.status()));
+  decompressed_size = result.ValueOrDie();
+#endif
+  RETURN_ON_ASSERT(static_cast<size_t>(decompressed_size) == output_size,
+                   "The decompressed chunk size doesn't match");
+  return Status::OK();
+}
+
+}  // namespace
+
+void WriteBlobChunkOptions(BlobChunkOptions const& options,
+                           ByteStreamBuilder& builder) {
+  builder.SetParam("format", "chunked");
+  builder.SetParam("chunk_size", std::to_string(options.chunk_size));
+  builder.SetParam("compression", options.compression);
+  builder.SetParam("checksum", options.checksum ? "1" : "0");
+}
+
+bool ReadBlobChunkOptions(
+    std::unordered_map<std::string, std::string> const& params,
+    BlobChunkOptions& options) {
+  auto format = params.find("format");
+  if (format == params.end() || format->second != "chunked") {
+    return false;
+  }
+  auto chunk_size = params.find("chunk_size");
+  if (chunk_size != params.end()) {
+    options.chunk_size = std::stoull(chunk_size->second);
+  }
+  auto compression = params.find("compression");
+  if (compression != params.end()) {
+    options.compression = compression->second;
+  }
+  auto checksum = params.find("checksum");
+  options.checksum = checksum != params.end() && checksum->second == "1";
+  return true;
+}
+
+Status WriteBlobChunks(ByteStreamWriter& writer,
+                       std::vector<std::shared_ptr<Blob>> const& blobs,
+                       BlobChunkOptions const& options) {
+  std::vector<const uint8_t*> sources;
+  std::vector<size_t> sizes;
+  for (auto const& blob : blobs) {
+    sources.emplace_back(reinterpret_cast<const uint8_t*>(blob->data()));
+    sizes.emplace_back(blob->size());
+  }
+  ChunkLayout layout(sizes, options.chunk_size);
+  const size_t chunks = layout.Chunks();
+  const size_t concurrency = std::max<size_t>(options.concurrency, 1);
+  // chunks that prepared ahead of the writing
+  const size_t window = concurrency * 2;
+  {
+    std::unique_ptr<arrow::util::Codec> codec;
+    RETURN_ON_ERROR(makeCodec(options.compression, codec));
+  }
+
+  struct prepared_t {
+    bool ready = false;
+    Status status;
+    BlobChunkHeader header;
+    std::vector<uint8_t> payload;  // empty if not compressed
+  };
+  std::vector<prepared_t> prepared(chunks);
+  std::mutex mutex;
+  std::condition_variable cv;
+  std::atomic<size_t> next_chunk(0);
+  size_t written = 0;
+  bool stopped = false;
+
+  auto prepare = [&](arrow::util::Codec* codec, const size_t chunk,
+                     prepared_t& target) -> Status {
+    std::vector<piece_t> pieces;
+    layout.Pieces(chunk, pieces);
+    auto& header = target.header;
+    memset(&header, 0, sizeof(BlobChunkHeader));
+    header.raw_size = layout.ChunkSize(chunk);
+    header.stored_size = header.raw_size;
+    if (options.checksum) {
+      for (auto const& piece : pieces) {
+        header.checksum = checksum(sources[piece.blob] + piece.offset,
+                                   piece.length, header.checksum);
+      }
+    }
+    if (codec == nullptr) {
+      return Status::OK();
+    }
+    std::vector<uint8_t> raw;
+    const uint8_t* data = nullptr;
+    if (pieces.size() == 1) {
+      data = sources[pieces[0].blob] + pieces[0].offset;
+    } else {
+      raw.resize(header.raw_size);
+      size_t offset = 0;
+      for (auto const& piece : pieces) {
+        memcpy(raw.data() + offset, sources[piece.blob] + piece.offset,
+               piece.length);
+        offset += piece.length;
+      }
+      data = raw.data();
+    }
+    RETURN_ON_ERROR(compress(codec, data, header.raw_size, target.payload));
+    if (target.payload.size() < header.raw_size) {
+      header.compressed = 1;
+      header.stored_size = target.payload.size();
+    } else {
+      // incompressible, store the raw bytes
+      target.payload.clear();
+      target.payload.shrink_to_fit();
+    }
+    return Status::OK();
+  };
+
+  std::vector<std::thread> workers;
+  for (size_t idx = 0; idx < std::min(concurrency, chunks); ++idx) {
+    workers.emplace_back([&]() {
+      std::unique_ptr<arrow::util::Codec> codec;
+      VINEYARD_DISCARD(makeCodec(options.compression, codec));
+      while (true) {
+        size_t chunk = next_chunk.fetch_add(1);
+        if (chunk >= chunks) {
+          return;
+        }
+        {
+          std::unique_lock<std::mutex> lock(mutex);
+          cv.wait(lock,
+                  [&]() { return stopped || chunk < written + window; });
+          if (stopped) {
+            return;
+          }
+        }
+        auto status = prepare(codec.get(), chunk, prepared[chunk]);
+        {
+          std::lock_guard<std::mutex> lock(mutex);
+          prepared[chunk].status = status;
+          prepared[chunk].ready = true;
+        }
+        cv.notify_all();
+      }
+    });
+  }
+
+  Status status;
+  for (size_t chunk = 0; chunk < chunks && status.ok(); ++chunk) {
+    auto& target = prepared[chunk];
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      cv.wait(lock, [&]() { return target.ready; });
+    }
+    status = target.status;
+    std::unique_ptr<arrow::MutableBuffer> buffer = nullptr;
+    if (status.ok()) {
+      status = writer.GetNext(
+          sizeof(BlobChunkHeader) + target.header.stored_size, buffer);
+    }
+    if (status.ok()) {
+      uint8_t* pointer = buffer->mutable_data();
+      memcpy(pointer, &target.header, sizeof(BlobChunkHeader));
+      pointer += sizeof(BlobChunkHeader);
+      if (target.header.compressed) {
+        memory::concurrent_memcpy(pointer, target.payload.data(),
+                                  target.payload.size());
+      } else {
+        std::vector<piece_t> pieces;
+        layout.Pieces(chunk, pieces);
+        for (auto const& piece : pieces) {
+          memory::concurrent_memcpy(pointer, sources[piece.blob] + piece.offset,
+                                    piece.length);
+          pointer += piece.length;
+        }
+      }
+    }
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      std::vector<uint8_t>().swap(target.payload);
+      written += 1;
+      stopped = !status.ok();
+    }
+    cv.notify_all();
+  }
+  for (auto& worker : workers) {
+    worker.join();
+  }
+  return status;
+}
+
+Status ReadBlobChunks(ByteStreamReader& reader,
+                      std::vector<uint8_t*> const& targets,
+                      std::vector<size_t> const& sizes,
+                      BlobChunkOptions const& options) {
+  ChunkLayout layout(sizes, options.chunk_size);
+  const size_t chunks = layout.Chunks();
+  const size_t concurrency = std::max<size_t>(options.concurrency, 1);
+  {
+    std::unique_ptr<arrow::util::Codec> codec;
+    RETURN_ON_ERROR(makeCodec(options.compression, codec));
+  }
+
+  using chunk_t = std::pair<size_t, std::shared_ptr<arrow::Buffer>>;
+  PCMPMCQueue<chunk_t> queue;
+  queue.SetLimit(concurrency * 2);
+  queue.SetProducerNum(1);
+
+  std::mutex mutex;
+  Status status;
+  std::atomic_bool failed(false);
+
+  auto process = [&](arrow::util::Codec* codec, const size_t chunk,
+                     std::shared_ptr<arrow::Buffer> const& buffer) -> Status {
+    RETURN_ON_ASSERT(static_cast<size_t>(buffer->size()) >=
+                         sizeof(BlobChunkHeader),
+                     "Invalid chunk in the serialized stream");
+    BlobChunkHeader header;
+    memcpy(&header, buffer->data(), sizeof(BlobChunkHeader));
+    const uint8_t* payload = buffer->data() + sizeof(BlobChunkHeader);
+    RETURN_ON_ASSERT(header.raw_size == layout.ChunkSize(chunk) &&
+                         sizeof(BlobChunkHeader) + header.stored_size ==
+                             static_cast<size_t>(buffer->size()),
+                     "The chunk " + std::to_string(chunk) +
+                         " doesn't match the size of blobs");
+    std::vector<piece_t> pieces;
+    layout.Pieces(chunk, pieces);
+    if (header.compressed) {
+      RETURN_ON_ASSERT(codec != nullptr,
+                       "The chunk is compressed but no codec is specified");
+      if (pieces.size() == 1) {
+        RETURN_ON_ERROR(decompress(codec, payload, header.stored_size,
+                                   targets[pieces[0].blob] + pieces[0].offset,
+                                   pieces[0].length));
+      } else {
+        std::vector<uint8_t> raw(header.raw_size);
+        RETURN_ON_ERROR(decompress(codec, payload, header.stored_size,
+                                   raw.data(), raw.size()));
+        size_t offset = 0;
+        for (auto const& piece : pieces) {
+          memcpy(targets[piece.blob] + piece.offset, raw.data() + offset,
+                 piece.length);
+          offset += piece.length;
+        }
+      }
+    } else {
+      for (auto const& piece : pieces) {
+        memory::concurrent_memcpy(targets[piece.blob] + piece.offset,
+                                  payload, piece.length);
+        payload += piece.length;
+      }
+    }
+    if (options.checksum) {
+      uint64_t hash = 0;
+      for (auto const& piece : pieces) {
+        hash = checksum(targets[piece.blob] + piece.offset, piece.length,
+                        hash);
+      }
+      RETURN_ON_ASSERT(hash == header.checksum,
+                       "Checksum mismatch of the chunk " +
+                           std::to_string(chunk));
+    }
+    return Status::OK();
+  };
+
+  std::vector<std::thread> workers;
+  for (size_t idx = 0; idx < std::min(concurrency, chunks); ++idx) {
+    workers.emplace_back([&]() {
+      std::unique_ptr<arrow::util::Codec> codec;
+      VINEYARD_DISCARD(makeCodec(options.compression, codec));
+      chunk_t chunk;
+      while (queue.Get(chunk)) {
+        if (failed.load()) {
+          continue;  // drains the queue
+        }
+        auto s = process(codec.get(), chunk.first, chunk.second);
+        if (!s.ok()) {
+          std::lock_guard<std::mutex> lock(mutex);
+          if (status.ok()) {
+            status = s;
+          }
+          failed.store(true);
+        }
+      }
+    });
+  }
+
+  Status read_status;
+  for (size_t chunk = 0; chunk < chunks && !failed.load(); ++chunk) {
+    std::unique_ptr<arrow::Buffer> buffer = nullptr;
+    read_status = reader.GetNext(buffer);
+    if (!read_status.ok()) {
+      break;
+    }
+    queue.Put(chunk_t(chunk, std::shared_ptr<arrow::Buffer>(buffer.release())));
+  }
+  queue.DecProducerNum();
+  for (auto& worker : workers) {
+    worker.join();
+  }
+  RETURN_ON_ERROR(read_status);
+  return status;
+}
+
+}  // namespace vineyard
@@ -0,0 +1,90 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+
+#ifndef MODULES_IO_IO_CHUNKED_BLOBS_H_
+#define MODULES_IO_IO_CHUNKED_BLOBS_H_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "basic/stream/byte_stream.h"
+#include "common/util/status.h"
+
+namespace vineyard {
+
+/**
+ * @brief The frame of a chunk in the serialized byte stream, followed by the
+ * (optionally compressed) payload.
+ */
+struct BlobChunkHeader {
+  uint64_t raw_size;     // bytes of the blobs in this chunk
+  uint64_t stored_size;  // bytes of the payload that follows
+  uint64_t checksum;     // of the raw bytes, 0 if the checksum is disabled
+  uint32_t compressed;
+  uint32_t reserved;
+};
+
+struct BlobChunkOptions {
+  size_t chunk_size = 64UL * 1024 * 1024;
+  // "none", "lz4" or "zstd"
+  std::string compression = "none";
+  bool checksum = true;
+  size_t concurrency = 4;
+};
+
+/**
+ * @brief Record the options in the params of the stream, the deserializer
+ * recovers them by `ReadBlobChunkOptions`.
+ */
+void WriteBlobChunkOptions(BlobChunkOptions const& options,
+                           ByteStreamBuilder& builder);
+
+/**
+ * @brief Returns false if the stream is not in the chunked format, i.e., it
+ * is serialized by a legacy serializer where each blob takes one chunk.
+ */
+bool ReadBlobChunkOptions(
+    std::unordered_map<std::string, std::string> const& params,
+    BlobChunkOptions& options);
+
+/**
+ * @brief Write the blobs to the stream in the chunked format: the blobs are
+ * concatenated and cut into chunks of `chunk_size` bytes, i.e., large blobs
+ * span many chunks and small blobs are packed together.
+ *
+ * The chunks are compressed and checksummed by a pool of threads ahead of
+ * the writing, which happens in order.
+ */
+Status WriteBlobChunks(ByteStreamWriter& writer,
+                       std::vector<std::shared_ptr<Blob>> const& blobs,
+                       BlobChunkOptions const& options);
+
+/**
+ * @brief Read the chunks back into the destination blobs, which must have
+ * been allocated with the sizes of the serialized blobs. The chunks are
+ * verified, decompressed and copied by a pool of threads.
+ */
+Status ReadBlobChunks(ByteStreamReader& reader,
+                      std::vector<uint8_t*> const& targets,
+                      std::vector<size_t> const& sizes,
+                      BlobChunkOptions const& options);
+
+}  // namespace vineyard
+
+#endif  // MODULES_IO_IO_CHUNKED_BLOBS_H_
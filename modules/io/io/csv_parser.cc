@@ -0,0 +1,277 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "io/io/csv_parser.h"
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "arrow/io/api.h"
+#include "arrow/util/config.h"
+
+#include "boost/algorithm/string.hpp"
+
+#include "basic/ds/arrow_utils.h"
+#include "common/util/logging.h"
+
+namespace vineyard {
+
+Status MakeCSVOptions(CSVOptions& options, char delimiter, bool header_row,
+                      std::vector<std::string> columns,
+                      std::vector<std::string> column_types,
+                      std::vector<std::string> original_columns,
+                      bool include_all_columns) {
+  auto& read_options = options.read_options;
+  auto& parse_options = options.parse_options;
+  auto& convert_options = options.convert_options;
+
+  read_options.column_names = original_columns;
+  // blocks of a chunk are parsed by arrow's thread pool.
+  read_options.use_threads = true;
+  parse_options.delimiter = delimiter;
+
+  auto is_number = [](const std::string& s) -> bool {
+    return !s.empty() && std::find_if(s.begin(), s.end(), [](unsigned char c) {
+                           return !std::isdigit(c);
+                         }) == s.end();
+  };
+
+  std::vector<int> indices;
+  for (size_t i = 0; i < columns.size(); ++i) {
+    if (is_number(columns[i])) {
+      int col_idx = std::stoi(columns[i]);
+      if (col_idx >= static_cast<int>(original_columns.size())) {
+        return Status(StatusCode::kArrowError,
+                      "Index out of range: " + columns[i]);
+      }
+      indices.push_back(col_idx);
+      columns[i] = original_columns[col_idx];
+    }
+  }
+
+  // If include_all_columns_ is set, push other names as well
+  if (include_all_columns) {
+    for (const auto& col : original_columns) {
+      if (std::find(std::begin(columns), std::end(columns), col) ==
+          columns.end()) {
+        columns.push_back(col);
+      }
+    }
+  }
+
+  convert_options.include_columns = columns;
+
+  if (column_types.size() > convert_options.include_columns.size()) {
+    return Status(StatusCode::kArrowError,
+                  "Format of column type schema is incorrect.");
+  }
+  std::unordered_map<std::string, std::shared_ptr<arrow::DataType>>
+      arrow_column_types;
+
+  for (size_t i = 0; i < column_types.size(); ++i) {
+    if (!column_types[i].empty()) {
+      arrow_column_types[convert_options.include_columns[i]] =
+          type_name_to_arrow_type(column_types[i]);
+    }
+  }
+  convert_options.column_types = arrow_column_types;
+  return Status::OK();
+}
+
+Status MakeCSVOptions(CSVOptions& options,
+                      std::unordered_map<std::string, std::string>& params) {
+  bool header_row = (params["header_row"] == "1");
+  std::string delimiter = params["delimiter"];
+  if (delimiter.empty()) {
+    delimiter = ",";
+  }
+  std::vector<std::string> columns;
+  std::vector<std::string> column_types;
+  std::vector<std::string> original_columns;
+  std::string header_line;
+
+  if (header_row) {
+    header_line = params["header_line"];
+    if (header_line.empty()) {
+      return Status::Invalid(
+          "Header line not found while header_row is set to True");
+    }
+    ::boost::algorithm::trim(header_line);
+    ::boost::split(original_columns, header_line,
+                   ::boost::is_any_of(delimiter.substr(0, 1)));
+  } else {
+    // Name columns as f0 ... fn
+    std::string one_line = params["header_line"];
+    ::boost::algorithm::trim(one_line);
+    std::vector<std::string> one_column;
+    ::boost::split(one_column, one_line,
+                   ::boost::is_any_of(delimiter.substr(0, 1)));
+    for (size_t i = 0; i < one_column.size(); ++i) {
+      original_columns.push_back("f" + std::to_string(i));
+    }
+  }
+
+  if (params.find("schema") != params.end()) {
+    VLOG(2) << "param schema: " << params["schema"];
+    ::boost::split(columns, params["schema"], ::boost::is_any_of(","));
+  }
+  if (params.find("column_types") != params.end()) {
+    VLOG(2) << "param column_types: " << params["column_types"];
+    ::boost::split(column_types, params["column_types"],
+                   ::boost::is_any_of(","));
+  }
+  bool include_all_columns = false;
+  if (params.find("include_all_columns") != params.end()) {
+    VLOG(2) << "param include_all_columns: " << params["include_all_columns"];
+    include_all_columns = (params["include_all_columns"] == "1");
+  }
+  return MakeCSVOptions(options, delimiter[0], header_row, columns,
+                        column_types, original_columns, include_all_columns);
+}
+
+void FixColumnTypes(CSVOptions& options,
+                    const std::shared_ptr<arrow::Schema>& schema) {
+  for (auto const& field : schema->fields()) {
+    if (field->type()->id() != arrow::Type::NA) {
+      options.convert_options.column_types.emplace(field->name(),
+                                                   field->type());
+    }
+  }
+}
+
+Status ParseTable(std::shared_ptr<arrow::Table>* table,
+                  const std::shared_ptr<arrow::Buffer>& buffer,
+                  const CSVOptions& options, arrow::MemoryPool* pool) {
+  auto buffer_reader = std::make_shared<arrow::io::BufferReader>(buffer);
+
+  std::shared_ptr<arrow::io::InputStream> input =
+      arrow::io::RandomAccessFile::GetStream(buffer_reader, 0, buffer->size());
+
+  if (pool == nullptr) {
+    pool = arrow::default_memory_pool();
+  }
+
+  std::shared_ptr<arrow::csv::TableReader> reader;
+#if defined(ARROW_VERSION) && ARROW_VERSION >= 4000000
+  RETURN_ON_ARROW_ERROR_AND_ASSIGN(
+      reader, arrow::csv::TableReader::Make(
+                  arrow::io::AsyncContext(pool), input, options.read_options,
+                  options.parse_options, options.convert_options));
+#else
+  RETURN_ON_ARROW_ERROR_AND_ASSIGN(
+      reader, arrow::csv::TableReader::Make(pool, input, options.read_options,
+                                            options.parse_options,
+                                            options.convert_options));
+#endif
+
+  auto result = reader->Read();
+  if (!result.status().ok()) {
+    if (result.status().message() == "Empty CSV file") {
+      *table = nullptr;
+      return Status::OK();
+    } else {
+      return Status::ArrowError(result.status());
+    }
+  }
+  *table = result.ValueOrDie();
+
+  RETURN_ON_ARROW_ERROR((*table)->Validate());
+
+  VLOG(2) << "Parsed: " << (*table)->num_rows() << " rows, "
+          << (*table)->num_columns() << " columns";
+  VLOG(2) << (*table)->schema()->ToString();
+  return Status::OK();
+}
+
+Status RecordSplitter::Next(const std::unique_ptr<arrow::Buffer>& buffer,
+                            std::shared_ptr<arrow::Buffer>& chunk) {
+  const char* data = reinterpret_cast<const char*>(buffer->data());
+  int64_t size = buffer->size();
+  int64_t end = size;
+  while (end > 0 && data[end - 1] != '\n') {
+    --end;
+  }
+  arrow::BufferBuilder builder;
+  RETURN_ON_ARROW_ERROR(builder.Reserve(carry_.size() + end));
+  RETURN_ON_ARROW_ERROR(builder.Append(carry_.data(), carry_.size()));
+  RETURN_ON_ARROW_ERROR(builder.Append(data, end));
+  RETURN_ON_ARROW_ERROR(builder.Finish(&chunk));
+  carry_.assign(data + end, size - end);
+  return Status::OK();
+}
+
+Status RecordSplitter::Finish(std::shared_ptr<arrow::Buffer>& chunk) {
+  arrow::BufferBuilder builder;
+  RETURN_ON_ARROW_ERROR(builder.Append(carry_.data(), carry_.size()));
+  RETURN_ON_ARROW_ERROR(builder.Finish(&chunk));
+  carry_.clear();
+  return Status::OK();
+}
+
+Status CSVTableWriter::Write(const std::shared_ptr<arrow::Buffer>& chunk) {
+  if (chunk->size() == 0) {
+    return Status::OK();
+  }
+  if (!schema_fixed_) {
+    // the first chunk is parsed in place to infer the schema
+    std::shared_ptr<arrow::Table> table;
+    RETURN_ON_ERROR(ParseTable(&table, chunk, options_, pool_));
+    if (table == nullptr) {
+      return Status::OK();
+    }
+    FixColumnTypes(options_, table->schema());
+    schema_fixed_ = true;
+    return sink_(table);
+  }
+  auto parsed = std::make_shared<parsed_t>();
+  parsed_t* target = parsed.get();
+  CSVOptions const& options = options_;
+  arrow::MemoryPool* pool = pool_;
+  parsed->status =
+      std::async(std::launch::async, [chunk, options, pool, target]() {
+        return ParseTable(&target->table, chunk, options, pool);
+      });
+  parsing_.emplace_back(parsed);
+  while (parsing_.size() > concurrency_) {
+    RETURN_ON_ERROR(writeFront());
+  }
+  return Status::OK();
+}
+
+Status CSVTableWriter::Flush() {
+  auto status = Status::OK();
+  while (!parsing_.empty()) {
+    auto s = writeFront();
+    if (status.ok() && !s.ok()) {
+      status = s;
+    }
+  }
+  return status;
+}
+
+Status CSVTableWriter::writeFront() {
+  auto parsed = parsing_.front();
+  parsing_.pop_front();
+  RETURN_ON_ERROR(parsed->status.get());
+  if (parsed->table == nullptr) {
+    return Status::OK();
+  }
+  return sink_(parsed->table);
+}
+
+}  // namespace vineyard
@@ -0,0 +1,146 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef MODULES_IO_IO_CSV_PARSER_H_
+#define MODULES_IO_IO_CSV_PARSER_H_
+
+#include <algorithm>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "arrow/api.h"
+#include "arrow/csv/api.h"
+
+#include "basic/stream/dataframe_stream.h"
+#include "common/util/status.h"
+
+namespace vineyard {
+
+struct CSVOptions {
+  arrow::csv::ReadOptions read_options = arrow::csv::ReadOptions::Defaults();
+  arrow::csv::ParseOptions parse_options =
+      arrow::csv::ParseOptions::Defaults();
+  arrow::csv::ConvertOptions convert_options =
+      arrow::csv::ConvertOptions::Defaults();
+};
+
+// resolves the columns and column types once, rather than for every chunk.
+Status MakeCSVOptions(CSVOptions& options, char delimiter, bool header_row,
+                      std::vector<std::string> columns,
+                      std::vector<std::string> column_types,
+                      std::vector<std::string> original_columns,
+                      bool include_all_columns);
+
+/**
+ * @brief Resolves the options from the params of byte streams (or the meta
+ * of io adaptors), i.e., "header_row", "header_line", "delimiter", "schema",
+ * "column_types" and "include_all_columns".
+ */
+Status MakeCSVOptions(CSVOptions& options,
+                      std::unordered_map<std::string, std::string>& params);
+
+// pins the column types to the ones inferred from the first chunk, thus the
+// following chunks skip the inference and yield the same schema.
+void FixColumnTypes(CSVOptions& options,
+                    const std::shared_ptr<arrow::Schema>& schema);
+
+// the columns are allocated from `pool`, or the default pool of arrow if
+// it's nullptr.
+Status ParseTable(std::shared_ptr<arrow::Table>* table,
+                  const std::shared_ptr<arrow::Buffer>& buffer,
+                  const CSVOptions& options,
+                  arrow::MemoryPool* pool = nullptr);
+
+/**
+ * @brief Cuts the chunks of the byte stream at the last line break, the
+ * trailing partial record is carried over to the next chunk.
+ *
+ * The chunks are copied out of the stream anyway, as they are released once
+ * been consumed.
+ */
+class RecordSplitter {
+ public:
+  Status Next(const std::unique_ptr<arrow::Buffer>& buffer,
+              std::shared_ptr<arrow::Buffer>& chunk);
+
+  Status Finish(std::shared_ptr<arrow::Buffer>& chunk);
+
+ private:
+  std::string carry_;
+};
+
+using table_sink_t =
+    std::function<Status(const std::shared_ptr<arrow::Table>& table)>;
+
+/**
+ * @brief Parses the chunks (that end at line breaks) with at most
+ * `concurrency` chunks in flight, and writes the tables to the dataframe
+ * stream (or the `sink`) in order.
+ *
+ * The first chunk is parsed in place to infer the schema, which is pinned
+ * for the following chunks.
+ */
+class CSVTableWriter {
+ public:
+  CSVTableWriter(CSVOptions const& options, DataframeStreamWriter* writer,
+                 size_t const concurrency)
+      : CSVTableWriter(
+            options,
+            [writer](const std::shared_ptr<arrow::Table>& table) {
+              return writer->WriteTable(table);
+            },
+            concurrency) {}
+
+  /**
+   * @param pool The pool that the columns are allocated from, e.g., a
+   * vineyard memory pool, thus the tables could be sealed without copying.
+   */
+  CSVTableWriter(CSVOptions const& options, table_sink_t sink,
+                 size_t const concurrency, arrow::MemoryPool* pool = nullptr)
+      : options_(options),
+        sink_(std::move(sink)),
+        concurrency_(std::max<size_t>(concurrency, 1)),
+        pool_(pool) {}
+
+  Status Write(const std::shared_ptr<arrow::Buffer>& chunk);
+
+  // waits for the chunks in flight, the dataframe stream is not finished
+  Status Flush();
+
+ private:
+  Status writeFront();
+
+  struct parsed_t {
+    std::future<Status> status;
+    std::shared_ptr<arrow::Table> table;
+  };
+
+  CSVOptions options_;
+  table_sink_t sink_;
+  size_t concurrency_;
+  arrow::MemoryPool* pool_;
+  bool schema_fixed_ = false;
+  std::deque<std::shared_ptr<parsed_t>> parsing_;
+};
+
+}  // namespace vineyard
+
+#endif  // MODULES_IO_IO_CSV_PARSER_H_
@@ -16,6 +16,8 @@ limitations under the License.
 #ifndef MODULES_IO_IO_I_IO_ADAPTOR_H_
 #define MODULES_IO_IO_I_IO_ADAPTOR_H_
 
+#include <algorithm>
+#include <future>
 #include <memory>
 #include <string>
 #include <unordered_map>
@@ -70,9 +72,51 @@ class IIOAdaptor {
   virtual Status ReadLine(std::string& line) = 0;
   virtual Status WriteLine(const std::string& line) = 0;
 
+  /**
+   * Read a batch of lines at once, each of them is followed by a '\n'.
+   * Adaptors that read in batches (e.g., kafka) override it to avoid the
+   * per-line overhead.
+   */
+  virtual Status ReadLines(std::string& lines) {
+    std::string line;
+    RETURN_ON_ERROR(ReadLine(line));
+    lines = line + "\n";
+    return Status::OK();
+  }
+
+  /**
+   * Write each '\n'-delimited line in the buffer, see also `ReadLines`.
+   */
+  virtual Status WriteLines(const char* buffer, size_t size) {
+    const char* end = buffer + size;
+    while (buffer < end) {
+      const char* line_end = std::find(buffer, end, '\n');
+      if (line_end != buffer) {
+        RETURN_ON_ERROR(WriteLine(std::string(buffer, line_end - buffer)));
+      }
+      buffer = line_end + 1;
+    }
+    return Status::OK();
+  }
+
   virtual Status Read(void* buffer, size_t size) = 0;
   virtual Status Write(void* buffer, size_t size) = 0;
 
+  /**
+   * Read `size` bytes at `offset` without blocking the caller, the `buffer`
+   * must be kept alive until the returned future is ready, and `nread`
+   * (can be nullptr) receives the number of bytes been read.
+   *
+   * Adaptors that don't support asynchronous reads return
+   * `Status::NotImplemented`.
+   */
+  virtual std::future<Status> ReadAsync(int64_t offset, void* buffer,
+                                        size_t size, int64_t* nread) {
+    std::promise<Status> promise;
+    promise.set_value(Status::NotImplemented("Asynchronous read"));
+    return promise.get_future();
+  }
+
   virtual Status Flush() { return Status::OK(); }
 
   virtual Status ReadTable(std::shared_ptr<arrow::Table>* table) {
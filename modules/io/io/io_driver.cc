@@ -0,0 +1,493 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "io/io/io_driver.h"
+
+#include <algorithm>
+#include <cstring>
+#include <deque>
+#include <future>
+#include <memory>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+
+#include "arrow/buffer.h"
+#include "arrow/buffer_builder.h"
+#include "arrow/table.h"
+
+#include "basic/ds/arrow.h"
+#include "basic/ds/arrow_memory_pool.h"
+#include "basic/stream/byte_stream.h"
+#include "basic/stream/dataframe_stream.h"
+#include "basic/stream/parallel_stream.h"
+#include "common/util/logging.h"
+#include "io/io/csv_parser.h"
+#include "io/io/io_factory.h"
+
+namespace vineyard {
+
+// the size of blocks that are read from the file, the blocks are aligned to
+// the block size in the file.
+constexpr int64_t kReadBlockSize = 8 * 1024 * 1024;
+
+// the size of chunks that are cut from the lines of non-local adaptors
+constexpr size_t kLineChunkSize = 2 * 1024 * 1024;
+
+Status ReadLineBlocks(LocalIOAdaptor* adaptor, line_block_sink_t const& sink) {
+  int64_t offset = 0, nbytes = 0;
+  RETURN_ON_ERROR(adaptor->GetPartialReadDetail(offset, nbytes));
+  int64_t end = offset + nbytes;
+  const size_t depth = std::max(1u, adaptor->ReadDepth());
+
+  struct block_t {
+    std::unique_ptr<char[]> data;
+    int64_t size = 0, nread = 0;
+    std::future<Status> status;
+  };
+  std::deque<std::unique_ptr<block_t>> reading;
+  int64_t position = offset;
+  auto submit = [&]() {
+    while (reading.size() < depth && position < end) {
+      std::unique_ptr<block_t> block(new block_t());
+      block->size = std::min(kReadBlockSize - position % kReadBlockSize,
+                             end - position);
+      block->data.reset(new char[block->size]);
+      block->status = adaptor->ReadAsync(position, block->data.get(),
+                                         block->size, &block->nread);
+      position += block->size;
+      reading.emplace_back(std::move(block));
+    }
+  };
+
+  // the partial line at the end of the last block
+  std::string carry;
+  auto consume = [&](block_t* block) -> Status {
+    RETURN_ON_ERROR(block->status.get());
+    const char* data = block->data.get();
+    int64_t size = block->nread;
+    // stops at the end of file
+    bool last = size < block->size || (reading.empty() && position >= end);
+    if (last) {
+      position = end;
+    } else {
+      submit();
+    }
+
+    int64_t cut = size;
+    if (!last) {
+      while (cut > 0 && data[cut - 1] != '\n') {
+        --cut;
+      }
+    }
+    size_t chunk_size = carry.size() + cut;
+    if (chunk_size > 0 && (cut > 0 || last)) {
+      RETURN_ON_ERROR(sink(carry, data, cut));
+      carry.clear();
+    }
+    carry.append(data + cut, size - cut);
+    return Status::OK();
+  };
+
+  submit();
+  Status status;
+  while (status.ok() && !reading.empty()) {
+    auto block = std::move(reading.front());
+    reading.pop_front();
+    status = consume(block.get());
+    if (position >= end && block->nread < block->size) {
+      break;
+    }
+  }
+  // the buffers must outlive the reads in flight
+  for (auto& block : reading) {
+    if (block->status.valid()) {
+      block->status.wait();
+    }
+  }
+  return status;
+}
+
+namespace detail {
+
+template <typename Writer>
+static Status FinishStream(Status const& status, Writer* writer) {
+  if (status.ok()) {
+    return writer->Finish();
+  }
+  VINEYARD_DISCARD(writer->Abort());
+  return status;
+}
+
+static Status ReadBytes(IIOAdaptor* adaptor, ByteStreamWriter* writer) {
+  auto block_adaptor = dynamic_cast<LocalIOAdaptor*>(adaptor);
+  if (block_adaptor != nullptr) {
+    return ReadLineBlocks(
+        block_adaptor,
+        [writer](const std::string& carry, const char* data,
+                 int64_t const size) -> Status {
+          std::unique_ptr<arrow::MutableBuffer> buffer;
+          RETURN_ON_ERROR(writer->GetNext(carry.size() + size, buffer));
+          memcpy(buffer->mutable_data(), carry.data(), carry.size());
+          memcpy(buffer->mutable_data() + carry.size(), data, size);
+          return Status::OK();
+        });
+  }
+  std::string line;
+  while (adaptor->ReadLine(line).ok()) {
+    RETURN_ON_ERROR(writer->WriteLine(line));
+  }
+  return Status::OK();
+}
+
+static Status ReadDataframe(IIOAdaptor* adaptor, CSVTableWriter* writer) {
+  auto block_adaptor = dynamic_cast<LocalIOAdaptor*>(adaptor);
+  if (block_adaptor != nullptr) {
+    RETURN_ON_ERROR(ReadLineBlocks(
+        block_adaptor,
+        [writer](const std::string& carry, const char* data,
+                 int64_t const size) -> Status {
+          arrow::BufferBuilder builder;
+          std::shared_ptr<arrow::Buffer> chunk;
+          RETURN_ON_ARROW_ERROR(builder.Reserve(carry.size() + size));
+          RETURN_ON_ARROW_ERROR(builder.Append(carry.data(), carry.size()));
+          RETURN_ON_ARROW_ERROR(builder.Append(data, size));
+          RETURN_ON_ARROW_ERROR(builder.Finish(&chunk));
+          return writer->Write(chunk);
+        }));
+  } else {
+    std::string lines, line;
+    while (adaptor->ReadLine(line).ok()) {
+      lines.append(line);
+      if (!line.empty() && line.back() != '\n') {
+        lines.push_back('\n');
+      }
+      if (lines.size() >= kLineChunkSize) {
+        RETURN_ON_ERROR(writer->Write(arrow::Buffer::FromString(lines)));
+        lines.clear();
+      }
+    }
+    if (!lines.empty()) {
+      RETURN_ON_ERROR(writer->Write(arrow::Buffer::FromString(lines)));
+    }
+  }
+  return writer->Flush();
+}
+
+static Status ParseBytes(ByteStreamReader* reader, CSVTableWriter* writer) {
+  RecordSplitter splitter;
+  std::shared_ptr<arrow::Buffer> chunk;
+  while (true) {
+    std::unique_ptr<arrow::Buffer> buffer;
+    auto status = reader->GetNext(buffer);
+    if (status.IsStreamDrained()) {
+      break;
+    }
+    RETURN_ON_ERROR(status);
+    RETURN_ON_ERROR(splitter.Next(buffer, chunk));
+    RETURN_ON_ERROR(writer->Write(chunk));
+  }
+  RETURN_ON_ERROR(splitter.Finish(chunk));
+  RETURN_ON_ERROR(writer->Write(chunk));
+  return writer->Flush();
+}
+
+// the columns are rarely larger than the text they are parsed from
+static size_t ArenaSize(IIOAdaptor* adaptor) {
+  int64_t offset = 0, nbytes = 0;
+  auto block_adaptor = dynamic_cast<LocalIOAdaptor*>(adaptor);
+  if (block_adaptor == nullptr ||
+      !block_adaptor->GetPartialReadDetail(offset, nbytes).ok()) {
+    return 0;
+  }
+  return 2 * nbytes + 64 * 1024 * 1024;
+}
+
+static Status SealTable(Client& client,
+                        std::vector<std::shared_ptr<arrow::Table>>& tables,
+                        ObjectID& table_id) {
+  table_id = InvalidObjectID();
+  if (tables.empty()) {
+    return Status::OK();
+  }
+  TableBuilder builder(client, ConcatenateTables(tables));
+  auto table = builder.Seal(client);
+  RETURN_ON_ASSERT(table != nullptr, "Failed to seal the table");
+  table_id = table->id();
+  return Status::OK();
+}
+
+static Status OpenAdaptor(std::string const& location, int const proc_num,
+                          int const proc_index,
+                          std::shared_ptr<IIOAdaptor>& adaptor) {
+  adaptor = IOFactory::CreateIOAdaptor(location);
+  RETURN_ON_ASSERT(adaptor != nullptr,
+                   "Failed to create the io adaptor for " + location);
+  RETURN_ON_ERROR(adaptor->SetPartialRead(proc_index, proc_num));
+  return adaptor->Open();
+}
+
+}  // namespace detail
+
+IODriver::IODriver(Client& client, size_t const concurrency)
+    : client_(client) {
+  size_t parallelism = concurrency;
+  if (parallelism == 0) {
+    parallelism = std::max(1u, std::thread::hardware_concurrency());
+  }
+  for (size_t idx = 0; idx < parallelism; ++idx) {
+    workers_.emplace_back([this]() { this->run(); });
+  }
+}
+
+IODriver::~IODriver() {
+  VINEYARD_DISCARD(Wait());
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopped_ = true;
+  }
+  task_cv_.notify_all();
+  for (auto& worker : workers_) {
+    worker.join();
+  }
+}
+
+Status IODriver::ReadBytes(std::string const& location, int const proc_num,
+                           int const proc_index, ObjectID& stream_id) {
+  std::shared_ptr<IIOAdaptor> adaptor;
+  RETURN_ON_ERROR(
+      detail::OpenAdaptor(location, proc_num, proc_index, adaptor));
+
+  ByteStreamBuilder builder(client_);
+  builder.SetParams(adaptor->GetMeta());
+  auto stream = std::dynamic_pointer_cast<ByteStream>(builder.Seal(client_));
+  RETURN_ON_ERROR(client_.Persist(stream->id()));
+  std::unique_ptr<ByteStreamWriter> writer;
+  RETURN_ON_ERROR(stream->OpenWriter(client_, writer));
+  writer->SetBufferSizeLimit(kLineChunkSize);
+  stream_id = stream->id();
+
+  std::shared_ptr<ByteStreamWriter> shared_writer = std::move(writer);
+  submit([adaptor, shared_writer]() -> Status {
+    auto status = detail::ReadBytes(adaptor.get(), shared_writer.get());
+    auto s = adaptor->Close();
+    return detail::FinishStream(status.ok() ? s : status,
+                                shared_writer.get());
+  });
+  return Status::OK();
+}
+
+Status IODriver::ReadDataframe(std::string const& location, int const proc_num,
+                               int const proc_index, ObjectID& stream_id) {
+  std::shared_ptr<IIOAdaptor> adaptor;
+  RETURN_ON_ERROR(
+      detail::OpenAdaptor(location, proc_num, proc_index, adaptor));
+
+  std::unordered_map<std::string, std::string> params;
+  for (auto const& kv : adaptor->GetMeta()) {
+    params.emplace(kv.first, kv.second);
+  }
+  auto options = std::make_shared<CSVOptions>();
+  RETURN_ON_ERROR(MakeCSVOptions(*options, params));
+  // the partitions have been run concurrently
+  size_t concurrency = 1;
+  if (params.find("parse_concurrency") != params.end()) {
+    concurrency = std::stoul(params["parse_concurrency"]);
+  }
+
+  DataframeStreamBuilder builder(client_);
+  builder.SetParams(params);
+  auto stream =
+      std::dynamic_pointer_cast<DataframeStream>(builder.Seal(client_));
+  RETURN_ON_ERROR(client_.Persist(stream->id()));
+  std::unique_ptr<DataframeStreamWriter> writer;
+  RETURN_ON_ERROR(stream->OpenWriter(client_, writer));
+  stream_id = stream->id();
+
+  std::shared_ptr<DataframeStreamWriter> shared_writer = std::move(writer);
+  submit([adaptor, options, concurrency, shared_writer]() -> Status {
+    CSVTableWriter table_writer(*options, shared_writer.get(), concurrency);
+    auto status = detail::ReadDataframe(adaptor.get(), &table_writer);
+    auto s = adaptor->Close();
+    return detail::FinishStream(status.ok() ? s : status,
+                                shared_writer.get());
+  });
+  return Status::OK();
+}
+
+Status IODriver::ReadTable(std::string const& location, int const proc_num,
+                           int const proc_index, ObjectID& table_id) {
+  std::shared_ptr<IIOAdaptor> adaptor;
+  RETURN_ON_ERROR(
+      detail::OpenAdaptor(location, proc_num, proc_index, adaptor));
+
+  std::unordered_map<std::string, std::string> params;
+  for (auto const& kv : adaptor->GetMeta()) {
+    params.emplace(kv.first, kv.second);
+  }
+  auto options = std::make_shared<CSVOptions>();
+  RETURN_ON_ERROR(MakeCSVOptions(*options, params));
+  size_t concurrency = 1;
+  if (params.find("parse_concurrency") != params.end()) {
+    concurrency = std::stoul(params["parse_concurrency"]);
+  }
+
+  table_id = InvalidObjectID();
+  ObjectID* target = &table_id;
+  Client& client = client_;
+  submit([&client, adaptor, options, concurrency, target]() -> Status {
+    // the pool must outlive the tables that are allocated from it
+    std::unique_ptr<arrow::MemoryPool> pool;
+#if defined(WITH_JEMALLOC)
+    VineyardArenaMemoryPool* arena = nullptr;
+    size_t arena_size = detail::ArenaSize(adaptor.get());
+    if (arena_size > 0) {
+      arena = new VineyardArenaMemoryPool(client, arena_size);
+      pool.reset(arena);
+    }
+#endif
+    if (pool == nullptr) {
+      pool.reset(new VineyardMemoryPool(client));
+    }
+
+    std::vector<std::shared_ptr<arrow::Table>> tables;
+    CSVTableWriter table_writer(
+        *options,
+        [&tables](const std::shared_ptr<arrow::Table>& table) {
+          tables.emplace_back(table);
+          return Status::OK();
+        },
+        concurrency, pool.get());
+    auto status = detail::ReadDataframe(adaptor.get(), &table_writer);
+    auto s = adaptor->Close();
+    if (status.ok()) {
+      status = s;
+    }
+    ObjectID table_id = InvalidObjectID();
+    if (status.ok()) {
+      status = detail::SealTable(client, tables, table_id);
+    }
+#if defined(WITH_JEMALLOC)
+    // the frozen blobs are visible to the server after being released
+    if (arena != nullptr) {
+      auto released = arena->Release();
+      if (status.ok()) {
+        status = released;
+      }
+    }
+#endif
+    if (status.ok() && table_id != InvalidObjectID()) {
+      status = client.Persist(table_id);
+    }
+    if (status.ok()) {
+      *target = table_id;
+    }
+    return status;
+  });
+  return Status::OK();
+}
+
+Status IODriver::ParseBytesToDataframe(ObjectID const parallel_stream,
+                                       int const proc_index,
+                                       ObjectID& stream_id) {
+  auto pstream = client_.GetObject<ParallelStream>(parallel_stream);
+  RETURN_ON_ASSERT(pstream != nullptr, "Not a parallel stream: " +
+                                           ObjectIDToString(parallel_stream));
+  auto source = pstream->GetStream<ByteStream>(proc_index);
+  RETURN_ON_ASSERT(source != nullptr, "Not a byte stream at " +
+                                          std::to_string(proc_index));
+  auto params = source->GetParams();
+  auto options = std::make_shared<CSVOptions>();
+  RETURN_ON_ERROR(MakeCSVOptions(*options, params));
+  size_t concurrency = 1;
+  if (params.find("parse_concurrency") != params.end()) {
+    concurrency = std::stoul(params["parse_concurrency"]);
+  }
+
+  DataframeStreamBuilder builder(client_);
+  builder.SetParams(params);
+  auto stream =
+      std::dynamic_pointer_cast<DataframeStream>(builder.Seal(client_));
+  RETURN_ON_ERROR(client_.Persist(stream->id()));
+  std::unique_ptr<DataframeStreamWriter> writer;
+  RETURN_ON_ERROR(stream->OpenWriter(client_, writer));
+
+  std::unique_ptr<Client> reader_client(new Client());
+  RETURN_ON_ERROR(client_.Fork(*reader_client));
+  std::unique_ptr<ByteStreamReader> reader;
+  RETURN_ON_ERROR(source->OpenReader(*reader_client, reader));
+  reader->SetPrefetch(std::max<size_t>(concurrency, 1));
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    readers_.emplace_back(std::move(reader_client));
+  }
+  stream_id = stream->id();
+
+  std::shared_ptr<ByteStreamReader> shared_reader = std::move(reader);
+  std::shared_ptr<DataframeStreamWriter> shared_writer = std::move(writer);
+  submit([options, concurrency, shared_reader, shared_writer]() -> Status {
+    CSVTableWriter table_writer(*options, shared_writer.get(), concurrency);
+    auto status = detail::ParseBytes(shared_reader.get(), &table_writer);
+    return detail::FinishStream(status, shared_writer.get());
+  });
+  return Status::OK();
+}
+
+Status IODriver::Wait() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  idle_cv_.wait(lock, [this]() { return tasks_.empty() && running_ == 0; });
+  auto status = status_;
+  status_ = Status::OK();
+  return status;
+}
+
+void IODriver::submit(std::function<Status()> task) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    tasks_.emplace(std::move(task));
+  }
+  task_cv_.notify_one();
+}
+
+void IODriver::run() {
+  while (true) {
+    std::function<Status()> task;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      task_cv_.wait(lock, [this]() { return stopped_ || !tasks_.empty(); });
+      if (tasks_.empty()) {
+        return;
+      }
+      task = std::move(tasks_.front());
+      tasks_.pop();
+      running_ += 1;
+    }
+    auto status = task();
+    if (!status.ok()) {
+      LOG(ERROR) << "IO task failed: " << status.ToString();
+    }
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      running_ -= 1;
+      if (status_.ok() && !status.ok()) {
+        status_ = status;
+      }
+    }
+    idle_cv_.notify_all();
+  }
+}
+
+}  // namespace vineyard
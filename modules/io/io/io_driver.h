@@ -0,0 +1,135 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef MODULES_IO_IO_IO_DRIVER_H_
+#define MODULES_IO_IO_IO_DRIVER_H_
+
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "client/client.h"
+#include "common/util/status.h"
+#include "common/util/uuid.h"
+#include "io/io/local_io_adaptor.h"
+
+namespace vineyard {
+
+/**
+ * @brief Receives the chunks that are cut at the last line break, as the
+ * partial line carried over from the previous block, followed by the lines
+ * of current block.
+ */
+using line_block_sink_t = std::function<Status(
+    const std::string& carry, const char* data, int64_t const size)>;
+
+/**
+ * @brief Reads the assigned part of the file in large blocks, with the reads
+ * of the next `ReadDepth()` blocks in flight (i.e., concurrent range reads for
+ * object stores), and hands the blocks that cut at the last line break to
+ * the `sink`.
+ */
+Status ReadLineBlocks(LocalIOAdaptor* adaptor, line_block_sink_t const& sink);
+
+/**
+ * @brief IODriver runs the io adaptors as tasks on a shared pool of threads
+ * inside the current process, rather than launching a process (and a
+ * connection to vineyardd) for every stream and partition.
+ *
+ * The tasks share the client. Reading a file as dataframes fuses the reading
+ * and the parsing, thus there's no byte stream in between. The streams are
+ * created (and persisted) when the task is submitted, and are filled by the
+ * task in background, see also `Wait`.
+ */
+class IODriver {
+ public:
+  /**
+   * @param concurrency The number of tasks that run at the same time, 0
+   * means the hardware concurrency.
+   */
+  explicit IODriver(Client& client, size_t const concurrency = 0);
+
+  ~IODriver();
+
+  /**
+   * @brief Read the `proc_index`-th of `proc_num` parts of the file as a byte
+   * stream, as the "read_local_bytes" adaptor does.
+   */
+  Status ReadBytes(std::string const& location, int const proc_num,
+                   int const proc_index, ObjectID& stream_id);
+
+  /**
+   * @brief Read the `proc_index`-th of `proc_num` parts of the file and parse
+   * the lines into a dataframe stream directly, i.e., "read_local_bytes" and
+   * "parse_bytes_to_dataframe" fused.
+   */
+  Status ReadDataframe(std::string const& location, int const proc_num,
+                       int const proc_index, ObjectID& stream_id);
+
+  /**
+   * @brief Read the `proc_index`-th of `proc_num` parts of the file and parse
+   * the lines into a vineyard table, i.e., "read_local_bytes",
+   * "parse_bytes_to_dataframe" and "write_vineyard_dataframe" fused.
+   *
+   * The columns are parsed into memory of vineyard, and the table is sealed
+   * in place without copying. The `table_id` is assigned once the task
+   * finishes (see also `Wait`), and is `InvalidObjectID()` if there are no
+   * records in the part.
+   */
+  Status ReadTable(std::string const& location, int const proc_num,
+                   int const proc_index, ObjectID& table_id);
+
+  /**
+   * @brief Parse the `proc_index`-th byte stream of the parallel stream into
+   * a dataframe stream, as the "parse_bytes_to_dataframe" adaptor does.
+   *
+   * The byte stream is pulled by a connection forked from the client, since
+   * pulls wait for the producer, which may not be a task of the driver.
+   */
+  Status ParseBytesToDataframe(ObjectID const parallel_stream,
+                               int const proc_index, ObjectID& stream_id);
+
+  /**
+   * @brief Wait until all submitted tasks finish, returns the first error,
+   * the streams that failed are aborted.
+   */
+  Status Wait();
+
+ private:
+  void submit(std::function<Status()> task);
+
+  void run();
+
+  Client& client_;
+  // the connections for pulling streams
+  std::vector<std::unique_ptr<Client>> readers_;
+
+  std::vector<std::thread> workers_;
+  std::mutex mutex_;
+  std::condition_variable task_cv_, idle_cv_;
+  std::queue<std::function<Status()>> tasks_;
+  size_t running_ = 0;
+  bool stopped_ = false;
+  Status status_;
+};
+
+}  // namespace vineyard
+
+#endif  // MODULES_IO_IO_IO_DRIVER_H_
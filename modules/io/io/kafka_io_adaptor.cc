@@ -17,6 +17,9 @@ limitations under the License.
 
 #include "io/io/kafka_io_adaptor.h"
 
+#include <algorithm>
+#include <chrono>
+#include <cstring>
 #include <iosfwd>
 #include <memory>
 #include <string>
@@ -32,9 +35,10 @@ namespace vineyard {
 KafkaIOAdaptor::KafkaIOAdaptor(const std::string& location) {
   LOG(INFO) << "Parse location here";
   parseLocation(location);
+  batches_.SetProducerNum(0);
 }
 
-KafkaIOAdaptor::~KafkaIOAdaptor() {}
+KafkaIOAdaptor::~KafkaIOAdaptor() { VINEYARD_DISCARD(Close()); }
 
 std::unique_ptr<IIOAdaptor> KafkaIOAdaptor::Make(const std::string& location,
                                                  Client* client) {
@@ -53,7 +57,6 @@ Status KafkaIOAdaptor::Open() {
     local_partition_num_ = partition_num_;
     group_id_ = group_id_ + std::to_string(partial_index_);
   }
-  batch_size_per_partition_ = batch_size_ / local_partition_num_;
   RdKafka::Conf* conf = RdKafka::Conf::create(RdKafka::Conf::CONF_GLOBAL);
   std::string rdkafka_err;
   if (conf->set("metadata.broker.list", brokers_, rdkafka_err) !=
@@ -71,8 +74,14 @@ Status KafkaIOAdaptor::Open() {
       RdKafka::Conf::CONF_OK) {
     LOG(WARNING) << "Failed to set auto.offset.reset: " << rdkafka_err;
   }
+  // keep at least a batch prefetched by librdkafka
+  if (conf->set("queued.min.messages", std::to_string(batch_size_),
+                rdkafka_err) != RdKafka::Conf::CONF_OK) {
+    LOG(WARNING) << "Failed to set queued.min.messages: " << rdkafka_err;
+  }
 
-  message_queue_.resize(local_partition_num_);
+  batches_.SetLimit(4 * local_partition_num_);
+  batches_.SetProducerNum(local_partition_num_);
   for (int i = 0; i < local_partition_num_; ++i) {
     consumer_ptrs_[i] = std::shared_ptr<RdKafka::KafkaConsumer>(
         RdKafka::KafkaConsumer::create(conf, rdkafka_err));
@@ -92,11 +101,6 @@ Status KafkaIOAdaptor::Open() {
     delete topic_partition;
     topic_partition = nullptr;
     consumer_ptrs_[i]->subscribe({topic_});
-
-    message_queue_[i] =
-        std::make_shared<PCBlockingQueue<std::vector<std::string>>>();
-    message_queue_[i]->SetLimit(16);
-    message_queue_[i]->SetProducerNum(1);
   }
   delete conf;  // release the memory resource
   startFetch();
@@ -123,6 +127,15 @@ Status KafkaIOAdaptor::Open(const char* mode) {
       LOG(WARNING) << "Failed to set queue.buffering.max.messages: "
                    << rdkafka_err;
     }
+    // the messages are sent in batches by librdkafka
+    if (conf->set("linger.ms", std::to_string(linger_ms_), rdkafka_err) !=
+        RdKafka::Conf::CONF_OK) {
+      LOG(WARNING) << "Failed to set linger.ms: " << rdkafka_err;
+    }
+    if (conf->set("batch.num.messages", std::to_string(batch_size_),
+                  rdkafka_err) != RdKafka::Conf::CONF_OK) {
+      LOG(WARNING) << "Failed to set batch.num.messages: " << rdkafka_err;
+    }
 
     producer_ = std::unique_ptr<RdKafka::Producer>(
         RdKafka::Producer::create(conf, rdkafka_err));
@@ -142,8 +155,11 @@ Status KafkaIOAdaptor::Configure(const std::string& key,
   if (key == "group_id") {
     group_id_ = value;
   } else if (key == "batch_size") {
-    batch_size_ = std::stoi(value);
-    batch_size_per_partition_ = batch_size_ / local_partition_num_;
+    batch_size_ = std::max(1, std::stoi(value));
+  } else if (key == "batch_bytes") {
+    batch_bytes_ = std::stoull(value);
+  } else if (key == "linger_ms") {
+    linger_ms_ = std::stoi(value);
   } else if (key == "time_interval") {
     time_interval_ms_ = std::stoi(value) * 1000;
   }
@@ -158,67 +174,117 @@ Status KafkaIOAdaptor::SetPartialRead(const int index, const int total_parts) {
 }
 
 Status KafkaIOAdaptor::ReadLine(std::string& line) {
-  if (message_offset_ < message_list_.size()) {
-    line = message_list_[message_offset_];
-    ++message_offset_;
-    return Status::OK();
-  } else {
-    message_list_.clear();
-    message_offset_ = 0;
-    bool end = false;
-    while (!end) {
-      end = true;
-      for (int i = 0; i < local_partition_num_; ++i) {
-        end = end & message_queue_[i]->End();
-        if (message_queue_[i]->Size()) {
-          message_queue_[i]->Get(message_list_);
-          break;
-        }
-      }
-      if (message_list_.size()) {
-        line = message_list_[message_offset_];
-        ++message_offset_;
-        return Status::OK();
-      }
+  while (batch_offset_ >= batch_.size()) {
+    batch_.clear();
+    batch_offset_ = 0;
+    if (!batches_.Get(batch_)) {
+      return Status::EndOfFile();
     }
-    return Status::EndOfFile();
   }
+  // every message in the batch is followed by a '\n'
+  size_t end = batch_.find('\n', batch_offset_);
+  line = batch_.substr(batch_offset_, end - batch_offset_);
+  batch_offset_ = end + 1;
+  return Status::OK();
 }
 
-Status KafkaIOAdaptor::WriteLine(const std::string& line) {
-  if (line.empty()) {
+Status KafkaIOAdaptor::ReadLines(std::string& lines) {
+  if (batch_offset_ < batch_.size()) {
+    // the rest of the batch that is partially read by `ReadLine`
+    lines = batch_.substr(batch_offset_);
+    batch_.clear();
+    batch_offset_ = 0;
     return Status::OK();
   }
-  RdKafka::ErrorCode err = producer_->produce(
-      topic_, RdKafka::Topic::PARTITION_UA, RdKafka::Producer::RK_MSG_COPY,
-      static_cast<void*>(const_cast<char*>(line.c_str())) /* value */,
-      line.size() /* size */, NULL, 0, 0 /* timestamp */,
-      NULL /* delivery report */);
-  if (err != RdKafka::ERR_NO_ERROR) {
-    LOG(ERROR) << "Failed to writeline to kafka: " << RdKafka::err2str(err);
+  if (!batches_.Get(lines)) {
+    return Status::EndOfFile();
   }
-  producer_->flush(time_interval_ms_);
   return Status::OK();
 }
 
-Status KafkaIOAdaptor::Write(void* buffer, size_t size) {
-  {
-    if (size == 0) {
-      return Status::OK();
-    }
+Status KafkaIOAdaptor::produce(const char* data, size_t size) {
+  while (true) {
     RdKafka::ErrorCode err = producer_->produce(
         topic_, RdKafka::Topic::PARTITION_UA, RdKafka::Producer::RK_MSG_COPY,
-        buffer /* value */, size /* size */, NULL, 0, 0 /* timestamp */,
+        static_cast<void*>(const_cast<char*>(data)) /* value */,
+        size /* size */, NULL, 0, 0 /* timestamp */,
         NULL /* delivery report */);
+    if (err == RdKafka::ERR__QUEUE_FULL) {
+      // wait for the in-flight messages being delivered
+      producer_->poll(100);
+      continue;
+    }
     if (err != RdKafka::ERR_NO_ERROR) {
-      LOG(ERROR) << "Failed to output to kafka: " << RdKafka::err2str(err);
+      return Status::IOError("Failed to produce to kafka: " +
+                             RdKafka::err2str(err));
+    }
+    // serve the delivery reports without blocking
+    producer_->poll(0);
+    return Status::OK();
+  }
+}
+
+Status KafkaIOAdaptor::WriteLine(const std::string& line) {
+  if (line.empty()) {
+    return Status::OK();
+  }
+  return produce(line.c_str(), line.size());
+}
+
+Status KafkaIOAdaptor::Write(void* buffer, size_t size) {
+  if (size == 0) {
+    return Status::OK();
+  }
+  return produce(static_cast<const char*>(buffer), size);
+}
+
+Status KafkaIOAdaptor::WriteLines(const char* buffer, size_t size) {
+  const char* end = buffer + size;
+  while (buffer < end) {
+    const char* line_end =
+        static_cast<const char*>(memchr(buffer, '\n', end - buffer));
+    if (line_end == nullptr) {
+      line_end = end;
     }
-    producer_->flush(time_interval_ms_);
+    if (line_end != buffer) {
+      RETURN_ON_ERROR(produce(buffer, line_end - buffer));
+    }
+    buffer = line_end + 1;
   }
   return Status::OK();
 }
 
-Status KafkaIOAdaptor::Close() { return Status::OK(); }
+Status KafkaIOAdaptor::Flush() {
+  if (!producer_) {
+    return Status::OK();
+  }
+  RdKafka::ErrorCode err = producer_->flush(time_interval_ms_);
+  if (err != RdKafka::ERR_NO_ERROR) {
+    return Status::IOError("Failed to flush kafka producer, " +
+                           std::to_string(producer_->outq_len()) +
+                           " messages are not delivered: " +
+                           RdKafka::err2str(err));
+  }
+  return Status::OK();
+}
+
+Status KafkaIOAdaptor::Close() {
+  if (consumer_) {
+    stopped_.store(true);
+    // unblock the fetchers that are waiting for the space of the queue
+    std::string batch;
+    while (batches_.Get(batch)) {
+    }
+    for (auto& fetcher : fetchers_) {
+      if (fetcher.joinable()) {
+        fetcher.join();
+      }
+    }
+    fetchers_.clear();
+    return Status::OK();
+  }
+  return Flush();
+}
 
 void KafkaIOAdaptor::parseLocation(const std::string& location) {
   std::string tmp_location(location);
@@ -245,93 +311,77 @@ void KafkaIOAdaptor::parseLocation(const std::string& location) {
 
 void KafkaIOAdaptor::startFetch() {
   for (int i = 0; i < local_partition_num_; ++i) {
-    std::thread t = std::thread([&, i] {
-      while (!message_queue_[i]->End()) {
-        std::vector<std::string> msg;
-        fetchMessage(i, msg);
-        message_queue_[i]->Put(std::move(msg));
+    fetchers_.emplace_back([this, i]() {
+      bool more = true;
+      while (more) {
+        std::string batch;
+        size_t messages = 0;
+        more = fetchMessage(i, batch, messages);
+        if (messages > 0) {
+          batches_.Put(std::move(batch));
+        }
       }
+      batches_.DecProducerNum();
     });
-    t.detach();
     LOG(INFO) << "[partition" << partial_index_
               << "] start fetch thread on partition " << i;
   }
 }
 
-void KafkaIOAdaptor::fetchMessage(int partition_index,
-                                  std::vector<std::string>& messages) {
-  messages.reserve(batch_size_per_partition_);
-  // Create a consumer dispatcher
+bool KafkaIOAdaptor::fetchMessage(int partition_index, std::string& batch,
+                                  size_t& messages) {
   auto consumer_ptr_ = consumer_ptrs_[partition_index];
-
-  int msg_cnt = 0;
-  int64_t first_msg_ts = 0, cur_msg_ts = 0;
-
-  int msg_len;
-  const char* msg_payload;
-  int64_t timestamp;
-  std::string msg_data;
-
-  auto process = [&](int partition_index, RdKafka::Message* message) -> bool {
+  auto deadline = std::chrono::steady_clock::now();
+
+  while (!stopped_.load()) {
+    int timeout = time_interval_ms_;
+    if (messages > 0) {
+      timeout = std::max<int64_t>(
+          0, std::chrono::duration_cast<std::chrono::milliseconds>(
+                 deadline - std::chrono::steady_clock::now())
+                 .count());
+    }
+    std::unique_ptr<RdKafka::Message> message(consumer_ptr_->consume(timeout));
     switch (message->err()) {
     case RdKafka::ERR__TIMED_OUT:
-      if (msg_cnt) {
-        msg_cnt = 0;
-        first_msg_ts = 0;
-        return false;
-      }
-      message_queue_[partition_index]->DecProducerNum();
-      return true;
+      // either the batch lingers enough, or the partition has been drained
+      return messages > 0;
 
     case RdKafka::ERR_NO_ERROR:
-      /* process message */
-      msg_len = message->len();
-      msg_payload = static_cast<char*>(message->payload());
-      timestamp = message->timestamp().timestamp;
-
-      msg_data = std::string(msg_payload, msg_len);
-      if (!msg_data.empty()) {
-        messages.push_back(msg_data);
-        ++msg_cnt;
-      }
-      if (!first_msg_ts) {
-        first_msg_ts = timestamp;
+      if (message->len() > 0) {
+        if (messages == 0) {
+          deadline = std::chrono::steady_clock::now() +
+                     std::chrono::milliseconds(linger_ms_);
+        }
+        batch.append(static_cast<const char*>(message->payload()),
+                     message->len());
+        batch.push_back('\n');
+        ++messages;
       }
-      cur_msg_ts = timestamp;
-      if (msg_cnt >= this->batch_size_per_partition_ ||
-          cur_msg_ts - first_msg_ts > this->time_interval_ms_) {
-        msg_cnt = 0;
-        first_msg_ts = 0;
-        return false;
-      } else {
+      if (messages >= static_cast<size_t>(batch_size_) ||
+          batch.size() >= batch_bytes_) {
         return true;
       }
+      break;
 
     case RdKafka::ERR__PARTITION_EOF:
-      LOG(ERROR) << "Reached EOF on partition";
-      message_queue_[partition_index]->DecProducerNum();
-      return true;
+      LOG(INFO) << "Reached EOF on partition";
+      return false;
 
     case RdKafka::ERR__UNKNOWN_TOPIC:
     case RdKafka::ERR__UNKNOWN_PARTITION:
       LOG(ERROR) << "Topic or partition error: " << message->errstr();
-      message_queue_[partition_index]->DecProducerNum();
-      return true;
+      return false;
 
     default:
       LOG(ERROR) << "Unhandled kafka error: " << message->errstr();
-      return false;
-    }
-  };
-
-  while (true) {
-    RdKafka::Message* message = consumer_ptr_->consume(time_interval_ms_);
-    bool cont = process(partition_index, message);
-    delete message;
-    if (!cont) {
+      if (messages > 0) {
+        return true;
+      }
       break;
     }
   }
+  return false;
 }
 
 const bool KafkaIOAdaptor::registered_ = IOFactory::Register(
@@ -18,17 +18,19 @@ limitations under the License.
 
 #ifdef KAFKA_ENABLED
 
+#include <atomic>
 #include <fstream>
 #include <map>
 #include <memory>
 #include <string>
+#include <thread>
 #include <vector>
 
 #include "librdkafka/rdkafka.h"
 #include "librdkafka/rdkafkacpp.h"
 
-#include "common/util/blocking_queue.h"
 #include "common/util/functions.h"
+#include "common/util/mpmc_queue.h"
 #include "common/util/status.h"
 #include "io/io/i_io_adaptor.h"
 #include "io/io/io_factory.h"
@@ -57,6 +59,15 @@ class KafkaIOAdaptor : public IIOAdaptor {
 
   Status ReadLine(std::string& line) override;
 
+  /**
+   * @brief Read the next batch of messages of any partition, the messages
+   * are concatenated into `lines` and each of them is followed by a '\n'.
+   *
+   * A batch is cut when it reaches `batch_size` messages, or `batch_bytes`
+   * bytes, or lingers for `linger_ms` milliseconds, whichever comes first.
+   */
+  Status ReadLines(std::string& lines) override;
+
   Status SetPartialRead(const int index, const int total_parts) override;
 
   Status GetPartialReadDetail(int64_t& offset, int64_t& nbytes) {
@@ -73,6 +84,17 @@ class KafkaIOAdaptor : public IIOAdaptor {
 
   Status Write(void* buffer, size_t size) override;
 
+  /**
+   * @brief Produce each '\n'-delimited line in the buffer as a message,
+   * without waiting for the deliveries, see also `Flush`.
+   */
+  Status WriteLines(const char* buffer, size_t size) override;
+
+  /**
+   * @brief Wait until the produced messages have been delivered.
+   */
+  Status Flush() override;
+
   Status ListDirectory(const std::string& path,
                        std::vector<std::string>& files) override {
     return Status::NotImplemented();
@@ -89,26 +111,34 @@ class KafkaIOAdaptor : public IIOAdaptor {
 
   void startFetch();
 
-  void fetchMessage(int partition, std::vector<std::string>& messages);
+  // returns false when the partition has no more messages
+  bool fetchMessage(int partition, std::string& batch, size_t& messages);
+
+  Status produce(const char* data, size_t size);
 
   static const constexpr int internal_buffer_size_ = 1024 * 1024;
 
-  bool consumer_;
-  int batch_size_ = 50;
+  bool consumer_ = false;
+  // the limits of batches of each partition
+  int batch_size_ = 64 * 1024;
+  size_t batch_bytes_ = 2 * 1024 * 1024;
+  int linger_ms_ = 100;
   int partition_num_;
-  int local_partition_num_;
-  int batch_size_per_partition_;
+  int local_partition_num_ = 0;
+  // the partition is regarded as drained after being idle for the interval
   int time_interval_ms_ = 1000 * 10;
-  size_t message_offset_ = 0;
 
   bool partial_read_ = false;
-  int partial_index_;
-  int total_parts_;
-
-  template <typename T>
-  using mq_t = std::shared_ptr<PCBlockingQueue<std::vector<T>>>;
-  std::vector<mq_t<std::string>> message_queue_;
-  std::vector<std::string> message_list_;
+  int partial_index_ = 0;
+  int total_parts_ = 1;
+
+  // batches from all partitions, each partition is fetched by a thread
+  PCMPMCQueue<std::string> batches_;
+  std::vector<std::thread> fetchers_;
+  std::atomic_bool stopped_{false};
+  // the batch being consumed by `ReadLine`
+  std::string batch_;
+  size_t batch_offset_ = 0;
   std::string group_id_;
   std::string brokers_;
   std::string topic_;
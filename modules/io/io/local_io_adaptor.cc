@@ -20,9 +20,13 @@ limitations under the License.
 #include <sys/types.h>
 
 #include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <future>
 #include <limits>
 #include <memory>
 #include <string>
+#include <thread>
 #include <vector>
 
 #include "arrow/csv/api.h"
@@ -32,10 +36,22 @@ limitations under the License.
 #include "arrow/status.h"
 #include "arrow/util/config.h"
 #include "arrow/util/uri.h"
+#if defined(ARROW_VERSION) && ARROW_VERSION >= 4000000
+#include "arrow/csv/writer.h"
+#endif
 
 #include "boost/algorithm/string.hpp"
 #include "glog/logging.h"
 
+#if defined(VINEYARD_WITH_PARQUET)
+#include "parquet/arrow/reader.h"
+#include "parquet/arrow/writer.h"
+#endif
+#if defined(VINEYARD_WITH_ORC)
+#include "arrow/adapters/orc/adapter.h"
+#endif
+
+#include "basic/ds/arrow_memory_pool.h"
 #include "basic/ds/arrow_utils.h"
 
 namespace vineyard {
@@ -52,6 +68,7 @@ LocalIOAdaptor::LocalIOAdaptor(const std::string& location)
   //
   // TODO: tidy with netlib for url parsing.
   size_t arg_pos = location.find_first_of('#');
+  std::string endpoint;
   if (arg_pos != std::string::npos) {
     // process arguments
     std::vector<std::string> config_list;
@@ -82,6 +99,15 @@ LocalIOAdaptor::LocalIOAdaptor(const std::string& location)
       } else if (kv_pair[0] == "header_row") {
         header_row_ = (boost::algorithm::to_lower_copy(kv_pair[1]) == "true");
         meta_.emplace("header_row", std::to_string(header_row_));
+      } else if (kv_pair[0] == "format") {
+        format_ = boost::algorithm::to_lower_copy(kv_pair[1]);
+        meta_.emplace("format", format_);
+      } else if (kv_pair[0] == "read_concurrency" && kv_pair.size() > 1) {
+        read_concurrency_ = std::max(1, std::stoi(kv_pair[1]));
+      } else if (kv_pair[0] == "read_retries" && kv_pair.size() > 1) {
+        read_retries_ = std::max(0, std::stoi(kv_pair[1]));
+      } else if (kv_pair[0] == "endpoint" && kv_pair.size() > 1) {
+        endpoint = kv_pair[1];
       } else if (kv_pair[0] == "include_all_columns") {
         include_all_columns_ =
             (boost::algorithm::to_lower_copy(kv_pair[1]) == "true");
@@ -95,6 +121,27 @@ LocalIOAdaptor::LocalIOAdaptor(const std::string& location)
 
   // process locations
   location_ = location_.substr(0, arg_pos);
+  if (format_.empty()) {
+    if (boost::algorithm::iends_with(location_, ".parquet")) {
+      format_ = "parquet";
+    } else if (boost::algorithm::iends_with(location_, ".orc")) {
+      format_ = "orc";
+    } else {
+      format_ = "csv";
+    }
+  }
+  // OSS is accessed through its S3 compatible API, the endpoint (e.g.,
+  // "oss-cn-hangzhou.aliyuncs.com") comes from the "endpoint" argument or the
+  // "OSS_ENDPOINT" environment variable.
+  if (boost::algorithm::istarts_with(location_, "oss://")) {
+    if (endpoint.empty() && getenv("OSS_ENDPOINT") != nullptr) {
+      endpoint = getenv("OSS_ENDPOINT");
+    }
+    location_ = "s3://" + location_.substr(6);
+    if (!endpoint.empty()) {
+      location_ += "?endpoint_override=" + endpoint;
+    }
+  }
   size_t i = 0;
   for (i = 0; i < location_.size(); ++i) {
     if (location_[i] < 0 || location_[i] > 127) {
@@ -138,7 +185,9 @@ std::unique_ptr<IIOAdaptor> LocalIOAdaptor::Make(const std::string& location,
                                                  Client* client) {
   // use `registered` to avoid it being optimized out.
   VLOG(999) << "Local IO adaptor has been registered: " << registered_;
-  return std::unique_ptr<IIOAdaptor>(new LocalIOAdaptor(location));
+  auto adaptor = new LocalIOAdaptor(location);
+  adaptor->client_ = client;
+  return std::unique_ptr<IIOAdaptor>(adaptor);
 }
 
 Status LocalIOAdaptor::Open() { return this->Open("r"); }
@@ -161,6 +210,21 @@ Status LocalIOAdaptor::Open(const char* mode) {
     return Status::OK();
   } else {
     RETURN_ON_ARROW_ERROR_AND_ASSIGN(ifp_, fs_->OpenInputFile(location_));
+    if (format_ != "csv") {
+      // columnar files are split by row groups (or stripes) when reading
+      return Status::OK();
+    }
+    if (fs_->type_name() == "local") {
+      async_reader_.reset(new AsyncFileReader(queue_depth_));
+      auto status = async_reader_->Open(location_);
+      if (!status.ok()) {
+        VLOG(2) << "Asynchronous reads are disabled: " << status.ToString();
+        async_reader_.reset();
+      }
+    } else {
+      range_reader_.reset(
+          new RangeReader(ifp_, read_concurrency_, read_retries_));
+    }
 
     // check the partial read flag
     if (enable_partial_read_) {
@@ -178,6 +242,17 @@ Status LocalIOAdaptor::Open(const char* mode) {
 
 Status LocalIOAdaptor::Configure(const std::string& key,
                                  const std::string& value) {
+  if (key == "queue_depth") {
+    queue_depth_ = std::stoul(value);
+  } else if (key == "parse_concurrency") {
+    parse_concurrency_ = std::max(1, std::stoi(value));
+  } else if (key == "read_concurrency") {
+    read_concurrency_ = std::max(1, std::stoi(value));
+  } else if (key == "read_retries") {
+    read_retries_ = std::max(0, std::stoi(value));
+  } else if (key == "write_block_size" && write_buffers_[0] == nullptr) {
+    write_block_size_ = std::max<size_t>(4096, std::stoul(value));
+  }
   return Status::OK();
 }
 
@@ -275,10 +350,188 @@ Status LocalIOAdaptor::setPartialReadImpl() {
 }
 
 Status LocalIOAdaptor::ReadTable(std::shared_ptr<arrow::Table>* table) {
+  if (format_ == "parquet") {
+    return readParquetTable(table);
+  }
+  if (format_ == "orc") {
+    return readORCTable(table);
+  }
   RETURN_ON_ERROR(ReadPartialTable(table, index_));
   return Status::OK();
 }
 
+arrow::MemoryPool* LocalIOAdaptor::memoryPool() {
+  if (client_ == nullptr) {
+    return arrow::default_memory_pool();
+  }
+  if (memory_pool_ == nullptr) {
+    memory_pool_.reset(new VineyardMemoryPool(*client_));
+  }
+  return memory_pool_.get();
+}
+
+Status LocalIOAdaptor::resolveColumnIndices(const arrow::Schema& schema,
+                                            std::vector<int>& indices) {
+  indices.clear();
+  if (columns_.empty()) {
+    for (int i = 0; i < schema.num_fields(); ++i) {
+      indices.push_back(i);
+    }
+    return Status::OK();
+  }
+  for (auto const& column : columns_) {
+    int index = -1;
+    if (!column.empty() &&
+        std::all_of(column.begin(), column.end(),
+                    [](unsigned char c) { return std::isdigit(c); })) {
+      index = std::stoi(column);
+    } else {
+      index = schema.GetFieldIndex(column);
+    }
+    if (index < 0 || index >= schema.num_fields()) {
+      return Status::Invalid("Column not found in '" + location_ +
+                             "': " + column);
+    }
+    indices.push_back(index);
+  }
+  if (include_all_columns_) {
+    for (int i = 0; i < schema.num_fields(); ++i) {
+      if (std::find(indices.begin(), indices.end(), i) == indices.end()) {
+        indices.push_back(i);
+      }
+    }
+  }
+  return Status::OK();
+}
+
+#if defined(VINEYARD_WITH_PARQUET) || defined(VINEYARD_WITH_ORC)
+// the row groups (or stripes) [begin, end) that belong to `index_`
+static void getPartialRange(int64_t total, bool enable_partial_read,
+                            int index, int total_parts, int64_t& begin,
+                            int64_t& end) {
+  if (!enable_partial_read || total_parts <= 1) {
+    begin = 0;
+    end = total;
+  } else {
+    begin = total * index / total_parts;
+    end = total * (index + 1) / total_parts;
+  }
+}
+#endif
+
+Status LocalIOAdaptor::readParquetTable(std::shared_ptr<arrow::Table>* table) {
+#if defined(VINEYARD_WITH_PARQUET)
+  if (ifp_ == nullptr) {
+    return Status::IOError("The file hasn't been opened in read mode: " +
+                           location_);
+  }
+  parquet::arrow::FileReaderBuilder builder;
+  RETURN_ON_ARROW_ERROR(builder.Open(ifp_));
+  std::unique_ptr<parquet::arrow::FileReader> reader;
+  RETURN_ON_ARROW_ERROR(builder.memory_pool(memoryPool())->Build(&reader));
+  // column chunks are decoded in parallel
+  reader->set_use_threads(true);
+
+  std::shared_ptr<arrow::Schema> schema;
+  RETURN_ON_ARROW_ERROR(reader->GetSchema(&schema));
+  std::vector<int> indices;
+  RETURN_ON_ERROR(resolveColumnIndices(*schema, indices));
+
+  int64_t begin = 0, end = 0;
+  getPartialRange(reader->num_row_groups(), enable_partial_read_, index_,
+                  total_parts_, begin, end);
+  std::vector<int> row_groups;
+  for (int64_t i = begin; i < end; ++i) {
+    row_groups.push_back(static_cast<int>(i));
+  }
+  if (row_groups.empty()) {
+    *table = nullptr;
+    return Status::OK();
+  }
+  RETURN_ON_ARROW_ERROR(reader->ReadRowGroups(row_groups, indices, table));
+  VLOG(2) << "[file-" << location_ << "] contains: " << (*table)->num_rows()
+          << " rows, " << (*table)->num_columns() << " columns";
+  return Status::OK();
+#else
+  return Status::NotImplemented(
+      "Parquet is not supported, as vineyard is built without it");
+#endif
+}
+
+Status LocalIOAdaptor::readORCTable(std::shared_ptr<arrow::Table>* table) {
+#if defined(VINEYARD_WITH_ORC)
+  if (ifp_ == nullptr) {
+    return Status::IOError("The file hasn't been opened in read mode: " +
+                           location_);
+  }
+  using arrow::adapters::orc::ORCFileReader;
+  arrow::MemoryPool* pool = memoryPool();
+  auto open_reader = [&](std::unique_ptr<ORCFileReader>& reader) -> Status {
+#if defined(ARROW_VERSION) && ARROW_VERSION >= 6000000
+    RETURN_ON_ARROW_ERROR_AND_ASSIGN(reader, ORCFileReader::Open(ifp_, pool));
+#else
+    RETURN_ON_ARROW_ERROR(ORCFileReader::Open(ifp_, pool, &reader));
+#endif
+    return Status::OK();
+  };
+
+  std::unique_ptr<ORCFileReader> reader;
+  RETURN_ON_ERROR(open_reader(reader));
+  std::shared_ptr<arrow::Schema> schema;
+#if defined(ARROW_VERSION) && ARROW_VERSION >= 6000000
+  RETURN_ON_ARROW_ERROR_AND_ASSIGN(schema, reader->ReadSchema());
+#else
+  RETURN_ON_ARROW_ERROR(reader->ReadSchema(&schema));
+#endif
+  std::vector<int> indices;
+  RETURN_ON_ERROR(resolveColumnIndices(*schema, indices));
+
+  int64_t begin = 0, end = 0;
+  getPartialRange(reader->NumberOfStripes(), enable_partial_read_, index_,
+                  total_parts_, begin, end);
+  if (begin >= end) {
+    *table = nullptr;
+    return Status::OK();
+  }
+
+  // the orc reader is not thread-safe, each thread reads a range of stripes
+  // with its own reader.
+  int64_t concurrency =
+      std::min<int64_t>(parse_concurrency_, end - begin);
+  std::vector<std::shared_ptr<arrow::RecordBatch>> batches(end - begin);
+  std::vector<std::future<Status>> readers;
+  for (int64_t worker = 0; worker < concurrency; ++worker) {
+    readers.emplace_back(std::async(std::launch::async, [&, worker]() {
+      std::unique_ptr<ORCFileReader> reader;
+      RETURN_ON_ERROR(open_reader(reader));
+      for (int64_t stripe = begin + worker; stripe < end;
+           stripe += concurrency) {
+#if defined(ARROW_VERSION) && ARROW_VERSION >= 6000000
+        RETURN_ON_ARROW_ERROR_AND_ASSIGN(batches[stripe - begin],
+                                         reader->ReadStripe(stripe, indices));
+#else
+        RETURN_ON_ARROW_ERROR(
+            reader->ReadStripe(stripe, indices, &batches[stripe - begin]));
+#endif
+      }
+      return Status::OK();
+    }));
+  }
+  Status status;
+  for (auto& reader : readers) {
+    status &= reader.get();
+  }
+  RETURN_ON_ERROR(status);
+  RETURN_ON_ERROR(RecordBatchesToTable(batches, table));
+  VLOG(2) << "[file-" << location_ << "] contains: " << (*table)->num_rows()
+          << " rows, " << (*table)->num_columns() << " columns";
+  return Status::OK();
+#else
+  return Status::NotImplemented(
+      "ORC is not supported, as vineyard is built without it");
+#endif
+}
+
 /// \a origin_columns_ saves the column names of the CSV.
 ///
 /// If \a header_row == \a true, \a origin_columns will be read from the first
@@ -309,10 +562,7 @@ Status LocalIOAdaptor::ReadPartialTable(std::shared_ptr<arrow::Table>* table,
   int64_t offset = partial_read_offset_[index];
   int64_t nbytes =
       partial_read_offset_[index + 1] - partial_read_offset_[index];
-  std::shared_ptr<arrow::io::InputStream> input =
-      arrow::io::RandomAccessFile::GetStream(ifp_, offset, nbytes);
-
-  arrow::MemoryPool* pool = arrow::default_memory_pool();
+  arrow::MemoryPool* pool = memoryPool();
 
   auto read_options = arrow::csv::ReadOptions::Defaults();
   auto parse_options = arrow::csv::ParseOptions::Defaults();
@@ -369,29 +619,199 @@ Status LocalIOAdaptor::ReadPartialTable(std::shared_ptr<arrow::Table>* table,
 
   parse_options.delimiter = delimiter_;
 
-  std::shared_ptr<arrow::csv::TableReader> reader;
+  // the part is read into memory in one go, if possible
+  std::unique_ptr<char[]> content;
+  if (async_reader_ != nullptr && nbytes > 0) {
+    // read the whole part with many reads in flight, rather than letting the
+    // csv reader pull it block by block.
+    constexpr int64_t kReadBlockSize = 4 * 1024 * 1024;
+    content.reset(new char[nbytes]);
+    std::vector<AsyncFileReader::read_request_t> requests;
+    for (int64_t begin = 0; begin < nbytes; begin += kReadBlockSize) {
+      AsyncFileReader::read_request_t request;
+      request.offset = offset + begin;
+      request.buffer = content.get() + begin;
+      request.size = std::min(kReadBlockSize, nbytes - begin);
+      requests.emplace_back(request);
+    }
+    RETURN_ON_ERROR(async_reader_->ReadBatch(requests));
+    for (auto const& request : requests) {
+      if (request.nread != static_cast<int64_t>(request.size)) {
+        return Status::IOError("Unexpected end of file: " + location_);
+      }
+    }
+  } else if (range_reader_ != nullptr && nbytes > 0) {
+    // issue the range reads of the part concurrently
+    constexpr int64_t kReadBlockSize = 8 * 1024 * 1024;
+    content.reset(new char[nbytes]);
+    std::vector<std::future<Status>> reads;
+    std::vector<int64_t> nreads((nbytes + kReadBlockSize - 1) /
+                                kReadBlockSize);
+    for (int64_t begin = 0; begin < nbytes; begin += kReadBlockSize) {
+      reads.emplace_back(range_reader_->ReadAsync(
+          offset + begin, content.get() + begin,
+          std::min(kReadBlockSize, nbytes - begin),
+          &nreads[begin / kReadBlockSize]));
+    }
+    Status status;
+    for (auto& read : reads) {
+      status &= read.get();
+    }
+    RETURN_ON_ERROR(status);
+    for (size_t index = 0; index < nreads.size(); ++index) {
+      if (nreads[index] !=
+          std::min(kReadBlockSize, nbytes - static_cast<int64_t>(
+                                                index * kReadBlockSize))) {
+        return Status::IOError("Unexpected end of file: " + location_);
+      }
+    }
+  }
+
+  // reads the slice [begin, end) of the part, `ReadAt` of the file is safe
+  // to be used from multiple threads.
+  auto read_slice = [&](int64_t begin, int64_t end,
+                        const arrow::csv::ReadOptions& read_options,
+                        const arrow::csv::ConvertOptions& convert_options,
+                        std::shared_ptr<arrow::Table>* slice) -> Status {
+    std::shared_ptr<arrow::io::InputStream> input;
+    if (content != nullptr) {
+      input = std::make_shared<arrow::io::BufferReader>(
+          std::make_shared<arrow::Buffer>(
+              reinterpret_cast<const uint8_t*>(content.get() + begin),
+              end - begin));
+    } else {
+      input =
+          arrow::io::RandomAccessFile::GetStream(ifp_, offset + begin,
+                                                 end - begin);
+    }
+
+    std::shared_ptr<arrow::csv::TableReader> reader;
 #if defined(ARROW_VERSION) && ARROW_VERSION >= 4000000
-  RETURN_ON_ARROW_ERROR_AND_ASSIGN(
-      reader, arrow::csv::TableReader::Make(arrow::io::IOContext(pool), input,
-                                            read_options, parse_options,
-                                            convert_options));
+    RETURN_ON_ARROW_ERROR_AND_ASSIGN(
+        reader, arrow::csv::TableReader::Make(arrow::io::IOContext(pool),
+                                              input, read_options,
+                                              parse_options, convert_options));
 #else
-  RETURN_ON_ARROW_ERROR_AND_ASSIGN(
-      reader, arrow::csv::TableReader::Make(pool, input, read_options,
-                                            parse_options, convert_options));
+    RETURN_ON_ARROW_ERROR_AND_ASSIGN(
+        reader, arrow::csv::TableReader::Make(pool, input, read_options,
+                                              parse_options, convert_options));
 #endif
 
-  // RETURN_ON_ARROW_ERROR_AND_ASSIGN(*table, reader->Read());
-  auto result = reader->Read();
-  if (!result.status().ok()) {
-    if (result.status().message() == "Empty CSV file") {
-      *table = nullptr;
-      return Status::OK();
+    auto result = reader->Read();
+    if (!result.status().ok()) {
+      if (result.status().message() == "Empty CSV file") {
+        *slice = nullptr;
+        return Status::OK();
+      } else {
+        return Status::ArrowError(result.status());
+      }
+    }
+    *slice = result.ValueOrDie();
+    return Status::OK();
+  };
+
+  // finds the position after the next line break at or after `position`
+  auto next_line = [&](int64_t position) -> int64_t {
+    constexpr int64_t kProbeSize = 4096;
+    char probe[kProbeSize];
+    while (position < nbytes) {
+      int64_t size = std::min(kProbeSize, nbytes - position);
+      const char* data = probe;
+      if (content != nullptr) {
+        data = content.get() + position;
+      } else {
+        auto r = ifp_->ReadAt(offset + position, size, probe);
+        if (!r.ok() || r.ValueUnsafe() <= 0) {
+          return nbytes;
+        }
+        size = r.ValueUnsafe();
+      }
+      auto found = static_cast<const char*>(memchr(data, '\n', size));
+      if (found != nullptr) {
+        return position + (found - data) + 1;
+      }
+      position += size;
+    }
+    return nbytes;
+  };
+
+  // sub-split the part at line breaks, to be parsed by multiple threads
+  constexpr int64_t kMinSliceSize = 8 * 1024 * 1024;
+  int64_t slice_num = std::max<int64_t>(
+      1, std::min<int64_t>(parse_concurrency_, nbytes / kMinSliceSize));
+  std::vector<int64_t> slice_offsets{0};
+  for (int64_t i = 1; i < slice_num; ++i) {
+    int64_t position =
+        next_line(std::max(slice_offsets.back(), i * (nbytes / slice_num)));
+    if (position < nbytes) {
+      slice_offsets.push_back(position);
+    }
+  }
+  slice_offsets.push_back(nbytes);
+  slice_num = slice_offsets.size() - 1;
+
+  if (slice_num > 1) {
+    read_options.use_threads = false;
+    // infer the column types once from a sample, thus all slices yield the
+    // same schema
+    {
+      std::shared_ptr<arrow::Table> sample;
+      int64_t sample_end = next_line(std::min(nbytes, kMinSliceSize / 8));
+      RETURN_ON_ERROR(
+          read_slice(0, sample_end, read_options, convert_options, &sample));
+      if (sample != nullptr) {
+        for (auto const& field : sample->schema()->fields()) {
+          if (field->type()->id() != arrow::Type::NA) {
+            convert_options.column_types.emplace(field->name(),
+                                                 field->type());
+          }
+        }
+      }
+    }
+
+    std::vector<std::shared_ptr<arrow::Table>> slices(slice_num);
+    std::vector<std::future<Status>> readers;
+    for (int64_t i = 0; i < slice_num; ++i) {
+      readers.emplace_back(std::async(std::launch::async, [&, i]() {
+        return read_slice(slice_offsets[i], slice_offsets[i + 1],
+                          read_options, convert_options, &slices[i]);
+      }));
+    }
+    Status status;
+    for (auto& reader : readers) {
+      status &= reader.get();
+    }
+    RETURN_ON_ERROR(status);
+
+    std::vector<std::shared_ptr<arrow::Table>> tables;
+    bool consistent = true;
+    for (auto const& slice : slices) {
+      if (slice == nullptr || slice->num_rows() == 0) {
+        continue;
+      }
+      if (!tables.empty() && !slice->schema()->Equals(tables[0]->schema())) {
+        consistent = false;
+        break;
+      }
+      tables.push_back(slice);
+    }
+    if (consistent) {
+      // concatenates the chunks of slices without copying
+      *table = tables.empty() ? nullptr : ConcatenateTables(tables);
     } else {
-      return Status::ArrowError(result.status());
+      // the types of columns that are empty in the sample are inferred
+      // differently by slices, fallback to read the part as a whole.
+      slice_num = 1;
+      read_options.use_threads = true;
     }
   }
-  *table = result.ValueOrDie();
+  if (slice_num <= 1) {
+    RETURN_ON_ERROR(
+        read_slice(0, nbytes, read_options, convert_options, table));
+  }
+  if (*table == nullptr) {
+    return Status::OK();
+  }
 
   RETURN_ON_ARROW_ERROR((*table)->Validate());
 
@@ -480,12 +900,8 @@ Status LocalIOAdaptor::WriteLine(const std::string& line) {
     return Status::IOError("The file hasn't been opened in write mode: " +
                            location_);
   }
-  auto status = ofp_->Write(line.c_str(), line.size());
-  if (status.ok()) {
-    return Status::ArrowError(ofp_->Write("\n", 1));
-  } else {
-    return Status::ArrowError(status);
-  }
+  RETURN_ON_ERROR(bufferedWrite(line.c_str(), line.size()));
+  return bufferedWrite("\n", 1);
 }
 
 Status LocalIOAdaptor::Seek(const int64_t offset) {
@@ -558,12 +974,157 @@ Status LocalIOAdaptor::Read(void* buffer, size_t size) {
   }
 }
 
+Status LocalIOAdaptor::ReadAt(const int64_t offset, void* buffer, size_t size,
+                              int64_t& nread) {
+  if (ifp_ == nullptr) {
+    return Status::IOError("The file hasn't been opened in read mode: " +
+                           location_);
+  }
+  RETURN_ON_ARROW_ERROR_AND_ASSIGN(nread, ifp_->ReadAt(offset, size, buffer));
+  return Status::OK();
+}
+
+std::future<Status> LocalIOAdaptor::ReadAsync(int64_t offset, void* buffer,
+                                              size_t size, int64_t* nread) {
+  if (async_reader_ != nullptr) {
+    return async_reader_->ReadAsync(offset, buffer, size, nread);
+  }
+  if (range_reader_ != nullptr) {
+    return range_reader_->ReadAsync(offset, buffer, size, nread);
+  }
+  return std::async(std::launch::async,
+                    [this, offset, buffer, size, nread]() -> Status {
+                      int64_t nbytes = 0;
+                      RETURN_ON_ERROR(ReadAt(offset, buffer, size, nbytes));
+                      if (nread != nullptr) {
+                        *nread = nbytes;
+                      }
+                      return Status::OK();
+                    });
+}
+
+unsigned LocalIOAdaptor::ReadDepth() const {
+  if (range_reader_ != nullptr) {
+    return range_reader_->Concurrency();
+  }
+  // the local reads are fast enough to overlap with a single block
+  return 2;
+}
+
 Status LocalIOAdaptor::Write(void* buffer, size_t size) {
   if (ofp_ == nullptr) {
     return Status::IOError("The file hasn't been opened in write mode: " +
                            location_);
   }
-  return Status::ArrowError(ofp_->Write(buffer, size));
+  return bufferedWrite(static_cast<const char*>(buffer), size);
+}
+
+Status LocalIOAdaptor::WriteTable(std::shared_ptr<arrow::Table> table) {
+  if (ofp_ == nullptr) {
+    return Status::IOError("The file hasn't been opened in write mode: " +
+                           location_);
+  }
+  if (format_ == "parquet") {
+#if defined(VINEYARD_WITH_PARQUET)
+    if (parquet_writer_ == nullptr) {
+      // the row groups are written to the output stream directly
+      RETURN_ON_ERROR(drainWrites());
+      std::unique_ptr<parquet::arrow::FileWriter> writer;
+#if defined(ARROW_VERSION) && ARROW_VERSION >= 11000000
+      RETURN_ON_ARROW_ERROR_AND_ASSIGN(
+          writer,
+          parquet::arrow::FileWriter::Open(
+              *table->schema(), arrow::default_memory_pool(), ofp_));
+#else
+      RETURN_ON_ARROW_ERROR(parquet::arrow::FileWriter::Open(
+          *table->schema(), arrow::default_memory_pool(), ofp_,
+          parquet::default_writer_properties(),
+          parquet::default_arrow_writer_properties(), &writer));
+#endif
+      parquet_writer_ = std::move(writer);
+    }
+    return Status::ArrowError(
+        parquet_writer_->WriteTable(*table, table->num_rows()));
+#else
+    return Status::NotImplemented("Writing parquet files requires parquet");
+#endif
+  }
+  if (format_ != "csv") {
+    return Status::NotImplemented("Writing tables as " + format_);
+  }
+#if defined(ARROW_VERSION) && ARROW_VERSION >= 4000000
+  auto options = arrow::csv::WriteOptions::Defaults();
+  options.include_header = header_row_ && !header_written_;
+#if ARROW_VERSION >= 8000000
+  options.delimiter = delimiter_;
+#else
+  if (delimiter_ != ',') {
+    return Status::NotImplemented("Writing CSV with delimiter '" +
+                                  std::string(1, delimiter_) + "'");
+  }
+#endif
+  header_written_ = true;
+  std::shared_ptr<arrow::io::BufferOutputStream> sink;
+  RETURN_ON_ARROW_ERROR_AND_ASSIGN(
+      sink, arrow::io::BufferOutputStream::Create(
+                write_block_size_, arrow::default_memory_pool()));
+  RETURN_ON_ARROW_ERROR(arrow::csv::WriteCSV(*table, options, sink.get()));
+  std::shared_ptr<arrow::Buffer> buffer;
+  RETURN_ON_ARROW_ERROR_AND_ASSIGN(buffer, sink->Finish());
+  return bufferedWrite(reinterpret_cast<const char*>(buffer->data()),
+                       buffer->size());
+#else
+  return Status::NotImplemented("Writing CSV requires arrow >= 4.0");
+#endif
+}
+
+Status LocalIOAdaptor::bufferedWrite(const char* data, size_t size) {
+  if (write_buffers_[0] == nullptr) {
+    write_buffers_[0].reset(new char[write_block_size_]);
+    write_buffers_[1].reset(new char[write_block_size_]);
+  }
+  while (size > 0) {
+    if (write_size_ == 0 && size >= write_block_size_) {
+      // large writes go to the output stream directly, in order
+      if (writing_.valid()) {
+        RETURN_ON_ERROR(writing_.get());
+      }
+      return Status::ArrowError(ofp_->Write(data, size));
+    }
+    size_t nbytes = std::min(size, write_block_size_ - write_size_);
+    memcpy(write_buffers_[write_index_].get() + write_size_, data, nbytes);
+    write_size_ += nbytes;
+    data += nbytes;
+    size -= nbytes;
+    if (write_size_ == write_block_size_) {
+      RETURN_ON_ERROR(submitWrite());
+    }
+  }
+  return Status::OK();
+}
+
+Status LocalIOAdaptor::submitWrite() {
+  if (writing_.valid()) {
+    RETURN_ON_ERROR(writing_.get());
+  }
+  const char* buffer = write_buffers_[write_index_].get();
+  const size_t size = write_size_;
+  writing_ = std::async(std::launch::async, [this, buffer, size]() {
+    return Status::ArrowError(ofp_->Write(buffer, size));
+  });
+  write_index_ = 1 - write_index_;
+  write_size_ = 0;
+  return Status::OK();
+}
+
+Status LocalIOAdaptor::drainWrites() {
+  if (write_size_ > 0) {
+    RETURN_ON_ERROR(submitWrite());
+  }
+  if (writing_.valid()) {
+    RETURN_ON_ERROR(writing_.get());
+  }
+  return Status::OK();
 }
 
 Status LocalIOAdaptor::Flush() {
@@ -571,21 +1132,37 @@ Status LocalIOAdaptor::Flush() {
     return Status::IOError("The file hasn't been opened in write mode: " +
                            location_);
   }
+  RETURN_ON_ERROR(drainWrites());
   return Status::ArrowError(ofp_->Flush());
 }
 
 Status LocalIOAdaptor::Close() {
   Status s1, s2;
+  if (async_reader_) {
+    VINEYARD_DISCARD(async_reader_->Close());
+    async_reader_.reset();
+  }
+  // waits for the inflight range reads
+  range_reader_.reset();
   if (ifp_) {
     s1 = Status::ArrowError(ifp_->Close());
   }
   if (ofp_) {
+    s2 = drainWrites();
+#if defined(VINEYARD_WITH_PARQUET)
+    if (parquet_writer_ != nullptr) {
+      // writes the footer
+      s2 &= Status::ArrowError(parquet_writer_->Close());
+    }
+#endif
+    parquet_writer_.reset();
     auto status = ofp_->Flush();
     if (status.ok()) {
-      s2 = Status::ArrowError(ofp_->Close());
+      s2 &= Status::ArrowError(ofp_->Close());
     } else {
-      s2 = Status::ArrowError(status);
+      s2 &= Status::ArrowError(status);
     }
+    ofp_.reset();
   }
   return s1 & s2;
 }
@@ -617,7 +1194,7 @@ void LocalIOAdaptor::Init() {}
 void LocalIOAdaptor::Finalize() {}
 
 const bool LocalIOAdaptor::registered_ = IOFactory::Register(
-    {"file", "hdfs", "s3"},
+    {"file", "hdfs", "s3", "oss"},
     static_cast<IOFactory::io_initializer_t>(&LocalIOAdaptor::Make));
 
 }  // namespace vineyard
@@ -16,9 +16,12 @@ limitations under the License.
 #ifndef MODULES_IO_IO_LOCAL_IO_ADAPTOR_H_
 #define MODULES_IO_IO_LOCAL_IO_ADAPTOR_H_
 
+#include <algorithm>
 #include <fstream>
+#include <future>
 #include <memory>
 #include <string>
+#include <thread>
 #include <unordered_map>
 #include <vector>
 
@@ -26,10 +29,19 @@ limitations under the License.
 #include "arrow/filesystem/api.h"
 #include "arrow/io/api.h"
 
+#include "basic/ds/arrow_memory_pool.h"
 #include "common/util/functions.h"
 #include "common/util/status.h"
+#include "io/io/async_file_reader.h"
 #include "io/io/i_io_adaptor.h"
 #include "io/io/io_factory.h"
+#include "io/io/range_reader.h"
+
+namespace parquet {
+namespace arrow {
+class FileWriter;
+}  // namespace arrow
+}  // namespace parquet
 
 namespace vineyard {
 // FIXME: do not use fixed value, expend to double space when read to a
@@ -83,6 +95,18 @@ class LocalIOAdaptor : public IIOAdaptor {
 
   Status Read(void* buffer, size_t size) override;
 
+  /** Read at most `size` bytes at the given `offset` of the file, without
+   * moving the file stream pointer, thus it is safe to be called from
+   * multiple threads.
+   *
+   * @param nread the number of bytes been read, zero means the end of file.
+   */
+  Status ReadAt(const int64_t offset, void* buffer, size_t size,
+                int64_t& nread);
+
+  std::future<Status> ReadAsync(int64_t offset, void* buffer, size_t size,
+                                int64_t* nread) override;
+
   Status Write(void* buffer, size_t size) override;
 
   Status Flush() override;
@@ -102,8 +126,21 @@ class LocalIOAdaptor : public IIOAdaptor {
 
   Status GetPartialReadDetail(int64_t& offset, int64_t& nbytes);
 
+  /**
+   * The number of blocks that are worth being read ahead with `ReadAsync`,
+   * i.e., the concurrency of range reads for remote file systems.
+   */
+  unsigned ReadDepth() const;
+
   Status ReadTable(std::shared_ptr<arrow::Table>* table) override;
 
+  /**
+   * Write the table in the format of the file, i.e., formatted as CSV by
+   * arrow's (vectorized) CSV writer, or as row groups of a parquet file.
+   * The header of CSV is only written for the first table.
+   */
+  Status WriteTable(std::shared_ptr<arrow::Table> table) override;
+
   Status ReadPartialTable(std::shared_ptr<arrow::Table>* table, int index);
 
   Status Seek(const int64_t offset);
@@ -120,11 +157,50 @@ class LocalIOAdaptor : public IIOAdaptor {
   Status setPartialReadImpl();
   int64_t getDistanceToLineBreak(const int index);
 
+  // allocates from vineyard if connected, thus the tables are sealable
+  // without copying.
+  arrow::MemoryPool* memoryPool();
+  Status resolveColumnIndices(const arrow::Schema& schema,
+                              std::vector<int>& indices);
+  Status readParquetTable(std::shared_ptr<arrow::Table>* table);
+  Status readORCTable(std::shared_ptr<arrow::Table>* table);
+
+  // appends to the write buffer, full blocks are written in background
+  Status bufferedWrite(const char* data, size_t size);
+  // hands the filled buffer over to the background write
+  Status submitWrite();
+  // waits for the background write, and writes the rest of the buffer
+  Status drainWrites();
+
   std::string location_;
+  // "csv", "parquet" or "orc", from the "format" argument or the extension
+  std::string format_;
+  Client* client_ = nullptr;
+  std::unique_ptr<VineyardMemoryPool> memory_pool_;
   char buff[LINESIZE];
   std::shared_ptr<arrow::fs::FileSystem> fs_;
   std::shared_ptr<arrow::io::RandomAccessFile> ifp_;  // for input
   std::shared_ptr<arrow::io::OutputStream> ofp_;      // for output
+  // the writes are double-buffered: one buffer is filled while the other is
+  // being written, configured by the "write_block_size"
+  size_t write_block_size_ = 4 * 1024 * 1024;
+  std::unique_ptr<char[]> write_buffers_[2];
+  int write_index_ = 0;
+  size_t write_size_ = 0;
+  std::future<Status> writing_;
+  bool header_written_ = false;
+  std::shared_ptr<parquet::arrow::FileWriter> parquet_writer_;
+  // for asynchronous reads, configured by the "queue_depth"
+  unsigned queue_depth_ = 32;
+  std::unique_ptr<AsyncFileReader> async_reader_;
+  // for concurrent range reads of remote files (e.g., on s3, oss and hdfs),
+  // configured by the "read_concurrency" and "read_retries"
+  unsigned read_concurrency_ = 16;
+  unsigned read_retries_ = 3;
+  std::unique_ptr<RangeReader> range_reader_;
+  // the number of threads that parse a part, configured by the
+  // "parse_concurrency"
+  int parse_concurrency_ = std::max(1u, std::thread::hardware_concurrency());
 
   // for arrow
   std::vector<std::string> columns_;
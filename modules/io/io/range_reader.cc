@@ -0,0 +1,110 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+
+#include "io/io/range_reader.h"
+
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "glog/logging.h"
+
+namespace vineyard {
+
+RangeReader::RangeReader(std::shared_ptr<arrow::io::RandomAccessFile> file,
+                         const unsigned concurrency, const unsigned retries)
+    : file_(file), concurrency_(std::max(1u, concurrency)), retries_(retries) {
+  for (unsigned index = 0; index < concurrency_; ++index) {
+    workers_.emplace_back([this]() { this->serve(); });
+  }
+}
+
+RangeReader::~RangeReader() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopped_ = true;
+  }
+  pending_cv_.notify_all();
+  for (auto& worker : workers_) {
+    if (worker.joinable()) {
+      worker.join();
+    }
+  }
+  for (auto& request : pending_) {
+    request->promise.set_value(
+        Status::IOError("The range reader has been closed"));
+  }
+}
+
+std::future<Status> RangeReader::ReadAsync(const int64_t offset, void* buffer,
+                                           const size_t size, int64_t* nread) {
+  std::unique_ptr<request_t> request(new request_t{
+      offset, static_cast<char*>(buffer), size, nread, std::promise<Status>()});
+  auto future = request->promise.get_future();
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    pending_.emplace_back(std::move(request));
+  }
+  pending_cv_.notify_one();
+  return future;
+}
+
+Status RangeReader::read(request_t& request) {
+  int64_t done = 0;
+  unsigned attempts = 0;
+  while (done < static_cast<int64_t>(request.size)) {
+    auto result = file_->ReadAt(request.offset + done, request.size - done,
+                                request.buffer + done);
+    if (!result.ok()) {
+      if (attempts++ >= retries_) {
+        return Status::ArrowError(result.status());
+      }
+      VLOG(2) << "Retry the read at " << (request.offset + done) << " after "
+              << result.status().ToString();
+      std::this_thread::sleep_for(std::chrono::milliseconds(100 << attempts));
+      continue;
+    }
+    if (result.ValueUnsafe() == 0) {
+      break;  // end of file
+    }
+    done += result.ValueUnsafe();
+  }
+  if (request.nread != nullptr) {
+    *request.nread = done;
+  }
+  return Status::OK();
+}
+
+void RangeReader::serve() {
+  while (true) {
+    std::unique_ptr<request_t> request;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      pending_cv_.wait(lock,
+                       [this]() { return stopped_ || !pending_.empty(); });
+      if (stopped_) {
+        return;
+      }
+      request = std::move(pending_.front());
+      pending_.pop_front();
+    }
+    request->promise.set_value(read(*request));
+  }
+}
+
+}  // namespace vineyard
@@ -0,0 +1,89 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+
+#ifndef MODULES_IO_IO_RANGE_READER_H_
+#define MODULES_IO_IO_RANGE_READER_H_
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "arrow/io/api.h"
+
+#include "common/util/status.h"
+
+namespace vineyard {
+
+/**
+ * @brief RangeReader issues positional reads of a remote file (e.g., on S3,
+ * OSS or HDFS) concurrently, each of which becomes a range request of the
+ * object store, thus a single reader is able to saturate the bandwidth of the
+ * object store rather than a single connection.
+ *
+ * Failed reads are retried with exponential backoff, as transient errors
+ * (e.g., throttling, connection resets) are common for object stores.
+ */
+class RangeReader {
+ public:
+  RangeReader(std::shared_ptr<arrow::io::RandomAccessFile> file,
+              const unsigned concurrency = 16, const unsigned retries = 3);
+
+  ~RangeReader();
+
+  unsigned Concurrency() const { return concurrency_; }
+
+  /**
+   * @brief Read `size` bytes at `offset` into `buffer`, which must be kept
+   * alive until the returned future is ready.
+   *
+   * @param nread The number of bytes been read when the read completes, less
+   * than `size` only at the end of file, can be nullptr.
+   */
+  std::future<Status> ReadAsync(const int64_t offset, void* buffer,
+                                const size_t size, int64_t* nread = nullptr);
+
+ private:
+  struct request_t {
+    int64_t offset;
+    char* buffer;
+    size_t size;
+    int64_t* nread;
+    std::promise<Status> promise;
+  };
+
+  Status read(request_t& request);
+
+  void serve();
+
+  std::shared_ptr<arrow::io::RandomAccessFile> file_;
+  const unsigned concurrency_;
+  const unsigned retries_;
+
+  std::vector<std::thread> workers_;
+  std::mutex mutex_;
+  std::condition_variable pending_cv_;
+  std::deque<std::unique_ptr<request_t>> pending_;
+  bool stopped_ = false;
+};
+
+}  // namespace vineyard
+
+#endif  // MODULES_IO_IO_RANGE_READER_H_
@@ -205,6 +205,47 @@ class ParallelStreamLauncher(ScriptLauncher):
         vineyard_rpc_client.put_name(gdf, name)
 
 
+class ParallelStreamDriverLauncher(ParallelStreamLauncher):
+    """Launch the :code:`io_driver` once per host, which runs the tasks of all
+    partitions on that host inside a single process, rather than a process per
+    partition.
+    """
+    def __init__(self, deployment="ssh"):
+        super(ParallelStreamDriverLauncher, self).__init__(deployment)
+        self._slots = []
+
+    def run(self, *args, **kwargs):
+        kwargs = kwargs.copy()
+        self.vineyard_endpoint = kwargs.pop("vineyard_endpoint", None)
+        if ":" in self.vineyard_endpoint:
+            self.vineyard_endpoint = tuple(self.vineyard_endpoint.split(":"))
+
+        hosts = kwargs.pop("hosts", ["localhost"])
+        num_workers = kwargs.pop("num_workers", len(hosts))
+
+        nh = len(hosts)
+        slots = [num_workers // nh + int(i < num_workers % nh) for i in range(nh)]
+        proc_idx = 0
+        for host, nproc in zip(hosts, slots):
+            if nproc == 0:
+                continue
+            launcher = StreamLauncher(deployment=self.deployment)
+            launcher.run(host, *(args + (num_workers, proc_idx, nproc)), **kwargs)
+            proc_idx += nproc
+            self._procs.append(launcher)
+            self._slots.append(nproc)
+
+    def wait(self, timeout=None, func=None):
+        partial_ids = []
+        for proc, nproc in zip(self._procs, self._slots):
+            for _ in range(nproc):
+                partial_ids.append(proc.wait(timeout=timeout))
+        logger.debug("partial_ids = %s", partial_ids)
+        if func is None:
+            return self.create_parallel_stream(partial_ids)
+        return func(self.vineyard_endpoint, partial_ids)
+
+
 def get_executable(name):
     return f"vineyard_{name}"
 
@@ -295,8 +336,19 @@ def read_dataframe(path, vineyard_socket, *args, **kwargs):
     path = json.dumps(path)
     storage_options = kwargs.pop("storage_options", {})
     read_options = kwargs.pop("read_options", {})
+    # the native driver takes the read options as the fragment of the location
+    location = json.loads(path)
+    if read_options:
+        location += "#" + "&".join("%s=%s" % (k, v) for k, v in read_options.items())
     storage_options = base64.b64encode(json.dumps(storage_options).encode("utf-8")).decode("utf-8")
     read_options = base64.b64encode(json.dumps(read_options).encode("utf-8")).decode("utf-8")
+    driver = kwargs.pop("driver", None)
+    if driver == "native" and ".orc" not in path:
+        # reads and parses in the same process, without the byte streams in between
+        deployment = kwargs.pop("deployment", "ssh")
+        launcher = ParallelStreamDriverLauncher(deployment)
+        launcher.run(get_executable("io_driver"), vineyard_socket, "read_dataframe", location, *args, **kwargs)
+        return launcher.wait()
     if ".orc" in path:
         logger.debug("Read Orc file from %s.", path)
         return read_orc(path, vineyard_socket, storage_options, read_options, *args, **kwargs.copy())
@@ -96,6 +96,20 @@ def pytest_addoption(parser):
         help='Test with object migration enabled',
     )
 
+    parser.addoption(
+        '--with-kafka',
+        action='store_true',
+        default=False,
+        help='Test with kafka enabled',
+    )
+
+    parser.addoption(
+        '--kafka-endpoint',
+        action='store',
+        default='127.0.0.1:9092',
+        help='Kafka brokers that will be used to run vineyard tests',
+    )
+
 
 @pytest.fixture(scope='session')
 def vineyard_ipc_socket(request):
@@ -147,6 +161,16 @@ def with_migration(request):
     return request.config.option.with_migration
 
 
+@pytest.fixture(scope='session')
+def with_kafka(request):
+    return request.config.option.with_kafka
+
+
+@pytest.fixture(scope='session')
+def kafka_endpoint(request):
+    return request.config.option.kafka_endpoint
+
+
 @pytest.fixture(scope='session')
 def vineyard_client(request):
     ipc_socket = request.config.option.vineyard_ipc_socket
@@ -168,6 +192,11 @@ def pytest_configure(config):
         "skip_without_migration(): skip migration tests if object migration is not available",
     )
 
+    config.addinivalue_line(
+        "markers",
+        "skip_without_kafka(): skip kafka tests if kafka service is not available",
+    )
+
 
 def pytest_runtest_setup(item):
     markers = [mark for mark in item.iter_markers(name='skip_without_hdfs')]
@@ -180,5 +209,10 @@ def pytest_runtest_setup(item):
         if not item.config.option.with_migration:
             pytest.skip('Skip since object migration is not available')
 
+    markers = [mark for mark in item.iter_markers(name='skip_without_kafka')]
+    if markers:
+        if not item.config.option.with_kafka:
+            pytest.skip('Skip since kafka service is not available')
+
 
 pytest_plugins = []
@@ -0,0 +1,129 @@
+#! /usr/bin/env python
+# -*- coding: utf-8 -*-
+#
+# Copyright 2020-2021 Alibaba Group Holding Limited.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+
+""" How to run those test:
+
+    * Step 1: setup a vineyard server and a kafka broker (with topics created
+      automatically):
+
+        vineyardd --socket=/tmp/vineyard.sock
+
+    * Step 2: using pytest to run the following tests:
+
+    .. code:: console
+
+        pytest modules/io/python/drivers/io/tests/test_kafka.py \
+                --vineyard-ipc-socket=/tmp/vineyard.sock \
+                --vineyard-endpoint=127.0.0.1:9600 \
+                --test-dataset=<directory of gstest> \
+                --with-kafka \
+                --kafka-endpoint=127.0.0.1:9092
+"""
+
+import json
+import time
+
+import pyarrow as pa
+import pytest
+
+import vineyard
+from vineyard.drivers.io.stream import ParallelStreamLauncher, StreamLauncher, get_executable
+
+
+def produce(vineyard_ipc_socket, vineyard_endpoint, path, address):
+    launcher = ParallelStreamLauncher()
+    launcher.run(
+        get_executable("read_local_bytes"),
+        vineyard_ipc_socket,
+        path,
+        vineyard_endpoint=vineyard_endpoint,
+    )
+    stream = launcher.wait()
+    launcher = ParallelStreamLauncher()
+    launcher.run(
+        get_executable("write_kafka_bytes"),
+        vineyard_ipc_socket,
+        stream,
+        address,
+        vineyard_endpoint=vineyard_endpoint,
+    )
+    launcher.join()
+
+
+def consume(vineyard_ipc_socket, executable, address, *args):
+    # the consumers keep polling the topic, thus never finish
+    launcher = StreamLauncher()
+    launcher.run("localhost", get_executable(executable), vineyard_ipc_socket, address, 1, 0, *args)
+    stream_id = launcher.wait()
+    client = vineyard.connect(vineyard_ipc_socket)
+    return launcher, client, client.get_object(stream_id).open_reader(client)
+
+
+@pytest.mark.skip_without_kafka()
+def test_kafka_bytes(vineyard_ipc_socket, vineyard_endpoint, test_dataset, kafka_endpoint):
+    topic = "vineyard_test_bytes_%d" % int(time.time())
+    address = "%s/%s/vineyard_test/1" % (kafka_endpoint, topic)
+    produce(vineyard_ipc_socket, vineyard_endpoint, "%s/p2p-31.e" % test_dataset, address)
+    with open("%s/p2p-31.e" % test_dataset, "r") as f:
+        expected = [line for line in f.read().split("\n") if line]
+
+    launcher, _, reader = consume(vineyard_ipc_socket, "read_kafka_bytes", address)
+    lines, chunks = [], 0
+    try:
+        while len(lines) < len(expected):
+            chunk = reader.next()
+            lines.extend(line for line in bytes(chunk).decode("utf-8").split("\n") if line)
+            chunks += 1
+    finally:
+        launcher.dispose()
+    # the messages of a partition are kept in order, and a chunk takes a
+    # batch of messages, rather than a single one
+    assert lines == expected
+    assert chunks < len(expected)
+
+
+@pytest.mark.skip_without_kafka()
+def test_kafka_dataframe(vineyard_ipc_socket, vineyard_endpoint, test_dataset_tmp, kafka_endpoint):
+    topic = "vineyard_test_dataframe_%d" % int(time.time())
+    address = "%s/%s/vineyard_test/1" % (kafka_endpoint, topic)
+    num_messages = 10000
+    with open("%s/messages.json" % test_dataset_tmp, "w") as f:
+        for i in range(num_messages):
+            f.write(json.dumps({"id": i, "name": "name-%d" % i, "score": i * 0.5}) + "\n")
+    produce(vineyard_ipc_socket, vineyard_endpoint, "%s/messages.json" % test_dataset_tmp, address)
+
+    launcher, _, reader = consume(vineyard_ipc_socket, "read_kafka_dataframe", address, "json")
+    batches = []
+    try:
+        while sum(batch.num_rows for batch in batches) < num_messages:
+            content = reader.next()
+            buf_reader = pa.ipc.open_stream(pa.py_buffer(content))
+            while True:
+                try:
+                    batches.append(buf_reader.read_next_batch())
+                except StopIteration:
+                    break
+    finally:
+        launcher.dispose()
+    # the messages are decoded into tables of the same schema
+    for batch in batches:
+        assert batch.schema.equals(batches[0].schema)
+    df = pa.Table.from_batches(batches).to_pandas()
+    assert list(df["id"]) == list(range(num_messages))
+    assert list(df["name"]) == ["name-%d" % i for i in range(num_messages)]
+    assert list(df["score"]) == [i * 0.5 for i in range(num_messages)]
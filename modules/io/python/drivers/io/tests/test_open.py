@@ -49,6 +49,7 @@ from urllib.parse import urlparse
 
 import vineyard
 import vineyard.io
+from vineyard.drivers.io.stream import ParallelStreamLauncher, get_executable, parse_bytes_to_dataframe
 
 
 def test_local_with_header(vineyard_ipc_socket, vineyard_endpoint, test_dataset, test_dataset_tmp):
@@ -91,6 +92,85 @@ def test_local_without_header(vineyard_ipc_socket, vineyard_endpoint, test_datas
     assert filecmp.cmp("%s/p2p-31.e" % test_dataset, "%s/p2p-31.out_0" % test_dataset_tmp)
 
 
+@pytest.mark.parametrize("header_row", [True, False])
+def test_local_native_driver(vineyard_ipc_socket, vineyard_endpoint, test_dataset, test_dataset_tmp, header_row):
+    read_options = {"header_row": header_row, "delimiter": " "}
+    for driver in ["native", None]:
+        stream = vineyard.io.open(
+            "file://%s/p2p-31.e" % test_dataset,
+            vineyard_ipc_socket=vineyard_ipc_socket,
+            vineyard_endpoint=vineyard_endpoint,
+            read_options=read_options,
+            driver=driver,
+        )
+        vineyard.io.open(
+            "file://%s/p2p-31.%s.out" % (test_dataset_tmp, driver or "process"),
+            stream,
+            mode="w",
+            vineyard_ipc_socket=vineyard_ipc_socket,
+            vineyard_endpoint=vineyard_endpoint,
+        )
+    # reads the same content as the process-based readers
+    assert filecmp.cmp("%s/p2p-31.native.out_0" % test_dataset_tmp, "%s/p2p-31.process.out_0" % test_dataset_tmp)
+    assert filecmp.cmp("%s/p2p-31.e" % test_dataset, "%s/p2p-31.native.out_0" % test_dataset_tmp)
+
+
+@pytest.mark.parametrize("parse_concurrency", ["1", "4"])
+def test_local_concurrent_parsing(vineyard_ipc_socket, vineyard_endpoint, test_dataset_tmp, parse_concurrency):
+    # spans many chunks of the byte stream, which are parsed concurrently
+    generate_large_file("%s/large.csv" % test_dataset_tmp)
+    stream = vineyard.io.open(
+        "file://%s/large.csv" % test_dataset_tmp,
+        vineyard_ipc_socket=vineyard_ipc_socket,
+        vineyard_endpoint=vineyard_endpoint,
+        read_options={
+            "header_row": False,
+            "delimiter": ",",
+            "parse_concurrency": parse_concurrency,
+        },
+    )
+    vineyard.io.open(
+        "file://%s/large.%s.out" % (test_dataset_tmp, parse_concurrency),
+        stream,
+        mode="w",
+        vineyard_ipc_socket=vineyard_ipc_socket,
+        vineyard_endpoint=vineyard_endpoint,
+    )
+    # the records are kept in order, even those cut at the chunk boundaries
+    assert filecmp.cmp("%s/large.csv" % test_dataset_tmp, "%s/large.%s.out_0" % (test_dataset_tmp, parse_concurrency))
+
+
+def test_local_block_reader(vineyard_ipc_socket, vineyard_endpoint, test_dataset_tmp):
+    # the parts span a few blocks, and don't end at the block boundaries
+    generate_large_file("%s/large.csv" % test_dataset_tmp)
+    launcher = ParallelStreamLauncher()
+    launcher.run(
+        get_executable("read_local_bytes"),
+        vineyard_ipc_socket,
+        "%s/large.csv" % test_dataset_tmp,
+        vineyard_endpoint=vineyard_endpoint,
+        num_workers=3,
+    )
+    stream = launcher.wait()
+    dfstream = parse_bytes_to_dataframe(
+        vineyard_ipc_socket,
+        stream,
+        vineyard_endpoint=vineyard_endpoint,
+        num_workers=3,
+    )
+    vineyard.io.open(
+        "file://%s/large.blocks.out" % test_dataset_tmp,
+        dfstream,
+        mode="w",
+        vineyard_ipc_socket=vineyard_ipc_socket,
+        vineyard_endpoint=vineyard_endpoint,
+        num_workers=3,
+    )
+    # every line is read exactly once, by one of the parts
+    combine_files("%s/large.blocks.out" % test_dataset_tmp)
+    assert filecmp.cmp("%s/large.csv" % test_dataset_tmp, "%s/large.blocks.out" % test_dataset_tmp)
+
+
 @pytest.mark.skip()
 def test_local_orc(vineyard_ipc_socket, vineyard_endpoint, test_dataset, test_dataset_tmp):
     stream = vineyard.io.open(
@@ -455,3 +535,10 @@ def combine_files(prefix):
         for f in sorted(read_files):
             with open(f, "rb") as infile:
                 outfile.write(infile.read())
+
+
+def generate_large_file(path, num_lines=1500000):
+    # larger than a few blocks of the readers, with lines of varied lengths
+    with open(path, "w") as outfile:
+        for i in range(num_lines):
+            outfile.write("%d,%d,%d\n" % (i, i * 7919 % 1000003, i % 13))
@@ -15,59 +15,265 @@ limitations under the License.
 
 #include "malloc/allocator.h"
 
+#include <algorithm>
+#include <atomic>
 #include <cstdint>
+#include <cstring>
+#include <limits>
+#include <map>
 #include <memory>
 #include <mutex>
+#include <string>
+#include <thread>
 #include <utility>
+#include <vector>
 
 #include "client/allocator.h"
 #include "client/client.h"
 #include "client/ds/blob.h"
+#include "common/util/env.h"
 
 namespace vineyard {
 
 namespace detail {
 
-static VineyardAllocator<void>& _DefaultAllocator() {
-  static VineyardAllocator<void>* default_allocator =
-      new VineyardAllocator<void>{};
-  return *default_allocator;
-}
+// the maximum number of arenas that threads are spread across by default
+constexpr int kMaximumSlots = 16;
+
+// the arena size if the memory limit of the server is unknown
+constexpr size_t kDefaultArenaSize = 256UL * 1024 * 1024;
+
+/**
+ * @brief The arenas that serve `vineyard_malloc`, each thread is bound to one
+ * of the arenas, and a new arena is made from the server once the arena of
+ * the thread is exhausted.
+ *
+ * The size of each arena and the number of arenas that threads are spread
+ * across can be specified by the environment variables
+ * `VINEYARD_MALLOC_ARENA_SIZE` (in bytes) and `VINEYARD_MALLOC_ARENAS`. The
+ * arenas are outside the footprint accounting of the server, thus by default
+ * each arena takes the memory limit of the server divided by the number of
+ * slots.
+ */
+class Arenas {
+ public:
+  using allocator_t = VineyardAllocator<void>;
+
+  Arenas() {
+    std::string arena_size = read_env("VINEYARD_MALLOC_ARENA_SIZE");
+    if (!arena_size.empty()) {
+      arena_size_ = std::stoull(arena_size);
+    }
+    std::string arenas = read_env("VINEYARD_MALLOC_ARENAS");
+    if (!arenas.empty()) {
+      slots_ = std::max(1, std::stoi(arenas));
+    } else {
+      slots_ = std::min(
+          kMaximumSlots,
+          std::max(1, static_cast<int>(std::thread::hardware_concurrency())));
+    }
+    bindings_.resize(slots_, nullptr);
+    if (arena_size_ == 0) {
+      std::shared_ptr<InstanceStatus> status;
+      if (vineyard::Client::Default().InstanceStatus(status).ok() &&
+          status->memory_limit > 0) {
+        arena_size_ = std::max<size_t>(status->memory_limit / slots_, 1);
+      } else {
+        arena_size_ = kDefaultArenaSize;
+      }
+    }
+  }
+
+  void* Allocate(const size_t size,
+                 const size_t alignment = alignof(std::max_align_t)) {
+    allocator_t* allocator = bound();
+    if (allocator == nullptr) {
+      return nullptr;
+    }
+    void* pointer = allocator->Allocate(size, alignment);
+    if (pointer == nullptr && alignment <= arena_size_ &&
+        size <= arena_size_ - alignment) {
+      // the arena is exhausted, grow with a new arena, unless the request
+      // wouldn't fit a fresh arena either.
+      allocator = grow(allocator);
+      if (allocator != nullptr) {
+        pointer = allocator->Allocate(size, alignment);
+      }
+    }
+    return pointer;
+  }
+
+  void* Reallocate(void* pointer, const size_t size) {
+    if (pointer == nullptr) {
+      return Allocate(size);
+    }
+    allocator_t* owner = find(pointer);
+    if (owner == nullptr) {
+      return nullptr;
+    }
+    if (void* target = owner->Reallocate(pointer, size)) {
+      return target;
+    }
+    // cannot be grown inside the arena
+    void* target = Allocate(size);
+    if (target != nullptr) {
+      memcpy(target, pointer, std::min(size, owner->GetAllocatedSize(pointer)));
+      owner->Free(pointer);
+    }
+    return target;
+  }
+
+  void Free(void* pointer) {
+    if (allocator_t* owner = find(pointer)) {
+      owner->Free(pointer);
+    }
+  }
+
+  void Freeze(void* pointer) {
+    // the memory may be allocated by any thread
+    if (allocator_t* owner = find(pointer)) {
+      owner->Freeze(pointer);
+    }
+  }
+
+  void Flush() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto& allocator : allocators_) {
+      VINEYARD_CHECK_OK(allocator->Flush());
+    }
+  }
+
+  /**
+   * @brief Release all arenas, requires no concurrent allocations.
+   */
+  void Finalize(const bool renew) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto& allocator : allocators_) {
+      VINEYARD_CHECK_OK(allocator->Release());
+    }
+    std::fill(bindings_.begin(), bindings_.end(), nullptr);
+    std::atomic_store(&ranges_, std::make_shared<const range_map_t>());
+    allocators_.clear();
+    // invalidates the bindings cached by threads
+    generation_ += 1;
+    finalized_ = !renew;
+  }
+
+ private:
+  allocator_t* bound() {
+    thread_local std::pair<uint64_t, allocator_t*> binding{
+        std::numeric_limits<uint64_t>::max(), nullptr};
+    thread_local int slot = next_slot_.fetch_add(1) % slots_;
+    if (binding.first == generation_.load() && binding.second != nullptr) {
+      return binding.second;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (finalized_) {
+      return nullptr;
+    }
+    if (bindings_[slot] == nullptr) {
+      bindings_[slot] = make();
+    }
+    binding = std::make_pair(generation_.load(), bindings_[slot]);
+    return binding.second;
+  }
+
+  allocator_t* grow(allocator_t* exhausted) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (finalized_) {
+      return nullptr;
+    }
+    for (auto& binding : bindings_) {
+      if (binding == exhausted) {
+        binding = make();
+      }
+    }
+    // rebinds the threads of the exhausted arena
+    generation_ += 1;
+    return allocators_.back().get();
+  }
+
+  // requires `mutex_` been held
+  allocator_t* make() {
+    allocators_.emplace_back(
+        new allocator_t(vineyard::Client::Default(), arena_size_));
+    allocator_t* allocator = allocators_.back().get();
+    // the end address of the arena is the key, see also `find`
+    auto ranges = std::make_shared<range_map_t>(*std::atomic_load(&ranges_));
+    ranges->emplace(allocator->Space() + allocator->Size(), allocator);
+    std::atomic_store(&ranges_,
+                      std::shared_ptr<const range_map_t>(std::move(ranges)));
+    return allocator;
+  }
+
+  allocator_t* find(const void* pointer) {
+    if (pointer == nullptr) {
+      return nullptr;
+    }
+    // lock-free, as the ranges are replaced as a whole on growing
+    auto ranges = std::atomic_load(&ranges_);
+    auto iter = ranges->upper_bound(reinterpret_cast<uintptr_t>(pointer));
+    if (iter != ranges->end() && iter->second->Contains(pointer)) {
+      return iter->second;
+    }
+    return nullptr;
+  }
+
+  // 0 means being decided by the memory limit of the server
+  size_t arena_size_ = 0;
+  int slots_ = 1;
+  std::atomic<int> next_slot_{0};
+  std::atomic<uint64_t> generation_{0};
+  bool finalized_ = false;
 
-static std::mutex allocator_mutex;
+  std::mutex mutex_;
+  std::vector<std::unique_ptr<allocator_t>> allocators_;
+  // the arena that each slot of threads is bound to
+  std::vector<allocator_t*> bindings_;
+  // end address of arenas -> allocator
+  using range_map_t = std::map<uintptr_t, allocator_t*>;
+  std::shared_ptr<const range_map_t> ranges_ =
+      std::make_shared<const range_map_t>();
+};
+
+static Arenas& _DefaultArenas() {
+  static Arenas* default_arenas = new Arenas{};
+  return *default_arenas;
+}
 
 }  // namespace detail
 
 }  // namespace vineyard
 
 void* vineyard_malloc(size_t size) {
-  return vineyard::detail::_DefaultAllocator().Allocate(size);
+  return vineyard::detail::_DefaultArenas().Allocate(size);
 }
 
 void* vineyard_calloc(size_t num, size_t size) {
-  return vineyard::detail::_DefaultAllocator().Allocate(num * size);
+  if (size != 0 && num > std::numeric_limits<size_t>::max() / size) {
+    return nullptr;
+  }
+  void* pointer = vineyard::detail::_DefaultArenas().Allocate(num * size);
+  if (pointer != nullptr) {
+    memset(pointer, 0, num * size);
+  }
+  return pointer;
 }
 
 void* vineyard_realloc(void* pointer, size_t size) {
-  return vineyard::detail::_DefaultAllocator().Reallocate(pointer, size);
+  return vineyard::detail::_DefaultArenas().Reallocate(pointer, size);
 }
 
 void vineyard_free(void* pointer) {
-  vineyard::detail::_DefaultAllocator().Free(pointer);
+  vineyard::detail::_DefaultArenas().Free(pointer);
 }
 
 void vineyard_freeze(void* pointer) {
-  std::lock_guard<std::mutex> lock(vineyard::detail::allocator_mutex);
-  vineyard::detail::_DefaultAllocator().Freeze(pointer);
+  vineyard::detail::_DefaultArenas().Freeze(pointer);
 }
 
+void vineyard_allocator_flush() { vineyard::detail::_DefaultArenas().Flush(); }
+
 void vineyard_allocator_finalize(int renew) {
-  std::lock_guard<std::mutex> lock(vineyard::detail::allocator_mutex);
-  vineyard::VineyardAllocator<void>& default_allocator =
-      vineyard::detail::_DefaultAllocator();
-  if (renew) {
-    VINEYARD_CHECK_OK(default_allocator.Renew());
-  } else {
-    VINEYARD_CHECK_OK(default_allocator.Release());
-  }
+  vineyard::detail::_DefaultArenas().Finalize(renew);
 }
@@ -0,0 +1,125 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "migrate/compression.h"
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace vineyard {
+
+// blobs smaller than this are sent as is.
+static constexpr size_t kMinCompressSize = 4096;
+// a leading sample of the blob is compressed first to detect incompressible
+// contents cheaply.
+static constexpr size_t kSampleSize = 64 * 1024;
+// compression is skipped unless it saves at least 10% of the bytes.
+static constexpr double kMaxCompressRatio = 0.9;
+
+static bool parseCompression(std::string const& name,
+                             arrow::Compression::type& type) {
+  if (name == "lz4") {
+    type = arrow::Compression::LZ4_FRAME;
+  } else if (name == "zstd") {
+    type = arrow::Compression::ZSTD;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+std::string BlobCodec::Negotiate(std::string const& name) {
+  std::unique_ptr<BlobCodec> codec;
+  if (Make(name, codec).ok()) {
+    return name;
+  }
+  return "none";
+}
+
+Status BlobCodec::Make(std::string const& name,
+                       std::unique_ptr<BlobCodec>& codec) {
+  arrow::Compression::type type;
+  if (!parseCompression(name, type)) {
+    return Status::Invalid("Unsupported compression for migration: " + name);
+  }
+  std::unique_ptr<arrow::util::Codec> arrow_codec;
+#if defined(ARROW_VERSION) && ARROW_VERSION < 17000
+  RETURN_ON_ERROR(
+      Status::ArrowError(arrow::util::Codec::Create(type, &arrow_codec)));
+#else
+  auto result = arrow::util::Codec::Create(type);
+  RETURN_ON_ERROR(Status::ArrowError(result.status()));
+  arrow_codec = std::move(result).ValueOrDie();
+#endif
+  codec.reset(new BlobCodec(name, std::move(arrow_codec)));
+  return Status::OK();
+}
+
+bool BlobCodec::Compress(const uint8_t* data, const size_t size,
+                         std::vector<uint8_t>& output) {
+  if (size < kMinCompressSize) {
+    return false;
+  }
+  if (size > kSampleSize) {
+    if (!compress(data, kSampleSize, output) ||
+        output.size() > kSampleSize * kMaxCompressRatio) {
+      return false;
+    }
+  }
+  return compress(data, size, output) &&
+         output.size() <= size * kMaxCompressRatio;
+}
+
+Status BlobCodec::Decompress(const uint8_t* data, const size_t size,
+                             uint8_t* output, const size_t output_size) {
+  int64_t decompressed_size = 0;
+#if defined(ARROW_VERSION) && ARROW_VERSION < 17000
+  RETURN_ON_ERROR(Status::ArrowError(codec_->Decompress(
+      size, data, output_size, output, &decompressed_size)));
+#else
+  auto result = codec_->Decompress(size, data, output_size, output);
+  RETURN_ON_ERROR(Status::ArrowError(result.status()));
+  decompressed_size = result.ValueOrDie();
+#endif
+  RETURN_ON_ASSERT(static_cast<size_t>(decompressed_size) == output_size,
+                   "The decompressed blob size doesn't match");
+  return Status::OK();
+}
+
+bool BlobCodec::compress(const uint8_t* data, const size_t size,
+                         std::vector<uint8_t>& output) {
+  output.resize(codec_->MaxCompressedLen(size, data));
+  int64_t compressed_size = 0;
+#if defined(ARROW_VERSION) && ARROW_VERSION < 17000
+  if (!codec_->Compress(size, data, output.size(), output.data(),
+                        &compressed_size)
+           .ok()) {
+    return false;
+  }
+#else
+  auto result = codec_->Compress(size, data, output.size(), output.data());
+  if (!result.ok()) {
+    return false;
+  }
+  compressed_size = result.ValueOrDie();
+#endif
+  output.resize(compressed_size);
+  return true;
+}
+
+}  // namespace vineyard
@@ -0,0 +1,75 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef MODULES_MIGRATE_COMPRESSION_H_
+#define MODULES_MIGRATE_COMPRESSION_H_
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "arrow/util/compression.h"
+
+#include "common/util/status.h"
+
+namespace vineyard {
+
+/**
+ * @brief The on-the-wire codec for blob payloads of migration, backed by the
+ * codecs of arrow. Supported names are "none", "lz4" and "zstd".
+ */
+class BlobCodec {
+ public:
+  /**
+   * @brief Returns the given codec name if it is supported in this build,
+   * otherwise "none".
+   */
+  static std::string Negotiate(std::string const& name);
+
+  static Status Make(std::string const& name,
+                     std::unique_ptr<BlobCodec>& codec);
+
+  std::string const& name() const { return name_; }
+
+  /**
+   * @brief Compress the blob into `output`, returns false if the blob is not
+   * worth compressing, i.e., too small or incompressible (judged from a
+   * sample at first), and the raw bytes should be sent instead.
+   */
+  bool Compress(const uint8_t* data, const size_t size,
+                std::vector<uint8_t>& output);
+
+  /**
+   * @brief Decompress into the destination buffer directly, which must be
+   * exactly the size of the original blob.
+   */
+  Status Decompress(const uint8_t* data, const size_t size, uint8_t* output,
+                    const size_t output_size);
+
+ private:
+  BlobCodec(std::string const& name, std::unique_ptr<arrow::util::Codec> codec)
+      : name_(name), codec_(std::move(codec)) {}
+
+  bool compress(const uint8_t* data, const size_t size,
+                std::vector<uint8_t>& output);
+
+  std::string name_;
+  std::unique_ptr<arrow::util::Codec> codec_;
+};
+
+}  // namespace vineyard
+
+#endif  // MODULES_MIGRATE_COMPRESSION_H_
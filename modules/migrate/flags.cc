@@ -18,8 +18,31 @@ limitations under the License.
 namespace vineyard {
 
 DEFINE_uint64(migration_port, 0, "rpc port of migration");
+DEFINE_uint64(migration_connections, 4,
+              "number of parallel connections for sending blobs");
+DEFINE_string(migration_compression, "none",
+              "codec for blob payloads on the wire: none, lz4 or zstd");
+DEFINE_bool(migration_checksum, false,
+            "send the CRC32C of blobs for the receiver to verify the content");
 DEFINE_string(object_list, "", "object list");
 DEFINE_string(instance_map, "", "instance_mapping");
 DEFINE_string(ipc_socket, "", "ipc socket of vineyard server");
 
+DEFINE_string(source_endpoint, "",
+              "rpc endpoint of the source instance to copy from, the objects "
+              "are pulled in parallel when specified");
+DEFINE_string(copy_pattern, "*", "typename pattern of objects to copy");
+DEFINE_string(copy_name_prefix, "",
+              "only copy the named objects whose names have the prefix");
+DEFINE_uint64(copy_page_size, 1000, "objects listed in a page");
+DEFINE_uint64(copy_parallelism, 4, "number of concurrent copy workers");
+DEFINE_uint64(copy_rpc_streams, 2, "data streams of every copy worker");
+DEFINE_uint64(copy_chunk_size, 4 * 1024 * 1024,
+              "size of chunks that blobs are fetched in");
+DEFINE_string(copy_manifest, "",
+              "manifest of copied objects, for resuming a failed copy");
+DEFINE_bool(copy_names, true, "copy the names of objects as well");
+DEFINE_double(copy_report_interval, 5.0,
+              "interval in seconds of reporting the throughput");
+
 }  // namespace vineyard
@@ -23,10 +23,24 @@ limitations under the License.
 namespace vineyard {
 
 DECLARE_uint64(migration_port);
+DECLARE_uint64(migration_connections);
+DECLARE_string(migration_compression);
+DECLARE_bool(migration_checksum);
 DECLARE_string(object_list);
 DECLARE_string(instance_map);
 DECLARE_string(ipc_socket);
 
+DECLARE_string(source_endpoint);
+DECLARE_string(copy_pattern);
+DECLARE_string(copy_name_prefix);
+DECLARE_uint64(copy_page_size);
+DECLARE_uint64(copy_parallelism);
+DECLARE_uint64(copy_rpc_streams);
+DECLARE_uint64(copy_chunk_size);
+DECLARE_string(copy_manifest);
+DECLARE_bool(copy_names);
+DECLARE_double(copy_report_interval);
+
 }  // namespace vineyard
 
 #endif  // MODULES_MIGRATE_FLAGS_H_
@@ -15,23 +15,75 @@ limitations under the License.
 
 #include "migrate/object_migration.h"
 
+#include <algorithm>
+#include <future>
 #include <limits>
 #include <map>
+#include <memory>
+#include <numeric>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "boost/asio.hpp"
 
+#include "common/memory/checksum.h"
+#include "common/util/functions.h"
 #include "migrate/flags.h"
 #include "migrate/protocols.h"
 
-#define MAX_BUFFER_SIZE 1048576
-
 namespace vineyard {
 
 namespace asio = boost::asio;
 using boost::asio::ip::tcp;
 
+static Status writeMessage(tcp::socket& socket, std::string const& message) {
+  boost::system::error_code ec;
+  size_t length = message.size();
+  asio::write(socket, asio::buffer(&length, sizeof(size_t)), ec);
+  if (!ec) {
+    asio::write(socket, asio::buffer(message, message.size()), ec);
+  }
+  if (ec) {
+    return Status::IOError("Failed to write migration message: " +
+                           ec.message());
+  }
+  return Status::OK();
+}
+
+static Status readMessage(tcp::socket& socket, json& root) {
+  boost::system::error_code ec;
+  size_t length = 0;
+  asio::read(socket, asio::buffer(&length, sizeof(size_t)), ec);
+  std::string message;
+  if (!ec) {
+    message.resize(length);
+    asio::read(socket, asio::buffer(&message[0], message.size()), ec);
+  }
+  if (ec) {
+    return Status::IOError("Failed to read migration message: " +
+                           ec.message());
+  }
+  try {
+    root = json::parse(message);
+  } catch (json::exception const& err) {
+    return Status::Invalid("Malformed migration message: " +
+                           std::string(err.what()));
+  }
+  return Status::OK();
+}
+
+static void logThroughput(std::string const& action, const size_t blobs,
+                          const size_t bytes, const size_t wire_bytes,
+                          const double elapsed) {
+  double mbytes = static_cast<double>(bytes) / (1024 * 1024);
+  double wire_mbytes = static_cast<double>(wire_bytes) / (1024 * 1024);
+  LOG(INFO) << action << " " << blobs << " blobs (" << mbytes << " MB, "
+            << wire_mbytes << " MB on the wire) in " << elapsed
+            << " seconds, throughput: " << (elapsed > 0 ? mbytes / elapsed : 0)
+            << " MB/s";
+}
+
 Status ObjectMigration::Migrate(
     std::unordered_map<InstanceID, InstanceID>& instance_map,
     std::unordered_map<ObjectID, InstanceID>& object_map, Client& client) {
@@ -48,36 +100,86 @@ Status ObjectMigration::Migrate(
   tcp::resolver::query query(hostname, std::to_string(FLAGS_migration_port));
   tcp::resolver::iterator endpoint_iterator = resolver.resolve(query);
   tcp::endpoint endpoint = endpoint_iterator->endpoint();
-  tcp::socket socket(io_service);
-  socket.connect(endpoint);
+  size_t connections = std::max<size_t>(FLAGS_migration_connections, 1);
+  std::vector<std::unique_ptr<tcp::socket>> sockets;
+  for (size_t index = 0; index < connections; ++index) {
+    sockets.emplace_back(new tcp::socket(io_service));
+    boost::system::error_code ec;
+    sockets.back()->connect(endpoint, ec);
+    if (ec) {
+      return Status::IOError("Failed to connect to the migration server: " +
+                             ec.message());
+    }
+  }
+
+  // the metadata goes through the first connection, and the server allocates
+  // all destination blobs at once before any blob is sent.
+  tcp::socket& socket = *sockets[0];
   for (auto object_id : object_ids_) {
     LOG(INFO) << "Start send object " << object_id;
     RETURN_ON_ERROR(sendObjectMeta(object_id, client, socket));
   }
+  std::string message_out;
+  WritePrepareBlobsRequest(instance_id_, connections,
+                           FLAGS_migration_compression, message_out);
+  RETURN_ON_ERROR(writeMessage(socket, message_out));
+  json message_in;
+  size_t num_blobs = 0;
+  std::string compression;
+  RETURN_ON_ERROR(readMessage(socket, message_in));
+  RETURN_ON_ERROR(ReadPrepareBlobsReply(message_in, num_blobs, compression));
+  VLOG(10) << "The migration server has prepared " << num_blobs
+           << " blobs, using compression: " << compression;
+  std::unique_ptr<BlobCodec> codec;
+  if (compression != "none") {
+    RETURN_ON_ERROR(BlobCodec::Make(compression, codec));
+  }
+
+  // balance the blobs over connections, from the largest one.
+  std::vector<std::shared_ptr<Blob>> blobs;
+  size_t total_size = 0;
   for (auto blob_id : blob_list_) {
-    std::shared_ptr<Blob> target_blob =
-        std::dynamic_pointer_cast<Blob>(client.GetObject(blob_id));
-    size_t remain_size = target_blob->size();
-    std::string message_out;
-    WriteSendBlobBufferRequest(blob_id, remain_size, message_out);
-    size_t length = message_out.size();
-    boost::asio::write(socket, asio::buffer(&length, sizeof(size_t)));
-    boost::asio::write(socket, asio::buffer(message_out, message_out.size()));
-    size_t offset = 0;
-    while (remain_size) {
-      size_t send_size =
-          remain_size < MAX_BUFFER_SIZE ? remain_size : MAX_BUFFER_SIZE;
-      boost::asio::write(socket,
-                         asio::buffer(target_blob->data() + offset, send_size));
-      remain_size -= send_size;
-      offset += send_size;
-    }
+    auto blob = std::dynamic_pointer_cast<Blob>(client.GetObject(blob_id));
+    RETURN_ON_ASSERT(blob != nullptr, "Failed to get blob to migrate");
+    total_size += blob->size();
+    blobs.emplace_back(blob);
+  }
+  std::sort(blobs.begin(), blobs.end(),
+            [](std::shared_ptr<Blob> const& lhs,
+               std::shared_ptr<Blob> const& rhs) {
+              return lhs->size() > rhs->size();
+            });
+  std::vector<std::vector<std::shared_ptr<Blob>>> assignments(connections);
+  std::vector<size_t> loads(connections, 0);
+  for (auto const& blob : blobs) {
+    size_t index = std::min_element(loads.begin(), loads.end()) - loads.begin();
+    assignments[index].emplace_back(blob);
+    loads[index] += blob->size();
   }
-  std::string message_exit;
-  WriteExitRequest(message_exit);
-  size_t length = message_exit.size();
-  boost::asio::write(socket, asio::buffer(&length, sizeof(size_t)));
-  boost::asio::write(socket, asio::buffer(message_exit, message_exit.size()));
+
+  double start = GetCurrentTime();
+  std::vector<std::future<Status>> senders;
+  std::vector<size_t> wire_sizes(connections, 0);
+  for (size_t index = 0; index < connections; ++index) {
+    senders.emplace_back(std::async(std::launch::async, [&, index]() {
+      for (auto const& blob : assignments[index]) {
+        RETURN_ON_ERROR(sendBlob(blob, codec.get(), *sockets[index],
+                                 wire_sizes[index]));
+      }
+      std::string message_exit;
+      WriteExitRequest(message_exit);
+      return writeMessage(*sockets[index], message_exit);
+    }));
+  }
+  Status status;
+  for (auto& sender : senders) {
+    status &= sender.get();
+  }
+  RETURN_ON_ERROR(status);
+  logThroughput("Migration sent", blobs.size(), total_size,
+                std::accumulate(wire_sizes.begin(), wire_sizes.end(),
+                                static_cast<size_t>(0)),
+                GetCurrentTime() - start);
   return Status::OK();
 }
 
@@ -105,14 +207,47 @@ Status ObjectMigration::sendObjectMeta(ObjectID object_id, Client& client,
   if (object_list_.find(object_id) == object_list_.end()) {
     std::string msg;
     WriteSendObjectRequest(object_id, meta_tree, msg);
-    size_t length = msg.size();
-    boost::asio::write(socket, asio::buffer(&length, sizeof(size_t)));
-    boost::asio::write(socket, asio::buffer(msg, msg.size()));
+    RETURN_ON_ERROR(writeMessage(socket, msg));
     object_list_.emplace(object_id);
   }
   return Status::OK();
 }
 
+Status ObjectMigration::sendBlob(std::shared_ptr<Blob> const& blob,
+                                 BlobCodec* codec, tcp::socket& socket,
+                                 size_t& wire_size) {
+  std::vector<uint8_t> compressed;
+  bool compress =
+      codec != nullptr &&
+      codec->Compress(reinterpret_cast<const uint8_t*>(blob->data()),
+                      blob->size(), compressed);
+  int64_t checksum = -1;
+  if (FLAGS_migration_checksum) {
+    checksum = memory::concurrent_crc32c(blob->data(), blob->size());
+  }
+  std::string message_out;
+  if (compress) {
+    WriteSendBlobBufferRequest(blob->id(), blob->size(), compressed.size(),
+                               codec->name(), checksum, message_out);
+  } else {
+    WriteSendBlobBufferRequest(blob->id(), blob->size(), 0, "none", checksum,
+                               message_out);
+  }
+  RETURN_ON_ERROR(writeMessage(socket, message_out));
+  boost::system::error_code ec;
+  if (compress) {
+    asio::write(socket, asio::buffer(compressed), ec);
+    wire_size += compressed.size();
+  } else {
+    asio::write(socket, asio::buffer(blob->data(), blob->size()), ec);
+    wire_size += blob->size();
+  }
+  if (ec) {
+    return Status::IOError("Failed to send blob: " + ec.message());
+  }
+  return Status::OK();
+}
+
 void ObjectMigration::getBlobList(json& meta_tree) {
   InstanceID instance_id = meta_tree["instance_id"].get<InstanceID>();
   if (instance_id != instance_id_)
@@ -131,79 +266,297 @@ void ObjectMigration::getBlobList(json& meta_tree) {
 }
 
 Status MigrationServer::Start(Client& client) {
+  for (auto const& item : instance_map_) {
+    if (item.second == client.instance_id() && item.first != item.second) {
+      pending_sources_ += 1;
+    }
+  }
+  if (pending_sources_ == 0) {
+    LOG(INFO) << "No instance migrates objects to this instance";
+    return Status::OK();
+  }
+
   asio::io_service io_service;
   tcp::acceptor acceptor(io_service,
                          tcp::endpoint(tcp::v4(), FLAGS_migration_port));
-  tcp::socket socket(io_service);
-  acceptor.accept(socket);
-  bool read_msg = true;
-  while (read_msg) {
-    size_t length;
-    std::string message_in;
-    boost::asio::read(socket, asio::buffer(&length, sizeof(size_t)));
-    message_in.resize(length);
-    boost::asio::read(socket, asio::buffer(&message_in[0], message_in.size()));
-    json root = json::parse(message_in);
+  double start = GetCurrentTime();
+  doAccept(io_service, acceptor, client);
+  io_service.run();
+  for (auto& session : sessions_) {
+    session.join();
+  }
+  for (auto& item : blob_writers_) {
+    VINEYARD_DISCARD(item.second->Abort(client));
+  }
+  blob_writers_.clear();
+  RETURN_ON_ERROR(status_);
+  logThroughput("Migration received", received_blobs_, received_bytes_,
+                received_wire_bytes_, GetCurrentTime() - start);
+
+  for (auto it = object_map_.begin(); it != object_map_.end(); it++) {
+    ObjectID object_id;
+    if (object_id_map_.find(it->first) == object_id_map_.end()) {
+      if (it->second["instance_id"].get<InstanceID>() ==
+          UnspecifiedInstanceID()) {
+        object_id = createObject(it->second, client, true);
+      } else {
+        object_id = createObject(it->second, client, false);
+      }
+      object_id_map_.emplace(it->first, object_id);
+    } else {
+      object_id = object_id_map_.find(it->first)->second;
+    }
+    LOG(INFO) << "Build target local object " << it->first
+              << ", id: " << object_id;
+  }
+  LOG(INFO) << "Migration server exit";
+  return Status::OK();
+}
+
+void MigrationServer::doAccept(asio::io_service& io_service,
+                               tcp::acceptor& acceptor, Client& client) {
+  auto socket = std::make_shared<tcp::socket>(io_service);
+  acceptor.async_accept(*socket, [this, &io_service, &acceptor, &client,
+                                  socket](boost::system::error_code ec) {
+    if (ec) {
+      // the acceptor has been closed.
+      return;
+    }
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (stopped_) {
+        return;
+      }
+      sockets_.emplace_back(socket);
+    }
+    sessions_.emplace_back([this, &io_service, &acceptor, &client, socket]() {
+      bool finished = false;
+      auto status = serve(client, *socket, finished);
+      if (!status.ok()) {
+        LOG(ERROR) << "Migration session failed: " << status.ToString();
+      }
+      if (!status.ok() || finished) {
+        stop(io_service, acceptor, status);
+      }
+    });
+    doAccept(io_service, acceptor, client);
+  });
+}
 
-    std::string type = root["type"].get_ref<std::string const&>();
+Status MigrationServer::serve(Client& client, tcp::socket& socket,
+                              bool& finished) {
+  while (true) {
+    json root;
+    RETURN_ON_ERROR(readMessage(socket, root));
+    std::string type = root.value("type", "");
     MigrateActionType cmd = ParseMigrateAction(type);
     switch (cmd) {
     case MigrateActionType::SendObjectRequest: {
-      LOG(INFO) << "cmd send object request";
       ObjectID object_id;
       json object_meta;
       RETURN_ON_ERROR(ReadSendObjectRequest(root, object_id, object_meta));
       // FIXME: this part will be abandoned when global object contains meta of
       // sub_object
+      std::lock_guard<std::mutex> lock(mutex_);
       object_map_.emplace(object_id, object_meta);
     } break;
+    case MigrateActionType::PrepareBlobsRequest: {
+      InstanceID instance_id;
+      size_t connections = 0, num_blobs = 0;
+      std::string compression;
+      RETURN_ON_ERROR(ReadPrepareBlobsRequest(root, instance_id, connections,
+                                              compression));
+      auto status = prepareBlobs(client, instance_id, connections, compression,
+                                 num_blobs);
+      std::string message_out;
+      if (status.ok()) {
+        WritePrepareBlobsReply(num_blobs, compression, message_out);
+      } else {
+        WriteErrorReply(status, message_out);
+      }
+      RETURN_ON_ERROR(writeMessage(socket, message_out));
+      RETURN_ON_ERROR(status);
+    } break;
     case MigrateActionType::SendBlobBufferRequest: {
       ObjectID blob_id;
-      size_t blob_size;
-      RETURN_ON_ERROR(ReadSendBlobBufferRequest(root, blob_id, blob_size));
-      std::unique_ptr<BlobWriter> buffer_writer;
-      RETURN_ON_ERROR(client.CreateBlob(blob_size, buffer_writer));
-      size_t remain_size = blob_size;
-      size_t offset = 0;
-      while (remain_size) {
-        size_t recv_size =
-            remain_size < MAX_BUFFER_SIZE ? remain_size : MAX_BUFFER_SIZE;
-        boost::asio::read(
-            socket, asio::buffer(buffer_writer->data() + offset, recv_size));
-        remain_size -= recv_size;
-        offset += recv_size;
-      }
-      auto buffer = buffer_writer->Seal(client);
-      object_id_map_.emplace(blob_id, buffer->id());
+      size_t blob_size, compressed_size;
+      std::string compression;
+      int64_t checksum = -1;
+      RETURN_ON_ERROR(ReadSendBlobBufferRequest(
+          root, blob_id, blob_size, compressed_size, compression, checksum));
+      RETURN_ON_ERROR(receiveBlob(client, socket, blob_id, blob_size,
+                                  compressed_size, compression, checksum));
     } break;
     case MigrateActionType::ExitRequest: {
-      for (auto it = object_map_.begin(); it != object_map_.end(); it++) {
-        ObjectID object_id;
-        if (object_id_map_.find(it->first) == object_id_map_.end()) {
-          if (it->second["instance_id"].get<InstanceID>() ==
-              UnspecifiedInstanceID()) {
-            object_id = createObject(it->second, client, true);
-          } else {
-            object_id = createObject(it->second, client, false);
-          }
-          object_id_map_.emplace(it->first, object_id);
-        } else {
-          object_id = object_id_map_.find(it->first)->second;
-        }
-        LOG(INFO) << "Build target local object " << it->first
-                  << ", id: " << object_id;
-      }
-      read_msg = false;
-      LOG(INFO) << "Migration server exit";
-    } break;
+      std::lock_guard<std::mutex> lock(mutex_);
+      finished_connections_ += 1;
+      finished = pending_sources_ == 0 &&
+                 finished_connections_ == expected_connections_;
+      return Status::OK();
+    }
     default: {
-      LOG(ERROR) << "Got unexpected command: " << type;
+      return Status::Invalid("Got unexpected migration command: " + type);
     }
     }
   }
   return Status::OK();
 }
 
+Status MigrationServer::prepareBlobs(Client& client,
+                                     const InstanceID instance_id,
+                                     const size_t connections,
+                                     std::string& compression,
+                                     size_t& num_blobs) {
+  // accept the requested codec only if it is available here as well.
+  compression = BlobCodec::Negotiate(compression);
+  if (compression != "none") {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (codecs_.find(compression) == codecs_.end()) {
+      std::unique_ptr<BlobCodec> codec;
+      RETURN_ON_ERROR(BlobCodec::Make(compression, codec));
+      codecs_.emplace(compression, std::move(codec));
+    }
+  }
+  std::vector<ObjectID> blob_ids;
+  std::vector<size_t> blob_sizes;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto const& item : object_map_) {
+      collectBlobs(item.second, instance_id, blob_ids, blob_sizes);
+    }
+  }
+  std::vector<std::unique_ptr<BlobWriter>> writers;
+  if (!blob_sizes.empty()) {
+    RETURN_ON_ERROR(client.CreateBlobs(blob_sizes, writers));
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (size_t index = 0; index < blob_ids.size(); ++index) {
+    blob_writers_.emplace(blob_ids[index], std::move(writers[index]));
+  }
+  pending_sources_ -= 1;
+  expected_connections_ += connections;
+  num_blobs = blob_ids.size();
+  return Status::OK();
+}
+
+Status MigrationServer::receiveBlob(Client& client, tcp::socket& socket,
+                                    const ObjectID blob_id,
+                                    const size_t blob_size,
+                                    const size_t compressed_size,
+                                    std::string const& compression,
+                                    const int64_t checksum) {
+  std::unique_ptr<BlobWriter> buffer_writer;
+  BlobCodec* codec = nullptr;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    // checks before taking the prepared writer, which would leak otherwise
+    if (compressed_size > 0) {
+      auto codec_iter = codecs_.find(compression);
+      RETURN_ON_ASSERT(codec_iter != codecs_.end(),
+                       "The compression hasn't been negotiated");
+      codec = codec_iter->second.get();
+    }
+    auto iter = blob_writers_.find(blob_id);
+    if (iter != blob_writers_.end()) {
+      buffer_writer = std::move(iter->second);
+      blob_writers_.erase(iter);
+    }
+  }
+  if (buffer_writer == nullptr) {
+    RETURN_ON_ERROR(client.CreateBlob(blob_size, buffer_writer));
+  }
+  if (buffer_writer->size() != blob_size) {
+    VINEYARD_DISCARD(buffer_writer->Abort(client));
+    return Status::AssertionFailed(
+        "The size of the prepared blob doesn't match");
+  }
+  boost::system::error_code ec;
+  if (codec == nullptr) {
+    asio::read(socket, asio::buffer(buffer_writer->data(), blob_size), ec);
+  } else {
+    std::vector<uint8_t> compressed(compressed_size);
+    asio::read(socket, asio::buffer(compressed), ec);
+    if (!ec) {
+      auto status = codec->Decompress(
+          compressed.data(), compressed.size(),
+          reinterpret_cast<uint8_t*>(buffer_writer->data()), blob_size);
+      if (!status.ok()) {
+        VINEYARD_DISCARD(buffer_writer->Abort(client));
+        return status;
+      }
+    }
+  }
+  if (ec) {
+    VINEYARD_DISCARD(buffer_writer->Abort(client));
+    return Status::IOError("Failed to receive blob: " + ec.message());
+  }
+  if (checksum >= 0 &&
+      static_cast<int64_t>(memory::concurrent_crc32c(
+          buffer_writer->data(), blob_size)) != checksum) {
+    VINEYARD_DISCARD(buffer_writer->Abort(client));
+    return Status::IOError("The content of the received blob " +
+                           ObjectIDToString(blob_id) +
+                           " is corrupted: checksum mismatches");
+  }
+  auto buffer = buffer_writer->Seal(client);
+  std::lock_guard<std::mutex> lock(mutex_);
+  object_id_map_.emplace(blob_id, buffer->id());
+  received_blobs_ += 1;
+  received_bytes_ += blob_size;
+  received_wire_bytes_ += compressed_size > 0 ? compressed_size : blob_size;
+  return Status::OK();
+}
+
+void MigrationServer::collectBlobs(const json& meta_tree,
+                                   const InstanceID instance_id,
+                                   std::vector<ObjectID>& blob_ids,
+                                   std::vector<size_t>& blob_sizes) {
+  // follows `ObjectMigration::getBlobList`, to match the blobs that will be
+  // sent from the source instance.
+  if (meta_tree.value("instance_id", UnspecifiedInstanceID()) != instance_id) {
+    return;
+  }
+  ObjectID id =
+      VYObjectIDFromString(meta_tree["id"].get_ref<std::string const&>());
+  if (IsBlob(id)) {
+    if (blob_writers_.find(id) == blob_writers_.end() &&
+        std::find(blob_ids.begin(), blob_ids.end(), id) == blob_ids.end()) {
+      blob_ids.emplace_back(id);
+      blob_sizes.emplace_back(
+          meta_tree.value("length", static_cast<size_t>(0)));
+    }
+    return;
+  }
+  for (auto& item : meta_tree) {
+    if (item.is_object() && !item.empty()) {
+      collectBlobs(item, instance_id, blob_ids, blob_sizes);
+    }
+  }
+}
+
+void MigrationServer::stop(asio::io_service& io_service,
+                           tcp::acceptor& acceptor, Status const& status) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  status_ &= status;
+  if (stopped_) {
+    return;
+  }
+  stopped_ = true;
+  if (!status.ok()) {
+    // unblock the other sessions
+    for (auto& socket : sockets_) {
+      boost::system::error_code ec;
+      socket->shutdown(tcp::socket::shutdown_both, ec);
+    }
+  }
+  // closing the acceptor cancels the pending accept, then the io_service
+  // returns.
+  io_service.post([&acceptor]() {
+    boost::system::error_code ec;
+    acceptor.close(ec);
+  });
+}
+
 ObjectID MigrationServer::createObject(json& meta_tree, Client& client,
                                        bool persist) {
   InstanceID instance_id = meta_tree["instance_id"].get<InstanceID>();
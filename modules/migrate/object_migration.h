@@ -17,6 +17,7 @@ limitations under the License.
 #define MODULES_MIGRATE_OBJECT_MIGRATION_H_
 
 #include <memory>
+#include <mutex>
 #include <set>
 #include <string>
 #include <thread>
@@ -33,6 +34,7 @@ limitations under the License.
 #include "client/client.h"
 #include "client/ds/blob.h"
 #include "client/ds/object_meta.h"
+#include "migrate/compression.h"
 #include "migrate/protocols.h"
 
 namespace vineyard {
@@ -56,6 +58,9 @@ class ObjectMigration {
   Status sendObjectMeta(ObjectID object_id, Client& client,
                         tcp::socket& socket);
 
+  Status sendBlob(std::shared_ptr<Blob> const& blob, BlobCodec* codec,
+                  tcp::socket& socket, size_t& wire_size);
+
   void getBlobList(json& meta_tree);
 
   std::vector<ObjectID> object_ids_;
@@ -71,14 +76,56 @@ class MigrationServer {
       std::unordered_map<InstanceID, InstanceID>& instance_map)
       : instance_map_(instance_map) {}
 
+  /**
+   * @brief Serve the migration clients of all source instances that are
+   * mapped to the instance of `client`, over concurrent connections, then
+   * build the migrated objects.
+   */
   Status Start(Client& client);
 
  private:
+  void doAccept(asio::io_service& io_service, tcp::acceptor& acceptor,
+                Client& client);
+
+  Status serve(Client& client, tcp::socket& socket, bool& finished);
+
+  Status prepareBlobs(Client& client, const InstanceID instance_id,
+                      const size_t connections, std::string& compression,
+                      size_t& num_blobs);
+
+  Status receiveBlob(Client& client, tcp::socket& socket,
+                     const ObjectID blob_id, const size_t blob_size,
+                     const size_t compressed_size,
+                     std::string const& compression, const int64_t checksum);
+
+  void collectBlobs(const json& meta_tree, const InstanceID instance_id,
+                    std::vector<ObjectID>& blob_ids,
+                    std::vector<size_t>& blob_sizes);
+
+  void stop(asio::io_service& io_service, tcp::acceptor& acceptor,
+            Status const& status);
+
   ObjectID createObject(json& meta, Client& client, bool persist);
 
   std::unordered_map<InstanceID, InstanceID> instance_map_;
   std::unordered_map<ObjectID, json> object_map_;
   std::unordered_map<ObjectID, ObjectID> object_id_map_;
+
+  // guards the states below, and the two maps above, which are shared by the
+  // sessions of concurrent connections.
+  std::mutex mutex_;
+  std::unordered_map<ObjectID, std::unique_ptr<BlobWriter>> blob_writers_;
+  std::unordered_map<std::string, std::unique_ptr<BlobCodec>> codecs_;
+  std::vector<std::shared_ptr<tcp::socket>> sockets_;
+  std::vector<std::thread> sessions_;
+  size_t pending_sources_ = 0;
+  size_t expected_connections_ = 0;
+  size_t finished_connections_ = 0;
+  size_t received_blobs_ = 0;
+  size_t received_bytes_ = 0;
+  size_t received_wire_bytes_ = 0;
+  bool stopped_ = false;
+  Status status_;
 };
 
 }  // namespace vineyard
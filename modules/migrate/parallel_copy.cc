@@ -0,0 +1,343 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "migrate/parallel_copy.h"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <future>
+#include <thread>
+#include <utility>
+
+#include "common/util/logging.h"
+
+namespace vineyard {
+
+namespace {
+
+// collects the ids of nested members (except blobs)
+void collectMembers(const json& tree, std::set<ObjectID>& members) {
+  for (auto const& item : tree) {
+    if (!item.is_object() || !item.contains("id")) {
+      continue;
+    }
+    ObjectID member_id =
+        ObjectIDFromString(item["id"].get_ref<std::string const&>());
+    if (!IsBlob(member_id)) {
+      members.emplace(member_id);
+      collectMembers(item, members);
+    }
+  }
+}
+
+// collects the blobs of the object, which must live on the source instance
+Status collectBlobs(const json& tree, const InstanceID instance_id,
+                    std::set<ObjectID>& blobs) {
+  for (auto const& item : tree) {
+    if (!item.is_object() || !item.contains("id")) {
+      continue;
+    }
+    ObjectID member_id =
+        ObjectIDFromString(item["id"].get_ref<std::string const&>());
+    if (!IsBlob(member_id)) {
+      RETURN_ON_ERROR(collectBlobs(item, instance_id, blobs));
+      continue;
+    }
+    if (member_id != EmptyBlobID() &&
+        item["instance_id"].get<InstanceID>() != instance_id) {
+      return Status::Invalid("Blob " + ObjectIDToString(member_id) +
+                             " doesn't locate on the source instance");
+    }
+    blobs.emplace(member_id);
+  }
+  return Status::OK();
+}
+
+}  // namespace
+
+Status ParallelCopy::Copy(std::vector<ObjectID> const& object_ids,
+                          std::map<ObjectID, ObjectID>& copied) {
+  RETURN_ON_ASSERT(options_.parallelism > 0,
+                   "The parallelism of copy must be positive");
+  RETURN_ON_ERROR(loadManifest());
+
+  std::vector<task_t> tasks;
+  if (object_ids.empty()) {
+    RPCClient source;
+    RETURN_ON_ERROR(source.Connect(source_endpoint_));
+    RETURN_ON_ERROR(enumerate(source, tasks));
+  } else {
+    for (auto const& id : object_ids) {
+      RETURN_ON_ASSERT(!IsBlob(id), "The blobs cannot be copied");
+      tasks.emplace_back(task_t{id, ""});
+    }
+  }
+  std::vector<task_t> pending;
+  for (auto const& task : tasks) {
+    if (copied_.find(task.id) == copied_.end()) {
+      pending.emplace_back(task);
+    }
+  }
+  total_objects_ = pending.size();
+  LOG(INFO) << "Copying " << pending.size() << " objects from "
+            << source_endpoint_ << ", " << tasks.size() - pending.size()
+            << " objects have been copied before";
+
+  auto const start = std::chrono::steady_clock::now();
+  auto elapsed = [start]() {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                         start)
+        .count();
+  };
+
+  // reports the throughput periodically as the copy goes
+  std::mutex report_mutex;
+  std::condition_variable report_cv;
+  bool finished = false;
+  std::thread reporter;
+  if (options_.report_interval > 0) {
+    reporter = std::thread([&]() {
+      std::unique_lock<std::mutex> lock(report_mutex);
+      auto const interval =
+          std::chrono::duration<double>(options_.report_interval);
+      size_t last_bytes = 0;
+      double last = 0;
+      while (!report_cv.wait_for(lock, interval, [&]() { return finished; })) {
+        size_t bytes = copied_bytes_.load();
+        double now = elapsed();
+        report(now, now - last, bytes - last_bytes);
+        last_bytes = bytes;
+        last = now;
+      }
+    });
+  }
+
+  std::atomic<size_t> next{0};
+  auto worker = [&]() -> Status {
+    Client client;
+    RETURN_ON_ERROR(client.Connect(ipc_socket_));
+    std::unique_ptr<RPCClient> source;
+    auto connect = [&]() -> Status {
+      source.reset(new RPCClient());
+      RETURN_ON_ERROR(source->Connect(source_endpoint_));
+      if (options_.rpc_streams > 0) {
+        auto status = source->ConnectDataStreams(options_.rpc_streams,
+                                                 options_.chunk_size);
+        if (!status.ok()) {
+          LOG(WARNING) << "Failed to open extra RPC data streams: "
+                       << status.ToString();
+        }
+      }
+      return Status::OK();
+    };
+    RETURN_ON_ERROR(connect());
+    while (true) {
+      size_t index = next.fetch_add(1);
+      if (index >= pending.size()) {
+        return Status::OK();
+      }
+      auto const& task = pending[index];
+      ObjectID target_id = InvalidObjectID();
+      auto status = copyObject(client, *source, task, target_id);
+      if (status.ok()) {
+        status = record(task.id, target_id);
+      }
+      if (status.ok()) {
+        copied_objects_ += 1;
+        continue;
+      }
+      failed_objects_ += 1;
+      LOG(ERROR) << "Failed to copy object " << ObjectIDToString(task.id)
+                 << ": " << status.ToString();
+      // the connection may be left in an unknown state by the failure
+      RETURN_ON_ERROR(connect());
+    }
+  };
+
+  std::vector<std::future<Status>> workers;
+  for (size_t i = 0; i < std::min(options_.parallelism, pending.size());
+       ++i) {
+    workers.emplace_back(std::async(std::launch::async, worker));
+  }
+  Status status;
+  for (auto& item : workers) {
+    status &= item.get();
+  }
+
+  if (reporter.joinable()) {
+    {
+      std::lock_guard<std::mutex> lock(report_mutex);
+      finished = true;
+    }
+    report_cv.notify_all();
+    reporter.join();
+  }
+  double total = elapsed();
+  report(total, total, copied_bytes_.load());
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    copied = copied_;
+  }
+  RETURN_ON_ERROR(status);
+  if (failed_objects_ > 0) {
+    return Status::IOError(std::to_string(failed_objects_.load()) +
+                           " objects failed to copy, rerun with the "
+                           "manifest to resume");
+  }
+  return Status::OK();
+}
+
+Status ParallelCopy::enumerate(RPCClient& source, std::vector<task_t>& tasks) {
+  // the objects to copy, and their names (if any)
+  std::map<ObjectID, std::string> candidates;
+  std::set<ObjectID> members;
+  std::string cursor;
+  do {
+    std::vector<json> objects;
+    std::string next_cursor;
+    RETURN_ON_ERROR(source.ListData(options_.pattern, false,
+                                    options_.name_prefix, cursor,
+                                    options_.page_size, false, objects,
+                                    next_cursor));
+    for (auto const& item : objects) {
+      ObjectID id =
+          ObjectIDFromString(item["id"].get_ref<std::string const&>());
+      json const& meta = item["meta"];
+      if (IsBlob(id) || meta.value("global", false) ||
+          meta.value("instance_id", UnspecifiedInstanceID()) !=
+              source.remote_instance_id()) {
+        continue;
+      }
+      collectMembers(meta, members);
+      candidates.emplace(id, item.value("name", std::string()));
+    }
+    cursor = next_cursor;
+  } while (!cursor.empty());
+
+  for (auto const& kv : candidates) {
+    if (members.find(kv.first) == members.end()) {
+      tasks.emplace_back(task_t{kv.first, kv.second});
+    }
+  }
+  return Status::OK();
+}
+
+Status ParallelCopy::loadManifest() {
+  if (options_.manifest.empty()) {
+    return Status::OK();
+  }
+  {
+    std::ifstream input(options_.manifest);
+    std::string source_id, target_id;
+    while (input >> source_id >> target_id) {
+      copied_[ObjectIDFromString(source_id)] = ObjectIDFromString(target_id);
+    }
+  }
+  manifest_.open(options_.manifest, std::ios::out | std::ios::app);
+  if (!manifest_.is_open()) {
+    return Status::IOError("Failed to open the manifest: " +
+                           options_.manifest);
+  }
+  return Status::OK();
+}
+
+Status ParallelCopy::record(ObjectID const source_id,
+                            ObjectID const target_id) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  copied_[source_id] = target_id;
+  if (manifest_.is_open()) {
+    // flushed on every record, for the copy to be resumed after a crash
+    manifest_ << ObjectIDToString(source_id) << " "
+              << ObjectIDToString(target_id) << std::endl;
+    if (!manifest_) {
+      return Status::IOError("Failed to write the manifest: " +
+                             options_.manifest);
+    }
+  }
+  return Status::OK();
+}
+
+Status ParallelCopy::copyObject(Client& client, RPCClient& source,
+                                task_t const& task, ObjectID& target_id) {
+  ObjectMeta metadata;
+  RETURN_ON_ERROR(source.GetMetaData(task.id, metadata, false));
+  std::set<ObjectID> blob_ids;
+  RETURN_ON_ERROR(
+      collectBlobs(metadata.MetaData(), source.remote_instance_id(), blob_ids));
+
+  std::map<ObjectID, std::shared_ptr<Blob>> blobs;
+  if (blob_ids.erase(EmptyBlobID()) > 0) {
+    blobs.emplace(EmptyBlobID(), Blob::MakeEmpty(client));
+  }
+  size_t nbytes = 0;
+  if (!blob_ids.empty()) {
+    std::map<ObjectID, std::unique_ptr<BlobWriter>> buffers;
+    RETURN_ON_ERROR(source.GetRemoteBlobs(blob_ids, client, buffers));
+    for (auto& item : buffers) {
+      nbytes += item.second->size();
+      blobs.emplace(item.first, std::dynamic_pointer_cast<Blob>(
+                                    item.second->Seal(client)));
+    }
+  }
+
+  ObjectMeta target;
+  RETURN_ON_ERROR(rebuild(client, metadata, target, blobs));
+  RETURN_ON_ERROR(client.Persist(target.GetId()));
+  if (options_.copy_names && !task.name.empty()) {
+    RETURN_ON_ERROR(client.PutName(target.GetId(), task.name));
+  }
+  target_id = target.GetId();
+  copied_bytes_ += nbytes;
+  return Status::OK();
+}
+
+Status ParallelCopy::rebuild(
+    Client& client, ObjectMeta const& metadata, ObjectMeta& target,
+    std::map<ObjectID, std::shared_ptr<Blob>> const& blobs) {
+  for (auto const& kv : metadata) {
+    if (kv.value().is_object()) {
+      ObjectMeta member = metadata.GetMemberMeta(kv.key());
+      if (member.GetTypeName() == type_name<Blob>()) {
+        target.AddMember(kv.key(), blobs.at(member.GetId()));
+      } else {
+        ObjectMeta subtarget;
+        RETURN_ON_ERROR(rebuild(client, member, subtarget, blobs));
+        target.AddMember(kv.key(), subtarget);
+      }
+    } else {
+      target.AddKeyValue(kv.key(), kv.value());
+    }
+  }
+  ObjectID target_id = InvalidObjectID();
+  RETURN_ON_ERROR(client.CreateMetaData(target, target_id));
+  target.SetId(target_id);
+  return Status::OK();
+}
+
+void ParallelCopy::report(double const elapsed, double const interval,
+                          size_t const interval_bytes) {
+  double mbytes = static_cast<double>(copied_bytes_.load()) / (1024 * 1024);
+  double interval_mbytes = static_cast<double>(interval_bytes) / (1024 * 1024);
+  LOG(INFO) << "Copied " << copied_objects_.load() << "/" << total_objects_
+            << " objects (" << failed_objects_.load() << " failed), "
+            << mbytes << " MB in " << elapsed << " seconds, throughput: "
+            << (interval > 0 ? interval_mbytes / interval : 0)
+            << " MB/s, average: " << (elapsed > 0 ? mbytes / elapsed : 0)
+            << " MB/s";
+}
+
+}  // namespace vineyard
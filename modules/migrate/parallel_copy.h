@@ -0,0 +1,125 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef MODULES_MIGRATE_PARALLEL_COPY_H_
+#define MODULES_MIGRATE_PARALLEL_COPY_H_
+
+#include <atomic>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "client/client.h"
+#include "client/ds/blob.h"
+#include "client/ds/object_meta.h"
+#include "client/rpc_client.h"
+
+namespace vineyard {
+
+/**
+ * @brief ParallelCopy copies the objects of a (remote) source instance into
+ * the local instance, e.g., cloning the caches of an environment into
+ * another.
+ *
+ * The objects are enumerated by pages of `ListData`, and copied by
+ * concurrent workers, each fetching the blobs over its own RPC connection
+ * and striping them across its data streams in chunked ranges. The copied
+ * objects are appended to a manifest, rerunning with the same manifest
+ * resumes a failed copy by skipping the objects that have been copied.
+ */
+class ParallelCopy {
+ public:
+  struct Options {
+    // the typename pattern of objects to enumerate
+    std::string pattern = "*";
+    // only enumerates the named objects whose names have the prefix
+    std::string name_prefix;
+    size_t page_size = 1000;
+    // the number of concurrent workers
+    size_t parallelism = 4;
+    // the data streams (and the size of chunks) of every worker
+    size_t rpc_streams = 2;
+    size_t chunk_size = 4 * 1024 * 1024;
+    // the path of manifest, empty means the copy cannot be resumed
+    std::string manifest;
+    bool copy_names = true;
+    // the interval (in seconds) of reporting the throughput
+    double report_interval = 5.0;
+  };
+
+  ParallelCopy(std::string const& ipc_socket,
+               std::string const& source_endpoint, Options const& options)
+      : ipc_socket_(ipc_socket),
+        source_endpoint_(source_endpoint),
+        options_(options) {}
+
+  /**
+   * @brief Copy the given objects, or all the enumerated objects if
+   * `object_ids` is empty.
+   *
+   * The objects that are members of other enumerated objects are copied as
+   * parts of them, and the global objects are skipped since their members
+   * may live on other instances.
+   *
+   * @param copied Record the copied object of every source object,
+   * including the ones copied by previous runs of the manifest.
+   */
+  Status Copy(std::vector<ObjectID> const& object_ids,
+              std::map<ObjectID, ObjectID>& copied);
+
+ private:
+  struct task_t {
+    ObjectID id;
+    std::string name;
+  };
+
+  Status enumerate(RPCClient& source, std::vector<task_t>& tasks);
+
+  Status loadManifest();
+
+  Status record(ObjectID const source_id, ObjectID const target_id);
+
+  Status copyObject(Client& client, RPCClient& source, task_t const& task,
+                    ObjectID& target_id);
+
+  Status rebuild(Client& client, ObjectMeta const& metadata,
+                 ObjectMeta& target,
+                 std::map<ObjectID, std::shared_ptr<Blob>> const& blobs);
+
+  void report(double const elapsed, double const interval,
+              size_t const interval_bytes);
+
+  std::string ipc_socket_;
+  std::string source_endpoint_;
+  Options options_;
+
+  // guards the manifest and the copied objects
+  std::mutex mutex_;
+  std::ofstream manifest_;
+  std::map<ObjectID, ObjectID> copied_;
+
+  size_t total_objects_ = 0;
+  std::atomic<size_t> copied_objects_{0};
+  std::atomic<size_t> copied_bytes_{0};
+  std::atomic<size_t> failed_objects_{0};
+};
+
+}  // namespace vineyard
+
+#endif  // MODULES_MIGRATE_PARALLEL_COPY_H_
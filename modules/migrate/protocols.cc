@@ -32,6 +32,10 @@ MigrateActionType ParseMigrateAction(const std::string& str_type) {
     return MigrateActionType::SendObjectRequest;
   } else if (str_type == "send_blob_buffer_request") {
     return MigrateActionType::SendBlobBufferRequest;
+  } else if (str_type == "prepare_blobs_request") {
+    return MigrateActionType::PrepareBlobsRequest;
+  } else if (str_type == "prepare_blobs_reply") {
+    return MigrateActionType::PrepareBlobsReply;
   } else {
     return MigrateActionType::NullAction;
   }
@@ -79,6 +83,24 @@ void WriteSendBlobBufferRequest(const ObjectID blob_id, const size_t blob_size,
   encode_msg(root, msg);
 }
 
+void WriteSendBlobBufferRequest(const ObjectID blob_id, const size_t blob_size,
+                                const size_t compressed_size,
+                                std::string const& compression,
+                                const int64_t checksum, std::string& msg) {
+  json root;
+  root["type"] = "send_blob_buffer_request";
+  root["blob_id"] = blob_id;
+  root["blob_size"] = blob_size;
+  if (compressed_size > 0) {
+    root["compressed_size"] = compressed_size;
+    root["compression"] = compression;
+  }
+  if (checksum >= 0) {
+    root["checksum"] = checksum;
+  }
+  encode_msg(root, msg);
+}
+
 Status ReadSendBlobBufferRequest(const json& root, ObjectID& blob_id,
                                  size_t& blob_size) {
   RETURN_ON_ASSERT(root["type"].get_ref<std::string const&>() ==
@@ -88,4 +110,60 @@ Status ReadSendBlobBufferRequest(const json& root, ObjectID& blob_id,
   return Status::OK();
 }
 
+Status ReadSendBlobBufferRequest(const json& root, ObjectID& blob_id,
+                                 size_t& blob_size, size_t& compressed_size,
+                                 std::string& compression, int64_t& checksum) {
+  RETURN_ON_ERROR(ReadSendBlobBufferRequest(root, blob_id, blob_size));
+  compressed_size = root.value("compressed_size", static_cast<size_t>(0));
+  compression = root.value("compression", "none");
+  checksum = root.value("checksum", static_cast<int64_t>(-1));
+  return Status::OK();
+}
+
+void WritePrepareBlobsRequest(const InstanceID instance_id,
+                              const size_t connections,
+                              std::string const& compression,
+                              std::string& msg) {
+  json root;
+  root["type"] = "prepare_blobs_request";
+  root["instance_id"] = instance_id;
+  root["connections"] = connections;
+  root["compression"] = compression;
+  encode_msg(root, msg);
+}
+
+Status ReadPrepareBlobsRequest(const json& root, InstanceID& instance_id,
+                               size_t& connections, std::string& compression) {
+  RETURN_ON_ASSERT(root["type"].get_ref<std::string const&>() ==
+                   "prepare_blobs_request");
+  instance_id = root["instance_id"].get<InstanceID>();
+  connections = root["connections"].get<size_t>();
+  compression = root.value("compression", "none");
+  return Status::OK();
+}
+
+void WritePrepareBlobsReply(const size_t num_blobs,
+                            std::string const& compression, std::string& msg) {
+  json root;
+  root["type"] = "prepare_blobs_reply";
+  root["num_blobs"] = num_blobs;
+  root["compression"] = compression;
+  encode_msg(root, msg);
+}
+
+Status ReadPrepareBlobsReply(const json& root, size_t& num_blobs,
+                             std::string& compression) {
+  if (root.contains("code")) {
+    Status st = Status(static_cast<StatusCode>(root.value("code", 0)),
+                       root.value("message", ""));
+    if (!st.ok()) {
+      return st;
+    }
+  }
+  RETURN_ON_ASSERT(root.value("type", "") == "prepare_blobs_reply");
+  num_blobs = root["num_blobs"].get<size_t>();
+  compression = root.value("compression", "none");
+  return Status::OK();
+}
+
 }  // namespace vineyard
@@ -30,6 +30,8 @@ enum class MigrateActionType {
   ExitReply = 2,
   SendObjectRequest = 3,
   SendBlobBufferRequest = 4,
+  PrepareBlobsRequest = 5,
+  PrepareBlobsReply = 6,
 };
 
 MigrateActionType ParseMigrateAction(const std::string& str_type);
@@ -47,9 +49,37 @@ Status ReadSendObjectRequest(const json& root, ObjectID& object_id,
 void WriteSendBlobBufferRequest(const ObjectID blob_id, const size_t blob_size,
                                 std::string& msg);
 
+/**
+ * A non-zero `compressed_size` means the payload that follows has been
+ * compressed by `compression`, and a non-negative `checksum` is the CRC32C
+ * of the (uncompressed) content.
+ */
+void WriteSendBlobBufferRequest(const ObjectID blob_id, const size_t blob_size,
+                                const size_t compressed_size,
+                                std::string const& compression,
+                                const int64_t checksum, std::string& msg);
+
 Status ReadSendBlobBufferRequest(const json& root, ObjectID& blob_id,
                                  size_t& blob_size);
 
+Status ReadSendBlobBufferRequest(const json& root, ObjectID& blob_id,
+                                 size_t& blob_size, size_t& compressed_size,
+                                 std::string& compression, int64_t& checksum);
+
+void WritePrepareBlobsRequest(const InstanceID instance_id,
+                              const size_t connections,
+                              std::string const& compression,
+                              std::string& msg);
+
+Status ReadPrepareBlobsRequest(const json& root, InstanceID& instance_id,
+                               size_t& connections, std::string& compression);
+
+void WritePrepareBlobsReply(const size_t num_blobs,
+                            std::string const& compression, std::string& msg);
+
+Status ReadPrepareBlobsReply(const json& root, size_t& num_blobs,
+                             std::string& compression);
+
 }  // namespace vineyard
 
 #endif  // MODULES_MIGRATE_PROTOCOLS_H_
@@ -16,6 +16,7 @@ limitations under the License.
 #include <signal.h>
 
 #include <iostream>
+#include <map>
 
 #include "boost/algorithm/string.hpp"
 
@@ -25,6 +26,7 @@ limitations under the License.
 #include "common/util/logging.h"
 #include "migrate/flags.h"
 #include "migrate/object_migration.h"
+#include "migrate/parallel_copy.h"
 
 using namespace vineyard;  // NOLINT(build/namespaces)
 
@@ -36,10 +38,40 @@ int main(int argc, char* argv[]) {
   logging::InitGoogleLogging("vineyard_copy");
   std::vector<std::string> w_list;
   std::vector<ObjectID> object_id_list;
-  boost::split(w_list, FLAGS_object_list, boost::is_any_of(" ,\t"));
+  boost::split(w_list, FLAGS_object_list, boost::is_any_of(" ,\t"),
+               boost::token_compress_on);
   for (auto& str_id : w_list) {
-    object_id_list.emplace_back(VYObjectIDFromString(str_id));
+    if (!str_id.empty()) {
+      object_id_list.emplace_back(VYObjectIDFromString(str_id));
+    }
+  }
+
+  // pull the objects from the source instance in parallel
+  if (!FLAGS_source_endpoint.empty()) {
+    ParallelCopy::Options options;
+    options.pattern = FLAGS_copy_pattern;
+    options.name_prefix = FLAGS_copy_name_prefix;
+    options.page_size = FLAGS_copy_page_size;
+    options.parallelism = FLAGS_copy_parallelism;
+    options.rpc_streams = FLAGS_copy_rpc_streams;
+    options.chunk_size = FLAGS_copy_chunk_size;
+    options.manifest = FLAGS_copy_manifest;
+    options.copy_names = FLAGS_copy_names;
+    options.report_interval = FLAGS_copy_report_interval;
+    ParallelCopy copy(FLAGS_ipc_socket, FLAGS_source_endpoint, options);
+    std::map<ObjectID, ObjectID> copied;
+    auto status = copy.Copy(object_id_list, copied);
+    if (!status.ok()) {
+      LOG(ERROR) << "Copy failed: " << status.ToString();
+      return static_cast<int>(status.code());
+    }
+    for (auto const& kv : copied) {
+      std::cout << VYObjectIDToString(kv.first) << " "
+                << VYObjectIDToString(kv.second) << std::endl;
+    }
+    return 0;
   }
+
   Client client;
   VINEYARD_CHECK_OK(client.Connect(FLAGS_ipc_socket));
   LOG(INFO) << "Connected to IPCServer: " << FLAGS_ipc_socket;
@@ -14,10 +14,14 @@ limitations under the License.
 */
 
 #include <iostream>
+#include <iterator>
 #include <limits>
 #include <map>
+#include <memory>
+#include <set>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "boost/asio.hpp"
 #include "gflags/gflags.h"
@@ -26,9 +30,11 @@ limitations under the License.
 #include "client/ds/blob.h"
 #include "client/rpc_client.h"
 #include "common/util/boost.h"
+#include "common/util/env.h"
 #include "common/util/flags.h"
 #include "common/util/logging.h"
 #include "common/util/status.h"
+#include "migrate/compression.h"
 
 namespace vineyard {
 
@@ -47,16 +53,35 @@ DEFINE_string(
 DEFINE_string(id, VYObjectIDToString(InvalidObjectID()),
               "Object to migrate to local");
 DEFINE_bool(local_copy, false, "Make a copy of blobs even on the same machine");
+DEFINE_bool(rpc_fetch, true,
+            "Fetch blobs that live on the RPC peer through its RPC service, "
+            "rather than the migration socket");
+DEFINE_uint64(rpc_streams, 2,
+              "Extra RPC connections to stripe the fetched blobs across");
+DEFINE_string(compression, "",
+              "Codec for blob payloads on the migration socket: none, lz4 or "
+              "zstd, defaults to $VINEYARD_MIGRATION_COMPRESSION. The client "
+              "requests the codec, and the server adopts it if available");
+
+// Blobs are fetched through RPC only if the payloads needn't be compressed.
+static bool use_rpc_fetch() {
+  return FLAGS_rpc_fetch && FLAGS_compression == "none";
+}
 
 static void find_blobs_on_remote_instance(const InstanceID remote_instance_id,
                                           const json& tree,
-                                          std::set<ObjectID>& blobs) {
+                                          std::set<ObjectID>& blobs,
+                                          std::set<ObjectID>& rpc_blobs) {
   if (tree.empty()) {
     return;
   }
   ObjectID member_id =
       VYObjectIDFromString(tree["id"].get_ref<std::string const&>());
   if (IsBlob(member_id)) {
+    if (use_rpc_fetch() && member_id != EmptyBlobID() &&
+        tree["instance_id"].get<InstanceID>() == remote_instance_id) {
+      rpc_blobs.emplace(member_id);
+    }
     if (FLAGS_local_copy) {
       blobs.emplace(member_id);
     } else {
@@ -67,13 +92,81 @@ static void find_blobs_on_remote_instance(const InstanceID remote_instance_id,
   } else {
     for (auto& item : tree) {
       if (item.is_object()) {
-        find_blobs_on_remote_instance(remote_instance_id, item, blobs);
+        find_blobs_on_remote_instance(remote_instance_id, item, blobs,
+                                      rpc_blobs);
       }
     }
   }
 }
 
+// The codec is agreed in the handshake: the client sends the requested one
+// and the server replies the accepted one, as the per-blob header doesn't
+// carry the codec.
+static void writeCodecName(asio::ip::tcp::socket& socket,
+                           std::string const& name) {
+  size_t length = name.size();
+  asio::write(socket, asio::buffer(&length, sizeof(size_t)));
+  asio::write(socket, asio::buffer(name));
+}
+
+static Status readCodecName(asio::ip::tcp::socket& socket, std::string& name) {
+  size_t length = 0;
+  asio::read(socket, asio::buffer(&length, sizeof(size_t)));
+  RETURN_ON_ASSERT(length <= 64, "Invalid codec name in the handshake");
+  name.resize(length);
+  asio::read(socket, asio::buffer(&name[0], length));
+  return Status::OK();
+}
+
+// Seals the blob writer, the writer is aborted if sealing fails.
+static Status sealBlob(Client& client, std::unique_ptr<BlobWriter>& writer,
+                       std::shared_ptr<Blob>& blob) {
+  try {
+    blob = std::dynamic_pointer_cast<Blob>(writer->Seal(client));
+  } catch (std::exception const& ex) {
+    VINEYARD_DISCARD(writer->Abort(client));
+    return Status::IOError("Failed to seal the blob " +
+                           ObjectIDToString(writer->id()) + ": " + ex.what());
+  }
+  RETURN_ON_ASSERT(blob != nullptr, "Failed to seal the blob " +
+                                        ObjectIDToString(writer->id()));
+  return Status::OK();
+}
+
+// Receives the content of a blob from the migration socket into the writer.
+static Status receiveBlob(asio::ip::tcp::socket& socket,
+                          std::unique_ptr<BlobCodec> const& codec,
+                          std::vector<uint8_t>& compressed,
+                          size_t const size_of_blob,
+                          size_t const compressed_size, BlobWriter& buffer) {
+  if (compressed_size > 0) {
+    RETURN_ON_ASSERT(codec != nullptr,
+                     "Received a compressed blob unexpectedly");
+    VLOG(10) << "Receiving compressed blob payload of size " << compressed_size
+             << " ...";
+    compressed.resize(compressed_size);
+    asio::read(socket, asio::buffer(compressed));
+    return codec->Decompress(compressed.data(), compressed.size(),
+                             reinterpret_cast<uint8_t*>(buffer.data()),
+                             size_of_blob);
+  }
+  VLOG(10) << "Receiving blob payload of size " << size_of_blob << " ...";
+  asio::read(socket, asio::buffer(buffer.data(), size_of_blob));
+  return Status::OK();
+}
+
 Status Serve(Client& client, asio::ip::tcp::socket&& socket) {
+  // accept the requested codec only if it is available here as well, and
+  // fallback to the raw payloads otherwise.
+  std::string compression;
+  RETURN_ON_ERROR(readCodecName(socket, compression));
+  compression = BlobCodec::Negotiate(compression);
+  std::unique_ptr<BlobCodec> codec;
+  if (compression != "none") {
+    RETURN_ON_ERROR(BlobCodec::Make(compression, codec));
+  }
+  writeCodecName(socket, compression);
+  std::vector<uint8_t> compressed;
   while (true) {
     ObjectID blob_to_send = InvalidObjectID();
     asio::read(socket, asio::buffer(&blob_to_send, sizeof(ObjectID)));
@@ -88,8 +181,20 @@ Status Serve(Client& client, asio::ip::tcp::socket&& socket) {
       blob = client.GetObject<Blob>(blob_to_send);
       blob_size = blob->size();
     }
+    // a non-zero compressed size means the payload has been compressed.
+    size_t compressed_size = 0;
+    if (blob_size > 0 && codec != nullptr &&
+        codec->Compress(reinterpret_cast<const uint8_t*>(blob->data()),
+                        blob_size, compressed)) {
+      compressed_size = compressed.size();
+    }
     asio::write(socket, asio::buffer(&blob_size, sizeof(size_t)));
-    if (blob_size > 0) {
+    asio::write(socket, asio::buffer(&compressed_size, sizeof(size_t)));
+    if (compressed_size > 0) {
+      VLOG(10) << "Sending compressed blob payload of size " << blob_size
+               << " -> " << compressed_size << " ...";
+      asio::write(socket, asio::buffer(compressed));
+    } else if (blob_size > 0) {
       VLOG(10) << "Sending blob payload of size " << blob_size << " ...";
       asio::write(socket, asio::buffer(blob->data(), blob_size));
     }
@@ -157,38 +262,90 @@ Status Rebuild(Client& client, ObjectMeta const& metadata, ObjectMeta& target,
 
 Status Work(Client& client, RPCClient& rpc_client,
             asio::ip::tcp::socket& socket) {
+  // adopt the codec that the server accepts
+  std::string compression = BlobCodec::Negotiate(FLAGS_compression);
+  writeCodecName(socket, compression);
+  RETURN_ON_ERROR(readCodecName(socket, compression));
+  std::unique_ptr<BlobCodec> codec;
+  if (compression != "none") {
+    RETURN_ON_ERROR(BlobCodec::Make(compression, codec));
+  }
+
   // ping to ensure server works as expected
   ObjectID empty_blob_id = EmptyBlobID();
   asio::write(socket, asio::buffer(&empty_blob_id, sizeof(ObjectID)));
   size_t received_size = std::numeric_limits<size_t>::max();
+  size_t compressed_size = std::numeric_limits<size_t>::max();
   asio::read(socket, asio::buffer(&received_size, sizeof(size_t)));
-  RETURN_ON_ASSERT(received_size == 0,
+  asio::read(socket, asio::buffer(&compressed_size, sizeof(size_t)));
+  RETURN_ON_ASSERT(received_size == 0 && compressed_size == 0,
                    "The remote server work as unexpectedly, abort");
+  std::vector<uint8_t> compressed;
   ObjectMeta metadata;
   RETURN_ON_ERROR(
       rpc_client.GetMetaData(VYObjectIDFromString(FLAGS_id), metadata, true));
 
   // step 1: collect blob set
-  std::set<ObjectID> remote_blobs;
+  std::set<ObjectID> remote_blobs, rpc_blobs;
   find_blobs_on_remote_instance(rpc_client.remote_instance_id(),
-                                metadata.MetaData(), remote_blobs);
+                                metadata.MetaData(), remote_blobs, rpc_blobs);
   metadata.PrintMeta();
   VLOG(10) << "blob sizes to migrate: " << remote_blobs.size();
   std::map<ObjectID, std::shared_ptr<Blob>> target_blobs;
 
-  // step 2: migrate blobs to local
+  // step 2.1: fetch blobs that live on the RPC peer in place, and fallback to
+  // the migration socket if the fetch fails.
+  if (!rpc_blobs.empty()) {
+    std::map<ObjectID, std::unique_ptr<BlobWriter>> buffers;
+    auto status = rpc_client.GetRemoteBlobs(rpc_blobs, client, buffers);
+    if (status.ok()) {
+      for (auto iter = buffers.begin(); iter != buffers.end(); ++iter) {
+        std::shared_ptr<Blob> blob;
+        status = sealBlob(client, iter->second, blob);
+        if (!status.ok()) {
+          // the writers that haven't been sealed are aborted
+          for (auto rest = std::next(iter); rest != buffers.end(); ++rest) {
+            VINEYARD_DISCARD(rest->second->Abort(client));
+          }
+          return status;
+        }
+        target_blobs.emplace(iter->first, blob);
+      }
+    } else {
+      LOG(WARNING) << "Failed to fetch blobs through RPC, fallback to the "
+                      "migration socket: "
+                   << status.ToString();
+    }
+  }
+
+  // step 2.2: migrate the remaining blobs to local
   for (auto const& blob : remote_blobs) {
+    if (target_blobs.find(blob) != target_blobs.end()) {
+      continue;
+    }
     VLOG(10) << "Will migrate blob " << VYObjectIDToString(blob) << " to local";
     asio::write(socket, asio::buffer(&blob, sizeof(ObjectID)));
     size_t size_of_blob = std::numeric_limits<size_t>::max();
     asio::read(socket, asio::buffer(&size_of_blob, sizeof(size_t)));
+    asio::read(socket, asio::buffer(&compressed_size, sizeof(size_t)));
     if (size_of_blob > 0) {
       std::unique_ptr<BlobWriter> buffer;
       RETURN_ON_ERROR(client.CreateBlob(size_of_blob, buffer));
-      VLOG(10) << "Receiving blob payload of size " << size_of_blob << " ...";
-      asio::read(socket, asio::buffer(buffer->data(), size_of_blob));
-      target_blobs.emplace(
-          blob, std::dynamic_pointer_cast<Blob>(buffer->Seal(client)));
+      Status status;
+      try {
+        status = receiveBlob(socket, codec, compressed, size_of_blob,
+                             compressed_size, *buffer);
+      } catch (std::exception const& ex) {
+        status = Status::IOError("Failed to receive the blob " +
+                                 ObjectIDToString(blob) + ": " + ex.what());
+      }
+      if (!status.ok()) {
+        VINEYARD_DISCARD(buffer->Abort(client));
+        return status;
+      }
+      std::shared_ptr<Blob> target_blob;
+      RETURN_ON_ERROR(sealBlob(client, buffer, target_blob));
+      target_blobs.emplace(blob, target_blob);
     } else {
       target_blobs.emplace(blob, Blob::MakeEmpty(client));
     }
@@ -254,6 +411,13 @@ Status RunClient() {
 
   RPCClient rpc_client;
   RETURN_ON_ERROR(rpc_client.Connect(FLAGS_rpc_endpoint));
+  if (use_rpc_fetch() && FLAGS_rpc_streams > 0) {
+    auto status = rpc_client.ConnectDataStreams(FLAGS_rpc_streams);
+    if (!status.ok()) {
+      LOG(WARNING) << "Failed to open extra RPC data streams: "
+                   << status.ToString();
+    }
+  }
 
   auto status = Work(client, rpc_client, socket);
 
@@ -281,6 +445,14 @@ int main(int argc, char** argv) {
   }
   vineyard::flags::HandleCommandLineHelpFlags();
 
+  if (vineyard::FLAGS_compression.empty()) {
+    vineyard::FLAGS_compression =
+        vineyard::read_env("VINEYARD_MIGRATION_COMPRESSION");
+  }
+  if (vineyard::FLAGS_compression.empty()) {
+    vineyard::FLAGS_compression = "none";
+  }
+
   if (vineyard::FLAGS_client && vineyard::FLAGS_server) {
     LOG(ERROR)
         << "A process cannot be serve as client and server at the same time";
@@ -47,9 +47,24 @@ namespace vineyard {
  * instance that connects to the same socket file, it will reuse the client,
  * since the vineyard client itself is thread-safe.
  *
+ * The blocking calls release the GIL, thus python threads can share a client
+ * (the requests are serialized on the connection), or use `fork()` to get
+ * a client with a dedicated connection for concurrent requests.
+ *
  * The aim is to make python API more pythonic, and make the object lifecycle
  * control easier.
  */
+/**
+ * A slice of the memory mapped by a MmapEntry, the mapping is kept alive as
+ * long as the buffer (or any memoryview of it) is referenced in python.
+ */
+struct MappedBuffer {
+  std::shared_ptr<MmapEntry> entry;
+  uint8_t* data;
+  size_t size;
+  bool readonly;
+};
+
 template <typename ClientType>
 class ClientManager {
  public:
@@ -62,16 +77,26 @@ class ClientManager {
   }
 
   std::shared_ptr<ClientType> Connect(std::string const& endpoint = "") {
-    std::lock_guard<std::mutex> guard{mtx_};
-    auto iter = client_set_.find(endpoint);
-    if (iter != client_set_.end()) {
-      if (iter->second->Connected()) {
-        return iter->second;
+    std::shared_ptr<ClientType> client = nullptr;
+    Status connect_status;
+    {
+      // release the GIL before taking the lock: other threads may block on
+      // the lock while holding the GIL.
+      py::gil_scoped_release release;
+      std::lock_guard<std::mutex> guard{mtx_};
+      auto iter = client_set_.find(endpoint);
+      if (iter != client_set_.end()) {
+        if (iter->second->Connected()) {
+          return iter->second;
+        }
+      }
+      client = std::make_shared<ClientType>();
+      connect_status =
+          endpoint.empty() ? client->Connect() : client->Connect(endpoint);
+      if (connect_status.ok()) {
+        client_set_[endpoint] = client;
       }
     }
-    std::shared_ptr<ClientType> client = std::make_shared<ClientType>();
-    auto connect_status =
-        endpoint.empty() ? client->Connect() : client->Connect(endpoint);
     if (PyErr_CheckSignals() != 0) {
       // The method `Connect` will keep retrying, we need to propogate
       // the Ctrl-C when during the C++ code run retries.
@@ -80,7 +105,6 @@ class ClientManager {
     // propogate the KeyboardInterrupt exception correctly before the
     // RuntimeError
     throw_on_error(connect_status);
-    client_set_.emplace(endpoint, client);
     return client;
   }
 
@@ -106,18 +130,21 @@ void bind_client(py::module& mod) {
   py::class_<ClientBase, std::shared_ptr<ClientBase>>(mod, "ClientBase")
       .def(
           "create_metadata",
-          [](ClientBase* self, ObjectMeta& metadata) -> ObjectMeta& {
+          [](ClientBase* self, ObjectMeta& metadata,
+             const int64_t ttl) -> ObjectMeta& {
             ObjectID object_id;
-            throw_on_error(self->CreateMetaData(metadata, object_id));
+            throw_on_error(self->CreateMetaData(metadata, ttl, object_id));
             return metadata;
           },
-          "metadata"_a)
+          py::call_guard<py::gil_scoped_release>(), "metadata"_a,
+          py::arg("ttl") = 0)
       .def(
           "delete",
           [](ClientBase* self, const ObjectIDWrapper object_id,
              const bool force, const bool deep) {
             throw_on_error(self->DelData(object_id, force, deep));
           },
+          py::call_guard<py::gil_scoped_release>(),
           "object_id"_a, py::arg("force") = false, py::arg("deep") = true)
       .def(
           "delete",
@@ -129,6 +156,7 @@ void bind_client(py::module& mod) {
             }
             throw_on_error(self->DelData(unwrapped_object_ids, force, deep));
           },
+          py::call_guard<py::gil_scoped_release>(),
           "object_ids"_a, py::arg("force") = false, py::arg("deep") = true)
       .def(
           "delete",
@@ -136,6 +164,7 @@ void bind_client(py::module& mod) {
              const bool deep) {
             throw_on_error(self->DelData(meta.GetId(), force, deep));
           },
+          py::call_guard<py::gil_scoped_release>(),
           "object_meta"_a, py::arg("force") = false, py::arg("deep") = true)
       .def(
           "delete",
@@ -143,25 +172,40 @@ void bind_client(py::module& mod) {
              const bool deep) {
             throw_on_error(self->DelData(object->id(), force, deep));
           },
+          py::call_guard<py::gil_scoped_release>(),
           "object"_a, py::arg("force") = false, py::arg("deep") = true)
       .def(
           "persist",
           [](ClientBase* self, const ObjectIDWrapper object_id) {
             throw_on_error(self->Persist(object_id));
           },
-          "object_id"_a)
+          py::call_guard<py::gil_scoped_release>(), "object_id"_a)
       .def(
           "persist",
           [](ClientBase* self, const ObjectMeta& meta) {
             throw_on_error(self->Persist(meta.GetId()));
           },
-          "object_meta"_a)
+          py::call_guard<py::gil_scoped_release>(), "object_meta"_a)
       .def(
           "persist",
           [](ClientBase* self, const Object* object) {
             throw_on_error(self->Persist(object->id()));
           },
-          "object"_a)
+          py::call_guard<py::gil_scoped_release>(), "object"_a)
+      .def(
+          "persist_async",
+          [](ClientBase* self, const ObjectIDWrapper object_id) -> uint64_t {
+            uint64_t ticket = 0;
+            throw_on_error(self->PersistAsync(object_id, ticket));
+            return ticket;
+          },
+          py::call_guard<py::gil_scoped_release>(), "object_id"_a)
+      .def(
+          "wait_persisted",
+          [](ClientBase* self, const uint64_t ticket) {
+            throw_on_error(self->WaitPersisted(ticket));
+          },
+          py::call_guard<py::gil_scoped_release>(), py::arg("ticket") = 0)
       .def(
           "exists",
           [](ClientBase* self, const ObjectIDWrapper object_id) -> bool {
@@ -169,7 +213,7 @@ void bind_client(py::module& mod) {
             throw_on_error(self->Exists(object_id, exists));
             return exists;
           },
-          "object_id"_a)
+          py::call_guard<py::gil_scoped_release>(), "object_id"_a)
       .def(
           "shallow_copy",
           [](ClientBase* self,
@@ -201,48 +245,70 @@ void bind_client(py::module& mod) {
             throw_on_error(self->DeepCopy(object_id, target_id));
             return target_id;
           },
-          "object_id"_a)
+          py::call_guard<py::gil_scoped_release>(), "object_id"_a)
       .def(
           "put_name",
           [](ClientBase* self, const ObjectIDWrapper object_id,
-             std::string const& name) {
-            throw_on_error(self->PutName(object_id, name));
+             std::string const& name, const int64_t ttl) {
+            throw_on_error(self->PutName(object_id, name, ttl));
           },
-          "object_id"_a, "name"_a)
+          py::call_guard<py::gil_scoped_release>(), "object_id"_a, "name"_a,
+          py::arg("ttl") = 0)
       .def(
           "put_name",
           [](ClientBase* self, const ObjectIDWrapper object_id,
-             ObjectNameWrapper const& name) {
-            throw_on_error(self->PutName(object_id, name));
+             ObjectNameWrapper const& name, const int64_t ttl) {
+            throw_on_error(self->PutName(object_id, name, ttl));
           },
-          "object_id"_a, "name"_a)
+          py::call_guard<py::gil_scoped_release>(), "object_id"_a, "name"_a,
+          py::arg("ttl") = 0)
       .def(
           "put_name",
           [](ClientBase* self, const ObjectMeta& meta,
-             std::string const& name) {
-            throw_on_error(self->PutName(meta.GetId(), name));
+             std::string const& name, const int64_t ttl) {
+            throw_on_error(self->PutName(meta.GetId(), name, ttl));
           },
-          "object_meta"_a, "name"_a)
+          py::call_guard<py::gil_scoped_release>(), "object_meta"_a, "name"_a,
+          py::arg("ttl") = 0)
       .def(
           "put_name",
           [](ClientBase* self, const ObjectMeta& meta,
-             ObjectNameWrapper const& name) {
-            throw_on_error(self->PutName(meta.GetId(), name));
+             ObjectNameWrapper const& name, const int64_t ttl) {
+            throw_on_error(self->PutName(meta.GetId(), name, ttl));
           },
-          "object_meta"_a, "name"_a)
+          py::call_guard<py::gil_scoped_release>(), "object_meta"_a, "name"_a,
+          py::arg("ttl") = 0)
       .def(
           "put_name",
-          [](ClientBase* self, const Object* object, std::string const& name) {
-            throw_on_error(self->PutName(object->id(), name));
+          [](ClientBase* self, const Object* object, std::string const& name,
+             const int64_t ttl) {
+            throw_on_error(self->PutName(object->id(), name, ttl));
           },
-          "object"_a, "name"_a)
+          py::call_guard<py::gil_scoped_release>(), "object"_a, "name"_a,
+          py::arg("ttl") = 0)
       .def(
           "put_name",
           [](ClientBase* self, const Object* object,
-             ObjectNameWrapper const& name) {
-            throw_on_error(self->PutName(object->id(), name));
+             ObjectNameWrapper const& name, const int64_t ttl) {
+            throw_on_error(self->PutName(object->id(), name, ttl));
+          },
+          py::call_guard<py::gil_scoped_release>(), "object"_a, "name"_a,
+          py::arg("ttl") = 0)
+      .def(
+          "create_snapshot",
+          [](ClientBase* self, const bool sync_remote) -> uint64_t {
+            uint64_t snapshot = 0;
+            throw_on_error(self->CreateSnapshot(snapshot, sync_remote));
+            return snapshot;
           },
-          "object"_a, "name"_a)
+          py::call_guard<py::gil_scoped_release>(),
+          py::arg("sync_remote") = false)
+      .def(
+          "release_snapshot",
+          [](ClientBase* self, const uint64_t snapshot) {
+            throw_on_error(self->ReleaseSnapshot(snapshot));
+          },
+          py::call_guard<py::gil_scoped_release>(), "snapshot"_a)
       .def(
           "get_name",
           [](ClientBase* self, std::string const& name,
@@ -251,6 +317,7 @@ void bind_client(py::module& mod) {
             throw_on_error(self->GetName(name, object_id));
             return object_id;
           },
+          py::call_guard<py::gil_scoped_release>(),
           "object_id"_a, py::arg("wait") = false)
       .def(
           "get_name",
@@ -260,23 +327,25 @@ void bind_client(py::module& mod) {
             throw_on_error(self->GetName(name, object_id));
             return object_id;
           },
+          py::call_guard<py::gil_scoped_release>(),
           "object_id"_a, py::arg("wait") = false)
       .def(
           "drop_name",
           [](ClientBase* self, std::string const& name) {
             throw_on_error(self->DropName(name));
           },
-          "name"_a)
+          py::call_guard<py::gil_scoped_release>(), "name"_a)
       .def(
           "drop_name",
           [](ClientBase* self, ObjectNameWrapper const& name) {
             throw_on_error(self->DropName(name));
           },
-          "name"_a)
+          py::call_guard<py::gil_scoped_release>(), "name"_a)
       .def("sync_meta",
            [](ClientBase* self) -> void {
              VINEYARD_DISCARD(self->SyncMetaData());
-           })
+           },
+           py::call_guard<py::gil_scoped_release>())
       .def(
           "migrate",
           [](ClientBase* self, const ObjectID object_id) -> ObjectIDWrapper {
@@ -284,7 +353,83 @@ void bind_client(py::module& mod) {
             throw_on_error(self->MigrateObject(object_id, target_id));
             return target_id;
           },
-          "object_id"_a)
+          py::call_guard<py::gil_scoped_release>(), "object_id"_a)
+      .def(
+          "replicate",
+          [](ClientBase* self, const ObjectIDWrapper object_id,
+             std::vector<InstanceID> const& instances)
+              -> std::map<InstanceID, ObjectIDWrapper> {
+            std::map<InstanceID, ObjectID> replicas;
+            throw_on_error(self->Replicate(object_id, instances, replicas));
+            return std::map<InstanceID, ObjectIDWrapper>(replicas.begin(),
+                                                         replicas.end());
+          },
+          py::call_guard<py::gil_scoped_release>(),
+          "object_id"_a, "instances"_a)
+      .def(
+          "migrate_objects",
+          [](ClientBase* self,
+             std::map<ObjectIDWrapper, InstanceID> const& placement,
+             size_t const parallelism, size_t const parallelism_per_instance,
+             size_t const bandwidth)
+              -> std::map<ObjectIDWrapper, ObjectIDWrapper> {
+            MigrationOptions options;
+            options.parallelism = parallelism;
+            options.parallelism_per_instance = parallelism_per_instance;
+            options.bandwidth = bandwidth;
+            std::map<ObjectID, ObjectID> results;
+            throw_on_error(self->Migrate(
+                std::map<ObjectID, InstanceID>(placement.begin(),
+                                               placement.end()),
+                results, options));
+            return std::map<ObjectIDWrapper, ObjectIDWrapper>(results.begin(),
+                                                              results.end());
+          },
+          py::call_guard<py::gil_scoped_release>(), "placement"_a,
+          py::arg("parallelism") = 4, py::arg("parallelism_per_instance") = 2,
+          py::arg("bandwidth") = 0)
+      .def(
+          "prefetch",
+          [](ClientBase* self, std::vector<ObjectIDWrapper> const& object_ids,
+             const InstanceID instance) -> size_t {
+            size_t nbytes = 0;
+            throw_on_error(self->Prefetch(
+                std::vector<ObjectID>(object_ids.begin(), object_ids.end()),
+                instance, nbytes));
+            return nbytes;
+          },
+          py::call_guard<py::gil_scoped_release>(), "object_ids"_a,
+          py::arg("instance") = UnspecifiedInstanceID())
+      .def(
+          "footprints",
+          [](ClientBase* self, std::vector<ObjectIDWrapper> const& object_ids,
+             size_t const limit) -> py::tuple {
+            std::vector<ObjectFootprint> objects;
+            std::map<std::string, TypeFootprint> types;
+            Status s;
+            {
+              py::gil_scoped_release release;
+              s = self->Footprints(
+                  std::vector<ObjectID>(object_ids.begin(), object_ids.end()),
+                  limit, objects, types);
+            }
+            throw_on_error(s);
+            py::list objects_out;
+            for (auto const& object : objects) {
+              objects_out.append(py::dict("id"_a = ObjectIDWrapper(object.id),
+                                          "typename"_a = object.type_name,
+                                          "size"_a = object.size));
+            }
+            py::dict types_out;
+            for (auto const& type : types) {
+              types_out[py::str(type.first)] =
+                  py::dict("objects"_a = type.second.objects,
+                           "size"_a = type.second.size);
+            }
+            return py::make_tuple(objects_out, types_out);
+          },
+          py::arg("object_ids") = std::vector<ObjectIDWrapper>{},
+          py::arg("limit") = 0)
       .def(
           "migrate_stream",
           [](ClientBase* self, const ObjectID object_id) -> ObjectIDWrapper {
@@ -292,7 +437,7 @@ void bind_client(py::module& mod) {
             throw_on_error(self->MigrateStream(object_id, target_id));
             return target_id;
           },
-          "object_id"_a)
+          py::call_guard<py::gil_scoped_release>(), "object_id"_a)
       .def_property_readonly("connected", &Client::Connected)
       .def_property_readonly("instance_id", &Client::instance_id)
       .def_property_readonly(
@@ -301,7 +446,12 @@ void bind_client(py::module& mod) {
               -> std::map<uint64_t,
                           std::unordered_map<std::string, py::object>> {
             std::map<uint64_t, json> meta;
-            throw_on_error(self->ClusterInfo(meta));
+            Status status;
+            {
+              py::gil_scoped_release release;
+              status = self->ClusterInfo(meta);
+            }
+            throw_on_error(status);
             std::map<uint64_t, std::unordered_map<std::string, py::object>>
                 meta_to_return;
             for (auto const& kv : meta) {
@@ -315,17 +465,62 @@ void bind_client(py::module& mod) {
             }
             return meta_to_return;
           })
+      .def(
+          "locality",
+          [](ClientBase* self, const ObjectIDWrapper object_id,
+             const bool sync_remote) -> std::map<InstanceID, size_t> {
+            std::map<InstanceID, size_t> locality;
+            throw_on_error(
+                self->LocalityInfo(object_id, locality, sync_remote));
+            return locality;
+          },
+          py::call_guard<py::gil_scoped_release>(),
+          "object_id"_a, py::arg("sync_remote") = true)
       .def_property_readonly(
           "status",
           [](ClientBase* self) -> std::shared_ptr<InstanceStatus> {
             std::shared_ptr<InstanceStatus> status;
-            throw_on_error(self->InstanceStatus(status));
+            Status s;
+            {
+              py::gil_scoped_release release;
+              s = self->InstanceStatus(status);
+            }
+            throw_on_error(s);
             return status;
           })
+      .def(
+          "list_data",
+          [](ClientBase* self, std::string const& pattern, bool const regex,
+             std::string const& name_prefix, std::string const& cursor,
+             size_t const limit, bool const brief) -> py::tuple {
+            std::vector<json> objects;
+            std::string next_cursor;
+            Status s;
+            {
+              py::gil_scoped_release release;
+              s = self->ListData(pattern, regex, name_prefix, cursor, limit,
+                                 brief, objects, next_cursor);
+            }
+            throw_on_error(s);
+            py::list items;
+            for (auto const& item : objects) {
+              items.append(detail::from_json(item));
+            }
+            return py::make_tuple(items, next_cursor);
+          },
+          "pattern"_a, py::arg("regex") = false, py::arg("name_prefix") = "",
+          py::arg("cursor") = "", py::arg("limit") = 1024,
+          py::arg("brief") = true)
       .def("debug",
            [](ClientBase* self, py::dict debug) {
-             json result;
-             throw_on_error(self->Debug(detail::to_json(debug), result));
+             json request = detail::to_json(debug), result;
+             Status status;
+             {
+               // the profiling request blocks for seconds
+               py::gil_scoped_release release;
+               status = self->Debug(request, result);
+             }
+             throw_on_error(status);
              return detail::from_json(result);
            })
       .def_property_readonly("ipc_socket", &ClientBase::IPCSocket)
@@ -347,6 +542,51 @@ void bind_client(py::module& mod) {
       .def_property_readonly(
           "memory_limit",
           [](InstanceStatus* status) { return status->memory_limit; })
+      .def_property_readonly(
+          "spilled_objects",
+          [](InstanceStatus* status) { return status->spilled_objects; })
+      .def_property_readonly(
+          "spilled_size",
+          [](InstanceStatus* status) { return status->spilled_size; })
+      .def_property_readonly(
+          "small_blobs",
+          [](InstanceStatus* status) { return status->small_blobs; })
+      .def_property_readonly(
+          "small_blobs_size",
+          [](InstanceStatus* status) { return status->small_blobs_size; })
+      .def_property_readonly(
+          "small_blobs_capacity",
+          [](InstanceStatus* status) { return status->small_blobs_capacity; })
+      .def_property_readonly(
+          "free_size",
+          [](InstanceStatus* status) { return status->free_size; })
+      .def_property_readonly(
+          "free_blocks",
+          [](InstanceStatus* status) { return status->free_blocks; })
+      .def_property_readonly(
+          "largest_free_size",
+          [](InstanceStatus* status) { return status->largest_free_size; })
+      .def_property_readonly(
+          "relocated_objects",
+          [](InstanceStatus* status) { return status->relocated_objects; })
+      .def_property_readonly(
+          "relocated_size",
+          [](InstanceStatus* status) { return status->relocated_size; })
+      .def_property_readonly(
+          "prefaulted_size",
+          [](InstanceStatus* status) { return status->prefaulted_size; })
+      .def_property_readonly(
+          "prefault_size",
+          [](InstanceStatus* status) { return status->prefault_size; })
+      .def_property_readonly(
+          "deduplicated_objects",
+          [](InstanceStatus* status) { return status->deduplicated_objects; })
+      .def_property_readonly(
+          "deduplicated_size",
+          [](InstanceStatus* status) { return status->deduplicated_size; })
+      .def_property_readonly(
+          "dedup_ratio",
+          [](InstanceStatus* status) { return status->dedup_ratio; })
       .def_property_readonly(
           "deferred_requests",
           [](InstanceStatus* status) { return status->deferred_requests; })
@@ -367,6 +607,10 @@ void bind_client(py::module& mod) {
                 << std::endl;
              ss << "    memory_limit: " << status->memory_limit << ","
                 << std::endl;
+             ss << "    spilled_objects: " << status->spilled_objects << ","
+                << std::endl;
+             ss << "    spilled_size: " << status->spilled_size << ","
+                << std::endl;
              ss << "    deferred_requests: " << status->deferred_requests << ","
                 << std::endl;
              ss << "    ipc_connections: " << status->ipc_connections << ","
@@ -383,6 +627,8 @@ void bind_client(py::module& mod) {
         ss << "    deployment: " << status->deployment << std::endl;
         ss << "    memory_usage: " << status->memory_usage << std::endl;
         ss << "    memory_limit: " << status->memory_limit << std::endl;
+        ss << "    spilled_objects: " << status->spilled_objects << std::endl;
+        ss << "    spilled_size: " << status->spilled_size << std::endl;
         ss << "    deferred_requests: " << status->deferred_requests
            << std::endl;
         ss << "    ipc_connections: " << status->ipc_connections << std::endl;
@@ -394,16 +640,45 @@ void bind_client(py::module& mod) {
   py::class_<Client, std::shared_ptr<Client>, ClientBase>(mod, "IPCClient")
       .def(
           "create_blob",
-          [](Client* self, size_t size) {
+          [](Client* self, size_t size, int numa_node) {
             std::unique_ptr<BlobWriter> blob;
-            throw_on_error(self->CreateBlob(size, blob));
+            throw_on_error(self->CreateBlob(size, numa_node, blob));
             return std::shared_ptr<BlobWriter>(blob.release());
           },
-          py::return_value_policy::move, "size"_a)
+          py::call_guard<py::gil_scoped_release>(),
+          py::return_value_policy::move, "size"_a, "numa_node"_a = -1)
+      .def(
+          "copy_blob",
+          [](Client* self, const ObjectIDWrapper source) {
+            std::unique_ptr<BlobWriter> blob;
+            throw_on_error(self->CopyBlob(source, blob));
+            return std::shared_ptr<BlobWriter>(blob.release());
+          },
+          py::call_guard<py::gil_scoped_release>(),
+          py::return_value_policy::move, "source"_a)
+      .def(
+          "create_blob_from_file",
+          [](Client* self, std::string const& path, size_t const offset,
+             int64_t const length) {
+            std::shared_ptr<Blob> blob;
+            throw_on_error(
+                self->CreateBlobFromFile(path, offset, length, blob));
+            return blob;
+          },
+          py::call_guard<py::gil_scoped_release>(), "path"_a, "offset"_a = 0,
+          "length"_a = -1)
       .def("create_empty_blob",
            [](Client* self) -> std::shared_ptr<Blob> {
              return Blob::MakeEmpty(*self);
            })
+      .def(
+          "release",
+          [](Client* self, const std::vector<ObjectIDWrapper>& object_ids) {
+            std::vector<ObjectID> unwrapped_object_ids(object_ids.begin(),
+                                                       object_ids.end());
+            throw_on_error(self->Release(unwrapped_object_ids));
+          },
+          py::call_guard<py::gil_scoped_release>(), "object_ids"_a)
       .def(
           "get_object",
           [](Client* self, const ObjectIDWrapper object_id) {
@@ -412,7 +687,7 @@ void bind_client(py::module& mod) {
             throw_on_error(self->GetObject(object_id, object));
             return object;
           },
-          "object_id"_a)
+          py::call_guard<py::gil_scoped_release>(), "object_id"_a)
       .def(
           "get_objects",
           [](Client* self, const std::vector<ObjectIDWrapper>& object_ids) {
@@ -422,7 +697,7 @@ void bind_client(py::module& mod) {
             }
             return self->GetObjects(unwrapped_object_ids);
           },
-          "object_ids"_a)
+          py::call_guard<py::gil_scoped_release>(), "object_ids"_a)
       .def(
           "get_meta",
           [](Client* self, ObjectIDWrapper const& object_id,
@@ -433,11 +708,13 @@ void bind_client(py::module& mod) {
             throw_on_error(self->GetMetaData(object_id, meta, sync_remote));
             return meta;
           },
+          py::call_guard<py::gil_scoped_release>(),
           "object_id"_a, py::arg("sync_remote") = false)
       .def(
           "get_metas",
           [](Client* self, std::vector<ObjectIDWrapper> const& object_ids,
-             bool const sync_remote) -> std::vector<ObjectMeta> {
+             bool const sync_remote,
+             uint64_t const snapshot) -> std::vector<ObjectMeta> {
             std::vector<ObjectMeta> metas;
             // FIXME: do we really not need to sync from etcd? We assume the
             // object is a local object
@@ -445,12 +722,19 @@ void bind_client(py::module& mod) {
             for (size_t idx = 0; idx < object_ids.size(); ++idx) {
               unwrapped_object_ids[idx] = object_ids[idx];
             }
-            throw_on_error(
-                self->GetMetaData(unwrapped_object_ids, metas, sync_remote));
+            if (snapshot != 0) {
+              throw_on_error(
+                  self->GetMetaData(unwrapped_object_ids, snapshot, metas));
+            } else {
+              throw_on_error(
+                  self->GetMetaData(unwrapped_object_ids, metas, sync_remote));
+            }
             return metas;
           },
-          "object_ids"_a, py::arg("sync_remote") = false)
+          py::call_guard<py::gil_scoped_release>(), "object_ids"_a,
+          py::arg("sync_remote") = false, py::arg("snapshot") = 0)
       .def("list_objects", &Client::ListObjects, "pattern"_a,
+           py::call_guard<py::gil_scoped_release>(),
            py::arg("regex") = false, py::arg("limit") = 5)
       .def(
           "allocated_size",
@@ -459,7 +743,7 @@ void bind_client(py::module& mod) {
             throw_on_error(self->AllocatedSize(id, size));
             return size;
           },
-          "target"_a)
+          py::call_guard<py::gil_scoped_release>(), "target"_a)
       .def(
           "allocated_size",
           [](Client* self, const Object* target) -> size_t {
@@ -469,7 +753,7 @@ void bind_client(py::module& mod) {
             }
             return size;
           },
-          "target"_a)
+          py::call_guard<py::gil_scoped_release>(), "target"_a)
       .def("close",
            [](Client* self) {
              return ClientManager<Client>::GetManager()->Disconnect(
@@ -480,7 +764,8 @@ void bind_client(py::module& mod) {
              std::shared_ptr<Client> client(new Client());
              throw_on_error(self->Fork(*client));
              return client;
-           })
+           },
+           py::call_guard<py::gil_scoped_release>())
       .def("__enter__", [](Client* self) { return self; })
       .def("__exit__", [](Client* self, py::object, py::object, py::object) {
         // DO NOTHING
@@ -497,7 +782,7 @@ void bind_client(py::module& mod) {
             throw_on_error(self->GetObject(object_id, object));
             return object;
           },
-          "object_id"_a)
+          py::call_guard<py::gil_scoped_release>(), "object_id"_a)
       .def(
           "get_objects",
           [](RPCClient* self, std::vector<ObjectIDWrapper> const& object_ids) {
@@ -507,7 +792,7 @@ void bind_client(py::module& mod) {
             }
             return self->GetObjects(unwrapped_object_ids);
           },
-          "object_ids"_a)
+          py::call_guard<py::gil_scoped_release>(), "object_ids"_a)
       .def(
           "get_meta",
           [](RPCClient* self, ObjectIDWrapper const& object_id) -> ObjectMeta {
@@ -515,7 +800,7 @@ void bind_client(py::module& mod) {
             throw_on_error(self->GetMetaData(object_id, meta, true));
             return meta;
           },
-          "object_id"_a)
+          py::call_guard<py::gil_scoped_release>(), "object_id"_a)
       .def(
           "get_metas",
           [](RPCClient* self, std::vector<ObjectIDWrapper> const& object_ids)
@@ -529,8 +814,9 @@ void bind_client(py::module& mod) {
                 self->GetMetaData(unwrapped_object_ids, metas, true));
             return metas;
           },
-          "object_ids"_a)
+          py::call_guard<py::gil_scoped_release>(), "object_ids"_a)
       .def("list_objects", &RPCClient::ListObjects, "pattern"_a,
+           py::call_guard<py::gil_scoped_release>(),
            py::arg("regex") = false, py::arg("limit") = 5)
       .def("close",
            [](RPCClient* self) {
@@ -542,7 +828,8 @@ void bind_client(py::module& mod) {
              std::shared_ptr<Client> client(new Client());
              throw_on_error(self->Fork(*client));
              return client;
-           })
+           },
+           py::call_guard<py::gil_scoped_release>())
       .def_property_readonly("remote_instance_id",
                              &RPCClient::remote_instance_id)
       .def("__enter__", [](RPCClient* self) { return self; })
@@ -606,6 +893,43 @@ void bind_client(py::module& mod) {
                 rpc_endpoint);
           },
           "(host, port)"_a);
+
+  // MmapEntry: maps the fds received by the asyncio client, see also
+  // `vineyard.core.aio`.
+  py::class_<MmapEntry, std::shared_ptr<MmapEntry>>(mod, "MmapEntry")
+      .def(py::init<int, int64_t, int64_t, bool, bool>(), "fd"_a,
+           "map_size"_a, "page_size"_a = 0, "readonly"_a = true,
+           "realign"_a = true)
+      .def_property_readonly("fd", &MmapEntry::fd)
+      .def(
+          "view",
+          [](std::shared_ptr<MmapEntry> self, const size_t offset,
+             const size_t size, const bool readonly) -> MappedBuffer {
+            uint8_t* pointer =
+                readonly ? self->map_readonly() : self->map_readwrite();
+            if (pointer == nullptr) {
+              throw_on_error(Status::IOError("Failed to mmap the fd " +
+                                             std::to_string(self->fd())));
+            }
+            return MappedBuffer{self, pointer + offset, size, readonly};
+          },
+          "offset"_a, "size"_a, "readonly"_a = true);
+
+  // MappedBuffer
+  py::class_<MappedBuffer, std::shared_ptr<MappedBuffer>>(
+      mod, "MappedBuffer", py::buffer_protocol())
+      .def_property_readonly(
+          "size", [](MappedBuffer* self) -> size_t { return self->size; })
+      .def_property_readonly(
+          "readonly",
+          [](MappedBuffer* self) -> bool { return self->readonly; })
+      .def("__len__", [](MappedBuffer* self) { return self->size; })
+      .def_buffer([](MappedBuffer& buffer) -> py::buffer_info {
+        return py::buffer_info(buffer.data, sizeof(int8_t),
+                               py::format_descriptor<int8_t>::format(), 1,
+                               {buffer.size}, {sizeof(int8_t)},
+                               buffer.readonly);
+      });
 }
 
 }  // namespace vineyard
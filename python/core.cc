@@ -15,17 +15,22 @@ limitations under the License.
 
 #include <functional>
 #include <memory>
+#include <string>
+#include <vector>
 
 #include "client/client.h"
 #include "client/ds/blob.h"
 #include "client/ds/i_object.h"
 #include "client/ds/object_meta.h"
 #include "client/rpc_client.h"
+#include "common/memory/memcpy.h"
 #include "common/util/json.h"
 #include "common/util/status.h"
 
 #include "pybind11/pybind11.h"
 #include "pybind11/stl.h"
+
+#include "dlpack.h"          // NOLINT(build/include_subdir)
 #include "pybind11_utils.h"  // NOLINT(build/include_subdir)
 
 namespace py = pybind11;
@@ -33,6 +38,94 @@ using namespace py::literals;  // NOLINT(build/namespaces_literals)
 
 namespace vineyard {
 
+namespace detail {
+
+// keeps the blob alive until the consumer of the DLPack tensor releases it.
+struct dlpack_context_t {
+  std::shared_ptr<Blob> blob;
+  std::vector<int64_t> shape, strides;
+  DLManagedTensor tensor;
+};
+
+static void dlpack_deleter(DLManagedTensor* self) {
+  delete static_cast<dlpack_context_t*>(self->manager_ctx);
+}
+
+static void dlpack_capsule_destructor(PyObject* capsule) {
+  // the consumer renames the capsule to "used_dltensor" once it takes the
+  // ownership, and is responsible for calling the deleter then.
+  if (PyCapsule_IsValid(capsule, "dltensor")) {
+    auto managed = static_cast<DLManagedTensor*>(
+        PyCapsule_GetPointer(capsule, "dltensor"));
+    managed->deleter(managed);
+  }
+}
+
+static py::object blob_to_dlpack(std::shared_ptr<Blob> const& blob,
+                                 std::string const& typestr,
+                                 std::vector<int64_t> const& shape,
+                                 std::vector<int64_t> const& strides,
+                                 uint64_t const offset) {
+  // `typestr` follows numpy's `dtype.str`, e.g., "<f8"
+  if (typestr.size() < 3 || typestr[0] == '>') {
+    throw_on_error(Status::Invalid("Unsupported dtype for DLPack: " + typestr));
+  }
+  DLDataType dtype;
+  switch (typestr[1]) {
+  case 'i':
+    dtype.code = kDLInt;
+    break;
+  case 'u':
+    dtype.code = kDLUInt;
+    break;
+  case 'f':
+    dtype.code = kDLFloat;
+    break;
+  case 'c':
+    dtype.code = kDLComplex;
+    break;
+  case 'b':
+    dtype.code = kDLBool;
+    break;
+  default:
+    throw_on_error(Status::Invalid("Unsupported dtype for DLPack: " + typestr));
+  }
+  int64_t itemsize = std::stoi(typestr.substr(2));
+  dtype.bits = static_cast<uint8_t>(itemsize * 8);
+  dtype.lanes = 1;
+  if (shape.size() != strides.size()) {
+    throw_on_error(
+        Status::Invalid("The shape doesn't match the strides for DLPack"));
+  }
+
+  auto context = new dlpack_context_t();
+  context->blob = blob;
+  context->shape = shape;
+  // DLPack counts the strides in elements
+  for (auto const stride : strides) {
+    if (stride % itemsize != 0) {
+      delete context;
+      throw_on_error(Status::Invalid(
+          "The strides must be multiples of the itemsize for DLPack"));
+    }
+    context->strides.emplace_back(stride / itemsize);
+  }
+  DLTensor& tensor = context->tensor.dl_tensor;
+  tensor.data = const_cast<char*>(blob->data());
+  tensor.device = DLDevice{kDLCPU, 0};
+  tensor.ndim = static_cast<int32_t>(shape.size());
+  tensor.dtype = dtype;
+  tensor.shape = context->shape.data();
+  tensor.strides = context->strides.data();
+  tensor.byte_offset = offset;
+  context->tensor.manager_ctx = context;
+  context->tensor.deleter = dlpack_deleter;
+  return py::reinterpret_steal<py::object>(PyCapsule_New(
+      &context->tensor, "dltensor", dlpack_capsule_destructor));
+}
+
+}  // namespace detail
+
 void bind_core(py::module& mod) {
   // ObjectIDWrapper
   py::class_<ObjectIDWrapper>(mod, "ObjectID")
@@ -316,7 +409,8 @@ void bind_core(py::module& mod) {
   py::class_<ObjectBuilder, std::shared_ptr<ObjectBuilder>>(mod,
                                                             "ObjectBuilder")
       // NB: don't expose the "Build" method to python.
-      .def("seal", &ObjectBuilder::Seal, "client"_a)
+      .def("seal", &ObjectBuilder::Seal, "client"_a,
+           py::call_guard<py::gil_scoped_release>())
       .def_property_readonly("issealed", &ObjectBuilder::sealed);
 
   // Blob
@@ -342,6 +436,8 @@ void bind_core(py::module& mod) {
       .def_property_readonly(
           "address",
           [](Blob* self) { return reinterpret_cast<uintptr_t>(self->data()); })
+      .def("dlpack", &detail::blob_to_dlpack, "typestr"_a, "shape"_a,
+           "strides"_a, "offset"_a = 0)
       .def_property_readonly("buffer",
                              [](Blob& blob) -> py::object {
                                auto buffer = blob.Buffer();
@@ -399,15 +495,22 @@ void bind_core(py::module& mod) {
           [](BlobWriter* self, Client& client) {
             throw_on_error(self->Abort(client));
           },
-          "client"_a)
+          py::call_guard<py::gil_scoped_release>(), "client"_a)
+      .def(
+          "extend",
+          [](BlobWriter* self, Client& client, size_t const size) {
+            throw_on_error(self->Extend(client, size));
+          },
+          py::call_guard<py::gil_scoped_release>(), "client"_a, "size"_a)
       .def(
           "copy",
           [](BlobWriter* self, size_t const offset, uintptr_t ptr,
              size_t const size) {
-            std::memcpy(self->data() + offset, reinterpret_cast<void*>(ptr),
-                        size);
+            memory::concurrent_memcpy(self->data() + offset,
+                                      reinterpret_cast<void*>(ptr), size);
           },
-          "offset"_a, "address"_a, "size"_a)
+          py::call_guard<py::gil_scoped_release>(), "offset"_a, "address"_a,
+          "size"_a)
       .def(
           "copy",
           [](BlobWriter* self, size_t offset, py::bytes bs) {
@@ -417,7 +520,11 @@ void bind_core(py::module& mod) {
               py::pybind11_fail("Unable to extract bytes contents!");
             }
             VINEYARD_ASSERT(offset + length <= self->size());
-            std::memcpy(self->data() + offset, buffer, length);
+            {
+              // the bytes object is kept alive by the arguments
+              py::gil_scoped_release release;
+              memory::concurrent_memcpy(self->data() + offset, buffer, length);
+            }
           },
           "offset"_a, "bytes"_a)
       .def_property_readonly("address",
@@ -40,39 +40,64 @@ void bind_stream(py::module& mod) {
           "next",
           [](ByteStreamWriter* self, size_t const size) -> py::object {
             std::unique_ptr<arrow::MutableBuffer> chunk = nullptr;
-            throw_on_error(self->GetNext(size, chunk));
+            Status status;
+            {
+              // allows the `next_async` running in an executor
+              py::gil_scoped_release release;
+              status = self->GetNext(size, chunk);
+            }
+            throw_on_error(status);
             auto chunk_ptr = chunk.release();
             return py::memoryview::from_memory(chunk_ptr->mutable_data(),
                                                chunk_ptr->size(), false);
           },
           "size"_a)
       .def("finish",
-           [](ByteStreamWriter* self) { throw_on_error(self->Finish()); })
+           [](ByteStreamWriter* self) { throw_on_error(self->Finish()); },
+           py::call_guard<py::gil_scoped_release>())
       .def("abort",
-           [](ByteStreamWriter* self) { throw_on_error(self->Abort()); });
+           [](ByteStreamWriter* self) { throw_on_error(self->Abort()); },
+           py::call_guard<py::gil_scoped_release>());
 
   // ByteStreamReader
   py::class_<ByteStreamReader, std::unique_ptr<ByteStreamReader>>(
       mod, "ByteStreamReader")
-      .def("next", [](ByteStreamReader* self) -> py::object {
-        std::unique_ptr<arrow::Buffer> chunk = nullptr;
-        throw_on_error(self->GetNext(chunk));
-        auto chunk_ptr = chunk.release();
-        return py::memoryview::from_memory(
-            const_cast<uint8_t*>(chunk_ptr->data()), chunk_ptr->size(), true);
-      });
+      .def("next",
+           [](ByteStreamReader* self) -> py::object {
+             std::unique_ptr<arrow::Buffer> chunk = nullptr;
+             Status status;
+             {
+               // allows the `next_async` running in an executor
+               py::gil_scoped_release release;
+               status = self->GetNext(chunk);
+             }
+             throw_on_error(status);
+             auto chunk_ptr = chunk.release();
+             return py::memoryview::from_memory(
+                 const_cast<uint8_t*>(chunk_ptr->data()), chunk_ptr->size(),
+                 true);
+           })
+      .def(
+          "set_prefetch",
+          [](ByteStreamReader* self, size_t const depth) {
+            self->SetPrefetch(depth);
+          },
+          "depth"_a);
 
   // ByteStream
   py::class_<ByteStream, std::shared_ptr<ByteStream>, Object>(mod, "ByteStream")
       .def(
           "open_reader",
-          [](ByteStream* self,
-             Client& client) -> std::unique_ptr<ByteStreamReader> {
+          [](ByteStream* self, Client& client,
+             bool const broadcast,
+             int64_t const offset) -> std::unique_ptr<ByteStreamReader> {
             std::unique_ptr<ByteStreamReader> reader = nullptr;
-            throw_on_error(self->OpenReader(client, reader));
+            throw_on_error(
+                self->OpenReader(client, reader, broadcast, offset));
             return reader;
           },
-          "client"_a)
+          py::call_guard<py::gil_scoped_release>(),
+          "client"_a, "broadcast"_a = false, "offset"_a = -1)
       .def(
           "open_writer",
           [](ByteStream* self,
@@ -81,7 +106,7 @@ void bind_stream(py::module& mod) {
             throw_on_error(self->OpenWriter(client, writer));
             return writer;
           },
-          "client"_a)
+          py::call_guard<py::gil_scoped_release>(), "client"_a)
       .def("__getitem__",
            [](ByteStream* self, std::string const& key) {
              return self->GetParams().at(key);
@@ -118,40 +143,65 @@ void bind_stream(py::module& mod) {
           "next",
           [](DataframeStreamWriter* self, size_t const size) -> py::object {
             std::unique_ptr<arrow::MutableBuffer> chunk = nullptr;
-            throw_on_error(self->GetNext(size, chunk));
+            Status status;
+            {
+              // allows the `next_async` running in an executor
+              py::gil_scoped_release release;
+              status = self->GetNext(size, chunk);
+            }
+            throw_on_error(status);
             auto chunk_ptr = chunk.release();
             return py::memoryview::from_memory(chunk_ptr->mutable_data(),
                                                chunk_ptr->size(), false);
           },
           "size"_a)
       .def("finish",
-           [](DataframeStreamWriter* self) { throw_on_error(self->Finish()); })
+           [](DataframeStreamWriter* self) { throw_on_error(self->Finish()); },
+           py::call_guard<py::gil_scoped_release>())
       .def("abort",
-           [](DataframeStreamWriter* self) { throw_on_error(self->Abort()); });
+           [](DataframeStreamWriter* self) { throw_on_error(self->Abort()); },
+           py::call_guard<py::gil_scoped_release>());
 
   // DataframeStreamReader
   py::class_<DataframeStreamReader, std::unique_ptr<DataframeStreamReader>>(
       mod, "DataframeStreamReader")
-      .def("next", [](DataframeStreamReader* self) -> py::object {
-        std::unique_ptr<arrow::Buffer> chunk = nullptr;
-        throw_on_error(self->GetNext(chunk));
-        auto chunk_ptr = chunk.release();
-        return py::memoryview::from_memory(
-            const_cast<uint8_t*>(chunk_ptr->data()), chunk_ptr->size(), true);
-      });
+      .def("next",
+           [](DataframeStreamReader* self) -> py::object {
+             std::unique_ptr<arrow::Buffer> chunk = nullptr;
+             Status status;
+             {
+               // allows the `next_async` running in an executor
+               py::gil_scoped_release release;
+               status = self->GetNext(chunk);
+             }
+             throw_on_error(status);
+             auto chunk_ptr = chunk.release();
+             return py::memoryview::from_memory(
+                 const_cast<uint8_t*>(chunk_ptr->data()), chunk_ptr->size(),
+                 true);
+           })
+      .def(
+          "set_prefetch",
+          [](DataframeStreamReader* self, size_t const depth) {
+            self->SetPrefetch(depth);
+          },
+          "depth"_a);
 
   // DataFrameStream
   py::class_<DataframeStream, std::shared_ptr<DataframeStream>, Object>(
       mod, "DataframeStream")
       .def(
           "open_reader",
-          [](DataframeStream* self,
-             Client& client) -> std::unique_ptr<DataframeStreamReader> {
+          [](DataframeStream* self, Client& client,
+             bool const broadcast,
+             int64_t const offset) -> std::unique_ptr<DataframeStreamReader> {
             std::unique_ptr<DataframeStreamReader> reader = nullptr;
-            throw_on_error(self->OpenReader(client, reader));
+            throw_on_error(
+                self->OpenReader(client, reader, broadcast, offset));
             return reader;
           },
-          "client"_a)
+          py::call_guard<py::gil_scoped_release>(),
+          "client"_a, "broadcast"_a = false, "offset"_a = -1)
       .def(
           "open_writer",
           [](DataframeStream* self,
@@ -160,7 +210,7 @@ void bind_stream(py::module& mod) {
             throw_on_error(self->OpenWriter(client, writer));
             return writer;
           },
-          "client"_a)
+          py::call_guard<py::gil_scoped_release>(), "client"_a)
       .def("__getitem__",
            [](DataframeStream* self, std::string const& key) {
              return self->GetParams().at(key);
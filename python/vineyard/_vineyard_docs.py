@@ -595,6 +595,69 @@ key is the instance id, and the second-level key is the cluster metadata fields.
     }
 ''')
 
+add_doc(
+    ClientBase.replicate, r'''
+.. method:: replicate(object_id: ObjectID, instances: List[int]) -> Dict[int, ObjectID]
+    :noindex:
+
+Replicate the object to the given instances, e.g., for the read-mostly
+objects that are accessed from every node. The replicas share the signature
+with the object, and getting the object on these instances returns the local
+replicas.
+
+Parameters:
+    object_id: ObjectID
+        The object to replicate.
+    instances: List[int]
+        The instances where the replicas will be placed.
+
+Returns:
+    The replica on every given instance.
+''')
+
+add_doc(
+    ClientBase.prefetch, r'''
+.. method:: prefetch(object_ids: List[ObjectID], instance: int = UnspecifiedInstanceID()) -> int
+    :noindex:
+
+Warm up the objects on the given instance (defaults to the connected one)
+ahead of the tasks that read them. The remote objects are replicated to the
+instance, and their blobs are staged in memory with the pages pre-faulted.
+
+Parameters:
+    object_ids: List[ObjectID]
+        The objects to prefetch.
+    instance: int
+        The instance to prefetch to.
+
+Returns:
+    The bytes that have been prefetched.
+''')
+
+add_doc(
+    ClientBase.locality, r'''
+.. method:: locality(object_id: ObjectID, sync_remote: bool = True) -> Dict[int, int]
+    :noindex:
+
+Get how many bytes of the object (e.g., the chunks of a global dataframe)
+live on each instance, aggregated from the metadata on the server side.
+The result can be used for locality-aware task placement.
+
+.. code:: python
+
+    >>> client.locality(global_tensor_id)
+    {
+        14: 4096,
+        15: 8192
+    }
+
+Parameters:
+    object_id: ObjectID
+        The object to inspect.
+    sync_remote: bool
+        Whether to sync the metadata from etcd first.
+''')
+
 add_doc(
     ClientBase.status, r'''
 The status the of connected vineyard server, returns a :class:`InstanceStatus`.
@@ -29,6 +29,7 @@ from dask.distributed import Client
 import vineyard
 from vineyard.data.dataframe import make_global_dataframe
 from vineyard.data.tensor import make_global_tensor
+from vineyard.data.utils import from_json, normalize_dtype
 
 
 def dask_array_builder(client, value, builder, **kw):
@@ -57,16 +58,23 @@ def dask_dataframe_builder(client, value, builder, **kw):
     return make_global_dataframe(client, blocks)
 
 
-def dask_array_resolver(obj, resolver, **kw):
-    def get_partition(obj_id):
-        client = vineyard.connect()
-        np_value = client.get(obj_id)
-        return da.from_array(np_value)
+def get_partition(obj_id):
+    # the partitions are zero-copy views over the blobs of the local vineyard
+    # instance, and stay on the worker as the results of futures.
+    client = vineyard.connect()
+    return client.get(obj_id)
+
+
+def get_empty_partition(obj_id):
+    client = vineyard.connect()
+    return client.get(obj_id).iloc[:0]
 
+
+def dask_array_resolver(obj, resolver, **kw):
     meta = obj.meta
     num = int(meta['partitions_-size'])
     dask_client = Client(kw['dask_scheduler'])
-    futures = []
+    arrays = []
     indices = []
     with_index = True
     for i in range(num):
@@ -79,13 +87,17 @@ def dask_array_resolver(obj, resolver, **kw):
         else:
             with_index = False
 
-        futures.append(
-            # we require the 1-on-1 alignment of vineyard instances and dask workers.
-            # vineyard_sockets maps vineyard instance_ids into ipc_sockets, while
-            # dask_workers maps vineyard instance_ids into names of dask workers.
-            dask_client.submit(get_partition, ts.meta.id, workers={kw['dask_workers'][instance_id]}))
+        # we require the 1-on-1 alignment of vineyard instances and dask workers.
+        # vineyard_sockets maps vineyard instance_ids into ipc_sockets, while
+        # dask_workers maps vineyard instance_ids into names of dask workers.
+        #
+        # only the object id is shipped to the worker, and the scheduler learns
+        # the location of the chunk from the future, rather than gathering it.
+        future = dask_client.submit(get_partition, ts.meta.id, workers={kw['dask_workers'][instance_id]})
+        shape = tuple(from_json(ts.meta['shape_']))
+        dtype = normalize_dtype(ts.meta['value_type_'], ts.meta.get('value_type_meta_', None))
+        arrays.append(da.from_delayed(dask.delayed(future), shape=shape, dtype=dtype))
 
-    arrays = dask_client.gather(futures)
     if with_index:
         indices = list(sorted(indices))
         nx = indices[-1][0] + 1
@@ -103,26 +115,25 @@ def dask_array_resolver(obj, resolver, **kw):
 
 
 def dask_dataframe_resolver(obj, resolver, **kw):
-    def get_partition(obj_id):
-        client = vineyard.connect()
-        df = client.get(obj_id)
-        return dd.from_pandas(df, npartitions=1)
-
     meta = obj.meta
     num = int(meta['partitions_-size'])
     dask_client = Client(kw['dask_scheduler'])
     futures = []
+    empty = None
     for i in range(num):
         df = meta.get_member('partitions_-%d' % i)
         instance_id = int(df.meta['instance_id'])
+        workers = {kw['dask_workers'][instance_id]}
+        if empty is None:
+            # only the schema is gathered
+            empty = dask_client.submit(get_empty_partition, df.meta.id, workers=workers)
         futures.append(
             # we require the 1-on-1 alignment of vineyard instances and dask workers.
             # vineyard_sockets maps vineyard instance_ids into ipc_sockets, while
             # dask_workers maps vineyard instance_ids into names of dask workers.
-            dask_client.submit(get_partition, df.meta.id, workers={kw['dask_workers'][instance_id]}))
+            dask_client.submit(get_partition, df.meta.id, workers=workers))
 
-    dfs = dask_client.gather(futures)
-    return dd.concat(dfs, axis=0)
+    return dd.from_delayed(futures, meta=empty.result())
 
 
 def register_dask_types(builder_ctx, resolver_ctx):
@@ -97,6 +97,7 @@ def test_dask_array_resolver(dask_cluster):
 
     gtensor = make_global_tensor(clients[0], chunks)
     darr = clients[0].get(gtensor.id, dask_scheduler=dask_scheduler, dask_workers=dask_workers)
+    assert darr.numblocks == (num, num)
     assert darr.sum().sum().compute() == 0
 
 
@@ -111,6 +112,7 @@ def test_dask_dataframe_resolver(dask_cluster):
 
     gdf = make_global_dataframe(clients[0], chunks)
     ddf = clients[0].get(gdf.id, dask_scheduler=dask_scheduler, dask_workers=dask_workers)
+    assert ddf.npartitions == len(clients)
     assert ddf.sum().sum().compute() == 60
 
 
@@ -0,0 +1,427 @@
+#! /usr/bin/env python
+# -*- coding: utf-8 -*-
+#
+# Copyright 2020-2021 Alibaba Group Holding Limited.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+
+'''An asyncio-native IPC client for vineyard.
+
+The client talks the JSON protocol on the UNIX domain socket of vineyardd
+without blocking the event loop. Requests are tagged with ``request_id`` and
+pipelined on a single connection, i.e., many coroutines can have requests in
+flight at the same time, the server answers them in order and the replies are
+dispatched to the awaiting coroutines.
+
+The file descriptors of the shared memory are received with ``recvmsg`` and
+mapped by the same :code:`MmapEntry` as the C++ client, blobs are exposed as
+zero-copy :code:`memoryview` objects.
+
+.. code:: python
+
+    import asyncio
+    from vineyard.core.aio import connect
+
+    async def main():
+        client = await connect('/var/run/vineyard.sock')
+        blobs = await client.get_blobs(ids)
+        ...
+        await client.close()
+
+    asyncio.run(main())
+
+Note that requests that wait on the server side (e.g., :meth:`get_name`
+with ``wait=True``) hold the pipeline until they are answered, as the server
+processes the requests of a connection one by one.
+'''
+
+import asyncio
+import json
+import os
+import socket
+import struct
+
+from .. import _C
+from ..version import __version__
+
+# the same as `kMaxFdsPerMessage` in `src/common/memory/fling.h`
+_MAX_FDS_PER_MESSAGE = 253
+
+# the length of messages is encoded as a native `size_t`
+_LENGTH = struct.Struct('N')
+
+_STATUS_EXCEPTIONS = {
+    1: 'InvalidException',
+    2: 'KeyErrorException',
+    3: 'TypeErrorException',
+    4: 'IOErrorException',
+    5: 'EndOfFileException',
+    6: 'NotImplementedException',
+    7: 'AssertionFailedException',
+    8: 'UserInputErrorException',
+    11: 'ObjectExistsException',
+    12: 'ObjectNotExistsException',
+    13: 'ObjectSealedException',
+    14: 'ObjectNotSealedException',
+    21: 'MetaTreeInvalidException',
+    22: 'MetaTreeTypeInvalidException',
+    23: 'MetaTreeTypeNotExistsException',
+    24: 'MetaTreeNameInvalidException',
+    25: 'MetaTreeNameNotExistsException',
+    26: 'MetaTreeLinkInvalidException',
+    27: 'MetaTreeSubtreeNotExistsException',
+    31: 'VineyardServerNotReadyException',
+    32: 'ArrowErrorException',
+    33: 'ConnectionFailedException',
+    34: 'ConnectionErrorException',
+    35: 'EtcdErrorException',
+    41: 'NotEnoughMemoryException',
+    42: 'StreamDrainedException',
+    43: 'StreamFailedException',
+    44: 'InvalidStreamStateException',
+}
+
+
+def _raise_on_error(reply, expected):
+    code = reply.get('code', 0)
+    if code != 0:
+        name = _STATUS_EXCEPTIONS.get(code, 'UnknownErrorException')
+        raise getattr(_C, name)(reply.get('message', ''))
+    if reply.get('type') != expected:
+        raise _C.InvalidException('Unexpected reply, expects %s: %s' % (expected, reply))
+    return reply
+
+
+def _object_id_to_string(object_id):
+    return 'o%016x' % int(object_id)
+
+
+def _has_shared_fd(payload):
+    return payload['data_size'] > 0 and payload['store_fd'] != -1 and 'device' not in payload
+
+
+class AsyncIPCClient:
+    '''The asyncio IPC client, use :func:`connect` to create and register a client.
+
+    The client is bound to the event loop where it is connected, and is not
+    thread-safe.
+    '''
+
+    def __init__(self, ipc_socket):
+        self._ipc_socket = ipc_socket
+        self._sock = None
+        self._loop = None
+        self._reader = None
+        self._write_lock = asyncio.Lock()
+        self._next_request_id = 0
+        self._pending = dict()
+        # server-side store fd -> MmapEntry
+        self._mmap_table = dict()
+        self._closed = False
+        self.instance_id = None
+        self.rpc_endpoint = None
+        self.version = None
+
+    @property
+    def ipc_socket(self):
+        return self._ipc_socket
+
+    @property
+    def connected(self):
+        return self._sock is not None and not self._closed
+
+    async def _connect(self):
+        self._loop = asyncio.get_running_loop()
+        sock = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+        sock.setblocking(False)
+        try:
+            await self._loop.sock_connect(sock, self._ipc_socket)
+        except OSError as e:
+            sock.close()
+            raise _C.ConnectionFailedException('Failed to connect to %s: %s' % (self._ipc_socket, e)) from e
+        self._sock = sock
+
+        # registers before the pipelining starts
+        try:
+            await self._send({'type': 'register_request', 'version': __version__})
+            reply = _raise_on_error(json.loads(await self._recv_frame()), 'register_reply')
+        except BaseException:
+            self._closed = True
+            sock.close()
+            raise
+        self.instance_id = reply['instance_id']
+        self.rpc_endpoint = reply.get('rpc_endpoint')
+        self.version = reply.get('version')
+        if not reply.get('pipelining', False):
+            await self.close()
+            raise _C.NotImplementedException('The vineyard server doesn\'t support pipelined requests')
+        self._reader = self._loop.create_task(self._read_replies())
+
+    async def close(self):
+        '''Close the connection, the pending requests fail with a
+        :class:`ConnectionErrorException`.
+
+        Buffers that have been returned by :meth:`get_blobs` and
+        :meth:`create_blob` stay valid until they are released.
+        '''
+        if self._closed:
+            return
+        self._closed = True
+        if self._reader is not None:
+            self._reader.cancel()
+            try:
+                await self._reader
+            except (asyncio.CancelledError, Exception):  # pylint: disable=broad-except
+                pass
+        if self._sock is not None:
+            try:
+                await self._send({'type': 'exit_request'})
+            except (OSError, _C.ConnectionErrorException):
+                pass
+            self._sock.close()
+        self._fail_pending(_C.ConnectionErrorException('The client has been closed'))
+        self._mmap_table.clear()
+
+    async def __aenter__(self):
+        return self
+
+    async def __aexit__(self, exc_type, exc, tb):
+        await self.close()
+
+    async def _send(self, request):
+        body = json.dumps(request).encode('utf-8')
+        async with self._write_lock:
+            await self._loop.sock_sendall(self._sock, _LENGTH.pack(len(body)) + body)
+
+    async def _recv_exactly(self, size):
+        # never reads beyond the frame, the fds are received with the byte that
+        # follows.
+        chunks, remaining = [], size
+        while remaining > 0:
+            chunk = await self._loop.sock_recv(self._sock, remaining)
+            if not chunk:
+                raise _C.ConnectionErrorException('The connection has been closed by the vineyard server')
+            chunks.append(chunk)
+            remaining -= len(chunk)
+        return b''.join(chunks)
+
+    async def _recv_frame(self):
+        size, = _LENGTH.unpack(await self._recv_exactly(_LENGTH.size))
+        return await self._recv_exactly(size)
+
+    async def _recv_fds(self, count):
+        fds = []
+        try:
+            while len(fds) < count:
+                try:
+                    _, ancdata, _, _ = self._sock.recvmsg(1, socket.CMSG_SPACE(4 * _MAX_FDS_PER_MESSAGE))
+                except (BlockingIOError, InterruptedError):
+                    readable = self._loop.create_future()
+                    self._loop.add_reader(self._sock.fileno(), readable.set_result, None)
+                    try:
+                        await readable
+                    finally:
+                        self._loop.remove_reader(self._sock.fileno())
+                    continue
+                received = []
+                for level, kind, data in ancdata:
+                    if level == socket.SOL_SOCKET and kind == socket.SCM_RIGHTS:
+                        received.extend(struct.unpack('%di' % (len(data) // 4), data[:len(data) - len(data) % 4]))
+                if not received:
+                    raise _C.IOErrorException('Failed to receive file descriptors from the socket')
+                fds.extend(received)
+        except BaseException:
+            for fd in fds:
+                os.close(fd)
+            raise
+        return fds
+
+    async def _receive_mmaps(self, payloads):
+        # the server sends the fds that are new to this connection, in the
+        # order of the payloads
+        pending = []
+        for payload in payloads:
+            store_fd = payload['store_fd']
+            if _has_shared_fd(payload) and store_fd not in self._mmap_table and store_fd not in pending:
+                pending.append(store_fd)
+        if not pending:
+            return
+        fds = await self._recv_fds(len(pending))
+        payloads = {payload['store_fd']: payload for payload in payloads}
+        for store_fd, fd in zip(pending, fds):
+            payload = payloads[store_fd]
+            # the entry takes the ownership of the fd
+            self._mmap_table[store_fd] = _C.MmapEntry(fd, payload['map_size'], payload.get('page_size', 0),
+                                                      readonly=False)
+
+    async def _read_replies(self):
+        try:
+            while True:
+                reply = json.loads(await self._recv_frame())
+                if reply.get('type') == 'get_buffers_reply' and reply.get('code', 0) == 0:
+                    await self._receive_mmaps([reply[str(i)] for i in range(reply['num'])])
+                elif reply.get('type') == 'create_buffer_reply' and reply.get('code', 0) == 0:
+                    await self._receive_mmaps([reply['created']])
+                request_id = reply.pop('request_id', None)
+                future = self._pending.pop(request_id, None)
+                if future is not None and not future.done():
+                    future.set_result(reply)
+        except asyncio.CancelledError:
+            raise
+        except Exception as e:  # pylint: disable=broad-except
+            self._fail_pending(e)
+
+    def _fail_pending(self, error):
+        pending, self._pending = self._pending, dict()
+        for future in pending.values():
+            if not future.done():
+                future.set_exception(error)
+
+    async def _request(self, request, expected):
+        if not self.connected or self._reader.done():
+            raise _C.ConnectionErrorException('The client is not connected to vineyard server')
+        request_id = self._next_request_id
+        self._next_request_id += 1
+        future = self._loop.create_future()
+        self._pending[request_id] = future
+        # the server expects the `request_id` to be the leading field
+        tagged = {'request_id': request_id}
+        tagged.update(request)
+        try:
+            # a half-written request would break the framing, hence the
+            # sending is not interrupted by cancellation.
+            await asyncio.shield(self._send(tagged))
+        except asyncio.CancelledError:
+            raise
+        except BaseException:
+            self._pending.pop(request_id, None)
+            raise
+        return _raise_on_error(await future, expected)
+
+    async def get_meta(self, object_id, sync_remote=False, wait=False):
+        '''Get the metadata of the object as a dict, the members are nested
+        dicts as well.
+        '''
+        reply = await self._request(
+            {
+                'type': 'get_data_request',
+                'id': [int(object_id)],
+                'sync_remote': sync_remote,
+                'wait': wait,
+            }, 'get_data_reply')
+        content = reply['content']
+        key = _object_id_to_string(object_id)
+        if key not in content:
+            raise _C.ObjectNotExistsException('Failed to get the metadata of %s' % key)
+        return content[key]
+
+    async def create_metadata(self, content, ttl=0):
+        '''Create the object from the metadata (a dict), returns the object id.'''
+        request = {'type': 'create_data_request', 'content': content}
+        if ttl > 0:
+            request['ttl'] = ttl
+        reply = await self._request(request, 'create_data_reply')
+        return _C.ObjectID(reply['id'])
+
+    async def exists(self, object_id):
+        reply = await self._request({'type': 'exists_request', 'id': int(object_id)}, 'exists_reply')
+        return reply.get('exists', False)
+
+    async def persist(self, object_id):
+        await self._request({'type': 'persist_request', 'id': int(object_id)}, 'persist_reply')
+
+    async def delete(self, object_ids, force=False, deep=True):
+        if not isinstance(object_ids, (list, tuple, set)):
+            object_ids = [object_ids]
+        await self._request(
+            {
+                'type': 'del_data_request',
+                'id': [int(object_id) for object_id in object_ids],
+                'force': force,
+                'deep': deep,
+                'fastpath': False,
+            }, 'del_data_reply')
+
+    async def put_name(self, object_id, name, ttl=0):
+        request = {'type': 'put_name_request', 'object_id': int(object_id), 'name': name}
+        if ttl > 0:
+            request['ttl'] = ttl
+        await self._request(request, 'put_name_reply')
+
+    async def get_name(self, name, wait=False):
+        reply = await self._request({'type': 'get_name_request', 'name': name, 'wait': wait}, 'get_name_reply')
+        return _C.ObjectID(reply['object_id'])
+
+    async def drop_name(self, name):
+        await self._request({'type': 'drop_name_request', 'name': name}, 'drop_name_reply')
+
+    def _view(self, payload, readonly):
+        if payload['data_size'] == 0:
+            return memoryview(b'')
+        if not _has_shared_fd(payload):
+            raise _C.NotImplementedException('Device blobs cannot be accessed by the asyncio client')
+        entry = self._mmap_table.get(payload['store_fd'])
+        if entry is None:
+            raise _C.IOErrorException('The fd of blob %s has not been received' %
+                                      _object_id_to_string(payload['object_id']))
+        # the memoryview keeps the mapping alive
+        return memoryview(entry.view(payload['data_offset'], payload['data_size'], readonly))
+
+    async def get_blobs(self, object_ids):
+        '''Get the blobs as a dict of object id -> readonly buffers, the buffers
+        are mapped from the shared memory without copying.
+        '''
+        object_ids = list(object_ids)
+        request = {'type': 'get_buffers_request', 'num': len(object_ids)}
+        for index, object_id in enumerate(object_ids):
+            request[str(index)] = int(object_id)
+        reply = await self._request(request, 'get_buffers_reply')
+        blobs = dict()
+        for index in range(reply['num']):
+            payload = reply[str(index)]
+            blobs[_C.ObjectID(payload['object_id'])] = self._view(payload, True)
+        return blobs
+
+    async def get_blob(self, object_id):
+        blobs = await self.get_blobs([object_id])
+        if _C.ObjectID(int(object_id)) not in blobs:
+            raise _C.ObjectNotExistsException('Failed to get the blob %s' % _object_id_to_string(object_id))
+        return blobs[_C.ObjectID(int(object_id))]
+
+    async def create_blob(self, size):
+        '''Create a blob and returns its id and the writable buffer, the blob
+        is usable once the buffer has been filled.
+        '''
+        reply = await self._request({'type': 'create_buffer_request', 'size': size}, 'create_buffer_reply')
+        return _C.ObjectID(reply['id']), self._view(reply['created'], False)
+
+
+async def connect(ipc_socket=None):
+    '''Connect to vineyard server and returns an :class:`AsyncIPCClient`.
+
+    Parameters:
+        ipc_socket: str
+            The UNIX domain socket of vineyardd, defaults to the environment
+            variable :code:`VINEYARD_IPC_SOCKET`.
+    '''
+    if ipc_socket is None:
+        ipc_socket = os.environ.get('VINEYARD_IPC_SOCKET', None)
+    if ipc_socket is None:
+        raise _C.ConnectionFailedException('Failed to resolve the IPC socket of vineyard server')
+    client = AsyncIPCClient(ipc_socket)
+    await client._connect()  # pylint: disable=protected-access
+    return client
+
+
+__all__ = ['AsyncIPCClient', 'connect']
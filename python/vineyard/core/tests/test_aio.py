@@ -0,0 +1,83 @@
+#! /usr/bin/env python
+# -*- coding: utf-8 -*-
+#
+# Copyright 2020-2021 Alibaba Group Holding Limited.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+
+import asyncio
+
+import numpy as np
+
+import pytest
+
+import vineyard
+from vineyard.core import default_builder_context, default_resolver_context
+from vineyard.core import aio
+from vineyard.data import register_builtin_types
+
+register_builtin_types(default_builder_context, default_resolver_context)
+
+
+def test_aio_metadata(vineyard_ipc_socket, vineyard_client):
+    object_ids = [vineyard_client.put(np.arange(i + 1)) for i in range(16)]
+
+    async def run():
+        async with await aio.connect(vineyard_ipc_socket) as client:
+            metas = await asyncio.gather(*[client.get_meta(object_id) for object_id in object_ids])
+            existences = await asyncio.gather(*[client.exists(object_id) for object_id in object_ids])
+            return metas, existences
+
+    metas, existences = asyncio.run(run())
+    assert all(existences)
+    for object_id, meta in zip(object_ids, metas):
+        assert meta['typename'] == vineyard_client.get_meta(object_id).typename
+
+
+def test_aio_names(vineyard_ipc_socket, vineyard_client):
+    object_id = vineyard_client.put(np.ones((4, 4)))
+
+    async def run():
+        async with await aio.connect(vineyard_ipc_socket) as client:
+            await client.persist(object_id)
+            await client.put_name(object_id, 'aio_test_names')
+            named = await client.get_name('aio_test_names')
+            await client.drop_name('aio_test_names')
+            with pytest.raises(vineyard.ObjectNotExistsException):
+                await client.get_name('aio_test_names')
+            return named
+
+    assert asyncio.run(run()) == object_id
+
+
+def test_aio_blobs(vineyard_ipc_socket, vineyard_client):
+    values = [np.random.rand(1024 * (i + 1)) for i in range(8)]
+    blob_ids = [vineyard_client.get_meta(vineyard_client.put(value))['buffer_'].id for value in values]
+
+    async def run():
+        async with await aio.connect(vineyard_ipc_socket) as client:
+            # the requests are pipelined on the same connection
+            blobs = await asyncio.gather(client.get_blobs(blob_ids[:4]), client.get_blobs(blob_ids[4:]),
+                                         client.get_blob(blob_ids[0]))
+            blob_id, buffer = await client.create_blob(1024)
+            buffer[:] = b'x' * 1024
+            assert bytes(memoryview(vineyard_client.get_object(blob_id))) == b'x' * 1024
+            return blobs
+
+    first, second, blob = asyncio.run(run())
+    # the buffers are still valid after the client has been closed
+    for value, blob_id_ in zip(values, blob_ids):
+        buffer = first[blob_id_] if blob_id_ in first else second[blob_id_]
+        np.testing.assert_array_equal(np.frombuffer(buffer, dtype=value.dtype), value)
+    assert bytes(blob) == values[0].tobytes()
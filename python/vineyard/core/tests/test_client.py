@@ -16,6 +16,10 @@
 # limitations under the License.
 #
 
+from concurrent.futures import ThreadPoolExecutor
+
+import numpy as np
+
 import pytest
 
 import vineyard
@@ -71,3 +75,15 @@ def test_persist_multiref(vineyard_client):
     meta.set_global(True)
     rmeta = vineyard_client.create_metadata(meta)
     vineyard_client.persist(rmeta)
+
+
+def test_concurrent_get(vineyard_client):
+    data = np.arange(1024 * 1024, dtype=np.int64)
+    object_id = vineyard_client.put(data)
+
+    def get(_):
+        return vineyard_client.get(object_id)
+
+    with ThreadPoolExecutor(8) as executor:
+        for value in executor.map(get, range(64)):
+            np.testing.assert_equal(data, value)
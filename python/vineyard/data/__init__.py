@@ -22,8 +22,10 @@ from . import dataframe
 from . import default
 from . import graph
 from . import index
+from . import packed
 from . import pickle
 from . import series
+from . import sorted_index
 from . import tensor
 
 from vineyard.core.builder import default_builder_context
@@ -35,6 +37,8 @@ from vineyard.data.tensor import register_tensor_types
 from vineyard.data.index import register_index_types
 from vineyard.data.series import register_series_types
 from vineyard.data.dataframe import register_dataframe_types
+from vineyard.data.sorted_index import register_sorted_index_types
+from vineyard.data.packed import register_packed_types
 from vineyard.data.graph import register_graph_types
 
 
@@ -46,6 +50,8 @@ def register_builtin_types(builder_ctx, resolver_ctx):
     register_index_types(builder_ctx, resolver_ctx)
     register_series_types(builder_ctx, resolver_ctx)
     register_dataframe_types(builder_ctx, resolver_ctx)
+    register_sorted_index_types(builder_ctx, resolver_ctx)
+    register_packed_types(builder_ctx, resolver_ctx)
     register_graph_types(builder_ctx, resolver_ctx)
 
 
@@ -20,15 +20,21 @@ import re
 import pyarrow as pa
 
 from vineyard._C import ObjectMeta
-from .utils import normalize_dtype
+from .utils import allocate_buffer, build_buffer, normalize_dtype
+
+
+def allocate_arrow_buffer(client, size):
+    ''' Allocate an arrow buffer on top of a vineyard blob builder, the buffer
+        will be sealed in place when being put into vineyard as a whole, see
+        also :meth:`vineyard.data.utils.allocate_buffer`.
+    '''
+    return pa.py_buffer(allocate_buffer(client, size))
 
 
 def buffer_builder(client, buffer, builder):
     if buffer is None:
         return client.create_empty_blob()
-    builder = client.create_blob(len(buffer))
-    builder.copy(0, buffer.address, len(buffer))
-    return builder.seal(client)
+    return build_buffer(client, buffer.address, len(buffer))
 
 
 def as_arrow_buffer(blob):
@@ -26,10 +26,36 @@ except:
 from pandas.core.internals.managers import BlockManager
 
 from vineyard._C import Object, ObjectID, ObjectMeta
-from .utils import from_json, to_json, normalize_dtype, expand_slice
+from .utils import allocate_numpy, from_json, to_json, normalize_dtype, expand_slice
 from .tensor import ndarray
 
 
+def allocate_dataframe(client, columns, length, index=None):
+    ''' Allocate a dataframe whose columns live in vineyard blob builders, the
+        columns can be filled in place and will be sealed without copy when the
+        dataframe is put into vineyard.
+
+        Parameters:
+            columns: dict
+                Mapping from column names to dtypes.
+            length: int
+                Number of rows.
+            index: optional
+                The index of the dataframe, defaults to a RangeIndex.
+    '''
+    blocks = []
+    for idx, dtype in enumerate(columns.values()):
+        if BlockPlacement:
+            placement = BlockPlacement(slice(idx, idx + 1, 1))
+        else:
+            placement = slice(idx, idx + 1, 1)
+        values = allocate_numpy(client, (1, length), dtype).view(ndarray)
+        blocks.append(Block(values, placement, ndim=2))
+    if index is None:
+        index = pd.RangeIndex(length)
+    return pd.DataFrame(BlockManager(blocks, [pd.Index(list(columns.keys())), index]))
+
+
 def pandas_dataframe_builder(client, value, builder, **kw):
     meta = ObjectMeta()
     meta['typename'] = 'vineyard::DataFrame'
@@ -22,26 +22,43 @@ if pickle.HIGHEST_PROTOCOL < 5:
     import pickle5 as pickle
 
 from vineyard._C import ObjectMeta
+from vineyard.data.utils import build_buffer, buffer_address
 
 
 def default_builder(client, value, **kwargs):
     ''' Default builder: pickle (version 5), then build a blob object for it.
+
+        The out-of-band buffers (e.g., the contents of numpy arrays and
+        tensors in a model state dict) are built as separate blobs without
+        going through the pickled bytes, and are passed back to `pickle.loads`
+        as zero-copy views on the blobs by the resolver.
     '''
-    payload = pickle.dumps(value, protocol=5)
+    buffers = []
+    payload = pickle.dumps(value, protocol=5, buffer_callback=buffers.append)
     buffer = client.create_blob(len(payload))
     buffer.copy(0, payload)
 
     meta = ObjectMeta(**kwargs)
     meta['typename'] = 'vineyard::PickleBuffer'
-    meta['nbytes'] = len(payload)
     meta['size_'] = len(payload)
     meta.add_member('buffer_', buffer.seal(client))
+    nbytes = len(payload)
+    for index, pickled in enumerate(buffers):
+        raw = pickled.raw()
+        meta.add_member('buffers_-%d' % index, build_buffer(client, buffer_address(raw), raw.nbytes))
+        nbytes += raw.nbytes
+    meta['buffers_-size'] = len(buffers)
+    meta['nbytes'] = nbytes
     return client.create_metadata(meta)
 
 
 def default_resolver(obj):
     view = memoryview(obj.member('buffer_'))[0:int(obj.meta['size_'])]
-    return pickle.loads(view, fix_imports=True)
+    buffers = []
+    if 'buffers_-size' in obj.meta:
+        for index in range(int(obj.meta['buffers_-size'])):
+            buffers.append(memoryview(obj.member('buffers_-%d' % index)))
+    return pickle.loads(view, fix_imports=True, buffers=buffers)
 
 
 def register_default_types(builder_ctx=None, resolver_ctx=None):
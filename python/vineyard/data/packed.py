@@ -0,0 +1,107 @@
+#! /usr/bin/env python
+# -*- coding: utf-8 -*-
+#
+# Copyright 2020-2021 Alibaba Group Holding Limited.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+
+''' Many small values packed into a single blob, sharing the layout with the
+    C++ `vineyard::PackedValues`, see also "basic/ds/packed.h".
+'''
+
+from collections.abc import Sequence
+
+import numpy as np
+
+import pickle
+
+if pickle.HIGHEST_PROTOCOL < 5:
+    import pickle5 as pickle
+
+from vineyard._C import ObjectMeta
+
+
+class PackedValues(Sequence):
+    ''' A read-only sequence of the packed values, the values are bytes unless
+        they have been pickled when building.
+    '''
+    def __init__(self, offsets, values, pickled):
+        self._offsets = offsets
+        self._values = values
+        self._pickled = pickled
+
+    def __len__(self):
+        return len(self._offsets) - 1
+
+    def __getitem__(self, index):
+        if isinstance(index, slice):
+            return [self[i] for i in range(*index.indices(len(self)))]
+        if index < 0:
+            index += len(self)
+        if index < 0 or index >= len(self):
+            raise IndexError('index out of range')
+        value = self._values[self._offsets[index]:self._offsets[index + 1]]
+        if self._pickled:
+            return pickle.loads(value)
+        return value.tobytes()
+
+    def get(self, indices):
+        ''' The values at the given indices, in batch.
+        '''
+        return [self[index] for index in indices]
+
+
+def build_packed_values(client, values):
+    ''' Pack the values into a single blob, bytes-like values are kept as they
+        are, otherwise all values are pickled.
+    '''
+    pickled = not all(isinstance(value, (bytes, bytearray, memoryview)) for value in values)
+    if pickled:
+        payloads = [pickle.dumps(value, protocol=5) for value in values]
+    else:
+        payloads = [bytes(value) for value in values]
+    offsets = np.zeros(len(payloads) + 1, dtype=np.int64)
+    offsets[1:] = np.cumsum([len(payload) for payload in payloads], dtype=np.int64)
+    table = offsets.tobytes()
+
+    buffer = client.create_blob(len(table) + int(offsets[-1]))
+    buffer.copy(0, table)
+    if len(payloads) > 0 and offsets[-1] > 0:
+        buffer.copy(len(table), b''.join(payloads))
+
+    meta = ObjectMeta()
+    meta['typename'] = 'vineyard::PackedValues'
+    meta['size_'] = len(payloads)
+    if pickled:
+        meta['serialization_'] = 'pickle'
+    meta.add_member('buffer_', buffer.seal(client))
+    meta['nbytes'] = len(table) + int(offsets[-1])
+    return client.create_metadata(meta)
+
+
+def packed_values_resolver(obj):
+    meta = obj.meta
+    size = int(meta['size_'])
+    view = memoryview(obj.member('buffer_'))
+    offsets = np.frombuffer(view, dtype=np.int64, count=size + 1)
+    values = view[(size + 1) * offsets.itemsize:]
+    return PackedValues(offsets, values, meta.get('serialization_', None) == 'pickle')
+
+
+def register_packed_types(builder_ctx, resolver_ctx):
+    if resolver_ctx is not None:
+        resolver_ctx.register('vineyard::PackedValues', packed_values_resolver)
+
+
+__all__ = ['PackedValues', 'build_packed_values']
@@ -110,11 +110,12 @@ class PickledWriter:
     '''
     def __init__(self, store_size=-1):
         if store_size > 0:
-            # optimization: reserve space for incoming contents
-            self._buffer = BytesIO(initial_bytes=b'\x00' * store_size)
+            # optimization: reserve space for incoming contents, and write the
+            # blocks in place rather than through a `BytesIO`.
+            self._buffer = bytearray(store_size)
         else:
-            self._buffer = BytesIO()
-        self._buffer.seek(0)
+            self._buffer = bytearray()
+        self._offset = 0
         self._value = None
 
     @property
@@ -122,10 +123,14 @@ class PickledWriter:
         return self._value
 
     def write(self, bs):
-        self._buffer.write(bs)
+        nlen = len(bs)
+        if self._offset + nlen > len(self._buffer):
+            self._buffer.extend(b'\x00' * (self._offset + nlen - len(self._buffer)))
+        memoryview(self._buffer)[self._offset:self._offset + nlen] = bs
+        self._offset += nlen
 
     def close(self):
-        bs = self._buffer.getbuffer()
+        bs = memoryview(self._buffer)[0:self._offset]
         buffers = []
         buffer_sizes = []
         try:
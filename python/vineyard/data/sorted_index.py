@@ -0,0 +1,159 @@
+#! /usr/bin/env python
+# -*- coding: utf-8 -*-
+#
+# Copyright 2020-2021 Alibaba Group Holding Limited.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+
+''' Sorted index over a key column of vineyard dataframes, sharing the layout
+    with the C++ `vineyard::SortedIndex`, see also "basic/ds/sorted_index.h".
+'''
+
+import numpy as np
+
+from vineyard._C import ObjectMeta
+
+from .utils import build_numpy_buffer, from_json, to_json
+
+# numpy dtype -> (typename argument, value_type_)
+_key_types = {
+    'int32': ('int', 'int32'),
+    'uint32': ('uint', 'uint32'),
+    'int64': ('int64', 'int64'),
+    'uint64': ('uint64', 'uint64'),
+    'float32': ('float', 'float'),
+    'float64': ('double', 'double'),
+}
+
+_value_types = {value_type: np.dtype(name) for name, (_, value_type) in _key_types.items()}
+
+DEFAULT_FANOUT = 64
+
+
+class SortedIndex:
+    ''' The sorted keys and the row ids in the key order, all the lookups are
+        vectorized over the zero-copy views on the blobs.
+    '''
+    def __init__(self, keys, rows, key_column, dataframe):
+        self._keys = keys
+        self._rows = rows
+        self._key_column = key_column
+        self._dataframe = dataframe
+
+    @property
+    def keys(self):
+        return self._keys
+
+    @property
+    def rows(self):
+        return self._rows
+
+    @property
+    def key_column(self):
+        return self._key_column
+
+    @property
+    def dataframe(self):
+        ''' The object id of the indexed dataframe.
+        '''
+        return self._dataframe
+
+    def __len__(self):
+        return len(self._keys)
+
+    def lookup(self, keys):
+        ''' The (first) row of each key, -1 for the keys that are not found.
+        '''
+        keys = np.asarray(keys, dtype=self._keys.dtype)
+        rows = np.full(keys.shape, -1, dtype=np.int64)
+        if len(self._keys) == 0:
+            return rows
+        positions = np.minimum(np.searchsorted(self._keys, keys, side='left'), len(self._keys) - 1)
+        found = self._keys[positions] == keys
+        rows[found] = self._rows[positions[found]]
+        return rows
+
+    def range_positions(self, lowers, uppers):
+        ''' The positions `[begins, ends)` in the key order of the keys in
+            `[lowers, uppers)`, in batch.
+        '''
+        begins = np.searchsorted(self._keys, np.asarray(lowers, dtype=self._keys.dtype), side='left')
+        ends = np.searchsorted(self._keys, np.asarray(uppers, dtype=self._keys.dtype), side='left')
+        return begins, np.maximum(begins, ends)
+
+    def range_scan(self, lower, upper):
+        ''' The rows whose keys are in `[lower, upper)`, in the key order.
+        '''
+        begins, ends = self.range_positions([lower], [upper])
+        return self._rows[begins[0]:ends[0]]
+
+
+def _fence_levels(keys, fanout):
+    levels, below = [], keys
+    while len(below) > fanout:
+        below = below[::fanout]
+        levels.append(below)
+    if levels:
+        return np.concatenate(levels)
+    return keys[0:0]
+
+
+def build_sorted_index(client, dataframe, key_column, fanout=DEFAULT_FANOUT):
+    ''' Build the sorted index over the key column of the given dataframe (an
+        object id or the metadata of a `vineyard::DataFrame`).
+    '''
+    meta = client.get_meta(dataframe) if not isinstance(dataframe, ObjectMeta) else dataframe
+    for index in range(int(meta['__values_-size'])):
+        if from_json(meta['__values_-key-%d' % index]) == key_column:
+            column = client.get(meta['__values_-value-%d' % index].id)
+            break
+    else:
+        raise ValueError('The key column %s does not exist in the dataframe' % key_column)
+    column = np.asarray(column)
+    if column.dtype.name not in _key_types:
+        raise ValueError('Unsupported type of key column: %s' % column.dtype)
+    typename, value_type = _key_types[column.dtype.name]
+
+    rows = np.argsort(column, kind='stable').astype(np.int64)
+    keys = np.ascontiguousarray(column[rows])
+
+    index = ObjectMeta()
+    index['typename'] = 'vineyard::SortedIndex<%s>' % typename
+    index['length_'] = len(keys)
+    index['fanout_'] = fanout
+    index['value_type_'] = value_type
+    index['key_column_'] = to_json(key_column)
+    index.add_member('keys_', build_numpy_buffer(client, keys))
+    index.add_member('rows_', build_numpy_buffer(client, rows))
+    index.add_member('fences_', build_numpy_buffer(client, _fence_levels(keys, fanout)))
+    index.add_member('dataframe_', meta.id)
+    index['nbytes'] = keys.nbytes + rows.nbytes
+    return client.create_metadata(index)
+
+
+def sorted_index_resolver(obj):
+    meta = obj.meta
+    dtype = _value_types[meta['value_type_']]
+    length = int(meta['length_'])
+    keys = np.frombuffer(memoryview(obj.member('keys_')), dtype=dtype)[0:length]
+    rows = np.frombuffer(memoryview(obj.member('rows_')), dtype=np.int64)[0:length]
+    return SortedIndex(keys, rows, from_json(meta['key_column_']), meta.get_member('dataframe_').id)
+
+
+def register_sorted_index_types(builder_ctx, resolver_ctx):
+    if resolver_ctx is not None:
+        resolver_ctx.register('vineyard::SortedIndex', sorted_index_resolver)
+
+
+__all__ = ['SortedIndex', 'build_sorted_index']
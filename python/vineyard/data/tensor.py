@@ -25,6 +25,7 @@ except ImportError:
     sp = None
 
 import pickle
+import re
 
 if pickle.HIGHEST_PROTOCOL < 5:
     import pickle5 as pickle
@@ -55,7 +56,13 @@ def numpy_ndarray_builder(client, value, **kw):
     meta['partition_index_'] = to_json(kw.get('partition_index', []))
     meta['nbytes'] = value.nbytes
     meta['order_'] = to_json(('C' if value.flags['C_CONTIGUOUS'] else 'F'))
-    meta.add_member('buffer_', build_numpy_buffer(client, value))
+    if value.dtype.name != 'object' and value.size > 0 and not value.flags['C_CONTIGUOUS'] \
+            and value.flags['F_CONTIGUOUS']:
+        # keep the Fortran layout as is, and resolve it as a strided view without copy
+        meta['strides_'] = to_json(value.strides)
+        meta.add_member('buffer_', build_numpy_buffer(client, value.T))
+    else:
+        meta.add_member('buffer_', build_numpy_buffer(client, value))
     return client.create_metadata(meta)
 
 
@@ -74,12 +81,115 @@ def numpy_ndarray_resolver(obj):
         order = 'C'
     if np.prod(shape) == 0:
         return np.zeros(shape, dtype=value_type)
+    if 'strides_' in meta:
+        # views over the blob of another tensor, see also `numpy_ndarray_view`.
+        array = np.ndarray(shape,
+                           dtype=value_type,
+                           buffer=memoryview(obj.member('buffer_')),
+                           offset=int(meta.get('offset_', 0)),
+                           strides=from_json(meta['strides_']))
+        return array.view(ndarray)
     c_array = np.frombuffer(memoryview(obj.member('buffer_')), dtype=value_type).reshape(shape)
     # TODO: revise the memory copy of asfortranarray
     array = (c_array if order == 'C' else np.asfortranarray(c_array))
     return array.view(ndarray)
 
 
+def numpy_ndarray_view(client, tensor, key):
+    '''Create a view of the tensor with numpy's basic indexing (integers and
+    slices with positive steps), the view shares the blob with the tensor and
+    no data will be copied.
+
+    The resolved view is a strided numpy array over the shared memory, and
+    can be passed to :code:`torch.from_numpy` or :code:`pyarrow.Tensor` without
+    copy as well.
+    '''
+    if isinstance(tensor, ObjectID):
+        tensor = client.get_meta(tensor)
+    elif isinstance(tensor, Object):
+        tensor = tensor.meta
+    if not tensor.typename.startswith('vineyard::Tensor') or tensor['value_type_'] == 'object':
+        raise ValueError('Cannot create views on %s' % tensor.typename)
+    if not isinstance(key, tuple):
+        key = (key, )
+
+    shape = from_json(tensor['shape_'])
+    if len(key) > len(shape):
+        raise IndexError('Too many indices for the tensor')
+    itemsize = np.dtype(normalize_dtype(tensor['value_type_'], tensor.get('value_type_meta_', None))).itemsize
+    if 'strides_' in tensor:
+        strides = from_json(tensor['strides_'])
+    else:
+        strides = [itemsize] * len(shape)
+        for axis in range(len(shape) - 1, 0, -1):
+            strides[axis - 1] = strides[axis] * shape[axis]
+    offset = int(tensor.get('offset_', 0))
+
+    key = key + (slice(None), ) * (len(shape) - len(key))
+    view_shape, view_strides = [], []
+    for index, dim, stride in zip(key, shape, strides):
+        if isinstance(index, slice):
+            start, stop, step = index.indices(dim)
+            if step <= 0:
+                raise IndexError('Only positive steps are supported in views')
+            view_shape.append(len(range(start, stop, step)))
+            view_strides.append(stride * step)
+            offset += start * stride
+        else:
+            index = int(index)
+            if index < 0:
+                index += dim
+            if index < 0 or index >= dim:
+                raise IndexError('Index %d is out of bounds for size %d' % (index, dim))
+            offset += index * stride
+
+    meta = ObjectMeta()
+    meta['typename'] = tensor.typename
+    meta['value_type_'] = tensor['value_type_']
+    if 'value_type_meta_' in tensor:
+        meta['value_type_meta_'] = tensor['value_type_meta_']
+    meta['shape_'] = to_json(view_shape)
+    meta['partition_index_'] = tensor['partition_index_']
+    meta['offset_'] = offset
+    meta['strides_'] = to_json(view_strides)
+    meta['nbytes'] = int(np.prod(view_shape)) * itemsize
+    meta.add_member('buffer_', tensor.get_member('buffer_'))
+    return client.create_metadata(meta)
+
+
+def tensor_to_dlpack(obj):
+    '''Export a :code:`Tensor` (including views) or :code:`NumericArray` object
+    as a DLPack capsule over the shared memory without copy, e.g., for
+    :code:`torch.utils.dlpack.from_dlpack`.
+
+    The blob keeps alive until the consumer releases the DLPack tensor. DLPack
+    has no notion of read-only memory, the consumers mustn't write into
+    sealed blobs.
+    '''
+    meta = obj.meta
+    typename = obj.typename
+    if typename.startswith('vineyard::Tensor'):
+        value_type = np.dtype(normalize_dtype(meta['value_type_'], meta.get('value_type_meta_', None)))
+        shape = from_json(meta['shape_'])
+        if 'strides_' in meta:
+            strides = from_json(meta['strides_'])
+        else:
+            strides = [value_type.itemsize] * len(shape)
+            for axis in range(len(shape) - 1, 0, -1):
+                strides[axis - 1] = strides[axis] * shape[axis]
+        offset = int(meta.get('offset_', 0))
+    elif typename.startswith('vineyard::NumericArray'):
+        if int(meta['null_count_']) != 0:
+            raise ValueError('Cannot export arrays with nulls as DLPack')
+        value_type = np.dtype(normalize_dtype(re.match(r'vineyard::NumericArray<([^>]+)>', typename).groups()[0]))
+        shape = [int(meta['length_'])]
+        strides = [value_type.itemsize]
+        offset = int(meta['offset_']) * value_type.itemsize
+    else:
+        raise TypeError('Cannot export %s as DLPack' % typename)
+    return obj.member('buffer_').dlpack(value_type.str, shape, strides, offset)
+
+
 def bsr_matrix_builder(client, value, builder, **kw):
     meta = ObjectMeta()
     meta['typename'] = 'vineyard::BSRMatrix<%s>' % value.dtype.name
@@ -23,10 +23,21 @@ import pytest
 import vineyard
 from vineyard.core import default_builder_context, default_resolver_context
 from vineyard.data import register_builtin_types
+from vineyard.data.arrow import allocate_arrow_buffer
 
 register_builtin_types(default_builder_context, default_resolver_context)
 
 
+def test_allocated_arrow_array(vineyard_client):
+    buffer = allocate_arrow_buffer(vineyard_client, 8 * 1024)
+    np.frombuffer(buffer, dtype='int64')[:] = np.arange(1024)
+    arr = pa.Array.from_buffers(pa.int64(), 1024, [None, buffer])
+    object_id = vineyard_client.put(arr)
+    value = vineyard_client.get(object_id)
+    assert arr.equals(value)
+    assert value.buffers()[1].address == buffer.address
+
+
 def test_arrow_array(vineyard_client):
     arr = pa.array([1, 2, None, 3])
     object_id = vineyard_client.put(arr)
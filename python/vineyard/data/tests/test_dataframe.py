@@ -23,6 +23,7 @@ import numpy as np
 import vineyard
 from vineyard.core import default_builder_context, default_resolver_context
 from vineyard.data import register_builtin_types
+from vineyard.data.dataframe import allocate_dataframe
 
 register_builtin_types(default_builder_context, default_resolver_context)
 
@@ -109,3 +110,14 @@ def test_dataframe_reusing(vineyard_client):
     assert ob is not None
     assert ob2 is not None
     assert ob.id == ob2.id
+
+
+def test_allocated_dataframe(vineyard_client):
+    df = allocate_dataframe(vineyard_client, {'x': 'int64', 'y': 'float64'}, 1000)
+    df['x'].values[:] = np.arange(1000)
+    df['y'].values[:] = np.random.rand(1000)
+    address, _ = df['x'].values.__array_interface__['data']
+    object_id = vineyard_client.put(df)
+    value = vineyard_client.get(object_id)
+    pd.testing.assert_frame_equal(df, value)
+    assert value['x'].values.__array_interface__['data'][0] == address
@@ -56,3 +56,21 @@ def test_dict(vineyard_client):
     value = {1: 2, 3: 4, 5: None, None: 6}
     object_id = vineyard_client.put(value)
     assert vineyard_client.get(object_id) == value
+
+
+def test_out_of_band_buffers(vineyard_client):
+    value = {
+        'weight': np.random.rand(1024, 256),
+        'bias': np.random.rand(256),
+        'empty': np.zeros((0, 4)),
+        'step': 10,
+    }
+    object_id = vineyard_client.put(value)
+    meta = vineyard_client.get_meta(object_id)
+    assert meta['typename'] == 'vineyard::PickleBuffer'
+    assert int(meta['buffers_-size']) == 3
+    target = vineyard_client.get(object_id)
+    assert target.keys() == value.keys()
+    for key in ['weight', 'bias', 'empty']:
+        np.testing.assert_array_equal(target[key], value[key])
+    assert target['step'] == value['step']
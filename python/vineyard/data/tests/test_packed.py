@@ -0,0 +1,46 @@
+#! /usr/bin/env python
+# -*- coding: utf-8 -*-
+#
+# Copyright 2020-2021 Alibaba Group Holding Limited.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+
+from vineyard.core import default_builder_context, default_resolver_context
+from vineyard.data import register_builtin_types
+from vineyard.data.packed import build_packed_values
+
+register_builtin_types(default_builder_context, default_resolver_context)
+
+
+def test_packed_bytes(vineyard_client):
+    values = [('key-%d' % i).encode() for i in range(10000)] + [b'']
+    packed = vineyard_client.get(build_packed_values(vineyard_client, values).id)
+    assert len(packed) == len(values)
+    assert packed[42] == b'key-42'
+    assert packed[-1] == b''
+    assert packed.get([9999, 0]) == [b'key-9999', b'key-0']
+    assert list(packed) == values
+
+
+def test_packed_objects(vineyard_client):
+    values = [{'a': 1}, (1, 2.5), 'config', None]
+    packed = vineyard_client.get(build_packed_values(vineyard_client, values).id)
+    assert list(packed) == values
+    assert packed[1:3] == values[1:3]
+
+
+def test_empty_packed_values(vineyard_client):
+    packed = vineyard_client.get(build_packed_values(vineyard_client, []).id)
+    assert len(packed) == 0
+    assert list(packed) == []
@@ -0,0 +1,57 @@
+#! /usr/bin/env python
+# -*- coding: utf-8 -*-
+#
+# Copyright 2020-2021 Alibaba Group Holding Limited.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+
+import pandas as pd
+import numpy as np
+
+from vineyard.core import default_builder_context, default_resolver_context
+from vineyard.data import register_builtin_types
+from vineyard.data.sorted_index import build_sorted_index
+
+register_builtin_types(default_builder_context, default_resolver_context)
+
+
+def test_sorted_index(vineyard_client):
+    keys = np.random.randint(0, 1000, size=10000)
+    df = pd.DataFrame({'key': keys, 'value': np.arange(10000) * 0.5})
+    df_id = vineyard_client.put(df)
+
+    index_id = build_sorted_index(vineyard_client, df_id, 'key', fanout=16).id
+    index = vineyard_client.get(index_id)
+    assert len(index) == len(keys)
+    assert index.key_column == 'key'
+    assert index.dataframe == df_id
+    assert (np.diff(index.keys) >= 0).all()
+
+    queries = np.array([-1, 0, 7, 500, 999, 1000])
+    rows = index.lookup(queries)
+    for query, row in zip(queries, rows):
+        matches = np.flatnonzero(keys == query)
+        assert row == (matches[0] if len(matches) > 0 else -1)
+
+    for lower, upper in [(0, 10), (100, 101), (-5, 3), (700, 2000), (9, 2)]:
+        rows = np.sort(index.range_scan(lower, upper))
+        np.testing.assert_array_equal(rows, np.flatnonzero((keys >= lower) & (keys < upper)))
+
+
+def test_empty_sorted_index(vineyard_client):
+    df_id = vineyard_client.put(pd.DataFrame({'key': np.array([], dtype='int64')}))
+    index = vineyard_client.get(build_sorted_index(vineyard_client, df_id, 'key').id)
+    assert len(index) == 0
+    assert (index.lookup([1, 2]) == -1).all()
+    assert len(index.range_scan(0, 10)) == 0
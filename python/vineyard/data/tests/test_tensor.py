@@ -30,6 +30,8 @@ import pytest
 import vineyard
 from vineyard.core import default_builder_context, default_resolver_context
 from vineyard.data import register_builtin_types
+from vineyard.data.tensor import numpy_ndarray_view, tensor_to_dlpack
+from vineyard.data.utils import allocate_numpy
 
 register_builtin_types(default_builder_context, default_resolver_context)
 
@@ -40,6 +42,36 @@ def test_numpy_ndarray(vineyard_client):
     np.testing.assert_allclose(arr, vineyard_client.get(object_id))
 
 
+def test_ndarray_view(vineyard_client):
+    arr = np.random.rand(8, 6, 4)
+    object_id = vineyard_client.put(arr)
+
+    view_id = numpy_ndarray_view(vineyard_client, object_id, (slice(2, 6), slice(None, None, 2)))
+    view = vineyard_client.get(view_id)
+    assert not view.flags['C_CONTIGUOUS']
+    np.testing.assert_allclose(arr[2:6, ::2], view)
+
+    # views of views
+    view_id = numpy_ndarray_view(vineyard_client, view_id, (1, slice(1, 3), -1))
+    np.testing.assert_allclose(arr[2:6, ::2][1, 1:3, -1], vineyard_client.get(view_id))
+
+    with pytest.raises(IndexError):
+        numpy_ndarray_view(vineyard_client, object_id, slice(None, None, -1))
+
+
+def test_ndarray_dlpack(vineyard_client):
+    torch = pytest.importorskip('torch')
+
+    arr = np.random.rand(8, 6)
+    object_id = vineyard_client.put(arr)
+    tensor = torch.utils.dlpack.from_dlpack(tensor_to_dlpack(vineyard_client.get_object(object_id)))
+    np.testing.assert_allclose(arr, tensor.numpy())
+
+    view_id = numpy_ndarray_view(vineyard_client, object_id, (slice(1, 7, 3), slice(2, 4)))
+    tensor = torch.utils.dlpack.from_dlpack(tensor_to_dlpack(vineyard_client.get_object(view_id)))
+    np.testing.assert_allclose(arr[1:7:3, 2:4], tensor.numpy())
+
+
 def test_empty_ndarray(vineyard_client):
     arr = np.ones(())
     object_id = vineyard_client.put(arr)
@@ -96,6 +128,7 @@ def test_tensor_order(vineyard_client):
     res = vineyard_client.get(object_id)
     assert res.flags['C_CONTIGUOUS'] == arr.flags['C_CONTIGUOUS']
     assert res.flags['F_CONTIGUOUS'] == arr.flags['F_CONTIGUOUS']
+    np.testing.assert_equal(arr, res)
 
 
 @pytest.mark.skipif(sp is None, reason="scipy.sparse is not available")
@@ -131,3 +164,14 @@ def test_dia_matrix(vineyard_client):
     arr = sp.sparse.dia_matrix((3, 4), dtype=np.int8)
     object_id = vineyard_client.put(arr)
     np.testing.assert_allclose(arr.A, vineyard_client.get(object_id).A)
+
+
+def test_allocated_ndarray(vineyard_client):
+    arr = allocate_numpy(vineyard_client, (4, 5, 6), 'float64')
+    arr[:] = np.random.rand(4, 5, 6)
+    address, _ = arr.__array_interface__['data']
+    object_id = vineyard_client.put(arr)
+    value = vineyard_client.get(object_id)
+    np.testing.assert_allclose(arr, value)
+    # sealed in place, without copy
+    assert value.__array_interface__['data'][0] == address
@@ -18,6 +18,7 @@
 
 import json
 import platform
+import threading
 
 import numpy as np
 
@@ -73,9 +74,62 @@ def normalize_cpptype(dtype):
     return dtype.name
 
 
+# address -> the unsealed blob builders created by `allocate_buffer`
+_allocated_blobs = dict()
+_allocated_blobs_lock = threading.Lock()
+
+
+def allocate_buffer(client, size):
+    ''' Allocate a blob builder of the given size from vineyard and return a
+        writable memoryview on top of it, numpy arrays and arrow buffers can
+        be created on the memoryview without copy.
+
+        When the whole buffer is put into vineyard later (e.g., as the
+        buffer of a tensor or an arrow array), the blob builder will be sealed
+        in place rather than being copied to another new blob, the contents
+        shouldn't be mutated after that.
+    '''
+    buffer = client.create_blob(size)
+    with _allocated_blobs_lock:
+        _allocated_blobs[buffer.address] = buffer
+    return memoryview(buffer)
+
+
+def allocate_numpy(client, shape, dtype):
+    ''' Allocate a C-contiguous numpy array on top of a blob builder, see also
+        :meth:`allocate_buffer`.
+    '''
+    dtype = np.dtype(dtype)
+    if dtype.name == 'object':
+        raise ValueError('Cannot allocate arrays of python objects')
+    size = int(np.prod(shape)) * dtype.itemsize
+    if size == 0:
+        return np.zeros(shape, dtype=dtype)
+    return np.frombuffer(allocate_buffer(client, size), dtype=dtype).reshape(shape)
+
+
+def buffer_address(buffer):
+    ''' The address of a contiguous bytes-like object (e.g., the raw view of
+        a `pickle.PickleBuffer`), which can be passed to :meth:`build_buffer`.
+    '''
+    if len(buffer) == 0:
+        return 0
+    address, _ = np.frombuffer(buffer, dtype=np.uint8).__array_interface__['data']
+    return address
+
+
 def build_buffer(client, address, size):
     if size == 0:
         return client.create_empty_blob()
+    with _allocated_blobs_lock:
+        buffer = _allocated_blobs.get(address, None)
+        if buffer is not None and buffer.size == size:
+            del _allocated_blobs[address]
+        else:
+            buffer = None
+    if buffer is not None:
+        # allocated by `allocate_buffer`, seal in place
+        return buffer.seal(client)
     buffer = client.create_blob(size)
     buffer.copy(0, address, size)
     return buffer.seal(client)
@@ -116,5 +170,6 @@ def expand_slice(indexer):
 
 
 __all__ = [
-    'normalize_dtype', 'normalize_cpptype', 'build_buffer', 'build_numpy_buffer', 'to_json', 'from_json', 'expand_slice'
+    'normalize_dtype', 'normalize_cpptype', 'allocate_buffer', 'allocate_numpy', 'build_buffer', 'build_numpy_buffer',
+    'to_json', 'from_json', 'expand_slice'
 ]
@@ -563,3 +563,25 @@ def test_concurrent_meta_sync(vineyard_ipc_sockets):
         r, message = rs.get(block=True)
         if not r:
             pytest.fail(message)
+
+
+def test_run_kernel_on_global_tensor(vineyard_ipc_sockets):
+    from vineyard.launcher.kernel import run_kernel
+
+    clients = generate_vineyard_ipc_clients(vineyard_ipc_sockets, 4)
+
+    chunks = [np.arange(i * 25, (i + 1) * 25, dtype='double') for i in range(4)]
+    meta = vineyard.ObjectMeta()
+    meta['typename'] = 'vineyard::GlobalTensor'
+    meta.set_global(True)
+    for index, (client, chunk) in enumerate(zip(clients, chunks)):
+        object_id = client.put(chunk)
+        client.persist(object_id)
+        meta.add_member('partitions_-%d' % index, object_id)
+    meta['partitions_-size'] = len(chunks)
+    tensor = clients[0].create_metadata(meta)
+    clients[0].persist(tensor)
+
+    assert run_kernel(clients[0], tensor.id, 'sum') == np.sum(np.concatenate(chunks))
+    assert run_kernel(clients[0], tensor.id, 'count') == 100
+    assert sorted(run_kernel(clients[0], tensor.id, 'numpy:max', reducer=list)) == [24, 49, 74, 99]
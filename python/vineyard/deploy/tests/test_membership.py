@@ -0,0 +1,102 @@
+#! /usr/bin/env python
+# -*- coding: utf-8 -*-
+#
+# Copyright 2020-2021 Alibaba Group Holding Limited.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+
+import contextlib
+import os
+import re
+import subprocess
+import tempfile
+import time
+
+import pytest
+
+import vineyard
+from vineyard.deploy.etcd import start_etcd
+from vineyard.deploy.utils import check_socket, find_port, find_vineyardd_path
+
+GOSSIP_INTERVAL = 200  # milliseconds
+
+
+@contextlib.contextmanager
+def start_gossip_vineyardd(etcd_endpoints, etcd_prefix, log_path):
+    ipc_socket = tempfile.mktemp(prefix='vineyard-', suffix='.sock')
+    rpc_socket_port = find_port()
+    env = os.environ.copy()
+    env['GLOG_logtostderr'] = '1'
+    with open(log_path, 'w') as log:
+        proc = subprocess.Popen([
+            find_vineyardd_path(),
+            '--size', '64Mi',
+            '--socket', ipc_socket,
+            '--rpc_socket_port', str(rpc_socket_port),
+            '--etcd_endpoint', etcd_endpoints,
+            '--etcd_prefix', etcd_prefix,
+            '--membership=gossip',
+            '--gossip_interval=%d' % GOSSIP_INTERVAL,
+        ], env=env, stdout=log, stderr=log)
+    try:
+        while not (check_socket(ipc_socket) and check_socket(('0.0.0.0', rpc_socket_port))):
+            assert proc.poll() is None, 'vineyardd exited unexpectedly'
+            time.sleep(0.5)
+        yield proc, ipc_socket
+    finally:
+        if proc.poll() is None:
+            proc.terminate()
+            proc.wait()
+
+
+def registered(client, instance_id):
+    # the meta of the removed instance may leave as an empty entry
+    return bool(client.meta.get(instance_id, {}).get('rpc_endpoint'))
+
+
+def wait_for(predicate, timeout=60):
+    start = time.time()
+    while not predicate():
+        assert time.time() - start < timeout
+        time.sleep(0.5)
+
+
+@pytest.mark.skipif(find_vineyardd_path() is None, reason='vineyardd is not available')
+def test_gossip_membership_failure():
+    instance_size = 3
+    with start_etcd() as (_, etcd_endpoints), tempfile.TemporaryDirectory() as log_dir:
+        etcd_prefix = 'vineyard_test_membership_%s' % time.time()
+        logs = [os.path.join(log_dir, 'vineyardd.%d.log' % idx) for idx in range(instance_size)]
+        with contextlib.ExitStack() as stack:
+            instances = [stack.enter_context(start_gossip_vineyardd(etcd_endpoints, etcd_prefix, log)) for log in logs]
+            clients = [vineyard.connect(ipc_socket) for _, ipc_socket in instances]
+            wait_for(lambda: all(registered(client, peer.instance_id) for client in clients for peer in clients))
+
+            victim, victim_id = instances[0][0], clients[0].instance_id
+            survivors = clients[1:]
+            victim.kill()
+            victim.wait()
+
+            # declared as dead by the survivors, and the registration is removed
+            wait_for(lambda: all(not registered(client, victim_id) for client in survivors))
+            # the cleanup happens once, by the successor of the dead instance only
+            time.sleep(GOSSIP_INTERVAL * 10 / 1000)
+
+            removals = 0
+            for log in logs[1:]:
+                with open(log, 'r') as f:
+                    content = f.read()
+                assert 'Instance %d timeout' % victim_id in content
+                removals += len(re.findall(r'Removing the failed instance %d\b' % victim_id, content))
+            assert removals == 1
@@ -19,19 +19,79 @@
 import itertools
 import json
 import logging
+import os
+import re
+import shutil
+import subprocess
+import tempfile
+import time
 
 import pytest
 import numpy as np
+import pandas as pd
 
 import vineyard
 from vineyard.core import default_builder_context, default_resolver_context
 from vineyard.data import register_builtin_types
+from vineyard.deploy.utils import find_port, find_vineyardd_path
 
 register_builtin_types(default_builder_context, default_resolver_context)
 
 logger = logging.getLogger('vineyard')
 
 
+def find_vineyard_copy_path():
+    vineyard_copy = shutil.which('vineyard-copy')
+    if vineyard_copy is None and find_vineyardd_path() is not None:
+        vineyard_copy = os.path.join(os.path.dirname(find_vineyardd_path()), 'vineyard-copy')
+        if not os.access(vineyard_copy, os.X_OK):
+            vineyard_copy = None
+    return vineyard_copy
+
+
+def push_objects(client1, client2, objects, *args):
+    ''' Push the objects from client1's instance to client2's by the
+        migration protocol of `vineyard-copy`, returns the received objects
+        and the (megabytes, megabytes on the wire) reported by the server.
+    '''
+    vineyard_copy = find_vineyard_copy_path()
+    port = find_port()
+    instance_map = json.dumps({'i%x' % client1.instance_id: client2.instance_id})
+    common_args = [
+        '--instance_map', instance_map,
+        '--migration_port', str(port),
+    ] + list(args)
+    server = subprocess.Popen([vineyard_copy, '--ipc_socket', client2.ipc_socket] + common_args,
+                              stdout=subprocess.PIPE, stderr=subprocess.STDOUT, universal_newlines=True)
+    try:
+        # the client fails before sending anything if the server is not listening yet
+        for _ in range(30):
+            client = subprocess.run([
+                vineyard_copy, '--ipc_socket', client1.ipc_socket,
+                '--object_list', ','.join(repr(o) for o in objects),
+            ] + common_args, stdout=subprocess.PIPE, stderr=subprocess.STDOUT, universal_newlines=True)
+            if client.returncode == 0:
+                break
+            assert server.poll() is None, 'the migration server exited unexpectedly'
+            time.sleep(1)
+        assert client.returncode == 0, client.stdout
+        output, _ = server.communicate(timeout=120)
+    finally:
+        if server.poll() is None:
+            server.kill()
+            server.wait()
+    assert server.returncode == 0, output
+
+    received = dict()
+    for source, target in re.findall(r'Build target local object (\d+), id: (\d+)', output):
+        received[vineyard.ObjectID(int(source))] = vineyard.ObjectID(int(target))
+    number = r'([-+.\deE]+)'
+    throughput = re.search(r'Migration received (\d+) blobs \(%s MB, %s MB on the wire\)' % (number, number),
+                           output)
+    assert throughput is not None, output
+    return received, int(throughput.group(1)), float(throughput.group(2)), float(throughput.group(3))
+
+
 @pytest.mark.skip_without_migration()
 def test_migration(vineyard_ipc_sockets):
     vineyard_ipc_sockets = list(itertools.islice(itertools.cycle(vineyard_ipc_sockets), 2))
@@ -58,6 +118,196 @@ def test_migration(vineyard_ipc_sockets):
     logger.info('------- finish migrate remote --------')
 
 
+@pytest.mark.skip_without_migration()
+def test_migration_large_object(vineyard_ipc_sockets):
+    vineyard_ipc_sockets = list(itertools.islice(itertools.cycle(vineyard_ipc_sockets), 2))
+
+    client1 = vineyard.connect(vineyard_ipc_sockets[0])
+    client2 = vineyard.connect(vineyard_ipc_sockets[1])
+
+    # the columns are blobs of their own, the large ones are striped across
+    # the rpc streams when fetched, and the empty one has no payload at all.
+    data = pd.DataFrame({
+        'a': np.arange(4 * 1024 * 1024, dtype=np.int64),
+        'b': np.random.rand(4 * 1024 * 1024),
+        'c': np.zeros(4 * 1024 * 1024, dtype=np.int32),
+    })
+    o = client1.put(data)
+    client1.persist(o)
+    empty = client1.put(np.empty((0,), dtype=np.float64))
+    client1.persist(empty)
+
+    o1 = client2.migrate(o)
+    assert o1 != o
+    meta = client2.get_meta(o1)
+    assert meta.instance_id == client2.instance_id
+    pd.testing.assert_frame_equal(client2.get(o1), data)
+
+    empty1 = client2.migrate(empty)
+    assert empty1 != empty
+    assert client2.get(empty1).shape == (0,)
+    logger.info('------- finish migrate large object --------')
+
+
+@pytest.mark.skip_without_migration()
+@pytest.mark.skipif(find_vineyard_copy_path() is None, reason='vineyard-copy is not available')
+@pytest.mark.parametrize('connections', [1, 3, 16])
+def test_push_over_concurrent_connections(vineyard_ipc_sockets, connections):
+    vineyard_ipc_sockets = list(itertools.islice(itertools.cycle(vineyard_ipc_sockets), 2))
+
+    client1 = vineyard.connect(vineyard_ipc_sockets[0])
+    client2 = vineyard.connect(vineyard_ipc_sockets[1])
+
+    # blobs of various sizes, balanced over the connections, and more
+    # connections than blobs leaves some of them without any blob.
+    arrays = [np.random.rand(size) for size in [1, 1000, 1024 * 1024, 3 * 1024 * 1024 + 7]]
+    objects = [client1.put(array) for array in arrays]
+    for o in objects:
+        client1.persist(o)
+
+    received, blobs, mbytes, _ = push_objects(client1, client2, objects,
+                                              '--migration_connections', str(connections))
+    assert blobs == len(arrays)
+    assert mbytes == pytest.approx(sum(array.nbytes for array in arrays) / (1024 * 1024), rel=1e-3)
+    assert set(received.keys()) == set(objects)
+    for o, array in zip(objects, arrays):
+        assert received[o] != o
+        assert client2.get_meta(received[o]).instance_id == client2.instance_id
+        np.testing.assert_array_equal(client2.get(received[o]), array)
+    logger.info('------- finish push over %d connections --------' % connections)
+
+
+@pytest.mark.skip_without_migration()
+@pytest.mark.skipif(find_vineyard_copy_path() is None, reason='vineyard-copy is not available')
+@pytest.mark.parametrize('compression', ['none', 'lz4', 'zstd', 'unknown'])
+def test_push_with_compression(vineyard_ipc_sockets, compression):
+    vineyard_ipc_sockets = list(itertools.islice(itertools.cycle(vineyard_ipc_sockets), 2))
+
+    client1 = vineyard.connect(vineyard_ipc_sockets[0])
+    client2 = vineyard.connect(vineyard_ipc_sockets[1])
+
+    # the zeros are compressed, while the random floats don't compress well
+    # and the tiny blob is too small to bother, both are sent raw.
+    arrays = [
+        np.zeros(1024 * 1024, dtype=np.int64),
+        np.random.rand(1024 * 1024),
+        np.arange(16, dtype=np.int32),
+    ]
+    objects = [client1.put(array) for array in arrays]
+    for o in objects:
+        client1.persist(o)
+
+    received, blobs, mbytes, wire_mbytes = push_objects(client1, client2, objects,
+                                                        '--migration_compression', compression)
+    assert blobs == len(arrays)
+    if compression in ['lz4', 'zstd']:
+        assert wire_mbytes < mbytes
+        assert wire_mbytes >= arrays[1].nbytes / (1024 * 1024)
+    else:
+        # the unknown codec is declined by the server, falling back to raw
+        assert wire_mbytes == mbytes
+    for o, array in zip(objects, arrays):
+        np.testing.assert_array_equal(client2.get(received[o]), array)
+    logger.info('------- finish push with compression %s --------' % compression)
+
+
+def pull_objects(client, source_endpoint, *args):
+    ''' Pull the objects from the source instance into client's instance
+        by the parallel copy of `vineyard-copy`, returns the copied objects.
+    '''
+    proc = subprocess.run([
+        find_vineyard_copy_path(),
+        '--ipc_socket', client.ipc_socket,
+        '--source_endpoint', source_endpoint,
+    ] + list(args), stdout=subprocess.PIPE, stderr=subprocess.PIPE, universal_newlines=True)
+    assert proc.returncode == 0, proc.stderr
+    copied = dict()
+    for line in proc.stdout.splitlines():
+        source, target = line.split()
+        copied[vineyard.ObjectID(source)] = vineyard.ObjectID(target)
+    return copied
+
+
+@pytest.mark.skip_without_migration()
+@pytest.mark.skipif(find_vineyard_copy_path() is None, reason='vineyard-copy is not available')
+def test_parallel_pull(vineyard_ipc_sockets):
+    vineyard_ipc_sockets = list(itertools.islice(itertools.cycle(vineyard_ipc_sockets), 2))
+
+    client1 = vineyard.connect(vineyard_ipc_sockets[0])
+    client2 = vineyard.connect(vineyard_ipc_sockets[1])
+
+    prefix = 'parallel_pull_%s_' % time.time()
+    named = dict()
+    for index in range(6):
+        data = np.random.rand(index * 256 * 1024 + 1)
+        o = client1.put(data)
+        client1.persist(o)
+        client1.put_name(o, '%s%d' % (prefix, index))
+        named[o] = data
+    # the members of dataframe are copied as a part of it
+    dataframe = pd.DataFrame({'a': np.arange(1024 * 1024), 'b': np.random.rand(1024 * 1024)})
+    o = client1.put(dataframe)
+    client1.persist(o)
+    client1.put_name(o, '%sdataframe' % prefix)
+    named[o] = dataframe
+    # not matched by the prefix
+    unnamed = client1.put(np.ones(10))
+    client1.persist(unnamed)
+
+    with tempfile.TemporaryDirectory() as directory:
+        manifest = os.path.join(directory, 'manifest')
+        args = [
+            '--copy_name_prefix', prefix,
+            '--copy_parallelism', '3',
+            '--copy_chunk_size', str(64 * 1024),
+            '--copy_manifest', manifest,
+        ]
+        copied = pull_objects(client2, client1.rpc_endpoint, *args)
+        assert set(copied.keys()) == set(named.keys())
+        for o, data in named.items():
+            assert client2.get_meta(copied[o]).instance_id == client2.instance_id
+            if isinstance(data, pd.DataFrame):
+                pd.testing.assert_frame_equal(client2.get(copied[o]), data)
+            else:
+                np.testing.assert_array_equal(client2.get(copied[o]), data)
+        # the names follow the copies
+        assert client2.get_name('%s0' % prefix) == copied[list(named.keys())[0]]
+
+        # rerunning with the manifest copies nothing again
+        with open(manifest, 'r') as f:
+            assert len(f.readlines()) == len(named)
+        assert pull_objects(client2, client1.rpc_endpoint, *args) == copied
+        with open(manifest, 'r') as f:
+            assert len(f.readlines()) == len(named)
+    logger.info('------- finish parallel pull --------')
+
+
+@pytest.mark.skip_without_migration()
+def test_replication(vineyard_ipc_sockets):
+    vineyard_ipc_sockets = list(itertools.islice(itertools.cycle(vineyard_ipc_sockets), 2))
+
+    client1 = vineyard.connect(vineyard_ipc_sockets[0])
+    client2 = vineyard.connect(vineyard_ipc_sockets[1])
+
+    data = np.ones((1, 2, 3, 4, 5))
+    o = client1.put(data)
+    client1.persist(o)
+
+    replicas = client1.replicate(o, [client1.instance_id, client2.instance_id])
+    assert replicas[client1.instance_id] == o
+    assert replicas[client2.instance_id] != o
+    logger.info('------- finish replicate --------')
+
+    # the remote object is resolved to the local replica
+    meta = client2.get_meta(o, sync_remote=True)
+    assert meta.id == replicas[client2.instance_id]
+    assert meta.instance_id == client2.instance_id
+    np.testing.assert_allclose(client2.get(o), data)
+
+    # replicate again: do nothing
+    assert client1.replicate(o, [client2.instance_id]) == {client2.instance_id: replicas[client2.instance_id]}
+    logger.info('------- finish resolve replica --------')
+
 @pytest.mark.skip_without_migration()
 def test_migration_and_deletion(vineyard_ipc_sockets):
     vineyard_ipc_sockets = list(itertools.islice(itertools.cycle(vineyard_ipc_sockets), 2))
@@ -135,3 +385,54 @@ def test_migration_and_deletion(vineyard_ipc_sockets):
 
     with pytest.raises(vineyard.ObjectNotExistsException):
         print(client2.get_meta(o2))
+
+
+@pytest.mark.skip_without_migration()
+def test_migrate_objects(vineyard_ipc_sockets):
+    vineyard_ipc_sockets = list(itertools.islice(itertools.cycle(vineyard_ipc_sockets), 4))
+
+    clients = [vineyard.connect(ipc_socket) for ipc_socket in vineyard_ipc_sockets]
+    targets = [clients[2].instance_id, clients[3].instance_id]
+
+    # objects of different sizes from two instances, spread over another two
+    data, placement = dict(), dict()
+    for index in range(8):
+        value = np.random.rand(1024 * (index + 1) ** 2)
+        o = clients[index % 2].put(value)
+        clients[index % 2].persist(o)
+        data[o] = value
+        placement[o] = targets[index % 2]
+
+    # the objects already on the target, or having a replica there, are not
+    # transferred
+    local = clients[2].put(np.arange(1024))
+    clients[2].persist(local)
+    placement[local] = targets[0]
+    replicated = clients[0].put(np.arange(2048))
+    clients[0].persist(replicated)
+    replicas = clients[0].replicate(replicated, [targets[1]])
+    placement[replicated] = targets[1]
+
+    results = clients[0].migrate_objects(placement, parallelism=3, parallelism_per_instance=1)
+    assert set(results.keys()) == set(placement.keys())
+    assert results[local] == local
+    assert results[replicated] == replicas[targets[1]]
+
+    for o, value in data.items():
+        target = clients[2 + targets.index(placement[o])]
+        assert results[o] != o
+        meta = target.get_meta(results[o], sync_remote=True)
+        assert meta.instance_id == placement[o]
+        # persisted in a batch per target instance
+        assert target.get_object(results[o]).ispersist
+        np.testing.assert_allclose(target.get(results[o]), value)
+    logger.info('------- finish migrate objects --------')
+
+    # the migrated objects are already in place: do nothing
+    migrated = {results[o]: placement[o] for o in data}
+    assert clients[1].migrate_objects(migrated) == {o: o for o in migrated}
+
+    with pytest.raises(vineyard.InvalidException):
+        clients[0].migrate_objects({local: 0xFFFFFFFF})
+    with pytest.raises(vineyard.AssertionFailedException):
+        clients[0].migrate_objects(placement, parallelism=0)
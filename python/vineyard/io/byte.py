@@ -55,7 +55,27 @@
     ----> 1 chunk = reader.next()
 
     StreamDrainedException: Stream drained: no more chunks
+
+    # or, await the chunks in a coroutine, with the next chunks being pulled
+    # in background
+    >>> reader.set_prefetch(2)
+    >>> chunk = await reader.next_async()
 '''
 
+import asyncio
+import functools
+
 from vineyard._C import ByteStream, ByteStreamBuilder, \
     ByteStreamReader, ByteStreamWriter
+
+
+async def _next_async(self, *args, **kwargs):
+    ''' The awaitable version of :code:`next()`, the blocking request runs in
+        the default executor of the event loop.
+    '''
+    loop = asyncio.get_event_loop()
+    return await loop.run_in_executor(None, functools.partial(self.next, *args, **kwargs))
+
+
+setattr(ByteStreamReader, 'next_async', _next_async)
+setattr(ByteStreamWriter, 'next_async', _next_async)
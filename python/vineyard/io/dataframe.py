@@ -59,3 +59,9 @@
 
 from vineyard._C import DataframeStream, DataframeStreamBuilder, \
     DataframeStreamReader, DataframeStreamWriter
+
+from .byte import _next_async
+
+
+setattr(DataframeStreamReader, 'next_async', _next_async)
+setattr(DataframeStreamWriter, 'next_async', _next_async)
@@ -0,0 +1,178 @@
+#! /usr/bin/env python
+# -*- coding: utf-8 -*-
+#
+# Copyright 2020-2021 Alibaba Group Holding Limited.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+
+''' Run kernels over the local chunks of global objects (e.g.,
+:code:`GlobalTensor` and :code:`GlobalDataFrame`) on every vineyard instance
+in parallel, and reduce the per-chunk results on the caller, i.e., move the
+compute to the data rather than fetching every chunk to the caller.
+
+.. code:: python
+
+    >>> from vineyard.launcher.kernel import run_kernel
+    >>> run_kernel(client, global_tensor_id, 'sum')
+    4950.0
+
+A kernel is a function that accepts the resolved value of a chunk, and is
+referred by a registered name (see :code:`register_kernel`) or by
+:code:`"module:function"`, which must be importable on every host.
+'''
+
+import base64
+import importlib
+import json
+import logging
+import pickle
+import sys
+from concurrent.futures import ThreadPoolExecutor
+
+import numpy as np
+
+from vineyard._C import connect, ObjectID, IPCClient
+
+from .script import ScriptLauncher
+
+logger = logging.getLogger('vineyard')
+
+_kernels = dict()
+
+
+def register_kernel(name, kernel, reducer=None):
+    ''' Register a kernel, and the default reducer which accepts the list of
+        per-chunk results.
+
+        Note that the kernel must be registered in the processes launched on
+        every instance as well, i.e., when the defining module is being
+        imported.
+    '''
+    _kernels[name] = (kernel, reducer)
+
+
+def resolve_kernel(kernel):
+    if kernel in _kernels:
+        return _kernels[kernel]
+    if ':' not in kernel:
+        raise ValueError('Unknown kernel: %s' % kernel)
+    module, name = kernel.split(':', 1)
+    func = importlib.import_module(module)
+    for attr in name.split('.'):
+        func = getattr(func, attr)
+    return func, None
+
+
+def _kernel_spec(kernel):
+    if isinstance(kernel, str):
+        return kernel
+    module = getattr(kernel, '__module__', None)
+    if not module or module == '__main__':
+        raise ValueError('The kernel must be importable on every instance: %r' % kernel)
+    return '%s:%s' % (module, kernel.__qualname__)
+
+
+def _chunks(meta):
+    ''' The chunks of global objects, i.e., the members :code:`partitions_-N`.
+    '''
+    return [meta.get_member('partitions_-%d' % i) for i in range(int(meta['partitions_-size']))]
+
+
+def _run_on_local_chunks(client, object_id, kernel, parallelism=None):
+    meta = client.get_meta(object_id, True)
+    chunks = [chunk.id for chunk in _chunks(meta) if chunk.meta.instance_id == client.instance_id]
+    func, _ = resolve_kernel(kernel)
+    with ThreadPoolExecutor(max_workers=parallelism) as executor:
+        return list(executor.map(lambda chunk: func(client.get(chunk)), chunks))
+
+
+def run_kernel(client, object_id, kernel, reducer=None, parallelism=None, timeout=None):
+    ''' Run the kernel over the chunks of the global object on the instances
+        where the chunks live, in parallel, and reduce the results.
+
+        Parameters:
+            client: IPCClient or RPCClient
+                The connected vineyard client, :code:`ClusterInfo` of which
+                decides where to run the kernel.
+            object_id: ObjectID
+                The global object, e.g., :code:`GlobalTensor`.
+            kernel: str or callable
+                The name of the registered kernel, or an importable function.
+            reducer: callable
+                Reduce the list of per-chunk results, defaults to the reducer
+                of the registered kernel, and returns the list when is None.
+            parallelism: int
+                The number of chunks to be processed concurrently on each
+                instance.
+    '''
+    spec = _kernel_spec(kernel)
+    if isinstance(client, IPCClient):
+        meta = client.get_meta(object_id, True)
+    else:
+        meta = client.get_meta(object_id)
+    instances = sorted(set(chunk.meta.instance_id for chunk in _chunks(meta)))
+    cluster = client.meta
+
+    launchers = []
+    try:
+        for instance_id in instances:
+            instance = cluster[instance_id]
+            launcher = ScriptLauncher(sys.executable, host=instance['hostname'])
+            launcher.run('-m', 'vineyard.launcher.kernel', instance['ipc_socket'], repr(object_id), spec,
+                         str(parallelism or 0))
+            launchers.append(launcher)
+        results = []
+        for launcher in launchers:
+            results.extend(pickle.loads(base64.b64decode(launcher.wait(timeout=timeout))))
+            launcher.join()
+    finally:
+        for launcher in launchers:
+            launcher.dispose(desired=False)
+
+    if reducer is None and spec in _kernels:
+        reducer = _kernels[spec][1]
+    if reducer is None:
+        return results
+    return reducer(results)
+
+
+register_kernel('sum', np.sum, np.sum)
+register_kernel('count', np.size, np.sum)
+register_kernel('min', np.min, np.min)
+register_kernel('max', np.max, np.max)
+register_kernel('nbytes', lambda value: value.nbytes, np.sum)
+
+
+def main():
+    if len(sys.argv) < 4:
+        print('usage: python -m vineyard.launcher.kernel <ipc_socket> <object_id> <kernel> [<parallelism>]',
+              file=sys.stderr)
+        sys.exit(1)
+    ipc_socket, object_id, kernel = sys.argv[1:4]
+    parallelism = int(sys.argv[4]) if len(sys.argv) > 4 else 0
+    client = connect(ipc_socket)
+    try:
+        results = _run_on_local_chunks(client, ObjectID(object_id), kernel, parallelism or None)
+    except Exception as e:  # pylint: disable=broad-except
+        logger.exception('Failed to run kernel %s', kernel)
+        print(json.dumps({'error': str(e)}), flush=True)
+        sys.exit(1)
+    print(json.dumps({'return': base64.b64encode(pickle.dumps(results)).decode('ascii')}), flush=True)
+
+
+if __name__ == '__main__':
+    main()
+
+
+__all__ = ['register_kernel', 'run_kernel']
@@ -19,10 +19,12 @@
 import json
 import logging
 import os
+import socket
 import subprocess
 import sys
 import threading
 
+from ..deploy.utils import ssh_base_cmd
 from .launcher import Launcher, LauncherStatus
 
 logger = logging.getLogger('vineyard')
@@ -32,10 +34,14 @@ class ScriptLauncher(Launcher):
     ''' Launch the job by executing a script.
 
         The output of script must be printed to stdout, rather than stderr.
+
+        When :code:`host` is given (and is not the local host) the script will be
+        executed on that host through ssh.
     '''
-    def __init__(self, script):
+    def __init__(self, script, host=None):
         super(ScriptLauncher, self).__init__()
         self._script = script
+        self._host = host
         self._proc = None
         self._listen_out_thrd = None
         self._listen_err_thrd = None
@@ -77,6 +83,8 @@ class ScriptLauncher(Launcher):
                     cmd.append(repr(value))
             else:
                 env[key] = value
+        if self._host and self._host not in ['localhost', '127.0.0.1', socket.gethostname()]:
+            cmd = ssh_base_cmd(self._host) + cmd
         logger.debug('command = %s', ' '.join(cmd))
         self._cmd = cmd
         self._proc = subprocess.Popen(cmd,
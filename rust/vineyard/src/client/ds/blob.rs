@@ -25,12 +25,13 @@ use super::payload::Payload;
 use super::status::*;
 use super::uuid::*;
 use super::IPCClient;
+use super::SharedBuffer;
 
 #[derive(Debug)]
 pub struct Blob {
     id: ObjectID,
     size: usize,
-    buffer: Option<Rc<arrow::Buffer>>,
+    buffer: Option<Rc<SharedBuffer>>,
 }
 
 impl Default for Blob {
@@ -38,12 +39,20 @@ impl Default for Blob {
         Blob {
             id: invalid_object_id(),
             size: usize::MAX,
-            buffer: None as Option<Rc<arrow::Buffer>>,
+            buffer: None as Option<Rc<SharedBuffer>>,
         }
     }
 }
 
 impl Blob {
+    pub fn new(id: ObjectID, size: usize, buffer: Option<Rc<SharedBuffer>>) -> Blob {
+        Blob { id, size, buffer }
+    }
+
+    pub fn id(&self) -> ObjectID {
+        self.id
+    }
+
     pub fn size(&self) -> usize {
         self.allocated_size()
     }
@@ -52,7 +61,8 @@ impl Blob {
         self.size
     }
 
-    pub fn data(&self) -> io::Result<String> {
+    // The bytes of the blob, as a view over the shared memory.
+    pub fn data(&self) -> io::Result<&[u8]> {
         if self.size > 0 {
             match &self.buffer {
                 None => panic!(
@@ -71,12 +81,31 @@ impl Blob {
                 }
             }
         }
-        //Ok(self.buffer.data())
-        // Question: buffer.data() as_ptr()
-        panic!()
+        match &self.buffer {
+            None => Ok(&[]),
+            Some(buf) => Ok(buf.as_slice()),
+        }
+    }
+
+    // A view over the bytes in [begin, end) of the blob without copying.
+    pub fn slice(&self, begin: usize, end: usize) -> io::Result<&[u8]> {
+        let data = self.data()?;
+        if begin > end || end > data.len() {
+            return Err(io::Error::new(
+                io::ErrorKind::InvalidInput,
+                format!(
+                    "Slice [{}, {}) is out of the range of blob {} with size {}",
+                    begin,
+                    end,
+                    object_id_to_string(self.id),
+                    self.size
+                ),
+            ));
+        }
+        Ok(&data[begin..end])
     }
 
-    pub fn buffer(&self) -> io::Result<Rc<arrow::Buffer>> {
+    pub fn buffer(&self) -> io::Result<Rc<SharedBuffer>> {
         if self.size > 0 {
             match &self.buffer {
                 None => panic!(
@@ -107,11 +136,20 @@ impl Blob {
 pub struct BlobWriter {
     object_id: ObjectID,
     payload: Payload,
-    buffer: Option<Rc<arrow::MutableBuffer>>,
+    buffer: Option<Rc<SharedBuffer>>,
     metadata: HashMap<String, String>,
 }
 
 impl BlobWriter {
+    pub fn new(object_id: ObjectID, payload: Payload, buffer: Rc<SharedBuffer>) -> BlobWriter {
+        BlobWriter {
+            object_id,
+            payload,
+            buffer: Some(buffer),
+            metadata: HashMap::new(),
+        }
+    }
+
     pub fn id(&self) -> ObjectID {
         self.object_id
     }
@@ -123,12 +161,15 @@ impl BlobWriter {
         }
     }
 
-    pub fn data(&self) -> char {
-        0 as char
-        //TODO. Question
+    // The writable bytes of the blob, written in place in the shared memory.
+    pub fn data(&mut self) -> &mut [u8] {
+        match &self.buffer {
+            None => &mut [],
+            Some(buf) => unsafe { buf.as_mut_slice() },
+        }
     }
 
-    pub fn buffer(&self) -> Rc<arrow::MutableBuffer> {
+    pub fn buffer(&self) -> Rc<SharedBuffer> {
         Rc::clone(&self.buffer.as_ref().unwrap())
     }
 
@@ -19,6 +19,7 @@ pub mod object_meta;
 
 pub use super::client::Client;
 pub use super::ipc_client::IPCClient;
+pub use super::mmap::SharedBuffer;
 pub use super::rpc_client::RPCClient;
 
 pub use crate::common::memory::payload;
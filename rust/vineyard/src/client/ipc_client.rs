@@ -1,4 +1,5 @@
 use std::cell::{RefCell, RefMut};
+use std::collections::{HashMap, HashSet};
 /** Copyright 2020-2021 Alibaba Group Holding Limited.
 
 Licensed under the Apache License, Version 2.0 (the "License");
@@ -24,7 +25,9 @@ use arrow::buffer as arrow;
 use super::client::Client;
 use super::client::ConnInputKind::{self, IPCConnInput};
 use super::client::StreamKind::{self, IPCStream};
+use super::mmap::{MmapEntry, SharedBuffer};
 use super::rust_io::*;
+use super::Blob;
 use super::BlobWriter;
 use super::ObjectMeta;
 
@@ -45,6 +48,10 @@ pub struct IPCClient {
     instance_id: InstanceID,
     server_version: String,
     stream: Option<RefCell<StreamKind>>,
+    // server fd -> the segment mapped from it
+    mmap_table: HashMap<i32, Rc<MmapEntry>>,
+    // server fd -> client fd, received but not mapped yet
+    received_fds: HashMap<i32, i32>,
 }
 
 impl Default for IPCClient {
@@ -57,27 +64,143 @@ impl Default for IPCClient {
             instance_id: 0,
             server_version: String::new(),
             stream: None as Option<RefCell<StreamKind>>,
+            mmap_table: HashMap::new(),
+            received_fds: HashMap::new(),
         }
     }
 }
 
 impl IPCClient {
-    pub fn create_blob(&mut self, size: usize, blob: Box<BlobWriter>) -> io::Result<()> {
+    pub fn create_blob(&mut self, size: usize) -> io::Result<BlobWriter> {
         ENSURE_CONNECTED(self.connected());
-        let object_id = invalid_object_id();
-        let mut object: Payload;
-        let buffer: Option<Rc<arrow::MutableBuffer>> = None;
-        //RETURN_ON_ERROR(create_buffer(size, object_id, object, buffer));
-        panic!(); //TODO
+        let (object_id, payload, buffer) = self.create_buffer(size)?;
+        Ok(BlobWriter::new(object_id, payload, buffer))
     }
 
+    // Allocates a blob in the shared memory, the returned buffer is a
+    // writable view over it.
     pub fn create_buffer(
+        &mut self,
         size: usize,
-        id: ObjectID,
-        payload: &mut Payload,
-        buffer: Option<Rc<arrow::MutableBuffer>>,
-    ) -> io::Result<()> {
-        panic!(); //TODO
+    ) -> io::Result<(ObjectID, Payload, Rc<SharedBuffer>)> {
+        ENSURE_CONNECTED(self.connected());
+        let message_out = write_create_buffer_request(size);
+        let mut message_in = String::new();
+        {
+            let mut stream = self.get_stream()?;
+            do_write(&mut stream, &message_out)?;
+            do_read(&mut stream, &mut message_in)?;
+        }
+        let message_in: Value = serde_json::from_str(&message_in)?;
+        let (object_id, payload) = read_create_buffer_reply(message_in)?;
+        RETURN_ON_ASSERT(payload.data_size as usize == size);
+        let buffer = self.map_payload(&payload)?;
+        Ok((object_id, payload, Rc::new(buffer)))
+    }
+
+    pub fn get_blob(&mut self, id: ObjectID) -> io::Result<Blob> {
+        let mut ids = HashSet::new();
+        ids.insert(id);
+        match self.get_blobs(&ids)?.remove(&id) {
+            Some(blob) => Ok(blob),
+            None => Err(io::Error::new(
+                io::ErrorKind::NotFound,
+                format!("buffer not exists: {}", object_id_to_string(id)),
+            )),
+        }
+    }
+
+    pub fn get_blobs(&mut self, ids: &HashSet<ObjectID>) -> io::Result<HashMap<ObjectID, Blob>> {
+        let mut blobs = HashMap::new();
+        for (id, (size, buffer)) in self.get_buffers(ids)? {
+            blobs.insert(id, Blob::new(id, size, buffer));
+        }
+        Ok(blobs)
+    }
+
+    // Gets the blobs in a single round trip, the buffers are views over the
+    // shared memory without copying, and are `None` for blobs that are not
+    // locally available.
+    pub fn get_buffers(
+        &mut self,
+        ids: &HashSet<ObjectID>,
+    ) -> io::Result<HashMap<ObjectID, (usize, Option<Rc<SharedBuffer>>)>> {
+        ENSURE_CONNECTED(self.connected());
+        let mut buffers = HashMap::new();
+        if ids.is_empty() {
+            return Ok(buffers);
+        }
+        let message_out = write_get_buffer_request(ids);
+        let mut message_in = String::new();
+        {
+            let mut stream = self.get_stream()?;
+            do_write(&mut stream, &message_out)?;
+            do_read(&mut stream, &mut message_in)?;
+        }
+        let message_in: Value = serde_json::from_str(&message_in)?;
+        let payloads = read_get_buffer_reply(message_in)?;
+        // the fds follow the reply on the socket, and must be received in
+        // the order of payloads.
+        self.receive_fds(&payloads)?;
+        for payload in payloads.iter() {
+            let buffer = if payload.data_size > 0 && !payload.is_device() {
+                Some(Rc::new(self.map_payload(payload)?))
+            } else {
+                None
+            };
+            buffers.insert(payload.object_id, (payload.data_size as usize, buffer));
+        }
+        Ok(buffers)
+    }
+
+    // Receives the fds of segments that haven't been mapped yet, the server
+    // sends each fd once over the connection.
+    fn receive_fds(&mut self, payloads: &[Payload]) -> io::Result<()> {
+        let mut fds: Vec<i32> = Vec::new();
+        for payload in payloads {
+            let fd = payload.store_fd;
+            if payload.data_size > 0
+                && fd != -1
+                && !payload.is_device()
+                && !self.mmap_table.contains_key(&fd)
+                && !self.received_fds.contains_key(&fd)
+                && !fds.contains(&fd)
+            {
+                fds.push(fd);
+            }
+        }
+        if fds.is_empty() {
+            return Ok(());
+        }
+        let client_fds = match &*self.get_stream()? {
+            IPCStream(stream) => recv_fds(stream, fds.len())?,
+            _ => panic!("File descriptors can only be received from IPC connections."),
+        };
+        for (fd, client_fd) in fds.into_iter().zip(client_fds.into_iter()) {
+            self.received_fds.insert(fd, client_fd);
+        }
+        Ok(())
+    }
+
+    // Returns the view of the payload, the segment is mapped on first access.
+    fn map_payload(&mut self, payload: &Payload) -> io::Result<SharedBuffer> {
+        if payload.data_size <= 0 {
+            return Ok(SharedBuffer::empty());
+        }
+        if payload.is_device() || payload.store_fd == -1 {
+            return Err(io::Error::new(
+                io::ErrorKind::InvalidInput,
+                "Device blobs cannot be mapped as shared memory",
+            ));
+        }
+        let fd = payload.store_fd;
+        if !self.mmap_table.contains_key(&fd) {
+            self.receive_fds(std::slice::from_ref(payload))?;
+            let client_fd = self.received_fds.remove(&fd).unwrap();
+            let entry = MmapEntry::new(client_fd, payload.map_size, payload.page_size, true)?;
+            self.mmap_table.insert(fd, Rc::new(entry));
+        }
+        SharedBuffer::new(&self.mmap_table[&fd], payload)
     }
 }
 
@@ -174,6 +297,79 @@ mod tests {
         assert_eq!(id1, id2);
     }
 
+    #[test]
+    #[ignore]
+    fn test_ipc_create_and_get_buffer() {
+        let ipc_client = &mut IPCClient::default();
+        ipc_client.connect(IPCConnInput(SOCKET_PATH)).unwrap();
+        let mut writer = ipc_client.create_blob(1024).unwrap();
+        for (idx, byte) in writer.data().iter_mut().enumerate() {
+            *byte = (idx % 256) as u8;
+        }
+        let blob = ipc_client.get_blob(writer.id()).unwrap();
+        assert_eq!(blob.size(), 1024);
+        let data = blob.data().unwrap();
+        for idx in 0..1024 {
+            assert_eq!(data[idx], (idx % 256) as u8);
+        }
+        assert_eq!(blob.slice(16, 32).unwrap(), &writer.data()[16..32]);
+    }
+
+    #[test]
+    #[ignore]
+    fn test_ipc_get_blobs_across_clients() {
+        // the small blobs share segments, and the large ones are likely to
+        // be placed in segments of their own
+        let sizes: Vec<usize> = vec![1, 100, 4096, 1 << 20, (16 << 20) + 7];
+        let value_at = |index: usize, offset: usize| (offset * 7 + index) as u8;
+
+        let writer_client = &mut IPCClient::default();
+        writer_client.connect(IPCConnInput(SOCKET_PATH)).unwrap();
+        let mut writers = Vec::new();
+        for (index, size) in sizes.iter().enumerate() {
+            let mut writer = writer_client.create_blob(*size).unwrap();
+            assert_eq!(writer.size(), *size);
+            for (offset, byte) in writer.data().iter_mut().enumerate() {
+                *byte = value_at(index, offset);
+            }
+            writers.push(writer);
+        }
+        let ids: HashSet<ObjectID> = writers.iter().map(|writer| writer.id()).collect();
+
+        // the blobs are mapped by another client, from the fds passed to it
+        let reader_client = &mut IPCClient::default();
+        reader_client.connect(IPCConnInput(SOCKET_PATH)).unwrap();
+        let blobs = reader_client.get_blobs(&ids).unwrap();
+        assert_eq!(blobs.len(), sizes.len());
+        for (index, writer) in writers.iter().enumerate() {
+            let blob = &blobs[&writer.id()];
+            assert_eq!(blob.size(), sizes[index]);
+            let data = blob.data().unwrap();
+            for offset in 0..sizes[index] {
+                assert_eq!(data[offset], value_at(index, offset));
+            }
+            let half = blob.size() / 2;
+            assert_eq!(
+                blob.slice(half, blob.size()).unwrap().len(),
+                blob.size() - half
+            );
+            assert!(blob.slice(0, blob.size() + 1).is_err());
+        }
+
+        // both clients map the same shared memory
+        writers[0].data()[0] = 255;
+        assert_eq!(blobs[&writers[0].id()].data().unwrap()[0], 255);
+
+        // a new client maps the segments again
+        let last = sizes.len() - 1;
+        let other_client = &mut IPCClient::default();
+        other_client.connect(IPCConnInput(SOCKET_PATH)).unwrap();
+        let blob = other_client.get_blob(writers[last].id()).unwrap();
+        let data = blob.data().unwrap();
+        assert_eq!(data.len(), sizes[last]);
+        assert_eq!(data[sizes[last] - 1], value_at(last, sizes[last] - 1));
+    }
+
     #[test]
     #[should_panic]
     #[ignore]
@@ -0,0 +1,145 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+use std::io;
+use std::ptr;
+use std::rc::Rc;
+use std::slice;
+
+use super::payload::Payload;
+
+// A memory segment mapped from the file descriptor received from the
+// server, the segment is unmapped (and the fd is closed) when dropped.
+#[derive(Debug)]
+pub struct MmapEntry {
+    fd: i32,
+    pointer: *mut u8,
+    length: usize,
+}
+
+impl MmapEntry {
+    pub fn new(fd: i32, map_size: i64, page_size: i64, realign: bool) -> io::Result<MmapEntry> {
+        // fake_mmap in malloc.h leaves a gap between memory segments, to make
+        // map_size page-aligned again.
+        let mut length = if realign {
+            map_size - std::mem::size_of::<usize>() as i64
+        } else {
+            map_size
+        };
+        // segments backed by huge pages must be mapped (and unmapped) with
+        // lengths that aligned to the huge page size.
+        if page_size > 0 {
+            length = (length + page_size - 1) / page_size * page_size;
+        }
+        let pointer = unsafe {
+            libc::mmap(
+                ptr::null_mut(),
+                length as usize,
+                libc::PROT_READ | libc::PROT_WRITE,
+                libc::MAP_SHARED,
+                fd,
+                0,
+            )
+        };
+        if pointer == libc::MAP_FAILED {
+            let err = io::Error::last_os_error();
+            unsafe {
+                libc::close(fd);
+            }
+            return Err(err);
+        }
+        Ok(MmapEntry {
+            fd,
+            pointer: pointer as *mut u8,
+            length: length as usize,
+        })
+    }
+
+    pub fn len(&self) -> usize {
+        self.length
+    }
+}
+
+impl Drop for MmapEntry {
+    fn drop(&mut self) {
+        unsafe {
+            libc::munmap(self.pointer as *mut libc::c_void, self.length);
+            libc::close(self.fd);
+        }
+    }
+}
+
+// A view over the bytes of a blob in the mapped segment, no bytes are copied
+// and the segment is kept mapped as long as the view is alive.
+#[derive(Debug)]
+pub struct SharedBuffer {
+    pointer: *mut u8,
+    size: usize,
+    segment: Option<Rc<MmapEntry>>,
+}
+
+impl SharedBuffer {
+    pub fn empty() -> SharedBuffer {
+        SharedBuffer {
+            pointer: ptr::null_mut(),
+            size: 0,
+            segment: None,
+        }
+    }
+
+    pub fn new(segment: &Rc<MmapEntry>, payload: &Payload) -> io::Result<SharedBuffer> {
+        let begin = payload.data_offset as usize;
+        let size = payload.data_size as usize;
+        if payload.data_offset < 0 || begin + size > segment.len() {
+            return Err(io::Error::new(
+                io::ErrorKind::InvalidData,
+                "The blob is out of the range of the mapped segment",
+            ));
+        }
+        Ok(SharedBuffer {
+            pointer: unsafe { segment.pointer.add(begin) },
+            size,
+            segment: Some(Rc::clone(segment)),
+        })
+    }
+
+    pub fn len(&self) -> usize {
+        self.size
+    }
+
+    pub fn is_empty(&self) -> bool {
+        self.size == 0
+    }
+
+    pub fn as_ptr(&self) -> *const u8 {
+        self.pointer
+    }
+
+    pub fn as_slice(&self) -> &[u8] {
+        if self.size == 0 {
+            return &[];
+        }
+        unsafe { slice::from_raw_parts(self.pointer, self.size) }
+    }
+
+    // The caller must guarantee no other views of the blob are accessed
+    // while the mutable slice is alive, i.e., the blob is being written by
+    // its `BlobWriter`.
+    pub(crate) unsafe fn as_mut_slice(&self) -> &mut [u8] {
+        if self.size == 0 {
+            return &mut [];
+        }
+        slice::from_raw_parts_mut(self.pointer, self.size)
+    }
+}
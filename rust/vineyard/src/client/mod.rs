@@ -17,6 +17,7 @@ limitations under the License.
 pub mod client;
 pub mod ds;
 pub mod ipc_client;
+pub mod mmap;
 pub mod rpc_client;
 pub mod rust_io;
 
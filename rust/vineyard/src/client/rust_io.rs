@@ -16,8 +16,10 @@ limitations under the License.
 use std::io::prelude::*;
 use std::mem;
 use std::net::TcpStream;
+use std::os::unix::io::AsRawFd;
 use std::os::unix::net::UnixStream;
 use std::path::Path;
+use std::ptr;
 
 use super::client::StreamKind;
 
@@ -60,6 +62,89 @@ pub fn do_read(stream: &mut StreamKind, message_in: &mut String) -> io::Result<(
     Ok(())
 }
 
+// The server passes at most 253 (SCM_MAX_FD - 2) file descriptors in a
+// single message.
+const MAX_FDS_PER_MESSAGE: usize = 253;
+
+fn close_fds(fds: &[i32]) {
+    for fd in fds {
+        unsafe {
+            libc::close(*fd);
+        }
+    }
+}
+
+// Receives `count` file descriptors from the unix socket, the fds may be
+// passed by the server in one or more messages.
+pub fn recv_fds(stream: &UnixStream, count: usize) -> io::Result<Vec<i32>> {
+    let conn = stream.as_raw_fd();
+    let mut fds: Vec<i32> = Vec::with_capacity(count);
+    let space =
+        unsafe { libc::CMSG_SPACE((mem::size_of::<i32>() * MAX_FDS_PER_MESSAGE) as u32) } as usize;
+    let mut control = vec![0u8; space];
+    while fds.len() < count {
+        let mut data = [0u8; 1];
+        let mut iov = libc::iovec {
+            iov_base: data.as_mut_ptr() as *mut libc::c_void,
+            iov_len: data.len(),
+        };
+        let mut msg: libc::msghdr = unsafe { mem::zeroed() };
+        msg.msg_iov = &mut iov;
+        msg.msg_iovlen = 1;
+        msg.msg_control = control.as_mut_ptr() as *mut libc::c_void;
+        msg.msg_controllen = space as _;
+        let r = loop {
+            let r = unsafe { libc::recvmsg(conn, &mut msg, 0) };
+            if r < 0 && io::Error::last_os_error().kind() == io::ErrorKind::Interrupted {
+                continue;
+            }
+            break r;
+        };
+        if r <= 0 {
+            let err = if r == 0 {
+                io::Error::new(io::ErrorKind::UnexpectedEof, "Encountered unexpected EOF")
+            } else {
+                io::Error::last_os_error()
+            };
+            close_fds(&fds);
+            return Err(err);
+        }
+        let mut received = 0;
+        let mut header = unsafe { libc::CMSG_FIRSTHDR(&msg) };
+        while !header.is_null() {
+            let cmsg = unsafe { &*header };
+            if cmsg.cmsg_level == libc::SOL_SOCKET && cmsg.cmsg_type == libc::SCM_RIGHTS {
+                let length = cmsg.cmsg_len as usize - unsafe { libc::CMSG_LEN(0) } as usize;
+                let rights = unsafe { libc::CMSG_DATA(header) } as *const i32;
+                for idx in 0..length / mem::size_of::<i32>() {
+                    fds.push(unsafe { ptr::read_unaligned(rights.add(idx)) });
+                    received += 1;
+                }
+            }
+            header = unsafe { libc::CMSG_NXTHDR(&msg, header) };
+        }
+        if msg.msg_flags & libc::MSG_CTRUNC != 0 || received == 0 {
+            close_fds(&fds);
+            return Err(io::Error::new(
+                io::ErrorKind::InvalidData,
+                "Failed to receive file descriptors from the socket",
+            ));
+        }
+    }
+    if fds.len() != count {
+        close_fds(&fds);
+        return Err(io::Error::new(
+            io::ErrorKind::InvalidData,
+            format!(
+                "Failed to receive file descriptors: expect {} but got {}",
+                count,
+                fds.len()
+            ),
+        ));
+    }
+    Ok(fds)
+}
+
 mod ipc_io {
     use super::*;
 
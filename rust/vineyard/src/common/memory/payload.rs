@@ -7,11 +7,13 @@ use super::uuid::*;
 #[derive(Debug)]
 pub struct Payload {
     pub object_id: ObjectID,
-    store_fd: i32,
+    pub store_fd: i32,
     arena_fd: i32,
-    data_offset: isize,
-    data_size: i64,
-    map_size: i64,
+    pub data_offset: isize,
+    pub data_size: i64,
+    pub map_size: i64,
+    pub page_size: i64,
+    pub device: i32,
     pointer: *const u8, // TODO: Check if this is right for nullptr
 }
 
@@ -24,6 +26,8 @@ impl Default for Payload {
             data_offset: 0,
             data_size: 0,
             map_size: 0,
+            page_size: 0,
+            device: -1,
             pointer: ptr::null(), // nullptr
         }
     }
@@ -35,6 +39,11 @@ impl Payload {
         ret
     }
 
+    // Blobs in device memory cannot be mapped as shared memory.
+    pub fn is_device(&self) -> bool {
+        self.device >= 0
+    }
+
     pub fn to_json(&self) -> Value {
         json!({
             "object_id": self.object_id, 
@@ -50,6 +59,8 @@ impl Payload {
         self.data_offset = tree["data_offset"].as_i64().unwrap() as isize;
         self.data_size = tree["data_size"].as_i64().unwrap();
         self.map_size = tree["map_size"].as_i64().unwrap();
+        self.page_size = tree["page_size"].as_i64().unwrap_or(0);
+        self.device = tree["device"].as_i64().unwrap_or(-1) as i32;
         self.pointer = ptr::null(); //  nullptr
     }
 }
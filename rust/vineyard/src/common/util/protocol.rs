@@ -142,10 +142,10 @@ pub fn write_create_remote_buffer_request(size: usize) -> String {
     encode_msg(msg)
 }
 
-pub fn write_get_buffer_request(ids: HashSet<ObjectID>) -> String {
+pub fn write_get_buffer_request(ids: &HashSet<ObjectID>) -> String {
     let mut map = Map::new();
     let mut idx: usize = 0;
-    for id in &ids {
+    for id in ids {
         map.insert(
             idx.to_string(),
             Value::Number(serde_json::Number::from(*id)),
@@ -164,15 +164,17 @@ pub fn write_get_buffer_request(ids: HashSet<ObjectID>) -> String {
     encode_msg(msg)
 }
 
-pub fn read_get_buffer_reply(root: Value) -> io::Result<HashMap<ObjectID, Payload>> {
+// The payloads are kept in the order of the reply, as the server sends the
+// file descriptors in the same order.
+pub fn read_get_buffer_reply(root: Value) -> io::Result<Vec<Payload>> {
     CHECK_IPC_ERROR(&root, "get_buffers_reply");
-    let mut objects: HashMap<ObjectID, Payload> = HashMap::new();
     let num: usize = root["num"].as_u64().unwrap() as usize;
+    let mut objects: Vec<Payload> = Vec::with_capacity(num);
     for idx in 0..num {
         let tree: &Value = &root[idx.to_string()];
         let mut object = Payload::new();
         object.from_json(tree);
-        objects.insert(object.object_id, object);
+        objects.push(object);
     }
     Ok(objects)
 }
@@ -18,9 +18,14 @@ limitations under the License.
 
 #include <stddef.h>
 
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
 #include <limits>
 #include <memory>
-#include <set>
+#include <mutex>
+#include <type_traits>
+#include <unordered_set>
 #include <vector>
 
 #include "client/client.h"
@@ -29,6 +34,16 @@ limitations under the License.
 
 namespace vineyard {
 
+/**
+ * @brief VineyardAllocator allocates memory from a jemalloc arena that is
+ * mapped from the vineyard server, allocated blocks can be frozen into blobs
+ * in place by `Freeze`.
+ *
+ * Frozen blocks become available in the vineyard server after `Flush` (which
+ * keeps the arena alive and hands the large freed ranges back to the server)
+ * or `Release`. The allocator is thread-safe, and each thread allocates from
+ * its own cache of the arena.
+ */
 template <typename T>
 struct VineyardAllocator : public memory::Jemalloc {
  public:
@@ -57,34 +72,130 @@ struct VineyardAllocator : public memory::Jemalloc {
   VineyardAllocator(const VineyardAllocator<U>&) noexcept {}
 
   T* allocate(size_t size, const void* = nullptr) {
-    return reinterpret_cast<T*>(Jemalloc::Allocate(size));
+    return reinterpret_cast<T*>(
+        Jemalloc::Allocate(size * sizeof_value(), alignof(std::max_align_t)));
   }
 
-  void deallocate(T* ptr, size_t size) {
-    if (freezed_.find(reinterpret_cast<uintptr_t>(ptr)) != freezed_.end()) {
-      Jemalloc::Free(ptr, size);
+  void deallocate(T* ptr, size_t size) { Free(ptr, size * sizeof_value()); }
+
+  /**
+   * @brief Free the memory if it hasn't been frozen, frozen memory belongs to
+   * the blob.
+   */
+  void Free(void* ptr, size_t size = 0) {
+    if (ptr == nullptr) {
+      return;
+    }
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (frozen_.erase(reinterpret_cast<uintptr_t>(ptr))) {
+        return;
+      }
+    }
+    size_t allocated_size = Jemalloc::GetAllocatedSize(ptr);
+    Jemalloc::Free(ptr, size);
+    if (allocated_size >= kRecycleThreshold) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      unused_offsets_.emplace_back(reinterpret_cast<uintptr_t>(ptr) - space_);
+      unused_sizes_.emplace_back(allocated_size);
+    }
+  }
+
+  /**
+   * @brief Reallocate the memory, frozen memory is copied rather than being
+   * moved.
+   */
+  void* Reallocate(void* ptr, size_t size) {
+    if (ptr == nullptr) {
+      return Jemalloc::Allocate(size, alignof(std::max_align_t));
+    }
+    bool frozen = false;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      frozen = frozen_.find(reinterpret_cast<uintptr_t>(ptr)) != frozen_.end();
+    }
+    if (!frozen) {
+      return Jemalloc::Reallocate(ptr, size);
     }
+    void* target = Jemalloc::Allocate(size, alignof(std::max_align_t));
+    if (target != nullptr) {
+      memcpy(target, ptr, std::min(size, Jemalloc::GetAllocatedSize(ptr)));
+      // the pointer is given up, the memory is now owned by the blob only
+      std::lock_guard<std::mutex> lock(mutex_);
+      frozen_.erase(reinterpret_cast<uintptr_t>(ptr));
+    }
+    return target;
+  }
+
+  /**
+   * @brief Whether the memory belongs to the arena of the allocator.
+   */
+  bool Contains(const void* ptr) const {
+    auto pointer = reinterpret_cast<uintptr_t>(ptr);
+    return pointer >= space_ && pointer < space_ + available_size_;
   }
 
+  uintptr_t Space() const { return space_; }
+
+  size_t Size() const { return available_size_; }
+
   std::shared_ptr<Blob> Freeze(T* ptr) {
     size_t allocated_size = Jemalloc::GetAllocatedSize(ptr);
     VLOG(10) << "freeze the pointer " << ptr << " of size " << allocated_size;
-    offsets_.emplace_back(reinterpret_cast<uintptr_t>(ptr) - space_);
-    sizes_.emplace_back(allocated_size);
-    freezed_.emplace(reinterpret_cast<uintptr_t>(ptr));
-    ObjectID id = base_ + (reinterpret_cast<uintptr_t>(ptr) - space_);
-    return Blob::FromBuffer(client_, id, reinterpret_cast<uintptr_t>(ptr),
-                            allocated_size);
+    uintptr_t offset = reinterpret_cast<uintptr_t>(ptr) - space_;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      offsets_.emplace_back(offset);
+      sizes_.emplace_back(allocated_size);
+      frozen_.emplace(reinterpret_cast<uintptr_t>(ptr));
+    }
+    return Blob::FromBuffer(client_, GenerateBlobID(base_ + offset),
+                            allocated_size, reinterpret_cast<uintptr_t>(ptr));
+  }
+
+  /**
+   * @brief Make the blocks that are frozen since last flush available in the
+   * vineyard server, and recycle the large blocks that have been freed.
+   *
+   * The bookkeeping is cleared after flushing, except the frozen pointers that
+   * haven't been deallocated yet.
+   */
+  Status Flush() {
+    std::vector<size_t> offsets, sizes, unused_offsets, unused_sizes;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      offsets.swap(offsets_);
+      sizes.swap(sizes_);
+      unused_offsets.swap(unused_offsets_);
+      unused_sizes.swap(unused_sizes_);
+    }
+    if (offsets.empty() && unused_offsets.empty()) {
+      return Status::OK();
+    }
+    VLOG(10) << "jemalloc arena flushed: " << offsets.size()
+             << " blocks are frozen, " << unused_offsets.size()
+             << " blocks are recycled.";
+    return client_.FlushArena(fd_, offsets, sizes, unused_offsets,
+                              unused_sizes);
   }
 
+  /**
+   * @brief Release the arena, requires no concurrent allocations.
+   */
   Status Release() {
+    if (released_) {
+      return Status::OK();
+    }
+    released_ = true;
+    // the cached memory cannot be served anymore
+    Jemalloc::DestroyThreadCaches();
     VLOG(10) << "jemalloc arena finalized: of " << offsets_.size()
              << " blocks are in use.";
     return client_.ReleaseArena(fd_, offsets_, sizes_);
   }
 
   Status Renew() {
-    RETURN_ON_ERROR(client_.ReleaseArena(fd_, offsets_, sizes_));
+    RETURN_ON_ERROR(Release());
     return _initialize_arena(available_size_);
   }
 
@@ -94,25 +205,44 @@ struct VineyardAllocator : public memory::Jemalloc {
   };
 
  private:
+  // freed blocks that are larger than the threshold are handed back to the
+  // server on `Flush`.
+  static constexpr size_t kRecycleThreshold = 1 * 1024 * 1024;  // 1MB
+
   Client& client_;
   int fd_;
   uintptr_t base_, space_;
   size_t available_size_;
+  bool released_ = false;
+
+  std::mutex mutex_;
   std::vector<size_t> offsets_, sizes_;
-  std::set<uintptr_t> freezed_;
+  std::vector<size_t> unused_offsets_, unused_sizes_;
+  std::unordered_set<uintptr_t> frozen_;
+
+  static constexpr size_t sizeof_value() {
+    // `VineyardAllocator<void>` allocates in bytes
+    return sizeof(
+        typename std::conditional<std::is_void<T>::value, char, T>::type);
+  }
 
   Status _initialize_arena(size_t size) {
     VLOG(2) << "make arena: " << size;
     RETURN_ON_ERROR(
         client_.CreateArena(size, fd_, available_size_, base_, space_));
     Jemalloc::Init(reinterpret_cast<void*>(space_), available_size_);
+    Jemalloc::EnableThreadCache();
     VLOG(2) << "jemalloc arena initialized: " << available_size_ << ", at "
             << reinterpret_cast<void*>(space_);
 
     // reset the context
+    std::lock_guard<std::mutex> lock(mutex_);
+    released_ = false;
     offsets_.clear();
     sizes_.clear();
-    freezed_.clear();
+    unused_offsets_.clear();
+    unused_sizes_.clear();
+    frozen_.clear();
     return Status::OK();
   }
 };
@@ -0,0 +1,209 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+
+#ifndef SRC_CLIENT_ASYNC_CLIENT_H_
+#define SRC_CLIENT_ASYNC_CLIENT_H_
+
+#include <algorithm>
+#include <memory>
+#include <thread>
+#include <utility>
+
+#include "boost/asio.hpp"
+#include "boost/version.hpp"
+
+#include "client/client.h"
+#include "client/ds/blob.h"
+#include "client/ds/object_base.h"
+#include "client/rpc_client.h"
+#include "common/util/status.h"
+#include "common/util/uuid.h"
+
+#if BOOST_VERSION < 107000
+#error "The asynchronous vineyard client requires boost >= 1.70"
+#endif
+
+/**
+ * @brief Asynchronous operations on vineyard clients in the style of asio
+ * initiating functions, i.e., the completion token decides how the result
+ * is delivered:
+ *
+ *  - a callback, e.g., `[](Status status, std::shared_ptr<Object> object)`,
+ *
+ *  - `asio::use_future`, returns a `std::future` of the result, i.e., a
+ *    `std::tuple<Status, ...>` as the status is not an error code,
+ *
+ *  - `asio::yield_context` for stackful coroutines, or `asio::use_awaitable`
+ *    in C++20 coroutines, e.g.,
+ *
+ *      auto [status, object] =
+ *          co_await AsyncGetObject(client, id, asio::use_awaitable);
+ *
+ * The blocking requests are issued on a dedicated thread pool, and the
+ * completion handlers are invoked on their associated executors, thus
+ * the event loop threads of the caller are never blocked.
+ */
+namespace vineyard {
+
+namespace asio = boost::asio;
+
+namespace detail {
+
+// the pool that issues the blocking requests, pulling from a stream
+// occupies a thread until the chunk arrives.
+inline asio::thread_pool& async_client_pool() {
+  static asio::thread_pool pool(
+      std::max(4U, std::thread::hardware_concurrency()));
+  return pool;
+}
+
+template <typename R>
+struct async_op_t {
+  template <typename Handler, typename Request>
+  static void run(Handler&& handler, Request&& request) {
+    auto work = asio::make_work_guard(asio::get_associated_executor(handler));
+    asio::post(async_client_pool(), [handler = std::forward<Handler>(handler),
+                                     request = std::forward<Request>(request),
+                                     work = std::move(work)]() mutable {
+      R result{};
+      Status status = request(result);
+      auto executor = work.get_executor();
+      asio::dispatch(executor, [handler = std::move(handler), status,
+                                result = std::move(result)]() mutable {
+        handler(status, std::move(result));
+      });
+    });
+  }
+};
+
+template <>
+struct async_op_t<void> {
+  template <typename Handler, typename Request>
+  static void run(Handler&& handler, Request&& request) {
+    auto work = asio::make_work_guard(asio::get_associated_executor(handler));
+    asio::post(async_client_pool(), [handler = std::forward<Handler>(handler),
+                                     request = std::forward<Request>(request),
+                                     work = std::move(work)]() mutable {
+      Status status = request();
+      auto executor = work.get_executor();
+      asio::dispatch(executor,
+                     [handler = std::move(handler), status]() mutable {
+                       handler(status);
+                     });
+    });
+  }
+};
+
+template <typename R, typename CompletionToken, typename Request>
+auto async_request(CompletionToken&& token, Request&& request) {
+  return asio::async_initiate<CompletionToken, void(Status, R)>(
+      [](auto handler, auto request) {
+        async_op_t<R>::run(std::move(handler), std::move(request));
+      },
+      token, std::forward<Request>(request));
+}
+
+template <typename CompletionToken, typename Request>
+auto async_status_request(CompletionToken&& token, Request&& request) {
+  return asio::async_initiate<CompletionToken, void(Status)>(
+      [](auto handler, auto request) {
+        async_op_t<void>::run(std::move(handler), std::move(request));
+      },
+      token, std::forward<Request>(request));
+}
+
+}  // namespace detail
+
+/**
+ * @brief Get the object asynchronously, completes with
+ * `(Status, std::shared_ptr<Object>)`.
+ */
+template <typename CompletionToken>
+auto AsyncGetObject(Client& client, const ObjectID id,
+                    CompletionToken&& token) {
+  return detail::async_request<std::shared_ptr<Object>>(
+      std::forward<CompletionToken>(token),
+      [&client, id](std::shared_ptr<Object>& object) {
+        return client.GetObject(id, object);
+      });
+}
+
+template <typename CompletionToken>
+auto AsyncGetObject(RPCClient& client, const ObjectID id,
+                    CompletionToken&& token) {
+  return detail::async_request<std::shared_ptr<Object>>(
+      std::forward<CompletionToken>(token),
+      [&client, id](std::shared_ptr<Object>& object) {
+        return client.GetObject(id, object);
+      });
+}
+
+/**
+ * @brief Create a blob asynchronously, completes with
+ * `(Status, std::unique_ptr<BlobWriter>)`.
+ */
+template <typename CompletionToken>
+auto AsyncCreateBlob(Client& client, const size_t size,
+                     CompletionToken&& token) {
+  return detail::async_request<std::unique_ptr<BlobWriter>>(
+      std::forward<CompletionToken>(token),
+      [&client, size](std::unique_ptr<BlobWriter>& blob) {
+        return client.CreateBlob(size, blob);
+      });
+}
+
+/**
+ * @brief Allocate the next chunk of the stream asynchronously, completes
+ * with `(Status, std::unique_ptr<arrow::MutableBuffer>)`.
+ */
+template <typename CompletionToken>
+auto AsyncGetNextStreamChunk(Client& client, const ObjectID id,
+                             const size_t size, CompletionToken&& token) {
+  return detail::async_request<std::unique_ptr<arrow::MutableBuffer>>(
+      std::forward<CompletionToken>(token),
+      [&client, id, size](std::unique_ptr<arrow::MutableBuffer>& chunk) {
+        return client.GetNextStreamChunk(id, size, chunk);
+      });
+}
+
+/**
+ * @brief Pull the next chunk from the stream asynchronously, completes with
+ * `(Status, std::unique_ptr<arrow::Buffer>)`.
+ */
+template <typename CompletionToken>
+auto AsyncPullNextStreamChunk(Client& client, const ObjectID id,
+                              CompletionToken&& token) {
+  return detail::async_request<std::unique_ptr<arrow::Buffer>>(
+      std::forward<CompletionToken>(token),
+      [&client, id](std::unique_ptr<arrow::Buffer>& chunk) {
+        return client.PullNextStreamChunk(id, chunk);
+      });
+}
+
+/**
+ * @brief Persist the object asynchronously, completes with `(Status)`.
+ */
+template <typename CompletionToken>
+auto AsyncPersist(ClientBase& client, const ObjectID id,
+                  CompletionToken&& token) {
+  return detail::async_status_request(
+      std::forward<CompletionToken>(token),
+      [&client, id]() { return client.Persist(id); });
+}
+
+}  // namespace vineyard
+
+#endif  // SRC_CLIENT_ASYNC_CLIENT_H_
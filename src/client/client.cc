@@ -16,11 +16,18 @@ limitations under the License.
 #include "client/client.h"
 
 #include <sys/mman.h>
+#include <unistd.h>
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
 #include <limits>
 #include <map>
 #include <mutex>
 #include <set>
+#include <thread>
 #include <unordered_map>
 #include <utility>
 
@@ -29,14 +36,23 @@ limitations under the License.
 #include "client/ds/blob.h"
 #include "client/io.h"
 #include "client/utils.h"
+#include "common/memory/cuda.h"
 #include "common/memory/fling.h"
+#include "common/util/binary_protocols.h"
 #include "common/util/boost.h"
+#include "common/util/env.h"
 #include "common/util/protocols.h"
 
 namespace vineyard {
 
-MmapEntry::MmapEntry(int fd, int64_t map_size, bool readonly, bool realign)
-    : fd_(fd), ro_pointer_(nullptr), rw_pointer_(nullptr), length_(0) {
+MmapEntry::MmapEntry(int fd, int64_t map_size, int64_t page_size,
+                     bool readonly, bool realign, bool prefault, bool pin)
+    : fd_(fd),
+      ro_pointer_(nullptr),
+      rw_pointer_(nullptr),
+      length_(0),
+      prefault_(prefault),
+      pin_(pin) {
   // fake_mmap in malloc.h leaves a gap between memory segments, to make
   // map_size page-aligned again.
   if (realign) {
@@ -44,9 +60,20 @@ MmapEntry::MmapEntry(int fd, int64_t map_size, bool readonly, bool realign)
   } else {
     length_ = map_size;
   }
+  // segments backed by huge pages must be mapped (and unmapped) with lengths
+  // that aligned to the huge page size.
+  if (page_size > 0) {
+    length_ = (length_ + page_size - 1) / page_size * page_size;
+  }
 }
 
 MmapEntry::~MmapEntry() {
+  if (ro_pinned_) {
+    VINEYARD_DISCARD(memory::cuda_host_unregister(ro_pointer_));
+  }
+  if (rw_pinned_) {
+    VINEYARD_DISCARD(memory::cuda_host_unregister(rw_pointer_));
+  }
   if (ro_pointer_) {
     int r = munmap(ro_pointer_, length_);
     if (r != 0) {
@@ -65,29 +92,84 @@ MmapEntry::~MmapEntry() {
 }
 
 uint8_t* MmapEntry::map_readonly() {
+  std::lock_guard<std::mutex> lock(mutex_);
   if (!ro_pointer_) {
+    int flags = MAP_SHARED | (prefault_ ? MAP_POPULATE : 0);
     ro_pointer_ = reinterpret_cast<uint8_t*>(
-        mmap(NULL, length_, PROT_READ, MAP_SHARED, fd_, 0));
+        mmap(NULL, length_, PROT_READ, flags, fd_, 0));
     if (ro_pointer_ == MAP_FAILED) {
       LOG(ERROR) << "mmap failed: errno = " << errno << ": " << strerror(errno);
       ro_pointer_ = nullptr;
+    } else if (pin_) {
+      ro_pinned_ = pin(ro_pointer_, true);
     }
   }
   return ro_pointer_;
 }
 
 uint8_t* MmapEntry::map_readwrite() {
+  std::lock_guard<std::mutex> lock(mutex_);
   if (!rw_pointer_) {
+    int flags = MAP_SHARED | (prefault_ ? MAP_POPULATE : 0);
     rw_pointer_ = reinterpret_cast<uint8_t*>(
-        mmap(NULL, length_, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0));
+        mmap(NULL, length_, PROT_READ | PROT_WRITE, flags, fd_, 0));
     if (rw_pointer_ == MAP_FAILED) {
       LOG(ERROR) << "mmap failed: errno = " << errno << ": " << strerror(errno);
       rw_pointer_ = nullptr;
+    } else if (pin_) {
+      rw_pinned_ = pin(rw_pointer_, false);
     }
   }
   return rw_pointer_;
 }
 
+bool MmapEntry::pin(uint8_t* pointer, bool readonly) {
+  auto status = memory::cuda_host_register(pointer, length_, readonly);
+  if (!status.ok()) {
+    // the segment still works as pageable memory
+    LOG(WARNING) << "Failed to register the mapped segment as pinned memory: "
+                 << status.ToString();
+  }
+  return status.ok();
+}
+
+std::shared_ptr<SharedMmapTable> SharedMmapTable::Get(
+    const std::string& ipc_socket) {
+  static std::mutex mutex;
+  static std::unordered_map<std::string, std::shared_ptr<SharedMmapTable>>
+      tables;
+  std::lock_guard<std::mutex> lock(mutex);
+  auto& table = tables[ipc_socket];
+  if (table == nullptr) {
+    table = std::make_shared<SharedMmapTable>();
+  }
+  return table;
+}
+
+uint64_t SharedMmapTable::Snapshot(std::vector<entry_t>& entries) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  entries.assign(entries_.begin(), entries_.end());
+  return server_token_;
+}
+
+void SharedMmapTable::Reset(const uint64_t server_token) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (server_token_ != server_token) {
+    server_token_ = server_token;
+    entries_.clear();
+  }
+}
+
+std::shared_ptr<MmapEntry> SharedMmapTable::Emplace(
+    const uint64_t server_token, const int fd,
+    std::shared_ptr<MmapEntry> const& entry) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (server_token_ != server_token) {
+    return entry;
+  }
+  return entries_.emplace(fd, entry).first->second;
+}
+
 Status Client::Connect() {
   if (const char* env_p = std::getenv("VINEYARD_IPC_SOCKET")) {
     return Connect(std::string(env_p));
@@ -104,17 +186,111 @@ Status Client::Connect(const std::string& ipc_socket) {
   }
   ipc_socket_ = ipc_socket;
   RETURN_ON_ERROR(connect_ipc_socket_retry(ipc_socket, vineyard_conn_));
+
+  if (const char* env_p = std::getenv("VINEYARD_MMAP_PREFAULT")) {
+    std::string flag(env_p);
+    prefault_ = flag == "1" || flag == "true";
+  }
+  if (const char* env_p = std::getenv("VINEYARD_CUDA_HOST_REGISTER")) {
+    std::string flag(env_p);
+    pin_memory_ = flag == "1" || flag == "true";
+  }
+  // claims the fds that have been received by other clients in the process
+  std::vector<SharedMmapTable::entry_t> mapped;
+  uint64_t mapped_token = 0;
+  if (const char* env_p = std::getenv("VINEYARD_SHARED_MMAP")) {
+    std::string flag(env_p);
+    if (flag == "1" || flag == "true") {
+      shared_mmap_table_ = SharedMmapTable::Get(ipc_socket);
+      mapped_token = shared_mmap_table_->Snapshot(mapped);
+    }
+  }
+  std::vector<int> mapped_fds;
+  for (auto const& item : mapped) {
+    mapped_fds.emplace_back(item.first);
+  }
+
   std::string message_out;
-  WriteRegisterRequest(message_out);
+  WriteRegisterRequest(mapped_token, mapped_fds, read_env("VINEYARD_TENANT"),
+                       message_out);
   RETURN_ON_ERROR(doWrite(message_out));
   json message_in;
   RETURN_ON_ERROR(doRead(message_in));
   std::string ipc_socket_value, rpc_endpoint_value;
+  bool binary_protocol = false, ipc_ring = false, pipelining = false;
   RETURN_ON_ERROR(ReadRegisterReply(message_in, ipc_socket_value,
                                     rpc_endpoint_value, instance_id_,
-                                    server_version_));
+                                    server_version_, binary_protocol, ipc_ring,
+                                    server_token_, pipelining));
   rpc_endpoint_ = rpc_endpoint_value;
   connected_ = true;
+  // the blobs are pinned per connection
+  mapped_blobs_.clear();
+  blob_table_.reset();
+
+  if (shared_mmap_table_) {
+    if (server_token_ != 0 && server_token_ == mapped_token) {
+      // the server won't send these fds on this connection
+      mmap_table_.insert(mapped.begin(), mapped.end());
+    } else {
+      // the server doesn't support sharing fds across connections, or the
+      // table is populated by another server.
+      shared_mmap_table_->Reset(server_token_);
+      if (server_token_ == 0) {
+        shared_mmap_table_ = nullptr;
+      }
+    }
+  }
+
+  // the binary protocol is opt-in, and only be used when the server
+  // supports it.
+  binary_protocol_supported_ = binary_protocol;
+  if (const char* env_p = std::getenv("VINEYARD_BINARY_PROTOCOL")) {
+    std::string flag(env_p);
+    binary_protocol_ = binary_protocol && (flag == "1" || flag == "true");
+  }
+
+  // the blob table is opt-in, as the blobs resolved from it are not pinned,
+  // and it is mapped before switching to the ring as the fd follows the
+  // reply on the socket.
+  if (const char* env_p = std::getenv("VINEYARD_BLOB_TABLE")) {
+    std::string flag(env_p);
+    if (flag == "1" || flag == "true") {
+      auto status = enableBlobTable();
+      if (!status.ok()) {
+        LOG(WARNING) << "Failed to map the blob table: " << status.ToString();
+      }
+    }
+  }
+
+  // the shared memory ring is opt-in as well, as it costs a server thread
+  // per connection.
+  if (const char* env_p = std::getenv("VINEYARD_IPC_RING")) {
+    std::string flag(env_p);
+    if (ipc_ring && (flag == "1" || flag == "true")) {
+      auto status = enableRing();
+      if (!status.ok()) {
+        Disconnect();
+        return status;
+      }
+    }
+  }
+
+  // pipelining is opt-in, and is not used together with the shared memory
+  // ring.
+  pipelining_ = false;
+  if (const char* env_p = std::getenv("VINEYARD_PIPELINING")) {
+    std::string flag(env_p);
+    pipelining_ = pipelining && !ring_ && (flag == "1" || flag == "true");
+  }
+
+  if (const char* env_p = std::getenv("VINEYARD_META_CACHE")) {
+    size_t capacity = std::strtoull(env_p, nullptr, 10);
+    if (capacity > 0) {
+      VINEYARD_SUPPRESS(EnableMetaCache(capacity));
+    }
+  }
+  enableProfilingFromEnv();
 
   if (!compatible_server(server_version_)) {
     LOG(ERROR) << "Warning: this version of vineyard client may be "
@@ -126,6 +302,72 @@ Status Client::Connect(const std::string& ipc_socket) {
   return Status::OK();
 }
 
+Status Client::enableRing() {
+  std::string message_out;
+  WriteEnableRingRequest(kRingCapacity, message_out);
+  RETURN_ON_ERROR(doWrite(message_out));
+  json message_in;
+  RETURN_ON_ERROR(doRead(message_in));
+  int fd = -1;
+  size_t capacity = 0;
+  RETURN_ON_ERROR(ReadEnableRingReply(message_in, fd, capacity));
+  int ring_fd = recv_fd(vineyard_conn_);
+  if (ring_fd < 0) {
+    return Status::IOError("Failed to receive the fd of the ring buffer");
+  }
+  auto status = RingChannel::Map(ring_fd, capacity, false, ring_);
+  close(ring_fd);
+  return status;
+}
+
+Status Client::enableBlobTable() {
+  std::string message_out;
+  WriteEnableBlobTableRequest(message_out);
+  RETURN_ON_ERROR(doWrite(message_out));
+  json message_in;
+  RETURN_ON_ERROR(doRead(message_in));
+  int fd = -1;
+  size_t capacity = 0;
+  RETURN_ON_ERROR(ReadEnableBlobTableReply(message_in, fd, capacity));
+  int table_fd = recv_fd(vineyard_conn_);
+  if (table_fd < 0) {
+    return Status::IOError("Failed to receive the fd of the blob table");
+  }
+  auto status = BlobTable::Map(table_fd, capacity, false, blob_table_);
+  close(table_fd);
+  return status;
+}
+
+void Client::resolveBuffers(
+    std::set<ObjectID>& ids,
+    std::map<ObjectID, std::shared_ptr<arrow::Buffer>>& buffers) {
+  for (auto iter = ids.begin(); iter != ids.end(); /* no self-inc */) {
+    BlobLocation location;
+    if (*iter == EmptyBlobID()) {
+      buffers.emplace(*iter, std::make_shared<arrow::Buffer>(nullptr, 0));
+      iter = ids.erase(iter);
+      continue;
+    }
+    if (!blob_table_->Get(*iter, location)) {
+      ++iter;
+      continue;
+    }
+    // the fd of the segment must have been received, as the fds follow the
+    // replies of `GetBuffers`.
+    auto entry = mmap_table_.find(location.store_fd);
+    uint8_t* shared =
+        entry == mmap_table_.end() ? nullptr : entry->second->map_readonly();
+    if (shared == nullptr) {
+      ++iter;
+      continue;
+    }
+    buffers.emplace(*iter, std::make_shared<arrow::Buffer>(
+                               shared + location.data_offset,
+                               location.data_size));
+    iter = ids.erase(iter);
+  }
+}
+
 Status Client::Fork(Client& client) {
   RETURN_ON_ASSERT(!client.Connected(),
                    "The client has already been connected to vineyard server");
@@ -141,14 +383,33 @@ Client& Client::Default() {
 
 Status Client::GetMetaData(const ObjectID id, ObjectMeta& meta,
                            const bool sync_remote) {
+  return GetMetaData(id, meta, sync_remote, false);
+}
+
+Status Client::GetMetaData(const ObjectID id, ObjectMeta& meta,
+                           const bool sync_remote, const bool lazy) {
   ENSURE_CONNECTED(this);
+  // `sync_remote` asks for the metadata that has been synchronized from
+  // the other instances, bypass the cache and refresh it with the result.
+  bool const cacheable = meta_cache_ && !lazy;
+  if (cacheable && !sync_remote && meta_cache_->Get(id, meta)) {
+    return Status::OK();
+  }
+  uint64_t const epoch = cacheable ? meta_cache_->Epoch() : 0;
+
   json tree;
-  RETURN_ON_ERROR(GetData(id, tree, sync_remote));
+  {
+    GetObjectProfile::Timer timer(GetObjectProfile::kGetData);
+    RETURN_ON_ERROR(GetData(id, tree, sync_remote, false, lazy));
+  }
   meta.Reset();
   meta.SetMetaData(this, tree);
 
   std::map<ObjectID, std::shared_ptr<arrow::Buffer>> buffers;
-  RETURN_ON_ERROR(GetBuffers(meta.GetBufferSet()->AllBufferIds(), buffers));
+  {
+    GetObjectProfile::Timer timer(GetObjectProfile::kGetBuffers);
+    RETURN_ON_ERROR(GetBuffers(meta.GetBufferSet()->AllBufferIds(), buffers));
+  }
 
   for (auto const& id : meta.GetBufferSet()->AllBufferIds()) {
     const auto& buffer = buffers.find(id);
@@ -156,6 +417,9 @@ Status Client::GetMetaData(const ObjectID id, ObjectMeta& meta,
       meta.SetBuffer(id, buffer->second);
     }
   }
+  if (cacheable) {
+    meta_cache_->Put(id, meta, epoch);
+  }
   return Status::OK();
 }
 
@@ -163,22 +427,67 @@ Status Client::GetMetaData(const std::vector<ObjectID>& ids,
                            std::vector<ObjectMeta>& metas,
                            const bool sync_remote) {
   ENSURE_CONNECTED(this);
-  std::vector<json> trees;
-  RETURN_ON_ERROR(GetData(ids, trees, sync_remote));
-  metas.resize(trees.size());
+  metas.resize(ids.size());
+  // only fetch the metadata that misses the cache, `sync_remote` bypasses
+  // the cache and refreshes it.
+  std::vector<ObjectID> missed_ids;
+  std::vector<size_t> missed_indices;
+  for (size_t idx = 0; idx < ids.size(); ++idx) {
+    if (!meta_cache_ || sync_remote ||
+        !meta_cache_->Get(ids[idx], metas[idx])) {
+      missed_ids.emplace_back(ids[idx]);
+      missed_indices.emplace_back(idx);
+    }
+  }
+  if (missed_ids.empty()) {
+    return Status::OK();
+  }
+  uint64_t const epoch = meta_cache_ ? meta_cache_->Epoch() : 0;
+
+  // the metadata and the blobs are fetched in a single round trip
+  std::unordered_map<ObjectID, json> trees;
+  std::map<ObjectID, std::shared_ptr<arrow::Buffer>> buffers;
+  RETURN_ON_ERROR(getObjectsImpl(missed_ids, sync_remote, trees, buffers));
 
+  for (auto const idx : missed_indices) {
+    auto tree = trees.find(ids[idx]);
+    if (tree == trees.end()) {
+      return Status::ObjectNotExists("failed to get metadata of object " +
+                                     ObjectIDToString(ids[idx]));
+    }
+    auto& meta = metas[idx];
+    meta.Reset();
+    meta.SetMetaData(this, tree->second);
+    for (auto const id : meta.GetBufferSet()->AllBufferIds()) {
+      const auto& buffer = buffers.find(id);
+      if (buffer != buffers.end()) {
+        meta.SetBuffer(id, buffer->second);
+      }
+    }
+    if (meta_cache_) {
+      meta_cache_->Put(ids[idx], meta, epoch);
+    }
+  }
+  return Status::OK();
+}
+
+Status Client::GetMetaData(const std::vector<ObjectID>& ids,
+                           const uint64_t snapshot,
+                           std::vector<ObjectMeta>& metas) {
+  ENSURE_CONNECTED(this);
+  std::vector<json> trees;
+  RETURN_ON_ERROR(GetData(ids, snapshot, trees));
+  // the cache serves the latest metadata, bypassed for the snapshots
+  metas.resize(ids.size());
   std::set<ObjectID> blob_ids;
-  for (size_t idx = 0; idx < trees.size(); ++idx) {
+  for (size_t idx = 0; idx < ids.size(); ++idx) {
     metas[idx].Reset();
     metas[idx].SetMetaData(this, trees[idx]);
-    for (const auto& id : metas[idx].GetBufferSet()->AllBufferIds()) {
-      blob_ids.emplace(id);
-    }
+    auto const& buffer_ids = metas[idx].GetBufferSet()->AllBufferIds();
+    blob_ids.insert(buffer_ids.begin(), buffer_ids.end());
   }
-
   std::map<ObjectID, std::shared_ptr<arrow::Buffer>> buffers;
   RETURN_ON_ERROR(GetBuffers(blob_ids, buffers));
-
   for (auto& meta : metas) {
     for (auto const id : meta.GetBufferSet()->AllBufferIds()) {
       const auto& buffer = buffers.find(id);
@@ -191,20 +500,114 @@ Status Client::GetMetaData(const std::vector<ObjectID>& ids,
 }
 
 Status Client::CreateBlob(size_t size, std::unique_ptr<BlobWriter>& blob) {
+  return CreateBlob(size, -1, blob);
+}
+
+Status Client::CreateBlob(size_t size, const int numa_node,
+                          std::unique_ptr<BlobWriter>& blob) {
   ENSURE_CONNECTED(this);
 
   ObjectID object_id = InvalidObjectID();
   Payload object;
   std::shared_ptr<arrow::MutableBuffer> buffer = nullptr;
-  RETURN_ON_ERROR(CreateBuffer(size, object_id, object, buffer));
+  RETURN_ON_ERROR(CreateBuffer(size, object_id, object, buffer, numa_node));
+  blob.reset(new BlobWriter(object_id, object, buffer));
+  return Status::OK();
+}
+
+Status Client::CreateDeviceBlob(size_t size, const int device,
+                                std::unique_ptr<BlobWriter>& blob) {
+  ENSURE_CONNECTED(this);
+  RETURN_ON_ASSERT(device >= 0, "Invalid CUDA device");
+
+  std::string message_out;
+  WriteCreateBufferRequest(size, -1, device, message_out);
+  RETURN_ON_ERROR(doWrite(message_out));
+  json message_in;
+  RETURN_ON_ERROR(doRead(message_in));
+  ObjectID object_id = InvalidObjectID();
+  Payload object;
+  RETURN_ON_ERROR(ReadCreateBufferReply(message_in, object_id, object));
+  RETURN_ON_ASSERT(static_cast<size_t>(object.data_size) == size);
+
+  uint8_t* pointer = nullptr;
+  if (object.data_size > 0) {
+    RETURN_ON_ERROR(mapDeviceBuffer(object, &pointer));
+  }
+  auto buffer = std::make_shared<arrow::MutableBuffer>(pointer, size);
   blob.reset(new BlobWriter(object_id, object, buffer));
   return Status::OK();
 }
 
+Status Client::CreateBlobs(const std::vector<size_t>& sizes,
+                           std::vector<std::unique_ptr<BlobWriter>>& blobs) {
+  ENSURE_CONNECTED(this);
+
+  std::vector<ObjectID> object_ids;
+  std::vector<Payload> objects;
+  std::vector<std::shared_ptr<arrow::MutableBuffer>> buffers;
+  RETURN_ON_ERROR(CreateBuffers(sizes, object_ids, objects, buffers));
+  blobs.clear();
+  for (size_t idx = 0; idx < sizes.size(); ++idx) {
+    blobs.emplace_back(
+        new BlobWriter(object_ids[idx], objects[idx], buffers[idx]));
+  }
+  return Status::OK();
+}
+
+Status Client::CopyBlob(const ObjectID source,
+                        std::unique_ptr<BlobWriter>& blob) {
+  ENSURE_CONNECTED(this);
+
+  ObjectID object_id = InvalidObjectID();
+  Payload object;
+  std::shared_ptr<arrow::MutableBuffer> buffer = nullptr;
+  RETURN_ON_ERROR(CopyBuffer(source, object_id, object, buffer));
+  blob.reset(new BlobWriter(object_id, object, buffer));
+  return Status::OK();
+}
+
+Status Client::CreateBlobFromFile(const std::string& path, const size_t offset,
+                                  const int64_t length,
+                                  std::shared_ptr<Blob>& blob) {
+  ENSURE_CONNECTED(this);
+  std::string message_out;
+  WriteCreateBufferFromFileRequest(path, offset, length, message_out);
+  RETURN_ON_ERROR(doWrite(message_out));
+  json message_in;
+  RETURN_ON_ERROR(doRead(message_in));
+  ObjectID object_id = InvalidObjectID();
+  Payload payload;
+  RETURN_ON_ERROR(
+      ReadCreateBufferFromFileReply(message_in, object_id, payload));
+
+  uint8_t *shared = nullptr, *dist = nullptr;
+  if (payload.data_size > 0) {
+    // the fd follows the reply on the socket
+    RETURN_ON_ERROR(mmapToClient(payload.store_fd, payload.map_size,
+                                 payload.page_size, true, true, &shared));
+    dist = shared + payload.data_offset;
+  }
+  blob = Blob::FromBuffer(*this, object_id, payload.data_size,
+                          reinterpret_cast<uintptr_t>(dist));
+  return Status::OK();
+}
+
 Status Client::CreateStream(const ObjectID& id) {
+  return CreateStream(id, 0, 0);
+}
+
+Status Client::CreateStream(const ObjectID& id, size_t const retain_chunks,
+                            size_t const retain_bytes,
+                            size_t const budget_bytes) {
   ENSURE_CONNECTED(this);
   std::string message_out;
-  WriteCreateStreamRequest(id, message_out);
+  if (retain_chunks == 0 && retain_bytes == 0 && budget_bytes == 0) {
+    WriteCreateStreamRequest(id, message_out);
+  } else {
+    WriteCreateStreamRequest(id, retain_chunks, retain_bytes, budget_bytes,
+                             message_out);
+  }
   RETURN_ON_ERROR(doWrite(message_out));
   json message_in;
   RETURN_ON_ERROR(doRead(message_in));
@@ -213,9 +616,19 @@ Status Client::CreateStream(const ObjectID& id) {
 }
 
 Status Client::OpenStream(const ObjectID& id, OpenStreamMode mode) {
+  return OpenStream(id, mode, -1);
+}
+
+Status Client::OpenStream(const ObjectID& id, OpenStreamMode mode,
+                          int64_t const offset) {
   ENSURE_CONNECTED(this);
   std::string message_out;
-  WriteOpenStreamRequest(id, static_cast<int64_t>(mode), message_out);
+  if (offset < 0) {
+    WriteOpenStreamRequest(id, static_cast<int64_t>(mode), message_out);
+  } else {
+    WriteOpenStreamRequest(id, static_cast<int64_t>(mode), offset,
+                           message_out);
+  }
   RETURN_ON_ERROR(doWrite(message_out));
   json message_in;
   RETURN_ON_ERROR(doRead(message_in));
@@ -227,18 +640,26 @@ Status Client::GetNextStreamChunk(ObjectID const id, size_t const size,
                                   std::unique_ptr<arrow::MutableBuffer>& blob) {
   ENSURE_CONNECTED(this);
   std::string message_out;
-  WriteGetNextStreamChunkRequest(id, size, message_out);
-  RETURN_ON_ERROR(doWrite(message_out));
-  json message_in;
-  RETURN_ON_ERROR(doRead(message_in));
   Payload object;
-  RETURN_ON_ERROR(ReadGetNextStreamChunkReply(message_in, object));
+  if (binary_protocol_) {
+    WriteGetNextStreamChunkRequestBinary(id, size, message_out);
+    RETURN_ON_ERROR(doWrite(message_out));
+    std::string message_in;
+    RETURN_ON_ERROR(doRead(message_in));
+    RETURN_ON_ERROR(ReadGetNextStreamChunkReplyBinary(message_in, object));
+  } else {
+    WriteGetNextStreamChunkRequest(id, size, message_out);
+    RETURN_ON_ERROR(doWrite(message_out));
+    json message_in;
+    RETURN_ON_ERROR(doRead(message_in));
+    RETURN_ON_ERROR(ReadGetNextStreamChunkReply(message_in, object));
+  }
   RETURN_ON_ASSERT(size == static_cast<size_t>(object.data_size),
                    "The size of returned chunk doesn't match");
   uint8_t *mmapped_ptr = nullptr, *dist = nullptr;
   if (object.data_size > 0) {
-    RETURN_ON_ERROR(mmapToClient(object.store_fd, object.map_size, false, true,
-                                 &mmapped_ptr));
+    RETURN_ON_ERROR(mmapToClient(object.store_fd, object.map_size,
+                                 object.page_size, false, true, &mmapped_ptr));
     dist = mmapped_ptr + object.data_offset;
   }
   blob.reset(new arrow::MutableBuffer(dist, object.data_size));
@@ -249,22 +670,124 @@ Status Client::PullNextStreamChunk(ObjectID const id,
                                    std::unique_ptr<arrow::Buffer>& blob) {
   ENSURE_CONNECTED(this);
   std::string message_out;
-  WritePullNextStreamChunkRequest(id, message_out);
-  RETURN_ON_ERROR(doWrite(message_out));
-  json message_in;
-  RETURN_ON_ERROR(doRead(message_in));
   Payload object;
-  RETURN_ON_ERROR(ReadPullNextStreamChunkReply(message_in, object));
+  if (binary_protocol_) {
+    WritePullNextStreamChunkRequestBinary(id, message_out);
+    RETURN_ON_ERROR(doWrite(message_out));
+    std::string message_in;
+    RETURN_ON_ERROR(doRead(message_in));
+    RETURN_ON_ERROR(ReadPullNextStreamChunkReplyBinary(message_in, object));
+  } else {
+    WritePullNextStreamChunkRequest(id, message_out);
+    RETURN_ON_ERROR(doWrite(message_out));
+    json message_in;
+    RETURN_ON_ERROR(doRead(message_in));
+    RETURN_ON_ERROR(ReadPullNextStreamChunkReply(message_in, object));
+  }
   uint8_t *mmapped_ptr = nullptr, *dist = nullptr;
   if (object.data_size > 0) {
-    RETURN_ON_ERROR(mmapToClient(object.store_fd, object.map_size, true, true,
-                                 &mmapped_ptr));
+    RETURN_ON_ERROR(mmapToClient(object.store_fd, object.map_size,
+                                 object.page_size, true, true, &mmapped_ptr));
     dist = mmapped_ptr + object.data_offset;
   }
   blob.reset(new arrow::Buffer(dist, object.data_size));
   return Status::OK();
 }
 
+std::future<Status> Client::GetNextStreamChunkAsync(
+    ObjectID const id, size_t const size,
+    std::unique_ptr<arrow::MutableBuffer>& blob) {
+  return doAsync(
+      [this, id, size, &blob]() { return GetNextStreamChunk(id, size, blob); });
+}
+
+std::future<Status> Client::PullNextStreamChunkAsync(
+    ObjectID const id, std::unique_ptr<arrow::Buffer>& blob) {
+  return doAsync([this, id, &blob]() { return PullNextStreamChunk(id, blob); });
+}
+
+Status Client::GetNextStreamChunks(
+    ObjectID const id, std::vector<size_t> const& sizes,
+    std::vector<std::unique_ptr<arrow::MutableBuffer>>& blobs) {
+  ENSURE_CONNECTED(this);
+  RETURN_ON_ASSERT(binary_protocol_supported_,
+                   "The batched stream chunks requires the binary protocol");
+  std::string message_out;
+  WriteGetNextStreamChunksRequestBinary(id, sizes, message_out);
+  RETURN_ON_ERROR(doWrite(message_out));
+  std::string message_in;
+  RETURN_ON_ERROR(doRead(message_in));
+  std::vector<Payload> objects;
+  RETURN_ON_ERROR(ReadGetNextStreamChunksReplyBinary(message_in, objects));
+  RETURN_ON_ASSERT(objects.size() == sizes.size(),
+                   "The number of returned chunks doesn't match");
+  RETURN_ON_ERROR(receiveFds(objects));
+  blobs.clear();
+  for (size_t idx = 0; idx < objects.size(); ++idx) {
+    auto const& object = objects[idx];
+    RETURN_ON_ASSERT(sizes[idx] == static_cast<size_t>(object.data_size),
+                     "The size of returned chunk doesn't match");
+    uint8_t *mmapped_ptr = nullptr, *dist = nullptr;
+    if (object.data_size > 0) {
+      RETURN_ON_ERROR(mmapToClient(object.store_fd, object.map_size,
+                                   object.page_size, false, true,
+                                   &mmapped_ptr));
+      dist = mmapped_ptr + object.data_offset;
+    }
+    blobs.emplace_back(new arrow::MutableBuffer(dist, object.data_size));
+  }
+  return Status::OK();
+}
+
+Status Client::PutStreamChunks(
+    ObjectID const id,
+    std::vector<std::shared_ptr<arrow::Buffer>> const& chunks) {
+  ENSURE_CONNECTED(this);
+  RETURN_ON_ASSERT(binary_protocol_supported_,
+                   "The batched stream chunks requires the binary protocol");
+  if (chunks.empty()) {
+    return Status::OK();
+  }
+  std::vector<std::pair<const uint8_t*, size_t>> payloads;
+  for (auto const& chunk : chunks) {
+    payloads.emplace_back(chunk->data(), chunk->size());
+  }
+  std::string message_out;
+  WritePutStreamChunksRequestBinary(id, payloads, message_out);
+  RETURN_ON_ERROR(doWrite(message_out));
+  std::string message_in;
+  RETURN_ON_ERROR(doRead(message_in));
+  size_t num = 0;
+  RETURN_ON_ERROR(ReadPutStreamChunksReplyBinary(message_in, num));
+  RETURN_ON_ASSERT(num == chunks.size(),
+                   "The number of published chunks doesn't match");
+  return Status::OK();
+}
+
+Status Client::PullStreamChunks(
+    ObjectID const id, size_t const limit,
+    std::vector<std::shared_ptr<arrow::Buffer>>& chunks) {
+  ENSURE_CONNECTED(this);
+  RETURN_ON_ASSERT(binary_protocol_supported_,
+                   "The batched stream chunks requires the binary protocol");
+  std::string message_out;
+  WritePullStreamChunksRequestBinary(id, limit, message_out);
+  RETURN_ON_ERROR(doWrite(message_out));
+  auto message_in = std::make_shared<std::string>();
+  RETURN_ON_ERROR(doRead(*message_in));
+  std::vector<std::pair<size_t, size_t>> payloads;
+  RETURN_ON_ERROR(ReadPullStreamChunksReplyBinary(*message_in, payloads));
+  // the chunks refer to the reply message, rather than copying again
+  chunks.clear();
+  for (auto const& payload : payloads) {
+    auto data = reinterpret_cast<const uint8_t*>(message_in->data()) +
+                payload.first;
+    chunks.emplace_back(new arrow::Buffer(data, payload.second),
+                        [message_in](arrow::Buffer* buffer) { delete buffer; });
+  }
+  return Status::OK();
+}
+
 Status Client::StopStream(ObjectID const id, const bool failed) {
   ENSURE_CONNECTED(this);
   std::string message_out;
@@ -276,50 +799,215 @@ Status Client::StopStream(ObjectID const id, const bool failed) {
   return Status::OK();
 }
 
+// objects with many members (e.g., fragments, tables) construct the members
+// concurrently, see also `ObjectMeta::PrefetchMembers`.
+static constexpr size_t kPrefetchMembersThreshold = 16;
+
 std::shared_ptr<Object> Client::GetObject(const ObjectID id) {
+  GetObjectProfile::Scope scope(profile_.get());
   ObjectMeta meta;
   VINEYARD_CHECK_OK(this->GetMetaData(id, meta, true));
   VINEYARD_ASSERT(!meta.MetaData().empty());
-  auto object = ObjectFactory::Create(meta.GetTypeName());
+  std::unique_ptr<Object> object;
+  {
+    GetObjectProfile::Timer timer(GetObjectProfile::kCreate);
+    object = ObjectFactory::Create(meta.GetTypeId(), meta.GetTypeName());
+  }
   if (object == nullptr) {
     object = std::unique_ptr<Object>(new Object());
   }
-  object->Construct(meta);
+  {
+    GetObjectProfile::Timer timer(GetObjectProfile::kConstruct);
+    if (meta.MemberCount() > kPrefetchMembersThreshold) {
+      meta.PrefetchMembers();
+    }
+    object->Construct(meta);
+    meta.DropPrefetchedMembers();
+  }
+  scope.Commit(meta.GetTypeName());
   return object;
 }
 
 Status Client::GetObject(const ObjectID id, std::shared_ptr<Object>& object) {
+  GetObjectProfile::Scope scope(profile_.get());
   ObjectMeta meta;
   RETURN_ON_ERROR(this->GetMetaData(id, meta, true));
   RETURN_ON_ASSERT(!meta.MetaData().empty());
-  object = ObjectFactory::Create(meta.GetTypeName());
+  {
+    GetObjectProfile::Timer timer(GetObjectProfile::kCreate);
+    object = ObjectFactory::Create(meta.GetTypeId(), meta.GetTypeName());
+  }
   if (object == nullptr) {
     object = std::unique_ptr<Object>(new Object());
   }
-  object->Construct(meta);
+  {
+    GetObjectProfile::Timer timer(GetObjectProfile::kConstruct);
+    if (meta.MemberCount() > kPrefetchMembersThreshold) {
+      meta.PrefetchMembers();
+    }
+    object->Construct(meta);
+    meta.DropPrefetchedMembers();
+  }
+  scope.Commit(meta.GetTypeName());
+  return Status::OK();
+}
+
+Status Client::GetObject(const ObjectID id, const AccessHint hint,
+                         std::shared_ptr<Object>& object) {
+  RETURN_ON_ERROR(GetObject(id, object));
+  return Advise(*object, hint, true);
+}
+
+namespace detail {
+
+#ifndef MADV_POPULATE_READ
+#define MADV_POPULATE_READ 22
+#endif
+
+static void PopulatePages(
+    std::vector<std::pair<uintptr_t, size_t>> const& ranges,
+    const size_t page_size) {
+  for (auto const& range : ranges) {
+#if defined(__linux__)
+    // populates the page tables without touching the content (Linux 5.14+)
+    if (madvise(reinterpret_cast<void*>(range.first), range.second,
+                MADV_POPULATE_READ) == 0) {
+      continue;
+    }
+#endif
+    const volatile uint8_t* pointer =
+        reinterpret_cast<const volatile uint8_t*>(range.first);
+    for (size_t offset = 0; offset < range.second; offset += page_size) {
+      (void) pointer[offset];
+    }
+  }
+}
+
+}  // namespace detail
+
+Status Client::Advise(const Object& object, const AccessHint hint,
+                      const bool background) {
+  int advice = MADV_NORMAL;
+  switch (hint) {
+  case AccessHint::normal:
+    advice = MADV_NORMAL;
+    break;
+  case AccessHint::sequential:
+    advice = MADV_SEQUENTIAL;
+    break;
+  case AccessHint::random:
+    advice = MADV_RANDOM;
+    break;
+  case AccessHint::willneed:
+  case AccessHint::populate:
+    advice = MADV_WILLNEED;
+    break;
+  default:
+    return Status::Invalid("Unknown access hint: " +
+                           std::to_string(static_cast<int>(hint)));
+  }
+
+  // the page-aligned ranges of the blobs in host memory
+  static const size_t page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+  std::vector<std::pair<uintptr_t, size_t>> ranges;
+  auto const& buffer_set = object.meta().GetBufferSet();
+  for (auto const& item : buffer_set->AllBuffers()) {
+    auto const& buffer = item.second;
+    if (buffer == nullptr || buffer->size() == 0 ||
+        device_mappings_.find(item.first) != device_mappings_.end()) {
+      continue;
+    }
+    uintptr_t begin = reinterpret_cast<uintptr_t>(buffer->data());
+    uintptr_t aligned = begin / page_size * page_size;
+    ranges.emplace_back(aligned, begin + buffer->size() - aligned);
+  }
+
+  for (auto const& range : ranges) {
+    // the content is left intact, failures i.e., the ranges that are not
+    // mapped by this client, are ignored
+    if (madvise(reinterpret_cast<void*>(range.first), range.second, advice) !=
+        0) {
+      VLOG(10) << "madvise failed: errno = " << errno << ": "
+               << strerror(errno);
+    }
+  }
+  if (hint != AccessHint::populate) {
+    return Status::OK();
+  }
+  if (!background) {
+    detail::PopulatePages(ranges, page_size);
+    return Status::OK();
+  }
+  std::lock_guard<std::mutex> lock(advise_mutex_);
+  // drops the finished ones
+  advising_.erase(
+      std::remove_if(advising_.begin(), advising_.end(),
+                     [](std::future<void> const& task) {
+                       return task.wait_for(std::chrono::seconds(0)) ==
+                              std::future_status::ready;
+                     }),
+      advising_.end());
+  advising_.emplace_back(std::async(std::launch::async, [ranges]() {
+    detail::PopulatePages(ranges, page_size);
+  }));
   return Status::OK();
 }
 
 std::vector<std::shared_ptr<Object>> Client::GetObjects(
     const std::vector<ObjectID>& ids) {
+  std::vector<std::shared_ptr<Object>> objects;
+  VINEYARD_CHECK_OK(this->GetObjects(ids, objects, true));
+  return objects;
+}
+
+Status Client::GetObjects(const std::vector<ObjectID>& ids,
+                          std::vector<std::shared_ptr<Object>>& objects,
+                          const bool sync_remote) {
   std::vector<ObjectMeta> metas;
-  VINEYARD_CHECK_OK(this->GetMetaData(ids, metas, true));
+  RETURN_ON_ERROR(this->GetMetaData(ids, metas, sync_remote));
   for (auto const& meta : metas) {
-    if (meta.MetaData().empty()) {
-      VINEYARD_ASSERT(!meta.MetaData().empty());
-    }
+    RETURN_ON_ASSERT(!meta.MetaData().empty());
   }
-  std::vector<std::shared_ptr<Object>> objects;
-  objects.reserve(ids.size());
-  for (auto const& meta : metas) {
-    auto object = ObjectFactory::Create(meta.GetTypeName());
+
+  objects.clear();
+  objects.resize(metas.size());
+  auto construct = [&metas, &objects](const size_t idx) {
+    auto object = ObjectFactory::Create(metas[idx].GetTypeId(),
+                                        metas[idx].GetTypeName());
     if (object == nullptr) {
       object = std::unique_ptr<Object>(new Object());
     }
-    object->Construct(meta);
-    objects.emplace_back(std::shared_ptr<Object>(object.release()));
+    object->Construct(metas[idx]);
+    objects[idx] = std::shared_ptr<Object>(object.release());
+  };
+
+  // constructing is cheap for small batches, where spawning the threads
+  // doesn't pay off.
+  static constexpr size_t kParallelThreshold = 64;
+  size_t concurrency = std::min<size_t>(
+      std::max<unsigned>(std::thread::hardware_concurrency(), 1),
+      metas.size() / kParallelThreshold);
+  if (concurrency <= 1) {
+    for (size_t idx = 0; idx < metas.size(); ++idx) {
+      construct(idx);
+    }
+    return Status::OK();
   }
-  return objects;
+  std::atomic<size_t> next(0);
+  std::vector<std::thread> workers;
+  workers.reserve(concurrency);
+  for (size_t i = 0; i < concurrency; ++i) {
+    workers.emplace_back([&]() {
+      size_t idx = 0;
+      while ((idx = next.fetch_add(1)) < metas.size()) {
+        construct(idx);
+      }
+    });
+  }
+  for (auto& worker : workers) {
+    worker.join();
+  }
+  return Status::OK();
 }
 
 std::vector<std::shared_ptr<Object>> Client::ListObjects(
@@ -354,7 +1042,7 @@ std::vector<std::shared_ptr<Object>> Client::ListObjects(
       }
     }
 
-    auto object = ObjectFactory::Create(meta.GetTypeName());
+    auto object = ObjectFactory::Create(meta.GetTypeId(), meta.GetTypeName());
     if (object == nullptr) {
       object = std::unique_ptr<Object>(new Object());
     }
@@ -395,7 +1083,7 @@ Status Client::CreateArena(const size_t size, int& fd, size_t& available_size,
                   size == available_size);
   uint8_t* mmapped_ptr = nullptr;
   VINEYARD_CHECK_OK(
-      mmapToClient(fd, available_size, false, false, &mmapped_ptr));
+      mmapToClient(fd, available_size, 0, false, false, &mmapped_ptr));
   space = reinterpret_cast<uintptr_t>(mmapped_ptr);
   return Status::OK();
 }
@@ -412,27 +1100,166 @@ Status Client::ReleaseArena(const int fd, std::vector<size_t> const& offsets,
   return Status::OK();
 }
 
+Status Client::FlushArena(const int fd, std::vector<size_t> const& offsets,
+                          std::vector<size_t> const& sizes,
+                          std::vector<size_t> const& unused_offsets,
+                          std::vector<size_t> const& unused_sizes) {
+  ENSURE_CONNECTED(this);
+  std::string message_out;
+  WriteFinalizeArenaRequest(fd, offsets, sizes, unused_offsets, unused_sizes,
+                            message_out);
+  RETURN_ON_ERROR(doWrite(message_out));
+  json message_in;
+  RETURN_ON_ERROR(doRead(message_in));
+  RETURN_ON_ERROR(ReadFinalizeArenaReply(message_in));
+  return Status::OK();
+}
+
+Status Client::Release(std::vector<ObjectID> const& ids) {
+  ENSURE_CONNECTED(this);
+  std::vector<ObjectID> blob_ids;
+  for (auto const& id : ids) {
+    if (IsBlob(id)) {
+      blob_ids.emplace_back(id);
+      continue;
+    }
+    json tree;
+    RETURN_ON_ERROR(GetData(id, tree, false));
+    ObjectMeta meta;
+    meta.SetMetaData(this, tree);
+    for (auto const& blob_id : meta.GetBufferSet()->AllBufferIds()) {
+      blob_ids.emplace_back(blob_id);
+    }
+  }
+
+  // the released blobs are no longer pinned, and the cached metadata that
+  // holds their buffers may refer to spilled or relocated memory thereafter.
+  for (auto const& blob_id : blob_ids) {
+    mapped_blobs_.erase(blob_id);
+  }
+  if (meta_cache_) {
+    meta_cache_->Invalidate(blob_ids);
+  }
+
+  std::string message_out;
+  WriteReleaseRequest(blob_ids, message_out);
+  RETURN_ON_ERROR(doWrite(message_out));
+  json message_in;
+  RETURN_ON_ERROR(doRead(message_in));
+  RETURN_ON_ERROR(ReadReleaseReply(message_in));
+  return Status::OK();
+}
+
 Status Client::CreateBuffer(const size_t size, ObjectID& id, Payload& payload,
+                            std::shared_ptr<arrow::MutableBuffer>& buffer,
+                            const int numa_node) {
+  ENSURE_CONNECTED(this);
+  std::string message_out;
+  if (binary_protocol_) {
+    WriteCreateBufferRequestBinary(size, numa_node, message_out);
+    RETURN_ON_ERROR(doWrite(message_out));
+    std::string message_in;
+    RETURN_ON_ERROR(doRead(message_in));
+    RETURN_ON_ERROR(ReadCreateBufferReplyBinary(message_in, id, payload));
+  } else {
+    WriteCreateBufferRequest(size, numa_node, message_out);
+    RETURN_ON_ERROR(doWrite(message_out));
+    json message_in;
+    RETURN_ON_ERROR(doRead(message_in));
+    RETURN_ON_ERROR(ReadCreateBufferReply(message_in, id, payload));
+  }
+  RETURN_ON_ASSERT(static_cast<size_t>(payload.data_size) == size);
+
+  uint8_t *shared = nullptr, *dist = nullptr;
+  if (payload.data_size > 0) {
+    RETURN_ON_ERROR(
+        mmapToClient(payload.store_fd, payload.map_size, payload.page_size,
+                     false, true, &shared));
+    dist = shared + payload.data_offset;
+  }
+  buffer = std::make_shared<arrow::MutableBuffer>(dist, payload.data_size);
+  return Status::OK();
+}
+
+Status Client::ExtendBuffer(const ObjectID id, const size_t size,
+                            Payload& payload,
                             std::shared_ptr<arrow::MutableBuffer>& buffer) {
   ENSURE_CONNECTED(this);
   std::string message_out;
-  WriteCreateBufferRequest(size, message_out);
+  WriteExtendBufferRequest(id, size, message_out);
   RETURN_ON_ERROR(doWrite(message_out));
   json message_in;
   RETURN_ON_ERROR(doRead(message_in));
-  RETURN_ON_ERROR(ReadCreateBufferReply(message_in, id, payload));
+  RETURN_ON_ERROR(ReadExtendBufferReply(message_in, payload));
   RETURN_ON_ASSERT(static_cast<size_t>(payload.data_size) == size);
 
+  // the blob is extended in place, and the segment has been mapped
+  uint8_t* shared = nullptr;
+  RETURN_ON_ERROR(mmapToClient(payload.store_fd, payload.map_size,
+                               payload.page_size, false, true, &shared));
+  buffer = std::make_shared<arrow::MutableBuffer>(
+      shared + payload.data_offset, payload.data_size);
+  return Status::OK();
+}
+
+Status Client::CopyBuffer(const ObjectID source, ObjectID& id,
+                          Payload& payload,
+                          std::shared_ptr<arrow::MutableBuffer>& buffer) {
+  ENSURE_CONNECTED(this);
+  std::string message_out;
+  WriteCopyBufferRequest(source, message_out);
+  RETURN_ON_ERROR(doWrite(message_out));
+  json message_in;
+  RETURN_ON_ERROR(doRead(message_in));
+  RETURN_ON_ERROR(ReadCopyBufferReply(message_in, id, payload));
+
   uint8_t *shared = nullptr, *dist = nullptr;
   if (payload.data_size > 0) {
     RETURN_ON_ERROR(
-        mmapToClient(payload.store_fd, payload.map_size, false, true, &shared));
+        mmapToClient(payload.store_fd, payload.map_size, payload.page_size,
+                     false, true, &shared));
     dist = shared + payload.data_offset;
   }
   buffer = std::make_shared<arrow::MutableBuffer>(dist, payload.data_size);
   return Status::OK();
 }
 
+Status Client::CreateBuffers(
+    const std::vector<size_t>& sizes, std::vector<ObjectID>& ids,
+    std::vector<Payload>& payloads,
+    std::vector<std::shared_ptr<arrow::MutableBuffer>>& buffers) {
+  ENSURE_CONNECTED(this);
+  if (sizes.empty()) {
+    return Status::OK();
+  }
+  std::string message_out;
+  WriteCreateBuffersRequest(sizes, message_out);
+  RETURN_ON_ERROR(doWrite(message_out));
+  json message_in;
+  RETURN_ON_ERROR(doRead(message_in));
+  RETURN_ON_ERROR(ReadCreateBuffersReply(message_in, ids, payloads));
+  RETURN_ON_ASSERT(ids.size() == sizes.size() &&
+                   payloads.size() == sizes.size());
+
+  // n.b.: the server sends fds in the order of payloads, thus we must receive
+  // them in the same order.
+  RETURN_ON_ERROR(receiveFds(payloads));
+  for (size_t idx = 0; idx < payloads.size(); ++idx) {
+    auto const& payload = payloads[idx];
+    RETURN_ON_ASSERT(static_cast<size_t>(payload.data_size) == sizes[idx]);
+    uint8_t *shared = nullptr, *dist = nullptr;
+    if (payload.data_size > 0) {
+      RETURN_ON_ERROR(
+          mmapToClient(payload.store_fd, payload.map_size, payload.page_size,
+                       false, true, &shared));
+      dist = shared + payload.data_offset;
+    }
+    buffers.emplace_back(
+        std::make_shared<arrow::MutableBuffer>(dist, payload.data_size));
+  }
+  return Status::OK();
+}
+
 Status Client::GetBuffer(const ObjectID id,
                          std::shared_ptr<arrow::Buffer>& buffer) {
   std::map<ObjectID, std::shared_ptr<arrow::Buffer>> buffers;
@@ -445,6 +1272,25 @@ Status Client::GetBuffer(const ObjectID id,
   return Status::OK();
 }
 
+Status Client::getBuffersImpl(const std::set<ObjectID>& ids,
+                              std::vector<Payload>& payloads) {
+  std::string message_out;
+  if (binary_protocol_) {
+    WriteGetBuffersRequestBinary(ids, message_out);
+    RETURN_ON_ERROR(doWrite(message_out));
+    std::string message_in;
+    RETURN_ON_ERROR(doRead(message_in));
+    RETURN_ON_ERROR(ReadGetBuffersReplyBinary(message_in, payloads));
+  } else {
+    WriteGetBuffersRequest(ids, message_out);
+    RETURN_ON_ERROR(doWrite(message_out));
+    json message_in;
+    RETURN_ON_ERROR(doRead(message_in));
+    RETURN_ON_ERROR(ReadGetBuffersReply(message_in, payloads));
+  }
+  return Status::OK();
+}
+
 Status Client::GetBuffers(
     const std::set<ObjectID>& ids,
     std::map<ObjectID, std::shared_ptr<arrow::Buffer>>& buffers) {
@@ -452,23 +1298,61 @@ Status Client::GetBuffers(
     return Status::OK();
   }
   ENSURE_CONNECTED(this);
+  // the blobs that have been mapped (and are still pinned) by this client
+  // are served without a round trip.
+  std::set<ObjectID> missed_ids;
+  for (auto const& id : ids) {
+    auto mapped = mapped_blobs_.find(id);
+    if (mapped != mapped_blobs_.end()) {
+      buffers.emplace(id, mapped->second);
+    } else {
+      missed_ids.emplace(id);
+    }
+  }
+  if (blob_table_ && !missed_ids.empty()) {
+    resolveBuffers(missed_ids, buffers);
+  }
+  if (missed_ids.empty()) {
+    return Status::OK();
+  }
+  std::vector<Payload> payloads;
+  RETURN_ON_ERROR(getBuffersImpl(missed_ids, payloads));
+  return mapBuffers(payloads, buffers);
+}
+
+Status Client::getObjectsImpl(
+    const std::vector<ObjectID>& ids, const bool sync_remote,
+    std::unordered_map<ObjectID, json>& trees,
+    std::map<ObjectID, std::shared_ptr<arrow::Buffer>>& buffers) {
   std::string message_out;
-  WriteGetBuffersRequest(ids, message_out);
+  WriteGetObjectsRequest(ids, sync_remote, false, message_out);
   RETURN_ON_ERROR(doWrite(message_out));
   json message_in;
   RETURN_ON_ERROR(doRead(message_in));
   std::vector<Payload> payloads;
-  RETURN_ON_ERROR(ReadGetBuffersReply(message_in, payloads));
+  RETURN_ON_ERROR(ReadGetObjectsReply(message_in, trees, payloads));
+  return mapBuffers(payloads, buffers);
+}
+
+Status Client::mapBuffers(
+    const std::vector<Payload>& payloads,
+    std::map<ObjectID, std::shared_ptr<arrow::Buffer>>& buffers) {
+  // the fds follow the reply on the socket, the connection is dropped if
+  // they cannot be received.
+  RETURN_ON_ERROR(receiveFds(payloads));
   for (auto const& item : payloads) {
     std::shared_ptr<arrow::Buffer> buffer = nullptr;
     uint8_t *shared = nullptr, *dist = nullptr;
-    if (item.data_size > 0) {
-      VINEYARD_CHECK_OK(
-          mmapToClient(item.store_fd, item.map_size, true, true, &shared));
+    if (item.data_size > 0 && item.IsDevice()) {
+      RETURN_ON_ERROR(mapDeviceBuffer(item, &dist));
+    } else if (item.data_size > 0) {
+      RETURN_ON_ERROR(mmapToClient(item.store_fd, item.map_size,
+                                   item.page_size, true, true, &shared));
       dist = shared + item.data_offset;
     }
     buffer = std::make_shared<arrow::Buffer>(dist, item.data_size);
     buffers.emplace(item.object_id, buffer);
+    mapped_blobs_[item.object_id] = buffer;
   }
   return Status::OK();
 }
@@ -479,18 +1363,14 @@ Status Client::GetBufferSizes(const std::set<ObjectID>& ids,
     return Status::OK();
   }
   ENSURE_CONNECTED(this);
-  std::string message_out;
-  WriteGetBuffersRequest(ids, message_out);
-  RETURN_ON_ERROR(doWrite(message_out));
-  json message_in;
-  RETURN_ON_ERROR(doRead(message_in));
   std::vector<Payload> payloads;
-  RETURN_ON_ERROR(ReadGetBuffersReply(message_in, payloads));
+  RETURN_ON_ERROR(getBuffersImpl(ids, payloads));
+  RETURN_ON_ERROR(receiveFds(payloads));
   for (auto const& item : payloads) {
     uint8_t* shared = nullptr;
-    if (item.data_size > 0) {
-      VINEYARD_CHECK_OK(
-          mmapToClient(item.store_fd, item.map_size, true, true, &shared));
+    if (item.data_size > 0 && !item.IsDevice()) {
+      RETURN_ON_ERROR(mmapToClient(item.store_fd, item.map_size,
+                                   item.page_size, true, true, &shared));
     }
     sizes.emplace(item.object_id, item.data_size);
   }
@@ -500,11 +1380,18 @@ Status Client::GetBufferSizes(const std::set<ObjectID>& ids,
 Status Client::DropBuffer(const ObjectID id, const int fd) {
   ENSURE_CONNECTED(this);
 
-  // unmap from client
+  // unmap from client, the segment keeps mapped if it is shared by other
+  // clients in the process.
   auto entry = mmap_table_.find(fd);
   if (entry != mmap_table_.end()) {
     mmap_table_.erase(entry);
   }
+  auto device_entry = device_mappings_.find(id);
+  if (device_entry != device_mappings_.end()) {
+    VINEYARD_DISCARD(memory::cuda_ipc_close(device_entry->second));
+    device_mappings_.erase(device_entry);
+  }
+  mapped_blobs_.erase(id);
 
   // free on server
   std::string message_out;
@@ -516,17 +1403,63 @@ Status Client::DropBuffer(const ObjectID id, const int fd) {
   return Status::OK();
 }
 
-Status Client::mmapToClient(int fd, int64_t map_size, bool readonly,
-                            bool realign, uint8_t** ptr) {
+Status Client::receiveFds(const std::vector<Payload>& payloads) {
+  std::vector<int> fds;
+  std::set<int> pending;
+  for (auto const& payload : payloads) {
+    int fd = payload.store_fd;
+    if (payload.data_size > 0 && fd != -1 && !payload.IsDevice() &&
+        mmap_table_.find(fd) == mmap_table_.end() &&
+        received_fds_.find(fd) == received_fds_.end() &&
+        pending.emplace(fd).second) {
+      fds.emplace_back(fd);
+    }
+  }
+  if (fds.size() <= 1) {
+    // a single fd is received on demand in `mmapToClient`
+    return Status::OK();
+  }
+  std::vector<int> client_fds(fds.size());
+  if (recv_fds(vineyard_conn_, client_fds.data(), client_fds.size()) < 0) {
+    // the following messages on the socket cannot be parsed anymore
+    connected_ = false;
+    return Status::IOError(
+        "Failed to receieve file descriptors from the socket");
+  }
+  for (size_t idx = 0; idx < fds.size(); ++idx) {
+    received_fds_.emplace(fds[idx], client_fds[idx]);
+  }
+  return Status::OK();
+}
+
+Status Client::mmapToClient(int fd, int64_t map_size, int64_t page_size,
+                            bool readonly, bool realign, uint8_t** ptr) {
+  RETURN_ON_ASSERT(fd != -1, "Device blobs cannot be mapped as shared memory");
+  GetObjectProfile::Timer timer(GetObjectProfile::kMmap);
   auto entry = mmap_table_.find(fd);
   if (entry == mmap_table_.end()) {
-    int client_fd = recv_fd(vineyard_conn_);
-    if (fd <= 0) {
+    int client_fd = -1;
+    auto received = received_fds_.find(fd);
+    if (received != received_fds_.end()) {
+      client_fd = received->second;
+      received_fds_.erase(received);
+    } else {
+      client_fd = recv_fd(vineyard_conn_);
+    }
+    if (client_fd < 0) {
+      // the following messages on the socket cannot be parsed anymore
+      connected_ = false;
       return Status::IOError(
           "Failed to receieve file descriptor from the socket");
     }
-    auto mmap_entry = std::unique_ptr<MmapEntry>(
-        new MmapEntry(client_fd, map_size, readonly, realign));
+    auto mmap_entry = std::make_shared<MmapEntry>(
+        client_fd, map_size, page_size, readonly, realign, prefault_,
+        pin_memory_);
+    if (shared_mmap_table_) {
+      // reuses the mapping if the fd has been received by another client in
+      // the process, and the duplicated fd is closed with `mmap_entry`.
+      mmap_entry = shared_mmap_table_->Emplace(server_token_, fd, mmap_entry);
+    }
     entry = mmap_table_.emplace(fd, std::move(mmap_entry)).first;
   }
   if (readonly) {
@@ -543,6 +1476,83 @@ Status Client::mmapToClient(int fd, int64_t map_size, bool readonly,
   return Status::OK();
 }
 
-Client::~Client() { Disconnect(); }
+Status Client::mapDeviceBuffer(Payload const& payload, uint8_t** ptr) {
+  auto entry = device_mappings_.find(payload.object_id);
+  if (entry == device_mappings_.end()) {
+    void* pointer = nullptr;
+    RETURN_ON_ERROR(
+        memory::cuda_ipc_open(payload.device, payload.ipc_handle, &pointer));
+    entry = device_mappings_
+                .emplace(payload.object_id, reinterpret_cast<uint8_t*>(pointer))
+                .first;
+  }
+  *ptr = entry->second;
+  return Status::OK();
+}
+
+Status Client::EnableMetaCache(const size_t capacity) {
+  ENSURE_CONNECTED(this);
+  if (meta_cache_) {
+    return Status::OK();
+  }
+  std::unique_ptr<MetaCache> cache(new MetaCache(capacity));
+  RETURN_ON_ERROR(cache->Subscribe(ipc_socket_));
+  meta_cache_ = std::move(cache);
+  return Status::OK();
+}
+
+Status Client::connectAnother(int& conn) {
+  return connect_ipc_socket_retry(ipc_socket_, conn);
+}
+
+Status Client::GetName(const std::string& name, ObjectID& id,
+                       const bool wait) {
+  if (meta_cache_ && meta_cache_->GetName(name, id)) {
+    return Status::OK();
+  }
+  uint64_t const epoch = meta_cache_ ? meta_cache_->Epoch() : 0;
+  RETURN_ON_ERROR(ClientBase::GetName(name, id, wait));
+  if (meta_cache_) {
+    meta_cache_->PutName(name, id, epoch);
+  }
+  return Status::OK();
+}
+
+Status Client::DropName(const std::string& name) {
+  if (meta_cache_) {
+    meta_cache_->InvalidateNames({name});
+  }
+  return ClientBase::DropName(name);
+}
+
+Status Client::DropNames(const std::vector<std::string>& names) {
+  if (meta_cache_) {
+    meta_cache_->InvalidateNames(names);
+  }
+  return ClientBase::DropNames(names);
+}
+
+void Client::invalidateMetaData(const std::vector<ObjectID>& ids) {
+  if (meta_cache_) {
+    meta_cache_->Invalidate(ids);
+  }
+  for (auto const& id : ids) {
+    mapped_blobs_.erase(id);
+  }
+}
+
+Client::~Client() {
+  {
+    // the pages to be populated are unmapped with the client
+    std::lock_guard<std::mutex> lock(advise_mutex_);
+    for (auto& task : advising_) {
+      task.wait();
+    }
+  }
+  Disconnect();
+  for (auto const& item : device_mappings_) {
+    VINEYARD_DISCARD(memory::cuda_ipc_close(item.second));
+  }
+}
 
 }  // namespace vineyard
@@ -16,11 +16,14 @@ limitations under the License.
 #ifndef SRC_CLIENT_CLIENT_H_
 #define SRC_CLIENT_CLIENT_H_
 
+#include <future>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <set>
 #include <string>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "arrow/buffer.h"
@@ -29,6 +32,8 @@ limitations under the License.
 #include "client/client_base.h"
 #include "client/ds/i_object.h"
 #include "client/ds/object_meta.h"
+#include "client/meta_cache.h"
+#include "common/memory/blob_table.h"
 #include "common/memory/payload.h"
 #include "common/util/status.h"
 #include "common/util/uuid.h"
@@ -38,13 +43,30 @@ namespace vineyard {
 class Blob;
 class BlobWriter;
 
+/**
+ * @brief How the blobs of an object are going to be accessed, which is
+ * applied to the mapped pages by `madvise`, see also `Client::Advise`.
+ */
+enum class AccessHint {
+  normal = 0,
+  // aggressive read-ahead, the pages behind are dropped soon
+  sequential = 1,
+  // no read-ahead
+  random = 2,
+  // read ahead (e.g., from the page cache for file blobs) in background
+  willneed = 3,
+  // fault all pages in, i.e., populate the page tables
+  populate = 4,
+};
+
 /**
  * @brief MmapEntry represents a memory-mapped fd on the client side. The fd
  * can be mmapped as readonly or readwrite memory.
  */
 class MmapEntry {
  public:
-  MmapEntry(int fd, int64_t map_size, bool readonly, bool realign = false);
+  MmapEntry(int fd, int64_t map_size, int64_t page_size, bool readonly,
+            bool realign = false, bool prefault = false, bool pin = false);
 
   ~MmapEntry();
 
@@ -65,12 +87,62 @@ class MmapEntry {
   int fd() { return fd_; }
 
  private:
+  // registers the mapped pointer with `cudaHostRegister`, returns whether
+  // succeed.
+  bool pin(uint8_t* pointer, bool readonly);
+
   /// The associated file descriptor on the client.
   int fd_;
   /// The result of mmap for this file descriptor.
   uint8_t *ro_pointer_, *rw_pointer_;
   /// The length of the memory-mapped file.
   size_t length_;
+  /// Whether populate the page tables when mapping.
+  bool prefault_;
+  /// Whether page-lock the mapped segments for CUDA, and whether the mapped
+  /// pointers have been registered successfully.
+  bool pin_, ro_pinned_ = false, rw_pinned_ = false;
+  /// The entry may be shared by clients in different threads.
+  std::mutex mutex_;
+};
+
+/**
+ * @brief SharedMmapTable holds the fds that the process has received from a
+ * vineyard server. Clients in the same process that connect to the same
+ * server (e.g., by `Fork`) share the mapped segments, and the server won't
+ * send these fds again on the new connections.
+ *
+ * The table is enabled by `VINEYARD_SHARED_MMAP=1`.
+ */
+class SharedMmapTable {
+ public:
+  using entry_t = std::pair<int, std::shared_ptr<MmapEntry>>;
+
+  static std::shared_ptr<SharedMmapTable> Get(const std::string& ipc_socket);
+
+  /**
+   * @brief Get the fds (on the server side) that have been received, returns
+   * the token of the server that sent them.
+   */
+  uint64_t Snapshot(std::vector<entry_t>& entries) const;
+
+  /**
+   * @brief Drop the entries if they are received from another server (e.g.,
+   * the server has been restarted).
+   */
+  void Reset(const uint64_t server_token);
+
+  /**
+   * @brief Insert the entry of a newly received fd, returns the existing one
+   * if the fd has been received by other clients.
+   */
+  std::shared_ptr<MmapEntry> Emplace(const uint64_t server_token, const int fd,
+                                     std::shared_ptr<MmapEntry> const& entry);
+
+ private:
+  mutable std::mutex mutex_;
+  uint64_t server_token_ = 0;
+  std::unordered_map<int, std::shared_ptr<MmapEntry>> entries_;
 };
 
 /**
@@ -127,6 +199,24 @@ class Client : public ClientBase {
   Status GetMetaData(const ObjectID id, ObjectMeta& meta_data,
                      const bool sync_remote = false) override;
 
+  /**
+   * @brief Obtain metadata from vineyard server, in the lazy mode when `lazy`
+   * is true: only the object itself and its blobs are fetched, and the other
+   * members are fetched (and their blobs are mapped) on the first
+   * `GetMemberMeta` (or `GetMember`).
+   *
+   * @param id The object id to get.
+   * @param meta_data The result metadata will be store in `meta_data` as return
+   * value.
+   * @param sync_remote Whether to trigger an immediate remote metadata
+   *        synchronization before get specific metadata.
+   * @param lazy Whether to fetch the members on demand.
+   *
+   * @return Status that indicates whether the get action has succeeded.
+   */
+  Status GetMetaData(const ObjectID id, ObjectMeta& meta_data,
+                     const bool sync_remote, const bool lazy);
+
   /**
    * @brief Obtain multiple metadatas from vineyard server.
    *
@@ -141,6 +231,20 @@ class Client : public ClientBase {
   Status GetMetaData(const std::vector<ObjectID>& id, std::vector<ObjectMeta>&,
                      const bool sync_remote = false);
 
+  /**
+   * @brief Obtain multiple metadatas from the given snapshot, the objects are
+   * consistent with each other even if they are being updated or deleted
+   * concurrently, see also `CreateSnapshot`.
+   *
+   * @param ids The object ids to get.
+   * @param snapshot The snapshot to read from.
+   * @param metas The result metadatas.
+   *
+   * @return Status that indicates whether the get action has succeeded.
+   */
+  Status GetMetaData(const std::vector<ObjectID>& ids, const uint64_t snapshot,
+                     std::vector<ObjectMeta>& metas);
+
   /**
    * @brief Create a blob in vineyard server. When creating a blob, vineyard
    * server's bulk allocator will prepare a block of memory of the requested
@@ -153,6 +257,76 @@ class Client : public ClientBase {
    */
   Status CreateBlob(size_t size, std::unique_ptr<BlobWriter>& blob);
 
+  /**
+   * @brief Create a blob on the given NUMA node of the vineyard server's host.
+   * By default blobs are placed on the NUMA node that the client runs on.
+   *
+   * @param size The size of requested blob.
+   * @param numa_node The preferred NUMA node, -1 means the client's node.
+   * @param blob The result mutable blob will be set in `blob`.
+   *
+   * @return Status that indicates whether the create action has succeeded.
+   */
+  Status CreateBlob(size_t size, const int numa_node,
+                    std::unique_ptr<BlobWriter>& blob);
+
+  /**
+   * @brief Create a blob in the memory of the given CUDA device. The blob is
+   * shared with other clients on the same host through the CUDA IPC memory
+   * handle, the `data()` of the blob (and of the sealed blob that fetched by
+   * other clients) is a device pointer.
+   *
+   * @param size The size of requested blob.
+   * @param device The CUDA device.
+   * @param blob The result mutable blob will be set in `blob`.
+   *
+   * @return Status that indicates whether the create action has succeeded.
+   */
+  Status CreateDeviceBlob(size_t size, const int device,
+                          std::unique_ptr<BlobWriter>& blob);
+
+  /**
+   * @brief Create a batch of blobs in vineyard server with a single round
+   * trip. See also `CreateBlob`.
+   *
+   * @param sizes The sizes of requested blobs.
+   * @param blobs The result mutable blobs, in the same order as `sizes`.
+   *
+   * @return Status that indicates whether the create action has succeeded.
+   */
+  Status CreateBlobs(const std::vector<size_t>& sizes,
+                     std::vector<std::unique_ptr<BlobWriter>>& blobs);
+
+  /**
+   * @brief Create a blob with the content of the given blob, the content is
+   * copied inside the vineyard server, rather than being read and written
+   * through the client. The result blob can be modified and sealed as a new
+   * blob, the source blob is left untouched.
+   *
+   * @param source The blob to copy from.
+   * @param blob The result mutable blob will be set in `blob`.
+   *
+   * @return Status that indicates whether the copy action has succeeded.
+   */
+  Status CopyBlob(const ObjectID source, std::unique_ptr<BlobWriter>& blob);
+
+  /**
+   * @brief Create a blob from the range of a file without copying, the file
+   * is mapped by the vineyard server and the blob is backed by the page
+   * cache. The file must be readable by both the server and the calling
+   * process, and must not be modified while the blob is in use, truncating
+   * it raises SIGBUS on reading the blob.
+   *
+   * @param path The path of the file on the host of the vineyard server.
+   * @param offset The start of the range in the file.
+   * @param length The size of the range, -1 means the rest of the file.
+   * @param blob The result (sealed) blob will be set in `blob`.
+   *
+   * @return Status that indicates whether the create action has succeeded.
+   */
+  Status CreateBlobFromFile(const std::string& path, const size_t offset,
+                            const int64_t length, std::shared_ptr<Blob>& blob);
+
   /**
    * @brief Get a blob from vineyard server. When obtaining blobs from vineyard
    * server, the memory address in the server process will be mmapped to the
@@ -187,17 +361,46 @@ class Client : public ClientBase {
    */
   Status CreateStream(const ObjectID& id);
 
+  /**
+   * @brief Allocate a replayable stream on vineyard, the chunks that have
+   * been read are still kept within the given budget, and readers can reopen
+   * the stream at a chunk offset, see also `OpenStream`.
+   *
+   * @param id The id of metadata that will be used to create stream.
+   * @param retain_chunks The maximum number of read chunks to keep, 0 means
+   * unlimited.
+   * @param retain_bytes The maximum total size of read chunks to keep, 0
+   * means unlimited.
+   * @param budget_bytes The maximum total size of chunks that the stream
+   * holds, the producer waits when exceeding it. 0 means unlimited, the
+   * stream still shares the stream memory fairly with other streams.
+   *
+   * @return Status that indicates whether the create action has succeeded.
+   */
+  Status CreateStream(const ObjectID& id, size_t const retain_chunks,
+                      size_t const retain_bytes,
+                      size_t const budget_bytes = 0);
+
   /**
    * @brief open a stream on vineyard. Failed if the stream is already opened on
    * the given mode.
    *
    * @param id The id of stream to mark.
-   * @param mode The mode, OpenStreamMode::read or OpenStreamMode::write.
+   * @param mode The mode, OpenStreamMode::read or OpenStreamMode::write,
+   * or OpenStreamMode::broadcast to read as one of the many consumers.
    *
    * @return Status that indicates whether the open action has succeeded.
    */
   Status OpenStream(const ObjectID& id, OpenStreamMode mode);
 
+  /**
+   * @brief Open a stream for read, starting from the chunk at `offset`, i.e.,
+   * the number of chunks that sealed before it. The offset must be within
+   * the chunks that are still retained, e.g., for replayable streams.
+   */
+  Status OpenStream(const ObjectID& id, OpenStreamMode mode,
+                    int64_t const offset);
+
   /**
    * @brief Allocate a chunk of given size in vineyard for a stream. When the
    * request cannot be statisfied immediately, e.g., vineyard doesn't have
@@ -227,6 +430,75 @@ class Client : public ClientBase {
   Status PullNextStreamChunk(ObjectID const id,
                              std::unique_ptr<arrow::Buffer>& blob);
 
+  /**
+   * @brief The asynchronous version of `GetNextStreamChunk`, the `blob` must
+   * be kept alive until the returned future is ready.
+   */
+  std::future<Status> GetNextStreamChunkAsync(
+      ObjectID const id, size_t const size,
+      std::unique_ptr<arrow::MutableBuffer>& blob);
+
+  /**
+   * @brief The asynchronous version of `PullNextStreamChunk`, the `blob` must
+   * be kept alive until the returned future is ready.
+   *
+   * Note that the client is occupied while the request is pending, thus
+   * the writer of the stream shouldn't share the same client.
+   */
+  std::future<Status> PullNextStreamChunkAsync(
+      ObjectID const id, std::unique_ptr<arrow::Buffer>& blob);
+
+  /**
+   * @brief Allocate a window of chunks for a stream in a single round trip.
+   * The chunks that returned by the previous call are made available to the
+   * readers, and the returned ones are in-flight until the next call, or the
+   * stream being stopped.
+   *
+   * Requires the server supports the binary protocol.
+   *
+   * @param id The id of the stream.
+   * @param sizes The sizes of chunks to allocate.
+   * @param blobs The allocated mutable buffers, in the order of `sizes`.
+   *
+   * @return Status that indicates whether the allocation has succeeded.
+   */
+  Status GetNextStreamChunks(
+      ObjectID const id, std::vector<size_t> const& sizes,
+      std::vector<std::unique_ptr<arrow::MutableBuffer>>& blobs);
+
+  /**
+   * @brief Publish small chunks to a stream in a single round trip, the
+   * payloads are sent inline and copied into the chunks by the server. Blocked
+   * like `GetNextStreamChunk` when the stream has accumulated too many chunks.
+   *
+   * Requires the server supports the binary protocol.
+   *
+   * @param id The id of the stream.
+   * @param chunks The payloads of chunks, in the order of publishing.
+   *
+   * @return Status that indicates whether the publishing has succeeded.
+   */
+  Status PutStreamChunks(
+      ObjectID const id,
+      std::vector<std::shared_ptr<arrow::Buffer>> const& chunks);
+
+  /**
+   * @brief Poll at most `limit` ready chunks from a stream in a single round
+   * trip, with the payloads inline in the reply, thus the chunks can be
+   * released in vineyard at once. Blocked like `PullNextStreamChunk` when
+   * there's no ready chunk.
+   *
+   * Requires the server supports the binary protocol.
+   *
+   * @param id The id of the stream.
+   * @param limit The maximum number of chunks to poll.
+   * @param chunks The polled chunks, which are at least one.
+   *
+   * @return Status that indicates whether the polling has succeeded.
+   */
+  Status PullStreamChunks(ObjectID const id, size_t const limit,
+                          std::vector<std::shared_ptr<arrow::Buffer>>& chunks);
+
   /**
    * @brief Stop a stream, mark it as finished or aborted.
    *
@@ -262,6 +534,28 @@ class Client : public ClientBase {
    */
   Status GetObject(const ObjectID id, std::shared_ptr<Object>& object);
 
+  /**
+   * @brief Get an object from vineyard and advise the access pattern of its
+   * blobs, the pages are populated in background for `AccessHint::populate`.
+   * See also `Advise`.
+   */
+  Status GetObject(const ObjectID id, const AccessHint hint,
+                   std::shared_ptr<Object>& object);
+
+  /**
+   * @brief Advise the access pattern of the (mapped) blobs of the object,
+   * e.g., for avoiding the page faults on the first accesses (`populate`),
+   * or the useless read-ahead of random accesses (`random`). The blobs that
+   * haven't been fetched (e.g., of lazy members) are skipped.
+   *
+   * @param background Whether apply the hint in a background thread rather
+   * than waiting for the pages to be faulted in, only takes effects for
+   * `AccessHint::populate`. The blobs must not be dropped until it finishes,
+   * and the client waits for the pending ones before being destroyed.
+   */
+  Status Advise(const Object& object, const AccessHint hint,
+                const bool background = false);
+
   /**
    * @brief Get an object from vineyard. The type parameter `T` will be used to
    * resolve the constructor of the object.
@@ -317,6 +611,22 @@ class Client : public ClientBase {
   std::vector<std::shared_ptr<Object>> GetObjects(
       const std::vector<ObjectID>& ids);
 
+  /**
+   * @brief Get multiple objects from vineyard in a single round trip, the
+   * metadata, the blobs and the file descriptors are fetched together, and
+   * the objects are constructed in parallel.
+   *
+   * @param ids The object IDs to get.
+   * @param objects The result objects, in the same order of `ids`.
+   * @param sync_remote Whether trigger an immediate remote metadata
+   *        synchronization before get specific metadata. Default is true.
+   *
+   * @return Status that indicates whether the get action succeeds.
+   */
+  Status GetObjects(const std::vector<ObjectID>& ids,
+                    std::vector<std::shared_ptr<Object>>& objects,
+                    const bool sync_remote = true);
+
   /**
    * @brief List objects in vineyard, using the given typename patterns.
    *
@@ -345,10 +655,69 @@ class Client : public ClientBase {
   Status ReleaseArena(const int fd, std::vector<size_t> const& offsets,
                       std::vector<size_t> const& sizes);
 
+  /**
+   * @brief Make the given blocks of the arena available as blobs, and hand
+   * the unused ranges back to the server, while keeping the arena alive.
+   */
+  Status FlushArena(const int fd, std::vector<size_t> const& offsets,
+                    std::vector<size_t> const& sizes,
+                    std::vector<size_t> const& unused_offsets,
+                    std::vector<size_t> const& unused_sizes);
+
+  /**
+   * @brief Release the blobs of the given objects that have been mapped by
+   * this client, to allow the server spilling or evicting them when the shared
+   * memory is exhausted.
+   *
+   * The mapped buffers are still accessible after release, but their contents
+   * may be reclaimed by the server.
+   */
+  Status Release(std::vector<ObjectID> const& ids);
+
+  /**
+   * @brief Cache the metadata of objects on the client side, at most
+   * `capacity` objects in LRU order. The cached entries are invalidated by
+   * the notifications pushed from the server when the objects are deleted
+   * or persisted.
+   *
+   * The cache can also be enabled by the environment variable
+   * `VINEYARD_META_CACHE=<capacity>` when connecting.
+   */
+  Status EnableMetaCache(const size_t capacity = 1024);
+
+  /**
+   * @brief The metadata cache, nullptr if it is not enabled.
+   */
+  MetaCache* GetMetaCache() const { return meta_cache_.get(); }
+
+  /**
+   * @brief Resolve the name, from the metadata cache if it is enabled.
+   */
+  Status GetName(const std::string& name, ObjectID& id,
+                 const bool wait = false) override;
+
+  Status DropName(const std::string& name) override;
+
+  Status DropNames(const std::vector<std::string>& names) override;
+
  protected:
+  Status connectAnother(int& conn) override;
+
   Status CreateBuffer(const size_t size, ObjectID& id, Payload& payload,
+                      std::shared_ptr<arrow::MutableBuffer>& buffer,
+                      const int numa_node = -1);
+
+  Status CreateBuffers(
+      const std::vector<size_t>& sizes, std::vector<ObjectID>& ids,
+      std::vector<Payload>& payloads,
+      std::vector<std::shared_ptr<arrow::MutableBuffer>>& buffers);
+
+  Status ExtendBuffer(const ObjectID id, const size_t size, Payload& payload,
                       std::shared_ptr<arrow::MutableBuffer>& buffer);
 
+  Status CopyBuffer(const ObjectID source, ObjectID& id, Payload& payload,
+                    std::shared_ptr<arrow::MutableBuffer>& buffer);
+
   Status GetBuffer(const ObjectID id, std::shared_ptr<arrow::Buffer>& buffer);
 
   Status GetBuffers(
@@ -367,11 +736,88 @@ class Client : public ClientBase {
    */
   Status DropBuffer(const ObjectID id, const int fd);
 
+  void invalidateMetaData(const std::vector<ObjectID>& ids) override;
+
  private:
-  Status mmapToClient(int fd, int64_t map_size, bool readonly, bool realign,
-                      uint8_t** ptr);
+  /**
+   * @brief Switch the requests and replies to the shared memory ring.
+   */
+  Status enableRing();
+
+  // the capacity of each direction of the ring, in bytes
+  static constexpr size_t kRingCapacity = 1024 * 1024;
+
+  /**
+   * @brief Map the blob table of the server, see also `resolveBuffers`.
+   */
+  Status enableBlobTable();
+
+  /**
+   * @brief Resolve the blobs in the segments that have been mapped from the
+   * blob table, without a round trip. The unresolved ids are left in `ids`.
+   */
+  void resolveBuffers(
+      std::set<ObjectID>& ids,
+      std::map<ObjectID, std::shared_ptr<arrow::Buffer>>& buffers);
+
+  Status getBuffersImpl(const std::set<ObjectID>& ids,
+                        std::vector<Payload>& payloads);
+
+  /**
+   * @brief Fetch the metadata and the (local) blobs of the given objects in
+   * a single round trip.
+   */
+  Status getObjectsImpl(
+      const std::vector<ObjectID>& ids, const bool sync_remote,
+      std::unordered_map<ObjectID, json>& trees,
+      std::map<ObjectID, std::shared_ptr<arrow::Buffer>>& buffers);
+
+  Status mapBuffers(
+      const std::vector<Payload>& payloads,
+      std::map<ObjectID, std::shared_ptr<arrow::Buffer>>& buffers);
+
+  Status mmapToClient(int fd, int64_t map_size, int64_t page_size,
+                      bool readonly, bool realign, uint8_t** ptr);
+
+  // receives the fds of payloads that haven't been mapped in one go, must be
+  // invoked right after the reply, before `mmapToClient`.
+  Status receiveFds(const std::vector<Payload>& payloads);
+
+  // opens the IPC handle of device blobs, the mapping is kept until the
+  // client is destroyed.
+  Status mapDeviceBuffer(Payload const& payload, uint8_t** ptr);
+
+  std::unordered_map<int, std::shared_ptr<MmapEntry>> mmap_table_;
+  // fds that have been received by `receiveFds` but not mapped yet
+  std::unordered_map<int, int> received_fds_;
+
+  // the blobs that have been mapped by this client, they are pinned by the
+  // server until being released, see also `GetBuffers`.
+  std::unordered_map<ObjectID, std::shared_ptr<arrow::Buffer>> mapped_blobs_;
+
+  // the blob table mapped from the server, nullptr unless
+  // `VINEYARD_BLOB_TABLE` is set and the server enables it.
+  std::shared_ptr<BlobTable> blob_table_;
+
+  // the process-wide table, nullptr unless `VINEYARD_SHARED_MMAP` is set.
+  std::shared_ptr<SharedMmapTable> shared_mmap_table_;
+  uint64_t server_token_ = 0;
+  // whether pre-fault the mapped segments, see `VINEYARD_MMAP_PREFAULT`.
+  bool prefault_ = false;
+  // whether register the mapped segments as CUDA pinned host memory, see
+  // `VINEYARD_CUDA_HOST_REGISTER`.
+  bool pin_memory_ = false;
+
+  // device blob -> the device pointer opened from the IPC handle
+  std::unordered_map<ObjectID, uint8_t*> device_mappings_;
+
+  // the pages being populated in background, see also `Advise`
+  std::mutex advise_mutex_;
+  std::vector<std::future<void>> advising_;
 
-  std::unordered_map<int, std::unique_ptr<MmapEntry>> mmap_table_;
+  // should be destructed before the `mmap_table_`, as the cached metadata
+  // holds the mapped buffers.
+  std::unique_ptr<MetaCache> meta_cache_;
 
  private:
   friend class Blob;
@@ -15,7 +15,14 @@ limitations under the License.
 
 #include "client/client_base.h"
 
+#include <sys/socket.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <chrono>
 #include <future>
+#include <set>
+#include <thread>
 #include <utility>
 
 #include "boost/range/combine.hpp"
@@ -31,26 +38,26 @@ namespace vineyard {
 ClientBase::ClientBase() : connected_(false), vineyard_conn_(0) {}
 
 Status ClientBase::GetData(const ObjectID id, json& tree,
-                           const bool sync_remote, const bool wait) {
-  ENSURE_CONNECTED(this);
+                           const bool sync_remote, const bool wait,
+                           const bool lazy) {
+  ENSURE_CONNECTED_UNLOCKED(this);
   std::string message_out;
-  WriteGetDataRequest(id, sync_remote, wait, message_out);
-  RETURN_ON_ERROR(doWrite(message_out));
+  WriteGetDataRequest(std::vector<ObjectID>{id}, sync_remote, wait, lazy,
+                      message_out);
   json message_in;
-  RETURN_ON_ERROR(doRead(message_in));
+  RETURN_ON_ERROR(doRequest(message_out, message_in));
   RETURN_ON_ERROR(ReadGetDataReply(message_in, tree));
   return Status::OK();
 }
 
 Status ClientBase::GetData(const std::vector<ObjectID>& ids,
                            std::vector<json>& trees, const bool sync_remote,
-                           const bool wait) {
-  ENSURE_CONNECTED(this);
+                           const bool wait, const bool lazy) {
+  ENSURE_CONNECTED_UNLOCKED(this);
   std::string message_out;
-  WriteGetDataRequest(ids, sync_remote, wait, message_out);
-  RETURN_ON_ERROR(doWrite(message_out));
+  WriteGetDataRequest(ids, sync_remote, wait, lazy, message_out);
   json message_in;
-  RETURN_ON_ERROR(doRead(message_in));
+  RETURN_ON_ERROR(doRequest(message_out, message_in));
   std::unordered_map<ObjectID, json> meta_trees;
   RETURN_ON_ERROR(ReadGetDataReply(message_in, meta_trees));
   trees.reserve(ids.size());
@@ -60,19 +67,106 @@ Status ClientBase::GetData(const std::vector<ObjectID>& ids,
   return Status::OK();
 }
 
+Status ClientBase::GetData(const std::vector<ObjectID>& ids,
+                           const uint64_t snapshot, std::vector<json>& trees,
+                           const bool lazy) {
+  ENSURE_CONNECTED_UNLOCKED(this);
+  std::string message_out;
+  WriteGetDataRequest(ids, false, false, lazy, snapshot, message_out);
+  json message_in;
+  RETURN_ON_ERROR(doRequest(message_out, message_in));
+  std::unordered_map<ObjectID, json> meta_trees;
+  RETURN_ON_ERROR(ReadGetDataReply(message_in, meta_trees));
+  trees.clear();
+  trees.reserve(ids.size());
+  for (auto const& id : ids) {
+    auto tree = meta_trees.find(id);
+    if (tree == meta_trees.end()) {
+      return Status::ObjectNotExists("object " + ObjectIDToString(id) +
+                                     " doesn't exist in the snapshot");
+    }
+    trees.emplace_back(std::move(tree->second));
+  }
+  return Status::OK();
+}
+
+Status ClientBase::CreateSnapshot(uint64_t& snapshot, const bool sync_remote) {
+  ENSURE_CONNECTED_UNLOCKED(this);
+  std::string message_out;
+  WriteCreateSnapshotRequest(sync_remote, message_out);
+  json message_in;
+  RETURN_ON_ERROR(doRequest(message_out, message_in));
+  RETURN_ON_ERROR(ReadCreateSnapshotReply(message_in, snapshot));
+  return Status::OK();
+}
+
+Status ClientBase::ReleaseSnapshot(const uint64_t snapshot) {
+  ENSURE_CONNECTED_UNLOCKED(this);
+  std::string message_out;
+  WriteReleaseSnapshotRequest(snapshot, message_out);
+  json message_in;
+  RETURN_ON_ERROR(doRequest(message_out, message_in));
+  RETURN_ON_ERROR(ReadReleaseSnapshotReply(message_in));
+  return Status::OK();
+}
+
+size_t MetaBatch::CreateData(const ObjectMeta& meta) {
+  json op;
+  op["op"] = "create_data";
+  op["content"] = meta.MetaData();
+  ops_.push_back(op);
+  incomplete_ = incomplete_ || meta.incomplete();
+  return creations_++;
+}
+
+void MetaBatch::Persist(const ObjectID id) {
+  json op;
+  op["op"] = "persist";
+  op["object_id"] = id;
+  ops_.push_back(op);
+}
+
+void MetaBatch::PersistCreated(const size_t ref) {
+  json op;
+  op["op"] = "persist";
+  op["ref"] = ref;
+  ops_.push_back(op);
+}
+
+void MetaBatch::PutName(const ObjectID id, std::string const& name) {
+  json op;
+  op["op"] = "put_name";
+  op["object_id"] = id;
+  op["name"] = name;
+  ops_.push_back(op);
+}
+
+void MetaBatch::PutNameCreated(const size_t ref, std::string const& name) {
+  json op;
+  op["op"] = "put_name";
+  op["ref"] = ref;
+  op["name"] = name;
+  ops_.push_back(op);
+}
+
 Status ClientBase::CreateData(const json& tree, ObjectID& id,
-                              Signature& signature, InstanceID& instance_id) {
-  ENSURE_CONNECTED(this);
+                              Signature& signature, InstanceID& instance_id,
+                              const int64_t ttl) {
+  ENSURE_CONNECTED_UNLOCKED(this);
   std::string message_out;
-  WriteCreateDataRequest(tree, message_out);
-  RETURN_ON_ERROR(doWrite(message_out));
+  WriteCreateDataRequest(tree, ttl, message_out);
   json message_in;
-  RETURN_ON_ERROR(doRead(message_in));
+  RETURN_ON_ERROR(doRequest(message_out, message_in));
   RETURN_ON_ERROR(ReadCreateDataReply(message_in, id, signature, instance_id));
   return Status::OK();
 }
 
 Status ClientBase::CreateMetaData(ObjectMeta& meta_data, ObjectID& id) {
+  return CreateMetaData(meta_data, 0, id);
+}
+
+Status ClientBase::CreateMetaData(ObjectMeta& meta_data, const int64_t ttl,
+                                  ObjectID& id) {
   InstanceID instance_id = this->instance_id_;
   meta_data.SetInstanceId(instance_id);
   meta_data.AddKeyValue("transient", true);
@@ -85,7 +179,8 @@ Status ClientBase::CreateMetaData(ObjectMeta& meta_data, ObjectID& id) {
     VINEYARD_SUPPRESS(SyncMetaData());
   }
   Signature signature;
-  auto status = CreateData(meta_data.MetaData(), id, signature, instance_id);
+  auto status =
+      CreateData(meta_data.MetaData(), id, signature, instance_id, ttl);
   if (status.ok()) {
     meta_data.SetId(id);
     meta_data.SetSignature(signature);
@@ -102,6 +197,33 @@ Status ClientBase::CreateMetaData(ObjectMeta& meta_data, ObjectID& id) {
   return status;
 }
 
+Status ClientBase::CreateMetaData(ObjectMeta& meta_data, ObjectID& id,
+                                  const bool persist) {
+  if (!persist) {
+    return CreateMetaData(meta_data, id);
+  }
+  // the creating and persisting are applied as a single batch
+  MetaBatch batch;
+  batch.PersistCreated(batch.CreateData(meta_data));
+  std::vector<ObjectID> ids;
+  std::vector<Signature> signatures;
+  std::vector<InstanceID> instance_ids;
+  RETURN_ON_ERROR(Batch(batch, ids, signatures, instance_ids));
+  RETURN_ON_ASSERT(ids.size() == 1, "Unexpected reply of the batch request");
+  id = ids[0];
+  meta_data.SetId(id);
+  meta_data.SetSignature(signatures[0]);
+  meta_data.SetClient(this);
+  meta_data.SetInstanceId(instance_ids[0]);
+  meta_data.AddKeyValue("transient", false);
+  if (meta_data.incomplete()) {
+    ObjectMeta result_meta;
+    RETURN_ON_ERROR(this->GetMetaData(id, result_meta));
+    meta_data = result_meta;
+  }
+  return Status::OK();
+}
+
 Status ClientBase::SyncMetaData() {
   json __dummy;
   return GetData(InvalidObjectID(), __dummy, true, false);
@@ -109,25 +231,25 @@ Status ClientBase::SyncMetaData() {
 
 Status ClientBase::DelData(const ObjectID id, const bool force,
                            const bool deep) {
-  ENSURE_CONNECTED(this);
+  ENSURE_CONNECTED_UNLOCKED(this);
   std::string message_out;
   WriteDelDataRequest(id, force, deep, false, message_out);
-  RETURN_ON_ERROR(doWrite(message_out));
   json message_in;
-  RETURN_ON_ERROR(doRead(message_in));
+  RETURN_ON_ERROR(doRequest(message_out, message_in));
   RETURN_ON_ERROR(ReadDelDataReply(message_in));
+  invalidateMetaData({id});
   return Status::OK();
 }
 
 Status ClientBase::DelData(const std::vector<ObjectID>& ids, const bool force,
                            const bool deep) {
-  ENSURE_CONNECTED(this);
+  ENSURE_CONNECTED_UNLOCKED(this);
   std::string message_out;
   WriteDelDataRequest(ids, force, deep, false, message_out);
-  RETURN_ON_ERROR(doWrite(message_out));
   json message_in;
-  RETURN_ON_ERROR(doRead(message_in));
+  RETURN_ON_ERROR(doRequest(message_out, message_in));
   RETURN_ON_ERROR(ReadDelDataReply(message_in));
+  invalidateMetaData(ids);
   return Status::OK();
 }
 
@@ -144,58 +266,104 @@ Status ClientBase::ListData(std::string const& pattern, bool const regex,
   return Status::OK();
 }
 
+Status ClientBase::ListData(std::string const& pattern, bool const regex,
+                            std::string const& name_prefix,
+                            std::string const& cursor, size_t const limit,
+                            bool const brief, std::vector<json>& objects,
+                            std::string& next_cursor) {
+  ENSURE_CONNECTED_UNLOCKED(this);
+  std::string message_out;
+  WriteListObjectsRequest(pattern, regex, name_prefix, cursor, limit, brief,
+                          message_out);
+  json message_in;
+  RETURN_ON_ERROR(doRequest(message_out, message_in));
+  RETURN_ON_ERROR(ReadListObjectsReply(message_in, objects, next_cursor));
+  return Status::OK();
+}
+
 Status ClientBase::Persist(const ObjectID id) {
-  ENSURE_CONNECTED(this);
+  ENSURE_CONNECTED_UNLOCKED(this);
   std::string message_out;
   WritePersistRequest(id, message_out);
-  RETURN_ON_ERROR(doWrite(message_out));
   json message_in;
-  RETURN_ON_ERROR(doRead(message_in));
+  RETURN_ON_ERROR(doRequest(message_out, message_in));
   RETURN_ON_ERROR(ReadPersistReply(message_in));
+  invalidateMetaData({id});
+  return Status::OK();
+}
+
+Status ClientBase::PersistAsync(const ObjectID id, uint64_t& ticket) {
+  ENSURE_CONNECTED_UNLOCKED(this);
+  std::string message_out;
+  WritePersistRequest(id, true, message_out);
+  json message_in;
+  RETURN_ON_ERROR(doRequest(message_out, message_in));
+  RETURN_ON_ERROR(ReadPersistReply(message_in, ticket));
+  std::lock_guard<std::mutex> lock(persisting_mutex_);
+  persisting_.emplace_back(id);
   return Status::OK();
 }
 
+Status ClientBase::PersistAsync(const ObjectID id) {
+  uint64_t ticket = 0;
+  return PersistAsync(id, ticket);
+}
+
+Status ClientBase::WaitPersisted(const uint64_t ticket) {
+  ENSURE_CONNECTED_UNLOCKED(this);
+  std::string message_out;
+  WriteWaitPersistedRequest(ticket, message_out);
+  json message_in;
+  auto status = doRequest(message_out, message_in);
+  if (status.ok()) {
+    status = ReadWaitPersistedReply(message_in);
+  }
+  std::vector<ObjectID> persisted;
+  {
+    std::lock_guard<std::mutex> lock(persisting_mutex_);
+    persisted.swap(persisting_);
+  }
+  invalidateMetaData(persisted);
+  return status;
+}
+
 Status ClientBase::IfPersist(const ObjectID id, bool& persist) {
-  ENSURE_CONNECTED(this);
+  ENSURE_CONNECTED_UNLOCKED(this);
   std::string message_out;
   WriteIfPersistRequest(id, message_out);
-  RETURN_ON_ERROR(doWrite(message_out));
   json message_in;
-  RETURN_ON_ERROR(doRead(message_in));
+  RETURN_ON_ERROR(doRequest(message_out, message_in));
   RETURN_ON_ERROR(ReadIfPersistReply(message_in, persist));
   return Status::OK();
 }
 
 Status ClientBase::Exists(const ObjectID id, bool& exists) {
-  ENSURE_CONNECTED(this);
+  ENSURE_CONNECTED_UNLOCKED(this);
   std::string message_out;
   WriteExistsRequest(id, message_out);
-  RETURN_ON_ERROR(doWrite(message_out));
   json message_in;
-  RETURN_ON_ERROR(doRead(message_in));
+  RETURN_ON_ERROR(doRequest(message_out, message_in));
   RETURN_ON_ERROR(ReadExistsReply(message_in, exists));
   return Status::OK();
 }
 
 Status ClientBase::ShallowCopy(const ObjectID id, ObjectID& target_id) {
-  ENSURE_CONNECTED(this);
+  ENSURE_CONNECTED_UNLOCKED(this);
   std::string message_out;
   WriteShallowCopyRequest(id, message_out);
-  RETURN_ON_ERROR(doWrite(message_out));
   json message_in;
-  RETURN_ON_ERROR(doRead(message_in));
+  RETURN_ON_ERROR(doRequest(message_out, message_in));
   RETURN_ON_ERROR(ReadShallowCopyReply(message_in, target_id));
   return Status::OK();
 }
 
 Status ClientBase::ShallowCopy(const ObjectID id, json const& extra_metadata,
                                ObjectID& target_id) {
-  ENSURE_CONNECTED(this);
+  ENSURE_CONNECTED_UNLOCKED(this);
   std::string message_out;
   WriteShallowCopyRequest(id, extra_metadata, message_out);
-  RETURN_ON_ERROR(doWrite(message_out));
   json message_in;
-  RETURN_ON_ERROR(doRead(message_in));
+  RETURN_ON_ERROR(doRequest(message_out, message_in));
   RETURN_ON_ERROR(ReadShallowCopyReply(message_in, target_id));
   return Status::OK();
 }
@@ -235,40 +403,116 @@ Status ClientBase::deepCopyImpl(const ObjectID object_id, ObjectID& target_id,
   return Status::OK();
 }
 
-Status ClientBase::PutName(const ObjectID id, std::string const& name) {
-  ENSURE_CONNECTED(this);
+Status ClientBase::PutName(const ObjectID id, std::string const& name,
+                           const int64_t ttl) {
+  ENSURE_CONNECTED_UNLOCKED(this);
   std::string message_out;
-  WritePutNameRequest(id, name, message_out);
-  RETURN_ON_ERROR(doWrite(message_out));
+  WritePutNameRequest(id, name, ttl, message_out);
   json message_in;
-  RETURN_ON_ERROR(doRead(message_in));
+  RETURN_ON_ERROR(doRequest(message_out, message_in));
   RETURN_ON_ERROR(ReadPutNameReply(message_in));
   return Status::OK();
 }
 
 Status ClientBase::GetName(const std::string& name, ObjectID& id,
                            const bool wait) {
-  ENSURE_CONNECTED(this);
+  ENSURE_CONNECTED_UNLOCKED(this);
   std::string message_out;
   WriteGetNameRequest(name, wait, message_out);
-  RETURN_ON_ERROR(doWrite(message_out));
   json message_in;
-  RETURN_ON_ERROR(doRead(message_in));
+  RETURN_ON_ERROR(doRequest(message_out, message_in));
   RETURN_ON_ERROR(ReadGetNameReply(message_in, id));
   return Status::OK();
 }
 
 Status ClientBase::DropName(const std::string& name) {
-  ENSURE_CONNECTED(this);
+  ENSURE_CONNECTED_UNLOCKED(this);
   std::string message_out;
   WriteDropNameRequest(name, message_out);
-  RETURN_ON_ERROR(doWrite(message_out));
   json message_in;
-  RETURN_ON_ERROR(doRead(message_in));
+  RETURN_ON_ERROR(doRequest(message_out, message_in));
   RETURN_ON_ERROR(ReadDropNameReply(message_in));
   return Status::OK();
 }
 
+Status ClientBase::PutNames(const std::map<std::string, ObjectID>& names) {
+  ENSURE_CONNECTED_UNLOCKED(this);
+  std::string message_out;
+  WritePutNamesRequest(names, message_out);
+  json message_in;
+  RETURN_ON_ERROR(doRequest(message_out, message_in));
+  RETURN_ON_ERROR(ReadPutNamesReply(message_in));
+  return Status::OK();
+}
+
+Status ClientBase::GetNames(const std::vector<std::string>& names,
+                            std::map<std::string, ObjectID>& ids) {
+  return GetNames(names, 0, ids);
+}
+
+Status ClientBase::GetNames(const std::vector<std::string>& names,
+                            const uint64_t snapshot,
+                            std::map<std::string, ObjectID>& ids) {
+  ENSURE_CONNECTED_UNLOCKED(this);
+  std::string message_out;
+  WriteGetNamesRequest(names, snapshot, message_out);
+  json message_in;
+  RETURN_ON_ERROR(doRequest(message_out, message_in));
+  RETURN_ON_ERROR(ReadGetNamesReply(message_in, ids));
+  return Status::OK();
+}
+
+Status ClientBase::DropNames(const std::vector<std::string>& names) {
+  ENSURE_CONNECTED_UNLOCKED(this);
+  std::string message_out;
+  WriteDropNamesRequest(names, message_out);
+  json message_in;
+  RETURN_ON_ERROR(doRequest(message_out, message_in));
+  RETURN_ON_ERROR(ReadDropNamesReply(message_in));
+  return Status::OK();
+}
+
+Status ClientBase::Batch(const MetaBatch& batch, std::vector<ObjectID>& ids) {
+  std::vector<Signature> signatures;
+  std::vector<InstanceID> instance_ids;
+  return Batch(batch, ids, signatures, instance_ids);
+}
+
+Status ClientBase::Batch(const MetaBatch& batch, std::vector<ObjectID>& ids,
+                         std::vector<Signature>& signatures,
+                         std::vector<InstanceID>& instance_ids) {
+  ENSURE_CONNECTED_UNLOCKED(this);
+  if (batch.Empty()) {
+    return Status::OK();
+  }
+  // decorate the metadata to be created in the same way as `CreateMetaData`
+  json ops = batch.ops_;
+  for (auto& op : ops) {
+    if (op["op"] != "create_data") {
+      continue;
+    }
+    json& content = op["content"];
+    content["instance_id"] = this->instance_id_;
+    content["transient"] = true;
+    if (!content.contains("nbytes")) {
+      content["nbytes"] = 0;
+    }
+  }
+  // if the metadata has incomplete components, trigger an remote meta sync.
+  if (batch.incomplete_) {
+    VINEYARD_SUPPRESS(SyncMetaData());
+  }
+  std::string message_out;
+  WriteBatchRequest(ops, message_out);
+  json message_in;
+  RETURN_ON_ERROR(doRequest(message_out, message_in));
+  ids.clear();
+  signatures.clear();
+  instance_ids.clear();
+  RETURN_ON_ERROR(ReadBatchReply(message_in, ids, signatures, instance_ids));
+  return Status::OK();
+}
+
 Status ClientBase::MigrateStream(const ObjectID stream_id,
                                  ObjectID& result_id) {
   return MigrateObject(stream_id, result_id, true);
@@ -284,15 +528,310 @@ Status ClientBase::MigrateObject(const ObjectID object_id, ObjectID& result_id,
   VLOG(10) << "migrate local: " << this->instance_id()
            << ", remote: " << meta.GetInstanceId();
   if (meta.GetInstanceId() == this->instance_id()) {
-    result_id = object_id;
+    // the object itself, or its local replica
+    result_id = meta.GetId();
     return Status::OK();
   }
 
   // findout remote server
   std::map<InstanceID, json> cluster;
   RETURN_ON_ERROR(this->ClusterInfo(cluster));
-  auto selfhost =
-      cluster.at(this->instance_id())["hostname"].get_ref<std::string const&>();
+  return migrateObjectTo(meta, *this, this->instance_id(), cluster, is_stream,
+                         result_id);
+}
+
+Status ClientBase::Replicate(const ObjectID object_id,
+                             const std::vector<InstanceID>& instances,
+                             std::map<InstanceID, ObjectID>& replicas) {
+  ENSURE_CONNECTED(this);
+  RETURN_ON_ASSERT(!IsBlob(object_id), "The blobs cannot be replicated");
+  ObjectMeta meta;
+  RETURN_ON_ERROR(this->GetMetaData(object_id, meta, true));
+  std::map<InstanceID, json> cluster;
+  RETURN_ON_ERROR(this->ClusterInfo(cluster));
+  for (auto const instance_id : instances) {
+    if (instance_id == meta.GetInstanceId()) {
+      replicas[instance_id] = meta.GetId();
+      continue;
+    }
+    auto target = cluster.find(instance_id);
+    if (target == cluster.end()) {
+      return Status::Invalid("Instance " + std::to_string(instance_id) +
+                             " doesn't exist in the cluster");
+    }
+    RPCClient receiver;
+    RETURN_ON_ERROR(receiver.Connect(
+        target->second["rpc_endpoint"].get_ref<std::string const&>()));
+    ObjectMeta existing;
+    RETURN_ON_ERROR(receiver.GetMetaData(object_id, existing, true));
+    if (existing.GetInstanceId() == instance_id) {
+      // has already been replicated
+      replicas[instance_id] = existing.GetId();
+      continue;
+    }
+    ObjectID replica_id = InvalidObjectID();
+    RETURN_ON_ERROR(migrateObjectTo(meta, receiver, instance_id, cluster,
+                                    false, replica_id));
+    replicas[instance_id] = replica_id;
+  }
+  return Status::OK();
+}
+
+Status ClientBase::Migrate(const std::map<ObjectID, InstanceID>& placement,
+                           std::map<ObjectID, ObjectID>& results,
+                           const MigrationOptions& options) {
+  ENSURE_CONNECTED(this);
+  RETURN_ON_ASSERT(
+      options.parallelism > 0 && options.parallelism_per_instance > 0,
+      "The parallelism of migration must be positive");
+  std::map<InstanceID, json> cluster;
+  RETURN_ON_ERROR(this->ClusterInfo(cluster));
+  VINEYARD_SUPPRESS(this->SyncMetaData());
+
+  struct transfer_t {
+    ObjectMeta meta;
+    InstanceID target;
+    std::string source_host;
+    size_t nbytes;
+    ObjectID result;
+    bool transferred;
+  };
+  std::vector<transfer_t> transfers;
+  results.clear();
+  for (auto const& kv : placement) {
+    RETURN_ON_ASSERT(!IsBlob(kv.first), "The blobs cannot be migrated");
+    if (cluster.find(kv.second) == cluster.end()) {
+      return Status::Invalid("Instance " + std::to_string(kv.second) +
+                             " doesn't exist in the cluster");
+    }
+    ObjectMeta meta;
+    RETURN_ON_ERROR(this->GetMetaData(kv.first, meta, false));
+    if (meta.GetInstanceId() == kv.second) {
+      results[kv.first] = meta.GetId();
+      continue;
+    }
+    auto source = cluster.find(meta.GetInstanceId());
+    if (source == cluster.end()) {
+      return Status::Invalid("The instance of object " +
+                             ObjectIDToString(kv.first) +
+                             " doesn't exist in the cluster");
+    }
+    transfers.emplace_back(transfer_t{
+        meta, kv.second, source->second["hostname"].get<std::string>(),
+        meta.GetNBytes(), InvalidObjectID(), false});
+  }
+  // the larger transfers first, to shorten the tail of the schedule
+  std::stable_sort(transfers.begin(), transfers.end(),
+                   [](transfer_t const& lhs, transfer_t const& rhs) {
+                     return lhs.nbytes > rhs.nbytes;
+                   });
+
+  std::mutex mutex;
+  std::condition_variable cv;
+  std::vector<bool> started(transfers.size(), false);
+  // the migration server listens on a fixed port, thus a source host can
+  // serve only one transfer at a time.
+  std::set<std::string> sending;
+  std::map<InstanceID, size_t> receiving;
+  size_t admitted_bytes = 0;
+  Status failure;
+  auto const begin = std::chrono::steady_clock::now();
+
+  auto transfer = [&](transfer_t& item) -> Status {
+    RPCClient receiver;
+    RETURN_ON_ERROR(receiver.Connect(
+        cluster.at(item.target)["rpc_endpoint"].get_ref<std::string const&>()));
+    ObjectMeta existing;
+    RETURN_ON_ERROR(receiver.GetMetaData(item.meta.GetId(), existing, true));
+    if (existing.GetInstanceId() == item.target) {
+      // has already been replicated
+      item.result = existing.GetId();
+      return Status::OK();
+    }
+    RETURN_ON_ERROR(migrateObjectTo(item.meta, receiver, item.target, cluster,
+                                    false, item.result));
+    item.transferred = true;
+    return Status::OK();
+  };
+
+  auto worker = [&]() {
+    while (true) {
+      size_t index = transfers.size();
+      std::chrono::steady_clock::time_point admission;
+      {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true) {
+          if (!failure.ok()) {
+            return;
+          }
+          bool pending = false;
+          for (size_t i = 0; i < transfers.size(); ++i) {
+            if (started[i]) {
+              continue;
+            }
+            pending = true;
+            auto const& item = transfers[i];
+            if (sending.find(item.source_host) == sending.end() &&
+                receiving[item.target] < options.parallelism_per_instance) {
+              index = i;
+              break;
+            }
+          }
+          if (!pending) {
+            return;
+          }
+          if (index != transfers.size()) {
+            break;
+          }
+          cv.wait(lock);
+        }
+        auto& item = transfers[index];
+        started[index] = true;
+        sending.emplace(item.source_host);
+        receiving[item.target] += 1;
+        // pace the starts of transfers by the bytes admitted so far
+        admission = begin;
+        if (options.bandwidth > 0) {
+          admission += std::chrono::microseconds(static_cast<int64_t>(
+              static_cast<double>(admitted_bytes) / options.bandwidth * 1e6));
+        }
+        admitted_bytes += item.nbytes;
+      }
+      std::this_thread::sleep_until(admission);
+
+      auto& item = transfers[index];
+      Status status = transfer(item);
+      VLOG(10) << "migrate " << ObjectIDToString(item.meta.GetId()) << " to "
+               << item.target << ": " << status.ToString();
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        sending.erase(item.source_host);
+        receiving[item.target] -= 1;
+        if (!status.ok() && failure.ok()) {
+          failure = status;
+        }
+      }
+      cv.notify_all();
+    }
+  };
+
+  std::vector<std::thread> workers;
+  for (size_t i = 0; i < std::min(options.parallelism, transfers.size());
+       ++i) {
+    workers.emplace_back(worker);
+  }
+  for (auto& thread : workers) {
+    thread.join();
+  }
+  RETURN_ON_ERROR(failure);
+
+  // the migrated objects are persisted in one batch per target instance
+  std::map<InstanceID, MetaBatch> batches;
+  for (auto const& item : transfers) {
+    results[item.meta.GetId()] = item.result;
+    if (options.persist && item.transferred) {
+      batches[item.target].Persist(item.result);
+    }
+  }
+  for (auto const& kv : batches) {
+    std::vector<ObjectID> created;
+    if (kv.first == this->instance_id()) {
+      RETURN_ON_ERROR(this->Batch(kv.second, created));
+      continue;
+    }
+    RPCClient receiver;
+    RETURN_ON_ERROR(receiver.Connect(
+        cluster.at(kv.first)["rpc_endpoint"].get_ref<std::string const&>()));
+    RETURN_ON_ERROR(receiver.Batch(kv.second, created));
+  }
+  return Status::OK();
+}
+
+Status ClientBase::Prefetch(const std::vector<ObjectID>& ids,
+                            const InstanceID target_instance, size_t& nbytes) {
+  ENSURE_CONNECTED(this);
+  if (target_instance != UnspecifiedInstanceID() &&
+      target_instance != this->instance_id()) {
+    std::map<InstanceID, json> cluster;
+    RETURN_ON_ERROR(this->ClusterInfo(cluster));
+    auto target = cluster.find(target_instance);
+    if (target == cluster.end()) {
+      return Status::Invalid("Instance " + std::to_string(target_instance) +
+                             " doesn't exist in the cluster");
+    }
+    RPCClient receiver;
+    RETURN_ON_ERROR(receiver.Connect(
+        target->second["rpc_endpoint"].get_ref<std::string const&>()));
+    return receiver.Prefetch(ids, nbytes);
+  }
+
+  // the replicas are equivalents of the objects on this instance, and only
+  // the local chunks of global objects are prefetched.
+  std::vector<ObjectID> local_ids;
+  for (auto const& id : ids) {
+    if (IsBlob(id)) {
+      local_ids.emplace_back(id);
+      continue;
+    }
+    ObjectMeta meta;
+    RETURN_ON_ERROR(this->GetMetaData(id, meta, true));
+    if (meta.IsGlobal() || meta.GetInstanceId() == this->instance_id()) {
+      local_ids.emplace_back(id);
+      continue;
+    }
+    std::map<InstanceID, ObjectID> replicas;
+    RETURN_ON_ERROR(Replicate(id, {this->instance_id()}, replicas));
+    local_ids.emplace_back(replicas.at(this->instance_id()));
+  }
+
+  std::string message_out;
+  WritePrefetchRequest(local_ids, message_out);
+  RETURN_ON_ERROR(doWrite(message_out));
+  json message_in;
+  RETURN_ON_ERROR(doRead(message_in));
+  RETURN_ON_ERROR(ReadPrefetchReply(message_in, nbytes));
+  return Status::OK();
+}
+
+Status ClientBase::Prefetch(const std::vector<ObjectID>& ids, size_t& nbytes) {
+  return Prefetch(ids, UnspecifiedInstanceID(), nbytes);
+}
+
+Status ClientBase::Footprints(const std::vector<ObjectID>& ids,
+                              const size_t limit,
+                              std::vector<ObjectFootprint>& objects,
+                              std::map<std::string, TypeFootprint>& types) {
+  ENSURE_CONNECTED(this);
+  std::string message_out;
+  WriteFootprintsRequest(ids, limit, message_out);
+  RETURN_ON_ERROR(doWrite(message_out));
+  json message_in;
+  RETURN_ON_ERROR(doRead(message_in));
+  json footprints;
+  RETURN_ON_ERROR(ReadFootprintsReply(message_in, footprints));
+  objects.clear();
+  for (auto const& item : footprints["objects"]) {
+    objects.emplace_back(ObjectFootprint{
+        item["id"].get<ObjectID>(),
+        item["typename"].get_ref<std::string const&>(),
+        item["size"].get<size_t>()});
+  }
+  types.clear();
+  for (auto const& item : footprints["types"].items()) {
+    types[item.key()] = TypeFootprint{item.value()["objects"].get<size_t>(),
+                                      item.value()["size"].get<size_t>()};
+  }
+  return Status::OK();
+}
+
+Status ClientBase::migrateObjectTo(const ObjectMeta& meta,
+                                   ClientBase& receiver,
+                                   InstanceID const receiver_instance_id,
+                                   std::map<InstanceID, json> const& cluster,
+                                   bool const is_stream, ObjectID& result_id) {
+  ObjectID const object_id = meta.GetId();
+  auto selfhost = cluster.at(receiver_instance_id)["hostname"]
+                      .get_ref<std::string const&>();
   auto otherHost = cluster.at(meta.GetInstanceId())["hostname"]
                        .get_ref<std::string const&>();
   auto otherEndpoint = cluster.at(meta.GetInstanceId())["rpc_endpoint"]
@@ -309,15 +848,15 @@ Status ClientBase::MigrateObject(const ObjectID object_id, ObjectID& result_id,
   });
 
   // local migrate receiver
-  auto receiver = std::async(std::launch::async, [&]() -> Status {
-    RETURN_ON_ERROR(this->migrateObjectImpl(
+  auto local = std::async(std::launch::async, [&]() -> Status {
+    RETURN_ON_ERROR(receiver.migrateObjectImpl(
         object_id, result_id, false, is_stream, otherHost, otherEndpoint));
     VLOG(10) << "receive from migration: " << VYObjectIDToString(object_id)
              << " -> " << VYObjectIDToString(result_id);
     return Status::OK();
   });
 
-  return sender.get() & receiver.get();
+  return sender.get() & local.get();
 }
 
 Status ClientBase::migrateObjectImpl(const ObjectID object_id,
@@ -344,6 +883,17 @@ bool ClientBase::Connected() const {
 }
 
 void ClientBase::Disconnect() {
+  {
+    // the pending asynchronous requests still refer to the connection, and
+    // may block forever, e.g., prefetching a stream that won't be finished.
+    std::lock_guard<std::mutex> lock(async_mutex_);
+    if (async_tail_.valid() &&
+        async_tail_.wait_for(std::chrono::seconds(0)) !=
+            std::future_status::ready) {
+      shutdown(vineyard_conn_, SHUT_RDWR);
+      async_tail_.wait();
+    }
+  }
   std::lock_guard<std::recursive_mutex> __guard(this->client_mutex_);
   if (!this->connected_) {
     return;
@@ -352,11 +902,39 @@ void ClientBase::Disconnect() {
   WriteExitRequest(message_out);
   VINEYARD_SUPPRESS(doWrite(message_out));
   close(vineyard_conn_);
+  ring_.reset();
   connected_ = false;
+  if (dump_profile_ && profile_) {
+    LOG(INFO) << "The costs of GetObject:" << std::endl
+              << profile_->ToString();
+  }
+}
+
+void ClientBase::EnableProfiling() {
+  if (!profile_) {
+    profile_.reset(new GetObjectProfile());
+  }
+}
+
+void ClientBase::enableProfilingFromEnv() {
+  if (const char* env_p = std::getenv("VINEYARD_CLIENT_PROFILE")) {
+    std::string flag(env_p);
+    if (flag == "1" || flag == "true") {
+      EnableProfiling();
+      dump_profile_ = true;
+    }
+  }
 }
 
 Status ClientBase::doWrite(const std::string& message_out) {
-  auto status = send_message(vineyard_conn_, message_out);
+  Status status;
+  if (ring_) {
+    int conn = vineyard_conn_;
+    status = ring_->requests().WriteMessage(
+        message_out, [conn]() { return !peer_closed(conn); });
+  } else {
+    status = send_message(vineyard_conn_, message_out);
+  }
   if (!status.ok()) {
     connected_ = false;
   }
@@ -364,12 +942,20 @@ Status ClientBase::doWrite(const std::string& message_out) {
 }
 
 Status ClientBase::doRead(std::string& message_in) {
-  return recv_message(vineyard_conn_, message_in);
+  while (true) {
+    RETURN_ON_ERROR(recvMessage(message_in));
+    uint64_t request_id = 0;
+    if (!ReadRequestID(message_in, request_id)) {
+      return Status::OK();
+    }
+    // the reply of a pipelined request issued before this one
+    deliverReply(request_id, std::move(message_in));
+  }
 }
 
 Status ClientBase::doRead(json& root) {
   std::string message_in;
-  auto status = recv_message(vineyard_conn_, message_in);
+  auto status = doRead(message_in);
   if (!status.ok()) {
     connected_ = false;
     return status;
@@ -384,6 +970,141 @@ Status ClientBase::doRead(json& root) {
   return status;
 }
 
+Status ClientBase::doRequest(const std::string& message_out,
+                             json& message_in) {
+  if (!pipelining_) {
+    std::lock_guard<std::recursive_mutex> __guard(this->client_mutex_);
+    RETURN_ON_ERROR(doWrite(message_out));
+    return doRead(message_in);
+  }
+  const uint64_t request_id = next_request_id_.fetch_add(1);
+  std::string request = message_out;
+  TagRequestID(request_id, request);
+  {
+    // the requests won't be interleaved with the unpipelined ones, which may
+    // transfer fds or raw buffers after the reply.
+    std::lock_guard<std::recursive_mutex> __guard(this->client_mutex_);
+    RETURN_ON_ERROR(doWrite(request));
+  }
+  std::string reply;
+  RETURN_ON_ERROR(waitReply(request_id, reply));
+  auto status = CATCH_JSON_ERROR([&]() -> Status {
+    message_in = json::parse(reply);
+    return Status::OK();
+  }());
+  if (!status.ok()) {
+    connected_ = false;
+  }
+  return status;
+}
+
+Status ClientBase::recvMessage(std::string& message_in) {
+  if (ring_) {
+    int conn = vineyard_conn_;
+    return ring_->replies().ReadMessage(
+        message_in, [conn]() { return !peer_closed(conn); });
+  }
+  return recv_message(vineyard_conn_, message_in);
+}
+
+void ClientBase::deliverReply(const uint64_t request_id,
+                              std::string&& message_in) {
+  std::lock_guard<std::mutex> lock(pipeline_mutex_);
+  pipeline_replies_[request_id] = std::move(message_in);
+  pipeline_cv_.notify_all();
+}
+
+Status ClientBase::waitReply(const uint64_t request_id,
+                             std::string& message_in) {
+  std::unique_lock<std::mutex> lock(pipeline_mutex_);
+  while (true) {
+    auto iter = pipeline_replies_.find(request_id);
+    if (iter != pipeline_replies_.end()) {
+      message_in = std::move(iter->second);
+      pipeline_replies_.erase(iter);
+      return Status::OK();
+    }
+    if (!connected_) {
+      return Status::ConnectionError("Client is not connected");
+    }
+    bool const reading = pipeline_reading_;
+    if (reading) {
+      // waits for the reader to hand over the reply, unless the client is
+      // held by the current thread (i.e., the request is issued inside a
+      // locked section), where the reader cannot proceed until we return.
+      if (!client_mutex_.try_lock()) {
+        pipeline_cv_.wait(lock);
+        continue;
+      }
+      client_mutex_.unlock();
+    } else {
+      // reads the replies on behalf of all waiting requests
+      pipeline_reading_ = true;
+    }
+    lock.unlock();
+    auto status = readPipelined(request_id);
+    lock.lock();
+    if (!reading) {
+      pipeline_reading_ = false;
+      pipeline_cv_.notify_all();
+    }
+    RETURN_ON_ERROR(status);
+  }
+}
+
+Status ClientBase::readPipelined(const uint64_t request_id) {
+  // all reads from the connection happen with the client locked, thus the
+  // reply is still pending if it hasn't been delivered yet, and the blocking
+  // read below will return.
+  std::lock_guard<std::recursive_mutex> __guard(this->client_mutex_);
+  if (!connected_) {
+    return Status::ConnectionError("Client is not connected");
+  }
+  {
+    std::lock_guard<std::mutex> lock(pipeline_mutex_);
+    if (pipeline_replies_.find(request_id) != pipeline_replies_.end()) {
+      // has been received by others
+      return Status::OK();
+    }
+  }
+  std::string message_in;
+  auto status = recvMessage(message_in);
+  if (!status.ok()) {
+    connected_ = false;
+    return status;
+  }
+  uint64_t request_id_in = 0;
+  if (ReadRequestID(message_in, request_id_in)) {
+    deliverReply(request_id_in, std::move(message_in));
+  } else {
+    LOG(WARNING) << "Drop the unexpected message on a pipelined connection";
+  }
+  return Status::OK();
+}
+
+std::future<Status> ClientBase::doAsync(std::function<Status()> request) {
+  std::lock_guard<std::mutex> lock(async_mutex_);
+  auto previous = async_tail_;
+  auto done = std::make_shared<std::promise<void>>();
+  async_tail_ = done->get_future().share();
+  return std::async(std::launch::async, [previous, done, request]() {
+    if (previous.valid()) {
+      previous.wait();
+    }
+    Status status;
+    try {
+      status = request();
+    } catch (...) {
+      // releases the following requests, and forwards the exception to the
+      // returned future.
+      done->set_value();
+      throw;
+    }
+    done->set_value();
+    return status;
+  });
+}
+
 Status ClientBase::ClusterInfo(std::map<InstanceID, json>& meta) {
   ENSURE_CONNECTED(this);
   std::string message_out;
@@ -401,14 +1122,33 @@ Status ClientBase::ClusterInfo(std::map<InstanceID, json>& meta) {
   return Status::OK();
 }
 
-Status ClientBase::InstanceStatus(
-    std::shared_ptr<struct InstanceStatus>& status) {
+Status ClientBase::LocalityInfo(const ObjectID id,
+                                std::map<InstanceID, size_t>& locality,
+                                const bool sync_remote) {
   ENSURE_CONNECTED(this);
   std::string message_out;
-  WriteInstanceStatusRequest(message_out);
+  WriteLocalityInfoRequest(id, sync_remote, message_out);
   RETURN_ON_ERROR(doWrite(message_out));
   json message_in;
   RETURN_ON_ERROR(doRead(message_in));
+  json result;
+  RETURN_ON_ERROR(ReadLocalityInfoReply(message_in, result));
+  locality.clear();
+  for (auto& kv : json::iterator_wrapper(result)) {
+    InstanceID instance_id = UnspecifiedInstanceID();
+    std::stringstream(kv.key().substr(1)) >> instance_id;
+    locality[instance_id] = kv.value().get<size_t>();
+  }
+  return Status::OK();
+}
+
+Status ClientBase::InstanceStatus(
+    std::shared_ptr<struct InstanceStatus>& status) {
+  ENSURE_CONNECTED_UNLOCKED(this);
+  std::string message_out;
+  WriteInstanceStatusRequest(message_out);
+  json message_in;
+  RETURN_ON_ERROR(doRequest(message_out, message_in));
   json status_json;
   RETURN_ON_ERROR(ReadInstanceStatusReply(message_in, status_json));
   status.reset(new struct InstanceStatus(status_json));
@@ -443,11 +1183,42 @@ Status ClientBase::Debug(const json& debug, json& result) {
   return Status::OK();
 }
 
+Status ClientBase::SubscribeObjects(
+    const ObjectFilter& filter, ObjectSubscription::callback_t callback,
+    std::unique_ptr<ObjectSubscription>& subscription) {
+  ENSURE_CONNECTED(this);
+  int conn = -1;
+  RETURN_ON_ERROR(connectAnother(conn));
+  std::unique_ptr<ObjectSubscription> target(
+      new ObjectSubscription(filter, callback));
+  RETURN_ON_ERROR(target->Subscribe(conn));
+  subscription = std::move(target);
+  return Status::OK();
+}
+
 InstanceStatus::InstanceStatus(const json& tree)
     : instance_id(tree["instance_id"].get<InstanceID>()),
       deployment(tree["deployment"].get_ref<const std::string&>()),
       memory_usage(tree["memory_usage"].get<size_t>()),
       memory_limit(tree["memory_limit"].get<size_t>()),
+      spilled_objects(tree.value("spilled_objects", 0)),
+      spilled_size(tree.value("spilled_size", 0)),
+      uploaded_objects(tree.value("uploaded_objects", 0)),
+      hydrated_objects(tree.value("hydrated_objects", 0)),
+      snapshot_objects(tree.value("snapshot_objects", 0)),
+      small_blobs(tree.value("small_blobs", 0)),
+      small_blobs_size(tree.value("small_blobs_size", 0)),
+      small_blobs_capacity(tree.value("small_blobs_capacity", 0)),
+      free_size(tree.value("free_size", 0)),
+      free_blocks(tree.value("free_blocks", 0)),
+      largest_free_size(tree.value("largest_free_size", 0)),
+      relocated_objects(tree.value("relocated_objects", 0)),
+      relocated_size(tree.value("relocated_size", 0)),
+      prefaulted_size(tree.value("prefaulted_size", 0)),
+      prefault_size(tree.value("prefault_size", 0)),
+      deduplicated_objects(tree.value("deduplicated_objects", 0)),
+      deduplicated_size(tree.value("deduplicated_size", 0)),
+      dedup_ratio(tree.value("dedup_ratio", 1.0)),
       deferred_requests(tree["deferred_requests"].get<size_t>()),
       ipc_connections(tree["ipc_connections"].get<size_t>()),
       rpc_connections(tree["rpc_connections"].get<size_t>()) {}
@@ -17,6 +17,10 @@ limitations under the License.
 #define SRC_CLIENT_CLIENT_BASE_H_
 
 #include <sys/mman.h>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <future>
 #include <map>
 #include <memory>
 #include <mutex>
@@ -25,6 +29,9 @@ limitations under the License.
 #include <vector>
 
 #include "client/ds/object_meta.h"
+#include "client/profile.h"
+#include "client/subscription.h"
+#include "common/memory/ring_buffer.h"
 #include "common/util/boost.h"
 #include "common/util/status.h"
 #include "common/util/uuid.h"
@@ -33,6 +40,54 @@ limitations under the License.
 namespace vineyard {
 
 struct InstanceStatus;
+struct ObjectFootprint;
+struct TypeFootprint;
+
+/**
+ * @brief MetaBatch collects the creating, persisting and naming of objects,
+ * to be applied by `ClientBase::Batch` with all-or-nothing semantics.
+ *
+ * The ids of objects created in the batch are unknown before the batch is
+ * applied, the later ops refer them by the index returned by `CreateData`.
+ */
+class MetaBatch {
+ public:
+  size_t CreateData(const ObjectMeta& meta);
+
+  void Persist(const ObjectID id);
+
+  void PersistCreated(const size_t ref);
+
+  void PutName(const ObjectID id, std::string const& name);
+
+  void PutNameCreated(const size_t ref, std::string const& name);
+
+  size_t Creations() const { return creations_; }
+
+  bool Empty() const { return ops_.empty(); }
+
+ private:
+  json ops_ = json::array();
+  size_t creations_ = 0;
+  bool incomplete_ = false;
+
+  friend class ClientBase;
+};
+
+/**
+ * @brief MigrationOptions controls how `ClientBase::Migrate` schedules the
+ * transfers of a placement.
+ */
+struct MigrationOptions {
+  // the transfers in flight across the cluster
+  size_t parallelism = 4;
+  // the transfers in flight that are received by the same instance
+  size_t parallelism_per_instance = 2;
+  // the bytes per second admitted to start transferring, 0 means unlimited
+  size_t bandwidth = 0;
+  // persist the migrated objects (in a batch per target instance)
+  bool persist = true;
+};
 
 /**
  * @brief ClientBase is the base class for vineyard IPC and RPC client.
@@ -61,11 +116,13 @@ class ClientBase {
    *        synchronization before get specific metadata. Default is false.
    * @param wait The request could be blocked util the object with given id has
    *        been created on vineyard by other clients. Default is false.
+   * @param lazy Whether to return the members (except blobs) as shallow stubs
+   *        rather than the whole tree. Default is false.
    *
    * @return Status that indicates whether the get action succeeds.
    */
   Status GetData(const ObjectID id, json& tree, const bool sync_remote = false,
-                 const bool wait = false);
+                 const bool wait = false, const bool lazy = false);
 
   /**
    * @brief Get multiple object metadatas from vineyard using given object IDs.
@@ -76,11 +133,53 @@ class ClientBase {
    *        synchronization before get specific metadata. Default is false.
    * @param wait The request could be blocked util the object with given id has
    *        been created on vineyard by other clients. Default is false.
+   * @param lazy Whether to return the members (except blobs) as shallow stubs
+   *        rather than the whole tree. Default is false.
    *
    * @return Status that indicates whether the get action has succeeded.
    */
   Status GetData(const std::vector<ObjectID>& ids, std::vector<json>& trees,
-                 const bool sync_remote = false, const bool wait = false);
+                 const bool sync_remote = false, const bool wait = false,
+                 const bool lazy = false);
+
+  /**
+   * @brief Get multiple object metadatas from the given snapshot, see also
+   * `CreateSnapshot`.
+   *
+   * @param ids The IDs of the requested objects
+   * @param snapshot The snapshot to read from.
+   * @param trees The returned metadata trees of the requested objects
+   * @param lazy Whether to return the members (except blobs) as shallow stubs
+   *        rather than the whole tree. Default is false.
+   *
+   * @return Status that indicates whether the get action has succeeded, or
+   * ObjectNotExists if any object doesn't exist in the snapshot.
+   */
+  Status GetData(const std::vector<ObjectID>& ids, const uint64_t snapshot,
+                 std::vector<json>& trees, const bool lazy = false);
+
+  /**
+   * @brief Take a snapshot of the metadata in the vineyard server, the reads
+   * from the snapshot observe the objects and names as of the same moment,
+   * regardless of the concurrent updates.
+   *
+   * The blobs of the objects that are deleted after the snapshot is taken
+   * are kept until the snapshot is released, thus the snapshot should be
+   * released as soon as possible. The snapshots are released when the client
+   * disconnects as well.
+   *
+   * @param snapshot The returned snapshot.
+   * @param sync_remote Whether to synchronize the metadata with the metadata
+   *        service before taking the snapshot. Default is false.
+   *
+   * @return Status that indicates whether the snapshot has been taken.
+   */
+  Status CreateSnapshot(uint64_t& snapshot, const bool sync_remote = false);
+
+  /**
+   * @brief Release the snapshot that has been taken by this client.
+   */
+  Status ReleaseSnapshot(const uint64_t snapshot);
 
   /**
    * @brief Create the metadata in the vineyard server.
@@ -89,11 +188,13 @@ class ClientBase {
    * @param id The returned object ID of the created data.
    * @param instance_id The vineyard instance ID where this object is created.
    * at.
+   * @param ttl The object will be deleted by the server after `ttl` seconds,
+   * unless its blobs are still in use, 0 means never.
    *
    * @return Status that indicates whether the create action has succeeded.
    */
   Status CreateData(const json& tree, ObjectID& id, Signature& signature,
-                    InstanceID& instance_id);
+                    InstanceID& instance_id, const int64_t ttl = 0);
 
   /**
    * @brief Create the metadata in the vineyard server, after created, the
@@ -106,6 +207,23 @@ class ClientBase {
    */
   Status CreateMetaData(ObjectMeta& meta_data, ObjectID& id);
 
+  /**
+   * @brief Create the metadata that expires after `ttl` seconds, see also
+   * `CreateData`.
+   */
+  Status CreateMetaData(ObjectMeta& meta_data, const int64_t ttl,
+                        ObjectID& id);
+
+  /**
+   * @brief Create the metadata and persist it in a single request when
+   * `persist` is true, see also `Persist`.
+   *
+   * All transient local members of the metadata are persisted along with
+   * it, in the same metadata commit.
+   */
+  Status CreateMetaData(ObjectMeta& meta_data, ObjectID& id,
+                        const bool persist);
+
   /**
    * @brief Get the meta-data of the requested object
    *
@@ -175,16 +293,63 @@ class ClientBase {
                   size_t const limit,
                   std::unordered_map<ObjectID, json>& meta_trees);
 
+  /**
+   * @brief List a page of objects whose typename matches the pattern, to
+   * enumerate a large number of objects without a huge reply.
+   *
+   * @param name_prefix When not empty, only the named objects whose names
+   * start with the prefix (e.g., "namespace/") are listed, in the order of
+   * names.
+   * @param cursor Where the page starts, empty for the first page.
+   * @param limit The number limit of objects in the page.
+   * @param brief Whether only returns the "id", "typename" and "name" (if
+   * any) of objects, otherwise the metadata is returned as "meta" as well.
+   * @param objects The objects in the page.
+   * @param next_cursor The cursor of the next page, empty if there are no
+   * more objects.
+   *
+   * @return Status that indicates whether the list action has succeeded.
+   */
+  Status ListData(std::string const& pattern, bool const regex,
+                  std::string const& name_prefix, std::string const& cursor,
+                  size_t const limit, bool const brief,
+                  std::vector<json>& objects, std::string& next_cursor);
+
   /**
    * @brief Persist the given object to etcd to make it visible to clients that
    * been connected to vineyard servers in the cluster.
    *
+   * The transient local members of the object are persisted as well, in a
+   * single metadata commit, there's no need to persist them one by one.
+   *
    * @param id The object id of object that will be persisted.
    *
    * @return Status that indicates whether the persist action has succeeded.
    */
   Status Persist(const ObjectID id);
 
+  /**
+   * @brief Persist the object in the background, the request returns once
+   * the persisting has been queued by the vineyard server, and is committed
+   * to etcd along with other pending requests.
+   *
+   * @param id The object id of object that will be persisted.
+   * @param ticket The handle of the persisting, see also `WaitPersisted`.
+   *
+   * @return Status that indicates whether the persisting has been queued.
+   */
+  Status PersistAsync(const ObjectID id, uint64_t& ticket);
+
+  Status PersistAsync(const ObjectID id);
+
+  /**
+   * @brief Wait until the asynchronous persisting up to the given ticket (or
+   * all the issued ones if the ticket is 0) have been committed.
+   *
+   * @return Status of the first failed persisting since the last wait, if any.
+   */
+  Status WaitPersisted(const uint64_t ticket = 0);
+
   /**
    * @brief Check if the given object has been persist to etcd.
    *
@@ -255,10 +420,12 @@ class ClientBase {
    * @param id The ID of the object.
    * @param name The user-specific name that will be associated with the given
    * object.
+   * @param ttl The name will be dropped after `ttl` seconds, 0 means never.
    *
    * @return Status that indicates whether the request has succeeded.
    */
-  Status PutName(const ObjectID id, std::string const& name);
+  Status PutName(const ObjectID id, std::string const& name,
+                 const int64_t ttl = 0);
 
   /**
    * @brief Retrieve the object ID by assoicated name.
@@ -270,8 +437,8 @@ class ClientBase {
    *
    * @return Status that indicates whether the query has succeeded.
    */
-  Status GetName(const std::string& name, ObjectID& id,
-                 const bool wait = false);
+  virtual Status GetName(const std::string& name, ObjectID& id,
+                         const bool wait = false);
 
   /**
    * @brief Deregister a name entry. The assoicated object will be kept and
@@ -281,7 +448,62 @@ class ClientBase {
    *
    * @return Status that indicates whether the query has succeeded.
    */
-  Status DropName(const std::string& name);
+  virtual Status DropName(const std::string& name);
+
+  /**
+   * @brief Register the names in a single request, which is committed to
+   * the metadata service as a whole.
+   *
+   * @param names The names and the associated object ids.
+   *
+   * @return Status that indicates whether the request has succeeded.
+   */
+  Status PutNames(const std::map<std::string, ObjectID>& names);
+
+  /**
+   * @brief Resolve the names in a single request, the names that don't exist
+   * are absent in `ids`.
+   *
+   * @param names The names of the requested objects.
+   * @param ids The resolved object ids.
+   *
+   * @return Status that indicates whether the query has succeeded.
+   */
+  Status GetNames(const std::vector<std::string>& names,
+                  std::map<std::string, ObjectID>& ids);
+
+  /**
+   * @brief Resolve the names in the given snapshot, see also `CreateSnapshot`.
+   */
+  Status GetNames(const std::vector<std::string>& names,
+                  const uint64_t snapshot,
+                  std::map<std::string, ObjectID>& ids);
+
+  /**
+   * @brief Deregister the names in a single request, the names that don't
+   * exist are ignored.
+   *
+   * @param names The names that will be deregistered.
+   *
+   * @return Status that indicates whether the request has succeeded.
+   */
+  virtual Status DropNames(const std::vector<std::string>& names);
+
+  /**
+   * @brief Apply the creating, persisting and naming in the batch as a
+   * whole, either all of them take effect, or none of them does.
+   *
+   * @param batch The ops to apply.
+   * @param ids The ids of the objects created in the batch, in the order of
+   * the `CreateData` calls.
+   *
+   * @return Status that indicates whether the batch has been applied.
+   */
+  Status Batch(const MetaBatch& batch, std::vector<ObjectID>& ids);
+
+  Status Batch(const MetaBatch& batch, std::vector<ObjectID>& ids,
+               std::vector<Signature>& signatures,
+               std::vector<InstanceID>& instance_ids);
 
   /**
    * @brief Migrate remote object to local.
@@ -296,6 +518,64 @@ class ClientBase {
   Status MigrateObject(const ObjectID object_id, ObjectID& result_id,
                        bool is_stream = false);
 
+  /**
+   * @brief Replicate the object to the given instances, i.e., deep copy the
+   * object (and its blobs) from the instance where it locates to the peers.
+   *
+   * The replicas have the same signature as the object, and become its
+   * equivalents, the requests that get the object on these instances will
+   * be resolved to the local replicas.
+   *
+   * @param object_id The existing object that will be replicated.
+   * @param instances The instances where the replicas will be placed, the
+   * instance where the object locates will be skipped.
+   * @param replicas Record the replica on every of the given instances.
+   *
+   * @return Status that indicates if the replication success.
+   */
+  Status Replicate(const ObjectID object_id,
+                   const std::vector<InstanceID>& instances,
+                   std::map<InstanceID, ObjectID>& replicas);
+
+  /**
+   * @brief Migrate a set of objects to the instances given by the placement,
+   * e.g., rebalancing the fragments of a fragment group.
+   *
+   * The transfers are executed in parallel, the larger ones first, and a new
+   * transfer starts as soon as a slot becomes free. A source host serves at
+   * most one transfer at a time since the migration server listens on a
+   * fixed port. The migrated objects are persisted in one batch per target
+   * instance after all transfers have finished.
+   *
+   * @param placement The target instance of every object, the objects that
+   * already locate (or have a replica) on the target are not transferred.
+   * @param results Record the migrated object of every object.
+   * @param options Limits the parallelism and the bandwidth.
+   *
+   * @return Status that indicates if all the migrations success.
+   */
+  Status Migrate(const std::map<ObjectID, InstanceID>& placement,
+                 std::map<ObjectID, ObjectID>& results,
+                 const MigrationOptions& options = MigrationOptions());
+
+  /**
+   * @brief Warm up the objects on the given instance ahead of the jobs that
+   * read them: the remote objects are replicated to the instance, then the
+   * instance stages their blobs in memory (reloading the spilled ones) and
+   * pre-faults the pages, thus the later `GetObject` calls are local hits.
+   *
+   * @param ids The objects (or blobs that local to the instance).
+   * @param target_instance The instance to prefetch to, defaults to the
+   * connected instance.
+   * @param nbytes Record the bytes that have been prefetched.
+   *
+   * @return Status that indicates if the prefetch success.
+   */
+  Status Prefetch(const std::vector<ObjectID>& ids,
+                  const InstanceID target_instance, size_t& nbytes);
+
+  Status Prefetch(const std::vector<ObjectID>& ids, size_t& nbytes);
+
   /**
    * @brief Migrate remote stream to local.
    *
@@ -353,6 +633,20 @@ class ClientBase {
    */
   Status ClusterInfo(std::map<InstanceID, json>& meta);
 
+  /**
+   * @brief Retrieve how many bytes of the given (global) object live on each
+   * instance, aggregated from the metadata of its blobs on the server side,
+   * without fetching the metadata of every chunk.
+   *
+   * @param id The object id.
+   * @param locality The bytes of the object on each instance.
+   * @param sync_remote Whether to sync the metadata from etcd first.
+   *
+   * @return Status that indicates whether the query has succeeded.
+   */
+  Status LocalityInfo(const ObjectID id, std::map<InstanceID, size_t>& locality,
+                      const bool sync_remote = true);
+
   /**
    * @brief Return the status of connected vineyard instance.
    *
@@ -365,6 +659,26 @@ class ClientBase {
    */
   Status InstanceStatus(std::shared_ptr<struct InstanceStatus>& status);
 
+  /**
+   * @brief Query the shared memory taken by the objects on the connected
+   * instance, in a single request.
+   *
+   * The footprint of an object is the total size of its distinct local blobs,
+   * which is computed by the server when the object is created.
+   *
+   * @param ids The objects to query, the unknown ones (e.g., the objects on
+   * other instances) are skipped. If empty, the `limit` largest objects (all
+   * objects if `limit` is 0) are returned, in descending order of sizes.
+   * @param objects The footprints of objects.
+   * @param types The number of objects and the total footprints of every
+   * typename.
+   *
+   * @return Status that indicates whether the query has succeeded.
+   */
+  Status Footprints(const std::vector<ObjectID>& ids, const size_t limit,
+                    std::vector<ObjectFootprint>& objects,
+                    std::map<std::string, TypeFootprint>& types);
+
   /**
    * @brief List all instances in the connected vineyard cluster.
    *
@@ -385,6 +699,18 @@ class ClientBase {
   /**
    * @brief Issue a debug request.
    *
+   * The handler inspects the running server without disrupting it, the
+   * payload may contain:
+   *
+   *   - "traces": {"limit": n}, the latest traces of requests.
+   *   - "allocator": {"options": "...", "chunks": bool}, the statistics of
+   *     the shared memory allocator.
+   *   - "connections": true, the states of the IPC connections.
+   *   - "streams": true, the states and queue depths of the streams.
+   *   - "profile": {"seconds": n, "frequency": hz}, samples the CPU profile
+   *     of the server for n seconds, the request blocks until the profiling
+   *     finishes.
+   *
    * @param debug The payload that will be sent to the debug handler.
    * @param result The result that returned by the debug handler.
    *
@@ -392,6 +718,40 @@ class ClientBase {
    */
   Status Debug(const json& debug, json& tree);
 
+  /**
+   * @brief Subscribe the objects that are created (or persisted) anywhere in
+   * the cluster, or have been given names, and match the filter.
+   *
+   * The events are received on a dedicated connection to the same server,
+   * and the callback is invoked on a background thread until the returned
+   * subscription is destructed.
+   *
+   * @param filter The conditions of the subscribed objects.
+   * @param callback The callback that will be invoked for every event.
+   * @param subscription The returned subscription.
+   *
+   * @return Status that indicates whether the subscription succeeds.
+   */
+  Status SubscribeObjects(const ObjectFilter& filter,
+                          ObjectSubscription::callback_t callback,
+                          std::unique_ptr<ObjectSubscription>& subscription);
+
+  /**
+   * @brief Time the phases of `GetObject` (fetching the metadata and the
+   * blobs, mapping, creating and constructing the object) per type name,
+   * see also `GetObjectProfile`.
+   *
+   * The profiling can also be enabled by the environment variable
+   * `VINEYARD_CLIENT_PROFILE=1` when connecting, and then the costs are
+   * logged when disconnecting.
+   */
+  void EnableProfiling();
+
+  /**
+   * @brief The costs of `GetObject`, nullptr if profiling is not enabled.
+   */
+  GetObjectProfile* GetProfile() const { return profile_.get(); }
+
  protected:
   Status doWrite(const std::string& message_out);
 
@@ -399,11 +759,38 @@ class ClientBase {
 
   Status doRead(json& root);
 
+  /**
+   * @brief Issue a request and wait for the reply.
+   *
+   * When pipelining is enabled (by the environment variable
+   * `VINEYARD_PIPELINING`), the request is tagged with a request id and the
+   * client is only locked while writing, thus requests from multiple threads
+   * can be in flight on the same connection, and the replies are matched by
+   * the ids. Requests that transfer fds or raw buffers are not pipelined.
+   */
+  Status doRequest(const std::string& message_out, json& message_in);
+
+  /**
+   * @brief Issue the request on a background thread. The requests that are
+   * submitted asynchronously by the same client are issued in order, and
+   * other requests wait for the in-flight one since the client is locked.
+   */
+  std::future<Status> doAsync(std::function<Status()> request);
+
   /**
    * @brief Implementation for migrate remote object to local.
    *
    * @return Status that indicates if the migration success.
    */
+  /**
+   * @brief Migrate the object to the instance that the receiver connects to,
+   * the receiver can be this client itself.
+   */
+  Status migrateObjectTo(const ObjectMeta& meta, ClientBase& receiver,
+                         InstanceID const receiver_instance_id,
+                         std::map<InstanceID, json> const& cluster,
+                         bool const is_stream, ObjectID& result_id);
+
   Status migrateObjectImpl(const ObjectID object_id, ObjectID& result_id,
                            bool const local, bool const is_stream,
                            std::string const& peer,
@@ -413,6 +800,35 @@ class ClientBase {
                       std::string const& peer,
                       std::string const& peer_rpc_endpoint);
 
+  /**
+   * @brief Invoked after the metadata of the objects has been changed or
+   * deleted by this client, for clients that cache the metadata.
+   */
+  virtual void invalidateMetaData(const std::vector<ObjectID>& ids) {}
+
+  /**
+   * @brief Open another connection to the connected server, for the
+   * connections that receive the pushed notifications.
+   */
+  virtual Status connectAnother(int& conn) {
+    return Status::NotImplemented("Cannot open another connection");
+  }
+
+  // reads a message from the socket (or the ring) as is.
+  Status recvMessage(std::string& message_in);
+
+  // hands over the reply to the pipelined request that waits for it.
+  void deliverReply(const uint64_t request_id, std::string&& message_in);
+
+  Status waitReply(const uint64_t request_id, std::string& message_in);
+
+  // reads a reply of pipelined requests with the client locked, unless the
+  // reply of the given request has been received by others.
+  Status readPipelined(const uint64_t request_id);
+
+  // see `VINEYARD_CLIENT_PROFILE` in `EnableProfiling`
+  void enableProfilingFromEnv();
+
   mutable bool connected_;
   std::string ipc_socket_;
   std::string rpc_endpoint_;
@@ -420,8 +836,43 @@ class ClientBase {
   InstanceID instance_id_;
   std::string server_version_;
 
+  // Whether to use the binary protocol for hot-path commands, see also
+  // "common/util/binary_protocols.h".
+  bool binary_protocol_ = false;
+
+  // Whether the server accepts binary messages, the batched stream commands
+  // are only available in the binary protocol.
+  bool binary_protocol_supported_ = false;
+
+  // The shared memory ring for requests and replies, the socket is only used
+  // for receiving fds when the ring is enabled.
+  std::shared_ptr<RingChannel> ring_;
+
   // A mutex which protects the client.
   std::recursive_mutex client_mutex_;
+
+  // The objects that are being persisted asynchronously, their cached
+  // metadata is invalidated by `WaitPersisted`.
+  std::mutex persisting_mutex_;
+  std::vector<ObjectID> persisting_;
+
+  // The last submitted asynchronous request, see also `doAsync`.
+  std::mutex async_mutex_;
+  std::shared_future<void> async_tail_;
+
+  // Pipelined requests, see also `doRequest`.
+  bool pipelining_ = false;
+  std::atomic<uint64_t> next_request_id_{1};
+  std::mutex pipeline_mutex_;
+  std::condition_variable pipeline_cv_;
+  // the replies that haven't been taken by the requests
+  std::unordered_map<uint64_t, std::string> pipeline_replies_;
+  // whether a request is reading replies on behalf of others
+  bool pipeline_reading_ = false;
+
+  // The costs of `GetObject`, see also `EnableProfiling`.
+  std::unique_ptr<GetObjectProfile> profile_;
+  bool dump_profile_ = false;
 };
 
 struct InstanceStatus {
@@ -433,6 +884,43 @@ struct InstanceStatus {
   const size_t memory_usage;
   /// The memory upper bound of this vineyard server, in bytes.
   const size_t memory_limit;
+  /// How many blobs have been spilled to disk.
+  const size_t spilled_objects;
+  /// The total size of blobs that have been spilled to disk, in bytes.
+  const size_t spilled_size;
+  /// How many persisted blobs have been written to the backing store.
+  const size_t uploaded_objects;
+  /// How many blobs have been loaded back from the backing store.
+  const size_t hydrated_objects;
+  /// How many blobs have been mapped from the snapshot on start.
+  const size_t snapshot_objects;
+  /// How many small blobs are served by the slabs.
+  const size_t small_blobs;
+  /// The total size of small blobs, in bytes.
+  const size_t small_blobs_size;
+  /// The total size of slabs for small blobs, in bytes, the gap to
+  /// `small_blobs_size` is the internal fragmentation.
+  const size_t small_blobs_capacity;
+  /// The free space inside the shared memory, in bytes.
+  const size_t free_size;
+  /// How many free blocks the free space is fragmented into.
+  const size_t free_blocks;
+  /// The largest blob that can be created without spilling, in bytes.
+  const size_t largest_free_size;
+  /// How many blobs have been relocated for defragmentation.
+  const size_t relocated_objects;
+  /// The total size of relocated blobs, in bytes.
+  const size_t relocated_size;
+  /// How much of the shared memory has been pre-faulted, in bytes.
+  const size_t prefaulted_size;
+  /// The size of shared memory to pre-fault, 0 if not requested.
+  const size_t prefault_size;
+  /// How many blobs have been remapped to the payloads of identical content.
+  const size_t deduplicated_objects;
+  /// The shared memory saved by deduplication, in bytes.
+  const size_t deduplicated_size;
+  /// The logical size of blobs over the memory usage, 1.0 means no savings.
+  const double dedup_ratio;
   /// How many requests are deferred in the queue.
   const size_t deferred_requests;
   /// How many Client connects to this vineyard server.
@@ -449,6 +937,21 @@ struct InstanceStatus {
   explicit InstanceStatus(const json& tree);
 };
 
+struct ObjectFootprint {
+  ObjectID id;
+  std::string type_name;
+  /// The total size of the distinct local blobs of the object, in bytes.
+  size_t size;
+};
+
+struct TypeFootprint {
+  /// How many objects of the typename are on the instance.
+  size_t objects;
+  /// The total footprints of the objects, the blobs shared by several
+  /// objects are counted in every of them.
+  size_t size;
+};
+
 }  // namespace vineyard
 
 #endif  // SRC_CLIENT_CLIENT_BASE_H_
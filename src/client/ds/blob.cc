@@ -162,6 +162,20 @@ const std::shared_ptr<arrow::MutableBuffer>& BlobWriter::Buffer() const {
   return buffer_;
 }
 
+Status BlobWriter::Extend(Client& client, const size_t size) {
+  if (this->sealed()) {
+    return Status::ObjectSealed();
+  }
+  if (size == this->size()) {
+    return Status::OK();
+  }
+  std::shared_ptr<arrow::MutableBuffer> buffer;
+  RETURN_ON_ERROR(client.ExtendBuffer(this->object_id_, size, this->payload_,
+                                      buffer));
+  this->buffer_ = buffer;
+  return Status::OK();
+}
+
 Status BlobWriter::Build(Client& client) { return Status::OK(); }
 
 Status BlobWriter::Abort(Client& client) {
@@ -202,7 +216,8 @@ std::shared_ptr<Object> BlobWriter::_Seal(Client& client) {
   uint8_t *mmapped_ptr = nullptr, *dist = nullptr;
   if (payload_.data_size > 0) {
     VINEYARD_CHECK_OK(client.mmapToClient(payload_.store_fd, payload_.map_size,
-                                          false, true, &mmapped_ptr));
+                                          payload_.page_size, false, true,
+                                          &mmapped_ptr));
     dist = mmapped_ptr + payload_.data_offset;
   }
   auto buffer = arrow::Buffer::Wrap(dist, payload_.data_size);
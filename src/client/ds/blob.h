@@ -179,6 +179,19 @@ class BlobWriter : public ObjectBuilder {
    */
   const std::shared_ptr<arrow::MutableBuffer>& Buffer() const;
 
+  /**
+   * @brief Grow the blob writer in place to the given size, when the server's
+   * allocator has enough adjacent free space. The id and the data pointer
+   * of the blob writer are unchanged, and the existing content is kept.
+   *
+   * Returns `Status::NotEnoughMemory` when the blob cannot be extended in
+   * place, and the caller should fallback to a new blob writer.
+   *
+   * @param client The client connected to the vineyard server.
+   * @param size The new size of the blob, must be no less than the current.
+   */
+  Status Extend(Client& client, const size_t size);
+
   /**
    * @brief Build a blob in vineyard server.
    *
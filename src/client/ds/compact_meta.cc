@@ -0,0 +1,460 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+
+#include "client/ds/compact_meta.h"
+
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <set>
+#include <utility>
+#include <vector>
+
+#include "client/client.h"
+#include "client/ds/blob.h"
+
+namespace vineyard {
+
+namespace detail {
+
+static constexpr uint32_t kCompactMetaMagic = 0x4d435956;  // "VYCM"
+static constexpr uint32_t kCompactMetaVersion = 1;
+
+struct compact_meta_header_t {
+  uint32_t magic;
+  uint32_t version;
+  uint64_t size;
+  uint64_t nkeys;
+  uint64_t keys_offset;
+  uint64_t root_offset;
+};
+
+struct compact_meta_entry_t {
+  uint32_t key;
+  uint32_t type;
+  uint64_t value;
+};
+
+template <typename T>
+inline uint64_t compact_append(std::string& buffer, const T& value) {
+  uint64_t offset = buffer.size();
+  buffer.append(reinterpret_cast<const char*>(&value), sizeof(T));
+  return offset;
+}
+
+template <typename T>
+inline void compact_write_at(std::string& buffer, const uint64_t offset,
+                             const T& value) {
+  memcpy(&buffer[offset], &value, sizeof(T));
+}
+
+inline uint64_t compact_append_string(std::string& buffer,
+                                      const std::string& value) {
+  uint64_t offset =
+      compact_append(buffer, static_cast<uint32_t>(value.size()));
+  buffer.append(value);
+  return offset;
+}
+
+static void compact_collect_keys(const json& tree,
+                                 std::set<std::string>& keys) {
+  for (auto const& item : tree.items()) {
+    keys.emplace(item.key());
+    if (item.value().is_object()) {
+      compact_collect_keys(item.value(), keys);
+    }
+  }
+}
+
+static uint64_t compact_append_node(
+    std::string& buffer, const json& tree,
+    const std::map<std::string, uint32_t>& keys) {
+  std::vector<std::pair<uint32_t, const json*>> items;
+  for (auto const& item : tree.items()) {
+    items.emplace_back(keys.at(item.key()), &item.value());
+  }
+  std::sort(items.begin(), items.end(),
+            [](const std::pair<uint32_t, const json*>& lhs,
+               const std::pair<uint32_t, const json*>& rhs) {
+              return lhs.first < rhs.first;
+            });
+
+  uint64_t offset = compact_append(buffer, static_cast<uint64_t>(items.size()));
+  buffer.resize(buffer.size() + items.size() * sizeof(compact_meta_entry_t));
+  for (size_t index = 0; index < items.size(); ++index) {
+    const json& value = *items[index].second;
+    compact_meta_entry_t entry{items[index].first, 0, 0};
+    CompactMeta::ValueType type;
+    if (value.is_null()) {
+      type = CompactMeta::ValueType::kNull;
+    } else if (value.is_boolean()) {
+      type = CompactMeta::ValueType::kBool;
+      entry.value = value.get<bool>() ? 1 : 0;
+    } else if (value.is_number_unsigned()) {
+      type = CompactMeta::ValueType::kUInt;
+      entry.value = value.get<uint64_t>();
+    } else if (value.is_number_integer()) {
+      type = CompactMeta::ValueType::kInt;
+      int64_t v = value.get<int64_t>();
+      memcpy(&entry.value, &v, sizeof(int64_t));
+    } else if (value.is_number_float()) {
+      type = CompactMeta::ValueType::kDouble;
+      double v = value.get<double>();
+      memcpy(&entry.value, &v, sizeof(double));
+    } else if (value.is_string()) {
+      type = CompactMeta::ValueType::kString;
+      entry.value = compact_append_string(
+          buffer, value.get_ref<std::string const&>());
+    } else if (value.is_object()) {
+      type = CompactMeta::ValueType::kObject;
+      entry.value = compact_append_node(buffer, value, keys);
+    } else {
+      type = CompactMeta::ValueType::kJSON;
+      entry.value = compact_append_string(buffer, value.dump());
+    }
+    entry.type = static_cast<uint32_t>(type);
+    compact_write_at(
+        buffer,
+        offset + sizeof(uint64_t) + index * sizeof(compact_meta_entry_t),
+        entry);
+  }
+  return offset;
+}
+
+}  // namespace detail
+
+size_t CompactMeta::Node::Size() const {
+  if (meta_ == nullptr) {
+    return 0;
+  }
+  uint64_t count = 0;
+  memcpy(&count, meta_->data_ + offset_, sizeof(uint64_t));
+  return count;
+}
+
+bool CompactMeta::Node::Haskey(const std::string& key) const {
+  ValueType type;
+  uint64_t value;
+  return lookup(key, type, value).ok();
+}
+
+Status CompactMeta::Node::GetKeyValue(const std::string& key,
+                                      std::string& value) const {
+  ValueType type;
+  uint64_t offset;
+  RETURN_ON_ERROR(lookup(key, type, offset));
+  RETURN_ON_ASSERT(type == ValueType::kString || type == ValueType::kJSON,
+                   "The value of '" + key + "' is not a string");
+  return meta_->readString(offset, value);
+}
+
+Status CompactMeta::Node::GetKeyValue(const std::string& key,
+                                      int64_t& value) const {
+  ValueType type;
+  uint64_t bits;
+  RETURN_ON_ERROR(lookup(key, type, bits));
+  RETURN_ON_ASSERT(type == ValueType::kInt || type == ValueType::kUInt,
+                   "The value of '" + key + "' is not an integer");
+  memcpy(&value, &bits, sizeof(int64_t));
+  return Status::OK();
+}
+
+Status CompactMeta::Node::GetKeyValue(const std::string& key,
+                                      uint64_t& value) const {
+  ValueType type;
+  RETURN_ON_ERROR(lookup(key, type, value));
+  RETURN_ON_ASSERT(type == ValueType::kInt || type == ValueType::kUInt,
+                   "The value of '" + key + "' is not an integer");
+  return Status::OK();
+}
+
+Status CompactMeta::Node::GetKeyValue(const std::string& key,
+                                      double& value) const {
+  ValueType type;
+  uint64_t bits;
+  RETURN_ON_ERROR(lookup(key, type, bits));
+  if (type == ValueType::kDouble) {
+    memcpy(&value, &bits, sizeof(double));
+  } else if (type == ValueType::kInt) {
+    int64_t v;
+    memcpy(&v, &bits, sizeof(int64_t));
+    value = static_cast<double>(v);
+  } else if (type == ValueType::kUInt) {
+    value = static_cast<double>(bits);
+  } else {
+    return Status::Invalid("The value of '" + key + "' is not a number");
+  }
+  return Status::OK();
+}
+
+Status CompactMeta::Node::GetKeyValue(const std::string& key,
+                                      bool& value) const {
+  ValueType type;
+  uint64_t bits;
+  RETURN_ON_ERROR(lookup(key, type, bits));
+  RETURN_ON_ASSERT(type == ValueType::kBool,
+                   "The value of '" + key + "' is not a boolean");
+  value = bits != 0;
+  return Status::OK();
+}
+
+Status CompactMeta::Node::GetKeyValue(const std::string& key,
+                                      json& value) const {
+  ValueType type;
+  uint64_t bits;
+  RETURN_ON_ERROR(lookup(key, type, bits));
+  return decode(type, bits, value);
+}
+
+Status CompactMeta::Node::GetMember(const std::string& key,
+                                    Node& member) const {
+  ValueType type;
+  uint64_t offset;
+  RETURN_ON_ERROR(lookup(key, type, offset));
+  RETURN_ON_ASSERT(type == ValueType::kObject,
+                   "The value of '" + key + "' is not a member");
+  member = Node(meta_, offset);
+  return Status::OK();
+}
+
+Status CompactMeta::Node::ToJSON(json& tree) const {
+  tree = json::object();
+  if (meta_ == nullptr) {
+    return Status::OK();
+  }
+  const size_t count = Size();
+  for (size_t index = 0; index < count; ++index) {
+    detail::compact_meta_entry_t entry;
+    memcpy(&entry,
+           meta_->data_ + offset_ + sizeof(uint64_t) +
+               index * sizeof(detail::compact_meta_entry_t),
+           sizeof(detail::compact_meta_entry_t));
+    RETURN_ON_ASSERT(entry.key < meta_->nkeys_,
+                     "Invalid key in the compact metadata");
+    uint64_t key_offset = 0;
+    memcpy(&key_offset,
+           meta_->data_ + meta_->keys_offset_ + entry.key * sizeof(uint64_t),
+           sizeof(uint64_t));
+    std::string key;
+    RETURN_ON_ERROR(meta_->readString(key_offset, key));
+    RETURN_ON_ERROR(
+        decode(static_cast<ValueType>(entry.type), entry.value, tree[key]));
+  }
+  return Status::OK();
+}
+
+Status CompactMeta::Node::decode(const ValueType type, const uint64_t bits,
+                                 json& value) const {
+  switch (type) {
+  case ValueType::kNull:
+    value = nullptr;
+    return Status::OK();
+  case ValueType::kBool:
+    value = bits != 0;
+    return Status::OK();
+  case ValueType::kInt: {
+    int64_t v;
+    memcpy(&v, &bits, sizeof(int64_t));
+    value = v;
+    return Status::OK();
+  }
+  case ValueType::kUInt:
+    value = bits;
+    return Status::OK();
+  case ValueType::kDouble: {
+    double v;
+    memcpy(&v, &bits, sizeof(double));
+    value = v;
+    return Status::OK();
+  }
+  case ValueType::kString: {
+    std::string v;
+    RETURN_ON_ERROR(meta_->readString(bits, v));
+    value = std::move(v);
+    return Status::OK();
+  }
+  case ValueType::kJSON: {
+    std::string v;
+    RETURN_ON_ERROR(meta_->readString(bits, v));
+    value = json::parse(v, nullptr, false);
+    RETURN_ON_ASSERT(!value.is_discarded(), "Corrupted compact metadata");
+    return Status::OK();
+  }
+  case ValueType::kObject:
+    return Node(meta_, bits).ToJSON(value);
+  default:
+    return Status::Invalid("Unknown value type in the compact metadata");
+  }
+}
+
+Status CompactMeta::Node::lookup(const std::string& key, ValueType& type,
+                                 uint64_t& value) const {
+  RETURN_ON_ASSERT(meta_ != nullptr, "The compact metadata is empty");
+  int64_t key_index = meta_->findKey(key);
+  if (key_index == -1) {
+    return Status::MetaTreeSubtreeNotExists(key);
+  }
+  const size_t count = Size();
+  const char* entries = meta_->data_ + offset_ + sizeof(uint64_t);
+  RETURN_ON_ASSERT(
+      offset_ + sizeof(uint64_t) +
+              count * sizeof(detail::compact_meta_entry_t) <=
+          meta_->size_,
+      "Corrupted compact metadata");
+  size_t begin = 0, end = count;
+  while (begin < end) {
+    size_t mid = begin + (end - begin) / 2;
+    detail::compact_meta_entry_t entry;
+    memcpy(&entry, entries + mid * sizeof(detail::compact_meta_entry_t),
+           sizeof(detail::compact_meta_entry_t));
+    if (entry.key == static_cast<uint32_t>(key_index)) {
+      type = static_cast<ValueType>(entry.type);
+      value = entry.value;
+      return Status::OK();
+    } else if (entry.key < static_cast<uint32_t>(key_index)) {
+      begin = mid + 1;
+    } else {
+      end = mid;
+    }
+  }
+  return Status::MetaTreeSubtreeNotExists(key);
+}
+
+Status CompactMeta::Serialize(const json& tree, std::string& buffer) {
+  RETURN_ON_ASSERT(tree.is_object(), "The metadata must be an object");
+  std::set<std::string> key_set;
+  detail::compact_collect_keys(tree, key_set);
+  std::map<std::string, uint32_t> keys;
+  for (auto const& key : key_set) {
+    keys.emplace(key, static_cast<uint32_t>(keys.size()));
+  }
+
+  buffer.clear();
+  detail::compact_meta_header_t header{};
+  header.magic = detail::kCompactMetaMagic;
+  header.version = detail::kCompactMetaVersion;
+  header.nkeys = keys.size();
+  detail::compact_append(buffer, header);
+
+  // the key table, in the order of the key index
+  header.keys_offset = buffer.size();
+  buffer.resize(buffer.size() + keys.size() * sizeof(uint64_t));
+  for (auto const& key : keys) {
+    uint64_t offset = detail::compact_append_string(buffer, key.first);
+    detail::compact_write_at(
+        buffer, header.keys_offset + key.second * sizeof(uint64_t), offset);
+  }
+
+  header.root_offset = detail::compact_append_node(buffer, tree, keys);
+  header.size = buffer.size();
+  detail::compact_write_at(buffer, 0, header);
+  return Status::OK();
+}
+
+Status CompactMeta::Open(const char* data, const size_t size,
+                         CompactMeta& meta) {
+  detail::compact_meta_header_t header;
+  RETURN_ON_ASSERT(data != nullptr && size >= sizeof(header),
+                   "Invalid compact metadata");
+  memcpy(&header, data, sizeof(header));
+  RETURN_ON_ASSERT(header.magic == detail::kCompactMetaMagic,
+                   "Invalid compact metadata");
+  RETURN_ON_ASSERT(header.version == detail::kCompactMetaVersion,
+                   "Unsupported version of the compact metadata: " +
+                       std::to_string(header.version));
+  RETURN_ON_ASSERT(
+      header.size <= size &&
+          header.keys_offset + header.nkeys * sizeof(uint64_t) <= size &&
+          header.root_offset + sizeof(uint64_t) <= size,
+      "Corrupted compact metadata");
+  meta.data_ = data;
+  meta.size_ = header.size;
+  meta.nkeys_ = header.nkeys;
+  meta.keys_offset_ = header.keys_offset;
+  meta.root_ = Node(&meta, header.root_offset);
+  meta.blob_ = nullptr;
+  return Status::OK();
+}
+
+Status CompactMeta::Open(const std::shared_ptr<Blob>& blob,
+                         CompactMeta& meta) {
+  RETURN_ON_ASSERT(blob != nullptr, "The blob is null");
+  RETURN_ON_ERROR(Open(blob->data(), blob->allocated_size(), meta));
+  meta.blob_ = blob;
+  return Status::OK();
+}
+
+Status CompactMeta::Write(Client& client, const ObjectMeta& meta,
+                          ObjectID& id) {
+  std::string buffer;
+  RETURN_ON_ERROR(Serialize(meta.MetaData(), buffer));
+  std::unique_ptr<BlobWriter> writer;
+  RETURN_ON_ERROR(client.CreateBlob(buffer.size(), writer));
+  memcpy(writer->data(), buffer.data(), buffer.size());
+  auto blob = writer->Seal(client);
+  RETURN_ON_ASSERT(blob != nullptr, "Failed to seal the compact metadata");
+  id = blob->id();
+  return Status::OK();
+}
+
+Status CompactMeta::Read(Client& client, const ObjectID id,
+                         CompactMeta& meta) {
+  std::shared_ptr<Blob> blob;
+  RETURN_ON_ERROR(client.GetObject(id, blob));
+  return Open(blob, meta);
+}
+
+int64_t CompactMeta::findKey(const std::string& key) const {
+  uint64_t begin = 0, end = nkeys_;
+  while (begin < end) {
+    uint64_t mid = begin + (end - begin) / 2;
+    uint64_t offset = 0;
+    memcpy(&offset, data_ + keys_offset_ + mid * sizeof(uint64_t),
+           sizeof(uint64_t));
+    uint32_t length = 0;
+    if (offset + sizeof(uint32_t) > size_) {
+      return -1;
+    }
+    memcpy(&length, data_ + offset, sizeof(uint32_t));
+    if (offset + sizeof(uint32_t) + length > size_) {
+      return -1;
+    }
+    int r = key.compare(0, std::string::npos, data_ + offset + sizeof(uint32_t),
+                        length);
+    if (r == 0) {
+      return static_cast<int64_t>(mid);
+    } else if (r > 0) {
+      begin = mid + 1;
+    } else {
+      end = mid;
+    }
+  }
+  return -1;
+}
+
+Status CompactMeta::readString(const uint64_t offset,
+                               std::string& value) const {
+  RETURN_ON_ASSERT(offset + sizeof(uint32_t) <= size_,
+                   "Corrupted compact metadata");
+  uint32_t length = 0;
+  memcpy(&length, data_ + offset, sizeof(uint32_t));
+  RETURN_ON_ASSERT(offset + sizeof(uint32_t) + length <= size_,
+                   "Corrupted compact metadata");
+  value.assign(data_ + offset + sizeof(uint32_t), length);
+  return Status::OK();
+}
+
+}  // namespace vineyard
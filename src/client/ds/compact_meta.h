@@ -0,0 +1,161 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+
+#ifndef SRC_CLIENT_DS_COMPACT_META_H_
+#define SRC_CLIENT_DS_COMPACT_META_H_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "client/ds/object_meta.h"
+#include "common/util/json.h"
+#include "common/util/status.h"
+#include "common/util/uuid.h"
+
+namespace vineyard {
+
+class Blob;
+class Client;
+
+/**
+ * @brief CompactMeta is an immutable binary layout of the metadata, which is
+ * designed for metadata that contains tens of thousands of keys (e.g., the
+ * fragments) and being read many times.
+ *
+ * The keys are interned into a sorted key table, and every (nested) member is
+ * a node of entries sorted by the key index, where members refer each other
+ * by offsets. Thus looking up a key is a binary search without parsing.
+ *
+ * The layout can be written to a blob and mapped by other clients, see also
+ * `Write` and `Open`.
+ */
+class CompactMeta {
+ public:
+  enum class ValueType : uint32_t {
+    kNull = 0,
+    kBool = 1,
+    kInt = 2,
+    kUInt = 3,
+    kDouble = 4,
+    kString = 5,
+    // arrays and other values, in their json string form
+    kJSON = 6,
+    kObject = 7,
+  };
+
+  /**
+   * @brief A (nested) member in the compact metadata, which is valid as long
+   * as the CompactMeta is alive.
+   */
+  class Node {
+   public:
+    Node() = default;
+
+    size_t Size() const;
+
+    bool Haskey(const std::string& key) const;
+
+    Status GetKeyValue(const std::string& key, std::string& value) const;
+
+    Status GetKeyValue(const std::string& key, int64_t& value) const;
+
+    Status GetKeyValue(const std::string& key, uint64_t& value) const;
+
+    Status GetKeyValue(const std::string& key, double& value) const;
+
+    Status GetKeyValue(const std::string& key, bool& value) const;
+
+    /**
+     * @brief Get the value as json, works for values of any type.
+     */
+    Status GetKeyValue(const std::string& key, json& value) const;
+
+    Status GetMember(const std::string& key, Node& member) const;
+
+    Status ToJSON(json& tree) const;
+
+   private:
+    Node(const CompactMeta* meta, const uint64_t offset)
+        : meta_(meta), offset_(offset) {}
+
+    Status lookup(const std::string& key, ValueType& type,
+                  uint64_t& value) const;
+
+    Status decode(const ValueType type, const uint64_t bits,
+                  json& value) const;
+
+    const CompactMeta* meta_ = nullptr;
+    uint64_t offset_ = 0;
+
+    friend class CompactMeta;
+  };
+
+  CompactMeta() = default;
+
+  // the nodes refer to the CompactMeta itself
+  CompactMeta(const CompactMeta&) = delete;
+  CompactMeta& operator=(const CompactMeta&) = delete;
+
+  /**
+   * @brief Encode the metadata tree to the compact layout.
+   */
+  static Status Serialize(const json& tree, std::string& buffer);
+
+  /**
+   * @brief Open the compact layout in the given memory, the memory must
+   * outlive the CompactMeta.
+   */
+  static Status Open(const char* data, const size_t size, CompactMeta& meta);
+
+  /**
+   * @brief Open the compact layout from a blob, the blob is held by the
+   * CompactMeta.
+   */
+  static Status Open(const std::shared_ptr<Blob>& blob, CompactMeta& meta);
+
+  /**
+   * @brief Encode the metadata to a blob in vineyard, hence it could be mapped
+   * (rather than parsed) by other clients on the same instance.
+   */
+  static Status Write(Client& client, const ObjectMeta& meta, ObjectID& id);
+
+  /**
+   * @brief Map the compact metadata written by `Write`.
+   */
+  static Status Read(Client& client, const ObjectID id, CompactMeta& meta);
+
+  const Node& Root() const { return root_; }
+
+  Status ToJSON(json& tree) const { return root_.ToJSON(tree); }
+
+ private:
+  // the key index, or -1 if not found.
+  int64_t findKey(const std::string& key) const;
+
+  Status readString(const uint64_t offset, std::string& value) const;
+
+  const char* data_ = nullptr;
+  size_t size_ = 0;
+  uint64_t nkeys_ = 0;
+  uint64_t keys_offset_ = 0;
+  Node root_;
+  std::shared_ptr<Blob> blob_ = nullptr;
+};
+
+}  // namespace vineyard
+
+#endif  // SRC_CLIENT_DS_COMPACT_META_H_
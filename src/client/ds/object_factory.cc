@@ -15,6 +15,8 @@ limitations under the License.
 
 #include "client/ds/object_factory.h"
 
+#include <algorithm>
+
 #include "client/ds/i_object.h"
 #include "client/ds/object_meta.h"
 
@@ -32,8 +34,27 @@ std::unique_ptr<Object> ObjectFactory::Create(std::string const& type_name) {
   }
 }
 
+std::unique_ptr<Object> ObjectFactory::Create(const TypeID type_id,
+                                              std::string const& type_name) {
+  auto& known_type_ids = getKnownTypeIds();
+  auto creator = std::lower_bound(
+      known_type_ids.begin(), known_type_ids.end(), type_id,
+      [](const std::pair<TypeID, object_initializer_t>& item,
+         const TypeID id) { return item.first < id; });
+  if (creator != known_type_ids.end() && creator->first == type_id &&
+      creator->second != nullptr) {
+    return (creator->second)();
+  }
+  return ObjectFactory::Create(type_name);
+}
+
 std::unique_ptr<Object> ObjectFactory::Create(ObjectMeta const& metadata) {
-  return ObjectFactory::Create(metadata.GetTypeName(), metadata);
+  auto target =
+      ObjectFactory::Create(metadata.GetTypeId(), metadata.GetTypeName());
+  if (target != nullptr) {
+    target->Construct(metadata);
+  }
+  return target;
 }
 
 std::unique_ptr<Object> ObjectFactory::Create(std::string const& type_name,
@@ -63,4 +84,25 @@ ObjectFactory::getKnownTypes() {
   return *known_types;
 }
 
+void ObjectFactory::registerTypeId(const TypeID type_id,
+                                   object_initializer_t initializer) {
+  auto& known_type_ids = getKnownTypeIds();
+  auto iter = std::lower_bound(
+      known_type_ids.begin(), known_type_ids.end(), type_id,
+      [](const std::pair<TypeID, object_initializer_t>& item,
+         const TypeID id) { return item.first < id; });
+  if (iter != known_type_ids.end() && iter->first == type_id) {
+    // two distinct typenames collide, resolve them by the typename instead.
+    LOG(WARNING) << "The type id " << type_id << " is ambiguous";
+    iter->second = nullptr;
+  } else {
+    known_type_ids.emplace(iter, type_id, initializer);
+  }
+}
+
+ObjectFactory::known_type_ids_t& ObjectFactory::getKnownTypeIds() {
+  static known_type_ids_t* known_type_ids = new known_type_ids_t();
+  return *known_type_ids;
+}
+
 }  // namespace vineyard
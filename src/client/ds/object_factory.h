@@ -19,6 +19,8 @@ limitations under the License.
 #include <memory>
 #include <string>
 #include <unordered_map>
+#include <utility>
+#include <vector>
 
 #include "common/util/logging.h"
 #include "common/util/typename.h"
@@ -60,8 +62,10 @@ class __attribute__((visibility("default"))) ObjectFactory {
 #endif
     auto& known_types = getKnownTypes();
     // the explicit `static_cast` is used to help overloading resolution.
-    known_types.emplace(type_name<T>(),
-                        static_cast<object_initializer_t>(&T::Create));
+    auto initializer = static_cast<object_initializer_t>(&T::Create);
+    if (known_types.emplace(type_name<T>(), initializer).second) {
+      registerTypeId(type_id<T>(), initializer);
+    }
     return true;
   }
 
@@ -73,6 +77,18 @@ class __attribute__((visibility("default"))) ObjectFactory {
   static std::unique_ptr<Object> __attribute__((visibility("default")))
   Create(std::string const& type_name);
 
+  /**
+   * @brief Initialize an instance by looking up the `type_id` in the factory,
+   * which avoids hashing and comparing the (long) typename strings.
+   *
+   * The `type_name` is used when the `type_id` is unknown or ambiguous.
+   *
+   * @param type_id The id of the type to be instantiated, see `type_id<T>()`.
+   * @param type_name The type to be instantiated.
+   */
+  static std::unique_ptr<Object> __attribute__((visibility("default")))
+  Create(const TypeID type_id, std::string const& type_name);
+
   /**
    * @brief Initialize an instance by looking up the `type_name` in the factory,
    * and construct the object using the metadata.
@@ -108,6 +124,17 @@ class __attribute__((visibility("default"))) ObjectFactory {
   // https://isocpp.org/wiki/faq/ctors#static-init-order-on-first-use
   static std::unordered_map<std::string, object_initializer_t>& __attribute__((
       visibility("default"))) getKnownTypes();
+
+  // type id -> initializer, sorted by the type id, the initializer is nullptr
+  // if the id is ambiguous.
+  using known_type_ids_t =
+      std::vector<std::pair<TypeID, object_initializer_t>>;
+
+  static void __attribute__((visibility("default")))
+  registerTypeId(const TypeID type_id, object_initializer_t initializer);
+
+  static known_type_ids_t& __attribute__((visibility("default")))
+  getKnownTypeIds();
 };
 
 }  // namespace vineyard
@@ -15,12 +15,92 @@ limitations under the License.
 
 #include "client/ds/object_meta.h"
 
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+
 #include "client/client.h"
 #include "client/ds/blob.h"
 
 namespace vineyard {
 
-ObjectMeta::ObjectMeta() : buffer_set_(std::make_shared<BufferSet>()) {}
+struct ObjectMeta::prefetched_members_t {
+  std::mutex mutex;
+  std::map<std::string, std::shared_ptr<Object>> members;
+};
+
+// guards the `buffer_set_` as well, which is extended by the fetched members.
+struct ObjectMeta::lazy_members_t {
+  std::mutex mutex;
+  std::map<std::string, json> members;
+};
+
+namespace detail {
+
+/**
+ * @brief A process-wide pool of (at most 8) workers for `PrefetchMembers`,
+ * to avoid spawning threads on every `GetObject`.
+ *
+ * The pool is intentionally leaked, as the workers may still be alive when
+ * the static objects are destructed at exit.
+ */
+class PrefetchPool {
+ public:
+  static PrefetchPool& Default() {
+    static PrefetchPool* pool = new PrefetchPool();
+    return *pool;
+  }
+
+  size_t Size() const { return size_; }
+
+  void Submit(std::function<void()>&& task) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      tasks_.emplace_back(std::move(task));
+    }
+    cv_.notify_one();
+  }
+
+ private:
+  PrefetchPool()
+      : size_(std::min<size_t>(
+            8,
+            std::max<unsigned int>(1, std::thread::hardware_concurrency()))) {
+    for (size_t i = 1; i < size_; ++i) {
+      std::thread([this]() { this->run(); }).detach();
+    }
+  }
+
+  void run() {
+    while (true) {
+      std::function<void()> task;
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait(lock, [this]() { return !tasks_.empty(); });
+        task = std::move(tasks_.front());
+        tasks_.pop_front();
+      }
+      task();
+    }
+  }
+
+  const size_t size_;
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::deque<std::function<void()>> tasks_;
+};
+
+}  // namespace detail
+
+ObjectMeta::ObjectMeta()
+    : buffer_set_(std::make_shared<BufferSet>()),
+      lazy_members_(std::make_shared<lazy_members_t>()),
+      prefetched_members_(std::make_shared<prefetched_members_t>()) {}
 
 ObjectMeta::~ObjectMeta() {}
 
@@ -28,6 +108,8 @@ ObjectMeta::ObjectMeta(const ObjectMeta& other) {
   this->client_ = other.client_;
   this->meta_ = other.meta_;
   this->buffer_set_ = other.buffer_set_;
+  this->lazy_members_ = other.lazy_members_;
+  this->prefetched_members_ = other.prefetched_members_;
   this->incomplete_ = other.incomplete_;
   this->force_local_ = other.force_local_;
 }
@@ -36,6 +118,8 @@ ObjectMeta& ObjectMeta::operator=(ObjectMeta const& other) {
   this->client_ = other.client_;
   this->meta_ = other.meta_;
   this->buffer_set_ = other.buffer_set_;
+  this->lazy_members_ = other.lazy_members_;
+  this->prefetched_members_ = other.prefetched_members_;
   this->incomplete_ = other.incomplete_;
   this->force_local_ = other.force_local_;
   return *this;
@@ -65,12 +149,21 @@ const bool ObjectMeta::IsGlobal() const { return meta_.value("global", false); }
 
 void ObjectMeta::SetTypeName(const std::string& type_name) {
   meta_["typename"] = type_name;
+  meta_["typeid"] = type_id(type_name);
 }
 
 std::string const& ObjectMeta::GetTypeName() const {
   return meta_["typename"].get_ref<std::string const&>();
 }
 
+TypeID ObjectMeta::GetTypeId() const {
+  auto iter = meta_.find("typeid");
+  if (iter != meta_.end() && iter->is_number_unsigned()) {
+    return iter->get<TypeID>();
+  }
+  return type_id(GetTypeName());
+}
+
 void ObjectMeta::SetNBytes(const size_t nbytes) { meta_["nbytes"] = nbytes; }
 
 size_t const ObjectMeta::GetNBytes() const {
@@ -117,6 +210,11 @@ void ObjectMeta::ResetKey(std::string const& key) {
 }
 
 void ObjectMeta::AddKeyValue(const std::string& key, const std::string& value) {
+  if (key == "typename") {
+    // keeps the `typeid` consistent
+    SetTypeName(value);
+    return;
+  }
   meta_[key] = value;
 }
 
@@ -162,8 +260,17 @@ void ObjectMeta::AddMember(const std::string& name, const ObjectID member_id) {
 }
 
 std::shared_ptr<Object> ObjectMeta::GetMember(const std::string& name) const {
+  {
+    std::lock_guard<std::mutex> lock(prefetched_members_->mutex);
+    auto iter = prefetched_members_->members.find(name);
+    if (iter != prefetched_members_->members.end()) {
+      auto object = iter->second;
+      prefetched_members_->members.erase(iter);
+      return object;
+    }
+  }
   ObjectMeta meta = this->GetMemberMeta(name);
-  auto object = ObjectFactory::Create(meta.GetTypeName());
+  auto object = ObjectFactory::Create(meta.GetTypeId(), meta.GetTypeName());
   if (object == nullptr) {
     object = std::unique_ptr<Object>(new Object());
   }
@@ -171,28 +278,175 @@ std::shared_ptr<Object> ObjectMeta::GetMember(const std::string& name) const {
   return object;
 }
 
+void ObjectMeta::PrefetchMembers(const size_t concurrency) const {
+  std::vector<std::string> names;
+  for (auto const& item : meta_.items()) {
+    json const& member = item.value();
+    if (!member.is_object() || member.empty() || member.value("lazy", false)) {
+      continue;
+    }
+    // blobs are cheap to construct
+    auto typename_iter = member.find("typename");
+    if (typename_iter != member.end() && typename_iter->is_string() &&
+        typename_iter->get_ref<std::string const&>() == "vineyard::Blob") {
+      continue;
+    }
+    names.emplace_back(item.key());
+  }
+  auto& pool = detail::PrefetchPool::Default();
+  size_t parallelism = concurrency == 0 ? pool.Size() : concurrency;
+  parallelism = std::min(std::min(parallelism, pool.Size()), names.size());
+  if (parallelism <= 1) {
+    return;
+  }
+
+  // The caller takes part in the construction as well, and waits for the
+  // members that have been taken by the workers, rather than the workers
+  // themselves: a worker that is scheduled after all members have been taken
+  // (e.g., when the pool is busy) returns immediately without touching
+  // `this`, thus the caller never blocks on a busy pool.
+  struct state_t {
+    explicit state_t(std::vector<std::string>&& names)
+        : names(std::move(names)), objects(this->names.size()) {}
+
+    std::vector<std::string> names;
+    std::vector<std::shared_ptr<Object>> objects;
+    std::atomic<size_t> next{0};
+    size_t finished = 0;
+    std::exception_ptr error = nullptr;
+    std::mutex mutex;
+    std::condition_variable cv;
+  };
+  auto state = std::make_shared<state_t>(std::move(names));
+  auto construct = [this, state]() {
+    size_t index = 0;
+    while ((index = state->next.fetch_add(1)) < state->names.size()) {
+      std::exception_ptr error = nullptr;
+      try {
+        ObjectMeta meta = this->GetMemberMeta(state->names[index]);
+        auto object =
+            ObjectFactory::Create(meta.GetTypeId(), meta.GetTypeName());
+        if (object == nullptr) {
+          object = std::unique_ptr<Object>(new Object());
+        }
+        object->Construct(meta);
+        state->objects[index] = std::move(object);
+      } catch (...) { error = std::current_exception(); }
+      std::lock_guard<std::mutex> lock(state->mutex);
+      if (error != nullptr && state->error == nullptr) {
+        state->error = error;
+      }
+      if (++state->finished == state->names.size()) {
+        state->cv.notify_all();
+      }
+    }
+  };
+  for (size_t i = 1; i < parallelism; ++i) {
+    pool.Submit(construct);
+  }
+  construct();
+  {
+    std::unique_lock<std::mutex> lock(state->mutex);
+    state->cv.wait(
+        lock, [&]() { return state->finished == state->names.size(); });
+    if (state->error != nullptr) {
+      std::rethrow_exception(state->error);
+    }
+  }
+
+  std::lock_guard<std::mutex> lock(prefetched_members_->mutex);
+  for (size_t index = 0; index < state->names.size(); ++index) {
+    prefetched_members_->members.emplace(state->names[index],
+                                         state->objects[index]);
+  }
+}
+
+void ObjectMeta::DropPrefetchedMembers() const {
+  std::lock_guard<std::mutex> lock(prefetched_members_->mutex);
+  prefetched_members_->members.clear();
+}
+
+size_t ObjectMeta::MemberCount() const {
+  size_t count = 0;
+  for (auto const& item : meta_.items()) {
+    if (item.value().is_object() && !item.value().empty()) {
+      count += 1;
+    }
+  }
+  return count;
+}
+
 ObjectMeta ObjectMeta::GetMemberMeta(const std::string& name) const {
   ObjectMeta ret;
-  auto const& child_meta = meta_[name];
-  VINEYARD_ASSERT(!child_meta.is_null(), "Failed to get member " + name);
-
-  ret.SetMetaData(this->client_, child_meta);
-  auto const& all_blobs = buffer_set_->AllBuffers();
-  for (auto const& blob : ret.buffer_set_->AllBuffers()) {
-    auto iter = all_blobs.find(blob.first);
-    // for remote object, the blob may not present here
-    if (iter != all_blobs.end()) {
-      ret.SetBuffer(blob.first, iter->second);
+  VINEYARD_CHECK_OK(this->GetMemberMeta(name, ret));
+  return ret;
+}
+
+Status ObjectMeta::GetMemberMeta(const std::string& name,
+                                 ObjectMeta& meta) const {
+  auto member = meta_.find(name);
+  RETURN_ON_ASSERT(member != meta_.end() && !member->is_null(),
+                   "Failed to get member " + name);
+  json const* child_meta = &*member;
+  if (child_meta->value("lazy", false)) {
+    RETURN_ON_ERROR(this->fetchLazyMember(name, child_meta));
+  }
+
+  meta.Reset();
+  meta.SetMetaData(this->client_, *child_meta);
+  {
+    std::lock_guard<std::mutex> lock(lazy_members_->mutex);
+    auto const& all_blobs = buffer_set_->AllBuffers();
+    for (auto const& blob : meta.buffer_set_->AllBuffers()) {
+      auto iter = all_blobs.find(blob.first);
+      // for remote object, the blob may not present here
+      if (iter != all_blobs.end()) {
+        meta.SetBuffer(blob.first, iter->second);
+      }
     }
   }
   if (this->force_local_) {
-    ret.ForceLocal();
+    meta.ForceLocal();
   }
-  return ret;
+  return Status::OK();
+}
+
+Status ObjectMeta::fetchLazyMember(const std::string& name,
+                                   json const*& member) const {
+  {
+    std::lock_guard<std::mutex> lock(lazy_members_->mutex);
+    auto iter = lazy_members_->members.find(name);
+    if (iter != lazy_members_->members.end()) {
+      member = &iter->second;
+      return Status::OK();
+    }
+  }
+  // fetched out of the lock, the concurrent fetches of the same member are
+  // harmless as the first one wins.
+  Client* client = dynamic_cast<Client*>(client_);
+  RETURN_ON_ASSERT(client != nullptr,
+                   "The lazy member '" + name +
+                       "' can only be fetched with an IPC client");
+  ObjectID member_id =
+      VYObjectIDFromString(meta_[name]["id"].get_ref<std::string const&>());
+  ObjectMeta member_meta;
+  RETURN_ON_ERROR(client->GetMetaData(member_id, member_meta, false, true));
+  RETURN_ON_ASSERT(!member_meta.MetaData().empty(),
+                   "Failed to get member " + name);
+  std::lock_guard<std::mutex> lock(lazy_members_->mutex);
+  auto iter = lazy_members_->members.find(name);
+  if (iter == lazy_members_->members.end()) {
+    // the blobs of the member have been mapped
+    buffer_set_->Extend(member_meta.buffer_set_);
+    iter = lazy_members_->members.emplace(name, member_meta.meta_).first;
+  }
+  member = &iter->second;
+  return Status::OK();
 }
 
 Status ObjectMeta::GetBuffer(const ObjectID blob_id,
                              std::shared_ptr<arrow::Buffer>& buffer) const {
+  std::lock_guard<std::mutex> lock(lazy_members_->mutex);
   if (buffer_set_->Get(blob_id, buffer)) {
     return Status::OK();
   } else {
@@ -213,6 +467,8 @@ void ObjectMeta::Reset() {
   client_ = nullptr;
   meta_ = json::object();
   buffer_set_.reset(new BufferSet());
+  lazy_members_.reset(new lazy_members_t());
+  prefetched_members_.reset(new prefetched_members_t());
   incomplete_ = false;
 }
 
@@ -29,6 +29,7 @@ limitations under the License.
 #include "common/util/boost.h"
 #include "common/util/json.h"
 #include "common/util/status.h"
+#include "common/util/typename.h"
 #include "common/util/uuid.h"
 
 namespace vineyard {
@@ -107,6 +108,13 @@ class ObjectMeta {
    */
   std::string const& GetTypeName() const;
 
+  /**
+   * @brief Get the `typeid` of the metadata, i.e., the hash of the `typename`,
+   * it will be computed from the `typename` when the metadata doesn't have
+   * one (e.g., the metadata created by a legacy writer).
+   */
+  TypeID GetTypeId() const;
+
   /**
    * @brief Set the `nbytes` attribute for the metadata, basically it indicates
    * the memory usage of the object.
@@ -466,14 +474,55 @@ class ObjectMeta {
    */
   std::shared_ptr<Object> GetMember(const std::string& name) const;
 
+  /**
+   * @brief Construct the (non-blob) members concurrently ahead of time, the
+   * constructed members are taken by the following `GetMember`, e.g., in the
+   * `Construct` of the object.
+   *
+   * The members are independent subtrees of the metadata, and their blobs
+   * have been mapped once when fetching the metadata. Lazy members are left
+   * to `GetMember`.
+   *
+   * The members are constructed on a process-wide pool of workers, and the
+   * exception raised by constructing any member is rethrown to the caller.
+   *
+   * @param concurrency The number of threads, 0 means the number of cores
+   * (at most 8).
+   */
+  void PrefetchMembers(const size_t concurrency = 0) const;
+
+  /**
+   * @brief Drop the prefetched members that haven't been taken by
+   * `GetMember`, e.g., after the `Construct` of the object finishes.
+   */
+  void DropPrefetchedMembers() const;
+
+  /**
+   * @brief The number of members (including blobs) of the object.
+   */
+  size_t MemberCount() const;
+
   /**
    * @brief Get member's ObjectMeta value.
    *
+   * For metadata obtained in the lazy mode (see `Client::GetMetaData`), the
+   * member is fetched from the server on the first access.
+   *
    * @param name The name of member object.
    * @param member The metadata of member object. will be stored in `value`.
    */
   ObjectMeta GetMemberMeta(const std::string& name) const;
 
+  /**
+   * @brief Get member's ObjectMeta value, the failure of fetching a lazy
+   * member (e.g., with an RPC client, or the member has been deleted) is
+   * returned rather than aborting.
+   *
+   * The lazy members are fetched under the lock that is shared between the
+   * copies of the metadata, thus it is safe to be called concurrently.
+   */
+  Status GetMemberMeta(const std::string& name, ObjectMeta& meta) const;
+
   /**
    * @brief Get buffer member (directed or indirected) from the metadata. The
    * metadata should has already been initialized.
@@ -524,6 +573,9 @@ class ObjectMeta {
  private:
   void findAllBlobs(const json& tree);
 
+  // fetch the lazy member from the server, the result is cached.
+  Status fetchLazyMember(const std::string& name, json const*& member) const;
+
   void SetInstanceId(const InstanceID instance_id);
 
   void SetSignature(const Signature signature);
@@ -534,6 +586,12 @@ class ObjectMeta {
   json meta_;
   // associated blobs
   std::shared_ptr<BufferSet> buffer_set_ = nullptr;
+  // the fetched lazy members, shared between the copies like `buffer_set_`.
+  struct lazy_members_t;
+  std::shared_ptr<lazy_members_t> lazy_members_ = nullptr;
+  // the members that have been constructed by `PrefetchMembers`.
+  struct prefetched_members_t;
+  std::shared_ptr<prefetched_members_t> prefetched_members_ = nullptr;
 
   // incomplete: whether the metadata has incomplete member, introduced by
   // `AddMember(name, member_id)`.
@@ -14,6 +14,12 @@ limitations under the License.
 */
 
 #include "client/io.h"
+
+#include <limits.h>
+#include <poll.h>
+
+#include <algorithm>
+
 #include "common/util/logging.h"
 
 namespace vineyard {
@@ -188,4 +194,50 @@ Status recv_message(int fd, std::string& msg) {
   return Status::OK();
 }
 
+Status recv_iovec(int fd, struct iovec* iov, size_t iovcnt) {
+  while (iovcnt > 0) {
+    // skip the drained (or empty) destinations
+    if (iov->iov_len == 0) {
+      ++iov;
+      --iovcnt;
+      continue;
+    }
+    ssize_t nbytes =
+        readv(fd, iov, static_cast<int>(std::min<size_t>(iovcnt, IOV_MAX)));
+    if (nbytes < 0) {
+      if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) {
+        continue;
+      }
+      return Status::IOError("Receive message failed: " +
+                             std::string(strerror(errno)));
+    } else if (nbytes == 0) {
+      return Status::IOError(
+          "Receive message failed: encountered unexpected EOF");
+    }
+    size_t bytes = static_cast<size_t>(nbytes);
+    while (bytes > 0) {
+      size_t chunk = std::min(bytes, iov->iov_len);
+      iov->iov_base = static_cast<char*>(iov->iov_base) + chunk;
+      iov->iov_len -= chunk;
+      bytes -= chunk;
+      if (iov->iov_len == 0) {
+        ++iov;
+        --iovcnt;
+      }
+    }
+  }
+  return Status::OK();
+}
+
+bool peer_closed(int fd) {
+  struct pollfd pfd;
+  pfd.fd = fd;
+  pfd.events = 0;
+  pfd.revents = 0;
+  if (poll(&pfd, 1, 0) < 0) {
+    return errno != EINTR;
+  }
+  return (pfd.revents & (POLLHUP | POLLERR | POLLNVAL)) != 0;
+}
+
 }  // namespace vineyard
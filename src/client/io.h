@@ -20,6 +20,7 @@ limitations under the License.
 #include <netdb.h>
 #include <netinet/in.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
 #include <sys/un.h>
 #include <unistd.h>
 
@@ -47,6 +48,18 @@ Status recv_bytes(int fd, void* data, size_t length);
 
 Status recv_message(int fd, std::string& msg);
 
+/**
+ * @brief Receive bytes into a sequence of destinations with vectored reads,
+ * the `iov` will be modified in place.
+ */
+Status recv_iovec(int fd, struct iovec* iov, size_t iovcnt);
+
+/**
+ * @brief Whether the peer of the socket has hung up, without consuming any
+ * data from the socket.
+ */
+bool peer_closed(int fd);
+
 }  // namespace vineyard
 
 #endif  // SRC_CLIENT_IO_H_
@@ -0,0 +1,254 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "client/meta_cache.h"
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "client/io.h"
+#include "common/util/logging.h"
+#include "common/util/protocols.h"
+
+namespace vineyard {
+
+MetaCache::MetaCache(const size_t capacity) : capacity_(capacity) {}
+
+MetaCache::~MetaCache() {
+  if (conn_ != -1) {
+    // unblock the listener
+    shutdown(conn_, SHUT_RDWR);
+  }
+  if (listener_.joinable()) {
+    listener_.join();
+  }
+  if (conn_ != -1) {
+    close(conn_);
+  }
+}
+
+Status MetaCache::Subscribe(const std::string& ipc_socket) {
+  RETURN_ON_ASSERT(conn_ == -1, "The metadata cache has been subscribed");
+  RETURN_ON_ERROR(connect_ipc_socket_retry(ipc_socket, conn_));
+  auto subscribe = [this]() -> Status {
+    std::string message_out, message_in;
+    WriteRegisterRequest(message_out);
+    RETURN_ON_ERROR(send_message(conn_, message_out));
+    RETURN_ON_ERROR(recv_message(conn_, message_in));
+    std::string ipc_socket_value, rpc_endpoint_value, version;
+    InstanceID instance_id = UnspecifiedInstanceID();
+    RETURN_ON_ERROR(CATCH_JSON_ERROR(ReadRegisterReply(
+        json::parse(message_in), ipc_socket_value, rpc_endpoint_value,
+        instance_id, version)));
+
+    WriteSubscribeInvalidationRequest(message_out);
+    RETURN_ON_ERROR(send_message(conn_, message_out));
+    RETURN_ON_ERROR(recv_message(conn_, message_in));
+    return CATCH_JSON_ERROR(
+        ReadSubscribeInvalidationReply(json::parse(message_in)));
+  };
+  auto status = subscribe();
+  if (!status.ok()) {
+    close(conn_);
+    conn_ = -1;
+    return status;
+  }
+  subscribed_.store(true);
+  listener_ = std::thread([this]() { this->listen(); });
+  return Status::OK();
+}
+
+bool MetaCache::Get(const ObjectID id, ObjectMeta& meta) {
+  if (!subscribed_.load()) {
+    return false;
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto entry = entries_.find(id);
+  if (entry == entries_.end()) {
+    misses_ += 1;
+    return false;
+  }
+  lru_.splice(lru_.begin(), lru_, entry->second.lru);
+  meta = entry->second.meta;
+  hits_ += 1;
+  return true;
+}
+
+void MetaCache::Put(const ObjectID id, const ObjectMeta& meta,
+                    const uint64_t epoch) {
+  if (!subscribed_.load() || capacity_ == 0 || IsBlob(id) ||
+      meta.MetaData().empty()) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (epoch != epoch_.load()) {
+    // the metadata may have been invalidated since it was fetched.
+    return;
+  }
+  if (entries_.find(id) != entries_.end()) {
+    return;
+  }
+  lru_.emplace_front(id);
+  entry_t& entry = entries_[id];
+  entry.meta = meta;
+  entry.lru = lru_.begin();
+  collectMembers(meta.MetaData(), entry.members);
+  for (auto const& member : entry.members) {
+    referrers_.emplace(member, id);
+  }
+  while (entries_.size() > capacity_) {
+    erase(lru_.back());
+  }
+}
+
+void MetaCache::Invalidate(const std::vector<ObjectID>& ids) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  epoch_ += 1;
+  for (auto const& id : ids) {
+    evict(id);
+  }
+}
+
+bool MetaCache::GetName(const std::string& name, ObjectID& id) {
+  if (!subscribed_.load()) {
+    return false;
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto entry = names_.find(name);
+  if (entry == names_.end()) {
+    return false;
+  }
+  id = entry->second;
+  return true;
+}
+
+void MetaCache::PutName(const std::string& name, const ObjectID id,
+                        const uint64_t epoch) {
+  if (!subscribed_.load() || capacity_ == 0) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (epoch != epoch_.load()) {
+    return;
+  }
+  if (names_.size() >= capacity_ && names_.find(name) == names_.end()) {
+    names_.erase(names_.begin());
+  }
+  names_[name] = id;
+}
+
+void MetaCache::InvalidateNames(const std::vector<std::string>& names) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  epoch_ += 1;
+  for (auto const& name : names) {
+    names_.erase(name);
+  }
+}
+
+void MetaCache::Clear() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  epoch_ += 1;
+  lru_.clear();
+  entries_.clear();
+  referrers_.clear();
+  names_.clear();
+}
+
+size_t MetaCache::Size() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return entries_.size();
+}
+
+size_t MetaCache::Names() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return names_.size();
+}
+
+void MetaCache::listen() {
+  std::string message_in;
+  while (true) {
+    auto status = recv_message(conn_, message_in);
+    if (!status.ok()) {
+      break;
+    }
+    std::vector<ObjectID> ids;
+    std::vector<std::string> names;
+    status = CATCH_JSON_ERROR(
+        ReadInvalidationNotification(json::parse(message_in), ids, names));
+    if (!status.ok()) {
+      LOG(ERROR) << "Failed to read the invalidation: " << status.ToString();
+      continue;
+    }
+    if (!ids.empty()) {
+      Invalidate(ids);
+    }
+    if (!names.empty()) {
+      InvalidateNames(names);
+    }
+  }
+  // the invalidations cannot be received anymore
+  subscribed_.store(false);
+  Clear();
+}
+
+void MetaCache::erase(const ObjectID id) {
+  auto entry = entries_.find(id);
+  if (entry == entries_.end()) {
+    return;
+  }
+  for (auto const& member : entry->second.members) {
+    auto range = referrers_.equal_range(member);
+    for (auto iter = range.first; iter != range.second; /* no self-inc */) {
+      if (iter->second == id) {
+        iter = referrers_.erase(iter);
+      } else {
+        ++iter;
+      }
+    }
+  }
+  lru_.erase(entry->second.lru);
+  entries_.erase(entry);
+}
+
+void MetaCache::evict(const ObjectID id) {
+  std::vector<ObjectID> pending{id};
+  while (!pending.empty()) {
+    ObjectID target = pending.back();
+    pending.pop_back();
+    auto range = referrers_.equal_range(target);
+    for (auto iter = range.first; iter != range.second; ++iter) {
+      pending.emplace_back(iter->second);
+    }
+    referrers_.erase(target);
+    erase(target);
+  }
+}
+
+void MetaCache::collectMembers(const json& tree,
+                               std::vector<ObjectID>& members) {
+  for (auto const& item : tree) {
+    if (!item.is_object() || !item.contains("id")) {
+      continue;
+    }
+    ObjectID member_id =
+        VYObjectIDFromString(item["id"].get_ref<std::string const&>());
+    members.emplace_back(member_id);
+    if (!IsBlob(member_id)) {
+      collectMembers(item, members);
+    }
+  }
+}
+
+}  // namespace vineyard
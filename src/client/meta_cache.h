@@ -0,0 +1,135 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef SRC_CLIENT_META_CACHE_H_
+#define SRC_CLIENT_META_CACHE_H_
+
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "client/ds/object_meta.h"
+#include "common/util/status.h"
+#include "common/util/uuid.h"
+
+namespace vineyard {
+
+/**
+ * @brief MetaCache caches the metadata of sealed objects on the client side
+ * in LRU order.
+ *
+ * The metadata of sealed objects is immutable except being deleted (or
+ * persisted), the server pushes the invalidations through a dedicated
+ * subscription connection, and the affected entries (including the entries
+ * that contain the object as a member) are evicted.
+ */
+class MetaCache {
+ public:
+  explicit MetaCache(const size_t capacity);
+
+  ~MetaCache();
+
+  /**
+   * @brief Subscribe the invalidations from the server, the cache won't serve
+   * any hits before that.
+   */
+  Status Subscribe(const std::string& ipc_socket);
+
+  /**
+   * @brief The epoch increases on every invalidation, entries fetched before
+   * an invalidation won't be inserted, see also `Put`.
+   */
+  uint64_t Epoch() const { return epoch_.load(); }
+
+  bool Get(const ObjectID id, ObjectMeta& meta);
+
+  /**
+   * @brief Insert the metadata fetched from the server at the given epoch.
+   */
+  void Put(const ObjectID id, const ObjectMeta& meta, const uint64_t epoch);
+
+  /**
+   * @brief Evict the entries of the given objects (or blobs) and the entries
+   * that contain them as members.
+   */
+  void Invalidate(const std::vector<ObjectID>& ids);
+
+  /**
+   * @brief The name -> object id mappings are cached as well, and are
+   * invalidated when the names are changed or dropped.
+   */
+  bool GetName(const std::string& name, ObjectID& id);
+
+  void PutName(const std::string& name, const ObjectID id,
+               const uint64_t epoch);
+
+  void InvalidateNames(const std::vector<std::string>& names);
+
+  void Clear();
+
+  size_t Size() const;
+
+  size_t Names() const;
+
+  size_t Hits() const { return hits_.load(); }
+
+  size_t Misses() const { return misses_.load(); }
+
+ private:
+  void listen();
+
+  // removes the entry, requires `mutex_` been held.
+  void erase(const ObjectID id);
+
+  // evicts the entry and the entries that refer it, requires `mutex_` been
+  // held.
+  void evict(const ObjectID id);
+
+  // collects the ids of nested members, including the blobs, as the entries
+  // that hold the buffers of released blobs are evicted as well.
+  static void collectMembers(const json& tree, std::vector<ObjectID>& members);
+
+  struct entry_t {
+    ObjectMeta meta;
+    std::list<ObjectID>::iterator lru;
+    std::vector<ObjectID> members;
+  };
+
+  const size_t capacity_;
+  mutable std::mutex mutex_;
+  // entries in access order, the most recently used one is at the front.
+  std::list<ObjectID> lru_;
+  std::unordered_map<ObjectID, entry_t> entries_;
+  // member -> the cached objects that contain it
+  std::unordered_multimap<ObjectID, ObjectID> referrers_;
+  // name -> object id, at most `capacity` names
+  std::unordered_map<std::string, ObjectID> names_;
+
+  std::atomic<uint64_t> epoch_{0};
+  std::atomic<size_t> hits_{0}, misses_{0};
+
+  int conn_ = -1;
+  std::atomic_bool subscribed_{false};
+  std::thread listener_;
+};
+
+}  // namespace vineyard
+
+#endif  // SRC_CLIENT_META_CACHE_H_
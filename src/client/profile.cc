@@ -0,0 +1,135 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "client/profile.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+
+namespace vineyard {
+
+// the costs of the innermost `Scope` on this thread
+static thread_local GetObjectProfile::cost_t* current_cost = nullptr;
+
+static int64_t totalDurations(const GetObjectProfile::cost_t& cost) {
+  int64_t total = 0;
+  for (int phase = 0; phase < GetObjectProfile::kPhases; ++phase) {
+    total += cost.durations[phase];
+  }
+  return total;
+}
+
+GetObjectProfile::Scope::Scope(GetObjectProfile* profile)
+    : profile_(profile) {
+  if (profile_ != nullptr) {
+    previous_ = current_cost;
+    current_cost = &cost_;
+  }
+}
+
+GetObjectProfile::Scope::~Scope() {
+  if (profile_ != nullptr) {
+    current_cost = previous_;
+  }
+}
+
+void GetObjectProfile::Scope::Commit(const std::string& type_name) {
+  if (profile_ != nullptr) {
+    cost_.calls = 1;
+    profile_->Add(type_name, cost_);
+  }
+}
+
+GetObjectProfile::Timer::Timer(const Phase phase)
+    : phase_(phase), cost_(current_cost) {
+  if (cost_ != nullptr) {
+    nested_ = totalDurations(*cost_);
+    start_ = std::chrono::steady_clock::now();
+  }
+}
+
+GetObjectProfile::Timer::~Timer() {
+  if (cost_ == nullptr) {
+    return;
+  }
+  int64_t elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                        std::chrono::steady_clock::now() - start_)
+                        .count();
+  // excludes the phases that are timed inside this one
+  nested_ = totalDurations(*cost_) - nested_;
+  cost_->durations[phase_] += elapsed - nested_;
+}
+
+void GetObjectProfile::Add(const std::string& type_name, const cost_t& cost) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  cost_t& accumulated = costs_[type_name];
+  accumulated.calls += cost.calls;
+  for (int phase = 0; phase < kPhases; ++phase) {
+    accumulated.durations[phase] += cost.durations[phase];
+  }
+}
+
+std::map<std::string, GetObjectProfile::cost_t> GetObjectProfile::Costs()
+    const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return costs_;
+}
+
+void GetObjectProfile::Reset() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  costs_.clear();
+}
+
+std::string GetObjectProfile::ToString() const {
+  std::stringstream ss;
+  ss << std::left << std::setw(48) << "type" << std::right << std::setw(10)
+     << "calls";
+  for (int phase = 0; phase < kPhases; ++phase) {
+    ss << std::setw(14) << PhaseName(static_cast<Phase>(phase));
+  }
+  ss << " (avg us)" << std::endl;
+  ss << std::fixed << std::setprecision(2);
+  for (auto const& item : Costs()) {
+    ss << std::left << std::setw(48) << item.first << std::right
+       << std::setw(10) << item.second.calls;
+    for (int phase = 0; phase < kPhases; ++phase) {
+      double average = static_cast<double>(item.second.durations[phase]) /
+                       1000.0 / std::max<size_t>(item.second.calls, 1);
+      ss << std::setw(14) << average;
+    }
+    ss << std::endl;
+  }
+  return ss.str();
+}
+
+const char* GetObjectProfile::PhaseName(const Phase phase) {
+  switch (phase) {
+  case kGetData:
+    return "get_data";
+  case kGetBuffers:
+    return "get_buffers";
+  case kMmap:
+    return "mmap";
+  case kCreate:
+    return "create";
+  case kConstruct:
+    return "construct";
+  default:
+    return "unknown";
+  }
+}
+
+}  // namespace vineyard
@@ -0,0 +1,106 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef SRC_CLIENT_PROFILE_H_
+#define SRC_CLIENT_PROFILE_H_
+
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+
+namespace vineyard {
+
+/**
+ * @brief GetObjectProfile accumulates where the time of `GetObject` goes,
+ * per type name of the objects.
+ *
+ * The phases are timed by `Timer`s inside a `Scope` on the same thread, and
+ * the time of nested phases (e.g., the mmap inside getting the buffers) is
+ * only counted to the innermost one.
+ */
+class GetObjectProfile {
+ public:
+  enum Phase {
+    kGetData = 0,     // fetching the metadata
+    kGetBuffers = 1,  // fetching the blobs, including receiving the fds
+    kMmap = 2,        // mapping the received fds
+    kCreate = 3,      // ObjectFactory::Create
+    kConstruct = 4,   // Object::Construct
+    kPhases = 5,
+  };
+
+  struct cost_t {
+    size_t calls = 0;
+    // in nanoseconds
+    int64_t durations[kPhases] = {};
+  };
+
+  /**
+   * @brief Collect the costs of a single `GetObject` call on the current
+   * thread, does nothing if the profile is nullptr.
+   */
+  class Scope {
+   public:
+    explicit Scope(GetObjectProfile* profile);
+
+    ~Scope();
+
+    void Commit(const std::string& type_name);
+
+   private:
+    GetObjectProfile* profile_;
+    cost_t cost_;
+    cost_t* previous_ = nullptr;
+  };
+
+  /**
+   * @brief Time a phase, does nothing outside a `Scope`.
+   */
+  class Timer {
+   public:
+    explicit Timer(const Phase phase);
+
+    ~Timer();
+
+   private:
+    const Phase phase_;
+    cost_t* cost_;
+    int64_t nested_ = 0;
+    std::chrono::steady_clock::time_point start_;
+  };
+
+  void Add(const std::string& type_name, const cost_t& cost);
+
+  std::map<std::string, cost_t> Costs() const;
+
+  void Reset();
+
+  /**
+   * @brief The average cost (in microseconds) of each phase per type name.
+   */
+  std::string ToString() const;
+
+  static const char* PhaseName(const Phase phase);
+
+ private:
+  mutable std::mutex mutex_;
+  std::map<std::string, cost_t> costs_;
+};
+
+}  // namespace vineyard
+
+#endif  // SRC_CLIENT_PROFILE_H_
@@ -15,16 +15,24 @@ limitations under the License.
 
 #include "client/rpc_client.h"
 
+#include <algorithm>
+#include <future>
 #include <mutex>
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
+#include <utility>
 #include <vector>
 
+#include "client/client.h"
 #include "client/ds/blob.h"
 #include "client/ds/object_factory.h"
 #include "client/io.h"
 #include "client/utils.h"
+#include "common/memory/checksum.h"
+#include "common/util/binary_protocols.h"
 #include "common/util/boost.h"
+#include "common/util/env.h"
 #include "common/util/protocols.h"
 
 namespace vineyard {
@@ -60,16 +68,24 @@ Status RPCClient::Connect(const std::string& host, uint32_t port) {
   rpc_endpoint_ = rpc_endpoint;
   RETURN_ON_ERROR(connect_rpc_socket_retry(host, port, vineyard_conn_));
   std::string message_out;
-  WriteRegisterRequest(message_out);
+  WriteRegisterRequest(0, {}, read_env("VINEYARD_TENANT"), message_out);
   RETURN_ON_ERROR(doWrite(message_out));
   json message_in;
   RETURN_ON_ERROR(doRead(message_in));
   std::string ipc_socket_value, rpc_endpoint_value;
-  RETURN_ON_ERROR(ReadRegisterReply(message_in, ipc_socket_value,
-                                    rpc_endpoint_value, remote_instance_id_,
-                                    server_version_));
+  bool binary_protocol = false, ipc_ring = false, pipelining = false;
+  uint64_t server_token = 0;
+  RETURN_ON_ERROR(ReadRegisterReply(
+      message_in, ipc_socket_value, rpc_endpoint_value, remote_instance_id_,
+      server_version_, binary_protocol, ipc_ring, server_token, pipelining));
+  binary_protocol_supported_ = binary_protocol;
+  if (const char* env_p = std::getenv("VINEYARD_PIPELINING")) {
+    std::string flag(env_p);
+    pipelining_ = pipelining && (flag == "1" || flag == "true");
+  }
   ipc_socket_ = ipc_socket_value;
   connected_ = true;
+  enableProfilingFromEnv();
 
   if (!compatible_server(server_version_)) {
     LOG(ERROR) << "Warning: this version of vineyard client may be "
@@ -84,6 +100,13 @@ Status RPCClient::Connect(const std::string& host, uint32_t port) {
   return Status::OK();
 }
 
+Status RPCClient::connectAnother(int& conn) {
+  size_t pos = rpc_endpoint_.find(":");
+  return connect_rpc_socket_retry(
+      rpc_endpoint_.substr(0, pos),
+      static_cast<uint32_t>(std::stoul(rpc_endpoint_.substr(pos + 1))), conn);
+}
+
 Status RPCClient::Fork(RPCClient& client) {
   RETURN_ON_ASSERT(!client.Connected(),
                    "The client has already been connected to vineyard server");
@@ -94,7 +117,10 @@ Status RPCClient::GetMetaData(const ObjectID id, ObjectMeta& meta,
                               const bool sync_remote) {
   ENSURE_CONNECTED(this);
   json tree;
-  RETURN_ON_ERROR(GetData(id, tree, sync_remote));
+  {
+    GetObjectProfile::Timer timer(GetObjectProfile::kGetData);
+    RETURN_ON_ERROR(GetData(id, tree, sync_remote));
+  }
   meta.Reset();
   meta.SetMetaData(this, tree);
   return Status::OK();
@@ -116,27 +142,44 @@ Status RPCClient::GetMetaData(const std::vector<ObjectID>& ids,
 }
 
 std::shared_ptr<Object> RPCClient::GetObject(const ObjectID id) {
+  GetObjectProfile::Scope scope(profile_.get());
   ObjectMeta meta;
   VINEYARD_CHECK_OK(this->GetMetaData(id, meta, true));
   VINEYARD_ASSERT(!meta.MetaData().empty());
-  auto object = ObjectFactory::Create(meta.GetTypeName());
+  std::unique_ptr<Object> object;
+  {
+    GetObjectProfile::Timer timer(GetObjectProfile::kCreate);
+    object = ObjectFactory::Create(meta.GetTypeId(), meta.GetTypeName());
+  }
   if (object == nullptr) {
     object = std::unique_ptr<Object>(new Object());
   }
-  object->Construct(meta);
+  {
+    GetObjectProfile::Timer timer(GetObjectProfile::kConstruct);
+    object->Construct(meta);
+  }
+  scope.Commit(meta.GetTypeName());
   return object;
 }
 
 Status RPCClient::GetObject(const ObjectID id,
                             std::shared_ptr<Object>& object) {
+  GetObjectProfile::Scope scope(profile_.get());
   ObjectMeta meta;
   RETURN_ON_ERROR(this->GetMetaData(id, meta, true));
   RETURN_ON_ASSERT(!meta.MetaData().empty());
-  object = ObjectFactory::Create(meta.GetTypeName());
+  {
+    GetObjectProfile::Timer timer(GetObjectProfile::kCreate);
+    object = ObjectFactory::Create(meta.GetTypeId(), meta.GetTypeName());
+  }
   if (object == nullptr) {
     object = std::unique_ptr<Object>(new Object());
   }
-  object->Construct(meta);
+  {
+    GetObjectProfile::Timer timer(GetObjectProfile::kConstruct);
+    object->Construct(meta);
+  }
+  scope.Commit(meta.GetTypeName());
   return Status::OK();
 }
 
@@ -149,7 +192,7 @@ std::vector<std::shared_ptr<Object>> RPCClient::GetObjects(
   }
   std::vector<std::shared_ptr<Object>> objects;
   for (auto const& meta : metas) {
-    auto object = ObjectFactory::Create(meta.GetTypeName());
+    auto object = ObjectFactory::Create(meta.GetTypeId(), meta.GetTypeName());
     if (object == nullptr) {
       object = std::unique_ptr<Object>(new Object());
     }
@@ -170,7 +213,7 @@ std::vector<std::shared_ptr<Object>> RPCClient::ListObjects(
   for (auto const& kv : meta_trees) {
     ObjectMeta meta;
     meta.SetMetaData(this, kv.second);
-    auto object = ObjectFactory::Create(meta.GetTypeName());
+    auto object = ObjectFactory::Create(meta.GetTypeId(), meta.GetTypeName());
     if (object == nullptr) {
       object = std::unique_ptr<Object>(new Object());
     }
@@ -180,6 +223,291 @@ std::vector<std::shared_ptr<Object>> RPCClient::ListObjects(
   return objects;
 }
 
+Status RPCClient::ConnectDataStreams(size_t const num_streams,
+                                     size_t const chunk_size) {
+  ENSURE_CONNECTED(this);
+  RETURN_ON_ASSERT(chunk_size > 0, "The chunk size must be positive");
+  chunk_size_ = chunk_size;
+  while (data_streams_.size() < num_streams) {
+    std::unique_ptr<RPCClient> stream(new RPCClient());
+    RETURN_ON_ERROR(Fork(*stream));
+    data_streams_.emplace_back(std::move(stream));
+  }
+  return Status::OK();
+}
+
+Status RPCClient::GetRemoteBlobs(
+    std::set<ObjectID> const& ids, Client& client,
+    std::map<ObjectID, std::unique_ptr<BlobWriter>>& blobs) {
+  if (ids.empty()) {
+    return Status::OK();
+  }
+  ENSURE_CONNECTED(this);
+  if (!data_streams_.empty()) {
+    return getRemoteBlobsStriped(ids, client, blobs);
+  }
+  std::string message_out;
+  WriteGetRemoteBuffersRequest(
+      std::unordered_set<ObjectID>(ids.begin(), ids.end()), message_out);
+  RETURN_ON_ERROR(doWrite(message_out));
+  json message_in;
+  RETURN_ON_ERROR(doRead(message_in));
+  std::vector<Payload> payloads;
+  RETURN_ON_ERROR(ReadGetBuffersReply(message_in, payloads));
+
+  std::vector<size_t> sizes;
+  size_t total_size = 0;
+  for (auto const& payload : payloads) {
+    sizes.emplace_back(payload.data_size);
+    total_size += payload.data_size;
+  }
+  std::vector<std::unique_ptr<BlobWriter>> writers;
+  auto status = client.CreateBlobs(sizes, writers);
+
+  // the contents follow the reply in order, and must be drained even if the
+  // local blobs cannot be created, to keep the connection usable.
+  if (!status.ok()) {
+    std::vector<char> sink(std::min<size_t>(total_size, 1024 * 1024));
+    while (total_size > 0) {
+      size_t chunk = std::min(total_size, sink.size());
+      RETURN_ON_ERROR(recv_bytes(vineyard_conn_, sink.data(), chunk));
+      total_size -= chunk;
+    }
+    return status;
+  }
+  std::vector<struct iovec> iov(writers.size());
+  for (size_t idx = 0; idx < writers.size(); ++idx) {
+    iov[idx].iov_base = writers[idx]->data();
+    iov[idx].iov_len = sizes[idx];
+  }
+  status = recv_iovec(vineyard_conn_, iov.data(), iov.size());
+  if (!status.ok()) {
+    connected_ = false;
+    for (auto& writer : writers) {
+      VINEYARD_DISCARD(writer->Abort(client));
+    }
+    return status;
+  }
+  if (verify_checksums_) {
+    std::vector<ObjectID> blob_ids;
+    std::vector<int64_t> checksums;
+    for (auto const& payload : payloads) {
+      blob_ids.emplace_back(payload.object_id);
+      checksums.emplace_back(payload.checksum);
+    }
+    status = verifyChecksums(blob_ids, writers, checksums);
+    if (!status.ok()) {
+      for (auto& writer : writers) {
+        VINEYARD_DISCARD(writer->Abort(client));
+      }
+      return status;
+    }
+  }
+  for (size_t idx = 0; idx < writers.size(); ++idx) {
+    blobs.emplace(payloads[idx].object_id, std::move(writers[idx]));
+  }
+  return Status::OK();
+}
+
+Status RPCClient::getRemoteBlobsStriped(
+    std::set<ObjectID> const& ids, Client& client,
+    std::map<ObjectID, std::unique_ptr<BlobWriter>>& blobs) {
+  // the sizes of blobs are resolved from the metadata of the remote server
+  std::vector<ObjectID> blob_ids(ids.begin(), ids.end());
+  std::vector<json> trees;
+  RETURN_ON_ERROR(GetData(blob_ids, trees));
+  std::vector<size_t> sizes;
+  std::vector<int64_t> checksums;
+  for (auto const& tree : trees) {
+    RETURN_ON_ASSERT(tree.contains("length"), "Not a blob: " + tree.dump());
+    sizes.emplace_back(tree["length"].get<size_t>());
+    checksums.emplace_back(tree.value("checksum", static_cast<int64_t>(-1)));
+  }
+  std::vector<std::unique_ptr<BlobWriter>> writers;
+  RETURN_ON_ERROR(client.CreateBlobs(sizes, writers));
+
+  // stripe the chunks across all connections in a round-robin manner
+  size_t num_streams = data_streams_.size() + 1;
+  std::vector<std::vector<ObjectID>> chunk_ids(num_streams);
+  std::vector<std::vector<size_t>> chunk_offsets(num_streams),
+      chunk_sizes(num_streams);
+  std::vector<std::vector<char*>> chunk_destinations(num_streams);
+  size_t stream_index = 0;
+  for (size_t idx = 0; idx < blob_ids.size(); ++idx) {
+    for (size_t offset = 0; offset < sizes[idx]; offset += chunk_size_) {
+      chunk_ids[stream_index].emplace_back(blob_ids[idx]);
+      chunk_offsets[stream_index].emplace_back(offset);
+      chunk_sizes[stream_index].emplace_back(
+          std::min(chunk_size_, sizes[idx] - offset));
+      chunk_destinations[stream_index].emplace_back(writers[idx]->data() +
+                                                    offset);
+      stream_index = (stream_index + 1) % num_streams;
+    }
+  }
+
+  // n.b.: the chunks of this connection are fetched in the current thread,
+  // as the client mutex has been held.
+  std::vector<std::future<Status>> fetches;
+  for (size_t idx = 1; idx < num_streams; ++idx) {
+    fetches.emplace_back(std::async(
+        std::launch::async, &RPCClient::getRemoteBufferChunks,
+        data_streams_[idx - 1].get(), std::cref(chunk_ids[idx]),
+        std::cref(chunk_offsets[idx]), std::cref(chunk_sizes[idx]),
+        std::cref(chunk_destinations[idx])));
+  }
+  Status status = getRemoteBufferChunks(chunk_ids[0], chunk_offsets[0],
+                                        chunk_sizes[0], chunk_destinations[0]);
+  for (auto& fetch : fetches) {
+    auto s = fetch.get();
+    if (status.ok() && !s.ok()) {
+      status = s;
+    }
+  }
+  if (status.ok() && verify_checksums_) {
+    status = verifyChecksums(blob_ids, writers, checksums);
+  }
+  if (!status.ok()) {
+    for (auto& writer : writers) {
+      VINEYARD_DISCARD(writer->Abort(client));
+    }
+    return status;
+  }
+  for (size_t idx = 0; idx < writers.size(); ++idx) {
+    blobs.emplace(blob_ids[idx], std::move(writers[idx]));
+  }
+  return Status::OK();
+}
+
+Status RPCClient::verifyChecksums(
+    std::vector<ObjectID> const& ids,
+    std::vector<std::unique_ptr<BlobWriter>> const& writers,
+    std::vector<int64_t> const& checksums) {
+  // the blobs are verified one by one, and each is hashed by chunks in
+  // parallel.
+  for (size_t idx = 0; idx < writers.size(); ++idx) {
+    if (checksums[idx] < 0) {
+      continue;
+    }
+    uint32_t checksum =
+        memory::concurrent_crc32c(writers[idx]->data(), writers[idx]->size());
+    if (static_cast<int64_t>(checksum) != checksums[idx]) {
+      return Status::IOError("The content of the fetched blob " +
+                             ObjectIDToString(ids[idx]) +
+                             " is corrupted: checksum mismatches");
+    }
+  }
+  return Status::OK();
+}
+
+Status RPCClient::getRemoteBufferChunks(
+    std::vector<ObjectID> const& ids, std::vector<size_t> const& offsets,
+    std::vector<size_t> const& sizes, std::vector<char*> const& destinations) {
+  if (ids.empty()) {
+    return Status::OK();
+  }
+  std::lock_guard<std::recursive_mutex> guard(client_mutex_);
+  std::string message_out;
+  WriteGetRemoteBufferChunksRequest(ids, offsets, sizes, message_out);
+  RETURN_ON_ERROR(doWrite(message_out));
+  json message_in;
+  RETURN_ON_ERROR(doRead(message_in));
+  size_t total_size = 0;
+  RETURN_ON_ERROR(ReadGetRemoteBufferChunksReply(message_in, total_size));
+  size_t expected_size = 0;
+  for (auto const size : sizes) {
+    expected_size += size;
+  }
+  RETURN_ON_ASSERT(total_size == expected_size,
+                   "The size of returned chunks doesn't match");
+  std::vector<struct iovec> iov(ids.size());
+  for (size_t idx = 0; idx < ids.size(); ++idx) {
+    iov[idx].iov_base = destinations[idx];
+    iov[idx].iov_len = sizes[idx];
+  }
+  auto status = recv_iovec(vineyard_conn_, iov.data(), iov.size());
+  if (!status.ok()) {
+    connected_ = false;
+  }
+  return status;
+}
+
+Status RPCClient::SubscribeStream(ObjectID const id, size_t const credits,
+                                  bool const broadcast) {
+  ENSURE_CONNECTED(this);
+  RETURN_ON_ASSERT(binary_protocol_supported_,
+                   "The stream subscription requires the binary protocol");
+  RETURN_ON_ASSERT(subscribed_stream_ == InvalidObjectID(),
+                   "A stream has been subscribed on this connection");
+  RETURN_ON_ASSERT(credits > 0, "The credits shouldn't be zero");
+  std::string message_out;
+  WriteSubscribeStreamRequestBinary(
+      id, credits,
+      static_cast<int64_t>(broadcast ? OpenStreamMode::broadcast
+                                     : OpenStreamMode::read),
+      message_out);
+  RETURN_ON_ERROR(doWrite(message_out));
+  std::string message_in;
+  RETURN_ON_ERROR(doRead(message_in));
+  ObjectID stream_id = InvalidObjectID();
+  RETURN_ON_ERROR(ReadSubscribeStreamReplyBinary(message_in, stream_id));
+  RETURN_ON_ASSERT(stream_id == id, "Unexpected subscribed stream");
+  subscribed_stream_ = id;
+  received_chunks_ = 0;
+  return Status::OK();
+}
+
+Status RPCClient::ReceiveStreamChunks(
+    std::vector<std::shared_ptr<arrow::Buffer>>& chunks) {
+  ENSURE_CONNECTED(this);
+  RETURN_ON_ASSERT(subscribed_stream_ != InvalidObjectID(),
+                   "No stream has been subscribed on this connection");
+  std::string message_out;
+  if (received_chunks_ > 0) {
+    // the previous chunks have been consumed
+    WriteStreamCreditRequestBinary(subscribed_stream_, received_chunks_,
+                                   message_out);
+    RETURN_ON_ERROR(doWrite(message_out));
+    received_chunks_ = 0;
+  }
+  auto message_in = std::make_shared<std::string>();
+  RETURN_ON_ERROR(doRead(*message_in));
+  ObjectID stream_id = InvalidObjectID();
+  std::vector<std::pair<size_t, size_t>> payloads;
+  RETURN_ON_ERROR(ReadStreamChunksPushBinary(*message_in, stream_id, payloads));
+  RETURN_ON_ASSERT(stream_id == subscribed_stream_,
+                   "Unexpected chunks of stream " +
+                       ObjectIDToString(stream_id));
+  // the chunks refer to the pushed message, rather than copying again
+  chunks.clear();
+  for (auto const& payload : payloads) {
+    auto data = reinterpret_cast<const uint8_t*>(message_in->data()) +
+                payload.first;
+    chunks.emplace_back(new arrow::Buffer(data, payload.second),
+                        [message_in](arrow::Buffer* buffer) { delete buffer; });
+  }
+  received_chunks_ = chunks.size();
+  return Status::OK();
+}
+
+Status RPCClient::ForwardStream(ObjectID const id, Client& client,
+                                ObjectID const local_id,
+                                size_t const credits) {
+  RETURN_ON_ERROR(client.OpenStream(local_id, OpenStreamMode::write));
+  auto status = SubscribeStream(id, credits);
+  while (status.ok()) {
+    std::vector<std::shared_ptr<arrow::Buffer>> chunks;
+    status = ReceiveStreamChunks(chunks);
+    if (status.ok()) {
+      status = client.PutStreamChunks(local_id, chunks);
+    }
+  }
+  if (status.IsStreamDrained()) {
+    return client.StopStream(local_id, false);
+  }
+  VINEYARD_SUPPRESS(client.StopStream(local_id, true));
+  return status;
+}
+
 RPCClient::~RPCClient() { Disconnect(); }
 
 }  // namespace vineyard
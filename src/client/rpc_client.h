@@ -16,10 +16,14 @@ limitations under the License.
 #ifndef SRC_CLIENT_RPC_CLIENT_H_
 #define SRC_CLIENT_RPC_CLIENT_H_
 
+#include <map>
 #include <memory>
+#include <set>
 #include <string>
 #include <vector>
 
+#include "arrow/buffer.h"
+
 #include "client/client_base.h"
 #include "client/ds/i_object.h"
 #include "client/ds/object_meta.h"
@@ -29,6 +33,7 @@ limitations under the License.
 namespace vineyard {
 
 class BlobWriter;
+class Client;
 
 class RPCClient : public ClientBase {
  public:
@@ -196,6 +201,97 @@ class RPCClient : public ClientBase {
                                                    const bool regex = false,
                                                    size_t const limit = 5);
 
+  /**
+   * @brief Open extra data connections to the connected vineyard server, the
+   * contents of blobs fetched by `GetRemoteBlobs` will be striped across them
+   * in chunks.
+   *
+   * @param num_streams The number of extra data connections.
+   * @param chunk_size The size of the chunks that blobs are split into.
+   *
+   * @return Status that indicates whether the connect has succeeded.
+   */
+  Status ConnectDataStreams(size_t const num_streams,
+                            size_t const chunk_size = 4 * 1024 * 1024);
+
+  /**
+   * @brief Verify the content of blobs fetched by `GetRemoteBlobs` against
+   * the checksums computed by the remote server when they are sealed (see
+   * also the `--blob_checksum` option of vineyardd), the blobs without
+   * checksums are not verified.
+   */
+  void VerifyChecksums(const bool verify) { verify_checksums_ = verify; }
+
+  /**
+   * @brief Fetch the content of blobs from the connected (remote) vineyard
+   * server into newly created blobs in the local vineyard server of
+   * `client`.
+   *
+   * The content is received from the socket into the local shared memory
+   * directly, without any intermediate copy. When data streams are
+   * connected, chunks of blobs are fetched in parallel and reassembled in
+   * place.
+   *
+   * @param ids The blobs to fetch.
+   * @param client The IPC client of the local vineyard server.
+   * @param blobs The result mutable blobs, keyed by the remote blob ids.
+   *
+   * @return Status that indicates whether the fetch action has succeeded.
+   */
+  Status GetRemoteBlobs(std::set<ObjectID> const& ids, Client& client,
+                        std::map<ObjectID, std::unique_ptr<BlobWriter>>& blobs);
+
+  /**
+   * @brief Subscribe a stream on the connected (remote) vineyard server. The
+   * chunks are pushed to this client as soon as they are sealed, as long as
+   * the client has credits, i.e., at most `credits` chunks are in flight
+   * before being received by `ReceiveStreamChunks`.
+   *
+   * The connection is dedicated to the subscription afterwards, use `Fork`
+   * to open another connection for other requests.
+   *
+   * @param id The id of the remote stream.
+   * @param credits The number of chunks that can be pushed ahead.
+   * @param broadcast Whether to subscribe as one of the consumers of a
+   * broadcast stream, see also `OpenStreamMode::broadcast`.
+   *
+   * @return Status that indicates whether the subscription has succeeded.
+   */
+  Status SubscribeStream(ObjectID const id, size_t const credits = 8,
+                         bool const broadcast = false);
+
+  /**
+   * @brief Receive the pushed chunks of the subscribed stream, blocked until
+   * there are chunks available. The credits of chunks received by the
+   * previous call are granted back before blocking.
+   *
+   * A status code `kStreamDrained` or `kStreamFailed` will be returned when
+   * the remote stream has been stopped.
+   *
+   * @param chunks The received chunks, which are at least one.
+   *
+   * @return Status that indicates whether the receiving has succeeded.
+   */
+  Status ReceiveStreamChunks(
+      std::vector<std::shared_ptr<arrow::Buffer>>& chunks);
+
+  /**
+   * @brief Subscribe the remote stream, and publish the received chunks to a
+   * stream in the local vineyard server of `client` as they arrive, until
+   * the remote stream stops. The local stream will be stopped in the same
+   * state.
+   *
+   * @param id The id of the remote stream.
+   * @param client The IPC client of the local vineyard server.
+   * @param local_id The id of the local stream, which will be opened for
+   * write.
+   * @param credits The number of chunks that can be pushed ahead.
+   *
+   * @return Status that indicates whether the forwarding has succeeded.
+   */
+  Status ForwardStream(ObjectID const id, Client& client,
+                       ObjectID const local_id, size_t const credits = 8);
+
   /**
    * @brief Get the remote instance id of the connected vineyard server.
    *
@@ -206,8 +302,42 @@ class RPCClient : public ClientBase {
    */
   const InstanceID remote_instance_id() const { return remote_instance_id_; }
 
+ protected:
+  Status connectAnother(int& conn) override;
+
  private:
+  Status getRemoteBlobsStriped(
+      std::set<ObjectID> const& ids, Client& client,
+      std::map<ObjectID, std::unique_ptr<BlobWriter>>& blobs);
+
+  /**
+   * @brief Fetch the chunks into the given destinations, over this
+   * connection.
+   */
+  /**
+   * @brief Verify the received content against the checksums, -1 means the
+   * checksum is unknown.
+   */
+  Status verifyChecksums(
+      std::vector<ObjectID> const& ids,
+      std::vector<std::unique_ptr<BlobWriter>> const& writers,
+      std::vector<int64_t> const& checksums);
+
+  Status getRemoteBufferChunks(std::vector<ObjectID> const& ids,
+                               std::vector<size_t> const& offsets,
+                               std::vector<size_t> const& sizes,
+                               std::vector<char*> const& destinations);
+
   InstanceID remote_instance_id_;
+
+  std::vector<std::unique_ptr<RPCClient>> data_streams_;
+  size_t chunk_size_ = 4 * 1024 * 1024;
+  bool verify_checksums_ = false;
+
+  // the subscribed stream, and the number of chunks that have been received
+  // but haven't been granted back as credits.
+  ObjectID subscribed_stream_ = InvalidObjectID();
+  size_t received_chunks_ = 0;
 };
 
 }  // namespace vineyard
@@ -0,0 +1,104 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+
+#include "client/subscription.h"
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "client/io.h"
+#include "common/util/logging.h"
+#include "common/util/protocols.h"
+
+namespace vineyard {
+
+ObjectSubscription::ObjectSubscription(const ObjectFilter& filter,
+                                       callback_t callback)
+    : filter_(filter), callback_(callback) {}
+
+ObjectSubscription::~ObjectSubscription() {
+  if (conn_ != -1) {
+    // unblock the listener
+    shutdown(conn_, SHUT_RDWR);
+  }
+  if (listener_.joinable()) {
+    listener_.join();
+  }
+  if (conn_ != -1) {
+    close(conn_);
+  }
+}
+
+Status ObjectSubscription::Subscribe(const int conn) {
+  RETURN_ON_ASSERT(conn_ == -1, "The objects have been subscribed");
+  conn_ = conn;
+  auto subscribe = [this]() -> Status {
+    std::string message_out, message_in;
+    WriteRegisterRequest(message_out);
+    RETURN_ON_ERROR(send_message(conn_, message_out));
+    RETURN_ON_ERROR(recv_message(conn_, message_in));
+    std::string ipc_socket_value, rpc_endpoint_value, version;
+    InstanceID instance_id = UnspecifiedInstanceID();
+    RETURN_ON_ERROR(CATCH_JSON_ERROR(ReadRegisterReply(
+        json::parse(message_in), ipc_socket_value, rpc_endpoint_value,
+        instance_id, version)));
+
+    WriteSubscribeObjectsRequest(filter_.type_pattern, filter_.name_prefix,
+                                 filter_.labels, message_out);
+    RETURN_ON_ERROR(send_message(conn_, message_out));
+    RETURN_ON_ERROR(recv_message(conn_, message_in));
+    return CATCH_JSON_ERROR(ReadSubscribeObjectsReply(json::parse(message_in)));
+  };
+  auto status = subscribe();
+  if (!status.ok()) {
+    close(conn_);
+    conn_ = -1;
+    return status;
+  }
+  subscribed_.store(true);
+  listener_ = std::thread([this]() { this->listen(); });
+  return Status::OK();
+}
+
+void ObjectSubscription::listen() {
+  std::string message_in;
+  while (true) {
+    auto status = recv_message(conn_, message_in);
+    if (!status.ok()) {
+      break;
+    }
+    json events;
+    status = CATCH_JSON_ERROR(
+        ReadObjectsNotification(json::parse(message_in), events));
+    if (!status.ok()) {
+      LOG(ERROR) << "Failed to read the object events: " << status.ToString();
+      continue;
+    }
+    for (auto const& item : events) {
+      ObjectEvent event;
+      event.id = item.value("id", InvalidObjectID());
+      event.type_name = item.value("typename", "");
+      event.signature = item.value("signature", InvalidSignature());
+      event.instance_id = item.value("instance_id", UnspecifiedInstanceID());
+      event.transient = item.value("transient", true);
+      event.name = item.value("name", "");
+      callback_(event);
+    }
+  }
+  subscribed_.store(false);
+}
+
+}  // namespace vineyard
@@ -0,0 +1,94 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+
+#ifndef SRC_CLIENT_SUBSCRIPTION_H_
+#define SRC_CLIENT_SUBSCRIPTION_H_
+
+#include <atomic>
+#include <functional>
+#include <map>
+#include <string>
+#include <thread>
+
+#include "common/util/status.h"
+#include "common/util/uuid.h"
+
+namespace vineyard {
+
+/**
+ * @brief The conditions of the subscribed objects, the empty conditions
+ * match all objects.
+ */
+struct ObjectFilter {
+  // the wildcard pattern of the typename, e.g., "vineyard::Tensor<*>"
+  std::string type_pattern;
+  // the prefix of the names, only the events of putting names match it
+  std::string name_prefix;
+  // the string-valued keys in the metadata, e.g., `meta.AddKeyValue(k, v)`
+  std::map<std::string, std::string> labels;
+};
+
+/**
+ * @brief The event of an object that is created (or persisted) somewhere in
+ * the cluster, or has been given a name.
+ */
+struct ObjectEvent {
+  ObjectID id;
+  std::string type_name;
+  Signature signature;
+  InstanceID instance_id;
+  bool transient;
+  // non-empty if the event is caused by putting the name
+  std::string name;
+};
+
+/**
+ * @brief ObjectSubscription receives the events of the objects that match
+ * the filter on a dedicated connection, the events are pushed by the server
+ * and the callback is invoked on a background thread in order.
+ *
+ * The subscription ends when it is destructed or the connection is lost.
+ */
+class ObjectSubscription {
+ public:
+  using callback_t = std::function<void(const ObjectEvent&)>;
+
+  ObjectSubscription(const ObjectFilter& filter, callback_t callback);
+
+  ~ObjectSubscription();
+
+  /**
+   * @brief Subscribe on the given connection that has been connected to the
+   * server, the subscription takes the ownership of the connection.
+   */
+  Status Subscribe(const int conn);
+
+  bool Subscribed() const { return subscribed_.load(); }
+
+ private:
+  void listen();
+
+  const ObjectFilter filter_;
+  callback_t callback_;
+
+  int conn_ = -1;
+  std::atomic_bool subscribed_{false};
+  std::thread listener_;
+};
+
+}  // namespace vineyard
+
+#endif  // SRC_CLIENT_SUBSCRIPTION_H_
@@ -30,6 +30,14 @@ namespace vineyard {
   std::lock_guard<std::recursive_mutex> __guard(this->client_mutex_)
 #endif  // ENSURE_CONNECTED
 
+// the client is locked when the request is issued, see also `doRequest`.
+#ifndef ENSURE_CONNECTED_UNLOCKED
+#define ENSURE_CONNECTED_UNLOCKED(this)                        \
+  if (!this->connected_) {                                     \
+    return Status::ConnectionError("Client is not connected"); \
+  }
+#endif  // ENSURE_CONNECTED_UNLOCKED
+
 }  // namespace vineyard
 
 #endif  // SRC_CLIENT_UTILS_H_
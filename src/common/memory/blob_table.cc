@@ -0,0 +1,276 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+
+#include "common/memory/blob_table.h"
+
+#include <errno.h>
+#include <string.h>
+#include <sys/mman.h>
+
+#include <new>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace vineyard {
+
+namespace {
+
+constexpr uint32_t kSlotLive = 1;
+constexpr uint32_t kSlotRemoved = 2;
+
+constexpr size_t kMinCapacity = 1024;
+constexpr size_t kMaxCapacity = 1UL << 28;
+
+// the table is rehashed once a quarter of slots are tombstones.
+constexpr size_t kTombstoneRatio = 4;
+
+// a reader gives up after the slot keeps being rewritten, and falls back to
+// the IPC.
+constexpr int kMaxRetries = 64;
+
+static_assert(ATOMIC_INT_LOCK_FREE == 2 && ATOMIC_LLONG_LOCK_FREE == 2,
+              "the blob table requires lock-free atomics");
+
+}  // namespace
+
+BlobTable::BlobTable(uint8_t* base, const size_t capacity, const bool writable)
+    : base_(base),
+      capacity_(capacity),
+      writable_(writable),
+      entries_(reinterpret_cast<BlobTableEntry*>(base)) {
+  if (writable_) {
+    for (size_t index = 0; index < capacity_; ++index) {
+      new (&entries_[index]) BlobTableEntry();
+      entries_[index].seq.store(0);
+      entries_[index].object_id.store(0);
+      entries_[index].state.store(0);
+    }
+  }
+}
+
+BlobTable::~BlobTable() {
+  if (base_ != nullptr) {
+    munmap(base_, RequiredSize(capacity_));
+  }
+}
+
+size_t BlobTable::RequiredSize(const size_t capacity) {
+  return capacity * sizeof(BlobTableEntry);
+}
+
+size_t BlobTable::AlignedCapacity(const size_t capacity) {
+  size_t aligned = kMinCapacity;
+  while (aligned < capacity && aligned < kMaxCapacity) {
+    aligned <<= 1;
+  }
+  return aligned;
+}
+
+Status BlobTable::Map(const int fd, const size_t capacity, const bool writable,
+                      std::shared_ptr<BlobTable>& table) {
+  RETURN_ON_ASSERT(capacity == AlignedCapacity(capacity),
+                   "Invalid capacity of the blob table");
+  void* base = mmap(nullptr, RequiredSize(capacity),
+                    writable ? (PROT_READ | PROT_WRITE) : PROT_READ,
+                    MAP_SHARED, fd, 0);
+  if (base == MAP_FAILED) {
+    return Status::IOError("Failed to mmap the blob table: " +
+                           std::string(strerror(errno)));
+  }
+  table.reset(
+      new BlobTable(reinterpret_cast<uint8_t*>(base), capacity, writable));
+  return Status::OK();
+}
+
+size_t BlobTable::slotOf(const ObjectID id) const {
+  // the ids of blobs are derived from addresses, mix the bits (splitmix64)
+  uint64_t value = id + 0x9e3779b97f4a7c15ULL;
+  value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  value = (value ^ (value >> 27)) * 0x94d049bb133111ebULL;
+  value = value ^ (value >> 31);
+  return value & (capacity_ - 1);
+}
+
+BlobTableEntry* BlobTable::find(const ObjectID id, bool& found) {
+  found = false;
+  BlobTableEntry* reusable = nullptr;
+  size_t slot = slotOf(id);
+  for (size_t probe = 0; probe < capacity_; ++probe) {
+    BlobTableEntry& entry = entries_[(slot + probe) & (capacity_ - 1)];
+    uint64_t object_id = entry.object_id.load(std::memory_order_relaxed);
+    uint32_t state = entry.state.load(std::memory_order_relaxed);
+    if (object_id == id && state == kSlotLive) {
+      found = true;
+      return &entry;
+    }
+    if (object_id == 0) {
+      return reusable != nullptr ? reusable : &entry;
+    }
+    if (state == kSlotRemoved && reusable == nullptr) {
+      reusable = &entry;
+    }
+  }
+  return reusable;
+}
+
+void BlobTable::write(BlobTableEntry& entry, const ObjectID id,
+                      const uint32_t state, const BlobLocation& location) {
+  uint64_t seq = entry.seq.load(std::memory_order_relaxed);
+  entry.seq.store(seq + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  entry.object_id.store(id, std::memory_order_relaxed);
+  entry.state.store(state, std::memory_order_relaxed);
+  entry.store_fd.store(location.store_fd, std::memory_order_relaxed);
+  entry.map_size.store(location.map_size, std::memory_order_relaxed);
+  entry.data_offset.store(location.data_offset, std::memory_order_relaxed);
+  entry.data_size.store(location.data_size, std::memory_order_relaxed);
+  entry.seq.store(seq + 2, std::memory_order_release);
+}
+
+bool BlobTable::Put(const ObjectID id, const BlobLocation& location) {
+  if (!writable_ || id == 0) {
+    return false;
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  bool found = false;
+  BlobTableEntry* entry = find(id, found);
+  if (entry == nullptr) {
+    return false;
+  }
+  if (!found && entry->state.load(std::memory_order_relaxed) == kSlotRemoved) {
+    tombstones_ -= 1;
+  }
+  write(*entry, id, kSlotLive, location);
+  if (!found) {
+    size_ += 1;
+  }
+  return true;
+}
+
+void BlobTable::Remove(const ObjectID id) {
+  if (!writable_) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  bool found = false;
+  BlobTableEntry* entry = find(id, found);
+  if (found) {
+    write(*entry, id, kSlotRemoved, BlobLocation());
+    size_ -= 1;
+    tombstones_ += 1;
+    clearTombstones(entry - entries_);
+    if (tombstones_ * kTombstoneRatio > capacity_) {
+      rehash();
+    }
+  }
+}
+
+void BlobTable::clearTombstones(size_t index) {
+  // no probe sequence passes the empty slot, thus the tombstones right
+  // before it are not needed to keep any sequence.
+  size_t const mask = capacity_ - 1;
+  if (entries_[(index + 1) & mask].object_id.load(
+          std::memory_order_relaxed) != 0) {
+    return;
+  }
+  for (size_t count = 0; count < capacity_; ++count) {
+    BlobTableEntry& entry = entries_[index];
+    if (entry.state.load(std::memory_order_relaxed) != kSlotRemoved) {
+      break;
+    }
+    write(entry, 0, 0, BlobLocation());
+    tombstones_ -= 1;
+    index = (index + mask) & mask;
+  }
+}
+
+void BlobTable::rehash() {
+  std::vector<std::pair<ObjectID, BlobLocation>> blobs;
+  blobs.reserve(size_);
+  for (size_t index = 0; index < capacity_; ++index) {
+    BlobTableEntry& entry = entries_[index];
+    uint64_t object_id = entry.object_id.load(std::memory_order_relaxed);
+    if (object_id == 0) {
+      continue;
+    }
+    if (entry.state.load(std::memory_order_relaxed) == kSlotLive) {
+      BlobLocation location;
+      location.store_fd = entry.store_fd.load(std::memory_order_relaxed);
+      location.map_size = entry.map_size.load(std::memory_order_relaxed);
+      location.data_offset =
+          entry.data_offset.load(std::memory_order_relaxed);
+      location.data_size = entry.data_size.load(std::memory_order_relaxed);
+      blobs.emplace_back(object_id, location);
+    }
+    write(entry, 0, 0, BlobLocation());
+  }
+  tombstones_ = 0;
+  for (auto const& blob : blobs) {
+    bool found = false;
+    BlobTableEntry* entry = find(blob.first, found);
+    write(*entry, blob.first, kSlotLive, blob.second);
+  }
+}
+
+bool BlobTable::Get(const ObjectID id, BlobLocation& location) const {
+  if (id == 0) {
+    return false;
+  }
+  size_t slot = slotOf(id);
+  for (size_t probe = 0; probe < capacity_; ++probe) {
+    const BlobTableEntry& entry = entries_[(slot + probe) & (capacity_ - 1)];
+    int retry = 0;
+    for (/* no init */; retry < kMaxRetries; ++retry) {
+      uint64_t seq = entry.seq.load(std::memory_order_acquire);
+      if (seq & 1) {
+        std::this_thread::yield();
+        continue;
+      }
+      uint64_t object_id = entry.object_id.load(std::memory_order_relaxed);
+      uint32_t state = entry.state.load(std::memory_order_relaxed);
+      BlobLocation value;
+      value.store_fd = entry.store_fd.load(std::memory_order_relaxed);
+      value.map_size = entry.map_size.load(std::memory_order_relaxed);
+      value.data_offset = entry.data_offset.load(std::memory_order_relaxed);
+      value.data_size = entry.data_size.load(std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (entry.seq.load(std::memory_order_relaxed) != seq) {
+        continue;
+      }
+      if (object_id == 0) {
+        return false;
+      }
+      if (object_id == id) {
+        if (state != kSlotLive) {
+          // keep probing, the blob may have been re-published in a later
+          // slot (e.g., a reused tombstone)
+          break;
+        }
+        location = value;
+        return true;
+      }
+      break;
+    }
+    if (retry == kMaxRetries) {
+      return false;
+    }
+  }
+  return false;
+}
+
+}  // namespace vineyard
@@ -0,0 +1,155 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+
+#ifndef SRC_COMMON_MEMORY_BLOB_TABLE_H_
+#define SRC_COMMON_MEMORY_BLOB_TABLE_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+
+#include "common/util/status.h"
+#include "common/util/uuid.h"
+
+namespace vineyard {
+
+/**
+ * @brief A slot of the blob table, the fields are guarded by the seqlock
+ * `seq`, which is odd while the slot is being written.
+ */
+struct BlobTableEntry {
+  alignas(64) std::atomic<uint64_t> seq;
+  std::atomic<uint64_t> object_id;  // 0 means the slot has never been used
+  std::atomic<uint32_t> state;
+  std::atomic<int32_t> store_fd;
+  std::atomic<int64_t> map_size;
+  std::atomic<int64_t> data_offset;
+  std::atomic<int64_t> data_size;
+};
+
+/**
+ * @brief The location of a blob resolved from the blob table.
+ */
+struct BlobLocation {
+  // the fd on the server side, i.e., the key of the client's mmap table
+  int store_fd = -1;
+  int64_t map_size = 0;
+  int64_t data_offset = 0;
+  int64_t data_size = 0;
+};
+
+/**
+ * @brief BlobTable is an open-addressing hash table from blob ids to their
+ * locations in the shared memory, it is written by the server and mapped
+ * (read-only) by clients, so that the blobs in segments that have been
+ * mapped can be resolved without a round trip.
+ *
+ * The server serializes the writers, and readers are lock-free: a reader
+ * retries a slot whenever the seqlock of the slot changes during reading.
+ * Removed slots are kept as tombstones to keep the probe sequences, and are
+ * reused by later insertions. Tombstones at the end of a probe sequence are
+ * cleared, and the table is rehashed in place once too many of them pile up,
+ * so that a miss doesn't probe the whole table. Readers may miss a blob
+ * during the rehash, and fall back to the IPC then.
+ */
+class BlobTable {
+ public:
+  ~BlobTable();
+
+  /**
+   * @brief The size of the memory segment for a table of the given number of
+   * slots.
+   */
+  static size_t RequiredSize(const size_t capacity);
+
+  /**
+   * @brief Round the number of slots to a power of two.
+   */
+  static size_t AlignedCapacity(const size_t capacity);
+
+  /**
+   * @brief Map the table behind the fd, the fd can be closed after mapping.
+   *
+   * @param writable Whether the table is mapped by the server, which
+   * initializes the slots of the newly created segment as well.
+   */
+  static Status Map(const int fd, const size_t capacity, const bool writable,
+                    std::shared_ptr<BlobTable>& table);
+
+  /**
+   * @brief Insert or update the location of a blob, returns false if the
+   * table is full.
+   */
+  bool Put(const ObjectID id, const BlobLocation& location);
+
+  void Remove(const ObjectID id);
+
+  /**
+   * @brief Lookup the blob, returns false if the blob hasn't been published
+   * or has been removed.
+   */
+  bool Get(const ObjectID id, BlobLocation& location) const;
+
+  size_t capacity() const { return capacity_; }
+
+  /**
+   * @brief The number of blobs that are published in the table.
+   */
+  size_t size() const { return size_.load(); }
+
+  /**
+   * @brief The number of removed slots that haven't been reused or cleared.
+   */
+  size_t tombstones() const { return tombstones_; }
+
+ private:
+  BlobTable(uint8_t* base, const size_t capacity, const bool writable);
+
+  // the first slot on the probe sequence, requires `capacity_` is a power of
+  // two.
+  size_t slotOf(const ObjectID id) const;
+
+  // finds the slot of the blob, or the slot to insert the blob into,
+  // requires `mutex_` been held.
+  BlobTableEntry* find(const ObjectID id, bool& found);
+
+  void write(BlobTableEntry& entry, const ObjectID id, const uint32_t state,
+             const BlobLocation& location);
+
+  // clears the tombstones that precede an empty slot, requires `mutex_` been
+  // held.
+  void clearTombstones(size_t index);
+
+  // re-inserts the live blobs to drop all tombstones, requires `mutex_` been
+  // held.
+  void rehash();
+
+  uint8_t* base_;
+  size_t capacity_;
+  bool writable_;
+  BlobTableEntry* entries_;
+
+  // the writers on the server side
+  std::mutex mutex_;
+  std::atomic<size_t> size_{0};
+  size_t tombstones_ = 0;
+};
+
+}  // namespace vineyard
+
+#endif  // SRC_COMMON_MEMORY_BLOB_TABLE_H_
@@ -0,0 +1,314 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+
+#include "common/memory/checksum.h"
+
+#include <algorithm>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#include <nmmintrin.h>
+#define VINEYARD_CRC32C_SSE42 1
+#elif defined(__ARM_FEATURE_CRC32)
+#include <arm_acle.h>
+#define VINEYARD_CRC32C_ARMV8 1
+#endif
+
+namespace vineyard {
+
+namespace memory {
+
+static constexpr uint64_t kPrime1 = 11400714785074694791ULL;
+static constexpr uint64_t kPrime2 = 14029467366897019727ULL;
+static constexpr uint64_t kPrime3 = 1609587929392839161ULL;
+static constexpr uint64_t kPrime4 = 9650029242287828579ULL;
+static constexpr uint64_t kPrime5 = 2870177450012600261ULL;
+
+static inline uint64_t rotl(const uint64_t x, const int r) {
+  return (x << r) | (x >> (64 - r));
+}
+
+static inline uint64_t read64(const uint8_t* p) {
+  uint64_t v;
+  memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+static inline uint32_t read32(const uint8_t* p) {
+  uint32_t v;
+  memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+static inline uint64_t xxh_round(uint64_t acc, const uint64_t input) {
+  acc += input * kPrime2;
+  acc = rotl(acc, 31);
+  return acc * kPrime1;
+}
+
+static inline uint64_t merge_round(uint64_t acc, const uint64_t value) {
+  acc ^= xxh_round(0, value);
+  return acc * kPrime1 + kPrime4;
+}
+
+uint64_t xxhash64(const void* data, const size_t size, const uint64_t seed) {
+  const uint8_t* p = reinterpret_cast<const uint8_t*>(data);
+  const uint8_t* const end = p + size;
+  uint64_t h;
+  if (size >= 32) {
+    const uint8_t* const limit = end - 32;
+    uint64_t v1 = seed + kPrime1 + kPrime2, v2 = seed + kPrime2, v3 = seed,
+             v4 = seed - kPrime1;
+    do {
+      v1 = xxh_round(v1, read64(p));
+      v2 = xxh_round(v2, read64(p + 8));
+      v3 = xxh_round(v3, read64(p + 16));
+      v4 = xxh_round(v4, read64(p + 24));
+      p += 32;
+    } while (p <= limit);
+    h = rotl(v1, 1) + rotl(v2, 7) + rotl(v3, 12) + rotl(v4, 18);
+    h = merge_round(h, v1);
+    h = merge_round(h, v2);
+    h = merge_round(h, v3);
+    h = merge_round(h, v4);
+  } else {
+    h = seed + kPrime5;
+  }
+  h += static_cast<uint64_t>(size);
+  for (; p + 8 <= end; p += 8) {
+    h ^= xxh_round(0, read64(p));
+    h = rotl(h, 27) * kPrime1 + kPrime4;
+  }
+  if (p + 4 <= end) {
+    h ^= static_cast<uint64_t>(read32(p)) * kPrime1;
+    h = rotl(h, 23) * kPrime2 + kPrime3;
+    p += 4;
+  }
+  for (; p < end; ++p) {
+    h ^= (*p) * kPrime5;
+    h = rotl(h, 11) * kPrime1;
+  }
+  h ^= h >> 33;
+  h *= kPrime2;
+  h ^= h >> 29;
+  h *= kPrime3;
+  h ^= h >> 32;
+  return h;
+}
+
+static size_t checksum_parallelism(const size_t concurrency,
+                                   const size_t chunks) {
+  size_t parallelism = concurrency;
+  if (parallelism == 0) {
+    parallelism = std::min<size_t>(
+        8, std::max<unsigned int>(1, std::thread::hardware_concurrency()));
+  }
+  return std::max<size_t>(1, std::min(parallelism, chunks));
+}
+
+// runs `func(chunk)` for all chunks with `parallelism` threads
+template <typename F>
+static void for_each_chunk(const size_t chunks, const size_t parallelism,
+                           F const& func) {
+  auto run = [&](size_t worker) {
+    for (size_t chunk = worker; chunk < chunks; chunk += parallelism) {
+      func(chunk);
+    }
+  };
+  std::vector<std::thread> workers;
+  for (size_t worker = 1; worker < parallelism; ++worker) {
+    workers.emplace_back(run, worker);
+  }
+  run(0);
+  for (auto& worker : workers) {
+    worker.join();
+  }
+}
+
+uint64_t concurrent_checksum(const void* data, const size_t size,
+                             const size_t concurrency) {
+  if (size <= kChecksumChunk) {
+    return xxhash64(data, size, size);
+  }
+  const uint8_t* source = reinterpret_cast<const uint8_t*>(data);
+  size_t const chunks = (size + kChecksumChunk - 1) / kChecksumChunk;
+  std::vector<uint64_t> digests(chunks);
+  for_each_chunk(chunks, checksum_parallelism(concurrency, chunks),
+                 [&](size_t chunk) {
+                   size_t offset = chunk * kChecksumChunk;
+                   digests[chunk] =
+                       xxhash64(source + offset,
+                                std::min(kChecksumChunk, size - offset));
+                 });
+  return xxhash64(digests.data(), digests.size() * sizeof(uint64_t), size);
+}
+
+namespace detail {
+
+struct crc32c_table_t {
+  uint32_t table[256];
+
+  crc32c_table_t() {
+    for (uint32_t index = 0; index < 256; ++index) {
+      uint32_t crc = index;
+      for (int bit = 0; bit < 8; ++bit) {
+        crc = (crc >> 1) ^ (0x82F63B78U & (0U - (crc & 1U)));
+      }
+      table[index] = crc;
+    }
+  }
+};
+
+static uint32_t crc32c_software(const uint8_t* p, size_t size, uint32_t crc) {
+  static const crc32c_table_t crc32c_table;
+  for (; size > 0; --size, ++p) {
+    crc = crc32c_table.table[(crc ^ *p) & 0xFF] ^ (crc >> 8);
+  }
+  return crc;
+}
+
+#if defined(VINEYARD_CRC32C_SSE42)
+__attribute__((target("sse4.2"))) static uint32_t crc32c_hardware(
+    const uint8_t* p, size_t size, uint32_t crc) {
+  uint64_t crc64 = crc;
+  for (; size >= 8; size -= 8, p += 8) {
+    crc64 = _mm_crc32_u64(crc64, read64(p));
+  }
+  crc = static_cast<uint32_t>(crc64);
+  for (; size > 0; --size, ++p) {
+    crc = _mm_crc32_u8(crc, *p);
+  }
+  return crc;
+}
+
+static bool crc32c_hardware_supported() {
+  static const bool supported = __builtin_cpu_supports("sse4.2");
+  return supported;
+}
+#elif defined(VINEYARD_CRC32C_ARMV8)
+static uint32_t crc32c_hardware(const uint8_t* p, size_t size, uint32_t crc) {
+  for (; size >= 8; size -= 8, p += 8) {
+    crc = __crc32cd(crc, read64(p));
+  }
+  for (; size > 0; --size, ++p) {
+    crc = __crc32cb(crc, *p);
+  }
+  return crc;
+}
+
+static bool crc32c_hardware_supported() { return true; }
+#else
+static uint32_t crc32c_hardware(const uint8_t* p, size_t size, uint32_t crc) {
+  return crc32c_software(p, size, crc);
+}
+
+static bool crc32c_hardware_supported() { return false; }
+#endif
+
+// multiplies the 32x32 matrix over GF(2) by the vector, see also zlib's
+// crc32_combine().
+static uint32_t gf2_matrix_times(const uint32_t* matrix, uint32_t vector) {
+  uint32_t sum = 0;
+  for (; vector != 0; vector >>= 1, ++matrix) {
+    if (vector & 1) {
+      sum ^= *matrix;
+    }
+  }
+  return sum;
+}
+
+static void gf2_matrix_square(uint32_t* square, const uint32_t* matrix) {
+  for (int n = 0; n < 32; ++n) {
+    square[n] = gf2_matrix_times(matrix, matrix[n]);
+  }
+}
+
+}  // namespace detail
+
+uint32_t crc32c_combine(uint32_t crc1, const uint32_t crc2, size_t size2) {
+  if (size2 == 0) {
+    return crc1;
+  }
+  uint32_t even[32], odd[32];
+  // the operator for one zero bit
+  odd[0] = 0x82F63B78U;
+  for (uint32_t n = 1, row = 1; n < 32; ++n, row <<= 1) {
+    odd[n] = row;
+  }
+  // the operators for two and four zero bits
+  detail::gf2_matrix_square(even, odd);
+  detail::gf2_matrix_square(odd, even);
+  // apply `size2` zero bytes to `crc1`
+  do {
+    detail::gf2_matrix_square(even, odd);
+    if (size2 & 1) {
+      crc1 = detail::gf2_matrix_times(even, crc1);
+    }
+    size2 >>= 1;
+    if (size2 == 0) {
+      break;
+    }
+    detail::gf2_matrix_square(odd, even);
+    if (size2 & 1) {
+      crc1 = detail::gf2_matrix_times(odd, crc1);
+    }
+    size2 >>= 1;
+  } while (size2 != 0);
+  return crc1 ^ crc2;
+}
+
+uint32_t crc32c(const void* data, const size_t size, const uint32_t crc) {
+  const uint8_t* p = reinterpret_cast<const uint8_t*>(data);
+  uint32_t value = ~crc;
+  if (detail::crc32c_hardware_supported()) {
+    value = detail::crc32c_hardware(p, size, value);
+  } else {
+    value = detail::crc32c_software(p, size, value);
+  }
+  return ~value;
+}
+
+uint32_t concurrent_crc32c(const void* data, const size_t size,
+                           const size_t concurrency) {
+  if (size <= kChecksumChunk) {
+    return crc32c(data, size);
+  }
+  const uint8_t* source = reinterpret_cast<const uint8_t*>(data);
+  size_t const chunks = (size + kChecksumChunk - 1) / kChecksumChunk;
+  std::vector<uint32_t> crcs(chunks);
+  for_each_chunk(chunks, checksum_parallelism(concurrency, chunks),
+                 [&](size_t chunk) {
+                   size_t offset = chunk * kChecksumChunk;
+                   crcs[chunk] =
+                       crc32c(source + offset,
+                              std::min(kChecksumChunk, size - offset));
+                 });
+  // combine the crcs of chunks, the result is the standard CRC32C of the
+  // whole region.
+  uint32_t crc = crcs[0];
+  for (size_t chunk = 1; chunk < chunks; ++chunk) {
+    size_t offset = chunk * kChecksumChunk;
+    crc = crc32c_combine(crc, crcs[chunk],
+                         std::min(kChecksumChunk, size - offset));
+  }
+  return crc;
+}
+
+}  // namespace memory
+
+}  // namespace vineyard
@@ -0,0 +1,76 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+
+#ifndef SRC_COMMON_MEMORY_CHECKSUM_H_
+#define SRC_COMMON_MEMORY_CHECKSUM_H_
+
+#include <cstddef>
+#include <cstdint>
+
+namespace vineyard {
+
+namespace memory {
+
+// the region is hashed by chunks of this size independently, and the digests
+// of chunks are hashed again, thus the result doesn't depend on the
+// concurrency.
+static constexpr size_t kChecksumChunk = 4UL * 1024 * 1024;
+
+/**
+ * @brief The 64-bits xxhash (XXH64) of the given region.
+ */
+uint64_t xxhash64(const void* data, const size_t size, const uint64_t seed = 0);
+
+/**
+ * @brief The checksum of a large region, whose chunks are hashed by multiple
+ * threads, see also `kChecksumChunk`.
+ *
+ * @param concurrency The maximum number of threads, 0 means using the
+ * hardware concurrency (at most 8 threads).
+ */
+uint64_t concurrent_checksum(const void* data, const size_t size,
+                             const size_t concurrency = 0);
+
+/**
+ * @brief The CRC32C (Castagnoli) of the given region, continuing from `crc`,
+ * using the SSE4.2 (or ARMv8) CRC instructions when available.
+ */
+uint32_t crc32c(const void* data, const size_t size, const uint32_t crc = 0);
+
+/**
+ * @brief The integrity checksum of blobs, i.e., the CRC32C for the regions
+ * up to `kChecksumChunk`, otherwise the CRC32C of the CRC32Cs of the chunks,
+ * which are computed by multiple threads.
+ *
+ * @param concurrency The maximum number of threads, 0 means using the
+ * hardware concurrency (at most 8 threads).
+ */
+/**
+ * @brief Returns the CRC32C of the concatenation of two regions, from the
+ * CRC32C of the first one, and the CRC32C and the size of the second one.
+ */
+uint32_t crc32c_combine(uint32_t crc1, const uint32_t crc2, size_t size2);
+
+// the chunks are checksummed concurrently and combined, the result is the
+// same as `crc32c()` of the whole region.
+uint32_t concurrent_crc32c(const void* data, const size_t size,
+                           const size_t concurrency = 0);
+
+}  // namespace memory
+
+}  // namespace vineyard
+
+#endif  // SRC_COMMON_MEMORY_CHECKSUM_H_
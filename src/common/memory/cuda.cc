@@ -0,0 +1,210 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+
+#include "common/memory/cuda.h"
+
+#include <dlfcn.h>
+
+#include <cstring>
+#include <mutex>
+#include <string>
+
+namespace vineyard {
+
+namespace memory {
+
+namespace {
+
+// see also `cudaHostRegisterFlags` in cuda_runtime_api.h
+constexpr unsigned int kCudaHostRegisterDefault = 0x00;
+constexpr unsigned int kCudaHostRegisterReadOnly = 0x08;
+constexpr unsigned int kCudaIpcMemLazyEnablePeerAccess = 0x01;
+
+// `cudaIpcMemHandle_t` is passed by value
+struct cuda_ipc_handle_t {
+  char reserved[kCudaIpcHandleSize];
+};
+
+using host_register_t = int (*)(void*, size_t, unsigned int);
+using host_unregister_t = int (*)(void*);
+using get_error_string_t = const char* (*)(int);
+using set_device_t = int (*)(int);
+using malloc_t = int (*)(void**, size_t);
+using free_t = int (*)(void*);
+using ipc_get_handle_t = int (*)(cuda_ipc_handle_t*, void*);
+using ipc_open_handle_t = int (*)(void**, cuda_ipc_handle_t, unsigned int);
+using ipc_close_handle_t = int (*)(void*);
+
+struct cuda_runtime_t {
+  void* handle = nullptr;
+  host_register_t host_register = nullptr;
+  host_unregister_t host_unregister = nullptr;
+  get_error_string_t get_error_string = nullptr;
+  set_device_t set_device = nullptr;
+  malloc_t malloc = nullptr;
+  free_t free = nullptr;
+  ipc_get_handle_t ipc_get_handle = nullptr;
+  ipc_open_handle_t ipc_open_handle = nullptr;
+  ipc_close_handle_t ipc_close_handle = nullptr;
+};
+
+cuda_runtime_t const& cuda_runtime() {
+  static cuda_runtime_t runtime;
+  static std::once_flag flag;
+  std::call_once(flag, []() {
+    for (auto const& library : {"libcudart.so", "libcudart.so.12",
+                                "libcudart.so.11.0", "libcudart.so.10.2"}) {
+      runtime.handle = dlopen(library, RTLD_NOW | RTLD_LOCAL);
+      if (runtime.handle != nullptr) {
+        break;
+      }
+    }
+    if (runtime.handle == nullptr) {
+      return;
+    }
+    runtime.host_register = reinterpret_cast<host_register_t>(
+        dlsym(runtime.handle, "cudaHostRegister"));
+    runtime.host_unregister = reinterpret_cast<host_unregister_t>(
+        dlsym(runtime.handle, "cudaHostUnregister"));
+    runtime.get_error_string = reinterpret_cast<get_error_string_t>(
+        dlsym(runtime.handle, "cudaGetErrorString"));
+    runtime.set_device = reinterpret_cast<set_device_t>(
+        dlsym(runtime.handle, "cudaSetDevice"));
+    runtime.malloc =
+        reinterpret_cast<malloc_t>(dlsym(runtime.handle, "cudaMalloc"));
+    runtime.free = reinterpret_cast<free_t>(dlsym(runtime.handle, "cudaFree"));
+    runtime.ipc_get_handle = reinterpret_cast<ipc_get_handle_t>(
+        dlsym(runtime.handle, "cudaIpcGetMemHandle"));
+    runtime.ipc_open_handle = reinterpret_cast<ipc_open_handle_t>(
+        dlsym(runtime.handle, "cudaIpcOpenMemHandle"));
+    runtime.ipc_close_handle = reinterpret_cast<ipc_close_handle_t>(
+        dlsym(runtime.handle, "cudaIpcCloseMemHandle"));
+  });
+  return runtime;
+}
+
+Status cuda_error(cuda_runtime_t const& runtime, std::string const& call,
+                  int error) {
+  std::string message = call + " failed with error " + std::to_string(error);
+  if (runtime.get_error_string) {
+    message += ": " + std::string(runtime.get_error_string(error));
+  }
+  return Status::IOError(message);
+}
+
+Status cuda_set_device(cuda_runtime_t const& runtime, const int device) {
+  if (runtime.set_device == nullptr || runtime.malloc == nullptr ||
+      runtime.free == nullptr || runtime.ipc_get_handle == nullptr ||
+      runtime.ipc_open_handle == nullptr ||
+      runtime.ipc_close_handle == nullptr) {
+    return Status::NotImplemented("The CUDA runtime is not available");
+  }
+  int error = runtime.set_device(device);
+  if (error != 0) {
+    return cuda_error(runtime, "cudaSetDevice", error);
+  }
+  return Status::OK();
+}
+
+}  // namespace
+
+Status cuda_host_register(void* pointer, size_t size, bool readonly) {
+  auto const& runtime = cuda_runtime();
+  if (runtime.host_register == nullptr) {
+    return Status::NotImplemented("The CUDA runtime is not available");
+  }
+  // registering read-only mappings requires the `ReadOnly` flag (CUDA 11.1+)
+  int error = runtime.host_register(
+      pointer, size,
+      readonly ? kCudaHostRegisterReadOnly : kCudaHostRegisterDefault);
+  if (error != 0) {
+    return cuda_error(runtime, "cudaHostRegister", error);
+  }
+  return Status::OK();
+}
+
+Status cuda_host_unregister(void* pointer) {
+  auto const& runtime = cuda_runtime();
+  if (runtime.host_unregister == nullptr) {
+    return Status::NotImplemented("The CUDA runtime is not available");
+  }
+  int error = runtime.host_unregister(pointer);
+  if (error != 0) {
+    return cuda_error(runtime, "cudaHostUnregister", error);
+  }
+  return Status::OK();
+}
+
+Status cuda_malloc(const int device, const size_t size, void** pointer,
+                   std::string& handle) {
+  auto const& runtime = cuda_runtime();
+  RETURN_ON_ERROR(cuda_set_device(runtime, device));
+  int error = runtime.malloc(pointer, size);
+  if (error != 0) {
+    return cuda_error(runtime, "cudaMalloc", error);
+  }
+  cuda_ipc_handle_t ipc_handle;
+  error = runtime.ipc_get_handle(&ipc_handle, *pointer);
+  if (error != 0) {
+    runtime.free(*pointer);
+    *pointer = nullptr;
+    return cuda_error(runtime, "cudaIpcGetMemHandle", error);
+  }
+  handle.assign(ipc_handle.reserved, kCudaIpcHandleSize);
+  return Status::OK();
+}
+
+Status cuda_free(const int device, void* pointer) {
+  auto const& runtime = cuda_runtime();
+  RETURN_ON_ERROR(cuda_set_device(runtime, device));
+  int error = runtime.free(pointer);
+  if (error != 0) {
+    return cuda_error(runtime, "cudaFree", error);
+  }
+  return Status::OK();
+}
+
+Status cuda_ipc_open(const int device, std::string const& handle,
+                     void** pointer) {
+  auto const& runtime = cuda_runtime();
+  RETURN_ON_ERROR(cuda_set_device(runtime, device));
+  RETURN_ON_ASSERT(handle.size() == kCudaIpcHandleSize,
+                   "Invalid CUDA IPC memory handle");
+  cuda_ipc_handle_t ipc_handle;
+  memcpy(ipc_handle.reserved, handle.data(), kCudaIpcHandleSize);
+  int error = runtime.ipc_open_handle(pointer, ipc_handle,
+                                      kCudaIpcMemLazyEnablePeerAccess);
+  if (error != 0) {
+    return cuda_error(runtime, "cudaIpcOpenMemHandle", error);
+  }
+  return Status::OK();
+}
+
+Status cuda_ipc_close(void* pointer) {
+  auto const& runtime = cuda_runtime();
+  if (runtime.ipc_close_handle == nullptr) {
+    return Status::NotImplemented("The CUDA runtime is not available");
+  }
+  int error = runtime.ipc_close_handle(pointer);
+  if (error != 0) {
+    return cuda_error(runtime, "cudaIpcCloseMemHandle", error);
+  }
+  return Status::OK();
+}
+
+}  // namespace memory
+
+}  // namespace vineyard
@@ -0,0 +1,68 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+
+#ifndef SRC_COMMON_MEMORY_CUDA_H_
+#define SRC_COMMON_MEMORY_CUDA_H_
+
+#include <cstddef>
+#include <string>
+
+#include "common/util/status.h"
+
+namespace vineyard {
+
+namespace memory {
+
+/**
+ * @brief Page-lock the mapped region with `cudaHostRegister`, so that the
+ * host-to-device copies from the shared memory can use DMA directly rather
+ * than being staged through pageable buffers.
+ *
+ * The CUDA runtime is loaded with `dlopen` on the first use, vineyard doesn't
+ * depend on it at build time, and `NotImplemented` is returned when the
+ * runtime is not available.
+ */
+Status cuda_host_register(void* pointer, size_t size, bool readonly);
+
+Status cuda_host_unregister(void* pointer);
+
+// the size of `cudaIpcMemHandle_t`
+static constexpr size_t kCudaIpcHandleSize = 64;
+
+/**
+ * @brief Allocate device memory on the given device, and export the
+ * allocation as a CUDA IPC memory handle, which can be opened by other
+ * processes (on the same host) with `cuda_ipc_open`.
+ */
+Status cuda_malloc(const int device, const size_t size, void** pointer,
+                   std::string& handle);
+
+Status cuda_free(const int device, void* pointer);
+
+/**
+ * @brief Map the device memory exported by another process into the address
+ * space of the current process.
+ */
+Status cuda_ipc_open(const int device, std::string const& handle,
+                     void** pointer);
+
+Status cuda_ipc_close(void* pointer);
+
+}  // namespace memory
+
+}  // namespace vineyard
+
+#endif  // SRC_COMMON_MEMORY_CUDA_H_
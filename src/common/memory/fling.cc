@@ -29,6 +29,10 @@
 #include <string.h>
 #include <sys/socket.h>
 #include <sys/uio.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <vector>
 
 #include "common/util/logging.h"
 
@@ -148,3 +152,103 @@ int recv_fd(int conn) {
 
   return found_fd;
 }
+
+int send_fds(int conn, const int* fds, size_t count) {
+  std::vector<char> buf(CMSG_SPACE(sizeof(int) * kMaxFdsPerMessage));
+  while (count > 0) {
+    size_t batch = std::min(count, kMaxFdsPerMessage);
+    struct msghdr msg;
+    struct iovec iov;
+    const size_t buf_len = CMSG_SPACE(sizeof(int) * batch);
+    memset(buf.data(), 0, buf_len);
+    init_msg(&msg, &iov, buf.data(), buf_len);
+
+    struct cmsghdr* header = CMSG_FIRSTHDR(&msg);
+    if (header == nullptr) {
+      LOG(ERROR) << "Error in init_msg: header is NULL";
+      return -1;
+    }
+    header->cmsg_level = SOL_SOCKET;
+    header->cmsg_type = SCM_RIGHTS;
+    header->cmsg_len = CMSG_LEN(sizeof(int) * batch);
+    memcpy(CMSG_DATA(header), fds, sizeof(int) * batch);
+
+    while (true) {
+      ssize_t r = sendmsg(conn, &msg, 0);
+      if (r < 0) {
+        if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) {
+          continue;
+        }
+        LOG(ERROR) << "Error in send_fds (errno = " << errno << ": "
+                   << strerror(errno) << ")";
+        return static_cast<int>(r);
+      } else if (r == 0) {
+        LOG(ERROR) << "Encountered unexpected EOF";
+        return -1;
+      }
+      break;
+    }
+    fds += batch;
+    count -= batch;
+  }
+  return 1;
+}
+
+int recv_fds(int conn, int* fds, size_t count) {
+  std::vector<char> buf(CMSG_SPACE(sizeof(int) * kMaxFdsPerMessage));
+  size_t received = 0;
+  auto cleanup = [&]() {
+    for (size_t i = 0; i < received; ++i) {
+      close(fds[i]);
+    }
+  };
+  while (received < count) {
+    struct msghdr msg;
+    struct iovec iov;
+    init_msg(&msg, &iov, buf.data(), buf.size());
+
+    ssize_t r = recvmsg(conn, &msg, 0);
+    if (r == -1) {
+      if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) {
+        continue;
+      }
+      LOG(ERROR) << "Error in recv_fds (errno = " << errno << ")";
+      cleanup();
+      return -1;
+    } else if (r == 0) {
+      LOG(ERROR) << "Encountered unexpected EOF";
+      cleanup();
+      return -1;
+    }
+
+    size_t before = received;
+    bool overflow = false;
+    for (struct cmsghdr* header = CMSG_FIRSTHDR(&msg); header != NULL;
+         header = CMSG_NXTHDR(&msg, header)) {
+      if (header->cmsg_level != SOL_SOCKET ||
+          header->cmsg_type != SCM_RIGHTS) {
+        continue;
+      }
+      size_t n =
+          (header->cmsg_len -
+           (CMSG_DATA(header) - reinterpret_cast<unsigned char*>(header))) /
+          sizeof(int);
+      for (size_t i = 0; i < n; ++i) {
+        int fd = (reinterpret_cast<int*>(CMSG_DATA(header)))[i];
+        if (received < count) {
+          fds[received++] = fd;
+        } else {
+          close(fd);
+          overflow = true;
+        }
+      }
+    }
+    if (received == before || overflow || (msg.msg_flags & MSG_CTRUNC)) {
+      errno = EBADMSG;
+      LOG(ERROR) << "Error in recv_fds: unexpected fds received in message";
+      cleanup();
+      return -1;
+    }
+  }
+  return 1;
+}
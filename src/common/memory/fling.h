@@ -39,6 +39,8 @@
 #include <sys/socket.h>
 #include <sys/uio.h>
 
+#include <cstddef>
+
 // This is necessary for Mac OS X, see http://www.apuebook.com/faqs2e.html
 // (10).
 #if !defined(CMSG_SPACE) && !defined(CMSG_LEN)
@@ -62,4 +64,28 @@ int send_fd(int conn, int fd);
 // @return File descriptor or a value < 0 on failure.
 int recv_fd(int conn);
 
+// The maximum number of file descriptors that can be passed in a single
+// message (SCM_MAX_FD in linux).
+constexpr size_t kMaxFdsPerMessage = 253;
+
+// Send file descriptors over a unix domain socket, at most
+// `kMaxFdsPerMessage` fds are packed into one control message.
+//
+// @param conn Unix domain socket to send the file descriptors over.
+// @param fds File descriptors to send over.
+// @param count The number of file descriptors.
+// @return Status code which is < 0 on failure.
+int send_fds(int conn, const int* fds, size_t count);
+
+// Receive exactly `count` file descriptors over a unix domain socket, the
+// messages may carry one or more fds, i.e., they may be sent either by
+// `send_fd` or by `send_fds`.
+//
+// @param conn Unix domain socket to receive the file descriptors from.
+// @param fds The received file descriptors.
+// @param count The number of file descriptors to receive.
+// @return Status code which is < 0 on failure, the received fds are closed
+//         on failure.
+int recv_fds(int conn, int* fds, size_t count);
+
 #endif  // SRC_COMMON_MEMORY_FLING_H_
@@ -14,6 +14,7 @@ limitations under the License.
 
 #include <algorithm>
 #include <string>
+#include <unordered_map>
 
 #define JEMALLOC_NO_DEMANGLE
 #include "jemalloc/include/jemalloc/jemalloc.h"
@@ -30,11 +31,16 @@ namespace memory {
 
 Jemalloc::arena_t Jemalloc::arenas_[Jemalloc::MAXIMUM_ARENAS];
 
+static void appendStats(void* opaque, const char* message) {
+  reinterpret_cast<std::string*>(opaque)->append(message);
+}
+
 Jemalloc::Jemalloc() {
   extent_hooks_ = static_cast<extent_hooks_t*>(malloc(sizeof(extent_hooks_t)));
 }
 
 Jemalloc::~Jemalloc() {
+  DestroyThreadCaches();
   if (extent_hooks_) {
     free(extent_hooks_);
   }
@@ -109,17 +115,65 @@ void* Jemalloc::Init(void* space, const size_t size) {
 }
 
 void* Jemalloc::Allocate(const size_t bytes, const size_t alignment) {
-  return vineyard_je_mallocx(std::max(bytes, alignment), flags_);
+  return vineyard_je_mallocx(std::max(bytes, alignment), flags());
 }
 
 void* Jemalloc::Reallocate(void* pointer, size_t size) {
-  return vineyard_je_rallocx(pointer, size, flags_);
+  return vineyard_je_rallocx(pointer, size, flags());
+}
+
+bool Jemalloc::ReallocateInPlace(void* pointer, size_t size) {
+  return vineyard_je_xallocx(pointer, size, 0, flags()) >= size;
 }
 
 void Jemalloc::Free(void* pointer, size_t) {
   if (pointer) {
-    vineyard_je_dallocx(pointer, flags_);
+    vineyard_je_dallocx(pointer, flags());
+  }
+}
+
+void Jemalloc::EnableThreadCache() { thread_cache_ = true; }
+
+void Jemalloc::DestroyThreadCaches() {
+  std::lock_guard<std::mutex> lock(tcaches_mutex_);
+  for (unsigned tcache : tcaches_) {
+    if (auto ret = vineyard_je_mallctl("tcache.destroy", nullptr, nullptr,
+                                       &tcache, sizeof(tcache))) {
+      int err = std::exchange(errno, ret);
+      PLOG(ERROR) << "Failed to destroy the thread cache " << tcache;
+      errno = err;
+    }
+  }
+  tcaches_.clear();
+  // the arena is about to be released, the stale caches of threads won't be
+  // looked up anymore as arena indices are never reused.
+  thread_cache_ = false;
+}
+
+int Jemalloc::flags() {
+  if (!thread_cache_) {
+    return flags_;
+  }
+  // arena index -> the explicit thread cache
+  thread_local std::unordered_map<unsigned, unsigned> tcaches;
+  auto iter = tcaches.find(arena_index_);
+  if (iter == tcaches.end()) {
+    unsigned tcache = 0;
+    size_t tcache_size = sizeof(tcache);
+    if (auto ret = vineyard_je_mallctl("tcache.create", &tcache, &tcache_size,
+                                       nullptr, 0)) {
+      int err = std::exchange(errno, ret);
+      PLOG(ERROR) << "Failed to create the thread cache";
+      errno = err;
+      return flags_;
+    }
+    {
+      std::lock_guard<std::mutex> lock(tcaches_mutex_);
+      tcaches_.emplace_back(tcache);
+    }
+    iter = tcaches.emplace(arena_index_, tcache).first;
   }
+  return MALLOCX_ARENA(arena_index_) | MALLOCX_TCACHE(iter->second);
 }
 
 void Jemalloc::Recycle(const bool /* unused currently */) {
@@ -151,6 +205,41 @@ void Jemalloc::Traverse() {
   }
 }
 
+void Jemalloc::Stats(const std::string& options, json& tree) {
+  // refresh the cached statistics
+  uint64_t epoch = 1;
+  size_t epoch_size = sizeof(epoch);
+  vineyard_je_mallctl("epoch", &epoch, &epoch_size, &epoch, epoch_size);
+
+  std::string content;
+  vineyard_je_malloc_stats_print(appendStats, &content,
+                                 ("J" + options).c_str());
+  json stats = json::parse(content, nullptr, false);
+  if (stats.is_discarded()) {
+    tree["stats"] = content;
+  } else {
+    tree["stats"] = stats;
+  }
+
+  arena_t const& arena = arenas_[arena_index_];
+  json layout;
+  layout["index"] = arena_index_;
+  layout["base"] = arena.base_pointer_;
+  layout["end"] = arena.base_end_pointer_;
+  // the extents are carved from the space sequentially
+  layout["extents_size"] = arena.pre_alloc_ - arena.base_pointer_;
+  std::string prefix = "stats.arenas." + std::to_string(arena_index_) + ".";
+  for (auto const& key : {"pactive", "pdirty", "pmuzzy", "mapped", "retained",
+                          "small.allocated", "large.allocated"}) {
+    size_t value = 0, value_size = sizeof(value);
+    if (vineyard_je_mallctl((prefix + key).c_str(), &value, &value_size,
+                            nullptr, 0) == 0) {
+      layout[key] = value;
+    }
+  }
+  tree["arena"] = layout;
+}
+
 void* Jemalloc::theAllocHook(extent_hooks_t* extent_hooks, void* new_addr,
                              size_t size, size_t alignment, bool* zero,
                              bool* commit, unsigned arena_index) {
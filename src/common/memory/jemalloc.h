@@ -18,6 +18,11 @@ limitations under the License.
 
 #if defined(WITH_JEMALLOC)
 
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "common/util/json.h"
 #include "server/memory/malloc.h"
 
 // forward declarations, to avoid include jemalloc/jemalloc.h.
@@ -39,16 +44,45 @@ class Jemalloc {
 
   void* Reallocate(void* pointer, size_t size);
 
+  /**
+   * Grow the allocation in place, returns false if it cannot be extended
+   * without moving.
+   */
+  bool ReallocateInPlace(void* pointer, size_t size);
+
   void Free(void* pointer, size_t = 0);
 
   void Recycle(const bool force = false);
 
+  /**
+   * Serve the allocations of each thread from its own cache, rather than from
+   * the arena directly, to avoid the contention among threads.
+   *
+   * The caches hold freed memory of the arena, and must be destroyed by
+   * `DestroyThreadCaches` before the arena is released.
+   */
+  void EnableThreadCache();
+
+  /**
+   * Flush and destroy the thread caches, requires no concurrent allocations.
+   */
+  void DestroyThreadCaches();
+
   size_t GetAllocatedSize(void* pointer);
 
   size_t EstimateAllocatedSize(const size_t size);
 
   void Traverse();
 
+  /**
+   * Dump the statistics of jemalloc (`malloc_stats_print`, in JSON), and the
+   * layout of the arena that serves the shared memory.
+   *
+   * @param options The options of `malloc_stats_print`, e.g., "a" omits the
+   *                per-arena statistics.
+   */
+  void Stats(const std::string& options, json& tree);
+
   static constexpr size_t Alignment = 1 * 1024 * 1024;  // 1MB
 
   struct arena_t {
@@ -60,6 +94,13 @@ class Jemalloc {
  private:
   unsigned arena_index_;
   int flags_ = 0;
+
+  bool thread_cache_ = false;
+  std::mutex tcaches_mutex_;
+  std::vector<unsigned> tcaches_;
+
+  // the flags of the calling thread, i.e., with the thread's cache
+  int flags();
   extent_hooks_t* extent_hooks_ = nullptr;
 
   static void* theAllocHook(extent_hooks_t* extent_hooks, void* new_addr,
@@ -0,0 +1,96 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+
+#include "common/memory/memcpy.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace vineyard {
+
+namespace memory {
+
+static void stream_memcpy(uint8_t* dst, const uint8_t* src, size_t size) {
+#if defined(__SSE2__)
+  // the non-temporal stores require the 16-bytes aligned destination
+  size_t head = std::min(
+      size, (16 - reinterpret_cast<uintptr_t>(dst) % 16) % 16);
+  memcpy(dst, src, head);
+  dst += head;
+  src += head;
+  size -= head;
+  for (size_t loops = size / 64; loops > 0; --loops) {
+    const __m128i* s = reinterpret_cast<const __m128i*>(src);
+    __m128i* d = reinterpret_cast<__m128i*>(dst);
+    __m128i v0 = _mm_loadu_si128(s + 0);
+    __m128i v1 = _mm_loadu_si128(s + 1);
+    __m128i v2 = _mm_loadu_si128(s + 2);
+    __m128i v3 = _mm_loadu_si128(s + 3);
+    _mm_stream_si128(d + 0, v0);
+    _mm_stream_si128(d + 1, v1);
+    _mm_stream_si128(d + 2, v2);
+    _mm_stream_si128(d + 3, v3);
+    src += 64;
+    dst += 64;
+  }
+  // make the streaming stores visible to the other threads
+  _mm_sfence();
+  memcpy(dst, src, size % 64);
+#else
+  memcpy(dst, src, size);
+#endif
+}
+
+void concurrent_memcpy(void* dst, const void* src, const size_t size,
+                       const size_t concurrency) {
+  if (size < kConcurrentMemcpyThreshold) {
+    memcpy(dst, src, size);
+    return;
+  }
+  size_t parallelism = concurrency;
+  if (parallelism == 0) {
+    parallelism = std::min<size_t>(
+        8, std::max<unsigned int>(1, std::thread::hardware_concurrency()));
+  }
+  parallelism = std::max<size_t>(
+      1, std::min(parallelism, size / kConcurrentMemcpyChunk));
+
+  uint8_t* target = reinterpret_cast<uint8_t*>(dst);
+  const uint8_t* source = reinterpret_cast<const uint8_t*>(src);
+  // split into the multiples of cache lines
+  size_t slice = (size / parallelism + 63) / 64 * 64;
+  std::vector<std::thread> workers;
+  for (size_t offset = slice; offset < size; offset += slice) {
+    size_t length = std::min(slice, size - offset);
+    workers.emplace_back(stream_memcpy, target + offset, source + offset,
+                         length);
+  }
+  stream_memcpy(target, source, std::min(slice, size));
+  for (auto& worker : workers) {
+    worker.join();
+  }
+}
+
+}  // namespace memory
+
+}  // namespace vineyard
@@ -0,0 +1,50 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+
+#ifndef SRC_COMMON_MEMORY_MEMCPY_H_
+#define SRC_COMMON_MEMORY_MEMCPY_H_
+
+#include <cstddef>
+
+namespace vineyard {
+
+namespace memory {
+
+// regions smaller than this are copied by a plain `memcpy`
+static constexpr size_t kConcurrentMemcpyThreshold = 32UL * 1024 * 1024;
+
+// each worker copies at least this many bytes
+static constexpr size_t kConcurrentMemcpyChunk = 8UL * 1024 * 1024;
+
+/**
+ * @brief Copy a large region with multiple threads, using non-temporal
+ * stores for the destination, since the freshly filled blobs are unlikely
+ * to be read back from the cache by the writer.
+ *
+ * The workers inherit the CPU affinity of the calling thread, thus keep the
+ * calling thread on the NUMA node of the destination to copy locally.
+ *
+ * @param concurrency The maximum number of threads, 0 means using the
+ * hardware concurrency (at most 8 threads).
+ */
+void concurrent_memcpy(void* dst, const void* src, const size_t size,
+                       const size_t concurrency = 0);
+
+}  // namespace memory
+
+}  // namespace vineyard
+
+#endif  // SRC_COMMON_MEMORY_MEMCPY_H_
@@ -17,6 +17,35 @@ limitations under the License.
 
 namespace vineyard {
 
+namespace {
+
+// the IPC handles are opaque bytes, hex-encoded in JSON.
+std::string EncodeHandle(std::string const& handle) {
+  static const char digits[] = "0123456789abcdef";
+  std::string encoded;
+  encoded.reserve(handle.size() * 2);
+  for (unsigned char c : handle) {
+    encoded.push_back(digits[c >> 4]);
+    encoded.push_back(digits[c & 0x0f]);
+  }
+  return encoded;
+}
+
+std::string DecodeHandle(std::string const& encoded) {
+  auto value = [](char c) -> int {
+    return c <= '9' ? c - '0' : c - 'a' + 10;
+  };
+  std::string handle;
+  handle.reserve(encoded.size() / 2);
+  for (size_t i = 0; i + 1 < encoded.size(); i += 2) {
+    handle.push_back(
+        static_cast<char>((value(encoded[i]) << 4) | value(encoded[i + 1])));
+  }
+  return handle;
+}
+
+}  // namespace
+
 json Payload::ToJSON() const {
   json payload;
   this->ToJSON(payload);
@@ -29,6 +58,15 @@ void Payload::ToJSON(json& tree) const {
   tree["data_offset"] = data_offset;
   tree["data_size"] = data_size;
   tree["map_size"] = map_size;
+  tree["page_size"] = page_size;
+  tree["numa_node"] = numa_node;
+  if (checksum >= 0) {
+    tree["checksum"] = checksum;
+  }
+  if (device >= 0) {
+    tree["device"] = device;
+    tree["ipc_handle"] = EncodeHandle(ipc_handle);
+  }
 }
 
 void Payload::FromJSON(const json& tree) {
@@ -37,6 +75,15 @@ void Payload::FromJSON(const json& tree) {
   data_offset = tree["data_offset"].get<ptrdiff_t>();
   data_size = tree["data_size"].get<int64_t>();
   map_size = tree["map_size"].get<int64_t>();
+  page_size = tree.value("page_size", static_cast<int64_t>(0));
+  numa_node = tree.value("numa_node", -1);
+  device = tree.value("device", -1);
+  checksum = tree.value("checksum", static_cast<int64_t>(-1));
+  if (device >= 0) {
+    ipc_handle = DecodeHandle(tree["ipc_handle"].get_ref<std::string const&>());
+  } else {
+    ipc_handle.clear();
+  }
   pointer = nullptr;
 }
 
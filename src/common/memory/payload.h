@@ -17,6 +17,7 @@ limitations under the License.
 #define SRC_COMMON_MEMORY_PAYLOAD_H_
 
 #include <memory>
+#include <string>
 
 #include "common/util/json.h"
 #include "common/util/uuid.h"
@@ -30,7 +31,31 @@ struct Payload {
   ptrdiff_t data_offset;
   int64_t data_size;
   int64_t map_size;
+  // page size of the underlying memory segment, 0 means normal pages.
+  int64_t page_size;
+  // the NUMA node that the blob is placed on, -1 means unknown.
+  int numa_node;
+  // the CUDA device that the blob is placed on, -1 means host memory.
+  //
+  // device blobs are shared through the CUDA IPC memory handle rather than
+  // the fd, and `pointer` is a device pointer.
+  int device;
+  std::string ipc_handle;
   uint8_t* pointer;
+  // the CRC32C of the sealed content (see also `memory::concurrent_crc32c`),
+  // -1 means unknown.
+  int64_t checksum;
+
+  // server-side states, won't be sent to clients.
+  bool is_persisted;
+  bool is_spilled;
+  // whether the blob has become a member of some object.
+  bool is_sealed;
+  // whether the blob is mapped from a file (see also
+  // `BulkStore::CreateFromFile`), which may be truncated by others, thus the
+  // server never reads it through the mapping.
+  bool is_file;
+  int64_t ref_cnt;
 
   Payload()
       : object_id(EmptyBlobID()),
@@ -39,7 +64,16 @@ struct Payload {
         data_offset(0),
         data_size(0),
         map_size(0),
-        pointer(nullptr) {}
+        page_size(0),
+        numa_node(-1),
+        device(-1),
+        pointer(nullptr),
+        checksum(-1),
+        is_persisted(false),
+        is_spilled(false),
+        is_sealed(false),
+        is_file(false),
+        ref_cnt(0) {}
 
   Payload(ObjectID object_id, int64_t size, uint8_t* ptr, int fd, int64_t msize,
           ptrdiff_t offset)
@@ -49,7 +83,16 @@ struct Payload {
         data_offset(offset),
         data_size(size),
         map_size(msize),
-        pointer(ptr) {}
+        page_size(0),
+        numa_node(-1),
+        device(-1),
+        pointer(ptr),
+        checksum(-1),
+        is_persisted(false),
+        is_spilled(false),
+        is_sealed(false),
+        is_file(false),
+        ref_cnt(0) {}
 
   Payload(ObjectID object_id, int64_t size, uint8_t* ptr, int fd, int arena_fd,
           int64_t msize, ptrdiff_t offset)
@@ -59,7 +102,18 @@ struct Payload {
         data_offset(offset),
         data_size(size),
         map_size(msize),
-        pointer(ptr) {}
+        page_size(0),
+        numa_node(-1),
+        device(-1),
+        pointer(ptr),
+        checksum(-1),
+        is_persisted(false),
+        is_spilled(false),
+        is_sealed(false),
+        is_file(false),
+        ref_cnt(0) {}
+
+  bool IsDevice() const { return device >= 0; }
 
   static std::shared_ptr<Payload> MakeEmpty() {
     static std::shared_ptr<Payload> payload = std::make_shared<Payload>();
@@ -0,0 +1,290 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "common/memory/ring_buffer.h"
+
+#include <errno.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#if defined(__linux__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <time.h>
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <new>
+#include <thread>
+
+#include "common/util/logging.h"
+
+namespace vineyard {
+
+namespace {
+
+// Spin for a few microseconds before sleeping, as the peer usually replies
+// shortly for cheap requests. Spinning is useless on a single core.
+inline int spin_count() {
+  static const int count = std::thread::hardware_concurrency() > 1 ? 2048 : 0;
+  return count;
+}
+
+// The timeout of each futex wait, to re-check whether the peer is alive.
+constexpr int64_t kWaitTimeoutMicros = 10 * 1000;
+
+constexpr size_t kMinCapacity = 4096;
+constexpr size_t kMaxCapacity = 64 * 1024 * 1024;
+
+static_assert(ATOMIC_INT_LOCK_FREE == 2 && ATOMIC_LLONG_LOCK_FREE == 2,
+              "the ring buffer requires lock-free atomics");
+
+inline void cpu_relax() {
+#if defined(__x86_64__) || defined(__i386__)
+  __builtin_ia32_pause();
+#elif defined(__aarch64__)
+  asm volatile("yield" ::: "memory");
+#endif
+}
+
+inline void futex_wait(std::atomic<uint32_t>* word, uint32_t value) {
+#if defined(__linux__)
+  struct timespec timeout;
+  timeout.tv_sec = kWaitTimeoutMicros / 1000000;
+  timeout.tv_nsec = (kWaitTimeoutMicros % 1000000) * 1000;
+  // n.b.: not FUTEX_WAIT_PRIVATE, as the word is shared between processes.
+  syscall(SYS_futex, reinterpret_cast<uint32_t*>(word), FUTEX_WAIT, value,
+          &timeout, nullptr, 0);
+#else
+  std::this_thread::sleep_for(std::chrono::microseconds(50));
+#endif
+}
+
+inline void futex_wake(std::atomic<uint32_t>* word) {
+#if defined(__linux__)
+  syscall(SYS_futex, reinterpret_cast<uint32_t*>(word), FUTEX_WAKE, INT_MAX,
+          nullptr, nullptr, 0);
+#endif
+}
+
+}  // namespace
+
+RingBuffer::RingBuffer(uint8_t* base, size_t capacity, bool initialize)
+    : header_(reinterpret_cast<RingBufferHeader*>(base)),
+      data_(reinterpret_cast<char*>(base + sizeof(RingBufferHeader))),
+      capacity_(capacity) {
+  if (initialize) {
+    new (header_) RingBufferHeader();
+    header_->head.store(0);
+    header_->tail.store(0);
+    header_->readable.store(0);
+    header_->reader_waiting.store(0);
+    header_->writable.store(0);
+    header_->writer_waiting.store(0);
+    header_->closed.store(0);
+  }
+}
+
+Status RingBuffer::WriteMessage(const std::string& msg,
+                                std::function<bool()> const& alive) {
+  size_t length = msg.size();
+  RETURN_ON_ERROR(
+      write(reinterpret_cast<const char*>(&length), sizeof(size_t), alive));
+  return write(msg.data(), length, alive);
+}
+
+Status RingBuffer::ReadMessage(std::string& msg,
+                               std::function<bool()> const& alive) {
+  size_t length;
+  RETURN_ON_ERROR(
+      read(reinterpret_cast<char*>(&length), sizeof(size_t), alive));
+  // the length comes from the peer, thus the message grows (by at most the
+  // capacity of the ring each time) as the body arrives rather than being
+  // allocated up front.
+  msg.clear();
+  while (msg.size() < length) {
+    size_t offset = msg.size();
+    size_t chunk = std::min(length - offset, capacity_);
+    msg.resize(offset + chunk);
+    RETURN_ON_ERROR(read(&msg[offset], chunk, alive));
+  }
+  // keep the same as `recv_message`
+  msg.push_back('\0');
+  return Status::OK();
+}
+
+void RingBuffer::Close() {
+  header_->closed.store(1);
+  notify(header_->readable, header_->reader_waiting);
+  notify(header_->writable, header_->writer_waiting);
+}
+
+bool RingBuffer::Closed() const { return header_->closed.load() != 0; }
+
+Status RingBuffer::write(const char* data, size_t size,
+                         std::function<bool()> const& alive) {
+  size_t written = 0;
+  while (written < size) {
+    uint64_t tail = header_->tail.load(std::memory_order_relaxed);
+    uint64_t head = header_->head.load();
+    if (tail - head > capacity_) {
+      return corrupted();
+    }
+    size_t space = capacity_ - (tail - head);
+    if (space == 0) {
+      RETURN_ON_ERROR(wait(
+          header_->writable, header_->writer_waiting,
+          [this, tail]() { return tail - header_->head.load() < capacity_; },
+          alive));
+      continue;
+    }
+    size_t chunk = std::min(space, size - written);
+    size_t offset = tail % capacity_;
+    size_t first = std::min(chunk, capacity_ - offset);
+    memcpy(data_ + offset, data + written, first);
+    memcpy(data_, data + written + first, chunk - first);
+    header_->tail.store(tail + chunk);
+    notify(header_->readable, header_->reader_waiting);
+    written += chunk;
+  }
+  return Status::OK();
+}
+
+Status RingBuffer::read(char* data, size_t size,
+                        std::function<bool()> const& alive) {
+  size_t consumed = 0;
+  while (consumed < size) {
+    uint64_t head = header_->head.load(std::memory_order_relaxed);
+    size_t available = header_->tail.load() - head;
+    if (available > capacity_) {
+      return corrupted();
+    }
+    if (available == 0) {
+      RETURN_ON_ERROR(wait(
+          header_->readable, header_->reader_waiting,
+          [this, head]() { return header_->tail.load() != head; }, alive));
+      continue;
+    }
+    size_t chunk = std::min(available, size - consumed);
+    size_t offset = head % capacity_;
+    size_t first = std::min(chunk, capacity_ - offset);
+    memcpy(data + consumed, data_ + offset, first);
+    memcpy(data + consumed + first, data_, chunk - first);
+    header_->head.store(head + chunk);
+    notify(header_->writable, header_->writer_waiting);
+    consumed += chunk;
+  }
+  return Status::OK();
+}
+
+Status RingBuffer::corrupted() {
+  // the positions live in the shared memory and are untrusted, the ring is
+  // unusable once they are inconsistent.
+  Close();
+  return Status::IOError("The ring buffer has been corrupted");
+}
+
+template <typename Cond>
+Status RingBuffer::wait(std::atomic<uint32_t>& word,
+                        std::atomic<uint32_t>& waiting, Cond cond,
+                        std::function<bool()> const& alive) {
+  for (int spin = 0; spin < spin_count(); ++spin) {
+    if (cond()) {
+      return Status::OK();
+    }
+    cpu_relax();
+  }
+  while (true) {
+    uint32_t value = word.load();
+    waiting.fetch_add(1);
+    if (cond()) {
+      waiting.fetch_sub(1);
+      return Status::OK();
+    }
+    if (Closed()) {
+      waiting.fetch_sub(1);
+      return Status::IOError("The ring buffer has been closed");
+    }
+    futex_wait(&word, value);
+    waiting.fetch_sub(1);
+    if (cond()) {
+      return Status::OK();
+    }
+    if (Closed()) {
+      return Status::IOError("The ring buffer has been closed");
+    }
+    if (alive && !alive()) {
+      return Status::IOError("The peer of the ring buffer has gone");
+    }
+  }
+}
+
+void RingBuffer::notify(std::atomic<uint32_t>& word,
+                        std::atomic<uint32_t>& waiting) {
+  word.fetch_add(1);
+  if (waiting.load() > 0) {
+    futex_wake(&word);
+  }
+}
+
+RingChannel::RingChannel(uint8_t* base, size_t capacity, bool initialize)
+    : base_(base), capacity_(capacity) {
+  size_t ring_size = sizeof(RingBufferHeader) + capacity;
+  requests_.reset(new RingBuffer(base, capacity, initialize));
+  replies_.reset(new RingBuffer(base + ring_size, capacity, initialize));
+}
+
+RingChannel::~RingChannel() {
+  if (base_ != nullptr) {
+    if (munmap(base_, RequiredSize(capacity_)) != 0) {
+      LOG(ERROR) << "munmap ring buffer failed: errno = " << errno << ": "
+                 << strerror(errno);
+    }
+  }
+}
+
+size_t RingChannel::RequiredSize(size_t capacity) {
+  return 2 * (sizeof(RingBufferHeader) + capacity);
+}
+
+size_t RingChannel::AlignedCapacity(size_t capacity) {
+  capacity = std::max(kMinCapacity, std::min(kMaxCapacity, capacity));
+  return (capacity + 63) / 64 * 64;
+}
+
+Status RingChannel::Map(int fd, size_t capacity, bool initialize,
+                        std::shared_ptr<RingChannel>& channel) {
+  RETURN_ON_ASSERT(capacity == AlignedCapacity(capacity),
+                   "Invalid capacity of the ring buffer");
+  void* base = mmap(nullptr, RequiredSize(capacity), PROT_READ | PROT_WRITE,
+                    MAP_SHARED, fd, 0);
+  if (base == MAP_FAILED) {
+    return Status::IOError("Failed to mmap the ring buffer: " +
+                           std::string(strerror(errno)));
+  }
+  channel.reset(
+      new RingChannel(reinterpret_cast<uint8_t*>(base), capacity, initialize));
+  return Status::OK();
+}
+
+void RingChannel::Close() {
+  requests_->Close();
+  replies_->Close();
+}
+
+}  // namespace vineyard
@@ -0,0 +1,140 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef SRC_COMMON_MEMORY_RING_BUFFER_H_
+#define SRC_COMMON_MEMORY_RING_BUFFER_H_
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <string>
+
+#include "common/util/status.h"
+
+namespace vineyard {
+
+/**
+ * @brief The control block of a ring, lives at the beginning of the ring in
+ * the shared memory. The positions are monotonic byte counters, and the
+ * "readable"/"writable" words are used as futexes to wake up the peer.
+ */
+struct RingBufferHeader {
+  alignas(64) std::atomic<uint64_t> head;  // advanced by the consumer
+  alignas(64) std::atomic<uint64_t> tail;  // advanced by the producer
+  alignas(64) std::atomic<uint32_t> readable;
+  std::atomic<uint32_t> reader_waiting;
+  alignas(64) std::atomic<uint32_t> writable;
+  std::atomic<uint32_t> writer_waiting;
+  alignas(64) std::atomic<uint32_t> closed;
+};
+
+/**
+ * @brief A lock-free single-producer single-consumer byte ring that lives in
+ * shared memory. Messages are framed in the same way as on the unix socket,
+ * i.e., a size_t length followed by the body, and messages larger than the
+ * ring are streamed through it.
+ *
+ * The peers spin for a short while before sleeping on the futex, and the
+ * `alive` callback is checked periodically while sleeping to detect the peer
+ * has gone.
+ */
+class RingBuffer {
+ public:
+  RingBuffer(uint8_t* base, size_t capacity, bool initialize);
+
+  Status WriteMessage(const std::string& msg,
+                      std::function<bool()> const& alive);
+
+  Status ReadMessage(std::string& msg, std::function<bool()> const& alive);
+
+  /**
+   * @brief Mark the ring as closed and wake up all waiters.
+   */
+  void Close();
+
+  bool Closed() const;
+
+ private:
+  Status write(const char* data, size_t size,
+               std::function<bool()> const& alive);
+
+  Status read(char* data, size_t size, std::function<bool()> const& alive);
+
+  // closes the ring when the positions in the control block are invalid.
+  Status corrupted();
+
+  template <typename Cond>
+  Status wait(std::atomic<uint32_t>& word, std::atomic<uint32_t>& waiting,
+              Cond cond, std::function<bool()> const& alive);
+
+  void notify(std::atomic<uint32_t>& word, std::atomic<uint32_t>& waiting);
+
+  RingBufferHeader* header_;
+  char* data_;
+  size_t capacity_;
+};
+
+/**
+ * @brief A pair of rings for the requests and replies of a IPC connection,
+ * both are placed in one shared memory segment whose fd is passed to the
+ * client via `send_fd`.
+ */
+class RingChannel {
+ public:
+  ~RingChannel();
+
+  /**
+   * @brief The size of the memory segment for rings of the given capacity.
+   */
+  static size_t RequiredSize(size_t capacity);
+
+  /**
+   * @brief Round the capacity to the cacheline, and clamp it into a sane
+   * range.
+   */
+  static size_t AlignedCapacity(size_t capacity);
+
+  /**
+   * @brief Map the segment behind the fd, the fd can be closed after mapping.
+   *
+   * @param initialize Whether to initialize the control blocks, i.e., the
+   * segment is newly created.
+   */
+  static Status Map(int fd, size_t capacity, bool initialize,
+                    std::shared_ptr<RingChannel>& channel);
+
+  RingBuffer& requests() { return *requests_; }
+
+  RingBuffer& replies() { return *replies_; }
+
+  size_t capacity() const { return capacity_; }
+
+  /**
+   * @brief Close both directions.
+   */
+  void Close();
+
+ private:
+  RingChannel(uint8_t* base, size_t capacity, bool initialize);
+
+  uint8_t* base_;
+  size_t capacity_;
+  std::unique_ptr<RingBuffer> requests_;
+  std::unique_ptr<RingBuffer> replies_;
+};
+
+}  // namespace vineyard
+
+#endif  // SRC_COMMON_MEMORY_RING_BUFFER_H_
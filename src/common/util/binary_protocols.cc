@@ -0,0 +1,553 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "common/util/binary_protocols.h"
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+#include "common/memory/cuda.h"
+#include "common/util/json.h"
+
+namespace vineyard {
+
+namespace {
+
+/**
+ * The fixed layout of payloads in binary messages.
+ */
+struct BinaryPayload {
+  ObjectID object_id;
+  int64_t data_offset;
+  int64_t data_size;
+  int64_t map_size;
+  int64_t page_size;
+  int32_t store_fd;
+  int32_t numa_node;
+  int32_t device;
+  int32_t reserved;
+  char ipc_handle[memory::kCudaIpcHandleSize];
+};
+
+class BinaryEncoder {
+ public:
+  BinaryEncoder(const CommandType type, std::string& msg) : msg_(msg) {
+    BinaryMessageHeader header;
+    header.marker = '\0';
+    header.version = kBinaryProtocolVersion;
+    header.reserved = 0;
+    header.type = static_cast<int32_t>(type);
+    msg_.clear();
+    Put(header);
+  }
+
+  template <typename T>
+  void Put(const T& value) {
+    msg_.append(reinterpret_cast<const char*>(&value), sizeof(T));
+  }
+
+  void Put(const uint8_t* data, const size_t size) {
+    Put(static_cast<uint64_t>(size));
+    if (size > 0) {
+      msg_.append(reinterpret_cast<const char*>(data), size);
+    }
+  }
+
+  void Put(const Payload& object) {
+    BinaryPayload payload;
+    payload.object_id = object.object_id;
+    payload.data_offset = object.data_offset;
+    payload.data_size = object.data_size;
+    payload.map_size = object.map_size;
+    payload.page_size = object.page_size;
+    payload.store_fd = object.store_fd;
+    payload.numa_node = object.numa_node;
+    payload.device = object.device;
+    payload.reserved = 0;
+    memset(payload.ipc_handle, 0, sizeof(payload.ipc_handle));
+    memcpy(payload.ipc_handle, object.ipc_handle.data(),
+           std::min(object.ipc_handle.size(), sizeof(payload.ipc_handle)));
+    Put(payload);
+  }
+
+ private:
+  std::string& msg_;
+};
+
+class BinaryDecoder {
+ public:
+  explicit BinaryDecoder(const std::string& msg)
+      : msg_(msg), offset_(sizeof(BinaryMessageHeader)) {}
+
+  template <typename T>
+  Status Get(T& value) {
+    if (offset_ + sizeof(T) > msg_.size()) {
+      return Status::Invalid("Malformed binary message: truncated");
+    }
+    memcpy(&value, msg_.data() + offset_, sizeof(T));
+    offset_ += sizeof(T);
+    return Status::OK();
+  }
+
+  // gets the (offset, size) of an inlined payload
+  Status Get(std::pair<size_t, size_t>& payload) {
+    uint64_t size = 0;
+    RETURN_ON_ERROR(Get(size));
+    if (size > msg_.size() - offset_) {
+      return Status::Invalid("Malformed binary message: truncated");
+    }
+    payload = std::make_pair(offset_, static_cast<size_t>(size));
+    offset_ += size;
+    return Status::OK();
+  }
+
+  Status Get(Payload& object) {
+    BinaryPayload payload;
+    RETURN_ON_ERROR(Get(payload));
+    object.object_id = payload.object_id;
+    object.data_offset = payload.data_offset;
+    object.data_size = payload.data_size;
+    object.map_size = payload.map_size;
+    object.page_size = payload.page_size;
+    object.store_fd = payload.store_fd;
+    object.numa_node = payload.numa_node;
+    object.device = payload.device;
+    if (object.device >= 0) {
+      object.ipc_handle.assign(payload.ipc_handle, sizeof(payload.ipc_handle));
+    } else {
+      object.ipc_handle.clear();
+    }
+    object.pointer = nullptr;
+    return Status::OK();
+  }
+
+ private:
+  const std::string& msg_;
+  size_t offset_;
+};
+
+Status CheckBinaryMessage(const std::string& msg, const CommandType expected) {
+  CommandType type;
+  RETURN_ON_ERROR(ReadBinaryMessageType(msg, type));
+  RETURN_ON_ASSERT(type == expected);
+  return Status::OK();
+}
+
+/**
+ * Errors of binary requests are replied as JSON messages.
+ */
+Status CheckBinaryReply(const std::string& msg, const CommandType expected) {
+  if (IsBinaryMessage(msg)) {
+    return CheckBinaryMessage(msg, expected);
+  }
+  json root;
+  RETURN_ON_ERROR(CATCH_JSON_ERROR([&]() -> Status {
+    root = json::parse(msg);
+    return Status::OK();
+  }()));
+  Status status = Status(static_cast<StatusCode>(root.value("code", 0)),
+                         root.value("message", ""));
+  if (status.ok()) {
+    return Status::Invalid("Unexpected reply for a binary request: " + msg);
+  }
+  return status;
+}
+
+}  // namespace
+
+bool IsBinaryMessage(const std::string& msg) {
+  return msg.size() >= sizeof(BinaryMessageHeader) && msg[0] == '\0';
+}
+
+Status ReadBinaryMessageType(const std::string& msg, CommandType& type) {
+  if (!IsBinaryMessage(msg)) {
+    return Status::Invalid("Not a binary message");
+  }
+  BinaryMessageHeader header;
+  memcpy(&header, msg.data(), sizeof(BinaryMessageHeader));
+  if (header.version != kBinaryProtocolVersion) {
+    return Status::Invalid("Unsupported binary protocol version: " +
+                           std::to_string(header.version));
+  }
+  type = static_cast<CommandType>(header.type);
+  return Status::OK();
+}
+
+void WriteGetBuffersRequestBinary(const std::set<ObjectID>& ids,
+                                  std::string& msg) {
+  BinaryEncoder encoder(CommandType::GetBuffersRequest, msg);
+  encoder.Put(static_cast<uint64_t>(ids.size()));
+  for (auto const& id : ids) {
+    encoder.Put(id);
+  }
+}
+
+Status ReadGetBuffersRequestBinary(const std::string& msg,
+                                   std::vector<ObjectID>& ids) {
+  RETURN_ON_ERROR(CheckBinaryMessage(msg, CommandType::GetBuffersRequest));
+  BinaryDecoder decoder(msg);
+  uint64_t num = 0;
+  RETURN_ON_ERROR(decoder.Get(num));
+  RETURN_ON_ASSERT(num <= msg.size() / sizeof(ObjectID));
+  ids.resize(num);
+  for (uint64_t i = 0; i < num; ++i) {
+    RETURN_ON_ERROR(decoder.Get(ids[i]));
+  }
+  return Status::OK();
+}
+
+void WriteGetBuffersReplyBinary(
+    const std::vector<std::shared_ptr<Payload>>& objects, std::string& msg) {
+  BinaryEncoder encoder(CommandType::GetBuffersRequest, msg);
+  encoder.Put(static_cast<uint64_t>(objects.size()));
+  for (auto const& object : objects) {
+    encoder.Put(*object);
+  }
+}
+
+Status ReadGetBuffersReplyBinary(const std::string& msg,
+                                 std::vector<Payload>& objects) {
+  RETURN_ON_ERROR(CheckBinaryReply(msg, CommandType::GetBuffersRequest));
+  BinaryDecoder decoder(msg);
+  uint64_t num = 0;
+  RETURN_ON_ERROR(decoder.Get(num));
+  RETURN_ON_ASSERT(num <= msg.size() / sizeof(BinaryPayload));
+  objects.resize(num);
+  for (uint64_t i = 0; i < num; ++i) {
+    RETURN_ON_ERROR(decoder.Get(objects[i]));
+  }
+  return Status::OK();
+}
+
+void WriteCreateBufferRequestBinary(const size_t size, const int numa_node,
+                                    std::string& msg) {
+  BinaryEncoder encoder(CommandType::CreateBufferRequest, msg);
+  encoder.Put(static_cast<uint64_t>(size));
+  encoder.Put(static_cast<int32_t>(numa_node));
+}
+
+Status ReadCreateBufferRequestBinary(const std::string& msg, size_t& size,
+                                     int& numa_node) {
+  RETURN_ON_ERROR(CheckBinaryMessage(msg, CommandType::CreateBufferRequest));
+  BinaryDecoder decoder(msg);
+  uint64_t size_value = 0;
+  int32_t numa_node_value = -1;
+  RETURN_ON_ERROR(decoder.Get(size_value));
+  RETURN_ON_ERROR(decoder.Get(numa_node_value));
+  size = static_cast<size_t>(size_value);
+  numa_node = static_cast<int>(numa_node_value);
+  return Status::OK();
+}
+
+void WriteCreateBufferReplyBinary(const ObjectID id,
+                                  const std::shared_ptr<Payload>& object,
+                                  std::string& msg) {
+  BinaryEncoder encoder(CommandType::CreateBufferRequest, msg);
+  encoder.Put(id);
+  encoder.Put(*object);
+}
+
+Status ReadCreateBufferReplyBinary(const std::string& msg, ObjectID& id,
+                                   Payload& object) {
+  RETURN_ON_ERROR(CheckBinaryReply(msg, CommandType::CreateBufferRequest));
+  BinaryDecoder decoder(msg);
+  RETURN_ON_ERROR(decoder.Get(id));
+  RETURN_ON_ERROR(decoder.Get(object));
+  return Status::OK();
+}
+
+void WriteGetNextStreamChunkRequestBinary(const ObjectID stream_id,
+                                          const size_t size, std::string& msg) {
+  BinaryEncoder encoder(CommandType::GetNextStreamChunkRequest, msg);
+  encoder.Put(stream_id);
+  encoder.Put(static_cast<uint64_t>(size));
+}
+
+Status ReadGetNextStreamChunkRequestBinary(const std::string& msg,
+                                           ObjectID& stream_id, size_t& size) {
+  RETURN_ON_ERROR(
+      CheckBinaryMessage(msg, CommandType::GetNextStreamChunkRequest));
+  BinaryDecoder decoder(msg);
+  uint64_t size_value = 0;
+  RETURN_ON_ERROR(decoder.Get(stream_id));
+  RETURN_ON_ERROR(decoder.Get(size_value));
+  size = static_cast<size_t>(size_value);
+  return Status::OK();
+}
+
+void WriteGetNextStreamChunkReplyBinary(const std::shared_ptr<Payload>& object,
+                                        std::string& msg) {
+  BinaryEncoder encoder(CommandType::GetNextStreamChunkRequest, msg);
+  encoder.Put(*object);
+}
+
+Status ReadGetNextStreamChunkReplyBinary(const std::string& msg,
+                                         Payload& object) {
+  RETURN_ON_ERROR(
+      CheckBinaryReply(msg, CommandType::GetNextStreamChunkRequest));
+  BinaryDecoder decoder(msg);
+  return decoder.Get(object);
+}
+
+void WritePullNextStreamChunkRequestBinary(const ObjectID stream_id,
+                                           std::string& msg) {
+  BinaryEncoder encoder(CommandType::PullNextStreamChunkRequest, msg);
+  encoder.Put(stream_id);
+}
+
+Status ReadPullNextStreamChunkRequestBinary(const std::string& msg,
+                                            ObjectID& stream_id) {
+  RETURN_ON_ERROR(
+      CheckBinaryMessage(msg, CommandType::PullNextStreamChunkRequest));
+  BinaryDecoder decoder(msg);
+  return decoder.Get(stream_id);
+}
+
+void WritePullNextStreamChunkReplyBinary(
+    const std::shared_ptr<Payload>& object, std::string& msg) {
+  BinaryEncoder encoder(CommandType::PullNextStreamChunkRequest, msg);
+  encoder.Put(*object);
+}
+
+Status ReadPullNextStreamChunkReplyBinary(const std::string& msg,
+                                          Payload& object) {
+  RETURN_ON_ERROR(
+      CheckBinaryReply(msg, CommandType::PullNextStreamChunkRequest));
+  BinaryDecoder decoder(msg);
+  return decoder.Get(object);
+}
+
+void WriteGetNextStreamChunksRequestBinary(const ObjectID stream_id,
+                                           const std::vector<size_t>& sizes,
+                                           std::string& msg) {
+  BinaryEncoder encoder(CommandType::GetNextStreamChunksRequest, msg);
+  encoder.Put(stream_id);
+  encoder.Put(static_cast<uint64_t>(sizes.size()));
+  for (auto const size : sizes) {
+    encoder.Put(static_cast<uint64_t>(size));
+  }
+}
+
+Status ReadGetNextStreamChunksRequestBinary(const std::string& msg,
+                                            ObjectID& stream_id,
+                                            std::vector<size_t>& sizes) {
+  RETURN_ON_ERROR(
+      CheckBinaryMessage(msg, CommandType::GetNextStreamChunksRequest));
+  BinaryDecoder decoder(msg);
+  uint64_t num = 0;
+  RETURN_ON_ERROR(decoder.Get(stream_id));
+  RETURN_ON_ERROR(decoder.Get(num));
+  RETURN_ON_ASSERT(num <= msg.size() / sizeof(uint64_t));
+  sizes.resize(num);
+  for (uint64_t i = 0; i < num; ++i) {
+    uint64_t size_value = 0;
+    RETURN_ON_ERROR(decoder.Get(size_value));
+    sizes[i] = static_cast<size_t>(size_value);
+  }
+  return Status::OK();
+}
+
+void WriteGetNextStreamChunksReplyBinary(
+    const std::vector<std::shared_ptr<Payload>>& objects, std::string& msg) {
+  BinaryEncoder encoder(CommandType::GetNextStreamChunksRequest, msg);
+  encoder.Put(static_cast<uint64_t>(objects.size()));
+  for (auto const& object : objects) {
+    encoder.Put(*object);
+  }
+}
+
+Status ReadGetNextStreamChunksReplyBinary(const std::string& msg,
+                                          std::vector<Payload>& objects) {
+  RETURN_ON_ERROR(
+      CheckBinaryReply(msg, CommandType::GetNextStreamChunksRequest));
+  BinaryDecoder decoder(msg);
+  uint64_t num = 0;
+  RETURN_ON_ERROR(decoder.Get(num));
+  RETURN_ON_ASSERT(num <= msg.size() / sizeof(BinaryPayload));
+  objects.resize(num);
+  for (uint64_t i = 0; i < num; ++i) {
+    RETURN_ON_ERROR(decoder.Get(objects[i]));
+  }
+  return Status::OK();
+}
+
+void WritePutStreamChunksRequestBinary(
+    const ObjectID stream_id,
+    const std::vector<std::pair<const uint8_t*, size_t>>& payloads,
+    std::string& msg) {
+  BinaryEncoder encoder(CommandType::PutStreamChunksRequest, msg);
+  encoder.Put(stream_id);
+  encoder.Put(static_cast<uint64_t>(payloads.size()));
+  for (auto const& payload : payloads) {
+    encoder.Put(payload.first, payload.second);
+  }
+}
+
+Status ReadPutStreamChunksRequestBinary(
+    const std::string& msg, ObjectID& stream_id,
+    std::vector<std::pair<size_t, size_t>>& payloads) {
+  RETURN_ON_ERROR(CheckBinaryMessage(msg, CommandType::PutStreamChunksRequest));
+  BinaryDecoder decoder(msg);
+  uint64_t num = 0;
+  RETURN_ON_ERROR(decoder.Get(stream_id));
+  RETURN_ON_ERROR(decoder.Get(num));
+  RETURN_ON_ASSERT(num <= msg.size() / sizeof(uint64_t));
+  payloads.resize(num);
+  for (uint64_t i = 0; i < num; ++i) {
+    RETURN_ON_ERROR(decoder.Get(payloads[i]));
+  }
+  return Status::OK();
+}
+
+void WritePutStreamChunksReplyBinary(const size_t num, std::string& msg) {
+  BinaryEncoder encoder(CommandType::PutStreamChunksRequest, msg);
+  encoder.Put(static_cast<uint64_t>(num));
+}
+
+Status ReadPutStreamChunksReplyBinary(const std::string& msg, size_t& num) {
+  RETURN_ON_ERROR(CheckBinaryReply(msg, CommandType::PutStreamChunksRequest));
+  BinaryDecoder decoder(msg);
+  uint64_t num_value = 0;
+  RETURN_ON_ERROR(decoder.Get(num_value));
+  num = static_cast<size_t>(num_value);
+  return Status::OK();
+}
+
+void WritePullStreamChunksRequestBinary(const ObjectID stream_id,
+                                        const size_t limit, std::string& msg) {
+  BinaryEncoder encoder(CommandType::PullStreamChunksRequest, msg);
+  encoder.Put(stream_id);
+  encoder.Put(static_cast<uint64_t>(limit));
+}
+
+Status ReadPullStreamChunksRequestBinary(const std::string& msg,
+                                         ObjectID& stream_id, size_t& limit) {
+  RETURN_ON_ERROR(
+      CheckBinaryMessage(msg, CommandType::PullStreamChunksRequest));
+  BinaryDecoder decoder(msg);
+  uint64_t limit_value = 0;
+  RETURN_ON_ERROR(decoder.Get(stream_id));
+  RETURN_ON_ERROR(decoder.Get(limit_value));
+  limit = static_cast<size_t>(limit_value);
+  return Status::OK();
+}
+
+void WritePullStreamChunksReplyBinary(
+    const std::vector<std::shared_ptr<Payload>>& objects, std::string& msg) {
+  BinaryEncoder encoder(CommandType::PullStreamChunksRequest, msg);
+  encoder.Put(static_cast<uint64_t>(objects.size()));
+  for (auto const& object : objects) {
+    encoder.Put(object->pointer, object->data_size);
+  }
+}
+
+Status ReadPullStreamChunksReplyBinary(
+    const std::string& msg, std::vector<std::pair<size_t, size_t>>& payloads) {
+  RETURN_ON_ERROR(CheckBinaryReply(msg, CommandType::PullStreamChunksRequest));
+  BinaryDecoder decoder(msg);
+  uint64_t num = 0;
+  RETURN_ON_ERROR(decoder.Get(num));
+  RETURN_ON_ASSERT(num <= msg.size() / sizeof(uint64_t));
+  payloads.resize(num);
+  for (uint64_t i = 0; i < num; ++i) {
+    RETURN_ON_ERROR(decoder.Get(payloads[i]));
+  }
+  return Status::OK();
+}
+
+void WriteSubscribeStreamRequestBinary(const ObjectID stream_id,
+                                       const size_t credits,
+                                       const int64_t mode, std::string& msg) {
+  BinaryEncoder encoder(CommandType::SubscribeStreamRequest, msg);
+  encoder.Put(stream_id);
+  encoder.Put(static_cast<uint64_t>(credits));
+  encoder.Put(mode);
+}
+
+Status ReadSubscribeStreamRequestBinary(const std::string& msg,
+                                        ObjectID& stream_id, size_t& credits,
+                                        int64_t& mode) {
+  RETURN_ON_ERROR(CheckBinaryMessage(msg, CommandType::SubscribeStreamRequest));
+  BinaryDecoder decoder(msg);
+  uint64_t credits_value = 0;
+  RETURN_ON_ERROR(decoder.Get(stream_id));
+  RETURN_ON_ERROR(decoder.Get(credits_value));
+  RETURN_ON_ERROR(decoder.Get(mode));
+  credits = static_cast<size_t>(credits_value);
+  return Status::OK();
+}
+
+void WriteSubscribeStreamReplyBinary(const ObjectID stream_id,
+                                     std::string& msg) {
+  BinaryEncoder encoder(CommandType::SubscribeStreamRequest, msg);
+  encoder.Put(stream_id);
+  encoder.Put(static_cast<uint64_t>(0));
+}
+
+Status ReadSubscribeStreamReplyBinary(const std::string& msg,
+                                      ObjectID& stream_id) {
+  std::vector<std::pair<size_t, size_t>> payloads;
+  RETURN_ON_ERROR(ReadStreamChunksPushBinary(msg, stream_id, payloads));
+  RETURN_ON_ASSERT(payloads.empty());
+  return Status::OK();
+}
+
+void WriteStreamChunksPushBinary(
+    const ObjectID stream_id,
+    const std::vector<std::shared_ptr<Payload>>& objects, std::string& msg) {
+  BinaryEncoder encoder(CommandType::SubscribeStreamRequest, msg);
+  encoder.Put(stream_id);
+  encoder.Put(static_cast<uint64_t>(objects.size()));
+  for (auto const& object : objects) {
+    encoder.Put(object->pointer, object->data_size);
+  }
+}
+
+Status ReadStreamChunksPushBinary(
+    const std::string& msg, ObjectID& stream_id,
+    std::vector<std::pair<size_t, size_t>>& payloads) {
+  RETURN_ON_ERROR(CheckBinaryReply(msg, CommandType::SubscribeStreamRequest));
+  BinaryDecoder decoder(msg);
+  uint64_t num = 0;
+  RETURN_ON_ERROR(decoder.Get(stream_id));
+  RETURN_ON_ERROR(decoder.Get(num));
+  RETURN_ON_ASSERT(num <= msg.size() / sizeof(uint64_t));
+  payloads.resize(num);
+  for (uint64_t i = 0; i < num; ++i) {
+    RETURN_ON_ERROR(decoder.Get(payloads[i]));
+  }
+  return Status::OK();
+}
+
+void WriteStreamCreditRequestBinary(const ObjectID stream_id,
+                                    const size_t credits, std::string& msg) {
+  BinaryEncoder encoder(CommandType::StreamCreditRequest, msg);
+  encoder.Put(stream_id);
+  encoder.Put(static_cast<uint64_t>(credits));
+}
+
+Status ReadStreamCreditRequestBinary(const std::string& msg,
+                                     ObjectID& stream_id, size_t& credits) {
+  RETURN_ON_ERROR(CheckBinaryMessage(msg, CommandType::StreamCreditRequest));
+  BinaryDecoder decoder(msg);
+  uint64_t credits_value = 0;
+  RETURN_ON_ERROR(decoder.Get(stream_id));
+  RETURN_ON_ERROR(decoder.Get(credits_value));
+  credits = static_cast<size_t>(credits_value);
+  return Status::OK();
+}
+
+}  // namespace vineyard
@@ -0,0 +1,188 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef SRC_COMMON_UTIL_BINARY_PROTOCOLS_H_
+#define SRC_COMMON_UTIL_BINARY_PROTOCOLS_H_
+
+#include <cstdint>
+#include <memory>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "common/memory/payload.h"
+#include "common/util/protocols.h"
+#include "common/util/status.h"
+#include "common/util/uuid.h"
+
+namespace vineyard {
+
+/**
+ * The fixed-layout binary framing for hot-path IPC commands, as an
+ * alternative to the JSON messages in "protocols.h".
+ *
+ * A binary message starts with a `BinaryMessageHeader`, whose leading byte is
+ * always '\0' and thus never be confused with a JSON message. Replies of a
+ * binary request are binary messages tagged with the same command type, except
+ * errors, which are always JSON messages, see also `WriteErrorReply`.
+ *
+ * The server announces the support in the register reply, and clients opt in
+ * to use it.
+ */
+struct BinaryMessageHeader {
+  uint8_t marker;  // always be '\0'
+  uint8_t version;
+  uint16_t reserved;
+  int32_t type;  // the `CommandType`
+};
+
+// version 2: payloads carry the device and the CUDA IPC memory handle.
+constexpr uint8_t kBinaryProtocolVersion = 2;
+
+bool IsBinaryMessage(const std::string& msg);
+
+Status ReadBinaryMessageType(const std::string& msg, CommandType& type);
+
+void WriteGetBuffersRequestBinary(const std::set<ObjectID>& ids,
+                                  std::string& msg);
+
+Status ReadGetBuffersRequestBinary(const std::string& msg,
+                                   std::vector<ObjectID>& ids);
+
+void WriteGetBuffersReplyBinary(
+    const std::vector<std::shared_ptr<Payload>>& objects, std::string& msg);
+
+Status ReadGetBuffersReplyBinary(const std::string& msg,
+                                 std::vector<Payload>& objects);
+
+void WriteCreateBufferRequestBinary(const size_t size, const int numa_node,
+                                    std::string& msg);
+
+Status ReadCreateBufferRequestBinary(const std::string& msg, size_t& size,
+                                     int& numa_node);
+
+void WriteCreateBufferReplyBinary(const ObjectID id,
+                                  const std::shared_ptr<Payload>& object,
+                                  std::string& msg);
+
+Status ReadCreateBufferReplyBinary(const std::string& msg, ObjectID& id,
+                                   Payload& object);
+
+void WriteGetNextStreamChunkRequestBinary(const ObjectID stream_id,
+                                          const size_t size, std::string& msg);
+
+Status ReadGetNextStreamChunkRequestBinary(const std::string& msg,
+                                           ObjectID& stream_id, size_t& size);
+
+void WriteGetNextStreamChunkReplyBinary(const std::shared_ptr<Payload>& object,
+                                        std::string& msg);
+
+Status ReadGetNextStreamChunkReplyBinary(const std::string& msg,
+                                         Payload& object);
+
+void WritePullNextStreamChunkRequestBinary(const ObjectID stream_id,
+                                           std::string& msg);
+
+Status ReadPullNextStreamChunkRequestBinary(const std::string& msg,
+                                            ObjectID& stream_id);
+
+void WritePullNextStreamChunkReplyBinary(
+    const std::shared_ptr<Payload>& object, std::string& msg);
+
+Status ReadPullNextStreamChunkReplyBinary(const std::string& msg,
+                                          Payload& object);
+
+void WriteGetNextStreamChunksRequestBinary(const ObjectID stream_id,
+                                           const std::vector<size_t>& sizes,
+                                           std::string& msg);
+
+Status ReadGetNextStreamChunksRequestBinary(const std::string& msg,
+                                            ObjectID& stream_id,
+                                            std::vector<size_t>& sizes);
+
+void WriteGetNextStreamChunksReplyBinary(
+    const std::vector<std::shared_ptr<Payload>>& objects, std::string& msg);
+
+Status ReadGetNextStreamChunksReplyBinary(const std::string& msg,
+                                          std::vector<Payload>& objects);
+
+/**
+ * The payloads of chunks are inlined in the message, as (size, bytes) pairs,
+ * readers get the (offset, size) of each payload in the message.
+ */
+void WritePutStreamChunksRequestBinary(
+    const ObjectID stream_id,
+    const std::vector<std::pair<const uint8_t*, size_t>>& payloads,
+    std::string& msg);
+
+Status ReadPutStreamChunksRequestBinary(
+    const std::string& msg, ObjectID& stream_id,
+    std::vector<std::pair<size_t, size_t>>& payloads);
+
+void WritePutStreamChunksReplyBinary(const size_t num, std::string& msg);
+
+Status ReadPutStreamChunksReplyBinary(const std::string& msg, size_t& num);
+
+void WritePullStreamChunksRequestBinary(const ObjectID stream_id,
+                                        const size_t limit, std::string& msg);
+
+Status ReadPullStreamChunksRequestBinary(const std::string& msg,
+                                         ObjectID& stream_id, size_t& limit);
+
+void WritePullStreamChunksReplyBinary(
+    const std::vector<std::shared_ptr<Payload>>& objects, std::string& msg);
+
+Status ReadPullStreamChunksReplyBinary(
+    const std::string& msg, std::vector<std::pair<size_t, size_t>>& payloads);
+
+/**
+ * Once a stream is subscribed, the chunks are pushed as soon as they are
+ * sealed (tagged as `SubscribeStreamRequest`), as long as the subscriber has
+ * enough credits, which are granted by `StreamCreditRequest` (that has no
+ * reply) after the pushed chunks are consumed. The end of stream is pushed
+ * as an error reply.
+ */
+void WriteSubscribeStreamRequestBinary(const ObjectID stream_id,
+                                       const size_t credits,
+                                       const int64_t mode, std::string& msg);
+
+Status ReadSubscribeStreamRequestBinary(const std::string& msg,
+                                        ObjectID& stream_id, size_t& credits,
+                                        int64_t& mode);
+
+void WriteSubscribeStreamReplyBinary(const ObjectID stream_id,
+                                     std::string& msg);
+
+Status ReadSubscribeStreamReplyBinary(const std::string& msg,
+                                      ObjectID& stream_id);
+
+void WriteStreamChunksPushBinary(
+    const ObjectID stream_id,
+    const std::vector<std::shared_ptr<Payload>>& objects, std::string& msg);
+
+Status ReadStreamChunksPushBinary(
+    const std::string& msg, ObjectID& stream_id,
+    std::vector<std::pair<size_t, size_t>>& payloads);
+
+void WriteStreamCreditRequestBinary(const ObjectID stream_id,
+                                    const size_t credits, std::string& msg);
+
+Status ReadStreamCreditRequestBinary(const std::string& msg,
+                                     ObjectID& stream_id, size_t& credits);
+
+}  // namespace vineyard
+
+#endif  // SRC_COMMON_UTIL_BINARY_PROTOCOLS_H_
@@ -0,0 +1,351 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+
+#ifndef SRC_COMMON_UTIL_MPMC_QUEUE_H_
+#define SRC_COMMON_UTIL_MPMC_QUEUE_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace vineyard {
+
+/**
+ * @brief A bounded lock-free multi-producer multi-consumer ring (the one
+ * by Dmitry Vyukov), where every cell carries a sequence number that tells
+ * whether it is ready for the producer or the consumer of the current lap.
+ *
+ * The batched versions claim a run of consecutive ready cells with a single
+ * CAS on the position.
+ */
+template <typename T>
+class MPMCRing {
+ public:
+  explicit MPMCRing(size_t capacity = 1024) { reset(capacity); }
+
+  ~MPMCRing() { drain(); }
+
+  MPMCRing(const MPMCRing&) = delete;
+  MPMCRing& operator=(const MPMCRing&) = delete;
+
+  /**
+   * @brief Reallocate the ring, rounded up to a power of two, must not be
+   * called concurrently with other operations.
+   */
+  void reset(size_t capacity) {
+    drain();
+    size_t aligned = 2;
+    while (aligned < capacity) {
+      aligned <<= 1;
+    }
+    mask_ = aligned - 1;
+    cells_.reset(new cell_t[aligned]);
+    for (size_t i = 0; i < aligned; ++i) {
+      cells_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+    enqueue_pos_.store(0, std::memory_order_relaxed);
+    dequeue_pos_.store(0, std::memory_order_relaxed);
+  }
+
+  size_t capacity() const { return mask_ + 1; }
+
+  /**
+   * @brief An estimation as the positions are read without synchronization.
+   */
+  size_t size() const {
+    size_t enqueue = enqueue_pos_.load(std::memory_order_relaxed);
+    size_t dequeue = dequeue_pos_.load(std::memory_order_relaxed);
+    return enqueue > dequeue ? enqueue - dequeue : 0;
+  }
+
+  template <typename U>
+  bool TryPut(U&& item) {
+    size_t pos = 0;
+    if (claim(enqueue_pos_, 0, 1, pos) == 0) {
+      return false;
+    }
+    cell_t& cell = cells_[pos & mask_];
+    new (&cell.storage) T(std::forward<U>(item));
+    cell.sequence.store(pos + 1, std::memory_order_release);
+    return true;
+  }
+
+  bool TryGet(T& item) {
+    size_t pos = 0;
+    if (claim(dequeue_pos_, 1, 1, pos) == 0) {
+      return false;
+    }
+    cell_t& cell = cells_[pos & mask_];
+    T* value = cell.value();
+    item = std::move(*value);
+    value->~T();
+    cell.sequence.store(pos + mask_ + 1, std::memory_order_release);
+    return true;
+  }
+
+  /**
+   * @brief Move the items in `[begin, end)` into the ring, returns the number
+   * of items that have been put.
+   */
+  template <typename Iterator>
+  size_t TryPutBatch(Iterator begin, Iterator end) {
+    size_t pos = 0;
+    size_t count =
+        claim(enqueue_pos_, 0, static_cast<size_t>(end - begin), pos);
+    for (size_t i = 0; i < count; ++i, ++begin) {
+      cell_t& cell = cells_[(pos + i) & mask_];
+      new (&cell.storage) T(std::move(*begin));
+      cell.sequence.store(pos + i + 1, std::memory_order_release);
+    }
+    return count;
+  }
+
+  /**
+   * @brief Append at most `limit` items to `items`, returns the number of
+   * items that have been got.
+   */
+  size_t TryGetBatch(std::vector<T>& items, size_t limit) {
+    size_t pos = 0;
+    size_t count = claim(dequeue_pos_, 1, limit, pos);
+    for (size_t i = 0; i < count; ++i) {
+      cell_t& cell = cells_[(pos + i) & mask_];
+      T* value = cell.value();
+      items.emplace_back(std::move(*value));
+      value->~T();
+      cell.sequence.store(pos + i + mask_ + 1, std::memory_order_release);
+    }
+    return count;
+  }
+
+ private:
+  struct cell_t {
+    std::atomic<size_t> sequence;
+    typename std::aligned_storage<sizeof(T), alignof(T)>::type storage;
+
+    T* value() { return reinterpret_cast<T*>(&storage); }
+  };
+
+  // claims at most `limit` consecutive cells whose sequence is `pos + lag`,
+  // i.e., empty cells for producers (lag = 0) and full cells for consumers
+  // (lag = 1). A ready cell stays ready until claimed, as only the owner of
+  // the position can move it forward.
+  size_t claim(std::atomic<size_t>& position, size_t const lag,
+               size_t const limit, size_t& pos) {
+    if (limit == 0) {
+      return 0;
+    }
+    pos = position.load(std::memory_order_relaxed);
+    while (true) {
+      size_t count = 0;
+      while (count < limit && count <= mask_) {
+        size_t seq = cells_[(pos + count) & mask_].sequence.load(
+            std::memory_order_acquire);
+        if (seq != pos + count + lag) {
+          break;
+        }
+        ++count;
+      }
+      if (count == 0) {
+        size_t seq = cells_[pos & mask_].sequence.load(
+            std::memory_order_acquire);
+        intptr_t diff =
+            static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + lag);
+        if (diff < 0) {
+          // full (for producers) or empty (for consumers)
+          return 0;
+        }
+        // other threads have moved the position forward
+        pos = position.load(std::memory_order_relaxed);
+        continue;
+      }
+      if (position.compare_exchange_weak(pos, pos + count,
+                                         std::memory_order_relaxed)) {
+        return count;
+      }
+    }
+  }
+
+  // destroys the remaining items, must not be called concurrently.
+  void drain() {
+    if (!cells_) {
+      return;
+    }
+    size_t end = enqueue_pos_.load(std::memory_order_relaxed);
+    for (size_t pos = dequeue_pos_.load(std::memory_order_relaxed); pos != end;
+         ++pos) {
+      cell_t& cell = cells_[pos & mask_];
+      if (cell.sequence.load(std::memory_order_relaxed) == pos + 1) {
+        cell.value()->~T();
+      }
+    }
+  }
+
+  std::unique_ptr<cell_t[]> cells_;
+  size_t mask_ = 0;
+  alignas(64) std::atomic<size_t> enqueue_pos_{0};
+  alignas(64) std::atomic<size_t> dequeue_pos_{0};
+};
+
+/**
+ * @brief The lock-free counterpart of `PCBlockingQueue`, with the same
+ * `Put`/`Get`/`DecProducerNum` semantics, i.e., `Get` returns false once the
+ * queue is empty and all producers have finished.
+ *
+ * The waiting threads spin, then yield, then park on a condition variable,
+ * and the mutex is only touched when there are parked threads.
+ */
+template <typename T>
+class PCMPMCQueue {
+ public:
+  PCMPMCQueue() : ring_(kDefaultLimit) {}
+  ~PCMPMCQueue() {}
+
+  /**
+   * @brief The queue is bounded, the limit must be set before the queue is
+   * used.
+   */
+  void SetLimit(size_t limit) { ring_.reset(limit); }
+
+  void SetProducerNum(int pn) { producer_num_.store(pn); }
+
+  void DecProducerNum() {
+    if (producer_num_.fetch_sub(1) == 1) {
+      std::lock_guard<std::mutex> lk(lock_);
+      empty_.notify_all();
+    }
+  }
+
+  void Put(const T& item) {
+    wait_for(full_, full_waiters_, [&]() { return ring_.TryPut(item); });
+    notify(empty_, empty_waiters_);
+  }
+
+  void Put(T&& item) {
+    wait_for(full_, full_waiters_,
+             [&]() { return ring_.TryPut(std::move(item)); });
+    notify(empty_, empty_waiters_);
+  }
+
+  /**
+   * @brief Move all the items into the queue, blocks until there's enough
+   * room for all of them.
+   */
+  void PutBatch(std::vector<T>& items) {
+    auto begin = items.begin();
+    while (begin != items.end()) {
+      wait_for(full_, full_waiters_, [&]() {
+        size_t count = ring_.TryPutBatch(begin, items.end());
+        begin += count;
+        return count != 0;
+      });
+      notify(empty_, empty_waiters_);
+    }
+    items.clear();
+  }
+
+  bool Get(T& item) {
+    bool got = false;
+    wait_for(empty_, empty_waiters_, [&]() {
+      got = ring_.TryGet(item);
+      return got || producer_num_.load() == 0;
+    });
+    if (!got) {
+      // drain the items that have been put before the last producer ends
+      got = ring_.TryGet(item);
+    }
+    if (got) {
+      notify(full_, full_waiters_);
+    }
+    return got;
+  }
+
+  /**
+   * @brief Get at most `limit` items, returns false once the queue is empty
+   * and all producers have finished.
+   */
+  bool GetBatch(std::vector<T>& items, size_t limit) {
+    size_t count = 0;
+    wait_for(empty_, empty_waiters_, [&]() {
+      count = ring_.TryGetBatch(items, limit);
+      return count != 0 || producer_num_.load() == 0;
+    });
+    if (count == 0) {
+      count = ring_.TryGetBatch(items, limit);
+    }
+    if (count != 0) {
+      notify(full_, full_waiters_);
+    }
+    return count != 0;
+  }
+
+  size_t Size() const { return ring_.size(); }
+
+  bool End() const { return ring_.size() == 0 && producer_num_.load() == 0; }
+
+ private:
+  static constexpr size_t kDefaultLimit = 1024;
+  static constexpr int kSpinCount = 64;
+  static constexpr int kYieldCount = 16;
+
+  template <typename F>
+  void wait_for(std::condition_variable& cv, std::atomic<int>& waiters,
+                F&& ready) {
+    for (int i = 0; i < kSpinCount; ++i) {
+      if (ready()) {
+        return;
+      }
+    }
+    for (int i = 0; i < kYieldCount; ++i) {
+      std::this_thread::yield();
+      if (ready()) {
+        return;
+      }
+    }
+    std::unique_lock<std::mutex> lk(lock_);
+    waiters.fetch_add(1);
+    // the counter is increased before checking again, pairs with the fence
+    // in `notify`, hence the wakeup won't be lost.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    cv.wait(lk, ready);
+    waiters.fetch_sub(1);
+  }
+
+  void notify(std::condition_variable& cv, std::atomic<int>& waiters) {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (waiters.load(std::memory_order_relaxed) > 0) {
+      std::lock_guard<std::mutex> lk(lock_);
+      cv.notify_all();
+    }
+  }
+
+  MPMCRing<T> ring_;
+  std::atomic<int> producer_num_{0};
+
+  std::mutex lock_;
+  std::condition_variable empty_, full_;
+  std::atomic<int> empty_waiters_{0}, full_waiters_{0};
+};
+
+}  // namespace vineyard
+
+#endif  // SRC_COMMON_UTIL_MPMC_QUEUE_H_
@@ -15,8 +15,10 @@ limitations under the License.
 
 #include "common/util/protocols.h"
 
+#include <cstdlib>
 #include <sstream>
 #include <unordered_set>
+#include <utility>
 
 #include "boost/algorithm/string.hpp"
 
@@ -82,6 +84,24 @@ CommandType ParseCommandType(const std::string& str_type) {
     return CommandType::DropNameRequest;
   } else if (str_type == "if_persist_request") {
     return CommandType::IfPersistRequest;
+  } else if (str_type == "locality_info_request") {
+    return CommandType::LocalityInfoRequest;
+  } else if (str_type == "prefetch_request") {
+    return CommandType::PrefetchRequest;
+  } else if (str_type == "footprints_request") {
+    return CommandType::FootprintsRequest;
+  } else if (str_type == "list_objects_request") {
+    return CommandType::ListObjectsRequest;
+  } else if (str_type == "put_names_request") {
+    return CommandType::PutNamesRequest;
+  } else if (str_type == "get_names_request") {
+    return CommandType::GetNamesRequest;
+  } else if (str_type == "drop_names_request") {
+    return CommandType::DropNamesRequest;
+  } else if (str_type == "batch_request") {
+    return CommandType::BatchRequest;
+  } else if (str_type == "enable_blob_table_request") {
+    return CommandType::EnableBlobTableRequest;
   } else if (str_type == "instance_status_request") {
     return CommandType::InstanceStatusRequest;
   } else if (str_type == "shallow_copy_request") {
@@ -102,6 +122,34 @@ CommandType ParseCommandType(const std::string& str_type) {
     return CommandType::MakeArenaRequest;
   } else if (str_type == "finalize_arena_request") {
     return CommandType::FinalizeArenaRequest;
+  } else if (str_type == "release_request") {
+    return CommandType::ReleaseRequest;
+  } else if (str_type == "create_buffers_request") {
+    return CommandType::CreateBuffersRequest;
+  } else if (str_type == "enable_ring_request") {
+    return CommandType::EnableRingRequest;
+  } else if (str_type == "get_remote_buffer_chunks_request") {
+    return CommandType::GetRemoteBufferChunksRequest;
+  } else if (str_type == "subscribe_invalidation_request") {
+    return CommandType::SubscribeInvalidationRequest;
+  } else if (str_type == "subscribe_objects_request") {
+    return CommandType::SubscribeObjectsRequest;
+  } else if (str_type == "get_objects_request") {
+    return CommandType::GetObjectsRequest;
+  } else if (str_type == "extend_buffer_request") {
+    return CommandType::ExtendBufferRequest;
+  } else if (str_type == "copy_buffer_request") {
+    return CommandType::CopyBufferRequest;
+  } else if (str_type == "create_buffer_from_file_request") {
+    return CommandType::CreateBufferFromFileRequest;
+  } else if (str_type == "create_snapshot_request") {
+    return CommandType::CreateSnapshotRequest;
+  } else if (str_type == "release_snapshot_request") {
+    return CommandType::ReleaseSnapshotRequest;
+  } else if (str_type == "wait_persisted_request") {
+    return CommandType::WaitPersistedRequest;
+  } else if (str_type == "gossip_request") {
+    return CommandType::GossipRequest;
   } else if (str_type == "debug_command") {
     return CommandType::DebugCommand;
   } else {
@@ -125,6 +173,27 @@ void WriteRegisterRequest(std::string& msg) {
   encode_msg(root, msg);
 }
 
+void WriteRegisterRequest(const uint64_t server_token,
+                          const std::vector<int>& mapped_fds,
+                          std::string& msg) {
+  WriteRegisterRequest(server_token, mapped_fds, "", msg);
+}
+
+void WriteRegisterRequest(const uint64_t server_token,
+                          const std::vector<int>& mapped_fds,
+                          const std::string& tenant, std::string& msg) {
+  json root;
+  root["type"] = "register_request";
+  root["version"] = vineyard_version();
+  root["server_token"] = server_token;
+  root["mapped_fds"] = mapped_fds;
+  if (!tenant.empty()) {
+    root["tenant"] = tenant;
+  }
+
+  encode_msg(root, msg);
+}
+
 Status ReadRegisterRequest(const json& root, std::string& version) {
   RETURN_ON_ASSERT(root["type"] == "register_request");
 
@@ -134,15 +203,51 @@ Status ReadRegisterRequest(const json& root, std::string& version) {
   return Status::OK();
 }
 
+Status ReadRegisterRequest(const json& root, std::string& version,
+                           uint64_t& server_token,
+                           std::vector<int>& mapped_fds) {
+  RETURN_ON_ERROR(ReadRegisterRequest(root, version));
+  server_token = root.value<uint64_t>("server_token", 0);
+  if (root.contains("mapped_fds")) {
+    root["mapped_fds"].get_to(mapped_fds);
+  }
+  return Status::OK();
+}
+
+Status ReadRegisterRequest(const json& root, std::string& version,
+                           uint64_t& server_token, std::vector<int>& mapped_fds,
+                           std::string& tenant) {
+  RETURN_ON_ERROR(
+      ReadRegisterRequest(root, version, server_token, mapped_fds));
+  tenant = root.value<std::string>("tenant", "");
+  return Status::OK();
+}
+
 void WriteRegisterReply(const std::string& ipc_socket,
                         const std::string& rpc_endpoint,
                         const InstanceID instance_id, std::string& msg) {
+  WriteRegisterReply(ipc_socket, rpc_endpoint, instance_id, 0, msg);
+}
+
+void WriteRegisterReply(const std::string& ipc_socket,
+                        const std::string& rpc_endpoint,
+                        const InstanceID instance_id,
+                        const uint64_t server_token, std::string& msg) {
   json root;
   root["type"] = "register_reply";
   root["ipc_socket"] = ipc_socket;
   root["rpc_endpoint"] = rpc_endpoint;
   root["instance_id"] = instance_id;
   root["version"] = vineyard_version();
+  // the server accepts binary messages, see also "binary_protocols.h".
+  root["binary_protocol"] = true;
+  // the server accepts requests from shared memory rings, see also
+  // "common/memory/ring_buffer.h".
+  root["ipc_ring"] = true;
+  // identifies the server process, see also `WriteRegisterRequest`.
+  root["server_token"] = server_token;
+  // the server accepts pipelined requests, see also `TagRequestID`.
+  root["pipelining"] = true;
   encode_msg(root, msg);
 }
 
@@ -160,6 +265,61 @@ Status ReadRegisterReply(const json& root, std::string& ipc_socket,
   return Status::OK();
 }
 
+Status ReadRegisterReply(const json& root, std::string& ipc_socket,
+                         std::string& rpc_endpoint, InstanceID& instance_id,
+                         std::string& version, bool& binary_protocol,
+                         bool& ipc_ring) {
+  RETURN_ON_ERROR(ReadRegisterReply(root, ipc_socket, rpc_endpoint,
+                                    instance_id, version));
+  binary_protocol = root.value("binary_protocol", false);
+  ipc_ring = root.value("ipc_ring", false);
+  return Status::OK();
+}
+
+Status ReadRegisterReply(const json& root, std::string& ipc_socket,
+                         std::string& rpc_endpoint, InstanceID& instance_id,
+                         std::string& version, bool& binary_protocol,
+                         bool& ipc_ring, uint64_t& server_token) {
+  RETURN_ON_ERROR(ReadRegisterReply(root, ipc_socket, rpc_endpoint,
+                                    instance_id, version, binary_protocol,
+                                    ipc_ring));
+  server_token = root.value<uint64_t>("server_token", 0);
+  return Status::OK();
+}
+
+Status ReadRegisterReply(const json& root, std::string& ipc_socket,
+                         std::string& rpc_endpoint, InstanceID& instance_id,
+                         std::string& version, bool& binary_protocol,
+                         bool& ipc_ring, uint64_t& server_token,
+                         bool& pipelining) {
+  RETURN_ON_ERROR(ReadRegisterReply(root, ipc_socket, rpc_endpoint,
+                                    instance_id, version, binary_protocol,
+                                    ipc_ring, server_token));
+  pipelining = root.value("pipelining", false);
+  return Status::OK();
+}
+
+static constexpr char kRequestIDPrefix[] = "{\"request_id\":";
+
+void TagRequestID(const uint64_t request_id, std::string& msg) {
+  // the messages are json objects, i.e., "{...}".
+  std::string tagged = kRequestIDPrefix + std::to_string(request_id);
+  if (msg.size() > 2) {
+    tagged.push_back(',');
+  }
+  tagged.append(msg, 1, std::string::npos);
+  msg = std::move(tagged);
+}
+
+bool ReadRequestID(const std::string& msg, uint64_t& request_id) {
+  const size_t length = sizeof(kRequestIDPrefix) - 1;
+  if (msg.compare(0, length, kRequestIDPrefix) != 0) {
+    return false;
+  }
+  request_id = std::strtoull(msg.c_str() + length, nullptr, 10);
+  return true;
+}
+
 void WriteExitRequest(std::string& msg) {
   json root;
   root["type"] = "exit_request";
@@ -181,21 +341,41 @@ void WriteGetDataRequest(const ObjectID id, const bool sync_remote,
 void WriteGetDataRequest(const std::vector<ObjectID>& ids,
                          const bool sync_remote, const bool wait,
                          std::string& msg) {
+  WriteGetDataRequest(ids, sync_remote, wait, false, msg);
+}
+
+void WriteGetDataRequest(const std::vector<ObjectID>& ids,
+                         const bool sync_remote, const bool wait,
+                         const bool lazy, std::string& msg) {
+  WriteGetDataRequest(ids, sync_remote, wait, lazy, 0, msg);
+}
+
+void WriteGetDataRequest(const std::vector<ObjectID>& ids,
+                         const bool sync_remote, const bool wait,
+                         const bool lazy, const uint64_t snapshot,
+                         std::string& msg) {
   json root;
   root["type"] = "get_data_request";
   root["id"] = ids;
   root["sync_remote"] = sync_remote;
   root["wait"] = wait;
+  root["lazy"] = lazy;
+  if (snapshot != 0) {
+    root["snapshot"] = snapshot;
+  }
 
   encode_msg(root, msg);
 }
 
 Status ReadGetDataRequest(const json& root, std::vector<ObjectID>& ids,
-                          bool& sync_remote, bool& wait) {
+                          bool& sync_remote, bool& wait, bool& lazy,
+                          uint64_t& snapshot) {
   RETURN_ON_ASSERT(root["type"] == "get_data_request");
   ids = root["id"].get_to(ids);
   sync_remote = root.value("sync_remote", false);
   wait = root.value("wait", false);
+  lazy = root.value("lazy", false);
+  snapshot = root.value("snapshot", static_cast<uint64_t>(0));
   return Status::OK();
 }
 
@@ -248,6 +428,56 @@ Status ReadListDataRequest(const json& root, std::string& pattern, bool& regex,
   return Status::OK();
 }
 
+void WriteListObjectsRequest(std::string const& pattern, bool const regex,
+                             std::string const& name_prefix,
+                             std::string const& cursor, size_t const limit,
+                             bool const brief, std::string& msg) {
+  json root;
+  root["type"] = "list_objects_request";
+  root["pattern"] = pattern;
+  root["regex"] = regex;
+  root["name_prefix"] = name_prefix;
+  root["cursor"] = cursor;
+  root["limit"] = limit;
+  root["brief"] = brief;
+
+  encode_msg(root, msg);
+}
+
+Status ReadListObjectsRequest(const json& root, std::string& pattern,
+                              bool& regex, std::string& name_prefix,
+                              std::string& cursor, size_t& limit,
+                              bool& brief) {
+  RETURN_ON_ASSERT(root["type"] == "list_objects_request");
+  pattern = root["pattern"].get_ref<std::string const&>();
+  regex = root.value("regex", false);
+  name_prefix = root.value("name_prefix", "");
+  cursor = root.value("cursor", "");
+  limit = root["limit"].get<size_t>();
+  brief = root.value("brief", false);
+  return Status::OK();
+}
+
+void WriteListObjectsReply(const json& objects, std::string const& next_cursor,
+                           std::string& msg) {
+  json root;
+  root["type"] = "list_objects_reply";
+  root["objects"] = objects;
+  root["next_cursor"] = next_cursor;
+
+  encode_msg(root, msg);
+}
+
+Status ReadListObjectsReply(const json& root, std::vector<json>& objects,
+                            std::string& next_cursor) {
+  CHECK_IPC_ERROR(root, "list_objects_reply");
+  for (auto const& item : root["objects"]) {
+    objects.emplace_back(item);
+  }
+  next_cursor = root.value("next_cursor", "");
+  return Status::OK();
+}
+
 void WriteCreateBufferRequest(const size_t size, std::string& msg) {
   json root;
   root["type"] = "create_buffer_request";
@@ -256,12 +486,50 @@ void WriteCreateBufferRequest(const size_t size, std::string& msg) {
   encode_msg(root, msg);
 }
 
+void WriteCreateBufferRequest(const size_t size, const int numa_node,
+                              std::string& msg) {
+  json root;
+  root["type"] = "create_buffer_request";
+  root["size"] = size;
+  root["numa_node"] = numa_node;
+
+  encode_msg(root, msg);
+}
+
 Status ReadCreateBufferRequest(const json& root, size_t& size) {
   RETURN_ON_ASSERT(root["type"] == "create_buffer_request");
   size = root["size"].get<size_t>();
   return Status::OK();
 }
 
+Status ReadCreateBufferRequest(const json& root, size_t& size,
+                               int& numa_node) {
+  RETURN_ON_ASSERT(root["type"] == "create_buffer_request");
+  size = root["size"].get<size_t>();
+  numa_node = root.value("numa_node", -1);
+  return Status::OK();
+}
+
+void WriteCreateBufferRequest(const size_t size, const int numa_node,
+                              const int device, std::string& msg) {
+  json root;
+  root["type"] = "create_buffer_request";
+  root["size"] = size;
+  root["numa_node"] = numa_node;
+  root["device"] = device;
+
+  encode_msg(root, msg);
+}
+
+Status ReadCreateBufferRequest(const json& root, size_t& size, int& numa_node,
+                               int& device) {
+  RETURN_ON_ASSERT(root["type"] == "create_buffer_request");
+  size = root["size"].get<size_t>();
+  numa_node = root.value("numa_node", -1);
+  device = root.value("device", -1);
+  return Status::OK();
+}
+
 void WriteCreateBufferReply(const ObjectID id,
                             const std::shared_ptr<Payload>& object,
                             std::string& msg) {
@@ -297,6 +565,51 @@ Status ReadCreateRemoteBufferRequest(const json& root, size_t& size) {
   return Status::OK();
 }
 
+void WriteCreateBuffersRequest(const std::vector<size_t>& sizes,
+                               std::string& msg) {
+  json root;
+  root["type"] = "create_buffers_request";
+  root["sizes"] = sizes;
+  root["num"] = sizes.size();
+
+  encode_msg(root, msg);
+}
+
+Status ReadCreateBuffersRequest(const json& root, std::vector<size_t>& sizes) {
+  RETURN_ON_ASSERT(root["type"] == "create_buffers_request");
+  sizes = root["sizes"].get<std::vector<size_t>>();
+  return Status::OK();
+}
+
+void WriteCreateBuffersReply(
+    const std::vector<ObjectID>& ids,
+    const std::vector<std::shared_ptr<Payload>>& objects, std::string& msg) {
+  json root;
+  root["type"] = "create_buffers_reply";
+  for (size_t i = 0; i < objects.size(); ++i) {
+    json tree;
+    objects[i]->ToJSON(tree);
+    root[std::to_string(i)] = tree;
+  }
+  root["ids"] = ids;
+  root["num"] = objects.size();
+
+  encode_msg(root, msg);
+}
+
+Status ReadCreateBuffersReply(const json& root, std::vector<ObjectID>& ids,
+                              std::vector<Payload>& objects) {
+  CHECK_IPC_ERROR(root, "create_buffers_reply");
+  ids = root["ids"].get<std::vector<ObjectID>>();
+  for (size_t i = 0; i < root["num"]; ++i) {
+    json tree = root[std::to_string(i)];
+    Payload object;
+    object.FromJSON(tree);
+    objects.emplace_back(object);
+  }
+  return Status::OK();
+}
+
 void WriteGetBuffersRequest(const std::set<ObjectID>& ids, std::string& msg) {
   json root;
   root["type"] = "get_buffers_request";
@@ -366,6 +679,46 @@ Status ReadGetRemoteBuffersRequest(const json& root,
   return Status::OK();
 }
 
+void WriteGetRemoteBufferChunksRequest(const std::vector<ObjectID>& ids,
+                                       const std::vector<size_t>& offsets,
+                                       const std::vector<size_t>& sizes,
+                                       std::string& msg) {
+  json root;
+  root["type"] = "get_remote_buffer_chunks_request";
+  root["ids"] = ids;
+  root["offsets"] = offsets;
+  root["sizes"] = sizes;
+
+  encode_msg(root, msg);
+}
+
+Status ReadGetRemoteBufferChunksRequest(const json& root,
+                                        std::vector<ObjectID>& ids,
+                                        std::vector<size_t>& offsets,
+                                        std::vector<size_t>& sizes) {
+  RETURN_ON_ASSERT(root["type"] == "get_remote_buffer_chunks_request");
+  ids = root["ids"].get<std::vector<ObjectID>>();
+  offsets = root["offsets"].get<std::vector<size_t>>();
+  sizes = root["sizes"].get<std::vector<size_t>>();
+  RETURN_ON_ASSERT(ids.size() == offsets.size() && ids.size() == sizes.size());
+  return Status::OK();
+}
+
+void WriteGetRemoteBufferChunksReply(const size_t total_size,
+                                     std::string& msg) {
+  json root;
+  root["type"] = "get_remote_buffer_chunks_reply";
+  root["total_size"] = total_size;
+
+  encode_msg(root, msg);
+}
+
+Status ReadGetRemoteBufferChunksReply(const json& root, size_t& total_size) {
+  CHECK_IPC_ERROR(root, "get_remote_buffer_chunks_reply");
+  total_size = root["total_size"].get<size_t>();
+  return Status::OK();
+}
+
 void WriteDropBufferRequest(const ObjectID id, std::string& msg) {
   json root;
   root["type"] = "drop_buffer_request";
@@ -392,17 +745,52 @@ Status ReadDropBufferReply(const json& root) {
   return Status::OK();
 }
 
+void WriteReleaseRequest(const std::vector<ObjectID>& ids, std::string& msg) {
+  json root;
+  root["type"] = "release_request";
+  root["ids"] = ids;
+
+  encode_msg(root, msg);
+}
+
+Status ReadReleaseRequest(const json& root, std::vector<ObjectID>& ids) {
+  RETURN_ON_ASSERT(root["type"] == "release_request");
+  ids = root["ids"].get_to(ids);
+  return Status::OK();
+}
+
+void WriteReleaseReply(std::string& msg) {
+  json root;
+  root["type"] = "release_reply";
+
+  encode_msg(root, msg);
+}
+
+Status ReadReleaseReply(const json& root) {
+  CHECK_IPC_ERROR(root, "release_reply");
+  return Status::OK();
+}
+
 void WriteCreateDataRequest(const json& content, std::string& msg) {
+  WriteCreateDataRequest(content, 0, msg);
+}
+
+void WriteCreateDataRequest(const json& content, const int64_t ttl,
+                            std::string& msg) {
   json root;
   root["type"] = "create_data_request";
   root["content"] = content;
+  if (ttl > 0) {
+    root["ttl"] = ttl;
+  }
 
   encode_msg(root, msg);
 }
 
-Status ReadCreateDataRequest(const json& root, json& content) {
+Status ReadCreateDataRequest(const json& root, json& content, int64_t& ttl) {
   RETURN_ON_ASSERT(root["type"] == "create_data_request");
   content = root["content"];
+  ttl = root.value("ttl", static_cast<int64_t>(0));
   return Status::OK();
 }
 
@@ -427,16 +815,30 @@ Status ReadCreateDataReply(const json& root, ObjectID& id, Signature& signature,
 }
 
 void WritePersistRequest(const ObjectID id, std::string& msg) {
+  WritePersistRequest(id, false, msg);
+}
+
+Status ReadPersistRequest(const json& root, ObjectID& id) {
+  bool async = false;
+  return ReadPersistRequest(root, id, async);
+}
+
+void WritePersistRequest(const ObjectID id, const bool async,
+                         std::string& msg) {
   json root;
   root["type"] = "persist_request";
   root["id"] = id;
+  if (async) {
+    root["async"] = true;
+  }
 
   encode_msg(root, msg);
 }
 
-Status ReadPersistRequest(const json& root, ObjectID& id) {
+Status ReadPersistRequest(const json& root, ObjectID& id, bool& async) {
   RETURN_ON_ASSERT(root["type"] == "persist_request");
   id = root["id"].get<ObjectID>();
+  async = root.value("async", false);
   return Status::OK();
 }
 
@@ -447,11 +849,51 @@ void WritePersistReply(std::string& msg) {
   encode_msg(root, msg);
 }
 
+void WritePersistReply(const uint64_t ticket, std::string& msg) {
+  json root;
+  root["type"] = "persist_reply";
+  root["ticket"] = ticket;
+
+  encode_msg(root, msg);
+}
+
 Status ReadPersistReply(const json& root) {
   CHECK_IPC_ERROR(root, "persist_reply");
   return Status::OK();
 }
 
+Status ReadPersistReply(const json& root, uint64_t& ticket) {
+  CHECK_IPC_ERROR(root, "persist_reply");
+  ticket = root.value("ticket", static_cast<uint64_t>(0));
+  return Status::OK();
+}
+
+void WriteWaitPersistedRequest(const uint64_t ticket, std::string& msg) {
+  json root;
+  root["type"] = "wait_persisted_request";
+  root["ticket"] = ticket;
+
+  encode_msg(root, msg);
+}
+
+Status ReadWaitPersistedRequest(const json& root, uint64_t& ticket) {
+  RETURN_ON_ASSERT(root["type"] == "wait_persisted_request");
+  ticket = root.value("ticket", static_cast<uint64_t>(0));
+  return Status::OK();
+}
+
+void WriteWaitPersistedReply(std::string& msg) {
+  json root;
+  root["type"] = "wait_persisted_reply";
+
+  encode_msg(root, msg);
+}
+
+Status ReadWaitPersistedReply(const json& root) {
+  CHECK_IPC_ERROR(root, "wait_persisted_reply");
+  return Status::OK();
+}
+
 void WriteIfPersistRequest(const ObjectID id, std::string& msg) {
   json root;
   root["type"] = "if_persist_request";
@@ -607,90 +1049,315 @@ Status ReadInstanceStatusReply(const json& root, json& meta) {
   return Status::OK();
 }
 
-void WritePutNameRequest(const ObjectID object_id, const std::string& name,
-                         std::string& msg) {
+void WriteLocalityInfoRequest(const ObjectID id, const bool sync_remote,
+                              std::string& msg) {
   json root;
-  root["type"] = "put_name_request";
-  root["object_id"] = object_id;
-  root["name"] = name;
-
+  root["type"] = "locality_info_request";
+  root["id"] = id;
+  root["sync_remote"] = sync_remote;
   encode_msg(root, msg);
 }
 
-Status ReadPutNameRequest(const json& root, ObjectID& object_id,
-                          std::string& name) {
-  RETURN_ON_ASSERT(root["type"] == "put_name_request");
-  object_id = root["object_id"].get<ObjectID>();
-  name = root["name"].get_ref<std::string const&>();
+Status ReadLocalityInfoRequest(const json& root, ObjectID& id,
+                               bool& sync_remote) {
+  RETURN_ON_ASSERT(root["type"] == "locality_info_request");
+  id = root["id"].get<ObjectID>();
+  sync_remote = root.value("sync_remote", false);
   return Status::OK();
 }
 
-void WritePutNameReply(std::string& msg) {
+void WriteLocalityInfoReply(const json& locality, std::string& msg) {
   json root;
-  root["type"] = "put_name_reply";
-
+  root["type"] = "locality_info_reply";
+  root["locality"] = locality;
   encode_msg(root, msg);
 }
 
-Status ReadPutNameReply(const json& root) {
-  CHECK_IPC_ERROR(root, "put_name_reply");
+Status ReadLocalityInfoReply(const json& root, json& locality) {
+  CHECK_IPC_ERROR(root, "locality_info_reply");
+  locality = root["locality"];
   return Status::OK();
 }
 
-void WriteGetNameRequest(const std::string& name, const bool wait,
-                         std::string& msg) {
+void WritePrefetchRequest(const std::vector<ObjectID>& ids, std::string& msg) {
   json root;
-  root["type"] = "get_name_request";
-  root["name"] = name;
-  root["wait"] = wait;
-
+  root["type"] = "prefetch_request";
+  root["ids"] = ids;
   encode_msg(root, msg);
 }
 
-Status ReadGetNameRequest(const json& root, std::string& name, bool& wait) {
-  RETURN_ON_ASSERT(root["type"] == "get_name_request");
-  name = root["name"].get_ref<std::string const&>();
-  wait = root["wait"].get<bool>();
+Status ReadPrefetchRequest(const json& root, std::vector<ObjectID>& ids) {
+  RETURN_ON_ASSERT(root["type"] == "prefetch_request");
+  ids = root["ids"].get<std::vector<ObjectID>>();
   return Status::OK();
 }
 
-void WriteGetNameReply(const ObjectID& object_id, std::string& msg) {
+void WritePrefetchReply(const size_t nbytes, std::string& msg) {
   json root;
-  root["type"] = "get_name_reply";
-  root["object_id"] = object_id;
-
+  root["type"] = "prefetch_reply";
+  root["nbytes"] = nbytes;
   encode_msg(root, msg);
 }
 
-Status ReadGetNameReply(const json& root, ObjectID& object_id) {
-  CHECK_IPC_ERROR(root, "get_name_reply");
-  object_id = root["object_id"].get<ObjectID>();
+Status ReadPrefetchReply(const json& root, size_t& nbytes) {
+  CHECK_IPC_ERROR(root, "prefetch_reply");
+  nbytes = root.value("nbytes", static_cast<size_t>(0));
   return Status::OK();
 }
 
-void WriteDropNameRequest(const std::string& name, std::string& msg) {
+void WriteFootprintsRequest(const std::vector<ObjectID>& ids,
+                            const size_t limit, std::string& msg) {
   json root;
-  root["type"] = "drop_name_request";
-  root["name"] = name;
-
+  root["type"] = "footprints_request";
+  root["ids"] = ids;
+  root["limit"] = limit;
   encode_msg(root, msg);
 }
 
-Status ReadDropNameRequest(const json& root, std::string& name) {
-  RETURN_ON_ASSERT(root["type"] == "drop_name_request");
-  name = root["name"].get_ref<std::string const&>();
+Status ReadFootprintsRequest(const json& root, std::vector<ObjectID>& ids,
+                             size_t& limit) {
+  RETURN_ON_ASSERT(root["type"] == "footprints_request");
+  ids = root.value("ids", std::vector<ObjectID>{});
+  limit = root.value("limit", static_cast<size_t>(0));
   return Status::OK();
 }
 
-void WriteDropNameReply(std::string& msg) {
+void WriteFootprintsReply(const json& footprints, std::string& msg) {
   json root;
-  root["type"] = "drop_name_reply";
-
+  root["type"] = "footprints_reply";
+  root["footprints"] = footprints;
   encode_msg(root, msg);
 }
 
-Status ReadDropNameReply(const json& root) {
-  CHECK_IPC_ERROR(root, "drop_name_reply");
+Status ReadFootprintsReply(const json& root, json& footprints) {
+  CHECK_IPC_ERROR(root, "footprints_reply");
+  footprints = root["footprints"];
+  return Status::OK();
+}
+
+void WritePutNameRequest(const ObjectID object_id, const std::string& name,
+                         std::string& msg) {
+  WritePutNameRequest(object_id, name, 0, msg);
+}
+
+void WritePutNameRequest(const ObjectID object_id, const std::string& name,
+                         const int64_t ttl, std::string& msg) {
+  json root;
+  root["type"] = "put_name_request";
+  root["object_id"] = object_id;
+  root["name"] = name;
+  if (ttl > 0) {
+    root["ttl"] = ttl;
+  }
+
+  encode_msg(root, msg);
+}
+
+Status ReadPutNameRequest(const json& root, ObjectID& object_id,
+                          std::string& name, int64_t& ttl) {
+  RETURN_ON_ASSERT(root["type"] == "put_name_request");
+  object_id = root["object_id"].get<ObjectID>();
+  name = root["name"].get_ref<std::string const&>();
+  ttl = root.value("ttl", static_cast<int64_t>(0));
+  return Status::OK();
+}
+
+void WritePutNameReply(std::string& msg) {
+  json root;
+  root["type"] = "put_name_reply";
+
+  encode_msg(root, msg);
+}
+
+Status ReadPutNameReply(const json& root) {
+  CHECK_IPC_ERROR(root, "put_name_reply");
+  return Status::OK();
+}
+
+void WriteGetNameRequest(const std::string& name, const bool wait,
+                         std::string& msg) {
+  json root;
+  root["type"] = "get_name_request";
+  root["name"] = name;
+  root["wait"] = wait;
+
+  encode_msg(root, msg);
+}
+
+Status ReadGetNameRequest(const json& root, std::string& name, bool& wait) {
+  RETURN_ON_ASSERT(root["type"] == "get_name_request");
+  name = root["name"].get_ref<std::string const&>();
+  wait = root["wait"].get<bool>();
+  return Status::OK();
+}
+
+void WriteGetNameReply(const ObjectID& object_id, std::string& msg) {
+  json root;
+  root["type"] = "get_name_reply";
+  root["object_id"] = object_id;
+
+  encode_msg(root, msg);
+}
+
+Status ReadGetNameReply(const json& root, ObjectID& object_id) {
+  CHECK_IPC_ERROR(root, "get_name_reply");
+  object_id = root["object_id"].get<ObjectID>();
+  return Status::OK();
+}
+
+void WriteDropNameRequest(const std::string& name, std::string& msg) {
+  json root;
+  root["type"] = "drop_name_request";
+  root["name"] = name;
+
+  encode_msg(root, msg);
+}
+
+Status ReadDropNameRequest(const json& root, std::string& name) {
+  RETURN_ON_ASSERT(root["type"] == "drop_name_request");
+  name = root["name"].get_ref<std::string const&>();
+  return Status::OK();
+}
+
+void WriteDropNameReply(std::string& msg) {
+  json root;
+  root["type"] = "drop_name_reply";
+
+  encode_msg(root, msg);
+}
+
+Status ReadDropNameReply(const json& root) {
+  CHECK_IPC_ERROR(root, "drop_name_reply");
+  return Status::OK();
+}
+
+void WritePutNamesRequest(const std::map<std::string, ObjectID>& names,
+                          std::string& msg) {
+  json root;
+  root["type"] = "put_names_request";
+  root["names"] = names;
+
+  encode_msg(root, msg);
+}
+
+Status ReadPutNamesRequest(const json& root,
+                           std::map<std::string, ObjectID>& names) {
+  RETURN_ON_ASSERT(root["type"] == "put_names_request");
+  names = root["names"].get<std::map<std::string, ObjectID>>();
+  return Status::OK();
+}
+
+void WritePutNamesReply(std::string& msg) {
+  json root;
+  root["type"] = "put_names_reply";
+
+  encode_msg(root, msg);
+}
+
+Status ReadPutNamesReply(const json& root) {
+  CHECK_IPC_ERROR(root, "put_names_reply");
+  return Status::OK();
+}
+
+void WriteGetNamesRequest(const std::vector<std::string>& names,
+                          std::string& msg) {
+  WriteGetNamesRequest(names, 0, msg);
+}
+
+void WriteGetNamesRequest(const std::vector<std::string>& names,
+                          const uint64_t snapshot, std::string& msg) {
+  json root;
+  root["type"] = "get_names_request";
+  root["names"] = names;
+  if (snapshot != 0) {
+    root["snapshot"] = snapshot;
+  }
+
+  encode_msg(root, msg);
+}
+
+Status ReadGetNamesRequest(const json& root, std::vector<std::string>& names,
+                           uint64_t& snapshot) {
+  RETURN_ON_ASSERT(root["type"] == "get_names_request");
+  names = root["names"].get<std::vector<std::string>>();
+  snapshot = root.value("snapshot", static_cast<uint64_t>(0));
+  return Status::OK();
+}
+
+void WriteGetNamesReply(const std::map<std::string, ObjectID>& object_ids,
+                        std::string& msg) {
+  json root;
+  root["type"] = "get_names_reply";
+  root["object_ids"] = object_ids;
+
+  encode_msg(root, msg);
+}
+
+Status ReadGetNamesReply(const json& root,
+                         std::map<std::string, ObjectID>& object_ids) {
+  CHECK_IPC_ERROR(root, "get_names_reply");
+  object_ids = root["object_ids"].get<std::map<std::string, ObjectID>>();
+  return Status::OK();
+}
+
+void WriteDropNamesRequest(const std::vector<std::string>& names,
+                           std::string& msg) {
+  json root;
+  root["type"] = "drop_names_request";
+  root["names"] = names;
+
+  encode_msg(root, msg);
+}
+
+Status ReadDropNamesRequest(const json& root, std::vector<std::string>& names) {
+  RETURN_ON_ASSERT(root["type"] == "drop_names_request");
+  names = root["names"].get<std::vector<std::string>>();
+  return Status::OK();
+}
+
+void WriteDropNamesReply(std::string& msg) {
+  json root;
+  root["type"] = "drop_names_reply";
+
+  encode_msg(root, msg);
+}
+
+Status ReadDropNamesReply(const json& root) {
+  CHECK_IPC_ERROR(root, "drop_names_reply");
+  return Status::OK();
+}
+
+void WriteBatchRequest(const json& ops, std::string& msg) {
+  json root;
+  root["type"] = "batch_request";
+  root["ops"] = ops;
+
+  encode_msg(root, msg);
+}
+
+Status ReadBatchRequest(const json& root, json& ops) {
+  RETURN_ON_ASSERT(root["type"] == "batch_request");
+  ops = root["ops"];
+  return Status::OK();
+}
+
+void WriteBatchReply(const json& objects, std::string& msg) {
+  json root;
+  root["type"] = "batch_reply";
+  root["objects"] = objects;
+
+  encode_msg(root, msg);
+}
+
+Status ReadBatchReply(const json& root, std::vector<ObjectID>& ids,
+                      std::vector<Signature>& signatures,
+                      std::vector<InstanceID>& instance_ids) {
+  CHECK_IPC_ERROR(root, "batch_reply");
+  for (auto const& object : root["objects"]) {
+    ids.emplace_back(object["id"].get<ObjectID>());
+    signatures.emplace_back(object["signature"].get<Signature>());
+    instance_ids.emplace_back(object["instance_id"].get<InstanceID>());
+  }
   return Status::OK();
 }
 
@@ -750,6 +1417,31 @@ Status ReadCreateStreamRequest(const json& root, ObjectID& object_id) {
   return Status::OK();
 }
 
+void WriteCreateStreamRequest(const ObjectID& object_id,
+                              const size_t retain_chunks,
+                              const size_t retain_bytes,
+                              const size_t budget_bytes, std::string& msg) {
+  json root;
+  root["type"] = "create_stream_request";
+  root["object_id"] = object_id;
+  root["retain_chunks"] = retain_chunks;
+  root["retain_bytes"] = retain_bytes;
+  root["budget_bytes"] = budget_bytes;
+
+  encode_msg(root, msg);
+}
+
+Status ReadCreateStreamRequest(const json& root, ObjectID& object_id,
+                               size_t& retain_chunks, size_t& retain_bytes,
+                               size_t& budget_bytes) {
+  RETURN_ON_ASSERT(root["type"] == "create_stream_request");
+  object_id = root["object_id"].get<ObjectID>();
+  retain_chunks = root.value("retain_chunks", static_cast<size_t>(0));
+  retain_bytes = root.value("retain_bytes", static_cast<size_t>(0));
+  budget_bytes = root.value("budget_bytes", static_cast<size_t>(0));
+  return Status::OK();
+}
+
 void WriteCreateStreamReply(std::string& msg) {
   json root;
   root["type"] = "create_stream_reply";
@@ -780,6 +1472,26 @@ Status ReadOpenStreamRequest(const json& root, ObjectID& object_id,
   return Status::OK();
 }
 
+void WriteOpenStreamRequest(const ObjectID& object_id, const int64_t& mode,
+                            const int64_t offset, std::string& msg) {
+  json root;
+  root["type"] = "open_stream_request";
+  root["object_id"] = object_id;
+  root["mode"] = mode;
+  root["offset"] = offset;
+
+  encode_msg(root, msg);
+}
+
+Status ReadOpenStreamRequest(const json& root, ObjectID& object_id,
+                             int64_t& mode, int64_t& offset) {
+  RETURN_ON_ASSERT(root["type"] == "open_stream_request");
+  object_id = root["object_id"].get<ObjectID>();
+  mode = root["mode"].get<int64_t>();
+  offset = root.value("offset", static_cast<int64_t>(-1));
+  return Status::OK();
+}
+
 void WriteOpenStreamReply(std::string& msg) {
   json root;
   root["type"] = "open_stream_reply";
@@ -1011,13 +1723,35 @@ void WriteFinalizeArenaRequest(const int fd, std::vector<size_t> const& offsets,
   encode_msg(root, msg);
 }
 
+void WriteFinalizeArenaRequest(const int fd, std::vector<size_t> const& offsets,
+                               std::vector<size_t> const& sizes,
+                               std::vector<size_t> const& unused_offsets,
+                               std::vector<size_t> const& unused_sizes,
+                               std::string& msg) {
+  json root;
+  root["type"] = "finalize_arena_request";
+  root["fd"] = fd;
+  root["offsets"] = offsets;
+  root["sizes"] = sizes;
+  root["keep_alive"] = true;
+  root["unused_offsets"] = unused_offsets;
+  root["unused_sizes"] = unused_sizes;
+
+  encode_msg(root, msg);
+}
+
 Status ReadFinalizeArenaRequest(const json& root, int& fd,
                                 std::vector<size_t>& offsets,
-                                std::vector<size_t>& sizes) {
+                                std::vector<size_t>& sizes, bool& keep_alive,
+                                std::vector<size_t>& unused_offsets,
+                                std::vector<size_t>& unused_sizes) {
   RETURN_ON_ASSERT(root["type"] == "finalize_arena_request");
   fd = root["fd"].get<int>();
   offsets = root["offsets"].get<std::vector<size_t>>();
   sizes = root["sizes"].get<std::vector<size_t>>();
+  keep_alive = root.value("keep_alive", false);
+  unused_offsets = root.value("unused_offsets", std::vector<size_t>{});
+  unused_sizes = root.value("unused_sizes", std::vector<size_t>{});
   return Status::OK();
 }
 
@@ -1032,6 +1766,393 @@ Status ReadFinalizeArenaReply(const json& root) {
   return Status::OK();
 }
 
+void WriteEnableRingRequest(const size_t capacity, std::string& msg) {
+  json root;
+  root["type"] = "enable_ring_request";
+  root["capacity"] = capacity;
+  encode_msg(root, msg);
+}
+
+Status ReadEnableRingRequest(const json& root, size_t& capacity) {
+  RETURN_ON_ASSERT(root["type"] == "enable_ring_request");
+  capacity = root["capacity"].get<size_t>();
+  return Status::OK();
+}
+
+void WriteEnableRingReply(const int fd, const size_t capacity,
+                          std::string& msg) {
+  json root;
+  root["type"] = "enable_ring_reply";
+  root["fd"] = fd;
+  root["capacity"] = capacity;
+  encode_msg(root, msg);
+}
+
+Status ReadEnableRingReply(const json& root, int& fd, size_t& capacity) {
+  CHECK_IPC_ERROR(root, "enable_ring_reply");
+  fd = root["fd"].get<int>();
+  capacity = root["capacity"].get<size_t>();
+  return Status::OK();
+}
+
+void WriteEnableBlobTableRequest(std::string& msg) {
+  json root;
+  root["type"] = "enable_blob_table_request";
+  encode_msg(root, msg);
+}
+
+Status ReadEnableBlobTableRequest(const json& root) {
+  RETURN_ON_ASSERT(root["type"] == "enable_blob_table_request");
+  return Status::OK();
+}
+
+void WriteEnableBlobTableReply(const int fd, const size_t capacity,
+                               std::string& msg) {
+  json root;
+  root["type"] = "enable_blob_table_reply";
+  root["fd"] = fd;
+  root["capacity"] = capacity;
+  encode_msg(root, msg);
+}
+
+Status ReadEnableBlobTableReply(const json& root, int& fd,
+                                size_t& capacity) {
+  CHECK_IPC_ERROR(root, "enable_blob_table_reply");
+  fd = root["fd"].get<int>();
+  capacity = root["capacity"].get<size_t>();
+  return Status::OK();
+}
+
+void WriteSubscribeInvalidationRequest(std::string& msg) {
+  json root;
+  root["type"] = "subscribe_invalidation_request";
+  encode_msg(root, msg);
+}
+
+Status ReadSubscribeInvalidationRequest(const json& root) {
+  RETURN_ON_ASSERT(root["type"] == "subscribe_invalidation_request");
+  return Status::OK();
+}
+
+void WriteSubscribeInvalidationReply(std::string& msg) {
+  json root;
+  root["type"] = "subscribe_invalidation_reply";
+  encode_msg(root, msg);
+}
+
+Status ReadSubscribeInvalidationReply(const json& root) {
+  CHECK_IPC_ERROR(root, "subscribe_invalidation_reply");
+  return Status::OK();
+}
+
+void WriteInvalidationNotification(const std::vector<ObjectID>& ids,
+                                   const std::vector<std::string>& names,
+                                   std::string& msg) {
+  json root;
+  root["type"] = "invalidation_notification";
+  root["ids"] = ids;
+  if (!names.empty()) {
+    root["names"] = names;
+  }
+  encode_msg(root, msg);
+}
+
+Status ReadInvalidationNotification(const json& root,
+                                    std::vector<ObjectID>& ids,
+                                    std::vector<std::string>& names) {
+  CHECK_IPC_ERROR(root, "invalidation_notification");
+  root["ids"].get_to(ids);
+  names = root.value("names", std::vector<std::string>{});
+  return Status::OK();
+}
+
+void WriteSubscribeObjectsRequest(
+    const std::string& type_pattern, const std::string& name_prefix,
+    const std::map<std::string, std::string>& labels, std::string& msg) {
+  json root;
+  root["type"] = "subscribe_objects_request";
+  root["type_pattern"] = type_pattern;
+  root["name_prefix"] = name_prefix;
+  root["labels"] = labels;
+  encode_msg(root, msg);
+}
+
+Status ReadSubscribeObjectsRequest(const json& root, std::string& type_pattern,
+                                   std::string& name_prefix,
+                                   std::map<std::string, std::string>& labels) {
+  RETURN_ON_ASSERT(root["type"] == "subscribe_objects_request");
+  type_pattern = root.value("type_pattern", "");
+  name_prefix = root.value("name_prefix", "");
+  labels = root.value("labels", std::map<std::string, std::string>{});
+  return Status::OK();
+}
+
+void WriteSubscribeObjectsReply(std::string& msg) {
+  json root;
+  root["type"] = "subscribe_objects_reply";
+  encode_msg(root, msg);
+}
+
+Status ReadSubscribeObjectsReply(const json& root) {
+  CHECK_IPC_ERROR(root, "subscribe_objects_reply");
+  return Status::OK();
+}
+
+void WriteObjectsNotification(const json& events, std::string& msg) {
+  json root;
+  root["type"] = "objects_notification";
+  root["events"] = events;
+  encode_msg(root, msg);
+}
+
+Status ReadObjectsNotification(const json& root, json& events) {
+  CHECK_IPC_ERROR(root, "objects_notification");
+  events = root["events"];
+  return Status::OK();
+}
+
+void WriteGetObjectsRequest(const std::vector<ObjectID>& ids,
+                            const bool sync_remote, const bool wait,
+                            std::string& msg) {
+  json root;
+  root["type"] = "get_objects_request";
+  root["id"] = ids;
+  root["sync_remote"] = sync_remote;
+  root["wait"] = wait;
+  encode_msg(root, msg);
+}
+
+Status ReadGetObjectsRequest(const json& root, std::vector<ObjectID>& ids,
+                             bool& sync_remote, bool& wait) {
+  RETURN_ON_ASSERT(root["type"] == "get_objects_request");
+  root["id"].get_to(ids);
+  sync_remote = root.value("sync_remote", false);
+  wait = root.value("wait", false);
+  return Status::OK();
+}
+
+void WriteGetObjectsReply(const json& content,
+                          const std::vector<std::shared_ptr<Payload>>& objects,
+                          std::string& msg) {
+  json root;
+  root["type"] = "get_objects_reply";
+  root["content"] = content;
+  json buffers = json::array();
+  for (auto const& object : objects) {
+    json tree;
+    object->ToJSON(tree);
+    buffers.push_back(tree);
+  }
+  root["buffers"] = buffers;
+  encode_msg(root, msg);
+}
+
+Status ReadGetObjectsReply(const json& root,
+                           std::unordered_map<ObjectID, json>& content,
+                           std::vector<Payload>& objects) {
+  CHECK_IPC_ERROR(root, "get_objects_reply");
+  for (auto const& kv : json::iterator_wrapper(root["content"])) {
+    content.emplace(VYObjectIDFromString(kv.key()), kv.value());
+  }
+  for (auto const& tree : root["buffers"]) {
+    Payload object;
+    object.FromJSON(tree);
+    objects.emplace_back(object);
+  }
+  return Status::OK();
+}
+
+void WriteExtendBufferRequest(const ObjectID id, const size_t size,
+                              std::string& msg) {
+  json root;
+  root["type"] = "extend_buffer_request";
+  root["id"] = id;
+  root["size"] = size;
+  encode_msg(root, msg);
+}
+
+Status ReadExtendBufferRequest(const json& root, ObjectID& id, size_t& size) {
+  RETURN_ON_ASSERT(root["type"] == "extend_buffer_request");
+  id = root["id"].get<ObjectID>();
+  size = root["size"].get<size_t>();
+  return Status::OK();
+}
+
+void WriteExtendBufferReply(const std::shared_ptr<Payload>& object,
+                            std::string& msg) {
+  json root;
+  root["type"] = "extend_buffer_reply";
+  json tree;
+  object->ToJSON(tree);
+  root["extended"] = tree;
+  encode_msg(root, msg);
+}
+
+Status ReadExtendBufferReply(const json& root, Payload& object) {
+  CHECK_IPC_ERROR(root, "extend_buffer_reply");
+  object.FromJSON(root["extended"]);
+  return Status::OK();
+}
+
+void WriteCopyBufferRequest(const ObjectID id, std::string& msg) {
+  json root;
+  root["type"] = "copy_buffer_request";
+  root["id"] = id;
+  encode_msg(root, msg);
+}
+
+Status ReadCopyBufferRequest(const json& root, ObjectID& id) {
+  RETURN_ON_ASSERT(root["type"] == "copy_buffer_request");
+  id = root["id"].get<ObjectID>();
+  return Status::OK();
+}
+
+void WriteCopyBufferReply(const ObjectID id,
+                          const std::shared_ptr<Payload>& object,
+                          std::string& msg) {
+  json root;
+  root["type"] = "copy_buffer_reply";
+  root["id"] = id;
+  json tree;
+  object->ToJSON(tree);
+  root["created"] = tree;
+  encode_msg(root, msg);
+}
+
+Status ReadCopyBufferReply(const json& root, ObjectID& id, Payload& object) {
+  CHECK_IPC_ERROR(root, "copy_buffer_reply");
+  id = root["id"].get<ObjectID>();
+  object.FromJSON(root["created"]);
+  return Status::OK();
+}
+
+void WriteCreateBufferFromFileRequest(const std::string& path,
+                                      const size_t offset,
+                                      const int64_t length, std::string& msg) {
+  json root;
+  root["type"] = "create_buffer_from_file_request";
+  root["path"] = path;
+  root["offset"] = offset;
+  root["length"] = length;
+  encode_msg(root, msg);
+}
+
+Status ReadCreateBufferFromFileRequest(const json& root, std::string& path,
+                                       size_t& offset, int64_t& length) {
+  RETURN_ON_ASSERT(root["type"] == "create_buffer_from_file_request");
+  path = root["path"].get_ref<std::string const&>();
+  offset = root.value("offset", static_cast<size_t>(0));
+  length = root.value("length", static_cast<int64_t>(-1));
+  return Status::OK();
+}
+
+void WriteCreateBufferFromFileReply(const ObjectID id,
+                                    const std::shared_ptr<Payload>& object,
+                                    std::string& msg) {
+  json root;
+  root["type"] = "create_buffer_from_file_reply";
+  root["id"] = id;
+  json tree;
+  object->ToJSON(tree);
+  root["created"] = tree;
+  encode_msg(root, msg);
+}
+
+Status ReadCreateBufferFromFileReply(const json& root, ObjectID& id,
+                                     Payload& object) {
+  CHECK_IPC_ERROR(root, "create_buffer_from_file_reply");
+  id = root["id"].get<ObjectID>();
+  object.FromJSON(root["created"]);
+  return Status::OK();
+}
+
+void WriteCreateSnapshotRequest(const bool sync_remote, std::string& msg) {
+  json root;
+  root["type"] = "create_snapshot_request";
+  root["sync_remote"] = sync_remote;
+  encode_msg(root, msg);
+}
+
+Status ReadCreateSnapshotRequest(const json& root, bool& sync_remote) {
+  RETURN_ON_ASSERT(root["type"] == "create_snapshot_request");
+  sync_remote = root.value("sync_remote", false);
+  return Status::OK();
+}
+
+void WriteCreateSnapshotReply(const uint64_t snapshot, std::string& msg) {
+  json root;
+  root["type"] = "create_snapshot_reply";
+  root["snapshot"] = snapshot;
+  encode_msg(root, msg);
+}
+
+Status ReadCreateSnapshotReply(const json& root, uint64_t& snapshot) {
+  CHECK_IPC_ERROR(root, "create_snapshot_reply");
+  snapshot = root["snapshot"].get<uint64_t>();
+  return Status::OK();
+}
+
+void WriteReleaseSnapshotRequest(const uint64_t snapshot, std::string& msg) {
+  json root;
+  root["type"] = "release_snapshot_request";
+  root["snapshot"] = snapshot;
+  encode_msg(root, msg);
+}
+
+Status ReadReleaseSnapshotRequest(const json& root, uint64_t& snapshot) {
+  RETURN_ON_ASSERT(root["type"] == "release_snapshot_request");
+  snapshot = root["snapshot"].get<uint64_t>();
+  return Status::OK();
+}
+
+void WriteReleaseSnapshotReply(std::string& msg) {
+  json root;
+  root["type"] = "release_snapshot_reply";
+  encode_msg(root, msg);
+}
+
+Status ReadReleaseSnapshotReply(const json& root) {
+  CHECK_IPC_ERROR(root, "release_snapshot_reply");
+  return Status::OK();
+}
+
+void WriteGossipRequest(const InstanceID from, const InstanceID target,
+                        const json& updates, std::string& msg) {
+  json root;
+  root["type"] = "gossip_request";
+  root["from"] = from;
+  root["target"] = target;
+  root["updates"] = updates;
+
+  encode_msg(root, msg);
+}
+
+Status ReadGossipRequest(const json& root, InstanceID& from,
+                         InstanceID& target, json& updates) {
+  RETURN_ON_ASSERT(root["type"] == "gossip_request");
+  from = root["from"].get<InstanceID>();
+  target = root.value("target", UnspecifiedInstanceID());
+  updates = root.value("updates", json::array());
+  return Status::OK();
+}
+
+void WriteGossipReply(const bool acked, const json& updates,
+                      std::string& msg) {
+  json root;
+  root["type"] = "gossip_reply";
+  root["acked"] = acked;
+  root["updates"] = updates;
+
+  encode_msg(root, msg);
+}
+
+Status ReadGossipReply(const json& root, bool& acked, json& updates) {
+  CHECK_IPC_ERROR(root, "gossip_reply");
+  acked = root.value("acked", false);
+  updates = root.value("updates", json::array());
+  return Status::OK();
+}
+
 void WriteDebugRequest(const json& debug, std::string& msg) {
   json root;
   root["type"] = "debug_command";
@@ -67,6 +67,36 @@ enum class CommandType {
   MakeArenaRequest = 33,
   FinalizeArenaRequest = 34,
   DeepCopyRequest = 35,
+  ReleaseRequest = 36,
+  CreateBuffersRequest = 37,
+  EnableRingRequest = 38,
+  GetRemoteBufferChunksRequest = 39,
+  SubscribeInvalidationRequest = 40,
+  GetObjectsRequest = 41,
+  ExtendBufferRequest = 42,
+  CopyBufferRequest = 43,
+  // the batched stream commands are only available in the binary protocol,
+  // see also "binary_protocols.h".
+  GetNextStreamChunksRequest = 44,
+  PutStreamChunksRequest = 45,
+  PullStreamChunksRequest = 46,
+  SubscribeStreamRequest = 47,
+  StreamCreditRequest = 48,
+  SubscribeObjectsRequest = 49,
+  LocalityInfoRequest = 50,
+  EnableBlobTableRequest = 51,
+  ListObjectsRequest = 52,
+  PutNamesRequest = 53,
+  GetNamesRequest = 54,
+  DropNamesRequest = 55,
+  BatchRequest = 56,
+  PrefetchRequest = 57,
+  FootprintsRequest = 58,
+  CreateBufferFromFileRequest = 59,
+  CreateSnapshotRequest = 60,
+  ReleaseSnapshotRequest = 61,
+  WaitPersistedRequest = 62,
+  GossipRequest = 63,
 };
 
 CommandType ParseCommandType(const std::string& str_type);
@@ -75,16 +105,71 @@ void WriteErrorReply(Status const& status, std::string& msg);
 
 void WriteRegisterRequest(std::string& msg);
 
+/**
+ * The `mapped_fds` are the fds (on the server side) that have already been
+ * received by the client process from the server identified by
+ * `server_token`, the server won't send them again on the new connection.
+ */
+void WriteRegisterRequest(const uint64_t server_token,
+                          const std::vector<int>& mapped_fds,
+                          std::string& msg);
+
+/**
+ * The connections that register with the same `tenant` share the quotas on
+ * the server side, an empty tenant means the connection itself.
+ */
+void WriteRegisterRequest(const uint64_t server_token,
+                          const std::vector<int>& mapped_fds,
+                          const std::string& tenant, std::string& msg);
+
 Status ReadRegisterRequest(const json& msg, std::string& version);
 
+Status ReadRegisterRequest(const json& msg, std::string& version,
+                           uint64_t& server_token,
+                           std::vector<int>& mapped_fds);
+
+Status ReadRegisterRequest(const json& msg, std::string& version,
+                           uint64_t& server_token, std::vector<int>& mapped_fds,
+                           std::string& tenant);
+
 void WriteRegisterReply(const std::string& ipc_socket,
                         const std::string& rpc_endpoint,
                         const InstanceID instance_id, std::string& msg);
 
+void WriteRegisterReply(const std::string& ipc_socket,
+                        const std::string& rpc_endpoint,
+                        const InstanceID instance_id,
+                        const uint64_t server_token, std::string& msg);
+
 Status ReadRegisterReply(const json& msg, std::string& ipc_socket,
                          std::string& rpc_endpoint, InstanceID& instance_id,
                          std::string& version);
 
+Status ReadRegisterReply(const json& msg, std::string& ipc_socket,
+                         std::string& rpc_endpoint, InstanceID& instance_id,
+                         std::string& version, bool& binary_protocol,
+                         bool& ipc_ring);
+
+Status ReadRegisterReply(const json& msg, std::string& ipc_socket,
+                         std::string& rpc_endpoint, InstanceID& instance_id,
+                         std::string& version, bool& binary_protocol,
+                         bool& ipc_ring, uint64_t& server_token);
+
+Status ReadRegisterReply(const json& msg, std::string& ipc_socket,
+                         std::string& rpc_endpoint, InstanceID& instance_id,
+                         std::string& version, bool& binary_protocol,
+                         bool& ipc_ring, uint64_t& server_token,
+                         bool& pipelining);
+
+/**
+ * @brief Pipelined requests carry a "request_id" as the first field, and the
+ * server echoes it at the very beginning of the reply, thus the replies can
+ * be matched without parsing, see also `ClientBase::doRequest`.
+ */
+void TagRequestID(const uint64_t request_id, std::string& msg);
+
+bool ReadRequestID(const std::string& msg, uint64_t& request_id);
+
 void WriteExitRequest(std::string& msg);
 
 void WriteGetDataRequest(const ObjectID id, const bool sync_remote,
@@ -94,8 +179,26 @@ void WriteGetDataRequest(const std::vector<ObjectID>& ids,
                          const bool sync_remote, const bool wait,
                          std::string& msg);
 
+/**
+ * When `lazy` is set, the member objects in the replied metadata are shallow
+ * stubs (except blobs), to be fetched on demand.
+ */
+void WriteGetDataRequest(const std::vector<ObjectID>& ids,
+                         const bool sync_remote, const bool wait,
+                         const bool lazy, std::string& msg);
+
+/**
+ * When `snapshot` is not 0, the metadata is read from the given snapshot (see
+ * also `WriteCreateSnapshotRequest`), `sync_remote` and `wait` are ignored.
+ */
+void WriteGetDataRequest(const std::vector<ObjectID>& ids,
+                         const bool sync_remote, const bool wait,
+                         const bool lazy, const uint64_t snapshot,
+                         std::string& msg);
+
 Status ReadGetDataRequest(const json& root, std::vector<ObjectID>& ids,
-                          bool& sync_remote, bool& wait);
+                          bool& sync_remote, bool& wait, bool& lazy,
+                          uint64_t& snapshot);
 
 void WriteGetDataReply(const json& content, std::string& msg);
 
@@ -112,7 +215,14 @@ Status ReadListDataRequest(const json& root, std::string& pattern, bool& regex,
 
 void WriteCreateDataRequest(const json& content, std::string& msg);
 
-Status ReadCreateDataRequest(const json& root, json& content);
+/**
+ * @brief The object expires after `ttl` seconds, never if `ttl` is not
+ * positive.
+ */
+void WriteCreateDataRequest(const json& content, const int64_t ttl,
+                            std::string& msg);
+
+Status ReadCreateDataRequest(const json& root, json& content, int64_t& ttl);
 
 void WriteCreateDataReply(const ObjectID& id, const Signature& sigature,
                           const InstanceID& instance_id, std::string& msg);
@@ -124,10 +234,36 @@ void WritePersistRequest(const ObjectID id, std::string& msg);
 
 Status ReadPersistRequest(const json& root, ObjectID& id);
 
+/**
+ * When `async` is set, the request is replied once the persisting has been
+ * queued, with a ticket for `WriteWaitPersistedRequest`.
+ */
+void WritePersistRequest(const ObjectID id, const bool async,
+                         std::string& msg);
+
+Status ReadPersistRequest(const json& root, ObjectID& id, bool& async);
+
 void WritePersistReply(std::string& msg);
 
+void WritePersistReply(const uint64_t ticket, std::string& msg);
+
 Status ReadPersistReply(const json& root);
 
+Status ReadPersistReply(const json& root, uint64_t& ticket);
+
+/**
+ * Wait until the asynchronous persisting requests up to the `ticket` (all
+ * of them if 0) of the connection have finished, the reply carries the
+ * first error among them, if any.
+ */
+void WriteWaitPersistedRequest(const uint64_t ticket, std::string& msg);
+
+Status ReadWaitPersistedRequest(const json& root, uint64_t& ticket);
+
+void WriteWaitPersistedReply(std::string& msg);
+
+Status ReadWaitPersistedReply(const json& root);
+
 void WriteIfPersistRequest(const ObjectID id, std::string& msg);
 
 Status ReadIfPersistRequest(const json& root, ObjectID& id);
@@ -174,16 +310,103 @@ void WriteInstanceStatusReply(const json& content, std::string& msg);
 
 Status ReadInstanceStatusReply(const json& root, json& content);
 
+/**
+ * The bytes of the blobs of an object per instance, aggregated from the
+ * metadata on the server side, the "locality" in the reply maps "i<id>"
+ * to the bytes that located at the instance.
+ */
+void WriteLocalityInfoRequest(const ObjectID id, const bool sync_remote,
+                              std::string& msg);
+
+Status ReadLocalityInfoRequest(const json& root, ObjectID& id,
+                               bool& sync_remote);
+
+void WriteLocalityInfoReply(const json& locality, std::string& msg);
+
+Status ReadLocalityInfoReply(const json& root, json& locality);
+
+/**
+ * Stage the local blobs of the objects in the bulk store and pre-fault their
+ * pages, the reply carries the bytes that have been prefetched.
+ */
+void WritePrefetchRequest(const std::vector<ObjectID>& ids, std::string& msg);
+
+Status ReadPrefetchRequest(const json& root, std::vector<ObjectID>& ids);
+
+void WritePrefetchReply(const size_t nbytes, std::string& msg);
+
+Status ReadPrefetchReply(const json& root, size_t& nbytes);
+
+/**
+ * Query the shared memory taken by the given objects, or by the `limit`
+ * largest objects (all if `limit` is 0) when `ids` is empty, the reply
+ * carries the aggregates of every typename as well.
+ */
+void WriteFootprintsRequest(const std::vector<ObjectID>& ids,
+                            const size_t limit, std::string& msg);
+
+Status ReadFootprintsRequest(const json& root, std::vector<ObjectID>& ids,
+                             size_t& limit);
+
+void WriteFootprintsReply(const json& footprints, std::string& msg);
+
+Status ReadFootprintsReply(const json& root, json& footprints);
+
+/**
+ * The paginated version of the "list_data_request", see also
+ * `meta_tree::ListObjects`.
+ */
+void WriteListObjectsRequest(std::string const& pattern, bool const regex,
+                             std::string const& name_prefix,
+                             std::string const& cursor, size_t const limit,
+                             bool const brief, std::string& msg);
+
+Status ReadListObjectsRequest(const json& root, std::string& pattern,
+                              bool& regex, std::string& name_prefix,
+                              std::string& cursor, size_t& limit, bool& brief);
+
+void WriteListObjectsReply(const json& objects, std::string const& next_cursor,
+                           std::string& msg);
+
+Status ReadListObjectsReply(const json& root, std::vector<json>& objects,
+                            std::string& next_cursor);
+
 void WriteCreateBufferRequest(const size_t size, std::string& msg);
 
+void WriteCreateBufferRequest(const size_t size, const int numa_node,
+                              std::string& msg);
+
 Status ReadCreateBufferRequest(const json& root, size_t& size);
 
+Status ReadCreateBufferRequest(const json& root, size_t& size, int& numa_node);
+
+/**
+ * The `device` is the CUDA device to place the blob, -1 means the host memory.
+ */
+void WriteCreateBufferRequest(const size_t size, const int numa_node,
+                              const int device, std::string& msg);
+
+Status ReadCreateBufferRequest(const json& root, size_t& size, int& numa_node,
+                               int& device);
+
 void WriteCreateBufferReply(const ObjectID id,
                             const std::shared_ptr<Payload>& object,
                             std::string& msg);
 
 Status ReadCreateBufferReply(const json& root, ObjectID& id, Payload& object);
 
+void WriteCreateBuffersRequest(const std::vector<size_t>& sizes,
+                               std::string& msg);
+
+Status ReadCreateBuffersRequest(const json& root, std::vector<size_t>& sizes);
+
+void WriteCreateBuffersReply(
+    const std::vector<ObjectID>& ids,
+    const std::vector<std::shared_ptr<Payload>>& objects, std::string& msg);
+
+Status ReadCreateBuffersReply(const json& root, std::vector<ObjectID>& ids,
+                              std::vector<Payload>& objects);
+
 void WriteCreateRemoteBufferRequest(const size_t size, std::string& msg);
 
 Status ReadCreateRemoteBufferRequest(const json& root, size_t& size);
@@ -203,6 +426,21 @@ void WriteGetRemoteBuffersRequest(const std::unordered_set<ObjectID>& ids,
 Status ReadGetRemoteBuffersRequest(const json& root,
                                    std::vector<ObjectID>& ids);
 
+void WriteGetRemoteBufferChunksRequest(const std::vector<ObjectID>& ids,
+                                       const std::vector<size_t>& offsets,
+                                       const std::vector<size_t>& sizes,
+                                       std::string& msg);
+
+Status ReadGetRemoteBufferChunksRequest(const json& root,
+                                        std::vector<ObjectID>& ids,
+                                        std::vector<size_t>& offsets,
+                                        std::vector<size_t>& sizes);
+
+void WriteGetRemoteBufferChunksReply(const size_t total_size,
+                                     std::string& msg);
+
+Status ReadGetRemoteBufferChunksReply(const json& root, size_t& total_size);
+
 void WriteDropBufferRequest(const ObjectID id, std::string& msg);
 
 Status ReadDropBufferRequest(const json& root, ObjectID& id);
@@ -211,11 +449,22 @@ void WriteDropBufferReply(std::string& msg);
 
 Status ReadDropBufferReply(const json& root);
 
+void WriteReleaseRequest(const std::vector<ObjectID>& ids, std::string& msg);
+
+Status ReadReleaseRequest(const json& root, std::vector<ObjectID>& ids);
+
+void WriteReleaseReply(std::string& msg);
+
+Status ReadReleaseReply(const json& root);
+
 void WritePutNameRequest(const ObjectID object_id, const std::string& name,
                          std::string& msg);
 
+void WritePutNameRequest(const ObjectID object_id, const std::string& name,
+                         const int64_t ttl, std::string& msg);
+
 Status ReadPutNameRequest(const json& root, ObjectID& object_id,
-                          std::string& name);
+                          std::string& name, int64_t& ttl);
 
 void WritePutNameReply(std::string& msg);
 
@@ -238,6 +487,67 @@ void WriteDropNameReply(std::string& msg);
 
 Status ReadDropNameReply(const json& root);
 
+/**
+ * The batched version of "put_name_request", "get_name_request" and
+ * "drop_name_request", the names in a request are (un)registered in a single
+ * metadata update. Names that cannot be found are absent in the reply of
+ * "get_names_request".
+ */
+void WritePutNamesRequest(const std::map<std::string, ObjectID>& names,
+                          std::string& msg);
+
+Status ReadPutNamesRequest(const json& root,
+                           std::map<std::string, ObjectID>& names);
+
+void WritePutNamesReply(std::string& msg);
+
+Status ReadPutNamesReply(const json& root);
+
+void WriteGetNamesRequest(const std::vector<std::string>& names,
+                          std::string& msg);
+
+void WriteGetNamesRequest(const std::vector<std::string>& names,
+                          const uint64_t snapshot, std::string& msg);
+
+Status ReadGetNamesRequest(const json& root, std::vector<std::string>& names,
+                           uint64_t& snapshot);
+
+void WriteGetNamesReply(const std::map<std::string, ObjectID>& object_ids,
+                        std::string& msg);
+
+Status ReadGetNamesReply(const json& root,
+                         std::map<std::string, ObjectID>& object_ids);
+
+void WriteDropNamesRequest(const std::vector<std::string>& names,
+                           std::string& msg);
+
+Status ReadDropNamesRequest(const json& root, std::vector<std::string>& names);
+
+void WriteDropNamesReply(std::string& msg);
+
+Status ReadDropNamesReply(const json& root);
+
+/**
+ * The "batch_request" carries a list of ops, each of them is one of
+ *
+ *    {"op": "create_data", "content": <metadata>}
+ *    {"op": "persist", "object_id": <id>}
+ *    {"op": "put_name", "object_id": <id>, "name": <name>}
+ *
+ * where the "object_id" can be replaced with a "ref", the index of an earlier
+ * "create_data" op in the same batch. The reply contains the id, signature
+ * and instance id of each created object, in order.
+ */
+void WriteBatchRequest(const json& ops, std::string& msg);
+
+Status ReadBatchRequest(const json& root, json& ops);
+
+void WriteBatchReply(const json& objects, std::string& msg);
+
+Status ReadBatchReply(const json& root, std::vector<ObjectID>& ids,
+                      std::vector<Signature>& signatures,
+                      std::vector<InstanceID>& instance_ids);
+
 void WriteMigrateObjectRequest(const ObjectID object_id, const bool local,
                                const bool is_stream, std::string const& peer,
                                std::string const& peer_rpc_endpoint,
@@ -255,6 +565,21 @@ void WriteCreateStreamRequest(const ObjectID& object_id, std::string& msg);
 
 Status ReadCreateStreamRequest(const json& root, ObjectID& object_id);
 
+/**
+ * The `retain_chunks` and `retain_bytes` is the budget of chunks that been
+ * kept for replaying after all readers have passed them, 0 means unlimited,
+ * and both 0 means don't retain. The `budget_bytes` is the maximum bytes of
+ * chunks that the stream holds, 0 means unlimited.
+ */
+void WriteCreateStreamRequest(const ObjectID& object_id,
+                              const size_t retain_chunks,
+                              const size_t retain_bytes,
+                              const size_t budget_bytes, std::string& msg);
+
+Status ReadCreateStreamRequest(const json& root, ObjectID& object_id,
+                               size_t& retain_chunks, size_t& retain_bytes,
+                               size_t& budget_bytes);
+
 void WriteCreateStreamReply(std::string& msg);
 
 Status ReadCreateStreamReply(const json& root);
@@ -265,6 +590,16 @@ void WriteOpenStreamRequest(const ObjectID& object_id, const int64_t& mode,
 Status ReadOpenStreamRequest(const json& root, ObjectID& object_id,
                              int64_t& mode);
 
+/**
+ * The reader starts from the chunk at `offset` when it is not negative, see
+ * also `WriteCreateStreamRequest`.
+ */
+void WriteOpenStreamRequest(const ObjectID& object_id, const int64_t& mode,
+                            const int64_t offset, std::string& msg);
+
+Status ReadOpenStreamRequest(const json& root, ObjectID& object_id,
+                             int64_t& mode, int64_t& offset);
+
 void WriteOpenStreamReply(std::string& msg);
 
 Status ReadOpenStreamReply(const json& root);
@@ -337,14 +672,194 @@ void WriteFinalizeArenaRequest(const int fd, std::vector<size_t> const& offsets,
                                std::vector<size_t> const& sizes,
                                std::string& msg);
 
+/**
+ * @brief Finalize the blocks of the arena without releasing it, the unused
+ * ranges are handed back to the server to be recycled.
+ */
+void WriteFinalizeArenaRequest(const int fd, std::vector<size_t> const& offsets,
+                               std::vector<size_t> const& sizes,
+                               std::vector<size_t> const& unused_offsets,
+                               std::vector<size_t> const& unused_sizes,
+                               std::string& msg);
+
 Status ReadFinalizeArenaRequest(const json& root, int& fd,
                                 std::vector<size_t>& offsets,
-                                std::vector<size_t>& sizes);
+                                std::vector<size_t>& sizes, bool& keep_alive,
+                                std::vector<size_t>& unused_offsets,
+                                std::vector<size_t>& unused_sizes);
 
 void WriteFinalizeArenaReply(std::string& msg);
 
 Status ReadFinalizeArenaReply(const json& root);
 
+void WriteEnableRingRequest(const size_t capacity, std::string& msg);
+
+Status ReadEnableRingRequest(const json& root, size_t& capacity);
+
+void WriteEnableRingReply(const int fd, const size_t capacity,
+                          std::string& msg);
+
+Status ReadEnableRingReply(const json& root, int& fd, size_t& capacity);
+
+void WriteEnableBlobTableRequest(std::string& msg);
+
+Status ReadEnableBlobTableRequest(const json& root);
+
+void WriteEnableBlobTableReply(const int fd, const size_t capacity,
+                               std::string& msg);
+
+Status ReadEnableBlobTableReply(const json& root, int& fd, size_t& capacity);
+
+void WriteSubscribeInvalidationRequest(std::string& msg);
+
+Status ReadSubscribeInvalidationRequest(const json& root);
+
+void WriteSubscribeInvalidationReply(std::string& msg);
+
+Status ReadSubscribeInvalidationReply(const json& root);
+
+/**
+ * The notification that is pushed to the subscribed connections when the
+ * metadata of objects has been changed or deleted, or the names have been
+ * changed or dropped.
+ */
+void WriteInvalidationNotification(const std::vector<ObjectID>& ids,
+                                   const std::vector<std::string>& names,
+                                   std::string& msg);
+
+Status ReadInvalidationNotification(const json& root,
+                                    std::vector<ObjectID>& ids,
+                                    std::vector<std::string>& names);
+
+/**
+ * Subscribe the objects that are created (or persisted) in the cluster on a
+ * dedicated connection, the objects are filtered by the (wildcard) typename
+ * pattern, the prefix of names, and the labels (the string-valued keys in
+ * the metadata) on the server side, empty conditions match all.
+ */
+void WriteSubscribeObjectsRequest(
+    const std::string& type_pattern, const std::string& name_prefix,
+    const std::map<std::string, std::string>& labels, std::string& msg);
+
+Status ReadSubscribeObjectsRequest(const json& root, std::string& type_pattern,
+                                   std::string& name_prefix,
+                                   std::map<std::string, std::string>& labels);
+
+void WriteSubscribeObjectsReply(std::string& msg);
+
+Status ReadSubscribeObjectsReply(const json& root);
+
+/**
+ * The notification that is pushed to the connections that subscribe the
+ * objects, every event contains the "id", "typename", "signature",
+ * "instance_id", "transient", and the "name" if the event is caused by
+ * putting a name.
+ */
+void WriteObjectsNotification(const json& events, std::string& msg);
+
+Status ReadObjectsNotification(const json& root, json& events);
+
+/**
+ * Get the metadata of objects and the payloads of their (local) blobs in a
+ * single round trip, the file descriptors that haven't been sent to the
+ * client follow the reply, see also `get_buffers_reply`.
+ */
+void WriteGetObjectsRequest(const std::vector<ObjectID>& ids,
+                            const bool sync_remote, const bool wait,
+                            std::string& msg);
+
+Status ReadGetObjectsRequest(const json& root, std::vector<ObjectID>& ids,
+                             bool& sync_remote, bool& wait);
+
+void WriteGetObjectsReply(const json& content,
+                          const std::vector<std::shared_ptr<Payload>>& objects,
+                          std::string& msg);
+
+Status ReadGetObjectsReply(const json& root,
+                           std::unordered_map<ObjectID, json>& content,
+                           std::vector<Payload>& objects);
+
+/**
+ * Grow the unsealed buffer in place, the buffer keeps its id and address.
+ */
+void WriteExtendBufferRequest(const ObjectID id, const size_t size,
+                              std::string& msg);
+
+Status ReadExtendBufferRequest(const json& root, ObjectID& id, size_t& size);
+
+void WriteExtendBufferReply(const std::shared_ptr<Payload>& object,
+                            std::string& msg);
+
+Status ReadExtendBufferReply(const json& root, Payload& object);
+
+/**
+ * Create a new (unsealed) buffer with the content of the given blob.
+ */
+void WriteCopyBufferRequest(const ObjectID id, std::string& msg);
+
+Status ReadCopyBufferRequest(const json& root, ObjectID& id);
+
+void WriteCopyBufferReply(const ObjectID id,
+                          const std::shared_ptr<Payload>& object,
+                          std::string& msg);
+
+Status ReadCopyBufferReply(const json& root, ObjectID& id, Payload& object);
+
+/**
+ * Create a (sealed) blob that is backed by the given range of the file, a
+ * negative `length` means the rest of the file.
+ */
+void WriteCreateBufferFromFileRequest(const std::string& path,
+                                      const size_t offset,
+                                      const int64_t length, std::string& msg);
+
+Status ReadCreateBufferFromFileRequest(const json& root, std::string& path,
+                                       size_t& offset, int64_t& length);
+
+void WriteCreateBufferFromFileReply(const ObjectID id,
+                                    const std::shared_ptr<Payload>& object,
+                                    std::string& msg);
+
+Status ReadCreateBufferFromFileReply(const json& root, ObjectID& id,
+                                     Payload& object);
+
+/**
+ * Take a snapshot of the metadata, the objects and names read from the
+ * snapshot are consistent with each other, until it is released.
+ */
+void WriteCreateSnapshotRequest(const bool sync_remote, std::string& msg);
+
+Status ReadCreateSnapshotRequest(const json& root, bool& sync_remote);
+
+void WriteCreateSnapshotReply(const uint64_t snapshot, std::string& msg);
+
+Status ReadCreateSnapshotReply(const json& root, uint64_t& snapshot);
+
+void WriteReleaseSnapshotRequest(const uint64_t snapshot, std::string& msg);
+
+Status ReadReleaseSnapshotRequest(const json& root, uint64_t& snapshot);
+
+void WriteReleaseSnapshotReply(std::string& msg);
+
+Status ReadReleaseSnapshotReply(const json& root);
+
+/**
+ * The membership probe between vineyardd instances, see `Membership`. The
+ * `target` is the instance to probe, or the receiver itself when it is
+ * `UnspecifiedInstanceID()`, the `updates` is the membership view of the
+ * sender piggybacked on the probe.
+ */
+void WriteGossipRequest(const InstanceID from, const InstanceID target,
+                        const json& updates, std::string& msg);
+
+Status ReadGossipRequest(const json& root, InstanceID& from,
+                         InstanceID& target, json& updates);
+
+void WriteGossipReply(const bool acked, const json& updates,
+                      std::string& msg);
+
+Status ReadGossipReply(const json& root, bool& acked, json& updates);
+
 void WriteDebugRequest(const json& debug, std::string& msg);
 
 Status ReadDebugRequest(const json& root, json& debug);
@@ -16,6 +16,8 @@ limitations under the License.
 #ifndef SRC_COMMON_UTIL_TYPENAME_H_
 #define SRC_COMMON_UTIL_TYPENAME_H_
 
+#include <cstddef>
+#include <cstdint>
 #include <string>
 
 #if defined(__GNUC__) && defined(__GNUC_MINOR__) && defined(__GNUC_PATCHLEVEL__)
@@ -149,6 +151,48 @@ inline const std::string type_name<uint64_t>() {
   return "uint64";
 }
 
+/**
+ * @brief A compact and stable identifier of the typename, i.e., the 64-bit
+ * FNV-1a hash of `type_name<T>()`, which is stored in the metadata along with
+ * the `typename` and used to resolve the types in the ObjectFactory.
+ */
+using TypeID = uint64_t;
+
+namespace detail {
+
+constexpr TypeID __typeid_fnv1a(const char* s, const size_t n,
+                                const TypeID hash) {
+  return n == 0 ? hash
+                : __typeid_fnv1a(s + 1, n - 1,
+                                 (hash ^ static_cast<uint8_t>(*s)) *
+                                     UINT64_C(0x100000001b3));
+}
+
+}  // namespace detail
+
+constexpr TypeID type_id(const char* type_name, const size_t length) {
+  return detail::__typeid_fnv1a(type_name, length,
+                                UINT64_C(0xcbf29ce484222325));
+}
+
+inline TypeID type_id(const std::string& type_name) {
+  TypeID hash = UINT64_C(0xcbf29ce484222325);
+  for (const char c : type_name) {
+    hash = (hash ^ static_cast<uint8_t>(c)) * UINT64_C(0x100000001b3);
+  }
+  return hash;
+}
+
+/**
+ * @brief The `type_name<T>()` is composed at runtime, the id is computed once
+ * for each type.
+ */
+template <typename T>
+inline TypeID type_id() {
+  static const TypeID id = type_id(type_name<T>());
+  return id;
+}
+
 }  // namespace vineyard
 
 // for backwards compatiblity.
@@ -20,11 +20,85 @@ limitations under the License.
 
 #include "common/util/uuid.h"
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <cstdio>
 #include <cstdlib>
+#include <stdexcept>
 
 namespace vineyard {
 
+namespace {
+
+constexpr uint64_t kInstanceBits = 15;
+constexpr uint64_t kSequenceBits = 48;
+constexpr uint64_t kSequenceMask = (1UL << kSequenceBits) - 1;
+// the prefix used before the instance id is known
+constexpr uint64_t kUnspecifiedPrefix = (1UL << kInstanceBits) - 1;
+// sequence numbers reserved by a thread at a time
+constexpr uint64_t kBlockSize = 256;
+// 2021-01-01T00:00:00Z, in microseconds
+constexpr uint64_t kEpochMicros = 1609459200000000UL;
+// the clock ticks every 8 microseconds, thus the 48-bit sequence lasts for
+// about 71 years after the epoch.
+constexpr uint64_t kTickMicros = 8;
+
+std::atomic<uint64_t> instance_prefix{kUnspecifiedPrefix << kSequenceBits};
+std::atomic<uint64_t> next_sequence{0};
+
+struct sequence_block_t {
+  uint64_t next = 0;
+  uint64_t end = 0;
+};
+
+inline uint64_t now_ticks() {
+  auto now = std::chrono::system_clock::now().time_since_epoch();
+  return (static_cast<uint64_t>(
+              std::chrono::duration_cast<std::chrono::microseconds>(now)
+                  .count()) -
+          kEpochMicros) /
+         kTickMicros;
+}
+
+uint64_t next_id() {
+  thread_local sequence_block_t block;
+  if (block.next == block.end) {
+    const uint64_t now = now_ticks();
+    uint64_t current = next_sequence.load(std::memory_order_relaxed);
+    uint64_t start = 0;
+    do {
+      start = std::max(current, now);
+    } while (!next_sequence.compare_exchange_weak(
+        current, start + kBlockSize, std::memory_order_relaxed));
+    if (start + kBlockSize > kSequenceMask + 1) {
+      // never wraps around, which would collide with the existing ids
+      throw std::overflow_error(
+          "The sequence of object ids has been exhausted");
+    }
+    block.next = start;
+    block.end = start + kBlockSize;
+  }
+  return instance_prefix.load(std::memory_order_relaxed) | block.next++;
+}
+
+}  // namespace
+
+bool SetIDGeneratorInstanceID(const InstanceID instance_id) {
+  if (instance_id != UnspecifiedInstanceID() &&
+      instance_id >= kUnspecifiedPrefix) {
+    return false;
+  }
+  uint64_t prefix = instance_id == UnspecifiedInstanceID() ? kUnspecifiedPrefix
+                                                           : instance_id;
+  instance_prefix.store(prefix << kSequenceBits);
+  return true;
+}
+
+ObjectID GenerateObjectID() { return next_id(); }
+
+Signature GenerateSignature() { return next_id(); }
+
 const std::string ObjectIDToString(const ObjectID id) {
   thread_local char buffer[18] = {'\0'};
   std::snprintf(buffer, sizeof(buffer), "o%016" PRIx64, id);
@@ -45,7 +45,7 @@ using Signature = uint64_t;
 using InstanceID = uint64_t;
 
 // blob id: 1 + memory address (in vineyardd)
-// non-blob id: 0 + random (rdstc)
+// non-blob id: 0 + instance (15 bits) + sequence (48 bits)
 
 inline void* GetBlobAddr(ObjectID const id) {
   return (id & 0x8000000000000000UL)
@@ -63,13 +63,36 @@ inline ObjectID GenerateBlobID(const uintptr_t ptr) {
 
 constexpr inline ObjectID EmptyBlobID() { return 0x8000000000000000UL; }
 
-inline ObjectID GenerateObjectID() {
-  return 0x7FFFFFFFFFFFFFFFUL & static_cast<uint64_t>(__rdtsc());
-}
+/**
+ * @brief Set the instance id that prefixes the generated object ids and
+ * signatures, ids generated by different instances never collide.
+ *
+ * Before that (e.g., on the client side) a reserved prefix is used.
+ *
+ * @return false if the instance id doesn't fit in the prefix, i.e., not
+ * less than 32767, and the prefix is left unchanged.
+ */
+bool SetIDGeneratorInstanceID(const InstanceID instance_id);
 
-inline ObjectID GenerateSignature() {
-  return 0x7FFFFFFFFFFFFFFFUL & static_cast<uint64_t>(__rdtsc());
-}
+/**
+ * @brief Generate a non-blob object id.
+ *
+ * The sequence part is a hybrid logical clock in ticks of 8 microseconds:
+ * each thread reserves a block of sequence numbers from a process-wide
+ * counter that never falls behind the wall clock, thus ids are unique inside
+ * the process without per-id contention, and stay unique across restarts as
+ * long as the average generation rate doesn't exceed one id per tick.
+ *
+ * Throws std::overflow_error once the sequence is exhausted (about 71 years
+ * after 2021), rather than wrapping around.
+ */
+ObjectID GenerateObjectID();
+
+/**
+ * @brief Generate a signature, signatures share the same generator with the
+ * object ids.
+ */
+Signature GenerateSignature();
 
 inline bool IsBlob(ObjectID id) { return id & 0x8000000000000000UL; }
 
@@ -28,8 +28,7 @@ namespace vineyard {
 IPCServer::IPCServer(vs_ptr_t vs_ptr)
     : SocketServer(vs_ptr),
       ipc_spec_(vs_ptr_->GetSpec()["ipc_spec"]),
-      acceptor_(vs_ptr_->GetContext(), getEndpoint(vs_ptr_->GetContext())),
-      socket_(vs_ptr_->GetContext()) {}
+      acceptor_(vs_ptr_->GetContext(), getEndpoint(vs_ptr_->GetContext())) {}
 
 IPCServer::~IPCServer() {
   if (acceptor_.is_open()) {
@@ -98,16 +97,14 @@ void IPCServer::doAccept() {
   if (!acceptor_.is_open()) {
     return;
   }
-  acceptor_.async_accept(socket_, [this](boost::system::error_code ec) {
+  // every in-flight accept owns the socket being accepted.
+  auto socket = std::make_shared<asio::local::stream_protocol::socket>(
+      vs_ptr_->GetContext());
+  acceptor_.async_accept(*socket, [this, socket](boost::system::error_code ec) {
     if (!ec) {
-      std::shared_ptr<SocketConnection> conn =
-          std::make_shared<SocketConnection>(std::move(this->socket_), vs_ptr_,
-                                             this, next_conn_id_);
-      conn->Start();
-      std::lock_guard<std::recursive_mutex> scope_lock(
-          this->connections_mutex_);
-      connections_.emplace(next_conn_id_, conn);
-      ++next_conn_id_;
+      int conn_id = nextConnectionID();
+      startConnection(conn_id, std::make_shared<SocketConnection>(
+                                   std::move(*socket), vs_ptr_, this, conn_id));
     }
     // don't continue when the iocontext being cancelled.
     if (!stopped_.load()) {
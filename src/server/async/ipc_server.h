@@ -59,7 +59,6 @@ class IPCServer : public SocketServer {
 
   const json ipc_spec_;
   asio::local::stream_protocol::acceptor acceptor_;
-  asio::local::stream_protocol::socket socket_;
 };
 
 }  // namespace vineyard
@@ -0,0 +1,108 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+
+#include "server/async/metrics_server.h"
+
+#include <istream>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "common/util/logging.h"
+#include "server/util/metrics.h"
+
+namespace vineyard {
+
+MetricsServer::MetricsServer(vs_ptr_t vs_ptr, const uint32_t port)
+    : vs_ptr_(vs_ptr),
+      port_(port),
+      acceptor_(vs_ptr_->GetContext()),
+      socket_(vs_ptr_->GetContext()) {
+  auto endpoint = asio::ip::tcp::endpoint(asio::ip::tcp::v4(), port_);
+  acceptor_.open(endpoint.protocol());
+  acceptor_.set_option(asio::ip::tcp::acceptor::reuse_address(true));
+  acceptor_.bind(endpoint);
+  acceptor_.listen();
+}
+
+MetricsServer::~MetricsServer() { Stop(); }
+
+void MetricsServer::Start() {
+  doAccept();
+  LOG(INFO) << "Vineyard will serve the metrics on 0.0.0.0:" << port_
+            << "/metrics";
+}
+
+void MetricsServer::Stop() {
+  if (stopped_.exchange(true)) {
+    return;
+  }
+  boost::system::error_code ec;
+  acceptor_.close(ec);
+}
+
+void MetricsServer::doAccept() {
+  if (!acceptor_.is_open()) {
+    return;
+  }
+  acceptor_.async_accept(socket_, [this](boost::system::error_code ec) {
+    if (!ec) {
+      doServe(std::make_shared<asio::ip::tcp::socket>(std::move(socket_)));
+    }
+    if (!stopped_.load()) {
+      doAccept();
+    }
+  });
+}
+
+void MetricsServer::doServe(std::shared_ptr<asio::ip::tcp::socket> socket) {
+  auto request = std::make_shared<asio::streambuf>();
+  asio::async_read_until(
+      *socket, *request, "\r\n\r\n",
+      [socket, request](boost::system::error_code ec, std::size_t) {
+        if (ec) {
+          return;
+        }
+        std::string method, path;
+        std::istream is(request.get());
+        is >> method >> path;
+        auto response = std::make_shared<std::string>();
+        if (method == "GET" && (path == "/metrics" || path == "/")) {
+          std::string body = metrics::Registry::Default().Render();
+          *response = "HTTP/1.1 200 OK\r\n"
+                      "Content-Type: text/plain; version=0.0.4\r\n"
+                      "Content-Length: " +
+                      std::to_string(body.size()) +
+                      "\r\n"
+                      "Connection: close\r\n\r\n" +
+                      body;
+        } else {
+          *response =
+              "HTTP/1.1 404 Not Found\r\n"
+              "Content-Length: 0\r\n"
+              "Connection: close\r\n\r\n";
+        }
+        asio::async_write(
+            *socket, asio::buffer(*response),
+            [socket, response](boost::system::error_code, std::size_t) {
+              boost::system::error_code ec;
+              socket->shutdown(asio::ip::tcp::socket::shutdown_both, ec);
+              socket->close(ec);
+            });
+      });
+}
+
+}  // namespace vineyard
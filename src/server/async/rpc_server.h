@@ -53,7 +53,6 @@ class RPCServer : public SocketServer {
 
   const json rpc_spec_;
   asio::ip::tcp::acceptor acceptor_;
-  asio::ip::tcp::socket socket_;
 };
 
 }  // namespace vineyard
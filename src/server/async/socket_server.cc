@@ -15,20 +15,116 @@ limitations under the License.
 
 #include "server/async/socket_server.h"
 
+#include <fnmatch.h>
+
+#include <algorithm>
 #include <limits>
 #include <memory>
+#include <set>
 #include <string>
+#include <thread>
 #include <utility>
 #include <vector>
 
 #include "common/memory/fling.h"
+#include "common/memory/memcpy.h"
+#include "common/memory/ring_buffer.h"
+#include "common/util/binary_protocols.h"
 #include "common/util/callback.h"
 #include "common/util/functions.h"
 #include "common/util/json.h"
+#include "server/memory/allocator.h"
+#include "server/memory/malloc.h"
+#include "server/util/credentials.h"
 #include "server/util/metrics.h"
+#include "server/util/numa.h"
+#include "server/util/profiler.h"
 
 namespace vineyard {
 
+namespace {
+
+// collects the blobs (in the metadata tree) that live on the given instance.
+void collectLocalBlobs(const json& tree, const InstanceID instance_id,
+                       std::set<ObjectID>& blob_ids) {
+  if (!tree.is_object() || !tree.contains("id")) {
+    return;
+  }
+  ObjectID id = VYObjectIDFromString(tree["id"].get_ref<std::string const&>());
+  if (IsBlob(id)) {
+    if (tree.value("instance_id", UnspecifiedInstanceID()) == instance_id) {
+      blob_ids.emplace(id);
+    }
+    return;
+  }
+  for (auto const& item : tree) {
+    collectLocalBlobs(item, instance_id, blob_ids);
+  }
+}
+
+// the time of handling requests, by command types (looked up without lock).
+metrics::Histogram& requestDuration(const CommandType cmd, const char* name) {
+  static constexpr int kCommands = 64;
+  static std::atomic<metrics::Histogram*> histograms[kCommands] = {};
+  int index = static_cast<int>(cmd) + 1;  // starts from `DebugCommand`
+  if (index < 0 || index >= kCommands) {
+    index = static_cast<int>(CommandType::NullCommand) + 1;
+  }
+  metrics::Histogram* histogram =
+      histograms[index].load(std::memory_order_acquire);
+  if (histogram == nullptr) {
+    histogram = &metrics::Registry::Default().GetHistogram(
+        "vineyard_request_duration_nanoseconds",
+        "The time of handling requests in vineyardd, in nanoseconds",
+        std::string("command=\"") + name + "\"");
+    histograms[index].store(histogram, std::memory_order_release);
+  }
+  return *histogram;
+}
+
+// the commands that are only available in the binary protocol don't have
+// names in "protocols.cc".
+const char* binaryCommandName(const CommandType cmd) {
+  switch (cmd) {
+  case CommandType::GetBuffersRequest:
+    return "get_buffers_request";
+  case CommandType::CreateBufferRequest:
+    return "create_buffer_request";
+  case CommandType::GetNextStreamChunkRequest:
+    return "get_next_stream_chunk_request";
+  case CommandType::PullNextStreamChunkRequest:
+    return "pull_next_stream_chunk_request";
+  case CommandType::GetNextStreamChunksRequest:
+    return "get_next_stream_chunks_request";
+  case CommandType::PutStreamChunksRequest:
+    return "put_stream_chunks_request";
+  case CommandType::PullStreamChunksRequest:
+    return "pull_stream_chunks_request";
+  case CommandType::SubscribeStreamRequest:
+    return "subscribe_stream_request";
+  case CommandType::StreamCreditRequest:
+    return "stream_credit_request";
+  default:
+    return "unknown";
+  }
+}
+
+metrics::Counter& receivedBytes() {
+  static metrics::Counter& counter = metrics::Registry::Default().GetCounter(
+      "vineyard_received_bytes_total",
+      "The size of requests received by vineyardd, in bytes");
+  return counter;
+}
+
+metrics::Counter& sentBytes() {
+  static metrics::Counter& counter = metrics::Registry::Default().GetCounter(
+      "vineyard_sent_bytes_total",
+      "The size of replies sent by vineyardd, in bytes");
+  return counter;
+}
+
+}  // namespace
+
 SocketConnection::SocketConnection(stream_protocol::socket socket,
                                    vs_ptr_t server_ptr,
                                    SocketServer* socket_server_ptr, int conn_id)
@@ -50,10 +146,44 @@ bool SocketConnection::Stop() {
     return false;
   }
 
-  // do cleanup: clean up streams associated with this client
-  for (auto stream_id : associated_streams_) {
-    VINEYARD_SUPPRESS(server_ptr_->GetStreamStore()->Drop(stream_id));
+  // wake up the ring loop first, it exits as the connection is not running,
+  // and the request in process (if any) fails to write the reply.
+  auto ring = std::atomic_load(&ring_);
+  if (ring) {
+    ring->Close();
+  }
+
+  {
+    // the requests may be being processed on the ring thread
+    std::lock_guard<std::recursive_mutex> lock(state_mutex_);
+
+    // do cleanup: clean up streams associated with this client
+    for (auto stream_id : associated_streams_) {
+      VINEYARD_SUPPRESS(
+          server_ptr_->GetStreamStore()->Drop(stream_id, conn_id_));
+    }
+
+    // do cleanup: release the blobs pinned by this client
+    for (auto blob_id : pinned_blobs_) {
+      VINEYARD_SUPPRESS(server_ptr_->GetBulkStore()->Unpin(blob_id));
+    }
+    pinned_blobs_.clear();
+  }
+
+  // do cleanup: release the metadata snapshots taken by this client
+  {
+    std::lock_guard<std::mutex> lock(snapshots_mutex_);
+    for (auto const snapshot : snapshots_) {
+      VINEYARD_SUPPRESS(server_ptr_->ReleaseSnapshot(snapshot));
+    }
+    snapshots_.clear();
+  }
+
+  // wake up the ring loop that waits for the pipelined reply
+  {
+    std::lock_guard<std::mutex> lock(pipeline_mutex_);
   }
+  pipeline_cv_.notify_all();
 
   // On Mac the state of socket may be "not connected" after the client has
   // already closed the socket, hence there will be an exception.
@@ -70,6 +200,7 @@ void SocketConnection::doReadHeader() {
   asio::async_read(socket_, asio::buffer(&read_msg_header_, sizeof(size_t)),
                    [this, self](boost::system::error_code ec, std::size_t) {
                      if (!ec && running_.load()) {
+                       received_ = trace::steady_clock_t::now();
                        doReadBody();
                      } else {
                        doStop();
@@ -90,21 +221,97 @@ void SocketConnection::doReadBody() {
   read_msg_body_.resize(read_msg_header_ + 1);
   read_msg_body_[read_msg_header_] = '\0';
   auto self(shared_from_this());
-  asio::async_read(socket_, asio::buffer(&read_msg_body_[0], read_msg_header_),
-                   [this, self](boost::system::error_code ec, std::size_t) {
-                     if ((!ec || ec == asio::error::eof) && running_.load()) {
-                       bool exit = processMessage(read_msg_body_);
-                       if (exit || ec == asio::error::eof) {
-                         doStop();
-                         return;
-                       }
-                     } else {
-                       doStop();
-                       return;
-                     }
-                     // start next-round read
-                     doReadHeader();
-                   });
+  asio::async_read(
+      socket_, asio::buffer(&read_msg_body_[0], read_msg_header_),
+      [this, self](boost::system::error_code ec, std::size_t) {
+        if ((ec && ec != asio::error::eof) || !running_.load()) {
+          doStop();
+          return;
+        }
+        const bool eof = ec == asio::error::eof;
+        auto delay = admitRequest();
+        if (delay.count() > 0) {
+          // throttles the tenant without blocking the IO thread
+          auto timer = std::make_shared<asio::steady_timer>(
+              server_ptr_->GetContext(), delay);
+          timer->async_wait(
+              [this, self, timer, eof](boost::system::error_code ec) {
+                if (!ec && running_.load()) {
+                  doProcessBody(eof);
+                } else {
+                  doStop();
+                }
+              });
+          return;
+        }
+        doProcessBody(eof);
+      });
+}
+
+void SocketConnection::doProcessBody(const bool eof) {
+  bool exit = false;
+  {
+    std::lock_guard<std::recursive_mutex> lock(state_mutex_);
+    exit = processMessage(read_msg_body_);
+  }
+  if (exit || eof) {
+    doStop();
+    return;
+  }
+  // start next-round read, unless waiting for the reply of a pipelined
+  // request.
+  if (!holdPipeline()) {
+    doReadHeader();
+  }
+}
+
+std::chrono::nanoseconds SocketConnection::admitRequest() {
+  if (tenant_ == nullptr) {
+    auto quota_manager = server_ptr_->GetQuotaManager();
+    if (quota_manager == nullptr || !quota_manager->Enabled()) {
+      return std::chrono::nanoseconds(0);
+    }
+    // the connection hasn't registered with a tenant
+    tenant_ = quota_manager->Get("");
+  }
+  return tenant_->Admit();
+}
+
+bool SocketConnection::holdPipeline() {
+  std::lock_guard<std::mutex> lock(pipeline_mutex_);
+  if (pipeline_request_id_ != -1 && !pipeline_replied_) {
+    pipeline_held_ = true;
+    return true;
+  }
+  pipeline_request_id_ = -1;
+  return false;
+}
+
+void SocketConnection::waitPipeline() {
+  std::unique_lock<std::mutex> lock(pipeline_mutex_);
+  pipeline_cv_.wait(lock, [this]() {
+    return pipeline_request_id_ == -1 || pipeline_replied_ ||
+           !running_.load();
+  });
+  pipeline_request_id_ = -1;
+}
+
+bool SocketConnection::tagReply(const std::string& buf, std::string& tagged,
+                                bool& resume) {
+  std::lock_guard<std::mutex> lock(pipeline_mutex_);
+  if (pipeline_request_id_ == -1 || pipeline_replied_) {
+    return false;
+  }
+  tagged = buf;
+  TagRequestID(static_cast<uint64_t>(pipeline_request_id_), tagged);
+  pipeline_replied_ = true;
+  resume = pipeline_held_;
+  if (pipeline_held_) {
+    pipeline_held_ = false;
+    pipeline_request_id_ = -1;
+  }
+  pipeline_cv_.notify_all();
+  return true;
 }
 
 #ifndef __REPORT_JSON_ERROR
@@ -166,14 +373,35 @@ void SocketConnection::doReadBody() {
 #endif  // RESPONSE_ON_ERROR
 
 bool SocketConnection::processMessage(const std::string& message_in) {
+  auto self(shared_from_this());
+  receivedBytes().Add(message_in.size());
+  if (IsBinaryMessage(message_in)) {
+    return processBinaryMessage(message_in);
+  }
+
   json root;
   std::istringstream is(message_in);
 
   // DON'T let vineyardd crash when the client is malicious.
   TRY_READ_FROM_JSON(root = json::parse(message_in), message_in);
 
-  std::string const& type = root["type"].get_ref<std::string const&>();
+  auto request_id = root.find("request_id");
+  if (request_id != root.end()) {
+    RESPONSE_ON_ERROR(request_id->is_number_integer()
+                          ? Status::OK()
+                          : Status::Invalid("The request_id must be an "
+                                            "integer: " +
+                                            request_id->dump()));
+    std::lock_guard<std::mutex> lock(pipeline_mutex_);
+    pipeline_request_id_ = request_id->get<int64_t>();
+    pipeline_replied_ = false;
+  }
+
+  std::string type;
+  TRY_READ_FROM_JSON(type = root["type"].get<std::string>(), message_in);
   CommandType cmd = ParseCommandType(type);
+  metrics::ScopedTimer timer(requestDuration(cmd, type.c_str()));
+  trace::DispatchScope dispatch(startTrace(type.c_str()));
   switch (cmd) {
   case CommandType::RegisterRequest: {
     return doRegister(root);
@@ -184,20 +412,32 @@ bool SocketConnection::processMessage(const std::string& message_in) {
   case CommandType::GetRemoteBuffersRequest: {
     return doGetRemoteBuffers(root);
   }
+  case CommandType::GetRemoteBufferChunksRequest: {
+    return doGetRemoteBufferChunks(root);
+  }
   case CommandType::CreateBufferRequest: {
     return doCreateBuffer(root);
   }
+  case CommandType::CreateBuffersRequest: {
+    return doCreateBuffers(root);
+  }
   case CommandType::CreateRemoteBufferRequest: {
     return doCreateRemoteBuffer(root);
   }
   case CommandType::DropBufferRequest: {
     return doDropBuffer(root);
   }
+  case CommandType::ReleaseRequest: {
+    return doRelease(root);
+  }
   case CommandType::GetDataRequest: {
     return doGetData(root);
   }
   case CommandType::ListDataRequest: {
-    return doListData(root);
+    return doBulk(root, &SocketConnection::doListData);
+  }
+  case CommandType::ListObjectsRequest: {
+    return doBulk(root, &SocketConnection::doListObjects);
   }
   case CommandType::CreateDataRequest: {
     return doCreateData(root);
@@ -205,6 +445,9 @@ bool SocketConnection::processMessage(const std::string& message_in) {
   case CommandType::PersistRequest: {
     return doPersist(root);
   }
+  case CommandType::WaitPersistedRequest: {
+    return doWaitPersisted(root);
+  }
   case CommandType::IfPersistRequest: {
     return doIfPersist(root);
   }
@@ -215,9 +458,12 @@ bool SocketConnection::processMessage(const std::string& message_in) {
     return doShallowCopy(root);
   }
   case CommandType::DeepCopyRequest: {
-    return doDeepCopy(root);
+    return doBulk(root, &SocketConnection::doDeepCopy);
   }
   case CommandType::DelDataRequest: {
+    if (root.value("deep", false)) {
+      return doBulk(root, &SocketConnection::doDelData);
+    }
     return doDelData(root);
   }
   case CommandType::CreateStreamRequest: {
@@ -244,6 +490,27 @@ bool SocketConnection::processMessage(const std::string& message_in) {
   case CommandType::DropNameRequest: {
     return doDropName(root);
   }
+  case CommandType::PutNamesRequest: {
+    return doPutNames(root);
+  }
+  case CommandType::GetNamesRequest: {
+    return doGetNames(root);
+  }
+  case CommandType::CreateSnapshotRequest: {
+    return doCreateSnapshot(root);
+  }
+  case CommandType::ReleaseSnapshotRequest: {
+    return doReleaseSnapshot(root);
+  }
+  case CommandType::GossipRequest: {
+    return doGossip(root);
+  }
+  case CommandType::DropNamesRequest: {
+    return doDropNames(root);
+  }
+  case CommandType::BatchRequest: {
+    return doBatch(root);
+  }
   case CommandType::MigrateObjectRequest: {
     return doMigrateObject(root);
   }
@@ -253,12 +520,45 @@ bool SocketConnection::processMessage(const std::string& message_in) {
   case CommandType::InstanceStatusRequest: {
     return doInstanceStatus(root);
   }
+  case CommandType::LocalityInfoRequest: {
+    return doLocalityInfo(root);
+  }
+  case CommandType::PrefetchRequest: {
+    return doPrefetch(root);
+  }
+  case CommandType::FootprintsRequest: {
+    return doFootprints(root);
+  }
   case CommandType::MakeArenaRequest: {
     return doMakeArena(root);
   }
   case CommandType::FinalizeArenaRequest: {
     return doFinalizeArena(root);
   }
+  case CommandType::EnableRingRequest: {
+    return doEnableRing(root);
+  }
+  case CommandType::EnableBlobTableRequest: {
+    return doEnableBlobTable(root);
+  }
+  case CommandType::SubscribeInvalidationRequest: {
+    return doSubscribeInvalidation(root);
+  }
+  case CommandType::SubscribeObjectsRequest: {
+    return doSubscribeObjects(root);
+  }
+  case CommandType::GetObjectsRequest: {
+    return doGetObjects(root);
+  }
+  case CommandType::ExtendBufferRequest: {
+    return doExtendBuffer(root);
+  }
+  case CommandType::CopyBufferRequest: {
+    return doCopyBuffer(root);
+  }
+  case CommandType::CreateBufferFromFileRequest: {
+    return doCreateBufferFromFile(root);
+  }
   case CommandType::DebugCommand: {
     return doDebug(root);
   }
@@ -272,12 +572,109 @@ bool SocketConnection::processMessage(const std::string& message_in) {
   }
 }
 
+bool SocketConnection::processBinaryMessage(const std::string& message_in) {
+  auto self(shared_from_this());
+  CommandType cmd;
+  RESPONSE_ON_ERROR(ReadBinaryMessageType(message_in, cmd));
+  metrics::ScopedTimer timer(requestDuration(cmd, binaryCommandName(cmd)));
+  trace::DispatchScope dispatch(startTrace(binaryCommandName(cmd)));
+  switch (cmd) {
+  case CommandType::GetBuffersRequest: {
+    std::vector<ObjectID> ids;
+    RESPONSE_ON_ERROR(ReadGetBuffersRequestBinary(message_in, ids));
+    return doGetBuffers(ids, true);
+  }
+  case CommandType::CreateBufferRequest: {
+    size_t size;
+    int numa_node = -1;
+    RESPONSE_ON_ERROR(
+        ReadCreateBufferRequestBinary(message_in, size, numa_node));
+    return doCreateBuffer(size, numa_node, true);
+  }
+  case CommandType::GetNextStreamChunkRequest: {
+    ObjectID stream_id;
+    size_t size;
+    RESPONSE_ON_ERROR(
+        ReadGetNextStreamChunkRequestBinary(message_in, stream_id, size));
+    return doGetNextStreamChunk(stream_id, size, true);
+  }
+  case CommandType::PullNextStreamChunkRequest: {
+    ObjectID stream_id;
+    RESPONSE_ON_ERROR(
+        ReadPullNextStreamChunkRequestBinary(message_in, stream_id));
+    return doPullNextStreamChunk(stream_id, true);
+  }
+  case CommandType::GetNextStreamChunksRequest: {
+    ObjectID stream_id;
+    std::vector<size_t> sizes;
+    RESPONSE_ON_ERROR(
+        ReadGetNextStreamChunksRequestBinary(message_in, stream_id, sizes));
+    return doGetNextStreamChunks(stream_id, sizes);
+  }
+  case CommandType::PutStreamChunksRequest: {
+    ObjectID stream_id;
+    std::vector<std::pair<size_t, size_t>> payloads;
+    RESPONSE_ON_ERROR(
+        ReadPutStreamChunksRequestBinary(message_in, stream_id, payloads));
+    // the writer may be pending, thus keep the inlined payloads alive
+    return doPutStreamChunks(stream_id,
+                             std::make_shared<std::string>(message_in),
+                             payloads);
+  }
+  case CommandType::PullStreamChunksRequest: {
+    ObjectID stream_id;
+    size_t limit;
+    RESPONSE_ON_ERROR(
+        ReadPullStreamChunksRequestBinary(message_in, stream_id, limit));
+    return doPullStreamChunks(stream_id, limit);
+  }
+  case CommandType::SubscribeStreamRequest: {
+    ObjectID stream_id;
+    size_t credits;
+    int64_t mode;
+    RESPONSE_ON_ERROR(ReadSubscribeStreamRequestBinary(message_in, stream_id,
+                                                        credits, mode));
+    return doSubscribeStream(stream_id, credits, mode);
+  }
+  case CommandType::StreamCreditRequest: {
+    ObjectID stream_id;
+    size_t credits;
+    RESPONSE_ON_ERROR(
+        ReadStreamCreditRequestBinary(message_in, stream_id, credits));
+    return doStreamCredit(stream_id, credits);
+  }
+  default: {
+    LOG(ERROR) << "Got unexpected binary command: " << static_cast<int>(cmd);
+    std::string message_out;
+    WriteErrorReply(Status::Invalid("Unsupported binary command: " +
+                                    std::to_string(static_cast<int>(cmd))),
+                    message_out);
+    doWrite(message_out);
+    return false;
+  }
+  }
+}
+
 bool SocketConnection::doRegister(const json& root) {
   auto self(shared_from_this());
   std::string client_version, message_out;
-  TRY_READ_REQUEST(ReadRegisterRequest, root, client_version);
+  uint64_t server_token = 0;
+  std::vector<int> mapped_fds;
+  std::string tenant;
+  TRY_READ_REQUEST(ReadRegisterRequest, root, client_version, server_token,
+                   mapped_fds, tenant);
+  auto quota_manager = server_ptr_->GetQuotaManager();
+  if (quota_manager && quota_manager->Enabled()) {
+    tenant_ = quota_manager->Get(tenant);
+  }
+  // the client process has already received these fds from this server on
+  // other connections.
+  if (server_token == server_ptr_->server_token()) {
+    used_fds_.insert(mapped_fds.begin(), mapped_fds.end());
+  }
   WriteRegisterReply(server_ptr_->IPCSocket(), server_ptr_->RPCEndpoint(),
-                     server_ptr_->instance_id(), message_out);
+                     server_ptr_->instance_id(), server_ptr_->server_token(),
+                     message_out);
   doWrite(message_out);
   return false;
 }
@@ -285,12 +682,23 @@ bool SocketConnection::doRegister(const json& root) {
 bool SocketConnection::doGetBuffers(const json& root) {
   auto self(shared_from_this());
   std::vector<ObjectID> ids;
+  TRY_READ_REQUEST(ReadGetBuffersRequest, root, ids);
+  return doGetBuffers(ids, false);
+}
+
+bool SocketConnection::doGetBuffers(std::vector<ObjectID> const& ids,
+                                    const bool binary) {
+  auto self(shared_from_this());
   std::vector<std::shared_ptr<Payload>> objects;
   std::string message_out;
 
-  TRY_READ_REQUEST(ReadGetBuffersRequest, root, ids);
-  RESPONSE_ON_ERROR(server_ptr_->GetBulkStore()->Get(ids, objects));
-  WriteGetBuffersReply(objects, message_out);
+  RESPONSE_ON_ERROR(
+      server_ptr_->GetBulkStore()->Get(ids, objects, pinned_blobs_));
+  if (binary) {
+    WriteGetBuffersReplyBinary(objects, message_out);
+  } else {
+    WriteGetBuffersReply(objects, message_out);
+  }
 
   /* NOTE: Here we send the file descriptor after the objects.
    *       We are using sendmsg to send the file descriptor
@@ -304,40 +712,62 @@ bool SocketConnection::doGetBuffers(const json& root) {
    *       explicit file descritors.
    */
   this->doWrite(message_out, [self, objects](const Status& status) {
-    for (auto object : objects) {
-      int store_fd = object->store_fd;
-      int data_size = object->data_size;
-      if (data_size > 0 &&
-          self->used_fds_.find(store_fd) == self->used_fds_.end()) {
-        self->used_fds_.emplace(store_fd);
-        send_fd(self->nativeHandle(), store_fd);
-      }
-    }
+    self->sendFds(objects);
     return Status::OK();
   });
   return false;
 }
 
+void SocketConnection::sendFds(
+    std::vector<std::shared_ptr<Payload>> const& objects) {
+  // all new fds are passed in as few messages as possible
+  std::vector<int> fds;
+  for (auto const& object : objects) {
+    int store_fd = object->store_fd;
+    int data_size = object->data_size;
+    // device blobs are shared by the IPC handles in the payloads
+    if (data_size > 0 && store_fd != -1 &&
+        used_fds_.find(store_fd) == used_fds_.end()) {
+      used_fds_.emplace(store_fd);
+      fds.emplace_back(store_fd);
+    }
+  }
+  if (fds.size() == 1) {
+    send_fd(nativeHandle(), fds[0]);
+  } else if (!fds.empty()) {
+    send_fds(nativeHandle(), fds.data(), fds.size());
+  }
+}
+
 void SocketConnection::sendBufferHelper(
-    std::vector<std::shared_ptr<Payload>> const objects, size_t index,
-    boost::system::error_code const ec, callback_t<> callback_after_finish) {
-  auto self(shared_from_this());
-  if (!ec && index < objects.size()) {
-    async_write(
-        socket_,
-        boost::asio::buffer(objects[index]->pointer, objects[index]->data_size),
-        [this, self, callback_after_finish, objects, index](
-            boost::system::error_code ec, std::size_t) {
-          sendBufferHelper(objects, index + 1, ec, callback_after_finish);
-        });
-  } else {
-    if (ec) {
-      VINEYARD_DISCARD(callback_after_finish(Status::IOError(
-          "Failed to write buffer to client: " + ec.message())));
-    } else {
-      VINEYARD_DISCARD(callback_after_finish(Status::OK()));
+    std::vector<std::shared_ptr<Payload>> const objects,
+    callback_t<> callback_after_finish) {
+  // write all payloads in one (vectored) write, rather than one by one
+  std::vector<asio::const_buffer> buffers;
+  buffers.reserve(objects.size());
+  for (auto const& object : objects) {
+    if (object->data_size > 0) {
+      buffers.emplace_back(object->pointer, object->data_size);
     }
   }
+  sendBufferHelper(buffers, objects, callback_after_finish);
+}
+
+void SocketConnection::sendBufferHelper(
+    std::vector<asio::const_buffer> const& buffers,
+    std::vector<std::shared_ptr<Payload>> const objects,
+    callback_t<> callback_after_finish) {
+  auto self(shared_from_this());
+  async_write(socket_, buffers,
+              [self, callback_after_finish, objects](
+                  boost::system::error_code ec, std::size_t) {
+                if (ec) {
+                  VINEYARD_DISCARD(callback_after_finish(Status::IOError(
+                      "Failed to write buffer to client: " + ec.message())));
+                } else {
+                  VINEYARD_DISCARD(callback_after_finish(Status::OK()));
+                }
+              });
 }
 
 bool SocketConnection::doGetRemoteBuffers(const json& root) {
@@ -346,13 +776,31 @@ bool SocketConnection::doGetRemoteBuffers(const json& root) {
   std::vector<std::shared_ptr<Payload>> objects;
   std::string message_out;
 
-  TRY_READ_REQUEST(ReadGetBuffersRequest, root, ids);
-  RESPONSE_ON_ERROR(server_ptr_->GetBulkStore()->Get(ids, objects));
+  TRY_READ_REQUEST(ReadGetRemoteBuffersRequest, root, ids);
+  // pinned until the buffers have been sent (i.e., the callbacks that hold
+  // `pinned` are released), to avoid being spilled meanwhile.
+  auto bulk_store = server_ptr_->GetBulkStore();
+  std::shared_ptr<std::unordered_set<ObjectID>> pinned(
+      new std::unordered_set<ObjectID>(),
+      [bulk_store](std::unordered_set<ObjectID>* pinned) {
+        for (auto const& id : *pinned) {
+          VINEYARD_DISCARD(bulk_store->Unpin(id));
+        }
+        delete pinned;
+      });
+  RESPONSE_ON_ERROR(bulk_store->Get(ids, objects, *pinned));
+  for (auto const& object : objects) {
+    if (object->IsDevice()) {
+      RESPONSE_ON_ERROR(Status::NotImplemented(
+          "Device blobs cannot be fetched remotely: " +
+          ObjectIDToString(object->object_id)));
+    }
+  }
   WriteGetBuffersReply(objects, message_out);
 
-  this->doWrite(message_out, [this, self, objects](const Status& status) {
-    boost::system::error_code ec;
-    sendBufferHelper(objects, 0, ec, [self](const Status& status) {
+  this->doWrite(message_out, [this, self, objects,
+                              pinned](const Status& status) {
+    sendBufferHelper(objects, [self, pinned](const Status& status) {
       if (!status.ok()) {
         LOG(ERROR) << "Failed to send buffers to remote client: "
                    << status.ToString();
@@ -364,23 +812,106 @@ bool SocketConnection::doGetRemoteBuffers(const json& root) {
   return false;
 }
 
+bool SocketConnection::doGetRemoteBufferChunks(const json& root) {
+  auto self(shared_from_this());
+  std::vector<ObjectID> ids;
+  std::vector<size_t> offsets, sizes;
+  std::vector<std::shared_ptr<Payload>> objects;
+  std::string message_out;
+
+  TRY_READ_REQUEST(ReadGetRemoteBufferChunksRequest, root, ids, offsets,
+                   sizes);
+  std::vector<asio::const_buffer> buffers;
+  size_t total_size = 0;
+  for (size_t idx = 0; idx < ids.size(); ++idx) {
+    std::shared_ptr<Payload> object;
+    RESPONSE_ON_ERROR(server_ptr_->GetBulkStore()->Get(ids[idx], object));
+    if (object->IsDevice()) {
+      RESPONSE_ON_ERROR(Status::NotImplemented(
+          "Device blobs cannot be fetched remotely: " +
+          ObjectIDToString(ids[idx])));
+    }
+    // n.b.: `offsets[idx] + sizes[idx]` may overflow
+    size_t const data_size = static_cast<size_t>(object->data_size);
+    if (offsets[idx] > data_size || sizes[idx] > data_size - offsets[idx]) {
+      RESPONSE_ON_ERROR(Status::Invalid(
+          "The requested chunk is out of the range of blob " +
+          ObjectIDToString(ids[idx])));
+    }
+    if (sizes[idx] > 0) {
+      buffers.emplace_back(object->pointer + offsets[idx], sizes[idx]);
+    }
+    total_size += sizes[idx];
+    objects.emplace_back(object);
+  }
+  WriteGetRemoteBufferChunksReply(total_size, message_out);
+
+  this->doWrite(message_out, [this, self, buffers,
+                              objects](const Status& status) {
+    sendBufferHelper(buffers, objects, [self](const Status& status) {
+      if (!status.ok()) {
+        LOG(ERROR) << "Failed to send buffer chunks to remote client: "
+                   << status.ToString();
+      }
+      return Status::OK();
+    });
+    return Status::OK();
+  });
+  return false;
+}
+
 bool SocketConnection::doCreateBuffer(const json& root) {
   auto self(shared_from_this());
   size_t size;
+  int numa_node = -1, device = -1;
+  TRY_READ_REQUEST(ReadCreateBufferRequest, root, size, numa_node, device);
+  if (device >= 0) {
+    return doCreateDeviceBuffer(size, device);
+  }
+  return doCreateBuffer(size, numa_node, false);
+}
+
+bool SocketConnection::doCreateDeviceBuffer(const size_t size,
+                                            const int device) {
+  auto self(shared_from_this());
   std::shared_ptr<Payload> object;
   std::string message_out;
 
-  TRY_READ_REQUEST(ReadCreateBufferRequest, root, size);
   ObjectID object_id;
-  RESPONSE_ON_ERROR(
-      server_ptr_->GetBulkStore()->Create(size, object_id, object));
+  RESPONSE_ON_ERROR(server_ptr_->GetBulkStore()->CreateDevice(
+      size, device, object_id, object));
+  pinBlobs({object});
   WriteCreateBufferReply(object_id, object, message_out);
+  // no fds to send, the IPC handle is in the payload
+  this->doWrite(message_out);
+  return false;
+}
+
+bool SocketConnection::doCreateBuffer(const size_t size, int numa_node,
+                                      const bool binary) {
+  auto self(shared_from_this());
+  std::shared_ptr<Payload> object;
+  std::string message_out;
+
+  if (numa_node == -1) {
+    numa_node = peerNumaNode();
+  }
+  ObjectID object_id;
+  RESPONSE_ON_ERROR(server_ptr_->GetBulkStore()->Create(
+      size, object_id, object, numa_node, tenant_));
+  pinBlobs({object});
+  created_blobs_.emplace(object_id);
+  if (binary) {
+    WriteCreateBufferReplyBinary(object_id, object, message_out);
+  } else {
+    WriteCreateBufferReply(object_id, object, message_out);
+  }
 
   int store_fd = object->store_fd;
   int data_size = object->data_size;
   this->doWrite(
       message_out, [this, self, store_fd, data_size](const Status& status) {
-        if (data_size > 0 &&
+        if (data_size > 0 && store_fd != -1 &&
             self->used_fds_.find(store_fd) == self->used_fds_.end()) {
           self->used_fds_.emplace(store_fd);
           send_fd(self->nativeHandle(), store_fd);
@@ -392,6 +923,110 @@ bool SocketConnection::doCreateBuffer(const json& root) {
   return false;
 }
 
+bool SocketConnection::doExtendBuffer(const json& root) {
+  auto self(shared_from_this());
+  ObjectID object_id;
+  size_t size;
+  std::shared_ptr<Payload> object;
+  std::string message_out;
+
+  TRY_READ_REQUEST(ReadExtendBufferRequest, root, object_id, size);
+  RESPONSE_ON_ERROR(created_blobs_.find(object_id) != created_blobs_.end()
+                        ? Status::OK()
+                        : Status::Invalid(
+                              "extend: the blob hasn't been created by the "
+                              "client: " +
+                              ObjectIDToString(object_id)));
+  RESPONSE_ON_ERROR(
+      server_ptr_->GetBulkStore()->Extend(object_id, size, object));
+  // the fd has been sent when creating the buffer
+  WriteExtendBufferReply(object, message_out);
+  this->doWrite(message_out);
+  return false;
+}
+
+bool SocketConnection::doCopyBuffer(const json& root) {
+  auto self(shared_from_this());
+  ObjectID source, object_id;
+  std::shared_ptr<Payload> object;
+  std::string message_out;
+
+  TRY_READ_REQUEST(ReadCopyBufferRequest, root, source);
+  RESPONSE_ON_ERROR(server_ptr_->GetBulkStore()->Copy(
+      source, object_id, object, peerNumaNode(), tenant_));
+  pinBlobs({object});
+  WriteCopyBufferReply(object_id, object, message_out);
+  this->doWrite(message_out, [self, object](const Status& status) {
+    self->sendFds({object});
+    return Status::OK();
+  });
+  return false;
+}
+
+bool SocketConnection::doCreateBufferFromFile(const json& root) {
+  auto self(shared_from_this());
+  std::string path;
+  size_t offset = 0;
+  int64_t length = -1;
+  ObjectID object_id;
+  std::shared_ptr<Payload> object;
+  std::string message_out;
+
+  TRY_READ_REQUEST(ReadCreateBufferFromFileRequest, root, path, offset,
+                   length);
+  // the file is opened on behalf of the peer, with its permissions
+  credentials::Credentials peer;
+  RESPONSE_ON_ERROR(credentials::OfPeer(nativeHandle(), peer));
+  RESPONSE_ON_ERROR(server_ptr_->GetBulkStore()->CreateFromFile(
+      path, offset, length, peer, object_id, object));
+  WriteCreateBufferFromFileReply(object_id, object, message_out);
+  this->doWrite(message_out, [self, object](const Status& status) {
+    self->sendFds({object});
+    return Status::OK();
+  });
+  return false;
+}
+
+bool SocketConnection::doCreateBuffers(const json& root) {
+  auto self(shared_from_this());
+  std::vector<size_t> sizes;
+  std::vector<ObjectID> object_ids;
+  std::vector<std::shared_ptr<Payload>> objects;
+  std::string message_out;
+
+  TRY_READ_REQUEST(ReadCreateBuffersRequest, root, sizes);
+  auto bulk_store = server_ptr_->GetBulkStore();
+  int numa_node = peerNumaNode();
+  for (auto const size : sizes) {
+    ObjectID object_id;
+    std::shared_ptr<Payload> object;
+    auto status =
+        bulk_store->Create(size, object_id, object, numa_node, tenant_);
+    if (!status.ok()) {
+      // rollback the blobs that have been created
+      for (auto const& id : object_ids) {
+        VINEYARD_DISCARD(bulk_store->Delete(id));
+      }
+      WriteErrorReply(status, message_out);
+      this->doWrite(message_out);
+      return false;
+    }
+    object_ids.emplace_back(object_id);
+    objects.emplace_back(object);
+  }
+  pinBlobs(objects);
+  created_blobs_.insert(object_ids.begin(), object_ids.end());
+  WriteCreateBuffersReply(object_ids, objects, message_out);
+
+  this->doWrite(message_out, [this, self, objects](const Status& status) {
+    self->sendFds(objects);
+    LOG_SUMMARY("instances_memory_usage_bytes", server_ptr_->instance_id(),
+                server_ptr_->GetBulkStore()->Footprint());
+    return Status::OK();
+  });
+  return false;
+}
+
 bool SocketConnection::doCreateRemoteBuffer(const json& root) {
   auto self(shared_from_this());
   size_t size;
@@ -399,8 +1034,8 @@ bool SocketConnection::doCreateRemoteBuffer(const json& root) {
 
   TRY_READ_REQUEST(ReadCreateBufferRequest, root, size);
   ObjectID object_id;
-  RESPONSE_ON_ERROR(
-      server_ptr_->GetBulkStore()->Create(size, object_id, object));
+  RESPONSE_ON_ERROR(server_ptr_->GetBulkStore()->Create(size, object_id,
+                                                        object, -1, tenant_));
 
   asio::async_read(
       socket_, asio::buffer(object->pointer, size),
@@ -434,6 +1069,7 @@ bool SocketConnection::doDropBuffer(const json& root) {
   auto status = server_ptr_->GetBulkStore()->Delete(object_id);
   std::string message_out;
   if (status.ok()) {
+    created_blobs_.erase(object_id);
     WriteDropBufferReply(message_out);
   } else {
     WriteErrorReply(status, message_out);
@@ -444,28 +1080,116 @@ bool SocketConnection::doDropBuffer(const json& root) {
   return false;
 }
 
-bool SocketConnection::doGetData(const json& root) {
+int SocketConnection::peerNumaNode() {
+  if (!numa::Enabled()) {
+    return -1;
+  }
+  if (peer_numa_node_ == -2) {
+    peer_numa_node_ = numa::NodeOfPeer(nativeHandle());
+  }
+  return peer_numa_node_;
+}
+
+bool SocketConnection::doRelease(const json& root) {
   auto self(shared_from_this());
   std::vector<ObjectID> ids;
-  bool sync_remote = false, wait = false;
-  double startTime = GetCurrentTime();
-  TRY_READ_REQUEST(ReadGetDataRequest, root, ids, sync_remote, wait);
-  json tree;
-  RESPONSE_ON_ERROR(server_ptr_->GetData(
-      ids, sync_remote, wait, [self]() { return self->running_.load(); },
-      [self, startTime](const Status& status, const json& tree) {
-        std::string message_out;
-        if (status.ok()) {
-          WriteGetDataReply(tree, message_out);
-        } else {
+  TRY_READ_REQUEST(ReadReleaseRequest, root, ids);
+  for (auto const& id : ids) {
+    auto iter = pinned_blobs_.find(id);
+    if (iter != pinned_blobs_.end()) {
+      VINEYARD_SUPPRESS(server_ptr_->GetBulkStore()->Unpin(id));
+      pinned_blobs_.erase(iter);
+    }
+  }
+  std::string message_out;
+  WriteReleaseReply(message_out);
+  this->doWrite(message_out);
+  return false;
+}
+
+bool SocketConnection::doGetData(const json& root) {
+  auto self(shared_from_this());
+  std::vector<ObjectID> ids;
+  bool sync_remote = false, wait = false, lazy = false;
+  uint64_t snapshot = 0;
+  double startTime = GetCurrentTime();
+  TRY_READ_REQUEST(ReadGetDataRequest, root, ids, sync_remote, wait, lazy,
+                   snapshot);
+  auto callback = [self, startTime](const Status& status, const json& tree) {
+    std::string message_out;
+    if (status.ok()) {
+      WriteGetDataReply(tree, message_out);
+    } else {
+      LOG(ERROR) << status.ToString();
+      WriteErrorReply(status, message_out);
+    }
+    self->doWrite(message_out);
+    double endTime = GetCurrentTime();
+    LOG_SUMMARY("data_request_duration_microseconds", "get",
+                (endTime - startTime) * 1000000);
+    LOG_COUNTER("data_requests_total", "get");
+    return Status::OK();
+  };
+  if (snapshot != 0) {
+    RESPONSE_ON_ERROR(server_ptr_->GetData(ids, snapshot, lazy, callback));
+  } else {
+    RESPONSE_ON_ERROR(server_ptr_->GetData(
+        ids, sync_remote, wait, lazy,
+        [self]() { return self->running_.load(); }, callback));
+  }
+  return false;
+}
+
+bool SocketConnection::doGetObjects(const json& root) {
+  auto self(shared_from_this());
+  std::vector<ObjectID> ids;
+  bool sync_remote = false, wait = false;
+  double startTime = GetCurrentTime();
+  TRY_READ_REQUEST(ReadGetObjectsRequest, root, ids, sync_remote, wait);
+  RESPONSE_ON_ERROR(server_ptr_->GetData(
+      ids, sync_remote, wait, false,
+      [self]() { return self->running_.load(); },
+      [self, startTime](const Status& status, const json& tree) {
+        if (!status.ok()) {
+          std::string message_out;
           LOG(ERROR) << status.ToString();
           WriteErrorReply(status, message_out);
+          self->doWrite(message_out);
+          return Status::OK();
         }
-        self->doWrite(message_out);
-        double endTime = GetCurrentTime();
-        LOG_SUMMARY("data_request_duration_microseconds", "get",
-                    (endTime - startTime) * 1000000);
-        LOG_COUNTER("data_requests_total", "get");
+        // the blobs are collected and pinned on the IO context, as the
+        // metadata callback runs on the meta context.
+        self->server_ptr_->GetContext().post([self, tree, startTime]() {
+          std::set<ObjectID> blob_ids;
+          for (auto const& item : tree) {
+            collectLocalBlobs(item, self->server_ptr_->instance_id(),
+                              blob_ids);
+          }
+          std::vector<std::shared_ptr<Payload>> objects;
+          std::string message_out;
+          Status status;
+          {
+            std::lock_guard<std::recursive_mutex> lock(self->state_mutex_);
+            status = self->server_ptr_->GetBulkStore()->Get(
+                std::vector<ObjectID>(blob_ids.begin(), blob_ids.end()),
+                objects, self->pinned_blobs_);
+          }
+          if (!status.ok()) {
+            LOG(ERROR) << status.ToString();
+            WriteErrorReply(status, message_out);
+            self->doWrite(message_out);
+            return;
+          }
+          WriteGetObjectsReply(tree, objects, message_out);
+          self->doWrite(message_out, [self, objects](const Status& status) {
+            self->sendFds(objects);
+            return Status::OK();
+          });
+          double endTime = GetCurrentTime();
+          LOG_SUMMARY("data_request_duration_microseconds", "get",
+                      (endTime - startTime) * 1000000);
+          LOG_COUNTER("data_requests_total", "get");
+        });
         return Status::OK();
       }));
   return false;
@@ -492,15 +1216,55 @@ bool SocketConnection::doListData(const json& root) {
   return false;
 }
 
+bool SocketConnection::doListObjects(const json& root) {
+  auto self(shared_from_this());
+  std::string pattern, name_prefix, cursor;
+  bool regex, brief;
+  size_t limit;
+  TRY_READ_REQUEST(ReadListObjectsRequest, root, pattern, regex, name_prefix,
+                   cursor, limit, brief);
+  RESPONSE_ON_ERROR(server_ptr_->ListObjects(
+      pattern, regex, name_prefix, cursor, limit, brief,
+      [self](const Status& status, const json& objects,
+             const std::string& next_cursor) {
+        std::string message_out;
+        if (status.ok()) {
+          WriteListObjectsReply(objects, next_cursor, message_out);
+        } else {
+          LOG(ERROR) << status.ToString();
+          WriteErrorReply(status, message_out);
+        }
+        self->doWrite(message_out);
+        return Status::OK();
+      }));
+  return false;
+}
+
+bool SocketConnection::doBulk(const json& root,
+                              bool (SocketConnection::*handler)(const json&)) {
+  auto self(shared_from_this());
+  server_ptr_->GetBulkContext().post([self, root, handler]() {
+    if (!self->running_.load()) {
+      return;
+    }
+    if (((*self).*handler)(root)) {
+      self->doStop();
+    }
+  });
+  return false;
+}
+
 bool SocketConnection::doCreateData(const json& root) {
   auto self(shared_from_this());
   json tree;
+  int64_t ttl = 0;
   double startTime = GetCurrentTime();
-  TRY_READ_REQUEST(ReadCreateDataRequest, root, tree);
+  TRY_READ_REQUEST(ReadCreateDataRequest, root, tree, ttl);
   RESPONSE_ON_ERROR(server_ptr_->CreateData(
-      tree, [tree, self, startTime](const Status& status, const ObjectID id,
-                                    const Signature signature,
-                                    const InstanceID instance_id) {
+      tree, ttl,
+      [tree, self, startTime](const Status& status, const ObjectID id,
+                              const Signature signature,
+                              const InstanceID instance_id) {
         std::string message_out;
         if (status.ok()) {
           WriteCreateDataReply(id, signature, instance_id, message_out);
@@ -525,7 +1289,46 @@ bool SocketConnection::doCreateData(const json& root) {
 bool SocketConnection::doPersist(const json& root) {
   auto self(shared_from_this());
   ObjectID id;
-  TRY_READ_REQUEST(ReadPersistRequest, root, id);
+  bool async = false;
+  TRY_READ_REQUEST(ReadPersistRequest, root, id, async);
+  if (async) {
+    // write-behind: replies once queued, the pending requests are committed
+    // in groups by the metadata service.
+    uint64_t ticket = 0;
+    {
+      std::lock_guard<std::mutex> lock(persisting_mutex_);
+      ticket = next_persisting_++;
+      persisting_.emplace(ticket);
+    }
+    auto status = server_ptr_->Persist(
+        id, [self, id, ticket](const Status& status) {
+          std::vector<std::pair<std::function<void(const Status&)>, Status>>
+              finished;
+          {
+            std::lock_guard<std::mutex> lock(self->persisting_mutex_);
+            self->persisting_.erase(ticket);
+            if (!status.ok()) {
+              LOG(ERROR) << "Failed to persist " << ObjectIDToString(id) << ": "
+                         << status.ToString();
+              self->persisting_failures_.emplace(ticket, status);
+            }
+            self->collectPersisted(finished);
+          }
+          for (auto& item : finished) {
+            item.first(item.second);
+          }
+          return Status::OK();
+        });
+    if (!status.ok()) {
+      std::lock_guard<std::mutex> lock(persisting_mutex_);
+      persisting_.erase(ticket);
+    }
+    RESPONSE_ON_ERROR(status);
+    std::string message_out;
+    WritePersistReply(ticket, message_out);
+    this->doWrite(message_out);
+    return false;
+  }
   RESPONSE_ON_ERROR(server_ptr_->Persist(id, [self](const Status& status) {
     std::string message_out;
     if (status.ok()) {
@@ -540,6 +1343,58 @@ bool SocketConnection::doPersist(const json& root) {
   return false;
 }
 
+bool SocketConnection::doWaitPersisted(const json& root) {
+  auto self(shared_from_this());
+  uint64_t ticket = 0;
+  TRY_READ_REQUEST(ReadWaitPersistedRequest, root, ticket);
+  auto reply = [self](const Status& status) {
+    std::string message_out;
+    if (status.ok()) {
+      WriteWaitPersistedReply(message_out);
+    } else {
+      WriteErrorReply(status, message_out);
+    }
+    self->doWrite(message_out);
+  };
+  std::vector<std::pair<std::function<void(const Status&)>, Status>> finished;
+  {
+    std::lock_guard<std::mutex> lock(persisting_mutex_);
+    if (ticket == 0 || ticket >= next_persisting_) {
+      ticket = next_persisting_ - 1;
+    }
+    persisting_waiters_.emplace_back(ticket, reply);
+    collectPersisted(finished);
+  }
+  for (auto& item : finished) {
+    item.first(item.second);
+  }
+  return false;
+}
+
+void SocketConnection::collectPersisted(
+    std::vector<std::pair<std::function<void(const Status&)>, Status>>&
+        finished) {
+  // the tickets before the oldest in-flight one have all finished
+  uint64_t const pending =
+      persisting_.empty() ? next_persisting_ : *persisting_.begin();
+  auto iter = persisting_waiters_.begin();
+  while (iter != persisting_waiters_.end()) {
+    if (iter->first >= pending) {
+      ++iter;
+      continue;
+    }
+    // reports the first failure up to the ticket, only once
+    Status status;
+    auto failures_end = persisting_failures_.upper_bound(iter->first);
+    if (persisting_failures_.begin() != failures_end) {
+      status = persisting_failures_.begin()->second;
+    }
+    persisting_failures_.erase(persisting_failures_.begin(), failures_end);
+    finished.emplace_back(std::move(iter->second), status);
+    iter = persisting_waiters_.erase(iter);
+  }
+}
+
 bool SocketConnection::doIfPersist(const json& root) {
   auto self(shared_from_this());
   ObjectID id;
@@ -648,8 +1503,11 @@ bool SocketConnection::doDelData(const json& root) {
 bool SocketConnection::doCreateStream(const json& root) {
   auto self(shared_from_this());
   ObjectID stream_id;
-  TRY_READ_REQUEST(ReadCreateStreamRequest, root, stream_id);
-  auto status = server_ptr_->GetStreamStore()->Create(stream_id);
+  size_t retain_chunks = 0, retain_bytes = 0, budget_bytes = 0;
+  TRY_READ_REQUEST(ReadCreateStreamRequest, root, stream_id, retain_chunks,
+                   retain_bytes, budget_bytes);
+  auto status = server_ptr_->GetStreamStore()->Create(
+      stream_id, retain_chunks, retain_bytes, budget_bytes);
   std::string message_out;
   if (status.ok()) {
     WriteCreateStreamReply(message_out);
@@ -664,11 +1522,16 @@ bool SocketConnection::doCreateStream(const json& root) {
 bool SocketConnection::doOpenStream(const json& root) {
   auto self(shared_from_this());
   ObjectID stream_id;
-  int64_t mode;
-  TRY_READ_REQUEST(ReadOpenStreamRequest, root, stream_id, mode);
-  auto status = server_ptr_->GetStreamStore()->Open(stream_id, mode);
+  int64_t mode, offset = -1;
+  TRY_READ_REQUEST(ReadOpenStreamRequest, root, stream_id, mode, offset);
+  auto status = server_ptr_->GetStreamStore()->Open(stream_id, mode, conn_id_,
+                                                    offset);
   std::string message_out;
   if (status.ok()) {
+    if (mode & (StreamStore::kReadMode | StreamStore::kBroadcastMode)) {
+      // the cursor should be removed once the consumer is gone
+      this->associated_streams_.emplace(stream_id);
+    }
     WriteOpenStreamReply(message_out);
   } else {
     LOG(ERROR) << status.ToString();
@@ -683,19 +1546,31 @@ bool SocketConnection::doGetNextStreamChunk(const json& root) {
   ObjectID stream_id;
   size_t size;
   TRY_READ_REQUEST(ReadGetNextStreamChunkRequest, root, stream_id, size);
+  return doGetNextStreamChunk(stream_id, size, false);
+}
+
+bool SocketConnection::doGetNextStreamChunk(const ObjectID stream_id,
+                                            const size_t size,
+                                            const bool binary) {
+  auto self(shared_from_this());
   RESPONSE_ON_ERROR(server_ptr_->GetStreamStore()->Get(
-      stream_id, size, [self](const Status& status, const ObjectID chunk) {
+      stream_id, size,
+      [self, binary](const Status& status, const ObjectID chunk) {
         std::string message_out;
         if (status.ok()) {
           std::shared_ptr<Payload> object;
           RETURN_ON_ERROR(
               self->server_ptr_->GetBulkStore()->Get(chunk, object));
-          WriteGetNextStreamChunkReply(object, message_out);
+          if (binary) {
+            WriteGetNextStreamChunkReplyBinary(object, message_out);
+          } else {
+            WriteGetNextStreamChunkReply(object, message_out);
+          }
           int store_fd = object->store_fd;
           int data_size = object->data_size;
           self->doWrite(
               message_out, [self, store_fd, data_size](const Status& status) {
-                if (data_size > 0 &&
+                if (data_size > 0 && store_fd != -1 &&
                     self->used_fds_.find(store_fd) == self->used_fds_.end()) {
                   self->used_fds_.emplace(store_fd);
                   send_fd(self->nativeHandle(), store_fd);
@@ -716,20 +1591,31 @@ bool SocketConnection::doPullNextStreamChunk(const json& root) {
   auto self(shared_from_this());
   ObjectID stream_id;
   TRY_READ_REQUEST(ReadPullNextStreamChunkRequest, root, stream_id);
+  return doPullNextStreamChunk(stream_id, false);
+}
+
+bool SocketConnection::doPullNextStreamChunk(const ObjectID stream_id,
+                                             const bool binary) {
+  auto self(shared_from_this());
   this->associated_streams_.emplace(stream_id);
   RESPONSE_ON_ERROR(server_ptr_->GetStreamStore()->Pull(
-      stream_id, [self](const Status& status, const ObjectID chunk) {
+      stream_id, conn_id_,
+      [self, binary](const Status& status, const ObjectID chunk) {
         std::string message_out;
         if (status.ok()) {
           std::shared_ptr<Payload> object;
           RETURN_ON_ERROR(
               self->server_ptr_->GetBulkStore()->Get(chunk, object));
-          WritePullNextStreamChunkReply(object, message_out);
+          if (binary) {
+            WritePullNextStreamChunkReplyBinary(object, message_out);
+          } else {
+            WritePullNextStreamChunkReply(object, message_out);
+          }
           int store_fd = object->store_fd;
           int data_size = object->data_size;
           self->doWrite(
               message_out, [self, store_fd, data_size](const Status& status) {
-                if (data_size > 0 &&
+                if (data_size > 0 && store_fd != -1 &&
                     self->used_fds_.find(store_fd) == self->used_fds_.end()) {
                   self->used_fds_.emplace(store_fd);
                   send_fd(self->nativeHandle(), store_fd);
@@ -748,6 +1634,197 @@ bool SocketConnection::doPullNextStreamChunk(const json& root) {
   return false;
 }
 
+bool SocketConnection::doGetNextStreamChunks(
+    const ObjectID stream_id, const std::vector<size_t>& sizes) {
+  auto self(shared_from_this());
+  RESPONSE_ON_ERROR(server_ptr_->GetStreamStore()->Get(
+      stream_id, sizes,
+      [self](const Status& status, const std::vector<ObjectID>& chunks) {
+        std::string message_out;
+        if (status.ok()) {
+          std::vector<std::shared_ptr<Payload>> objects;
+          for (auto const& chunk : chunks) {
+            std::shared_ptr<Payload> object;
+            RETURN_ON_ERROR(
+                self->server_ptr_->GetBulkStore()->Get(chunk, object));
+            objects.emplace_back(object);
+          }
+          WriteGetNextStreamChunksReplyBinary(objects, message_out);
+          self->doWrite(message_out, [self, objects](const Status& status) {
+            self->sendFds(objects);
+            return Status::OK();
+          });
+        } else {
+          LOG(ERROR) << status.ToString();
+          WriteErrorReply(status, message_out);
+          self->doWrite(message_out);
+        }
+        return Status::OK();
+      }));
+  return false;
+}
+
+bool SocketConnection::doPutStreamChunks(
+    const ObjectID stream_id, std::shared_ptr<std::string> message,
+    const std::vector<std::pair<size_t, size_t>>& payloads) {
+  auto self(shared_from_this());
+  std::vector<size_t> sizes;
+  for (auto const& payload : payloads) {
+    sizes.emplace_back(payload.second);
+  }
+  RESPONSE_ON_ERROR(server_ptr_->GetStreamStore()->Get(
+      stream_id, sizes,
+      [self, stream_id, message, payloads](
+          const Status& status, const std::vector<ObjectID>& chunks) {
+        auto s = status;
+        for (size_t idx = 0; s.ok() && idx < chunks.size(); ++idx) {
+          std::shared_ptr<Payload> object;
+          s = self->server_ptr_->GetBulkStore()->Get(chunks[idx], object);
+          if (s.ok() && payloads[idx].second > 0) {
+            memory::concurrent_memcpy(object->pointer,
+                                      message->data() + payloads[idx].first,
+                                      payloads[idx].second);
+          }
+        }
+        // publish the chunks at once, rather than on the next write
+        if (s.ok()) {
+          s = self->server_ptr_->GetStreamStore()->Seal(stream_id);
+        }
+        std::string message_out;
+        if (s.ok()) {
+          WritePutStreamChunksReplyBinary(chunks.size(), message_out);
+        } else {
+          LOG(ERROR) << s.ToString();
+          WriteErrorReply(s, message_out);
+        }
+        self->doWrite(message_out);
+        return Status::OK();
+      }));
+  return false;
+}
+
+bool SocketConnection::doPullStreamChunks(const ObjectID stream_id,
+                                          const size_t limit) {
+  auto self(shared_from_this());
+  this->associated_streams_.emplace(stream_id);
+  RESPONSE_ON_ERROR(server_ptr_->GetStreamStore()->Pull(
+      stream_id, conn_id_, limit,
+      [self](const Status& status, const std::vector<ObjectID>& chunks) {
+        std::string message_out;
+        if (status.ok()) {
+          std::vector<std::shared_ptr<Payload>> objects;
+          for (auto const& chunk : chunks) {
+            std::shared_ptr<Payload> object;
+            RETURN_ON_ERROR(
+                self->server_ptr_->GetBulkStore()->Get(chunk, object));
+            objects.emplace_back(object);
+          }
+          // the payloads are copied into the reply, as the chunks are
+          // released once the callback returns.
+          WritePullStreamChunksReplyBinary(objects, message_out);
+        } else {
+          if (!status.IsStreamDrained()) {
+            LOG(ERROR) << status.ToString();
+          }
+          WriteErrorReply(status, message_out);
+        }
+        self->doWrite(message_out);
+        return Status::OK();
+      }));
+  return false;
+}
+
+bool SocketConnection::doSubscribeStream(const ObjectID stream_id,
+                                         const size_t credits,
+                                         const int64_t mode) {
+  auto self(shared_from_this());
+  RESPONSE_ON_ERROR(subscribed_stream_ == InvalidObjectID()
+                        ? Status::OK()
+                        : Status::Invalid(
+                              "A stream has been subscribed on this "
+                              "connection: " +
+                              ObjectIDToString(subscribed_stream_)));
+  RESPONSE_ON_ERROR(
+      server_ptr_->GetStreamStore()->Open(stream_id, mode, conn_id_));
+  this->associated_streams_.emplace(stream_id);
+  subscribed_stream_ = stream_id;
+  stream_credits_ = credits;
+  std::string message_out;
+  WriteSubscribeStreamReplyBinary(stream_id, message_out);
+  this->doWrite(message_out);
+  pushStreamChunks();
+  return false;
+}
+
+bool SocketConnection::doStreamCredit(const ObjectID stream_id,
+                                      const size_t credits) {
+  // there's no reply for credits, as the subscriber is waiting for chunks.
+  if (stream_id != subscribed_stream_) {
+    LOG(ERROR) << "The stream hasn't been subscribed: "
+               << ObjectIDToString(stream_id);
+    return false;
+  }
+  stream_credits_ += credits;
+  pushStreamChunks();
+  return false;
+}
+
+void SocketConnection::pushStreamChunks() {
+  if (stream_credits_.load() == 0 || !running_.load()) {
+    return;
+  }
+  // at most one pulling at the same time
+  bool pulling = false;
+  if (!stream_pulling_.compare_exchange_strong(pulling, true)) {
+    return;
+  }
+  auto self(shared_from_this());
+  ObjectID stream_id = subscribed_stream_;
+  auto status = server_ptr_->GetStreamStore()->Pull(
+      stream_id, conn_id_, stream_credits_.load(),
+      [self, stream_id](const Status& status,
+                        const std::vector<ObjectID>& chunks) {
+        std::string message_out;
+        if (status.ok()) {
+          // consumes the credits before finishing the pulling, thus the
+          // following pulling won't see the stale credits.
+          size_t credits = self->stream_credits_.load();
+          while (!self->stream_credits_.compare_exchange_weak(
+              credits, credits - std::min(credits, chunks.size()))) {}
+          self->stream_pulling_.store(false);
+          std::vector<std::shared_ptr<Payload>> objects;
+          for (auto const& chunk : chunks) {
+            std::shared_ptr<Payload> object;
+            RETURN_ON_ERROR(
+                self->server_ptr_->GetBulkStore()->Get(chunk, object));
+            objects.emplace_back(object);
+          }
+          WriteStreamChunksPushBinary(stream_id, objects, message_out);
+          self->doWrite(message_out);
+          // pulls the following chunks outside of the stream store
+          self->server_ptr_->GetContext().post(
+              [self]() { self->pushStreamChunks(); });
+        } else {
+          // the end of stream, no more chunks will be pushed
+          self->stream_credits_.store(0);
+          self->stream_pulling_.store(false);
+          if (!status.IsStreamDrained()) {
+            LOG(ERROR) << status.ToString();
+          }
+          WriteErrorReply(status, message_out);
+          self->doWrite(message_out);
+        }
+        return Status::OK();
+      });
+  if (!status.ok()) {
+    stream_credits_.store(0);
+    stream_pulling_.store(false);
+    std::string message_out;
+    WriteErrorReply(status, message_out);
+    this->doWrite(message_out);
+  }
+}
+
 bool SocketConnection::doStopStream(const json& root) {
   auto self(shared_from_this());
   ObjectID stream_id;
@@ -766,9 +1843,10 @@ bool SocketConnection::doPutName(const json& root) {
   auto self(shared_from_this());
   ObjectID object_id;
   std::string name;
-  TRY_READ_REQUEST(ReadPutNameRequest, root, object_id, name);
+  int64_t ttl = 0;
+  TRY_READ_REQUEST(ReadPutNameRequest, root, object_id, name, ttl);
   RESPONSE_ON_ERROR(
-      server_ptr_->PutName(object_id, name, [self](const Status& status) {
+      server_ptr_->PutName(object_id, name, ttl, [self](const Status& status) {
         std::string message_out;
         if (status.ok()) {
           WritePutNameReply(message_out);
@@ -822,6 +1900,149 @@ bool SocketConnection::doDropName(const json& root) {
   return false;
 }
 
+bool SocketConnection::doPutNames(const json& root) {
+  auto self(shared_from_this());
+  std::map<std::string, ObjectID> names;
+  TRY_READ_REQUEST(ReadPutNamesRequest, root, names);
+  RESPONSE_ON_ERROR(server_ptr_->PutNames(names, [self](const Status& status) {
+    std::string message_out;
+    if (status.ok()) {
+      WritePutNamesReply(message_out);
+    } else {
+      LOG(ERROR) << "Failed to put names: " << status.ToString();
+      WriteErrorReply(status, message_out);
+    }
+    self->doWrite(message_out);
+    return Status::OK();
+  }));
+  return false;
+}
+
+bool SocketConnection::doGetNames(const json& root) {
+  auto self(shared_from_this());
+  std::vector<std::string> names;
+  uint64_t snapshot = 0;
+  TRY_READ_REQUEST(ReadGetNamesRequest, root, names, snapshot);
+  RESPONSE_ON_ERROR(server_ptr_->GetNames(
+      names, snapshot,
+      [self](const Status& status,
+             const std::map<std::string, ObjectID>& object_ids) {
+        std::string message_out;
+        if (status.ok()) {
+          WriteGetNamesReply(object_ids, message_out);
+        } else {
+          LOG(ERROR) << "Failed to get names: " << status.ToString();
+          WriteErrorReply(status, message_out);
+        }
+        self->doWrite(message_out);
+        return Status::OK();
+      }));
+  return false;
+}
+
+bool SocketConnection::doCreateSnapshot(const json& root) {
+  auto self(shared_from_this());
+  bool sync_remote = false;
+  TRY_READ_REQUEST(ReadCreateSnapshotRequest, root, sync_remote);
+  RESPONSE_ON_ERROR(server_ptr_->CreateSnapshot(
+      sync_remote, [self](const Status& status, const uint64_t snapshot) {
+        std::string message_out;
+        if (status.ok()) {
+          std::lock_guard<std::mutex> lock(self->snapshots_mutex_);
+          if (!self->running_.load()) {
+            // the connection has gone, nobody will release it
+            VINEYARD_SUPPRESS(self->server_ptr_->ReleaseSnapshot(snapshot));
+            return Status::OK();
+          }
+          self->snapshots_.emplace(snapshot);
+          WriteCreateSnapshotReply(snapshot, message_out);
+        } else {
+          LOG(ERROR) << "Failed to create snapshot: " << status.ToString();
+          WriteErrorReply(status, message_out);
+        }
+        self->doWrite(message_out);
+        return Status::OK();
+      }));
+  return false;
+}
+
+bool SocketConnection::doReleaseSnapshot(const json& root) {
+  auto self(shared_from_this());
+  uint64_t snapshot = 0;
+  std::string message_out;
+  TRY_READ_REQUEST(ReadReleaseSnapshotRequest, root, snapshot);
+  bool owned = false;
+  {
+    std::lock_guard<std::mutex> lock(snapshots_mutex_);
+    owned = snapshots_.erase(snapshot) != 0;
+  }
+  // only the snapshots taken by this connection can be released
+  RESPONSE_ON_ERROR(owned ? server_ptr_->ReleaseSnapshot(snapshot)
+                          : Status::Invalid(
+                                "The snapshot " + std::to_string(snapshot) +
+                                " doesn't belong to this connection"));
+  WriteReleaseSnapshotReply(message_out);
+  this->doWrite(message_out);
+  return false;
+}
+
+bool SocketConnection::doGossip(const json& root) {
+  auto self(shared_from_this());
+  InstanceID from = UnspecifiedInstanceID(), target = UnspecifiedInstanceID();
+  json updates;
+  TRY_READ_REQUEST(ReadGossipRequest, root, from, target, updates);
+  RESPONSE_ON_ERROR(server_ptr_->Gossip(
+      from, target, updates,
+      [self](const Status& status, const bool acked, const json& digest) {
+        std::string message_out;
+        if (status.ok()) {
+          WriteGossipReply(acked, digest, message_out);
+        } else {
+          WriteErrorReply(status, message_out);
+        }
+        self->doWrite(message_out);
+        return Status::OK();
+      }));
+  return false;
+}
+
+bool SocketConnection::doDropNames(const json& root) {
+  auto self(shared_from_this());
+  std::vector<std::string> names;
+  TRY_READ_REQUEST(ReadDropNamesRequest, root, names);
+  RESPONSE_ON_ERROR(server_ptr_->DropNames(names, [self](const Status& status) {
+    std::string message_out;
+    if (status.ok()) {
+      WriteDropNamesReply(message_out);
+    } else {
+      LOG(ERROR) << "Failed to drop names: " << status.ToString();
+      WriteErrorReply(status, message_out);
+    }
+    self->doWrite(message_out);
+    return Status::OK();
+  }));
+  return false;
+}
+
+bool SocketConnection::doBatch(const json& root) {
+  auto self(shared_from_this());
+  json ops;
+  TRY_READ_REQUEST(ReadBatchRequest, root, ops);
+  RESPONSE_ON_ERROR(server_ptr_->Batch(
+      ops, [self](const Status& status, const json& objects) {
+        std::string message_out;
+        if (status.ok()) {
+          WriteBatchReply(objects, message_out);
+        } else {
+          LOG(ERROR) << "Failed to apply the batch: " << status.ToString();
+          WriteErrorReply(status, message_out);
+        }
+        self->doWrite(message_out);
+        return Status::OK();
+      }));
+  return false;
+}
+
 bool SocketConnection::doMigrateObject(const json& root) {
   auto self(shared_from_this());
   ObjectID object_id;
@@ -881,6 +2102,62 @@ bool SocketConnection::doClusterMeta(const json& root) {
   return false;
 }
 
+bool SocketConnection::doLocalityInfo(const json& root) {
+  auto self(shared_from_this());
+  ObjectID id = InvalidObjectID();
+  bool sync_remote = false;
+  TRY_READ_REQUEST(ReadLocalityInfoRequest, root, id, sync_remote);
+  RESPONSE_ON_ERROR(server_ptr_->LocalityInfo(
+      id, sync_remote, [self](const Status& status, const json& locality) {
+        std::string message_out;
+        if (status.ok()) {
+          WriteLocalityInfoReply(locality, message_out);
+        } else {
+          WriteErrorReply(status, message_out);
+        }
+        self->doWrite(message_out);
+        return Status::OK();
+      }));
+  return false;
+}
+
+bool SocketConnection::doPrefetch(const json& root) {
+  auto self(shared_from_this());
+  std::vector<ObjectID> ids;
+  TRY_READ_REQUEST(ReadPrefetchRequest, root, ids);
+  RESPONSE_ON_ERROR(server_ptr_->Prefetch(
+      ids, [self](const Status& status, const size_t nbytes) {
+        std::string message_out;
+        if (status.ok()) {
+          WritePrefetchReply(nbytes, message_out);
+        } else {
+          WriteErrorReply(status, message_out);
+        }
+        self->doWrite(message_out);
+        return Status::OK();
+      }));
+  return false;
+}
+
+bool SocketConnection::doFootprints(const json& root) {
+  auto self(shared_from_this());
+  std::vector<ObjectID> ids;
+  size_t limit = 0;
+  TRY_READ_REQUEST(ReadFootprintsRequest, root, ids, limit);
+  RESPONSE_ON_ERROR(server_ptr_->Footprints(
+      ids, limit, [self](const Status& status, const json& footprints) {
+        std::string message_out;
+        if (status.ok()) {
+          WriteFootprintsReply(footprints, message_out);
+        } else {
+          WriteErrorReply(status, message_out);
+        }
+        self->doWrite(message_out);
+        return Status::OK();
+      }));
+  return false;
+}
+
 bool SocketConnection::doInstanceStatus(const json& root) {
   auto self(shared_from_this());
   TRY_READ_REQUEST(ReadInstanceStatusRequest, root);
@@ -927,27 +2204,320 @@ bool SocketConnection::doMakeArena(const json& root) {
 bool SocketConnection::doFinalizeArena(const json& root) {
   auto self(shared_from_this());
   int fd = -1;
-  std::vector<size_t> offsets, sizes;
+  std::vector<size_t> offsets, sizes, unused_offsets, unused_sizes;
+  bool keep_alive = false;
   std::string message_out;
 
-  TRY_READ_REQUEST(ReadFinalizeArenaRequest, root, fd, offsets, sizes);
-  RESPONSE_ON_ERROR(
-      server_ptr_->GetBulkStore()->FinalizeArena(fd, offsets, sizes));
+  TRY_READ_REQUEST(ReadFinalizeArenaRequest, root, fd, offsets, sizes,
+                   keep_alive, unused_offsets, unused_sizes);
+  if (keep_alive) {
+    RESPONSE_ON_ERROR(server_ptr_->GetBulkStore()->FlushArena(
+        fd, offsets, sizes, unused_offsets, unused_sizes));
+  } else {
+    RESPONSE_ON_ERROR(
+        server_ptr_->GetBulkStore()->FinalizeArena(fd, offsets, sizes));
+  }
   WriteFinalizeArenaReply(message_out);
 
   this->doWrite(message_out);
   return false;
 }
 
+bool SocketConnection::doEnableRing(const json& root) {
+  auto self(shared_from_this());
+  size_t capacity;
+  std::string message_out;
+
+  TRY_READ_REQUEST(ReadEnableRingRequest, root, capacity);
+  if (std::atomic_load(&ring_)) {
+    RESPONSE_ON_ERROR(Status::Invalid("The ring buffer has been enabled"));
+  }
+  capacity = RingChannel::AlignedCapacity(capacity);
+  int fd = memory::create_buffer(RingChannel::RequiredSize(capacity));
+  if (fd < 0) {
+    RESPONSE_ON_ERROR(Status::IOError("Failed to create the ring buffer"));
+  }
+  std::shared_ptr<RingChannel> ring;
+  auto status = RingChannel::Map(fd, capacity, true, ring);
+  if (!status.ok()) {
+    close(fd);
+    RESPONSE_ON_ERROR(status);
+  }
+  WriteEnableRingReply(fd, capacity, message_out);
+
+  // switch to the ring after the reply and the fd have been sent through
+  // the socket.
+  this->doWrite(message_out, [self, fd, ring](const Status& status) {
+    send_fd(self->nativeHandle(), fd);
+    close(fd);
+    self->doRingLoop(ring);
+    return Status::OK();
+  });
+  return false;
+}
+
+bool SocketConnection::doEnableBlobTable(const json& root) {
+  auto self(shared_from_this());
+  std::string message_out;
+
+  TRY_READ_REQUEST(ReadEnableBlobTableRequest, root);
+  auto bulk_store = server_ptr_->GetBulkStore();
+  int fd = bulk_store->BlobTableFd();
+  if (fd == -1) {
+    RESPONSE_ON_ERROR(
+        Status::NotImplemented("The blob table is not enabled"));
+  }
+  WriteEnableBlobTableReply(fd, bulk_store->BlobTableCapacity(), message_out);
+  // the table outlives the connection, thus the fd is not closed
+  this->doWrite(message_out, [self, fd](const Status& status) {
+    send_fd(self->nativeHandle(), fd);
+    return Status::OK();
+  });
+  return false;
+}
+
+bool SocketConnection::doSubscribeInvalidation(const json& root) {
+  auto self(shared_from_this());
+  std::string message_out;
+  TRY_READ_REQUEST(ReadSubscribeInvalidationRequest, root);
+  subscribed_.store(true);
+  WriteSubscribeInvalidationReply(message_out);
+  this->doWrite(message_out);
+  return false;
+}
+
+void SocketConnection::NotifyInvalidation(const std::string& message) {
+  if (subscribed_.load() && running_.load()) {
+    postWrite(message);
+  }
+}
+
+bool SocketConnection::doSubscribeObjects(const json& root) {
+  auto self(shared_from_this());
+  std::string type_pattern, name_prefix, message_out;
+  std::map<std::string, std::string> labels;
+  TRY_READ_REQUEST(ReadSubscribeObjectsRequest, root, type_pattern,
+                   name_prefix, labels);
+  if (objects_subscribed_.load()) {
+    RESPONSE_ON_ERROR(Status::Invalid(
+        "The connection has already subscribed the objects"));
+  }
+  subscribed_type_pattern_ = type_pattern;
+  subscribed_name_prefix_ = name_prefix;
+  subscribed_labels_ = labels;
+  objects_subscribed_.store(true);
+  WriteSubscribeObjectsReply(message_out);
+  this->doWrite(message_out);
+  return false;
+}
+
+void SocketConnection::NotifyObjects(const json& events) {
+  if (!objects_subscribed_.load() || !running_.load()) {
+    return;
+  }
+  json matched = json::array();
+  for (auto const& event : events) {
+    if (!subscribed_type_pattern_.empty() &&
+        fnmatch(subscribed_type_pattern_.c_str(),
+                event.value("typename", "").c_str(), 0) != 0) {
+      continue;
+    }
+    if (!subscribed_name_prefix_.empty() &&
+        event.value("name", "").compare(0, subscribed_name_prefix_.size(),
+                                        subscribed_name_prefix_) != 0) {
+      continue;
+    }
+    bool labeled = true;
+    if (!subscribed_labels_.empty()) {
+      auto labels = event.find("labels");
+      for (auto const& label : subscribed_labels_) {
+        if (labels == event.end() || !labels->contains(label.first) ||
+            (*labels)[label.first] != label.second) {
+          labeled = false;
+          break;
+        }
+      }
+    }
+    if (!labeled) {
+      continue;
+    }
+    json item = event;
+    item.erase("labels");
+    matched.push_back(std::move(item));
+  }
+  if (!matched.empty()) {
+    std::string message_out;
+    WriteObjectsNotification(matched, message_out);
+    postWrite(message_out);
+  }
+}
+
+void SocketConnection::postWrite(const std::string& message) {
+  auto self(shared_from_this());
+  asio::post(socket_.get_executor(), [self, message]() {
+    if (self->running_.load()) {
+      self->doWrite(message);
+    }
+  });
+}
+
+void SocketConnection::doRingLoop(std::shared_ptr<RingChannel> ring) {
+  auto self(shared_from_this());
+  std::atomic_store(&ring_, ring);
+  // a dedicated thread per connection, as waiting on the futex blocks.
+  std::thread([self, ring]() {
+    auto alive = [self]() { return self->running_.load(); };
+    std::string message_in;
+    while (self->running_.load()) {
+      if (!ring->requests().ReadMessage(message_in, alive).ok()) {
+        break;
+      }
+      self->received_ = trace::steady_clock_t::now();
+      auto delay = self->admitRequest();
+      if (delay.count() > 0) {
+        std::this_thread::sleep_for(delay);
+      }
+      bool exit = false;
+      {
+        // excludes the cleanup in `Stop()` that may run on the IO threads
+        std::lock_guard<std::recursive_mutex> lock(self->state_mutex_);
+        exit = self->processMessage(message_in);
+      }
+      if (exit) {
+        break;
+      }
+      self->waitPipeline();
+    }
+    self->doStop();
+  }).detach();
+}
+
 bool SocketConnection::doDebug(const json& root) {
+  auto self(shared_from_this());
+  json debug;
+  TRY_READ_REQUEST(ReadDebugRequest, root, debug);
   std::string message_out;
   json result;
+  if (debug.is_object() && debug.contains("traces")) {
+    // e.g., {"traces": {"limit": 100}}
+    size_t limit = std::numeric_limits<size_t>::max();
+    if (debug["traces"].is_object()) {
+      limit = debug["traces"].value("limit", limit);
+    }
+    trace::Tracer::Default().Dump(limit, result["traces"]);
+  }
+  if (debug.is_object() && debug.contains("allocator")) {
+    // e.g., {"allocator": {"options": "a", "chunks": true}}
+    std::string options;
+    bool chunks = false;
+    if (debug["allocator"].is_object()) {
+      options = debug["allocator"].value("options", options);
+      chunks = debug["allocator"].value("chunks", chunks);
+    }
+    BulkAllocator::Stats(options, chunks, result["allocator"]);
+  }
+  if (debug.is_object() && debug.contains("connections")) {
+    socket_server_ptr_->InspectConnections(result["connections"]);
+  }
+  if (debug.is_object() && debug.contains("streams")) {
+    server_ptr_->GetStreamStore()->Inspect(result["streams"]);
+  }
+  if (debug.is_object() && debug.contains("profile")) {
+    // e.g., {"profile": {"seconds": 30, "frequency": 99}}
+    int64_t seconds = 10, frequency = profiler::kDefaultFrequency;
+    std::string path;
+    if (debug["profile"].is_object()) {
+      seconds = debug["profile"].value("seconds", seconds);
+      frequency = debug["profile"].value("frequency", frequency);
+      path = debug["profile"].value("path", path);
+    }
+    // the session blocks, the reply is sent from a dedicated thread when the
+    // session finishes.
+    std::thread([self, seconds, frequency, path, result]() mutable {
+      std::string message_out;
+      auto status =
+          profiler::Profile(seconds, frequency, path, result["profile"]);
+      if (status.ok()) {
+        WriteDebugReply(result, message_out);
+      } else {
+        WriteErrorReply(status, message_out);
+      }
+      self->doWrite(message_out);
+    }).detach();
+    return false;
+  }
   WriteDebugReply(result, message_out);
   this->doWrite(message_out);
   return false;
 }
 
+void SocketConnection::Inspect(json& tree) {
+  tree["conn_id"] = conn_id_;
+  tree["running"] = running_.load();
+  {
+    std::lock_guard<std::recursive_mutex> scope_lock(write_msgs_mutex_);
+    size_t pending_bytes = 0;
+    for (auto const& message : write_msgs_) {
+      pending_bytes += message.size();
+    }
+    tree["pending_writes"] = write_msgs_.size();
+    tree["pending_write_bytes"] = pending_bytes;
+  }
+  {
+    std::lock_guard<std::mutex> lock(pipeline_mutex_);
+    tree["pipeline_request_id"] = pipeline_request_id_;
+    tree["pipeline_held"] = pipeline_held_;
+  }
+  {
+    std::lock_guard<std::mutex> lock(persisting_mutex_);
+    tree["persisting"] = persisting_.size();
+    tree["persisting_waiters"] = persisting_waiters_.size();
+  }
+  {
+    std::lock_guard<std::mutex> lock(snapshots_mutex_);
+    tree["snapshots"] = snapshots_.size();
+  }
+  tree["invalidation_subscribed"] = subscribed_.load();
+  tree["objects_subscribed"] = objects_subscribed_.load();
+}
+
+trace::trace_ptr_t SocketConnection::startTrace(const char* command) {
+  auto trace = trace::Tracer::Default().Start(conn_id_, command, received_);
+  std::atomic_store(&trace_, trace);
+  return trace;
+}
+
+trace::trace_ptr_t SocketConnection::takeTrace() {
+  if (!trace::Tracer::Default().Enabled()) {
+    return nullptr;
+  }
+  auto trace = std::atomic_exchange(&trace_, trace::trace_ptr_t());
+  if (trace) {
+    trace->Replied();
+  }
+  return trace;
+}
+
 void SocketConnection::doWrite(const std::string& buf) {
+  std::string tagged;
+  bool resume = false;
+  if (tagReply(buf, tagged, resume)) {
+    doWrite(tagged);
+    if (resume) {
+      doReadHeader();
+    }
+    return;
+  }
+  sentBytes().Add(buf.size());
+  auto trace = takeTrace();
+  if (std::atomic_load(&ring_)) {
+    doRingWrite(buf);
+    if (trace) {
+      trace->Add(trace::Phase::kWrite, trace::Since(trace->replied()));
+      trace->Done();
+    }
+    return;
+  }
   std::string to_send;
   size_t length = buf.size();
   to_send.resize(length + sizeof(size_t));
@@ -958,11 +2528,36 @@ void SocketConnection::doWrite(const std::string& buf) {
   {
     std::lock_guard<std::recursive_mutex> scoped_lock(write_msgs_mutex_);
     write_msgs_.push_back(std::move(to_send));
+    write_traces_.push_back(std::move(trace));
+    write_callbacks_.push_back(nullptr);
   }
   doAsyncWrite();
 }
 
 void SocketConnection::doWrite(const std::string& buf, callback_t<> callback) {
+  std::string tagged;
+  bool resume = false;
+  if (tagReply(buf, tagged, resume)) {
+    doWrite(tagged, callback);
+    if (resume) {
+      doReadHeader();
+    }
+    return;
+  }
+  sentBytes().Add(buf.size());
+  auto trace = takeTrace();
+  if (std::atomic_load(&ring_)) {
+    doRingWrite(buf);
+    if (trace) {
+      trace->Add(trace::Phase::kWrite, trace::Since(trace->replied()));
+      trace->Done();
+    }
+    auto status = callback(Status::OK());
+    if (!status.ok()) {
+      doStop();
+    }
+    return;
+  }
   std::string to_send;
   size_t length = buf.size();
   to_send.resize(length + sizeof(size_t));
@@ -973,18 +2568,33 @@ void SocketConnection::doWrite(const std::string& buf, callback_t<> callback) {
   {
     std::lock_guard<std::recursive_mutex> scoped_lock(write_msgs_mutex_);
     write_msgs_.push_back(std::move(to_send));
+    write_traces_.push_back(std::move(trace));
+    write_callbacks_.push_back(callback);
   }
-  doAsyncWrite(callback);
+  doAsyncWrite();
 }
 
 void SocketConnection::doWrite(std::string&& buf) {
+  sentBytes().Add(buf.size());
+  auto trace = takeTrace();
   {
     std::lock_guard<std::recursive_mutex> scoped_lock(write_msgs_mutex_);
     write_msgs_.push_back(std::move(buf));
+    write_traces_.push_back(std::move(trace));
+    write_callbacks_.push_back(nullptr);
   }
   doAsyncWrite();
 }
 
+void SocketConnection::doRingWrite(const std::string& buf) {
+  auto self(shared_from_this());
+  auto alive = [self]() { return self->running_.load(); };
+  auto ring = std::atomic_load(&ring_);
+  if (!ring->replies().WriteMessage(buf, alive).ok()) {
+    doStop();
+  }
+}
+
 void SocketConnection::doStop() {
   if (this->Stop()) {
     // drop connection
@@ -992,58 +2602,67 @@ void SocketConnection::doStop() {
   }
 }
 
-void SocketConnection::doAsyncWrite() {
-  std::shared_ptr<std::string> payload = nullptr;
-  {
-    std::lock_guard<std::recursive_mutex> scoped_lock(write_msgs_mutex_);
-    if (!write_msgs_.empty()) {
-      payload.reset(new std::string());
-      payload->swap(write_msgs_.front());
-      write_msgs_.pop_front();
+void SocketConnection::pinBlobs(
+    std::vector<std::shared_ptr<Payload>> const& objects) {
+  for (auto const& object : objects) {
+    if (object->data_size > 0 &&
+        pinned_blobs_.find(object->object_id) == pinned_blobs_.end()) {
+      if (server_ptr_->GetBulkStore()->Pin(object->object_id).ok()) {
+        pinned_blobs_.emplace(object->object_id);
+      }
     }
   }
-  if (payload == nullptr) {
-    return;
-  }
-  auto self(shared_from_this());
-  asio::async_write(
-      socket_, boost::asio::buffer(payload->data(), payload->length()),
-      [this, self, payload](boost::system::error_code ec, std::size_t) {
-        if (!ec) {
-          doAsyncWrite();
-        } else {
-          doStop();
-        }
-      });
 }
 
-void SocketConnection::doAsyncWrite(callback_t<> callback) {
+void SocketConnection::doAsyncWrite() {
   std::shared_ptr<std::string> payload = nullptr;
+  trace::trace_ptr_t trace = nullptr;
+  callback_t<> callback = nullptr;
   {
     std::lock_guard<std::recursive_mutex> scoped_lock(write_msgs_mutex_);
-    if (!write_msgs_.empty()) {
-      payload.reset(new std::string());
-      payload->swap(write_msgs_.front());
-      write_msgs_.pop_front();
+    // at most one write is in flight, the next one is started by the
+    // completion handler of the current one.
+    if (writing_ || write_msgs_.empty()) {
+      return;
     }
-  }
-  if (payload == nullptr) {
-    auto status = callback(Status::OK());
-    if (!status.ok()) {
-      doStop();
-    }
-    return;
+    writing_ = true;
+    payload.reset(new std::string());
+    payload->swap(write_msgs_.front());
+    write_msgs_.pop_front();
+    trace = std::move(write_traces_.front());
+    write_traces_.pop_front();
+    callback = std::move(write_callbacks_.front());
+    write_callbacks_.pop_front();
   }
   auto self(shared_from_this());
   asio::async_write(socket_,
                     boost::asio::buffer(payload->data(), payload->length()),
-                    [this, self, payload, callback](
+                    [this, self, payload, trace, callback](
                         boost::system::error_code ec, std::size_t) {
-                      if (!ec) {
-                        doAsyncWrite(callback);
-                      } else {
+                      if (trace) {
+                        trace->Add(trace::Phase::kWrite,
+                                   trace::Since(trace->replied()));
+                        trace->Done();
+                      }
+                      if (ec) {
                         doStop();
+                        return;
                       }
+                      // e.g., sending the fds after the reply, before the
+                      // next message.
+                      if (callback) {
+                        auto status = callback(Status::OK());
+                        if (!status.ok()) {
+                          doStop();
+                          return;
+                        }
+                      }
+                      {
+                        std::lock_guard<std::recursive_mutex> scoped_lock(
+                            write_msgs_mutex_);
+                        writing_ = false;
+                      }
+                      doAsyncWrite();
                     });
 }
 
@@ -1052,7 +2671,9 @@ SocketServer::SocketServer(vs_ptr_t vs_ptr)
 
 void SocketServer::Start() {
   stopped_.store(false);
-  doAccept();
+  for (unsigned int idx = 0; idx < vs_ptr_->GetConcurrency(); ++idx) {
+    doAccept();
+  }
 }
 
 void SocketServer::Stop() {
@@ -1060,38 +2681,98 @@ void SocketServer::Stop() {
     return;
   }
 
-  std::lock_guard<std::recursive_mutex> scope_lock(this->connections_mutex_);
-  std::vector<int> connection_ids_;
-  for (auto& pair : connections_) {
-    pair.second->Stop();
-  }
+  forEachConnection(
+      [](std::shared_ptr<SocketConnection> const& conn) { conn->Stop(); });
 }
 
 bool SocketServer::ExistsConnection(int conn_id) const {
-  std::lock_guard<std::recursive_mutex> scope_lock(this->connections_mutex_);
-  return connections_.find(conn_id) != connections_.end();
+  auto& shard = shardOf(conn_id);
+  std::lock_guard<std::recursive_mutex> scope_lock(shard.mutex);
+  return shard.connections.find(conn_id) != shard.connections.end();
 }
 
 void SocketServer::RemoveConnection(int conn_id) {
-  std::lock_guard<std::recursive_mutex> scope_lock(this->connections_mutex_);
-  auto conn = connections_.find(conn_id);
-  if (conn != connections_.end()) {
-    connections_.erase(conn);
+  auto& shard = shardOf(conn_id);
+  std::shared_ptr<SocketConnection> removed;
+  {
+    std::lock_guard<std::recursive_mutex> scope_lock(shard.mutex);
+    auto conn = shard.connections.find(conn_id);
+    if (conn != shard.connections.end()) {
+      removed = std::move(conn->second);
+      shard.connections.erase(conn);
+    }
   }
+  // the connection is destructed (if not referred anymore) out of the lock
 }
 
 void SocketServer::CloseConnection(int conn_id) {
-  std::lock_guard<std::recursive_mutex> scope_lock(this->connections_mutex_);
-  auto conn = connections_.find(conn_id);
-  if (conn != connections_.end()) {
-    conn->second->Stop();
-    connections_.erase(conn);
+  auto& shard = shardOf(conn_id);
+  std::shared_ptr<SocketConnection> closed;
+  {
+    std::lock_guard<std::recursive_mutex> scope_lock(shard.mutex);
+    auto conn = shard.connections.find(conn_id);
+    if (conn != shard.connections.end()) {
+      closed = std::move(conn->second);
+      shard.connections.erase(conn);
+    }
+  }
+  if (closed) {
+    closed->Stop();
   }
 }
 
 size_t SocketServer::AliveConnections() const {
-  std::lock_guard<std::recursive_mutex> scope_lock(this->connections_mutex_);
-  return connections_.size();
+  size_t alive = 0;
+  for (auto& shard : shards_) {
+    std::lock_guard<std::recursive_mutex> scope_lock(shard.mutex);
+    alive += shard.connections.size();
+  }
+  return alive;
+}
+
+void SocketServer::InspectConnections(json& tree) const {
+  std::vector<std::shared_ptr<SocketConnection>> connections;
+  forEachConnection([&](std::shared_ptr<SocketConnection> const& conn) {
+    connections.emplace_back(conn);
+  });
+  // n.b.: inspects outside the lock of shards
+  tree = json::array();
+  for (auto const& conn : connections) {
+    json entry;
+    conn->Inspect(entry);
+    tree.push_back(entry);
+  }
+}
+
+void SocketServer::startConnection(int conn_id,
+                                   std::shared_ptr<SocketConnection> conn) {
+  {
+    auto& shard = shardOf(conn_id);
+    std::lock_guard<std::recursive_mutex> scope_lock(shard.mutex);
+    shard.connections.emplace(conn_id, conn);
+  }
+  conn->Start();
+}
+
+void SocketServer::NotifyInvalidation(const std::vector<ObjectID>& ids,
+                                      const std::vector<std::string>& names) {
+  if (ids.empty() && names.empty()) {
+    return;
+  }
+  std::string message_out;
+  WriteInvalidationNotification(ids, names, message_out);
+  forEachConnection([&](std::shared_ptr<SocketConnection> const& conn) {
+    conn->NotifyInvalidation(message_out);
+  });
+}
+
+void SocketServer::NotifyObjects(const json& events) {
+  if (events.empty()) {
+    return;
+  }
+  forEachConnection([&](std::shared_ptr<SocketConnection> const& conn) {
+    conn->NotifyObjects(events);
+  });
 }
 
 }  // namespace vineyard
@@ -16,20 +16,28 @@ limitations under the License.
 #ifndef SRC_SERVER_ASYNC_SOCKET_SERVER_H_
 #define SRC_SERVER_ASYNC_SOCKET_SERVER_H_
 
+#include <array>
 #include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <deque>
+#include <map>
 #include <memory>
 #include <mutex>
+#include <set>
 #include <string>
 #include <unordered_map>
 #include <unordered_set>
+#include <utility>
 #include <vector>
 
 #include "boost/asio.hpp"
 
+#include "common/memory/ring_buffer.h"
 #include "common/util/protocols.h"
 #include "server/async/socket_server.h"
 #include "server/server/vineyard_server.h"
+#include "server/util/trace.h"
 
 namespace vineyard {
 
@@ -56,19 +64,66 @@ class SocketConnection : public std::enable_shared_from_this<SocketConnection> {
    */
   bool Stop();
 
+  /**
+   * @brief Push the invalidation notification to the client, if the
+   * connection has subscribed the invalidations.
+   */
+  void NotifyInvalidation(const std::string& message);
+
+  /**
+   * @brief Push the events of the objects that match the filter of the
+   * connection, if the connection has subscribed the objects.
+   */
+  void NotifyObjects(const json& events);
+
+  /**
+   * @brief Dump the states of the connection, i.e., the depth of the write
+   * queue and the pipeline, for debugging.
+   */
+  void Inspect(json& tree);
+
  protected:
   bool doRegister(const json& root);
 
   bool doGetBuffers(const json& root);
 
+  bool doGetBuffers(std::vector<ObjectID> const& ids, const bool binary);
+
   /**
    * @brief doGetRemoteBuffers differs from doGetRemoteBuffers, that the
    * content of blob is in the response body, rather than via memory sharing.
    */
   bool doGetRemoteBuffers(const json& root);
 
+  /**
+   * @brief doGetRemoteBufferChunks sends the requested byte ranges of blobs
+   * in the response body, to let clients stripe large blobs across multiple
+   * connections.
+   */
+  bool doGetRemoteBufferChunks(const json& root);
+
   bool doCreateBuffer(const json& root);
 
+  bool doCreateBuffer(const size_t size, int numa_node, const bool binary);
+
+  /**
+   * @brief Creates a blob in the device memory, which is shared with clients
+   * by the CUDA IPC memory handle in the payload rather than the fd.
+   */
+  bool doCreateDeviceBuffer(const size_t size, const int device);
+
+  /**
+   * @brief doCreateBuffers creates a batch of blobs in one round trip, the
+   * request either succeeds as a whole or fails without creating any blob.
+   */
+  bool doCreateBuffers(const json& root);
+
+  bool doExtendBuffer(const json& root);
+
+  bool doCopyBuffer(const json& root);
+
+  bool doCreateBufferFromFile(const json& root);
+
   /**
    * @brief doCreateBuffer differs from doCreateRemoteBuffer, that the content
    * of blob is in the request body, rather than via memory sharing.
@@ -77,14 +132,41 @@ class SocketConnection : public std::enable_shared_from_this<SocketConnection> {
 
   bool doDropBuffer(const json& root);
 
+  /**
+   * @brief doRelease unpins the blobs that previously mapped by this client,
+   * making them candidates for spilling and eviction.
+   */
+  bool doRelease(const json& root);
+
   bool doGetData(const json& root);
 
+  /**
+   * @brief Get the metadata of objects together with the payloads of their
+   * blobs that live on this instance.
+   */
+  bool doGetObjects(const json& root);
+
   bool doListData(const json& root);
 
+  bool doListObjects(const json& root);
+
+  /**
+   * @brief Run the handler of a long-running command on the bulk context of
+   * the server, to keep the IO workers responsive to the latency-critical
+   * commands (e.g., buffers and streams).
+   */
+  bool doBulk(const json& root, bool (SocketConnection::*handler)(const json&));
+
   bool doCreateData(const json& root);
 
   bool doPersist(const json& root);
 
+  /**
+   * @brief Wait for the asynchronous persisting of this connection, see also
+   * `WritePersistRequest`.
+   */
+  bool doWaitPersisted(const json& root);
+
   bool doIfPersist(const json& root);
 
   bool doExists(const json& root);
@@ -101,8 +183,30 @@ class SocketConnection : public std::enable_shared_from_this<SocketConnection> {
 
   bool doGetNextStreamChunk(const json& root);
 
+  bool doGetNextStreamChunk(const ObjectID stream_id, const size_t size,
+                            const bool binary);
+
   bool doPullNextStreamChunk(const json& root);
 
+  bool doPullNextStreamChunk(const ObjectID stream_id, const bool binary);
+
+  bool doGetNextStreamChunks(const ObjectID stream_id,
+                             const std::vector<size_t>& sizes);
+
+  bool doPutStreamChunks(
+      const ObjectID stream_id, std::shared_ptr<std::string> message,
+      const std::vector<std::pair<size_t, size_t>>& payloads);
+
+  bool doPullStreamChunks(const ObjectID stream_id, const size_t limit);
+
+  bool doSubscribeStream(const ObjectID stream_id, const size_t credits,
+                         const int64_t mode);
+
+  bool doStreamCredit(const ObjectID stream_id, const size_t credits);
+
+  // pushes the ready chunks of the subscribed stream, if there's credits
+  void pushStreamChunks();
+
   bool doStopStream(const json& root);
 
   bool doPutName(const json& root);
@@ -111,16 +215,60 @@ class SocketConnection : public std::enable_shared_from_this<SocketConnection> {
 
   bool doDropName(const json& root);
 
+  bool doPutNames(const json& root);
+
+  bool doGetNames(const json& root);
+
+  bool doDropNames(const json& root);
+
+  /**
+   * @brief The snapshots are released when the connection stops, if they
+   * haven't been released explicitly.
+   */
+  bool doCreateSnapshot(const json& root);
+
+  bool doReleaseSnapshot(const json& root);
+
+  bool doGossip(const json& root);
+
+  bool doBatch(const json& root);
+
   bool doMigrateObject(const json& root);
 
   bool doClusterMeta(const json& root);
 
   bool doInstanceStatus(const json& root);
 
+  bool doLocalityInfo(const json& root);
+
+  bool doPrefetch(const json& root);
+
+  bool doFootprints(const json& root);
+
   bool doMakeArena(const json& root);
 
   bool doFinalizeArena(const json& root);
 
+  bool doEnableRing(const json& root);
+
+  /**
+   * @brief Share the blob table of the bulk store, the fd is sent after the
+   * reply, see also `BulkStore::EnableBlobTable`.
+   */
+  bool doEnableBlobTable(const json& root);
+
+  /**
+   * @brief Subscribe the invalidations of metadata, used by the metadata
+   * cache on the client side.
+   */
+  bool doSubscribeInvalidation(const json& root);
+
+  /**
+   * @brief Subscribe the objects that are created or persisted in the
+   * cluster, see also `ObjectSubscription` on the client side.
+   */
+  bool doSubscribeObjects(const json& root);
+
   bool doDebug(const json& root);
 
  private:
@@ -134,16 +282,74 @@ class SocketConnection : public std::enable_shared_from_this<SocketConnection> {
    */
   bool processMessage(const std::string& message_in);
 
+  /**
+   * Handle the hot-path commands in binary messages, see also
+   * "common/util/binary_protocols.h".
+   */
+  bool processBinaryMessage(const std::string& message_in);
+
+  /**
+   * Start the trace of the request being dispatched, the trace is taken by
+   * the next reply written to the connection.
+   */
+  trace::trace_ptr_t startTrace(const char* command);
+
+  // takes the pending trace and marks it as replied.
+  trace::trace_ptr_t takeTrace();
+
   void doReadHeader();
 
   void doReadBody();
 
+  // processes the request in `read_msg_body_`, and continues reading.
+  void doProcessBody(const bool eof);
+
+  /**
+   * Returns how long the request should be delayed to keep the tenant of
+   * the connection under the rate quota, see also `Tenant::Admit`.
+   */
+  std::chrono::nanoseconds admitRequest();
+
+  /**
+   * Requests that carry a "request_id" are pipelined by the client, and the
+   * reply is tagged with the same id. Reading the next request is held until
+   * the current one has been replied, as the reply of asynchronous handlers
+   * must be tagged with the right id, and the replies remain in order.
+   *
+   * Returns true if the reading has been held, and will be resumed by the
+   * reply, see also `tagReply`.
+   */
+  bool holdPipeline();
+
+  // blocks until the current pipelined request has been replied, for
+  // requests that are read from the ring in a dedicated thread.
+  void waitPipeline();
+
+  // tags the reply of the pending pipelined request, and returns whether
+  // the reply has been tagged, `resume` indicates whether the reading
+  // should be resumed after the reply has been queued.
+  bool tagReply(const std::string& buf, std::string& tagged, bool& resume);
+
   void doWrite(const std::string& buf);
 
   void doWrite(std::string&& buf);
 
   void doWrite(const std::string& buf, callback_t<> callback);
 
+  /**
+   * Write the message from the connection's executor, for the pushes from
+   * other threads, e.g., the notifications from the meta context.
+   */
+  void postWrite(const std::string& message);
+
+  /**
+   * Serve requests from the shared memory ring in a dedicated thread, the
+   * socket is still used for passing fds and detecting the disconnection.
+   */
+  void doRingLoop(std::shared_ptr<RingChannel> ring);
+
+  void doRingWrite(const std::string& buf);
+
   /**
    * Being called when the encounter a socket error (in read/write), or by
    * external "conn->Stop()".
@@ -152,12 +358,43 @@ class SocketConnection : public std::enable_shared_from_this<SocketConnection> {
    */
   void doStop();
 
-  void doAsyncWrite();
+  /**
+   * Pin the blobs that will be mapped by the client, to avoid them being
+   * spilled or evicted while in use. Blobs are unpinned when the client
+   * releases them explicitly, or when the connection stops.
+   *
+   * The existing blobs are pinned by `BulkStore::Get` with `pinned_blobs_`
+   * instead, as they may have been spilled before pinning otherwise.
+   */
+  void pinBlobs(std::vector<std::shared_ptr<Payload>> const& objects);
+
+  /**
+   * Send the file descriptors of the given payloads that haven't been sent
+   * to the client yet, must be called after the reply has been written.
+   */
+  void sendFds(std::vector<std::shared_ptr<Payload>> const& objects);
 
-  void doAsyncWrite(callback_t<> callback);
+  /**
+   * The NUMA node of the client process, -1 if unknown or the NUMA-aware
+   * allocation is disabled.
+   */
+  int peerNumaNode();
+
+  /**
+   * Start writing the head of `write_msgs_`, unless a write is already in
+   * flight, and the messages are written one by one in order.
+   */
+  void doAsyncWrite();
 
   void sendBufferHelper(std::vector<std::shared_ptr<Payload>> const objects,
-                        size_t index, boost::system::error_code const ec,
+                        callback_t<> callback_after_finish);
+
+  /**
+   * Write the buffers in one (vectored) write, the `objects` are held until
+   * the write finishes.
+   */
+  void sendBufferHelper(std::vector<asio::const_buffer> const& buffers,
+                        std::vector<std::shared_ptr<Payload>> const objects,
                         callback_t<> callback_after_finish);
 
   stream_protocol::socket socket_;
@@ -168,11 +405,84 @@ class SocketConnection : public std::enable_shared_from_this<SocketConnection> {
 
   asio::streambuf buf_;
   socket_message_queue_t write_msgs_;
+  // the traces of the replies in `write_msgs_`, nullptr if not traced
+  std::deque<trace::trace_ptr_t> write_traces_;
+  // the callbacks after the messages in `write_msgs_` being written, nullptr
+  // if none
+  std::deque<callback_t<>> write_callbacks_;
+  // whether an `async_write` of the `write_msgs_` is in flight
+  bool writing_ = false;
   std::recursive_mutex write_msgs_mutex_;  // protect the write_msgs
 
+  // when the header of the current request arrived
+  trace::steady_clock_t::time_point received_;
+  // the trace of the request that hasn't been replied yet
+  trace::trace_ptr_t trace_;
+
+  // the pipelined request that hasn't been replied yet, see also
+  // `holdPipeline`.
+  std::mutex pipeline_mutex_;
+  std::condition_variable pipeline_cv_;
+  int64_t pipeline_request_id_ = -1;
+  bool pipeline_replied_ = false;
+  bool pipeline_held_ = false;
+
+  // guards the per-connection state that `Stop()` cleans up, e.g., the
+  // `pinned_blobs_` and `associated_streams_`, as the requests may be
+  // processed on the ring thread while `Stop()` runs on the IO threads.
+  std::recursive_mutex state_mutex_;
+
   std::unordered_set<int> used_fds_;
+  // the blobs that have been mapped by the client
+  std::unordered_set<ObjectID> pinned_blobs_;
+  // the blobs that have been created by the client, only which can be
+  // extended by the client, see also `doExtendBuffer`.
+  std::unordered_set<ObjectID> created_blobs_;
+  // the asynchronous persisting of the client: the tickets in flight, the
+  // failures that haven't been reported, and the waiters that wait for the
+  // tickets up to the given one, accessed on the meta context as well.
+  std::mutex persisting_mutex_;
+  uint64_t next_persisting_ = 1;
+  std::set<uint64_t> persisting_;
+  std::map<uint64_t, Status> persisting_failures_;
+  std::vector<std::pair<uint64_t, std::function<void(const Status&)>>>
+      persisting_waiters_;
+
+  // collects the waiters whose tickets have all finished, requires the
+  // `persisting_mutex_` been held.
+  void collectPersisted(
+      std::vector<std::pair<std::function<void(const Status&)>, Status>>&
+          finished);
+
+  // the metadata snapshots taken by the client, may be inserted on the meta
+  // context when being synced with the metadata service.
+  std::mutex snapshots_mutex_;
+  std::unordered_set<uint64_t> snapshots_;
+  // the NUMA node of the client, -2 means not resolved yet
+  int peer_numa_node_ = -2;
+  // the tenant that the connection is charged to, nullptr if the quotas
+  // are not enabled.
+  std::shared_ptr<Tenant> tenant_;
   // the associated reader of the stream
   std::unordered_set<ObjectID> associated_streams_;
+  // the shared memory ring for requests and replies, if enabled, accessed
+  // with `std::atomic_load/store` as it is set after the connection starts.
+  std::shared_ptr<RingChannel> ring_;
+  // whether the invalidations of metadata will be pushed to the connection.
+  std::atomic_bool subscribed_{false};
+  // the filter of the subscribed objects, immutable once
+  // `objects_subscribed_` is set.
+  std::string subscribed_type_pattern_;
+  std::string subscribed_name_prefix_;
+  std::map<std::string, std::string> subscribed_labels_;
+  std::atomic_bool objects_subscribed_{false};
+  // the stream whose chunks are pushed to the connection while the
+  // subscriber has credits, see also `doSubscribeStream`. The credits and
+  // the pulling state are updated by both the connection and the stream
+  // store (i.e., the callback of `Pull`).
+  ObjectID subscribed_stream_ = InvalidObjectID();
+  std::atomic<size_t> stream_credits_{0};
+  std::atomic_bool stream_pulling_{false};
 
   size_t read_msg_header_;
   std::string read_msg_body_;
@@ -216,15 +526,65 @@ class SocketServer {
    */
   size_t AliveConnections() const;
 
+  /**
+   * @brief Notify the subscribed connections that the metadata of given
+   * objects is no longer valid.
+   */
+  void NotifyInvalidation(const std::vector<ObjectID>& ids,
+                          const std::vector<std::string>& names);
+
+  /**
+   * @brief Push the events of the created (or persisted) objects to the
+   * connections that subscribe them.
+   */
+  void NotifyObjects(const json& events);
+
+  void InspectConnections(json& tree) const;
+
  protected:
+  int nextConnectionID() { return next_conn_id_.fetch_add(1); }
+
+  /**
+   * Register the accepted connection to the connection pool, then start
+   * serving it, as the connection may be removed once started.
+   */
+  void startConnection(int conn_id, std::shared_ptr<SocketConnection> conn);
+
   std::atomic_bool stopped_;  // if the socket server being stopped.
   vs_ptr_t vs_ptr_;
-  int next_conn_id_;
-  std::unordered_map<int, std::shared_ptr<SocketConnection>> connections_;
-  mutable std::recursive_mutex connections_mutex_;  // protect `connections_`
+  std::atomic<int> next_conn_id_;
 
  private:
+  /**
+   * Issue an accept that re-arms itself, a few accepts are in flight at the
+   * same time thus the connections can be set up on all IO threads.
+   */
   virtual void doAccept() = 0;
+
+  // the connection pool is sharded by the connection id, to avoid a global
+  // lock on the setup and teardown of short-lived connections.
+  static constexpr size_t kConnectionShards = 64;
+
+  struct connection_shard_t {
+    mutable std::recursive_mutex mutex;  // protect `connections`
+    std::unordered_map<int, std::shared_ptr<SocketConnection>> connections;
+  };
+
+  connection_shard_t& shardOf(int conn_id) const {
+    return shards_[static_cast<size_t>(conn_id) % kConnectionShards];
+  }
+
+  template <typename F>
+  void forEachConnection(F&& func) const {
+    for (auto& shard : shards_) {
+      std::lock_guard<std::recursive_mutex> scope_lock(shard.mutex);
+      for (auto& pair : shard.connections) {
+        func(pair.second);
+      }
+    }
+  }
+
+  mutable std::array<connection_shard_t, kConnectionShards> shards_;
 };
 
 }  // namespace vineyard
@@ -31,6 +31,12 @@ https://github.com/apache/arrow/blob/master/cpp/src/plasma/plasma_allocator.cc
 
 #include <stdio.h>
 
+#include <algorithm>
+#include <map>
+#include <string>
+
+#include "gflags/gflags.h"
+
 #include "common/util/env.h"
 #include "common/util/logging.h"
 #include "server/memory/malloc.h"
@@ -43,10 +49,15 @@ https://github.com/apache/arrow/blob/master/cpp/src/plasma/plasma_allocator.cc
 #include "server/memory/jemalloc.h"
 #endif
 
+DEFINE_int32(allocator_spaces, 1,
+             "The number of independent spaces that the shared memory is "
+             "divided into, allocations from different IPC threads are served "
+             "from different spaces without contending a single lock");
+
 namespace vineyard {
 
 int64_t BulkAllocator::footprint_limit_ = 0;
-int64_t BulkAllocator::allocated_ = 0;
+std::atomic<int64_t> BulkAllocator::allocated_{0};
 
 #if defined(WITH_JEMALLOC)
 BulkAllocator::Allocator BulkAllocator::allocator_{};
@@ -66,18 +77,23 @@ void* BulkAllocator::Init(const size_t size) {
 #endif
 }
 
-void* BulkAllocator::Memalign(const size_t bytes, const size_t alignment) {
-  if (allocated_ + static_cast<int64_t>(bytes) > footprint_limit_) {
+void* BulkAllocator::Memalign(const size_t bytes, const size_t alignment,
+                              const int numa_node) {
+  const int64_t reserved = static_cast<int64_t>(bytes);
+  if (allocated_.fetch_add(reserved) + reserved > footprint_limit_) {
+    allocated_ -= reserved;
     return nullptr;
   }
 
 #if defined(WITH_DLMALLOC)
-  void* mem = Allocator::Allocate(bytes, alignment);
+  void* mem = Allocator::Allocate(bytes, alignment, numa_node);
 #endif
 #if defined(WITH_JEMALLOC)
   void* mem = allocator_.Allocate(bytes, alignment);
 #endif
-  allocated_ += bytes;
+  if (mem == nullptr) {
+    allocated_ -= reserved;
+  }
   return mem;
 }
 
@@ -91,12 +107,87 @@ void BulkAllocator::Free(void* mem, size_t bytes) {
   allocated_ -= bytes;
 }
 
+bool BulkAllocator::ReallocateInPlace(void* mem, size_t bytes,
+                                      size_t new_bytes) {
+  if (new_bytes <= bytes) {
+    return true;
+  }
+  const int64_t reserved = static_cast<int64_t>(new_bytes - bytes);
+  if (allocated_.fetch_add(reserved) + reserved > footprint_limit_) {
+    allocated_ -= reserved;
+    return false;
+  }
+#if defined(WITH_DLMALLOC)
+  bool grown = Allocator::ReallocateInPlace(mem, new_bytes);
+#endif
+#if defined(WITH_JEMALLOC)
+  bool grown = allocator_.ReallocateInPlace(mem, new_bytes);
+#endif
+  if (!grown) {
+    allocated_ -= reserved;
+  }
+  return grown;
+}
+
+bool BulkAllocator::Inspect(visitor_t const& visitor) {
+#if defined(WITH_DLMALLOC)
+  Allocator::Inspect(visitor);
+  return true;
+#else
+  return false;
+#endif
+}
+
+void BulkAllocator::Stats(const std::string& options, const bool chunks,
+                          json& tree) {
+  tree["footprint_limit"] = footprint_limit_;
+  tree["allocated"] = allocated_.load();
+#if defined(WITH_DLMALLOC)
+  tree["allocator"] = "dlmalloc";
+  if (chunks) {
+    size_t used_chunks = 0, used_size = 0, free_ranges = 0, free_size = 0,
+           largest_free_size = 0;
+    // the number of free ranges that are smaller than 2^i bytes
+    std::map<size_t, size_t> free_histogram;
+    Allocator::Inspect([&](void*, size_t size, bool used) {
+      if (used) {
+        used_chunks += 1;
+        used_size += size;
+        return;
+      }
+      free_ranges += 1;
+      free_size += size;
+      largest_free_size = std::max(largest_free_size, size);
+      size_t bound = 1;
+      while (bound < size) {
+        bound <<= 1;
+      }
+      free_histogram[bound] += 1;
+    });
+    tree["used_chunks"] = used_chunks;
+    tree["used_size"] = used_size;
+    tree["free_ranges"] = free_ranges;
+    tree["free_size"] = free_size;
+    tree["largest_free_size"] = largest_free_size;
+    json histogram;
+    for (auto const& item : free_histogram) {
+      histogram[std::to_string(item.first)] = item.second;
+    }
+    tree["free_histogram"] = histogram;
+  }
+#endif
+#if defined(WITH_JEMALLOC)
+  tree["allocator"] = "jemalloc";
+  allocator_.Stats(options, tree);
+#endif
+}
+
 void BulkAllocator::SetFootprintLimit(size_t bytes) {
   footprint_limit_ = static_cast<int64_t>(bytes);
 }
 
 int64_t BulkAllocator::GetFootprintLimit() { return footprint_limit_; }
 
-int64_t BulkAllocator::Allocated() { return allocated_; }
+int64_t BulkAllocator::Allocated() { return allocated_.load(); }
 
 }  // namespace vineyard
@@ -29,8 +29,13 @@
 #ifndef SRC_SERVER_MEMORY_ALLOCATOR_H_
 #define SRC_SERVER_MEMORY_ALLOCATOR_H_
 
+#include <atomic>
 #include <cstddef>
 #include <cstdint>
+#include <functional>
+#include <string>
+
+#include "common/util/json.h"
 
 namespace vineyard {
 
@@ -49,8 +54,10 @@ class BulkAllocator {
   ///
   /// \param alignment Memory alignment.
   /// \param bytes Number of bytes.
+  /// \param numa_node The preferred NUMA node, -1 means no preference. Only
+  ///                  respected by the dlmalloc backend.
   /// \return Pointer to allocated memory.
-  static void* Memalign(size_t bytes, size_t alignment);
+  static void* Memalign(size_t bytes, size_t alignment, int numa_node = -1);
 
   /// Frees the memory space pointed to by mem, which must have been returned by
   /// a previous call to Memalign()
@@ -59,6 +66,33 @@ class BulkAllocator {
   /// \param bytes Number of bytes to be freed.
   static void Free(void* mem, size_t bytes);
 
+  /// Grows the memory space pointed to by mem in place, i.e., without moving
+  /// it, using the adjacent free space.
+  ///
+  /// \param mem Pointer to memory returned by a previous call to Memalign().
+  /// \param bytes The current number of bytes.
+  /// \param new_bytes The requested number of bytes.
+  /// \return Whether the memory space has been grown.
+  static bool ReallocateInPlace(void* mem, size_t bytes, size_t new_bytes);
+
+  using visitor_t = std::function<void(void* start, size_t size, bool used)>;
+
+  /// Visits the chunks in use and the free ranges of the allocator.
+  ///
+  /// \param visitor Receives the start address, the size and whether the
+  ///                chunk is in use.
+  /// \return false if the backend doesn't support it, i.e., jemalloc.
+  static bool Inspect(visitor_t const& visitor);
+
+  /// Dumps the statistics of the allocator for debugging.
+  ///
+  /// \param options The options of `malloc_stats_print` for jemalloc.
+  /// \param chunks Whether to walk the chunks to summarize the free ranges
+  ///               for dlmalloc, n.b., the allocations are blocked during
+  ///               the walking.
+  static void Stats(const std::string& options, const bool chunks,
+                    json& tree);
+
   /// Sets the memory footprint limit for Plasma.
   ///
   /// \param bytes Plasma memory footprint limit in bytes.
@@ -82,7 +116,9 @@ class BulkAllocator {
 #endif
 
  private:
-  static int64_t allocated_;
+  // n.b.: the allocations are served concurrently, the bytes are reserved
+  // before allocating to enforce the footprint limit globally.
+  static std::atomic<int64_t> allocated_;
   static int64_t footprint_limit_;
 
 #if defined(WITH_JEMALLOC)
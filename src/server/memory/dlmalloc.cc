@@ -30,6 +30,9 @@
 
 #include <stddef.h>
 
+#include <algorithm>
+#include <atomic>
+#include <mutex>
 #include <string>
 #include <vector>
 
@@ -38,6 +41,9 @@
 #include "common/util/logging.h"
 #include "server/memory/dlmalloc.h"
 #include "server/memory/malloc.h"
+#include "server/util/numa.h"
+
+DECLARE_int32(allocator_spaces);
 
 namespace vineyard {
 
@@ -54,7 +60,10 @@ int fake_munmap(void*, int64_t);
 #define HAVE_MORECORE 0
 #define DEFAULT_MMAP_THRESHOLD MAX_SIZE_T
 #define DEFAULT_GRANULARITY ((size_t) 128U * 1024U)
-#define USE_LOCKS 1 /* makes the dlmalloc thread safe (but is not scalable) */
+#define USE_LOCKS 1 /* makes the dlmalloc thread safe, one lock per mspace */
+#define MSPACES 1   /* per NUMA node mspaces */
+#define FOOTERS 1   /* makes `dlfree` works for chunks from mspaces */
+#define MALLOC_INSPECT_ALL 1 /* for the fragmentation stats and compaction */
 
 #include "dlmalloc/dlmalloc.c"  // NOLINT
 
@@ -66,6 +75,9 @@ int fake_munmap(void*, int64_t);
 #undef HAVE_MORECORE
 #undef DEFAULT_GRANULARITY
 #undef USE_LOCKS
+#undef MSPACES
+#undef FOOTERS
+#undef MALLOC_INSPECT_ALL
 
 // dlmalloc.c defined DEBUG which will conflict with ARROW_LOG(DEBUG).
 #ifdef DEBUG
@@ -80,14 +92,9 @@ constexpr int64_t kMmapRegionsGap = sizeof(size_t);
 
 constexpr int GRANULARITY_MULTIPLIER = 2;
 
-// Fine-grained control for whether we need pre-populate the shared memory.
-//
-// Usually it causes a long wait time at the start up, but it could improved
-// the performance of visiting shared memory.
-//
-// In cases that the startup time doesn't much matter, e.g., in kubernetes
-// environment, pre-populate will archive a win.
-DEFINE_bool(reserve_memory, false, "Pre-reserving enough memory pages");
+// The NUMA node that the segments created by fake_mmap should be placed on,
+// -1 means no preference.
+static thread_local int fake_mmap_numa_node = -1;
 
 static void* pointer_advance(void* p, ptrdiff_t n) {
   return (unsigned char*) p + n;
@@ -103,26 +110,32 @@ void* fake_mmap(size_t size) {
   // fake_mmap are never contiguous.
   size += kMmapRegionsGap;
 
-  int fd = create_buffer(size);
-  CHECK_GE(fd, 0) << "Failed to create buffer during mmap";
-  // MAP_POPULATE can be used to pre-populate the page tables for this memory
-  // region
-  // which avoids work when accessing the pages later. However it causes long
-  // pauses
-  // when mmapping the files. Only supported on Linux.
-
+  // n.b.: the pages are not populated here (e.g., by MAP_POPULATE) as it
+  // pauses in a single thread for large regions, the arena is pre-faulted by
+  // multiple threads after being initialized, see also
+  // `BulkStore::PreAllocate`.
+  //
+  // Segments for NUMA nodes are not pre-populated, as the memory policy only
+  // takes effect for pages that haven't been faulted in.
   int mmap_flag = MAP_SHARED;
-  if (FLAGS_reserve_memory) {
-#ifdef __linux__
-    mmap_flag |= MAP_POPULATE;
-#endif
-  }
 
-  void* pointer = mmap(NULL, size, PROT_READ | PROT_WRITE, mmap_flag, fd, 0);
+  int fd = -1;
+  int64_t page_size = 0;
+  void* pointer = mmap_buffer(size, mmap_flag, &fd, &page_size);
   if (pointer == MAP_FAILED) {
     LOG(ERROR) << "mmap failed with error: " << strerror(errno);
     return pointer;
   }
+  if (fake_mmap_numa_node != -1) {
+    auto status = numa::BindToNode(pointer, size, fake_mmap_numa_node);
+    if (!status.ok()) {
+      LOG(WARNING) << "Failed to place the segment on NUMA node "
+                   << fake_mmap_numa_node << ": " << status.ToString();
+    }
+  }
+
+  // n.b.: the spaces grow concurrently, each under its own lock.
+  std::lock_guard<std::mutex> guard(mmap_records_mutex);
 
   // Increase dlmalloc's allocation granularity directly.
   mparams.granularity *= GRANULARITY_MULTIPLIER;
@@ -130,6 +143,7 @@ void* fake_mmap(size_t size) {
   MmapRecord& record = mmap_records[pointer];
   record.fd = fd;
   record.size = size;
+  record.page_size = page_size;
 
   // We lie to dlmalloc about where mapped memory actually lives.
   pointer = pointer_advance(pointer, kMmapRegionsGap);
@@ -140,6 +154,7 @@ int fake_munmap(void* addr, int64_t size) {
   addr = pointer_retreat(addr, kMmapRegionsGap);
   size += kMmapRegionsGap;
 
+  std::lock_guard<std::mutex> guard(mmap_records_mutex);
   auto entry = mmap_records.find(addr);
 
   if (entry == mmap_records.end() || entry->second.size != size) {
@@ -148,7 +163,7 @@ int fake_munmap(void* addr, int64_t size) {
     return -1;
   }
 
-  int r = munmap(addr, size);
+  int r = munmap(addr, align_to_page_size(size, entry->second.page_size));
   if (r == 0) {
     close(entry->second.fd);
   }
@@ -157,23 +172,114 @@ int fake_munmap(void* addr, int64_t size) {
   return r;
 }
 
+std::vector<void*> DLmallocAllocator::mspaces_;
+std::vector<void*> DLmallocAllocator::spaces_;
+std::atomic<size_t> DLmallocAllocator::next_space_{0};
+
 void* DLmallocAllocator::Init(const size_t size) {
-  // We are using a single memory-mapped file by mallocing and freeing a single
-  // large amount of space up front.
-  void* pointer = dlmemalign(kBlockSize, size - 256 * sizeof(size_t));
-  if (pointer != nullptr) {
-    // This will unmap the file, but the next one created will be as large
-    // as this one (this is an implementation detail of dlmalloc).
-    dlfree(pointer);
+  ensure_initialization();
+  if (numa::Enabled()) {
+    // created up front, so that allocations won't need a lock to look up them
+    mspaces_.resize(numa::NodeCount(), nullptr);
+    for (int node = 0; node < numa::NodeCount(); ++node) {
+      fake_mmap_numa_node = node;
+      mspaces_[node] = create_mspace(0, 1);
+      fake_mmap_numa_node = -1;
+    }
+  }
+
+  size_t slice = size / std::max(FLAGS_allocator_spaces, 1);
+  slice = slice / kBlockSize * kBlockSize;
+  if (FLAGS_allocator_spaces <= 1 || slice < (1UL << 20)) {
+    // We are using a single memory-mapped file by mallocing and freeing a
+    // single large amount of space up front.
+    void* pointer = dlmemalign(kBlockSize, size - 256 * sizeof(size_t));
+    if (pointer != nullptr) {
+      // This will unmap the file, but the next one created will be as large
+      // as this one (this is an implementation detail of dlmalloc).
+      dlfree(pointer);
+    }
+    return pointer;
+  }
+
+  // Carve the single memory-mapped file into independent spaces, each of them
+  // has its own lock and never grows beyond its slice.
+  void* pointer = fake_mmap(size);
+  if (pointer == MAP_FAILED) {
+    return nullptr;
+  }
+  for (int index = 0; index < FLAGS_allocator_spaces; ++index) {
+    void* space =
+        create_mspace_with_base(pointer_advance(pointer, index * slice),
+                                slice, 1);
+    if (space == nullptr) {
+      LOG(WARNING) << "Failed to create the space " << index << " of "
+                   << slice << " bytes";
+      break;
+    }
+    mspace_set_footprint_limit(space, slice);
+    spaces_.emplace_back(space);
   }
   return pointer;
 }
 
-void* DLmallocAllocator::Allocate(const size_t bytes, const size_t alignment) {
+void* DLmallocAllocator::Allocate(const size_t bytes, const size_t alignment,
+                                  const int numa_node) {
+  if (numa_node >= 0 && numa_node < static_cast<int>(mspaces_.size()) &&
+      mspaces_[numa_node] != nullptr) {
+    fake_mmap_numa_node = numa_node;
+    void* pointer = mspace_memalign(mspaces_[numa_node], alignment, bytes);
+    fake_mmap_numa_node = -1;
+    return pointer;
+  }
+  if (spaces_.empty()) {
+    return dlmemalign(alignment, bytes);
+  }
+  // Each (IPC) thread is bound to a space in round-robin order, and borrows
+  // from the other spaces once its own space is exhausted.
+  static thread_local size_t bound = next_space_.fetch_add(1);
+  for (size_t index = 0; index < spaces_.size(); ++index) {
+    void* space = spaces_[(bound + index) % spaces_.size()];
+    if (void* pointer = mspace_memalign(space, alignment, bytes)) {
+      return pointer;
+    }
+  }
+  // larger than the free space of any single space, served by a new segment.
   return dlmemalign(alignment, bytes);
 }
 
-void DLmallocAllocator::Free(void* pointer, size_t) { dlfree(pointer); }
+void DLmallocAllocator::Free(void* pointer, size_t) {
+  // n.b.: with FOOTERS, `dlfree` finds the owner mspace of the chunk itself,
+  // and only the lock of that mspace is held.
+  dlfree(pointer);
+}
+
+bool DLmallocAllocator::ReallocateInPlace(void* pointer, const size_t bytes) {
+  // n.b.: with FOOTERS, the owner mspace of the chunk is found by itself.
+  return dlrealloc_in_place(pointer, bytes) == pointer;
+}
+
+static void inspect_chunk(void* start, void* end, size_t used, void* arg) {
+  auto const& visitor = *static_cast<DLmallocAllocator::visitor_t*>(arg);
+  if (used != 0) {
+    visitor(start, used, true);
+  } else {
+    visitor(start, static_cast<char*>(end) - static_cast<char*>(start), false);
+  }
+}
+
+void DLmallocAllocator::Inspect(visitor_t const& visitor) {
+  void* arg = const_cast<visitor_t*>(&visitor);
+  dlmalloc_inspect_all(inspect_chunk, arg);
+  for (void* space : spaces_) {
+    mspace_inspect_all(space, inspect_chunk, arg);
+  }
+  for (void* space : mspaces_) {
+    if (space != nullptr) {
+      mspace_inspect_all(space, inspect_chunk, arg);
+    }
+  }
+}
 
 void DLmallocAllocator::SetMallocGranularity(int value) {
   change_mparam(M_GRANULARITY, value);
@@ -18,6 +18,10 @@ limitations under the License.
 
 #if defined(WITH_DLMALLOC)
 
+#include <atomic>
+#include <functional>
+#include <vector>
+
 #include "common/util/status.h"
 
 namespace vineyard {
@@ -28,11 +32,39 @@ class DLmallocAllocator {
  public:
   static void* Init(const size_t size);
 
-  static void* Allocate(const size_t bytes, const size_t alignment);
+  /**
+   * Allocate from the mspace of the given NUMA node when NUMA-aware allocation
+   * is enabled, otherwise from the space bound to the calling thread (see also
+   * "--allocator_spaces").
+   */
+  static void* Allocate(const size_t bytes, const size_t alignment,
+                        const int numa_node = -1);
 
   static void Free(void* pointer, size_t = 0);
 
+  /**
+   * Grow the chunk in place using the adjacent free space, the chunk won't be
+   * moved.
+   */
+  static bool ReallocateInPlace(void* pointer, const size_t bytes);
+
+  using visitor_t = std::function<void(void* start, size_t size, bool used)>;
+
+  /**
+   * Visit the chunks in use (with the size of data) and the free ranges of
+   * all spaces. Each space is locked during its traversal, the visitor must
+   * not allocate from the spaces.
+   */
+  static void Inspect(visitor_t const& visitor);
+
   static void SetMallocGranularity(int value);
+
+ private:
+  // one mspace per NUMA node, created at `Init`.
+  static std::vector<void*> mspaces_;
+  // the slices of the pre-allocated segment, empty if there's only one space.
+  static std::vector<void*> spaces_;
+  static std::atomic<size_t> next_space_;
 };
 
 }  // namespace memory
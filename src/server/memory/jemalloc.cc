@@ -17,24 +17,38 @@ limitations under the License.
 
 #include <sys/mman.h>
 
+#include "gflags/gflags.h"
+
 #include "server/memory/jemalloc.h"
 #include "server/memory/malloc.h"
 
+DECLARE_int32(allocator_spaces);
+
 namespace vineyard {
 
 namespace memory {
 
 void* JemallocAllocator::Init(const size_t size) {
   // create memory using mmap
-  int fd = create_buffer(size);
-  void* space = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
-  if (space == nullptr) {
-    return space;
+  int fd = -1;
+  int64_t page_size = 0;
+  void* space = mmap_buffer(size, MAP_SHARED, &fd, &page_size);
+  if (space == MAP_FAILED) {
+    return nullptr;
   }
 
-  MmapRecord& record = mmap_records[space];
-  record.fd = fd;
-  record.size = size;
+  {
+    std::lock_guard<std::mutex> guard(mmap_records_mutex);
+    MmapRecord& record = mmap_records[space];
+    record.fd = fd;
+    record.size = size;
+    record.page_size = page_size;
+  }
+
+  if (FLAGS_allocator_spaces > 1) {
+    // the arena is shared, but each (IPC) thread allocates from its own cache
+    EnableThreadCache();
+  }
 
   return Jemalloc::Init(space, size);
 }
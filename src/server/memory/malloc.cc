@@ -29,10 +29,17 @@
 #include "server/memory/malloc.h"
 
 #include <stddef.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
 
+#include <fstream>
+#include <limits>
 #include <string>
 #include <vector>
 
+#include "gflags/gflags.h"
+
 #include "common/util/logging.h"
 
 namespace vineyard {
@@ -40,6 +47,7 @@ namespace vineyard {
 namespace memory {
 
 std::unordered_map<void*, MmapRecord> mmap_records;
+std::mutex mmap_records_mutex;
 
 static void* pointer_advance(void* p, ptrdiff_t n) {
   return (unsigned char*) p + n;
@@ -91,10 +99,105 @@ int create_buffer(int64_t size) {
   return fd;
 }
 
+// Backing the shared memory with huge pages reduces the TLB misses when
+// scanning large blobs, but requires the huge pages being reserved in the
+// system (e.g., via "/proc/sys/vm/nr_hugepages").
+DEFINE_bool(reserve_memory_hugepages, false,
+            "Backing the shared memory with huge pages if available");
+DEFINE_int64(hugepage_size, 0,
+             "The size of huge pages to use (e.g., 2097152 for 2M pages and "
+             "1073741824 for 1G pages), 0 means using the system default");
+
+#if defined(__linux__)
+#ifndef MFD_CLOEXEC
+#define MFD_CLOEXEC 0x0001U
+#endif
+#ifndef MFD_HUGETLB
+#define MFD_HUGETLB 0x0004U
+#endif
+#ifndef MFD_HUGE_SHIFT
+#define MFD_HUGE_SHIFT 26
+#endif
+#endif
+
+// Read the default huge page size from "/proc/meminfo", returns 0 if huge
+// pages are not supported.
+static int64_t default_hugepage_size() {
+  std::ifstream meminfo("/proc/meminfo");
+  std::string key;
+  while (meminfo >> key) {
+    if (key == "Hugepagesize:") {
+      int64_t size_in_kb = 0;
+      meminfo >> size_in_kb;
+      return size_in_kb * 1024;
+    }
+    meminfo.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+  }
+  return 0;
+}
+
+int create_hugepage_buffer(int64_t size, int64_t* page_size) {
+#if defined(__linux__) && defined(SYS_memfd_create)
+  int64_t hugepage_size =
+      FLAGS_hugepage_size > 0 ? FLAGS_hugepage_size : default_hugepage_size();
+  if (hugepage_size <= 0 || (hugepage_size & (hugepage_size - 1)) != 0) {
+    return -1;
+  }
+  unsigned int flags = MFD_CLOEXEC | MFD_HUGETLB;
+  if (FLAGS_hugepage_size > 0) {
+    flags |= static_cast<unsigned int>(__builtin_ctzll(hugepage_size))
+             << MFD_HUGE_SHIFT;
+  }
+  int fd = static_cast<int>(syscall(SYS_memfd_create, "vineyard-bulk", flags));
+  if (fd < 0) {
+    return -1;
+  }
+  if (ftruncate(fd, (off_t) align_to_page_size(size, hugepage_size)) != 0) {
+    close(fd);
+    return -1;
+  }
+  *page_size = hugepage_size;
+  return fd;
+#else
+  return -1;
+#endif
+}
+
+void* mmap_buffer(int64_t size, int mmap_flag, int* fd, int64_t* page_size) {
+  if (FLAGS_reserve_memory_hugepages) {
+    *fd = create_hugepage_buffer(size, page_size);
+    if (*fd != -1) {
+      // mmap on hugetlbfs fails when there's no enough free huge pages.
+      void* pointer =
+          mmap(NULL, align_to_page_size(size, *page_size),
+               PROT_READ | PROT_WRITE, mmap_flag | MAP_SHARED, *fd, 0);
+      if (pointer != MAP_FAILED) {
+        return pointer;
+      }
+      close(*fd);
+    }
+    LOG(WARNING) << "Huge pages are not available for " << size
+                 << " bytes, fallback to normal pages";
+  }
+  *page_size = 0;
+  *fd = create_buffer(size);
+  if (*fd < 0) {
+    return MAP_FAILED;
+  }
+  void* pointer = mmap(NULL, size, PROT_READ | PROT_WRITE,
+                       mmap_flag | MAP_SHARED, *fd, 0);
+  if (pointer == MAP_FAILED) {
+    close(*fd);
+    *fd = -1;
+  }
+  return pointer;
+}
+
 void GetMallocMapinfo(void* addr, int* fd, int64_t* map_size,
                       ptrdiff_t* offset) {
   // About the efficiences: the records size usually small, thus linear search
   // is enough.
+  std::lock_guard<std::mutex> guard(mmap_records_mutex);
   for (const auto& entry : mmap_records) {
     if (addr >= entry.first &&
         addr < pointer_advance(entry.first, entry.second.size)) {
@@ -111,6 +214,16 @@ void GetMallocMapinfo(void* addr, int* fd, int64_t* map_size,
   *offset = 0;
 }
 
+int64_t GetMallocPageSize(int fd) {
+  std::lock_guard<std::mutex> guard(mmap_records_mutex);
+  for (const auto& entry : mmap_records) {
+    if (entry.second.fd == fd) {
+      return entry.second.page_size;
+    }
+  }
+  return 0;
+}
+
 }  // namespace memory
 
 }  // namespace vineyard
@@ -32,6 +32,7 @@
 #include <inttypes.h>
 #include <stddef.h>
 
+#include <mutex>
 #include <unordered_map>
 
 namespace vineyard {
@@ -44,9 +45,14 @@ constexpr int64_t kBlockSize = 64;
 void GetMallocMapinfo(void* addr, int* fd, int64_t* map_length,
                       ptrdiff_t* offset);
 
+/// Get the page size of the memory segment that associated with the given fd,
+/// 0 means the segment is backed by normal pages.
+int64_t GetMallocPageSize(int fd);
+
 struct MmapRecord {
   int fd = -1;
   int64_t size = -1;
+  int64_t page_size = 0;
 };
 
 /// Hashtable that contains one entry per segment that we got from the OS
@@ -54,12 +60,39 @@ struct MmapRecord {
 /// and size.
 extern std::unordered_map<void*, MmapRecord> mmap_records;
 
+/// Guards `mmap_records`, as segments may be mapped by the concurrent
+/// allocations.
+extern std::mutex mmap_records_mutex;
+
 // Create a buffer. This is creating a temporary file and then
 // immediately unlinking it so we do not leave traces in the system.
 //
 // Returns a fd as expected.
 int create_buffer(int64_t size);
 
+// Create a buffer that backed by huge pages (hugetlbfs), the `page_size` will
+// be set as the size of huge pages.
+//
+// Returns -1 if huge pages are not available.
+int create_hugepage_buffer(int64_t size, int64_t* page_size);
+
+// Create a buffer and mmap it into the address space, with the given extra
+// mmap flags (e.g., MAP_POPULATE). When "--reserve_memory_hugepages" is
+// enabled the buffer will be backed by huge pages if possible, and falls back
+// to normal pages otherwise.
+//
+// Returns the mapped pointer, or MAP_FAILED on failure, the created fd and the
+// page size (0 for normal pages) will be returned as well. The mapped length
+// is `size` rounded up to the page size.
+void* mmap_buffer(int64_t size, int mmap_flag, int* fd, int64_t* page_size);
+
+inline int64_t align_to_page_size(int64_t size, int64_t page_size) {
+  if (page_size <= 0) {
+    return size;
+  }
+  return (size + page_size - 1) / page_size * page_size;
+}
+
 }  // namespace memory
 
 }  // namespace vineyard
@@ -28,21 +28,36 @@
 
 #include "server/memory/memory.h"
 
+#include <fcntl.h>
 #include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 #include <algorithm>
+#include <cstring>
+#include <functional>
 #include <limits>
 #include <map>
 #include <memory>
+#include <set>
 #include <string>
+#include <utility>
 #include <vector>
 
+#include "common/memory/checksum.h"
+#include "common/memory/cuda.h"
+#include "common/memory/memcpy.h"
 #include "server/memory/allocator.h"
 #include "server/memory/malloc.h"
+#include "server/util/metrics.h"
+#include "server/util/numa.h"
+#include "server/util/snapshot.h"
+#include "server/util/spill_file.h"
 
 namespace vineyard {
 
 using memory::GetMallocMapinfo;
+using memory::GetMallocPageSize;
 using memory::kBlockSize;
 
 namespace memory {
@@ -127,19 +142,87 @@ static void recycle_arena(const uintptr_t base, const size_t size,
 }  // namespace memory
 
 std::set<ObjectID> BulkStore::Arena::spans{};
+std::mutex BulkStore::Arena::spans_mutex;
 
 BulkStore::~BulkStore() {
+  prefaulter_.Stop();
+  {
+    std::lock_guard<std::mutex> lock(compact_mutex_);
+    compact_stopped_ = true;
+  }
+  compact_cv_.notify_all();
+  if (compactor_.joinable()) {
+    compactor_.join();
+  }
+  {
+    std::lock_guard<std::mutex> lock(upload_mutex_);
+    upload_stopped_ = true;
+  }
+  upload_cv_.notify_all();
+  if (uploader_.joinable()) {
+    uploader_.join();
+  }
+  {
+    std::lock_guard<std::mutex> lock(seal_mutex_);
+    seal_stopped_ = true;
+  }
+  seal_cv_.notify_all();
+  if (sealer_.joinable()) {
+    sealer_.join();
+  }
+  // keep the copies in the backing store for the next start
+  backing_store_.reset();
+  if (!snapshot_path_.empty()) {
+    auto status = SaveSnapshot(snapshot_path_);
+    if (!status.ok()) {
+      LOG(ERROR) << "Failed to save the snapshot to '" << snapshot_path_
+                 << "': " << status.ToString();
+    }
+  }
   std::vector<ObjectID> object_ids;
   object_ids.reserve(objects_.size());
   for (auto iter = objects_.begin(); iter != objects_.end(); iter++) {
     object_ids.emplace_back(iter->first);
   }
-  for (auto const& item : object_ids) {
-    VINEYARD_DISCARD(Delete(item));
+  VINEYARD_DISCARD(
+      Delete(std::set<ObjectID>(object_ids.begin(), object_ids.end())));
+  {
+    std::lock_guard<std::mutex> lock(recycle_mutex_);
+    recycle_stopped_ = true;
+  }
+  recycle_cv_.notify_all();
+  if (recycler_.joinable()) {
+    recycler_.join();
+  }
+  for (auto const& file : file_mappings_) {
+    munmap(file.second.base, file.second.size);
+    close(file.first);
+  }
+  if (placeholder_fd_ != -1) {
+    close(placeholder_fd_);
+  }
+  if (snapshot_base_ != nullptr) {
+    munmap(snapshot_base_, snapshot_size_);
+  }
+  if (snapshot_fd_ != -1) {
+    close(snapshot_fd_);
+  }
+  blob_table_.reset();
+  if (blob_table_fd_ != -1) {
+    close(blob_table_fd_);
   }
 }
 
-Status BulkStore::PreAllocate(const size_t size) {
+Status BulkStore::PreAllocate(const size_t size, const std::string& spill_path,
+                              const bool lru_eviction,
+                              const size_t slab_max_size) {
+  if (!spill_path.empty()) {
+    RETURN_ON_ERROR(spill::InitSpillDirectory(spill_path));
+    spill_path_ = spill_path;
+    LOG(INFO) << "Cold blobs will be spilled to '" << spill_path_ << "'";
+  }
+  lru_eviction_ = lru_eviction;
+  slab_.Init(slab_max_size);
   BulkAllocator::SetFootprintLimit(size);
   void* pointer = BulkAllocator::Init(size);
 
@@ -155,45 +238,255 @@ Status BulkStore::PreAllocate(const size_t size) {
   int64_t map_size = 0;
   ptrdiff_t offset = 0;
   GetMallocMapinfo(pointer, &fd, &map_size, &offset);
-  objects_.emplace(
-      object_id,
+  auto payload =
       std::make_shared<Payload>(object_id, size, static_cast<uint8_t*>(pointer),
-                                fd, map_size, offset));
+                                fd, map_size, offset);
+  payload->page_size = GetMallocPageSize(fd);
+  objects_.emplace(object_id, payload);
+  if (memory::Prefaulter::Enabled()) {
+    prefaulter_.Start(pointer, size, payload->page_size);
+  }
   return Status::OK();
 }
 
 // Allocate memory
 uint8_t* BulkStore::AllocateMemory(size_t size, int* fd, int64_t* map_size,
-                                   ptrdiff_t* offset) {
+                                   ptrdiff_t* offset, int numa_node) {
   // Try to evict objects until there is enough space.
   uint8_t* pointer = nullptr;
-  pointer =
-      reinterpret_cast<uint8_t*>(BulkAllocator::Memalign(size, kBlockSize));
+  if (slab_.Handles(size)) {
+    // n.b.: small blobs are placed regardless of the NUMA preference
+    pointer = reinterpret_cast<uint8_t*>(slab_.Allocate(size));
+  } else {
+    pointer = reinterpret_cast<uint8_t*>(
+        BulkAllocator::Memalign(size, kBlockSize, numa_node));
+  }
   if (pointer) {
     GetMallocMapinfo(pointer, fd, map_size, offset);
   }
   return pointer;
 }
 
+void BulkStore::FreeMemory(uint8_t* pointer, size_t size) {
+  if (slab_.Handles(size)) {
+    slab_.Free(pointer, size);
+  } else {
+    BulkAllocator::Free(pointer, size);
+  }
+}
+
+memory::SlabAllocator::Stats BulkStore::SlabStats() const {
+  return slab_.GetStats();
+}
+
+uint8_t* BulkStore::AllocateMemoryWithSpill(size_t size, int* fd,
+                                            int64_t* map_size,
+                                            ptrdiff_t* offset, int numa_node) {
+  uint8_t* pointer = AllocateMemory(size, fd, map_size, offset, numa_node);
+  // n.b.: freed space may be fragmented, thus we retry after each spill.
+  while (pointer == nullptr && (SpillColdObject() || EvictColdObject())) {
+    pointer = AllocateMemory(size, fd, map_size, offset, numa_node);
+  }
+  return pointer;
+}
+
+bool BulkStore::EvictColdObject() {
+  if (!lru_eviction_) {
+    return false;
+  }
+  for (auto iter = lru_.rbegin(); iter != lru_.rend(); ++iter) {
+    std::shared_ptr<Payload> object;
+    {
+      object_map_t::const_accessor accessor;
+      if (!objects_.find(accessor, *iter)) {
+        continue;
+      }
+      object = accessor->second;
+    }
+    // n.b.: the members of objects are never evicted, as the metadata that
+    // refers them would become dangling.
+    if (object->is_persisted || object->is_spilled || object->is_sealed ||
+        object->ref_cnt > 0 ||
+        Arena::Contains(object->object_id)) {
+      continue;
+    }
+    ObjectID object_id = object->object_id;
+    // n.b.: the `lru_` will be modified by `Delete`.
+    if (!Delete(object_id).ok()) {
+      return false;
+    }
+    evicted_objects_ += 1;
+#ifndef NDEBUG
+    VLOG(10) << "after evict: " << ObjectIDToString(object_id) << ": "
+             << Footprint() << "(" << FootprintLimit() << ")";
+#endif
+    return true;
+  }
+  return false;
+}
+
+bool BulkStore::SpillColdObject() {
+  if (spill_path_.empty()) {
+    return false;
+  }
+  for (auto iter = lru_.rbegin(); iter != lru_.rend(); ++iter) {
+    std::shared_ptr<Payload> object;
+    {
+      object_map_t::const_accessor accessor;
+      if (!objects_.find(accessor, *iter)) {
+        continue;
+      }
+      object = accessor->second;
+    }
+    // blobs in arenas (or the snapshot) don't take the space of the heap
+    if (!object->is_persisted || object->is_spilled || object->ref_cnt > 0 ||
+        object->arena_fd != -1 || IsShared(object)) {
+      continue;
+    }
+    auto status = spill::SpillToFile(spill_path_, object->object_id,
+                                     object->pointer, object->data_size);
+    if (!status.ok()) {
+      LOG(ERROR) << "Failed to spill blob "
+                 << ObjectIDToString(object->object_id) << ": "
+                 << status.ToString();
+      return false;
+    }
+    ForgetDigest(object);
+    FreeMemory(object->pointer, object->data_size);
+    object->pointer = nullptr;
+    object->is_spilled = true;
+    spilled_objects_ += 1;
+    spilled_size_ += object->data_size;
+    ForgetObject(object->object_id);
+#ifndef NDEBUG
+    VLOG(10) << "after spill: " << ObjectIDToString(object->object_id) << ": "
+             << Footprint() << "(" << FootprintLimit() << ")";
+#endif
+    return true;
+  }
+  return false;
+}
+
+Status BulkStore::ReloadColdObject(const std::shared_ptr<Payload>& object) {
+  std::lock_guard<std::recursive_mutex> guard(spill_mutex_);
+  if (!object->is_spilled) {
+    // has been reloaded by others
+    return Status::OK();
+  }
+  int fd = -1;
+  int64_t map_size = 0;
+  ptrdiff_t offset = 0;
+  uint8_t* pointer =
+      AllocateMemoryWithSpill(object->data_size, &fd, &map_size, &offset);
+  if (pointer == nullptr) {
+    return Status::NotEnoughMemory("Failed to reload spilled blob " +
+                                   ObjectIDToString(object->object_id) +
+                                   ", size = " +
+                                   std::to_string(object->data_size));
+  }
+  auto status = spill::ReloadFromFile(spill_path_, object->object_id, pointer,
+                                      object->data_size);
+  if (!status.ok()) {
+    FreeMemory(pointer, object->data_size);
+    return status;
+  }
+  VINEYARD_SUPPRESS(spill::RemoveSpillFile(spill_path_, object->object_id));
+  object->pointer = pointer;
+  object->store_fd = fd;
+  object->map_size = map_size;
+  object->page_size = GetMallocPageSize(fd);
+  object->numa_node = -1;
+  object->data_offset = offset;
+  object->is_spilled = false;
+  spilled_objects_ -= 1;
+  spilled_size_ -= object->data_size;
+  TouchObject(object->object_id);
+  return Status::OK();
+}
+
+void BulkStore::TouchObject(const ObjectID id) {
+  if (!reclaimable()) {
+    return;
+  }
+  auto iter = lru_index_.find(id);
+  if (iter != lru_index_.end()) {
+    lru_.splice(lru_.begin(), lru_, iter->second);
+  } else {
+    lru_.push_front(id);
+    lru_index_.emplace(id, lru_.begin());
+  }
+}
+
+void BulkStore::ForgetObject(const ObjectID id) {
+  auto iter = lru_index_.find(id);
+  if (iter != lru_index_.end()) {
+    lru_.erase(iter->second);
+    lru_index_.erase(iter);
+  }
+}
+
 Status BulkStore::Create(const size_t data_size, ObjectID& object_id,
-                         std::shared_ptr<Payload>& object) {
+                         std::shared_ptr<Payload>& object, int numa_node,
+                         const std::shared_ptr<Tenant>& tenant) {
   if (data_size == 0) {
     object_id = EmptyBlobID();
     object = Payload::MakeEmpty();
     return Status::OK();
   }
+  if (tenant) {
+    RETURN_ON_ERROR(tenant->Charge(data_size));
+  }
+  static metrics::Histogram& blob_sizes =
+      metrics::Registry::Default().GetHistogram(
+          "vineyard_blob_size_bytes", "The size of created blobs, in bytes");
+  blob_sizes.Observe(data_size);
   int fd = -1;
   int64_t map_size = 0;
   ptrdiff_t offset = 0;
   uint8_t* pointer = nullptr;
-  pointer = AllocateMemory(data_size, &fd, &map_size, &offset);
+  if (!numa::Enabled()) {
+    numa_node = -1;
+  }
+  pointer = AllocateMemory(data_size, &fd, &map_size, &offset, numa_node);
+  if (pointer == nullptr && numa_node != -1) {
+    // fallback to the default arena if the node's arena cannot grow
+    numa_node = -1;
+    pointer = AllocateMemory(data_size, &fd, &map_size, &offset);
+  }
+  if (pointer == nullptr && reclaimable()) {
+    std::lock_guard<std::recursive_mutex> guard(spill_mutex_);
+    pointer = AllocateMemoryWithSpill(data_size, &fd, &map_size, &offset);
+  }
   if (pointer == nullptr) {
+    if (tenant) {
+      tenant->Refund(data_size);
+    }
     return Status::NotEnoughMemory("size = " + std::to_string(data_size));
   }
   object_id = GenerateBlobID(pointer);
   object = std::make_shared<Payload>(object_id, data_size, pointer, fd,
                                      map_size, offset);
-  objects_.emplace(object_id, object);
+  object->page_size = GetMallocPageSize(fd);
+  object->numa_node = numa_node;
+  // n.b.: a relocated blob may still take the address as its id, see also
+  // `Compact`.
+  while (!objects_.emplace(object_id, object)) {
+    object_id += 1;
+    object->object_id = object_id;
+  }
+  PublishObject(object);
+  allocations_ += 1;
+  if (tenant) {
+    std::lock_guard<std::mutex> lock(owners_mutex_);
+    owners_[object_id] = std::make_pair(tenant, data_size);
+  }
+  {
+    std::lock_guard<std::recursive_mutex> guard(spill_mutex_);
+    if (object_id != GenerateBlobID(pointer)) {
+      relocated_[reinterpret_cast<uintptr_t>(pointer)] = object_id;
+    }
+    TouchObject(object_id);
+  }
 #ifndef NDEBUG
   VLOG(10) << "after allocate: " << ObjectIDToString(object_id) << ": "
            << Footprint() << "(" << FootprintLimit() << ")";
@@ -201,18 +494,271 @@ Status BulkStore::Create(const size_t data_size, ObjectID& object_id,
   return Status::OK();
 }
 
+Status BulkStore::CreateDevice(const size_t size, const int device,
+                               ObjectID& object_id,
+                               std::shared_ptr<Payload>& object) {
+  if (size == 0) {
+    object_id = EmptyBlobID();
+    object = Payload::MakeEmpty();
+    return Status::OK();
+  }
+  void* pointer = nullptr;
+  std::string handle;
+  RETURN_ON_ERROR(memory::cuda_malloc(device, size, &pointer, handle));
+  object_id = GenerateBlobID(pointer);
+  object = std::make_shared<Payload>(object_id, size,
+                                     reinterpret_cast<uint8_t*>(pointer), -1,
+                                     0, 0);
+  object->device = device;
+  object->ipc_handle = handle;
+  // the device address space may overlap with the ids of host blobs
+  while (!objects_.emplace(object_id, object)) {
+    object_id += 1;
+    object->object_id = object_id;
+  }
+  device_footprint_ += size;
+  return Status::OK();
+}
+
+Status BulkStore::CreateFromFile(const std::string& path, const size_t offset,
+                                 const int64_t length,
+                                 const credentials::Credentials& peer,
+                                 ObjectID& object_id,
+                                 std::shared_ptr<Payload>& object) {
+  int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd == -1) {
+    return Status::IOError("Failed to open '" + path +
+                           "': " + strerror(errno));
+  }
+  // the server may be more privileged than the client
+  auto status = credentials::CheckReadable(peer, fd);
+  if (!status.ok()) {
+    close(fd);
+    return status;
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+    close(fd);
+    return Status::Invalid("Not a regular file: '" + path + "'");
+  }
+  size_t file_size = static_cast<size_t>(st.st_size);
+  size_t size = length < 0 ? file_size - std::min(offset, file_size)
+                           : static_cast<size_t>(length);
+  if (offset > file_size || size > file_size - offset) {
+    close(fd);
+    return Status::Invalid("The range [" + std::to_string(offset) + ", " +
+                           std::to_string(offset + size) +
+                           ") is out of the file '" + path + "' of " +
+                           std::to_string(file_size) + " bytes");
+  }
+  if (size == 0) {
+    close(fd);
+    object_id = EmptyBlobID();
+    object = Payload::MakeEmpty();
+    return Status::OK();
+  }
+
+  MappedFile file;
+  {
+    std::lock_guard<std::mutex> lock(files_mutex_);
+    int64_t mtime = static_cast<int64_t>(st.st_mtim.tv_sec) * 1000000000 +
+                    st.st_mtim.tv_nsec;
+    auto key = std::make_pair(static_cast<uint64_t>(st.st_dev),
+                              static_cast<uint64_t>(st.st_ino));
+    auto iter = files_.find(key);
+    if (iter != files_.end() &&
+        file_mappings_.at(iter->second).size == file_size &&
+        file_mappings_.at(iter->second).mtime == mtime) {
+      close(fd);
+      fd = iter->second;
+    } else {
+      if (placeholder_fd_ == -1) {
+        placeholder_fd_ = open("/dev/null", O_RDONLY | O_CLOEXEC);
+      }
+      void* base = mmap(nullptr, file_size, PROT_READ, MAP_SHARED, fd, 0);
+      if (base == MAP_FAILED) {
+        close(fd);
+        return Status::IOError("Failed to mmap '" + path +
+                               "': " + strerror(errno));
+      }
+      // a changed file gets a new mapping, the blobs on the stale one are
+      // kept intact
+      file_mappings_[fd] = MappedFile{
+          fd, reinterpret_cast<uint8_t*>(base), file_size, mtime, key, 0};
+      files_[key] = fd;
+      std::lock_guard<std::mutex> guard(memory::mmap_records_mutex);
+      memory::MmapRecord& record = memory::mmap_records[base];
+      record.fd = fd;
+      record.size = file_size;
+    }
+    // holds the mapping before the blob is inserted, see also
+    // `ReleaseFileBlob`.
+    file = file_mappings_.at(fd);
+    file_mappings_.at(fd).blobs += 1;
+  }
+
+  uint8_t* pointer = file.base + offset;
+  // clients realign the `map_size` as the segments of the allocators, see
+  // also `MmapEntry`.
+  object = std::make_shared<Payload>(GenerateBlobID(pointer), size, pointer,
+                                     file.fd, file.fd,
+                                     file.size + sizeof(size_t), offset);
+  object->is_file = true;
+  object_id = object->object_id;
+  // blobs of different lengths may start at the same offset
+  while (true) {
+    object_map_t::accessor accessor;
+    if (objects_.insert(accessor, object_id)) {
+      accessor->second = object;
+      break;
+    }
+    if (accessor->second->pointer == pointer &&
+        accessor->second->data_size == object->data_size) {
+      object = accessor->second;
+      std::lock_guard<std::mutex> lock(files_mutex_);
+      file_mappings_.at(file.fd).blobs -= 1;
+      return Status::OK();
+    }
+    object_id += 1;
+    object->object_id = object_id;
+  }
+  PublishObject(object);
+  return Status::OK();
+}
+
+void BulkStore::ReleaseFileBlob(const std::shared_ptr<Payload>& object) {
+  std::lock_guard<std::mutex> lock(files_mutex_);
+  auto iter = file_mappings_.find(object->arena_fd);
+  if (iter == file_mappings_.end() || --iter->second.blobs > 0) {
+    return;
+  }
+  auto& file = iter->second;
+  auto latest = files_.find(file.key);
+  if (latest != files_.end() && latest->second == file.fd) {
+    files_.erase(latest);
+  }
+  {
+    std::lock_guard<std::mutex> guard(memory::mmap_records_mutex);
+    memory::mmap_records.erase(file.base);
+  }
+  munmap(file.base, file.size);
+  // drops the reference of the file but keeps the fd number, see also
+  // `placeholder_fd_`
+  if (placeholder_fd_ == -1 || dup2(placeholder_fd_, file.fd) == -1) {
+    LOG(ERROR) << "Failed to release the fd of the file blob: "
+               << strerror(errno);
+  }
+  file_mappings_.erase(iter);
+}
+
+Status BulkStore::Extend(const ObjectID id, const size_t size,
+                         std::shared_ptr<Payload>& object) {
+  if (id == EmptyBlobID()) {
+    return Status::Invalid("extend: cannot extend the empty blob");
+  }
+  std::lock_guard<std::recursive_mutex> guard(spill_mutex_);
+  object_map_t::accessor accessor;
+  if (!objects_.find(accessor, id)) {
+    return Status::ObjectNotExists("extend: id = " + ObjectIDToString(id));
+  }
+  object = accessor->second;
+  if (object->is_sealed) {
+    return Status::ObjectSealed(
+        "extend: the blob has been sealed (as a member of objects): " +
+        ObjectIDToString(id));
+  }
+  if (object->arena_fd != -1 || object->is_spilled || object->is_persisted ||
+      object->IsDevice() || IsShared(object)) {
+    return Status::Invalid("extend: the blob cannot be extended in place: " +
+                           ObjectIDToString(id));
+  }
+  size_t data_size = static_cast<size_t>(object->data_size);
+  if (size < data_size) {
+    return Status::Invalid("extend: cannot shrink the blob: " +
+                           ObjectIDToString(id));
+  }
+  std::shared_ptr<Tenant> tenant;
+  if (quotas_) {
+    std::lock_guard<std::mutex> lock(owners_mutex_);
+    auto owner = owners_.find(id);
+    if (owner != owners_.end()) {
+      tenant = owner->second.first;
+    }
+  }
+  if (tenant) {
+    RETURN_ON_ERROR(tenant->Charge(size - data_size, 0));
+  }
+  bool extended =
+      slab_.Handles(data_size)
+          ? slab_.ReallocateInPlace(object->pointer, data_size, size)
+          : BulkAllocator::ReallocateInPlace(object->pointer, data_size, size);
+  if (!extended) {
+    if (tenant) {
+      tenant->Refund(size - data_size, 0);
+    }
+    return Status::NotEnoughMemory("extend in place: id = " +
+                                   ObjectIDToString(id) +
+                                   ", size = " + std::to_string(size));
+  }
+  object->data_size = size;
+  // n.b.: still under the accessor, thus won't race with the deletion.
+  PublishObject(object);
+  if (tenant) {
+    std::lock_guard<std::mutex> lock(owners_mutex_);
+    owners_[id].second = size;
+  }
+  return Status::OK();
+}
+
+Status BulkStore::Copy(const ObjectID source, ObjectID& object_id,
+                       std::shared_ptr<Payload>& object, const int numa_node,
+                       const std::shared_ptr<Tenant>& tenant) {
+  std::shared_ptr<Payload> origin;
+  // pin the source to avoid it being spilled when allocating the copy
+  RETURN_ON_ERROR(Pin(source));
+  auto status = Get(source, origin);
+  if (status.ok() && origin->IsDevice()) {
+    status = Status::NotImplemented("copy: cannot copy the device blob " +
+                                    ObjectIDToString(source));
+  }
+  if (status.ok()) {
+    status = Create(origin->data_size, object_id, object, numa_node, tenant);
+  }
+  if (status.ok() && origin->data_size > 0) {
+    memory::concurrent_memcpy(object->pointer, origin->pointer,
+                              origin->data_size);
+  }
+  VINEYARD_DISCARD(Unpin(source));
+  return status;
+}
+
 Status BulkStore::Get(const ObjectID id, std::shared_ptr<Payload>& object) {
   if (id == EmptyBlobID()) {
     object = Payload::MakeEmpty();
     return Status::OK();
   } else {
-    object_map_t::const_accessor accessor;
-    if (objects_.find(accessor, id)) {
-      object = accessor->second;
-      return Status::OK();
-    } else {
+    // n.b.: keep the lock order as "spill_mutex_" -> "accessor", the
+    // spiller flips `is_spilled` under the lock.
+    std::lock_guard<std::recursive_mutex> guard(spill_mutex_);
+    bool found = false;
+    {
+      object_map_t::const_accessor accessor;
+      if ((found = objects_.find(accessor, id))) {
+        object = accessor->second;
+      }
+    }
+    if (!found) {
+      if (backing_store_) {
+        return HydrateObject(id, object);
+      }
       return Status::ObjectNotExists("get: id = " + ObjectIDToString(id));
     }
+    if (object->is_spilled) {
+      RETURN_ON_ERROR(ReloadColdObject(object));
+    } else if (reclaimable()) {
+      TouchObject(id);
+    }
+    return Status::OK();
   }
 }
 
@@ -222,16 +768,152 @@ Status BulkStore::Get(const std::vector<ObjectID>& ids,
     if (object_id == EmptyBlobID()) {
       objects.push_back(Payload::MakeEmpty());
     } else {
-      object_map_t::const_accessor accessor;
-      if (objects_.find(accessor, object_id)) {
-        objects.push_back(accessor->second);
+      // n.b.: keep the lock order as "spill_mutex_" -> "accessor".
+      std::lock_guard<std::recursive_mutex> guard(spill_mutex_);
+      std::shared_ptr<Payload> object;
+      bool found = false;
+      {
+        object_map_t::const_accessor accessor;
+        if ((found = objects_.find(accessor, object_id))) {
+          object = accessor->second;
+        }
+      }
+      if (!found) {
+        if (backing_store_ && HydrateObject(object_id, object).ok()) {
+          objects.push_back(object);
+        }
+        continue;
+      }
+      if (object->is_spilled) {
+        RETURN_ON_ERROR(ReloadColdObject(object));
+      } else if (reclaimable()) {
+        TouchObject(object_id);
       }
+      objects.push_back(object);
     }
   }
   return Status::OK();
 }
 
+Status BulkStore::Get(const ObjectID id, std::shared_ptr<Payload>& object,
+                      std::unordered_set<ObjectID>& pinned) {
+  if (id == EmptyBlobID()) {
+    object = Payload::MakeEmpty();
+    return Status::OK();
+  }
+  // n.b.: keep the lock order as "spill_mutex_" -> "accessor".
+  std::lock_guard<std::recursive_mutex> guard(spill_mutex_);
+  bool found = false;
+  {
+    object_map_t::const_accessor accessor;
+    if ((found = objects_.find(accessor, id))) {
+      object = accessor->second;
+    }
+  }
+  if (!found) {
+    if (!backing_store_) {
+      return Status::ObjectNotExists("get: id = " + ObjectIDToString(id));
+    }
+    RETURN_ON_ERROR(HydrateObject(id, object));
+  } else if (object->is_spilled) {
+    RETURN_ON_ERROR(ReloadColdObject(object));
+  } else if (reclaimable()) {
+    TouchObject(id);
+  }
+  if (object->data_size > 0 && pinned.find(id) == pinned.end()) {
+    RETURN_ON_ERROR(Pin(id));
+    pinned.emplace(id);
+  }
+  return Status::OK();
+}
+
+Status BulkStore::Get(const std::vector<ObjectID>& ids,
+                      std::vector<std::shared_ptr<Payload>>& objects,
+                      std::unordered_set<ObjectID>& pinned) {
+  for (auto object_id : ids) {
+    std::shared_ptr<Payload> object;
+    auto status = Get(object_id, object, pinned);
+    if (status.ok()) {
+      objects.push_back(object);
+    } else if (!status.IsObjectNotExists()) {
+      return status;
+    }
+  }
+  return Status::OK();
+}
+
+Status BulkStore::Prefetch(const std::vector<ObjectID>& ids, size_t& nbytes) {
+  std::vector<std::shared_ptr<Payload>> objects;
+  RETURN_ON_ERROR(Get(ids, objects));
+  static const size_t system_page_size = sysconf(_SC_PAGESIZE);
+  nbytes = 0;
+  for (auto const& object : objects) {
+    if (object->data_size <= 0 || object->IsDevice() ||
+        object->pointer == nullptr) {
+      continue;
+    }
+    if (object->is_file) {
+      // touching the mapping raises SIGBUS if the file has been truncated
+      posix_fadvise(object->arena_fd, object->data_offset, object->data_size,
+                    POSIX_FADV_WILLNEED);
+      nbytes += object->data_size;
+      continue;
+    }
+    size_t page_size =
+        std::max(static_cast<size_t>(object->page_size), system_page_size);
+    memory::Prefaulter::Touch(object->pointer, object->data_size, page_size);
+    nbytes += object->data_size;
+  }
+  return Status::OK();
+}
+
 Status BulkStore::Delete(const ObjectID& object_id) {
+  return Delete(std::set<ObjectID>{object_id});
+}
+
+Status BulkStore::Delete(const std::set<ObjectID>& ids) {
+  Status status;
+  std::vector<std::pair<uintptr_t, uintptr_t>> ranges;
+  std::vector<ObjectID> backed;
+  if (backing_store_) {
+    std::unique_lock<std::mutex> lock(upload_mutex_);
+    upload_cv_.wait(lock, [&]() { return ids.find(uploading_) == ids.end(); });
+    upload_queue_.erase(
+        std::remove_if(upload_queue_.begin(), upload_queue_.end(),
+                       [&](const ObjectID id) { return ids.count(id) > 0; }),
+        upload_queue_.end());
+    for (auto const& object_id : ids) {
+      object_map_t::const_accessor accessor;
+      if (objects_.find(accessor, object_id) &&
+          accessor->second->is_persisted) {
+        backed.emplace_back(object_id);
+      }
+    }
+  }
+  {
+    // n.b.: keep the lock order as "spill_mutex_" -> "accessor".
+    std::unique_lock<std::recursive_mutex> guard(spill_mutex_,
+                                                 std::defer_lock);
+    if (reclaimable() || deduplicating()) {
+      guard.lock();
+    }
+    for (auto const& object_id : ids) {
+      auto s = ReleaseObject(object_id, ranges);
+      if (!s.ok()) {
+        status = s;
+      }
+    }
+  }
+  RecycleArenas(ranges);
+  for (auto const& object_id : backed) {
+    VINEYARD_SUPPRESS(backing_store_->Delete(object_id));
+  }
+  return status;
+}
+
+Status BulkStore::ReleaseObject(
+    const ObjectID object_id,
+    std::vector<std::pair<uintptr_t, uintptr_t>>& ranges) {
   // see also: BulkStore::PreAllocate().
   if (object_id == EmptyBlobID() ||
       object_id == GenerateBlobID(reinterpret_cast<void*>(
@@ -243,58 +925,164 @@ Status BulkStore::Delete(const ObjectID& object_id) {
     return Status::ObjectNotExists("delete: id = " +
                                    ObjectIDToString(object_id));
   }
+  if (quotas_) {
+    RefundObject(object_id);
+  }
+  if (blob_table_) {
+    // unpublish before the memory is reused
+    blob_table_->Remove(object_id);
+  }
   auto& object = accessor->second;
+  if (object->IsDevice()) {
+    auto status = memory::cuda_free(object->device, object->pointer);
+    if (!status.ok()) {
+      LOG(ERROR) << "Failed to free the device blob "
+                 << ObjectIDToString(object_id) << ": " << status.ToString();
+    }
+    device_footprint_ -= object->data_size;
+    objects_.erase(accessor);
+    return Status::OK();
+  }
+  if (reclaimable()) {
+    ForgetObject(object_id);
+    if (object->is_spilled) {
+      VINEYARD_SUPPRESS(spill::RemoveSpillFile(spill_path_, object_id));
+      spilled_objects_ -= 1;
+      spilled_size_ -= object->data_size;
+      objects_.erase(accessor);
+      return Status::OK();
+    }
+  }
   if (object->arena_fd == -1) {
     auto buff_size = object->data_size;
-    BulkAllocator::Free(object->pointer, buff_size);
+    if (!(deduplicating() && UnshareObject(object_id, object))) {
+      FreeMemory(object->pointer, buff_size);
+    }
 #ifndef NDEBUG
     VLOG(10) << "after free: " << ObjectIDToString(object_id) << ": "
              << Footprint() << "(" << FootprintLimit() << ")";
 #endif
+  } else if (object->is_file) {
+    ReleaseFileBlob(object);
   } else {
-    static size_t page_size = memory::system_page_size();
     uintptr_t pointer = reinterpret_cast<uintptr_t>(object->pointer);
-    uintptr_t lower = memory::align_down(pointer, page_size),
-              upper = memory::align_up(pointer, page_size);
-    uintptr_t lower_bound = lower, upper_bound = upper;
+    ranges.emplace_back(pointer, pointer + object->data_size);
+    std::lock_guard<std::mutex> lock(Arena::spans_mutex);
+    Arena::spans.erase(object_id);
+  }
+  objects_.erase(accessor);
+  return Status::OK();
+}
+
+void BulkStore::RefundObject(const ObjectID id) {
+  std::lock_guard<std::mutex> lock(owners_mutex_);
+  auto owner = owners_.find(id);
+  if (owner != owners_.end()) {
+    owner->second.first->Refund(owner->second.second);
+    owners_.erase(owner);
+  }
+}
+
+void BulkStore::RecycleArenas(
+    std::vector<std::pair<uintptr_t, uintptr_t>> const& ranges) {
+  if (ranges.empty()) {
+    return;
+  }
+  static size_t page_size = memory::system_page_size();
+  std::vector<std::pair<uintptr_t, uintptr_t>> pages;
+  for (auto const& range : ranges) {
+    uintptr_t lower = memory::align_down(range.first, page_size),
+              upper = memory::align_up(range.second, page_size);
+    // the deleted blobs have been removed from the spans, the neighbours
+    // are the blobs in use.
+    ObjectID next = InvalidObjectID(), prev = InvalidObjectID();
     {
-      auto iter = Arena::spans.find(object_id);
-      if (iter != Arena::spans.begin()) {
-        auto iter_prev = std::prev(iter);
-        object_map_t::const_accessor accessor;
-        if (!objects_.find(accessor, *iter_prev)) {
-          return Status::Invalid(
-              "Internal state error: previous blob not found");
-        }
-        auto& object_prev = accessor->second;
-        lower_bound =
-            memory::align_up(reinterpret_cast<uintptr_t>(object_prev->pointer) +
-                                 object_prev->data_size,
-                             page_size);
-      }
-      auto iter_next = std::next(iter);
+      // n.b.: don't look up the objects while holding the lock, the
+      // accessors are taken before the lock in `ReleaseObject`.
+      std::lock_guard<std::mutex> lock(Arena::spans_mutex);
+      auto iter_next = Arena::spans.lower_bound(GenerateBlobID(range.first));
       if (iter_next != Arena::spans.end()) {
-        object_map_t::const_accessor accessor;
-        if (!objects_.find(accessor, *iter_next)) {
-          return Status::Invalid("Internal state error: next blob not found");
-        }
-        auto& object_next = accessor->second;
-        upper_bound = memory::align_down(
-            reinterpret_cast<uintptr_t>(object_next->pointer), page_size);
+        next = *iter_next;
+      }
+      if (iter_next != Arena::spans.begin()) {
+        prev = *std::prev(iter_next);
       }
     }
-    if (std::max(lower, lower_bound) < std::min(upper, upper_bound)) {
+    if (next != InvalidObjectID()) {
+      object_map_t::const_accessor accessor;
+      if (!objects_.find(accessor, next)) {
+        LOG(ERROR) << "Internal state error: next blob not found";
+        continue;
+      }
+      upper = std::min(
+          upper, memory::align_down(
+                     reinterpret_cast<uintptr_t>(accessor->second->pointer),
+                     page_size));
+    }
+    if (prev != InvalidObjectID()) {
+      object_map_t::const_accessor accessor;
+      if (!objects_.find(accessor, prev)) {
+        LOG(ERROR) << "Internal state error: previous blob not found";
+        continue;
+      }
+      auto& object_prev = accessor->second;
+      lower = std::max(
+          lower,
+          memory::align_up(reinterpret_cast<uintptr_t>(object_prev->pointer) +
+                               object_prev->data_size,
+                           page_size));
+    }
+    if (lower < upper) {
+      pages.emplace_back(lower, upper);
+    }
+  }
+  if (pages.empty()) {
+    return;
+  }
+
+  // coalesce the adjacent and overlapped ranges
+  std::sort(pages.begin(), pages.end());
+  size_t merged = 0;
+  for (size_t index = 1; index < pages.size(); ++index) {
+    if (pages[index].first <= pages[merged].second) {
+      pages[merged].second =
+          std::max(pages[merged].second, pages[index].second);
+    } else {
+      pages[++merged] = pages[index];
+    }
+  }
+  pages.resize(merged + 1);
+
+  {
+    std::lock_guard<std::mutex> lock(recycle_mutex_);
+    recycle_queue_.insert(recycle_queue_.end(), pages.begin(), pages.end());
+    if (!recycler_.joinable()) {
+      recycler_ = std::thread(&BulkStore::RecycleLoop, this);
+    }
+  }
+  recycle_cv_.notify_one();
+}
+
+void BulkStore::RecycleLoop() {
+  std::unique_lock<std::mutex> lock(recycle_mutex_);
+  while (true) {
+    recycle_cv_.wait(lock, [this]() {
+      return recycle_stopped_ || !recycle_queue_.empty();
+    });
+    if (recycle_queue_.empty()) {
+      return;
+    }
+    std::vector<std::pair<uintptr_t, uintptr_t>> pages;
+    pages.swap(recycle_queue_);
+    lock.unlock();
+    for (auto const& page : pages) {
 #ifndef NDEBUG
-      VLOG(10) << "after free: " << Footprint() << "(" << FootprintLimit()
-               << "), recycle: (" << std::max(lower, lower_bound) << ", "
-               << std::min(upper, upper_bound) << ")";
+      VLOG(10) << "recycle: (" << page.first << ", " << page.second << ")";
 #endif
-      memory::recycle_resident_memory(std::max(lower, lower_bound),
-                                      std::min(upper, upper_bound));
+      memory::recycle_resident_memory(page.first, page.second);
     }
+    lock.lock();
   }
-  objects_.erase(accessor);
-  return Status::OK();
 }
 
 bool BulkStore::Exists(const ObjectID& object_id) {
@@ -308,6 +1096,657 @@ size_t BulkStore::FootprintLimit() const {
   return BulkAllocator::GetFootprintLimit();
 }
 
+void BulkStore::MarkAsPersisted(const std::set<ObjectID>& ids) {
+  for (auto const& id : ids) {
+    if (id == EmptyBlobID() || Arena::Contains(id)) {
+      // blobs inside arenas are not allocated by the bulk allocator.
+      continue;
+    }
+    bool upload = false;
+    {
+      object_map_t::const_accessor accessor;
+      if (objects_.find(accessor, id)) {
+        // the backing store cannot read the device memory
+        // nor the files that may be truncated under the mapping
+        upload = !accessor->second->is_persisted && backing_store_ &&
+                 !accessor->second->IsDevice() && !accessor->second->is_file;
+        accessor->second->is_persisted = true;
+      }
+    }
+    if (upload) {
+      std::lock_guard<std::mutex> lock(upload_mutex_);
+      upload_queue_.emplace_back(id);
+      upload_cv_.notify_all();
+    }
+  }
+}
+
+Status BulkStore::Pin(const ObjectID id) {
+  if (id == EmptyBlobID()) {
+    return Status::OK();
+  }
+  std::lock_guard<std::recursive_mutex> guard(spill_mutex_);
+  object_map_t::const_accessor accessor;
+  if (!objects_.find(accessor, id)) {
+    return Status::ObjectNotExists("pin: id = " + ObjectIDToString(id));
+  }
+  accessor->second->ref_cnt += 1;
+  return Status::OK();
+}
+
+Status BulkStore::Unpin(const ObjectID id) {
+  if (id == EmptyBlobID()) {
+    return Status::OK();
+  }
+  std::lock_guard<std::recursive_mutex> guard(spill_mutex_);
+  object_map_t::const_accessor accessor;
+  if (!objects_.find(accessor, id)) {
+    return Status::ObjectNotExists("unpin: id = " + ObjectIDToString(id));
+  }
+  if (accessor->second->ref_cnt > 0) {
+    accessor->second->ref_cnt -= 1;
+  }
+  if (accessor->second->ref_cnt == 0 && !dedup_pending_.empty()) {
+    auto pending = dedup_pending_.find(id);
+    if (pending != dedup_pending_.end()) {
+      accessor.release();
+      DeduplicateObject(id, pending->second);
+    }
+  }
+  return Status::OK();
+}
+
+bool BulkStore::Pinned(const std::set<ObjectID>& ids) {
+  std::lock_guard<std::recursive_mutex> guard(spill_mutex_);
+  for (auto const id : ids) {
+    object_map_t::const_accessor accessor;
+    if (objects_.find(accessor, id) && accessor->second->ref_cnt > 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+size_t BulkStore::SpilledObjects() const {
+  std::lock_guard<std::recursive_mutex> guard(spill_mutex_);
+  return spilled_objects_;
+}
+
+size_t BulkStore::SpilledSize() const {
+  std::lock_guard<std::recursive_mutex> guard(spill_mutex_);
+  return spilled_size_;
+}
+
+size_t BulkStore::EvictedObjects() const {
+  std::lock_guard<std::recursive_mutex> guard(spill_mutex_);
+  return evicted_objects_;
+}
+
+BulkStore::FragmentationStats BulkStore::GetFragmentationStats() const {
+  FragmentationStats stats;
+  BulkAllocator::Inspect([&stats](void*, size_t size, bool used) {
+    if (!used) {
+      stats.free_size += size;
+      stats.free_blocks += 1;
+      stats.largest_free_size = std::max(stats.largest_free_size, size);
+    }
+  });
+  return stats;
+}
+
+Status BulkStore::Compact(size_t& relocated_objects, size_t& relocated_size) {
+  relocated_objects = 0;
+  relocated_size = 0;
+  if (blob_table_) {
+    return Status::Invalid(
+        "compact: the blobs published in the blob table cannot be moved");
+  }
+  std::vector<uintptr_t> chunks;
+  if (!BulkAllocator::Inspect([&chunks](void* start, size_t, bool used) {
+        if (used) {
+          chunks.emplace_back(reinterpret_cast<uintptr_t>(start));
+        }
+      })) {
+    return Status::NotImplemented(
+        "compact: not supported by the bulk allocator");
+  }
+  // moves the blobs at the tail first
+  std::sort(chunks.begin(), chunks.end(), std::greater<uintptr_t>());
+
+  size_t const allocations = allocations_.load();
+  for (uintptr_t const chunk : chunks) {
+    if (allocations_.load() != allocations) {
+      break;
+    }
+    // n.b.: holding the lock blocks the pinning, spilling and extending.
+    std::lock_guard<std::recursive_mutex> guard(spill_mutex_);
+    object_map_t::accessor accessor;
+    auto relocated = relocated_.find(chunk);
+    if (relocated != relocated_.end() &&
+        !(objects_.find(accessor, relocated->second) &&
+          reinterpret_cast<uintptr_t>(accessor->second->pointer) == chunk)) {
+      // stale, the blob has been deleted
+      accessor.release();
+      relocated_.erase(relocated);
+      relocated = relocated_.end();
+    }
+    if (relocated == relocated_.end() &&
+        !(objects_.find(accessor, GenerateBlobID(chunk)) &&
+          reinterpret_cast<uintptr_t>(accessor->second->pointer) == chunk)) {
+      // not a blob, e.g., slabs of small blobs
+      continue;
+    }
+    auto& object = accessor->second;
+    ObjectID const object_id = object->object_id;
+    size_t const size = static_cast<size_t>(object->data_size);
+    // the payload may be in use by the requests in flight if it is shared.
+    if (object->ref_cnt > 0 || object->is_spilled || object->arena_fd != -1 ||
+        object->IsDevice() || slab_.Handles(size) || object.use_count() > 1 ||
+        IsShared(object)) {
+      continue;
+    }
+    int fd = -1;
+    int64_t map_size = 0;
+    ptrdiff_t offset = 0;
+    uint8_t* pointer =
+        AllocateMemory(size, &fd, &map_size, &offset, object->numa_node);
+    if (pointer == nullptr) {
+      continue;
+    }
+    if (reinterpret_cast<uintptr_t>(pointer) > chunk) {
+      FreeMemory(pointer, size);
+      continue;
+    }
+    memcpy(pointer, object->pointer, size);
+    ForgetDigest(object);
+    FreeMemory(object->pointer, size);
+    object->pointer = pointer;
+    object->store_fd = fd;
+    object->map_size = map_size;
+    object->page_size = GetMallocPageSize(fd);
+    object->data_offset = offset;
+    if (relocated != relocated_.end()) {
+      relocated_.erase(relocated);
+    }
+    if (object_id != GenerateBlobID(pointer)) {
+      relocated_[reinterpret_cast<uintptr_t>(pointer)] = object_id;
+    }
+    relocated_objects += 1;
+    relocated_size += size;
+  }
+
+  std::lock_guard<std::recursive_mutex> guard(spill_mutex_);
+  relocated_objects_ += relocated_objects;
+  relocated_size_ += relocated_size;
+  return Status::OK();
+}
+
+void BulkStore::EnableCompaction(const std::chrono::seconds interval,
+                                 const double threshold) {
+  std::lock_guard<std::mutex> lock(compact_mutex_);
+  if (compactor_.joinable() || interval.count() <= 0) {
+    return;
+  }
+  compact_interval_ = interval;
+  compact_threshold_ = threshold;
+  compactor_ = std::thread(&BulkStore::CompactLoop, this);
+}
+
+void BulkStore::CompactLoop() {
+  std::unique_lock<std::mutex> lock(compact_mutex_);
+  size_t allocations = allocations_.load();
+  while (!compact_cv_.wait_for(lock, compact_interval_,
+                               [this]() { return compact_stopped_; })) {
+    size_t const current = allocations_.load();
+    if (std::exchange(allocations, current) != current) {
+      // not idle
+      continue;
+    }
+    auto stats = GetFragmentationStats();
+    if (stats.free_size == 0 ||
+        1.0 - static_cast<double>(stats.largest_free_size) / stats.free_size <
+            compact_threshold_) {
+      continue;
+    }
+    lock.unlock();
+    size_t relocated_objects = 0, relocated_size = 0;
+    auto status = Compact(relocated_objects, relocated_size);
+    if (!status.ok()) {
+      LOG(ERROR) << "Failed to compact the bulk store: " << status.ToString();
+    } else {
+      VLOG(2) << "compaction: relocated " << relocated_objects << " blobs ("
+              << relocated_size << " bytes), the largest free block was "
+              << stats.largest_free_size << " of " << stats.free_size
+              << " free bytes";
+    }
+    lock.lock();
+    allocations = allocations_.load();
+  }
+}
+
+void BulkStore::EnableBackingStore(std::shared_ptr<BackingStore> store) {
+  std::lock_guard<std::mutex> lock(upload_mutex_);
+  if (uploader_.joinable() || store == nullptr) {
+    return;
+  }
+  backing_store_ = store;
+  uploader_ = std::thread(&BulkStore::UploadLoop, this);
+  LOG(INFO) << "Persisted blobs will be backed by '" << store->Location()
+            << "'";
+}
+
+void BulkStore::UploadLoop() {
+  std::unique_lock<std::mutex> lock(upload_mutex_);
+  while (true) {
+    upload_cv_.wait(
+        lock, [this]() { return upload_stopped_ || !upload_queue_.empty(); });
+    if (upload_stopped_) {
+      break;
+    }
+    uploading_ = upload_queue_.front();
+    upload_queue_.pop_front();
+    lock.unlock();
+    // pinned blobs won't be spilled or relocated during uploading
+    std::shared_ptr<Payload> object;
+    auto status = Pin(uploading_);
+    if (status.ok()) {
+      status = Get(uploading_, object);
+      if (status.ok()) {
+        status = backing_store_->Put(uploading_, object->pointer,
+                                     object->data_size);
+      }
+      VINEYARD_DISCARD(Unpin(uploading_));
+    }
+    if (status.ok()) {
+      uploaded_objects_ += 1;
+    } else {
+      LOG(WARNING) << "Failed to write blob " << ObjectIDToString(uploading_)
+                   << " to the backing store: " << status.ToString();
+    }
+    lock.lock();
+    uploading_ = InvalidObjectID();
+    upload_cv_.notify_all();
+  }
+}
+
+Status BulkStore::HydrateObject(const ObjectID id,
+                                std::shared_ptr<Payload>& object) {
+  size_t size = 0;
+  if (!IsBlob(id) || !backing_store_->Size(id, size).ok() || size == 0) {
+    return Status::ObjectNotExists("get: id = " + ObjectIDToString(id));
+  }
+  int fd = -1;
+  int64_t map_size = 0;
+  ptrdiff_t offset = 0;
+  uint8_t* pointer = AllocateMemory(size, &fd, &map_size, &offset);
+  if (pointer == nullptr && reclaimable()) {
+    std::lock_guard<std::recursive_mutex> guard(spill_mutex_);
+    pointer = AllocateMemoryWithSpill(size, &fd, &map_size, &offset);
+  }
+  if (pointer == nullptr) {
+    return Status::NotEnoughMemory("Failed to hydrate blob " +
+                                   ObjectIDToString(id) +
+                                   ", size = " + std::to_string(size));
+  }
+  auto status = backing_store_->Get(id, pointer, size);
+  if (!status.ok()) {
+    FreeMemory(pointer, size);
+    return status;
+  }
+  object = std::make_shared<Payload>(id, size, pointer, fd, map_size, offset);
+  object->page_size = GetMallocPageSize(fd);
+  object->is_persisted = true;
+  bool inserted = false;
+  {
+    // n.b.: published under the accessor, thus won't race with the deletion.
+    object_map_t::accessor accessor;
+    if ((inserted = objects_.emplace(accessor, id, object))) {
+      PublishObject(object);
+    }
+  }
+  if (!inserted) {
+    // has been hydrated by others
+    FreeMemory(pointer, size);
+    object_map_t::const_accessor accessor;
+    if (!objects_.find(accessor, id)) {
+      return Status::ObjectNotExists("get: id = " + ObjectIDToString(id));
+    }
+    object = accessor->second;
+    return Status::OK();
+  }
+  {
+    std::lock_guard<std::recursive_mutex> guard(spill_mutex_);
+    if (id != GenerateBlobID(pointer)) {
+      relocated_[reinterpret_cast<uintptr_t>(pointer)] = id;
+    }
+    TouchObject(id);
+  }
+  hydrated_objects_ += 1;
+  return Status::OK();
+}
+
+Status BulkStore::LoadSnapshot(const std::string& path) {
+  RETURN_ON_ASSERT(snapshot_fd_ == -1, "The snapshot has been loaded");
+  snapshot_path_ = path;
+  std::vector<snapshot::SnapshotEntry> entries;
+  auto status = snapshot::OpenSnapshot(path, snapshot_fd_, snapshot_base_,
+                                       snapshot_size_, entries);
+  if (status.IsObjectNotExists()) {
+    LOG(INFO) << "No snapshot found at '" << path << "', starting empty";
+    return Status::OK();
+  }
+  RETURN_ON_ERROR(status);
+  {
+    std::lock_guard<std::mutex> guard(memory::mmap_records_mutex);
+    memory::MmapRecord& record =
+        memory::mmap_records[reinterpret_cast<void*>(snapshot_base_)];
+    record.fd = snapshot_fd_;
+    record.size = snapshot_size_;
+  }
+  for (auto const& entry : entries) {
+    // the blobs are released via `RecycleArenas` as arena blobs, each of them
+    // starts at a page boundary thus the pages are not shared.
+    auto object = std::make_shared<Payload>(
+        entry.object_id, entry.size, snapshot_base_ + entry.offset,
+        snapshot_fd_, snapshot_fd_, snapshot_size_, entry.offset);
+    object->is_persisted = entry.flags & snapshot::kSnapshotPersisted;
+    if (!objects_.emplace(entry.object_id, object)) {
+      LOG(WARNING) << "Duplicated blob in snapshot: "
+                   << ObjectIDToString(entry.object_id);
+      continue;
+    }
+    PublishObject(object);
+    snapshot_objects_ += 1;
+  }
+  LOG(INFO) << "Mapped " << snapshot_objects_ << " blobs from snapshot '"
+            << path << "'";
+  return Status::OK();
+}
+
+Status BulkStore::SaveSnapshot(const std::string& path) {
+  // hold the payloads to keep the content alive during writing
+  std::vector<std::shared_ptr<Payload>> objects;
+  for (auto iter = objects_.begin(); iter != objects_.end(); ++iter) {
+    auto const& object = iter->second;
+    if (object->is_persisted && !object->is_spilled && object->data_size > 0 &&
+        object->pointer != nullptr && !object->IsDevice()) {
+      objects.emplace_back(object);
+    }
+  }
+  std::vector<snapshot::SnapshotEntry> entries;
+  std::vector<const uint8_t*> data;
+  for (auto const& object : objects) {
+    entries.emplace_back(snapshot::SnapshotEntry{
+        .object_id = object->object_id,
+        .offset = 0,
+        .size = static_cast<uint64_t>(object->data_size),
+        .flags = snapshot::kSnapshotPersisted});
+    data.emplace_back(object->pointer);
+  }
+  RETURN_ON_ERROR(snapshot::WriteSnapshot(path, entries, data));
+  LOG(INFO) << "Saved " << entries.size() << " blobs to snapshot '" << path
+            << "'";
+  return Status::OK();
+}
+
+size_t BulkStore::RelocatedObjects() const {
+  std::lock_guard<std::recursive_mutex> guard(spill_mutex_);
+  return relocated_objects_;
+}
+
+size_t BulkStore::RelocatedSize() const {
+  std::lock_guard<std::recursive_mutex> guard(spill_mutex_);
+  return relocated_size_;
+}
+
+void BulkStore::EnableDeduplication(const size_t min_size) {
+  std::lock_guard<std::mutex> lock(seal_mutex_);
+  if (deduplicating() || min_size == 0) {
+    return;
+  }
+  dedup_min_size_ = min_size;
+  StartSealer();
+  LOG(INFO) << "Blobs no smaller than " << min_size
+            << " bytes will be deduplicated";
+}
+
+Status BulkStore::EnableBlobTable(const size_t capacity) {
+  RETURN_ON_ASSERT(!blob_table_, "The blob table has been enabled");
+  if (reclaimable() || deduplicating() || compactor_.joinable()) {
+    return Status::Invalid(
+        "The blob table cannot be enabled together with spilling, eviction, "
+        "compaction or deduplication");
+  }
+  size_t const slots = BlobTable::AlignedCapacity(capacity);
+  int fd = memory::create_buffer(BlobTable::RequiredSize(slots));
+  if (fd < 0) {
+    return Status::IOError("Failed to create the blob table");
+  }
+  auto status = BlobTable::Map(fd, slots, true, blob_table_);
+  if (!status.ok()) {
+    close(fd);
+    return status;
+  }
+  blob_table_fd_ = fd;
+  LOG(INFO) << "Publishing up to " << slots << " blobs in the blob table";
+  return Status::OK();
+}
+
+void BulkStore::PublishObject(const std::shared_ptr<Payload>& object) {
+  if (!blob_table_ || object->IsDevice() || object->is_spilled ||
+      object->store_fd == -1 || object->data_size == 0) {
+    return;
+  }
+  BlobLocation location;
+  location.store_fd = object->store_fd;
+  location.map_size = object->map_size;
+  location.data_offset = object->data_offset;
+  location.data_size = object->data_size;
+  // n.b.: the clients fall back to `GetBuffers` when the table is full.
+  blob_table_->Put(object->object_id, location);
+}
+
+void BulkStore::EnableChecksum() {
+  std::lock_guard<std::mutex> lock(seal_mutex_);
+  checksum_ = true;
+  StartSealer();
+}
+
+void BulkStore::StartSealer() {
+  if (!sealer_.joinable()) {
+    sealer_ = std::thread(&BulkStore::SealLoop, this);
+  }
+}
+
+void BulkStore::Seal(const std::set<ObjectID>& ids) {
+  for (auto const& id : ids) {
+    object_map_t::const_accessor accessor;
+    if (objects_.find(accessor, id)) {
+      accessor->second->is_sealed = true;
+    }
+  }
+  std::lock_guard<std::mutex> lock(seal_mutex_);
+  if (!sealer_.joinable()) {
+    return;
+  }
+  for (auto const& id : ids) {
+    if (id != EmptyBlobID()) {
+      seal_queue_.emplace_back(id);
+    }
+  }
+  seal_cv_.notify_all();
+}
+
+size_t BulkStore::DeduplicatedObjects() const {
+  std::lock_guard<std::recursive_mutex> guard(spill_mutex_);
+  return deduplicated_objects_;
+}
+
+size_t BulkStore::DeduplicatedSize() const {
+  std::lock_guard<std::recursive_mutex> guard(spill_mutex_);
+  return deduplicated_size_;
+}
+
+void BulkStore::SealLoop() {
+  std::unique_lock<std::mutex> lock(seal_mutex_);
+  while (true) {
+    seal_cv_.wait(
+        lock, [this]() { return seal_stopped_ || !seal_queue_.empty(); });
+    if (seal_stopped_) {
+      break;
+    }
+    ObjectID id = seal_queue_.front();
+    seal_queue_.pop_front();
+    lock.unlock();
+    // pinned blobs won't be spilled or relocated during hashing
+    if (Pin(id).ok()) {
+      std::shared_ptr<Payload> object;
+      {
+        object_map_t::const_accessor accessor;
+        if (objects_.find(accessor, id)) {
+          object = accessor->second;
+        }
+      }
+      // the file may be truncated under the mapping
+      bool readable = object != nullptr && !object->is_spilled &&
+                      !object->IsDevice() && !object->is_file;
+      bool dedupable = readable && deduplicating() &&
+                       object->arena_fd == -1 &&
+                       !Arena::Contains(id) &&
+                       static_cast<size_t>(object->data_size) >=
+                           dedup_min_size_ &&
+                       !slab_.Handles(object->data_size);
+      uint64_t digest = 0;
+      if (readable && checksum_ && object->checksum < 0) {
+        object->checksum =
+            memory::concurrent_crc32c(object->pointer, object->data_size);
+      }
+      if (dedupable) {
+        digest = memory::concurrent_checksum(object->pointer,
+                                             object->data_size);
+      }
+      std::lock_guard<std::recursive_mutex> guard(spill_mutex_);
+      VINEYARD_DISCARD(Unpin(id));
+      if (dedupable) {
+        DeduplicateObject(id, digest);
+      }
+    }
+    lock.lock();
+  }
+}
+
+void BulkStore::DeduplicateObject(const ObjectID id, const uint64_t digest) {
+  std::shared_ptr<Payload> object;
+  {
+    object_map_t::const_accessor accessor;
+    if (!objects_.find(accessor, id)) {
+      dedup_pending_.erase(id);
+      return;
+    }
+    object = accessor->second;
+  }
+  uintptr_t const address = reinterpret_cast<uintptr_t>(object->pointer);
+  if (object->is_spilled ||
+      dedup_payloads_.find(address) != dedup_payloads_.end()) {
+    // indexed already
+    return;
+  }
+  std::shared_ptr<Payload> origin;
+  auto range = dedup_digests_.equal_range(digest);
+  for (auto iter = range.first; iter != range.second; ++iter) {
+    auto const& shared = dedup_payloads_.at(iter->second);
+    std::shared_ptr<Payload> candidate;
+    {
+      object_map_t::const_accessor accessor;
+      if (shared.blobs.empty() ||
+          !objects_.find(accessor, shared.blobs.front())) {
+        continue;
+      }
+      candidate = accessor->second;
+    }
+    // verifies the content, as the digests may collide
+    if (candidate->data_size == object->data_size &&
+        memcmp(candidate->pointer, object->pointer, object->data_size) == 0) {
+      origin = candidate;
+      break;
+    }
+  }
+  if (origin == nullptr) {
+    dedup_payloads_[address] = SharedPayload{digest, {id}};
+    dedup_digests_.emplace(digest, address);
+    return;
+  }
+  // the blob may be mapped by clients, or in use by the requests in flight,
+  // besides the `objects_` and the local reference.
+  if (object->ref_cnt > 0 || object.use_count() > 2) {
+    dedup_pending_[id] = digest;
+    return;
+  }
+  dedup_pending_.erase(id);
+  FreeMemory(object->pointer, object->data_size);
+  auto relocated = relocated_.find(address);
+  if (relocated != relocated_.end() && relocated->second == id) {
+    relocated_.erase(relocated);
+  }
+  object->pointer = origin->pointer;
+  object->store_fd = origin->store_fd;
+  object->map_size = origin->map_size;
+  object->page_size = origin->page_size;
+  object->data_offset = origin->data_offset;
+  object->numa_node = origin->numa_node;
+  if (object->checksum < 0) {
+    object->checksum = origin->checksum;
+  }
+  dedup_payloads_.at(reinterpret_cast<uintptr_t>(origin->pointer))
+      .blobs.emplace_back(id);
+  deduplicated_objects_ += 1;
+  deduplicated_size_ += object->data_size;
+}
+
+bool BulkStore::UnshareObject(const ObjectID id,
+                              const std::shared_ptr<Payload>& object) {
+  dedup_pending_.erase(id);
+  uintptr_t const address = reinterpret_cast<uintptr_t>(object->pointer);
+  auto shared = dedup_payloads_.find(address);
+  if (shared == dedup_payloads_.end()) {
+    return false;
+  }
+  auto& blobs = shared->second.blobs;
+  blobs.erase(std::remove(blobs.begin(), blobs.end(), id), blobs.end());
+  if (!blobs.empty()) {
+    deduplicated_objects_ -= 1;
+    deduplicated_size_ -= object->data_size;
+    return true;
+  }
+  ForgetDigest(object);
+  return false;
+}
+
+bool BulkStore::IsShared(const std::shared_ptr<Payload>& object) const {
+  if (!deduplicating()) {
+    return false;
+  }
+  auto shared =
+      dedup_payloads_.find(reinterpret_cast<uintptr_t>(object->pointer));
+  return shared != dedup_payloads_.end() && shared->second.blobs.size() > 1;
+}
+
+void BulkStore::ForgetDigest(const std::shared_ptr<Payload>& object) {
+  uintptr_t const address = reinterpret_cast<uintptr_t>(object->pointer);
+  auto shared = dedup_payloads_.find(address);
+  if (shared == dedup_payloads_.end()) {
+    return;
+  }
+  auto range = dedup_digests_.equal_range(shared->second.digest);
+  for (auto iter = range.first; iter != range.second; ++iter) {
+    if (iter->second == address) {
+      dedup_digests_.erase(iter);
+      break;
+    }
+  }
+  dedup_payloads_.erase(shared);
+}
+
 Status BulkStore::MakeArena(size_t const size, int& fd, uintptr_t& base) {
   fd = memory::create_buffer(size);
   if (fd == -1) {
@@ -321,10 +1760,9 @@ Status BulkStore::MakeArena(size_t const size, int& fd, uintptr_t& base) {
   return Status::OK();
 }
 
-Status BulkStore::FinalizeArena(const int fd,
-                                std::vector<size_t> const& offsets,
-                                std::vector<size_t> const& sizes) {
-  VLOG(2) << "finalizing arena (fd) " << fd << "...";
+Status BulkStore::RegisterArenaBlobs(const int fd,
+                                     std::vector<size_t> const& offsets,
+                                     std::vector<size_t> const& sizes) {
   auto arena = arenas_.find(fd);
   if (arena == arenas_.end()) {
     return Status::ObjectNotExists("arena for fd " + std::to_string(fd) +
@@ -342,18 +1780,39 @@ Status BulkStore::FinalizeArena(const int fd,
     // make them available for blob pool
     uintptr_t pointer = mmap_base + offsets[idx];
     ObjectID object_id = GenerateBlobID(pointer);
-    objects_.emplace(object_id, std::make_shared<Payload>(
-                                    object_id, sizes[idx],
-                                    reinterpret_cast<uint8_t*>(pointer), fd,
-                                    mmap_size, offsets[idx]));
+    auto object = std::make_shared<Payload>(
+        object_id, sizes[idx], reinterpret_cast<uint8_t*>(pointer), fd,
+        mmap_size, offsets[idx]);
+    if (objects_.emplace(object_id, object)) {
+      PublishObject(object);
+    }
     // record the span, will be used to release memory back to OS when deleting
     // blobs
+    std::lock_guard<std::mutex> lock(Arena::spans_mutex);
     Arena::spans.emplace(object_id);
   }
-  // recycle memory
-  { memory::recycle_arena(mmap_base, mmap_size, offsets, sizes); }
+  return Status::OK();
+}
+
+Status BulkStore::FinalizeArena(const int fd,
+                                std::vector<size_t> const& offsets,
+                                std::vector<size_t> const& sizes) {
+  VLOG(2) << "finalizing arena (fd) " << fd << "...";
+  RETURN_ON_ERROR(RegisterArenaBlobs(fd, offsets, sizes));
+  auto arena = arenas_.find(fd);
+  size_t mmap_size = arena->second.size;
+  uintptr_t mmap_base = arena->second.base;
+  // recycle memory, except the blocks that have been flushed before
+  {
+    std::vector<size_t> blob_offsets = std::move(arena->second.offsets),
+                        blob_sizes = std::move(arena->second.sizes);
+    blob_offsets.insert(blob_offsets.end(), offsets.begin(), offsets.end());
+    blob_sizes.insert(blob_sizes.end(), sizes.begin(), sizes.end());
+    memory::recycle_arena(mmap_base, mmap_size, blob_offsets, blob_sizes);
+  }
   // make it available for mmap record
   {
+    std::lock_guard<std::mutex> guard(memory::mmap_records_mutex);
     memory::MmapRecord& record =
         memory::mmap_records[reinterpret_cast<void*>(mmap_base)];
     record.fd = fd;
@@ -363,4 +1822,30 @@ Status BulkStore::FinalizeArena(const int fd,
   return Status::OK();
 }
 
+Status BulkStore::FlushArena(const int fd, std::vector<size_t> const& offsets,
+                             std::vector<size_t> const& sizes,
+                             std::vector<size_t> const& unused_offsets,
+                             std::vector<size_t> const& unused_sizes) {
+  VLOG(2) << "flushing arena (fd) " << fd << "...";
+  if (unused_offsets.size() != unused_sizes.size()) {
+    return Status::UserInputError(
+        "The offsets and sizes of unused ranges are not match");
+  }
+  RETURN_ON_ERROR(RegisterArenaBlobs(fd, offsets, sizes));
+  auto& arena = arenas_.at(fd);
+  arena.offsets.insert(arena.offsets.end(), offsets.begin(), offsets.end());
+  arena.sizes.insert(arena.sizes.end(), sizes.begin(), sizes.end());
+  // the pages shared with blobs are kept, see also `RecycleArenas`
+  std::vector<std::pair<uintptr_t, uintptr_t>> ranges;
+  for (size_t idx = 0; idx < unused_offsets.size(); ++idx) {
+    if (unused_offsets[idx] + unused_sizes[idx] > arena.size) {
+      return Status::UserInputError("The unused range is out of the arena");
+    }
+    uintptr_t pointer = arena.base + unused_offsets[idx];
+    ranges.emplace_back(pointer, pointer + unused_sizes[idx]);
+  }
+  RecycleArenas(ranges);
+  return Status::OK();
+}
+
 }  // namespace vineyard
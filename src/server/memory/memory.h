@@ -29,15 +29,32 @@
 #ifndef SRC_SERVER_MEMORY_MEMORY_H_
 #define SRC_SERVER_MEMORY_MEMORY_H_
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <list>
+#include <map>
 #include <memory>
+#include <mutex>
 #include <set>
+#include <string>
+#include <thread>
 #include <unordered_map>
+#include <unordered_set>
+#include <utility>
 #include <vector>
 
 #include "oneapi/tbb/concurrent_hash_map.h"
 
+#include "common/memory/blob_table.h"
 #include "common/memory/payload.h"
 #include "common/util/status.h"
+#include "server/memory/prefault.h"
+#include "server/memory/slab.h"
+#include "server/util/backing_store.h"
+#include "server/util/credentials.h"
+#include "server/util/quota.h"
 
 namespace vineyard {
 
@@ -45,11 +62,81 @@ class BulkStore {
  public:
   ~BulkStore();
 
-  Status PreAllocate(const size_t size);
+  /**
+   * @brief Pre-allocate the shared memory arena. When `spill_path` is not
+   * empty, cold blobs will be spilled to files under that directory once the
+   * footprint limit is reached.
+   *
+   * When `lru_eviction` is enabled, unpinned and non-persisted blobs will be
+   * reclaimed in LRU order under memory pressure as well.
+   *
+   * Blobs that are no larger than `slab_max_size` are served by the slabs of
+   * size classes, see also `memory::SlabAllocator`.
+   */
+  Status PreAllocate(const size_t size, const std::string& spill_path = "",
+                     const bool lru_eviction = false,
+                     const size_t slab_max_size = 0);
 
+  /**
+   * Create a blob, placing it on the given NUMA node when NUMA-aware
+   * allocation is enabled (-1 means no preference).
+   *
+   * The blob is charged to the `tenant` (if any) until being deleted, and
+   * the creation fails when the quota of the tenant is exceeded.
+   */
   Status Create(const size_t size, ObjectID& object_id,
+                std::shared_ptr<Payload>& object, const int numa_node = -1,
+                const std::shared_ptr<Tenant>& tenant = nullptr);
+
+  /**
+   * @brief Create a blob in the memory of the given CUDA device, the blob is
+   * shared with clients through the CUDA IPC memory handle, so that processes
+   * on the same GPU (e.g., replicas of a model) share one copy.
+   *
+   * Device blobs take no space of the shared memory, and won't be spilled,
+   * evicted, relocated or uploaded to the backing store.
+   */
+  Status CreateDevice(const size_t size, const int device, ObjectID& object_id,
+                      std::shared_ptr<Payload>& object);
+
+  /**
+   * @brief Create a (sealed) blob of `length` bytes at `offset` of the file,
+   * a negative `length` means the rest of the file. The file is mapped by
+   * the server and shared with clients through its fd, thus the page cache
+   * is the storage of the blob and the content is not copied.
+   *
+   * The file is opened by the server, thus the requesting process (`peer`)
+   * must be allowed to read it, see also `credentials::CheckReadable`.
+   *
+   * The mappings are reused for the same file (if unchanged), and a blob
+   * that has been imported for the same range is returned as is. File blobs
+   * take no space of the shared memory like the blobs in arenas, and won't
+   * be spilled, evicted or relocated. The mapping is released once all the
+   * blobs on it have been deleted.
+   */
+  Status CreateFromFile(const std::string& path, const size_t offset,
+                        const int64_t length,
+                        const credentials::Credentials& peer,
+                        ObjectID& object_id,
+                        std::shared_ptr<Payload>& object);
+
+  /**
+   * @brief Grow the (unsealed) blob in place, when the allocator has enough
+   * adjacent free space. The blob keeps its id and address.
+   *
+   * Sealed blobs (i.e., members of objects), blobs in client-side arenas,
+   * spilled and persisted blobs cannot be extended.
+   */
+  Status Extend(const ObjectID id, const size_t size,
                 std::shared_ptr<Payload>& object);
 
+  /**
+   * @brief Create a new blob with the content of the given blob.
+   */
+  Status Copy(const ObjectID source, ObjectID& object_id,
+              std::shared_ptr<Payload>& object, const int numa_node = -1,
+              const std::shared_ptr<Tenant>& tenant = nullptr);
+
   Status Get(const ObjectID id, std::shared_ptr<Payload>& object);
 
   /**
@@ -59,33 +146,462 @@ class BulkStore {
   Status Get(const std::vector<ObjectID>& ids,
              std::vector<std::shared_ptr<Payload>>& objects);
 
+  /**
+   * @brief Get the blob and pin it (once for each `pinned`, i.e., the blobs
+   * that have been pinned by the requester) under the spill lock, thus the
+   * blob won't be spilled between being reloaded and being pinned.
+   */
+  Status Get(const ObjectID id, std::shared_ptr<Payload>& object,
+             std::unordered_set<ObjectID>& pinned);
+
+  /**
+   * Like `Get` above, the missing blobs are skipped.
+   */
+  Status Get(const std::vector<ObjectID>& ids,
+             std::vector<std::shared_ptr<Payload>>& objects,
+             std::unordered_set<ObjectID>& pinned);
+
+  /**
+   * @brief Stage the given blobs in memory, i.e., reload the spilled ones and
+   * hydrate the evicted ones, and pre-fault their pages, so that the first
+   * accesses of clients won't page fault. The blobs that don't exist are
+   * skipped.
+   */
+  Status Prefetch(const std::vector<ObjectID>& ids, size_t& nbytes);
+
   Status Delete(const ObjectID& object_id);
 
+  /**
+   * @brief Delete the given blobs in one batch. The freed pages of arenas
+   * are coalesced and released back to the OS in the background.
+   *
+   * The blobs that don't exist are skipped, and reported in the returned
+   * status.
+   */
+  Status Delete(const std::set<ObjectID>& ids);
+
   bool Exists(const ObjectID& object_id);
 
   size_t Footprint() const;
   size_t FootprintLimit() const;
 
+  /**
+   * @brief Mark the given blobs as persisted. Only persisted blobs are
+   * candidates to be spilled to disk.
+   */
+  void MarkAsPersisted(const std::set<ObjectID>& ids);
+
+  /**
+   * @brief Whether the persisted state of blobs is used, i.e., for spilling,
+   * uploading to the backing store or saving the snapshot.
+   */
+  bool TracksPersisted() const {
+    return !spill_path_.empty() || backing_store_ != nullptr ||
+           !snapshot_path_.empty();
+  }
+
+  /**
+   * @brief Pin the blob (i.e., increase the reference count), pinned blobs
+   * won't be spilled since they may have been mapped by clients.
+   */
+  Status Pin(const ObjectID id);
+
+  /**
+   * @brief Unpin the blob (i.e., decrease the reference count).
+   */
+  Status Unpin(const ObjectID id);
+
+  /**
+   * @brief Whether any of the given blobs is pinned, the missing blobs are
+   * ignored.
+   */
+  bool Pinned(const std::set<ObjectID>& ids);
+
+  size_t SpilledObjects() const;
+  size_t SpilledSize() const;
+  size_t EvictedObjects() const;
+
+  size_t DeviceFootprint() const { return device_footprint_.load(); }
+
+  /**
+   * @brief The usage of slabs for small blobs.
+   */
+  memory::SlabAllocator::Stats SlabStats() const;
+
+  struct FragmentationStats {
+    // the free space inside the mapped segments, in bytes
+    size_t free_size = 0;
+    size_t free_blocks = 0;
+    // the largest blob that can be created without growing the segments
+    size_t largest_free_size = 0;
+  };
+
+  /**
+   * @brief Walk the allocator to collect the free ranges, the stats are empty
+   * for the jemalloc backend.
+   */
+  FragmentationStats GetFragmentationStats() const;
+
+  /**
+   * @brief Relocate unpinned blobs into the free ranges at lower addresses,
+   * so that the free space coalesces at the tail of the segments.
+   *
+   * The relocated blobs keep their ids, and their payloads are updated for
+   * future mappings. Blobs that are (or may be) mapped by clients, small
+   * blobs, blobs in arenas and spilled blobs stay put. It stops early once
+   * new blobs are created, i.e., when the store is not idle anymore.
+   */
+  Status Compact(size_t& relocated_objects, size_t& relocated_size);
+
+  /**
+   * @brief Compact the store in the background when it has been idle (no
+   * blobs being created) for `interval`, and the fragmentation, i.e.,
+   * `1 - largest_free_size / free_size`, exceeds the `threshold`.
+   */
+  void EnableCompaction(const std::chrono::seconds interval,
+                        const double threshold);
+
+  size_t RelocatedObjects() const;
+  size_t RelocatedSize() const;
+
+  /**
+   * @brief The progress of pre-faulting the shared memory, see also
+   * `memory::Prefaulter`.
+   */
+  size_t PrefaultedSize() const { return prefaulter_.Touched(); }
+  size_t PrefaultSize() const { return prefaulter_.Total(); }
+
+  /**
+   * @brief Deduplicate the blobs with identical contents in the background.
+   * The sealed blobs that are no smaller than `min_size` are hashed, and the
+   * duplicates are remapped to the existing payloads once they are no longer
+   * pinned by clients, the payload is freed when the last blob is deleted.
+   */
+  void EnableDeduplication(const size_t min_size);
+
+  /**
+   * @brief Compute the CRC32C of the sealed blobs in the background, which
+   * is carried in the payloads for the receivers of remote transfers to
+   * verify the content.
+   */
+  void EnableChecksum();
+
+  /**
+   * @brief Track the blobs charged to tenants, must be enabled before any
+   * blob is created with a tenant, see also `Create`.
+   */
+  void EnableQuotas() { quotas_ = true; }
+
+  /**
+   * @brief Publish the locations of blobs into a shared memory table of
+   * `capacity` slots, which is mapped (read-only) by clients to resolve the
+   * blobs without a round trip, see also `BlobTable`.
+   *
+   * The clients don't pin the blobs that are resolved from the table, thus
+   * it cannot be enabled together with spilling, eviction, compaction or
+   * deduplication, which move the unpinned blobs.
+   */
+  Status EnableBlobTable(const size_t capacity);
+
+  // -1 if the blob table is not enabled
+  int BlobTableFd() const { return blob_table_fd_; }
+
+  size_t BlobTableCapacity() const {
+    return blob_table_ ? blob_table_->capacity() : 0;
+  }
+
+  /**
+   * @brief The blobs have been sealed (e.g., become members of objects), and
+   * their contents won't change anymore. Sealed blobs are never evicted.
+   */
+  void Seal(const std::set<ObjectID>& ids);
+
+  size_t DeduplicatedObjects() const;
+  // the shared memory saved by deduplication, in bytes
+  size_t DeduplicatedSize() const;
+
+  /**
+   * @brief Write the persisted blobs to the backing store in the background,
+   * and re-hydrate the blobs that are missing in the shared memory from it
+   * (e.g., after a restart) when being accessed.
+   */
+  void EnableBackingStore(std::shared_ptr<BackingStore> store);
+
+  size_t UploadedObjects() const { return uploaded_objects_.load(); }
+  size_t HydratedObjects() const { return hydrated_objects_.load(); }
+
+  /**
+   * @brief Map the blobs in the snapshot file (if exists) with their original
+   * ids, the content is faulted in lazily from the page cache when being
+   * accessed. The persisted blobs will be written back to the snapshot when
+   * the store shuts down.
+   */
+  Status LoadSnapshot(const std::string& path);
+
+  /**
+   * @brief Write the persisted blobs to the snapshot file, see also
+   * `snapshot::WriteSnapshot`.
+   */
+  Status SaveSnapshot(const std::string& path);
+
+  size_t SnapshotObjects() const { return snapshot_objects_; }
+
   Status MakeArena(const size_t size, int& fd, uintptr_t& base);
 
   Status FinalizeArena(const int fd, std::vector<size_t> const& offsets,
                        std::vector<size_t> const& sizes);
 
+  /**
+   * @brief Make the blocks available as blobs while keeping the arena alive,
+   * and recycle the unused ranges of the arena.
+   */
+  Status FlushArena(const int fd, std::vector<size_t> const& offsets,
+                    std::vector<size_t> const& sizes,
+                    std::vector<size_t> const& unused_offsets,
+                    std::vector<size_t> const& unused_sizes);
+
  private:
   uint8_t* AllocateMemory(size_t size, int* fd, int64_t* map_size,
-                          ptrdiff_t* offset);
+                          ptrdiff_t* offset, int numa_node = -1);
+
+  // frees the memory returned by `AllocateMemory`
+  void FreeMemory(uint8_t* pointer, size_t size);
+
+  /**
+   * @brief Allocate memory, and spill (or evict) cold blobs when there's no
+   * enough space. Requires `spill_mutex_` been held.
+   */
+  uint8_t* AllocateMemoryWithSpill(size_t size, int* fd, int64_t* map_size,
+                                   ptrdiff_t* offset, int numa_node = -1);
+
+  /**
+   * @brief Reclaim the least recently used blob that is neither pinned nor
+   * persisted.
+   *
+   * @return false if there's no candidates. Requires `spill_mutex_` been held.
+   */
+  bool EvictColdObject();
+
+  /**
+   * @brief Publish the location of the newly inserted blob to the blob table
+   * (if enabled).
+   */
+  void PublishObject(const std::shared_ptr<Payload>& object);
+
+  /**
+   * @brief Whether the access recency of blobs needs to be tracked.
+   */
+  bool reclaimable() const { return !spill_path_.empty() || lru_eviction_; }
+
+  /**
+   * @brief Spill the least recently used spillable blob to disk.
+   *
+   * @return false if there's no candidates. Requires `spill_mutex_` been held.
+   */
+  bool SpillColdObject();
+
+  /**
+   * @brief Load a spilled blob back to shared memory.
+   */
+  Status ReloadColdObject(const std::shared_ptr<Payload>& object);
+
+  // maintains the access recency of blobs, requires `spill_mutex_` been held.
+  void TouchObject(const ObjectID id);
+  void ForgetObject(const ObjectID id);
+
+  // refunds the tenant that the blob is charged to, once being released.
+  void RefundObject(const ObjectID id);
+
+  /**
+   * @brief Release the blob, the address ranges of arena blobs are collected
+   * into `ranges` to be recycled later. Requires `spill_mutex_` been held if
+   * reclaimable or deduplicating.
+   */
+  Status ReleaseObject(const ObjectID id,
+                       std::vector<std::pair<uintptr_t, uintptr_t>>& ranges);
+
+  /**
+   * @brief Coalesce the freed ranges of arenas and issue the `madvise` in the
+   * recycler thread. Pages shared with the blobs in use are kept.
+   */
+  void RecycleArenas(
+      std::vector<std::pair<uintptr_t, uintptr_t>> const& ranges);
+
+  void RecycleLoop();
+
+  void CompactLoop();
+
+  void UploadLoop();
+
+  // hashes the sealed blobs, for deduplication and integrity checksums
+  void SealLoop();
+
+  // starts the seal thread, requires `seal_mutex_` been held.
+  void StartSealer();
+
+  bool deduplicating() const { return dedup_min_size_ > 0; }
+
+  /**
+   * @brief Remap the blob to the payload with the same content, or index the
+   * blob by the digest if there's no such payload. Requires `spill_mutex_`
+   * been held.
+   */
+  void DeduplicateObject(const ObjectID id, const uint64_t digest);
+
+  /**
+   * @brief Detach the blob from the deduplication index.
+   *
+   * @return true if the payload is still shared by other blobs, i.e., the
+   * memory cannot be freed. Requires `spill_mutex_` been held.
+   */
+  bool UnshareObject(const ObjectID id, const std::shared_ptr<Payload>& object);
+
+  // whether the payload is shared by multiple blobs, requires `spill_mutex_`
+  // been held.
+  bool IsShared(const std::shared_ptr<Payload>& object) const;
+
+  // drops the payload from the deduplication index, e.g., when it is being
+  // spilled or relocated, requires `spill_mutex_` been held.
+  void ForgetDigest(const std::shared_ptr<Payload>& object);
+
+  /**
+   * @brief Load the missing blob from the backing store, keeping its id.
+   */
+  Status HydrateObject(const ObjectID id, std::shared_ptr<Payload>& object);
+
+  // registers the blocks of the arena as blobs
+  Status RegisterArenaBlobs(const int fd, std::vector<size_t> const& offsets,
+                            std::vector<size_t> const& sizes);
+
   struct Arena {
     int fd;
     size_t size;
     uintptr_t base;
+    // the blocks that have been flushed, kept until the arena is finalized
+    std::vector<size_t> offsets, sizes;
+    // the spans are modified on both the bulk context (registering arenas,
+    // evicting) and the IPC threads (deleting), guarded by `spans_mutex`.
     static std::set<ObjectID> spans;
+    static std::mutex spans_mutex;
+
+    static bool Contains(const ObjectID id) {
+      std::lock_guard<std::mutex> lock(spans_mutex);
+      return spans.find(id) != spans.end();
+    }
   };
 
   std::unordered_map<int /* fd */, Arena> arenas_;
 
+  memory::SlabAllocator slab_;
+  memory::Prefaulter prefaulter_;
+
   using object_map_t =
       tbb::concurrent_hash_map<ObjectID, std::shared_ptr<Payload>>;
   object_map_t objects_;
+
+  std::string spill_path_;
+  bool lru_eviction_ = false;
+  // blobs in access order, the most recently used one is at the front.
+  std::list<ObjectID> lru_;
+  std::unordered_map<ObjectID, std::list<ObjectID>::iterator> lru_index_;
+  size_t spilled_objects_ = 0;
+  size_t spilled_size_ = 0;
+  size_t evicted_objects_ = 0;
+  mutable std::recursive_mutex spill_mutex_;  // protect the spill states
+
+  // the size of blobs in device memory
+  std::atomic<size_t> device_footprint_{0};
+
+  // the page ranges to be released by the recycler thread
+  std::thread recycler_;
+  std::mutex recycle_mutex_;
+  std::condition_variable recycle_cv_;
+  std::vector<std::pair<uintptr_t, uintptr_t>> recycle_queue_;
+  bool recycle_stopped_ = false;
+
+  // ids of the blobs whose ids are not their addresses (e.g., the relocated
+  // ones), by addresses. Entries are verified against `objects_` before use.
+  std::unordered_map<uintptr_t, ObjectID> relocated_;
+  size_t relocated_objects_ = 0;
+  size_t relocated_size_ = 0;
+  // the number of created blobs, for telling whether the store is idle
+  std::atomic<size_t> allocations_{0};
+
+  std::thread compactor_;
+  std::chrono::seconds compact_interval_{0};
+  double compact_threshold_ = 0;
+  std::mutex compact_mutex_;
+  std::condition_variable compact_cv_;
+  bool compact_stopped_ = false;
+
+  std::shared_ptr<BackingStore> backing_store_;
+  std::thread uploader_;
+  std::mutex upload_mutex_;
+  std::condition_variable upload_cv_;
+  std::deque<ObjectID> upload_queue_;
+  // the blob being uploaded, won't be released until it finishes
+  ObjectID uploading_ = InvalidObjectID();
+  bool upload_stopped_ = false;
+  std::atomic<size_t> uploaded_objects_{0};
+  std::atomic<size_t> hydrated_objects_{0};
+
+  // the hashed payloads by addresses, see also `EnableDeduplication`
+  struct SharedPayload {
+    uint64_t digest;
+    std::vector<ObjectID> blobs;
+  };
+  std::unordered_map<uintptr_t, SharedPayload> dedup_payloads_;
+  std::unordered_multimap<uint64_t, uintptr_t> dedup_digests_;
+  // the duplicates that are pinned, remapped once being unpinned
+  std::unordered_map<ObjectID, uint64_t> dedup_pending_;
+  size_t dedup_min_size_ = 0;
+  size_t deduplicated_objects_ = 0;
+  size_t deduplicated_size_ = 0;
+  bool checksum_ = false;
+  // the tenants that the blobs are charged to, see also `Create`
+  bool quotas_ = false;
+  std::mutex owners_mutex_;
+  std::unordered_map<ObjectID, std::pair<std::shared_ptr<Tenant>, size_t>>
+      owners_;
+  // the published blobs, see also `EnableBlobTable`
+  std::shared_ptr<BlobTable> blob_table_;
+  int blob_table_fd_ = -1;
+  // the sealed blobs to be hashed
+  std::thread sealer_;
+  std::mutex seal_mutex_;
+  std::condition_variable seal_cv_;
+  std::deque<ObjectID> seal_queue_;
+  bool seal_stopped_ = false;
+
+  // releases the mapping of a file blob once it has no blobs anymore
+  void ReleaseFileBlob(const std::shared_ptr<Payload>& object);
+
+  // the files that are mapped for file blobs, see also `CreateFromFile`.
+  struct MappedFile {
+    int fd;
+    uint8_t* base;
+    size_t size;
+    int64_t mtime;
+    std::pair<uint64_t, uint64_t> key;
+    // the number of blobs on the mapping
+    size_t blobs;
+  };
+  std::mutex files_mutex_;
+  // fd -> the mapping
+  std::map<int, MappedFile> file_mappings_;
+  // (device, inode) -> the fd of the latest mapping of the file
+  std::map<std::pair<uint64_t, uint64_t>, int> files_;
+  // the fds that have been sent to clients cannot be reused, as clients
+  // identify the mappings by them, thus the released ones are kept open on
+  // this placeholder (i.e., "/dev/null") rather than closed.
+  int placeholder_fd_ = -1;
+
+  // the mapped snapshot file, see also `LoadSnapshot`
+  std::string snapshot_path_;
+  int snapshot_fd_ = -1;
+  uint8_t* snapshot_base_ = nullptr;
+  size_t snapshot_size_ = 0;
+  size_t snapshot_objects_ = 0;
 };
 
 }  // namespace vineyard
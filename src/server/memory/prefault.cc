@@ -0,0 +1,154 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+
+#include "server/memory/prefault.h"
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <string>
+
+#include "gflags/gflags.h"
+
+#include "common/util/logging.h"
+#include "server/util/numa.h"
+
+// Fine-grained control for whether we need pre-populate the shared memory.
+//
+// Usually it causes a long wait time at the start up, but it could improved
+// the performance of visiting shared memory.
+//
+// In cases that the startup time doesn't much matter, e.g., in kubernetes
+// environment, pre-populate will archive a win.
+DEFINE_bool(reserve_memory, false, "Pre-reserving enough memory pages");
+DEFINE_int32(reserve_memory_threads, 0,
+             "The number of threads to pre-reserve the memory pages, 0 means "
+             "the number of CPUs");
+DEFINE_bool(reserve_memory_async, false,
+            "Pre-reserve the memory pages in the background while serving");
+DEFINE_string(reserve_memory_policy, "",
+              "The NUMA placement of the pre-reserved pages, can be empty "
+              "(on the node that touches the page first) or \"interleave\" "
+              "(interleaved across all NUMA nodes)");
+
+namespace vineyard {
+
+namespace memory {
+
+#ifndef MADV_POPULATE_WRITE
+#define MADV_POPULATE_WRITE 23
+#endif
+
+// the unit of pre-faulting and progress reporting
+constexpr size_t kPrefaultChunkSize = 64UL << 20;
+
+Prefaulter::~Prefaulter() { Stop(); }
+
+bool Prefaulter::Enabled() { return FLAGS_reserve_memory; }
+
+void Prefaulter::Start(void* pointer, const size_t size,
+                       const size_t page_size) {
+  bool const background = FLAGS_reserve_memory_async;
+  pointer_ = static_cast<uint8_t*>(pointer);
+  total_ = size;
+  page_size_ = std::max(page_size, static_cast<size_t>(sysconf(_SC_PAGESIZE)));
+  if (FLAGS_reserve_memory_policy == "interleave") {
+    auto status = numa::Interleave(pointer, size);
+    if (!status.ok()) {
+      LOG(WARNING) << "Failed to interleave the shared memory: "
+                   << status.ToString();
+    }
+  } else if (!FLAGS_reserve_memory_policy.empty()) {
+    LOG(WARNING) << "Unknown memory policy '" << FLAGS_reserve_memory_policy
+                 << "', ignored";
+  }
+
+  size_t chunks = (size + kPrefaultChunkSize - 1) / kPrefaultChunkSize;
+  size_t concurrency = std::max(FLAGS_reserve_memory_threads, 0);
+  if (concurrency == 0) {
+    concurrency = std::thread::hardware_concurrency();
+  }
+  concurrency = std::max<size_t>(1, std::min(concurrency, chunks));
+  LOG(INFO) << "Pre-faulting " << size << " bytes of shared memory with "
+            << concurrency << " threads"
+            << (background ? " in the background" : "");
+  for (size_t index = 0; index < concurrency; ++index) {
+    workers_.emplace_back([this]() { this->run(); });
+  }
+  if (!background) {
+    for (auto& worker : workers_) {
+      worker.join();
+    }
+    workers_.clear();
+  }
+}
+
+void Prefaulter::Stop() {
+  stopped_.store(true);
+  for (auto& worker : workers_) {
+    if (worker.joinable()) {
+      worker.join();
+    }
+  }
+  workers_.clear();
+}
+
+void Prefaulter::run() {
+  size_t const chunks = (total_ + kPrefaultChunkSize - 1) / kPrefaultChunkSize;
+  while (!stopped_.load()) {
+    size_t chunk = next_chunk_.fetch_add(1);
+    if (chunk >= chunks) {
+      break;
+    }
+    size_t offset = chunk * kPrefaultChunkSize;
+    size_t size = std::min(kPrefaultChunkSize, total_ - offset);
+    Touch(pointer_ + offset, size, page_size_);
+    if (touched_.fetch_add(size) + size >= total_) {
+      LOG(INFO) << "Finished pre-faulting " << total_
+                << " bytes of shared memory";
+    }
+  }
+}
+
+void Prefaulter::Touch(uint8_t* begin, const size_t size,
+                       const size_t page_size) {
+#if defined(__linux__)
+  // populates the page tables without touching the content (Linux 5.14+)
+  uintptr_t aligned =
+      reinterpret_cast<uintptr_t>(begin) / page_size * page_size;
+  if (madvise(reinterpret_cast<void*>(aligned),
+              reinterpret_cast<uintptr_t>(begin) + size - aligned,
+              MADV_POPULATE_WRITE) == 0) {
+    return;
+  }
+#endif
+  // n.b.: the blobs may be written concurrently when pre-faulting in the
+  // background, a no-op atomic write faults the page in and keeps the
+  // content.
+  for (size_t offset = 0; offset < size; offset += page_size) {
+    __atomic_fetch_or(begin + offset, static_cast<uint8_t>(0),
+                      __ATOMIC_RELAXED);
+  }
+  if (size > 0) {
+    __atomic_fetch_or(begin + size - 1, static_cast<uint8_t>(0),
+                      __ATOMIC_RELAXED);
+  }
+}
+
+}  // namespace memory
+
+}  // namespace vineyard
@@ -0,0 +1,91 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+
+#ifndef SRC_SERVER_MEMORY_PREFAULT_H_
+#define SRC_SERVER_MEMORY_PREFAULT_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+namespace vineyard {
+
+namespace memory {
+
+/**
+ * @brief Prefaulter pre-touches the pages of the shared memory arena with
+ * multiple threads, to avoid the page-fault storms when clients touch the
+ * blobs for the first time.
+ *
+ * The range is touched by chunks without changing the content, thus it is
+ * safe to pre-fault in the background while blobs are being served.
+ */
+class Prefaulter {
+ public:
+  Prefaulter() = default;
+
+  ~Prefaulter();
+
+  /**
+   * @brief Whether the pre-faulting is requested, i.e., the
+   * "--reserve_memory" option is set.
+   */
+  static bool Enabled();
+
+  /**
+   * @brief Pre-fault the given range with "--reserve_memory_threads" threads.
+   * Returns immediately when "--reserve_memory_async" is set, otherwise waits
+   * for the pre-faulting finishes.
+   */
+  void Start(void* pointer, const size_t size, const size_t page_size);
+
+  /**
+   * @brief Stop the pre-faulting, the touched pages are kept.
+   */
+  void Stop();
+
+  size_t Touched() const { return touched_.load(); }
+
+  size_t Total() const { return total_; }
+
+  bool Done() const { return touched_.load() >= total_; }
+
+  /**
+   * @brief Fault in the pages of the given range in the calling thread
+   * without changing the content.
+   */
+  static void Touch(uint8_t* begin, const size_t size, const size_t page_size);
+
+ private:
+  void run();
+
+  uint8_t* pointer_ = nullptr;
+  size_t total_ = 0;
+  size_t page_size_ = 4096;
+
+  std::atomic<size_t> next_chunk_{0};
+  std::atomic<size_t> touched_{0};
+  std::atomic_bool stopped_{false};
+  std::vector<std::thread> workers_;
+};
+
+}  // namespace memory
+
+}  // namespace vineyard
+
+#endif  // SRC_SERVER_MEMORY_PREFAULT_H_
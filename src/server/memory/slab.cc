@@ -0,0 +1,172 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "server/memory/slab.h"
+
+#include <algorithm>
+
+#include "common/util/logging.h"
+#include "server/memory/allocator.h"
+#include "server/memory/malloc.h"
+
+namespace vineyard {
+
+namespace memory {
+
+namespace {
+
+constexpr uint64_t kPointerMask = (1UL << 48) - 1;
+
+constexpr size_t kAlignment = static_cast<size_t>(kBlockSize);
+
+inline void* untag(const uint64_t head) {
+  return reinterpret_cast<void*>(head & kPointerMask);
+}
+
+inline uint64_t retag(const void* pointer, const uint64_t head) {
+  return (reinterpret_cast<uint64_t>(pointer) & kPointerMask) |
+         ((head & ~kPointerMask) + (1UL << 48));
+}
+
+inline void*& next_of(void* item) { return *reinterpret_cast<void**>(item); }
+
+}  // namespace
+
+void SlabAllocator::Init(const size_t max_size) {
+  // classes are spaced by 1.5x, the classes that are not less than the block
+  // size are multiples of it to keep the alignment.
+  std::vector<size_t> item_sizes{16, 32, 48};
+  for (size_t item_size = kAlignment;
+       item_size <= max_size && item_size <= kSlabSize / 16; item_size *= 2) {
+    item_sizes.emplace_back(item_size);
+    if (item_size >= 2 * kAlignment && item_size + item_size / 2 <= max_size) {
+      item_sizes.emplace_back(item_size + item_size / 2);
+    }
+  }
+  while (!item_sizes.empty() && item_sizes.back() > max_size) {
+    item_sizes.pop_back();
+  }
+  if (item_sizes.empty()) {
+    max_size_ = 0;
+    return;
+  }
+  std::sort(item_sizes.begin(), item_sizes.end());
+  max_size_ = item_sizes.back();
+  index_.resize(max_size_ / kGranularity + 1, 0);
+  size_t granule = 0;
+  for (size_t idx = 0; idx < item_sizes.size(); ++idx) {
+    classes_.emplace_back(new size_class_t());
+    classes_.back()->item_size = item_sizes[idx];
+    for (; granule * kGranularity <= item_sizes[idx]; ++granule) {
+      index_[granule] = static_cast<uint8_t>(idx);
+    }
+  }
+  LOG(INFO) << "Blobs no larger than " << max_size_ << " bytes are served in "
+            << classes_.size() << " size classes";
+}
+
+void* SlabAllocator::Allocate(const size_t size) {
+  size_class_t& cls = classOf(size);
+  void* item = pop(cls);
+  while (item == nullptr) {
+    if (!grow(cls)) {
+      return nullptr;
+    }
+    item = pop(cls);
+  }
+  cls.items += 1;
+  cls.size += size;
+  return item;
+}
+
+void SlabAllocator::Free(void* pointer, const size_t size) {
+  size_class_t& cls = classOf(size);
+  cls.items -= 1;
+  cls.size -= size;
+  next_of(pointer) = nullptr;
+  push(cls, pointer, pointer);
+}
+
+bool SlabAllocator::ReallocateInPlace(void* pointer, const size_t size,
+                                      const size_t new_size) {
+  if (!Handles(new_size) || &classOf(size) != &classOf(new_size)) {
+    return false;
+  }
+  size_class_t& cls = classOf(size);
+  cls.size += new_size - size;
+  return true;
+}
+
+SlabAllocator::Stats SlabAllocator::GetStats() const {
+  Stats stats;
+  for (auto const& cls : classes_) {
+    stats.items += cls->items.load();
+    stats.size += cls->size.load();
+    stats.capacity += cls->capacity.load();
+  }
+  return stats;
+}
+
+void* SlabAllocator::pop(size_class_t& cls) {
+  uint64_t head = cls.head.load(std::memory_order_acquire);
+  while (true) {
+    void* item = untag(head);
+    if (item == nullptr) {
+      return nullptr;
+    }
+    // n.b.: the item may have been popped by others in the meantime, the
+    // value is stale then and the tag makes the exchange fail. Slabs are
+    // never unmapped thus the read is always valid.
+    void* next = next_of(item);
+    if (cls.head.compare_exchange_weak(head, retag(next, head),
+                                       std::memory_order_acq_rel,
+                                       std::memory_order_acquire)) {
+      return item;
+    }
+  }
+}
+
+void SlabAllocator::push(size_class_t& cls, void* first, void* last) {
+  uint64_t head = cls.head.load(std::memory_order_relaxed);
+  do {
+    next_of(last) = untag(head);
+  } while (!cls.head.compare_exchange_weak(head, retag(first, head),
+                                           std::memory_order_release,
+                                           std::memory_order_relaxed));
+}
+
+bool SlabAllocator::grow(size_class_t& cls) {
+  std::lock_guard<std::mutex> lock(cls.grow_mutex);
+  if (untag(cls.head.load(std::memory_order_acquire)) != nullptr) {
+    // has been grown by others
+    return true;
+  }
+  uint8_t* slab =
+      static_cast<uint8_t*>(BulkAllocator::Memalign(kSlabSize, kAlignment));
+  if (slab == nullptr) {
+    return false;
+  }
+  size_t count = kSlabSize / cls.item_size;
+  for (size_t idx = 0; idx + 1 < count; ++idx) {
+    next_of(slab + idx * cls.item_size) = slab + (idx + 1) * cls.item_size;
+  }
+  push(cls, slab, slab + (count - 1) * cls.item_size);
+  cls.capacity += count * cls.item_size;
+  return true;
+}
+
+}  // namespace memory
+
+}  // namespace vineyard
@@ -0,0 +1,111 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef SRC_SERVER_MEMORY_SLAB_H_
+#define SRC_SERVER_MEMORY_SLAB_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace vineyard {
+
+namespace memory {
+
+/**
+ * @brief SlabAllocator serves small blobs from size classes, to avoid the
+ * space overhead and the lock contention of the bulk allocator for massive
+ * tiny blobs.
+ *
+ * Slabs are taken from the bulk allocator in batches and carved into items of
+ * a size class. Freed items go back to the lock-free free list of the class,
+ * slabs are kept for reusing and never returned to the bulk allocator.
+ *
+ * Items are routed by size, i.e., a blob must be freed with the size that it
+ * is allocated (or extended in place) with.
+ */
+class SlabAllocator {
+ public:
+  struct Stats {
+    // the number of items in use
+    size_t items = 0;
+    // the total requested size of items in use, in bytes
+    size_t size = 0;
+    // the total size of slabs, in bytes
+    size_t capacity = 0;
+  };
+
+  /**
+   * @brief Serve blobs that are no larger than `max_size`, 0 means disable.
+   */
+  void Init(const size_t max_size);
+
+  bool Handles(const size_t size) const {
+    return size != 0 && size <= max_size_;
+  }
+
+  void* Allocate(const size_t size);
+
+  void Free(void* pointer, const size_t size);
+
+  /**
+   * @brief The item can be grown in place as long as the size class doesn't
+   * change.
+   */
+  bool ReallocateInPlace(void* pointer, const size_t size,
+                         const size_t new_size);
+
+  Stats GetStats() const;
+
+  static constexpr size_t kSlabSize = 256 * 1024;  // 256KB
+
+ private:
+  struct size_class_t {
+    size_t item_size = 0;
+    // the head of the free list, tagged by a counter in the higher 16 bits
+    // to avoid the ABA problem.
+    std::atomic<uint64_t> head{0};
+    std::mutex grow_mutex;
+    std::atomic<size_t> items{0}, size{0}, capacity{0};
+  };
+
+  size_class_t& classOf(const size_t size) {
+    return *classes_[index_[(size + kGranularity - 1) / kGranularity]];
+  }
+
+  void* pop(size_class_t& cls);
+
+  // pushes the linked items [first, last] to the free list
+  void push(size_class_t& cls, void* first, void* last);
+
+  // carves a new slab into the free list
+  bool grow(size_class_t& cls);
+
+  static constexpr size_t kGranularity = 16;
+
+  size_t max_size_ = 0;
+  std::vector<std::unique_ptr<size_class_t>> classes_;
+  // size in granularity -> the index of size class
+  std::vector<uint8_t> index_;
+};
+
+}  // namespace memory
+
+}  // namespace vineyard
+
+#endif  // SRC_SERVER_MEMORY_SLAB_H_
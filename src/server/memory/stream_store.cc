@@ -15,45 +15,109 @@ limitations under the License.
 
 #include "server/memory/stream_store.h"
 
+#include <algorithm>
+#include <iterator>
 #include <memory>
+#include <mutex>
+#include <set>
+#include <string>
 #include <utility>
+#include <vector>
 
 #include "common/util/callback.h"
 #include "common/util/logging.h"
 #include "server/memory/memory.h"
+#include "server/util/metrics.h"
 
 namespace vineyard {
 
+static void delivered(size_t const size) {
+  static metrics::Counter& delivered_bytes =
+      metrics::Registry::Default().GetCounter(
+          "vineyard_stream_delivered_bytes_total",
+          "The size of chunks delivered to the consumers of streams, in bytes");
+  delivered_bytes.Add(size);
+}
+
 #ifndef CHECK_STREAM_STATE
 #define CHECK_STREAM_STATE(condition)                                  \
   do {                                                                 \
     if (!(condition)) {                                                \
       LOG(ERROR) << "Stream state error(" __FILE__                     \
                     ":" VINEYARD_TO_STRING(__LINE__) "): " #condition; \
-      return callback(Status::InvalidStreamState(#condition),          \
-                      InvalidObjectID());                              \
+      return callback(Status::InvalidStreamState(#condition), {});     \
     }                                                                  \
   } while (0)
 #endif  // CHECK_STREAM_STATE
 
 // manage a pool of streams.
-Status StreamStore::Create(ObjectID const stream_id) {
-  if (streams_.find(stream_id) != streams_.end()) {
+Status StreamStore::Create(ObjectID const stream_id,
+                           size_t const retain_chunks,
+                           size_t const retain_bytes,
+                           size_t const budget_bytes) {
+  auto& shard = shards_[stream_id % kShards];
+  std::lock_guard<std::mutex> lock(shard.mutex);
+  if (shard.streams.find(stream_id) != shard.streams.end()) {
     return Status::ObjectExists();
   }
-  streams_.emplace(stream_id, std::make_shared<StreamHolder>());
+  auto stream = std::make_shared<StreamHolder>();
+  stream->retain_chunks = retain_chunks;
+  stream->retain_bytes = retain_bytes;
+  stream->budget_bytes = budget_bytes;
+  // the readers of replayable streams consume with cursors as well
+  stream->cursored = stream->replayable();
+  shard.streams.emplace(stream_id, stream);
+  active_streams_ += 1;
   return Status::OK();
 }
 
-Status StreamStore::Open(ObjectID const stream_id, int64_t const mode) {
-  if (streams_.find(stream_id) == streams_.end()) {
+Status StreamStore::Open(ObjectID const stream_id, int64_t const mode,
+                         int64_t const consumer, int64_t const offset) {
+  auto stream = find(stream_id);
+  if (stream == nullptr) {
     return Status::ObjectNotExists("stream cannot be open: " +
                                    ObjectIDToString(stream_id));
   }
-  if (streams_[stream_id]->open_mark & mode) {
+  std::lock_guard<std::recursive_mutex> guard(stream->mutex);
+  if ((mode & kBroadcastMode) ||
+      ((mode & kReadMode) && stream->replayable())) {
+    // a broadcast stream cannot have an exclusive reader, and vice versa.
+    if (mode & kBroadcastMode) {
+      if ((stream->open_mark & kReadMode) ||
+          stream->consumers_.find(consumer) != stream->consumers_.end()) {
+        return Status::StreamOpened();
+      }
+    } else if (!stream->consumers_.empty()) {
+      return Status::StreamOpened();
+    }
+    uint64_t end = stream->base_ + stream->retained_.size() +
+                   stream->ready_chunks_.size();
+    if (offset >= 0 && (static_cast<uint64_t>(offset) < stream->base_ ||
+                        static_cast<uint64_t>(offset) > end)) {
+      return Status::Invalid(
+          "The offset " + std::to_string(offset) +
+          " is out of the retained chunks of stream: [" +
+          std::to_string(stream->base_) + ", " + std::to_string(end) + "]");
+    }
+    if (!stream->cursored) {
+      // chunks that sealed before the first consumer comes are retained
+      stream->cursored = true;
+      while (!stream->ready_chunks_.empty()) {
+        RETURN_ON_ERROR(retain(stream, stream->ready_chunks_.front()));
+        stream->ready_chunks_.pop();
+      }
+    }
+    // starts from the oldest chunk that still been retained by default
+    stream->consumers_[consumer].cursor =
+        offset >= 0 ? static_cast<uint64_t>(offset) : stream->base_;
+    stream->open_mark |= mode;
+    return Status::OK();
+  }
+  if ((stream->open_mark & mode) ||
+      ((mode & kReadMode) && stream->cursored)) {
     return Status::StreamOpened();
   }
-  streams_[stream_id]->open_mark |= mode;
+  stream->open_mark |= mode;
   return Status::OK();
 }
 
@@ -61,116 +125,146 @@ Status StreamStore::Open(ObjectID const stream_id, int64_t const mode) {
 // available for consumer to read
 Status StreamStore::Get(ObjectID const stream_id, size_t const size,
                         callback_t<const ObjectID> callback) {
-  if (streams_.find(stream_id) == streams_.end()) {
+  return Get(stream_id, std::vector<size_t>{size},
+             [callback](const Status& status,
+                        const std::vector<ObjectID>& chunks) {
+               if (!status.ok()) {
+                 return callback(status, InvalidObjectID());
+               }
+               return callback(status, chunks.front());
+             });
+}
+
+Status StreamStore::Get(ObjectID const stream_id,
+                        std::vector<size_t> const& sizes,
+                        callback_t<const std::vector<ObjectID>&> callback) {
+  auto stream = find(stream_id);
+  if (stream == nullptr) {
     return callback(Status::ObjectNotExists("failed to pull from stream"),
-                    InvalidObjectID());
+                    {});
   }
-  auto stream = streams_.at(stream_id);
+  std::lock_guard<std::recursive_mutex> guard(stream->mutex);
 
   // precondition: there's no unsatistified writer, and still running
   CHECK_STREAM_STATE(!stream->writer_);
   CHECK_STREAM_STATE(!stream->drained && !stream->failed);
+  CHECK_STREAM_STATE(!sizes.empty());
 
-  // seal current chunk
-  if (stream->current_writing_) {
-    stream->ready_chunks_.push(stream->current_writing_.get());
-    stream->current_writing_ = boost::none;
-  }
-  // weak up the pending reader
-  if (stream->reader_) {
-    // should be no reading chunk
-    CHECK_STREAM_STATE(!stream->current_reading_);
-    if (!stream->ready_chunks_.empty()) {
-      stream->current_reading_ = stream->ready_chunks_.front();
-      stream->ready_chunks_.pop();
-      VINEYARD_SUPPRESS(
-          stream->reader_.get()(Status::OK(), stream->current_reading_.get()));
-      stream->reader_ = boost::none;
+  // seal current chunks, and weak up the pending reader
+  {
+    auto status = seal(stream);
+    if (!status.ok()) {
+      return callback(status, {});
     }
   }
 
-  if (allocatable(stream, size)) {
+  if (admissible(stream, sizes)) {
     // do allocation
-    ObjectID chunk;
-    std::shared_ptr<Payload> object;
-    auto status = store_->Create(size, chunk, object);
+    auto status = allocateAll(stream, sizes);
     if (!status.ok()) {
-      return callback(status, InvalidObjectID());
+      return callback(status, {});
     } else {
-      stream->current_writing_ = chunk;
-      return callback(Status::OK(), stream->current_writing_.get());
+      // the writer may seal them at once, see also `Seal`.
+      auto chunks = stream->current_writing_;
+      return callback(Status::OK(), chunks);
     }
   } else {
     // pending the writer
-    stream->writer_ = std::make_pair(size, callback);
+    stream->writer_ = std::make_pair(sizes, callback);
+    blocked_writers_ += 1;
     return Status::OK();
   }
 }
 
+Status StreamStore::Seal(ObjectID const stream_id) {
+  auto stream = find(stream_id);
+  if (stream == nullptr) {
+    return Status::ObjectNotExists("failed to seal stream: " +
+                                   ObjectIDToString(stream_id));
+  }
+  std::lock_guard<std::recursive_mutex> guard(stream->mutex);
+  return seal(stream);
+}
+
 // for consumer: read current chunk
-Status StreamStore::Pull(ObjectID const stream_id,
+Status StreamStore::Pull(ObjectID const stream_id, int64_t const consumer,
                          callback_t<const ObjectID> callback) {
-  if (streams_.find(stream_id) == streams_.end()) {
-    return callback(Status::ObjectNotExists("failed to put to stream"),
-                    InvalidObjectID());
+  return pull(stream_id, consumer,
+              StreamHolder::read_t{
+                  1, false,
+                  [callback](const Status& status,
+                             const std::vector<ObjectID>& chunks) {
+                    if (!status.ok()) {
+                      return callback(status, InvalidObjectID());
+                    }
+                    return callback(status, chunks.front());
+                  }});
+}
+
+Status StreamStore::Pull(ObjectID const stream_id, int64_t const consumer,
+                         size_t const limit,
+                         callback_t<const std::vector<ObjectID>&> callback) {
+  return pull(stream_id, consumer,
+              StreamHolder::read_t{std::max(limit, static_cast<size_t>(1)),
+                                   true, callback});
+}
+
+Status StreamStore::pull(ObjectID const stream_id, int64_t const consumer,
+                         StreamHolder::read_t const& read) {
+  auto& callback = read.callback;
+  auto stream = find(stream_id);
+  if (stream == nullptr) {
+    return callback(Status::ObjectNotExists("failed to put to stream"), {});
+  }
+  std::lock_guard<std::recursive_mutex> guard(stream->mutex);
+  if (stream->cursored) {
+    return pullBroadcast(stream, consumer, read);
   }
-  auto stream = streams_.at(stream_id);
 
   // precondition: there's no unsatistified reader
   CHECK_STREAM_STATE(!stream->reader_);
 
   // drop current reading
   if (stream->current_reading_) {
-    auto status = store_->Delete(stream->current_reading_.get());
+    auto status = recycle(stream, stream->current_reading_.get());
     if (!status.ok()) {
-      return callback(status, InvalidObjectID());
+      return callback(status, {});
     }
     stream->current_reading_ = boost::none;
   }
   // wake up the pending writer
-  if (stream->writer_) {
-    // should be no writing chunk
-    CHECK_STREAM_STATE(!stream->current_writing_);
-    auto writer = stream->writer_.get();
-    if (allocatable(stream, writer.first)) {
-      ObjectID chunk;
-      std::shared_ptr<Payload> object;
-      auto status = store_->Create(writer.first, chunk, object);
-      if (!status.ok()) {
-        VINEYARD_SUPPRESS(writer.second(status, InvalidObjectID()));
-      } else {
-        stream->current_writing_ = chunk;
-        VINEYARD_SUPPRESS(
-            writer.second(Status::OK(), stream->current_writing_.get()));
-        stream->writer_ = boost::none;
-      }
+  {
+    auto status = wakeupWriter(stream);
+    if (!status.ok()) {
+      return callback(status, {});
     }
   }
 
   if (!stream->ready_chunks_.empty()) {
-    stream->current_reading_ = stream->ready_chunks_.front();
-    stream->ready_chunks_.pop();
-    return callback(Status::OK(), stream->current_reading_.get());
+    RETURN_ON_ERROR(deliver(stream, read));
+    // the transient chunks have been released
+    return wakeupWriter(stream);
   } else {
     // if stream has been stoped, return a proper status.
     if (stream->drained) {
-      return callback(Status::StreamDrained(), InvalidObjectID());
+      return callback(Status::StreamDrained(), {});
     } else if (stream->failed) {
-      return callback(Status::StreamFailed(), InvalidObjectID());
+      return callback(Status::StreamFailed(), {});
     } else {
       // pending the reader
-      stream->reader_ = callback;
+      stream->reader_ = read;
       return Status::OK();
     }
   }
 }
 
 Status StreamStore::Stop(ObjectID const stream_id, bool failed) {
-  if (streams_.find(stream_id) == streams_.end()) {
+  auto stream = find(stream_id);
+  if (stream == nullptr) {
     return Status::ObjectNotExists("failed to stop stream: " +
                                    ObjectIDToString(stream_id));
   }
-  auto stream = streams_.at(stream_id);
+  std::lock_guard<std::recursive_mutex> guard(stream->mutex);
   // the stream is still running
   if (stream->drained || stream->failed) {
     return Status::InvalidStreamState("Stream already stoped");
@@ -179,41 +273,37 @@ Status StreamStore::Stop(ObjectID const stream_id, bool failed) {
   if (stream->writer_) {
     return Status::InvalidStreamState("Still pending writer on stream");
   }
-  // seal current writing chunk
-  if (stream->current_writing_) {
-    stream->ready_chunks_.push(stream->current_writing_.get());
-    stream->current_writing_ = boost::none;
-  }
+  // seal current writing chunks
+  RETURN_ON_ERROR(seal(stream));
   // stop
   if (failed) {
     stream->failed = true;
   } else {
     stream->drained = true;
   }
+  // the producer won't ask for chunks anymore
+  deactivate(stream);
+  RETURN_ON_ERROR(releasePool(stream));
+  if (stream->cursored) {
+    return notifyConsumers(stream);
+  }
   // weak up the pending reader
   if (stream->reader_) {
+    auto read = stream->reader_.get();
+    stream->reader_ = boost::none;
     // should be no reading chunk
     if (stream->current_reading_) {
       auto err =
           Status::InvalidStreamState("Shouldn't exists a being read chunk");
-      VINEYARD_SUPPRESS(stream->reader_.get()(err, InvalidObjectID()));
-      stream->reader_ = boost::none;
+      VINEYARD_SUPPRESS(read.callback(err, {}));
       return err;
     }
     if (stream->failed) {
-      VINEYARD_SUPPRESS(
-          stream->reader_.get()(Status::StreamFailed(), InvalidObjectID()));
-      stream->reader_ = boost::none;
+      VINEYARD_SUPPRESS(read.callback(Status::StreamFailed(), {}));
     } else if (!stream->ready_chunks_.empty()) {
-      stream->current_reading_ = stream->ready_chunks_.front();
-      stream->ready_chunks_.pop();
-      VINEYARD_SUPPRESS(
-          stream->reader_.get()(Status::OK(), stream->current_reading_.get()));
-      stream->reader_ = boost::none;
+      VINEYARD_SUPPRESS(deliver(stream, read));
     } else if (stream->drained) {
-      VINEYARD_SUPPRESS(
-          stream->reader_.get()(Status::StreamFailed(), InvalidObjectID()));
-      stream->reader_ = boost::none;
+      VINEYARD_SUPPRESS(read.callback(Status::StreamFailed(), {}));
     } else {
       RETURN_ON_ASSERT(false, "Impossible!");
     }
@@ -221,13 +311,34 @@ Status StreamStore::Stop(ObjectID const stream_id, bool failed) {
   return Status::OK();
 }
 
-Status StreamStore::Drop(ObjectID const stream_id) {
-  if (streams_.find(stream_id) == streams_.end()) {
+Status StreamStore::Drop(ObjectID const stream_id, int64_t const consumer) {
+  auto stream = find(stream_id);
+  if (stream == nullptr) {
     return Status::ObjectNotExists("failed to drop stream: " +
                                    ObjectIDToString(stream_id));
   }
-  auto stream = streams_.at(stream_id);
+  std::lock_guard<std::recursive_mutex> guard(stream->mutex);
+  if (stream->cursored) {
+    // the chunks that only wait for the lost consumer can be freed now.
+    if (stream->consumers_.erase(consumer) == 0) {
+      return Status::OK();
+    }
+    if (stream->consumers_.empty()) {
+      // the exclusive reader is gone, e.g., crashed, thus it can be reopened.
+      stream->open_mark &= ~kReadMode;
+    }
+    RETURN_ON_ERROR(collect(stream));
+    return wakeupWriter(stream);
+  }
   stream->failed = true;
+  deactivate(stream);
+  // the pending writer won't be satisfied anymore
+  if (stream->writer_) {
+    auto writer = stream->writer_.get();
+    stream->writer_ = boost::none;
+    blocked_writers_ -= 1;
+    VINEYARD_SUPPRESS(writer.second(Status::StreamFailed(), {}));
+  }
   // weakup pending reader
   if (stream->reader_) {
     // should be no reading chunk
@@ -235,26 +346,432 @@ Status StreamStore::Drop(ObjectID const stream_id) {
       return Status::InvalidStreamState("Shouldn't exists a being read chunk");
     }
     VINEYARD_SUPPRESS(
-        stream->reader_.get()(Status::StreamFailed(), InvalidObjectID()));
+        stream->reader_.get().callback(Status::StreamFailed(), {}));
     stream->reader_ = boost::none;
   }
   // drop all memory chunks in ready queue, but still keep the reading chunk
   // to avoid crash the reader
   while (!stream->ready_chunks_.empty()) {
-    RETURN_ON_ERROR(store_->Delete(stream->ready_chunks_.front()));
+    ObjectID chunk = stream->ready_chunks_.front();
+    backlog_bytes_ -= chunkSize(chunk);
     stream->ready_chunks_.pop();
+    RETURN_ON_ERROR(release(stream, chunk));
   }
-  return Status::OK();
+  return releasePool(stream);
+}
+
+void StreamStore::Inspect(json& tree) {
+  std::vector<std::pair<ObjectID, std::shared_ptr<StreamHolder>>> streams;
+  for (auto& shard : shards_) {
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    streams.insert(streams.end(), shard.streams.begin(), shard.streams.end());
+  }
+  json items = json::array();
+  for (auto const& item : streams) {
+    auto const& stream = item.second;
+    std::lock_guard<std::recursive_mutex> guard(stream->mutex);
+    json entry;
+    entry["id"] = ObjectIDToString(item.first);
+    entry["open_mark"] = stream->open_mark;
+    entry["active"] = stream->active;
+    entry["drained"] = stream->drained;
+    entry["failed"] = stream->failed;
+    entry["ready_chunks"] = stream->ready_chunks_.size();
+    entry["writing_chunks"] = stream->current_writing_.size();
+    entry["pooled_chunks"] = stream->pool_.size();
+    entry["reading"] = static_cast<bool>(stream->current_reading_);
+    entry["reader_blocked"] = static_cast<bool>(stream->reader_);
+    entry["writer_blocked"] = static_cast<bool>(stream->writer_);
+    entry["held_bytes"] = stream->held_bytes;
+    entry["budget_bytes"] = stream->budget_bytes;
+    if (stream->cursored) {
+      uint64_t end = stream->base_ + stream->retained_.size();
+      entry["retained_chunks"] = stream->retained_.size();
+      entry["base"] = stream->base_;
+      json consumers = json::array();
+      for (auto const& consumer : stream->consumers_) {
+        consumers.push_back(json{
+            {"consumer", consumer.first},
+            {"cursor", consumer.second.cursor},
+            {"lag", end - std::min(end, consumer.second.cursor)},
+            {"reading", consumer.second.reading},
+            {"blocked", static_cast<bool>(consumer.second.reader)}});
+      }
+      entry["consumers"] = consumers;
+    }
+    items.push_back(entry);
+  }
+  tree["streams"] = items;
+  tree["held_bytes"] = HeldBytes();
+  tree["backlog_bytes"] = BacklogBytes();
+  tree["blocked_writers"] = BlockedWriters();
+  tree["active_streams"] = ActiveStreams();
+}
+
+std::shared_ptr<StreamHolder> StreamStore::find(ObjectID const stream_id) {
+  auto& shard = shards_[stream_id % kShards];
+  std::lock_guard<std::mutex> lock(shard.mutex);
+  auto iter = shard.streams.find(stream_id);
+  if (iter == shard.streams.end()) {
+    return nullptr;
+  }
+  return iter->second;
 }
 
 bool StreamStore::allocatable(std::shared_ptr<StreamHolder> stream,
                               size_t size) {
-  if (store_->Footprint() + size <
-      store_->FootprintLimit() * threshold_ / 100.0) {
+  double limit = store_->FootprintLimit() * threshold_ / 100.0;
+  if (store_->Footprint() + size >= limit) {
+    return false;
+  }
+  if (size == 0 || stream->held_bytes == 0) {
     return true;
-  } else {
+  }
+  size_t held = stream->held_bytes + size;
+  if (stream->budget_bytes > 0 && held > stream->budget_bytes) {
     return false;
   }
+  // the pending writer of this stream (if any) is not counted
+  size_t others = blocked_writers_.load() - (stream->writer_ ? 1 : 0);
+  size_t active = std::max(active_streams_.load(), static_cast<size_t>(1));
+  return others == 0 || held <= limit / active;
+}
+
+Status StreamStore::allocate(std::shared_ptr<StreamHolder> stream,
+                             size_t size, ObjectID& chunk) {
+  // chunks of a stream are usually in the same size, the most recently
+  // recycled one is preferred as its pages are more likely to be hot.
+  static auto& registry = metrics::Registry::Default();
+  static metrics::Counter& pooled_chunks = registry.GetCounter(
+      "vineyard_stream_chunks_total",
+      "The number of chunks allocated for streams", "source=\"pool\"");
+  static metrics::Counter& created_chunks = registry.GetCounter(
+      "vineyard_stream_chunks_total",
+      "The number of chunks allocated for streams", "source=\"store\"");
+  static metrics::Counter& chunk_bytes = registry.GetCounter(
+      "vineyard_stream_chunk_bytes_total",
+      "The size of chunks allocated for streams, in bytes");
+  chunk_bytes.Add(size);
+  for (auto iter = stream->pool_.rbegin(); iter != stream->pool_.rend();
+       ++iter) {
+    if (iter->first == size) {
+      chunk = iter->second;
+      stream->pool_.erase(std::next(iter).base());
+      pooled_chunks.Add();
+      return Status::OK();
+    }
+  }
+  created_chunks.Add();
+  std::shared_ptr<Payload> object;
+  RETURN_ON_ERROR(store_->Create(size, chunk, object));
+  stream->held_bytes += size;
+  held_bytes_ += size;
+  return Status::OK();
+}
+
+Status StreamStore::recycle(std::shared_ptr<StreamHolder> stream,
+                            ObjectID const chunk) {
+  std::shared_ptr<Payload> object;
+  if (pool_depth_ == 0 || stream->drained || stream->failed ||
+      !allocatable(stream, 0) || !store_->Get(chunk, object).ok() ||
+      object->data_size == 0) {
+    return release(stream, chunk);
+  }
+  stream->pool_.emplace_back(object->data_size, chunk);
+  // evicts the oldest one when the pool is full
+  if (stream->pool_.size() > pool_depth_) {
+    ObjectID victim = stream->pool_.front().second;
+    stream->pool_.pop_front();
+    return release(stream, victim);
+  }
+  return Status::OK();
+}
+
+Status StreamStore::releasePool(std::shared_ptr<StreamHolder> stream) {
+  auto status = Status::OK();
+  while (!stream->pool_.empty()) {
+    auto s = release(stream, stream->pool_.front().second);
+    if (!s.ok()) {
+      status = s;
+    }
+    stream->pool_.pop_front();
+  }
+  return status;
+}
+
+Status StreamStore::release(std::shared_ptr<StreamHolder> stream,
+                            ObjectID const chunk) {
+  size_t size = std::min(stream->held_bytes, chunkSize(chunk));
+  stream->held_bytes -= size;
+  held_bytes_ -= size;
+  return store_->Delete(chunk);
+}
+
+size_t StreamStore::chunkSize(ObjectID const chunk) {
+  std::shared_ptr<Payload> object;
+  if (store_->Get(chunk, object).ok()) {
+    return object->data_size;
+  }
+  return 0;
+}
+
+void StreamStore::deactivate(std::shared_ptr<StreamHolder> stream) {
+  if (stream->active) {
+    stream->active = false;
+    active_streams_ -= 1;
+  }
+}
+
+bool StreamStore::admissible(std::shared_ptr<StreamHolder> stream,
+                             std::vector<size_t> const& sizes) {
+  // pooled chunks are reused without increasing the footprint
+  std::multiset<size_t> pooled;
+  for (auto const& item : stream->pool_) {
+    pooled.emplace(item.first);
+  }
+  bool reused = true;
+  size_t required = 0;
+  for (auto const size : sizes) {
+    auto iter = pooled.find(size);
+    if (iter != pooled.end()) {
+      pooled.erase(iter);
+    } else {
+      reused = false;
+      required += size;
+    }
+  }
+  return reused || allocatable(stream, required);
+}
+
+Status StreamStore::allocateAll(std::shared_ptr<StreamHolder> stream,
+                                std::vector<size_t> const& sizes) {
+  for (auto const size : sizes) {
+    ObjectID chunk;
+    auto status = allocate(stream, size, chunk);
+    if (!status.ok()) {
+      for (auto const& allocated : stream->current_writing_) {
+        VINEYARD_SUPPRESS(release(stream, allocated));
+      }
+      stream->current_writing_.clear();
+      return status;
+    }
+    stream->current_writing_.emplace_back(chunk);
+  }
+  return Status::OK();
+}
+
+Status StreamStore::seal(std::shared_ptr<StreamHolder> stream) {
+  static metrics::Counter& sealed_bytes =
+      metrics::Registry::Default().GetCounter(
+          "vineyard_stream_sealed_bytes_total",
+          "The size of chunks sealed by the producers of streams, in bytes");
+  for (auto const& chunk : stream->current_writing_) {
+    size_t size = 0;
+    if (stream->cursored) {
+      RETURN_ON_ERROR(retain(stream, chunk));
+      size = stream->retained_.back().second;
+    } else {
+      size = chunkSize(chunk);
+      stream->ready_chunks_.push(chunk);
+    }
+    backlog_bytes_ += size;
+    sealed_bytes.Add(size);
+  }
+  stream->current_writing_.clear();
+  if (stream->cursored) {
+    return notifyConsumers(stream);
+  }
+  if (stream->reader_ && !stream->ready_chunks_.empty()) {
+    // should be no reading chunk
+    if (stream->current_reading_) {
+      return Status::InvalidStreamState("Shouldn't exists a being read chunk");
+    }
+    auto read = stream->reader_.get();
+    stream->reader_ = boost::none;
+    VINEYARD_SUPPRESS(deliver(stream, read));
+  }
+  return Status::OK();
+}
+
+Status StreamStore::wakeupWriter(std::shared_ptr<StreamHolder> stream) {
+  if (!stream->writer_) {
+    return Status::OK();
+  }
+  // should be no writing chunk
+  if (!stream->current_writing_.empty()) {
+    return Status::InvalidStreamState(
+        "Shouldn't exists a being written chunk");
+  }
+  auto writer = stream->writer_.get();
+  if (admissible(stream, writer.first)) {
+    stream->writer_ = boost::none;
+    blocked_writers_ -= 1;
+    auto status = allocateAll(stream, writer.first);
+    if (!status.ok()) {
+      VINEYARD_SUPPRESS(writer.second(status, {}));
+    } else {
+      // the writer may seal them at once, see also `Seal`.
+      auto chunks = stream->current_writing_;
+      VINEYARD_SUPPRESS(writer.second(Status::OK(), chunks));
+    }
+  }
+  return Status::OK();
+}
+
+Status StreamStore::deliver(std::shared_ptr<StreamHolder> stream,
+                            StreamHolder::read_t const& read) {
+  std::vector<ObjectID> chunks;
+  size_t size = 0;
+  while (!stream->ready_chunks_.empty() && chunks.size() < read.limit) {
+    chunks.emplace_back(stream->ready_chunks_.front());
+    stream->ready_chunks_.pop();
+    size += chunkSize(chunks.back());
+  }
+  backlog_bytes_ -= size;
+  delivered(size);
+  if (!read.transient) {
+    stream->current_reading_ = chunks.front();
+    return read.callback(Status::OK(), chunks);
+  }
+  auto status = read.callback(Status::OK(), chunks);
+  for (auto const& chunk : chunks) {
+    auto s = recycle(stream, chunk);
+    if (status.ok() && !s.ok()) {
+      status = s;
+    }
+  }
+  return status;
+}
+
+Status StreamStore::pullBroadcast(std::shared_ptr<StreamHolder> stream,
+                                  int64_t const consumer,
+                                  StreamHolder::read_t const& read) {
+  auto& callback = read.callback;
+  auto iter = stream->consumers_.find(consumer);
+  if (iter == stream->consumers_.end()) {
+    return callback(Status::InvalidStreamState(
+                        "The stream hasn't been opened by the consumer"),
+                    {});
+  }
+  auto& state = iter->second;
+
+  // precondition: there's no unsatistified read of this consumer
+  CHECK_STREAM_STATE(!state.reader);
+
+  // drop current reading, the chunk is freed only when every consumer has
+  // passed it, thus the slowest consumer decides when the writer resumes.
+  if (state.reading) {
+    state.reading = false;
+    auto status = collect(stream);
+    if (status.ok()) {
+      status = wakeupWriter(stream);
+    }
+    if (!status.ok()) {
+      return callback(status, {});
+    }
+  }
+
+  if (state.cursor < stream->base_ + stream->retained_.size()) {
+    RETURN_ON_ERROR(deliverBroadcast(stream, state, read));
+    // the transient chunks may have been released
+    return wakeupWriter(stream);
+  } else if (stream->drained) {
+    return callback(Status::StreamDrained(), {});
+  } else if (stream->failed) {
+    return callback(Status::StreamFailed(), {});
+  } else {
+    // pending the reader
+    state.reader = read;
+    return Status::OK();
+  }
+}
+
+Status StreamStore::deliverBroadcast(std::shared_ptr<StreamHolder> stream,
+                                     StreamHolder::consumer_t& state,
+                                     StreamHolder::read_t const& read) {
+  std::vector<ObjectID> chunks;
+  size_t size = 0;
+  while (state.cursor < stream->base_ + stream->retained_.size() &&
+         chunks.size() < read.limit) {
+    auto const& chunk = stream->retained_[state.cursor - stream->base_];
+    chunks.emplace_back(chunk.first);
+    size += chunk.second;
+    state.cursor += 1;
+  }
+  delivered(size);
+  if (!read.transient) {
+    state.reading = true;
+    return read.callback(Status::OK(), chunks);
+  }
+  auto status = read.callback(Status::OK(), chunks);
+  auto s = collect(stream);
+  return status.ok() ? s : status;
+}
+
+Status StreamStore::notifyConsumers(std::shared_ptr<StreamHolder> stream) {
+  for (auto& item : stream->consumers_) {
+    auto& state = item.second;
+    if (!state.reader) {
+      continue;
+    }
+    auto read = state.reader.get();
+    if (state.cursor < stream->base_ + stream->retained_.size()) {
+      state.reader = boost::none;
+      VINEYARD_SUPPRESS(deliverBroadcast(stream, state, read));
+    } else if (stream->drained) {
+      state.reader = boost::none;
+      VINEYARD_SUPPRESS(read.callback(Status::StreamDrained(), {}));
+    } else if (stream->failed) {
+      state.reader = boost::none;
+      VINEYARD_SUPPRESS(read.callback(Status::StreamFailed(), {}));
+    }
+  }
+  return Status::OK();
+}
+
+Status StreamStore::retain(std::shared_ptr<StreamHolder> stream,
+                           ObjectID const chunk) {
+  std::shared_ptr<Payload> object;
+  RETURN_ON_ERROR(store_->Get(chunk, object));
+  stream->retained_.emplace_back(chunk, object->data_size);
+  return Status::OK();
+}
+
+Status StreamStore::collect(std::shared_ptr<StreamHolder> stream) {
+  uint64_t low = stream->base_ + stream->retained_.size();
+  if (stream->consumers_.empty() && stream->replayable()) {
+    // keeps the unread chunks for the next consumer
+    low = std::max(stream->base_, stream->passed_);
+  }
+  for (auto const& item : stream->consumers_) {
+    auto const& state = item.second;
+    low = std::min(low, state.reading ? state.cursor - 1 : state.cursor);
+  }
+  stream->passed_ = low;
+
+  // the passed chunks of replayable streams are kept within the budget,
+  // from the most recent ones.
+  size_t passed_bytes = 0;
+  if (stream->retain_bytes > 0) {
+    for (uint64_t seq = stream->base_; seq < low; ++seq) {
+      passed_bytes += stream->retained_[seq - stream->base_].second;
+    }
+  }
+  while (stream->base_ < low) {
+    if (stream->replayable() &&
+        (stream->retain_chunks == 0 ||
+         low - stream->base_ <= stream->retain_chunks) &&
+        (stream->retain_bytes == 0 || passed_bytes <= stream->retain_bytes)) {
+      break;
+    }
+    auto chunk = stream->retained_.front();
+    stream->retained_.pop_front();
+    stream->base_ += 1;
+    passed_bytes -= std::min(passed_bytes, chunk.second);
+    backlog_bytes_ -= chunk.second;
+    RETURN_ON_ERROR(recycle(stream, chunk.first));
+  }
+  return Status::OK();
 }
 
 }  // namespace vineyard
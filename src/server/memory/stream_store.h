@@ -16,12 +16,20 @@ limitations under the License.
 #ifndef SRC_SERVER_MEMORY_STREAM_STORE_H_
 #define SRC_SERVER_MEMORY_STREAM_STORE_H_
 
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <deque>
 #include <memory>
+#include <mutex>
 #include <queue>
 #include <unordered_map>
 #include <utility>
+#include <vector>
 
 #include "common/util/callback.h"
+#include "common/util/json.h"
+#include "common/util/uuid.h"
 #include "server/memory/memory.h"
 
 namespace vineyard {
@@ -34,26 +42,104 @@ namespace vineyard {
  *
  */
 struct StreamHolder {
-  boost::optional<ObjectID> current_writing_, current_reading_;
+  // a pending read of at most `limit` chunks, the chunks are released right
+  // after the callback returns if `transient`, as the payloads have been
+  // copied out, otherwise the (single) chunk is held until the next read.
+  struct read_t {
+    size_t limit;
+    bool transient;
+    callback_t<const std::vector<ObjectID>&> callback;
+  };
+
+  // the in-flight chunks of the producer, sealed on the next write.
+  std::vector<ObjectID> current_writing_;
+  boost::optional<ObjectID> current_reading_;
   std::queue<ObjectID> ready_chunks_;
-  boost::optional<callback_t<ObjectID>> reader_;
-  boost::optional<std::pair<size_t, callback_t<ObjectID>>> writer_;
+  boost::optional<read_t> reader_;
+  boost::optional<std::pair<std::vector<size_t>,
+                            callback_t<const std::vector<ObjectID>&>>>
+      writer_;
   bool drained{false}, failed{false};
   int64_t open_mark{0};
+  // drained chunks (size and id) that kept for reusing by the producer, the
+  // most recently recycled one is at the back.
+  std::deque<std::pair<size_t, ObjectID>> pool_;
+
+  // the cursor of a consumer of a broadcast (or replayable) stream
+  struct consumer_t {
+    // the sequence number of the next chunk to read
+    uint64_t cursor{0};
+    // whether the consumer is holding the chunk at `cursor - 1`
+    bool reading{false};
+    boost::optional<read_t> reader;
+  };
+
+  // broadcast and replayable streams: sealed chunks (id and size) are
+  // retained until every consumer has pulled them, `base_` is the sequence
+  // number of the front one.
+  bool cursored{false};
+  std::deque<std::pair<ObjectID, size_t>> retained_;
+  uint64_t base_{0};
+  std::unordered_map<int64_t, consumer_t> consumers_;
+
+  // replayable streams keep the chunks that all consumers have passed within
+  // the budget, 0 means unlimited, see also `StreamStore::Create`.
+  size_t retain_chunks{0}, retain_bytes{0};
+  // the sequence number that consumers have read up to, the chunks after it
+  // are kept even when there's no consumer.
+  uint64_t passed_{0};
+
+  bool replayable() const { return retain_chunks > 0 || retain_bytes > 0; }
+
+  // the bytes of chunks that the stream holds (in-flight, ready, being read,
+  // retained and pooled ones), and the budget of them, 0 means the fair
+  // share of the stream memory only, see also `StreamStore::allocatable`.
+  size_t held_bytes{0};
+  size_t budget_bytes{0};
+  // whether the producer is still running
+  bool active{true};
+
+  // serializes the operations on the stream, it is recursive since the
+  // callbacks may operate the same stream again, e.g., seal the chunks
+  // that just been allocated.
+  std::recursive_mutex mutex;
 };
 
 /**
  * @brief StreamStore manages a pool of streams.
  *
+ * The streams are sharded by id, and the operations on different streams
+ * proceed independently on the IPC threads, see also `StreamHolder::mutex`.
  */
 class StreamStore {
  public:
-  StreamStore(std::shared_ptr<BulkStore> store, size_t const stream_threshold)
-      : store_(store), threshold_(stream_threshold) {}
+  /**
+   * @param pool_depth The number of drained chunks that each stream keeps for
+   * reusing, rather than freeing them and allocating again. 0 means disable.
+   */
+  StreamStore(std::shared_ptr<BulkStore> store, size_t const stream_threshold,
+              size_t const pool_depth = 0)
+      : store_(store), threshold_(stream_threshold), pool_depth_(pool_depth) {}
 
-  Status Create(ObjectID const stream_id);
+  /**
+   * @param retain_chunks, retain_bytes The budget of chunks that are kept for
+   * replaying after every reader has passed them, the most recent ones are
+   * kept. 0 means unlimited, and both 0 means the stream is not replayable.
+   * @param budget_bytes The maximum bytes of chunks that the stream holds, 0
+   * means no limit besides the fair share.
+   */
+  Status Create(ObjectID const stream_id, size_t const retain_chunks = 0,
+                size_t const retain_bytes = 0, size_t const budget_bytes = 0);
 
-  Status Open(ObjectID const stream_id, int64_t const mode);
+  /**
+   * @param consumer Identifies the consumer when opening in broadcast mode
+   * (or reading a replayable stream), each consumer keeps its own cursor on
+   * the stream.
+   * @param offset The sequence number of chunk that the consumer starts
+   * from, negative means the oldest retained one.
+   */
+  Status Open(ObjectID const stream_id, int64_t const mode,
+              int64_t const consumer = 0, int64_t const offset = -1);
 
   /**
    * @brief This is called by the producer of the steram and it makes current
@@ -64,11 +150,35 @@ class StreamStore {
   Status Get(ObjectID const stream_id, size_t const size,
              callback_t<const ObjectID> callback);
 
+  /**
+   * @brief The batched variant of `Get`, it makes all in-flight chunks
+   * available for the consumer to read, and returns a window of chunks to
+   * write, which will be sealed on the next `Get` (or `Seal`, `Stop`).
+   */
+  Status Get(ObjectID const stream_id, std::vector<size_t> const& sizes,
+             callback_t<const std::vector<ObjectID>&> callback);
+
+  /**
+   * @brief Makes the in-flight chunks available for the consumer to read,
+   * without asking for new chunks.
+   */
+  Status Seal(ObjectID const stream_id);
+
   /**
    * @brief The consumer invokes this function to read current chunk
    *
    */
-  Status Pull(ObjectID const stream_id, callback_t<const ObjectID> callback);
+  Status Pull(ObjectID const stream_id, int64_t const consumer,
+              callback_t<const ObjectID> callback);
+
+  /**
+   * @brief Read at most `limit` ready chunks at once, the chunks are released
+   * as soon as the callback returns, i.e., the callback is expected to copy
+   * the payloads out.
+   */
+  Status Pull(ObjectID const stream_id, int64_t const consumer,
+              size_t const limit,
+              callback_t<const std::vector<ObjectID>&> callback);
 
   /**
    * @brief Function stop is called by the vineyard clients.
@@ -78,17 +188,129 @@ class StreamStore {
 
   /**
    * @brief Function Drop is called by vineyard when the clients loose
-   * connections
+   * connections. For broadcast and replayable streams only the given
+   * consumer is removed, the other consumers are not affected, and the
+   * stream can be reopened for read.
    *
    */
-  Status Drop(ObjectID const stream_id);
+  Status Drop(ObjectID const stream_id, int64_t const consumer = 0);
+
+  // the bytes of chunks that held by all streams
+  size_t HeldBytes() const { return held_bytes_.load(); }
+
+  // the bytes of sealed chunks that haven't been released by the consumers
+  size_t BacklogBytes() const { return backlog_bytes_.load(); }
+
+  // the number of producers that are waiting for the memory
+  size_t BlockedWriters() const { return blocked_writers_.load(); }
+
+  // the number of streams whose producer is still running
+  size_t ActiveStreams() const { return active_streams_.load(); }
+
+  /**
+   * @brief Dump the states and the queue depths of the streams, for
+   * debugging.
+   */
+  void Inspect(json& tree);
+
+  // mirrors `OpenStreamMode::read` and `OpenStreamMode::broadcast`
+  static constexpr int64_t kReadMode = 1;
+  static constexpr int64_t kBroadcastMode = 4;
 
  private:
+  /**
+   * @brief Whether the stream can take `size` more bytes: the footprint must
+   * be under the stream threshold, the stream must be within its budget, and
+   * a stream that exceeds its fair share of the threshold (divided by the
+   * active streams) yields to the blocked producers of the other streams.
+   * A stream that holds nothing is always allowed to make progress within
+   * the threshold.
+   */
   bool allocatable(std::shared_ptr<StreamHolder> stream, size_t size);
 
+  /**
+   * @brief Take a chunk of the given size from the pool, or create a new one
+   * from the bulk store.
+   */
+  Status allocate(std::shared_ptr<StreamHolder> stream, size_t size,
+                  ObjectID& chunk);
+
+  /**
+   * @brief Return the drained chunk to the pool, the chunk is deleted when
+   * the pool is full, the stream has been stopped, or the memory usage
+   * exceeds the threshold.
+   */
+  Status recycle(std::shared_ptr<StreamHolder> stream, ObjectID const chunk);
+
+  Status releasePool(std::shared_ptr<StreamHolder> stream);
+
+  // deletes the chunk and discharges it from the stream
+  Status release(std::shared_ptr<StreamHolder> stream, ObjectID const chunk);
+
+  // the size of chunk, 0 if not exists
+  size_t chunkSize(ObjectID const chunk);
+
+  // the producer won't allocate anymore, and it leaves the fair sharing
+  void deactivate(std::shared_ptr<StreamHolder> stream);
+
+  // whether the chunks of the given sizes can be taken from the pool, or
+  // be allocated under the threshold
+  bool admissible(std::shared_ptr<StreamHolder> stream,
+                  std::vector<size_t> const& sizes);
+
+  // allocates the in-flight chunks of the given sizes
+  Status allocateAll(std::shared_ptr<StreamHolder> stream,
+                     std::vector<size_t> const& sizes);
+
+  // seals the in-flight chunks, and delivers them to the pending reader(s)
+  Status seal(std::shared_ptr<StreamHolder> stream);
+
+  // allocates for the pending writer if there's enough room now
+  Status wakeupWriter(std::shared_ptr<StreamHolder> stream);
+
+  Status pull(ObjectID const stream_id, int64_t const consumer,
+              StreamHolder::read_t const& read);
+
+  // hands the ready chunks to the read of the exclusive reader
+  Status deliver(std::shared_ptr<StreamHolder> stream,
+                 StreamHolder::read_t const& read);
+
+  Status pullBroadcast(std::shared_ptr<StreamHolder> stream,
+                       int64_t const consumer,
+                       StreamHolder::read_t const& read);
+
+  // hands the retained chunks after the cursor to the read of the consumer
+  Status deliverBroadcast(std::shared_ptr<StreamHolder> stream,
+                          StreamHolder::consumer_t& state,
+                          StreamHolder::read_t const& read);
+
+  // delivers the newly sealed chunks (or the end of stream) to the pending
+  // consumers of a broadcast stream
+  Status notifyConsumers(std::shared_ptr<StreamHolder> stream);
+
+  // appends the sealed chunk to the retained ones
+  Status retain(std::shared_ptr<StreamHolder> stream, ObjectID const chunk);
+
+  // frees the retained chunks that every consumer has passed, except the
+  // ones within the retention budget
+  Status collect(std::shared_ptr<StreamHolder> stream);
+
+  // looks up the stream, returns nullptr if not exists
+  std::shared_ptr<StreamHolder> find(ObjectID const stream_id);
+
   std::shared_ptr<BulkStore> store_;
   size_t threshold_;
-  std::unordered_map<ObjectID, std::shared_ptr<StreamHolder>> streams_;
+  size_t pool_depth_;
+
+  std::atomic<size_t> held_bytes_{0}, backlog_bytes_{0};
+  std::atomic<size_t> blocked_writers_{0}, active_streams_{0};
+
+  static constexpr size_t kShards = 64;
+  struct shard_t {
+    std::mutex mutex;  // only guards the lookup table
+    std::unordered_map<ObjectID, std::shared_ptr<StreamHolder>> streams;
+  };
+  std::array<shard_t, kShards> shards_;
 };
 
 }  // namespace vineyard
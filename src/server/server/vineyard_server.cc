@@ -15,7 +15,11 @@ limitations under the License.
 
 #include "server/server/vineyard_server.h"
 
+#include <algorithm>
+#include <chrono>
 #include <iostream>
+#include <limits>
+#include <map>
 #include <memory>
 #include <set>
 #include <string>
@@ -27,12 +31,14 @@ limitations under the License.
 #include "common/util/json.h"
 #include "common/util/logging.h"
 #include "server/async/ipc_server.h"
+#include "server/async/metrics_server.h"
 #include "server/async/rpc_server.h"
 #include "server/services/meta_service.h"
 #include "server/util/kubectl.h"
 #include "server/util/meta_tree.h"
 #include "server/util/metrics.h"
 #include "server/util/proc.h"
+#include "server/util/trace.h"
 
 namespace vineyard {
 
@@ -60,24 +66,40 @@ bool DeferredReq::TestThenCall(const json& meta) const {
   return false;
 }
 
+void DeferredReq::Expire() const {
+  if (expire_fn_) {
+    expire_fn_();
+  }
+}
+
 VineyardServer::VineyardServer(const json& spec)
     : spec_(spec),
       concurrency_(std::thread::hardware_concurrency()),
+      bulk_concurrency_(std::max(1U, concurrency_ / 4)),
       context_(concurrency_),
       meta_context_(),
+      bulk_context_(bulk_concurrency_),
 #if BOOST_VERSION >= 106600
       guard_(asio::make_work_guard(context_)),
       meta_guard_(asio::make_work_guard(meta_context_)),
+      bulk_guard_(asio::make_work_guard(bulk_context_)),
 #else
       guard_(new boost::asio::io_service::work(context_)),
       meta_guard_(new boost::asio::io_service::work(context_)),
+      bulk_guard_(new boost::asio::io_service::work(bulk_context_)),
 #endif
-      ready_(0) {
-}
+      ready_(0),
+      server_token_(GenerateSignature()) {}
 
 Status VineyardServer::Serve() {
   stopped_.store(false);
 
+  trace::Tracer::Default().Configure(
+      spec_.value("trace_capacity", 0),
+      spec_.value("slow_request_threshold", static_cast<int64_t>(0)));
+  deferred_timeout_ =
+      spec_.value("deferred_timeout", static_cast<int64_t>(0));
+
   // Initialize the ipc/rpc server ptr first to get self endpoints when
   // initializing the metadata service.
   ipc_server_ptr_ =
@@ -92,9 +114,59 @@ Status VineyardServer::Serve() {
 
   bulk_store_ = std::make_shared<BulkStore>();
   RETURN_ON_ERROR(bulk_store_->PreAllocate(
-      spec_["bulkstore_spec"]["memory_size"].get<size_t>()));
+      spec_["bulkstore_spec"]["memory_size"].get<size_t>(),
+      spec_["bulkstore_spec"].value("spill_path", ""),
+      spec_["bulkstore_spec"].value("lru_eviction", false),
+      spec_["bulkstore_spec"].value("slab_max_size", 0)));
+  bulk_store_->EnableCompaction(
+      std::chrono::seconds(
+          spec_["bulkstore_spec"].value("compaction_interval", 0)),
+      spec_["bulkstore_spec"].value("compaction_threshold", 0.5));
+  bulk_store_->EnableDeduplication(
+      spec_["bulkstore_spec"].value("dedup_min_size", 0));
+  if (spec_["bulkstore_spec"].value("blob_checksum", false)) {
+    bulk_store_->EnableChecksum();
+  }
+  Quota quota;
+  quota.max_bytes = spec_["bulkstore_spec"].value("tenant_quota_size",
+                                                  static_cast<size_t>(0));
+  quota.max_objects = spec_["bulkstore_spec"].value("tenant_quota_objects",
+                                                    static_cast<size_t>(0));
+  quota.max_rate = spec_["bulkstore_spec"].value("tenant_quota_rate", 0.0);
+  quota_manager_ = std::make_shared<QuotaManager>(quota);
+  if (quota_manager_->Enabled()) {
+    bulk_store_->EnableQuotas();
+  }
+  std::string backing_store =
+      spec_["bulkstore_spec"].value("backing_store", "");
+  if (!backing_store.empty()) {
+    std::shared_ptr<BackingStore> store;
+    RETURN_ON_ERROR(BackingStore::Make(
+        backing_store,
+        spec_["bulkstore_spec"].value("backing_store_chunk_size",
+                                      static_cast<size_t>(8 * 1024 * 1024)),
+        spec_["bulkstore_spec"].value("backing_store_concurrency",
+                                      static_cast<size_t>(4)),
+        store));
+    bulk_store_->EnableBackingStore(store);
+  }
+  size_t const blob_table_size = spec_["bulkstore_spec"].value(
+      "blob_table_size", static_cast<size_t>(0));
+  if (blob_table_size > 0) {
+    auto status = bulk_store_->EnableBlobTable(blob_table_size);
+    if (!status.ok()) {
+      LOG(WARNING) << "The blob table is disabled: " << status.ToString();
+    }
+  }
+  std::string snapshot_path =
+      spec_["bulkstore_spec"].value("snapshot_path", "");
+  if (!snapshot_path.empty()) {
+    RETURN_ON_ERROR(bulk_store_->LoadSnapshot(snapshot_path));
+  }
   stream_store_ = std::make_shared<StreamStore>(
-      bulk_store_, spec_["bulkstore_spec"]["stream_threshold"].get<size_t>());
+      bulk_store_, spec_["bulkstore_spec"]["stream_threshold"].get<size_t>(),
+      spec_["bulkstore_spec"].value("stream_pool_depth", 0));
+  registerMetrics();
   BulkReady();
 
   serve_status_ = Status::OK();
@@ -106,6 +178,15 @@ Status VineyardServer::Serve() {
 #else
     workers_.emplace_back(
         boost::bind(&boost::asio::io_service::run, &context_));
+#endif
+  }
+  for (unsigned int idx = 0; idx < bulk_concurrency_; ++idx) {
+#if BOOST_VERSION >= 106600
+    workers_.emplace_back(
+        boost::bind(&boost::asio::io_context::run, &bulk_context_));
+#else
+    workers_.emplace_back(
+        boost::bind(&boost::asio::io_service::run, &bulk_context_));
 #endif
   }
   meta_context_.run();
@@ -113,6 +194,130 @@ Status VineyardServer::Serve() {
   return serve_status_;
 }
 
+void VineyardServer::registerMetrics() {
+  auto& registry = metrics::Registry::Default();
+  std::weak_ptr<BulkStore> store = bulk_store_;
+  auto collect = [store](size_t (BulkStore::*stat)() const) {
+    return [store, stat]() -> double {
+      auto bulk_store = store.lock();
+      return bulk_store ? static_cast<double>(((*bulk_store).*stat)()) : 0;
+    };
+  };
+  registry.RegisterGauge("vineyard_memory_usage_bytes",
+                         "The size of allocated shared memory, in bytes",
+                         collect(&BulkStore::Footprint));
+  registry.RegisterGauge("vineyard_memory_limit_bytes",
+                         "The limit of shared memory, in bytes",
+                         collect(&BulkStore::FootprintLimit));
+  registry.RegisterGauge("vineyard_spilled_objects",
+                         "The number of blobs spilled to disk",
+                         collect(&BulkStore::SpilledObjects));
+  registry.RegisterGauge("vineyard_spilled_bytes",
+                         "The size of blobs spilled to disk, in bytes",
+                         collect(&BulkStore::SpilledSize));
+  registry.RegisterGauge("vineyard_evicted_objects",
+                         "The number of blobs evicted in LRU order",
+                         collect(&BulkStore::EvictedObjects));
+  registry.RegisterGauge("vineyard_relocated_objects",
+                         "The number of blobs relocated by compaction",
+                         collect(&BulkStore::RelocatedObjects));
+  registry.RegisterGauge("vineyard_uploaded_objects",
+                         "The number of blobs written to the backing store",
+                         collect(&BulkStore::UploadedObjects));
+  registry.RegisterGauge("vineyard_hydrated_objects",
+                         "The number of blobs loaded from the backing store",
+                         collect(&BulkStore::HydratedObjects));
+  registry.RegisterGauge(
+      "vineyard_small_blobs_bytes", "The size of small blobs in slabs",
+      [store]() -> double {
+        auto bulk_store = store.lock();
+        return bulk_store ? bulk_store->SlabStats().size : 0;
+      });
+  registry.RegisterGauge(
+      "vineyard_memory_free_bytes",
+      "The free space inside the shared memory, in bytes",
+      [store]() -> double {
+        auto bulk_store = store.lock();
+        return bulk_store ? bulk_store->GetFragmentationStats().free_size : 0;
+      });
+  registry.RegisterGauge(
+      "vineyard_memory_largest_free_bytes",
+      "The largest free block inside the shared memory, in bytes",
+      [store]() -> double {
+        auto bulk_store = store.lock();
+        return bulk_store
+                   ? bulk_store->GetFragmentationStats().largest_free_size
+                   : 0;
+      });
+
+  std::weak_ptr<StreamStore> streams = stream_store_;
+  auto collect_streams = [streams](size_t (StreamStore::*stat)() const) {
+    return [streams, stat]() -> double {
+      auto stream_store = streams.lock();
+      return stream_store ? static_cast<double>(((*stream_store).*stat)())
+                          : 0;
+    };
+  };
+  registry.RegisterGauge("vineyard_stream_held_bytes",
+                         "The size of chunks held by streams, in bytes",
+                         collect_streams(&StreamStore::HeldBytes));
+  registry.RegisterGauge(
+      "vineyard_stream_backlog_bytes",
+      "The size of sealed chunks that not been released by consumers",
+      collect_streams(&StreamStore::BacklogBytes));
+  registry.RegisterGauge("vineyard_stream_blocked_writers",
+                         "The number of producers waiting for the memory",
+                         collect_streams(&StreamStore::BlockedWriters));
+  registry.RegisterGauge("vineyard_streams_active",
+                         "The number of streams whose producer is running",
+                         collect_streams(&StreamStore::ActiveStreams));
+
+  uint32_t port = spec_.value("metrics_port", 0);
+  if (port != 0) {
+    try {
+      metrics_server_ptr_.reset(new MetricsServer(shared_from_this(), port));
+      metrics_server_ptr_->Start();
+    } catch (std::exception const& ex) {
+      LOG(ERROR) << "Failed to serve the metrics on port " << port << ": "
+                 << ex.what();
+      metrics_server_ptr_.reset();
+    }
+  }
+}
+
+void VineyardServer::recordFootprint(const ObjectID id,
+                                     const std::string& type,
+                                     const size_t size) {
+  if (!footprints_->Put(id, type, size)) {
+    return;
+  }
+  std::string escaped;
+  for (char const c : type) {
+    if (c == '\\' || c == '"') {
+      escaped.push_back('\\');
+    }
+    escaped.push_back(c);
+  }
+  std::string labels = "typename=\"" + escaped + "\"";
+  std::weak_ptr<FootprintIndex> index = footprints_;
+  auto& registry = metrics::Registry::Default();
+  registry.RegisterGauge(
+      "vineyard_type_memory_bytes",
+      "The shared memory taken by the objects of the typename, in bytes",
+      [index, type]() -> double {
+        auto footprints = index.lock();
+        return footprints ? footprints->Aggregate(type).size : 0;
+      },
+      labels);
+  registry.RegisterGauge(
+      "vineyard_type_objects", "The number of objects of the typename",
+      [index, type]() -> double {
+        auto footprints = index.lock();
+        return footprints ? footprints->Aggregate(type).objects : 0;
+      },
+      labels);
+}
+
 Status VineyardServer::Finalize() { return Status::OK(); }
 
 std::shared_ptr<VineyardServer> VineyardServer::Get(const json& spec) {
@@ -191,95 +396,155 @@ void VineyardServer::RPCReady() {
 
 Status VineyardServer::GetData(const std::vector<ObjectID>& ids,
                                const bool sync_remote, const bool wait,
-                               std::function<bool()> alive,
+                               const bool lazy, std::function<bool()> alive,
                                callback_t<const json&> callback) {
   ENSURE_VINEYARDD_READY();
-  meta_service_ptr_->RequestToGetData(
-      sync_remote, [this, ids, wait, alive, callback](const Status& status,
-                                                      const json& meta) {
-        if (status.ok()) {
+  auto process = [this, ids, wait, lazy, alive, callback](
+                     const Status& status, const json& meta) {
+    if (status.ok()) {
       // When object not exists, we return an empty json, rather than
       // the status to indicate the error.
 #if !defined(NDEBUG)
-          if (VLOG_IS_ON(10)) {
-            VLOG(10) << "Got request from client to get data, dump json:";
-            std::cerr << meta.dump(4) << std::endl;
-            VLOG(10) << "=========================================";
-          }
-#endif
-          auto test_task = [this, ids](const json& meta) -> bool {
-            for (auto const& id : ids) {
-              bool exists = false;
-              if (IsBlob(id)) {
-                exists = this->bulk_store_->Exists(id);
-              } else {
-                VINEYARD_SUPPRESS(
-                    CATCH_JSON_ERROR(meta_tree::Exists(meta, id, exists)));
-              }
-              if (!exists) {
-                return exists;
-              }
-            }
-            return true;
-          };
-          auto eval_task = [this, ids, callback](const json& meta) -> Status {
-            json sub_tree_group;
-            for (auto const& id : ids) {
-              json sub_tree;
-              if (IsBlob(id)) {
-                std::shared_ptr<Payload> object;
-                if (this->bulk_store_->Get(id, object).ok()) {
-                  sub_tree["id"] = VYObjectIDToString(id);
-                  sub_tree["typename"] = "vineyard::Blob";
-                  sub_tree["length"] = object->data_size;
-                  sub_tree["nbytes"] = object->data_size;
-                  sub_tree["transient"] = true;
-                  sub_tree["instance_id"] = this->instance_id();
-                }
-              } else {
-                VINEYARD_SUPPRESS(CATCH_JSON_ERROR(meta_tree::GetData(
-                    meta, this->instance_name(), id, sub_tree, instance_id_)));
-#if !defined(NDEBUG)
-                if (VLOG_IS_ON(10)) {
-                  VLOG(10) << "Got request response:";
-                  std::cerr << sub_tree.dump(4) << std::endl;
-                  VLOG(10) << "=========================================";
-                }
+      if (VLOG_IS_ON(10)) {
+        VLOG(10) << "Got request from client to get data, dump json:";
+        std::cerr << meta.dump(4) << std::endl;
+        VLOG(10) << "=========================================";
+      }
 #endif
-              }
-              if (sub_tree.is_object() && !sub_tree.empty()) {
-                sub_tree_group[VYObjectIDToString(id)] = sub_tree;
-              }
-            }
-            return callback(Status::OK(), sub_tree_group);
-          };
-          if (!wait || test_task(meta)) {
-            return eval_task(meta);
+      auto test_task = [this, ids](const json& meta) -> bool {
+        for (auto const& id : ids) {
+          bool exists = false;
+          if (IsBlob(id)) {
+            exists = this->bulk_store_->Exists(id);
           } else {
-            this->deferred_.emplace_back(alive, test_task, eval_task);
-            return Status::OK();
+            VINEYARD_SUPPRESS(
+                CATCH_JSON_ERROR(meta_tree::Exists(meta, id, exists)));
+          }
+          if (!exists) {
+            return exists;
           }
-        } else {
-          LOG(ERROR) << status.ToString();
-          return status;
         }
-      });
+        return true;
+      };
+      auto eval_task = [this, ids, lazy,
+                        callback](const json& meta) -> Status {
+        json sub_tree_group;
+        this->getDataGroup(meta, ids, lazy, sub_tree_group);
+        return callback(Status::OK(), sub_tree_group);
+      };
+      auto expire_task = [callback]() {
+        VINEYARD_SUPPRESS(callback(
+            Status::ObjectNotExists("timeout when waiting for the objects"),
+            json()));
+      };
+      if (!wait || test_task(meta)) {
+        return eval_task(meta);
+      } else {
+        this->deferRequest(
+            DeferredReq(alive, test_task, eval_task, ids, expire_task));
+        return Status::OK();
+      }
+    } else {
+      LOG(ERROR) << status.ToString();
+      return status;
+    }
+  };
+  // reading the local metadata doesn't need to wait for the meta context,
+  // while the "wait" requests need to be deferred on it.
+  if (!sync_remote && !wait) {
+    meta_service_ptr_->RequestToReadData(process);
+  } else {
+    meta_service_ptr_->RequestToGetData(sync_remote, process);
+  }
   return Status::OK();
 }
 
+Status VineyardServer::GetData(const std::vector<ObjectID>& ids,
+                               const uint64_t snapshot, const bool lazy,
+                               callback_t<const json&> callback) {
+  ENSURE_VINEYARDD_READY();
+  std::shared_ptr<const json> meta;
+  {
+    std::lock_guard<std::mutex> lock(snapshots_mutex_);
+    auto iter = snapshots_.find(snapshot);
+    if (iter != snapshots_.end()) {
+      meta = iter->second.meta;
+    }
+  }
+  if (meta == nullptr) {
+    return callback(Status::Invalid("The snapshot " + std::to_string(snapshot) +
+                                    " doesn't exist or has been released"),
+                    json());
+  }
+  // the blobs referred by the snapshot are retired rather than deleted, see
+  // also `DeleteBlobBatch`.
+  json sub_tree_group;
+  getDataGroup(*meta, ids, lazy, sub_tree_group);
+  return callback(Status::OK(), sub_tree_group);
+}
+
+void VineyardServer::getDataGroup(const json& meta,
+                                  const std::vector<ObjectID>& ids,
+                                  const bool lazy, json& sub_tree_group) {
+  for (auto const& id : ids) {
+    json sub_tree;
+    if (IsBlob(id)) {
+      std::shared_ptr<Payload> object;
+      if (this->bulk_store_->Get(id, object).ok()) {
+        sub_tree["id"] = VYObjectIDToString(id);
+        sub_tree["typename"] = "vineyard::Blob";
+        sub_tree["length"] = object->data_size;
+        sub_tree["nbytes"] = object->data_size;
+        sub_tree["transient"] = true;
+        sub_tree["instance_id"] = this->instance_id();
+        if (object->checksum >= 0) {
+          sub_tree["checksum"] = object->checksum;
+        }
+      }
+    } else {
+      VINEYARD_SUPPRESS(CATCH_JSON_ERROR(meta_tree::GetData(
+          meta, this->instance_name(), id, sub_tree, instance_id_, lazy)));
+      // resolves the remote object to its local replica, if any
+      ObjectID replica = InvalidObjectID();
+      if (sub_tree.is_object() && !sub_tree.value("global", false) &&
+          sub_tree.value("instance_id", instance_id_) != instance_id_ &&
+          meta_tree::LocalEquivalent(meta, this->instance_name(), id,
+                                     replica)) {
+        json replica_tree;
+        VINEYARD_SUPPRESS(CATCH_JSON_ERROR(
+            meta_tree::GetData(meta, this->instance_name(), replica,
+                               replica_tree, instance_id_, lazy)));
+        if (replica_tree.is_object() && !replica_tree.empty()) {
+          sub_tree = std::move(replica_tree);
+        }
+      }
+#if !defined(NDEBUG)
+      if (VLOG_IS_ON(10)) {
+        VLOG(10) << "Got request response:";
+        std::cerr << sub_tree.dump(4) << std::endl;
+        VLOG(10) << "=========================================";
+      }
+#endif
+    }
+    if (sub_tree.is_object() && !sub_tree.empty()) {
+      sub_tree_group[VYObjectIDToString(id)] = sub_tree;
+    }
+  }
+}
+
 Status VineyardServer::ListData(std::string const& pattern, bool const regex,
                                 size_t const limit,
                                 callback_t<const json&> callback) {
   ENSURE_VINEYARDD_READY();
-  meta_service_ptr_->RequestToGetData(
-      false,  // no need for sync from etcd
+  meta_service_ptr_->RequestToReadData(
       [this, pattern, regex, limit, callback](const Status& status,
                                               const json& meta) {
         if (status.ok()) {
           json sub_tree_group;
           VINEYARD_CHECK_OK(CATCH_JSON_ERROR(
-              meta_tree::ListData(meta, this->instance_name(), pattern, regex,
-                                  limit, sub_tree_group)));
+              meta_tree::ListData(meta, this->instance_name(),
+                                  meta_service_ptr_->TypeIndex(), pattern,
+                                  regex, limit, sub_tree_group)));
           return callback(status, sub_tree_group);
         } else {
           LOG(ERROR) << status.ToString();
@@ -289,9 +554,41 @@ Status VineyardServer::ListData(std::string const& pattern, bool const regex,
   return Status::OK();
 }
 
+Status VineyardServer::ListObjects(
+    std::string const& pattern, bool const regex,
+    std::string const& name_prefix, std::string const& cursor,
+    size_t const limit, bool const brief,
+    callback_t<const json&, const std::string&> callback) {
+  ENSURE_VINEYARDD_READY();
+  meta_service_ptr_->RequestToReadData(
+      [this, pattern, regex, name_prefix, cursor, limit, brief, callback](
+          const Status& status, const json& meta) {
+        if (status.ok()) {
+          json objects;
+          std::string next_cursor;
+          auto s = CATCH_JSON_ERROR(meta_tree::ListObjects(
+              meta, this->instance_name(), meta_service_ptr_->TypeIndex(),
+              meta_service_ptr_->NameIndex(), meta_service_ptr_->ObjectNames(),
+              pattern, regex, name_prefix, cursor, limit, brief, objects,
+              next_cursor));
+          return callback(s, objects, next_cursor);
+        } else {
+          LOG(ERROR) << status.ToString();
+          return status;
+        }
+      });
+  return Status::OK();
+}
+
 Status VineyardServer::CreateData(
     const json& tree,
     callback_t<const ObjectID, const Signature, const InstanceID> callback) {
+  return CreateData(tree, 0, callback);
+}
+
+Status VineyardServer::CreateData(
+    const json& tree, const int64_t ttl,
+    callback_t<const ObjectID, const Signature, const InstanceID> callback) {
   ENSURE_VINEYARDD_READY();
 #if !defined(NDEBUG)
   if (VLOG_IS_ON(10)) {
@@ -309,7 +606,7 @@ Status VineyardServer::CreateData(
                               UnspecifiedInstanceID()));
     return Status::OK();
   }
-  std::string const& type = type_name_node.get_ref<std::string const&>();
+  std::string const type = type_name_node.get_ref<std::string const&>();
 
   RETURN_ON_ASSERT(type != "vineyard::Blob", "Blob has no metadata");
 
@@ -325,6 +622,7 @@ Status VineyardServer::CreateData(
   } else {
     decorated_tree["signature"] = signature;
   }
+  size_t const footprint = FootprintIndex::Measure(tree, instance_id_);
 
   // update meta into json
   meta_service_ptr_->RequestToBulkUpdate(
@@ -332,35 +630,89 @@ Status VineyardServer::CreateData(
                                  std::vector<IMetaService::op_t>& ops,
                                  InstanceID& computed_instance_id) {
         if (status.ok()) {
-          return CATCH_JSON_ERROR(
+          auto s = CATCH_JSON_ERROR(
               meta_tree::PutDataOps(meta, this->instance_name(), id,
                                     decorated_tree, ops, computed_instance_id));
+          if (s.ok()) {
+            // the local member blobs have been sealed
+            std::set<ObjectID> blobs;
+            meta_tree::CollectBlobs(decorated_tree, this->instance_id(),
+                                    blobs);
+            this->bulk_store_->Seal(blobs);
+          }
+          return s;
         } else {
           LOG(ERROR) << status.ToString();
           return status;
         }
       },
-      boost::bind(callback, _1, id, signature, _2));
+      [this, id, type, footprint, signature, ttl, callback](
+          const Status& status, const InstanceID computed_instance_id) {
+        if (status.ok()) {
+          this->recordFootprint(id, type, footprint);
+          if (ttl > 0) {
+            meta_context_.post(
+                [this, id, ttl]() { this->scheduleExpiry(id, "", ttl); });
+          }
+        }
+        return callback(status, id, signature, computed_instance_id);
+      });
   return Status::OK();
 }
 
 Status VineyardServer::Persist(const ObjectID id, callback_t<> callback) {
   ENSURE_VINEYARDD_READY();
   RETURN_ON_ASSERT(!IsBlob(id), "The blobs cannot be persisted");
+  // the local objects of this instance can be persisted without the global
+  // lock, as no other instances would write their metadata.
+  bool owned = false;
+  meta_service_ptr_->RequestToReadData(
+      [this, id, &owned](const Status& status, const json& meta) {
+        auto data = meta.find("data");
+        if (status.ok() && data != meta.end() && data->is_object()) {
+          auto object = data->find(VYObjectIDToString(id));
+          if (object != data->end() && object->is_object()) {
+            owned = !object->value("global", false) &&
+                    object->value("instance_id", UnspecifiedInstanceID()) ==
+                        this->instance_id();
+          }
+        }
+        return Status::OK();
+      });
   meta_service_ptr_->RequestToPersist(
       [this, id](const Status& status, const json& meta,
                  std::vector<IMetaService::op_t>& ops) {
         if (status.ok()) {
           auto status = CATCH_JSON_ERROR(
               meta_tree::PersistOps(meta, this->instance_name(), id, ops));
-          if (this->spec_["sync_crds"].get<bool>() && status.ok() &&
-              !ops.empty()) {
-            json tree;
-            VINEYARD_SUPPRESS(CATCH_JSON_ERROR(
-                meta_tree::GetData(meta, this->instance_name(), id, tree)));
-            if (tree.is_object() && !tree.empty()) {
+          if (!status.ok()) {
+            return status;
+          }
+          // n.b.: the persisted state of blobs is only used for spilling,
+          // uploading and snapshots, skip collecting the blobs otherwise.
+          bool const mark = this->bulk_store_->TracksPersisted();
+          bool const sync =
+              this->spec_["sync_crds"].get<bool>() && !ops.empty();
+          if (!mark && !sync) {
+            return status;
+          }
+          json tree;
+          VINEYARD_SUPPRESS(CATCH_JSON_ERROR(
+              meta_tree::GetData(meta, this->instance_name(), id, tree)));
+          if (tree.is_object() && !tree.empty()) {
+            // the local blobs of persisted objects can be spilled.
+            if (mark) {
+              std::set<ObjectID> blobs;
+              meta_tree::CollectBlobs(tree, this->instance_id(), blobs);
+              this->bulk_store_->MarkAsPersisted(blobs);
+            }
+
+            if (sync) {
               auto kube = std::make_shared<Kubectl>(this->GetMetaContext());
               kube->ApplyObject(meta["instances"], tree);
+              kube->ApplyInstanceStatus(meta["instances"], this->instance_id(),
+                                        this->bulk_store_->Footprint(),
+                                        this->bulk_store_->FootprintLimit());
               kube->Finish();
             }
           }
@@ -370,7 +722,7 @@ Status VineyardServer::Persist(const ObjectID id, callback_t<> callback) {
           return status;
         }
       },
-      callback);
+      callback, owned);
   return Status::OK();
 }
 
@@ -391,8 +743,8 @@ Status VineyardServer::IfPersist(const ObjectID id,
     context_.post(boost::bind(callback, Status::OK(), false));
     return Status::OK();
   }
-  meta_service_ptr_->RequestToGetData(
-      false, [id, callback](const Status& status, const json& meta) {
+  meta_service_ptr_->RequestToReadData(
+      [id, callback](const Status& status, const json& meta) {
         if (status.ok()) {
           bool persist = false;
           auto s = CATCH_JSON_ERROR(meta_tree::IfPersist(meta, id, persist));
@@ -529,9 +881,8 @@ Status VineyardServer::DelData(const std::vector<ObjectID>& ids,
                        "Fastpath deletion can only be applied to blobs");
     }
     context_.post([this, ids, callback] {
-      for (auto const id : ids) {
-        VINEYARD_DISCARD(bulk_store_->Delete(id));
-      }
+      VINEYARD_DISCARD(
+          bulk_store_->Delete(std::set<ObjectID>(ids.begin(), ids.end())));
       VINEYARD_DISCARD(callback(Status::OK()));
     });
     return Status::OK();
@@ -559,31 +910,119 @@ Status VineyardServer::DelData(const std::vector<ObjectID>& ids,
 }
 
 Status VineyardServer::DeleteBlobBatch(const std::set<ObjectID>& ids) {
-  for (auto object_id : ids) {
-    VINEYARD_SUPPRESS(this->bulk_store_->Delete(object_id));
+  if (ids.empty()) {
+    return Status::OK();
   }
+  {
+    // the blobs may still be referred by the snapshots taken before the
+    // deletion, i.e., the ones at an older metadata version.
+    std::lock_guard<std::mutex> lock(snapshots_mutex_);
+    uint64_t const version = meta_service_ptr_->MetaVersion();
+    if (oldestSnapshot() < version) {
+      retired_blobs_.emplace_back(version, ids);
+      return Status::OK();
+    }
+  }
+  // free the blobs before replying, returning the pages to the OS (the
+  // madvise) is still deferred to the recycler of the bulk store.
+  VINEYARD_SUPPRESS(bulk_store_->Delete(ids));
   return Status::OK();
 }
 
-Status VineyardServer::DeleteAllAt(const json& meta,
-                                   InstanceID const instance_id) {
-  std::vector<ObjectID> objects_to_cleanup;
-  auto status = CATCH_JSON_ERROR(
-      meta_tree::FilterAtInstance(meta, instance_id, objects_to_cleanup));
-  RETURN_ON_ERROR(status);
-  return this->DelData(objects_to_cleanup, true, true, false /* fastpath */,
-                       [](Status const& status) -> Status {
-                         if (!status.ok()) {
-                           LOG(ERROR) << "Error happens on cleanup: "
-                                      << status.ToString();
-                         }
-                         return Status::OK();
-                       });
+void VineyardServer::NotifyInvalidation(
+    const std::vector<ObjectID>& ids, const std::vector<std::string>& names) {
+  if (ipc_server_ptr_) {
+    ipc_server_ptr_->NotifyInvalidation(ids, names);
+  }
+}
+
+void VineyardServer::NotifyObjects(const json& events) {
+  if (ipc_server_ptr_) {
+    ipc_server_ptr_->NotifyObjects(events);
+  }
+  if (rpc_server_ptr_) {
+    rpc_server_ptr_->NotifyObjects(events);
+  }
+}
+
+Status VineyardServer::DeleteAllAt(InstanceID const instance_id) {
+  bulk_context_.post([this, instance_id]() {
+    auto objects_to_cleanup = std::make_shared<std::vector<ObjectID>>();
+    Status status;
+    meta_service_ptr_->RequestToReadData(
+        [&](const Status& s, const json& meta) {
+          status = s;
+          if (status.ok()) {
+            status = CATCH_JSON_ERROR(meta_tree::FilterAtInstance(
+                meta, instance_id, *objects_to_cleanup));
+          }
+          return status;
+        });
+    if (!status.ok()) {
+      LOG(ERROR) << "Failed to find the objects to cleanup: "
+                 << status.ToString();
+      return;
+    }
+    LOG(INFO) << "Cleaning up " << objects_to_cleanup->size()
+              << " objects of instance " << instance_id;
+    deleteInBatches(objects_to_cleanup, 0);
+  });
+  return Status::OK();
+}
+
+void VineyardServer::deleteInBatches(
+    std::shared_ptr<std::vector<ObjectID>> const& objects,
+    size_t const offset) {
+  // deletes a limited number of objects at a time, for the heartbeats and
+  // the requests from clients to interleave with the cleanup.
+  static constexpr size_t kDeleteBatchSize = 64;
+  if (offset >= objects->size()) {
+    return;
+  }
+  size_t end = std::min(objects->size(), offset + kDeleteBatchSize);
+  std::vector<ObjectID> batch(objects->begin() + offset,
+                              objects->begin() + end);
+  meta_service_ptr_->RequestToDelete(
+      batch, true, true,
+      [](const Status& status, const json& meta,
+         std::vector<ObjectID> const& ids_to_delete,
+         std::vector<IMetaService::op_t>& ops, bool& sync_remote) {
+        if (!status.ok()) {
+          return status;
+        }
+        // the members may have been deleted with an earlier batch.
+        std::vector<ObjectID> existing;
+        for (auto const& id : ids_to_delete) {
+          bool exists = false;
+          VINEYARD_DISCARD(meta_tree::Exists(meta, id, exists));
+          if (exists || IsBlob(id)) {
+            existing.emplace_back(id);
+          }
+        }
+        return CATCH_JSON_ERROR(
+            meta_tree::DelDataOps(meta, existing, ops, sync_remote));
+      },
+      [this, objects, end](const Status& status) {
+        if (!status.ok()) {
+          LOG(ERROR) << "Error happens on cleanup: " << status.ToString();
+        }
+        this->deleteInBatches(objects, end);
+        return Status::OK();
+      });
 }
 
 Status VineyardServer::PutName(const ObjectID object_id,
                                const std::string& name, callback_t<> callback) {
+  return PutName(object_id, name, 0, callback);
+}
+
+Status VineyardServer::PutName(const ObjectID object_id,
+                               const std::string& name, const int64_t ttl,
+                               callback_t<> callback) {
   ENSURE_VINEYARDD_READY();
+  meta_context_.post([this, object_id, name, ttl]() {
+    this->scheduleExpiry(object_id, name, ttl);
+  });
   meta_service_ptr_->RequestToPersist(
       [object_id, name](const Status& status, const json& meta,
                         std::vector<IMetaService::op_t>& ops) {
@@ -607,38 +1046,34 @@ Status VineyardServer::GetName(const std::string& name, const bool wait,
                                DeferredReq::alive_t alive,
                                callback_t<const ObjectID&> callback) {
   ENSURE_VINEYARDD_READY();
+  // the names that are known locally are served without syncing with etcd.
+  ObjectID object_id = InvalidObjectID();
+  if (meta_service_ptr_->LookupName(name, object_id)) {
+    return callback(Status::OK(), object_id);
+  }
   meta_service_ptr_->RequestToGetData(true, [this, name, wait, alive, callback](
                                                 const Status& status,
                                                 const json& meta) {
-    if (status.ok()) {
-      auto test_task = [name](const json& meta) -> bool {
-        auto names = meta.value("names", json(nullptr));
-        if (names.is_object()) {
-          return names.contains(name);
-        }
-        return false;
-      };
-      auto eval_task = [name, callback](const json& meta) -> Status {
-        auto names = meta.value("names", json(nullptr));
-        if (names.is_object() && names.contains(name)) {
-          auto entry = names[name];
-          if (!entry.is_null()) {
-            return callback(Status::OK(), entry.get<ObjectID>());
-          }
-        }
-        return callback(Status::ObjectNotExists("failed to find name: " + name),
-                        InvalidObjectID());
-      };
-      if (!wait || test_task(meta)) {
-        return eval_task(meta);
-      } else {
-        deferred_.emplace_back(alive, test_task, eval_task);
-        return Status::OK();
-      }
-    } else {
+    if (!status.ok()) {
       LOG(ERROR) << status.ToString();
       return status;
     }
+    ObjectID object_id = InvalidObjectID();
+    if (meta_service_ptr_->LookupName(name, object_id)) {
+      return callback(Status::OK(), object_id);
+    }
+    if (!wait) {
+      return callback(Status::ObjectNotExists("failed to find name: " + name),
+                      InvalidObjectID());
+    }
+    auto& waiters = name_waiters_[name];
+    waiters.erase(std::remove_if(waiters.begin(), waiters.end(),
+                                 [](name_waiter_t const& waiter) {
+                                   return !waiter.alive();
+                                 }),
+                  waiters.end());
+    waiters.emplace_back(name_waiter_t{alive, callback});
+    return Status::OK();
   });
   return Status::OK();
 }
@@ -664,6 +1099,322 @@ Status VineyardServer::DropName(const std::string& name,
   return Status::OK();
 }
 
+Status VineyardServer::PutNames(const std::map<std::string, ObjectID>& names,
+                                callback_t<> callback) {
+  ENSURE_VINEYARDD_READY();
+  meta_service_ptr_->RequestToPersist(
+      [names](const Status& status, const json& meta,
+              std::vector<IMetaService::op_t>& ops) {
+        if (status.ok()) {
+          for (auto const& item : names) {
+            ops.emplace_back(
+                IMetaService::op_t::Put("/names/" + item.first, item.second));
+          }
+          return Status::OK();
+        } else {
+          LOG(ERROR) << status.ToString();
+          return status;
+        }
+      },
+      callback);
+  return Status::OK();
+}
+
+Status VineyardServer::GetNames(
+    const std::vector<std::string>& names, const uint64_t snapshot,
+    callback_t<const std::map<std::string, ObjectID>&> callback) {
+  ENSURE_VINEYARDD_READY();
+  if (snapshot == 0) {
+    return GetNames(names, callback);
+  }
+  std::shared_ptr<const json> meta;
+  {
+    std::lock_guard<std::mutex> lock(snapshots_mutex_);
+    auto iter = snapshots_.find(snapshot);
+    if (iter != snapshots_.end()) {
+      meta = iter->second.meta;
+    }
+  }
+  std::map<std::string, ObjectID> object_ids;
+  if (meta == nullptr) {
+    return callback(Status::Invalid("The snapshot " + std::to_string(snapshot) +
+                                    " doesn't exist or has been released"),
+                    object_ids);
+  }
+  auto entries = meta->find("names");
+  if (entries != meta->end() && entries->is_object()) {
+    for (auto const& name : names) {
+      auto entry = entries->find(name);
+      if (entry != entries->end() && entry->is_number_integer()) {
+        object_ids.emplace(name, entry->get<ObjectID>());
+      }
+    }
+  }
+  return callback(Status::OK(), object_ids);
+}
+
+Status VineyardServer::GetNames(
+    const std::vector<std::string>& names,
+    callback_t<const std::map<std::string, ObjectID>&> callback) {
+  ENSURE_VINEYARDD_READY();
+  std::map<std::string, ObjectID> object_ids;
+  bool missing = false;
+  for (auto const& name : names) {
+    ObjectID object_id = InvalidObjectID();
+    if (meta_service_ptr_->LookupName(name, object_id)) {
+      object_ids.emplace(name, object_id);
+    } else {
+      missing = true;
+    }
+  }
+  if (!missing) {
+    return callback(Status::OK(), object_ids);
+  }
+  // sync with etcd only once for all the names that are unknown locally.
+  meta_service_ptr_->RequestToGetData(
+      true, [this, names, callback](const Status& status, const json& meta) {
+        std::map<std::string, ObjectID> object_ids;
+        if (!status.ok()) {
+          LOG(ERROR) << status.ToString();
+          return callback(status, object_ids);
+        }
+        for (auto const& name : names) {
+          ObjectID object_id = InvalidObjectID();
+          if (meta_service_ptr_->LookupName(name, object_id)) {
+            object_ids.emplace(name, object_id);
+          }
+        }
+        return callback(Status::OK(), object_ids);
+      });
+  return Status::OK();
+}
+
+Status VineyardServer::DropNames(const std::vector<std::string>& names,
+                                 callback_t<> callback) {
+  ENSURE_VINEYARDD_READY();
+  meta_service_ptr_->RequestToPersist(
+      [names](const Status& status, const json& meta,
+              std::vector<IMetaService::op_t>& ops) {
+        if (status.ok()) {
+          auto existing = meta.value("names", json(nullptr));
+          if (!existing.is_object()) {
+            return Status::OK();
+          }
+          for (auto const& name : names) {
+            if (existing.contains(name)) {
+              ops.emplace_back(IMetaService::op_t::Del("/names/" + name));
+            }
+          }
+          return Status::OK();
+        } else {
+          LOG(ERROR) << status.ToString();
+          return status;
+        }
+      },
+      callback);
+  return Status::OK();
+}
+
+namespace detail {
+
+struct batch_t {
+  // the created objects, with the generated ids and decorated metadata
+  std::vector<std::pair<ObjectID, json>> creations;
+  std::vector<ObjectID> persists;
+  std::map<std::string, ObjectID> names;
+  // the reply: id, signature and instance id of created objects
+  json objects = json::array();
+};
+
+static Status parse_batch(const json& ops, batch_t& batch) {
+  RETURN_ON_ASSERT(ops.is_array(), "The batch ops must be an array");
+  for (auto const& op : ops) {
+    RETURN_ON_ASSERT(op.is_object() && op.contains("op"),
+                     "Invalid batch op: " + op.dump());
+    std::string const& kind = op["op"].get_ref<std::string const&>();
+    if (kind == "create_data") {
+      json tree = op.value("content", json(nullptr));
+      auto type_name_node = tree.value("typename", json(nullptr));
+      RETURN_ON_ASSERT(type_name_node.is_string(), "No typename field");
+      RETURN_ON_ASSERT(type_name_node.get_ref<std::string const&>() !=
+                           "vineyard::Blob",
+                       "Blob has no metadata");
+      RETURN_ON_ASSERT(tree.contains("instance_id"),
+                       "The instance_id filed must be presented");
+      if (!tree.contains("signature")) {
+        tree["signature"] = GenerateSignature();
+      }
+      ObjectID id = GenerateObjectID();
+      json object;
+      object["id"] = id;
+      object["signature"] = tree["signature"];
+      batch.objects.push_back(object);
+      batch.creations.emplace_back(id, std::move(tree));
+      continue;
+    }
+
+    ObjectID id = InvalidObjectID();
+    if (op.contains("ref")) {
+      size_t ref = op["ref"].get<size_t>();
+      RETURN_ON_ASSERT(ref < batch.creations.size(),
+                       "The ref must point to an earlier 'create_data' op");
+      id = batch.creations[ref].first;
+    } else {
+      RETURN_ON_ASSERT(op.contains("object_id"),
+                       "Either 'object_id' or 'ref' is required");
+      id = op["object_id"].get<ObjectID>();
+    }
+    if (kind == "persist") {
+      RETURN_ON_ASSERT(!IsBlob(id), "The blobs cannot be persisted");
+      batch.persists.emplace_back(id);
+    } else if (kind == "put_name") {
+      batch.names[op["name"].get<std::string>()] = id;
+    } else {
+      return Status::Invalid("Unknown batch op: " + kind);
+    }
+  }
+  return Status::OK();
+}
+
+}  // namespace detail
+
+Status VineyardServer::Batch(const json& ops,
+                             callback_t<const json&> callback) {
+  ENSURE_VINEYARDD_READY();
+  // the ids of created objects are generated upfront, for the later ops in
+  // the same batch to refer them.
+  auto batch = std::make_shared<detail::batch_t>();
+  RETURN_ON_ERROR(CATCH_JSON_ERROR(detail::parse_batch(ops, *batch)));
+
+  auto rollback = [this, batch, callback](const Status& status) {
+    if (batch->creations.empty()) {
+      return callback(status, json(nullptr));
+    }
+    std::vector<ObjectID> created;
+    for (auto const& item : batch->creations) {
+      created.emplace_back(item.first);
+    }
+    meta_service_ptr_->RequestToDelete(
+        created, true, false,
+        [](const Status& status, const json& meta,
+           std::vector<ObjectID> const& ids_to_delete,
+           std::vector<IMetaService::op_t>& ops, bool& sync_remote) {
+          if (status.ok()) {
+            return CATCH_JSON_ERROR(
+                meta_tree::DelDataOps(meta, ids_to_delete, ops, sync_remote));
+          }
+          return status;
+        },
+        [status, callback](const Status& rollback_status) {
+          if (!rollback_status.ok()) {
+            LOG(ERROR) << "Failed to roll back the batch: "
+                       << rollback_status.ToString();
+          }
+          return callback(status, json(nullptr));
+        });
+    return Status::OK();
+  };
+
+  auto commit = [this, batch, callback, rollback]() {
+    if (batch->persists.empty() && batch->names.empty()) {
+      return callback(Status::OK(), batch->objects);
+    }
+    meta_service_ptr_->RequestToPersist(
+        [this, batch](const Status& status, const json& meta,
+                      std::vector<IMetaService::op_t>& ops) {
+          if (!status.ok()) {
+            LOG(ERROR) << status.ToString();
+            return status;
+          }
+          for (auto const& id : batch->persists) {
+            RETURN_ON_ERROR(CATCH_JSON_ERROR(
+                meta_tree::PersistOps(meta, this->instance_name(), id, ops)));
+          }
+          for (auto const& item : batch->names) {
+            ops.emplace_back(
+                IMetaService::op_t::Put("/names/" + item.first, item.second));
+          }
+          // the local blobs of persisted objects can be spilled.
+          std::set<ObjectID> blobs;
+          std::shared_ptr<Kubectl> kube;
+          if (this->spec_["sync_crds"].get<bool>() && !ops.empty()) {
+            kube = std::make_shared<Kubectl>(this->GetMetaContext());
+          }
+          // n.b.: the persisted state of blobs is only used for spilling,
+          // uploading and snapshots, skip collecting the blobs otherwise.
+          bool const mark = this->bulk_store_->TracksPersisted();
+          for (auto const& id : batch->persists) {
+            if (!mark && !kube) {
+              break;
+            }
+            json tree;
+            VINEYARD_SUPPRESS(CATCH_JSON_ERROR(
+                meta_tree::GetData(meta, this->instance_name(), id, tree)));
+            if (tree.is_object() && !tree.empty()) {
+              if (mark) {
+                meta_tree::CollectBlobs(tree, this->instance_id(), blobs);
+              }
+              if (kube) {
+                kube->ApplyObject(meta["instances"], tree);
+              }
+            }
+          }
+          this->bulk_store_->MarkAsPersisted(blobs);
+          if (kube) {
+            kube->ApplyInstanceStatus(meta["instances"], this->instance_id(),
+                                      this->bulk_store_->Footprint(),
+                                      this->bulk_store_->FootprintLimit());
+            kube->Finish();
+          }
+          return Status::OK();
+        },
+        [batch, callback, rollback](const Status& status) {
+          if (status.ok()) {
+            return callback(status, batch->objects);
+          }
+          LOG(ERROR) << "Failed to commit the batch: " << status.ToString();
+          return rollback(status);
+        });
+    return Status::OK();
+  };
+
+  if (batch->creations.empty()) {
+    return commit();
+  }
+  // the objects are created in a single local metadata update, nothing will
+  // be inserted if any of them fails.
+  meta_service_ptr_->RequestToBulkUpdate(
+      [this, batch](const Status& status, const json& meta,
+                    std::vector<IMetaService::op_t>& ops,
+                    InstanceID& computed_instance_id) {
+        if (!status.ok()) {
+          LOG(ERROR) << status.ToString();
+          return status;
+        }
+        std::set<ObjectID> blobs;
+        for (size_t index = 0; index < batch->creations.size(); ++index) {
+          auto const& item = batch->creations[index];
+          InstanceID instance_id = UnspecifiedInstanceID();
+          RETURN_ON_ERROR(CATCH_JSON_ERROR(
+              meta_tree::PutDataOps(meta, this->instance_name(), item.first,
+                                    item.second, ops, instance_id)));
+          batch->objects[index]["instance_id"] = instance_id;
+          meta_tree::CollectBlobs(item.second, this->instance_id(), blobs);
+        }
+        // the local member blobs have been sealed
+        this->bulk_store_->Seal(blobs);
+        computed_instance_id = this->instance_id();
+        return Status::OK();
+      },
+      [callback, commit](const Status& status, const InstanceID) {
+        if (!status.ok()) {
+          return callback(status, json(nullptr));
+        }
+        return commit();
+      });
+  return Status::OK();
+}
+
 Status VineyardServer::MigrateObject(const ObjectID object_id, const bool local,
                                      const std::string& peer,
                                      const std::string& peer_rpc_endpoint,
@@ -724,7 +1475,8 @@ Status VineyardServer::MigrateObject(const ObjectID object_id, const bool local,
                 },
                 [callback, result_id](const Status& status) {
                   return callback(Status::OK(), result_id);
-                });
+                },
+                true);
           } else {
             proc->Terminate();
             return callback(status, InvalidObjectID());
@@ -835,6 +1587,84 @@ Status VineyardServer::ClusterInfo(callback_t<const json&> callback) {
   return Status::OK();
 }
 
+Status VineyardServer::LocalityInfo(const ObjectID id, const bool sync_remote,
+                                    callback_t<const json&> callback) {
+  ENSURE_VINEYARDD_READY();
+  meta_service_ptr_->RequestToGetData(
+      sync_remote,
+      [this, id, callback](const Status& status, const json& meta) {
+        if (!status.ok()) {
+          LOG(ERROR) << status.ToString();
+          return status;
+        }
+        json sub_tree;
+        auto s = CATCH_JSON_ERROR(meta_tree::GetData(
+            meta, this->instance_name(), id, sub_tree, instance_id_));
+        if (!s.ok() || !sub_tree.is_object() || sub_tree.empty()) {
+          return callback(Status::ObjectNotExists(ObjectIDToString(id)),
+                          json());
+        }
+        // the object itself may be a blob
+        json wrapper;
+        wrapper["object"] = std::move(sub_tree);
+        std::set<ObjectID> visited;
+        std::map<InstanceID, size_t> locality;
+        meta_tree::CollectLocality(wrapper, visited, locality);
+        json result = json::object();
+        for (auto const& item : locality) {
+          result["i" + std::to_string(item.first)] = item.second;
+        }
+        return callback(Status::OK(), result);
+      });
+  return Status::OK();
+}
+
+Status VineyardServer::Prefetch(const std::vector<ObjectID>& ids,
+                                callback_t<const size_t> callback) {
+  ENSURE_VINEYARDD_READY();
+  meta_service_ptr_->RequestToGetData(
+      true, [this, ids, callback](const Status& status, const json& meta) {
+        if (!status.ok()) {
+          LOG(ERROR) << status.ToString();
+          return status;
+        }
+        auto blobs = std::make_shared<std::set<ObjectID>>();
+        for (auto const& id : ids) {
+          if (IsBlob(id)) {
+            blobs->emplace(id);
+            continue;
+          }
+          json sub_tree;
+          auto s = CATCH_JSON_ERROR(meta_tree::GetData(
+              meta, this->instance_name(), id, sub_tree, instance_id_));
+          if (!s.ok() || !sub_tree.is_object() || sub_tree.empty()) {
+            return callback(Status::ObjectNotExists(ObjectIDToString(id)), 0);
+          }
+          meta_tree::CollectBlobs(sub_tree, instance_id_, *blobs);
+        }
+        // touches the pages outside the meta context
+        bulk_context_.post([this, blobs, callback]() {
+          size_t nbytes = 0;
+          auto s = this->bulk_store_->Prefetch(
+              std::vector<ObjectID>(blobs->begin(), blobs->end()), nbytes);
+          VINEYARD_DISCARD(callback(s, nbytes));
+        });
+        return Status::OK();
+      });
+  return Status::OK();
+}
+
+Status VineyardServer::Footprints(const std::vector<ObjectID>& ids,
+                                  const size_t limit,
+                                  callback_t<const json&> callback) {
+  ENSURE_VINEYARDD_READY();
+  return callback(Status::OK(), footprints_->Query(ids, limit));
+}
+
+void VineyardServer::EraseFootprints(const std::vector<ObjectID>& ids) {
+  footprints_->Erase(ids);
+}
+
 Status VineyardServer::InstanceStatus(callback_t<const json&> callback) {
   ENSURE_VINEYARDD_READY();
 
@@ -843,6 +1673,33 @@ Status VineyardServer::InstanceStatus(callback_t<const json&> callback) {
   status["deployment"] = GetDeployment();
   status["memory_usage"] = bulk_store_->Footprint();
   status["memory_limit"] = bulk_store_->FootprintLimit();
+  status["spilled_objects"] = bulk_store_->SpilledObjects();
+  status["spilled_size"] = bulk_store_->SpilledSize();
+  status["evicted_objects"] = bulk_store_->EvictedObjects();
+  status["uploaded_objects"] = bulk_store_->UploadedObjects();
+  status["hydrated_objects"] = bulk_store_->HydratedObjects();
+  status["snapshot_objects"] = bulk_store_->SnapshotObjects();
+  auto slab_stats = bulk_store_->SlabStats();
+  status["small_blobs"] = slab_stats.items;
+  status["small_blobs_size"] = slab_stats.size;
+  status["small_blobs_capacity"] = slab_stats.capacity;
+  auto fragmentation = bulk_store_->GetFragmentationStats();
+  status["free_size"] = fragmentation.free_size;
+  status["free_blocks"] = fragmentation.free_blocks;
+  status["largest_free_size"] = fragmentation.largest_free_size;
+  status["relocated_objects"] = bulk_store_->RelocatedObjects();
+  status["relocated_size"] = bulk_store_->RelocatedSize();
+  status["prefaulted_size"] = bulk_store_->PrefaultedSize();
+  status["prefault_size"] = bulk_store_->PrefaultSize();
+  size_t const deduplicated_size = bulk_store_->DeduplicatedSize();
+  status["deduplicated_objects"] = bulk_store_->DeduplicatedObjects();
+  status["deduplicated_size"] = deduplicated_size;
+  // the logical size of blobs over the shared memory they take
+  size_t const footprint = bulk_store_->Footprint();
+  status["dedup_ratio"] =
+      footprint == 0 ? 1.0
+                     : static_cast<double>(footprint + deduplicated_size) /
+                           static_cast<double>(footprint);
   status["deferred_requests"] = deferred_.size();
   if (ipc_server_ptr_) {
     status["ipc_connections"] = ipc_server_ptr_->AliveConnections();
@@ -858,18 +1715,373 @@ Status VineyardServer::InstanceStatus(callback_t<const json&> callback) {
   return callback(Status::OK(), status);
 }
 
-Status VineyardServer::ProcessDeferred(const json& meta) {
-  auto iter = deferred_.begin();
-  while (iter != deferred_.end()) {
-    if (!iter->Alive() || iter->TestThenCall(meta)) {
-      deferred_.erase(iter++);
+Status VineyardServer::ProcessDeferred(const json& meta,
+                                       const std::vector<ObjectID>& ids) {
+  if (deferred_.empty()) {
+    return Status::OK();
+  }
+  // in the order of being deferred
+  std::set<uint64_t> candidates(unindexed_deferred_.begin(),
+                                unindexed_deferred_.end());
+  for (auto const& id : ids) {
+    auto range = deferred_index_.equal_range(id);
+    for (auto iter = range.first; iter != range.second; ++iter) {
+      candidates.emplace(iter->second);
+    }
+  }
+  for (auto const serial : candidates) {
+    auto iter = deferred_.find(serial);
+    if (iter == deferred_.end()) {
+      continue;
+    }
+    // the reference is stable even if the callback defers more requests
+    DeferredReq const& req = iter->second.req;
+    if (!req.Alive() || req.TestThenCall(meta)) {
+      eraseDeferred(serial);
+    }
+  }
+  return Status::OK();
+}
+
+void VineyardServer::deferRequest(DeferredReq&& req) {
+  uint64_t serial = next_deferred_++;
+  auto const& ids = req.ids();
+  if (ids.empty() || std::any_of(ids.begin(), ids.end(), IsBlob)) {
+    // the blobs are not in the metadata
+    unindexed_deferred_.emplace(serial);
+  } else {
+    for (auto const& id : ids) {
+      deferred_index_.emplace(id, serial);
+    }
+  }
+  auto deadline = std::chrono::steady_clock::time_point::max();
+  if (deferred_timeout_ > 0) {
+    deadline = std::chrono::steady_clock::now() +
+               std::chrono::seconds(deferred_timeout_);
+  }
+  deferred_.emplace(serial, deferred_t{std::move(req), deadline});
+
+  if (deferred_wheel_.empty()) {
+    deferred_wheel_.resize(64);
+  }
+  scheduleDeferred(serial, deadline);
+  if (deferred_timer_ == nullptr) {
+    deferred_timer_.reset(
+        new asio::steady_timer(meta_context_, std::chrono::seconds(1)));
+    deferred_timer_->async_wait([this](const boost::system::error_code& ec) {
+      if (!ec) {
+        this->tickDeferred();
+      }
+    });
+  }
+}
+
+void VineyardServer::eraseDeferred(const uint64_t serial) {
+  auto iter = deferred_.find(serial);
+  if (iter == deferred_.end()) {
+    return;
+  }
+  for (auto const& id : iter->second.req.ids()) {
+    auto range = deferred_index_.equal_range(id);
+    for (auto index = range.first; index != range.second; ++index) {
+      if (index->second == serial) {
+        deferred_index_.erase(index);
+        break;
+      }
+    }
+  }
+  unindexed_deferred_.erase(serial);
+  deferred_.erase(iter);
+}
+
+void VineyardServer::scheduleDeferred(
+    const uint64_t serial,
+    const std::chrono::steady_clock::time_point deadline) {
+  // the liveness of the connection is checked every few seconds
+  static constexpr int64_t kLivenessCheckTicks = 8;
+  int64_t ticks = kLivenessCheckTicks;
+  if (deadline != std::chrono::steady_clock::time_point::max()) {
+    auto remaining = std::chrono::duration_cast<std::chrono::seconds>(
+                         deadline - std::chrono::steady_clock::now())
+                         .count() +
+                     1;
+    ticks = std::max<int64_t>(1, std::min(ticks, remaining));
+  }
+  deferred_wheel_[(deferred_cursor_ + ticks) % deferred_wheel_.size()]
+      .emplace_back(serial);
+}
+
+void VineyardServer::tickDeferred() {
+  deferred_cursor_ = (deferred_cursor_ + 1) % deferred_wheel_.size();
+  std::vector<uint64_t> serials;
+  serials.swap(deferred_wheel_[deferred_cursor_]);
+  auto now = std::chrono::steady_clock::now();
+  for (auto const serial : serials) {
+    auto iter = deferred_.find(serial);
+    if (iter == deferred_.end()) {
+      continue;
+    }
+    if (!iter->second.req.Alive()) {
+      eraseDeferred(serial);
+    } else if (iter->second.deadline <= now) {
+      iter->second.req.Expire();
+      eraseDeferred(serial);
     } else {
-      ++iter;
+      scheduleDeferred(serial, iter->second.deadline);
     }
   }
+  if (deferred_.empty()) {
+    deferred_timer_.reset();
+    return;
+  }
+  deferred_timer_->expires_after(std::chrono::seconds(1));
+  deferred_timer_->async_wait([this](const boost::system::error_code& ec) {
+    if (!ec) {
+      this->tickDeferred();
+    }
+  });
+}
+
+Status VineyardServer::CreateSnapshot(const bool sync_remote,
+                                      callback_t<const uint64_t> callback) {
+  ENSURE_VINEYARDD_READY();
+  auto take = [this, callback](const Status& status, const json&) {
+    if (!status.ok()) {
+      return callback(status, 0);
+    }
+    uint64_t snapshot = 0;
+    {
+      // registered under the same lock as `DeleteBlobBatch`, thus the blobs
+      // deleted after taking the copy are always retired.
+      std::lock_guard<std::mutex> lock(snapshots_mutex_);
+      snapshot_t taken;
+      taken.meta = meta_service_ptr_->SnapshotMeta(taken.version);
+      snapshot = next_snapshot_++;
+      snapshots_.emplace(snapshot, std::move(taken));
+    }
+    return callback(Status::OK(), snapshot);
+  };
+  if (sync_remote) {
+    meta_service_ptr_->RequestToGetData(true, take);
+  } else {
+    VINEYARD_DISCARD(take(Status::OK(), json()));
+  }
   return Status::OK();
 }
 
+Status VineyardServer::ReleaseSnapshot(const uint64_t snapshot) {
+  std::set<ObjectID> reclaimable;
+  {
+    std::lock_guard<std::mutex> lock(snapshots_mutex_);
+    if (snapshots_.erase(snapshot) == 0) {
+      return Status::Invalid("The snapshot " + std::to_string(snapshot) +
+                             " doesn't exist or has been released");
+    }
+    // the retired blobs are ordered by the version of being deleted
+    uint64_t const oldest = oldestSnapshot();
+    while (!retired_blobs_.empty() && retired_blobs_.front().first <= oldest) {
+      reclaimable.insert(retired_blobs_.front().second.begin(),
+                         retired_blobs_.front().second.end());
+      retired_blobs_.pop_front();
+    }
+  }
+  if (!reclaimable.empty()) {
+    bulk_context_.post([this, reclaimable]() {
+      VINEYARD_SUPPRESS(this->bulk_store_->Delete(reclaimable));
+    });
+  }
+  return Status::OK();
+}
+
+Status VineyardServer::Gossip(const InstanceID from, const InstanceID target,
+                              const json& updates,
+                              callback_t<const bool, const json&> callback) {
+  ENSURE_VINEYARDD_READY();
+  meta_service_ptr_->RequestToGossip(from, target, updates, callback);
+  return Status::OK();
+}
+
+uint64_t VineyardServer::oldestSnapshot() const {
+  uint64_t oldest = std::numeric_limits<uint64_t>::max();
+  for (auto const& item : snapshots_) {
+    oldest = std::min(oldest, item.second.version);
+  }
+  return oldest;
+}
+
+void VineyardServer::scheduleExpiry(const ObjectID id,
+                                    const std::string& name,
+                                    const int64_t ttl) {
+  if (ttl <= 0) {
+    if (name.empty()) {
+      expiring_objects_.erase(id);
+    } else {
+      expiring_names_.erase(name);
+    }
+    return;
+  }
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(ttl);
+  if (name.empty()) {
+    expiring_objects_[id] = deadline;
+  } else {
+    expiring_names_[name] = std::make_pair(id, deadline);
+  }
+  if (expiry_wheel_.empty()) {
+    expiry_wheel_.resize(64);
+  }
+  enqueueExpiry(id, name, deadline);
+  if (expiry_timer_ == nullptr) {
+    expiry_timer_.reset(
+        new asio::steady_timer(meta_context_, std::chrono::seconds(1)));
+    expiry_timer_->async_wait([this](const boost::system::error_code& ec) {
+      if (!ec) {
+        this->tickExpiry();
+      }
+    });
+  }
+}
+
+void VineyardServer::enqueueExpiry(
+    const ObjectID id, const std::string& name,
+    const std::chrono::steady_clock::time_point deadline) {
+  // the far deadlines go round the wheel until being due
+  int64_t const slots = static_cast<int64_t>(expiry_wheel_.size());
+  auto remaining = std::chrono::duration_cast<std::chrono::seconds>(
+                       deadline - std::chrono::steady_clock::now())
+                       .count() +
+                   1;
+  int64_t ticks = std::max<int64_t>(1, std::min(slots - 1, remaining));
+  expiry_wheel_[(expiry_cursor_ + ticks) % expiry_wheel_.size()].emplace_back(
+      expiry_t{id, name, deadline});
+}
+
+void VineyardServer::tickExpiry() {
+  expiry_cursor_ = (expiry_cursor_ + 1) % expiry_wheel_.size();
+  std::vector<expiry_t> entries;
+  entries.swap(expiry_wheel_[expiry_cursor_]);
+  auto now = std::chrono::steady_clock::now();
+  std::vector<ObjectID> objects;
+  std::vector<std::pair<std::string, ObjectID>> names;
+  for (auto& entry : entries) {
+    if (entry.name.empty()) {
+      auto iter = expiring_objects_.find(entry.id);
+      if (iter == expiring_objects_.end() || iter->second != entry.deadline) {
+        continue;
+      }
+      if (entry.deadline > now) {
+        enqueueExpiry(entry.id, entry.name, entry.deadline);
+      } else {
+        objects.emplace_back(entry.id);
+      }
+    } else {
+      auto iter = expiring_names_.find(entry.name);
+      if (iter == expiring_names_.end() ||
+          iter->second.second != entry.deadline) {
+        continue;
+      }
+      if (entry.deadline > now) {
+        enqueueExpiry(entry.id, entry.name, entry.deadline);
+      } else {
+        expiring_names_.erase(iter);
+        names.emplace_back(std::move(entry.name), entry.id);
+      }
+    }
+  }
+
+  // filter out the objects that have gone, and the ones that are still in
+  // use, the latter are retried on the next tick.
+  std::vector<ObjectID> expired, pinned;
+  std::vector<std::string> expired_names;
+  meta_service_ptr_->RequestToReadData([&](const Status& status,
+                                           const json& meta) {
+    if (!status.ok()) {
+      return status;
+    }
+    for (auto const id : objects) {
+      json tree;
+      if (!meta_tree::GetData(meta, instance_name_, id, tree, instance_id_)
+               .ok()) {
+        expiring_objects_.erase(id);
+        continue;
+      }
+      std::set<ObjectID> blobs;
+      meta_tree::CollectBlobs(tree, instance_id_, blobs);
+      if (bulk_store_->Pinned(blobs)) {
+        pinned.emplace_back(id);
+      } else {
+        expiring_objects_.erase(id);
+        expired.emplace_back(id);
+      }
+    }
+    // the names may have been put to other objects in between
+    auto const& name_index = meta_service_ptr_->NameIndex();
+    for (auto const& name : names) {
+      auto iter = name_index.find(name.first);
+      if (iter != name_index.end() && iter->second == name.second) {
+        expired_names.emplace_back(name.first);
+      }
+    }
+    return Status::OK();
+  });
+  for (auto const id : pinned) {
+    enqueueExpiry(id, "", expiring_objects_[id]);
+  }
+  if (!expired.empty()) {
+    VLOG(2) << "Deleting " << expired.size() << " expired objects";
+    auto status = DelData(expired, false, true, false, [](const Status& s) {
+      if (!s.ok()) {
+        LOG(ERROR) << "Failed to delete the expired objects: " << s.ToString();
+      }
+      return Status::OK();
+    });
+    if (!status.ok()) {
+      LOG(ERROR) << "Failed to delete the expired objects: "
+                 << status.ToString();
+    }
+  }
+  if (!expired_names.empty()) {
+    auto status = DropNames(expired_names, [](const Status& s) {
+      if (!s.ok()) {
+        LOG(ERROR) << "Failed to drop the expired names: " << s.ToString();
+      }
+      return Status::OK();
+    });
+    if (!status.ok()) {
+      LOG(ERROR) << "Failed to drop the expired names: " << status.ToString();
+    }
+  }
+  if (expiring_objects_.empty() && expiring_names_.empty()) {
+    expiry_timer_.reset();
+    return;
+  }
+  expiry_timer_->expires_after(std::chrono::seconds(1));
+  expiry_timer_->async_wait([this](const boost::system::error_code& ec) {
+    if (!ec) {
+      this->tickExpiry();
+    }
+  });
+}
+
+void VineyardServer::ProcessNameWaiters(
+    const std::vector<std::string>& names) {
+  for (auto const& name : names) {
+    auto waiters = name_waiters_.find(name);
+    if (waiters == name_waiters_.end()) {
+      continue;
+    }
+    ObjectID object_id = InvalidObjectID();
+    if (!meta_service_ptr_->LookupName(name, object_id)) {
+      continue;
+    }
+    for (auto const& waiter : waiters->second) {
+      if (waiter.alive()) {
+        VINEYARD_SUPPRESS(waiter.callback(Status::OK(), object_id));
+      }
+    }
+    name_waiters_.erase(waiters);
+  }
+}
+
 const std::string VineyardServer::IPCSocket() {
   if (this->ipc_server_ptr_) {
     return ipc_server_ptr_->Socket();
@@ -893,12 +2105,16 @@ void VineyardServer::Stop() {
 
   guard_.reset();
   meta_guard_.reset();
+  bulk_guard_.reset();
   if (this->ipc_server_ptr_) {
     this->ipc_server_ptr_->Stop();
   }
   if (this->rpc_server_ptr_) {
     this->rpc_server_ptr_->Stop();
   }
+  if (this->metrics_server_ptr_) {
+    this->metrics_server_ptr_->Stop();
+  }
   if (this->meta_service_ptr_) {
     this->meta_service_ptr_->Stop();
   }
@@ -906,10 +2122,12 @@ void VineyardServer::Stop() {
   // stop the asio context at last
   context_.stop();
   meta_context_.stop();
+  bulk_context_.stop();
 
   // cleanup
   this->ipc_server_ptr_.reset(nullptr);
   this->rpc_server_ptr_.reset(nullptr);
+  this->metrics_server_ptr_.reset(nullptr);
   this->meta_service_ptr_.reset();
 
   // wait for the IO context finishes.
@@ -17,11 +17,17 @@ limitations under the License.
 #define SRC_SERVER_SERVER_VINEYARD_SERVER_H_
 
 #include <atomic>
+#include <chrono>
+#include <deque>
 #include <list>
+#include <map>
 #include <memory>
+#include <mutex>
 #include <set>
 #include <string>
 #include <thread>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 #include "boost/asio.hpp"
@@ -32,6 +38,8 @@ limitations under the License.
 
 #include "server/memory/memory.h"
 #include "server/memory/stream_store.h"
+#include "server/util/footprint.h"
+#include "server/util/quota.h"
 
 namespace vineyard {
 
@@ -41,29 +49,48 @@ class IMetaService;
 
 class IPCServer;
 class RPCServer;
+class MetricsServer;
 
 /**
  * @brief DeferredReq aims to defer a socket request such that the request
  * is executed only when the metadata satisfies some specific condition.
  *
+ * The request is only tested when the objects it waits for are updated, or
+ * on every update if it doesn't tell the objects, or waits for blobs.
  */
 class DeferredReq {
  public:
   using alive_t = std::function<bool()>;
   using test_t = std::function<bool(const json& meta)>;
   using call_t = std::function<Status(const json& meta)>;
+  using expire_t = std::function<void()>;
 
   DeferredReq(alive_t alive_fn, test_t test_fn, call_t call_fn)
       : alive_fn_(alive_fn), test_fn_(test_fn), call_fn_(call_fn) {}
 
+  DeferredReq(alive_t alive_fn, test_t test_fn, call_t call_fn,
+              std::vector<ObjectID> const& ids, expire_t expire_fn)
+      : alive_fn_(alive_fn),
+        test_fn_(test_fn),
+        call_fn_(call_fn),
+        expire_fn_(expire_fn),
+        ids_(ids) {}
+
   bool Alive() const;
 
   bool TestThenCall(const json& meta) const;
 
+  // being called when the request has been deferred for too long.
+  void Expire() const;
+
+  std::vector<ObjectID> const& ids() const { return ids_; }
+
  private:
   alive_t alive_fn_;
   test_t test_fn_;
   call_t call_fn_;
+  expire_t expire_fn_;
+  std::vector<ObjectID> ids_;
 };
 
 /**
@@ -81,12 +108,19 @@ class VineyardServer : public std::enable_shared_from_this<VineyardServer> {
 #if BOOST_VERSION >= 106600
   inline asio::io_context& GetContext() { return context_; }
   inline asio::io_context& GetMetaContext() { return meta_context_; }
+  inline asio::io_context& GetBulkContext() { return bulk_context_; }
 #else
   inline asio::io_service& GetContext() { return context_; }
   inline asio::io_service& GetMetaContext() { return meta_context_; }
+  inline asio::io_service& GetBulkContext() { return bulk_context_; }
 #endif
+  // the number of threads that serve the IO context.
+  inline unsigned int GetConcurrency() const { return concurrency_; }
   inline std::shared_ptr<BulkStore> GetBulkStore() { return bulk_store_; }
   inline std::shared_ptr<StreamStore> GetStreamStore() { return stream_store_; }
+  inline std::shared_ptr<QuotaManager> GetQuotaManager() {
+    return quota_manager_;
+  }
   static std::shared_ptr<VineyardServer> Get(const json& spec);
 
   void MetaReady();
@@ -96,18 +130,47 @@ class VineyardServer : public std::enable_shared_from_this<VineyardServer> {
   void BackendReady();
   void Ready();
 
+  /**
+   * When `lazy` is set, the members (except blobs) are returned as shallow
+   * stubs, see also `meta_tree::GetData`.
+   */
   Status GetData(const std::vector<ObjectID>& ids, const bool sync_remote,
-                 const bool wait,
+                 const bool wait, const bool lazy,
                  DeferredReq::alive_t alive,  // if connection is still alive
                  callback_t<const json&> callback);
 
+  /**
+   * @brief Read the metadata from the snapshot, see also `CreateSnapshot`.
+   */
+  Status GetData(const std::vector<ObjectID>& ids, const uint64_t snapshot,
+                 const bool lazy, callback_t<const json&> callback);
+
   Status ListData(std::string const& pattern, bool const regex,
                   size_t const limit, callback_t<const json&> callback);
 
+  /**
+   * @brief List a page of objects, the callback receives the objects and the
+   * cursor of the next page, see also `meta_tree::ListObjects`.
+   */
+  Status ListObjects(std::string const& pattern, bool const regex,
+                     std::string const& name_prefix, std::string const& cursor,
+                     size_t const limit, bool const brief,
+                     callback_t<const json&, const std::string&> callback);
+
   Status CreateData(
       const json& tree,
       callback_t<const ObjectID, const Signature, const InstanceID> callback);
 
+  /**
+   * @brief Create the data that expires after `ttl` seconds (never if `ttl`
+   * is not positive). The expired objects are deleted (non-forcely and
+   * deeply) in batches by the expiry timer wheel, except the ones whose local
+   * blobs are still pinned by clients, which are retried on the next tick.
+   */
+  Status CreateData(
+      const json& tree, const int64_t ttl,
+      callback_t<const ObjectID, const Signature, const InstanceID> callback);
+
   Status Persist(const ObjectID id, callback_t<> callback);
 
   Status IfPersist(const ObjectID id, callback_t<const bool> callback);
@@ -126,17 +189,99 @@ class VineyardServer : public std::enable_shared_from_this<VineyardServer> {
 
   Status DeleteBlobBatch(const std::set<ObjectID>& blobs);
 
-  Status DeleteAllAt(const json& meta, InstanceID const instance_id);
+  /**
+   * @brief Push the invalidations to the IPC clients that cache the metadata,
+   * when the metadata of the given objects has been changed or deleted, or
+   * the given names have been changed or dropped.
+   */
+  void NotifyInvalidation(const std::vector<ObjectID>& ids,
+                          const std::vector<std::string>& names);
+
+  /**
+   * @brief Push the events of the created (or persisted) objects, and the
+   * put names, to the IPC and RPC clients that subscribe them.
+   */
+  void NotifyObjects(const json& events);
+
+  /**
+   * @brief Delete the objects of an instance that has gone, in the background
+   * on the bulk context rather than inline with the heartbeat, as scanning
+   * the metadata and deleting the objects can be slow.
+   */
+  Status DeleteAllAt(InstanceID const instance_id);
 
   Status PutName(const ObjectID object_id, const std::string& name,
                  callback_t<> callback);
 
+  /**
+   * @brief Put the name that is dropped after `ttl` seconds, unless it has
+   * been put to another object in between. Putting the name again without a
+   * `ttl` cancels the expiry.
+   */
+  Status PutName(const ObjectID object_id, const std::string& name,
+                 const int64_t ttl, callback_t<> callback);
+
   Status GetName(const std::string& name, const bool wait,
                  DeferredReq::alive_t alive,  // if connection is still alive
                  callback_t<const ObjectID&> callback);
 
   Status DropName(const std::string& name, callback_t<> callback);
 
+  /**
+   * @brief The batched `PutName`, `GetName` and `DropName`, all names of a
+   * request are written in a single metadata commit. The names that cannot
+   * be found are absent in the result of `GetNames`.
+   */
+  Status PutNames(const std::map<std::string, ObjectID>& names,
+                  callback_t<> callback);
+
+  Status GetNames(const std::vector<std::string>& names,
+                  callback_t<const std::map<std::string, ObjectID>&> callback);
+
+  /**
+   * @brief Resolve the names in the snapshot, or in the latest metadata when
+   * `snapshot` is 0.
+   */
+  Status GetNames(const std::vector<std::string>& names,
+                  const uint64_t snapshot,
+                  callback_t<const std::map<std::string, ObjectID>&> callback);
+
+  /**
+   * @brief Take a snapshot of the local metadata (after synced with the
+   * metadata service if `sync_remote`), for consistent reads of multiple
+   * objects and names, see also `GetData` and `GetNames`.
+   *
+   * Snapshots share the copy of the metadata as long as it isn't updated in
+   * between. The blobs deleted while older snapshots are alive are retired
+   * rather than freed, and are reclaimed once no snapshot refers them.
+   */
+  Status CreateSnapshot(const bool sync_remote,
+                        callback_t<const uint64_t> callback);
+
+  Status ReleaseSnapshot(const uint64_t snapshot);
+
+  /**
+   * @brief Serve the membership probe from another instance, see also
+   * `Membership`.
+   */
+  Status Gossip(const InstanceID from, const InstanceID target,
+                const json& updates,
+                callback_t<const bool, const json&> callback);
+
+  Status DropNames(const std::vector<std::string>& names,
+                   callback_t<> callback);
+
+  /**
+   * @brief Create, persist and name objects with all-or-nothing semantics,
+   * see also `WriteBatchRequest` for the format of `ops`.
+   *
+   * The created objects are inserted in a single local metadata update, and
+   * the persisting and naming are committed to the metadata service as a
+   * single request. If the commit fails, the created objects are removed
+   * again.
+   */
+  Status Batch(const json& ops, callback_t<const json&> callback);
+
   Status MigrateObject(const ObjectID object_id, const bool local,
                        const std::string& peer,
                        const std::string& peer_rpc_endpoint,
@@ -151,13 +296,62 @@ class VineyardServer : public std::enable_shared_from_this<VineyardServer> {
 
   Status InstanceStatus(callback_t<const json&> callback);
 
-  Status ProcessDeferred(const json& meta);
+  /**
+   * @brief Aggregate the bytes of the blobs of the object per instance, for
+   * the locality-aware schedulers.
+   */
+  Status LocalityInfo(const ObjectID id, const bool sync_remote,
+                      callback_t<const json&> callback);
+
+  /**
+   * @brief Stage the local blobs of the objects (or replicas) in memory and
+   * pre-fault them, see also `BulkStore::Prefetch`.
+   */
+  Status Prefetch(const std::vector<ObjectID>& ids,
+                  callback_t<const size_t> callback);
+
+  /**
+   * @brief Query the shared memory taken by the given objects (or the `limit`
+   * largest objects if `ids` is empty), and by every typename, see also
+   * `FootprintIndex::Query`.
+   */
+  Status Footprints(const std::vector<ObjectID>& ids, const size_t limit,
+                    callback_t<const json&> callback);
+
+  /**
+   * @brief Drop the footprints of the deleted objects, must be called on the
+   * meta context.
+   */
+  void EraseFootprints(const std::vector<ObjectID>& ids);
+
+  /**
+   * @brief Test the deferred requests that wait for the updated objects, must
+   * be called on the meta context.
+   */
+  Status ProcessDeferred(const json& meta, const std::vector<ObjectID>& ids);
+
+  /**
+   * @brief Wake up the `GetName` requests that wait for the given names, must
+   * be called on the meta context.
+   */
+  void ProcessNameWaiters(const std::vector<std::string>& names);
 
   inline InstanceID instance_id() { return instance_id_; }
+
+  /**
+   * @brief An opaque token that identifies this server process, used by the
+   * clients to tell whether the fds they have received are still valid.
+   */
+  inline uint64_t server_token() const { return server_token_; }
   inline std::string instance_name() { return instance_name_; }
-  inline void set_instance_id(InstanceID id) {
+  inline Status set_instance_id(InstanceID id) {
+    if (!SetIDGeneratorInstanceID(id)) {
+      return Status::Invalid("The instance id " + std::to_string(id) +
+                             " cannot be encoded in the object ids");
+    }
     instance_id_ = id;
     instance_name_ = "i" + std::to_string(instance_id_);
+    return Status::OK();
   }
 
   inline std::string const& hostname() { return hostname_; }
@@ -183,13 +377,37 @@ class VineyardServer : public std::enable_shared_from_this<VineyardServer> {
  private:
   explicit VineyardServer(const json& spec);
 
+  // registers the gauges of stores, and serves the metrics if required.
+  void registerMetrics();
+
+  // records the footprint of a created object, and registers the gauges of
+  // the typename when it is seen for the first time.
+  void recordFootprint(const ObjectID id, const std::string& type,
+                       const size_t size);
+
+  // resolves the metadata of the objects, when exist, into the group.
+  void getDataGroup(const json& meta, const std::vector<ObjectID>& ids,
+                    const bool lazy, json& sub_tree_group);
+
+  // the minimum version of the alive snapshots, requires `snapshots_mutex_`
+  // been held.
+  uint64_t oldestSnapshot() const;
+
+  // deletes the objects from `offset` a batch at a time, see `DeleteAllAt`.
+  void deleteInBatches(std::shared_ptr<std::vector<ObjectID>> const& objects,
+                       size_t const offset);
+
   json spec_;
 
   unsigned int concurrency_;
+  // the long-running commands (e.g., listing or deleting large trees) are
+  // served by a smaller pool, thus they won't starve the latency-critical
+  // ones on `context_`.
+  unsigned int bulk_concurrency_;
 #if BOOST_VERSION >= 106600
-  asio::io_context context_, meta_context_;
+  asio::io_context context_, meta_context_, bulk_context_;
 #else
-  asio::io_service context_, meta_context_;
+  asio::io_service context_, meta_context_, bulk_context_;
 #endif
 
 #if BOOST_VERSION >= 106600
@@ -197,17 +415,95 @@ class VineyardServer : public std::enable_shared_from_this<VineyardServer> {
 #else
   using ctx_guard = std::unique_ptr<boost::asio::io_service::work>;
 #endif
-  ctx_guard guard_, meta_guard_;
+  ctx_guard guard_, meta_guard_, bulk_guard_;
   std::vector<std::thread> workers_;
 
   std::shared_ptr<IMetaService> meta_service_ptr_;
   std::unique_ptr<IPCServer> ipc_server_ptr_;
   std::unique_ptr<RPCServer> rpc_server_ptr_;
+  std::unique_ptr<MetricsServer> metrics_server_ptr_;
+
+  // defers the request, must be called on the meta context.
+  void deferRequest(DeferredReq&& req);
+
+  void eraseDeferred(const uint64_t serial);
 
-  std::list<DeferredReq> deferred_;
+  // puts the request into the slot of the timer wheel
+  void scheduleDeferred(const uint64_t serial,
+                        const std::chrono::steady_clock::time_point deadline);
+
+  // visits the next slot of the timer wheel, for the requests of the
+  // closed connections and the expired requests.
+  void tickDeferred();
+
+  struct deferred_t {
+    DeferredReq req;
+    std::chrono::steady_clock::time_point deadline;
+  };
+  uint64_t next_deferred_ = 0;
+  std::unordered_map<uint64_t, deferred_t> deferred_;
+  // object id -> the deferred requests that wait for it
+  std::unordered_multimap<ObjectID, uint64_t> deferred_index_;
+  // the requests that are tested on every update
+  std::unordered_set<uint64_t> unindexed_deferred_;
+  // the timer wheel of one-second slots, the stale entries are skipped.
+  std::vector<std::vector<uint64_t>> deferred_wheel_;
+  size_t deferred_cursor_ = 0;
+  std::unique_ptr<asio::steady_timer> deferred_timer_;
+  int64_t deferred_timeout_ = 0;  // in seconds, 0 means never
+
+  // schedules the expiry of the object, or of the name when `name` is not
+  // empty, a non-positive `ttl` cancels it, must be called on the meta
+  // context.
+  void scheduleExpiry(const ObjectID id, const std::string& name,
+                      const int64_t ttl);
+
+  void enqueueExpiry(const ObjectID id, const std::string& name,
+                     const std::chrono::steady_clock::time_point deadline);
+
+  // visits the next slot of the expiry wheel, and deletes the expired objects
+  // and names in a batch.
+  void tickExpiry();
+
+  struct expiry_t {
+    ObjectID id;
+    std::string name;
+    std::chrono::steady_clock::time_point deadline;
+  };
+  std::unordered_map<ObjectID, std::chrono::steady_clock::time_point>
+      expiring_objects_;
+  // name -> (object id, deadline)
+  std::unordered_map<std::string,
+                     std::pair<ObjectID, std::chrono::steady_clock::time_point>>
+      expiring_names_;
+  // the timer wheel of one-second slots, the entries whose deadline has been
+  // changed are skipped.
+  std::vector<std::vector<expiry_t>> expiry_wheel_;
+  size_t expiry_cursor_ = 0;
+  std::unique_ptr<asio::steady_timer> expiry_timer_;
+
+  struct snapshot_t {
+    uint64_t version;
+    std::shared_ptr<const json> meta;
+  };
+  std::mutex snapshots_mutex_;
+  uint64_t next_snapshot_ = 1;
+  std::unordered_map<uint64_t, snapshot_t> snapshots_;
+  // (the metadata version when being deleted, blobs)
+  std::deque<std::pair<uint64_t, std::set<ObjectID>>> retired_blobs_;
+
+  struct name_waiter_t {
+    DeferredReq::alive_t alive;
+    callback_t<const ObjectID&> callback;
+  };
+  // name -> the requests waiting for the name, accessed on the meta context
+  std::unordered_map<std::string, std::vector<name_waiter_t>> name_waiters_;
 
   std::shared_ptr<BulkStore> bulk_store_;
   std::shared_ptr<StreamStore> stream_store_;
+  std::shared_ptr<QuotaManager> quota_manager_;
+  std::shared_ptr<FootprintIndex> footprints_ =
+      std::make_shared<FootprintIndex>();
 
   Status serve_status_;
 
@@ -223,6 +519,7 @@ class VineyardServer : public std::enable_shared_from_this<VineyardServer> {
   std::atomic_bool stopped_;  // avoid invoke Stop() twice.
 
   InstanceID instance_id_;
+  const uint64_t server_token_;
   std::string instance_name_;
   std::string hostname_;
   std::string nodename_;
@@ -37,6 +37,17 @@ void EtcdWatchHandler::operator()(pplx::task<etcd::Response> const& resp_task) {
   this->operator()(resp_task.get());
 }
 
+// The watch is canceled with the compact revision when the revision to watch
+// from has been compacted, and the requests on a compacted revision fail
+// with ErrCompacted, i.e., grpc::StatusCode::OUT_OF_RANGE.
+constexpr int kEtcdErrorOutOfRange = 11;
+
+static bool is_compacted(etcd::Response const& resp) {
+  return resp.error_code() != 0 &&
+         (resp.compact_revision() > 0 ||
+          resp.error_code() == kEtcdErrorOutOfRange);
+}
+
 void EtcdWatchHandler::operator()(etcd::Response const& resp) {
   VLOG(10) << "etcd watch use " << resp.duration().count()
            << " microseconds, event size = " << resp.events().size();
@@ -92,6 +103,9 @@ void EtcdWatchHandler::operator()(etcd::Response const& resp) {
 #endif
 
   auto status = Status::EtcdError(resp.error_code(), resp.error_message());
+  if (is_compacted(resp)) {
+    compacted_.store(true);
+  }
 
   // NB: update the `handled_rev_` after we have truely applied the update ops.
   ctx_.post(boost::bind(callback_, status, ops, head_rev,
@@ -163,7 +177,7 @@ void EtcdMetaService::commitUpdates(
     for (size_t idx = offset; idx < offset + 127; ++idx) {
       auto const& op = changes[idx];
       if (op.op == op_t::kPut) {
-        tx.setup_put(prefix_ + op.kv.key, op.kv.value);
+        tx.setup_put(prefix_ + op.kv.key, encodeValue(op));
       } else if (op.op == op_t::kDel) {
         tx.setup_delete(prefix_ + op.kv.key);
       }
@@ -184,7 +198,7 @@ void EtcdMetaService::commitUpdates(
   for (size_t idx = offset; idx < changes.size(); ++idx) {
     auto const& op = changes[idx];
     if (op.op == op_t::kPut) {
-      tx.setup_put(prefix_ + op.kv.key, op.kv.value);
+      tx.setup_put(prefix_ + op.kv.key, encodeValue(op));
     } else if (op.op == op_t::kDel) {
       tx.setup_delete(prefix_ + op.kv.key);
     }
@@ -212,7 +226,8 @@ void EtcdMetaService::requestAll(
                  << " microseconds for " << resp.keys().size() << " keys";
         LOG_SUMMARY("etcd_request_duration_microseconds", "ls",
                     resp.duration().count());
-        std::vector<IMetaService::op_t> ops(resp.keys().size());
+        std::vector<IMetaService::op_t> ops;
+        ops.reserve(resp.keys().size());
         for (size_t i = 0; i < resp.keys().size(); ++i) {
           if (resp.key(i).empty()) {
             continue;
@@ -234,6 +249,17 @@ void EtcdMetaService::requestAll(
       });
 }
 
+void EtcdMetaService::requestHeadRevision(callback_t<unsigned> callback) {
+  etcd_->head().then([this, callback](pplx::task<etcd::Response> resp_task) {
+    auto resp = resp_task.get();
+    LOG_SUMMARY("etcd_request_duration_microseconds", "head",
+                resp.duration().count());
+    auto status = Status::EtcdError(resp.error_code(), resp.error_message());
+    server_ptr_->GetMetaContext().post(boost::bind(
+        callback, status, static_cast<unsigned>(resp.index())));
+  });
+}
+
 void EtcdMetaService::requestUpdates(
     const std::string& prefix, unsigned,
     callback_t<const std::vector<op_t>&, unsigned> callback) {
@@ -269,7 +295,8 @@ void EtcdMetaService::startDaemonWatch(
       handler_.reset(new EtcdWatchHandler(
           server_ptr_->GetMetaContext(), callback, prefix_,
           prefix_ + meta_sync_lock_, this->registered_callbacks_,
-          this->handled_rev_, this->registered_callbacks_mutex_));
+          this->handled_rev_, this->registered_callbacks_mutex_,
+          this->watch_compacted_));
     }
     this->watcher_.reset(new etcd::Watcher(
         *etcd_, prefix_ + prefix, since_rev + 1, std::ref(*handler_), true)),
@@ -297,12 +324,34 @@ void EtcdMetaService::retryDaeminWatch(
     if (error) {
       LOG(ERROR) << "backoff timer error: " << error << ", " << error.message();
     }
+    if (this->resyncing_.load()) {
+      // wait until the whole metadata has been reloaded.
+      this->retryDaeminWatch(prefix, callback);
+      return;
+    }
     // retry
     LOG(INFO) << "retrying to connect etcd...";
     this->startDaemonWatch(prefix, handled_rev_.load(), callback);
   });
 }
 
+std::string EtcdMetaService::encodeValue(const op_t& op) const {
+  static const std::string data_prefix = "/data/";
+  if (!compact_values_ || op.kv.value.empty() || op.kv.value[0] != '{' ||
+      !boost::algorithm::starts_with(op.kv.key, data_prefix) ||
+      op.kv.key.find('/', data_prefix.size()) != std::string::npos) {
+    return op.kv.value;
+  }
+  try {
+    std::vector<uint8_t> encoded = json::to_cbor(json::parse(op.kv.value));
+    return std::string(encoded.begin(), encoded.end());
+  } catch (std::exception const& e) {
+    LOG(WARNING) << "Failed to encode the value of " << op.kv.key << ": "
+                 << e.what();
+    return op.kv.value;
+  }
+}
+
 Status EtcdMetaService::preStart() {
   auto launcher = EtcdLauncher(etcd_spec_);
   return launcher.LaunchEtcdServer(etcd_, meta_sync_lock_, etcd_proc_);
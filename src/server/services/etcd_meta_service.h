@@ -65,14 +65,15 @@ class EtcdWatchHandler {
       std::string const& prefix, std::string const& filter_prefix,
       callback_task_queue_t& registered_callbacks,
       std::atomic<unsigned>& handled_rev,
-      std::mutex& registered_callbacks_mutex)
+      std::mutex& registered_callbacks_mutex, std::atomic<bool>& compacted)
       : ctx_(ctx),
         callback_(callback),
         prefix_(prefix),
         filter_prefix_(filter_prefix),
         registered_callbacks_(registered_callbacks),
         handled_rev_(handled_rev),
-        registered_callbacks_mutex_(registered_callbacks_mutex) {
+        registered_callbacks_mutex_(registered_callbacks_mutex),
+        compacted_(compacted) {
   }
 
   void operator()(pplx::task<etcd::Response> const& resp_task);
@@ -92,6 +93,9 @@ class EtcdWatchHandler {
   callback_task_queue_t& registered_callbacks_;
   std::atomic<unsigned>& handled_rev_;
   std::mutex& registered_callbacks_mutex_;
+  // set when the watched revision has been compacted, see also
+  // `IMetaService::daemonWatchHandler`.
+  std::atomic<bool>& compacted_;
 };
 
 /**
@@ -120,6 +124,7 @@ class EtcdLock : public ILock {
 class EtcdMetaService : public IMetaService {
  public:
   inline void Stop() override {
+    stopMembership();
     if (watcher_) {
       try {
         watcher_->Cancel();
@@ -137,7 +142,8 @@ class EtcdMetaService : public IMetaService {
   explicit EtcdMetaService(vs_ptr_t& server_ptr)
       : IMetaService(server_ptr),
         etcd_spec_(server_ptr_->GetSpec()["metastore_spec"]),
-        prefix_(etcd_spec_["prefix"].get_ref<std::string const&>()) {
+        prefix_(etcd_spec_["prefix"].get_ref<std::string const&>()),
+        compact_values_(etcd_spec_.value("compact_values", false)) {
     this->handled_rev_.store(0);
   }
 
@@ -149,6 +155,8 @@ class EtcdMetaService : public IMetaService {
       const std::string& prefix, unsigned base_rev,
       callback_t<const std::vector<op_t>&, unsigned> callback) override;
 
+  void requestHeadRevision(callback_t<unsigned> callback) override;
+
   void requestUpdates(
       const std::string& prefix, unsigned since_rev,
       callback_t<const std::vector<op_t>&, unsigned> callback) override;
@@ -156,6 +164,9 @@ class EtcdMetaService : public IMetaService {
   void commitUpdates(const std::vector<op_t>&,
                      callback_t<unsigned> callback_after_updated) override;
 
+  // conforms the max-txn-ops limitation (128) of etcd.
+  size_t maxOpsPerCommit() const override { return 127; }
+
   void startDaemonWatch(
       const std::string& prefix, unsigned since_rev,
       callback_t<const std::vector<op_t>&, unsigned, callback_t<unsigned>>
@@ -177,10 +188,15 @@ class EtcdMetaService : public IMetaService {
 
   const json etcd_spec_;
   const std::string prefix_;
+  const bool compact_values_;
 
  private:
   Status preStart() override;
 
+  // the value to put into etcd, the metadata of objects (the "/data/<id>"
+  // keys) is encoded as CBOR if `compact_values_` is enabled.
+  std::string encodeValue(const op_t& op) const;
+
   std::unique_ptr<etcd::Client> etcd_;
   std::shared_ptr<etcd::Watcher> watcher_;
   std::shared_ptr<EtcdWatchHandler> handler_;
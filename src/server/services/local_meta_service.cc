@@ -0,0 +1,136 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "server/services/local_meta_service.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "boost/algorithm/string.hpp"
+
+#include "common/util/boost.h"
+#include "common/util/logging.h"
+
+namespace vineyard {
+
+void LocalMetaService::requestLock(
+    std::string lock_name,
+    callback_t<std::shared_ptr<ILock>> callback_after_locked) {
+  unsigned rev = 0;
+  {
+    std::lock_guard<std::mutex> scope_lock(mutex_);
+    rev = head_rev_;
+  }
+  auto lock_ptr = std::make_shared<LocalLock>(
+      [this](const Status& status, unsigned& rev) {
+        std::lock_guard<std::mutex> scope_lock(this->mutex_);
+        rev = this->head_rev_;
+        return Status::OK();
+      },
+      rev);
+  server_ptr_->GetMetaContext().post(
+      boost::bind(callback_after_locked, Status::OK(), lock_ptr));
+}
+
+void LocalMetaService::requestAll(
+    const std::string& prefix, unsigned base_rev,
+    callback_t<const std::vector<op_t>&, unsigned> callback) {
+  std::vector<op_t> ops;
+  unsigned rev = 0;
+  {
+    std::lock_guard<std::mutex> scope_lock(mutex_);
+    for (auto iter = store_.lower_bound(prefix);
+         iter != store_.end() &&
+         boost::algorithm::starts_with(iter->first, prefix);
+         ++iter) {
+      ops.emplace_back(op_t::Put(iter->first, iter->second, head_rev_));
+    }
+    rev = head_rev_;
+  }
+  server_ptr_->GetMetaContext().post(
+      boost::bind(callback, Status::OK(), ops, rev));
+}
+
+void LocalMetaService::requestHeadRevision(callback_t<unsigned> callback) {
+  unsigned rev = 0;
+  {
+    std::lock_guard<std::mutex> scope_lock(mutex_);
+    rev = head_rev_;
+  }
+  server_ptr_->GetMetaContext().post(boost::bind(callback, Status::OK(), rev));
+}
+
+void LocalMetaService::requestUpdates(
+    const std::string& prefix, unsigned,
+    callback_t<const std::vector<op_t>&, unsigned> callback) {
+  // the committed updates have been posted to the daemon watch in order,
+  // on the same context.
+  unsigned rev = 0;
+  {
+    std::lock_guard<std::mutex> scope_lock(mutex_);
+    rev = head_rev_;
+  }
+  server_ptr_->GetMetaContext().post(
+      boost::bind(callback, Status::OK(), std::vector<op_t>{}, rev));
+}
+
+void LocalMetaService::commitUpdates(
+    const std::vector<op_t>& changes,
+    callback_t<unsigned> callback_after_updated) {
+  std::vector<op_t> events;
+  unsigned rev = 0;
+  {
+    std::lock_guard<std::mutex> scope_lock(mutex_);
+    rev = ++head_rev_;
+    for (auto const& op : changes) {
+      if (op.op == op_t::kPut) {
+        store_[op.kv.key] = op.kv.value;
+        events.emplace_back(op_t::Put(op.kv.key, op.kv.value, rev));
+      } else if (op.op == op_t::kDel) {
+        // drop the key and the keys under it, e.g., the fields of an
+        // object, only the existing keys generate the events.
+        auto iter = store_.find(op.kv.key);
+        if (iter != store_.end()) {
+          events.emplace_back(op_t::Del(iter->first, rev));
+          store_.erase(iter);
+        }
+        std::string const dir = op.kv.key + "/";
+        iter = store_.lower_bound(dir);
+        while (iter != store_.end() &&
+               boost::algorithm::starts_with(iter->first, dir)) {
+          events.emplace_back(op_t::Del(iter->first, rev));
+          iter = store_.erase(iter);
+        }
+      }
+    }
+  }
+  if (watch_callback_ && !events.empty()) {
+    server_ptr_->GetMetaContext().post(
+        boost::bind(watch_callback_, Status::OK(), events, rev,
+                    [](const Status& status, unsigned) { return status; }));
+  }
+  server_ptr_->GetMetaContext().post(
+      boost::bind(callback_after_updated, Status::OK(), rev));
+}
+
+void LocalMetaService::startDaemonWatch(
+    const std::string& prefix, unsigned since_rev,
+    callback_t<const std::vector<op_t>&, unsigned, callback_t<unsigned>>
+        callback) {
+  watch_callback_ = callback;
+}
+
+}  // namespace vineyard
@@ -0,0 +1,103 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef SRC_SERVER_SERVICES_LOCAL_META_SERVICE_H_
+#define SRC_SERVER_SERVICES_LOCAL_META_SERVICE_H_
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "server/services/meta_service.h"
+
+namespace vineyard {
+
+/**
+ * @brief LocalLock is the lock of the in-process meta service, the holders
+ * of it have already been serialized by the group commit of `IMetaService`.
+ *
+ */
+class LocalLock : public ILock {
+ public:
+  Status Release(unsigned& rev) override {
+    return callback_(Status::OK(), rev);
+  }
+  ~LocalLock() override {}
+
+  explicit LocalLock(const callback_t<unsigned&>& callback, unsigned rev)
+      : ILock(rev), callback_(callback) {}
+
+ protected:
+  const callback_t<unsigned&> callback_;
+};
+
+/**
+ * @brief LocalMetaService keeps the metadata inside the vineyardd process,
+ * for the single-node deployments, without launching an etcd.
+ *
+ * It behaves like a single-member etcd: every commit gets a new revision
+ * and is delivered back to the daemon watch as the remote updates.
+ *
+ */
+class LocalMetaService : public IMetaService {
+ public:
+  inline void Stop() override {
+    LOG(INFO) << "local meta service is stopping ...";
+  }
+
+ protected:
+  explicit LocalMetaService(vs_ptr_t& server_ptr) : IMetaService(server_ptr) {}
+
+  void requestLock(
+      std::string lock_name,
+      callback_t<std::shared_ptr<ILock>> callback_after_locked) override;
+
+  void requestAll(
+      const std::string& prefix, unsigned base_rev,
+      callback_t<const std::vector<op_t>&, unsigned> callback) override;
+
+  void requestHeadRevision(callback_t<unsigned> callback) override;
+
+  void requestUpdates(
+      const std::string& prefix, unsigned since_rev,
+      callback_t<const std::vector<op_t>&, unsigned> callback) override;
+
+  void commitUpdates(const std::vector<op_t>&,
+                     callback_t<unsigned> callback_after_updated) override;
+
+  void startDaemonWatch(
+      const std::string& prefix, unsigned since_rev,
+      callback_t<const std::vector<op_t>&, unsigned, callback_t<unsigned>>
+          callback) override;
+
+  Status probe() override { return Status::OK(); }
+
+ private:
+  // protects the store and revision from the callers of other threads.
+  std::mutex mutex_;
+  std::map<std::string, std::string> store_;
+  unsigned head_rev_ = 0;
+
+  callback_t<const std::vector<op_t>&, unsigned, callback_t<unsigned>>
+      watch_callback_;
+
+  friend class IMetaService;
+};
+
+}  // namespace vineyard
+
+#endif  // SRC_SERVER_SERVICES_LOCAL_META_SERVICE_H_
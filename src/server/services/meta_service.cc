@@ -16,16 +16,26 @@ limitations under the License.
 #include "server/services/meta_service.h"
 
 #include <algorithm>
+#include <cstdio>
+#include <fstream>
 #include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
 
 #include "glog/logging.h"
 
 #include "server/services/etcd_meta_service.h"
+#include "server/services/local_meta_service.h"
 #include "server/util/meta_tree.h"
 
 namespace vineyard {
 
 std::shared_ptr<IMetaService> IMetaService::Get(vs_ptr_t ptr) {
+  auto const& spec = ptr->GetSpec()["metastore_spec"];
+  if (spec.value("meta", "etcd") == "local") {
+    return std::shared_ptr<IMetaService>(new LocalMetaService(ptr));
+  }
   return std::shared_ptr<IMetaService>(new EtcdMetaService(ptr));
 }
 
@@ -161,61 +171,119 @@ void IMetaService::traverseToDelete(std::set<ObjectID>& initial_delete_set,
                                     const bool deep) {
   // emulate a topological sort to ensure the correctness when deleting multiple
   // objects at the same time.
-  if (delete_set.find(object_id) != delete_set.end()) {
-    // already been processed
-    if (depthes[depth] < depth) {
-      depthes[depth] = depth;
+  //
+  // The traversal uses an explicit stack rather than recursion, as the
+  // dependency graph of large objects (e.g., fragment groups with hundreds of
+  // thousands of blobs) can be very deep.
+  //
+  // The `targets` of a frame are visited before it moves on, and the stage
+  // tells which targets they are.
+  enum class stage_t {
+    kStart,
+    kUpwards,  // the supobjects in "initial_delete_set"
+    kDelete,   // the members to delete downwards
+    kForce,    // the supobjects to delete upwards, when being forced
+    kFinish,
+  };
+  struct frame_t {
+    ObjectID object_id;
+    int32_t depth;
+    bool force;
+    bool deep;
+    stage_t stage;
+    std::vector<ObjectID> targets;
+    size_t next;
+  };
+  std::vector<frame_t> stack;
+  stack.emplace_back(
+      frame_t{object_id, depth, force, deep, stage_t::kStart, {}, 0});
+
+  while (!stack.empty()) {
+    frame_t& frame = stack.back();
+    if (frame.next < frame.targets.size()) {
+      // visit the pending targets first
+      ObjectID target = frame.targets[frame.next++];
+      switch (frame.stage) {
+      case stage_t::kUpwards:
+        stack.emplace_back(frame_t{target, frame.depth + 1, frame.force,
+                                   frame.deep, stage_t::kStart, {}, 0});
+        break;
+      case stage_t::kDelete:
+        stack.emplace_back(frame_t{target, frame.depth - 1, false, true,
+                                   stage_t::kStart, {}, 0});
+        break;
+      default:
+        stack.emplace_back(frame_t{target, frame.depth + 1, true, false,
+                                   stage_t::kStart, {}, 0});
+        break;
+      }
+      continue;
     }
-    return;
-  }
-  // process the "initial_delete_set" in topo-sort order.
-  auto sup_target_range = supobjects_.equal_range(object_id);
-  std::set<ObjectID> sup_traget_to_preprocess;
-  for (auto it = sup_target_range.first; it != sup_target_range.second; ++it) {
-    if (initial_delete_set.find(it->second) != initial_delete_set.end()) {
-      sup_traget_to_preprocess.emplace(it->second);
+    frame.targets.clear();
+    frame.next = 0;
+
+    switch (frame.stage) {
+    case stage_t::kStart: {
+      if (delete_set.find(frame.object_id) != delete_set.end()) {
+        // already been processed
+        if (depthes[frame.depth] < frame.depth) {
+          depthes[frame.depth] = frame.depth;
+        }
+        stack.pop_back();
+        continue;
+      }
+      // process the "initial_delete_set" in topo-sort order.
+      std::set<ObjectID> sup_traget_to_preprocess;
+      auto sup_target_range = supobjects_.equal_range(frame.object_id);
+      for (auto it = sup_target_range.first; it != sup_target_range.second;
+           ++it) {
+        if (initial_delete_set.find(it->second) != initial_delete_set.end()) {
+          sup_traget_to_preprocess.emplace(it->second);
+        }
+      }
+      frame.targets.assign(sup_traget_to_preprocess.begin(),
+                           sup_traget_to_preprocess.end());
+      frame.stage = stage_t::kUpwards;
+      break;
     }
-  }
-  for (ObjectID const& sup_target : sup_traget_to_preprocess) {
-    traverseToDelete(initial_delete_set, delete_set, depth + 1, depthes,
-                     sup_target, force, deep);
-  }
-  if (force || deleteable(object_id)) {
-    delete_set.emplace(object_id);
-    depthes[object_id] = depth;
-    {
+    case stage_t::kUpwards: {
+      if (!(frame.force || deleteable(frame.object_id))) {
+        frame.stage = stage_t::kFinish;
+        break;
+      }
+      delete_set.emplace(frame.object_id);
+      depthes[frame.object_id] = frame.depth;
       // delete downwards
       std::set<ObjectID> to_delete;
       {
         // delete sup-edges of subobjects
-        auto range = subobjects_.equal_range(object_id);
+        auto range = subobjects_.equal_range(frame.object_id);
         for (auto it = range.first; it != range.second; ++it) {
           // remove dependency edge
           auto suprange = supobjects_.equal_range(it->second);
           decltype(suprange.first) p;
           for (p = suprange.first; p != suprange.second; /* no self-inc */) {
-            if (p->second == object_id) {
+            if (p->second == frame.object_id) {
               supobjects_.erase(p++);
             } else {
               ++p;
             }
           }
-          if (deep || IsBlob(it->second)) {
+          if (frame.deep || IsBlob(it->second)) {
             // blob is special: see Note [Deleting objects and blobs].
             to_delete.emplace(it->second);
           }
         }
       }
-
       {
         // delete sub-edges of supobjects
-        auto range = supobjects_.equal_range(object_id);
+        auto range = supobjects_.equal_range(frame.object_id);
         for (auto it = range.first; it != range.second; ++it) {
           // remove dependency edge
           auto subrange = subobjects_.equal_range(it->second);
           decltype(subrange.first) p;
           for (p = subrange.first; p != subrange.second; /* no self-inc */) {
-            if (p->second == object_id) {
+            if (p->second == frame.object_id) {
               subobjects_.erase(p++);
             } else {
               ++p;
@@ -223,43 +291,48 @@ void IMetaService::traverseToDelete(std::set<ObjectID>& initial_delete_set,
           }
         }
       }
-
-      for (auto const& target : to_delete) {
-        traverseToDelete(initial_delete_set, delete_set, depth - 1, depthes,
-                         target, false, true);
-      }
+      frame.targets.assign(to_delete.begin(), to_delete.end());
+      frame.stage = stage_t::kDelete;
+      break;
     }
-    if (force) {
-      // delete upwards
-      std::set<ObjectID> to_delete;
-      auto range = supobjects_.equal_range(object_id);
-      for (auto it = range.first; it != range.second; ++it) {
-        // remove dependency edge
-        auto subrange = subobjects_.equal_range(it->second);
-        decltype(subrange.first) p;
-        for (p = subrange.first; p != subrange.second; /* no self-inc */) {
-          if (p->second == object_id) {
-            subobjects_.erase(p++);
-          } else {
-            ++p;
+    case stage_t::kDelete: {
+      if (frame.force) {
+        // delete upwards
+        std::set<ObjectID> to_delete;
+        auto range = supobjects_.equal_range(frame.object_id);
+        for (auto it = range.first; it != range.second; ++it) {
+          // remove dependency edge
+          auto subrange = subobjects_.equal_range(it->second);
+          decltype(subrange.first) p;
+          for (p = subrange.first; p != subrange.second; /* no self-inc */) {
+            if (p->second == frame.object_id) {
+              subobjects_.erase(p++);
+            } else {
+              ++p;
+            }
           }
-        }
-        if (force) {
           to_delete.emplace(it->second);
         }
+        frame.targets.assign(to_delete.begin(), to_delete.end());
       }
-      if (force) {
-        for (auto const& target : to_delete) {
-          traverseToDelete(initial_delete_set, delete_set, depth + 1, depthes,
-                           target, true, false);
-        }
+      frame.stage = stage_t::kForce;
+      break;
+    }
+    case stage_t::kForce: {
+      subobjects_.erase(frame.object_id);
+      supobjects_.erase(frame.object_id);
+      frame.stage = stage_t::kFinish;
+      break;
+    }
+    case stage_t::kFinish: {
+      if (initial_delete_set.find(frame.object_id) !=
+          initial_delete_set.end()) {
+        initial_delete_set.erase(frame.object_id);
       }
+      stack.pop_back();
+      break;
+    }
     }
-    subobjects_.erase(object_id);
-    supobjects_.erase(object_id);
-  }
-  if (initial_delete_set.find(object_id) != initial_delete_set.end()) {
-    initial_delete_set.erase(object_id);
   }
 }
 
@@ -307,10 +380,20 @@ void IMetaService::printDepsGraph() {
            << ss.str();
 }
 
+// The metadata of objects may be stored as CBOR, see also
+// `EtcdMetaService::encodeValue`. A JSON text never starts with the initial
+// byte of a CBOR map (major type 5).
+static json parse_value(std::string const& value) {
+  if (!value.empty() && (static_cast<uint8_t>(value[0]) & 0xe0) == 0xa0) {
+    return json::from_cbor(value);
+  }
+  return json::parse(value);
+}
+
 void IMetaService::putVal(const kv_t& kv, bool const from_remote) {
   // don't crash the server for any reason (any potential garbage value)
   auto upsert_to_meta = [&]() -> Status {
-    json value = json::parse(kv.value);
+    json value = parse_value(kv.value);
     if (value.is_string()) {
       IncRef(server_ptr_->instance_name(), kv.key,
              value.get_ref<std::string const&>(), from_remote);
@@ -366,6 +449,48 @@ void IMetaService::putVal(const kv_t& kv, bool const from_remote) {
   VINEYARD_LOG_ERROR(CATCH_JSON_ERROR(upsert_to_meta()));
 }
 
+void IMetaService::updateTypeIndex(std::string const& name) {
+  auto iter = object_types_.find(name);
+  if (iter != object_types_.end()) {
+    auto type_iter = type_index_.find(iter->second);
+    if (type_iter != type_index_.end()) {
+      type_iter->second.erase(name);
+      if (type_iter->second.empty()) {
+        type_index_.erase(type_iter);
+      }
+    }
+    object_types_.erase(iter);
+  }
+  std::string type;
+  if (meta_tree::GetTypeName(meta_, name, type).ok()) {
+    type_index_[type].emplace(name);
+    object_types_.emplace(name, type);
+  }
+}
+
+void IMetaService::updateNameIndex(std::string const& name) {
+  auto iter = name_index_.find(name);
+  if (iter != name_index_.end()) {
+    auto range = object_names_.equal_range(iter->second);
+    for (auto entry = range.first; entry != range.second; ++entry) {
+      if (entry->second == name) {
+        object_names_.erase(entry);
+        break;
+      }
+    }
+    name_index_.erase(iter);
+  }
+  auto names = meta_.find("names");
+  if (names != meta_.end() && names->is_object()) {
+    auto entry = names->find(name);
+    if (entry != names->end() && entry->is_number_integer()) {
+      ObjectID object_id = entry->get<ObjectID>();
+      name_index_[name] = object_id;
+      object_names_.emplace(object_id, name);
+    }
+  }
+}
+
 void IMetaService::delVal(std::string const& key) {
   auto path = json::json_pointer(key);
   if (meta_.contains(path)) {
@@ -396,4 +521,389 @@ void IMetaService::delVal(ObjectID const& target, std::set<ObjectID>& blobs) {
   }
 }
 
+void IMetaService::resyncValues(callback_t<unsigned> callback_after_update) {
+  LOG(WARNING) << "The watched revision " << rev_
+               << " has been compacted, reload the whole metadata";
+  resyncing_.store(true);
+  requestAll("", rev_, [this, callback_after_update](
+                           const Status& status, const std::vector<op_t>& ops,
+                           unsigned rev) {
+    if (status.ok()) {
+      // the keys that have been deleted during the gap are gone from the
+      // reloaded ones.
+      std::vector<op_t> changes(ops);
+      std::set<std::string> keys;
+      for (auto const& op : ops) {
+        keys.emplace(op.kv.key);
+      }
+      for (auto const& kv : snapshot_kvs_) {
+        if (keys.find(kv.first) == keys.end()) {
+          changes.emplace_back(op_t::Del(kv.first, rev));
+        }
+      }
+      for (auto const& key : remote_keys_) {
+        if (keys.find(key) == keys.end()) {
+          changes.emplace_back(op_t::Del(key, rev));
+        }
+      }
+      this->metaUpdate(changes, true);
+      rev_ = rev;
+    }
+    resyncing_.store(false);
+    return callback_after_update(status, rev_);
+  });
+}
+
+Status IMetaService::loadSnapshot(std::vector<op_t>& ops, unsigned& rev) {
+  std::ifstream file(snapshot_path_);
+  if (!file.is_open()) {
+    return Status::IOError("Failed to open the metadata snapshot " +
+                           snapshot_path_);
+  }
+  std::stringstream buffer;
+  buffer << file.rdbuf();
+  auto const& spec = server_ptr_->GetSpec()["metastore_spec"];
+  // a corrupt or truncated snapshot shouldn't break down the server, the
+  // caller falls back to a full reload from the backend.
+  auto status = [&]() -> Status {
+    try {
+      json snapshot = json::parse(buffer.str());
+      if (snapshot.value("prefix", "") != spec.value("prefix", "") ||
+          snapshot.value("endpoint", "") != spec.value("etcd_endpoint", "")) {
+        return Status::Invalid(
+            "The metadata snapshot is for another meta service");
+      }
+      rev = snapshot.value("rev", 0U);
+      RETURN_ON_ASSERT(rev != 0, "Invalid revision in the metadata snapshot");
+      ops.clear();
+      for (auto const& item : json::iterator_wrapper(snapshot.at("kvs"))) {
+        ops.emplace_back(op_t::Put(
+            item.key(), item.value().get_ref<std::string const&>(), rev));
+      }
+      return Status::OK();
+    } catch (std::out_of_range const& err) {
+      return Status::MetaTreeInvalid(err.what());
+    } catch (json::exception const& err) {
+      return Status::MetaTreeInvalid(err.what());
+    }
+  }();
+  if (!status.ok()) {
+    ops.clear();
+    LOG(ERROR) << "Failed to load the metadata snapshot " << snapshot_path_
+               << ": " << status.ToString();
+  }
+  return status;
+}
+
+Status IMetaService::startSnapshot(Status const&) {
+  snapshot_timer_.reset(new asio::steady_timer(
+      server_ptr_->GetMetaContext(), std::chrono::seconds(snapshot_interval_)));
+  snapshot_timer_->async_wait([this](const boost::system::error_code& error) {
+    if (error == asio::error::operation_aborted) {
+      return;
+    }
+    checkpointSnapshot();
+    VINEYARD_DISCARD(startSnapshot(Status::OK()));
+  });
+  return Status::OK();
+}
+
+void IMetaService::checkpointSnapshot() {
+  if (rev_ == snapshot_rev_ || resyncing_.load() || snapshot_writing_.load()) {
+    return;
+  }
+  if (snapshot_writer_.joinable()) {
+    snapshot_writer_.join();
+  }
+  auto const& spec = server_ptr_->GetSpec()["metastore_spec"];
+  json snapshot;
+  snapshot["prefix"] = spec.value("prefix", "");
+  snapshot["endpoint"] = spec.value("etcd_endpoint", "");
+  snapshot["rev"] = rev_;
+  snapshot["kvs"] = snapshot_kvs_;
+  snapshot_rev_ = rev_;
+
+  // write to a temporary file then rename in the background, to keep the
+  // snapshot file always complete.
+  snapshot_writing_.store(true);
+  snapshot_writer_ = std::thread([this, snapshot = std::move(snapshot)]() {
+    std::string tmp_path = snapshot_path_ + ".tmp";
+    bool written = false;
+    {
+      std::ofstream file(tmp_path, std::ios::trunc);
+      file << json_to_string(snapshot);
+      written = file.good();
+    }
+    if (!written ||
+        std::rename(tmp_path.c_str(), snapshot_path_.c_str()) != 0) {
+      LOG(ERROR) << "Failed to checkpoint the metadata snapshot to "
+                 << snapshot_path_;
+    } else {
+      VLOG(10) << "Checkpointed the metadata snapshot at revision "
+               << snapshot["rev"].get<unsigned>();
+    }
+    snapshot_writing_.store(false);
+  });
+}
+
+void IMetaService::recordRemote(const op_t& op) {
+  // the values are only needed for checkpointing the snapshot.
+  if (!snapshot_path_.empty()) {
+    if (op.op == op_t::op_type_t::kPut) {
+      snapshot_kvs_[op.kv.key] = op.kv.value;
+    } else if (op.op == op_t::op_type_t::kDel) {
+      snapshot_kvs_.erase(op.kv.key);
+    }
+  } else {
+    if (op.op == op_t::op_type_t::kPut) {
+      remote_keys_.emplace(op.kv.key);
+    } else if (op.op == op_t::op_type_t::kDel) {
+      remote_keys_.erase(op.kv.key);
+    }
+  }
+}
+
+void IMetaService::requestToCommit(commit_request_t&& request) {
+  {
+    std::lock_guard<std::mutex> lock(commit_mutex_);
+    request.trace = trace::Current();
+    commit_queue_.emplace_back(std::move(request));
+    if (committing_) {
+      return;
+    }
+    committing_ = true;
+  }
+  server_ptr_->GetMetaContext().post([this]() { this->commitBatch(); });
+}
+
+void IMetaService::commitBatch() {
+  auto batch = std::make_shared<std::vector<commit_request_t>>();
+  {
+    std::lock_guard<std::mutex> lock(commit_mutex_);
+    batch->swap(commit_queue_);
+  }
+  auto statuses = std::make_shared<std::vector<Status>>(batch->size());
+
+  // the requests that only touch the keys owned by this instance don't
+  // contend with other instances, and are committed without the lock.
+  std::vector<size_t> owned;
+  auto locked = std::make_shared<std::vector<size_t>>();
+  bool const lease_valid = leaseValid();
+  for (size_t index = 0; index < batch->size(); ++index) {
+    if (lease_valid && (*batch)[index].owned) {
+      owned.emplace_back(index);
+    } else {
+      locked->emplace_back(index);
+    }
+  }
+  if (owned.empty()) {
+    this->commitLocked(batch, locked, statuses);
+    return;
+  }
+  this->commitRequests(batch, owned, nullptr, statuses, locked,
+                       [this, batch, locked, statuses]() {
+                         this->commitLocked(batch, locked, statuses);
+                       });
+}
+
+void IMetaService::commitLocked(
+    std::shared_ptr<std::vector<commit_request_t>> batch,
+    std::shared_ptr<std::vector<size_t>> indices,
+    std::shared_ptr<std::vector<Status>> statuses) {
+  if (indices->empty()) {
+    this->finishBatch(batch, nullptr, statuses);
+    return;
+  }
+  // the deferred requests keep their order in the batch
+  std::sort(indices->begin(), indices->end());
+  // NB: when persist local meta to etcd, we needs the meta_sync_lock_ to
+  // avoid contention between other vineyard instances.
+  auto start = trace::steady_clock_t::now();
+  this->requestLock(meta_sync_lock_, [this, batch, indices, statuses, start](
+                                         const Status& status,
+                                         std::shared_ptr<ILock> lock) {
+    int64_t locking = trace::Since(start);
+    for (auto index : *indices) {
+      if ((*batch)[index].trace) {
+        (*batch)[index].trace->Add(trace::Phase::kEtcd, locking);
+      }
+    }
+    if (!status.ok()) {
+      LOG(ERROR) << status.ToString();
+      for (auto index : *indices) {
+        (*statuses)[index] = status;  // propogate the error
+      }
+      this->finishBatch(batch, nullptr, statuses);
+      return Status::OK();
+    }
+    this->commitRequests(
+        batch, *indices, lock, statuses, nullptr,
+        [this, batch, lock, statuses]() {
+          this->finishBatch(batch, lock, statuses);
+        });
+    return Status::OK();
+  });
+}
+
+void IMetaService::commitRequests(
+    std::shared_ptr<std::vector<commit_request_t>> batch,
+    std::vector<size_t> const& indices, std::shared_ptr<ILock> lock,
+    std::shared_ptr<std::vector<Status>> statuses,
+    std::shared_ptr<std::vector<size_t>> deferred,
+    std::function<void()> callback_after_committed) {
+  requestValues("", [this, batch, indices, lock, statuses, deferred,
+                     callback_after_committed](const Status& status,
+                                               const json& meta,
+                                               unsigned rev) {
+    // the metadata that a request sees includes the changes of the requests
+    // before it in the same batch, as the changes are applied locally.
+    std::vector<size_t> pending;
+    for (auto index : indices) {
+      auto& request = (*batch)[index];
+      if (request.callback_after_ready) {
+        auto s = request.callback_after_ready(status, meta, request.ops);
+        if (!s.ok() || request.ops.empty()) {
+          (*statuses)[index] = s;
+          continue;
+        }
+        if (lock == nullptr) {
+          bool owned = true;
+          for (auto const& op : request.ops) {
+            owned = owned && this->isOwnedKey(op.kv.key);
+          }
+          if (!owned) {
+            // the ops are computed without the lock, recompute them later.
+            request.ops.clear();
+            deferred->emplace_back(index);
+            continue;
+          }
+        }
+        // apply changes locally before committing to etcd
+        this->metaUpdate(request.ops, false);
+      } else if (!status.ok()) {
+        (*statuses)[index] = status;
+        continue;
+      }
+      pending.emplace_back(index);
+    }
+
+    // pack the ops of requests into commits, without splitting a request
+    // across commits unless itself exceeds the limit.
+    auto packs = std::make_shared<std::vector<std::vector<size_t>>>();
+    size_t pack_size = 0;
+    for (auto index : pending) {
+      size_t size = (*batch)[index].ops.size();
+      if (packs->empty() || pack_size + size > maxOpsPerCommit()) {
+        packs->emplace_back();
+        pack_size = 0;
+      }
+      packs->back().emplace_back(index);
+      pack_size += size;
+    }
+    this->commitPacks(batch, packs, 0, statuses, callback_after_committed);
+    return Status::OK();
+  });
+}
+
+void IMetaService::commitPacks(
+    std::shared_ptr<std::vector<commit_request_t>> batch,
+    std::shared_ptr<std::vector<std::vector<size_t>>> packs,
+    size_t const index, std::shared_ptr<std::vector<Status>> statuses,
+    std::function<void()> callback_after_committed) {
+  if (index == packs->size()) {
+    callback_after_committed();
+    return;
+  }
+  std::vector<op_t> ops;
+  for (auto request_index : (*packs)[index]) {
+    auto const& request_ops = (*batch)[request_index].ops;
+    ops.insert(ops.end(), request_ops.begin(), request_ops.end());
+  }
+  // commit to etcd
+  auto start = trace::steady_clock_t::now();
+  this->commitUpdates(ops, [this, batch, packs, index, statuses, start,
+                            callback_after_committed](const Status& status,
+                                                      unsigned rev) {
+    int64_t committing = trace::Since(start);
+    for (auto request_index : (*packs)[index]) {
+      (*statuses)[request_index] = status;
+      if ((*batch)[request_index].trace) {
+        (*batch)[request_index].trace->Add(trace::Phase::kEtcd, committing);
+      }
+    }
+    if (!status.ok()) {
+      // the ops of the following requests are computed against the changes
+      // of this pack, thus they fail as well rather than being committed.
+      for (size_t next = index + 1; next < packs->size(); ++next) {
+        for (auto request_index : (*packs)[next]) {
+          (*statuses)[request_index] = status;
+        }
+      }
+      callback_after_committed();
+      return Status::OK();
+    }
+    this->commitPacks(batch, packs, index + 1, statuses,
+                      callback_after_committed);
+    return Status::OK();
+  });
+}
+
+bool IMetaService::isOwnedKey(const std::string& key) const {
+  std::string const& instance_name = server_ptr_->instance_name();
+  if (boost::algorithm::starts_with(key,
+                                    "/instances/" + instance_name + "/") ||
+      boost::algorithm::starts_with(key,
+                                    "/signatures/" + instance_name + "/")) {
+    return true;
+  }
+  static const std::string data_prefix = "/data/";
+  if (!boost::algorithm::starts_with(key, data_prefix)) {
+    return false;
+  }
+  size_t end = key.find('/', data_prefix.size());
+  std::string name = key.substr(data_prefix.size(),
+                                end == std::string::npos
+                                    ? std::string::npos
+                                    : end - data_prefix.size());
+  if (name.empty()) {
+    return false;
+  }
+  auto data = meta_.find("data");
+  if (data == meta_.end() || !data->is_object()) {
+    return false;
+  }
+  auto object = data->find(name);
+  if (object == data->end() || !object->is_object()) {
+    return false;
+  }
+  auto instance_id = object->find("instance_id");
+  return instance_id != object->end() && instance_id->is_number_integer() &&
+         instance_id->get<InstanceID>() == server_ptr_->instance_id();
+}
+
+void IMetaService::finishBatch(
+    std::shared_ptr<std::vector<commit_request_t>> batch,
+    std::shared_ptr<ILock> lock,
+    std::shared_ptr<std::vector<Status>> statuses) {
+  if (lock) {
+    // update rev_ to the revision after unlock.
+    unsigned rev_after_unlock = 0;
+    VINEYARD_DISCARD(lock->Release(rev_after_unlock));
+  }
+  for (size_t index = 0; index < batch->size(); ++index) {
+    auto const& request = (*batch)[index];
+    VINEYARD_SUPPRESS(request.callback_after_finish((*statuses)[index]));
+  }
+
+  bool next_batch = false;
+  {
+    std::lock_guard<std::mutex> scope_lock(commit_mutex_);
+    next_batch = !commit_queue_.empty();
+    committing_ = next_batch;
+  }
+  if (next_batch) {
+    this->commitBatch();
+  }
+}
+
 }  // namespace vineyard
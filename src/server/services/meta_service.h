@@ -16,12 +16,20 @@ limitations under the License.
 #ifndef SRC_SERVER_SERVICES_META_SERVICE_H_
 #define SRC_SERVER_SERVICES_META_SERVICE_H_
 
+#include <algorithm>
+#include <atomic>
 #include <chrono>
+#include <functional>
 #include <iostream>
+#include <limits>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <set>
+#include <shared_mutex>
 #include <string>
+#include <thread>
+#include <unordered_map>
 #include <vector>
 
 #include "boost/asio.hpp"
@@ -37,10 +45,18 @@ limitations under the License.
 #include "common/util/logging.h"
 #include "common/util/status.h"
 #include "server/server/vineyard_server.h"
+#include "server/util/membership.h"
 #include "server/util/metrics.h"
+#include "server/util/trace.h"
 
 #define HEARTBEAT_TIME 60
+#define SNAPSHOT_INTERVAL 60
 #define MAX_TIMEOUT_COUNT 3
+// the protocol period (in milliseconds) of the gossip-based membership
+#define GOSSIP_INTERVAL 1000
+// the instance is considered as dead by others after missing the heartbeats
+// for MAX_TIMEOUT_COUNT rounds, keep a margin of one round for the lease.
+#define LEASE_TTL (HEARTBEAT_TIME * (MAX_TIMEOUT_COUNT - 1))
 
 namespace vineyard {
 
@@ -116,6 +132,13 @@ class IMetaService {
     }
   };
 
+  // typename -> names of objects of that type
+  using type_index_t = std::map<std::string, std::set<std::string>>;
+  // name -> object id, ordered to list the names under a prefix (namespace)
+  using name_index_t = std::map<std::string, ObjectID>;
+  // object id -> names of the object
+  using object_names_t = std::multimap<ObjectID, std::string>;
+
   struct watcher_t {
     watcher_t(callback_t<const json&, const std::string&> w,
               const std::string& t)
@@ -123,9 +146,26 @@ class IMetaService {
     callback_t<const json&, const std::string&> watcher;
     std::string tag;
   };
-  virtual ~IMetaService() {}
+  virtual ~IMetaService() {
+    if (snapshot_writer_.joinable()) {
+      snapshot_writer_.join();
+    }
+  }
   explicit IMetaService(vs_ptr_t& server_ptr)
-      : server_ptr_(server_ptr), rev_(0), meta_sync_lock_("/meta_sync_lock") {}
+      : server_ptr_(server_ptr), rev_(0), meta_sync_lock_("/meta_sync_lock") {
+    auto const& spec = server_ptr_->GetSpec()["metastore_spec"];
+    snapshot_path_ = spec.value("snapshot", "");
+    snapshot_interval_ = spec.value("snapshot_interval",
+                                    static_cast<int64_t>(SNAPSHOT_INTERVAL));
+    gossip_ = spec.value("membership", "etcd") == "gossip";
+    if (gossip_ && !server_ptr_->GetSpec()["rpc_spec"].value("rpc", false)) {
+      LOG(WARNING) << "The membership requires the RPC server for gossiping, "
+                      "fallback to the heartbeat in etcd";
+      gossip_ = false;
+    }
+    gossip_interval_ =
+        spec.value("gossip_interval", static_cast<int64_t>(GOSSIP_INTERVAL));
+  }
 
   static std::shared_ptr<IMetaService> Get(vs_ptr_t);
 
@@ -141,6 +181,9 @@ class IMetaService {
         this->startDaemonWatch("", rev_,
                                boost::bind(&IMetaService::daemonWatchHandler,
                                            this, _1, _2, _3, _4));
+        if (!snapshot_path_.empty()) {
+          VINEYARD_DISCARD(this->startSnapshot(Status::OK()));
+        }
 
         // register self info.
         this->registerToEtcd();
@@ -163,8 +206,8 @@ class IMetaService {
       callback_t<const json&, std::vector<op_t>&, InstanceID&>
           callback_after_ready,
       callback_t<const InstanceID> callback_after_finish) {
-    server_ptr_->GetMetaContext().post([this, callback_after_ready,
-                                        callback_after_finish]() {
+    server_ptr_->GetMetaContext().post(trace::Wrap([this, callback_after_ready,
+                                                    callback_after_finish]() {
       std::vector<op_t> ops;
       InstanceID computed_instance_id;
       auto status =
@@ -181,54 +224,22 @@ class IMetaService {
         LOG(ERROR) << status.ToString();
       }
       VINEYARD_SUPPRESS(callback_after_finish(status, computed_instance_id));
-    });
+    }));
   }
 
+  /**
+   * The `owned` hint tells that the ops only touch the keys owned by this
+   * instance (see `isOwnedKey`). Such requests are committed without the
+   * global `meta_sync_lock_` as long as the lease of this instance is valid.
+   *
+   * Note that the `callback_after_ready` of an owned request may be invoked
+   * once more with the lock held, if the hint turns out to be wrong.
+   */
   inline void RequestToPersist(
       callback_t<const json&, std::vector<op_t>&> callback_after_ready,
-      callback_t<> callback_after_finish) {
-    // NB: when persist local meta to etcd, we needs the meta_sync_lock_ to
-    // avoid contention between other vineyard instances.
-    this->requestLock(
-        meta_sync_lock_,
-        [this, callback_after_ready, callback_after_finish](
-            const Status& status, std::shared_ptr<ILock> lock) {
-          if (status.ok()) {
-            requestValues(
-                "", [this, callback_after_ready, callback_after_finish, lock](
-                        const Status& status, const json& meta, unsigned rev) {
-                  std::vector<op_t> ops;
-                  auto s = callback_after_ready(status, meta, ops);
-                  if (s.ok()) {
-                    if (ops.empty()) {
-                      unsigned rev_after_unlock = 0;
-                      VINEYARD_DISCARD(lock->Release(rev_after_unlock));
-                      return callback_after_finish(Status::OK());
-                    }
-                    // apply changes locally before committing to etcd
-                    this->metaUpdate(ops, false);
-                    // commit to etcd
-                    this->commitUpdates(
-                        ops, [callback_after_finish, lock](const Status& status,
-                                                           unsigned rev) {
-                          // update rev_ to the revision after unlock.
-                          unsigned rev_after_unlock = 0;
-                          VINEYARD_DISCARD(lock->Release(rev_after_unlock));
-                          return callback_after_finish(status);
-                        });
-                    return Status::OK();
-                  } else {
-                    unsigned rev_after_unlock = 0;
-                    VINEYARD_DISCARD(lock->Release(rev_after_unlock));
-                    return callback_after_finish(s);  // propogate the error
-                  }
-                });
-            return Status::OK();
-          } else {
-            LOG(ERROR) << status.ToString();
-            return callback_after_finish(status);  // propogate the error
-          }
-        });
+      callback_t<> callback_after_finish, const bool owned = false) {
+    requestToCommit(commit_request_t{callback_after_ready, {},
+                                     callback_after_finish, owned});
   }
 
   inline void RequestToGetData(const bool sync_remote,
@@ -245,10 +256,73 @@ class IMetaService {
       //
       //    https://www.boost.org/doc/libs/1_73_0/libs/bind/doc/html/bind.html
       server_ptr_->GetMetaContext().post(
-          boost::bind(callback, Status::OK(), std::ref(meta_)));
+          trace::Wrap(boost::bind(callback, Status::OK(), std::ref(meta_))));
+    }
+  }
+
+  /**
+   * Read the local metadata in the calling thread, concurrently with other
+   * readers, rather than queuing behind the tasks on the meta context. The
+   * updates of `meta_` only happen on the meta context, with the writer lock
+   * held.
+   */
+  inline void RequestToReadData(callback_t<const json&> callback) {
+    std::shared_lock<std::shared_timed_mutex> lock(meta_mutex_);
+    VINEYARD_DISCARD(callback(Status::OK(), meta_));
+  }
+
+  /**
+   * Take an immutable copy of the local metadata at its current version, in
+   * the calling thread. The copy is shared by the subsequent calls as long as
+   * the metadata isn't updated and the copy is still alive, see also
+   * `VineyardServer::CreateSnapshot`.
+   */
+  inline std::shared_ptr<const json> SnapshotMeta(uint64_t& version) {
+    std::shared_lock<std::shared_timed_mutex> lock(meta_mutex_);
+    std::lock_guard<std::mutex> guard(snapshot_meta_mutex_);
+    version = meta_version_.load();
+    auto meta = snapshot_meta_.lock();
+    if (meta == nullptr || snapshot_meta_version_ != version) {
+      meta = std::make_shared<const json>(meta_);
+      snapshot_meta_ = meta;
+      snapshot_meta_version_ = version;
     }
+    return meta;
   }
 
+  /**
+   * The version of the local metadata, increases on every update.
+   */
+  inline uint64_t MetaVersion() const { return meta_version_.load(); }
+
+  /**
+   * Resolve the name in the local metadata, in the calling thread, see also
+   * `RequestToReadData`.
+   */
+  inline bool LookupName(const std::string& name, ObjectID& object_id) {
+    std::shared_lock<std::shared_timed_mutex> lock(meta_mutex_);
+    auto iter = name_index_.find(name);
+    if (iter == name_index_.end()) {
+      return false;
+    }
+    object_id = iter->second;
+    return true;
+  }
+
+  /**
+   * The typename index of the local metadata, must be accessed inside the
+   * callbacks of `RequestToReadData` or on the meta context.
+   */
+  const type_index_t& TypeIndex() const { return type_index_; }
+
+  /**
+   * The name index and the reverse mapping of the local metadata, must be
+   * accessed in the same way as `TypeIndex`.
+   */
+  const name_index_t& NameIndex() const { return name_index_; }
+
+  const object_names_t& ObjectNames() const { return object_names_; }
+
   inline void RequestToDelete(
       const std::vector<ObjectID>& object_ids, const bool force,
       const bool deep,
@@ -256,9 +330,9 @@ class IMetaService {
                  bool&>
           callback_after_ready,
       callback_t<> callback_after_finish) {
-    server_ptr_->GetMetaContext().post([this, object_ids, force, deep,
-                                        callback_after_ready,
-                                        callback_after_finish]() {
+    server_ptr_->GetMetaContext().post(trace::Wrap([this, object_ids, force,
+                                                    deep, callback_after_ready,
+                                                    callback_after_finish]() {
       // generated ops.
       std::vector<op_t> ops;
 
@@ -289,31 +363,10 @@ class IMetaService {
         return;
       }
 
-      // apply remote updates
-      //
-      // NB: when persist local meta to etcd, we needs the meta_sync_lock_ to
-      // avoid contention between other vineyard instances.
-      this->requestLock(
-          meta_sync_lock_,
-          [this, ops /* by copy */, callback_after_ready,
-           callback_after_finish](const Status& status,
-                                  std::shared_ptr<ILock> lock) {
-            if (status.ok()) {
-              // commit to etcd
-              this->commitUpdates(ops, [callback_after_finish, lock](
-                                           const Status& status, unsigned rev) {
-                // update rev_ to the revision after unlock.
-                unsigned rev_after_unlock = 0;
-                VINEYARD_DISCARD(lock->Release(rev_after_unlock));
-                return callback_after_finish(status);
-              });
-              return Status::OK();
-            } else {
-              LOG(ERROR) << status.ToString();
-              return callback_after_finish(status);  // propogate the error.
-            }
-          });
-    });
+      // apply remote updates, the ops have been applied locally.
+      this->requestToCommit(commit_request_t{nullptr, std::move(ops),
+                                             callback_after_finish, false});
+    }));
   }
 
   inline void RequestToShallowCopy(
@@ -351,6 +404,29 @@ class IMetaService {
     });
   }
 
+  /**
+   * Serve the membership probe from other instances, fails if the
+   * membership is not gossiped, see also `Membership`.
+   */
+  inline void RequestToGossip(const InstanceID from, const InstanceID target,
+                              const json& updates,
+                              callback_t<const bool, const json&> callback) {
+    server_ptr_->GetMetaContext().post([this, from, target, updates,
+                                        callback]() {
+      if (!membership_) {
+        VINEYARD_DISCARD(callback(
+            Status::Invalid("The membership is not gossiped by this instance"),
+            false, json()));
+        return;
+      }
+      membership_->Serve(from, target, updates,
+                         [callback](const bool acked, const json& digest) {
+                           VINEYARD_DISCARD(
+                               callback(Status::OK(), acked, digest));
+                         });
+    });
+  }
+
   void IncRef(std::string const& instance_name, std::string const& key,
               std::string const& value, const bool from_remote);
   void CloneRef(ObjectID const target, ObjectID const mirror);
@@ -380,7 +456,7 @@ class IMetaService {
               rank = tree["next_instance_id"].get<InstanceID>();
             }
 
-            this->server_ptr_->set_instance_id(rank);
+            RETURN_ON_ERROR(this->server_ptr_->set_instance_id(rank));
             this->server_ptr_->set_hostname(hostname);
             this->server_ptr_->set_nodename(nodename);
 
@@ -405,12 +481,18 @@ class IMetaService {
         },
         [&](const Status& status) {
           if (status.ok()) {
-            // start heartbeat
-            VINEYARD_DISCARD(this->startHeartbeat(Status::OK()));
+            renewLease();
+            // start heartbeat, the timestamps in etcd won't be refreshed
+            // anymore if the failures are detected by gossiping.
+            if (gossip_) {
+              this->startMembership();
+            } else {
+              VINEYARD_DISCARD(this->startHeartbeat(Status::OK()));
+            }
             // mark meta service as ready
             Ready();
           } else {
-            this->server_ptr_->set_instance_id(UINT64_MAX);
+            VINEYARD_DISCARD(this->server_ptr_->set_instance_id(UINT64_MAX));
             LOG(ERROR) << "compute instance_id error.";
           }
           return status;
@@ -442,6 +524,7 @@ class IMetaService {
             LOG(ERROR) << "Failed to refresh self: " << status.ToString();
             return callback_after_finish(status);
           }
+          renewLease();
           auto the_next =
               instances_list_.upper_bound(server_ptr_->instance_id());
           if (the_next == instances_list_.end()) {
@@ -453,7 +536,12 @@ class IMetaService {
           }
           VLOG(10) << "Instance size " << instances_list_.size()
                    << ", target instance is " << target_inst;
-          auto target = meta_["instances"]["i" + std::to_string(target_inst)];
+          json target;
+          {
+            // n.b.: the `operator[]` may insert null values into `meta_`.
+            std::unique_lock<std::shared_timed_mutex> lock(meta_mutex_);
+            target = meta_["instances"]["i" + std::to_string(target_inst)];
+          }
           // The subtree might be empty, when the etcd been resumed with another
           // data directory but the same endpoint. that leads to a crash here
           // but we just let it crash to help us diagnosis the error.
@@ -469,27 +557,7 @@ class IMetaService {
               LOG(ERROR) << "Instance " << target_inst << " timeout";
               timeout_count_ = 0;
               target_latest_time_ = 0;
-              RequestToPersist(
-                  [&, target_inst](const Status& status, const json& tree,
-                                   std::vector<op_t>& ops) {
-                    if (status.ok()) {
-                      std::string key =
-                          "/instances/i" + std::to_string(target_inst);
-                      ops.emplace_back(op_t::Del(key + "/hostid"));
-                      ops.emplace_back(op_t::Del(key + "/timestamp"));
-                      ops.emplace_back(op_t::Del(key + "/hostname"));
-                      ops.emplace_back(op_t::Del(key + "/nodename"));
-                      ops.emplace_back(op_t::Del(key + "/rpc_endpoint"));
-                      ops.emplace_back(op_t::Del(key + "/ipc_socket"));
-                    } else {
-                      LOG(ERROR) << status.ToString();
-                    }
-                    return status;
-                  },
-                  [&, callback_after_finish](const Status& status) {
-                    return callback_after_finish(status);
-                  });
-              VINEYARD_SUPPRESS(server_ptr_->DeleteAllAt(meta_, target_inst));
+              removeInstance(target_inst, callback_after_finish);
               return status;
             } else {
               return callback_after_finish(status);
@@ -497,7 +565,8 @@ class IMetaService {
           } else {
             return callback_after_finish(status);
           }
-        });
+        },
+        true);
   }
 
   Status startHeartbeat(Status const&) {
@@ -514,42 +583,155 @@ class IMetaService {
     return Status::OK();
   }
 
+  /**
+   * Removes the registration and the objects of the failed instance.
+   */
+  void removeInstance(const InstanceID target_inst,
+                      callback_t<> callback_after_finish) {
+    RequestToPersist(
+        [&, target_inst](const Status& status, const json& tree,
+                         std::vector<op_t>& ops) {
+          if (status.ok()) {
+            std::string key = "/instances/i" + std::to_string(target_inst);
+            ops.emplace_back(op_t::Del(key + "/hostid"));
+            ops.emplace_back(op_t::Del(key + "/timestamp"));
+            ops.emplace_back(op_t::Del(key + "/hostname"));
+            ops.emplace_back(op_t::Del(key + "/nodename"));
+            ops.emplace_back(op_t::Del(key + "/rpc_endpoint"));
+            ops.emplace_back(op_t::Del(key + "/ipc_socket"));
+          } else {
+            LOG(ERROR) << status.ToString();
+          }
+          return status;
+        },
+        [&, callback_after_finish](const Status& status) {
+          return callback_after_finish(status);
+        });
+    VINEYARD_SUPPRESS(server_ptr_->DeleteAllAt(target_inst));
+  }
+
+  /**
+   * Detects the failures by gossiping with other instances over the RPC
+   * port rather than polling the timestamps in etcd, the lease is renewed
+   * as long as this instance is reachable by others, and expires before this
+   * instance could be declared as dead.
+   */
+  void startMembership() {
+    membership_ = std::make_shared<Membership>(
+        server_ptr_->GetMetaContext(), server_ptr_->instance_id(),
+        gossip_interval_,
+        [this](const InstanceID id) { return this->instanceEndpoint(id); },
+        [this](const InstanceID id) {
+          LOG(INFO) << "Removing the failed instance " << id;
+          this->removeInstance(id, [id](const Status& status) {
+            if (!status.ok()) {
+              LOG(ERROR) << "Failed to remove instance " << id << ": "
+                         << status.ToString();
+            }
+            return status;
+          });
+        },
+        [this]() {
+          renewLease(std::max(membership_->SuspicionTimeout() / 1000 - 1,
+                              static_cast<int64_t>(0)));
+        });
+    for (auto const& instance_id : instances_list_) {
+      membership_->Join(instance_id);
+    }
+    membership_->Start();
+  }
+
+  std::string instanceEndpoint(const InstanceID instance_id) {
+    std::shared_lock<std::shared_timed_mutex> lock(meta_mutex_);
+    auto instances = meta_.find("instances");
+    if (instances == meta_.end() || !instances->is_object()) {
+      return std::string();
+    }
+    auto instance = instances->find("i" + std::to_string(instance_id));
+    if (instance == instances->end() || !instance->is_object()) {
+      return std::string();
+    }
+    return instance->value("rpc_endpoint", std::string());
+  }
+
  protected:
   // invoke when everything is ready (after Start() and ready for invoking)
   inline void Ready() {
     server_ptr_->MetaReady();  // notify server the meta svc is ready
   }
 
+  inline void stopMembership() {
+    server_ptr_->GetMetaContext().post([this]() {
+      if (membership_) {
+        membership_->Stop();
+      }
+    });
+  }
+
   virtual void commitUpdates(const std::vector<op_t>&,
                              callback_t<unsigned> callback_after_updated) = 0;
 
+  // the maximum number of ops that the backend commits atomically, ops of
+  // different requests are merged into one commit within this limit.
+  virtual size_t maxOpsPerCommit() const {
+    return std::numeric_limits<size_t>::max();
+  }
+
   void requestValues(const std::string& prefix,
                      callback_t<const json&, unsigned> callback) {
+    if (auto trace = trace::Current()) {
+      // accounts the time of syncing with etcd to the current request
+      auto start = trace::steady_clock_t::now();
+      auto traced_callback = callback;
+      callback = [trace, start, traced_callback](
+                     const Status& status, const json& meta, unsigned rev) {
+        trace->Add(trace::Phase::kEtcd, trace::Since(start));
+        trace::Scope scope(trace);
+        return traced_callback(status, meta, rev);
+      };
+    }
     // We still need to run a `etcdctl get` for the first time. With a
     // long-running and no compact Etcd, watching from revision 0 may
     // lead to a super huge amount of events, which is unacceptable.
+    //
+    // Unless a local snapshot is available, from where the daemon watch
+    // catches up incrementally.
     if (rev_ == 0) {
-      requestAll(prefix, rev_,
-                 [this, callback](const Status& status,
-                                  const std::vector<op_t>& ops, unsigned rev) {
-                   if (status.ok()) {
-                     this->metaUpdate(ops, true);
-                     rev_ = rev;
-                   }
-                   return callback(status, meta_, rev_);
-                 });
-    } else {
-      requestUpdates(
-          prefix, rev_,
-          [this, callback](const Status& status, const std::vector<op_t>& ops,
-                           unsigned rev) {
-            if (status.ok()) {
-              this->metaUpdate(ops, true);
-              rev_ = rev;
-            }
+      std::vector<op_t> ops;
+      unsigned snapshot_rev = 0;
+      if (!snapshot_path_.empty() && loadSnapshot(ops, snapshot_rev).ok()) {
+        requestHeadRevision([this, callback, ops, snapshot_rev, prefix](
+                                const Status& status, unsigned head_rev) {
+          if (status.ok() && snapshot_rev <= head_rev) {
+            LOG(INFO) << "Resume metadata from the snapshot at revision "
+                      << snapshot_rev << ", the head revision is " << head_rev;
+            this->metaUpdate(ops, true);
+            rev_ = snapshot_rev;
             return callback(status, meta_, rev_);
-          });
+          }
+          LOG(WARNING) << "The metadata snapshot is stale, fallback to a full "
+                          "reload";
+          this->requestFullValues(prefix, callback);
+          return Status::OK();
+        });
+      } else {
+        requestFullValues(prefix, callback);
+      }
+      return;
+    }
+
+    // Coalesce the concurrent callers: callers that arrive while a sync is in
+    // flight share the next round of sync, as the result of the current round
+    // may miss the updates that they are expected to observe.
+    {
+      std::lock_guard<std::mutex> lock(sync_mutex_);
+      sync_waiters_.emplace_back(callback);
+      if (syncing_) {
+        return;
+      }
+      syncing_ = true;
     }
+    syncValues(prefix);
   }
 
   virtual void requestLock(
@@ -560,6 +742,8 @@ class IMetaService {
       const std::string& prefix, unsigned base_rev,
       callback_t<const std::vector<op_t>&, unsigned> callback) = 0;
 
+  virtual void requestHeadRevision(callback_t<unsigned> callback) = 0;
+
   virtual void requestUpdates(
       const std::string& prefix, unsigned since_rev,
       callback_t<const std::vector<op_t>&, unsigned> callback) = 0;
@@ -575,16 +759,149 @@ class IMetaService {
   void printDepsGraph();
 
   json meta_;
+  // protects `meta_` from the concurrent readers, see `RequestToReadData`.
+  std::shared_timed_mutex meta_mutex_;
+  // increased by every `metaUpdate`, with the writer lock held.
+  std::atomic<uint64_t> meta_version_{0};
+  // the latest copy of `meta_` taken by `SnapshotMeta`.
+  std::mutex snapshot_meta_mutex_;
+  std::weak_ptr<const json> snapshot_meta_;
+  uint64_t snapshot_meta_version_ = 0;
   vs_ptr_t server_ptr_;
 
   unsigned rev_;
   bool backend_retrying_;
+  // whether the metadata is being reloaded as the watched revision has been
+  // compacted, see `resyncValues`.
+  std::atomic<bool> resyncing_{false};
+  // set by the backend when the revision to watch from has been compacted.
+  std::atomic<bool> watch_compacted_{false};
 
   std::string meta_sync_lock_;
 
  private:
   virtual Status preStart() { return Status::OK(); }
 
+  /**
+   * Group commit: the requests that arrive while a batch is being committed
+   * are queued and committed together in the next batch, under a single
+   * acquisition of the `meta_sync_lock_`.
+   */
+  struct commit_request_t {
+    // computes the ops from the synced metadata, or nullptr if the `ops`
+    // have been computed (and applied locally) in advance.
+    callback_t<const json&, std::vector<op_t>&> callback_after_ready;
+    std::vector<op_t> ops;
+    callback_t<> callback_after_finish;
+    // whether the ops only touch the keys owned by this instance.
+    bool owned;
+    // the trace of the request, see also "server/util/trace.h".
+    trace::trace_ptr_t trace = nullptr;
+  };
+
+  void requestToCommit(commit_request_t&& request);
+
+  void commitBatch();
+
+  void commitLocked(std::shared_ptr<std::vector<commit_request_t>> batch,
+                    std::shared_ptr<std::vector<size_t>> indices,
+                    std::shared_ptr<std::vector<Status>> statuses);
+
+  // commits the given requests of the batch, the requests whose ops turn
+  // out to touch keys that are not owned are moved to `deferred` when
+  // committing without the lock.
+  void commitRequests(std::shared_ptr<std::vector<commit_request_t>> batch,
+                      std::vector<size_t> const& indices,
+                      std::shared_ptr<ILock> lock,
+                      std::shared_ptr<std::vector<Status>> statuses,
+                      std::shared_ptr<std::vector<size_t>> deferred,
+                      std::function<void()> callback_after_committed);
+
+  void commitPacks(std::shared_ptr<std::vector<commit_request_t>> batch,
+                   std::shared_ptr<std::vector<std::vector<size_t>>> packs,
+                   size_t const index,
+                   std::shared_ptr<std::vector<Status>> statuses,
+                   std::function<void()> callback_after_committed);
+
+  /**
+   * The keys owned by this instance are only written by this instance: its
+   * own "/instances" and "/signatures" subtrees, and the "/data" of its own
+   * objects. Must be called on the meta context.
+   */
+  bool isOwnedKey(const std::string& key) const;
+
+  // the lease is renewed by the successful heartbeats.
+  void renewLease(const int64_t ttl = LEASE_TTL) {
+    lease_expiry_ = leaseClock() + ttl;
+  }
+
+  bool leaseValid() const { return leaseClock() < lease_expiry_; }
+
+  static int64_t leaseClock() {
+    return std::chrono::duration_cast<std::chrono::seconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+  }
+
+  void finishBatch(std::shared_ptr<std::vector<commit_request_t>> batch,
+                   std::shared_ptr<ILock> lock,
+                   std::shared_ptr<std::vector<Status>> statuses);
+
+  void requestFullValues(const std::string& prefix,
+                         callback_t<const json&, unsigned> callback) {
+    requestAll(prefix, rev_,
+               [this, callback](const Status& status,
+                                const std::vector<op_t>& ops, unsigned rev) {
+                 if (status.ok()) {
+                   this->metaUpdate(ops, true);
+                   rev_ = rev;
+                 }
+                 return callback(status, meta_, rev_);
+               });
+  }
+
+  void syncValues(const std::string& prefix) {
+    std::vector<callback_t<const json&, unsigned>> waiters;
+    {
+      std::lock_guard<std::mutex> lock(sync_mutex_);
+      waiters.swap(sync_waiters_);
+    }
+    requestUpdates(prefix, rev_,
+                   [this, prefix, waiters](const Status& status,
+                                           const std::vector<op_t>& ops,
+                                           unsigned rev) {
+                     if (status.ok()) {
+                       this->metaUpdate(ops, true);
+                       rev_ = rev;
+                     }
+                     for (auto const& waiter : waiters) {
+                       VINEYARD_SUPPRESS(waiter(status, meta_, rev_));
+                     }
+                     bool next_round = false;
+                     {
+                       std::lock_guard<std::mutex> lock(sync_mutex_);
+                       next_round = !sync_waiters_.empty();
+                       syncing_ = next_round;
+                     }
+                     if (next_round) {
+                       this->syncValues(prefix);
+                     }
+                     return Status::OK();
+                   });
+  }
+
+  // reload the whole metadata, and drop the keys that have gone since the
+  // snapshot.
+  void resyncValues(callback_t<unsigned> callback_after_update);
+
+  Status loadSnapshot(std::vector<op_t>& ops, unsigned& rev);
+
+  Status startSnapshot(Status const&);
+
+  void checkpointSnapshot();
+
+  void recordRemote(const op_t& op);
+
   bool deleteable(ObjectID const object_id);
 
   void traverseToDelete(std::set<ObjectID>& initial_delete_set,
@@ -602,6 +919,8 @@ class IMetaService {
                             std::vector<ObjectID>& delete_objects);
 
   void putVal(const kv_t& kv, bool const from_remote);
+  void updateTypeIndex(std::string const& name);
+  void updateNameIndex(std::string const& name);
   void delVal(std::string const& key);
   void delVal(const kv_t& kv);
   void delVal(ObjectID const& target, std::set<ObjectID>& blobs);
@@ -609,10 +928,12 @@ class IMetaService {
   template <class RangeT>
   void metaUpdate(const RangeT& ops, bool const from_remote) {
     std::set<ObjectID> blobs_to_delete;
+    std::unique_lock<std::shared_timed_mutex> lock(meta_mutex_);
 
     std::vector<op_t> add_sigs, drop_sigs;
     std::vector<op_t> add_datas, drop_datas;
     std::vector<op_t> add_others, drop_others;
+    std::set<std::string> touched_names;
 
     // group-by all changes
     for (const op_t& op : ops) {
@@ -634,11 +955,17 @@ class IMetaService {
         // skip the update of etcd lock
         continue;
       }
+      if (from_remote) {
+        recordRemote(op);
+      }
 
       // update instance status
       if (boost::algorithm::starts_with(op.kv.key, "/instances/")) {
         instanceUpdate(op);
       }
+      if (boost::algorithm::starts_with(op.kv.key, "/names/")) {
+        touched_names.emplace(op.kv.key.substr(7));
+      }
 
 #ifndef NDEBUG
       if (from_remote) {
@@ -684,12 +1011,29 @@ class IMetaService {
     }
 
     // apply adding datas
+    std::set<std::string> touched_datas;
+    for (const op_t& op : add_datas) {
+      touched_datas.emplace(op.kv.key.substr(6, op.kv.key.find('/', 6) - 6));
+    }
+    // the created (or persisted) objects, for the subscribers
+    std::vector<std::string> added_datas(touched_datas.begin(),
+                                         touched_datas.end());
+    // the changes to existing objects (e.g., persist) invalidate the metadata
+    // cached by clients.
+    std::vector<ObjectID> invalidated;
+    if (meta_.contains("data") && meta_["data"].is_object()) {
+      for (auto const& name : touched_datas) {
+        if (meta_["data"].contains(name)) {
+          invalidated.emplace_back(VYObjectIDFromString(name));
+        }
+      }
+    }
     for (const op_t& op : add_datas) {
       putVal(op.kv, from_remote);
     }
 
     // apply drop datas
-
+    std::vector<ObjectID> deleted;
     {
       // 1. collect all ids
       std::set<ObjectID> initial_delete_set;
@@ -720,9 +1064,17 @@ class IMetaService {
 #endif
 
       // 3. execute delete for every object
+      invalidated.insert(invalidated.end(), processed_delete_set.begin(),
+                         processed_delete_set.end());
       for (auto const target : processed_delete_set) {
         delVal(target, blobs_to_delete);
+        touched_datas.emplace(VYObjectIDToString(target));
       }
+      deleted = std::move(processed_delete_set);
+    }
+
+    for (auto const& name : touched_datas) {
+      updateTypeIndex(name);
     }
 
     // apply drop others
@@ -735,6 +1087,10 @@ class IMetaService {
       delVal(op.kv);
     }
 
+    for (auto const& name : touched_names) {
+      updateNameIndex(name);
+    }
+
 #ifndef NDEBUG
     // debugging
     if (VLOG_IS_ON(10)) {
@@ -745,8 +1101,70 @@ class IMetaService {
     }
 #endif
 
+    meta_version_ += 1;
+    // the remaining works only read the `meta_`, and the writers all run on
+    // the meta context.
+    lock.unlock();
+    std::vector<std::string> names(touched_names.begin(), touched_names.end());
+    server_ptr_->NotifyInvalidation(invalidated, names);
+    server_ptr_->EraseFootprints(deleted);
     VINEYARD_SUPPRESS(server_ptr_->DeleteBlobBatch(blobs_to_delete));
-    VINEYARD_SUPPRESS(server_ptr_->ProcessDeferred(meta_));
+    server_ptr_->ProcessNameWaiters(names);
+    server_ptr_->NotifyObjects(objectEvents(added_datas, names));
+    std::vector<ObjectID> touched_ids;
+    for (auto const& name : touched_datas) {
+      touched_ids.emplace_back(VYObjectIDFromString(name));
+    }
+    VINEYARD_SUPPRESS(server_ptr_->ProcessDeferred(meta_, touched_ids));
+  }
+
+  // the events of the given objects and names for the subscribers, requires
+  // the `meta_` won't be changed concurrently.
+  json objectEvents(std::vector<std::string> const& datas,
+                    std::vector<std::string> const& names) {
+    json events = json::array();
+    auto data = meta_.find("data");
+    if (data == meta_.end() || !data->is_object()) {
+      return events;
+    }
+    auto make_event = [&](std::string const& key) -> json {
+      auto object = data->find(key);
+      if (object == data->end() || !object->is_object()) {
+        return json();
+      }
+      json event, labels;
+      event["id"] = VYObjectIDFromString(key);
+      event["typename"] = object->value("typename", "");
+      event["signature"] = object->value("signature", InvalidSignature());
+      event["instance_id"] =
+          object->value("instance_id", UnspecifiedInstanceID());
+      event["transient"] = object->value("transient", true);
+      for (auto const& item : object->items()) {
+        if (item.value().is_string()) {
+          labels[item.key()] = item.value();
+        }
+      }
+      event["labels"] = labels;
+      return event;
+    };
+    for (auto const& key : datas) {
+      json event = make_event(key);
+      if (!event.is_null()) {
+        events.push_back(std::move(event));
+      }
+    }
+    for (auto const& name : names) {
+      auto entry = name_index_.find(name);
+      if (entry == name_index_.end()) {
+        continue;
+      }
+      json event = make_event(VYObjectIDToString(entry->second));
+      if (!event.is_null()) {
+        event["name"] = name;
+        events.push_back(std::move(event));
+      }
+    }
+    return events;
   }
 
   void instanceUpdate(const op_t& op) {
@@ -760,9 +1178,15 @@ class IMetaService {
       if (op.op == op_t::op_type_t::kPut) {
         LOG(INFO) << "Instance join: " << instance_id;
         instances_list_.emplace(instance_id);
+        if (membership_) {
+          membership_->Join(instance_id);
+        }
       } else if (op.op == op_t::op_type_t::kDel) {
         LOG(INFO) << "Instance exit: " << instance_id;
         instances_list_.erase(instance_id);
+        if (membership_) {
+          membership_->Leave(instance_id);
+        }
       } else {
         LOG(ERROR) << "Unknown op type: " << op.ToString();
       }
@@ -780,6 +1204,11 @@ class IMetaService {
     // for one type of change.
     if (!status.ok()) {
       LOG(ERROR) << "Error in daemon watching: " << status.ToString();
+      if (watch_compacted_.exchange(false)) {
+        // the revision to watch from (e.g., of the snapshot) has gone.
+        resyncValues(callback_after_update);
+        return Status::OK();
+      }
       return callback_after_update(status, rev);
     }
     if (ops.empty()) {
@@ -803,9 +1232,46 @@ class IMetaService {
 
   std::unique_ptr<asio::steady_timer> heartbeat_timer_;
   std::set<InstanceID> instances_list_;
+  // detects the failures by gossiping rather than the heartbeat in etcd
+  bool gossip_ = false;
+  int64_t gossip_interval_ = GOSSIP_INTERVAL;
+  std::shared_ptr<Membership> membership_;
+
+  // the pending requests of group commit, see `requestToCommit`.
+  std::mutex commit_mutex_;
+  bool committing_ = false;
+  std::vector<commit_request_t> commit_queue_;
+  // the expiry (in seconds) of the lease over the keys owned by this instance.
+  std::atomic<int64_t> lease_expiry_{0};
+
+  // coalesces the concurrent remote syncs, see `requestValues`.
+  std::mutex sync_mutex_;
+  bool syncing_ = false;
+  std::vector<callback_t<const json&, unsigned>> sync_waiters_;
+
+  // the metadata from the meta service, checkpointed to `snapshot_path_`
+  // periodically for resuming after restarts.
+  std::string snapshot_path_;
+  int64_t snapshot_interval_ = SNAPSHOT_INTERVAL;
+  std::map<std::string, std::string> snapshot_kvs_;
+  // the keys from the meta service when the snapshot is disabled, for
+  // finding the keys that vanished during a resync.
+  std::set<std::string> remote_keys_;
+  unsigned snapshot_rev_ = 0;
+  std::atomic<bool> snapshot_writing_{false};
+  std::thread snapshot_writer_;
+  std::unique_ptr<asio::steady_timer> snapshot_timer_;
   int64_t target_latest_time_ = 0;
   size_t timeout_count_ = 0;
 
+  // the typename index of "/data", and the reverse mapping
+  type_index_t type_index_;
+  std::unordered_map<std::string, std::string> object_types_;
+
+  // the index of "/names", for resolving names without traversing the tree
+  name_index_t name_index_;
+  object_names_t object_names_;
+
   // dependency: object id -> members' object id
   std::multimap<ObjectID, ObjectID> subobjects_;
   // dependency: object id -> ancestors' object id
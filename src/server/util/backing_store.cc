@@ -0,0 +1,260 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+
+#include "server/util/backing_store.h"
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "boost/algorithm/string/predicate.hpp"
+#include "boost/filesystem.hpp"
+
+#include "common/util/json.h"
+
+namespace vineyard {
+
+namespace {
+
+// the chunks of a blob are named by their indices, and the manifest records
+// the size and chunk size of the blob.
+class FileBackingStore : public BackingStore {
+ public:
+  FileBackingStore(const std::string& root, const size_t chunk_size,
+                   const size_t concurrency)
+      : root_(root),
+        chunk_size_(std::max<size_t>(chunk_size, 1)),
+        concurrency_(std::max<size_t>(concurrency, 1)) {}
+
+  Status Init() {
+    boost::system::error_code ec;
+    boost::filesystem::create_directories(root_, ec);
+    if (ec) {
+      return Status::IOError("Failed to create the backing store '" + root_ +
+                             "': " + ec.message());
+    }
+    if (access(root_.c_str(), R_OK | W_OK) != 0) {
+      return Status::IOError("The backing store '" + root_ +
+                             "' is not accessible: " + strerror(errno));
+    }
+    return Status::OK();
+  }
+
+  Status Put(const ObjectID id, const uint8_t* data,
+             const size_t size) override {
+    std::string directory = blobPath(id);
+    boost::system::error_code ec;
+    // drop the stale (or partially written) copy
+    boost::filesystem::remove_all(directory, ec);
+    boost::filesystem::create_directories(directory, ec);
+    if (ec) {
+      return Status::IOError("Failed to create '" + directory +
+                             "': " + ec.message());
+    }
+    size_t chunks = (size + chunk_size_ - 1) / chunk_size_;
+    RETURN_ON_ERROR(parallelFor(chunks, [&](const size_t index) -> Status {
+      size_t offset = index * chunk_size_;
+      return writeFile(chunkPath(id, index), data + offset,
+                       std::min(chunk_size_, size - offset));
+    }));
+    json manifest;
+    manifest["size"] = size;
+    manifest["chunk_size"] = chunk_size_;
+    std::string content = manifest.dump();
+    // commit: the manifest is renamed into place atomically
+    std::string manifest_path = directory + "/manifest";
+    RETURN_ON_ERROR(writeFile(manifest_path + ".tmp",
+                              reinterpret_cast<const uint8_t*>(content.data()),
+                              content.size()));
+    if (rename((manifest_path + ".tmp").c_str(), manifest_path.c_str()) != 0) {
+      return Status::IOError("Failed to commit '" + manifest_path +
+                             "': " + strerror(errno));
+    }
+    return Status::OK();
+  }
+
+  Status Get(const ObjectID id, uint8_t* data, const size_t size) override {
+    size_t blob_size = 0, chunk_size = 0;
+    RETURN_ON_ERROR(readManifest(id, blob_size, chunk_size));
+    if (size < blob_size) {
+      return Status::Invalid("The buffer is too small for blob " +
+                             ObjectIDToString(id));
+    }
+    size_t chunks = (blob_size + chunk_size - 1) / chunk_size;
+    return parallelFor(chunks, [&](const size_t index) -> Status {
+      size_t offset = index * chunk_size;
+      return readFile(chunkPath(id, index), data + offset,
+                      std::min(chunk_size, blob_size - offset));
+    });
+  }
+
+  Status Size(const ObjectID id, size_t& size) override {
+    size_t chunk_size = 0;
+    return readManifest(id, size, chunk_size);
+  }
+
+  Status Delete(const ObjectID id) override {
+    boost::system::error_code ec;
+    boost::filesystem::remove_all(blobPath(id), ec);
+    if (ec) {
+      return Status::IOError("Failed to remove '" + blobPath(id) +
+                             "': " + ec.message());
+    }
+    return Status::OK();
+  }
+
+  std::string Location() const override { return root_; }
+
+ private:
+  std::string blobPath(const ObjectID id) const {
+    return root_ + "/" + ObjectIDToString(id);
+  }
+
+  std::string chunkPath(const ObjectID id, const size_t index) const {
+    return blobPath(id) + "/" + std::to_string(index);
+  }
+
+  Status readManifest(const ObjectID id, size_t& size, size_t& chunk_size) {
+    std::ifstream stream(blobPath(id) + "/manifest");
+    if (!stream) {
+      return Status::ObjectNotExists("backing store: id = " +
+                                     ObjectIDToString(id));
+    }
+    try {
+      json manifest = json::parse(stream);
+      size = manifest["size"].get<size_t>();
+      chunk_size = std::max<size_t>(manifest["chunk_size"].get<size_t>(), 1);
+    } catch (json::exception const& err) {
+      return Status::IOError("Invalid manifest of blob " +
+                             ObjectIDToString(id) + ": " + err.what());
+    }
+    return Status::OK();
+  }
+
+  // runs the tasks on at most `concurrency_` threads, and returns the first
+  // error.
+  template <typename F>
+  Status parallelFor(const size_t count, F&& task) {
+    if (count == 0) {
+      return Status::OK();
+    }
+    std::atomic<size_t> next{0};
+    std::vector<Status> statuses(std::min(concurrency_, count));
+    auto worker = [&](const size_t slot) {
+      size_t index;
+      while ((index = next.fetch_add(1)) < count && statuses[slot].ok()) {
+        statuses[slot] = task(index);
+      }
+    };
+    std::vector<std::thread> workers;
+    for (size_t slot = 1; slot < statuses.size(); ++slot) {
+      workers.emplace_back(worker, slot);
+    }
+    worker(0);
+    for (auto& thread : workers) {
+      thread.join();
+    }
+    for (auto const& status : statuses) {
+      RETURN_ON_ERROR(status);
+    }
+    return Status::OK();
+  }
+
+  static Status writeFile(const std::string& path, const uint8_t* data,
+                          const size_t size) {
+    int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0600);
+    if (fd == -1) {
+      return Status::IOError("Failed to open '" + path +
+                             "': " + strerror(errno));
+    }
+    size_t offset = 0;
+    while (offset < size) {
+      ssize_t nbytes = write(fd, data + offset, size - offset);
+      if (nbytes == -1) {
+        if (errno == EINTR) {
+          continue;
+        }
+        std::string message = strerror(errno);
+        close(fd);
+        return Status::IOError("Failed to write '" + path + "': " + message);
+      }
+      offset += nbytes;
+    }
+    close(fd);
+    return Status::OK();
+  }
+
+  static Status readFile(const std::string& path, uint8_t* data,
+                         const size_t size) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd == -1) {
+      return Status::IOError("Failed to open '" + path +
+                             "': " + strerror(errno));
+    }
+    size_t offset = 0;
+    while (offset < size) {
+      ssize_t nbytes = read(fd, data + offset, size - offset);
+      if (nbytes == -1 && errno == EINTR) {
+        continue;
+      }
+      if (nbytes <= 0) {
+        std::string message = nbytes == 0 ? "unexpected EOF" : strerror(errno);
+        close(fd);
+        return Status::IOError("Failed to read '" + path + "': " + message);
+      }
+      offset += nbytes;
+    }
+    close(fd);
+    return Status::OK();
+  }
+
+  const std::string root_;
+  const size_t chunk_size_;
+  const size_t concurrency_;
+};
+
+}  // namespace
+
+Status BackingStore::Make(const std::string& location, const size_t chunk_size,
+                          const size_t concurrency,
+                          std::shared_ptr<BackingStore>& store) {
+  std::string path = location;
+  if (boost::algorithm::starts_with(path, "file://")) {
+    path = path.substr(std::string("file://").size());
+  } else if (path.find("://") != std::string::npos) {
+    return Status::NotImplemented(
+        "The backing store '" + location +
+        "' is not supported, mount it as a directory (e.g., by ossfs or "
+        "s3fs) instead");
+  }
+  auto file_store =
+      std::make_shared<FileBackingStore>(path, chunk_size, concurrency);
+  RETURN_ON_ERROR(file_store->Init());
+  store = file_store;
+  return Status::OK();
+}
+
+}  // namespace vineyard
@@ -0,0 +1,72 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+
+#ifndef SRC_SERVER_UTIL_BACKING_STORE_H_
+#define SRC_SERVER_UTIL_BACKING_STORE_H_
+
+#include <memory>
+#include <string>
+
+#include "common/util/status.h"
+#include "common/util/uuid.h"
+
+namespace vineyard {
+
+/**
+ * @brief BackingStore keeps the copies of persisted blobs outside the shared
+ * memory, such that the blobs can be re-hydrated after vineyardd restarts.
+ *
+ * A blob is written in chunks in parallel (as a multipart upload does), and
+ * becomes visible once its manifest, which is written last, is committed.
+ */
+class BackingStore {
+ public:
+  virtual ~BackingStore() = default;
+
+  /**
+   * @brief Make the backing store for the given location, only the local (or
+   * mounted, e.g., by ossfs or s3fs) directories, optionally with the
+   * "file://" scheme, are supported.
+   */
+  static Status Make(const std::string& location, const size_t chunk_size,
+                     const size_t concurrency,
+                     std::shared_ptr<BackingStore>& store);
+
+  virtual Status Put(const ObjectID id, const uint8_t* data,
+                     const size_t size) = 0;
+
+  /**
+   * @brief Read the blob into `data`, which must have at least `size` bytes,
+   * see also `Size`.
+   */
+  virtual Status Get(const ObjectID id, uint8_t* data, const size_t size) = 0;
+
+  /**
+   * @brief The size of the committed blob, fails if it doesn't exist.
+   */
+  virtual Status Size(const ObjectID id, size_t& size) = 0;
+
+  /**
+   * @brief Remove the blob, non-existing blobs will be ignored.
+   */
+  virtual Status Delete(const ObjectID id) = 0;
+
+  virtual std::string Location() const = 0;
+};
+
+}  // namespace vineyard
+
+#endif  // SRC_SERVER_UTIL_BACKING_STORE_H_
@@ -0,0 +1,121 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "server/util/credentials.h"
+
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+namespace vineyard {
+
+namespace credentials {
+
+Status OfPeer(const int socket_fd, Credentials& credentials) {
+#if defined(__linux__) && defined(SO_PEERCRED)
+  struct ucred peer;
+  socklen_t length = sizeof(peer);
+  if (getsockopt(socket_fd, SOL_SOCKET, SO_PEERCRED, &peer, &length) != 0 ||
+      peer.pid <= 0) {
+    return Status::Invalid(
+        "Failed to resolve the credentials of the peer, requires a UNIX "
+        "domain socket");
+  }
+  credentials.pid = peer.pid;
+  credentials.uid = peer.uid;
+  credentials.gid = peer.gid;
+  credentials.groups.clear();
+  // the supplementary groups are not carried by SO_PEERCRED
+  std::ifstream status("/proc/" + std::to_string(peer.pid) + "/status");
+  std::string line;
+  while (std::getline(status, line)) {
+    if (line.compare(0, 7, "Groups:") == 0) {
+      std::istringstream groups(line.substr(7));
+      gid_t group;
+      while (groups >> group) {
+        credentials.groups.emplace_back(group);
+      }
+      break;
+    }
+  }
+  return Status::OK();
+#else
+  return Status::NotImplemented(
+      "Resolving the credentials of the peer is not supported on this "
+      "platform");
+#endif
+}
+
+// checks the `mask` (e.g., `S_IROTH`) in the bits of the owner, group or
+// others, the same as the kernel does.
+static bool permitted(const Credentials& credentials, const struct stat& st,
+                      const mode_t mask) {
+  if (credentials.uid == st.st_uid) {
+    return st.st_mode & (mask << 6);
+  }
+  if (credentials.gid == st.st_gid ||
+      std::find(credentials.groups.begin(), credentials.groups.end(),
+                st.st_gid) != credentials.groups.end()) {
+    return st.st_mode & (mask << 3);
+  }
+  return st.st_mode & mask;
+}
+
+Status CheckReadable(const Credentials& credentials, const int fd) {
+  if (credentials.uid == 0) {
+    return Status::OK();
+  }
+  // the path of the opened file, where the symbolic links have been resolved
+  std::string link = "/proc/self/fd/" + std::to_string(fd);
+  std::string path(4096, '\0');
+  ssize_t length = readlink(link.c_str(), &path[0], path.size());
+  if (length <= 0 || static_cast<size_t>(length) >= path.size() ||
+      path[0] != '/') {
+    return Status::IOError("Failed to resolve the path of the file");
+  }
+  path.resize(length);
+
+  struct stat st;
+  for (size_t loc = path.find('/'); loc != std::string::npos;
+       loc = path.find('/', loc + 1)) {
+    std::string directory = loc == 0 ? "/" : path.substr(0, loc);
+    if (stat(directory.c_str(), &st) != 0) {
+      return Status::IOError("Failed to stat '" + directory +
+                             "': " + strerror(errno));
+    }
+    if (!permitted(credentials, st, S_IXOTH)) {
+      return Status::Invalid("Permission denied: '" + path + "'");
+    }
+  }
+  if (fstat(fd, &st) != 0) {
+    return Status::IOError("Failed to stat '" + path +
+                           "': " + strerror(errno));
+  }
+  if (!permitted(credentials, st, S_IROTH)) {
+    return Status::Invalid("Permission denied: '" + path + "'");
+  }
+  return Status::OK();
+}
+
+}  // namespace credentials
+
+}  // namespace vineyard
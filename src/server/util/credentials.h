@@ -0,0 +1,60 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef SRC_SERVER_UTIL_CREDENTIALS_H_
+#define SRC_SERVER_UTIL_CREDENTIALS_H_
+
+#include <sys/types.h>
+
+#include <vector>
+
+#include "common/util/status.h"
+
+namespace vineyard {
+
+namespace credentials {
+
+/**
+ * @brief The credentials of the peer process of a UNIX domain socket.
+ */
+struct Credentials {
+  pid_t pid = -1;
+  uid_t uid = static_cast<uid_t>(-1);
+  gid_t gid = static_cast<gid_t>(-1);
+  // the supplementary groups
+  std::vector<gid_t> groups;
+};
+
+/**
+ * @brief Resolve the credentials of the peer process of a UNIX domain socket,
+ * fails for the other kinds of sockets (e.g., TCP).
+ */
+Status OfPeer(const int socket_fd, Credentials& credentials);
+
+/**
+ * @brief Check whether the process of the credentials is allowed to read the
+ * opened file, i.e., it can search every directory on the path of the file
+ * and read the file itself.
+ *
+ * Only the permission bits are checked, ACLs that grant more access are not
+ * taken into account.
+ */
+Status CheckReadable(const Credentials& credentials, const int fd);
+
+}  // namespace credentials
+
+}  // namespace vineyard
+
+#endif  // SRC_SERVER_UTIL_CREDENTIALS_H_
@@ -135,6 +135,16 @@ Status EtcdLauncher::LaunchEtcdServer(
   args.emplace_back("--initial-advertise-peer-urls");
   args.emplace_back(peer_endpoint);
 
+  // every update of the metadata creates a revision, compact the history in
+  // the background to keep the size of etcd bounded.
+  int64_t retention = etcd_spec_.value("compaction_retention", 0);
+  if (retention > 0) {
+    args.emplace_back("--auto-compaction-mode");
+    args.emplace_back("revision");
+    args.emplace_back("--auto-compaction-retention");
+    args.emplace_back(std::to_string(retention));
+  }
+
   if (VLOG_IS_ON(10)) {
     args.emplace_back("--log-level");
     args.emplace_back("debug");
@@ -0,0 +1,135 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "server/util/footprint.h"
+
+#include <algorithm>
+#include <set>
+#include <utility>
+
+namespace vineyard {
+
+static void collect_blob_sizes(const json& tree, const InstanceID instance_id,
+                               std::set<ObjectID>& blobs, size_t& size) {
+  for (auto const& item : json::iterator_wrapper(tree)) {
+    if (!item.value().is_object() || item.value().empty()) {
+      continue;
+    }
+    const json& member = item.value();
+    if (member.value("typename", "") == "vineyard::Blob") {
+      if (member.value("instance_id", UnspecifiedInstanceID()) ==
+              instance_id &&
+          member.contains("id")) {
+        ObjectID blob_id =
+            VYObjectIDFromString(member["id"].get_ref<std::string const&>());
+        if (blobs.emplace(blob_id).second) {
+          size += member.value("length", static_cast<size_t>(0));
+        }
+      }
+    } else {
+      collect_blob_sizes(member, instance_id, blobs, size);
+    }
+  }
+}
+
+size_t FootprintIndex::Measure(const json& tree, const InstanceID instance_id) {
+  std::set<ObjectID> blobs;
+  size_t size = 0;
+  collect_blob_sizes(tree, instance_id, blobs, size);
+  return size;
+}
+
+bool FootprintIndex::Put(const ObjectID id, const std::string& type,
+                         const size_t size) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!objects_.emplace(id, footprint_t{type, size}).second) {
+    return false;
+  }
+  bool created = types_.find(type) == types_.end();
+  auto& aggregate = types_[type];
+  aggregate.objects += 1;
+  aggregate.size += size;
+  return created;
+}
+
+void FootprintIndex::Erase(const std::vector<ObjectID>& ids) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (auto const& id : ids) {
+    auto iter = objects_.find(id);
+    if (iter == objects_.end()) {
+      continue;
+    }
+    // the aggregates of the typenames are kept (even become zero), as the
+    // gauges of them have been registered.
+    auto& aggregate = types_[iter->second.type];
+    aggregate.objects -= 1;
+    aggregate.size -= iter->second.size;
+    objects_.erase(iter);
+  }
+}
+
+json FootprintIndex::Query(const std::vector<ObjectID>& ids,
+                           const size_t limit) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::vector<std::pair<ObjectID, const footprint_t*>> selected;
+  if (ids.empty()) {
+    selected.reserve(objects_.size());
+    for (auto const& item : objects_) {
+      selected.emplace_back(item.first, &item.second);
+    }
+    size_t n = limit == 0 ? selected.size() : std::min(limit, selected.size());
+    auto by_size = [](const std::pair<ObjectID, const footprint_t*>& lhs,
+                      const std::pair<ObjectID, const footprint_t*>& rhs) {
+      return lhs.second->size > rhs.second->size;
+    };
+    std::partial_sort(selected.begin(), selected.begin() + n, selected.end(),
+                      by_size);
+    selected.resize(n);
+  } else {
+    for (auto const& id : ids) {
+      auto iter = objects_.find(id);
+      if (iter != objects_.end()) {
+        selected.emplace_back(id, &iter->second);
+      }
+    }
+  }
+
+  json objects = json::array();
+  for (auto const& item : selected) {
+    objects.push_back(json{{"id", item.first},
+                           {"typename", item.second->type},
+                           {"size", item.second->size}});
+  }
+  json types = json::object();
+  size_t total = 0;
+  for (auto const& item : types_) {
+    if (item.second.objects == 0) {
+      continue;
+    }
+    types[item.first] =
+        json{{"objects", item.second.objects}, {"size", item.second.size}};
+    total += item.second.size;
+  }
+  return json{{"objects", objects}, {"types", types}, {"total", total}};
+}
+
+FootprintIndex::aggregate_t FootprintIndex::Aggregate(
+    const std::string& type) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto iter = types_.find(type);
+  return iter == types_.end() ? aggregate_t{} : iter->second;
+}
+
+}  // namespace vineyard
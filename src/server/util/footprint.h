@@ -0,0 +1,85 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef SRC_SERVER_UTIL_FOOTPRINT_H_
+#define SRC_SERVER_UTIL_FOOTPRINT_H_
+
+#include <cstddef>
+#include <map>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "common/util/json.h"
+#include "common/util/uuid.h"
+
+namespace vineyard {
+
+/**
+ * @brief The shared memory taken by the objects on this instance, i.e., the
+ * total size of the (distinct) local member blobs of every object, and the
+ * aggregates per typename.
+ *
+ * The footprint of an object is computed once when it is created, and the
+ * aggregates are maintained incrementally, thus the queries don't traverse
+ * the metadata. The blobs shared by several objects (e.g., a table and its
+ * columns) are counted in every of them.
+ */
+class FootprintIndex {
+ public:
+  struct footprint_t {
+    std::string type;
+    size_t size = 0;
+  };
+
+  struct aggregate_t {
+    size_t objects = 0;
+    size_t size = 0;
+  };
+
+  /**
+   * @brief The total size of the distinct blobs of `instance_id` inside the
+   * (fully expanded) metadata tree of an object.
+   */
+  static size_t Measure(const json& tree, const InstanceID instance_id);
+
+  /**
+   * @brief Record the footprint of an object.
+   *
+   * @return Whether the typename hasn't been seen before.
+   */
+  bool Put(const ObjectID id, const std::string& type, const size_t size);
+
+  void Erase(const std::vector<ObjectID>& ids);
+
+  /**
+   * @brief Render the footprints of the given objects, or the `limit` largest
+   * objects (all objects if `limit` is 0) if `ids` is empty, and the
+   * aggregates of all typenames.
+   */
+  json Query(const std::vector<ObjectID>& ids, const size_t limit) const;
+
+  aggregate_t Aggregate(const std::string& type) const;
+
+ private:
+  mutable std::mutex mutex_;
+  std::unordered_map<ObjectID, footprint_t> objects_;
+  std::map<std::string, aggregate_t> types_;
+};
+
+}  // namespace vineyard
+
+#endif  // SRC_SERVER_UTIL_FOOTPRINT_H_
@@ -17,6 +17,7 @@ limitations under the License.
 
 #include <map>
 #include <memory>
+#include <set>
 #include <string>
 #include <vector>
 
@@ -26,6 +27,7 @@ limitations under the License.
 #include "boost/process.hpp"
 
 #include "common/util/boost.h"
+#include "server/util/meta_tree.h"
 
 namespace vineyard {
 
@@ -52,6 +54,22 @@ void Kubectl::Apply(const std::string& content, callback_t<> callback) {
   });
 }
 
+// the bytes of blobs in the object, used by the scheduler to weight the
+// locality of chunks.
+static size_t object_nbytes(const json& object) {
+  if (object.value("typename", "") == "vineyard::Blob") {
+    return object.value("nbytes", static_cast<size_t>(0));
+  }
+  std::set<ObjectID> visited;
+  std::map<InstanceID, size_t> locality;
+  meta_tree::CollectLocality(object, visited, locality);
+  size_t nbytes = 0;
+  for (auto const& item : locality) {
+    nbytes += item.second;
+  }
+  return nbytes;
+}
+
 static std::string generate_local_object(
     std::map<InstanceID, std::string> const& instances, const json& object) {
   std::string object_id = object["id"].get_ref<std::string const&>();
@@ -59,6 +77,7 @@ static std::string generate_local_object(
       SignatureToString(object["signature"].get<Signature>());
   std::string type_name = object["typename"].get_ref<std::string const&>();
   InstanceID instance_id = object["instance_id"].get<InstanceID>();
+  size_t nbytes = object_nbytes(object);
   /* clang-format off */
   std::string crd = "\n"
                     "\n---"
@@ -75,6 +94,7 @@ static std::string generate_local_object(
                     "\n  typename: " + type_name +
                     "\n  instance_id: " + std::to_string(instance_id) +
                     "\n  hostname: " + instances.at(instance_id) +
+                    "\n  nbytes: " + std::to_string(nbytes) +
                     "\n  metadata: " + type_name +
                     "\n\n";
   /* clang-format on */
@@ -142,6 +162,38 @@ void Kubectl::ApplyObject(const json& meta, const json& object) {
   this->Apply(crds, [](const Status& status) { return status; });
 }
 
+void Kubectl::ApplyInstanceStatus(const json& meta,
+                                  const InstanceID instance_id,
+                                  const size_t memory_usage,
+                                  const size_t memory_limit) {
+  std::string id = std::to_string(instance_id);
+  std::string instance_key = "i" + id;
+  if (!meta.contains(instance_key)) {
+    return;
+  }
+  std::string hostname =
+      meta[instance_key].value("nodename", std::string("localhost"));
+  /* clang-format off */
+  std::string crd = "\n"
+                    "\n---"
+                    "\n"
+                    "\napiVersion: v1"
+                    "\nkind: ConfigMap"
+                    "\nmetadata:"
+                    "\n  name: vineyard-instance-" + id +
+                    "\n  labels:"
+                    "\n    k8s.v6d.io/instance-status: \"true\""
+                    "\ndata:"
+                    "\n  instance_id: \"" + id + "\""
+                    "\n  hostname: " + hostname +
+                    "\n  memory_usage: \"" + std::to_string(memory_usage) + "\""
+                    "\n  memory_limit: \"" + std::to_string(memory_limit) + "\""
+                    "\n\n";
+  /* clang-format on */
+  VLOG(10) << "Apply instance status: " << crd;
+  this->Apply(crd, [](const Status& status) { return status; });
+}
+
 void Kubectl::Finish() {
   proc_->Finish();
   for (auto const& line : Diagnostic()) {
@@ -45,6 +45,14 @@ class Kubectl {
 
   void ApplyObject(const json& meta, const json& object);
 
+  /**
+   * @brief Publish the shared memory usage of the instance as a ConfigMap,
+   * which is used by the scheduler to avoid nodes under memory pressure.
+   */
+  void ApplyInstanceStatus(const json& meta, const InstanceID instance_id,
+                           const size_t memory_usage,
+                           const size_t memory_limit);
+
   void Finish();
 
   std::list<std::string> const& Diagnostic() const {
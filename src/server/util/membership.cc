@@ -0,0 +1,475 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "server/util/membership.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <set>
+#include <utility>
+
+#include "common/util/logging.h"
+#include "common/util/protocols.h"
+
+namespace vineyard {
+
+// the number of members that are asked to probe the target indirectly.
+static constexpr size_t kIndirectProbes = 3;
+
+// the suspicion lasts for at least such protocol periods.
+static constexpr int64_t kSuspicionPeriods = 3;
+
+// the limit of gossip replies, the same as the requests of the RPC server.
+static constexpr size_t kMaxGossipMessage = 64 * 1024 * 1024;
+
+struct Membership::probe_t {
+  explicit probe_t(context_t& context)
+      : socket(context), resolver(context), timer(context) {}
+
+  asio::ip::tcp::socket socket;
+  asio::ip::tcp::resolver resolver;
+  asio::steady_timer timer;
+  // the member that is sent the probe
+  InstanceID peer = UnspecifiedInstanceID();
+  size_t length = 0;
+  std::string message;
+  std::function<void(bool)> callback;
+  bool done = false;
+};
+
+const char* MembershipStateToString(const Membership::State state) {
+  switch (state) {
+  case Membership::State::kAlive:
+    return "alive";
+  case Membership::State::kSuspect:
+    return "suspect";
+  case Membership::State::kDead:
+    return "dead";
+  default:
+    return "unknown";
+  }
+}
+
+Membership::State MembershipStateFromString(const std::string& state) {
+  if (state == "suspect") {
+    return Membership::State::kSuspect;
+  } else if (state == "dead") {
+    return Membership::State::kDead;
+  } else {
+    return Membership::State::kAlive;
+  }
+}
+
+Membership::Membership(context_t& context, const InstanceID self,
+                       const int64_t interval, resolve_t resolve,
+                       failure_t on_failure, alive_t on_alive)
+    : context_(context),
+      self_(self),
+      interval_(std::max(interval, static_cast<int64_t>(1))),
+      resolve_(std::move(resolve)),
+      on_failure_(std::move(on_failure)),
+      on_alive_(std::move(on_alive)),
+      random_(std::random_device()()) {}
+
+void Membership::Start() {
+  stopped_ = false;
+  timer_.reset(new asio::steady_timer(context_));
+  tick();
+}
+
+void Membership::Stop() {
+  stopped_ = true;
+  if (timer_) {
+    timer_->cancel();
+  }
+}
+
+void Membership::Join(const InstanceID id) {
+  if (id == self_ || members_.find(id) != members_.end()) {
+    return;
+  }
+  members_.emplace(id, member_t());
+  // probed in the next round of the round-robin order
+  probe_order_.emplace_back(id);
+}
+
+void Membership::Leave(const InstanceID id) { members_.erase(id); }
+
+void Membership::Serve(const InstanceID from, const InstanceID target,
+                       const json& updates, reply_t reply) {
+  Merge(from, updates);
+  if (target == UnspecifiedInstanceID() || target == self_) {
+    // being probed means this instance is reachable by its members.
+    on_alive_();
+    reply(true, Digest());
+    return;
+  }
+  auto self(shared_from_this());
+  send(target, UnspecifiedInstanceID(), interval_ / 2,
+       [self, reply](bool acked) { reply(acked, self->Digest()); });
+}
+
+json Membership::Digest() const {
+  json digest = json::array();
+  json update;
+  update["instance"] = self_;
+  update["incarnation"] = incarnation_;
+  update["state"] = MembershipStateToString(State::kAlive);
+  digest.push_back(update);
+  for (auto const& item : members_) {
+    update["instance"] = item.first;
+    update["incarnation"] = item.second.incarnation;
+    update["state"] = MembershipStateToString(item.second.state);
+    digest.push_back(update);
+  }
+  return digest;
+}
+
+void Membership::Merge(const InstanceID from, const json& updates) {
+  if (!updates.is_array()) {
+    return;
+  }
+  auto sender = members_.find(from);
+  bool const trusted =
+      sender != members_.end() && sender->second.state != State::kDead;
+  for (auto const& update : updates) {
+    InstanceID id = update.value("instance", UnspecifiedInstanceID());
+    uint64_t incarnation = update.value("incarnation", uint64_t(0));
+    State state = MembershipStateFromString(update.value("state", ""));
+    if (id == self_) {
+      if (state != State::kAlive && incarnation >= incarnation_) {
+        // refutes the suspicion, the new incarnation overrides it
+        incarnation_ = incarnation + 1;
+        LOG(INFO) << "Refuting the suspicion with incarnation "
+                  << incarnation_;
+      }
+      continue;
+    }
+    auto member = members_.find(id);
+    // members join only after their registration has been observed.
+    if (member == members_.end()) {
+      continue;
+    }
+    switch (state) {
+    case State::kAlive: {
+      // a newer incarnation refutes the suspicion, and the death as well
+      if (incarnation > member->second.incarnation) {
+        if (member->second.state == State::kDead) {
+          LOG(INFO) << "Instance " << id << " has refuted its death";
+        }
+        member->second.incarnation = incarnation;
+        member->second.state = State::kAlive;
+      }
+      break;
+    }
+    case State::kSuspect: {
+      suspect(id, incarnation);
+      break;
+    }
+    case State::kDead: {
+      if (trusted && incarnation >= member->second.incarnation) {
+        member->second.incarnation = incarnation;
+        confirm(id);
+      } else {
+        // the unverified claim is taken as a suspicion
+        suspect(id, incarnation);
+      }
+      break;
+    }
+    }
+  }
+}
+
+int64_t Membership::SuspicionTimeout() const {
+  double scale = std::ceil(std::log2(static_cast<double>(members_.size()) + 2));
+  return interval_ * kSuspicionPeriods * static_cast<int64_t>(scale);
+}
+
+void Membership::tick() {
+  if (stopped_) {
+    return;
+  }
+  int64_t const timestamp = now();
+  std::vector<InstanceID> expired;
+  for (auto const& item : members_) {
+    if (item.second.state == State::kSuspect &&
+        timestamp - item.second.suspected_at >= SuspicionTimeout()) {
+      expired.emplace_back(item.first);
+    }
+  }
+  for (auto const& id : expired) {
+    confirm(id);
+  }
+
+  InstanceID target = nextTarget();
+  if (target == UnspecifiedInstanceID()) {
+    // no one else to be reachable by
+    on_alive_();
+  } else {
+    probe(target);
+  }
+
+  auto self(shared_from_this());
+  timer_->expires_after(std::chrono::milliseconds(interval_));
+  timer_->async_wait([self](const boost::system::error_code& error) {
+    if (!error) {
+      self->tick();
+    }
+  });
+}
+
+void Membership::probe(const InstanceID target) {
+  auto self(shared_from_this());
+  send(target, UnspecifiedInstanceID(), interval_ / 3,
+       [self, target](bool acked) {
+         if (acked) {
+           self->on_alive_();
+         } else {
+           self->probeIndirectly(target);
+         }
+       });
+}
+
+void Membership::probeIndirectly(const InstanceID target) {
+  std::vector<InstanceID> peers;
+  for (auto const& item : members_) {
+    if (item.first != target && item.second.state == State::kAlive) {
+      peers.emplace_back(item.first);
+    }
+  }
+  std::shuffle(peers.begin(), peers.end(), random_);
+  if (peers.size() > kIndirectProbes) {
+    peers.resize(kIndirectProbes);
+  }
+  auto member = members_.find(target);
+  if (member == members_.end()) {
+    return;
+  }
+  uint64_t const incarnation = member->second.incarnation;
+  if (peers.empty()) {
+    suspect(target, incarnation);
+    return;
+  }
+
+  // suspects the target once all indirect probes failed
+  auto self(shared_from_this());
+  auto pending = std::make_shared<size_t>(peers.size());
+  auto acked = std::make_shared<bool>(false);
+  for (auto const& peer : peers) {
+    send(peer, target, interval_ / 2,
+         [self, target, incarnation, pending, acked](bool ack) {
+           *acked = *acked || ack;
+           if (--*pending == 0 && !*acked) {
+             self->suspect(target, incarnation);
+           }
+         });
+  }
+}
+
+void Membership::send(const InstanceID peer, const InstanceID target,
+                      const int64_t timeout,
+                      std::function<void(bool)> callback) {
+  std::string endpoint = resolve_(peer);
+  size_t split = endpoint.rfind(':');
+  if (split == std::string::npos) {
+    callback(false);
+    return;
+  }
+  std::string host = endpoint.substr(0, split),
+              port = endpoint.substr(split + 1);
+
+  auto probe = std::make_shared<probe_t>(context_);
+  probe->peer = peer;
+  probe->callback = std::move(callback);
+  std::string message;
+  WriteGossipRequest(self_, target, Digest(), message);
+  probe->length = message.size();
+  probe->message.resize(sizeof(size_t) + message.size());
+  memcpy(&probe->message[0], &probe->length, sizeof(size_t));
+  memcpy(&probe->message[sizeof(size_t)], message.data(), message.size());
+
+  auto self(shared_from_this());
+  probe->timer.expires_after(std::chrono::milliseconds(timeout));
+  probe->timer.async_wait([self, probe](const boost::system::error_code& e) {
+    if (!e) {
+      self->finish(probe, false, json());
+    }
+  });
+
+#if BOOST_VERSION >= 106600
+  probe->resolver.async_resolve(
+      host, port,
+      [self, probe](const boost::system::error_code& error,
+                    asio::ip::tcp::resolver::results_type results) {
+        if (error) {
+          self->finish(probe, false, json());
+          return;
+        }
+        asio::async_connect(
+            probe->socket, results,
+            [self, probe](const boost::system::error_code& error,
+                          const asio::ip::tcp::endpoint&) {
+              self->onConnected(probe, error);
+            });
+      });
+#else
+  probe->resolver.async_resolve(
+      asio::ip::tcp::resolver::query(host, port),
+      [self, probe](const boost::system::error_code& error,
+                    asio::ip::tcp::resolver::iterator iterator) {
+        if (error) {
+          self->finish(probe, false, json());
+          return;
+        }
+        asio::async_connect(
+            probe->socket, iterator,
+            [self, probe](const boost::system::error_code& error,
+                          asio::ip::tcp::resolver::iterator) {
+              self->onConnected(probe, error);
+            });
+      });
+#endif
+}
+
+void Membership::onConnected(std::shared_ptr<probe_t> probe,
+                             const boost::system::error_code& error) {
+  if (error || probe->done) {
+    finish(probe, false, json());
+    return;
+  }
+  auto self(shared_from_this());
+  asio::async_write(
+      probe->socket, asio::buffer(probe->message),
+      [self, probe](const boost::system::error_code& error, std::size_t) {
+        if (error) {
+          self->finish(probe, false, json());
+          return;
+        }
+        asio::async_read(
+            probe->socket, asio::buffer(&probe->length, sizeof(size_t)),
+            [self, probe](const boost::system::error_code& error,
+                          std::size_t) {
+              if (error || probe->length > kMaxGossipMessage) {
+                self->finish(probe, false, json());
+                return;
+              }
+              probe->message.resize(probe->length);
+              asio::async_read(
+                  probe->socket, asio::buffer(&probe->message[0],
+                                              probe->length),
+                  [self, probe](const boost::system::error_code& error,
+                                std::size_t) {
+                    bool acked = false;
+                    json updates;
+                    if (!error) {
+                      Status status = CATCH_JSON_ERROR(ReadGossipReply(
+                          json::parse(probe->message), acked, updates));
+                      if (!status.ok()) {
+                        VLOG(10) << "Invalid gossip reply: "
+                                 << status.ToString();
+                      }
+                    }
+                    self->finish(probe, acked, updates);
+                  });
+            });
+      });
+}
+
+void Membership::finish(std::shared_ptr<probe_t> probe, const bool acked,
+                        const json& updates) {
+  if (probe->done) {
+    return;
+  }
+  probe->done = true;
+  boost::system::error_code error;
+  probe->timer.cancel();
+  probe->socket.close(error);
+  Merge(probe->peer, updates);
+  probe->callback(acked);
+}
+
+void Membership::suspect(const InstanceID id, const uint64_t incarnation) {
+  auto member = members_.find(id);
+  if (member == members_.end() || member->second.state == State::kDead) {
+    return;
+  }
+  if (incarnation > member->second.incarnation ||
+      (incarnation == member->second.incarnation &&
+       member->second.state == State::kAlive)) {
+    LOG(WARNING) << "Instance " << id << " is suspected";
+    member->second.incarnation = incarnation;
+    member->second.state = State::kSuspect;
+    member->second.suspected_at = now();
+  }
+}
+
+void Membership::confirm(const InstanceID id) {
+  auto member = members_.find(id);
+  if (member == members_.end() || member->second.state == State::kDead) {
+    return;
+  }
+  LOG(ERROR) << "Instance " << id << " timeout";
+  member->second.state = State::kDead;
+  if (responsibleFor(id)) {
+    on_failure_(id);
+  }
+}
+
+bool Membership::responsibleFor(const InstanceID id) const {
+  // the first member that is not dead after `id`, in circular order
+  std::set<InstanceID> candidates{self_};
+  for (auto const& item : members_) {
+    if (item.first != id && item.second.state != State::kDead) {
+      candidates.emplace(item.first);
+    }
+  }
+  auto successor = candidates.upper_bound(id);
+  if (successor == candidates.end()) {
+    successor = candidates.begin();
+  }
+  return *successor == self_;
+}
+
+InstanceID Membership::nextTarget() {
+  for (size_t round = 0; round < 2; ++round) {
+    while (probe_index_ < probe_order_.size()) {
+      InstanceID id = probe_order_[probe_index_++];
+      auto member = members_.find(id);
+      if (member != members_.end() && member->second.state != State::kDead) {
+        return id;
+      }
+    }
+    // starts a new round in another random order
+    probe_order_.clear();
+    for (auto const& item : members_) {
+      if (item.second.state != State::kDead) {
+        probe_order_.emplace_back(item.first);
+      }
+    }
+    std::shuffle(probe_order_.begin(), probe_order_.end(), random_);
+    probe_index_ = 0;
+  }
+  return UnspecifiedInstanceID();
+}
+
+int64_t Membership::now() {
+  return std::chrono::duration_cast<std::chrono::milliseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+}  // namespace vineyard
@@ -0,0 +1,177 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef SRC_SERVER_UTIL_MEMBERSHIP_H_
+#define SRC_SERVER_UTIL_MEMBERSHIP_H_
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "boost/asio.hpp"
+#include "boost/asio/steady_timer.hpp"
+
+#include "common/util/json.h"
+#include "common/util/uuid.h"
+
+namespace vineyard {
+
+namespace asio = boost::asio;
+
+/**
+ * @brief Membership detects the failures of vineyardd instances by gossiping
+ * over the RPC port (SWIM), rather than polling the heartbeat timestamps in
+ * etcd.
+ *
+ * Every protocol period, the instance probes one of the members in a
+ * shuffled round-robin order. If the probe isn't acknowledged in time, a few
+ * other members are asked to probe it indirectly, and the member becomes
+ * suspected if none of them succeeds. The suspected member is declared as
+ * dead if it doesn't refute the suspicion (by increasing its incarnation)
+ * before the suspicion timeout. The membership view is piggybacked on every
+ * probe and reply.
+ *
+ * Members join and leave through the registration in the meta service, the
+ * failures are handled by the successor of the dead member only (as the
+ * etcd heartbeat does). Every method must be called on the given context.
+ */
+class Membership : public std::enable_shared_from_this<Membership> {
+ public:
+  enum class State {
+    kAlive = 0,
+    kSuspect = 1,
+    kDead = 2,
+  };
+
+  // the rpc endpoint of the instance, or empty if it is unknown.
+  using resolve_t = std::function<std::string(const InstanceID)>;
+  // invoked when the member has been declared as dead.
+  using failure_t = std::function<void(const InstanceID)>;
+  // invoked when this instance is known to be reachable by its members.
+  using alive_t = std::function<void()>;
+  using reply_t = std::function<void(const bool, const json&)>;
+
+#if BOOST_VERSION >= 106600
+  using context_t = asio::io_context;
+#else
+  using context_t = asio::io_service;
+#endif
+
+  Membership(context_t& context, const InstanceID self,
+             const int64_t interval, resolve_t resolve, failure_t on_failure,
+             alive_t on_alive);
+
+  void Start();
+
+  void Stop();
+
+  void Join(const InstanceID id);
+
+  void Leave(const InstanceID id);
+
+  /**
+   * @brief Serve the probe from a member, `target` is the instance to probe
+   * on behalf of `from`, or this instance itself.
+   */
+  void Serve(const InstanceID from, const InstanceID target,
+             const json& updates, reply_t reply);
+
+  /**
+   * @brief The membership view, including the incarnation of this instance.
+   */
+  json Digest() const;
+
+  /**
+   * @brief Merge the membership view piggybacked by the member `from`.
+   *
+   * A member is declared as dead only by a registered member and for an
+   * incarnation that is not older than the known one, otherwise the claim is
+   * taken as a suspicion. A dead member comes back once it refutes with a
+   * newer incarnation.
+   */
+  void Merge(const InstanceID from, const json& updates);
+
+  /**
+   * @brief The time (in milliseconds) before a suspected member is declared
+   * as dead, which scales with the number of members logarithmically.
+   */
+  int64_t SuspicionTimeout() const;
+
+ private:
+  struct member_t {
+    uint64_t incarnation = 0;
+    State state = State::kAlive;
+    int64_t suspected_at = 0;
+  };
+
+  struct probe_t;
+
+  void tick();
+
+  void probe(const InstanceID target);
+
+  void probeIndirectly(const InstanceID target);
+
+  // sends the probe of `target` to `peer`, the callback is invoked exactly
+  // once, with whether the probe has been acknowledged.
+  void send(const InstanceID peer, const InstanceID target,
+            const int64_t timeout, std::function<void(bool)> callback);
+
+  void onConnected(std::shared_ptr<probe_t> probe,
+                   const boost::system::error_code& error);
+
+  void finish(std::shared_ptr<probe_t> probe, const bool acked,
+              const json& updates);
+
+  void suspect(const InstanceID id, const uint64_t incarnation);
+
+  void confirm(const InstanceID id);
+
+  // whether this instance is the successor of the dead member among the
+  // members that are not dead, and thus responsible for the cleanup.
+  bool responsibleFor(const InstanceID id) const;
+
+  InstanceID nextTarget();
+
+  static int64_t now();
+
+  context_t& context_;
+  const InstanceID self_;
+  // the protocol period, in milliseconds
+  const int64_t interval_;
+  resolve_t resolve_;
+  failure_t on_failure_;
+  alive_t on_alive_;
+
+  uint64_t incarnation_ = 0;
+  std::map<InstanceID, member_t> members_;
+  std::vector<InstanceID> probe_order_;
+  size_t probe_index_ = 0;
+  std::mt19937 random_;
+  std::unique_ptr<asio::steady_timer> timer_;
+  bool stopped_ = false;
+};
+
+const char* MembershipStateToString(const Membership::State state);
+
+Membership::State MembershipStateFromString(const std::string& state);
+
+}  // namespace vineyard
+
+#endif  // SRC_SERVER_UTIL_MEMBERSHIP_H_
@@ -17,7 +17,9 @@ limitations under the License.
 
 #include <fnmatch.h>
 
+#include <algorithm>
 #include <iostream>
+#include <iterator>
 #include <regex>
 #include <set>
 #include <string>
@@ -267,9 +269,9 @@ static bool is_meta_placeholder(const json& tree) {
  */
 Status GetData(const json& tree, const std::string& instance_name,
                const ObjectID id, json& sub_tree,
-               InstanceID const& current_instance_id) {
+               InstanceID const& current_instance_id, const bool lazy) {
   return GetData(tree, instance_name, VYObjectIDToString(id), sub_tree,
-                 current_instance_id);
+                 current_instance_id, lazy);
 }
 
 /**
@@ -277,7 +279,7 @@ Status GetData(const json& tree, const std::string& instance_name,
  */
 Status GetData(const json& tree, const std::string& instance_name,
                const std::string& name, json& sub_tree,
-               InstanceID const& current_instance_id) {
+               InstanceID const& current_instance_id, const bool lazy) {
   json tmp_tree;
   sub_tree.clear();
   Status status = get_sub_tree(tree, "/data", name, tmp_tree);
@@ -312,6 +314,24 @@ Status GetData(const json& tree, const std::string& instance_name,
         return status;
       }
       json sub_sub_tree;
+      if (lazy && !IsBlob(VYObjectIDFromString(sub_sub_tree_name))) {
+        // the member will be fetched on demand on the client side.
+        sub_sub_tree["id"] = sub_sub_tree_name;
+        sub_sub_tree["instance_id"] = instance_id;
+        auto path = json::json_pointer("/data/" + sub_sub_tree_name);
+        if (tree.contains(path)) {
+          auto const& member_tree = tree[path];
+          // the typename in the link has been shortened.
+          VINEYARD_SUPPRESS(get_type(member_tree, sub_sub_tree_type, true));
+          if (member_tree.contains("instance_id")) {
+            sub_sub_tree["instance_id"] = member_tree["instance_id"];
+          }
+        }
+        sub_sub_tree["typename"] = sub_sub_tree_type;
+        sub_sub_tree["lazy"] = true;
+        sub_tree[item.key()] = sub_sub_tree;
+        continue;
+      }
       status = GetData(tree, instance_name, sub_sub_tree_name, sub_sub_tree,
                        current_instance_id);
       if (status.ok()) {
@@ -341,7 +361,8 @@ Status GetData(const json& tree, const std::string& instance_name,
 }
 
 Status ListData(const json& tree, const std::string& instance_name,
-                std::string const& pattern, bool const regex,
+                const IMetaService::type_index_t& type_index,
+                const std::string& pattern, bool const regex,
                 size_t const limit, json& tree_group) {
   if (!tree.contains("data")) {
     return Status::OK();
@@ -357,17 +378,18 @@ Status ListData(const json& tree, const std::string& instance_name,
     } catch (std::regex_error const&) { return Status::OK(); }
   }
 
-  for (auto const& item : json::iterator_wrapper(tree["data"])) {
-    if (found >= limit) {
-      break;
-    }
+  // the literal prefix of a wildcard pattern narrows down the candidate types
+  std::string prefix;
+  if (!regex) {
+    prefix = pattern.substr(0, pattern.find_first_of("*?[\\"));
+  }
 
-    if (!item.value().is_object() || item.value().empty()) {
-      LOG(INFO) << "Object meta shouldn't be empty";
-      return Status::MetaTreeInvalid();
+  for (auto iter = type_index.lower_bound(prefix);
+       iter != type_index.end() && found < limit; ++iter) {
+    std::string const& type = iter->first;
+    if (type.compare(0, prefix.size(), prefix) != 0) {
+      break;
     }
-    std::string type;
-    RETURN_ON_ERROR(get_type(item.value(), type, true));
 
     // match type on pattern
     bool matched = false;
@@ -378,13 +400,155 @@ Status ListData(const json& tree, const std::string& instance_name,
       // https://www.man7.org/linux/man-pages/man3/fnmatch.3.html
       matched = fnmatch(pattern.c_str(), type.c_str(), 0) == 0;
     }
+    if (!matched) {
+      continue;
+    }
 
-    if (matched) {
+    for (auto const& name : iter->second) {
+      if (found >= limit) {
+        break;
+      }
       found += 1;
       json object_meta_tree;
-      RETURN_ON_ERROR(
-          GetData(tree, instance_name, item.key(), object_meta_tree));
-      tree_group[item.key()] = object_meta_tree;
+      RETURN_ON_ERROR(GetData(tree, instance_name, name, object_meta_tree));
+      tree_group[name] = object_meta_tree;
+    }
+  }
+  return Status::OK();
+}
+
+namespace {
+
+// matches the typename either by regex or by the wildcard pattern
+class type_matcher_t {
+ public:
+  type_matcher_t(const std::string& pattern, bool const regex)
+      : pattern_(pattern), regex_(regex) {
+    if (regex_) {
+      try {
+        regex_pattern_ = std::regex(pattern);
+      } catch (std::regex_error const&) { invalid_ = true; }
+    } else {
+      prefix_ = pattern.substr(0, pattern.find_first_of("*?[\\"));
+    }
+  }
+
+  bool valid() const { return !invalid_; }
+
+  // the literal prefix of the wildcard pattern
+  const std::string& prefix() const { return prefix_; }
+
+  bool operator()(const std::string& type) const {
+    if (regex_) {
+      std::cmatch __m;
+      return std::regex_match(type.c_str(), __m, regex_pattern_);
+    }
+    return fnmatch(pattern_.c_str(), type.c_str(), 0) == 0;
+  }
+
+ private:
+  std::string pattern_;
+  bool regex_;
+  bool invalid_ = false;
+  std::regex regex_pattern_;
+  std::string prefix_;
+};
+
+// the cursor of listing by types is "<typename>\n<id>"
+constexpr char kCursorSeparator = '\n';
+
+}  // namespace
+
+Status ListObjects(const json& tree, const std::string& instance_name,
+                   const IMetaService::type_index_t& type_index,
+                   const IMetaService::name_index_t& name_index,
+                   const IMetaService::object_names_t& object_names,
+                   const std::string& pattern, bool const regex,
+                   const std::string& name_prefix, const std::string& cursor,
+                   size_t const limit, bool const brief, json& objects,
+                   std::string& next_cursor) {
+  objects = json::array();
+  next_cursor.clear();
+  if (!tree.contains("data") || limit == 0) {
+    return Status::OK();
+  }
+  type_matcher_t matcher(pattern, regex);
+  if (!matcher.valid()) {
+    // for invalid regex pattern, return nothing.
+    return Status::OK();
+  }
+
+  auto emit = [&](const std::string& name, const std::string& type,
+                  const std::string* object_name) -> Status {
+    json item;
+    item["id"] = name;
+    item["typename"] = type;
+    if (object_name != nullptr) {
+      item["name"] = *object_name;
+    } else {
+      auto names = object_names.find(ObjectIDFromString(name));
+      if (names != object_names.end()) {
+        item["name"] = names->second;
+      }
+    }
+    if (!brief) {
+      RETURN_ON_ERROR(GetData(tree, instance_name, name, item["meta"]));
+    }
+    objects.push_back(std::move(item));
+    return Status::OK();
+  };
+
+  if (!name_prefix.empty()) {
+    // the names are ordered, thus a page costs O(log n + k) besides the
+    // names of objects that don't match the pattern.
+    auto iter = cursor.empty() ? name_index.lower_bound(name_prefix)
+                               : name_index.upper_bound(cursor);
+    for (; iter != name_index.end(); ++iter) {
+      if (iter->first.compare(0, name_prefix.size(), name_prefix) != 0) {
+        break;
+      }
+      std::string name = ObjectIDToString(iter->second);
+      std::string type;
+      if (!GetTypeName(tree, name, type).ok() || !matcher(type)) {
+        continue;
+      }
+      if (objects.size() >= limit) {
+        next_cursor = std::prev(iter)->first;
+        return Status::OK();
+      }
+      RETURN_ON_ERROR(emit(name, type, &iter->first));
+    }
+    return Status::OK();
+  }
+
+  std::string cursor_type, cursor_name;
+  if (!cursor.empty()) {
+    size_t loc = cursor.find(kCursorSeparator);
+    RETURN_ON_ASSERT(loc != std::string::npos, "Invalid cursor: " + cursor);
+    cursor_type = cursor.substr(0, loc);
+    cursor_name = cursor.substr(loc + 1);
+  }
+  std::string last_type, last_name;
+  auto iter = type_index.lower_bound(std::max(matcher.prefix(), cursor_type));
+  for (; iter != type_index.end(); ++iter) {
+    std::string const& type = iter->first;
+    if (type.compare(0, matcher.prefix().size(), matcher.prefix()) != 0) {
+      break;
+    }
+    if (!matcher(type)) {
+      continue;
+    }
+    auto name_iter = type == cursor_type
+                         ? iter->second.upper_bound(cursor_name)
+                         : iter->second.begin();
+    for (; name_iter != iter->second.end(); ++name_iter) {
+      if (objects.size() >= limit) {
+        next_cursor = last_type + kCursorSeparator + last_name;
+        return Status::OK();
+      }
+      RETURN_ON_ERROR(emit(*name_iter, type, nullptr));
+      last_type = type;
+      last_name = *name_iter;
     }
   }
   return Status::OK();
@@ -651,7 +815,8 @@ static Status diff_data_meta_tree(const json& meta,
     // means, we can only update member's meta, cannot update the whole member
     // itself.
     if (item.key() == "id" || item.key() == "signature" ||
-        item.key() == "typename" || item.key() == "instance_id") {
+        item.key() == "typename" || item.key() == "typeid" ||
+        item.key() == "instance_id") {
       continue;
     }
 
@@ -856,6 +1021,15 @@ Status Exists(const json& tree, const ObjectID id, bool& exists) {
   return Status::OK();
 }
 
+Status GetTypeName(const json& tree, const std::string& name,
+                   std::string& type) {
+  auto path = json::json_pointer("/data/" + name);
+  if (!tree.contains(path)) {
+    return Status::MetaTreeSubtreeNotExists("get subtree failed: " + name);
+  }
+  return get_type(tree[path], type, true);
+}
+
 Status ShallowCopyOps(const json& tree, const ObjectID id,
                       const json& extra_metadata, const ObjectID target,
                       std::vector<IMetaService::op_t>& ops, bool& transient) {
@@ -918,6 +1092,49 @@ Status FilterAtInstance(const json& tree, const InstanceID& instance_id,
   return Status::OK();
 }
 
+void CollectBlobs(const json& sub_tree, const InstanceID& instance_id,
+                  std::set<ObjectID>& blobs) {
+  for (auto const& item : json::iterator_wrapper(sub_tree)) {
+    if (!item.value().is_object() || item.value().empty()) {
+      continue;
+    }
+    const json& member = item.value();
+    if (member.value("typename", "") == "vineyard::Blob") {
+      if (member.value("instance_id", UnspecifiedInstanceID()) ==
+              instance_id &&
+          member.contains("id")) {
+        blobs.emplace(VYObjectIDFromString(
+            member["id"].get_ref<std::string const&>()));
+      }
+    } else {
+      CollectBlobs(member, instance_id, blobs);
+    }
+  }
+}
+
+void CollectLocality(const json& sub_tree, std::set<ObjectID>& visited,
+                     std::map<InstanceID, size_t>& locality) {
+  for (auto const& item : json::iterator_wrapper(sub_tree)) {
+    if (!item.value().is_object() || item.value().empty()) {
+      continue;
+    }
+    const json& member = item.value();
+    if (member.value("typename", "") == "vineyard::Blob") {
+      if (!member.contains("id")) {
+        continue;
+      }
+      ObjectID blob_id =
+          VYObjectIDFromString(member["id"].get_ref<std::string const&>());
+      if (visited.emplace(blob_id).second) {
+        locality[member.value("instance_id", UnspecifiedInstanceID())] +=
+            member.value("nbytes", static_cast<size_t>(0));
+      }
+    } else {
+      CollectLocality(member, visited, locality);
+    }
+  }
+}
+
 Status DecodeObjectID(const json& tree, const std::string& instance_name,
                       const std::string& value, ObjectID& object_id) {
   meta_tree::NodeType type;
@@ -972,6 +1189,28 @@ bool HasEquivalent(const json& tree, ObjectID const object_id,
   return false;
 }
 
+bool LocalEquivalent(const json& tree, const std::string& instance_name,
+                     ObjectID const object_id, ObjectID& equivalent) {
+  std::string object_name = ObjectIDToString(object_id);
+  auto path = json::json_pointer("/data/" + object_name + "/signature");
+  if (!tree.contains(path)) {
+    return false;
+  }
+  auto local = json::json_pointer(
+      "/signatures/" + instance_name + "/" +
+      SignatureToString(tree[path].get<Signature>()));
+  if (!tree.contains(local) || !tree[local].is_string()) {
+    return false;
+  }
+  std::string const& local_name = tree[local].get_ref<std::string const&>();
+  if (local_name == object_name ||
+      !tree.contains(json::json_pointer("/data/" + local_name))) {
+    return false;
+  }
+  equivalent = ObjectIDFromString(local_name);
+  return true;
+}
+
 }  // namespace meta_tree
 
 }  // namespace vineyard
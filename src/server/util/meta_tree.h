@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef SRC_SERVER_UTIL_META_TREE_H_
 #define SRC_SERVER_UTIL_META_TREE_H_
 
+#include <map>
 #include <memory>
 #include <set>
 #include <string>
@@ -33,18 +34,56 @@ enum class NodeType {
   InvalidType = 15,
 };
 
+/**
+ * @brief Get the metadata of an object recursively. When `lazy` is set, the
+ * members are not expanded but returned as stubs (with "id", "typename",
+ * "instance_id" and "lazy"), except the blobs.
+ */
 Status GetData(const json& tree, const std::string& instance_name,
                const ObjectID id, json& sub_tree,
-               InstanceID const& current_instance_id = UnspecifiedInstanceID());
+               InstanceID const& current_instance_id = UnspecifiedInstanceID(),
+               const bool lazy = false);
 Status GetData(const json& tree, const std::string& instance_name,
                const std::string& name, json& sub_tree,
-               InstanceID const& current_instance_id = UnspecifiedInstanceID());
+               InstanceID const& current_instance_id = UnspecifiedInstanceID(),
+               const bool lazy = false);
+/**
+ * @brief List objects whose typename matches the pattern. The typename index
+ * is used to match the pattern once per type, rather than once per object.
+ */
 Status ListData(const json& tree, const std::string& instance_name,
+                const IMetaService::type_index_t& type_index,
                 const std::string& pattern, bool const regex,
                 size_t const limit, json& tree_group);
+
+/**
+ * @brief List a page of objects whose typename matches the pattern, starting
+ * after the `cursor` (empty for the first page).
+ *
+ * When `name_prefix` is not empty, only the named objects under the prefix
+ * (e.g., "namespace/") are listed, in the order of names, otherwise objects
+ * are listed in the order of (typename, id). Each item is either the full
+ * metadata, or only the "id", "typename" and "name" (if any) when `brief`.
+ *
+ * The `next_cursor` is empty when there are no more pages.
+ */
+Status ListObjects(const json& tree, const std::string& instance_name,
+                   const IMetaService::type_index_t& type_index,
+                   const IMetaService::name_index_t& name_index,
+                   const IMetaService::object_names_t& object_names,
+                   const std::string& pattern, bool const regex,
+                   const std::string& name_prefix, const std::string& cursor,
+                   size_t const limit, bool const brief, json& objects,
+                   std::string& next_cursor);
 Status IfPersist(const json& tree, const ObjectID id, bool& persist);
 Status Exists(const json& tree, const ObjectID id, bool& exists);
 
+/**
+ * @brief Get the decoded typename of the object with the given name.
+ */
+Status GetTypeName(const json& tree, const std::string& name,
+                   std::string& type);
+
 Status PutDataOps(const json& tree, const std::string& instance_name,
                   const ObjectID id, const json& sub_tree,
                   std::vector<IMetaService::op_t>& ops,
@@ -72,12 +111,33 @@ Status ShallowCopyOps(const json& tree, const ObjectID id,
 Status FilterAtInstance(const json& tree, const InstanceID& instance_id,
                         std::vector<ObjectID>& objects);
 
+/**
+ * @brief Collect the blobs that located at the given instance from the
+ * resolved metadata tree (i.e., the result of `GetData`) of an object.
+ */
+void CollectBlobs(const json& sub_tree, const InstanceID& instance_id,
+                  std::set<ObjectID>& blobs);
+
+/**
+ * @brief Aggregate the bytes of blobs per instance from the resolved metadata
+ * tree of an object, the blobs that are shared by members count once.
+ */
+void CollectLocality(const json& sub_tree, std::set<ObjectID>& visited,
+                     std::map<InstanceID, size_t>& locality);
+
 Status DecodeObjectID(const json& tree, const std::string& instance_name,
                       const std::string& value, ObjectID& object_id);
 
 bool HasEquivalent(const json& tree, ObjectID const object_id,
                    ObjectID& equivalent);
 
+/**
+ * @brief Find the equivalent of the object (i.e., with the same signature)
+ * that is registered by the given instance, e.g., the replicas.
+ */
+bool LocalEquivalent(const json& tree, const std::string& instance_name,
+                     ObjectID const object_id, ObjectID& equivalent);
+
 }  // namespace meta_tree
 
 }  // namespace vineyard
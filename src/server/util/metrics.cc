@@ -0,0 +1,147 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+
+#include "server/util/metrics.h"
+
+#include <sstream>
+#include <utility>
+
+namespace vineyard {
+
+namespace metrics {
+
+uint64_t Counter::Value() const {
+  uint64_t value = 0;
+  for (auto const& cell : cells_) {
+    value += cell.value.load(std::memory_order_relaxed);
+  }
+  return value;
+}
+
+Registry& Registry::Default() {
+  static Registry registry;
+  return registry;
+}
+
+Registry::family_t& Registry::family(const std::string& name,
+                                     const std::string& help,
+                                     const type_t type) {
+  auto iter = families_.find(name);
+  if (iter == families_.end()) {
+    iter = families_.emplace(name, family_t()).first;
+    iter->second.type = type;
+    iter->second.help = help;
+  } else if (iter->second.type != type) {
+    LOG(ERROR) << "The metric '" << name << "' has been registered as "
+               << "another type";
+  }
+  return iter->second;
+}
+
+Counter& Registry::GetCounter(const std::string& name, const std::string& help,
+                              const std::string& labels) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto& counter = family(name, help, type_t::kCounter).counters[labels];
+  if (counter == nullptr) {
+    counter.reset(new Counter());
+  }
+  return *counter;
+}
+
+Histogram& Registry::GetHistogram(const std::string& name,
+                                  const std::string& help,
+                                  const std::string& labels) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto& histogram = family(name, help, type_t::kHistogram).histograms[labels];
+  if (histogram == nullptr) {
+    histogram.reset(new Histogram());
+  }
+  return *histogram;
+}
+
+void Registry::RegisterGauge(const std::string& name, const std::string& help,
+                             std::function<double()> collector,
+                             const std::string& labels) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  family(name, help, type_t::kGauge).gauges[labels] = std::move(collector);
+}
+
+// joins the labels of the metric and the extra label, e.g., `le="+Inf"`.
+static std::string join_labels(const std::string& labels,
+                               const std::string& extra = "") {
+  if (labels.empty() && extra.empty()) {
+    return "";
+  }
+  if (labels.empty() || extra.empty()) {
+    return "{" + labels + extra + "}";
+  }
+  return "{" + labels + "," + extra + "}";
+}
+
+std::string Registry::Render() const {
+  std::ostringstream os;
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (auto const& item : families_) {
+    auto const& name = item.first;
+    auto const& family = item.second;
+    os << "# HELP " << name << " " << family.help << "\n";
+    switch (family.type) {
+    case type_t::kCounter: {
+      os << "# TYPE " << name << " counter\n";
+      for (auto const& counter : family.counters) {
+        os << name << join_labels(counter.first) << " "
+           << counter.second->Value() << "\n";
+      }
+      break;
+    }
+    case type_t::kGauge: {
+      os << "# TYPE " << name << " gauge\n";
+      for (auto const& gauge : family.gauges) {
+        os << name << join_labels(gauge.first) << " " << gauge.second()
+           << "\n";
+      }
+      break;
+    }
+    case type_t::kHistogram: {
+      os << "# TYPE " << name << " histogram\n";
+      for (auto const& histogram : family.histograms) {
+        // n.b.: the buckets are read one by one, thus the snapshot may be
+        // slightly inconsistent under concurrent recording.
+        uint64_t count = 0;
+        for (size_t bucket = 0; bucket < Histogram::kBuckets; ++bucket) {
+          count += histogram.second->Count(bucket);
+          std::string le = bucket + 1 == Histogram::kBuckets
+                               ? "+Inf"
+                               : std::to_string(1ULL << bucket);
+          os << name << "_bucket"
+             << join_labels(histogram.first, "le=\"" + le + "\"") << " "
+             << count << "\n";
+        }
+        os << name << "_sum" << join_labels(histogram.first) << " "
+           << histogram.second->Sum() << "\n";
+        os << name << "_count" << join_labels(histogram.first) << " " << count
+           << "\n";
+      }
+      break;
+    }
+    }
+  }
+  return os.str();
+}
+
+}  // namespace metrics
+
+}  // namespace vineyard
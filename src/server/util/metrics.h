@@ -16,6 +16,15 @@ limitations under the License.
 #ifndef SRC_SERVER_UTIL_METRICS_H_
 #define SRC_SERVER_UTIL_METRICS_H_
 
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
 #include "common/util/logging.h"
 #include "server/util/spec_resolvers.h"
 
@@ -34,6 +43,138 @@ namespace vineyard {
                                  << (metric_name) << " " << (metric_val);
 #endif
 
+namespace metrics {
+
+/**
+ * @brief A monotonic counter. Increments from different threads go to
+ * different cache lines, and are summed up when being collected.
+ */
+class Counter {
+ public:
+  void Add(const uint64_t value = 1) {
+    cells_[cell()].value.fetch_add(value, std::memory_order_relaxed);
+  }
+
+  uint64_t Value() const;
+
+ private:
+  static constexpr size_t kCells = 16;
+
+  struct alignas(64) cell_t {
+    std::atomic<uint64_t> value{0};
+  };
+
+  // the cell of the calling thread, assigned in round-robin order
+  static size_t cell() {
+    static std::atomic<size_t> next{0};
+    thread_local size_t index =
+        next.fetch_add(1, std::memory_order_relaxed) % kCells;
+    return index;
+  }
+
+  cell_t cells_[kCells];
+};
+
+/**
+ * @brief A histogram of exponential buckets, i.e., the i-th bucket counts the
+ * values in (2^(i-1), 2^i], and the last one counts all larger values.
+ * Recording is two relaxed atomic increments.
+ */
+class Histogram {
+ public:
+  static constexpr size_t kBuckets = 48;
+
+  void Observe(const uint64_t value) {
+    buckets_[Bucket(value)].fetch_add(1, std::memory_order_relaxed);
+    sum_.fetch_add(value, std::memory_order_relaxed);
+  }
+
+  static size_t Bucket(const uint64_t value) {
+    if (value <= 1) {
+      return 0;
+    }
+    size_t index = 64 - __builtin_clzll(value - 1);
+    return index < kBuckets ? index : kBuckets - 1;
+  }
+
+  uint64_t Count(const size_t bucket) const {
+    return buckets_[bucket].load(std::memory_order_relaxed);
+  }
+
+  uint64_t Sum() const { return sum_.load(std::memory_order_relaxed); }
+
+ private:
+  std::atomic<uint64_t> buckets_[kBuckets] = {};
+  std::atomic<uint64_t> sum_{0};
+};
+
+/**
+ * @brief Observe the elapsed nanoseconds of the scope.
+ */
+class ScopedTimer {
+ public:
+  explicit ScopedTimer(Histogram& histogram)
+      : histogram_(histogram), start_(std::chrono::steady_clock::now()) {}
+
+  ~ScopedTimer() {
+    histogram_.Observe(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                           std::chrono::steady_clock::now() - start_)
+                           .count());
+  }
+
+ private:
+  Histogram& histogram_;
+  std::chrono::steady_clock::time_point start_;
+};
+
+/**
+ * @brief The registry of metrics, rendered in the prometheus text format. The
+ * metrics live as long as the registry, callers are expected to look up them
+ * once and keep the references, as the lookup takes a lock.
+ */
+class Registry {
+ public:
+  static Registry& Default();
+
+  /**
+   * @param labels The labels of the metric in the prometheus format, e.g.,
+   * `command="get_buffers_request"`.
+   */
+  Counter& GetCounter(const std::string& name, const std::string& help,
+                      const std::string& labels = "");
+
+  Histogram& GetHistogram(const std::string& name, const std::string& help,
+                          const std::string& labels = "");
+
+  /**
+   * @brief Register a gauge whose value is collected when rendering.
+   */
+  void RegisterGauge(const std::string& name, const std::string& help,
+                     std::function<double()> collector,
+                     const std::string& labels = "");
+
+  std::string Render() const;
+
+ private:
+  enum class type_t { kCounter, kGauge, kHistogram };
+
+  struct family_t {
+    type_t type;
+    std::string help;
+    std::map<std::string, std::unique_ptr<Counter>> counters;
+    std::map<std::string, std::unique_ptr<Histogram>> histograms;
+    std::map<std::string, std::function<double()>> gauges;
+  };
+
+  family_t& family(const std::string& name, const std::string& help,
+                   const type_t type);
+
+  mutable std::mutex mutex_;
+  std::map<std::string, family_t> families_;
+};
+
+}  // namespace metrics
+
 }  // namespace vineyard
 
 #endif  // SRC_SERVER_UTIL_METRICS_H_
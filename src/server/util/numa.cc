@@ -0,0 +1,182 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "server/util/numa.h"
+
+#include <dirent.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "gflags/gflags.h"
+
+DEFINE_bool(numa_aware, false,
+            "Keep one allocation arena per NUMA node, and place blobs on the "
+            "NUMA node of the requesting client");
+
+namespace vineyard {
+
+namespace numa {
+
+#if defined(__linux__)
+#ifndef MPOL_PREFERRED
+#define MPOL_PREFERRED 1
+#endif
+#ifndef MPOL_INTERLEAVE
+#define MPOL_INTERLEAVE 3
+#endif
+#endif
+
+// Find the largest index of entries named as "<prefix><index>" under the
+// given directory, -1 if there's no such entry.
+static int max_indexed_entry(const std::string& directory,
+                             const std::string& prefix) {
+  DIR* dir = opendir(directory.c_str());
+  if (dir == nullptr) {
+    return -1;
+  }
+  int index = -1;
+  struct dirent* entry = nullptr;
+  while ((entry = readdir(dir)) != nullptr) {
+    std::string name = entry->d_name;
+    if (name.size() > prefix.size() &&
+        name.compare(0, prefix.size(), prefix) == 0 &&
+        name.find_first_not_of("0123456789", prefix.size()) ==
+            std::string::npos) {
+      index = std::max(index, std::stoi(name.substr(prefix.size())));
+    }
+  }
+  closedir(dir);
+  return index;
+}
+
+bool Enabled() {
+  static bool enabled = FLAGS_numa_aware && NodeCount() > 1;
+  return enabled;
+}
+
+int NodeCount() {
+  static int count =
+      std::max(1, max_indexed_entry("/sys/devices/system/node", "node") + 1);
+  return count;
+}
+
+int NodeOfCPU(const int cpu) {
+  if (cpu < 0) {
+    return -1;
+  }
+  return max_indexed_entry(
+      "/sys/devices/system/cpu/cpu" + std::to_string(cpu), "node");
+}
+
+int NodeOfProcess(const pid_t pid) {
+  std::ifstream stat("/proc/" + std::to_string(pid) + "/stat");
+  std::string content;
+  if (!std::getline(stat, content)) {
+    return -1;
+  }
+  // the "comm" field may contains spaces, skip it first.
+  size_t loc = content.rfind(')');
+  if (loc == std::string::npos) {
+    return -1;
+  }
+  // "processor" is the 39-th field, and "state" (the 3rd one) is the first
+  // field after "comm".
+  std::istringstream fields(content.substr(loc + 1));
+  std::string field;
+  for (int index = 3; index <= 39; ++index) {
+    if (!(fields >> field)) {
+      return -1;
+    }
+  }
+  return NodeOfCPU(std::stoi(field));
+}
+
+int NodeOfPeer(const int socket_fd) {
+#if defined(__linux__) && defined(SO_PEERCRED)
+  struct ucred credentials;
+  socklen_t length = sizeof(credentials);
+  if (getsockopt(socket_fd, SOL_SOCKET, SO_PEERCRED, &credentials, &length) !=
+          0 ||
+      credentials.pid <= 0) {
+    return -1;
+  }
+  return NodeOfProcess(credentials.pid);
+#else
+  return -1;
+#endif
+}
+
+Status BindToNode(void* addr, const size_t size, const int node) {
+#if defined(__linux__) && defined(SYS_mbind)
+  if (node < 0 || node >= NodeCount()) {
+    return Status::Invalid("Invalid NUMA node: " + std::to_string(node));
+  }
+  static const size_t page_size = sysconf(_SC_PAGESIZE);
+  uintptr_t begin = reinterpret_cast<uintptr_t>(addr) / page_size * page_size;
+  uintptr_t end = (reinterpret_cast<uintptr_t>(addr) + size + page_size - 1) /
+                  page_size * page_size;
+  constexpr size_t bits = sizeof(unsigned long) * 8;  // NOLINT(runtime/int)
+  std::vector<unsigned long> mask(node / bits + 1, 0);  // NOLINT(runtime/int)
+  mask[node / bits] |= 1UL << (node % bits);
+  if (syscall(SYS_mbind, begin, end - begin, MPOL_PREFERRED, mask.data(),
+              mask.size() * bits + 1, 0) != 0) {
+    return Status::IOError("Failed to bind memory to NUMA node " +
+                           std::to_string(node) + ": " + strerror(errno));
+  }
+  return Status::OK();
+#else
+  return Status::NotImplemented("NUMA memory policy is not supported");
+#endif
+}
+
+Status Interleave(void* addr, const size_t size) {
+#if defined(__linux__) && defined(SYS_mbind)
+  int const nodes = NodeCount();
+  if (nodes <= 1) {
+    return Status::OK();
+  }
+  static const size_t page_size = sysconf(_SC_PAGESIZE);
+  uintptr_t begin = reinterpret_cast<uintptr_t>(addr) / page_size * page_size;
+  uintptr_t end = (reinterpret_cast<uintptr_t>(addr) + size + page_size - 1) /
+                  page_size * page_size;
+  constexpr size_t bits = sizeof(unsigned long) * 8;  // NOLINT(runtime/int)
+  std::vector<unsigned long> mask(nodes / bits + 1, 0);  // NOLINT(runtime/int)
+  for (int node = 0; node < nodes; ++node) {
+    mask[node / bits] |= 1UL << (node % bits);
+  }
+  if (syscall(SYS_mbind, begin, end - begin, MPOL_INTERLEAVE, mask.data(),
+              mask.size() * bits + 1, 0) != 0) {
+    return Status::IOError(
+        std::string("Failed to interleave memory across NUMA nodes: ") +
+        strerror(errno));
+  }
+  return Status::OK();
+#else
+  return Status::NotImplemented("NUMA memory policy is not supported");
+#endif
+}
+
+}  // namespace numa
+
+}  // namespace vineyard
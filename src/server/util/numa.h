@@ -0,0 +1,73 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef SRC_SERVER_UTIL_NUMA_H_
+#define SRC_SERVER_UTIL_NUMA_H_
+
+#include <sys/types.h>
+
+#include <cstddef>
+
+#include "common/util/status.h"
+
+namespace vineyard {
+
+namespace numa {
+
+/**
+ * @brief Whether the NUMA-aware allocation is enabled, i.e., the
+ * "--numa_aware" option is set and there are more than one NUMA nodes.
+ */
+bool Enabled();
+
+/**
+ * @brief The number of NUMA nodes on this host, 1 if NUMA is not supported.
+ */
+int NodeCount();
+
+/**
+ * @brief The NUMA node of the given CPU, -1 if unknown.
+ */
+int NodeOfCPU(const int cpu);
+
+/**
+ * @brief The NUMA node that the given process is running on (the node of the
+ * CPU it last ran on), -1 if unknown.
+ */
+int NodeOfProcess(const pid_t pid);
+
+/**
+ * @brief The NUMA node of the peer process of a UNIX domain socket, -1 if
+ * unknown (e.g., for TCP sockets).
+ */
+int NodeOfPeer(const int socket_fd);
+
+/**
+ * @brief Set the memory policy of the given address range to prefer the given
+ * NUMA node. Pages that have already been faulted in are kept untouched.
+ */
+Status BindToNode(void* addr, const size_t size, const int node);
+
+/**
+ * @brief Set the memory policy of the given address range to interleave the
+ * pages across all NUMA nodes.
+ */
+Status Interleave(void* addr, const size_t size);
+
+}  // namespace numa
+
+}  // namespace vineyard
+
+#endif  // SRC_SERVER_UTIL_NUMA_H_
@@ -0,0 +1,303 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "server/util/profiler.h"
+
+#include <execinfo.h>
+#include <signal.h>
+#include <sys/time.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#if defined(WITH_PROFILING)
+#include "gperftools/profiler.h"
+#endif
+
+#include "common/backtrace/backtrace.hpp"
+#include "common/util/env.h"
+#include "common/util/logging.h"
+
+namespace vineyard {
+
+namespace profiler {
+
+namespace {
+
+std::atomic_bool running{false};
+
+#if !defined(WITH_PROFILING)
+
+// the frames of the signal handler and the signal trampoline
+constexpr int kSkipFrames = 2;
+constexpr int kMaxDepth = 48;
+constexpr size_t kMaxSamples = 64 * 1024;
+constexpr size_t kMaxTopFunctions = 32;
+
+struct sample_t {
+  int depth = 0;
+  void* frames[kMaxDepth];
+};
+
+// n.b.: touched by the signal handler, hence only lock-free atomics.
+std::atomic<sample_t*> samples{nullptr};
+std::atomic<size_t> samples_capacity{0};
+std::atomic<size_t> samples_taken{0};
+std::atomic<int> handlers_inflight{0};
+
+void onSigprof(int, siginfo_t*, void*) {
+  int saved_errno = errno;
+  handlers_inflight.fetch_add(1);
+  sample_t* buffer = samples.load();
+  if (buffer != nullptr) {
+    size_t index = samples_taken.fetch_add(1, std::memory_order_relaxed);
+    if (index < samples_capacity.load(std::memory_order_relaxed)) {
+      buffer[index].depth = backtrace(buffer[index].frames, kMaxDepth);
+    }
+  }
+  handlers_inflight.fetch_sub(1);
+  errno = saved_errno;
+}
+
+Status installHandler() {
+  static std::once_flag installed;
+  static int error = 0;
+  std::call_once(installed, []() {
+    // warm up `backtrace`, which loads libgcc on the first call and is
+    // not safe to do so in the signal handler.
+    void* frames[kMaxDepth];
+    backtrace(frames, kMaxDepth);
+
+    // n.b.: the handler stays once installed, as a SIGPROF that is still
+    // pending after the session would terminate the process otherwise.
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_sigaction = onSigprof;
+    action.sa_flags = SA_RESTART | SA_SIGINFO;
+    sigemptyset(&action.sa_mask);
+    if (sigaction(SIGPROF, &action, nullptr) != 0) {
+      error = errno;
+    }
+  });
+  if (error != 0) {
+    return Status::IOError("Failed to install the SIGPROF handler: " +
+                           std::string(strerror(error)));
+  }
+  return Status::OK();
+}
+
+Status setTimer(const int64_t frequency) {
+  struct itimerval timer;
+  memset(&timer, 0, sizeof(timer));
+  if (frequency > 0) {
+    timer.it_interval.tv_sec = 0;
+    timer.it_interval.tv_usec = 1000000 / frequency;
+    timer.it_value = timer.it_interval;
+  }
+  if (setitimer(ITIMER_PROF, &timer, nullptr) != 0) {
+    return Status::IOError("Failed to set the profiling timer: " +
+                           std::string(strerror(errno)));
+  }
+  return Status::OK();
+}
+
+// e.g., "./vineyardd(_ZN8vineyard3fooEv+0x1a) [0x55d1c1e3a0ba]"
+std::string symbolize(const char* symbol) {
+  std::string entry(symbol);
+  size_t begin = entry.find('('), end = entry.find_first_of("+)", begin);
+  if (begin != std::string::npos && end != std::string::npos &&
+      end > begin + 1) {
+    std::unique_ptr<char, decltype(std::free)&> demangled{nullptr, std::free};
+    size_t demangled_size = 0;
+    std::string mangled = entry.substr(begin + 1, end - begin - 1);
+    return backtrace_info::get_demangled_name(mangled.c_str(), demangled,
+                                              demangled_size);
+  }
+  // not exported, identifies the frame by the module and the offset
+  size_t slash = entry.rfind('/', begin);
+  size_t start = slash == std::string::npos ? 0 : slash + 1;
+  return entry.substr(start, entry.find(" [") - start);
+}
+
+Status sample(const int64_t seconds, const int64_t frequency, json& result) {
+  RETURN_ON_ERROR(installHandler());
+
+  // the signals are issued by the CPU time of all threads in the process
+  size_t threads = std::max(1u, std::min(std::thread::hardware_concurrency(),
+                                         static_cast<unsigned>(16)));
+  size_t capacity = std::min(
+      static_cast<size_t>(seconds * frequency) * threads, kMaxSamples);
+  std::unique_ptr<sample_t[]> buffer(new sample_t[capacity]);
+  samples_taken.store(0);
+  samples_capacity.store(capacity);
+  samples.store(buffer.get());
+
+  auto start = std::chrono::steady_clock::now();
+  auto status = setTimer(frequency);
+  if (status.ok()) {
+    std::this_thread::sleep_for(std::chrono::seconds(seconds));
+    status = setTimer(0);
+  }
+  int64_t elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+                        std::chrono::steady_clock::now() - start)
+                        .count();
+  samples.store(nullptr);
+  while (handlers_inflight.load() > 0) {
+    std::this_thread::yield();
+  }
+  RETURN_ON_ERROR(status);
+
+  size_t taken = samples_taken.load();
+  size_t recorded = std::min(taken, capacity);
+  std::map<std::vector<void*>, size_t> stacks;
+  std::unordered_map<void*, std::string> symbols;
+  for (size_t index = 0; index < recorded; ++index) {
+    sample_t const& item = buffer[index];
+    if (item.depth <= kSkipFrames) {
+      continue;
+    }
+    // root first, as the folded stacks
+    std::vector<void*> stack(item.frames + kSkipFrames,
+                             item.frames + item.depth);
+    std::reverse(stack.begin(), stack.end());
+    for (void* frame : stack) {
+      symbols.emplace(frame, std::string());
+    }
+    stacks[std::move(stack)] += 1;
+  }
+
+  std::vector<void*> frames;
+  for (auto const& item : symbols) {
+    frames.emplace_back(item.first);
+  }
+  std::unique_ptr<char*, decltype(std::free)&> names{
+      backtrace_symbols(frames.data(), static_cast<int>(frames.size())),
+      std::free};
+  for (size_t index = 0; index < frames.size(); ++index) {
+    symbols[frames[index]] =
+        names ? symbolize(names.get()[index]) : std::to_string(
+            reinterpret_cast<uintptr_t>(frames[index]));
+  }
+
+  std::vector<std::pair<std::string, size_t>> folded;
+  std::unordered_map<std::string, size_t> self;
+  for (auto const& item : stacks) {
+    std::string line;
+    for (void* frame : item.first) {
+      if (!line.empty()) {
+        line.push_back(';');
+      }
+      line.append(symbols[frame]);
+    }
+    folded.emplace_back(std::move(line), item.second);
+    self[symbols[item.first.back()]] += item.second;
+  }
+  auto by_count = [](std::pair<std::string, size_t> const& lhs,
+                     std::pair<std::string, size_t> const& rhs) {
+    return lhs.second > rhs.second;
+  };
+  std::sort(folded.begin(), folded.end(), by_count);
+  std::vector<std::pair<std::string, size_t>> top(self.begin(), self.end());
+  std::sort(top.begin(), top.end(), by_count);
+
+  result["profiler"] = "sampling";
+  result["frequency"] = frequency;
+  result["elapsed_ms"] = elapsed;
+  result["samples"] = recorded;
+  result["dropped"] = taken - recorded;
+  json stacks_tree = json::array();
+  for (auto const& item : folded) {
+    stacks_tree.push_back(item.first + " " + std::to_string(item.second));
+  }
+  result["stacks"] = stacks_tree;
+  json top_tree = json::array();
+  for (size_t index = 0; index < std::min(top.size(), kMaxTopFunctions);
+       ++index) {
+    top_tree.push_back(
+        json{{"function", top[index].first}, {"samples", top[index].second}});
+  }
+  result["top"] = top_tree;
+  return Status::OK();
+}
+
+#endif  // WITH_PROFILING
+
+}  // namespace
+
+Status Profile(const int64_t seconds, const int64_t frequency,
+               const std::string& path, json& result) {
+  RETURN_ON_ASSERT(seconds > 0 && seconds <= kMaxSeconds,
+                   "The duration of profiling should be in (0, " +
+                       std::to_string(kMaxSeconds) + "] seconds");
+  RETURN_ON_ASSERT(frequency > 0 && frequency <= kMaxFrequency,
+                   "The frequency of profiling should be in (0, " +
+                       std::to_string(kMaxFrequency) + "] HZ");
+  bool expected = false;
+  if (!running.compare_exchange_strong(expected, true)) {
+    return Status::Invalid("Another profiling session is running");
+  }
+  LOG(INFO) << "Start profiling for " << seconds << " seconds";
+  Status status;
+#if defined(WITH_PROFILING)
+  std::string target = path;
+  if (target.empty()) {
+    const char* tmpdir = std::getenv("TMPDIR");
+    target = std::string(tmpdir == nullptr ? "/tmp" : tmpdir) +
+             "/vineyardd." + std::to_string(get_pid()) + "." +
+             std::to_string(std::chrono::duration_cast<std::chrono::seconds>(
+                                std::chrono::system_clock::now()
+                                    .time_since_epoch())
+                                .count()) +
+             ".prof";
+  }
+  // the SIGPROF is owned by gperftools, and the profile that is started with
+  // vineyardd (see `vineyardd.cc`) is stopped for the session.
+  ProfilerStop();
+  if (ProfilerStart(target.c_str())) {
+    std::this_thread::sleep_for(std::chrono::seconds(seconds));
+    ProfilerFlush();
+    ProfilerStop();
+    result["profiler"] = "gperftools";
+    result["path"] = target;
+  } else {
+    status = Status::IOError("Failed to start gperftools profiler to " +
+                             target);
+  }
+#else
+  static_cast<void>(path);  // only for gperftools
+  status = sample(seconds, frequency, result);
+#endif
+  running.store(false);
+  LOG(INFO) << "Finish profiling: " << status.ToString();
+  return status;
+}
+
+bool Running() { return running.load(); }
+
+}  // namespace profiler
+
+}  // namespace vineyard
@@ -0,0 +1,63 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef SRC_SERVER_UTIL_PROFILER_H_
+#define SRC_SERVER_UTIL_PROFILER_H_
+
+#include <cstdint>
+#include <string>
+
+#include "common/util/json.h"
+#include "common/util/status.h"
+
+namespace vineyard {
+
+namespace profiler {
+
+/**
+ * @brief Sample the call stacks of the threads that are consuming CPU in the
+ * running daemon for the given duration, and returns the profile.
+ *
+ * The samples are taken on SIGPROF (i.e., the CPU time of the process), and
+ * aggregated as folded stacks, i.e., "a;b;c <count>", that can be fed into
+ * flamegraph.pl directly. When vineyardd is built with gperftools
+ * (`BUILD_VINEYARD_PROFILING`), the session is served by gperftools instead
+ * and the path of the written profile is returned.
+ *
+ * Only one session can be running at the same time, and the calling thread
+ * is blocked until the session finishes.
+ *
+ * @param seconds The duration of the session, at most `kMaxSeconds`.
+ * @param frequency The sampling frequency in HZ, at most `kMaxFrequency`.
+ * @param path The destination of the gperftools profile, a file under the
+ *             temporary directory is used if empty.
+ */
+Status Profile(const int64_t seconds, const int64_t frequency,
+               const std::string& path, json& result);
+
+/**
+ * @brief Whether a profiling session is running.
+ */
+bool Running();
+
+constexpr int64_t kMaxSeconds = 300;
+constexpr int64_t kMaxFrequency = 1000;
+constexpr int64_t kDefaultFrequency = 99;
+
+}  // namespace profiler
+
+}  // namespace vineyard
+
+#endif  // SRC_SERVER_UTIL_PROFILER_H_
@@ -0,0 +1,99 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+
+#include "server/util/quota.h"
+
+#include <algorithm>
+
+namespace vineyard {
+
+Tenant::Tenant(const std::string& name, const Quota& quota)
+    : name_(name),
+      quota_(quota),
+      tokens_(std::max(quota.max_rate, 1.0)),
+      refilled_(std::chrono::steady_clock::now()) {}
+
+Status Tenant::Charge(const size_t size, const size_t objects) {
+  size_t bytes = bytes_.fetch_add(size) + size;
+  if (quota_.max_bytes > 0 && bytes > quota_.max_bytes) {
+    bytes_ -= size;
+    return Status::NotEnoughMemory(
+        "exceeds the memory quota of tenant '" + name_ + "': " +
+        std::to_string(bytes) + " > " + std::to_string(quota_.max_bytes));
+  }
+  size_t count = objects_.fetch_add(objects) + objects;
+  if (quota_.max_objects > 0 && count > quota_.max_objects) {
+    objects_ -= objects;
+    bytes_ -= size;
+    return Status::NotEnoughMemory(
+        "exceeds the object quota of tenant '" + name_ + "': " +
+        std::to_string(count) + " > " + std::to_string(quota_.max_objects));
+  }
+  return Status::OK();
+}
+
+void Tenant::Refund(const size_t size, const size_t objects) {
+  bytes_ -= size;
+  objects_ -= objects;
+}
+
+std::chrono::nanoseconds Tenant::Admit() {
+  if (quota_.max_rate <= 0) {
+    return std::chrono::nanoseconds(0);
+  }
+  std::lock_guard<std::mutex> lock(bucket_mutex_);
+  auto now = std::chrono::steady_clock::now();
+  double elapsed = std::chrono::duration<double>(now - refilled_).count();
+  refilled_ = now;
+  tokens_ = std::min(tokens_ + elapsed * quota_.max_rate,
+                     std::max(quota_.max_rate, 1.0));
+  tokens_ -= 1;
+  if (tokens_ >= 0) {
+    return std::chrono::nanoseconds(0);
+  }
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::duration<double>(-tokens_ / quota_.max_rate));
+}
+
+QuotaManager::QuotaManager(const Quota& quota)
+    : quota_(quota),
+      default_tenant_(std::make_shared<Tenant>("<default>", quota)) {}
+
+std::shared_ptr<Tenant> QuotaManager::Get(const std::string& name) {
+  if (name.empty()) {
+    return default_tenant_;
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto& entry = tenants_[name];
+  auto tenant = entry.lock();
+  if (tenant == nullptr) {
+    tenant = std::make_shared<Tenant>(name, quota_);
+    entry = tenant;
+  }
+  // drop the expired tenants occasionally
+  if (tenants_.size() > 1024) {
+    for (auto iter = tenants_.begin(); iter != tenants_.end();) {
+      if (iter->second.expired()) {
+        iter = tenants_.erase(iter);
+      } else {
+        ++iter;
+      }
+    }
+  }
+  return tenant;
+}
+
+}  // namespace vineyard
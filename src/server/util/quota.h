@@ -0,0 +1,117 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+
+#ifndef SRC_SERVER_UTIL_QUOTA_H_
+#define SRC_SERVER_UTIL_QUOTA_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "common/util/status.h"
+
+namespace vineyard {
+
+/**
+ * @brief The limits of every tenant, 0 means unlimited.
+ */
+struct Quota {
+  size_t max_bytes = 0;
+  size_t max_objects = 0;
+  // requests per second, a burst of the same size is allowed.
+  double max_rate = 0;
+
+  bool Unlimited() const {
+    return max_bytes == 0 && max_objects == 0 && max_rate <= 0;
+  }
+};
+
+/**
+ * @brief The blobs and the request rate of a tenant, i.e., the connections
+ * that register with the same tenant name. The connections that don't give
+ * a name share the default tenant.
+ */
+class Tenant {
+ public:
+  Tenant(const std::string& name, const Quota& quota);
+
+  const std::string& Name() const { return name_; }
+
+  /**
+   * @brief Charge the bytes and the number of blobs, fails without charging
+   * anything if the quota would be exceeded.
+   */
+  Status Charge(const size_t size, const size_t objects = 1);
+
+  void Refund(const size_t size, const size_t objects = 1);
+
+  /**
+   * @brief Admit a request, returns how long the request should be delayed
+   * to keep the rate of the tenant under the quota.
+   *
+   * Requests of a throttled tenant are delayed rather than rejected, and the
+   * delays are accumulated in arrival order, thus a flooding tenant doesn't
+   * take the IO threads from others.
+   */
+  std::chrono::nanoseconds Admit();
+
+  size_t Bytes() const { return bytes_.load(); }
+
+  size_t Objects() const { return objects_.load(); }
+
+ private:
+  const std::string name_;
+  const Quota quota_;
+  std::atomic<size_t> bytes_{0}, objects_{0};
+
+  // the token bucket of requests, tokens go negative when being throttled.
+  std::mutex bucket_mutex_;
+  double tokens_;
+  std::chrono::steady_clock::time_point refilled_;
+};
+
+/**
+ * @brief QuotaManager resolves the tenants of connections, the usages of a
+ * tenant are kept as long as its connections or blobs are alive.
+ */
+class QuotaManager {
+ public:
+  explicit QuotaManager(const Quota& quota);
+
+  bool Enabled() const { return !quota_.Unlimited(); }
+
+  /**
+   * @brief Get the tenant of the given name, the default tenant is returned
+   * for an empty name.
+   */
+  std::shared_ptr<Tenant> Get(const std::string& name);
+
+ private:
+  const Quota quota_;
+  // shared by the connections without a tenant name, thus they cannot get
+  // rid of the quotas by not registering with a name.
+  const std::shared_ptr<Tenant> default_tenant_;
+  std::mutex mutex_;  // protect `tenants_`
+  std::unordered_map<std::string, std::weak_ptr<Tenant>> tenants_;
+};
+
+}  // namespace vineyard
+
+#endif  // SRC_SERVER_UTIL_QUOTA_H_
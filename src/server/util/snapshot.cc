@@ -0,0 +1,213 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+
+#include "server/util/snapshot.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace vineyard {
+
+namespace snapshot {
+
+namespace detail {
+
+constexpr uint64_t kSnapshotMagic = 0x313050414e535956UL;  // "VYSNAP01"
+constexpr uint32_t kSnapshotVersion = 1;
+
+struct SnapshotHeader {
+  uint64_t magic;
+  uint32_t version;
+  uint32_t reserved;
+  uint64_t alignment;
+  uint64_t entries;
+  uint64_t table_offset;
+  uint64_t data_offset;
+  uint64_t file_size;
+};
+
+static inline uint64_t align_up(const uint64_t value,
+                                const uint64_t alignment) {
+  return (value + alignment - 1) / alignment * alignment;
+}
+
+static Status write_all(const int fd, const std::string& path,
+                        const uint8_t* data, const size_t size,
+                        const size_t offset) {
+  size_t written = 0;
+  while (written < size) {
+    ssize_t nbytes =
+        pwrite(fd, data + written, size - written, offset + written);
+    if (nbytes == -1) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return Status::IOError("Failed to write snapshot file '" + path +
+                             "': " + strerror(errno));
+    }
+    written += nbytes;
+  }
+  return Status::OK();
+}
+
+static Status read_all(const int fd, const std::string& path, uint8_t* data,
+                       const size_t size, const size_t offset) {
+  size_t nread = 0;
+  while (nread < size) {
+    ssize_t nbytes = pread(fd, data + nread, size - nread, offset + nread);
+    if (nbytes == -1 && errno == EINTR) {
+      continue;
+    }
+    if (nbytes <= 0) {
+      std::string message = nbytes == 0 ? "unexpected EOF" : strerror(errno);
+      return Status::IOError("Failed to read snapshot file '" + path +
+                             "': " + message);
+    }
+    nread += nbytes;
+  }
+  return Status::OK();
+}
+
+}  // namespace detail
+
+Status WriteSnapshot(const std::string& path,
+                     std::vector<SnapshotEntry>& entries,
+                     std::vector<const uint8_t*> const& data) {
+  if (entries.size() != data.size()) {
+    return Status::Invalid("The entries and blobs of snapshot are not match");
+  }
+  const uint64_t alignment = sysconf(_SC_PAGESIZE);
+  detail::SnapshotHeader header{};
+  header.magic = detail::kSnapshotMagic;
+  header.version = detail::kSnapshotVersion;
+  header.alignment = alignment;
+  header.entries = entries.size();
+  header.table_offset = alignment;
+  header.data_offset = detail::align_up(
+      header.table_offset + entries.size() * sizeof(SnapshotEntry), alignment);
+  uint64_t offset = header.data_offset;
+  for (auto& entry : entries) {
+    entry.offset = offset;
+    offset = detail::align_up(offset + entry.size, alignment);
+  }
+  header.file_size = offset;
+
+  std::string temporary = path + ".tmp";
+  int fd = open(temporary.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0600);
+  if (fd == -1) {
+    return Status::IOError("Failed to open snapshot file '" + temporary +
+                           "': " + strerror(errno));
+  }
+  auto write_snapshot = [&]() -> Status {
+    // the paddings are left as holes
+    if (ftruncate(fd, header.file_size) != 0) {
+      return Status::IOError("Failed to resize snapshot file '" + temporary +
+                             "': " + strerror(errno));
+    }
+    RETURN_ON_ERROR(detail::write_all(
+        fd, temporary, reinterpret_cast<const uint8_t*>(&header),
+        sizeof(header), 0));
+    RETURN_ON_ERROR(detail::write_all(
+        fd, temporary, reinterpret_cast<const uint8_t*>(entries.data()),
+        entries.size() * sizeof(SnapshotEntry), header.table_offset));
+    for (size_t index = 0; index < entries.size(); ++index) {
+      RETURN_ON_ERROR(detail::write_all(fd, temporary, data[index],
+                                        entries[index].size,
+                                        entries[index].offset));
+    }
+    if (fsync(fd) != 0) {
+      return Status::IOError("Failed to sync snapshot file '" + temporary +
+                             "': " + strerror(errno));
+    }
+    return Status::OK();
+  };
+  auto status = write_snapshot();
+  close(fd);
+  if (status.ok() && rename(temporary.c_str(), path.c_str()) != 0) {
+    status = Status::IOError("Failed to rename snapshot file '" + temporary +
+                             "': " + strerror(errno));
+  }
+  if (!status.ok()) {
+    unlink(temporary.c_str());
+  }
+  return status;
+}
+
+Status OpenSnapshot(const std::string& path, int& fd, uint8_t*& base,
+                    size_t& size, std::vector<SnapshotEntry>& entries) {
+  fd = open(path.c_str(), O_RDWR);
+  if (fd == -1) {
+    if (errno == ENOENT) {
+      return Status::ObjectNotExists("snapshot file '" + path + "'");
+    }
+    return Status::IOError("Failed to open snapshot file '" + path +
+                           "': " + strerror(errno));
+  }
+  auto open_snapshot = [&]() -> Status {
+    detail::SnapshotHeader header{};
+    RETURN_ON_ERROR(detail::read_all(fd, path,
+                                     reinterpret_cast<uint8_t*>(&header),
+                                     sizeof(header), 0));
+    if (header.magic != detail::kSnapshotMagic ||
+        header.version != detail::kSnapshotVersion) {
+      return Status::Invalid("'" + path + "' is not a valid snapshot file");
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 ||
+        static_cast<uint64_t>(st.st_size) != header.file_size) {
+      return Status::Invalid("The snapshot file '" + path +
+                             "' is truncated");
+    }
+    entries.resize(header.entries);
+    RETURN_ON_ERROR(detail::read_all(
+        fd, path, reinterpret_cast<uint8_t*>(entries.data()),
+        entries.size() * sizeof(SnapshotEntry), header.table_offset));
+    for (auto const& entry : entries) {
+      if (entry.offset < header.data_offset ||
+          entry.offset + entry.size > header.file_size) {
+        return Status::Invalid("The snapshot file '" + path +
+                               "' is corrupted");
+      }
+    }
+    size = header.file_size;
+    void* space =
+        mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (space == MAP_FAILED) {
+      return Status::IOError("Failed to mmap snapshot file '" + path +
+                             "': " + strerror(errno));
+    }
+    base = static_cast<uint8_t*>(space);
+    return Status::OK();
+  };
+  auto status = open_snapshot();
+  if (!status.ok()) {
+    close(fd);
+    fd = -1;
+  }
+  return status;
+}
+
+}  // namespace snapshot
+
+}  // namespace vineyard
@@ -0,0 +1,73 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+
+#ifndef SRC_SERVER_UTIL_SNAPSHOT_H_
+#define SRC_SERVER_UTIL_SNAPSHOT_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "common/util/status.h"
+#include "common/util/uuid.h"
+
+namespace vineyard {
+
+namespace snapshot {
+
+/**
+ * @brief The blobs in the snapshot file.
+ *
+ * The snapshot is laid out as an arena: a page of header, the table of
+ * entries, then the content of blobs, each of which starts at a page
+ * boundary of the file. Thus the file can be mmap-ed as is and the blobs are
+ * faulted in lazily from the page cache when being accessed.
+ */
+struct SnapshotEntry {
+  ObjectID object_id;
+  uint64_t offset;  // the offset in the snapshot file
+  uint64_t size;
+  uint64_t flags;
+};
+
+constexpr uint64_t kSnapshotPersisted = 1;
+
+/**
+ * @brief Write the blobs to the snapshot file. The file is written to a
+ * temporary file first, and renamed to `path` when finishes, thus the previous
+ * snapshot is left untouched on failures.
+ *
+ * The `offset` of entries will be filled.
+ */
+Status WriteSnapshot(const std::string& path,
+                     std::vector<SnapshotEntry>& entries,
+                     std::vector<const uint8_t*> const& data);
+
+/**
+ * @brief Map the snapshot file with `MAP_SHARED`, the `fd` is kept open to be
+ * passed to clients, and needs to be closed (as well as `munmap` the `base`)
+ * by the caller.
+ *
+ * @return `ObjectNotExists` if the snapshot file doesn't exist.
+ */
+Status OpenSnapshot(const std::string& path, int& fd, uint8_t*& base,
+                    size_t& size, std::vector<SnapshotEntry>& entries);
+
+}  // namespace snapshot
+
+}  // namespace vineyard
+
+#endif  // SRC_SERVER_UTIL_SNAPSHOT_H_
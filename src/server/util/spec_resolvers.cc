@@ -26,15 +26,88 @@ namespace vineyard {
 
 // meta data
 DEFINE_string(deployment, "local", "deployment mode: local, distributed");
+DEFINE_string(meta, "etcd",
+              "metadata backend: etcd, or local to keep the metadata inside "
+              "the vineyardd process for single-node deployments");
 DEFINE_string(etcd_endpoint, "http://127.0.0.1:2379", "endpoint of etcd");
 DEFINE_string(etcd_prefix, "vineyard", "path prefix in etcd");
 DEFINE_string(etcd_cmd, "", "path of etcd executable");
+DEFINE_string(etcd_snapshot, "",
+              "file to checkpoint the metadata to, for resuming from it with "
+              "an incremental sync after restarts, empty means disable");
+DEFINE_int64(etcd_snapshot_interval, 60,
+             "interval in seconds to checkpoint the metadata snapshot");
+DEFINE_bool(etcd_compact_values, false,
+            "store the metadata of objects in etcd as CBOR rather than JSON "
+            "text, requires all vineyardd instances understand it");
+DEFINE_string(membership, "etcd",
+              "how the failures of vineyardd instances are detected: etcd to "
+              "poll the heartbeat timestamps in etcd, or gossip to probe each "
+              "other over the RPC port");
+DEFINE_int64(gossip_interval, 1000,
+             "the protocol period (in milliseconds) of the gossip-based "
+             "membership");
+DEFINE_int64(etcd_compaction_retention, 100000,
+             "the number of revisions the etcd launched by vineyardd keeps "
+             "before compacting the history automatically, 0 means disable");
 // share memory
 DEFINE_string(size, "256Mi",
               "shared memory size for vineyardd, the format could be 1024M, "
               "1024000, 1G, or 1Gi");
 DEFINE_int64(stream_threshold, 80,
              "memory threshold of streams (percentage of total memory)");
+DEFINE_int64(stream_pool_depth, 4,
+             "number of drained chunks that each stream keeps for reusing, "
+             "0 means disable");
+DEFINE_string(spill_path, "",
+              "directory to spill cold, persisted blobs to when the shared "
+              "memory is exhausted, empty means disable spilling");
+DEFINE_bool(lru_eviction, false,
+            "reclaim blobs that are neither pinned by clients nor persisted in "
+            "LRU order when the shared memory is exhausted");
+DEFINE_int64(slab_max_size, 4096,
+             "blobs no larger than it (in bytes) are allocated from slabs of "
+             "size classes, 0 means disable");
+DEFINE_int64(compaction_interval, 0,
+             "relocate blobs to defragment the shared memory once vineyardd "
+             "has been idle for the given seconds, 0 means disable");
+DEFINE_double(compaction_threshold, 0.5,
+              "compact only when the fragmentation (1 - largest free block / "
+              "free size) exceeds the threshold");
+DEFINE_int64(dedup_min_size, 0,
+             "deduplicate the sealed blobs no smaller than it (in bytes) by "
+             "their contents, 0 means disable");
+DEFINE_bool(blob_checksum, false,
+            "compute the CRC32C of the sealed blobs, for verifying the "
+            "content of blobs fetched by remote clients");
+DEFINE_string(backing_store, "",
+              "directory (e.g., mounted from OSS or S3) to back the persisted "
+              "blobs, which are re-hydrated lazily after restarts, empty "
+              "means disable");
+DEFINE_int64(backing_store_chunk_size, 8 * 1024 * 1024,
+             "the size of chunks that blobs are split into in the backing "
+             "store, in bytes");
+DEFINE_int64(backing_store_concurrency, 4,
+             "the number of chunks that are written (or read) in parallel");
+DEFINE_string(snapshot_path, "",
+              "file to snapshot the persisted blobs to on shutdown, which is "
+              "mmap-ed to restore the blobs instantly on the next start, empty "
+              "means disable");
+// quotas of tenants, i.e., the clients that connect with the same
+// "VINEYARD_TENANT", or every single connection otherwise.
+DEFINE_string(tenant_quota_size, "",
+              "shared memory that each tenant can allocate, in the same format "
+              "as --size, empty means unlimited");
+DEFINE_int64(tenant_quota_objects, 0,
+             "the number of blobs that each tenant can keep, 0 means "
+             "unlimited");
+DEFINE_double(tenant_quota_rate, 0,
+              "requests per second of each tenant, the excess requests are "
+              "delayed, 0 means unlimited");
+DEFINE_int64(blob_table_size, 0,
+             "the number of blobs that can be published in the shared blob "
+             "table, which lets clients resolve the blobs without a round "
+             "trip, 0 means disable");
 // ipc
 DEFINE_string(socket, "/var/run/vineyard.sock", "IPC socket file location");
 // rpc
@@ -48,6 +121,19 @@ DEFINE_bool(prometheus, false,
             "Whether to print metrics for prometheus or not");
 DEFINE_bool(metrics, false,
             "Alias for --prometheus, and takes precedence over --prometheus");
+DEFINE_int32(metrics_port, 0,
+             "port to serve the metrics over HTTP (at '/metrics') for "
+             "prometheus to scrape, 0 means disable");
+// Tracing of requests
+DEFINE_int32(trace_capacity, 1024,
+             "the number of latest request traces to keep for dumping via the "
+             "debug command, 0 means disable the tracing");
+DEFINE_int64(slow_request_threshold, 1000,
+             "log the requests that take longer than the threshold, in "
+             "milliseconds, 0 means disable");
+DEFINE_int64(deferred_timeout, 0,
+             "fail the requests that wait for the objects (e.g., the blocking "
+             "get) after the timeout, in seconds, 0 means never");
 
 const Resolver& Resolver::get(std::string name) {
   static auto server_resolver = ServerSpecResolver();
@@ -74,9 +160,16 @@ const Resolver& Resolver::get(std::string name) {
 json EtcdSpecResolver::resolve() const {
   json spec;
   // FIXME: get from flags or env
+  spec["meta"] = FLAGS_meta;
   spec["prefix"] = FLAGS_etcd_prefix;
   spec["etcd_endpoint"] = FLAGS_etcd_endpoint;
   spec["etcd_cmd"] = FLAGS_etcd_cmd;
+  spec["snapshot"] = FLAGS_etcd_snapshot;
+  spec["snapshot_interval"] = FLAGS_etcd_snapshot_interval;
+  spec["compact_values"] = FLAGS_etcd_compact_values;
+  spec["compaction_retention"] = FLAGS_etcd_compaction_retention;
+  spec["membership"] = FLAGS_membership;
+  spec["gossip_interval"] = FLAGS_gossip_interval;
   return spec;
 }
 
@@ -85,6 +178,24 @@ json BulkstoreSpecResolver::resolve() const {
   size_t bulkstore_limit = parseMemoryLimit(FLAGS_size);
   spec["memory_size"] = bulkstore_limit;
   spec["stream_threshold"] = FLAGS_stream_threshold;
+  spec["stream_pool_depth"] = FLAGS_stream_pool_depth;
+  spec["spill_path"] = FLAGS_spill_path;
+  spec["lru_eviction"] = FLAGS_lru_eviction;
+  spec["slab_max_size"] = FLAGS_slab_max_size;
+  spec["compaction_interval"] = FLAGS_compaction_interval;
+  spec["compaction_threshold"] = FLAGS_compaction_threshold;
+  spec["dedup_min_size"] = FLAGS_dedup_min_size;
+  spec["blob_checksum"] = FLAGS_blob_checksum;
+  spec["backing_store"] = FLAGS_backing_store;
+  spec["backing_store_chunk_size"] = FLAGS_backing_store_chunk_size;
+  spec["backing_store_concurrency"] = FLAGS_backing_store_concurrency;
+  spec["snapshot_path"] = FLAGS_snapshot_path;
+  spec["tenant_quota_size"] = FLAGS_tenant_quota_size.empty()
+                                  ? 0
+                                  : parseMemoryLimit(FLAGS_tenant_quota_size);
+  spec["tenant_quota_objects"] = FLAGS_tenant_quota_objects;
+  spec["tenant_quota_rate"] = FLAGS_tenant_quota_rate;
+  spec["blob_table_size"] = FLAGS_blob_table_size;
   return spec;
 }
 
@@ -153,6 +264,10 @@ json ServerSpecResolver::resolve() const {
   spec["bulkstore_spec"] = Resolver::get("bulkstore").resolve();
   spec["ipc_spec"] = Resolver::get("ipcserver").resolve();
   spec["rpc_spec"] = Resolver::get("rpcserver").resolve();
+  spec["metrics_port"] = FLAGS_metrics_port;
+  spec["trace_capacity"] = FLAGS_trace_capacity;
+  spec["slow_request_threshold"] = FLAGS_slow_request_threshold;
+  spec["deferred_timeout"] = FLAGS_deferred_timeout;
   return spec;
 }
 
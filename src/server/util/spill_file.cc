@@ -0,0 +1,117 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "server/util/spill_file.h"
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <string>
+
+#include "boost/filesystem.hpp"
+
+namespace vineyard {
+
+namespace spill {
+
+Status InitSpillDirectory(const std::string& spill_path) {
+  boost::system::error_code ec;
+  boost::filesystem::create_directories(spill_path, ec);
+  if (ec) {
+    return Status::IOError("Failed to create the spill directory '" +
+                           spill_path + "': " + ec.message());
+  }
+  if (access(spill_path.c_str(), R_OK | W_OK) != 0) {
+    return Status::IOError("The spill directory '" + spill_path +
+                           "' is not accessible: " + strerror(errno));
+  }
+  return Status::OK();
+}
+
+std::string SpillFilePath(const std::string& spill_path,
+                          const ObjectID object_id) {
+  return spill_path + "/" + ObjectIDToString(object_id);
+}
+
+Status SpillToFile(const std::string& spill_path, const ObjectID object_id,
+                   const uint8_t* data, const size_t size) {
+  std::string path = SpillFilePath(spill_path, object_id);
+  int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0600);
+  if (fd == -1) {
+    return Status::IOError("Failed to open spill file '" + path +
+                           "': " + strerror(errno));
+  }
+  size_t offset = 0;
+  while (offset < size) {
+    ssize_t nbytes = write(fd, data + offset, size - offset);
+    if (nbytes == -1) {
+      if (errno == EINTR) {
+        continue;
+      }
+      std::string message = strerror(errno);
+      close(fd);
+      unlink(path.c_str());
+      return Status::IOError("Failed to write spill file '" + path +
+                             "': " + message);
+    }
+    offset += nbytes;
+  }
+  close(fd);
+  return Status::OK();
+}
+
+Status ReloadFromFile(const std::string& spill_path, const ObjectID object_id,
+                      uint8_t* data, const size_t size) {
+  std::string path = SpillFilePath(spill_path, object_id);
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd == -1) {
+    return Status::IOError("Failed to open spill file '" + path +
+                           "': " + strerror(errno));
+  }
+  size_t offset = 0;
+  while (offset < size) {
+    ssize_t nbytes = read(fd, data + offset, size - offset);
+    if (nbytes == -1 && errno == EINTR) {
+      continue;
+    }
+    if (nbytes <= 0) {
+      std::string message = nbytes == 0 ? "unexpected EOF" : strerror(errno);
+      close(fd);
+      return Status::IOError("Failed to read spill file '" + path +
+                             "': " + message);
+    }
+    offset += nbytes;
+  }
+  close(fd);
+  return Status::OK();
+}
+
+Status RemoveSpillFile(const std::string& spill_path,
+                       const ObjectID object_id) {
+  std::string path = SpillFilePath(spill_path, object_id);
+  if (unlink(path.c_str()) != 0 && errno != ENOENT) {
+    return Status::IOError("Failed to remove spill file '" + path +
+                           "': " + strerror(errno));
+  }
+  return Status::OK();
+}
+
+}  // namespace spill
+
+}  // namespace vineyard
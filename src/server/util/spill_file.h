@@ -0,0 +1,64 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef SRC_SERVER_UTIL_SPILL_FILE_H_
+#define SRC_SERVER_UTIL_SPILL_FILE_H_
+
+#include <string>
+
+#include "common/util/status.h"
+#include "common/util/uuid.h"
+
+namespace vineyard {
+
+namespace spill {
+
+/**
+ * @brief Prepare the directory that used to hold spilled blobs. The directory
+ * will be created if it doesn't exist.
+ */
+Status InitSpillDirectory(const std::string& spill_path);
+
+/**
+ * @brief The location of the spill file for the given blob.
+ */
+std::string SpillFilePath(const std::string& spill_path,
+                          const ObjectID object_id);
+
+/**
+ * @brief Write the content of a blob to its spill file, the existing file will
+ * be truncated.
+ */
+Status SpillToFile(const std::string& spill_path, const ObjectID object_id,
+                   const uint8_t* data, const size_t size);
+
+/**
+ * @brief Read the content of a previously spilled blob into `data`, which must
+ * have at least `size` bytes.
+ */
+Status ReloadFromFile(const std::string& spill_path, const ObjectID object_id,
+                      uint8_t* data, const size_t size);
+
+/**
+ * @brief Remove the spill file of the given blob, non-existing files will be
+ * ignored.
+ */
+Status RemoveSpillFile(const std::string& spill_path, const ObjectID object_id);
+
+}  // namespace spill
+
+}  // namespace vineyard
+
+#endif  // SRC_SERVER_UTIL_SPILL_FILE_H_
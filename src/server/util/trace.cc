@@ -0,0 +1,188 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+
+#include "server/util/trace.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <random>
+#include <sstream>
+
+#include "common/util/logging.h"
+
+namespace vineyard {
+
+namespace trace {
+
+namespace {
+
+std::string toHex(const uint64_t value) {
+  std::ostringstream ss;
+  ss << std::hex << std::setw(16) << std::setfill('0') << value;
+  return ss.str();
+}
+
+json intAttribute(const std::string& key, const int64_t value) {
+  // OTLP/JSON encodes 64-bit integers as strings
+  return json{{"key", key}, {"value", {{"intValue", std::to_string(value)}}}};
+}
+
+}  // namespace
+
+const char* PhaseName(const Phase phase) {
+  switch (phase) {
+  case Phase::kQueue:
+    return "queue";
+  case Phase::kHandle:
+    return "handle";
+  case Phase::kMetaWait:
+    return "meta_wait";
+  case Phase::kMeta:
+    return "meta";
+  case Phase::kEtcd:
+    return "etcd";
+  case Phase::kWrite:
+    return "write";
+  default:
+    return "unknown";
+  }
+}
+
+RequestTrace::RequestTrace(const int conn_id, std::string command,
+                           const steady_clock_t::time_point received)
+    : conn_id_(conn_id), command_(std::move(command)), received_(received) {
+  auto now = std::chrono::system_clock::now();
+  start_unix_nano_ =
+      std::chrono::duration_cast<std::chrono::nanoseconds>(
+          now.time_since_epoch() - (steady_clock_t::now() - received))
+          .count();
+  for (auto& phase : phases_) {
+    phase.store(0, std::memory_order_relaxed);
+  }
+}
+
+void RequestTrace::Done() {
+  if (pending_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+    Tracer::Default().finish(*this);
+  }
+}
+
+trace_ptr_t& Current() {
+  thread_local trace_ptr_t current;
+  return current;
+}
+
+Tracer& Tracer::Default() {
+  static Tracer tracer;
+  return tracer;
+}
+
+Tracer::Tracer() {
+  std::random_device device;
+  seed_ = (static_cast<uint64_t>(device()) << 32) | device();
+}
+
+void Tracer::Configure(const size_t capacity, const int64_t slow_threshold) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  records_.clear();
+  records_.resize(capacity);
+  finished_ = 0;
+  slow_threshold_.store(slow_threshold * 1000 * 1000);
+  enabled_.store(capacity > 0);
+}
+
+trace_ptr_t Tracer::Start(const int conn_id, std::string command,
+                          const steady_clock_t::time_point received) {
+  if (!Enabled()) {
+    return nullptr;
+  }
+  auto trace =
+      std::make_shared<RequestTrace>(conn_id, std::move(command), received);
+  trace->Add(Phase::kQueue, Since(received));
+  return trace;
+}
+
+void Tracer::finish(RequestTrace const& trace) {
+  int64_t duration = Since(trace.received_);
+  int64_t slow_threshold = slow_threshold_.load(std::memory_order_relaxed);
+  if (slow_threshold > 0 && duration >= slow_threshold) {
+    std::ostringstream ss;
+    for (int index = 0; index < static_cast<int>(Phase::kPhases); ++index) {
+      ss << " " << PhaseName(static_cast<Phase>(index)) << "="
+         << trace.phases_[index].load(std::memory_order_relaxed) / 1000
+         << "us";
+    }
+    LOG(WARNING) << "Slow request '" << trace.command_ << "' from connection "
+                 << trace.conn_id_ << " takes " << duration / 1000 << "us:"
+                 << ss.str();
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (records_.empty()) {
+    return;
+  }
+  record_t& record = records_[finished_ % records_.size()];
+  record.sequence = finished_++;
+  record.conn_id = trace.conn_id_;
+  record.command = trace.command_;
+  record.start_unix_nano = trace.start_unix_nano_;
+  record.duration = duration;
+  for (int index = 0; index < static_cast<int>(Phase::kPhases); ++index) {
+    record.phases[index] = trace.phases_[index].load(std::memory_order_relaxed);
+  }
+}
+
+void Tracer::Dump(const size_t limit, json& result) const {
+  json spans = json::array();
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    uint64_t count = std::min<uint64_t>(finished_, records_.size());
+    count = std::min<uint64_t>(count, limit);
+    for (uint64_t index = finished_ - count; index < finished_; ++index) {
+      record_t const& record = records_[index % records_.size()];
+      json attributes = json::array();
+      attributes.emplace_back(intAttribute("vineyard.conn_id", record.conn_id));
+      for (int phase = 0; phase < static_cast<int>(Phase::kPhases); ++phase) {
+        attributes.emplace_back(intAttribute(
+            std::string("vineyard.") + PhaseName(static_cast<Phase>(phase)) +
+                "_ns",
+            record.phases[phase]));
+      }
+      spans.emplace_back(json{
+          {"traceId", toHex(seed_) + toHex(record.sequence)},
+          {"spanId", toHex(seed_ ^ record.sequence)},
+          {"name", record.command},
+          {"kind", 2},  // SPAN_KIND_SERVER
+          {"startTimeUnixNano", std::to_string(record.start_unix_nano)},
+          {"endTimeUnixNano",
+           std::to_string(record.start_unix_nano + record.duration)},
+          {"attributes", attributes}});
+    }
+  }
+  json resource_attributes = json::array();
+  resource_attributes.emplace_back(
+      json{{"key", "service.name"}, {"value", {{"stringValue", "vineyardd"}}}});
+  result = json{
+      {"resourceSpans",
+       json::array({json{
+           {"resource", {{"attributes", resource_attributes}}},
+           {"scopeSpans", json::array({json{{"scope", {{"name", "vineyard"}}},
+                                            {"spans", spans}}})}}})}};
+}
+
+}  // namespace trace
+
+}  // namespace vineyard
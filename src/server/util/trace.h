@@ -0,0 +1,223 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+
+#ifndef SRC_SERVER_UTIL_TRACE_H_
+#define SRC_SERVER_UTIL_TRACE_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "common/util/json.h"
+
+namespace vineyard {
+
+namespace trace {
+
+using steady_clock_t = std::chrono::steady_clock;
+
+/**
+ * @brief The phases of handling a request, the "meta" phase includes the
+ * "etcd" phase when the task on the meta context waits for etcd.
+ */
+enum class Phase {
+  kQueue = 0,     // from the request header arrived to being dispatched
+  kHandle = 1,    // the dispatching in the IO thread
+  kMetaWait = 2,  // waiting in the queue of the meta context
+  kMeta = 3,      // running on the meta context
+  kEtcd = 4,      // waiting for the responses of etcd
+  kWrite = 5,     // from the reply being enqueued to been written
+  kPhases = 6,
+};
+
+const char* PhaseName(const Phase phase);
+
+inline int64_t Since(const steady_clock_t::time_point start) {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             steady_clock_t::now() - start)
+      .count();
+}
+
+/**
+ * @brief The trace of a request, shared by the callbacks that serve the
+ * request on different threads.
+ *
+ * The trace finishes when both the dispatching and the writing of the reply
+ * are done.
+ */
+class RequestTrace {
+ public:
+  RequestTrace(const int conn_id, std::string command,
+               const steady_clock_t::time_point received);
+
+  void Add(const Phase phase, const int64_t nanoseconds) {
+    phases_[static_cast<int>(phase)].fetch_add(nanoseconds,
+                                               std::memory_order_relaxed);
+  }
+
+  int64_t Get(const Phase phase) const {
+    return phases_[static_cast<int>(phase)].load(std::memory_order_relaxed);
+  }
+
+  // marks the reply has been enqueued.
+  void Replied() { replied_ = steady_clock_t::now(); }
+
+  steady_clock_t::time_point replied() const { return replied_; }
+
+  // marks one of the dispatching and the writing is done.
+  void Done();
+
+ private:
+  int conn_id_;
+  std::string command_;
+  steady_clock_t::time_point received_;
+  steady_clock_t::time_point replied_;
+  int64_t start_unix_nano_;
+  std::atomic<int64_t> phases_[static_cast<int>(Phase::kPhases)];
+  std::atomic<int> pending_{2};
+
+  friend class Tracer;
+};
+
+using trace_ptr_t = std::shared_ptr<RequestTrace>;
+
+/**
+ * @brief The trace of the request being served by the calling thread.
+ */
+trace_ptr_t& Current();
+
+/**
+ * @brief Make the given trace current in the scope.
+ */
+class Scope {
+ public:
+  explicit Scope(trace_ptr_t trace) : previous_(std::move(Current())) {
+    Current() = std::move(trace);
+  }
+
+  ~Scope() { Current() = std::move(previous_); }
+
+ private:
+  trace_ptr_t previous_;
+};
+
+/**
+ * @brief Dispatch the request in the scope, the time is recorded as the
+ * "handle" phase.
+ */
+class DispatchScope {
+ public:
+  explicit DispatchScope(trace_ptr_t trace)
+      : trace_(trace), scope_(trace), start_(steady_clock_t::now()) {}
+
+  ~DispatchScope() {
+    if (trace_) {
+      trace_->Add(Phase::kHandle, Since(start_));
+      trace_->Done();
+    }
+  }
+
+ private:
+  trace_ptr_t trace_;
+  Scope scope_;
+  steady_clock_t::time_point start_;
+};
+
+/**
+ * @brief Carry the current trace to the task that will be posted to the
+ * meta context, the time before the task runs is recorded as the
+ * "meta_wait" phase.
+ */
+template <typename F>
+std::function<void()> Wrap(F&& fn) {
+  trace_ptr_t trace = Current();
+  if (trace == nullptr) {
+    return std::function<void()>(std::forward<F>(fn));
+  }
+  auto posted = steady_clock_t::now();
+  return [trace, posted, fn = std::forward<F>(fn)]() mutable {
+    trace->Add(Phase::kMetaWait, Since(posted));
+    auto start = steady_clock_t::now();
+    Scope scope(trace);
+    fn();
+    trace->Add(Phase::kMeta, Since(start));
+  };
+}
+
+/**
+ * @brief Tracer keeps the finished traces in a fixed-size ring buffer, and
+ * logs the requests that take longer than the threshold.
+ */
+class Tracer {
+ public:
+  static Tracer& Default();
+
+  /**
+   * @param capacity The number of finished traces to keep, 0 means disable
+   * the tracing.
+   * @param slow_threshold The threshold of slow requests in milliseconds, 0
+   * means don't log the slow requests.
+   */
+  void Configure(const size_t capacity, const int64_t slow_threshold);
+
+  bool Enabled() const { return enabled_.load(std::memory_order_relaxed); }
+
+  // returns nullptr if the tracing is disabled.
+  trace_ptr_t Start(const int conn_id, std::string command,
+                    const steady_clock_t::time_point received);
+
+  /**
+   * @brief Dump the latest (up to `limit`) traces as OpenTelemetry spans, in
+   * the JSON encoding of OTLP.
+   */
+  void Dump(const size_t limit, json& result) const;
+
+ private:
+  Tracer();
+
+  void finish(RequestTrace const& trace);
+
+  struct record_t {
+    uint64_t sequence;
+    int conn_id;
+    std::string command;
+    int64_t start_unix_nano;
+    int64_t duration;
+    int64_t phases[static_cast<int>(Phase::kPhases)];
+  };
+
+  std::atomic_bool enabled_{false};
+  std::atomic<int64_t> slow_threshold_{0};  // in nanoseconds
+  uint64_t seed_;
+
+  mutable std::mutex mutex_;
+  std::vector<record_t> records_;
+  uint64_t finished_ = 0;
+
+  friend class RequestTrace;
+};
+
+}  // namespace trace
+
+}  // namespace vineyard
+
+#endif  // SRC_SERVER_UTIL_TRACE_H_
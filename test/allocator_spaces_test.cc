@@ -0,0 +1,153 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <deque>
+#include <memory>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "arrow/status.h"
+#include "arrow/util/io_util.h"
+#include "arrow/util/logging.h"
+
+#include "client/client.h"
+#include "client/ds/blob.h"
+#include "client/ds/object_meta.h"
+#include "common/util/logging.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+// the server runs with `--allocator_spaces=4`, see also `test/runner.py`,
+// i.e., the shared memory is carved into 4 spaces with their own locks.
+constexpr int kThreads = 8;
+constexpr int kRounds = 200;
+constexpr size_t kLiveBlobs = 16;
+constexpr size_t kFillBlobSize = 4 * 1024 * 1024;
+
+// larger than `--slab_max_size`, thus allocated from the spaces
+size_t SizeOf(int thread, int round) {
+  return 8 * 1024 + ((thread * 7919 + round * 104729) % 64) * 8 * 1024;
+}
+
+uint8_t ValueAt(int thread, int round, size_t i) {
+  return static_cast<uint8_t>(thread * 31 + round * 7 + i);
+}
+
+void CheckBlob(Client& client, ObjectID const id, int thread, int round) {
+  std::vector<std::shared_ptr<Blob>> blobs;
+  VINEYARD_CHECK_OK(client.GetBlobs({id}, blobs));
+  auto& blob = blobs[0];
+  CHECK_EQ(blob->size(), SizeOf(thread, round));
+  auto data = reinterpret_cast<const uint8_t*>(blob->data());
+  for (size_t i = 0; i < blob->size(); i += 509) {
+    CHECK_EQ(data[i], ValueAt(thread, round, i));
+  }
+  CHECK_EQ(data[blob->size() - 1], ValueAt(thread, round, blob->size() - 1));
+}
+
+// the clients (thus the IPC threads that serve them) allocate and free
+// concurrently, an overlapping of blobs from different spaces corrupts the
+// content of others.
+void Churn(std::string const& ipc_socket, int thread) {
+  Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+  std::deque<std::pair<ObjectID, int>> live;
+  for (int round = 0; round < kRounds; ++round) {
+    std::unique_ptr<BlobWriter> writer;
+    VINEYARD_CHECK_OK(client.CreateBlob(SizeOf(thread, round), writer));
+    auto data = reinterpret_cast<uint8_t*>(writer->data());
+    for (size_t i = 0; i < writer->size(); ++i) {
+      data[i] = ValueAt(thread, round, i);
+    }
+    live.emplace_back(writer->Seal(client)->id(), round);
+    if (live.size() > kLiveBlobs) {
+      CheckBlob(client, live.front().first, thread, live.front().second);
+      VINEYARD_CHECK_OK(client.DelData(live.front().first));
+      live.pop_front();
+    }
+  }
+  for (auto const& item : live) {
+    CheckBlob(client, item.first, thread, item.second);
+    VINEYARD_CHECK_OK(client.DelData(item.first));
+  }
+  client.Disconnect();
+}
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    printf("usage ./allocator_spaces_test <ipc_socket>");
+    return 1;
+  }
+  std::string ipc_socket = std::string(argv[1]);
+
+  Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+  LOG(INFO) << "Connected to IPCServer: " << ipc_socket;
+
+  std::shared_ptr<InstanceStatus> status;
+  VINEYARD_CHECK_OK(client.InstanceStatus(status));
+  size_t const base = status->memory_usage;
+  size_t const limit = status->memory_limit;
+
+  {
+    std::vector<std::thread> threads;
+    for (int thread = 0; thread < kThreads; ++thread) {
+      threads.emplace_back(Churn, ipc_socket, thread);
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+  }
+  VINEYARD_CHECK_OK(client.InstanceStatus(status));
+  CHECK_EQ(status->memory_usage, base);
+  LOG(INFO) << "Passed concurrent allocation tests...";
+
+  // a single client is bound to one space, and borrows from the other
+  // spaces once its own one is exhausted
+  {
+    std::vector<ObjectID> blobs;
+    while (true) {
+      std::unique_ptr<BlobWriter> writer;
+      if (!client.CreateBlob(kFillBlobSize, writer).ok()) {
+        break;
+      }
+      writer->data()[0] = static_cast<char>(blobs.size());
+      writer->data()[kFillBlobSize - 1] = static_cast<char>(blobs.size());
+      blobs.emplace_back(writer->Seal(client)->id());
+    }
+    LOG(INFO) << "Allocated " << blobs.size() << " blobs of " << kFillBlobSize
+              << " bytes, the limit is " << limit;
+    CHECK_GT(blobs.size() * kFillBlobSize, limit / 2);
+
+    std::vector<std::shared_ptr<Blob>> contents;
+    VINEYARD_CHECK_OK(client.GetBlobs(blobs, contents));
+    for (size_t index = 0; index < contents.size(); ++index) {
+      CHECK_EQ(contents[index]->data()[0], static_cast<char>(index));
+      CHECK_EQ(contents[index]->data()[kFillBlobSize - 1],
+               static_cast<char>(index));
+    }
+    contents.clear();
+    VINEYARD_CHECK_OK(client.DelData(blobs));
+  }
+  VINEYARD_CHECK_OK(client.InstanceStatus(status));
+  CHECK_EQ(status->memory_usage, base);
+  LOG(INFO) << "Passed allocator spaces tests...";
+
+  client.Disconnect();
+
+  return 0;
+}
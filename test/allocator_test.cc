@@ -15,11 +15,13 @@ limitations under the License.
 
 #include <sys/mman.h>
 
+#include <cstring>
 #include <fstream>
 #include <iostream>
 #include <memory>
 #include <string>
 #include <thread>
+#include <vector>
 
 #include "arrow/status.h"
 #include "arrow/util/io_util.h"
@@ -52,6 +54,45 @@ int main(int argc, char** argv) {
   void* p2 = allocator.Allocate(1026);
   allocator.Freeze(p2);
 
+  {
+    // threads allocate from their own caches
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 4; ++i) {
+      threads.emplace_back([&allocator]() {
+        for (int j = 0; j < 1024; ++j) {
+          void* pointer = allocator.Allocate(64 + j);
+          memset(pointer, 0xab, 64 + j);
+          allocator.Free(pointer);
+        }
+      });
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+  }
+
+  {
+    // the frozen blocks are available after flush, while the arena is alive
+    void* p3 = allocator.Allocate(4 * 1024 * 1024);
+    memset(p3, 0xcd, 4 * 1024 * 1024);
+    auto blob = allocator.Freeze(p3);
+    void* p4 = allocator.Allocate(2 * 1024 * 1024);
+    allocator.Free(p4);
+    VINEYARD_CHECK_OK(allocator.Flush());
+
+    auto fetched = std::dynamic_pointer_cast<Blob>(
+        client.GetObject(blob->id()));
+    CHECK(fetched != nullptr);
+    CHECK_GE(fetched->size(), 4 * 1024 * 1024);
+    CHECK_EQ(fetched->data()[4 * 1024 * 1024 - 1], '\xcd');
+
+    // frozen memory won't be freed
+    allocator.Free(p3);
+    void* p5 = allocator.Allocate(4 * 1024 * 1024);
+    CHECK_NE(p5, p3);
+    allocator.Free(p5);
+  }
+
   VINEYARD_CHECK_OK(allocator.Release());
 
   LOG(INFO) << "Passed allocator tests...";
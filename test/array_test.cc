@@ -16,6 +16,7 @@ limitations under the License.
 #include <memory>
 #include <string>
 #include <thread>
+#include <vector>
 
 #include "arrow/status.h"
 #include "arrow/util/io_util.h"
@@ -69,6 +70,50 @@ int main(int argc, char** argv) {
 
   LOG(INFO) << "Passed double array tests...";
 
+  {
+    // grows beyond the initial capacity several times
+    ResizableArrayBuilder<int64_t> resizable(client, 3);
+    for (int64_t i = 0; i < 100000; ++i) {
+      resizable.push_back(i);
+    }
+    CHECK_EQ(resizable.size(), 100003);
+    CHECK_GE(resizable.capacity(), resizable.size());
+    resizable.resize(100010, -1);
+    auto sealed = std::dynamic_pointer_cast<Array<int64_t>>(
+        resizable.Seal(client));
+    CHECK_EQ(sealed->size(), 100010);
+    for (size_t i = 0; i < 3; ++i) {
+      CHECK_EQ((*sealed)[i], 0);
+    }
+    for (size_t i = 3; i < 100003; ++i) {
+      CHECK_EQ((*sealed)[i], static_cast<int64_t>(i - 3));
+    }
+    for (size_t i = 100003; i < 100010; ++i) {
+      CHECK_EQ((*sealed)[i], -1);
+    }
+  }
+
+  {
+    // the deprecated `payload()` still works
+    ResizableArrayBuilder<int64_t> resizable(client);
+    for (int64_t i = 0; i < 100; ++i) {
+      resizable.push_back(i);
+    }
+    std::vector<int64_t>& payload = resizable.payload();
+    CHECK_EQ(payload.size(), 100);
+    payload.push_back(100);
+    resizable.push_back(101);
+    CHECK_EQ(resizable.size(), 102);
+    auto sealed = std::dynamic_pointer_cast<Array<int64_t>>(
+        resizable.Seal(client));
+    CHECK_EQ(sealed->size(), 102);
+    for (size_t i = 0; i < 102; ++i) {
+      CHECK_EQ((*sealed)[i], static_cast<int64_t>(i));
+    }
+  }
+
+  LOG(INFO) << "Passed resizable array tests...";
+
   client.Disconnect();
 
   return 0;
@@ -13,9 +13,11 @@ See the License for the specific language governing permissions and
 limitations under the License.
 */
 
+#include <algorithm>
 #include <memory>
 #include <string>
 #include <thread>
+#include <vector>
 
 #include "arrow/status.h"
 #include "arrow/stl.h"
@@ -454,6 +456,127 @@ int main(int argc, char** argv) {
 
     LOG(INFO) << "Passed Table wrapper tests...";
   }
+
+  {
+    LOG(INFO) << "#########  Table Statistics Test #############";
+    std::vector<std::shared_ptr<arrow::RecordBatch>> batches;
+    auto schema = arrow::schema(
+        {std::make_shared<arrow::Field>("f1", arrow::int64()),
+         std::make_shared<arrow::Field>("f2", arrow::utf8())});
+    for (int64_t i = 0; i < 3; ++i) {
+      arrow::Int64Builder value_builder;
+      arrow::StringBuilder string_builder;
+      std::shared_ptr<arrow::Array> array1, array2;
+      for (int64_t j = i * 100; j < (i + 1) * 100; j++) {
+        CHECK_ARROW_ERROR(value_builder.Append(j));
+        CHECK_ARROW_ERROR(string_builder.AppendNull());
+      }
+      CHECK_ARROW_ERROR(value_builder.Finish(&array1));
+      CHECK_ARROW_ERROR(string_builder.Finish(&array2));
+      batches.emplace_back(
+          arrow::RecordBatch::Make(schema, 100, {array1, array2}));
+    }
+    std::shared_ptr<arrow::Table> table;
+    VINEYARD_CHECK_OK(RecordBatchesToTable(batches, &table));
+    TableBuilder builder(client, table);
+    builder.SetStatistics(true);
+    auto r1 = std::dynamic_pointer_cast<Table>(builder.Seal(client));
+    CHECK(r1->GetTable()->Equals(*table));
+
+    auto stats = r1->batches()[1]->ColumnStatistics(0);
+    CHECK_EQ(stats["null_count"].get<int64_t>(), 0);
+    CHECK_EQ(stats["min"].get<int64_t>(), 100);
+    CHECK_EQ(stats["max"].get<int64_t>(), 199);
+    CHECK(!r1->batches()[1]->ColumnStatistics(1).contains("min"));
+
+    // the batches of the identical schema share one interned schema proxy
+    ObjectID schema_id =
+        r1->batches()[0]->meta().GetMemberMeta("schema_").GetId();
+    for (auto const& batch : r1->batches()) {
+      CHECK_EQ(batch->meta().GetMemberMeta("schema_").GetId(), schema_id);
+      CHECK(batch->schema()->Equals(*schema));
+    }
+
+    ObjectMeta meta;
+    VINEYARD_CHECK_OK(client.GetMetaData(r1->id(), meta));
+    CHECK(Table::SelectBatches(meta, 0, 150, 160) ==
+          std::vector<size_t>({1}));
+    CHECK(Table::SelectBatches(meta, 0, 199, 200) ==
+          std::vector<size_t>({1, 2}));
+    CHECK(Table::SelectBatches(meta, 0, json(), 50) ==
+          std::vector<size_t>({0}));
+    CHECK(Table::SelectBatches(meta, 0, 1000, json()).empty());
+    // the string column has only nulls
+    CHECK(Table::SelectBatches(meta, 1, "a", "z").empty());
+
+    // the statistics are kept after extending, and the existing columns are
+    // referred rather than copied
+    arrow::DoubleBuilder double_builder;
+    std::shared_ptr<arrow::Array> array3;
+    for (int64_t j = 0; j < 300; j++) {
+      CHECK_ARROW_ERROR(double_builder.Append(j * 0.5));
+    }
+    CHECK_ARROW_ERROR(double_builder.Finish(&array3));
+    TableExtender extender(client, r1);
+    VINEYARD_CHECK_OK(extender.AddColumn(client, "f3", array3));
+    auto r2 = std::dynamic_pointer_cast<Table>(extender.Seal(client));
+    CHECK_EQ(r2->num_columns(), 3);
+    CHECK_EQ(r2->batches()[2]->columns()[0]->id(),
+             r1->batches()[2]->columns()[0]->id());
+    CHECK_EQ(r2->batches()[2]->ColumnStatistics(0)["min"].get<int64_t>(),
+             200);
+    CHECK_EQ(r2->batches()[2]->ColumnStatistics(2)["max"].get<double>(),
+             149.5);
+    VINEYARD_CHECK_OK(client.GetMetaData(r2->id(), meta));
+    CHECK(Table::SelectBatches(meta, 2, 10.0, 20.0) ==
+          std::vector<size_t>({0}));
+
+    LOG(INFO) << "Passed Table statistics tests...";
+  }
+
+  {
+    LOG(INFO) << "#########  Scatter-gather Serialization Test #############";
+    arrow::Int64Builder value_builder;
+    arrow::StringBuilder string_builder;
+    std::shared_ptr<arrow::Array> array1, array2;
+    for (int64_t j = 0; j < 1000; j++) {
+      CHECK_ARROW_ERROR(value_builder.Append(j));
+      CHECK_ARROW_ERROR(string_builder.Append(std::to_string(j)));
+    }
+    CHECK_ARROW_ERROR(value_builder.Finish(&array1));
+    CHECK_ARROW_ERROR(string_builder.Finish(&array2));
+    auto schema = arrow::schema(
+        {std::make_shared<arrow::Field>("f1", arrow::int64()),
+         std::make_shared<arrow::Field>("f2", arrow::utf8())});
+    auto batch = arrow::RecordBatch::Make(schema, 1000, {array1, array2});
+
+    std::vector<std::shared_ptr<arrow::Buffer>> buffers;
+    VINEYARD_CHECK_OK(SerializeRecordBatchesToBuffers({batch}, &buffers));
+    // the column buffers are referred rather than copied
+    auto values = array1->data()->buffers[1];
+    CHECK(std::any_of(buffers.begin(), buffers.end(),
+                      [&values](std::shared_ptr<arrow::Buffer> const& buffer) {
+                        return buffer->data() == values->data();
+                      }));
+
+    std::shared_ptr<arrow::Buffer> stream, expected;
+#if defined(ARROW_VERSION) && ARROW_VERSION < 17000
+    CHECK_ARROW_ERROR(arrow::ConcatenateBuffers(
+        buffers, arrow::default_memory_pool(), &stream));
+#else
+    CHECK_ARROW_ERROR_AND_ASSIGN(
+        stream,
+        arrow::ConcatenateBuffers(buffers, arrow::default_memory_pool()));
+#endif
+    VINEYARD_CHECK_OK(SerializeRecordBatches({batch}, &expected));
+    CHECK(stream->Equals(*expected));
+
+    std::vector<std::shared_ptr<arrow::RecordBatch>> batches;
+    VINEYARD_CHECK_OK(DeserializeRecordBatches(stream, &batches));
+    CHECK_EQ(batches.size(), 1);
+    CHECK(batches[0]->Equals(*batch));
+    LOG(INFO) << "Passed scatter-gather serialization tests...";
+  }
   client.Disconnect();
 
   return 0;
@@ -0,0 +1,100 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <memory>
+#include <string>
+
+#include "arrow/api.h"
+#include "arrow/status.h"
+
+#include "basic/ds/arrow.h"
+#include "basic/ds/arrow_memory_pool.h"
+#include "client/client.h"
+#include "common/util/logging.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+std::shared_ptr<arrow::Int64Array> MakeArray(arrow::MemoryPool* pool,
+                                             const int64_t length) {
+  arrow::Int64Builder builder(pool);
+  for (int64_t i = 0; i < length; ++i) {
+    CHECK_ARROW_ERROR(builder.Append(i * 3));
+  }
+  std::shared_ptr<arrow::Int64Array> array;
+  CHECK_ARROW_ERROR(builder.Finish(&array));
+  return array;
+}
+
+void CheckArray(std::shared_ptr<arrow::Int64Array> const& expected,
+                std::shared_ptr<arrow::Int64Array> const& actual) {
+  CHECK_EQ(expected->length(), actual->length());
+  for (int64_t i = 0; i < expected->length(); ++i) {
+    CHECK_EQ(expected->Value(i), actual->Value(i));
+  }
+}
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    printf("usage ./arrow_memory_pool_test <ipc_socket>");
+    return 1;
+  }
+  std::string ipc_socket = std::string(argv[1]);
+
+  Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+  LOG(INFO) << "Connected to IPCServer: " << ipc_socket;
+
+  {
+    VineyardMemoryPool pool(client);
+    auto array = MakeArray(&pool, 100000);
+    CHECK_GT(pool.bytes_allocated(), 0);
+
+    NumericArrayBuilder<int64_t> builder(client, array);
+    auto sealed = std::dynamic_pointer_cast<NumericArray<int64_t>>(
+        builder.Seal(client));
+    // the values buffer is adopted as the blob, rather than copied
+    CHECK_EQ(sealed->GetArray()->values()->data(), array->values()->data());
+
+    auto fetched = std::dynamic_pointer_cast<NumericArray<int64_t>>(
+        client.GetObject(sealed->id()));
+    CheckArray(array, fetched->GetArray());
+    LOG(INFO) << "Passed blob memory pool tests...";
+  }
+
+#if defined(WITH_JEMALLOC)
+  {
+    VineyardArenaMemoryPool pool(client, 64 * 1024 * 1024);
+    auto array = MakeArray(&pool, 100000);
+
+    NumericArrayBuilder<int64_t> builder(client, array);
+    auto sealed = std::dynamic_pointer_cast<NumericArray<int64_t>>(
+        builder.Seal(client));
+    CHECK_EQ(sealed->GetArray()->values()->data(), array->values()->data());
+
+    // the frozen blobs are visible to the server after being released
+    VINEYARD_CHECK_OK(pool.Release());
+    auto fetched = std::dynamic_pointer_cast<NumericArray<int64_t>>(
+        client.GetObject(sealed->id()));
+    CheckArray(array, fetched->GetArray());
+    LOG(INFO) << "Passed arena memory pool tests...";
+  }
+#endif
+
+  LOG(INFO) << "Passed arrow memory pool tests...";
+
+  client.Disconnect();
+
+  return 0;
+}
@@ -0,0 +1,94 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+
+#include <cstring>
+#include <future>
+#include <memory>
+#include <string>
+#include <thread>
+#include <tuple>
+
+#include "arrow/status.h"
+#include "arrow/util/io_util.h"
+#include "arrow/util/logging.h"
+
+#include "client/async_client.h"
+#include "client/client.h"
+#include "client/ds/blob.h"
+#include "common/util/logging.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    printf("usage ./async_client_test <ipc_socket>");
+    return 1;
+  }
+  std::string ipc_socket = std::string(argv[1]);
+
+  Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+  LOG(INFO) << "Connected to IPCServer: " << ipc_socket;
+
+  // completes as futures
+  ObjectID blob_id = InvalidObjectID();
+  {
+    auto created = AsyncCreateBlob(client, 1024, asio::use_future).get();
+    VINEYARD_CHECK_OK(std::get<0>(created));
+    auto& writer = std::get<1>(created);
+    memset(writer->data(), 'x', writer->size());
+    blob_id = writer->Seal(client)->id();
+
+    auto fetched = AsyncGetObject(client, blob_id, asio::use_future).get();
+    VINEYARD_CHECK_OK(std::get<0>(fetched));
+    auto blob = std::dynamic_pointer_cast<Blob>(std::get<1>(fetched));
+    CHECK(blob != nullptr);
+    CHECK_EQ(blob->size(), 1024);
+    CHECK_EQ(blob->data()[1023], 'x');
+  }
+
+  // completes on the event loop
+  {
+    asio::io_context context;
+    std::thread::id handler_thread;
+    bool missed = false;
+    AsyncGetObject(client, GenerateObjectID(),
+                   asio::bind_executor(
+                       context, [&](Status status, std::shared_ptr<Object>) {
+                         CHECK(!status.ok());
+                         handler_thread = std::this_thread::get_id();
+                         missed = true;
+                       }));
+    // the outstanding work keeps the loop running until the completion
+    context.run();
+    CHECK(missed);
+    CHECK(handler_thread == std::this_thread::get_id());
+  }
+
+  // completes with plain callbacks
+  {
+    std::promise<Status> persisted;
+    AsyncPersist(client, blob_id,
+                 [&](Status status) { persisted.set_value(status); });
+    VINEYARD_CHECK_OK(persisted.get_future().get());
+  }
+
+  LOG(INFO) << "Passed async client tests...";
+
+  client.Disconnect();
+
+  return 0;
+}
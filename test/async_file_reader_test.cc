@@ -0,0 +1,132 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <cstring>
+#include <future>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "common/util/logging.h"
+#include "io/io/async_file_reader.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+// not a multiple of the page size, to cover the short read at the end
+constexpr size_t kFileSize = 4 * 1024 * 1024 + 123;
+constexpr size_t kChunkSize = 64 * 1024;
+
+std::string makeFile(std::vector<char>& content) {
+  char path[] = "/tmp/vineyard_async_file_reader_test_XXXXXX";
+  int fd = mkstemp(path);
+  CHECK_NE(fd, -1);
+  content.resize(kFileSize);
+  for (size_t idx = 0; idx < content.size(); ++idx) {
+    content[idx] = static_cast<char>(idx * 131 + idx / 4096);
+  }
+  size_t written = 0;
+  while (written < content.size()) {
+    ssize_t res = write(fd, content.data() + written, content.size() - written);
+    CHECK_GT(res, 0);
+    written += res;
+  }
+  close(fd);
+  return path;
+}
+
+void testReader(std::string const& path, std::vector<char> const& content,
+                const bool io_uring) {
+  AsyncFileReader reader(8, io_uring);
+  VINEYARD_CHECK_OK(reader.Open(path));
+  CHECK_EQ(reader.Size(), static_cast<int64_t>(kFileSize));
+  if (!io_uring) {
+    CHECK(!reader.UsingIOUring());
+  }
+  LOG(INFO) << "Reading with " << (reader.UsingIOUring() ? "io_uring" : "pread")
+            << " ...";
+
+  std::vector<char> buffer(kFileSize);
+  VINEYARD_CHECK_OK(reader.RegisterBuffers({{buffer.data(), buffer.size()}}));
+
+  // single read, into the registered buffer
+  {
+    int64_t nread = -1;
+    auto future = reader.ReadAsync(1000, buffer.data(), kChunkSize, &nread);
+    VINEYARD_CHECK_OK(future.get());
+    CHECK_EQ(nread, static_cast<int64_t>(kChunkSize));
+    CHECK_EQ(memcmp(buffer.data(), content.data() + 1000, kChunkSize), 0);
+  }
+
+  // short read at the end of file, into an unregistered buffer
+  {
+    std::vector<char> tail(kChunkSize);
+    int64_t nread = -1;
+    auto future =
+        reader.ReadAsync(kFileSize - 100, tail.data(), tail.size(), &nread);
+    VINEYARD_CHECK_OK(future.get());
+    CHECK_EQ(nread, 100);
+    CHECK_EQ(memcmp(tail.data(), content.data() + kFileSize - 100, 100), 0);
+
+    future = reader.ReadAsync(kFileSize + 100, tail.data(), tail.size(), &nread);
+    VINEYARD_CHECK_OK(future.get());
+    CHECK_EQ(nread, 0);
+  }
+
+  // the whole file in a batch, more requests than the queue depth
+  {
+    memset(buffer.data(), 0, buffer.size());
+    std::vector<AsyncFileReader::read_request_t> requests;
+    for (size_t offset = 0; offset < kFileSize; offset += kChunkSize) {
+      AsyncFileReader::read_request_t request;
+      request.offset = offset;
+      request.buffer = buffer.data() + offset;
+      request.size = std::min(kChunkSize, kFileSize - offset);
+      requests.emplace_back(request);
+    }
+    VINEYARD_CHECK_OK(reader.ReadBatch(requests));
+    for (auto const& request : requests) {
+      CHECK_EQ(request.nread, static_cast<int64_t>(request.size));
+    }
+    CHECK_EQ(memcmp(buffer.data(), content.data(), kFileSize), 0);
+  }
+
+  VINEYARD_CHECK_OK(reader.Close());
+
+  // reads after closing fail rather than hang
+  {
+    int64_t nread = -1;
+    auto future = reader.ReadAsync(0, buffer.data(), kChunkSize, &nread);
+    CHECK(!future.get().ok());
+  }
+}
+
+int main(int argc, char** argv) {
+  std::vector<char> content;
+  std::string path = makeFile(content);
+
+  testReader(path, content, true);
+  LOG(INFO) << "Passed the io_uring (if available) tests...";
+
+  testReader(path, content, false);
+  LOG(INFO) << "Passed the pread tests...";
+
+  unlink(path.c_str());
+  LOG(INFO) << "Passed async file reader tests...";
+  return 0;
+}
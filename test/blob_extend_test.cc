@@ -0,0 +1,111 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "arrow/status.h"
+#include "arrow/util/io_util.h"
+#include "arrow/util/logging.h"
+
+#include "client/client.h"
+#include "client/ds/blob.h"
+#include "client/ds/object_meta.h"
+#include "common/util/logging.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    printf("usage ./blob_extend_test <ipc_socket>");
+    return 1;
+  }
+  std::string ipc_socket = std::string(argv[1]);
+
+  Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+  LOG(INFO) << "Connected to IPCServer: " << ipc_socket;
+
+  std::unique_ptr<BlobWriter> writer;
+  VINEYARD_CHECK_OK(client.CreateBlob(1024, writer));
+  for (size_t i = 0; i < writer->size(); ++i) {
+    writer->data()[i] = static_cast<char>(i);
+  }
+  ObjectID writer_id = writer->id();
+  char* data = writer->data();
+
+  // growing in place depends on the layout of the allocator
+  auto status = writer->Extend(client, 4096);
+  if (status.ok()) {
+    CHECK_EQ(writer->size(), 4096);
+    CHECK_EQ(writer->id(), writer_id);
+    CHECK_EQ(writer->data(), data);
+    for (size_t i = 0; i < 1024; ++i) {
+      CHECK_EQ(writer->data()[i], static_cast<char>(i));
+    }
+    for (size_t i = 1024; i < writer->size(); ++i) {
+      writer->data()[i] = static_cast<char>(i);
+    }
+  } else {
+    CHECK(status.IsNotEnoughMemory());
+    CHECK_EQ(writer->size(), 1024);
+  }
+  // shrinking is not allowed
+  CHECK(!writer->Extend(client, 16).ok());
+
+  size_t size = writer->size();
+  auto blob = std::dynamic_pointer_cast<Blob>(writer->Seal(client));
+  CHECK_EQ(blob->allocated_size(), size);
+  CHECK(writer->Extend(client, size * 2).IsObjectSealed());
+  LOG(INFO) << "Passed blob extend tests...";
+
+  {
+    // only the creator can extend the blob
+    std::unique_ptr<BlobWriter> unsealed;
+    VINEYARD_CHECK_OK(client.CreateBlob(1024, unsealed));
+    Client other;
+    VINEYARD_CHECK_OK(other.Connect(ipc_socket));
+    CHECK(unsealed->Extend(other, 4096).IsInvalid());
+    CHECK_EQ(unsealed->size(), 1024);
+    other.Disconnect();
+    VINEYARD_CHECK_OK(unsealed->Abort(client));
+  }
+  LOG(INFO) << "Passed blob extend ownership tests...";
+
+  {
+    std::unique_ptr<BlobWriter> copied;
+    VINEYARD_CHECK_OK(client.CopyBlob(blob->id(), copied));
+    CHECK(copied->id() != blob->id());
+    CHECK_EQ(copied->size(), size);
+    for (size_t i = 0; i < size; ++i) {
+      CHECK_EQ(copied->data()[i], static_cast<char>(i));
+    }
+    copied->data()[0] = 'x';
+    auto modified = std::dynamic_pointer_cast<Blob>(copied->Seal(client));
+    CHECK_EQ(modified->data()[0], 'x');
+    CHECK_EQ(blob->data()[0], static_cast<char>(0));
+
+    status = client.CopyBlob(GenerateBlobID(reinterpret_cast<void*>(0x1)),
+                             copied);
+    CHECK(status.IsObjectNotExists());
+  }
+  LOG(INFO) << "Passed blob copy tests...";
+
+  client.Disconnect();
+
+  return 0;
+}
@@ -0,0 +1,130 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <memory>
+#include <string>
+
+#include "client/client.h"
+#include "client/ds/blob.h"
+#include "common/util/logging.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    printf("usage ./blob_from_file_test <ipc_socket>");
+    return 1;
+  }
+  std::string ipc_socket = std::string(argv[1]);
+
+  Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+  LOG(INFO) << "Connected to IPCServer: " << ipc_socket;
+
+  std::string path =
+      "/tmp/blob_from_file_test." + std::to_string(getpid()) + ".bin";
+  const size_t file_size = 3 * 4096 + 17;
+  {
+    FILE* fp = fopen(path.c_str(), "wb");
+    CHECK(fp != nullptr);
+    for (size_t i = 0; i < file_size; ++i) {
+      fputc(static_cast<char>(i % 251), fp);
+    }
+    fclose(fp);
+  }
+
+  {
+    std::shared_ptr<Blob> blob;
+    VINEYARD_CHECK_OK(client.CreateBlobFromFile(path, 0, -1, blob));
+    CHECK_EQ(blob->size(), file_size);
+    for (size_t i = 0; i < file_size; ++i) {
+      CHECK_EQ(blob->data()[i], static_cast<char>(i % 251));
+    }
+
+    // the same range resolves to the same blob
+    std::shared_ptr<Blob> again;
+    VINEYARD_CHECK_OK(client.CreateBlobFromFile(path, 0, -1, again));
+    CHECK_EQ(again->id(), blob->id());
+
+    // unaligned ranges, and ranges that start at the same offset
+    std::shared_ptr<Blob> part, prefix;
+    VINEYARD_CHECK_OK(client.CreateBlobFromFile(path, 4099, 5000, part));
+    VINEYARD_CHECK_OK(client.CreateBlobFromFile(path, 0, 100, prefix));
+    CHECK_EQ(part->size(), 5000);
+    CHECK_EQ(prefix->size(), 100);
+    CHECK(prefix->id() != blob->id());
+    for (size_t i = 0; i < part->size(); ++i) {
+      CHECK_EQ(part->data()[i], static_cast<char>((4099 + i) % 251));
+    }
+
+    // the blobs can be fetched by other clients
+    Client other;
+    VINEYARD_CHECK_OK(other.Connect(ipc_socket));
+    auto fetched = other.GetObject<Blob>(part->id());
+    CHECK(fetched != nullptr);
+    CHECK_EQ(fetched->size(), 5000);
+    CHECK_EQ(fetched->data()[0], static_cast<char>(4099 % 251));
+    other.Disconnect();
+
+    VINEYARD_CHECK_OK(
+        client.DelData({blob->id(), part->id(), prefix->id()}));
+    LOG(INFO) << "Passed blob from file tests...";
+  }
+
+  {
+    std::shared_ptr<Blob> blob;
+    CHECK(!client.CreateBlobFromFile(path, file_size - 10, 11, blob).ok());
+    CHECK(!client.CreateBlobFromFile(path + ".missing", 0, -1, blob).ok());
+    CHECK(!client.CreateBlobFromFile("/tmp", 0, -1, blob).ok());
+    if (getuid() != 0) {
+      // files that the client cannot read are rejected, even if the server
+      // is able to read them
+      CHECK_EQ(chmod(path.c_str(), 0), 0);
+      CHECK(!client.CreateBlobFromFile(path, 0, -1, blob).ok());
+      CHECK_EQ(chmod(path.c_str(), 0644), 0);
+    }
+    LOG(INFO) << "Passed invalid blob from file tests...";
+  }
+
+  {
+    // truncating the file doesn't crash the server on prefetching
+    std::shared_ptr<Blob> blob;
+    VINEYARD_CHECK_OK(client.CreateBlobFromFile(path, 4096, 8192, blob));
+    CHECK_EQ(truncate(path.c_str(), 100), 0);
+    size_t nbytes = 0;
+    VINEYARD_CHECK_OK(client.Prefetch({blob->id()}, nbytes));
+    CHECK_EQ(nbytes, 8192);
+    VINEYARD_CHECK_OK(client.DelData({blob->id()}));
+
+    // the mappings are released with the blobs, and a changed file is
+    // mapped again
+    std::shared_ptr<Blob> part;
+    VINEYARD_CHECK_OK(client.CreateBlobFromFile(path, 0, 100, part));
+    CHECK_EQ(part->size(), 100);
+    CHECK_EQ(part->data()[99], static_cast<char>(99 % 251));
+    VINEYARD_CHECK_OK(client.DelData({part->id()}));
+    LOG(INFO) << "Passed truncated blob from file tests...";
+  }
+
+  unlink(path.c_str());
+  client.Disconnect();
+
+  LOG(INFO) << "Passed blob from file tests...";
+  return 0;
+}
@@ -0,0 +1,143 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <chrono>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "arrow/status.h"
+#include "arrow/util/io_util.h"
+#include "arrow/util/logging.h"
+
+#include "basic/ds/array.h"
+#include "client/client.h"
+#include "client/ds/object_meta.h"
+#include "common/util/logging.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+// the test runs twice, against the server before and after a restart, with
+// the same `--backing_store` or `--snapshot_path`, see also `test/runner.py`:
+// the first run persists the blobs and records their ids into the `ids_file`,
+// and the second run gets the blobs back by the ids.
+//
+// the sizes span several chunks of `--backing_store_chunk_size=256Ki`.
+const std::vector<size_t> kArraySizes = {64 * 1024, 256 * 1024,
+                                         1024 * 1024 + 123, 3 * 1024 * 1024};
+
+uint8_t ValueAt(size_t index, size_t i) {
+  return static_cast<uint8_t>(i * 7 + index);
+}
+
+std::shared_ptr<InstanceStatus> GetStatus(Client& client) {
+  std::shared_ptr<InstanceStatus> status;
+  VINEYARD_CHECK_OK(client.InstanceStatus(status));
+  return status;
+}
+
+void Persist(Client& client, const std::string& ids_file, bool snapshot) {
+  std::ofstream ids(ids_file);
+  for (size_t index = 0; index < kArraySizes.size(); ++index) {
+    std::vector<uint8_t> data(kArraySizes[index]);
+    for (size_t i = 0; i < data.size(); ++i) {
+      data[i] = ValueAt(index, i);
+    }
+    ArrayBuilder<uint8_t> builder(client, data);
+    auto array = builder.Seal(client);
+    VINEYARD_CHECK_OK(client.Persist(array->id()));
+    ids << array->meta().GetMemberMeta("buffer_").GetId() << std::endl;
+  }
+
+  // the snapshot is written when the server stops
+  if (snapshot) {
+    return;
+  }
+  // the blobs are uploaded in background, waits before the server stops
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(60);
+  while (GetStatus(client)->uploaded_objects < kArraySizes.size()) {
+    CHECK(std::chrono::steady_clock::now() < deadline);
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  }
+}
+
+void Restore(Client& client, const std::string& ids_file, bool snapshot) {
+  std::vector<ObjectID> ids;
+  std::ifstream input(ids_file);
+  ObjectID id = InvalidObjectID();
+  while (input >> id) {
+    ids.emplace_back(id);
+  }
+  CHECK_EQ(ids.size(), kArraySizes.size());
+
+  // the snapshot is mapped on start, otherwise nothing is in the shared
+  // memory after the restart
+  CHECK_EQ(GetStatus(client)->hydrated_objects, 0);
+  CHECK_EQ(GetStatus(client)->snapshot_objects,
+           snapshot ? kArraySizes.size() : 0);
+
+  std::vector<std::shared_ptr<Blob>> blobs;
+  VINEYARD_CHECK_OK(client.GetBlobs(ids, blobs));
+  CHECK_EQ(blobs.size(), ids.size());
+  for (size_t index = 0; index < blobs.size(); ++index) {
+    CHECK_EQ(blobs[index]->id(), ids[index]);
+    CHECK_EQ(blobs[index]->size(), kArraySizes[index]);
+    auto data = reinterpret_cast<const uint8_t*>(blobs[index]->data());
+    for (size_t i = 0; i < kArraySizes[index]; ++i) {
+      CHECK_EQ(data[i], ValueAt(index, i));
+    }
+  }
+  CHECK_EQ(GetStatus(client)->hydrated_objects,
+           snapshot ? 0 : kArraySizes.size());
+  if (snapshot) {
+    return;
+  }
+
+  // the hydrated blobs stay in the shared memory
+  blobs.clear();
+  VINEYARD_CHECK_OK(client.GetBlobs(ids, blobs));
+  CHECK_EQ(GetStatus(client)->hydrated_objects, kArraySizes.size());
+}
+
+int main(int argc, char** argv) {
+  if (argc < 4) {
+    printf(
+        "usage ./blob_restore_test <ipc_socket> <persist|restore> "
+        "<ids_file> [backing_store|snapshot]");
+    return 1;
+  }
+  std::string ipc_socket = std::string(argv[1]);
+  std::string mode = std::string(argv[2]);
+  std::string ids_file = std::string(argv[3]);
+  bool snapshot = argc > 4 && std::string(argv[4]) == "snapshot";
+
+  Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+  LOG(INFO) << "Connected to IPCServer: " << ipc_socket;
+
+  if (mode == "persist") {
+    Persist(client, ids_file, snapshot);
+    LOG(INFO) << "Passed blob persist tests...";
+  } else {
+    Restore(client, ids_file, snapshot);
+    LOG(INFO) << "Passed blob restore tests...";
+  }
+
+  client.Disconnect();
+
+  return 0;
+}
@@ -0,0 +1,164 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <thread>
+
+#include "arrow/status.h"
+#include "arrow/util/io_util.h"
+#include "arrow/util/logging.h"
+
+#include "client/client.h"
+#include "client/ds/blob.h"
+#include "common/memory/blob_table.h"
+#include "common/util/logging.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+void testBlobTable() {
+  size_t capacity = BlobTable::AlignedCapacity(2000);
+  CHECK_EQ(capacity, 2048);
+  int fd = memfd_create("blob_table_test", 0);
+  CHECK_GE(fd, 0);
+  CHECK_EQ(ftruncate(fd, BlobTable::RequiredSize(capacity)), 0);
+  std::shared_ptr<BlobTable> writer, reader;
+  VINEYARD_CHECK_OK(BlobTable::Map(fd, capacity, true, writer));
+  VINEYARD_CHECK_OK(BlobTable::Map(fd, capacity, false, reader));
+  close(fd);
+
+  BlobLocation location;
+  for (size_t index = 1; index <= 1000; ++index) {
+    location.store_fd = 3;
+    location.data_offset = index * 64;
+    location.data_size = index;
+    CHECK(writer->Put(GenerateBlobID(index * 64), location));
+  }
+  // tombstones are skipped and reused
+  for (size_t index = 1; index <= 1000; index += 2) {
+    writer->Remove(GenerateBlobID(index * 64));
+  }
+  CHECK_EQ(writer->size(), 500);
+  for (size_t index = 1; index <= 1000; ++index) {
+    bool found = reader->Get(GenerateBlobID(index * 64), location);
+    CHECK_EQ(found, index % 2 == 0);
+    if (found) {
+      CHECK_EQ(location.data_offset, index * 64);
+      CHECK_EQ(location.data_size, index);
+    }
+  }
+
+  // readers never observe torn entries
+  ObjectID target = GenerateBlobID(64);
+  std::thread updater([&]() {
+    BlobLocation value;
+    for (int64_t round = 0; round < 100000; ++round) {
+      value.data_offset = round;
+      value.data_size = round;
+      writer->Put(target, value);
+    }
+  });
+  for (int round = 0; round < 100000; ++round) {
+    if (reader->Get(target, location)) {
+      CHECK_EQ(location.data_offset, location.data_size);
+    }
+  }
+  updater.join();
+
+  // churns the table, the tombstones don't accumulate and a miss doesn't
+  // probe the whole table
+  for (size_t round = 0; round < 100; ++round) {
+    for (size_t index = 1; index <= 500; ++index) {
+      ObjectID id = GenerateBlobID((round * 1000 + index) * 64 + 1);
+      CHECK(writer->Put(id, location));
+      writer->Remove(id);
+    }
+    CHECK_LE(writer->tombstones() * 4, capacity);
+  }
+  CHECK_EQ(writer->size(), 500);
+  for (size_t index = 1; index <= 1000; ++index) {
+    CHECK_EQ(reader->Get(GenerateBlobID(index * 64), location),
+             index % 2 == 0);
+  }
+  auto start = std::chrono::steady_clock::now();
+  for (size_t index = 0; index < 100000; ++index) {
+    CHECK(!reader->Get(GenerateBlobID(index * 64 + 3), location));
+  }
+  auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+                     std::chrono::steady_clock::now() - start)
+                     .count();
+  LOG(INFO) << "100000 misses after churning took " << elapsed << "ms";
+  CHECK_LT(elapsed, 5000);
+  LOG(INFO) << "Passed blob table tests...";
+}
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    printf("usage ./blob_table_test <ipc_socket>");
+    return 1;
+  }
+  std::string ipc_socket = std::string(argv[1]);
+
+  testBlobTable();
+
+  Client producer;
+  VINEYARD_CHECK_OK(producer.Connect(ipc_socket));
+
+  // falls back to the `GetBuffers` requests if the server doesn't enable
+  // the blob table.
+  setenv("VINEYARD_BLOB_TABLE", "1", 1);
+  Client consumer;
+  VINEYARD_CHECK_OK(consumer.Connect(ipc_socket));
+  unsetenv("VINEYARD_BLOB_TABLE");
+  LOG(INFO) << "Connected to IPCServer: " << ipc_socket;
+
+  std::set<ObjectID> ids;
+  for (size_t index = 0; index < 16; ++index) {
+    std::unique_ptr<BlobWriter> writer;
+    VINEYARD_CHECK_OK(producer.CreateBlob(1024, writer));
+    for (size_t i = 0; i < writer->size(); ++i) {
+      writer->data()[i] = static_cast<char>(i + index);
+    }
+    ids.emplace(writer->Seal(producer)->id());
+  }
+
+  // the first fetch maps the segments, and the others may be resolved from
+  // the blob table
+  for (size_t round = 0; round < 2; ++round) {
+    std::map<ObjectID, std::shared_ptr<arrow::Buffer>> buffers;
+    VINEYARD_CHECK_OK(consumer.GetBuffers(ids, buffers));
+    CHECK_EQ(buffers.size(), ids.size());
+    size_t index = 0;
+    for (auto const& id : ids) {
+      auto const& buffer = buffers.at(id);
+      CHECK_EQ(buffer->size(), 1024);
+      CHECK_EQ(buffer->data()[1],
+               static_cast<uint8_t>(static_cast<char>(1 + index)));
+      index += 1;
+    }
+  }
+  LOG(INFO) << "Passed blob table client tests...";
+
+  producer.Disconnect();
+  consumer.Disconnect();
+
+  return 0;
+}
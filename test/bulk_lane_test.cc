@@ -0,0 +1,178 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "arrow/status.h"
+#include "arrow/util/io_util.h"
+#include "arrow/util/logging.h"
+
+#include "basic/ds/array.h"
+#include "basic/ds/tuple.h"
+#include "client/client.h"
+#include "client/ds/blob.h"
+#include "client/ds/object_meta.h"
+#include "common/util/logging.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+// `ListData`, `DeepCopy` and the deep `DelData` are served on the bulk
+// context of the server, rather than the IO workers.
+constexpr size_t kTuples = 4;
+constexpr size_t kTupleSize = 1000;
+constexpr int kListRounds = 20;
+constexpr int kBlobRounds = 200;
+constexpr size_t kBlobSize = 64 * 1024;
+
+size_t MemoryUsage(Client& client) {
+  std::shared_ptr<InstanceStatus> status;
+  VINEYARD_CHECK_OK(client.InstanceStatus(status));
+  return status->memory_usage;
+}
+
+size_t CountArrays(Client& client) {
+  std::unordered_map<ObjectID, json> metas;
+  VINEYARD_CHECK_OK(client.ListData("vineyard::Array*", false,
+                                    kTuples * kTupleSize * 2, metas));
+  return metas.size();
+}
+
+ObjectID MakeTuple(Client& client, size_t const index) {
+  TupleBuilder builder(client);
+  builder.SetSize(kTupleSize);
+  for (size_t idx = 0; idx < kTupleSize; ++idx) {
+    std::vector<double> values = {static_cast<double>(index),
+                                  static_cast<double>(idx)};
+    builder.SetValue(idx,
+                     std::make_shared<ArrayBuilder<double>>(client, values));
+  }
+  return builder.Seal(client)->id();
+}
+
+// the buffer requests keep being served while the bulk commands are running
+void ChurnBlobs(std::string const& ipc_socket, std::atomic<bool>& stopped,
+                int64_t& max_latency) {
+  Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+  int rounds = 0;
+  while (rounds < kBlobRounds || !stopped.load()) {
+    auto start = std::chrono::steady_clock::now();
+    std::unique_ptr<BlobWriter> writer;
+    VINEYARD_CHECK_OK(client.CreateBlob(kBlobSize, writer));
+    writer->data()[0] = static_cast<char>(rounds);
+    auto id = writer->Seal(client)->id();
+    std::vector<std::shared_ptr<Blob>> blobs;
+    VINEYARD_CHECK_OK(client.GetBlobs({id}, blobs));
+    CHECK_EQ(blobs[0]->data()[0], static_cast<char>(rounds));
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+                       std::chrono::steady_clock::now() - start)
+                       .count();
+    max_latency = std::max(max_latency, static_cast<int64_t>(elapsed));
+    blobs.clear();
+    VINEYARD_CHECK_OK(client.DelData(id));
+    ++rounds;
+  }
+  client.Disconnect();
+}
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    printf("usage ./bulk_lane_test <ipc_socket>");
+    return 1;
+  }
+  std::string ipc_socket = std::string(argv[1]);
+
+  Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+  LOG(INFO) << "Connected to IPCServer: " << ipc_socket;
+
+  size_t base_usage = MemoryUsage(client);
+  size_t base_arrays = CountArrays(client);
+  std::vector<ObjectID> tuples;
+  for (size_t index = 0; index < kTuples; ++index) {
+    tuples.emplace_back(MakeTuple(client, index));
+  }
+  CHECK_EQ(CountArrays(client), base_arrays + kTuples * kTupleSize);
+
+  std::atomic<bool> stopped(false);
+  int64_t max_latency = 0;
+  std::thread churn(ChurnBlobs, ipc_socket, std::ref(stopped),
+                    std::ref(max_latency));
+
+  // the listings are complete and consistent while running concurrently
+  {
+    std::vector<std::thread> listers;
+    for (size_t index = 0; index < kTuples; ++index) {
+      listers.emplace_back([&ipc_socket, base_arrays]() {
+        Client client;
+        VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+        for (int round = 0; round < kListRounds; ++round) {
+          CHECK_EQ(CountArrays(client), base_arrays + kTuples * kTupleSize);
+        }
+        client.Disconnect();
+      });
+    }
+    for (auto& lister : listers) {
+      lister.join();
+    }
+  }
+  LOG(INFO) << "Passed concurrent listing tests...";
+
+  // the trees are deleted concurrently, with their members
+  {
+    std::vector<std::thread> deleters;
+    for (auto const tuple : tuples) {
+      deleters.emplace_back([&ipc_socket, tuple]() {
+        Client client;
+        VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+        VINEYARD_CHECK_OK(client.DelData(tuple, false, true));
+        bool exists = true;
+        VINEYARD_CHECK_OK(client.Exists(tuple, exists));
+        CHECK(!exists);
+        client.Disconnect();
+      });
+    }
+    for (auto& deleter : deleters) {
+      deleter.join();
+    }
+  }
+  CHECK_EQ(CountArrays(client), base_arrays);
+  LOG(INFO) << "Passed concurrent deletion tests...";
+
+  stopped.store(true);
+  churn.join();
+  LOG(INFO) << "The max latency of buffer requests: " << max_latency << "ms";
+  CHECK_LT(max_latency, 5000);
+
+  // the blobs are reclaimed on the bulk context as well
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+  while (MemoryUsage(client) != base_usage) {
+    CHECK(std::chrono::steady_clock::now() < deadline);
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  }
+  LOG(INFO) << "Passed bulk lane tests...";
+
+  client.Disconnect();
+
+  return 0;
+}
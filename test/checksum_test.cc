@@ -0,0 +1,80 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+
+#include <stdlib.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "client/client.h"
+#include "common/memory/checksum.h"
+#include "common/util/logging.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    printf("usage ./checksum_test <ipc_socket>");
+    return 1;
+  }
+  std::string ipc_socket = std::string(argv[1]);
+
+  Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+  LOG(INFO) << "Connected to IPCServer: " << ipc_socket;
+
+  // the reference values of XXH64
+  CHECK_EQ(memory::xxhash64("", 0), 0xEF46DB3751D8E999ULL);
+  CHECK_EQ(memory::xxhash64("abc", 3), 0x44BC2CF5AD770999ULL);
+  LOG(INFO) << "Passed xxhash tests...";
+
+  // the reference value of CRC32C
+  CHECK_EQ(memory::crc32c("123456789", 9), 0xE3069283U);
+  CHECK_EQ(memory::crc32c("56789", 5, memory::crc32c("1234", 4)), 0xE3069283U);
+  CHECK_EQ(memory::crc32c_combine(memory::crc32c("1234", 4),
+                                  memory::crc32c("56789", 5), 5),
+           0xE3069283U);
+  LOG(INFO) << "Passed crc32c tests...";
+
+  const size_t size = memory::kChecksumChunk * 5 + 37;
+  std::vector<uint8_t> source(size);
+  for (size_t idx = 0; idx < source.size(); ++idx) {
+    source[idx] = static_cast<uint8_t>(idx * 31 + 7);
+  }
+  uint64_t digest = memory::concurrent_checksum(source.data(), size, 1);
+  uint32_t crc = memory::concurrent_crc32c(source.data(), size, 1);
+  for (size_t concurrency : {0, 3, 8}) {
+    CHECK_EQ(memory::concurrent_checksum(source.data(), size, concurrency),
+             digest);
+    CHECK_EQ(memory::concurrent_crc32c(source.data(), size, concurrency), crc);
+  }
+  // the combined crc is the standard CRC32C of the whole region
+  CHECK_EQ(crc, memory::crc32c(source.data(), size));
+  source[size / 2] += 1;
+  CHECK_NE(memory::concurrent_checksum(source.data(), size), digest);
+  CHECK_NE(memory::concurrent_crc32c(source.data(), size), crc);
+  LOG(INFO) << "Passed concurrent checksum tests...";
+
+  std::shared_ptr<InstanceStatus> status;
+  VINEYARD_CHECK_OK(client.InstanceStatus(status));
+  CHECK_GE(status->dedup_ratio, 1.0);
+  LOG(INFO) << "Passed deduplication status tests...";
+
+  client.Disconnect();
+
+  return 0;
+}
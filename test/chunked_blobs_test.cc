@@ -0,0 +1,154 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <stdio.h>
+
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "basic/stream/byte_stream.h"
+#include "client/client.h"
+#include "client/ds/blob.h"
+#include "common/util/logging.h"
+#include "io/io/chunked_blobs.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+constexpr size_t kChunkSize = 64 * 1024;
+
+// large blobs span many chunks, and small blobs are packed together
+const std::vector<size_t> kBlobSizes = {
+    1, 100, 3 * kChunkSize + 17, kChunkSize, 5000, 7, 2 * kChunkSize - 1};
+
+std::vector<std::shared_ptr<Blob>> makeBlobs(Client& client) {
+  std::vector<std::shared_ptr<Blob>> blobs;
+  for (size_t idx = 0; idx < kBlobSizes.size(); ++idx) {
+    std::unique_ptr<BlobWriter> writer;
+    VINEYARD_CHECK_OK(client.CreateBlob(kBlobSizes[idx], writer));
+    for (size_t offset = 0; offset < kBlobSizes[idx]; ++offset) {
+      // compressible in the first half
+      writer->data()[offset] =
+          offset < kBlobSizes[idx] / 2
+              ? static_cast<char>(idx)
+              : static_cast<char>(offset * 131 + offset / 4096 + idx);
+    }
+    blobs.emplace_back(std::dynamic_pointer_cast<Blob>(writer->Seal(client)));
+  }
+  return blobs;
+}
+
+void testRoundTrip(std::string const& ipc_socket, Client& client,
+                   std::vector<std::shared_ptr<Blob>> const& blobs,
+                   std::string const& compression, const bool checksum) {
+  BlobChunkOptions options;
+  options.chunk_size = kChunkSize;
+  options.compression = compression;
+  options.checksum = checksum;
+
+  ObjectID stream_id = InvalidObjectID();
+  {
+    ByteStreamBuilder builder(client);
+    WriteBlobChunkOptions(options, builder);
+    auto stream = std::dynamic_pointer_cast<ByteStream>(builder.Seal(client));
+    stream_id = stream->id();
+  }
+
+  Status write_status;
+  std::thread send_thrd([&]() {
+    Client writer_client;
+    VINEYARD_CHECK_OK(writer_client.Connect(ipc_socket));
+    auto stream = writer_client.GetObject<ByteStream>(stream_id);
+    std::unique_ptr<ByteStreamWriter> writer;
+    VINEYARD_CHECK_OK(stream->OpenWriter(writer_client, writer));
+    write_status = WriteBlobChunks(*writer, blobs, options);
+    if (write_status.ok()) {
+      VINEYARD_CHECK_OK(writer->Finish());
+    } else {
+      VINEYARD_CHECK_OK(writer->Abort());
+    }
+  });
+
+  auto stream = client.GetObject<ByteStream>(stream_id);
+  BlobChunkOptions read_options;
+  CHECK(ReadBlobChunkOptions(stream->GetParams(), read_options));
+  CHECK_EQ(read_options.chunk_size, kChunkSize);
+  CHECK_EQ(read_options.compression, compression);
+  CHECK_EQ(read_options.checksum, checksum);
+
+  std::vector<std::vector<uint8_t>> contents;
+  std::vector<uint8_t*> targets;
+  for (size_t size : kBlobSizes) {
+    contents.emplace_back(size, 0);
+  }
+  for (auto& content : contents) {
+    targets.emplace_back(content.data());
+  }
+  std::unique_ptr<ByteStreamReader> reader;
+  VINEYARD_CHECK_OK(stream->OpenReader(client, reader));
+  auto read_status =
+      ReadBlobChunks(*reader, targets, kBlobSizes, read_options);
+  send_thrd.join();
+
+  if (!write_status.ok() && compression != "none") {
+    // the codec is not available in the arrow library
+    LOG(INFO) << "Skipped the " << compression
+              << " tests: " << write_status.ToString();
+    return;
+  }
+  VINEYARD_CHECK_OK(write_status);
+  VINEYARD_CHECK_OK(read_status);
+  for (size_t idx = 0; idx < blobs.size(); ++idx) {
+    CHECK_EQ(memcmp(contents[idx].data(), blobs[idx]->data(),
+                    blobs[idx]->size()),
+             0);
+  }
+}
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    printf("usage ./chunked_blobs_test <ipc_socket>");
+    return 1;
+  }
+  std::string ipc_socket = std::string(argv[1]);
+
+  Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+  LOG(INFO) << "Connected to IPCServer: " << ipc_socket;
+
+  auto blobs = makeBlobs(client);
+  for (std::string const compression : {"none", "lz4", "zstd"}) {
+    for (bool checksum : {true, false}) {
+      testRoundTrip(ipc_socket, client, blobs, compression, checksum);
+    }
+    LOG(INFO) << "Passed the round trip tests with compression "
+              << compression << "...";
+  }
+
+  // streams of the legacy serializer are not in the chunked format
+  {
+    BlobChunkOptions options;
+    CHECK(!ReadBlobChunkOptions({{"blobs", "[]"}}, options));
+  }
+
+  LOG(INFO) << "Passed chunked blobs tests...";
+
+  client.Disconnect();
+
+  return 0;
+}
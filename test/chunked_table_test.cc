@@ -0,0 +1,168 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "arrow/api.h"
+
+#include "basic/ds/arrow.h"
+#include "basic/ds/chunked_table.h"
+#include "client/client.h"
+#include "client/ds/object_meta.h"
+#include "common/util/logging.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+std::shared_ptr<arrow::RecordBatch> MakeBatch(int64_t const base,
+                                              int64_t const length) {
+  arrow::Int64Builder b1;
+  arrow::StringBuilder b2;
+  for (int64_t i = base; i < base + length; ++i) {
+    CHECK_ARROW_ERROR(b1.Append(i));
+    CHECK_ARROW_ERROR(b2.Append("value-" + std::to_string(i)));
+  }
+  std::shared_ptr<arrow::Array> a1, a2;
+  CHECK_ARROW_ERROR(b1.Finish(&a1));
+  CHECK_ARROW_ERROR(b2.Finish(&a2));
+  auto schema = arrow::schema({arrow::field("id", arrow::int64()),
+                               arrow::field("name", arrow::utf8())});
+  return arrow::RecordBatch::Make(schema, length, {a1, a2});
+}
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    printf("usage ./chunked_table_test <ipc_socket>");
+    return 1;
+  }
+  std::string ipc_socket = std::string(argv[1]);
+
+  Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+  LOG(INFO) << "Connected to IPCServer: " << ipc_socket;
+
+  const int writers = 4, chunks_per_writer = 6, rows_per_chunk = 100;
+  auto schema = MakeBatch(0, 0)->schema();
+
+  ChunkedTableAppender appender(schema, 4);
+
+  {
+    std::vector<std::thread> threads;
+    for (int writer = 0; writer < writers; ++writer) {
+      threads.emplace_back([&, writer]() {
+        Client writer_client;
+        VINEYARD_CHECK_OK(writer_client.Connect(ipc_socket));
+        for (int chunk = 0; chunk < chunks_per_writer; ++chunk) {
+          int64_t base = (writer * chunks_per_writer + chunk) * rows_per_chunk;
+          VINEYARD_CHECK_OK(appender.Append(
+              writer_client, MakeBatch(base, rows_per_chunk)));
+        }
+        writer_client.Disconnect();
+      });
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+  }
+
+  const size_t total_chunks = writers * chunks_per_writer;
+  {
+    // published in batches of 4 chunks
+    auto latest = appender.Latest();
+    CHECK(latest != nullptr);
+    CHECK_EQ(latest->version(), total_chunks / 4 - 1);
+    CHECK_EQ(latest->chunk_num(), total_chunks);
+    CHECK_EQ(appender.Pending(), 0);
+  }
+
+  std::shared_ptr<ChunkedTable> s1, s2, s3;
+  {
+    VINEYARD_CHECK_OK(appender.Append(client, MakeBatch(-10, 10)));
+    CHECK_EQ(appender.Pending(), 1);
+    VINEYARD_CHECK_OK(appender.Snapshot(client, s1));
+    CHECK_EQ(appender.Pending(), 0);
+    CHECK_EQ(s1->chunk_num(), total_chunks + 1);
+    CHECK_EQ(s1->num_rows(), total_chunks * rows_per_chunk + 10);
+
+    auto table = std::dynamic_pointer_cast<ChunkedTable>(
+                     client.GetObject(s1->id()))
+                     ->GetTable();
+    CHECK_EQ(table->num_rows(), s1->num_rows());
+    CHECK(table->schema()->Equals(*schema));
+
+    // every row has been appended exactly once
+    std::vector<int> seen(total_chunks * rows_per_chunk + 10, 0);
+    for (auto const& chunk : s1->chunks()) {
+      auto ids = std::dynamic_pointer_cast<arrow::Int64Array>(
+          chunk->GetRecordBatch()->column(0));
+      for (int64_t i = 0; i < ids->length(); ++i) {
+        seen[ids->Value(i) + 10] += 1;
+      }
+    }
+    for (auto const& count : seen) {
+      CHECK_EQ(count, 1);
+    }
+  }
+
+  {
+    // no new chunks: a shallow copy of the latest snapshot
+    VINEYARD_CHECK_OK(appender.Snapshot(client, s2));
+    CHECK_NE(s2->id(), s1->id());
+    CHECK_EQ(s2->version(), s1->version() + 1);
+    CHECK_EQ(s2->chunk_num(), s1->chunk_num());
+    for (size_t i = 0; i < s1->chunk_num(); ++i) {
+      CHECK_EQ(s2->chunks()[i]->id(), s1->chunks()[i]->id());
+    }
+  }
+
+  {
+    // extend the chunks with a new column
+    arrow::DoubleBuilder builder;
+    for (size_t i = 0; i < s2->num_rows(); ++i) {
+      CHECK_ARROW_ERROR(builder.Append(i * 0.5));
+    }
+    std::shared_ptr<arrow::Array> column;
+    CHECK_ARROW_ERROR(builder.Finish(&column));
+    VINEYARD_CHECK_OK(appender.AddColumn(client, "weight", column));
+    s3 = appender.Latest();
+    CHECK_EQ(s3->version(), s2->version() + 1);
+    CHECK_EQ(s3->num_columns(), 3);
+    CHECK_EQ(s3->chunk_num(), s2->chunk_num());
+    // existing columns are shared
+    CHECK_EQ(s3->chunks()[0]->columns()[0]->id(),
+             s2->chunks()[0]->columns()[0]->id());
+    CHECK_EQ(s3->GetTable()->num_rows(), s2->num_rows());
+
+    // chunks of the old schema are rejected
+    CHECK(!appender.Append(client, MakeBatch(0, 10)).ok());
+  }
+
+  {
+    // earlier snapshots are still intact
+    auto table = std::dynamic_pointer_cast<ChunkedTable>(
+                     client.GetObject(s1->id()))
+                     ->GetTable();
+    CHECK_EQ(table->num_columns(), 2);
+    CHECK_EQ(table->num_rows(), s1->num_rows());
+  }
+
+  LOG(INFO) << "Passed chunked table tests...";
+
+  client.Disconnect();
+
+  return 0;
+}
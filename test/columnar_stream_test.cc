@@ -0,0 +1,146 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include <memory>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "arrow/api.h"
+#include "arrow/status.h"
+#include "arrow/util/logging.h"
+
+#include "basic/ds/arrow_utils.h"
+#include "basic/stream/dataframe_stream.h"
+#include "client/client.h"
+#include "common/util/logging.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+std::shared_ptr<arrow::RecordBatch> MakeBatch(int64_t start, int64_t rows) {
+  arrow::Int64Builder id_builder;
+  arrow::StringBuilder name_builder;
+  auto value_builder = std::make_shared<arrow::DoubleBuilder>();
+  arrow::ListBuilder list_builder(arrow::default_memory_pool(),
+                                  value_builder);
+  for (int64_t i = start; i < start + rows; ++i) {
+    CHECK_ARROW_ERROR(id_builder.Append(i));
+    if (i % 3 == 0) {
+      CHECK_ARROW_ERROR(name_builder.AppendNull());
+    } else {
+      CHECK_ARROW_ERROR(name_builder.Append("name-" + std::to_string(i)));
+    }
+    CHECK_ARROW_ERROR(list_builder.Append());
+    for (int64_t j = 0; j < i % 4; ++j) {
+      CHECK_ARROW_ERROR(value_builder->Append(i * 0.5 + j));
+    }
+  }
+  std::shared_ptr<arrow::Array> ids, names, lists;
+  CHECK_ARROW_ERROR(id_builder.Finish(&ids));
+  CHECK_ARROW_ERROR(name_builder.Finish(&names));
+  CHECK_ARROW_ERROR(list_builder.Finish(&lists));
+  auto schema = arrow::schema({arrow::field("id", arrow::int64()),
+                               arrow::field("name", arrow::utf8()),
+                               arrow::field("values", lists->type())});
+  return arrow::RecordBatch::Make(schema, rows, {ids, names, lists});
+}
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    printf("usage ./columnar_stream_test <ipc_socket>");
+    return 1;
+  }
+  std::string ipc_socket = std::string(argv[1]);
+
+  Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+  LOG(INFO) << "Connected to IPCServer: " << ipc_socket;
+
+  // the batches (including a sliced one) survive the columnar form
+  std::vector<std::shared_ptr<arrow::RecordBatch>> batches;
+  batches.emplace_back(MakeBatch(0, 100));
+  batches.emplace_back(MakeBatch(100, 1000)->Slice(17, 500));
+  batches.emplace_back(MakeBatch(1100, 0));
+  {
+    for (auto const& batch : batches) {
+      size_t size = 0;
+      VINEYARD_CHECK_OK(GetColumnarBatchSize(*batch, &size));
+      std::shared_ptr<arrow::ResizableBuffer> buffer;
+      CHECK_ARROW_ERROR_AND_ASSIGN(buffer, arrow::AllocateResizableBuffer(
+                                               static_cast<int64_t>(size)));
+      VINEYARD_CHECK_OK(WriteColumnarBatch(*batch, buffer.get()));
+      std::shared_ptr<arrow::RecordBatch> result;
+      VINEYARD_CHECK_OK(ReadColumnarBatch(batch->schema(), buffer, &result));
+      CHECK_ARROW_ERROR(result->ValidateFull());
+      CHECK(result->Equals(*batch));
+    }
+  }
+
+  ObjectID stream_id = InvalidObjectID();
+  {
+    DataframeStreamBuilder builder(client);
+    builder.SetParams(std::unordered_map<std::string, std::string>{
+        {"kind", "test"}, {"test_name", "columnar_stream_test"}});
+    builder.SetColumnar();
+    auto stream =
+        std::dynamic_pointer_cast<DataframeStream>(builder.Seal(client));
+    CHECK(stream->IsColumnar());
+    stream_id = stream->id();
+    CHECK(stream_id != InvalidObjectID());
+  }
+
+  std::shared_ptr<arrow::Table> table;
+  std::thread recv_thrd([&]() {
+    Client reader_client;
+    VINEYARD_CHECK_OK(reader_client.Connect(ipc_socket));
+    auto stream = reader_client.GetObject<DataframeStream>(stream_id);
+    CHECK(stream != nullptr);
+    std::unique_ptr<DataframeStreamReader> reader;
+    VINEYARD_CHECK_OK(stream->OpenReader(reader_client, reader));
+    VINEYARD_CHECK_OK(reader->ReadTable(table));
+  });
+
+  std::thread send_thrd([&]() {
+    Client writer_client;
+    VINEYARD_CHECK_OK(writer_client.Connect(ipc_socket));
+    auto stream = writer_client.GetObject<DataframeStream>(stream_id);
+    CHECK(stream != nullptr);
+    std::unique_ptr<DataframeStreamWriter> writer;
+    VINEYARD_CHECK_OK(stream->OpenWriter(writer_client, writer));
+    for (auto batch : batches) {
+      VINEYARD_CHECK_OK(writer->WriteBatch(batch));
+    }
+    // the schema cannot be changed in the middle of the stream
+    auto other = batches[0]->RemoveColumn(1).ValueOrDie();
+    CHECK(writer->WriteBatch(other).IsAssertionFailed());
+    VINEYARD_CHECK_OK(writer->Finish());
+  });
+
+  send_thrd.join();
+  recv_thrd.join();
+
+  std::shared_ptr<arrow::Table> expected;
+  VINEYARD_CHECK_OK(RecordBatchesToTable(batches, &expected));
+  CHECK_ARROW_ERROR(table->ValidateFull());
+  CHECK(table->Equals(*expected));
+  CHECK_EQ(table->schema()->metadata()->Get("format").ValueOrDie(),
+           "columnar");
+
+  LOG(INFO) << "Passed columnar stream tests...";
+
+  client.Disconnect();
+
+  return 0;
+}
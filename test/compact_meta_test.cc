@@ -0,0 +1,92 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+
+#include <memory>
+#include <string>
+#include <thread>
+
+#include "arrow/status.h"
+#include "arrow/util/io_util.h"
+#include "arrow/util/logging.h"
+
+#include "basic/ds/array.h"
+#include "basic/ds/tuple.h"
+#include "client/client.h"
+#include "client/ds/compact_meta.h"
+#include "client/ds/object_meta.h"
+#include "common/util/logging.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    printf("usage ./compact_meta_test <ipc_socket>");
+    return 1;
+  }
+  std::string ipc_socket = std::string(argv[1]);
+
+  Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+  LOG(INFO) << "Connected to IPCServer: " << ipc_socket;
+
+  const size_t element_size = 1024;
+
+  TupleBuilder tup_builder(client);
+  tup_builder.SetSize(element_size);
+  for (size_t idx = 0; idx < element_size; ++idx) {
+    std::vector<double> double_array = {1.0, static_cast<double>(idx)};
+    auto builder = std::make_shared<ArrayBuilder<double>>(client, double_array);
+    tup_builder.SetValue(idx, builder);
+  }
+  auto tup = std::dynamic_pointer_cast<Tuple>(tup_builder.Seal(client));
+
+  ObjectID compact_id = InvalidObjectID();
+  VINEYARD_CHECK_OK(CompactMeta::Write(client, tup->meta(), compact_id));
+
+  CompactMeta compact;
+  VINEYARD_CHECK_OK(CompactMeta::Read(client, compact_id, compact));
+
+  // lookups
+  {
+    std::string type_name;
+    VINEYARD_CHECK_OK(compact.Root().GetKeyValue("typename", type_name));
+    CHECK_EQ(type_name, tup->meta().GetTypeName());
+    uint64_t size = 0;
+    VINEYARD_CHECK_OK(compact.Root().GetKeyValue("size_", size));
+    CHECK_EQ(size, element_size);
+    CHECK(!compact.Root().Haskey("no-such-key"));
+
+    CompactMeta::Node member;
+    VINEYARD_CHECK_OK(compact.Root().GetMember("__elements_-7", member));
+    VINEYARD_CHECK_OK(member.GetKeyValue("typename", type_name));
+    CHECK_EQ(type_name, type_name<Array<double>>());
+    auto status = member.GetMember("no-such-member", member);
+    CHECK(status.IsMetaTreeSubtreeNotExists());
+  }
+
+  // round trip
+  {
+    json tree;
+    VINEYARD_CHECK_OK(compact.ToJSON(tree));
+    CHECK_EQ(tree, tup->meta().MetaData());
+  }
+
+  LOG(INFO) << "Passed compact metadata tests...";
+
+  client.Disconnect();
+
+  return 0;
+}
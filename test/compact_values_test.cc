@@ -0,0 +1,96 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <fstream>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "arrow/status.h"
+#include "arrow/util/io_util.h"
+#include "arrow/util/logging.h"
+
+#include "basic/ds/scalar.h"
+#include "client/client.h"
+#include "client/ds/object_meta.h"
+#include "common/util/logging.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+// the test runs for a few rounds against the same etcd and prefix, with and
+// without `--etcd_compact_values` in turn, see also `test/runner.py`. Every
+// round checks the objects persisted by the former rounds, i.e., the values
+// stored as both CBOR and JSON text, then persists some more.
+constexpr size_t kObjects = 16;
+
+std::string NameOf(size_t round, size_t index) {
+  return "compact_values_test_" + std::to_string(round) + "_" +
+         std::to_string(index);
+}
+
+int64_t ValueOf(size_t round, size_t index) {
+  return static_cast<int64_t>(round * 1000 + index);
+}
+
+int main(int argc, char** argv) {
+  if (argc < 4) {
+    printf("usage ./compact_values_test <ipc_socket> <round> <ids_file>");
+    return 1;
+  }
+  std::string ipc_socket = std::string(argv[1]);
+  size_t round = std::stoul(argv[2]);
+  std::string ids_file = std::string(argv[3]);
+
+  Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+  LOG(INFO) << "Connected to IPCServer: " << ipc_socket;
+
+  // lines of "<round> <index> <id>"
+  std::ifstream input(ids_file);
+  size_t persisted_round = 0, persisted_index = 0;
+  ObjectID id = InvalidObjectID();
+  size_t checked = 0;
+  while (input >> persisted_round >> persisted_index >> id) {
+    bool exists = false;
+    VINEYARD_CHECK_OK(client.Exists(id, exists));
+    CHECK(exists);
+    ObjectID named = InvalidObjectID();
+    VINEYARD_CHECK_OK(
+        client.GetName(NameOf(persisted_round, persisted_index), named));
+    CHECK_EQ(named, id);
+    auto scalar = client.GetObject<Scalar<int64_t>>(id);
+    CHECK(scalar != nullptr);
+    CHECK_EQ(scalar->Value(), ValueOf(persisted_round, persisted_index));
+    ++checked;
+  }
+  CHECK_EQ(checked, round * kObjects);
+  input.close();
+
+  std::ofstream output(ids_file, std::ios::app);
+  for (size_t index = 0; index < kObjects; ++index) {
+    ScalarBuilder<int64_t> builder(client);
+    builder.SetValue(ValueOf(round, index));
+    auto scalar = builder.Seal(client);
+    VINEYARD_CHECK_OK(client.Persist(scalar->id()));
+    VINEYARD_CHECK_OK(client.PutName(scalar->id(), NameOf(round, index)));
+    output << round << " " << index << " " << scalar->id() << std::endl;
+  }
+  LOG(INFO) << "Passed compact values tests of round " << round << "...";
+
+  client.Disconnect();
+
+  return 0;
+}
@@ -0,0 +1,211 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <atomic>
+#include <functional>
+#include <limits>
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "arrow/status.h"
+#include "arrow/util/io_util.h"
+#include "arrow/util/logging.h"
+
+#include "basic/ds/array.h"
+#include "client/client.h"
+#include "client/ds/object_meta.h"
+#include "common/util/logging.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+constexpr int kClients = 8;
+constexpr int kObjects = 64;
+
+std::string NameOf(int client_index, int object_index) {
+  return "concurrent_meta_test_" + std::to_string(client_index) + "_" +
+         std::to_string(object_index);
+}
+
+// every client creates and persists its objects, by both the blocking and
+// the pipelined persists, and names every 4th of them, where the owned keys
+// and the names (which need the global lock) are committed concurrently.
+void CreateObjects(const std::string& ipc_socket, int client_index,
+                   std::vector<ObjectID>& ids) {
+  Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+  uint64_t ticket = 0;
+  std::map<std::string, ObjectID> names;
+  for (int i = 0; i < kObjects; ++i) {
+    std::vector<double> values = {static_cast<double>(client_index),
+                                  static_cast<double>(i)};
+    ArrayBuilder<double> builder(client, values);
+    ObjectID id = builder.Seal(client)->id();
+    ids.emplace_back(id);
+    if (i % 2 == 0) {
+      VINEYARD_CHECK_OK(client.Persist(id));
+    } else {
+      VINEYARD_CHECK_OK(client.PersistAsync(id, ticket));
+    }
+    if (i % 4 == 0) {
+      VINEYARD_CHECK_OK(client.PutName(id, NameOf(client_index, i)));
+    } else if (i % 4 == 1) {
+      names.emplace(NameOf(client_index, i), id);
+    }
+  }
+  VINEYARD_CHECK_OK(client.PutNames(names));
+  VINEYARD_CHECK_OK(client.WaitPersisted(ticket));
+  client.Disconnect();
+}
+
+void DeleteObjects(const std::string& ipc_socket, int client_index,
+                   const std::vector<ObjectID>& ids) {
+  Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+  for (int i = 0; i < kObjects; ++i) {
+    if (i % 4 <= 1) {
+      VINEYARD_CHECK_OK(client.DropName(NameOf(client_index, i)));
+    }
+  }
+  // half one by one, and the other half in a single request
+  std::vector<ObjectID> batch;
+  for (int i = 0; i < kObjects; ++i) {
+    if (i % 2 == 0) {
+      VINEYARD_CHECK_OK(client.DelData(ids[i]));
+    } else {
+      batch.emplace_back(ids[i]);
+    }
+  }
+  VINEYARD_CHECK_OK(client.DelData(batch));
+  client.Disconnect();
+}
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    printf("usage ./concurrent_meta_test <ipc_socket>");
+    return 1;
+  }
+  std::string ipc_socket = std::string(argv[1]);
+
+  Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+  LOG(INFO) << "Connected to IPCServer: " << ipc_socket;
+
+  std::vector<std::vector<ObjectID>> ids(kClients);
+
+  // the reads are served while the commits are in progress
+  std::atomic<bool> writing(true);
+  std::atomic<size_t> reads(0);
+  std::thread reader([&]() {
+    Client reader_client;
+    VINEYARD_CHECK_OK(reader_client.Connect(ipc_socket));
+    while (writing.load()) {
+      std::unordered_map<ObjectID, json> metas;
+      VINEYARD_CHECK_OK(reader_client.ListData("vineyard::Array*", false,
+                                               kClients * kObjects, metas));
+      for (auto const& item : metas) {
+        ObjectMeta meta;
+        auto status = reader_client.GetMetaData(item.first, meta);
+        // the objects of the other tests may be deleted meanwhile
+        if (status.ok()) {
+          CHECK_EQ(meta.GetId(), item.first);
+          CHECK_EQ(meta.GetTypeName(),
+                   item.second.value("typename", std::string()));
+        }
+      }
+      reads.fetch_add(1);
+    }
+    reader_client.Disconnect();
+  });
+
+  {
+    std::vector<std::thread> writers;
+    for (int k = 0; k < kClients; ++k) {
+      writers.emplace_back(CreateObjects, ipc_socket, k, std::ref(ids[k]));
+    }
+    for (auto& writer : writers) {
+      writer.join();
+    }
+  }
+  writing.store(false);
+  reader.join();
+  CHECK_GT(reads.load(), 0);
+
+  for (int k = 0; k < kClients; ++k) {
+    CHECK_EQ(ids[k].size(), kObjects);
+    for (int i = 0; i < kObjects; ++i) {
+      ObjectID id = ids[k][i];
+      bool persist = false;
+      VINEYARD_CHECK_OK(client.IfPersist(id, persist));
+      CHECK(persist);
+      auto array = std::dynamic_pointer_cast<Array<double>>(
+          client.GetObject(id));
+      CHECK(array != nullptr);
+      CHECK_EQ(array->size(), 2);
+      CHECK_EQ((*array)[0], k);
+      CHECK_EQ((*array)[1], i);
+
+      ObjectID named = InvalidObjectID();
+      if (i % 4 <= 1) {
+        VINEYARD_CHECK_OK(client.GetName(NameOf(k, i), named));
+        CHECK_EQ(named, id);
+      } else {
+        CHECK(client.GetName(NameOf(k, i), named).IsObjectNotExists());
+      }
+    }
+  }
+
+  {
+    std::unordered_map<ObjectID, json> metas;
+    VINEYARD_CHECK_OK(client.ListData("vineyard::Array*", false,
+                                      std::numeric_limits<size_t>::max(),
+                                      metas));
+    for (auto const& client_ids : ids) {
+      for (auto const id : client_ids) {
+        CHECK(metas.find(id) != metas.end());
+      }
+    }
+  }
+
+  LOG(INFO) << "Passed concurrent persist tests...";
+
+  {
+    std::vector<std::thread> deleters;
+    for (int k = 0; k < kClients; ++k) {
+      deleters.emplace_back(DeleteObjects, ipc_socket, k, std::cref(ids[k]));
+    }
+    for (auto& deleter : deleters) {
+      deleter.join();
+    }
+  }
+  for (int k = 0; k < kClients; ++k) {
+    for (int i = 0; i < kObjects; ++i) {
+      bool exists = true;
+      VINEYARD_CHECK_OK(client.Exists(ids[k][i], exists));
+      CHECK(!exists);
+      ObjectID named = InvalidObjectID();
+      CHECK(client.GetName(NameOf(k, i), named).IsObjectNotExists());
+    }
+  }
+
+  LOG(INFO) << "Passed concurrent delete tests...";
+
+  client.Disconnect();
+
+  return 0;
+}
@@ -0,0 +1,138 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "arrow/status.h"
+#include "arrow/util/io_util.h"
+#include "arrow/util/logging.h"
+
+#include "client/client.h"
+#include "client/ds/object_meta.h"
+#include "client/rpc_client.h"
+#include "common/util/logging.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+constexpr int kThreads = 16;
+constexpr int kRounds = 100;
+
+// connects and closes at once, without even registering the client
+void ConnectAndClose(std::string const& ipc_socket) {
+  int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  CHECK_GE(fd, 0);
+  struct sockaddr_un address;
+  memset(&address, 0, sizeof(address));
+  address.sun_family = AF_UNIX;
+  strncpy(address.sun_path, ipc_socket.c_str(), sizeof(address.sun_path) - 1);
+  CHECK_EQ(connect(fd, reinterpret_cast<struct sockaddr*>(&address),
+                   sizeof(address)),
+           0);
+  close(fd);
+}
+
+void Churn(std::string const& ipc_socket, std::string const& rpc_endpoint,
+           int thread) {
+  bool exists = true;
+  for (int round = 0; round < kRounds; ++round) {
+    switch ((thread + round) % 3) {
+    case 0: {
+      Client client;
+      VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+      VINEYARD_CHECK_OK(client.Exists(GenerateObjectID(), exists));
+      CHECK(!exists);
+      client.Disconnect();
+      break;
+    }
+    case 1: {
+      RPCClient client;
+      VINEYARD_CHECK_OK(client.Connect(rpc_endpoint));
+      VINEYARD_CHECK_OK(client.Exists(GenerateObjectID(), exists));
+      CHECK(!exists);
+      client.Disconnect();
+      break;
+    }
+    default:
+      ConnectAndClose(ipc_socket);
+    }
+  }
+}
+
+std::shared_ptr<InstanceStatus> GetStatus(Client& client) {
+  std::shared_ptr<InstanceStatus> status;
+  VINEYARD_CHECK_OK(client.InstanceStatus(status));
+  return status;
+}
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    printf("usage ./connection_churn_test <ipc_socket>");
+    return 1;
+  }
+  std::string ipc_socket = std::string(argv[1]);
+
+  Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+  LOG(INFO) << "Connected to IPCServer: " << ipc_socket;
+  std::string rpc_endpoint = client.RPCEndpoint();
+
+  auto base = GetStatus(client);
+  {
+    std::vector<std::thread> threads;
+    for (int thread = 0; thread < kThreads; ++thread) {
+      threads.emplace_back(Churn, ipc_socket, rpc_endpoint, thread);
+    }
+    // the long-lived connection keeps being served during the churn
+    bool exists = true;
+    for (int round = 0; round < kRounds; ++round) {
+      VINEYARD_CHECK_OK(client.Exists(GenerateObjectID(), exists));
+      CHECK(!exists);
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+  }
+
+  // the connections are removed once the peers close, including those that
+  // closed before sending anything
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+  while (true) {
+    auto status = GetStatus(client);
+    if (status->ipc_connections == base->ipc_connections &&
+        status->rpc_connections == base->rpc_connections) {
+      break;
+    }
+    CHECK(std::chrono::steady_clock::now() < deadline)
+        << "ipc connections: " << status->ipc_connections << " vs. "
+        << base->ipc_connections
+        << ", rpc connections: " << status->rpc_connections << " vs. "
+        << base->rpc_connections;
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  }
+  LOG(INFO) << "Passed connection churn tests...";
+
+  client.Disconnect();
+
+  return 0;
+}
@@ -0,0 +1,82 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "arrow/status.h"
+#include "arrow/util/io_util.h"
+#include "arrow/util/logging.h"
+
+#include "client/client.h"
+#include "client/ds/blob.h"
+#include "client/ds/object_meta.h"
+#include "common/util/logging.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    printf("usage ./create_blobs_test <ipc_socket>");
+    return 1;
+  }
+  std::string ipc_socket = std::string(argv[1]);
+
+  Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+  LOG(INFO) << "Connected to IPCServer: " << ipc_socket;
+
+  std::vector<size_t> sizes = {1, 0, 1024, 4096, 0, 37};
+  std::vector<std::unique_ptr<BlobWriter>> writers;
+  VINEYARD_CHECK_OK(client.CreateBlobs(sizes, writers));
+  CHECK_EQ(writers.size(), sizes.size());
+
+  std::vector<ObjectID> ids(sizes.size(), InvalidObjectID());
+  for (size_t i = 0; i < sizes.size(); ++i) {
+    CHECK_EQ(writers[i]->size(), sizes[i]);
+    if (sizes[i] == 0) {
+      continue;
+    }
+    for (size_t j = 0; j < sizes[i]; ++j) {
+      writers[i]->data()[j] = static_cast<char>(i + j);
+    }
+    ids[i] = writers[i]->Seal(client)->id();
+  }
+
+  for (size_t i = 0; i < sizes.size(); ++i) {
+    if (sizes[i] == 0) {
+      continue;
+    }
+    std::shared_ptr<Blob> blob;
+    VINEYARD_CHECK_OK(client.GetObject(ids[i], blob));
+    CHECK_EQ(blob->allocated_size(), sizes[i]);
+    for (size_t j = 0; j < sizes[i]; ++j) {
+      CHECK_EQ(blob->data()[j], static_cast<char>(i + j));
+    }
+  }
+
+  // empty batch
+  std::vector<std::unique_ptr<BlobWriter>> empty_writers;
+  VINEYARD_CHECK_OK(client.CreateBlobs({}, empty_writers));
+  CHECK(empty_writers.empty());
+
+  LOG(INFO) << "Passed create blobs tests...";
+
+  client.Disconnect();
+
+  return 0;
+}
@@ -0,0 +1,113 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "arrow/status.h"
+#include "arrow/util/io_util.h"
+#include "arrow/util/logging.h"
+
+#include "basic/ds/scalar.h"
+#include "client/client.h"
+#include "client/ds/object_meta.h"
+#include "common/util/logging.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+// the server runs with `--deferred_timeout=2`, see also `test/runner.py`.
+constexpr int kTimeout = 2;
+constexpr size_t kWaiters = 4;
+
+size_t DeferredRequests(Client& client) {
+  std::shared_ptr<InstanceStatus> status;
+  VINEYARD_CHECK_OK(client.InstanceStatus(status));
+  return status->deferred_requests;
+}
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    printf("usage ./deferred_timeout_test <ipc_socket>");
+    return 1;
+  }
+  std::string ipc_socket = std::string(argv[1]);
+
+  Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+  LOG(INFO) << "Connected to IPCServer: " << ipc_socket;
+  CHECK_EQ(DeferredRequests(client), 0);
+
+  ScalarBuilder<int64_t> builder(client);
+  builder.SetValue(1234);
+  ObjectID existing = builder.Seal(client)->id();
+
+  // the waiting doesn't block when the objects exist
+  {
+    json tree;
+    VINEYARD_CHECK_OK(client.GetData(existing, tree, false, true));
+  }
+
+  // the waiters for objects that never come, one of them also waits for
+  // an existing object
+  auto start = std::chrono::steady_clock::now();
+  std::vector<std::thread> waiters;
+  for (size_t index = 0; index < kWaiters; ++index) {
+    waiters.emplace_back([&ipc_socket, &start, existing, index]() {
+      Client client;
+      VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+      std::vector<ObjectID> ids = {GenerateObjectID()};
+      if (index == 0) {
+        ids.emplace_back(existing);
+      }
+      std::vector<json> trees;
+      auto status = client.GetData(ids, trees, false, true);
+      CHECK(status.IsObjectNotExists());
+      auto elapsed = std::chrono::steady_clock::now() - start;
+      CHECK_GE(elapsed, std::chrono::seconds(kTimeout));
+      // the expiration is checked by a timer of one-second ticks
+      CHECK_LE(elapsed, std::chrono::seconds(kTimeout + 10));
+      client.Disconnect();
+    });
+  }
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+  while (DeferredRequests(client) < kWaiters) {
+    CHECK(std::chrono::steady_clock::now() < deadline);
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  }
+
+  // the updates of other objects don't satisfy the waiters
+  std::vector<ObjectID> others;
+  for (int index = 0; index < 32; ++index) {
+    ScalarBuilder<int64_t> builder(client);
+    builder.SetValue(index);
+    others.emplace_back(builder.Seal(client)->id());
+  }
+  VINEYARD_CHECK_OK(client.DelData(others));
+  CHECK_EQ(DeferredRequests(client), kWaiters);
+
+  for (auto& waiter : waiters) {
+    waiter.join();
+  }
+  CHECK_EQ(DeferredRequests(client), 0);
+  LOG(INFO) << "Passed deferred request timeout tests...";
+
+  VINEYARD_CHECK_OK(client.DelData(existing));
+  client.Disconnect();
+
+  return 0;
+}
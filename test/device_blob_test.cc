@@ -0,0 +1,90 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "arrow/status.h"
+#include "arrow/util/io_util.h"
+#include "arrow/util/logging.h"
+
+#include "client/client.h"
+#include "client/ds/blob.h"
+#include "client/ds/object_meta.h"
+#include "common/util/logging.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+constexpr size_t kBlobSize = 4 * 1024 * 1024;
+
+size_t MemoryUsage(Client& client) {
+  std::shared_ptr<InstanceStatus> status;
+  VINEYARD_CHECK_OK(client.InstanceStatus(status));
+  return status->memory_usage;
+}
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    printf("usage ./device_blob_test <ipc_socket>");
+    return 1;
+  }
+  std::string ipc_socket = std::string(argv[1]);
+
+  Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+  LOG(INFO) << "Connected to IPCServer: " << ipc_socket;
+
+  std::unique_ptr<BlobWriter> writer;
+  CHECK(!client.CreateDeviceBlob(kBlobSize, -1, writer).ok());
+
+  size_t base = MemoryUsage(client);
+  auto status = client.CreateDeviceBlob(kBlobSize, 0, writer);
+  if (status.IsNotImplemented() || status.IsIOError()) {
+    // neither the CUDA runtime nor a device is required on the CI hosts
+    LOG(INFO) << "Skipped device blob tests: " << status.ToString();
+    client.Disconnect();
+    return 0;
+  }
+  VINEYARD_CHECK_OK(status);
+  CHECK(writer->data() != nullptr);
+  CHECK_EQ(writer->size(), kBlobSize);
+
+  // the device memory is not taken from the shared memory
+  CHECK_EQ(MemoryUsage(client), base);
+
+  ObjectID id = writer->Seal(client)->id();
+  std::vector<std::shared_ptr<Blob>> blobs;
+  VINEYARD_CHECK_OK(client.GetBlobs({id}, blobs));
+  CHECK_EQ(blobs[0]->size(), kBlobSize);
+  CHECK(blobs[0]->data() != nullptr);
+  blobs.clear();
+
+  // empty blobs are not placed on the device
+  std::unique_ptr<BlobWriter> empty;
+  VINEYARD_CHECK_OK(client.CreateDeviceBlob(0, 0, empty));
+  CHECK_EQ(empty->id(), EmptyBlobID());
+
+  VINEYARD_CHECK_OK(client.DelData(id));
+  bool exists = true;
+  VINEYARD_CHECK_OK(client.Exists(id, exists));
+  CHECK(!exists);
+  CHECK_EQ(MemoryUsage(client), base);
+  LOG(INFO) << "Passed device blob tests...";
+
+  client.Disconnect();
+
+  return 0;
+}
@@ -0,0 +1,194 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "arrow/api.h"
+
+#include "basic/ds/arrow.h"
+#include "basic/ds/encoded_array.h"
+#include "client/client.h"
+#include "client/ds/object_meta.h"
+#include "common/util/logging.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    printf("usage ./encoded_array_test <ipc_socket>");
+    return 1;
+  }
+  std::string ipc_socket = std::string(argv[1]);
+
+  Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+  LOG(INFO) << "Connected to IPCServer: " << ipc_socket;
+
+  const int64_t length = 10000;
+
+  std::shared_ptr<arrow::Int64Array> a1;
+  {
+    arrow::Int64Builder builder;
+    for (int64_t i = 0; i < length; ++i) {
+      if (i % 97 == 0) {
+        CHECK_ARROW_ERROR(builder.AppendNull());
+      } else {
+        CHECK_ARROW_ERROR(builder.Append(1000000 + (i * 7) % 200));
+      }
+    }
+    CHECK_ARROW_ERROR(builder.Finish(&a1));
+  }
+
+  std::shared_ptr<arrow::StringArray> a2;
+  {
+    std::vector<std::string> words{"alpha", "beta", "gamma", "delta"};
+    arrow::StringBuilder builder;
+    for (int64_t i = 0; i < length; ++i) {
+      if (i % 89 == 0) {
+        CHECK_ARROW_ERROR(builder.AppendNull());
+      } else {
+        CHECK_ARROW_ERROR(builder.Append(words[i % words.size()]));
+      }
+    }
+    CHECK_ARROW_ERROR(builder.Finish(&a2));
+  }
+
+  std::shared_ptr<arrow::BooleanArray> a3;
+  {
+    arrow::BooleanBuilder builder;
+    for (int64_t i = 0; i < length; ++i) {
+      if (i >= 5000 && i < 5010) {
+        CHECK_ARROW_ERROR(builder.AppendNull());
+      } else {
+        CHECK_ARROW_ERROR(builder.Append((i / 1000) % 2 == 0));
+      }
+    }
+    CHECK_ARROW_ERROR(builder.Finish(&a3));
+  }
+
+  {
+    LOG(INFO) << "#########  Bit-packed Array Test ##########";
+    BitPackedArrayBuilder<int64_t> builder(client, a1);
+    CHECK(builder.Encodable());
+    auto r1 = std::dynamic_pointer_cast<BitPackedArray<int64_t>>(
+        builder.Seal(client));
+    CHECK(r1 != nullptr);
+    CHECK_LE(r1->bit_width(), 8);
+    CHECK(r1->GetArray()->Equals(*a1));
+    for (int64_t i = 1; i < length; i += 101) {
+      if (a1->IsValid(i)) {
+        CHECK_EQ(r1->Value(i), a1->Value(i));
+      }
+    }
+
+    auto r2 = std::dynamic_pointer_cast<BitPackedArray<int64_t>>(
+        client.GetObject(r1->id()));
+    CHECK(r2->ToArray()->Equals(*a1));
+
+    // sliced arrays
+    auto sliced = std::dynamic_pointer_cast<arrow::Int64Array>(
+        a1->Slice(1003, 4000));
+    BitPackedArrayBuilder<int64_t> sliced_builder(client, sliced);
+    auto r3 = sliced_builder.Seal(client);
+    CHECK(std::dynamic_pointer_cast<BitPackedArray<int64_t>>(r3)
+              ->GetArray()
+              ->Equals(*sliced));
+
+    std::shared_ptr<Object> decompressed;
+    VINEYARD_CHECK_OK(Decompress(client, r1, decompressed));
+    auto r4 = std::dynamic_pointer_cast<NumericArray<int64_t>>(decompressed);
+    CHECK(r4 != nullptr);
+    CHECK(r4->GetArray()->Equals(*a1));
+
+    LOG(INFO) << "Passed bit-packed array tests...";
+  }
+
+  {
+    LOG(INFO) << "#########  Dictionary Array Test ##########";
+    DictionaryStringArrayBuilder builder(client, a2);
+    CHECK(builder.Encodable());
+    auto r1 =
+        std::dynamic_pointer_cast<DictionaryStringArray>(builder.Seal(client));
+    CHECK(r1 != nullptr);
+    CHECK(r1->GetArray()->Equals(*a2));
+
+    auto r2 = std::dynamic_pointer_cast<DictionaryStringArray>(
+        client.GetObject(r1->id()));
+    CHECK(r2->ToArray()->Equals(*a2));
+
+    std::shared_ptr<Object> decompressed;
+    VINEYARD_CHECK_OK(Decompress(client, r1, decompressed));
+    auto r3 = std::dynamic_pointer_cast<StringArray>(decompressed);
+    CHECK(r3 != nullptr);
+    CHECK(r3->GetArray()->Equals(*a2));
+
+    LOG(INFO) << "Passed dictionary array tests...";
+  }
+
+  {
+    LOG(INFO) << "#########  Run-length Boolean Array Test ##########";
+    RunLengthBooleanArrayBuilder builder(client, a3);
+    CHECK(builder.Encodable());
+    auto r1 =
+        std::dynamic_pointer_cast<RunLengthBooleanArray>(builder.Seal(client));
+    CHECK(r1 != nullptr);
+    CHECK(r1->GetArray()->Equals(*a3));
+
+    std::shared_ptr<Object> decompressed;
+    VINEYARD_CHECK_OK(Decompress(client, r1, decompressed));
+    auto r2 = std::dynamic_pointer_cast<BooleanArray>(decompressed);
+    CHECK(r2 != nullptr);
+    CHECK(r2->GetArray()->Equals(*a3));
+
+    LOG(INFO) << "Passed run-length boolean array tests...";
+  }
+
+  {
+    LOG(INFO) << "#########  Compressed Table Test ##########";
+    std::shared_ptr<arrow::Array> a4;
+    {
+      // random-like doubles are kept as is
+      arrow::DoubleBuilder builder;
+      for (int64_t i = 0; i < length; ++i) {
+        CHECK_ARROW_ERROR(builder.Append(i * 0.618));
+      }
+      CHECK_ARROW_ERROR(builder.Finish(&a4));
+    }
+    auto schema = arrow::schema({arrow::field("a", arrow::int64()),
+                                 arrow::field("b", arrow::utf8()),
+                                 arrow::field("c", arrow::boolean()),
+                                 arrow::field("d", arrow::float64())});
+    std::vector<std::shared_ptr<arrow::Array>> columns{a1, a2, a3, a4};
+    auto table = arrow::Table::Make(schema, columns);
+
+    TableBuilder builder(client, table);
+    builder.SetCompression(true);
+    auto r1 = std::dynamic_pointer_cast<Table>(builder.Seal(client));
+    CHECK(r1->GetTable()->Equals(*table));
+
+    auto r2 = std::dynamic_pointer_cast<Table>(client.GetObject(r1->id()));
+    CHECK(r2->GetTable()->Equals(*table));
+
+    LOG(INFO) << "Passed compressed table tests...";
+  }
+
+  LOG(INFO) << "Passed encoded array tests...";
+
+  client.Disconnect();
+
+  return 0;
+}
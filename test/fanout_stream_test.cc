@@ -0,0 +1,147 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <unistd.h>
+
+#include <memory>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "arrow/status.h"
+#include "arrow/util/io_util.h"
+#include "arrow/util/logging.h"
+
+#include "basic/stream/byte_stream.h"
+#include "client/client.h"
+#include "client/ds/object_meta.h"
+#include "common/util/logging.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    printf("usage ./fanout_stream_test <ipc_socket>");
+    return 1;
+  }
+  std::string ipc_socket = std::string(argv[1]);
+
+  Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+  LOG(INFO) << "Connected to IPCServer: " << ipc_socket;
+
+  ObjectID stream_id = InvalidObjectID();
+  {
+    ByteStreamBuilder builder(client);
+    builder.SetParams(std::unordered_map<std::string, std::string>{
+        {"kind", "test"}, {"test_name", "fanout_stream_test"}});
+    auto bstream = std::dynamic_pointer_cast<ByteStream>(builder.Seal(client));
+    stream_id = bstream->id();
+    CHECK(stream_id != InvalidObjectID());
+  }
+
+  const size_t num_consumers = 3, num_chunks = 16;
+
+  // every consumer opens the stream before the producer starts, thus all of
+  // them see every chunk.
+  std::vector<std::unique_ptr<Client>> clients;
+  std::vector<std::unique_ptr<ByteStreamReader>> readers;
+  for (size_t idx = 0; idx < num_consumers; ++idx) {
+    clients.emplace_back(new Client());
+    VINEYARD_CHECK_OK(clients.back()->Connect(ipc_socket));
+    auto byte_stream = clients.back()->GetObject<ByteStream>(stream_id);
+    CHECK(byte_stream != nullptr);
+    std::unique_ptr<ByteStreamReader> reader;
+    VINEYARD_CHECK_OK(byte_stream->OpenReader(*clients.back(), reader, true));
+    readers.emplace_back(std::move(reader));
+
+    // the same consumer cannot open it twice
+    std::unique_ptr<ByteStreamReader> failed_reader;
+    CHECK(byte_stream->OpenReader(*clients.back(), failed_reader, true)
+              .IsStreamOpened());
+  }
+
+  {
+    // an exclusive reader cannot join a broadcast stream
+    auto byte_stream = client.GetObject<ByteStream>(stream_id);
+    std::unique_ptr<ByteStreamReader> failed_reader;
+    CHECK(byte_stream->OpenReader(client, failed_reader).IsStreamOpened());
+  }
+
+  std::vector<std::vector<size_t>> recv_chunks_size(num_consumers);
+  std::vector<std::thread> recv_thrds;
+  for (size_t idx = 0; idx < num_consumers; ++idx) {
+    recv_thrds.emplace_back([&, idx]() {
+      while (true) {
+        std::unique_ptr<arrow::Buffer> buffer = nullptr;
+        auto status = readers[idx]->GetNext(buffer);
+        if (status.ok()) {
+          CHECK(buffer != nullptr);
+          recv_chunks_size[idx].emplace_back(buffer->size());
+          // the first consumer is the slowest one
+          if (idx == 0) {
+            usleep(100 * 1000);
+          }
+        } else {
+          CHECK(status.IsStreamDrained());
+          break;
+        }
+      }
+    });
+  }
+
+  std::vector<size_t> send_chunks_size;
+  std::thread send_thrd([&]() {
+    Client writer_client;
+    VINEYARD_CHECK_OK(writer_client.Connect(ipc_socket));
+
+    auto byte_stream = writer_client.GetObject<ByteStream>(stream_id);
+    CHECK(byte_stream != nullptr);
+
+    std::unique_ptr<ByteStreamWriter> writer;
+    VINEYARD_CHECK_OK(byte_stream->OpenWriter(writer_client, writer));
+    for (size_t idx = 1; idx <= num_chunks; ++idx) {
+      std::unique_ptr<arrow::MutableBuffer> buffer = nullptr;
+      VINEYARD_CHECK_OK(writer->GetNext(idx * 1024, buffer));
+      CHECK(buffer != nullptr);
+      send_chunks_size.emplace_back(idx * 1024);
+    }
+    VINEYARD_CHECK_OK(writer->Finish());
+  });
+
+  send_thrd.join();
+  for (auto& thrd : recv_thrds) {
+    thrd.join();
+  }
+
+  for (size_t idx = 0; idx < num_consumers; ++idx) {
+    CHECK_EQ(send_chunks_size.size(), recv_chunks_size[idx].size());
+    for (size_t chunk = 0; chunk < send_chunks_size.size(); ++chunk) {
+      CHECK_EQ(send_chunks_size[chunk], recv_chunks_size[idx][chunk]);
+    }
+  }
+
+  readers.clear();
+  for (auto& reader_client : clients) {
+    reader_client->Disconnect();
+  }
+
+  LOG(INFO) << "Passed fanout stream tests...";
+
+  client.Disconnect();
+
+  return 0;
+}
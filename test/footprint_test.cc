@@ -0,0 +1,94 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "arrow/status.h"
+#include "arrow/util/io_util.h"
+#include "arrow/util/logging.h"
+
+#include "basic/ds/array.h"
+#include "client/client.h"
+#include "client/ds/object_meta.h"
+#include "common/util/logging.h"
+#include "common/util/typename.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    printf("usage ./footprint_test <ipc_socket>");
+    return 1;
+  }
+  std::string ipc_socket = std::string(argv[1]);
+
+  Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+  LOG(INFO) << "Connected to IPCServer: " << ipc_socket;
+
+  std::vector<double> large(1000, 1.0), small(10, 2.0);
+  ArrayBuilder<double> large_builder(client, large);
+  auto large_array = large_builder.Seal(client);
+  ArrayBuilder<double> small_builder(client, small);
+  auto small_array = small_builder.Seal(client);
+
+  std::vector<ObjectFootprint> objects;
+  std::map<std::string, TypeFootprint> types;
+  {
+    VINEYARD_CHECK_OK(client.Footprints(
+        {large_array->id(), small_array->id()}, 0, objects, types));
+    CHECK_EQ(objects.size(), 2);
+    CHECK_EQ(objects[0].id, large_array->id());
+    CHECK_EQ(objects[0].size, large.size() * sizeof(double));
+    CHECK_EQ(objects[0].type_name, type_name<Array<double>>());
+    CHECK_EQ(objects[1].id, small_array->id());
+    CHECK_EQ(objects[1].size, small.size() * sizeof(double));
+
+    auto type = types.find(type_name<Array<double>>());
+    CHECK(type != types.end());
+    CHECK_GE(type->second.objects, 2);
+    CHECK_GE(type->second.size, (large.size() + small.size()) * sizeof(double));
+    LOG(INFO) << "Passed footprints of objects tests...";
+  }
+
+  {
+    // the largest objects
+    VINEYARD_CHECK_OK(client.Footprints({}, 1, objects, types));
+    CHECK_EQ(objects.size(), 1);
+    CHECK_GE(objects[0].size, large.size() * sizeof(double));
+    LOG(INFO) << "Passed largest footprints tests...";
+  }
+
+  {
+    // deleted objects are not accounted anymore
+    VINEYARD_CHECK_OK(client.DelData(large_array->id()));
+    VINEYARD_CHECK_OK(client.Footprints({large_array->id(), small_array->id()},
+                                        0, objects, types));
+    CHECK_EQ(objects.size(), 1);
+    CHECK_EQ(objects[0].id, small_array->id());
+    VINEYARD_CHECK_OK(client.DelData(small_array->id()));
+    LOG(INFO) << "Passed footprints of deleted objects tests...";
+  }
+
+  LOG(INFO) << "Passed footprint tests...";
+
+  client.Disconnect();
+
+  return 0;
+}
@@ -0,0 +1,88 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <memory>
+#include <string>
+#include <thread>
+
+#include "arrow/status.h"
+#include "arrow/util/io_util.h"
+#include "arrow/util/logging.h"
+
+#include "basic/ds/array.h"
+#include "client/client.h"
+#include "client/ds/object_meta.h"
+#include "client/profile.h"
+#include "common/util/logging.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    printf("usage ./get_object_profile_test <ipc_socket>");
+    return 1;
+  }
+  std::string ipc_socket = std::string(argv[1]);
+
+  Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+  LOG(INFO) << "Connected to IPCServer: " << ipc_socket;
+
+  std::vector<double> double_array = {1.0, 7.0, 3.0, 4.0, 2.0};
+  ArrayBuilder<double> builder(client, double_array);
+  auto sealed = builder.Seal(client);
+
+  {
+    CHECK(client.GetProfile() == nullptr);
+    auto array = client.GetObject<Array<double>>(sealed->id());
+    CHECK(array != nullptr);
+    LOG(INFO) << "Passed profiling disabled tests...";
+  }
+
+  client.EnableProfiling();
+  GetObjectProfile* profile = client.GetProfile();
+  CHECK(profile != nullptr);
+
+  {
+    auto array = client.GetObject<Array<double>>(sealed->id());
+    CHECK(array != nullptr);
+    CHECK_EQ(array->size(), double_array.size());
+    std::shared_ptr<Object> object;
+    VINEYARD_CHECK_OK(client.GetObject(sealed->id(), object));
+
+    auto costs = profile->Costs();
+    auto cost = costs.find(type_name<Array<double>>());
+    CHECK(cost != costs.end());
+    CHECK_EQ(cost->second.calls, 2);
+    CHECK_GT(cost->second.durations[GetObjectProfile::kGetData], 0);
+    CHECK_GT(cost->second.durations[GetObjectProfile::kConstruct], 0);
+    for (int phase = 0; phase < GetObjectProfile::kPhases; ++phase) {
+      CHECK_GE(cost->second.durations[phase], 0);
+    }
+    LOG(INFO) << "The costs of GetObject:" << std::endl << profile->ToString();
+    LOG(INFO) << "Passed profiling tests...";
+  }
+
+  {
+    profile->Reset();
+    CHECK(profile->Costs().empty());
+    LOG(INFO) << "Passed profiling reset tests...";
+  }
+
+  client.Disconnect();
+
+  LOG(INFO) << "Passed get object profile tests...";
+  return 0;
+}
@@ -16,12 +16,14 @@ limitations under the License.
 #include <memory>
 #include <string>
 #include <thread>
+#include <vector>
 
 #include "arrow/status.h"
 #include "arrow/util/io_util.h"
 #include "arrow/util/logging.h"
 
 #include "basic/ds/array.h"
+#include "basic/ds/pair.h"
 #include "client/client.h"
 #include "client/ds/object_meta.h"
 #include "common/util/logging.h"
@@ -84,6 +86,100 @@ int main(int argc, char** argv) {
   CHECK_EQ(arrays[0]->id(), id);
   CHECK_EQ(arrays[1]->id(), copied_id);
 
+  {
+    // members are fetched on demand in the lazy mode
+    PairBuilder pair_builder(client);
+    pair_builder.SetFirst(
+        std::make_shared<ArrayBuilder<double>>(client, double_array));
+    pair_builder.SetSecond(
+        std::make_shared<ArrayBuilder<double>>(client, double_array));
+    auto pair = pair_builder.Seal(client);
+
+    ObjectMeta meta;
+    VINEYARD_CHECK_OK(client.GetMetaData(pair->id(), meta, false, true));
+    CHECK(meta.MetaData()["first_"].value("lazy", false));
+    CHECK(meta.GetBufferSet()->AllBufferIds().empty());
+
+    auto first =
+        std::dynamic_pointer_cast<Array<double>>(meta.GetMember("first_"));
+    CHECK(first != nullptr);
+    CHECK_EQ(first->size(), double_array.size());
+    CHECK_EQ((*first)[1], double_array[1]);
+    CHECK_EQ(meta.GetBufferSet()->AllBuffers().size(), 1);
+
+    // the copies share the fetched lazy members
+    std::vector<std::thread> threads;
+    for (size_t idx = 0; idx < 4; ++idx) {
+      threads.emplace_back([meta]() {
+        ObjectMeta member;
+        VINEYARD_CHECK_OK(meta.GetMemberMeta("second_", member));
+        CHECK_EQ(member.GetTypeName(), type_name<Array<double>>());
+      });
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+    CHECK_EQ(meta.GetBufferSet()->AllBuffers().size(), 2);
+  }
+
+  {
+    // the lazy member that has been deleted cannot be fetched
+    PairBuilder pair_builder(client);
+    pair_builder.SetFirst(
+        std::make_shared<ArrayBuilder<double>>(client, double_array));
+    pair_builder.SetSecond(
+        std::make_shared<ArrayBuilder<double>>(client, double_array));
+    auto pair = pair_builder.Seal(client);
+
+    ObjectMeta meta;
+    VINEYARD_CHECK_OK(client.GetMetaData(pair->id(), meta, false, true));
+    ObjectID first_id = VYObjectIDFromString(
+        meta.MetaData()["first_"]["id"].get_ref<std::string const&>());
+    VINEYARD_CHECK_OK(client.DelData(first_id, true, true));
+    ObjectMeta member;
+    CHECK(!meta.GetMemberMeta("first_", member).ok());
+  }
+
+  {
+    // large batches are constructed in parallel
+    std::vector<ObjectID> ids;
+    for (size_t idx = 0; idx < 256; ++idx) {
+      ArrayBuilder<double> builder(client, double_array);
+      ids.emplace_back(builder.Seal(client)->id());
+    }
+    std::vector<std::shared_ptr<Object>> objects;
+    VINEYARD_CHECK_OK(client.GetObjects(ids, objects));
+    CHECK_EQ(objects.size(), ids.size());
+    for (size_t idx = 0; idx < ids.size(); ++idx) {
+      auto array = std::dynamic_pointer_cast<Array<double>>(objects[idx]);
+      CHECK(array != nullptr);
+      CHECK_EQ(array->id(), ids[idx]);
+      CHECK_EQ((*array)[4], double_array[4]);
+    }
+
+    ids.emplace_back(GenerateObjectID());
+    auto status = client.GetObjects(ids, objects);
+    CHECK(status.IsObjectNotExists());
+  }
+
+  {
+    // the hints don't change the content
+    for (auto hint : {AccessHint::sequential, AccessHint::random,
+                      AccessHint::willneed, AccessHint::populate,
+                      AccessHint::normal}) {
+      std::shared_ptr<Object> object;
+      VINEYARD_CHECK_OK(client.GetObject(id, hint, object));
+      auto array = std::dynamic_pointer_cast<Array<double>>(object);
+      CHECK(array != nullptr);
+      VINEYARD_CHECK_OK(client.Advise(*array, hint, false));
+      for (size_t idx = 0; idx < double_array.size(); ++idx) {
+        CHECK_EQ((*array)[idx], double_array[idx]);
+      }
+    }
+    CHECK(client.Advise(*sealed_double_array, static_cast<AccessHint>(-1))
+              .IsInvalid());
+  }
+
   LOG(INFO) << "Passed various ways to get object tests...";
 
   client.Disconnect();
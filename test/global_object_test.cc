@@ -16,6 +16,7 @@ limitations under the License.
 #include <memory>
 #include <string>
 #include <thread>
+#include <vector>
 
 #include "arrow/status.h"
 #include "arrow/util/io_util.h"
@@ -63,6 +64,26 @@ void testGlobalTensor(Client& client) {
     CHECK(!tensor->meta().IsGlobal());
     CHECK(global_tensor->meta().IsGlobal());
   }
+
+  {
+    std::map<InstanceID, size_t> locality;
+    VINEYARD_CHECK_OK(client.LocalityInfo(global_tensor_id, locality));
+    CHECK_EQ(locality.size(), 1);
+    CHECK_EQ(locality.begin()->first, client.instance_id());
+    CHECK_EQ(locality.begin()->second, 6 * sizeof(double));
+
+    ObjectID unknown_id = GenerateObjectID();
+    CHECK(client.LocalityInfo(unknown_id, locality).IsObjectNotExists());
+  }
+
+  {
+    size_t nbytes = 0;
+    VINEYARD_CHECK_OK(client.Prefetch({global_tensor_id}, nbytes));
+    CHECK_EQ(nbytes, 6 * sizeof(double));
+    VINEYARD_CHECK_OK(
+        client.Prefetch({tensor_id}, client.instance_id(), nbytes));
+    CHECK_EQ(nbytes, 6 * sizeof(double));
+  }
 }
 
 void testGlobalDataFrame(Client& client) {
@@ -187,6 +208,44 @@ void testDelete(Client& client) {
   }
 }
 
+void testTransientPartitions(Client& client) {
+  // the partitions are not persisted before building the global dataframe
+  std::vector<ObjectID> dataframe_ids;
+  for (int i = 0; i < 8; ++i) {
+    DataFrameBuilder builder(client);
+    {
+      auto tb = std::make_shared<TensorBuilder<double>>(
+          client, std::vector<int64_t>{100});
+      builder.AddColumn("a", tb);
+    }
+    dataframe_ids.emplace_back(builder.Seal(client)->id());
+  }
+
+  ObjectID global_dataframe_id = InvalidObjectID();
+  {
+    GlobalDataFrameBuilder builder(client);
+    builder.set_partition_shape(8, 1);
+    builder.AddPartitions(dataframe_ids);
+    auto global_dataframe = builder.Seal(client);
+    CHECK(global_dataframe->IsPersist());
+    global_dataframe_id = global_dataframe->id();
+  }
+
+  {
+    auto global_dataframe =
+        client.GetObject<GlobalDataFrame>(global_dataframe_id);
+    CHECK(global_dataframe->meta().IsGlobal());
+    CHECK_EQ(global_dataframe->LocalPartitions(client).size(),
+             dataframe_ids.size());
+    for (auto const& id : dataframe_ids) {
+      bool persist = false;
+      VINEYARD_CHECK_OK(client.IfPersist(id, persist));
+      CHECK(persist);
+    }
+  }
+  VINEYARD_CHECK_OK(client.DelData(global_dataframe_id, true, true));
+}
+
 int main(int argc, char** argv) {
   if (argc < 2) {
     printf("usage ./global_object_test <ipc_socket>");
@@ -201,6 +260,7 @@ int main(int argc, char** argv) {
   testGlobalTensor(client);
   testGlobalDataFrame(client);
   testDelete(client);
+  testTransientPartitions(client);
 
   client.Disconnect();
 
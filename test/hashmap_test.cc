@@ -16,6 +16,7 @@ limitations under the License.
 #include <memory>
 #include <string>
 #include <thread>
+#include <vector>
 
 #include "arrow/status.h"
 #include "arrow/util/io_util.h"
@@ -70,6 +71,19 @@ int main(int argc, char** argv) {
     CHECK_DOUBLE_EQ(pair.second, vy_hashmap->at(pair.first));
   }
 
+  std::vector<int> keys{1, 2, 3, 4, 5, 6, 7};
+  std::vector<Hashmap<int, double>::iterator> results(keys.size());
+  CHECK_EQ(vy_hashmap->find(keys.data(), keys.size(), results.data()),
+           builder.size());
+  for (size_t i = 0; i < keys.size(); ++i) {
+    if (builder.find(keys[i]) != builder.end()) {
+      CHECK(results[i] != vy_hashmap->end());
+      CHECK_DOUBLE_EQ(results[i]->second, builder.at(keys[i]));
+    } else {
+      CHECK(results[i] == vy_hashmap->end());
+    }
+  }
+
   LOG(INFO) << "Passed double hashmap tests...";
 
   client.Disconnect();
@@ -0,0 +1,125 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <fstream>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "arrow/status.h"
+#include "arrow/util/io_util.h"
+#include "arrow/util/logging.h"
+
+#include "client/client.h"
+#include "client/ds/blob.h"
+#include "client/ds/object_meta.h"
+#include "common/util/logging.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+// the server runs with `--reserve_memory_hugepages`, see also
+// `test/runner.py`, and falls back to normal pages when huge pages are not
+// reserved in the system.
+//
+// the sizes are not multiples of the (huge) pages, the mappings in clients
+// must be aligned to the page size of segments.
+const std::vector<size_t> kBlobSizes = {1, 4095, 2 * 1024 * 1024 - 1,
+                                        2 * 1024 * 1024 + 1,
+                                        9 * 1024 * 1024 + 17};
+
+char ValueAt(size_t index, size_t i) {
+  return static_cast<char>(i * 13 + index);
+}
+
+int64_t ReadMeminfo(const std::string& field) {
+  std::ifstream meminfo("/proc/meminfo");
+  std::string key;
+  while (meminfo >> key) {
+    if (key == field) {
+      int64_t value = 0;
+      meminfo >> value;
+      return value;
+    }
+    meminfo.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+  }
+  return 0;
+}
+
+// the hugetlb segments are mapped from the memfd named by the server
+bool HugePageSegmentMapped() {
+  std::ifstream maps("/proc/self/maps");
+  std::string line;
+  while (std::getline(maps, line)) {
+    if (line.find("memfd:vineyard-bulk") != std::string::npos) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void CheckBlobs(Client& client, const std::vector<ObjectID>& ids) {
+  std::vector<std::shared_ptr<Blob>> blobs;
+  VINEYARD_CHECK_OK(client.GetBlobs(ids, blobs));
+  CHECK_EQ(blobs.size(), ids.size());
+  for (size_t index = 0; index < blobs.size(); ++index) {
+    CHECK_EQ(blobs[index]->size(), kBlobSizes[index]);
+    for (size_t i = 0; i < kBlobSizes[index]; ++i) {
+      CHECK_EQ(blobs[index]->data()[i], ValueAt(index, i));
+    }
+  }
+}
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    printf("usage ./hugepage_test <ipc_socket>");
+    return 1;
+  }
+  std::string ipc_socket = std::string(argv[1]);
+
+  Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+  LOG(INFO) << "Connected to IPCServer: " << ipc_socket;
+
+  std::vector<ObjectID> ids;
+  for (size_t index = 0; index < kBlobSizes.size(); ++index) {
+    std::unique_ptr<BlobWriter> writer;
+    VINEYARD_CHECK_OK(client.CreateBlob(kBlobSizes[index], writer));
+    for (size_t i = 0; i < kBlobSizes[index]; ++i) {
+      writer->data()[i] = ValueAt(index, i);
+    }
+    ids.emplace_back(writer->Seal(client)->id());
+  }
+  if (ReadMeminfo("HugePages_Total:") == 0) {
+    CHECK(!HugePageSegmentMapped());
+  }
+  LOG(INFO) << "Huge pages are "
+            << (HugePageSegmentMapped() ? "used" : "not available");
+
+  // the segments are mapped (and unmapped) by other clients as well
+  for (int round = 0; round < 3; ++round) {
+    Client reader;
+    VINEYARD_CHECK_OK(reader.Connect(ipc_socket));
+    CheckBlobs(reader, ids);
+    reader.Disconnect();
+  }
+  CheckBlobs(client, ids);
+  LOG(INFO) << "Passed huge page blob tests...";
+
+  VINEYARD_CHECK_OK(client.DelData(ids));
+  client.Disconnect();
+
+  return 0;
+}
@@ -15,6 +15,9 @@ limitations under the License.
 
 #include <bitset>
 #include <iostream>
+#include <thread>
+#include <unordered_set>
+#include <vector>
 
 #include "common/util/logging.h"
 #include "common/util/uuid.h"
@@ -29,4 +32,37 @@ int main() {
   ObjectID id2 = vineyard::GenerateObjectID();
   LOG(INFO) << id2 << "\n";
   CHECK(!vineyard::IsBlob(id2));
+
+  // ids generated concurrently are unique
+  const int threads = 8, ids_per_thread = 100000;
+  std::vector<std::vector<ObjectID>> generated(threads);
+  std::vector<std::thread> workers;
+  for (int i = 0; i < threads; ++i) {
+    workers.emplace_back([&generated, i]() {
+      for (int j = 0; j < ids_per_thread; ++j) {
+        generated[i].emplace_back(vineyard::GenerateObjectID());
+      }
+    });
+  }
+  for (auto& worker : workers) {
+    worker.join();
+  }
+  std::unordered_set<ObjectID> unique_ids;
+  for (auto const& ids : generated) {
+    for (auto const& id : ids) {
+      CHECK(!vineyard::IsBlob(id));
+      CHECK(unique_ids.emplace(id).second);
+    }
+  }
+
+  // the instance id prefixes the generated ids
+  CHECK(vineyard::SetIDGeneratorInstanceID(42));
+  ObjectID id3 = vineyard::GenerateObjectID();
+  CHECK_EQ(id3 >> 48, 42UL);
+  CHECK(!vineyard::IsBlob(id3));
+  // the instance ids that don't fit in the prefix are rejected
+  CHECK(!vineyard::SetIDGeneratorInstanceID(32767));
+  CHECK(!vineyard::SetIDGeneratorInstanceID(42 + 32767));
+  CHECK_EQ(vineyard::GenerateObjectID() >> 48, 42UL);
+  CHECK(vineyard::SetIDGeneratorInstanceID(vineyard::UnspecifiedInstanceID()));
 }
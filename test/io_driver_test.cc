@@ -0,0 +1,123 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "arrow/api.h"
+
+#include "basic/ds/arrow.h"
+#include "client/client.h"
+#include "common/util/logging.h"
+#include "io/io/io_driver.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+std::string makeFile(const int64_t rows) {
+  char path[] = "/tmp/vineyard_io_driver_test_XXXXXX";
+  int fd = mkstemp(path);
+  CHECK_NE(fd, -1);
+  close(fd);
+  std::ofstream out(path);
+  out << "id,name\n";
+  for (int64_t row = 0; row < rows; ++row) {
+    out << row << ",name-" << row << "\n";
+  }
+  out.close();
+  CHECK(out.good());
+  return path;
+}
+
+// the parts are read into sealed tables, which hold every row of the file
+// exactly once, in order
+void testReadTable(Client& client, const int64_t rows, const int proc_num) {
+  std::string path = makeFile(rows);
+
+  std::vector<ObjectID> table_ids(proc_num, InvalidObjectID());
+  {
+    IODriver driver(client, 4);
+    for (int proc_index = 0; proc_index < proc_num; ++proc_index) {
+      VINEYARD_CHECK_OK(driver.ReadTable(path + "#header_row=true", proc_num,
+                                         proc_index, table_ids[proc_index]));
+    }
+    VINEYARD_CHECK_OK(driver.Wait());
+  }
+
+  int64_t row = 0;
+  for (auto const& table_id : table_ids) {
+    if (table_id == InvalidObjectID()) {
+      continue;  // no records in the part
+    }
+    auto table = client.GetObject<Table>(table_id);
+    CHECK(table != nullptr);
+    auto arrow_table = table->GetTable();
+    CHECK_EQ(arrow_table->num_columns(), 2);
+    CHECK_EQ(arrow_table->field(0)->name(), "id");
+    CHECK_EQ(arrow_table->field(1)->name(), "name");
+    for (int chunk = 0; chunk < arrow_table->column(0)->num_chunks();
+         ++chunk) {
+      auto ids = std::dynamic_pointer_cast<arrow::Int64Array>(
+          arrow_table->column(0)->chunk(chunk));
+      CHECK(ids != nullptr);
+      auto names = arrow_table->column(1)->chunk(chunk);
+      for (int64_t index = 0; index < ids->length(); ++index, ++row) {
+        CHECK_EQ(ids->Value(index), row);
+        std::string name =
+            names->type()->id() == arrow::Type::LARGE_STRING
+                ? std::dynamic_pointer_cast<arrow::LargeStringArray>(names)
+                      ->GetString(index)
+                : std::dynamic_pointer_cast<arrow::StringArray>(names)
+                      ->GetString(index);
+        CHECK_EQ(name, "name-" + std::to_string(row));
+      }
+    }
+    VINEYARD_CHECK_OK(client.DelData(table_id, true, true));
+  }
+  CHECK_EQ(row, rows);
+
+  unlink(path.c_str());
+}
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    printf("usage ./io_driver_test <ipc_socket>");
+    return 1;
+  }
+  std::string ipc_socket = std::string(argv[1]);
+
+  Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+  LOG(INFO) << "Connected to IPCServer: " << ipc_socket;
+
+  testReadTable(client, 500000, 1);
+  testReadTable(client, 500000, 3);
+  LOG(INFO) << "Passed the read table tests...";
+
+  // some of the parts have no records
+  testReadTable(client, 3, 8);
+  LOG(INFO) << "Passed the read table with empty parts tests...";
+
+  LOG(INFO) << "Passed io driver tests...";
+
+  client.Disconnect();
+
+  return 0;
+}
@@ -0,0 +1,83 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <stdlib.h>
+
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "arrow/status.h"
+#include "arrow/util/io_util.h"
+#include "arrow/util/logging.h"
+
+#include "basic/ds/array.h"
+#include "client/client.h"
+#include "client/ds/object_meta.h"
+#include "common/util/logging.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    printf("usage ./ipc_ring_test <ipc_socket>");
+    return 1;
+  }
+  std::string ipc_socket = std::string(argv[1]);
+
+  // opt in the shared memory ring before connecting
+  setenv("VINEYARD_IPC_RING", "1", 1);
+
+  Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+  LOG(INFO) << "Connected to IPCServer: " << ipc_socket;
+
+  std::vector<ObjectID> ids;
+  for (size_t round = 0; round < 100; ++round) {
+    std::vector<double> double_array = {1.0, 7.0, 3.0, 4.0, 2.0};
+    double_array.push_back(static_cast<double>(round));
+    ArrayBuilder<double> builder(client, double_array);
+    auto sealed_double_array =
+        std::dynamic_pointer_cast<Array<double>>(builder.Seal(client));
+    ids.emplace_back(sealed_double_array->id());
+
+    std::shared_ptr<Array<double>> array;
+    VINEYARD_CHECK_OK(client.GetObject(ids.back(), array));
+    CHECK_EQ(array->size(), double_array.size());
+    for (size_t i = 0; i < double_array.size(); ++i) {
+      CHECK_EQ((*array)[i], double_array[i]);
+    }
+  }
+
+  // batched requests and replies
+  {
+    std::vector<ObjectMeta> metas;
+    VINEYARD_CHECK_OK(client.GetMetaData(ids, metas));
+    CHECK_EQ(metas.size(), ids.size());
+  }
+
+  // errors are replied through the ring as well
+  {
+    ObjectMeta meta;
+    CHECK(!client.GetMetaData(GenerateObjectID(), meta).ok());
+  }
+
+  LOG(INFO) << "Passed ipc ring tests...";
+
+  client.Disconnect();
+
+  return 0;
+}
@@ -0,0 +1,246 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "arrow/api.h"
+
+#include "basic/ds/arrow.h"
+#include "basic/ds/dataframe.h"
+#include "basic/ds/kernels.h"
+#include "client/client.h"
+#include "client/ds/object_meta.h"
+#include "common/util/logging.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+using kernels::CompareOp;
+using kernels::SelectionVector;
+
+template <typename T>
+bool Matches(T const lhs, CompareOp const op, T const rhs) {
+  switch (op) {
+  case CompareOp::kEqual:
+    return lhs == rhs;
+  case CompareOp::kNotEqual:
+    return lhs != rhs;
+  case CompareOp::kLess:
+    return lhs < rhs;
+  case CompareOp::kLessEqual:
+    return lhs <= rhs;
+  case CompareOp::kGreater:
+    return lhs > rhs;
+  case CompareOp::kGreaterEqual:
+    return lhs >= rhs;
+  }
+  return false;
+}
+
+template <typename T>
+void CheckCompare(std::vector<T> const& values, T const value) {
+  for (int op = 0; op <= static_cast<int>(CompareOp::kGreaterEqual); ++op) {
+    // unaligned heads and unfilled tails
+    for (int64_t offset = 0; offset < 3; ++offset) {
+      int64_t length = values.size() - offset;
+      SelectionVector selection(length);
+      int64_t count = kernels::Compare(values.data() + offset, length,
+                                       static_cast<CompareOp>(op), value,
+                                       selection.data());
+      SelectionVector expected;
+      for (int64_t idx = 0; idx < length; ++idx) {
+        if (Matches(values[offset + idx], static_cast<CompareOp>(op), value)) {
+          expected.emplace_back(idx);
+        }
+      }
+      selection.resize(count);
+      CHECK(selection == expected);
+    }
+  }
+}
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    printf("usage ./kernels_test <ipc_socket>");
+    return 1;
+  }
+  std::string ipc_socket = std::string(argv[1]);
+
+  Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+  LOG(INFO) << "Connected to IPCServer: " << ipc_socket;
+
+  const int64_t length = 1003;
+
+  {
+    LOG(INFO) << "#########  Compare Test ##########";
+    std::vector<int32_t> i32(length);
+    std::vector<uint32_t> u32(length);
+    std::vector<int64_t> i64(length);
+    std::vector<uint64_t> u64(length);
+    std::vector<float> f32(length);
+    std::vector<double> f64(length);
+    std::vector<int8_t> i8(length);
+    for (int64_t i = 0; i < length; ++i) {
+      i32[i] = (i * 37) % 101 - 50;
+      u32[i] = (i * 37) % 101 + 0x80000000U;
+      i64[i] = (i * 37) % 101 - 50;
+      u64[i] = (i * 37) % 101 + 0x8000000000000000UL;
+      f32[i] = ((i * 37) % 101 - 50) * 0.5f;
+      f64[i] = ((i * 37) % 101 - 50) * 0.5;
+      i8[i] = (i * 37) % 101 - 50;
+    }
+    f32[7] = std::numeric_limits<float>::quiet_NaN();
+    f64[9] = std::numeric_limits<double>::quiet_NaN();
+    CheckCompare<int32_t>(i32, 0);
+    CheckCompare<uint32_t>(u32, 0x80000000U + 50);
+    CheckCompare<int64_t>(i64, 0);
+    CheckCompare<uint64_t>(u64, 0x8000000000000000UL + 50);
+    CheckCompare<float>(f32, 0.5f);
+    CheckCompare<double>(f64, 0.5);
+    CheckCompare<int8_t>(i8, 0);
+    LOG(INFO) << "Passed compare tests...";
+  }
+
+  std::shared_ptr<arrow::RecordBatch> batch;
+  {
+    arrow::Int64Builder b1;
+    arrow::DoubleBuilder b2;
+    arrow::StringBuilder b3;
+    for (int64_t i = 0; i < length; ++i) {
+      if (i % 10 == 3) {
+        CHECK_ARROW_ERROR(b1.AppendNull());
+      } else {
+        CHECK_ARROW_ERROR(b1.Append(i % 100));
+      }
+      CHECK_ARROW_ERROR(b2.Append(i * 0.25));
+      if (i % 7 == 0) {
+        CHECK_ARROW_ERROR(b3.AppendNull());
+      } else {
+        CHECK_ARROW_ERROR(b3.Append("row-" + std::to_string(i)));
+      }
+    }
+    std::shared_ptr<arrow::Array> a1, a2, a3;
+    CHECK_ARROW_ERROR(b1.Finish(&a1));
+    CHECK_ARROW_ERROR(b2.Finish(&a2));
+    CHECK_ARROW_ERROR(b3.Finish(&a3));
+    auto schema = arrow::schema({arrow::field("a", arrow::int64()),
+                                 arrow::field("b", arrow::float64()),
+                                 arrow::field("c", arrow::utf8())});
+    batch = arrow::RecordBatch::Make(schema, length, {a1, a2, a3});
+  }
+
+  {
+    LOG(INFO) << "#########  RecordBatch Filter Test ##########";
+    auto a = std::dynamic_pointer_cast<arrow::Int64Array>(batch->column(0));
+    auto b = std::dynamic_pointer_cast<arrow::DoubleArray>(batch->column(1));
+    auto c = std::dynamic_pointer_cast<arrow::StringArray>(batch->column(2));
+
+    SelectionVector s1, s2, selection;
+    VINEYARD_CHECK_OK(
+        kernels::Filter<int64_t>(batch, "a", CompareOp::kLess, 20, s1));
+    VINEYARD_CHECK_OK(
+        kernels::Filter<double>(batch, "b", CompareOp::kGreaterEqual, 50, s2));
+    kernels::Intersect(s1, s2, selection);
+
+    SelectionVector expected;
+    for (int64_t i = 0; i < length; ++i) {
+      if (a->IsValid(i) && a->Value(i) < 20 && b->Value(i) >= 50) {
+        expected.emplace_back(i);
+      }
+    }
+    CHECK(!expected.empty());
+    CHECK(selection == expected);
+
+    // mismatched types and missing columns
+    CHECK(!kernels::Filter<int32_t>(batch, "a", CompareOp::kLess, 20, s1).ok());
+    CHECK(!kernels::Filter<int64_t>(batch, "x", CompareOp::kLess, 20, s1).ok());
+
+    LOG(INFO) << "#########  RecordBatch Take Test ##########";
+    std::shared_ptr<Object> object;
+    VINEYARD_CHECK_OK(kernels::Take(client, batch, selection, {"c", "a"},
+                                    object));
+    auto taken = std::dynamic_pointer_cast<RecordBatch>(
+                     client.GetObject(object->id()))
+                     ->GetRecordBatch();
+    CHECK_EQ(taken->num_rows(), static_cast<int64_t>(selection.size()));
+    CHECK_EQ(taken->num_columns(), 2);
+    CHECK_EQ(taken->schema()->field(0)->name(), "c");
+    auto ta = std::dynamic_pointer_cast<arrow::Int64Array>(taken->column(1));
+    auto tc = std::dynamic_pointer_cast<arrow::StringArray>(taken->column(0));
+    for (size_t i = 0; i < selection.size(); ++i) {
+      CHECK_EQ(ta->Value(i), a->Value(selection[i]));
+      CHECK_EQ(tc->IsNull(i), c->IsNull(selection[i]));
+      if (tc->IsValid(i)) {
+        CHECK_EQ(tc->GetString(i), c->GetString(selection[i]));
+      }
+    }
+
+    // take all columns
+    VINEYARD_CHECK_OK(kernels::Take(client, batch, selection, {}, object));
+    taken = std::dynamic_pointer_cast<RecordBatch>(object)->GetRecordBatch();
+    CHECK_EQ(taken->num_columns(), batch->num_columns());
+
+    // take nothing
+    VINEYARD_CHECK_OK(kernels::Take(client, batch, {}, {"a", "c"}, object));
+    taken = std::dynamic_pointer_cast<RecordBatch>(object)->GetRecordBatch();
+    CHECK_EQ(taken->num_rows(), 0);
+
+    LOG(INFO) << "Passed record batch kernels tests...";
+  }
+
+  {
+    LOG(INFO) << "#########  DataFrame Kernels Test ##########";
+    DataFrameBuilder builder(client);
+    auto tb1 = std::make_shared<TensorBuilder<int32_t>>(
+        client, std::vector<int64_t>{length});
+    auto tb2 = std::make_shared<TensorBuilder<double>>(
+        client, std::vector<int64_t>{length});
+    for (int64_t i = 0; i < length; ++i) {
+      tb1->data()[i] = i % 50;
+      tb2->data()[i] = i * 1.5;
+    }
+    builder.AddColumn("a", tb1);
+    builder.AddColumn("b", tb2);
+    auto df = std::dynamic_pointer_cast<DataFrame>(builder.Seal(client));
+
+    SelectionVector selection;
+    VINEYARD_CHECK_OK(
+        kernels::Filter<int32_t>(*df, "a", CompareOp::kEqual, 7, selection));
+    CHECK_EQ(selection.size(), (length + 42) / 50);
+
+    std::shared_ptr<Object> object;
+    VINEYARD_CHECK_OK(kernels::Take(client, *df, selection, {"b"}, object));
+    auto taken =
+        std::dynamic_pointer_cast<DataFrame>(client.GetObject(object->id()));
+    CHECK_EQ(taken->Columns().size(), 1);
+    auto column = std::dynamic_pointer_cast<Tensor<double>>(taken->Column("b"));
+    CHECK_EQ(column->shape()[0], static_cast<int64_t>(selection.size()));
+    for (size_t i = 0; i < selection.size(); ++i) {
+      CHECK_EQ(column->data()[i], selection[i] * 1.5);
+    }
+
+    LOG(INFO) << "Passed dataframe kernels tests...";
+  }
+
+  LOG(INFO) << "Passed filter kernels tests...";
+
+  client.Disconnect();
+
+  return 0;
+}
@@ -66,6 +66,18 @@ int main(int argc, char** argv) {
     CHECK_DOUBLE_EQ(arr->data()[2], static_cast<double>(idx));
   }
 
+  // the members are constructed concurrently
+  {
+    auto fetched = client.GetObject<Tuple>(tup->id());
+    CHECK_EQ(fetched->meta().GetTypeId(), type_id<Tuple>());
+    CHECK_EQ(fetched->Size(), element_size);
+    for (size_t idx = 0; idx < element_size; ++idx) {
+      auto arr = std::dynamic_pointer_cast<Array<double>>(fetched->At(idx));
+      CHECK(arr != nullptr);
+      CHECK_DOUBLE_EQ(arr->data()[2], static_cast<double>(idx));
+    }
+  }
+
   LOG(INFO) << "Passed large metadata tests...";
 
   client.Disconnect();
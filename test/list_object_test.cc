@@ -14,8 +14,11 @@ limitations under the License.
 */
 
 #include <memory>
+#include <set>
 #include <string>
 #include <thread>
+#include <unordered_map>
+#include <vector>
 
 #include "arrow/status.h"
 #include "arrow/util/io_util.h"
@@ -53,6 +56,116 @@ int main(int argc, char** argv) {
 
   LOG(INFO) << "Passed list objects tests...";
 
+  // paginated listing
+  {
+    std::set<ObjectID> ids;
+    std::string cursor;
+    do {
+      std::vector<json> objects;
+      std::string next_cursor;
+      VINEYARD_CHECK_OK(client.ListData("vineyard::Tensor*", false, "", cursor,
+                                        1, true, objects, next_cursor));
+      CHECK_LE(objects.size(), 1);
+      for (auto const& item : objects) {
+        CHECK(!item.contains("meta"));
+        CHECK(ids.emplace(ObjectIDFromString(item["id"].get<std::string>()))
+                  .second);
+      }
+      cursor = next_cursor;
+    } while (!cursor.empty());
+    CHECK_EQ(ids.size(), targets.size());
+  }
+
+  // listing named objects under a namespace
+  {
+    VINEYARD_CHECK_OK(client.PutName(sealed->id(), "list_object_test/a"));
+    VINEYARD_CHECK_OK(client.PutName(sealed->id(), "list_object_test/b"));
+    std::vector<std::string> names;
+    std::string cursor;
+    do {
+      std::vector<json> objects;
+      std::string next_cursor;
+      VINEYARD_CHECK_OK(client.ListData("*", false, "list_object_test/",
+                                        cursor, 1, false, objects,
+                                        next_cursor));
+      for (auto const& item : objects) {
+        CHECK(item.contains("meta"));
+        CHECK_EQ(ObjectIDFromString(item["id"].get<std::string>()),
+                 sealed->id());
+        names.emplace_back(item["name"].get<std::string>());
+      }
+      cursor = next_cursor;
+    } while (!cursor.empty());
+    CHECK_EQ(names.size(), 2);
+    CHECK_EQ(names[0], "list_object_test/a");
+    CHECK_EQ(names[1], "list_object_test/b");
+    VINEYARD_CHECK_OK(client.DropName("list_object_test/a"));
+    VINEYARD_CHECK_OK(client.DropName("list_object_test/b"));
+  }
+  LOG(INFO) << "Passed paginated list objects tests...";
+
+  // the typename index follows the creation and deletion of objects
+  {
+    auto list = [&](const std::string& pattern, const bool regex,
+                    const size_t limit) {
+      std::unordered_map<ObjectID, json> metas;
+      VINEYARD_CHECK_OK(client.ListData(pattern, regex, limit, metas));
+      CHECK_LE(metas.size(), limit);
+      return metas;
+    };
+    auto contains = [](const std::unordered_map<ObjectID, json>& metas,
+                       const ObjectID id) {
+      return metas.find(id) != metas.end();
+    };
+
+    std::vector<ObjectID> double_tensors, int_tensors;
+    for (int i = 0; i < 3; ++i) {
+      TensorBuilder<double> double_builder(client, {2});
+      double_tensors.emplace_back(double_builder.Seal(client)->id());
+      TensorBuilder<int64_t> int_builder(client, {2});
+      int_tensors.emplace_back(int_builder.Seal(client)->id());
+    }
+
+    auto all = list("vineyard::Tensor*", false, 1024);
+    auto doubles = list(type_name<Tensor<double>>(), false, 1024);
+    auto regex = list("vineyard::Tensor<(double|int64)>", true, 1024);
+    auto leading = list("?ineyard::Tensor<int64>", false, 1024);
+    for (auto const id : double_tensors) {
+      CHECK(contains(all, id));
+      CHECK(contains(doubles, id));
+      CHECK(contains(regex, id));
+      CHECK(!contains(leading, id));
+      CHECK_EQ(all[id]["typename"].get<std::string>(),
+               type_name<Tensor<double>>());
+    }
+    for (auto const id : int_tensors) {
+      CHECK(contains(all, id));
+      CHECK(!contains(doubles, id));
+      CHECK(contains(regex, id));
+      CHECK(contains(leading, id));
+    }
+    CHECK(!contains(list("vineyard::Tensor<float>", false, 1024),
+                    double_tensors[0]));
+    CHECK_EQ(list("vineyard::Tensor*", false, 2).size(), 2);
+    CHECK(list("vineyard::NoSuchType*", false, 1024).empty());
+
+    VINEYARD_CHECK_OK(client.DelData(double_tensors));
+    all = list("vineyard::Tensor*", false, 1024);
+    doubles = list(type_name<Tensor<double>>(), false, 1024);
+    for (auto const id : double_tensors) {
+      CHECK(!contains(all, id));
+      CHECK(!contains(doubles, id));
+    }
+    for (auto const id : int_tensors) {
+      CHECK(contains(all, id));
+    }
+    VINEYARD_CHECK_OK(client.DelData(int_tensors));
+    for (auto const id : int_tensors) {
+      CHECK(!contains(list("vineyard::Tensor<int64>", false, 1024), id));
+    }
+  }
+  LOG(INFO) << "Passed list objects by typename index tests...";
+
   client.Disconnect();
 
   return 0;
@@ -0,0 +1,325 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "arrow/api.h"
+
+#include "basic/ds/arrow.h"
+#include "client/client.h"
+#include "common/util/logging.h"
+#include "io/io/io_factory.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+// large enough to be split into a few slices of at least 8MB
+constexpr int64_t kRows = 1000000;
+
+std::string makeFile(const bool late_column) {
+  char path[] = "/tmp/vineyard_local_io_adaptor_test_XXXXXX";
+  int fd = mkstemp(path);
+  CHECK_NE(fd, -1);
+  close(fd);
+  std::ofstream out(path);
+  out << "id,score,name,note\n";
+  for (int64_t row = 0; row < kRows; ++row) {
+    out << row << "," << (row % 1000) * 0.5 << ",name-" << row * 7919 << ",";
+    // the column is empty in the sample at the head of the file
+    if (!late_column || row > kRows / 2) {
+      out << "note-" << row;
+    }
+    out << "\n";
+  }
+  out.close();
+  CHECK(out.good());
+  return path;
+}
+
+std::shared_ptr<arrow::Table> readTable(std::string const& path,
+                                        const int index, const int total_parts,
+                                        const int parse_concurrency) {
+  auto io = IOFactory::CreateIOAdaptor(path + "#header_row=true", nullptr);
+  VINEYARD_CHECK_OK(io->Configure("parse_concurrency",
+                                  std::to_string(parse_concurrency)));
+  VINEYARD_CHECK_OK(io->SetPartialRead(index, total_parts));
+  VINEYARD_CHECK_OK(io->Open());
+  std::shared_ptr<arrow::Table> table;
+  VINEYARD_CHECK_OK(io->ReadTable(&table));
+  VINEYARD_CHECK_OK(io->Close());
+  CHECK(table != nullptr);
+  return table;
+}
+
+std::string getString(std::shared_ptr<arrow::Array> const& array,
+                      const int64_t index) {
+  if (array->type()->id() == arrow::Type::LARGE_STRING) {
+    return std::dynamic_pointer_cast<arrow::LargeStringArray>(array)->GetString(
+        index);
+  }
+  return std::dynamic_pointer_cast<arrow::StringArray>(array)->GetString(
+      index);
+}
+
+// the parts hold every row of the file exactly once, in order
+void checkTables(std::vector<std::shared_ptr<arrow::Table>> const& tables,
+                 const bool late_column) {
+  int64_t row = 0;
+  for (auto const& table : tables) {
+    CHECK_EQ(table->num_columns(), 4);
+    for (int chunk = 0; chunk < table->column(0)->num_chunks(); ++chunk) {
+      auto ids = std::dynamic_pointer_cast<arrow::Int64Array>(
+          table->column(0)->chunk(chunk));
+      auto scores = std::dynamic_pointer_cast<arrow::DoubleArray>(
+          table->column(1)->chunk(chunk));
+      auto names = table->column(2)->chunk(chunk);
+      auto notes = table->column(3)->chunk(chunk);
+      CHECK(ids != nullptr && scores != nullptr);
+      CHECK_EQ(scores->length(), ids->length());
+      CHECK_EQ(names->length(), ids->length());
+      CHECK_EQ(notes->length(), ids->length());
+      for (int64_t index = 0; index < ids->length(); ++index, ++row) {
+        CHECK_EQ(ids->Value(index), row);
+        CHECK_EQ(scores->Value(index), (row % 1000) * 0.5);
+        CHECK_EQ(getString(names, index), "name-" + std::to_string(row * 7919));
+        if (!late_column || row > kRows / 2) {
+          CHECK_EQ(getString(notes, index), "note-" + std::to_string(row));
+        } else {
+          CHECK(notes->IsNull(index) || getString(notes, index).empty());
+        }
+      }
+    }
+  }
+  CHECK_EQ(row, kRows);
+}
+
+void testParallelParsing(const bool late_column) {
+  std::string path = makeFile(late_column);
+
+  // a single slice, parsed by the single threaded reader
+  auto expected = readTable(path, 0, 1, 1);
+  checkTables({expected}, late_column);
+
+  for (int parse_concurrency : {2, 4, 16}) {
+    auto table = readTable(path, 0, 1, parse_concurrency);
+    CHECK(table->schema()->Equals(*expected->schema()));
+    CHECK(table->Equals(*expected));
+
+    // the parts are sub-split into slices as well
+    std::vector<std::shared_ptr<arrow::Table>> parts;
+    for (int index = 0; index < 2; ++index) {
+      parts.emplace_back(readTable(path, index, 2, parse_concurrency));
+      CHECK(parts.back()->schema()->Equals(*expected->schema()));
+    }
+    checkTables(parts, late_column);
+  }
+
+  unlink(path.c_str());
+}
+
+std::shared_ptr<arrow::Table> makeTable(const int64_t begin,
+                                        const int64_t end) {
+  arrow::Int64Builder id_builder;
+  arrow::StringBuilder name_builder;
+  for (int64_t row = begin; row < end; ++row) {
+    CHECK_ARROW_ERROR(id_builder.Append(row));
+    CHECK_ARROW_ERROR(name_builder.Append("name-" + std::to_string(row)));
+  }
+  std::shared_ptr<arrow::Array> ids, names;
+  CHECK_ARROW_ERROR(id_builder.Finish(&ids));
+  CHECK_ARROW_ERROR(name_builder.Finish(&names));
+  auto schema = arrow::schema({arrow::field("id", arrow::int64()),
+                               arrow::field("name", arrow::utf8())});
+  return arrow::Table::Make(schema, {ids, names});
+}
+
+void testParquet(Client& client) {
+  constexpr int kRowGroups = 4;
+  constexpr int64_t kGroupRows = 10000;
+  std::string path = "/tmp/vineyard_local_io_adaptor_test_" +
+                     std::to_string(getpid()) + ".parquet";
+
+  // a row group per table
+  {
+    auto io = IOFactory::CreateIOAdaptor(path, nullptr);
+    VINEYARD_CHECK_OK(io->Open("w"));
+    for (int group = 0; group < kRowGroups; ++group) {
+      auto status = io->WriteTable(
+          makeTable(group * kGroupRows, (group + 1) * kGroupRows));
+      if (status.IsNotImplemented()) {
+        LOG(INFO) << "Skipped the parquet tests: " << status.ToString();
+        VINEYARD_DISCARD(io->Close());
+        unlink(path.c_str());
+        return;
+      }
+      VINEYARD_CHECK_OK(status);
+    }
+    VINEYARD_CHECK_OK(io->Close());
+  }
+
+  // the row groups are split across the parts, and the "schema" columns are
+  // projected in order
+  int64_t row = 0;
+  for (int index = 0; index < 2; ++index) {
+    auto io = IOFactory::CreateIOAdaptor(path + "#schema=name,id", &client);
+    VINEYARD_CHECK_OK(io->SetPartialRead(index, 2));
+    VINEYARD_CHECK_OK(io->Open());
+    std::shared_ptr<arrow::Table> table;
+    VINEYARD_CHECK_OK(io->ReadTable(&table));
+    VINEYARD_CHECK_OK(io->Close());
+    CHECK_EQ(table->num_rows(), kRowGroups / 2 * kGroupRows);
+    CHECK_EQ(table->num_columns(), 2);
+    CHECK_EQ(table->field(0)->name(), "name");
+    CHECK_EQ(table->field(1)->name(), "id");
+
+    auto expected = makeTable(row, row + table->num_rows());
+    CHECK(table->column(0)->Equals(expected->column(1)));
+    CHECK(table->column(1)->Equals(expected->column(0)));
+    row += table->num_rows();
+
+    // the columns are read into vineyard memory, and sealed as a table
+    TableBuilder builder(client, table);
+    auto sealed = std::dynamic_pointer_cast<Table>(builder.Seal(client));
+    auto fetched = std::dynamic_pointer_cast<Table>(
+        client.GetObject(sealed->id()));
+    CHECK(fetched->GetTable()->Equals(*table));
+  }
+  CHECK_EQ(row, kRowGroups * kGroupRows);
+
+  unlink(path.c_str());
+}
+
+// the small writes are buffered, and the large ones pass the blocks, while
+// the content is kept in order
+void testBufferedWrites() {
+  char path[] = "/tmp/vineyard_local_io_adaptor_test_XXXXXX";
+  int fd = mkstemp(path);
+  CHECK_NE(fd, -1);
+  close(fd);
+
+  std::string expected;
+  {
+    auto io = IOFactory::CreateIOAdaptor(path, nullptr);
+    VINEYARD_CHECK_OK(io->Configure("write_block_size", "4096"));
+    VINEYARD_CHECK_OK(io->Open("w"));
+    for (int64_t row = 0; row < 100000; ++row) {
+      std::string line = "line-" + std::to_string(row);
+      if (row % 1000 == 0) {
+        std::string block(4096 * (1 + row % 3000 / 1000) + row % 7, 'a');
+        VINEYARD_CHECK_OK(io->Write(&block[0], block.size()));
+        expected += block;
+      }
+      VINEYARD_CHECK_OK(io->WriteLine(line));
+      expected += line + "\n";
+    }
+    VINEYARD_CHECK_OK(io->Close());
+  }
+
+  std::ifstream in(path);
+  std::string content((std::istreambuf_iterator<char>(in)),
+                      std::istreambuf_iterator<char>());
+  CHECK_EQ(content.size(), expected.size());
+  CHECK(content == expected);
+
+  unlink(path);
+}
+
+// the header is written only once, and the tables are read back in order
+void testWriteCSVTables() {
+  constexpr int kTables = 3;
+  constexpr int64_t kTableRows = 20000;
+  std::string path = "/tmp/vineyard_local_io_adaptor_test_" +
+                     std::to_string(getpid()) + ".csv";
+
+  {
+    auto io = IOFactory::CreateIOAdaptor(path + "#header_row=true", nullptr);
+    VINEYARD_CHECK_OK(io->Configure("write_block_size", "4096"));
+    VINEYARD_CHECK_OK(io->Open("w"));
+    for (int index = 0; index < kTables; ++index) {
+      auto status = io->WriteTable(
+          makeTable(index * kTableRows, (index + 1) * kTableRows));
+      if (status.IsNotImplemented()) {
+        LOG(INFO) << "Skipped the CSV writing tests: " << status.ToString();
+        VINEYARD_DISCARD(io->Close());
+        unlink(path.c_str());
+        return;
+      }
+      VINEYARD_CHECK_OK(status);
+    }
+    VINEYARD_CHECK_OK(io->Close());
+  }
+
+  auto table = readTable(path, 0, 1, 1);
+  CHECK_EQ(table->num_rows(), kTables * kTableRows);
+  CHECK_EQ(table->num_columns(), 2);
+  CHECK_EQ(table->field(0)->name(), "id");
+  CHECK_EQ(table->field(1)->name(), "name");
+  int64_t row = 0;
+  for (int chunk = 0; chunk < table->column(0)->num_chunks(); ++chunk) {
+    auto ids = std::dynamic_pointer_cast<arrow::Int64Array>(
+        table->column(0)->chunk(chunk));
+    auto names = table->column(1)->chunk(chunk);
+    CHECK(ids != nullptr);
+    for (int64_t index = 0; index < ids->length(); ++index, ++row) {
+      CHECK_EQ(ids->Value(index), row);
+      CHECK_EQ(getString(names, index), "name-" + std::to_string(row));
+    }
+  }
+  CHECK_EQ(row, kTables * kTableRows);
+
+  unlink(path.c_str());
+}
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    printf("usage ./local_io_adaptor_test <ipc_socket>");
+    return 1;
+  }
+  std::string ipc_socket = std::string(argv[1]);
+
+  Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+  LOG(INFO) << "Connected to IPCServer: " << ipc_socket;
+
+  testParallelParsing(false);
+  LOG(INFO) << "Passed the parallel parsing tests...";
+
+  // falls back to the single threaded reader, as the types inferred from the
+  // sample are incomplete
+  testParallelParsing(true);
+  LOG(INFO) << "Passed the parallel parsing with incomplete sample tests...";
+
+  testParquet(client);
+  LOG(INFO) << "Passed the parquet tests...";
+
+  testBufferedWrites();
+  LOG(INFO) << "Passed the buffered writes tests...";
+
+  testWriteCSVTables();
+  LOG(INFO) << "Passed the CSV writing tests...";
+
+  LOG(INFO) << "Passed local io adaptor tests...";
+
+  client.Disconnect();
+
+  return 0;
+}
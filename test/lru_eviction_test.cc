@@ -0,0 +1,84 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "arrow/status.h"
+#include "arrow/util/io_util.h"
+#include "arrow/util/logging.h"
+
+#include "basic/ds/array.h"
+#include "client/client.h"
+#include "client/ds/blob.h"
+#include "client/ds/object_meta.h"
+#include "common/util/logging.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+// the server is expected to be launched with `--lru_eviction` and a small
+// `--size`, see also `test/runner.py`.
+constexpr size_t kBlobSize = 4 * 1024 * 1024;
+constexpr size_t kBlobs = 64;
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    printf("usage ./lru_eviction_test <ipc_socket>");
+    return 1;
+  }
+  std::string ipc_socket = std::string(argv[1]);
+
+  Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+  LOG(INFO) << "Connected to IPCServer: " << ipc_socket;
+
+  // an object that is neither pinned nor persisted
+  std::vector<double> double_array(kBlobSize / sizeof(double));
+  for (size_t i = 0; i < double_array.size(); ++i) {
+    double_array[i] = static_cast<double>(i);
+  }
+  ObjectID id = InvalidObjectID();
+  {
+    ArrayBuilder<double> builder(client, double_array);
+    id = builder.Seal(client)->id();
+  }
+  VINEYARD_CHECK_OK(client.Release({id}));
+
+  // allocates far more than the server can hold, the unpinned blobs that
+  // are members of no objects are evicted.
+  for (size_t index = 0; index < kBlobs; ++index) {
+    std::unique_ptr<BlobWriter> writer;
+    VINEYARD_CHECK_OK(client.CreateBlob(kBlobSize, writer));
+    memset(writer->data(), static_cast<int>(index), kBlobSize);
+    VINEYARD_CHECK_OK(client.Release({writer->id()}));
+  }
+
+  // the members of the existing object have been kept
+  {
+    std::shared_ptr<Array<double>> array;
+    VINEYARD_CHECK_OK(client.GetObject(id, array));
+    CHECK_EQ(array->size(), double_array.size());
+    for (size_t i = 0; i < double_array.size(); ++i) {
+      CHECK_EQ((*array)[i], double_array[i]);
+    }
+  }
+
+  LOG(INFO) << "Passed lru eviction tests...";
+
+  client.Disconnect();
+
+  return 0;
+}
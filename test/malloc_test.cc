@@ -0,0 +1,91 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <stdlib.h>
+
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "client/client.h"
+#include "common/util/logging.h"
+#include "malloc/allocator.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    printf("usage ./malloc_test <ipc_socket>");
+    return 1;
+  }
+  std::string ipc_socket = std::string(argv[1]);
+  // the allocator connects to the default client
+  setenv("VINEYARD_IPC_SOCKET", ipc_socket.c_str(), 1);
+  setenv("VINEYARD_MALLOC_ARENAS", "2", 1);
+  setenv("VINEYARD_MALLOC_ARENA_SIZE", std::to_string(64 << 20).c_str(), 1);
+
+  {
+    void* pointer = vineyard_calloc(16, 64);
+    for (int i = 0; i < 16 * 64; ++i) {
+      CHECK_EQ(reinterpret_cast<char*>(pointer)[i], 0);
+    }
+    pointer = vineyard_realloc(pointer, 4096);
+    CHECK(pointer != nullptr);
+    vineyard_free(pointer);
+    LOG(INFO) << "Passed malloc tests...";
+  }
+
+  {
+    // memory of a thread is frozen and freed by other threads, and arenas
+    // grow once exhausted.
+    std::vector<void*> pointers(8, nullptr);
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < pointers.size(); ++i) {
+      threads.emplace_back([i, &pointers]() {
+        for (int j = 0; j < 64; ++j) {
+          void* pointer = vineyard_malloc(1 << 20);
+          CHECK(pointer != nullptr);
+          memset(pointer, static_cast<int>(i), 1 << 20);
+          if (j == 0) {
+            pointers[i] = pointer;
+          } else {
+            vineyard_free(pointer);
+          }
+        }
+        void* pointer = vineyard_malloc(32 << 20);
+        CHECK(pointer != nullptr);
+        vineyard_free(pointer);
+      });
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+    for (size_t i = 0; i < pointers.size(); ++i) {
+      CHECK_EQ(reinterpret_cast<char*>(pointers[i])[0], static_cast<char>(i));
+      vineyard_freeze(pointers[i]);
+    }
+    vineyard_allocator_flush();
+    for (auto pointer : pointers) {
+      vineyard_free(pointer);
+    }
+    LOG(INFO) << "Passed multi-threaded malloc tests...";
+  }
+
+  vineyard_allocator_finalize(0);
+  LOG(INFO) << "Passed vineyard malloc tests...";
+  return 0;
+}
@@ -0,0 +1,73 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+
+#include <stdlib.h>
+
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "client/client.h"
+#include "client/ds/blob.h"
+#include "common/memory/memcpy.h"
+#include "common/util/logging.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    printf("usage ./memcpy_test <ipc_socket>");
+    return 1;
+  }
+  std::string ipc_socket = std::string(argv[1]);
+
+  Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+  LOG(INFO) << "Connected to IPCServer: " << ipc_socket;
+
+  const size_t size = memory::kConcurrentMemcpyThreshold * 2 + 37;
+  std::vector<uint8_t> source(size + 64);
+  for (size_t idx = 0; idx < source.size(); ++idx) {
+    source[idx] = static_cast<uint8_t>(idx * 31 + 7);
+  }
+
+  // unaligned source and destination, with different concurrency
+  for (size_t concurrency : {0, 1, 3, 8}) {
+    for (size_t offset : {0, 1, 13}) {
+      std::unique_ptr<BlobWriter> writer;
+      VINEYARD_CHECK_OK(client.CreateBlob(size + 64, writer));
+      memory::concurrent_memcpy(writer->data() + offset,
+                                source.data() + 64 - offset, size,
+                                concurrency);
+      CHECK_EQ(memcmp(writer->data() + offset, source.data() + 64 - offset,
+                      size),
+               0);
+      VINEYARD_CHECK_OK(writer->Abort(client));
+    }
+  }
+  LOG(INFO) << "Passed concurrent memcpy tests...";
+
+  // small copies go to memcpy directly
+  std::vector<uint8_t> target(1024);
+  memory::concurrent_memcpy(target.data(), source.data(), target.size());
+  CHECK_EQ(memcmp(target.data(), source.data(), target.size()), 0);
+  LOG(INFO) << "Passed small memcpy tests...";
+
+  client.Disconnect();
+
+  return 0;
+}
@@ -0,0 +1,129 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <memory>
+#include <string>
+#include <thread>
+
+#include "arrow/status.h"
+#include "arrow/util/io_util.h"
+#include "arrow/util/logging.h"
+
+#include "basic/ds/array.h"
+#include "basic/ds/pair.h"
+#include "client/client.h"
+#include "client/ds/object_meta.h"
+#include "client/meta_cache.h"
+#include "common/util/logging.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    printf("usage ./meta_cache_test <ipc_socket>");
+    return 1;
+  }
+  std::string ipc_socket = std::string(argv[1]);
+
+  Client client1, client2;
+  VINEYARD_CHECK_OK(client1.Connect(ipc_socket));
+  VINEYARD_CHECK_OK(client2.Connect(ipc_socket));
+  LOG(INFO) << "Connected to IPCServer: " << ipc_socket;
+
+  VINEYARD_CHECK_OK(client1.EnableMetaCache(16));
+  MetaCache* cache = client1.GetMetaCache();
+  CHECK(cache != nullptr);
+
+  std::vector<double> double_array = {1.0, 7.0, 3.0, 4.0, 2.0};
+  ArrayBuilder<double> builder1(client2, double_array);
+  ArrayBuilder<double> builder2(client2, double_array);
+  auto first = builder1.Seal(client2);
+  auto second = builder2.Seal(client2);
+  PairBuilder pair_builder(client2);
+  pair_builder.SetFirst(first);
+  pair_builder.SetSecond(second);
+  auto pair = pair_builder.Seal(client2);
+
+  {
+    ObjectMeta meta;
+    VINEYARD_CHECK_OK(client1.GetMetaData(pair->id(), meta));
+    CHECK_EQ(cache->Misses(), 1);
+    VINEYARD_CHECK_OK(client1.GetMetaData(pair->id(), meta));
+    CHECK_EQ(cache->Hits(), 1);
+    CHECK_EQ(meta.GetTypeName(), type_name<Pair>());
+
+    auto array = std::dynamic_pointer_cast<Array<double>>(
+        meta.GetMember("first_"));
+    CHECK(array != nullptr);
+    CHECK_EQ(array->size(), double_array.size());
+    LOG(INFO) << "Passed metadata cache hit tests...";
+  }
+
+  {
+    std::vector<ObjectMeta> metas;
+    VINEYARD_CHECK_OK(
+        client1.GetMetaData({pair->id(), first->id()}, metas, false));
+    CHECK_EQ(metas.size(), 2);
+    CHECK_EQ(metas[0].GetId(), pair->id());
+    CHECK_EQ(metas[1].GetId(), first->id());
+    CHECK_EQ(cache->Size(), 2);
+    LOG(INFO) << "Passed batch metadata cache tests...";
+  }
+
+  {
+    // deleting the member from the other client invalidates the pair as well
+    VINEYARD_CHECK_OK(client2.DelData(first->id(), true, true));
+    while (cache->Size() != 0) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    ObjectMeta meta;
+    auto status = client1.GetMetaData(pair->id(), meta);
+    CHECK(status.IsObjectNotExists());
+    VINEYARD_CHECK_OK(client1.GetMetaData(second->id(), meta));
+    LOG(INFO) << "Passed metadata cache invalidation tests...";
+  }
+
+  {
+    // releasing the blobs evicts the cached metadata that holds the buffers
+    ObjectMeta meta;
+    VINEYARD_CHECK_OK(client1.GetMetaData(second->id(), meta));
+    CHECK_EQ(cache->Size(), 1);
+    VINEYARD_CHECK_OK(client1.Release({second->id()}));
+    CHECK_EQ(cache->Size(), 0);
+    LOG(INFO) << "Passed metadata cache release tests...";
+  }
+
+  {
+    ObjectID id = InvalidObjectID();
+    VINEYARD_CHECK_OK(client2.PutName(second->id(), "meta_cache_test_name"));
+    VINEYARD_CHECK_OK(client1.GetName("meta_cache_test_name", id));
+    CHECK_EQ(id, second->id());
+    CHECK_EQ(cache->Names(), 1);
+    // dropping the name from the other client invalidates the cached name
+    VINEYARD_CHECK_OK(client2.DropName("meta_cache_test_name"));
+    while (cache->Names() != 0) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    auto status = client1.GetName("meta_cache_test_name", id);
+    CHECK(status.IsObjectNotExists());
+    LOG(INFO) << "Passed name cache invalidation tests...";
+  }
+
+  client1.Disconnect();
+  client2.Disconnect();
+
+  LOG(INFO) << "Passed metadata cache tests...";
+  return 0;
+}
@@ -0,0 +1,152 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <sys/stat.h>
+
+#include <chrono>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "arrow/status.h"
+#include "arrow/util/io_util.h"
+#include "arrow/util/logging.h"
+
+#include "basic/ds/scalar.h"
+#include "client/client.h"
+#include "client/ds/object_meta.h"
+#include "common/util/logging.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+// the test runs twice, against the server before and after a restart, with
+// the same etcd, prefix and `--etcd_snapshot`, see also `test/runner.py`:
+//
+// - the first run persists some objects and waits for the snapshot, then
+//   persists some more objects and deletes one of the former, which happen
+//   after the snapshot,
+// - the second run checks that both the snapshot and the updates after it
+//   are resumed.
+constexpr size_t kObjectsBefore = 8;
+constexpr size_t kObjectsAfter = 4;
+
+std::string NameOf(size_t index) {
+  return "meta_snapshot_test_" + std::to_string(index);
+}
+
+ObjectID PersistScalar(Client& client, size_t index) {
+  ScalarBuilder<int64_t> builder(client);
+  builder.SetValue(static_cast<int64_t>(index * 1000 + 7));
+  auto scalar = builder.Seal(client);
+  VINEYARD_CHECK_OK(client.Persist(scalar->id()));
+  VINEYARD_CHECK_OK(client.PutName(scalar->id(), NameOf(index)));
+  return scalar->id();
+}
+
+bool FileExists(const std::string& path) {
+  struct stat st;
+  return stat(path.c_str(), &st) == 0;
+}
+
+void Persist(Client& client, const std::string& ids_file,
+             const std::string& snapshot_file) {
+  std::ofstream ids(ids_file);
+  for (size_t index = 0; index < kObjectsBefore; ++index) {
+    ids << PersistScalar(client, index) << std::endl;
+  }
+
+  // the snapshot is checkpointed every `--etcd_snapshot_interval=1` seconds
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(30);
+  while (!FileExists(snapshot_file)) {
+    CHECK(std::chrono::steady_clock::now() < deadline);
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  }
+  std::this_thread::sleep_for(std::chrono::seconds(2));
+
+  for (size_t index = kObjectsBefore; index < kObjectsBefore + kObjectsAfter;
+       ++index) {
+    ids << PersistScalar(client, index) << std::endl;
+  }
+  ObjectID deleted;
+  VINEYARD_CHECK_OK(client.GetName(NameOf(0), deleted));
+  VINEYARD_CHECK_OK(client.DropName(NameOf(0)));
+  VINEYARD_CHECK_OK(client.DelData(deleted));
+}
+
+void Restore(Client& client, const std::string& ids_file,
+             const std::string& snapshot_file) {
+  CHECK(FileExists(snapshot_file));
+
+  std::vector<ObjectID> ids;
+  std::ifstream input(ids_file);
+  ObjectID id = InvalidObjectID();
+  while (input >> id) {
+    ids.emplace_back(id);
+  }
+  CHECK_EQ(ids.size(), kObjectsBefore + kObjectsAfter);
+
+  // deleted after the snapshot
+  bool exists = true;
+  VINEYARD_CHECK_OK(client.Exists(ids[0], exists));
+  CHECK(!exists);
+  ObjectID named = InvalidObjectID();
+  CHECK(client.GetName(NameOf(0), named).IsObjectNotExists());
+
+  for (size_t index = 1; index < ids.size(); ++index) {
+    VINEYARD_CHECK_OK(client.Exists(ids[index], exists));
+    CHECK(exists);
+    VINEYARD_CHECK_OK(client.GetName(NameOf(index), named));
+    CHECK_EQ(named, ids[index]);
+    auto scalar = client.GetObject<Scalar<int64_t>>(ids[index]);
+    CHECK(scalar != nullptr);
+    CHECK_EQ(scalar->Value(), static_cast<int64_t>(index * 1000 + 7));
+  }
+
+  // the objects can be updated after the resume
+  ObjectID id_after_resume = PersistScalar(client, ids.size());
+  VINEYARD_CHECK_OK(client.GetName(NameOf(ids.size()), named));
+  CHECK_EQ(named, id_after_resume);
+}
+
+int main(int argc, char** argv) {
+  if (argc < 5) {
+    printf(
+        "usage ./meta_snapshot_test <ipc_socket> <persist|restore> "
+        "<ids_file> <snapshot_file>");
+    return 1;
+  }
+  std::string ipc_socket = std::string(argv[1]);
+  std::string mode = std::string(argv[2]);
+  std::string ids_file = std::string(argv[3]);
+  std::string snapshot_file = std::string(argv[4]);
+
+  Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+  LOG(INFO) << "Connected to IPCServer: " << ipc_socket;
+
+  if (mode == "persist") {
+    Persist(client, ids_file, snapshot_file);
+    LOG(INFO) << "Passed metadata snapshot persist tests...";
+  } else {
+    Restore(client, ids_file, snapshot_file);
+    LOG(INFO) << "Passed metadata snapshot restore tests...";
+  }
+
+  client.Disconnect();
+
+  return 0;
+}
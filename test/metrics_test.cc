@@ -0,0 +1,197 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "arrow/status.h"
+#include "arrow/util/io_util.h"
+#include "arrow/util/logging.h"
+
+#include "client/client.h"
+#include "client/ds/blob.h"
+#include "client/ds/object_meta.h"
+#include "common/util/logging.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+// the server runs with `--metrics_port`, see also `test/runner.py`.
+const std::vector<size_t> kBlobSizes = {100 * 1024, 1024 * 1024,
+                                        3 * 1024 * 1024};
+
+// the whole response, the server closes the connection after replying
+std::string HttpGet(int const port, std::string const& path) {
+  int fd = socket(AF_INET, SOCK_STREAM, 0);
+  CHECK_GE(fd, 0);
+  struct sockaddr_in address;
+  memset(&address, 0, sizeof(address));
+  address.sin_family = AF_INET;
+  address.sin_port = htons(port);
+  address.sin_addr.s_addr = inet_addr("127.0.0.1");
+  CHECK_EQ(connect(fd, reinterpret_cast<struct sockaddr*>(&address),
+                   sizeof(address)),
+           0);
+  std::string request = "GET " + path + " HTTP/1.1\r\nHost: localhost\r\n\r\n";
+  CHECK_EQ(write(fd, request.data(), request.size()),
+           static_cast<ssize_t>(request.size()));
+  std::string response;
+  char buffer[4096];
+  ssize_t length = 0;
+  while ((length = read(fd, buffer, sizeof(buffer))) > 0) {
+    response.append(buffer, length);
+  }
+  close(fd);
+  return response;
+}
+
+// the samples, keyed by the name with labels, e.g.,
+// `vineyard_blob_size_bytes_bucket{le="1024"}`
+std::map<std::string, double> Scrape(int const port) {
+  std::string response = HttpGet(port, "/metrics");
+  CHECK_EQ(response.find("HTTP/1.1 200 OK\r\n"), 0);
+  std::istringstream body(response.substr(response.find("\r\n\r\n") + 4));
+  std::map<std::string, double> samples;
+  std::string line;
+  while (std::getline(body, line)) {
+    if (line.empty() || line[0] == '#') {
+      continue;
+    }
+    auto separator = line.rfind(' ');
+    CHECK_NE(separator, std::string::npos);
+    samples[line.substr(0, separator)] = std::stod(line.substr(separator + 1));
+  }
+  return samples;
+}
+
+double Delta(std::map<std::string, double>& before,
+             std::map<std::string, double>& after, std::string const& key) {
+  CHECK(after.find(key) != after.end()) << "no sample for " << key;
+  return after[key] - before[key];
+}
+
+// the buckets of every histogram are cumulative, and end with the count
+void CheckHistograms(std::map<std::string, double> const& samples) {
+  // (name, labels except `le`) => [(le, count)]
+  std::map<std::pair<std::string, std::string>,
+           std::vector<std::pair<double, double>>>
+      histograms;
+  for (auto const& sample : samples) {
+    auto bucket = sample.first.find("_bucket{");
+    if (bucket == std::string::npos) {
+      continue;
+    }
+    std::string name = sample.first.substr(0, bucket);
+    std::string labels = sample.first.substr(bucket + 8);
+    labels.pop_back();  // the trailing '}'
+    auto le = labels.find("le=\"");
+    CHECK_NE(le, std::string::npos);
+    std::string bound = labels.substr(le + 4, labels.size() - le - 5);
+    labels = labels.substr(0, le);
+    if (!labels.empty() && labels.back() == ',') {
+      labels.pop_back();
+    }
+    histograms[std::make_pair(name, labels)].emplace_back(
+        bound == "+Inf" ? std::numeric_limits<double>::infinity()
+                        : std::stod(bound),
+        sample.second);
+  }
+  CHECK(!histograms.empty());
+  for (auto& histogram : histograms) {
+    auto& buckets = histogram.second;
+    std::sort(buckets.begin(), buckets.end());
+    for (size_t index = 1; index < buckets.size(); ++index) {
+      CHECK_LE(buckets[index - 1].second, buckets[index].second);
+    }
+    CHECK(std::isinf(buckets.back().first));
+    auto const& labels = histogram.first.second;
+    std::string count = histogram.first.first + "_count" +
+                        (labels.empty() ? "" : "{" + labels + "}");
+    CHECK(samples.find(count) != samples.end()) << "no sample for " << count;
+    CHECK_EQ(samples.at(count), buckets.back().second);
+  }
+}
+
+int main(int argc, char** argv) {
+  if (argc < 3) {
+    printf("usage ./metrics_test <ipc_socket> <metrics_port>");
+    return 1;
+  }
+  std::string ipc_socket = std::string(argv[1]);
+  int port = std::stoi(argv[2]);
+
+  Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+  LOG(INFO) << "Connected to IPCServer: " << ipc_socket;
+
+  auto before = Scrape(port);
+  std::vector<ObjectID> ids;
+  size_t total = 0;
+  for (auto const size : kBlobSizes) {
+    std::unique_ptr<BlobWriter> writer;
+    VINEYARD_CHECK_OK(client.CreateBlob(size, writer));
+    ids.emplace_back(writer->Seal(client)->id());
+    total += size;
+  }
+  auto after = Scrape(port);
+
+  // the histogram of blob sizes, with buckets of (2^(i-1), 2^i]
+  std::string const histogram = "vineyard_blob_size_bytes";
+  CHECK_EQ(Delta(before, after, histogram + "_count"), kBlobSizes.size());
+  CHECK_EQ(Delta(before, after, histogram + "_sum"), total);
+  CHECK_EQ(Delta(before, after, histogram + "_bucket{le=\"65536\"}"), 0);
+  CHECK_EQ(Delta(before, after, histogram + "_bucket{le=\"1048576\"}"), 2);
+  CHECK_EQ(Delta(before, after, histogram + "_bucket{le=\"+Inf\"}"), 3);
+  CheckHistograms(after);
+
+  // the requests been handled, and the bytes been received and sent
+  CHECK_GE(Delta(before, after,
+                 "vineyard_request_duration_nanoseconds_count{command=\"create_"
+                 "buffer_request\"}"),
+           kBlobSizes.size());
+  CHECK_GT(Delta(before, after, "vineyard_received_bytes_total"), 0);
+  CHECK_GT(Delta(before, after, "vineyard_sent_bytes_total"), 0);
+
+  // the gauges are collected when being scraped
+  std::shared_ptr<InstanceStatus> status;
+  VINEYARD_CHECK_OK(client.InstanceStatus(status));
+  CHECK_LE(std::abs(after["vineyard_memory_usage_bytes"] -
+                    static_cast<double>(status->memory_usage)),
+           status->memory_usage * 1e-5);
+  CHECK_LE(std::abs(after["vineyard_memory_limit_bytes"] -
+                    static_cast<double>(status->memory_limit)),
+           status->memory_limit * 1e-5);
+
+  CHECK_EQ(HttpGet(port, "/no-such-path").find("HTTP/1.1 404 Not Found\r\n"),
+           0);
+  LOG(INFO) << "Passed metrics tests...";
+
+  VINEYARD_CHECK_OK(client.DelData(ids));
+  client.Disconnect();
+
+  return 0;
+}
@@ -0,0 +1,106 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "common/util/logging.h"
+#include "common/util/mpmc_queue.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+constexpr int kProducers = 4;
+constexpr int kConsumers = 4;
+constexpr int kItems = 100000;
+
+void testRing() {
+  MPMCRing<std::shared_ptr<int>> ring(3);
+  CHECK_EQ(ring.capacity(), 4);
+  for (int i = 0; i < 4; ++i) {
+    CHECK(ring.TryPut(std::make_shared<int>(i)));
+  }
+  CHECK(!ring.TryPut(std::make_shared<int>(4)));
+  CHECK_EQ(ring.size(), 4);
+
+  std::shared_ptr<int> item;
+  CHECK(ring.TryGet(item));
+  CHECK_EQ(*item, 0);
+  std::vector<std::shared_ptr<int>> items;
+  CHECK_EQ(ring.TryGetBatch(items, 8), 3);
+  for (int i = 0; i < 3; ++i) {
+    CHECK_EQ(*items[i], i + 1);
+  }
+  CHECK(!ring.TryGet(item));
+  LOG(INFO) << "Passed ring tests...";
+}
+
+void testProducerConsumer() {
+  PCMPMCQueue<std::string> queue;
+  queue.SetLimit(64);
+  queue.SetProducerNum(kProducers);
+
+  std::atomic<int64_t> count(0), sum(0);
+  std::vector<std::thread> threads;
+  for (int p = 0; p < kProducers; ++p) {
+    threads.emplace_back([&]() {
+      for (int i = 0; i < kItems; ++i) {
+        if (i % 2 == 0) {
+          queue.Put(std::to_string(i));
+        } else {
+          std::vector<std::string> batch{std::to_string(i)};
+          queue.PutBatch(batch);
+        }
+      }
+      queue.DecProducerNum();
+    });
+  }
+  for (int c = 0; c < kConsumers; ++c) {
+    threads.emplace_back([&, c]() {
+      if (c % 2 == 0) {
+        std::string item;
+        while (queue.Get(item)) {
+          count += 1;
+          sum += std::stoll(item);
+        }
+      } else {
+        std::vector<std::string> items;
+        while (queue.GetBatch(items, 16)) {
+          for (auto const& item : items) {
+            count += 1;
+            sum += std::stoll(item);
+          }
+          items.clear();
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  CHECK_EQ(count.load(), int64_t(kProducers) * kItems);
+  CHECK_EQ(sum.load(), int64_t(kProducers) * kItems * (kItems - 1) / 2);
+  CHECK_EQ(queue.Size(), 0);
+  LOG(INFO) << "Passed producer/consumer tests...";
+}
+
+int main(int argc, char** argv) {
+  testRing();
+  testProducerConsumer();
+  LOG(INFO) << "Passed mpmc queue tests...";
+  return 0;
+}
@@ -13,6 +13,10 @@ See the License for the specific language governing permissions and
 limitations under the License.
 */
 
+#include <map>
+#include <string>
+#include <vector>
+
 #include "client/client.h"
 
 using namespace vineyard;  // NOLINT(build/namespaces)
@@ -50,6 +54,77 @@ int main(int argc, char** argv) {
 
   LOG(INFO) << "check drop name success";
 
+  {
+    std::map<std::string, ObjectID> names;
+    for (int i = 0; i < 16; ++i) {
+      names["test_names_" + std::to_string(i)] = GenerateObjectID();
+    }
+    VINEYARD_CHECK_OK(client.PutNames(names));
+
+    std::vector<std::string> queries = {"test_names_1", "test_names_7",
+                                        "test_names_none"};
+    std::map<std::string, ObjectID> ids;
+    VINEYARD_CHECK_OK(client.GetNames(queries, ids));
+    CHECK_EQ(ids.size(), 2);
+    CHECK_EQ(ids["test_names_1"], names["test_names_1"]);
+    CHECK_EQ(ids["test_names_7"], names["test_names_7"]);
+
+    std::vector<std::string> drops;
+    for (auto const& item : names) {
+      drops.emplace_back(item.first);
+    }
+    VINEYARD_CHECK_OK(client.DropNames(drops));
+    ids.clear();
+    VINEYARD_CHECK_OK(client.GetNames(queries, ids));
+    CHECK(ids.empty());
+  }
+
+  LOG(INFO) << "check batched names success";
+
+  {
+    MetaBatch batch;
+    std::vector<size_t> refs;
+    for (int i = 0; i < 4; ++i) {
+      ObjectMeta meta;
+      meta.SetTypeName("vineyard::Scalar<int>");
+      meta.AddKeyValue("value_", i);
+      refs.emplace_back(batch.CreateData(meta));
+      batch.PersistCreated(refs.back());
+      batch.PutNameCreated(refs.back(), "test_batch_" + std::to_string(i));
+    }
+    std::vector<ObjectID> created;
+    VINEYARD_CHECK_OK(client.Batch(batch, created));
+    CHECK_EQ(created.size(), 4);
+    for (int i = 0; i < 4; ++i) {
+      ObjectID id = InvalidObjectID();
+      VINEYARD_CHECK_OK(client.GetName("test_batch_" + std::to_string(i), id));
+      CHECK_EQ(id, created[i]);
+      bool persist = false;
+      VINEYARD_CHECK_OK(client.IfPersist(id, persist));
+      CHECK(persist);
+    }
+
+    // a failed op discards the whole batch
+    MetaBatch invalid;
+    ObjectMeta meta;
+    meta.SetTypeName("vineyard::Scalar<int>");
+    meta.AddKeyValue("value_", 0);
+    invalid.PutNameCreated(invalid.CreateData(meta), "test_batch_invalid");
+    invalid.Persist(GenerateObjectID());
+    CHECK(!client.Batch(invalid, created).ok());
+    ObjectID id = InvalidObjectID();
+    CHECK(client.GetName("test_batch_invalid", id).IsObjectNotExists());
+
+    std::vector<std::string> drops;
+    for (int i = 0; i < 4; ++i) {
+      drops.emplace_back("test_batch_" + std::to_string(i));
+    }
+    VINEYARD_CHECK_OK(client.DropNames(drops));
+    VINEYARD_CHECK_OK(client.DelData(created, true, true));
+  }
+
+  LOG(INFO) << "check batch success";
+
   LOG(INFO) << "Passed name test...";
 
   client.Disconnect();
@@ -0,0 +1,118 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "arrow/status.h"
+#include "arrow/util/io_util.h"
+#include "arrow/util/logging.h"
+
+#include "client/client.h"
+#include "client/ds/blob.h"
+#include "client/ds/object_meta.h"
+#include "common/util/logging.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+// the server runs with `--numa_aware`, see also `test/runner.py`, which only
+// takes effect on hosts that have more than one NUMA node.
+constexpr size_t kBlobSize = 8 * 1024 * 1024;
+
+int NodeCount() {
+  int count = 0;
+  struct stat st;
+  while (stat(("/sys/devices/system/node/node" + std::to_string(count))
+                  .c_str(),
+              &st) == 0) {
+    ++count;
+  }
+  return std::max(count, 1);
+}
+
+// the node that the page of the address lives on, -1 if unknown
+int NodeOfPage(const void* address) {
+#if defined(__linux__) && defined(SYS_move_pages)
+  void* page = reinterpret_cast<void*>(reinterpret_cast<uintptr_t>(address) &
+                                       ~(getpagesize() - 1));
+  int status = -1;
+  if (syscall(SYS_move_pages, 0, 1, &page, nullptr, &status, 0) != 0) {
+    return -1;
+  }
+  return status;
+#else
+  return -1;
+#endif
+}
+
+ObjectID CreateBlob(Client& client, const int numa_node, const char value) {
+  std::unique_ptr<BlobWriter> writer;
+  VINEYARD_CHECK_OK(client.CreateBlob(kBlobSize, numa_node, writer));
+  CHECK_EQ(writer->size(), kBlobSize);
+  // faults in the pages, following the policy of the segment
+  memset(writer->data(), value, kBlobSize);
+  if (numa_node >= 0 && numa_node < NodeCount() && NodeCount() > 1) {
+    for (size_t offset = 0; offset < kBlobSize; offset += kBlobSize / 8) {
+      CHECK_EQ(NodeOfPage(writer->data() + offset), numa_node);
+    }
+  }
+  return writer->Seal(client)->id();
+}
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    printf("usage ./numa_test <ipc_socket>");
+    return 1;
+  }
+  std::string ipc_socket = std::string(argv[1]);
+
+  Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+  LOG(INFO) << "Connected to IPCServer: " << ipc_socket;
+  LOG(INFO) << "Found " << NodeCount() << " NUMA nodes";
+
+  // every node, the client's node (-1), and the out-of-range nodes which
+  // fall back to the default arena
+  std::vector<int> nodes = {-1, NodeCount(), 1024};
+  for (int node = 0; node < NodeCount(); ++node) {
+    nodes.emplace_back(node);
+  }
+  std::vector<ObjectID> ids;
+  for (size_t index = 0; index < nodes.size(); ++index) {
+    ids.emplace_back(CreateBlob(client, nodes[index], 'a' + index));
+  }
+
+  std::vector<std::shared_ptr<Blob>> blobs;
+  VINEYARD_CHECK_OK(client.GetBlobs(ids, blobs));
+  for (size_t index = 0; index < blobs.size(); ++index) {
+    CHECK_EQ(blobs[index]->size(), kBlobSize);
+    for (size_t offset = 0; offset < kBlobSize; offset += 4096) {
+      CHECK_EQ(blobs[index]->data()[offset], static_cast<char>('a' + index));
+    }
+  }
+  LOG(INFO) << "Passed numa aware blob tests...";
+
+  VINEYARD_CHECK_OK(client.DelData(ids));
+  client.Disconnect();
+
+  return 0;
+}
@@ -0,0 +1,163 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "arrow/status.h"
+#include "arrow/util/io_util.h"
+#include "arrow/util/logging.h"
+
+#include "basic/ds/array.h"
+#include "client/client.h"
+#include "client/ds/object_meta.h"
+#include "client/subscription.h"
+#include "common/util/logging.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+class EventCollector {
+ public:
+  ObjectSubscription::callback_t callback() {
+    return [this](const ObjectEvent& event) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      events_.emplace_back(event);
+      cv_.notify_all();
+    };
+  }
+
+  std::vector<ObjectEvent> Wait(const size_t count, const int seconds = 10) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    cv_.wait_for(lock, std::chrono::seconds(seconds),
+                 [&]() { return events_.size() >= count; });
+    return events_;
+  }
+
+ private:
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::vector<ObjectEvent> events_;
+};
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    printf("usage ./object_subscription_test <ipc_socket>");
+    return 1;
+  }
+  std::string ipc_socket = std::string(argv[1]);
+
+  Client client1, client2;
+  VINEYARD_CHECK_OK(client1.Connect(ipc_socket));
+  VINEYARD_CHECK_OK(client2.Connect(ipc_socket));
+  LOG(INFO) << "Connected to IPCServer: " << ipc_socket;
+
+  EventCollector arrays, named, labeled;
+  std::unique_ptr<ObjectSubscription> array_subscription, name_subscription,
+      label_subscription;
+  {
+    ObjectFilter filter;
+    filter.type_pattern = "vineyard::Array<*>";
+    VINEYARD_CHECK_OK(client1.SubscribeObjects(filter, arrays.callback(),
+                                               array_subscription));
+  }
+  {
+    ObjectFilter filter;
+    filter.name_prefix = "checkpoint/";
+    VINEYARD_CHECK_OK(client1.SubscribeObjects(filter, named.callback(),
+                                               name_subscription));
+  }
+  {
+    ObjectFilter filter;
+    filter.labels["stage"] = "eval";
+    VINEYARD_CHECK_OK(client1.SubscribeObjects(filter, labeled.callback(),
+                                               label_subscription));
+  }
+  CHECK(array_subscription->Subscribed());
+
+  std::vector<double> double_array = {1.0, 7.0, 3.0, 4.0, 2.0};
+  ArrayBuilder<double> builder1(client2, double_array);
+  ArrayBuilder<double> builder2(client2, double_array);
+  auto first = builder1.Seal(client2);
+  auto second = builder2.Seal(client2);
+
+  ObjectMeta checkpoint;
+  checkpoint.SetTypeName("vineyard::Checkpoint");
+  checkpoint.SetNBytes(0);
+  checkpoint.AddKeyValue("stage", "eval");
+  checkpoint.AddMember("model", first->meta());
+  ObjectID checkpoint_id = InvalidObjectID();
+  VINEYARD_CHECK_OK(client2.CreateMetaData(checkpoint, checkpoint_id));
+
+  {
+    auto events = arrays.Wait(2);
+    CHECK_EQ(events.size(), 2);
+    CHECK_EQ(events[0].id, first->id());
+    CHECK_EQ(events[1].id, second->id());
+    CHECK_EQ(events[0].type_name, type_name<Array<double>>());
+    CHECK(events[0].name.empty());
+    LOG(INFO) << "Passed typename subscription tests...";
+  }
+
+  {
+    auto events = labeled.Wait(1);
+    CHECK_EQ(events.size(), 1);
+    CHECK_EQ(events[0].id, checkpoint_id);
+    CHECK_EQ(events[0].type_name, "vineyard::Checkpoint");
+    CHECK_NE(events[0].signature, InvalidSignature());
+    LOG(INFO) << "Passed label subscription tests...";
+  }
+
+  {
+    VINEYARD_CHECK_OK(client2.Persist(checkpoint_id));
+    VINEYARD_CHECK_OK(client2.PutName(checkpoint_id, "checkpoint/1"));
+    VINEYARD_CHECK_OK(client2.PutName(first->id(), "others/1"));
+    auto events = named.Wait(1);
+    CHECK_EQ(events.size(), 1);
+    CHECK_EQ(events[0].id, checkpoint_id);
+    CHECK_EQ(events[0].name, "checkpoint/1");
+    CHECK(!events[0].transient);
+
+    // the persisted object is notified again
+    events = labeled.Wait(2);
+    CHECK_GE(events.size(), 2);
+    CHECK_EQ(events[1].id, checkpoint_id);
+    CHECK(!events[1].transient);
+    LOG(INFO) << "Passed name subscription tests...";
+  }
+
+  {
+    label_subscription.reset();
+    name_subscription.reset();
+    array_subscription.reset();
+    size_t received = arrays.Wait(0).size();
+    ArrayBuilder<double> builder3(client2, double_array);
+    auto third = builder3.Seal(client2);
+    // the connections of the subscriptions have been closed
+    CHECK_EQ(arrays.Wait(received + 1, 1).size(), received);
+    LOG(INFO) << "Passed unsubscription tests...";
+  }
+
+  client1.Disconnect();
+  client2.Disconnect();
+
+  LOG(INFO) << "Passed object subscription tests...";
+  return 0;
+}
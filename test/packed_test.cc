@@ -0,0 +1,86 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "basic/ds/packed.h"
+#include "client/client.h"
+#include "client/ds/object_meta.h"
+#include "common/util/logging.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    printf("usage ./packed_test <ipc_socket>");
+    return 1;
+  }
+  std::string ipc_socket = std::string(argv[1]);
+
+  Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+  LOG(INFO) << "Connected to IPCServer: " << ipc_socket;
+
+  std::vector<std::string> keys;
+  for (int i = 0; i < 10000; ++i) {
+    keys.emplace_back("key-" + std::to_string(i));
+  }
+  keys.emplace_back("");
+
+  PackedValuesBuilder builder(client);
+  builder.Append(keys);
+  builder.AppendValue<double>(3.5);
+  builder.AppendValue<int64_t>(-7);
+  CHECK_EQ(builder.size(), keys.size() + 2);
+  auto sealed =
+      std::dynamic_pointer_cast<PackedValues>(builder.Seal(client));
+  VINEYARD_CHECK_OK(client.Persist(sealed->id()));
+
+  auto packed = client.GetObject<PackedValues>(sealed->id());
+  CHECK_EQ(packed->size(), keys.size() + 2);
+  CHECK_EQ(packed->Get(42), "key-42");
+  CHECK_EQ(packed->Size(keys.size() - 1), 0);
+  CHECK(packed->Get({9999, 0}) ==
+        std::vector<std::string>({"key-9999", "key-0"}));
+  auto values = packed->Values();
+  CHECK(std::vector<std::string>(values.begin(),
+                                 values.begin() + keys.size()) == keys);
+  CHECK_EQ(packed->Value<double>(keys.size()), 3.5);
+  CHECK_EQ(packed->Value<int64_t>(keys.size() + 1), -7);
+
+  // all values are kept in a single blob
+  ObjectMeta meta;
+  VINEYARD_CHECK_OK(client.GetMetaData(packed->id(), meta));
+  CHECK_EQ(meta.GetBufferSet()->AllBufferIds().size(), 1);
+
+  {
+    // an empty pack
+    PackedValuesBuilder builder(client);
+    auto empty =
+        std::dynamic_pointer_cast<PackedValues>(builder.Seal(client));
+    CHECK_EQ(empty->size(), 0);
+    CHECK_EQ(empty->data_size(), 0);
+    CHECK(empty->Values().empty());
+  }
+
+  LOG(INFO) << "Passed packed values tests...";
+
+  client.Disconnect();
+
+  return 0;
+}
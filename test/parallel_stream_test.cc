@@ -0,0 +1,132 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "arrow/status.h"
+#include "arrow/util/io_util.h"
+#include "arrow/util/logging.h"
+
+#include "basic/stream/byte_stream.h"
+#include "basic/stream/parallel_stream.h"
+#include "client/client.h"
+#include "client/ds/object_meta.h"
+#include "common/util/logging.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    printf("usage ./parallel_stream_test <ipc_socket>");
+    return 1;
+  }
+  std::string ipc_socket = std::string(argv[1]);
+
+  Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+  LOG(INFO) << "Connected to IPCServer: " << ipc_socket;
+
+  const size_t num_partitions = 8, num_consumers = 3, num_chunks = 32;
+
+  std::vector<ObjectID> stream_ids;
+  ParallelStreamBuilder pbuilder(client);
+  for (size_t idx = 0; idx < num_partitions; ++idx) {
+    ByteStreamBuilder builder(client);
+    builder.SetParams(std::unordered_map<std::string, std::string>{
+        {"kind", "test"}, {"test_name", "parallel_stream_test"}});
+    auto bstream = std::dynamic_pointer_cast<ByteStream>(builder.Seal(client));
+    stream_ids.emplace_back(bstream->id());
+    pbuilder.AddStream(bstream->id());
+  }
+  auto pstream =
+      std::dynamic_pointer_cast<ParallelStream>(pbuilder.Seal(client));
+  CHECK(pstream != nullptr);
+
+  ParallelStreamReader<ByteStream, ByteStreamReader> reader;
+  VINEYARD_CHECK_OK(reader.Open(ipc_socket, pstream));
+  CHECK_EQ(reader.Partitions(), num_partitions);
+
+  // every partition is produced independently, at different paces
+  std::vector<std::thread> producers;
+  for (size_t partition = 0; partition < num_partitions; ++partition) {
+    producers.emplace_back([&, partition]() {
+      Client writer_client;
+      VINEYARD_CHECK_OK(writer_client.Connect(ipc_socket));
+      auto byte_stream =
+          writer_client.GetObject<ByteStream>(stream_ids[partition]);
+      std::unique_ptr<ByteStreamWriter> writer;
+      VINEYARD_CHECK_OK(byte_stream->OpenWriter(writer_client, writer));
+      for (size_t idx = 0; idx < num_chunks; ++idx) {
+        std::string message = std::to_string(partition * num_chunks + idx);
+        std::unique_ptr<arrow::MutableBuffer> buffer = nullptr;
+        VINEYARD_CHECK_OK(writer->GetNext(message.size(), buffer));
+        memcpy(buffer->mutable_data(), message.data(), message.size());
+        if (partition % 2 == 0) {
+          usleep(1000);
+        }
+      }
+      VINEYARD_CHECK_OK(writer->Finish());
+      writer_client.Disconnect();
+    });
+  }
+
+  std::mutex mutex;
+  std::vector<size_t> received;
+  std::vector<std::thread> consumers;
+  for (size_t idx = 0; idx < num_consumers; ++idx) {
+    consumers.emplace_back([&]() {
+      while (true) {
+        std::vector<std::shared_ptr<arrow::Buffer>> chunks;
+        auto status = reader.GetNextBatch(4, chunks);
+        if (!status.ok()) {
+          CHECK(status.IsStreamDrained());
+          break;
+        }
+        std::lock_guard<std::mutex> lock(mutex);
+        for (auto const& chunk : chunks) {
+          received.emplace_back(std::stoul(chunk->ToString()));
+        }
+      }
+    });
+  }
+
+  for (auto& thrd : producers) {
+    thrd.join();
+  }
+  for (auto& thrd : consumers) {
+    thrd.join();
+  }
+
+  std::sort(received.begin(), received.end());
+  CHECK_EQ(received.size(), num_partitions * num_chunks);
+  for (size_t idx = 0; idx < received.size(); ++idx) {
+    CHECK_EQ(received[idx], idx);
+  }
+
+  LOG(INFO) << "Passed parallel stream tests...";
+
+  client.Disconnect();
+
+  return 0;
+}
@@ -0,0 +1,105 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "arrow/status.h"
+#include "arrow/util/io_util.h"
+#include "arrow/util/logging.h"
+
+#include "basic/ds/perfect_hashmap.h"
+#include "client/client.h"
+#include "client/ds/object_meta.h"
+#include "common/util/logging.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    printf("usage ./perfect_hashmap_test <ipc_socket_name>");
+    return 1;
+  }
+  std::string ipc_socket = std::string(argv[1]);
+
+  Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+  LOG(INFO) << "Connected to IPCServer: " << ipc_socket;
+
+  using map_t = PerfectHashmap<int64_t, double>;
+
+  {
+    const int64_t num_elements = 100000;
+    PerfectHashmapBuilder<int64_t, double> builder(client);
+    builder.reserve(num_elements);
+    for (int64_t i = 0; i < num_elements; ++i) {
+      builder[i * 7] = i * 0.5;
+    }
+    auto sealed_hashmap =
+        std::dynamic_pointer_cast<map_t>(builder.Seal(client));
+    ObjectID id = sealed_hashmap->id();
+    auto vy_hashmap = std::dynamic_pointer_cast<map_t>(client.GetObject(id));
+    CHECK_EQ(sealed_hashmap->size(), num_elements);
+    CHECK_EQ(vy_hashmap->size(), num_elements);
+    CHECK_EQ(std::distance(vy_hashmap->begin(), vy_hashmap->end()),
+             num_elements);
+
+    for (int64_t i = 0; i < num_elements; ++i) {
+      CHECK_DOUBLE_EQ(sealed_hashmap->at(i * 7), i * 0.5);
+      CHECK_DOUBLE_EQ(vy_hashmap->at(i * 7), i * 0.5);
+      CHECK_EQ(vy_hashmap->count(i * 7 + 1), 0);
+    }
+
+    std::vector<int64_t> keys;
+    for (int64_t i = 0; i < 1000; ++i) {
+      keys.emplace_back(i);
+    }
+    std::vector<map_t::iterator> results(keys.size());
+    size_t found =
+        vy_hashmap->find(keys.data(), keys.size(), results.data());
+    CHECK_EQ(found, (keys.size() + 6) / 7);
+    for (size_t i = 0; i < keys.size(); ++i) {
+      if (keys[i] % 7 == 0) {
+        CHECK(results[i] != vy_hashmap->end());
+        CHECK_EQ(results[i]->first, keys[i]);
+      } else {
+        CHECK(results[i] == vy_hashmap->end());
+      }
+    }
+    LOG(INFO) << "Passed perfect hashmap tests...";
+  }
+
+  {
+    PerfectHashmapBuilder<int64_t, double> builder(client);
+    auto empty_hashmap = std::dynamic_pointer_cast<map_t>(builder.Seal(client));
+    CHECK(empty_hashmap->empty());
+    CHECK(empty_hashmap->find(1) == empty_hashmap->end());
+
+    PerfectHashmapBuilder<int64_t, double> single_builder(client);
+    single_builder.emplace(42, 1.0);
+    auto single_hashmap =
+        std::dynamic_pointer_cast<map_t>(single_builder.Seal(client));
+    CHECK_EQ(single_hashmap->size(), 1);
+    CHECK_DOUBLE_EQ(single_hashmap->at(42), 1.0);
+    CHECK_EQ(single_hashmap->count(43), 0);
+    LOG(INFO) << "Passed empty and singleton perfect hashmap tests...";
+  }
+
+  client.Disconnect();
+
+  return 0;
+}
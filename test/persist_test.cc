@@ -67,6 +67,31 @@ int main(int argc, char** argv) {
 
   LOG(INFO) << "Passed persist tests...";
 
+  {
+    std::vector<ObjectID> ids;
+    uint64_t ticket = 0;
+    for (int i = 0; i < 16; ++i) {
+      ArrayBuilder<double> builder(client, double_array);
+      ids.emplace_back(builder.Seal(client)->id());
+      VINEYARD_CHECK_OK(client.PersistAsync(ids.back(), ticket));
+    }
+    VINEYARD_CHECK_OK(client.WaitPersisted(ticket));
+    for (auto const id : ids) {
+      bool persist = false;
+      VINEYARD_CHECK_OK(client.IfPersist(id, persist));
+      CHECK(persist);
+    }
+    // nothing is pending
+    VINEYARD_CHECK_OK(client.WaitPersisted());
+
+    // the failure is reported by the barrier, once
+    VINEYARD_CHECK_OK(client.PersistAsync(GenerateObjectID()));
+    CHECK(!client.WaitPersisted().ok());
+    VINEYARD_CHECK_OK(client.WaitPersisted());
+  }
+
+  LOG(INFO) << "Passed async persist tests...";
+
   client.Disconnect();
 
   return 0;
@@ -0,0 +1,102 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include <stdlib.h>
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "arrow/status.h"
+#include "arrow/util/io_util.h"
+#include "arrow/util/logging.h"
+
+#include "basic/ds/array.h"
+#include "client/client.h"
+#include "client/ds/object_meta.h"
+#include "common/util/logging.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+constexpr size_t kThreads = 8;
+constexpr size_t kRounds = 256;
+
+// issues requests whose replies identify the request, from multiple threads
+// on the same client, thus a reply matched to the wrong request fails the
+// checks.
+void issueRequests(Client& client, const size_t index) {
+  std::vector<int64_t> data(16, static_cast<int64_t>(index));
+  ArrayBuilder<int64_t> builder(client, data);
+  ObjectID id = builder.Seal(client)->id();
+
+  for (size_t round = 0; round < kRounds; ++round) {
+    {
+      json tree;
+      VINEYARD_CHECK_OK(client.GetData(id, tree));
+      CHECK_EQ(VYObjectIDFromString(tree["id"].get_ref<std::string const&>()),
+               id);
+    }
+
+    {
+      std::string name = "pipelining_test_" + std::to_string(index) + "_" +
+                         std::to_string(round);
+      ObjectID named = InvalidObjectID();
+      VINEYARD_CHECK_OK(client.PutName(id, name));
+      VINEYARD_CHECK_OK(client.GetName(name, named));
+      CHECK_EQ(named, id);
+      VINEYARD_CHECK_OK(client.DropName(name));
+    }
+
+    // interleaves with the unpipelined requests that transfer fds
+    if (round % 64 == 0) {
+      std::shared_ptr<Array<int64_t>> array;
+      VINEYARD_CHECK_OK(client.GetObject(id, array));
+      CHECK_EQ(array->size(), data.size());
+      for (size_t i = 0; i < data.size(); ++i) {
+        CHECK_EQ((*array)[i], data[i]);
+      }
+    }
+  }
+}
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    printf("usage ./pipelining_test <ipc_socket>");
+    return 1;
+  }
+  std::string ipc_socket = std::string(argv[1]);
+
+  // opt in the pipelining before connecting
+  setenv("VINEYARD_PIPELINING", "1", 1);
+
+  Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+  LOG(INFO) << "Connected to IPCServer: " << ipc_socket;
+
+  std::vector<std::thread> threads;
+  for (size_t index = 0; index < kThreads; ++index) {
+    threads.emplace_back(issueRequests, std::ref(client), index);
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  LOG(INFO) << "Passed pipelining tests...";
+
+  client.Disconnect();
+
+  return 0;
+}
@@ -0,0 +1,107 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "arrow/status.h"
+#include "arrow/util/io_util.h"
+#include "arrow/util/logging.h"
+
+#include "client/client.h"
+#include "client/ds/blob.h"
+#include "client/ds/object_meta.h"
+#include "common/util/logging.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+// the server runs with `--reserve_memory` and `--reserve_memory_threads=4`,
+// and with `--reserve_memory_async` in the "async" mode, see also
+// `test/runner.py`.
+constexpr size_t kBlobSize = 1024 * 1024;
+constexpr size_t kBlobs = 64;
+
+std::shared_ptr<InstanceStatus> GetStatus(Client& client) {
+  std::shared_ptr<InstanceStatus> status;
+  VINEYARD_CHECK_OK(client.InstanceStatus(status));
+  return status;
+}
+
+char ValueAt(size_t blob, size_t offset) {
+  return static_cast<char>(blob * 131 + offset * 7 + 1);
+}
+
+int main(int argc, char** argv) {
+  if (argc < 3) {
+    printf("usage ./prefault_test <ipc_socket> <sync|async>");
+    return 1;
+  }
+  std::string ipc_socket = std::string(argv[1]);
+  bool async = std::string(argv[2]) == "async";
+
+  Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+  LOG(INFO) << "Connected to IPCServer: " << ipc_socket;
+
+  auto status = GetStatus(client);
+  CHECK_GT(status->prefault_size, 0);
+  if (!async) {
+    // the server starts serving after the arena has been pre-faulted
+    CHECK_EQ(status->prefaulted_size, status->prefault_size);
+  }
+
+  // the blobs written during (the background) pre-faulting are kept intact
+  std::vector<ObjectID> ids;
+  for (size_t blob = 0; blob < kBlobs; ++blob) {
+    std::unique_ptr<BlobWriter> writer;
+    VINEYARD_CHECK_OK(client.CreateBlob(kBlobSize, writer));
+    for (size_t offset = 0; offset < kBlobSize; offset += 4093) {
+      writer->data()[offset] = ValueAt(blob, offset);
+    }
+    ids.emplace_back(writer->Seal(client)->id());
+  }
+
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(60);
+  size_t prefaulted = 0;
+  while (true) {
+    status = GetStatus(client);
+    CHECK_GE(status->prefaulted_size, prefaulted);
+    prefaulted = status->prefaulted_size;
+    if (prefaulted == status->prefault_size) {
+      break;
+    }
+    CHECK(std::chrono::steady_clock::now() < deadline)
+        << "pre-faulted " << prefaulted << " of " << status->prefault_size;
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  }
+
+  std::vector<std::shared_ptr<Blob>> blobs;
+  VINEYARD_CHECK_OK(client.GetBlobs(ids, blobs));
+  for (size_t blob = 0; blob < kBlobs; ++blob) {
+    for (size_t offset = 0; offset < kBlobSize; offset += 4093) {
+      CHECK_EQ(blobs[blob]->data()[offset], ValueAt(blob, offset));
+    }
+  }
+  blobs.clear();
+  VINEYARD_CHECK_OK(client.DelData(ids));
+  LOG(INFO) << "Passed " << (async ? "async" : "sync") << " prefault tests...";
+
+  client.Disconnect();
+
+  return 0;
+}
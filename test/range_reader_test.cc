@@ -0,0 +1,168 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <stdio.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <future>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "arrow/api.h"
+#include "arrow/io/api.h"
+
+#include "common/util/logging.h"
+#include "io/io/range_reader.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+// not a multiple of the chunk size, to cover the short read at the end
+constexpr int64_t kFileSize = 4 * 1024 * 1024 + 123;
+constexpr int64_t kChunkSize = 64 * 1024;
+
+// an in-memory file like the ones of object stores: the first `failures`
+// reads fail, and a read returns at most `max_read` bytes.
+class FlakyFile : public arrow::io::RandomAccessFile {
+ public:
+  FlakyFile(std::shared_ptr<arrow::Buffer> buffer, const int failures,
+            const int64_t max_read)
+      : reader_(std::make_shared<arrow::io::BufferReader>(buffer)),
+        failures_(failures),
+        max_read_(max_read) {}
+
+  arrow::Status Close() override { return reader_->Close(); }
+
+  bool closed() const override { return reader_->closed(); }
+
+  arrow::Result<int64_t> Tell() const override { return reader_->Tell(); }
+
+  arrow::Status Seek(int64_t position) override {
+    return reader_->Seek(position);
+  }
+
+  arrow::Result<int64_t> GetSize() override { return reader_->GetSize(); }
+
+  arrow::Result<int64_t> Read(int64_t nbytes, void* out) override {
+    return reader_->Read(nbytes, out);
+  }
+
+  arrow::Result<std::shared_ptr<arrow::Buffer>> Read(int64_t nbytes) override {
+    return reader_->Read(nbytes);
+  }
+
+  arrow::Result<int64_t> ReadAt(int64_t position, int64_t nbytes,
+                                void* out) override {
+    ++reads_;
+    if (failures_.fetch_sub(1) > 0) {
+      return arrow::Status::IOError("Injected failure at ", position);
+    }
+    return reader_->ReadAt(position, std::min(nbytes, max_read_), out);
+  }
+
+  arrow::Result<std::shared_ptr<arrow::Buffer>> ReadAt(
+      int64_t position, int64_t nbytes) override {
+    return reader_->ReadAt(position, nbytes);
+  }
+
+  int reads() const { return reads_.load(); }
+
+ private:
+  std::shared_ptr<arrow::io::BufferReader> reader_;
+  std::atomic<int> failures_;
+  std::atomic<int> reads_{0};
+  const int64_t max_read_;
+};
+
+std::shared_ptr<arrow::Buffer> makeContent() {
+  auto content = arrow::AllocateBuffer(kFileSize);
+  CHECK(content.ok());
+  std::shared_ptr<arrow::Buffer> buffer = std::move(content).ValueUnsafe();
+  for (int64_t idx = 0; idx < kFileSize; ++idx) {
+    buffer->mutable_data()[idx] = static_cast<uint8_t>(idx * 131 + idx / 4096);
+  }
+  return buffer;
+}
+
+// the chunks are read out of order, and the last one passes the end of file
+void testConcurrentReads(std::shared_ptr<arrow::Buffer> const& content,
+                         const unsigned concurrency, const int failures,
+                         const int64_t max_read) {
+  auto file = std::make_shared<FlakyFile>(content, failures, max_read);
+  RangeReader reader(file, concurrency, 3);
+  CHECK_EQ(reader.Concurrency(), std::max(1u, concurrency));
+
+  int64_t num_chunks = (kFileSize + kChunkSize - 1) / kChunkSize;
+  std::vector<char> buffer(num_chunks * kChunkSize, 0);
+  std::vector<int64_t> nreads(num_chunks, -1);
+  std::vector<std::future<Status>> futures;
+  for (int64_t chunk = num_chunks - 1; chunk >= 0; --chunk) {
+    futures.emplace_back(reader.ReadAsync(chunk * kChunkSize,
+                                          buffer.data() + chunk * kChunkSize,
+                                          kChunkSize, &nreads[chunk]));
+  }
+  for (auto& future : futures) {
+    VINEYARD_CHECK_OK(future.get());
+  }
+  for (int64_t chunk = 0; chunk < num_chunks; ++chunk) {
+    CHECK_EQ(nreads[chunk],
+             std::min(kChunkSize, kFileSize - chunk * kChunkSize));
+  }
+  CHECK_EQ(memcmp(buffer.data(), content->data(), kFileSize), 0);
+  // short reads are continued, rather than returned
+  CHECK_GE(file->reads(),
+           num_chunks * ((kChunkSize + max_read - 1) / max_read));
+}
+
+// a read fails once the retries are exhausted, and the failure doesn't
+// break the later reads
+void testExhaustedRetries(std::shared_ptr<arrow::Buffer> const& content) {
+  auto file = std::make_shared<FlakyFile>(content, 3, kChunkSize);
+  RangeReader reader(file, 4, 2);
+
+  std::vector<char> buffer(kChunkSize);
+  auto status = reader.ReadAsync(0, buffer.data(), kChunkSize).get();
+  CHECK(!status.ok());
+  CHECK_EQ(file->reads(), 3);
+
+  VINEYARD_CHECK_OK(reader.ReadAsync(0, buffer.data(), kChunkSize).get());
+  CHECK_EQ(memcmp(buffer.data(), content->data(), kChunkSize), 0);
+}
+
+int main(int argc, char** argv) {
+  auto content = makeContent();
+
+  for (unsigned concurrency : {0u, 1u, 16u}) {
+    testConcurrentReads(content, concurrency, 0, kChunkSize);
+  }
+  LOG(INFO) << "Passed the concurrent reads tests...";
+
+  testConcurrentReads(content, 16, 0, 10007);
+  LOG(INFO) << "Passed the short reads tests...";
+
+  // every request is retried at most 3 times
+  testConcurrentReads(content, 16, 3, kChunkSize);
+  testConcurrentReads(content, 1, 3, 10007);
+  LOG(INFO) << "Passed the retried reads tests...";
+
+  testExhaustedRetries(content);
+  LOG(INFO) << "Passed the exhausted retries tests...";
+
+  LOG(INFO) << "Passed range reader tests...";
+  return 0;
+}
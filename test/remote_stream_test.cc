@@ -0,0 +1,137 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <memory>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "arrow/status.h"
+#include "arrow/util/io_util.h"
+#include "arrow/util/logging.h"
+
+#include "basic/stream/byte_stream.h"
+#include "client/client.h"
+#include "client/ds/object_meta.h"
+#include "client/rpc_client.h"
+#include "common/util/logging.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+ObjectID CreateByteStream(Client& client) {
+  ByteStreamBuilder builder(client);
+  builder.SetParams(std::unordered_map<std::string, std::string>{
+      {"kind", "test"}, {"test_name", "remote_stream_test"}});
+  auto bstream = std::dynamic_pointer_cast<ByteStream>(builder.Seal(client));
+  CHECK(bstream != nullptr);
+  return bstream->id();
+}
+
+int main(int argc, char** argv) {
+  if (argc < 3) {
+    printf("usage ./remote_stream_test <ipc_socket> <rpc_endpoint>");
+    return 1;
+  }
+  std::string ipc_socket(argv[1]);
+  std::string rpc_endpoint(argv[2]);
+
+  Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+  LOG(INFO) << "Connected to IPCServer: " << ipc_socket;
+
+  // the chunks of the "remote" stream are forwarded into the "local" one
+  ObjectID remote_id = CreateByteStream(client);
+  ObjectID local_id = CreateByteStream(client);
+
+  const size_t num_chunks = 64;
+  std::vector<std::string> messages;
+  for (size_t idx = 0; idx < num_chunks; ++idx) {
+    messages.emplace_back("message-" + std::to_string(idx));
+  }
+
+  std::thread send_thrd([&]() {
+    Client writer_client;
+    VINEYARD_CHECK_OK(writer_client.Connect(ipc_socket));
+    auto byte_stream = writer_client.GetObject<ByteStream>(remote_id);
+    std::unique_ptr<ByteStreamWriter> writer;
+    VINEYARD_CHECK_OK(byte_stream->OpenWriter(writer_client, writer));
+    for (auto const& message : messages) {
+      std::unique_ptr<arrow::MutableBuffer> buffer = nullptr;
+      VINEYARD_CHECK_OK(writer->GetNext(message.size(), buffer));
+      memcpy(buffer->mutable_data(), message.data(), message.size());
+    }
+    VINEYARD_CHECK_OK(writer->Finish());
+  });
+
+  std::thread forward_thrd([&]() {
+    Client local_client;
+    VINEYARD_CHECK_OK(local_client.Connect(ipc_socket));
+    RPCClient rpc_client;
+    VINEYARD_CHECK_OK(rpc_client.Connect(rpc_endpoint));
+    // a small window of credits to exercise the flow control
+    VINEYARD_CHECK_OK(
+        rpc_client.ForwardStream(remote_id, local_client, local_id, 2));
+  });
+
+  std::vector<std::string> received;
+  std::thread recv_thrd([&]() {
+    Client reader_client;
+    VINEYARD_CHECK_OK(reader_client.Connect(ipc_socket));
+    auto byte_stream = reader_client.GetObject<ByteStream>(local_id);
+    std::unique_ptr<ByteStreamReader> reader;
+    VINEYARD_CHECK_OK(byte_stream->OpenReader(reader_client, reader));
+    while (true) {
+      std::unique_ptr<arrow::Buffer> buffer = nullptr;
+      auto status = reader->GetNext(buffer);
+      if (!status.ok()) {
+        CHECK(status.IsStreamDrained());
+        break;
+      }
+      received.emplace_back(buffer->ToString());
+    }
+  });
+
+  send_thrd.join();
+  forward_thrd.join();
+  recv_thrd.join();
+
+  CHECK_EQ(messages.size(), received.size());
+  for (size_t idx = 0; idx < messages.size(); ++idx) {
+    CHECK_EQ(messages[idx], received[idx]);
+  }
+
+  // a subscription fails when the stream is aborted
+  {
+    ObjectID failed_id = CreateByteStream(client);
+    RPCClient rpc_client;
+    VINEYARD_CHECK_OK(rpc_client.Connect(rpc_endpoint));
+    VINEYARD_CHECK_OK(rpc_client.SubscribeStream(failed_id));
+
+    auto byte_stream = client.GetObject<ByteStream>(failed_id);
+    std::unique_ptr<ByteStreamWriter> writer;
+    VINEYARD_CHECK_OK(byte_stream->OpenWriter(client, writer));
+    VINEYARD_CHECK_OK(writer->Abort());
+
+    std::vector<std::shared_ptr<arrow::Buffer>> chunks;
+    CHECK(rpc_client.ReceiveStreamChunks(chunks).IsStreamFailed());
+  }
+
+  LOG(INFO) << "Passed remote stream tests...";
+
+  client.Disconnect();
+
+  return 0;
+}
@@ -0,0 +1,124 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include <stdlib.h>
+
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "common/memory/ring_buffer.h"
+#include "common/util/logging.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+constexpr size_t kCapacity = 4096;
+
+// a ring in private memory, the header is placed at the beginning as in the
+// shared memory segment.
+struct TestRing {
+  TestRing()
+      : memory(sizeof(RingBufferHeader) + kCapacity + alignof(RingBufferHeader)),
+        base(reinterpret_cast<uint8_t*>(
+            (reinterpret_cast<uintptr_t>(memory.data()) +
+             alignof(RingBufferHeader) - 1) /
+            alignof(RingBufferHeader) * alignof(RingBufferHeader))),
+        ring(base, kCapacity, true) {}
+
+  RingBufferHeader* header() {
+    return reinterpret_cast<RingBufferHeader*>(base);
+  }
+
+  std::vector<uint8_t> memory;
+  uint8_t* base;
+  RingBuffer ring;
+};
+
+void testRoundTrip() {
+  TestRing ring;
+  std::string small = "hello, vineyard";
+  // larger than the ring, streamed through it
+  std::string large(kCapacity * 5 + 17, '\0');
+  for (size_t i = 0; i < large.size(); ++i) {
+    large[i] = static_cast<char>(i * 7);
+  }
+
+  std::thread writer([&]() {
+    VINEYARD_CHECK_OK(ring.ring.WriteMessage(small, nullptr));
+    VINEYARD_CHECK_OK(ring.ring.WriteMessage(large, nullptr));
+  });
+  std::string message;
+  VINEYARD_CHECK_OK(ring.ring.ReadMessage(message, nullptr));
+  // keep the same as `recv_message`, with a trailing '\0'
+  CHECK_EQ(message.size(), small.size() + 1);
+  CHECK_EQ(message.substr(0, small.size()), small);
+  VINEYARD_CHECK_OK(ring.ring.ReadMessage(message, nullptr));
+  CHECK_EQ(message.size(), large.size() + 1);
+  CHECK(message.compare(0, large.size(), large) == 0);
+  writer.join();
+  LOG(INFO) << "Passed round trip tests...";
+}
+
+void testCorruptedPositions() {
+  // the peer advances the tail beyond the capacity
+  {
+    TestRing ring;
+    ring.header()->tail.store(kCapacity * 3);
+    std::string message;
+    CHECK(!ring.ring.ReadMessage(message, nullptr).ok());
+    CHECK(ring.ring.Closed());
+  }
+  // the peer moves the head beyond the tail
+  {
+    TestRing ring;
+    ring.header()->head.store(kCapacity);
+    CHECK(!ring.ring.WriteMessage("message", nullptr).ok());
+    CHECK(ring.ring.Closed());
+  }
+  LOG(INFO) << "Passed corrupted positions tests...";
+}
+
+void testBogusLength() {
+  // a huge length prefix doesn't allocate up front, and reading fails once
+  // the peer closes the ring.
+  TestRing ring;
+  size_t length = static_cast<size_t>(1) << 60;
+  auto writer = [&]() {
+    RingBufferHeader* header = ring.header();
+    uint8_t* data = ring.base + sizeof(RingBufferHeader);
+    memcpy(data, &length, sizeof(size_t));
+    memcpy(data + sizeof(size_t), "abcd", 4);
+    header->tail.store(sizeof(size_t) + 4);
+    header->readable.fetch_add(1);
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    ring.ring.Close();
+  };
+  std::thread thread(writer);
+  std::string message;
+  CHECK(!ring.ring.ReadMessage(message, nullptr).ok());
+  CHECK_LE(message.capacity(), 2 * kCapacity);
+  thread.join();
+  LOG(INFO) << "Passed bogus length tests...";
+}
+
+int main(int argc, char** argv) {
+  testRoundTrip();
+  testCorruptedPositions();
+  testBogusLength();
+  LOG(INFO) << "Passed ring buffer tests...";
+  return 0;
+}
@@ -13,9 +13,14 @@ See the License for the specific language governing permissions and
 limitations under the License.
 */
 
+#include <unistd.h>
+
+#include <map>
 #include <memory>
 #include <string>
 #include <thread>
+#include <utility>
+#include <vector>
 
 #include "arrow/status.h"
 #include "arrow/util/io_util.h"
@@ -23,9 +28,12 @@ limitations under the License.
 
 #include "basic/ds/array.h"
 #include "client/client.h"
+#include "client/ds/blob.h"
 #include "client/ds/object_meta.h"
+#include "client/io.h"
 #include "client/rpc_client.h"
 #include "common/util/logging.h"
+#include "common/util/protocols.h"
 
 using namespace vineyard;  // NOLINT(build/namespaces)
 
@@ -60,6 +68,74 @@ int main(int argc, char** argv) {
   CHECK_EQ(vy_double_array->size(), double_array.size());
   CHECK_EQ(vy_double_array->size(), sealed_double_array->size());
 
+  // fetch the blob contents into local blobs
+  {
+    ObjectID blob_id =
+        sealed_double_array->meta().GetMemberMeta("buffer_").GetId();
+    std::map<ObjectID, std::unique_ptr<BlobWriter>> blobs;
+    VINEYARD_CHECK_OK(rpc_client.GetRemoteBlobs({blob_id}, ipc_client, blobs));
+    CHECK_EQ(blobs.size(), 1);
+    auto& blob = blobs.at(blob_id);
+    CHECK_EQ(blob->size(), sizeof(double) * double_array.size());
+    auto data = reinterpret_cast<const double*>(blob->data());
+    for (size_t i = 0; i < double_array.size(); ++i) {
+      CHECK_EQ(data[i], double_array[i]);
+    }
+    VINEYARD_CHECK_OK(blob->Abort(ipc_client));
+  }
+
+  // stripe the blob across multiple connections
+  {
+    VINEYARD_CHECK_OK(rpc_client.ConnectDataStreams(3, 16));
+    ObjectID blob_id =
+        sealed_double_array->meta().GetMemberMeta("buffer_").GetId();
+    std::map<ObjectID, std::unique_ptr<BlobWriter>> blobs;
+    VINEYARD_CHECK_OK(rpc_client.GetRemoteBlobs({blob_id}, ipc_client, blobs));
+    auto& blob = blobs.at(blob_id);
+    CHECK_EQ(blob->size(), sizeof(double) * double_array.size());
+    auto data = reinterpret_cast<const double*>(blob->data());
+    for (size_t i = 0; i < double_array.size(); ++i) {
+      CHECK_EQ(data[i], double_array[i]);
+    }
+    VINEYARD_CHECK_OK(blob->Abort(ipc_client));
+  }
+
+  // chunks out of the range of the blob are rejected, including the ones
+  // whose end overflows.
+  {
+    ObjectID blob_id =
+        sealed_double_array->meta().GetMemberMeta("buffer_").GetId();
+    std::string host = rpc_endpoint.substr(0, rpc_endpoint.find(':'));
+    uint32_t port = static_cast<uint32_t>(
+        std::stoul(rpc_endpoint.substr(rpc_endpoint.find(':') + 1)));
+    int conn = -1;
+    VINEYARD_CHECK_OK(connect_rpc_socket_retry(host, port, conn));
+    std::string message_out, message_in;
+    WriteRegisterRequest(message_out);
+    VINEYARD_CHECK_OK(send_message(conn, message_out));
+    VINEYARD_CHECK_OK(recv_message(conn, message_in));
+
+    size_t const blob_size = sizeof(double) * double_array.size();
+    std::vector<std::pair<size_t, size_t>> chunks = {
+        {blob_size, 1},
+        {blob_size + 1, 0},
+        {1, blob_size},
+        {static_cast<size_t>(-1), 2},
+        {8, static_cast<size_t>(-1) - 7},
+    };
+    for (auto const& chunk : chunks) {
+      WriteGetRemoteBufferChunksRequest({blob_id}, {chunk.first},
+                                        {chunk.second}, message_out);
+      VINEYARD_CHECK_OK(send_message(conn, message_out));
+      VINEYARD_CHECK_OK(recv_message(conn, message_in));
+      size_t total_size = 0;
+      CHECK(!ReadGetRemoteBufferChunksReply(json::parse(message_in),
+                                            total_size)
+                 .ok());
+    }
+    close(conn);
+  }
+
   LOG(INFO) << "Passed rpc client tests...";
 
   ipc_client.Disconnect();
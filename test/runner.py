@@ -2,12 +2,16 @@
 # -*- coding: utf-8 -*-
 
 from argparse import ArgumentParser
+import base64
 import contextlib
 import importlib
+import json
 import os
 import platform
 import socket
+import struct
 import subprocess
+import tempfile
 import time
 
 
@@ -69,7 +73,7 @@ def start_etcd():
 
 
 @contextlib.contextmanager
-def start_vineyardd(etcd_endpoints, etcd_prefix, size=4 * 1024 * 1024 * 1024,
+def start_vineyardd(etcd_endpoints, etcd_prefix, *args, size=4 * 1024 * 1024 * 1024,
                     default_ipc_socket=VINEYARD_CI_IPC_SOCKET,
                     idx=None, **kw):
     rpc_socket_port = find_port()
@@ -84,6 +88,7 @@ def start_vineyardd(etcd_endpoints, etcd_prefix, size=4 * 1024 * 1024 * 1024,
                              '--rpc_socket_port', str(rpc_socket_port),
                              '--etcd_endpoint', etcd_endpoints,
                              '--etcd_prefix', etcd_prefix,
+                             *args,
                              verbose=True, **kw)
         yield stack.enter_context(proc), rpc_socket_port
 
@@ -202,40 +207,97 @@ def run_invalid_client_test(host, port):
     send_garbage_bytes(b'\xFF' * 10000)
     send_garbage_bytes(b'\xFF' * 100000)
 
+    # well-framed messages with invalid fields
+    def send_garbage_message(body):
+        send_garbage_bytes(struct.pack('<Q', len(body)) + body)
 
-def run_single_vineyardd_tests():
+    send_garbage_message(b'[]')
+    send_garbage_message(b'{}')
+    send_garbage_message(b'{"type": 1}')
+    send_garbage_message(b'{"type": "register_request", "request_id": "1"}')
+    send_garbage_message(b'{"type": "register_request", "request_id": 1.5}')
+    send_garbage_message(b'{"type": "register_request", "request_id": null}')
+
+
+def run_single_vineyardd_tests(*args):
     etcd_port = find_port()
     [find_port() for _ in range(10)]  # skip some ports
     with start_vineyardd('http://localhost:%d' % etcd_port,
                          'vineyard_test_%s' % time.time(),
+                         *args,
                          default_ipc_socket=VINEYARD_CI_IPC_SOCKET) as (_, rpc_socket_port):
         run_test('array_test')
         # FIXME: cannot be safely dtor after #350 and #354.
         # run_test('allocator_test')
         run_test('arrow_data_structure_test')
+        run_test('arrow_memory_pool_test')
+        run_test('async_client_test')
+        run_test('async_file_reader_test')
+        run_test('binary_protocol_test')
+        run_test('blob_extend_test')
+        run_test('blob_from_file_test')
+        run_test('blob_table_test')
+        run_test('bulk_lane_test')
+        run_test('checksum_test')
+        run_test('chunked_blobs_test')
+        run_test('chunked_table_test')
+        run_test('columnar_stream_test')
+        run_test('compact_meta_test')
+        run_test('concurrent_meta_test')
+        run_test('connection_churn_test')
+        run_test('create_blobs_test')
         run_test('dataframe_test')
         run_test('delete_test')
+        run_test('device_blob_test')
+        run_test('encoded_array_test')
+        run_test('fanout_stream_test')
+        run_test('footprint_test')
         run_test('get_wait_test')
+        run_test('get_object_profile_test')
         run_test('get_object_test')
         run_test('global_object_test')
         run_test('hashmap_test')
         run_test('id_test')
         run_test('invalid_connect_test', '127.0.0.1:%d' % rpc_socket_port)
+        run_test('io_driver_test')
+        run_test('ipc_ring_test')
+        run_test('kernels_test')
         run_test('large_meta_test')
         run_test('list_object_test')
+        run_test('local_io_adaptor_test')
+        run_test('malloc_test')
+        run_test('memcpy_test')
+        run_test('meta_cache_test')
+        run_test('mpmc_queue_test')
         run_test('name_test')
+        run_test('object_subscription_test')
+        run_test('packed_test')
         run_test('pair_test')
+        run_test('parallel_stream_test')
+        run_test('perfect_hashmap_test')
         run_test('persist_test')
+        run_test('pipelining_test')
+        run_test('range_reader_test')
+        run_test('release_test')
+        run_test('remote_stream_test', '127.0.0.1:%d' % rpc_socket_port)
+        run_test('ring_buffer_test')
         run_test('rpc_delete_test', '127.0.0.1:%d' % rpc_socket_port)
         run_test('rpc_get_object_test', '127.0.0.1:%d' % rpc_socket_port)
         run_test('rpc_test', '127.0.0.1:%d' % rpc_socket_port)
         run_test('scalar_test')
         run_test('server_status_test')
         run_test('signature_test')
+        run_test('small_blob_test')
+        run_test('snapshot_test')
+        run_test('sorted_index_test')
         run_test('shallow_copy_test')
+        run_test('shared_mmap_test')
         run_test('deep_copy_test')
+        run_test('stream_pool_test')
+        run_test('stream_replay_test')
         run_test('stream_test')
         run_test('tensor_test')
+        run_test('ttl_test')
         run_test('tuple_test')
         run_test('typename_test')
         run_test('version_test')
@@ -243,6 +305,251 @@ def run_single_vineyardd_tests():
         run_invalid_client_test('127.0.0.1', rpc_socket_port)
 
 
+def run_lru_eviction_tests():
+    etcd_port = find_port()
+    with start_vineyardd('http://localhost:%d' % etcd_port,
+                         'vineyard_test_%s' % time.time(),
+                         '--lru_eviction',
+                         size=64 * 1024 * 1024,
+                         default_ipc_socket=VINEYARD_CI_IPC_SOCKET):
+        run_test('lru_eviction_test')
+
+
+def run_spill_tests():
+    etcd_port = find_port()
+    with tempfile.TemporaryDirectory() as spill_path:
+        with start_vineyardd('http://localhost:%d' % etcd_port,
+                             'vineyard_test_%s' % time.time(),
+                             '--spill_path', spill_path,
+                             size=64 * 1024 * 1024,
+                             default_ipc_socket=VINEYARD_CI_IPC_SOCKET):
+            run_test('spill_test')
+
+
+def run_backing_store_tests():
+    etcd_port = find_port()
+    with tempfile.TemporaryDirectory() as store_path:
+        ids_file = os.path.join(store_path, 'ids')
+        # the blobs are hydrated from the backing store after the restart
+        for mode in ['persist', 'restore']:
+            with start_vineyardd('http://localhost:%d' % etcd_port,
+                                 'vineyard_test_%s' % time.time(),
+                                 '--backing_store', os.path.join(store_path, 'blobs'),
+                                 '--backing_store_chunk_size', str(256 * 1024),
+                                 size=256 * 1024 * 1024,
+                                 default_ipc_socket=VINEYARD_CI_IPC_SOCKET):
+                run_test('blob_restore_test', mode, ids_file)
+
+
+def run_snapshot_restore_tests():
+    etcd_port = find_port()
+    with tempfile.TemporaryDirectory() as snapshot_path:
+        ids_file = os.path.join(snapshot_path, 'ids')
+        # the blobs are mapped from the snapshot after the restart
+        for mode in ['persist', 'restore']:
+            with start_vineyardd('http://localhost:%d' % etcd_port,
+                                 'vineyard_test_%s' % time.time(),
+                                 '--snapshot_path', os.path.join(snapshot_path, 'snapshot'),
+                                 size=256 * 1024 * 1024,
+                                 default_ipc_socket=VINEYARD_CI_IPC_SOCKET):
+                run_test('blob_restore_test', mode, ids_file, 'snapshot')
+
+
+def run_meta_snapshot_tests():
+    with start_etcd() as (_, etcd_endpoints), tempfile.TemporaryDirectory() as snapshot_path:
+        etcd_prefix = 'vineyard_test_%s' % time.time()
+        ids_file = os.path.join(snapshot_path, 'ids')
+        snapshot_file = os.path.join(snapshot_path, 'meta')
+        # the metadata is resumed from the snapshot after the restart, and
+        # the updates after the snapshot are replayed from etcd
+        for mode in ['persist', 'restore']:
+            with start_vineyardd(etcd_endpoints,
+                                 etcd_prefix,
+                                 '--etcd_snapshot', snapshot_file,
+                                 '--etcd_snapshot_interval', '1',
+                                 size=64 * 1024 * 1024,
+                                 default_ipc_socket=VINEYARD_CI_IPC_SOCKET):
+                run_test('meta_snapshot_test', mode, ids_file, snapshot_file)
+
+
+def check_etcd_values(etcd_endpoints, etcd_prefix, ids_file, round, compact):
+    etcdctl = find_executable('etcdctl')
+    output = subprocess.check_output([etcdctl, '--endpoints', etcd_endpoints,
+                                      'get', etcd_prefix, '--prefix', '-w', 'json'])
+    values = dict()
+    for kv in json.loads(output).get('kvs', []):
+        values[base64.b64decode(kv['key']).decode()] = base64.b64decode(kv['value'])
+    with open(ids_file, 'r') as f:
+        for line in f:
+            persisted_round, _, object_id = line.split()
+            if int(persisted_round) != round:
+                continue
+            key = '/data/o%016x' % int(object_id)
+            value = [v for k, v in values.items() if k.endswith(key)]
+            assert len(value) == 1, 'no value for %s in etcd' % key
+            # a CBOR map, or a JSON text
+            if compact:
+                assert value[0][0] & 0xe0 == 0xa0, 'not a CBOR map: %r' % value[0][:16]
+            else:
+                assert value[0][:1] == b'{', 'not a JSON text: %r' % value[0][:16]
+
+
+def run_compact_values_tests():
+    with start_etcd() as (_, etcd_endpoints), tempfile.TemporaryDirectory() as ids_path:
+        etcd_prefix = 'vineyard_test_%s' % time.time()
+        ids_file = os.path.join(ids_path, 'ids')
+        # the instances read the values stored in both forms
+        for round, compact in enumerate([True, False, True, False]):
+            flags = ['--etcd_compact_values'] if compact else []
+            with start_vineyardd(etcd_endpoints,
+                                 etcd_prefix,
+                                 *flags,
+                                 size=64 * 1024 * 1024,
+                                 default_ipc_socket=VINEYARD_CI_IPC_SOCKET):
+                run_test('compact_values_test', str(round), ids_file)
+            check_etcd_values(etcd_endpoints, etcd_prefix, ids_file, round, compact)
+
+
+def run_allocator_spaces_tests():
+    etcd_port = find_port()
+    with start_vineyardd('http://localhost:%d' % etcd_port,
+                         'vineyard_test_%s' % time.time(),
+                         '--allocator_spaces=4',
+                         size=256 * 1024 * 1024,
+                         default_ipc_socket=VINEYARD_CI_IPC_SOCKET):
+        run_test('allocator_spaces_test')
+
+
+def run_hugepage_tests():
+    etcd_port = find_port()
+    with start_vineyardd('http://localhost:%d' % etcd_port,
+                         'vineyard_test_%s' % time.time(),
+                         '--reserve_memory_hugepages',
+                         size=64 * 1024 * 1024,
+                         default_ipc_socket=VINEYARD_CI_IPC_SOCKET):
+        run_test('hugepage_test')
+
+
+def run_prefault_tests():
+    for mode in ['sync', 'async']:
+        etcd_port = find_port()
+        flags = ['--reserve_memory', '--reserve_memory_threads=4']
+        if mode == 'async':
+            flags.append('--reserve_memory_async')
+        with start_vineyardd('http://localhost:%d' % etcd_port,
+                             'vineyard_test_%s' % time.time(),
+                             *flags,
+                             size=512 * 1024 * 1024,
+                             default_ipc_socket=VINEYARD_CI_IPC_SOCKET):
+            run_test('prefault_test', mode)
+
+
+def run_numa_tests():
+    etcd_port = find_port()
+    with start_vineyardd('http://localhost:%d' % etcd_port,
+                         'vineyard_test_%s' % time.time(),
+                         '--numa_aware',
+                         size=256 * 1024 * 1024,
+                         default_ipc_socket=VINEYARD_CI_IPC_SOCKET):
+        run_test('numa_test')
+
+
+def run_metrics_tests():
+    etcd_port = find_port()
+    metrics_port = find_port()
+    with start_vineyardd('http://localhost:%d' % etcd_port,
+                         'vineyard_test_%s' % time.time(),
+                         '--metrics_port', str(metrics_port),
+                         size=256 * 1024 * 1024,
+                         default_ipc_socket=VINEYARD_CI_IPC_SOCKET):
+        run_test('metrics_test', str(metrics_port))
+
+
+def run_deferred_timeout_tests():
+    etcd_port = find_port()
+    with start_vineyardd('http://localhost:%d' % etcd_port,
+                         'vineyard_test_%s' % time.time(),
+                         '--deferred_timeout=2',
+                         default_ipc_socket=VINEYARD_CI_IPC_SOCKET):
+        run_test('deferred_timeout_test')
+
+
+def run_tenant_quota_tests():
+    etcd_port = find_port()
+    with start_vineyardd('http://localhost:%d' % etcd_port,
+                         'vineyard_test_%s' % time.time(),
+                         '--tenant_quota_size=4Mi',
+                         '--tenant_quota_rate=100',
+                         default_ipc_socket=VINEYARD_CI_IPC_SOCKET):
+        run_test('tenant_quota_test')
+
+
+def run_benchmark(name, *args, env=None):
+    print(f'running benchmark -*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-  {name}  -*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-',
+          flush=True)
+    try:
+        executable = find_executable(name)
+    except RuntimeError:
+        print('skipped the benchmark %s, as it is not built' % name, flush=True)
+        return None
+    return json.loads(subprocess.check_output([executable] + list(args), env=env))
+
+
+def run_benchmark_tests():
+    # smoke runs with tiny workloads, checks that the benchmarks finish and
+    # report valid results, rather than the numbers
+    etcd_port = find_port()
+    with start_vineyardd('http://localhost:%d' % etcd_port,
+                         'vineyard_test_%s' % time.time(),
+                         size=256 * 1024 * 1024,
+                         default_ipc_socket=VINEYARD_CI_IPC_SOCKET) as (_, rpc_socket_port):
+        env = os.environ.copy()
+        env['VINEYARD_IPC_SOCKET'] = VINEYARD_CI_IPC_SOCKET
+        env['VINEYARD_RPC_ENDPOINT'] = '127.0.0.1:%d' % rpc_socket_port
+
+        results = run_benchmark('vineyard_bench', '--benchmark_min_time=0.01', '--benchmark_format=json', env=env)
+        if results is not None:
+            assert results['benchmarks'], 'no micro-benchmarks have been run'
+            for result in results['benchmarks']:
+                if result['name'].startswith('BM_FragmentLoad'):
+                    continue  # requires a fragment loaded by "VINEYARD_BENCH_FRAGMENT"
+                assert not result.get('error_occurred', False), '%s: %s' % (result['name'],
+                                                                              result.get('error_message'))
+
+        # the load of every operation, from a few client processes
+        results = run_benchmark('vineyard-bench', '--processes=2', '--duration=1', '--max_objects=64',
+                                '--mix=create_data:4,get_data:8,rpc_get_data:1,persist:1,put_name:1,'
+                                'del_data:3,stream:1',
+                                '--format=json', env=env)
+        if results is not None:
+            assert results['processes'] == 2
+            assert results['throughput'] > 0
+            assert len(results['operations']) == 7, 'missing operations: %s' % list(results['operations'])
+            for operation, result in results['operations'].items():
+                assert result['count'] > 0, 'no %s operations have been run' % operation
+                assert result['errors'] == 0, '%d %s operations failed' % (result['errors'], operation)
+
+        # the backends that are always compiled, under every workload
+        with tempfile.NamedTemporaryFile('w', suffix='.trace') as trace:
+            trace.write('# a: allocate <id> <size>, f: free <id>\n')
+            for index in range(1000):
+                trace.write('a %d %d\n' % (index, 64 << (index % 10)))
+                if index % 3 == 2:
+                    trace.write('f %d\n' % (index - 1))
+            trace.flush()
+            results = run_benchmark('vineyard-bench-allocator', '--allocators=system,dlmalloc,blob',
+                                    '--workloads=pareto,fragmentation,trace', '--trace=%s' % trace.name,
+                                    '--threads=1,2', '--iterations=10000', '--max_items=1024',
+                                    '--live_bytes=%d' % (1024 * 1024), '--rounds=2',
+                                    '--format=json', env=env)
+        if results is not None:
+            assert len(results) == 3 * 3 * 2
+            for result in results:
+                assert 'error' not in result, '%s: %s' % (result['allocator'], result['error'])
+                assert result['throughput'] > 0
+                assert result['failures'] == 0
+
+
 def run_scale_in_out_tests(etcd_endpoints, instance_size=4):
     etcd_prefix = 'vineyard_test_%s' % time.time()
     with start_multiple_vineyardd(etcd_endpoints,
@@ -379,6 +686,38 @@ def run_io_adaptor_distributed_tests(etcd_endpoints, with_migration):
         print('running distributed io adaptors tests use %s seconds' % (time.time() - start_time), flush=True)
 
 
+def run_java_tests():
+    import numpy as np
+    import pyarrow as pa
+    import vineyard
+
+    etcd_port = find_port()
+    with start_vineyardd('http://localhost:%d' % etcd_port,
+                         'vineyard_test_%s' % time.time(),
+                         default_ipc_socket=VINEYARD_CI_IPC_SOCKET):
+        # the table is put by the python client, and resolved by the java client,
+        # see also `TableResolverTest.java`
+        client = vineyard.connect(VINEYARD_CI_IPC_SOCKET)
+        batches = []
+        for index in range(3):
+            values = np.arange(index * 1000, (index + 1) * 1000, dtype=np.int64)
+            batches.append(pa.RecordBatch.from_arrays(
+                [pa.array(values), pa.array(values * 0.5),
+                 pa.array(values, mask=(values % 5 == 0))], ['a', 'b', 'c']))
+        object_id = client.put(pa.Table.from_batches(batches))
+
+        env = os.environ.copy()
+        env['VINEYARD_IPC_SOCKET'] = VINEYARD_CI_IPC_SOCKET
+        env['VINEYARD_TEST_TABLE'] = repr(object_id)
+        start_time = time.time()
+        subprocess.check_call(['mvn', '-q', 'test', '-pl', 'modules/basic', '-am',
+                               '-Dtest=TableResolverTest', '-Dsurefire.failIfNoSpecifiedTests=false'],
+                              cwd=os.path.join(os.path.dirname(os.path.abspath(__file__)), '..', 'java'),
+                              env=env)
+        print('running java tests use %s seconds' % (time.time() - start_time), flush=True)
+        client.close()
+
+
 def parse_sys_args():
     arg_parser = ArgumentParser()
     arg_parser.add_argument('--with-cpp', action='store_true', default=False,
@@ -391,18 +730,37 @@ def parse_sys_args():
                             help='Whether to run object migration tests')
     arg_parser.add_argument('--with-contrib', action='store_true', default=False,
                             help="Whether to run python contrib tests")
+    arg_parser.add_argument('--with-java', action='store_true', default=False,
+                            help='Whether to run java tests')
+    arg_parser.add_argument('--with-benchmarks', action='store_true', default=False,
+                            help='Whether to smoke-run the benchmarks')
     return arg_parser, arg_parser.parse_args()
 
 
 def main():
     parser, args = parse_sys_args()
 
-    if not (args.with_cpp or args.with_python or args.with_io):
+    if not (args.with_cpp or args.with_python or args.with_io or args.with_java or args.with_benchmarks):
         parser.print_help()
         exit(1)
 
     if args.with_cpp:
         run_single_vineyardd_tests()
+        # the same client tests, against the in-process metadata backend
+        run_single_vineyardd_tests('--meta', 'local')
+        run_lru_eviction_tests()
+        run_spill_tests()
+        run_backing_store_tests()
+        run_snapshot_restore_tests()
+        run_meta_snapshot_tests()
+        run_compact_values_tests()
+        run_hugepage_tests()
+        run_prefault_tests()
+        run_allocator_spaces_tests()
+        run_numa_tests()
+        run_metrics_tests()
+        run_deferred_timeout_tests()
+        run_tenant_quota_tests()
         with start_etcd() as (_, etcd_endpoints):
             run_scale_in_out_tests(etcd_endpoints, instance_size=4)
 
@@ -424,6 +782,12 @@ def main():
         with start_etcd() as (_, etcd_endpoints):
             run_io_adaptor_distributed_tests(etcd_endpoints, args.with_migration)
 
+    if args.with_java:
+        run_java_tests()
+
+    if args.with_benchmarks:
+        run_benchmark_tests()
+
 
 
 if __name__ == '__main__':
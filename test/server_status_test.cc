@@ -46,6 +46,7 @@ int main(int argc, char** argv) {
   CHECK_GT(instance_status->memory_limit, 0);
   CHECK_GT(instance_status->memory_limit, instance_status->memory_usage);
   CHECK_EQ(instance_status->instance_id, client.instance_id());
+  CHECK_LE(instance_status->largest_free_size, instance_status->free_size);
 
   std::vector<InstanceID> instances;
   VINEYARD_CHECK_OK(client.Instances(instances));
@@ -58,6 +59,35 @@ int main(int argc, char** argv) {
   CHECK(!cluster.empty());
   CHECK(!cluster[client.instance_id()].empty());
 
+  // the requests above have been traced
+  json traces;
+  VINEYARD_CHECK_OK(client.Debug(json{{"traces", {{"limit", 4}}}}, traces));
+  auto spans =
+      traces["traces"]["resourceSpans"][0]["scopeSpans"][0]["spans"];
+  CHECK(spans.is_array());
+  CHECK_LE(spans.size(), 4);
+
+  // runtime introspection
+  json states;
+  VINEYARD_CHECK_OK(client.Debug(
+      json{{"allocator", json::object()}, {"connections", true},
+           {"streams", true}},
+      states));
+  CHECK(states["allocator"].contains("allocated"));
+  CHECK(states["connections"].is_array());
+  CHECK_GE(states["connections"].size(), 1);
+  CHECK(states["streams"]["streams"].is_array());
+
+  json profile;
+  VINEYARD_CHECK_OK(client.Debug(
+      json{{"profile", {{"seconds", 1}, {"frequency", 99}}}}, profile));
+  CHECK(profile["profile"].contains("profiler"));
+
+  // the sessions cannot be too long
+  json invalid;
+  CHECK(client.Debug(json{{"profile", {{"seconds", 3600}}}}, invalid)
+            .IsAssertionFailed());
+
   LOG(INFO) << "Passed server status tests...";
 
   client.Disconnect();
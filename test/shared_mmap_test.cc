@@ -0,0 +1,85 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <stdlib.h>
+
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "arrow/status.h"
+#include "arrow/util/io_util.h"
+#include "arrow/util/logging.h"
+
+#include "basic/ds/array.h"
+#include "client/client.h"
+#include "client/ds/object_meta.h"
+#include "common/util/logging.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    printf("usage ./shared_mmap_test <ipc_socket>");
+    return 1;
+  }
+  std::string ipc_socket = std::string(argv[1]);
+
+  setenv("VINEYARD_SHARED_MMAP", "1", 1);
+  setenv("VINEYARD_MMAP_PREFAULT", "1", 1);
+
+  std::vector<double> double_array = {1.0, 7.0, 3.0, 4.0, 2.0};
+  ObjectID id = InvalidObjectID();
+
+  Client client1;
+  VINEYARD_CHECK_OK(client1.Connect(ipc_socket));
+  LOG(INFO) << "Connected to IPCServer: " << ipc_socket;
+  {
+    ArrayBuilder<double> builder(client1, double_array);
+    id = builder.Seal(client1)->id();
+  }
+
+  // the forked clients reuse the segments that mapped by `client1`
+  for (int round = 0; round < 4; ++round) {
+    Client client2;
+    VINEYARD_CHECK_OK(client1.Fork(client2));
+    std::shared_ptr<Array<double>> array;
+    VINEYARD_CHECK_OK(client2.GetObject(id, array));
+    CHECK_EQ(array->size(), double_array.size());
+    for (size_t i = 0; i < double_array.size(); ++i) {
+      CHECK_EQ((*array)[i], double_array[i]);
+    }
+
+    // blobs created by the forked client are visible to the others
+    ArrayBuilder<double> builder(client2, double_array);
+    ObjectID other = builder.Seal(client2)->id();
+    VINEYARD_CHECK_OK(client1.GetObject(other, array));
+    CHECK_EQ((*array)[2], double_array[2]);
+    client2.Disconnect();
+  }
+
+  {
+    std::shared_ptr<Array<double>> array;
+    VINEYARD_CHECK_OK(client1.GetObject(id, array));
+    CHECK_EQ((*array)[4], double_array[4]);
+  }
+
+  LOG(INFO) << "Passed shared mmap tests...";
+
+  client1.Disconnect();
+
+  return 0;
+}
@@ -0,0 +1,91 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "client/client.h"
+#include "client/ds/blob.h"
+#include "common/util/logging.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    printf("usage ./small_blob_test <ipc_socket>");
+    return 1;
+  }
+  std::string ipc_socket = std::string(argv[1]);
+
+  std::shared_ptr<InstanceStatus> before, after;
+  {
+    Client client;
+    VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+    VINEYARD_CHECK_OK(client.InstanceStatus(before));
+  }
+
+  const int parallelism = 4, blobs_per_thread = 2000;
+  std::vector<std::vector<ObjectID>> ids(parallelism);
+  std::vector<std::thread> threads;
+  for (int i = 0; i < parallelism; ++i) {
+    threads.emplace_back([&, i]() {
+      Client client;
+      VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+      for (int j = 0; j < blobs_per_thread; ++j) {
+        size_t size = 1 + (i * blobs_per_thread + j) % 300;
+        std::unique_ptr<BlobWriter> writer;
+        VINEYARD_CHECK_OK(client.CreateBlob(size, writer));
+        memset(writer->data(), i * 31 + j % 97, size);
+        ids[i].emplace_back(writer->Seal(client)->id());
+      }
+      client.Disconnect();
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+  VINEYARD_CHECK_OK(client.InstanceStatus(after));
+  if (after->small_blobs_capacity > 0) {
+    CHECK_GE(after->small_blobs - before->small_blobs,
+             parallelism * blobs_per_thread);
+    CHECK_GE(after->small_blobs_capacity, after->small_blobs_size);
+  }
+
+  // the small blobs don't overlap with each other
+  for (int i = 0; i < parallelism; ++i) {
+    std::vector<std::shared_ptr<Blob>> blobs;
+    VINEYARD_CHECK_OK(client.GetBlobs(ids[i], blobs));
+    for (int j = 0; j < blobs_per_thread; ++j) {
+      auto const& blob = blobs[j];
+      CHECK_EQ(blob->size(), 1 + (i * blobs_per_thread + j) % 300);
+      for (size_t k = 0; k < blob->size(); ++k) {
+        CHECK_EQ(blob->data()[k], static_cast<char>(i * 31 + j % 97));
+      }
+    }
+    VINEYARD_CHECK_OK(client.DelData(ids[i]));
+  }
+
+  LOG(INFO) << "Passed small blob tests...";
+
+  client.Disconnect();
+
+  return 0;
+}
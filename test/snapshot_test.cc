@@ -0,0 +1,108 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "basic/ds/array.h"
+#include "client/client.h"
+#include "client/ds/object_meta.h"
+#include "common/util/logging.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    printf("usage ./snapshot_test <ipc_socket>");
+    return 1;
+  }
+  std::string ipc_socket = std::string(argv[1]);
+
+  Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+  LOG(INFO) << "Connected to IPCServer: " << ipc_socket;
+
+  std::vector<double> double_array = {1.0, 7.0, 3.0, 4.0, 2.0};
+  ObjectID id = InvalidObjectID();
+  {
+    ArrayBuilder<double> builder(client, double_array);
+    id = builder.Seal(client)->id();
+  }
+  VINEYARD_CHECK_OK(client.PutName(id, "test_snapshot_array"));
+
+  uint64_t snapshot = 0;
+  VINEYARD_CHECK_OK(client.CreateSnapshot(snapshot));
+
+  // updates after the snapshot has been taken
+  VINEYARD_CHECK_OK(client.DropName("test_snapshot_array"));
+  VINEYARD_CHECK_OK(client.DelData(id, false, true));
+  ObjectID renamed = InvalidObjectID();
+  {
+    ArrayBuilder<double> builder(client, double_array);
+    renamed = builder.Seal(client)->id();
+  }
+  VINEYARD_CHECK_OK(client.PutName(renamed, "test_snapshot_array"));
+
+  {
+    std::map<std::string, ObjectID> ids;
+    VINEYARD_CHECK_OK(client.GetNames({"test_snapshot_array"}, snapshot, ids));
+    CHECK_EQ(ids.size(), 1);
+    CHECK_EQ(ids["test_snapshot_array"], id);
+
+    VINEYARD_CHECK_OK(client.GetNames({"test_snapshot_array"}, ids));
+    CHECK_EQ(ids["test_snapshot_array"], renamed);
+  }
+
+  LOG(INFO) << "Passed snapshot names tests...";
+
+  {
+    // the deleted object is still readable from the snapshot
+    std::vector<ObjectMeta> metas;
+    VINEYARD_CHECK_OK(client.GetMetaData({id}, snapshot, metas));
+    CHECK_EQ(metas.size(), 1);
+    Array<double> array;
+    array.Construct(metas[0]);
+    CHECK_EQ(array.size(), double_array.size());
+    for (size_t i = 0; i < double_array.size(); ++i) {
+      CHECK_EQ(array[i], double_array[i]);
+    }
+
+    // the objects created after the snapshot are invisible
+    CHECK(client.GetMetaData({renamed}, snapshot, metas).IsObjectNotExists());
+
+    ObjectMeta meta;
+    CHECK(!client.GetMetaData(id, meta).ok());
+  }
+
+  LOG(INFO) << "Passed snapshot objects tests...";
+
+  VINEYARD_CHECK_OK(client.ReleaseSnapshot(snapshot));
+  CHECK(!client.ReleaseSnapshot(snapshot).ok());
+  {
+    std::vector<ObjectMeta> metas;
+    CHECK(!client.GetMetaData({id}, snapshot, metas).ok());
+  }
+
+  VINEYARD_CHECK_OK(client.DropName("test_snapshot_array"));
+  VINEYARD_CHECK_OK(client.DelData(renamed, false, true));
+
+  LOG(INFO) << "Passed snapshot tests...";
+
+  client.Disconnect();
+
+  return 0;
+}
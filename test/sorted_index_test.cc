@@ -0,0 +1,120 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "basic/ds/dataframe.h"
+#include "basic/ds/sorted_index.h"
+#include "basic/ds/tensor.h"
+#include "client/client.h"
+#include "client/ds/object_meta.h"
+#include "common/util/logging.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    printf("usage ./sorted_index_test <ipc_socket>");
+    return 1;
+  }
+  std::string ipc_socket = std::string(argv[1]);
+
+  Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+  LOG(INFO) << "Connected to IPCServer: " << ipc_socket;
+
+  const size_t length = 200000;
+  std::vector<int64_t> keys(length);
+  {
+    std::mt19937 random(20211014);
+    for (size_t i = 0; i < length; ++i) {
+      keys[i] = random() % (length / 4);
+    }
+  }
+
+  std::shared_ptr<DataFrame> dataframe;
+  {
+    DataFrameBuilder builder(client);
+    auto key_builder = std::make_shared<TensorBuilder<int64_t>>(
+        client, std::vector<int64_t>{static_cast<int64_t>(length)});
+    auto value_builder = std::make_shared<TensorBuilder<double>>(
+        client, std::vector<int64_t>{static_cast<int64_t>(length)});
+    for (size_t i = 0; i < length; ++i) {
+      key_builder->data()[i] = keys[i];
+      value_builder->data()[i] = i * 0.5;
+    }
+    builder.AddColumn("key", key_builder);
+    builder.AddColumn("value", value_builder);
+    dataframe = std::dynamic_pointer_cast<DataFrame>(builder.Seal(client));
+  }
+
+  ObjectID index_id = InvalidObjectID();
+  {
+    SortedIndexBuilder<int64_t> builder(client, dataframe, "key");
+    index_id = builder.Seal(client)->id();
+  }
+  auto index = client.GetObject<SortedIndex<int64_t>>(index_id);
+  CHECK_EQ(index->length(), length);
+  CHECK_EQ(index->key_column(), json("key"));
+  CHECK_EQ(index->dataframe()->id(), dataframe->id());
+  CHECK(std::is_sorted(index->keys(), index->keys() + length));
+
+  // point lookups, in batch
+  {
+    std::vector<int64_t> queries{-1, 0, 1, 17, 4096, int64_t(length / 4) - 1,
+                                 int64_t(length / 4), int64_t(length)};
+    std::vector<int64_t> rows(queries.size());
+    index->Lookup(queries.data(), queries.size(), rows.data());
+    for (size_t i = 0; i < queries.size(); ++i) {
+      auto expected = std::find(keys.begin(), keys.end(), queries[i]);
+      if (expected == keys.end()) {
+        CHECK_EQ(rows[i], -1);
+      } else {
+        CHECK_EQ(rows[i], expected - keys.begin());
+      }
+    }
+    LOG(INFO) << "Passed sorted index lookup tests...";
+  }
+
+  // range scans
+  {
+    std::vector<std::pair<int64_t, int64_t>> ranges{
+        {0, 10}, {100, 101}, {-5, 3}, {1000, 5000}, {7, 7}, {9, 2}};
+    for (auto const& range : ranges) {
+      std::vector<int64_t> rows;
+      index->RangeScan(range.first, range.second, rows);
+      std::vector<int64_t> expected;
+      for (size_t i = 0; i < length; ++i) {
+        if (keys[i] >= range.first && keys[i] < range.second) {
+          expected.emplace_back(i);
+        }
+      }
+      std::sort(rows.begin(), rows.end());
+      CHECK(rows == expected);
+    }
+    LOG(INFO) << "Passed sorted index range scan tests...";
+  }
+
+  LOG(INFO) << "Passed sorted index tests...";
+
+  client.Disconnect();
+
+  return 0;
+}
@@ -0,0 +1,75 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "arrow/status.h"
+#include "arrow/util/io_util.h"
+#include "arrow/util/logging.h"
+
+#include "basic/ds/array.h"
+#include "client/client.h"
+#include "client/ds/object_meta.h"
+#include "common/util/logging.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+// the server is expected to be launched with `--spill_path` and a small
+// `--size`, see also `test/runner.py`.
+constexpr size_t kArraySize = 4 * 1024 * 1024;
+constexpr size_t kArrays = 32;
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    printf("usage ./spill_test <ipc_socket>");
+    return 1;
+  }
+  std::string ipc_socket = std::string(argv[1]);
+
+  Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+  LOG(INFO) << "Connected to IPCServer: " << ipc_socket;
+
+  // persists far more than the server can hold, the blobs of the persisted
+  // objects are spilled to make room for the later ones.
+  std::vector<ObjectID> ids;
+  for (size_t index = 0; index < kArrays; ++index) {
+    std::vector<uint8_t> data(kArraySize, static_cast<uint8_t>(index));
+    ArrayBuilder<uint8_t> builder(client, data);
+    auto array = builder.Seal(client);
+    VINEYARD_CHECK_OK(client.Persist(array->id()));
+    ids.emplace_back(array->id());
+    VINEYARD_CHECK_OK(client.Release({array->id()}));
+  }
+
+  // the spilled blobs are reloaded with the same contents
+  for (size_t index = 0; index < kArrays; ++index) {
+    std::shared_ptr<Array<uint8_t>> array;
+    VINEYARD_CHECK_OK(client.GetObject(ids[index], array));
+    CHECK_EQ(array->size(), kArraySize);
+    for (size_t i = 0; i < kArraySize; ++i) {
+      CHECK_EQ((*array)[i], static_cast<uint8_t>(index));
+    }
+    VINEYARD_CHECK_OK(client.Release({ids[index]}));
+  }
+
+  LOG(INFO) << "Passed spill tests...";
+
+  client.Disconnect();
+
+  return 0;
+}
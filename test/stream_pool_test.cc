@@ -0,0 +1,132 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <cstring>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "arrow/status.h"
+#include "arrow/util/io_util.h"
+#include "arrow/util/logging.h"
+
+#include "basic/stream/byte_stream.h"
+#include "client/client.h"
+#include "client/ds/object_meta.h"
+#include "common/util/logging.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+// the server runs with the default `--stream_pool_depth=4`: the chunks
+// drained by the consumer are kept for the producer's next chunks of the
+// same size, rather than being freed.
+constexpr size_t kChunkSize = 1024 * 1024;
+
+size_t MemoryUsage(Client& client) {
+  std::shared_ptr<InstanceStatus> status;
+  VINEYARD_CHECK_OK(client.InstanceStatus(status));
+  return status->memory_usage;
+}
+
+void Write(ByteStreamWriter& writer, size_t const size, char const value,
+           std::vector<const uint8_t*>& addresses) {
+  std::unique_ptr<arrow::MutableBuffer> buffer = nullptr;
+  VINEYARD_CHECK_OK(writer.GetNext(size, buffer));
+  CHECK_EQ(buffer->size(), size);
+  memset(buffer->mutable_data(), value, size);
+  addresses.emplace_back(buffer->data());
+}
+
+void Read(ByteStreamReader& reader, size_t const size, char const value) {
+  std::unique_ptr<arrow::Buffer> buffer = nullptr;
+  VINEYARD_CHECK_OK(reader.GetNext(buffer));
+  CHECK_EQ(buffer->size(), size);
+  for (int64_t i = 0; i < buffer->size(); i += 4096) {
+    CHECK_EQ(buffer->data()[i], static_cast<uint8_t>(value));
+  }
+  CHECK_EQ(buffer->data()[buffer->size() - 1], static_cast<uint8_t>(value));
+}
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    printf("usage ./stream_pool_test <ipc_socket>");
+    return 1;
+  }
+  std::string ipc_socket = std::string(argv[1]);
+
+  Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+  LOG(INFO) << "Connected to IPCServer: " << ipc_socket;
+
+  ObjectID stream_id = InvalidObjectID();
+  {
+    ByteStreamBuilder builder(client);
+    builder.SetParams(std::unordered_map<std::string, std::string>{
+        {"kind", "test"}, {"test_name", "stream_pool_test"}});
+    auto bstream = std::dynamic_pointer_cast<ByteStream>(builder.Seal(client));
+    stream_id = bstream->id();
+    CHECK(stream_id != InvalidObjectID());
+  }
+
+  auto byte_stream = client.GetObject<ByteStream>(stream_id);
+  std::unique_ptr<ByteStreamReader> reader = nullptr;
+  std::unique_ptr<ByteStreamWriter> writer = nullptr;
+  VINEYARD_CHECK_OK(byte_stream->OpenReader(client, reader));
+  VINEYARD_CHECK_OK(byte_stream->OpenWriter(client, writer));
+
+  size_t base = MemoryUsage(client);
+  std::vector<const uint8_t*> addresses;
+
+  // the chunk is sealed when the next one is asked for
+  Write(*writer, kChunkSize, 'a', addresses);
+  Write(*writer, kChunkSize, 'b', addresses);
+  Read(*reader, kChunkSize, 'a');
+  Write(*writer, kChunkSize, 'c', addresses);
+  size_t usage = MemoryUsage(client);
+  CHECK_GE(usage, base + 3 * kChunkSize);
+
+  // the drained 'a' goes to the pool rather than being freed
+  Read(*reader, kChunkSize, 'b');
+  CHECK_EQ(MemoryUsage(client), usage);
+
+  // and is reused for the next chunk of the same size, with the new content
+  Write(*writer, kChunkSize, 'd', addresses);
+  CHECK_EQ(MemoryUsage(client), usage);
+  CHECK_EQ(addresses[3], addresses[0]);
+
+  // chunks of other sizes are not taken from the pool
+  Write(*writer, kChunkSize / 2, 'e', addresses);
+  CHECK_GE(MemoryUsage(client), usage + kChunkSize / 2);
+  for (size_t index = 0; index < 3; ++index) {
+    CHECK(addresses[4] != addresses[index]);
+  }
+  VINEYARD_CHECK_OK(writer->Finish());
+
+  Read(*reader, kChunkSize, 'c');
+  Read(*reader, kChunkSize, 'd');
+  Read(*reader, kChunkSize / 2, 'e');
+  std::unique_ptr<arrow::Buffer> buffer = nullptr;
+  CHECK(reader->GetNext(buffer).IsStreamDrained());
+
+  // the pool is released once the stream stops, and the drained chunks are
+  // freed as usual
+  CHECK_EQ(MemoryUsage(client), base);
+  LOG(INFO) << "Passed stream pool tests...";
+
+  client.Disconnect();
+
+  return 0;
+}
@@ -0,0 +1,122 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <cstring>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "arrow/status.h"
+#include "arrow/util/io_util.h"
+#include "arrow/util/logging.h"
+
+#include "basic/stream/byte_stream.h"
+#include "client/client.h"
+#include "client/ds/object_meta.h"
+#include "common/util/logging.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    printf("usage ./stream_replay_test <ipc_socket>");
+    return 1;
+  }
+  std::string ipc_socket = std::string(argv[1]);
+
+  Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+  LOG(INFO) << "Connected to IPCServer: " << ipc_socket;
+
+  const size_t num_chunks = 8, retain_chunks = 4;
+
+  ObjectID stream_id = InvalidObjectID();
+  {
+    ByteStreamBuilder builder(client);
+    builder.SetParams(std::unordered_map<std::string, std::string>{
+        {"kind", "test"}, {"test_name", "stream_replay_test"}});
+    builder.SetRetention(retain_chunks, 0);
+    auto bstream = std::dynamic_pointer_cast<ByteStream>(builder.Seal(client));
+    stream_id = bstream->id();
+    CHECK(stream_id != InvalidObjectID());
+  }
+
+  {
+    auto byte_stream = client.GetObject<ByteStream>(stream_id);
+    std::unique_ptr<ByteStreamWriter> writer;
+    VINEYARD_CHECK_OK(byte_stream->OpenWriter(client, writer));
+    for (size_t idx = 1; idx <= num_chunks; ++idx) {
+      std::unique_ptr<arrow::MutableBuffer> buffer = nullptr;
+      VINEYARD_CHECK_OK(writer->GetNext(idx * 1024, buffer));
+      memset(buffer->mutable_data(), static_cast<int>(idx), buffer->size());
+    }
+    VINEYARD_CHECK_OK(writer->Finish());
+  }
+
+  // the first reader consumes the whole stream, then leaves
+  {
+    Client reader_client;
+    VINEYARD_CHECK_OK(reader_client.Connect(ipc_socket));
+    auto byte_stream = reader_client.GetObject<ByteStream>(stream_id);
+    std::unique_ptr<ByteStreamReader> reader;
+    VINEYARD_CHECK_OK(byte_stream->OpenReader(reader_client, reader));
+
+    // a replayable stream still has a single reader at a time
+    std::unique_ptr<ByteStreamReader> failed_reader;
+    CHECK(byte_stream->OpenReader(client, failed_reader).IsStreamOpened());
+
+    for (size_t idx = 1; idx <= num_chunks; ++idx) {
+      std::unique_ptr<arrow::Buffer> buffer = nullptr;
+      VINEYARD_CHECK_OK(reader->GetNext(buffer));
+      CHECK_EQ(buffer->size(), idx * 1024);
+    }
+    std::unique_ptr<arrow::Buffer> buffer = nullptr;
+    CHECK(reader->GetNext(buffer).IsStreamDrained());
+    reader_client.Disconnect();
+  }
+
+  auto byte_stream = client.GetObject<ByteStream>(stream_id);
+  {
+    // chunks out of the budget have been released
+    std::unique_ptr<ByteStreamReader> reader;
+    CHECK(byte_stream->OpenReader(client, reader, false, 0).IsInvalid());
+  }
+
+  // replay the most recent chunks from the checkpoint
+  {
+    Client reader_client;
+    VINEYARD_CHECK_OK(reader_client.Connect(ipc_socket));
+    std::unique_ptr<ByteStreamReader> reader;
+    int64_t const offset = num_chunks - retain_chunks;
+    VINEYARD_CHECK_OK(
+        byte_stream->OpenReader(reader_client, reader, false, offset));
+    for (size_t idx = offset + 1; idx <= num_chunks; ++idx) {
+      std::unique_ptr<arrow::Buffer> buffer = nullptr;
+      VINEYARD_CHECK_OK(reader->GetNext(buffer));
+      CHECK_EQ(buffer->size(), idx * 1024);
+      CHECK_EQ(buffer->data()[0], static_cast<uint8_t>(idx));
+    }
+    std::unique_ptr<arrow::Buffer> buffer = nullptr;
+    CHECK(reader->GetNext(buffer).IsStreamDrained());
+    reader_client.Disconnect();
+  }
+
+  LOG(INFO) << "Passed stream replay tests...";
+
+  client.Disconnect();
+
+  return 0;
+}
@@ -17,6 +17,7 @@ limitations under the License.
 #include <string>
 #include <thread>
 #include <unordered_map>
+#include <vector>
 
 #include "arrow/status.h"
 #include "arrow/util/io_util.h"
@@ -180,6 +181,157 @@ int main(int argc, char** argv) {
     CHECK(empty_reader->GetNext(buffer).IsStreamDrained());
   }
 
+  // when chunks are published and pulled in batches
+  {
+    ByteStreamBuilder builder(client);
+    builder.SetParams(std::unordered_map<std::string, std::string>{
+        {"kind", "test"}, {"test_name", "stream_test"}});
+    auto bstream = std::dynamic_pointer_cast<ByteStream>(builder.Seal(client));
+    stream_id = bstream->id();
+    CHECK(stream_id != InvalidObjectID());
+  }
+
+  auto batch_byte_stream = client.GetObject<ByteStream>(stream_id);
+
+  std::unique_ptr<ByteStreamReader> batch_reader = nullptr;
+  std::unique_ptr<ByteStreamWriter> batch_writer = nullptr;
+  VINEYARD_CHECK_OK(batch_byte_stream->OpenReader(client, batch_reader));
+  VINEYARD_CHECK_OK(batch_byte_stream->OpenWriter(client, batch_writer));
+
+  std::vector<std::string> messages;
+  {
+    std::vector<std::shared_ptr<arrow::Buffer>> chunks;
+    for (size_t idx = 0; idx < 8; ++idx) {
+      messages.emplace_back("message-" + std::to_string(idx));
+    }
+    for (auto const& message : messages) {
+      chunks.emplace_back(std::make_shared<arrow::Buffer>(message));
+    }
+    VINEYARD_CHECK_OK(batch_writer->PutChunks(chunks));
+
+    // a window of in-flight chunks
+    std::vector<std::unique_ptr<arrow::MutableBuffer>> window;
+    VINEYARD_CHECK_OK(
+        client.GetNextStreamChunks(stream_id, {16, 16, 16}, window));
+    CHECK_EQ(window.size(), 3);
+    for (size_t idx = 0; idx < window.size(); ++idx) {
+      messages.emplace_back(16, static_cast<char>('a' + idx));
+      memcpy(window[idx]->mutable_data(), messages.back().data(), 16);
+    }
+    VINEYARD_CHECK_OK(batch_writer->Finish());
+  }
+
+  {
+    std::vector<std::string> received;
+    while (true) {
+      std::vector<std::shared_ptr<arrow::Buffer>> chunks;
+      auto status = batch_reader->GetNextBatch(4, chunks);
+      if (!status.ok()) {
+        CHECK(status.IsStreamDrained());
+        break;
+      }
+      CHECK(!chunks.empty() && chunks.size() <= 4);
+      for (auto const& chunk : chunks) {
+        received.emplace_back(chunk->ToString());
+      }
+    }
+    CHECK_EQ(messages.size(), received.size());
+    for (size_t idx = 0; idx < messages.size(); ++idx) {
+      CHECK_EQ(messages[idx], received[idx]);
+    }
+  }
+
+  // when chunks are allocated and pulled asynchronously
+  {
+    ByteStreamBuilder builder(client);
+    builder.SetParams(std::unordered_map<std::string, std::string>{
+        {"kind", "test"}, {"test_name", "stream_test"}});
+    auto bstream = std::dynamic_pointer_cast<ByteStream>(builder.Seal(client));
+    stream_id = bstream->id();
+    CHECK(stream_id != InvalidObjectID());
+  }
+
+  {
+    // the pending pulls occupy the reader's client
+    Client writer_client;
+    VINEYARD_CHECK_OK(writer_client.Connect(ipc_socket));
+
+    auto async_byte_stream = client.GetObject<ByteStream>(stream_id);
+    std::unique_ptr<ByteStreamReader> async_reader = nullptr;
+    VINEYARD_CHECK_OK(async_byte_stream->OpenReader(client, async_reader));
+    async_reader->SetPrefetch(3);
+
+    std::thread writer_thrd([&]() {
+      auto byte_stream = writer_client.GetObject<ByteStream>(stream_id);
+      std::unique_ptr<ByteStreamWriter> writer = nullptr;
+      VINEYARD_CHECK_OK(byte_stream->OpenWriter(writer_client, writer));
+      for (size_t idx = 1; idx <= 8; ++idx) {
+        std::unique_ptr<arrow::MutableBuffer> buffer = nullptr;
+        auto allocated = writer->GetNextAsync(idx * 16, buffer);
+        VINEYARD_CHECK_OK(allocated.get());
+        CHECK_EQ(buffer->size(), idx * 16);
+        memset(buffer->mutable_data(), static_cast<int>(idx), buffer->size());
+      }
+      VINEYARD_CHECK_OK(writer->Finish());
+    });
+
+    for (size_t idx = 1; idx <= 8; ++idx) {
+      std::unique_ptr<arrow::Buffer> buffer = nullptr;
+      VINEYARD_CHECK_OK(async_reader->GetNext(buffer));
+      CHECK_EQ(buffer->size(), idx * 16);
+      CHECK_EQ(buffer->data()[0], static_cast<uint8_t>(idx));
+    }
+    std::unique_ptr<arrow::Buffer> buffer = nullptr;
+    CHECK(async_reader->GetNext(buffer).IsStreamDrained());
+    writer_thrd.join();
+    async_reader.reset();
+    writer_client.Disconnect();
+  }
+
+  // when the stream holds at most one chunk
+  {
+    ByteStreamBuilder builder(client);
+    builder.SetParams(std::unordered_map<std::string, std::string>{
+        {"kind", "test"}, {"test_name", "stream_test"}});
+    builder.SetBudget(64);
+    auto bstream = std::dynamic_pointer_cast<ByteStream>(builder.Seal(client));
+    stream_id = bstream->id();
+    CHECK(stream_id != InvalidObjectID());
+  }
+
+  {
+    // the producer waits until the consumer releases the previous chunk
+    Client writer_client;
+    VINEYARD_CHECK_OK(writer_client.Connect(ipc_socket));
+
+    auto budget_byte_stream = client.GetObject<ByteStream>(stream_id);
+    std::unique_ptr<ByteStreamReader> budget_reader = nullptr;
+    VINEYARD_CHECK_OK(budget_byte_stream->OpenReader(client, budget_reader));
+
+    std::thread writer_thrd([&]() {
+      auto byte_stream = writer_client.GetObject<ByteStream>(stream_id);
+      std::unique_ptr<ByteStreamWriter> writer = nullptr;
+      VINEYARD_CHECK_OK(byte_stream->OpenWriter(writer_client, writer));
+      for (size_t idx = 1; idx <= 8; ++idx) {
+        std::unique_ptr<arrow::MutableBuffer> buffer = nullptr;
+        VINEYARD_CHECK_OK(writer->GetNext(64, buffer));
+        memset(buffer->mutable_data(), static_cast<int>(idx), buffer->size());
+      }
+      VINEYARD_CHECK_OK(writer->Finish());
+    });
+
+    for (size_t idx = 1; idx <= 8; ++idx) {
+      std::unique_ptr<arrow::Buffer> buffer = nullptr;
+      VINEYARD_CHECK_OK(budget_reader->GetNext(buffer));
+      CHECK_EQ(buffer->size(), 64);
+      CHECK_EQ(buffer->data()[0], static_cast<uint8_t>(idx));
+    }
+    std::unique_ptr<arrow::Buffer> buffer = nullptr;
+    CHECK(budget_reader->GetNext(buffer).IsStreamDrained());
+    writer_thrd.join();
+    writer_client.Disconnect();
+  }
+
   LOG(INFO) << "Passed stream tests...";
 
   client.Disconnect();
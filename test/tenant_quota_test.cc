@@ -0,0 +1,101 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <stdlib.h>
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "arrow/status.h"
+#include "arrow/util/io_util.h"
+#include "arrow/util/logging.h"
+
+#include "client/client.h"
+#include "client/ds/blob.h"
+#include "common/util/logging.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+// the server is expected to be launched with `--tenant_quota_size=4Mi` and
+// `--tenant_quota_rate=100`, see also `test/runner.py`.
+constexpr size_t kQuotaSize = 4 * 1024 * 1024;
+constexpr double kQuotaRate = 100;
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    printf("usage ./tenant_quota_test <ipc_socket>");
+    return 1;
+  }
+  std::string ipc_socket = std::string(argv[1]);
+
+  // the connections without a tenant share the default tenant
+  Client client1, client2;
+  VINEYARD_CHECK_OK(client1.Connect(ipc_socket));
+  VINEYARD_CHECK_OK(client2.Connect(ipc_socket));
+  LOG(INFO) << "Connected to IPCServer: " << ipc_socket;
+
+  {
+    std::unique_ptr<BlobWriter> writer1, writer2;
+    VINEYARD_CHECK_OK(client1.CreateBlob(kQuotaSize * 3 / 4, writer1));
+    // charged to the same tenant
+    auto status = client2.CreateBlob(kQuotaSize / 2, writer2);
+    CHECK(status.IsNotEnoughMemory());
+
+    // refunded after dropping
+    VINEYARD_CHECK_OK(writer1->Abort(client1));
+    VINEYARD_CHECK_OK(client2.CreateBlob(kQuotaSize / 2, writer2));
+
+    // named tenants have their own quotas
+    setenv("VINEYARD_TENANT", "tenant_quota_test", 1);
+    Client client3;
+    VINEYARD_CHECK_OK(client3.Connect(ipc_socket));
+    unsetenv("VINEYARD_TENANT");
+    std::unique_ptr<BlobWriter> writer3;
+    VINEYARD_CHECK_OK(client3.CreateBlob(kQuotaSize * 3 / 4, writer3));
+    CHECK(client2.CreateBlob(kQuotaSize * 3 / 4, writer1).IsNotEnoughMemory());
+    VINEYARD_CHECK_OK(writer3->Abort(client3));
+    client3.Disconnect();
+
+    VINEYARD_CHECK_OK(writer2->Abort(client2));
+  }
+  LOG(INFO) << "Passed tenant quota charging tests...";
+
+  {
+    // exhaust the burst, then the requests are delayed to keep the rate
+    size_t requests = static_cast<size_t>(kQuotaRate) * 3;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < requests; ++i) {
+      bool exists = false;
+      VINEYARD_CHECK_OK(client1.Exists(InvalidObjectID(), exists));
+    }
+    double elapsed = std::chrono::duration<double>(
+                         std::chrono::steady_clock::now() - start)
+                         .count();
+    // the burst is as large as the rate
+    double expected = (requests - kQuotaRate) / kQuotaRate;
+    LOG(INFO) << "Throttled " << requests << " requests in " << elapsed
+              << " seconds, expects at least " << expected << " seconds";
+    CHECK_GE(elapsed, expected * 0.9);
+  }
+  LOG(INFO) << "Passed tenant quota throttling tests...";
+
+  client1.Disconnect();
+  client2.Disconnect();
+
+  return 0;
+}
@@ -16,6 +16,7 @@ limitations under the License.
 #include <memory>
 #include <string>
 #include <thread>
+#include <vector>
 
 #include "arrow/status.h"
 #include "arrow/util/io_util.h"
@@ -56,6 +57,77 @@ int main(int argc, char** argv) {
     CHECK_EQ(sealed_data[i], i);
   }
 
+  {
+    // the second column, as a view over the same blob
+    std::shared_ptr<Tensor<double>> view;
+    VINEYARD_CHECK_OK(sealed->Slice(client, {0, 1}, {2, 2}, {}, view));
+    CHECK_EQ(view->shape()[0], 2);
+    CHECK_EQ(view->shape()[1], 1);
+    CHECK(!view->is_contiguous());
+    CHECK_EQ(view->data(), sealed_data + 1);
+    auto strides = view->strides();
+    CHECK_EQ(strides[0], 3 * sizeof(double));
+    CHECK_EQ(view->ArrowTensor()->Value({1, 0}), 4);
+
+    auto fetched = client.GetObject<Tensor<double>>(view->id());
+    CHECK_EQ(fetched->data()[0], 1);
+    CHECK_EQ(fetched->offset(), sizeof(double));
+  }
+
+  {
+    // fill a column-major tensor concurrently
+    TensorBuilder<int64_t> builder(client, {100, 4}, TensorOrder::kColumnMajor);
+    CHECK_EQ(builder.strides()[1], 100 * sizeof(int64_t));
+    int64_t* data = builder.data();
+    VINEYARD_CHECK_OK(builder.Fill(
+        [data](int64_t const begin, int64_t const end) -> Status {
+          for (int64_t row = begin; row < end; ++row) {
+            for (int64_t col = 0; col < 4; ++col) {
+              data[col * 100 + row] = row * 4 + col;
+            }
+          }
+          return Status::OK();
+        },
+        4));
+    auto sealed =
+        std::dynamic_pointer_cast<Tensor<int64_t>>(builder.Seal(client));
+    auto fetched = client.GetObject<Tensor<int64_t>>(sealed->id());
+    CHECK_EQ(fetched->strides()[0], sizeof(int64_t));
+    CHECK_EQ(fetched->ArrowTensor()->Value({42, 3}), 42 * 4 + 3);
+  }
+
+  {
+    // partition a global tensor, and fill the partitions concurrently
+    GlobalTensorBuilder builder(client);
+    builder.set_shape({10, 6});
+    builder.set_partition_shape({3, 2});
+    VINEYARD_CHECK_OK(builder.BuildPartitions<double>(
+        client,
+        [](TensorBuilder<double>& partition,
+           std::vector<int64_t> const& offset) -> Status {
+          auto const& shape = partition.shape();
+          for (int64_t i = 0; i < shape[0]; ++i) {
+            for (int64_t j = 0; j < shape[1]; ++j) {
+              partition.data()[i * shape[1] + j] =
+                  (offset[0] + i) * 6 + offset[1] + j;
+            }
+          }
+          return Status::OK();
+        }));
+    auto global =
+        std::dynamic_pointer_cast<GlobalTensor>(builder.Seal(client));
+    auto const& partitions = global->LocalPartitions(client);
+    CHECK_EQ(partitions.size(), 6);
+    int64_t elements = 0;
+    for (auto const& partition : partitions) {
+      auto chunk = std::dynamic_pointer_cast<Tensor<double>>(partition);
+      auto const& index = chunk->partition_index();
+      elements += chunk->shape()[0] * chunk->shape()[1];
+      CHECK_EQ(chunk->data()[0], index[0] * 4 * 6 + index[1] * 3);
+    }
+    CHECK_EQ(elements, 60);
+  }
+
   LOG(INFO) << "Passed tensor tests...";
 
   client.Disconnect();
@@ -0,0 +1,106 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "basic/ds/array.h"
+#include "client/client.h"
+#include "client/ds/object_meta.h"
+#include "common/util/logging.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    printf("usage ./ttl_test <ipc_socket>");
+    return 1;
+  }
+  std::string ipc_socket = std::string(argv[1]);
+
+  Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+  LOG(INFO) << "Connected to IPCServer: " << ipc_socket;
+
+  // the expiry wheel ticks every second
+  auto wait_expiry = []() {
+    std::this_thread::sleep_for(std::chrono::seconds(3));
+  };
+
+  {
+    ObjectMeta meta;
+    meta.SetTypeName("vineyard::Scalar<int>");
+    meta.AddKeyValue("value_", 1);
+    ObjectID id = InvalidObjectID();
+    VINEYARD_CHECK_OK(client.CreateMetaData(meta, 1, id));
+    bool exists = false;
+    VINEYARD_CHECK_OK(client.Exists(id, exists));
+    CHECK(exists);
+    wait_expiry();
+    VINEYARD_CHECK_OK(client.Exists(id, exists));
+    CHECK(!exists);
+  }
+
+  LOG(INFO) << "Passed object ttl tests...";
+
+  {
+    std::vector<double> double_array = {1.0, 7.0, 3.0, 4.0, 2.0};
+    ArrayBuilder<double> builder(client, double_array);
+    auto array = builder.Seal(client);
+
+    // the blobs are pinned by this client since they are created by it
+    ObjectMeta meta;
+    meta.SetTypeName("vineyard::TTLWrapper");
+    meta.AddMember("array_", array->meta());
+    ObjectID id = InvalidObjectID();
+    VINEYARD_CHECK_OK(client.CreateMetaData(meta, 1, id));
+    wait_expiry();
+    bool exists = false;
+    VINEYARD_CHECK_OK(client.Exists(id, exists));
+    CHECK(exists);
+
+    VINEYARD_CHECK_OK(client.Release({array->id()}));
+    wait_expiry();
+    VINEYARD_CHECK_OK(client.Exists(id, exists));
+    CHECK(!exists);
+  }
+
+  LOG(INFO) << "Passed pinned object ttl tests...";
+
+  {
+    ObjectID id = GenerateObjectID();
+    VINEYARD_CHECK_OK(client.PutName(id, "test_ttl_name", 1));
+    // putting the name again without a ttl cancels the expiry
+    VINEYARD_CHECK_OK(client.PutName(id, "test_ttl_name_kept", 1));
+    VINEYARD_CHECK_OK(client.PutName(id, "test_ttl_name_kept"));
+    ObjectID target = InvalidObjectID();
+    VINEYARD_CHECK_OK(client.GetName("test_ttl_name", target));
+    CHECK_EQ(target, id);
+    wait_expiry();
+    CHECK(client.GetName("test_ttl_name", target).IsObjectNotExists());
+    VINEYARD_CHECK_OK(client.GetName("test_ttl_name_kept", target));
+    CHECK_EQ(target, id);
+    VINEYARD_CHECK_OK(client.DropName("test_ttl_name_kept"));
+  }
+
+  LOG(INFO) << "Passed name ttl tests...";
+
+  client.Disconnect();
+
+  return 0;
+}